@@ -6,6 +6,10 @@
 #include <limits> // std::numeric_limits
 #include <cstring> // memcpy, strcmp
 #include <algorithm> // std::min, std::max
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono> // std::chrono::milliseconds
 
 #include "libebm.h"
 #include "logging.h"
@@ -24,6 +28,7 @@
 
 #define R_NO_REMAP
 #include <Rinternals.h>
+#include <R_ext/Utils.h> // R_CheckUserInterrupt
 #include <R_ext/Visibility.h>
 
 namespace DEFINED_ZONE_NAME {
@@ -202,6 +207,59 @@ static IntEbm CountTotalDimensions(const size_t cTerms, const IntEbm * const acT
    return static_cast<IntEbm>(cTotalDimensions);
 }
 
+static void CheckUserInterrupt(void * const) {
+   R_CheckUserInterrupt();
+}
+
+// R_CheckUserInterrupt longjmps when the user has pressed Ctrl-C, which would skip joining our worker thread, so we
+// run it inside R_ToplevelExec which stops the jump there and tells us about it by returning FALSE
+static bool IsUserInterrupt() {
+   return Rboolean::FALSE == R_ToplevelExec(&CheckUserInterrupt, nullptr);
+}
+
+// Runs work on a background thread so that this thread, which is the only one that may call into R, stays free to
+// poll for a user interrupt.  On an interrupt we call CancelRunningCalls and then keep waiting until libebm returns
+// Error_Cancelled at its next round or term boundary, since work still uses memory that R owns.  work must not call
+// into R itself.
+template<typename TFunc>
+static ErrorEbm RunInterruptible(TFunc & work) {
+   std::mutex mutexDone;
+   std::condition_variable conditionDone;
+   bool bDone = false;
+   ErrorEbm errWork = Error_None;
+
+   std::thread worker;
+   try {
+      worker = std::thread([&]() {
+         const ErrorEbm err = work();
+         std::lock_guard<std::mutex> lockDone(mutexDone);
+         errWork = err;
+         bDone = true;
+         // notify while holding the lock so that the waiting thread cannot return and destroy conditionDone first
+         conditionDone.notify_one();
+      });
+   } catch(...) {
+      // we can still do the work without a thread, it just cannot be interrupted
+      return work();
+   }
+
+   bool bCancelled = false;
+   std::unique_lock<std::mutex> lockDone(mutexDone);
+   while(!bDone) {
+      if(!conditionDone.wait_for(lockDone, std::chrono::milliseconds(100), [&bDone]() { return bDone; }) && !bCancelled) {
+         lockDone.unlock();
+         if(IsUserInterrupt()) {
+            bCancelled = true;
+            CancelRunningCalls();
+         }
+         lockDone.lock();
+      }
+   }
+   lockDone.unlock();
+   worker.join();
+   return errWork;
+}
+
 static void RngFinalizer(SEXP rngHandleWrapped) {
    EBM_ASSERT(nullptr != rngHandleWrapped); // shouldn't be possible
    if(EXTPTRSXP == TYPEOF(rngHandleWrapped)) {
@@ -316,6 +374,88 @@ SEXP CutQuantile_R(SEXP featureVals, SEXP minSamplesBin, SEXP isRounded, SEXP co
    return ret;
 }
 
+SEXP CutQuantileBatch_R(SEXP featureVals, SEXP countColumns, SEXP minSamplesBin, SEXP isRounded, SEXP countCuts) {
+   EBM_ASSERT(nullptr != featureVals);
+   EBM_ASSERT(nullptr != countColumns);
+   EBM_ASSERT(nullptr != minSamplesBin);
+   EBM_ASSERT(nullptr != isRounded);
+   EBM_ASSERT(nullptr != countCuts);
+
+   const IntEbm countVals = CountDoubles(featureVals);
+   const double * const aFeatureVals = REAL(featureVals);
+
+   const IntEbm cColumns = ConvertIndex(countColumns);
+   if(IntEbm { 0 } == cColumns) {
+      return Rf_allocVector(VECSXP, R_xlen_t { 0 });
+   }
+   if(0 != countVals % cColumns) {
+      Rf_error("CutQuantileBatch_R featureVals is not a multiple of countColumns");
+   }
+   const IntEbm countSamples = countVals / cColumns;
+
+   if(cColumns != CountDoubles(minSamplesBin)) {
+      Rf_error("CutQuantileBatch_R cColumns != CountDoubles(minSamplesBin)");
+   }
+   if(cColumns != CountDoubles(countCuts)) {
+      Rf_error("CutQuantileBatch_R cColumns != CountDoubles(countCuts)");
+   }
+
+   BoolEbm bRounded = ConvertBool(isRounded);
+
+   IntEbm * const aSamplesBinMin = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != aSamplesBinMin); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   IntEbm * const acCuts = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != acCuts); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   size_t cCutsTotal = 0;
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      aSamplesBinMin[iColumn] = ConvertIndexApprox(REAL(minSamplesBin)[iColumn]);
+      const IntEbm cCuts = ConvertIndex(REAL(countCuts)[iColumn]);
+      acCuts[iColumn] = cCuts;
+      if(IsAddError(cCutsTotal, static_cast<size_t>(cCuts))) {
+         Rf_error("CutQuantileBatch_R IsAddError(cCutsTotal, static_cast<size_t>(cCuts))");
+      }
+      cCutsTotal += static_cast<size_t>(cCuts);
+   }
+
+   double * const aCutsLowerBoundInclusive = reinterpret_cast<double *>(
+      R_alloc(cCutsTotal, static_cast<int>(sizeof(double))));
+   EBM_ASSERT(nullptr != aCutsLowerBoundInclusive); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   const ErrorEbm err = CutQuantileBatch(
+      countSamples,
+      cColumns,
+      aFeatureVals,
+      aSamplesBinMin,
+      bRounded,
+      acCuts,
+      aCutsLowerBoundInclusive
+   );
+   if(Error_None != err) {
+      Rf_error("CutQuantileBatch returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   // CutQuantileBatch leaves each column's cuts at the offset given by the countCuts values that we passed in
+   SEXP ret = PROTECT(Rf_allocVector(VECSXP, static_cast<R_xlen_t>(cColumns)));
+   const double * pCutsLowerBoundInclusive = aCutsLowerBoundInclusive;
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      const size_t cCutsColumn = static_cast<size_t>(acCuts[iColumn]);
+      SEXP columnCuts = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cCutsColumn)));
+      double * const aColumnCuts = REAL(columnCuts);
+      for(size_t iCut = 0; iCut < cCutsColumn; ++iCut) {
+         aColumnCuts[iCut] = pCutsLowerBoundInclusive[iCut];
+      }
+      pCutsLowerBoundInclusive += static_cast<size_t>(ConvertIndex(REAL(countCuts)[iColumn]));
+      SET_VECTOR_ELT(ret, static_cast<R_xlen_t>(iColumn), columnCuts);
+      UNPROTECT(1);
+   }
+   UNPROTECT(1);
+   return ret;
+}
+
 SEXP Discretize_R(SEXP featureVals, SEXP cutsLowerBoundInclusive, SEXP binIndexesOut) {
    EBM_ASSERT(nullptr != featureVals);
    EBM_ASSERT(nullptr != cutsLowerBoundInclusive);
@@ -361,6 +501,104 @@ SEXP Discretize_R(SEXP featureVals, SEXP cutsLowerBoundInclusive, SEXP binIndexe
    return R_NilValue;
 }
 
+SEXP DiscretizeBatch_R(SEXP featureVals, SEXP countColumns, SEXP cutsLowerBoundInclusive) {
+   EBM_ASSERT(nullptr != featureVals);
+   EBM_ASSERT(nullptr != countColumns);
+   EBM_ASSERT(nullptr != cutsLowerBoundInclusive);
+
+   const IntEbm countVals = CountDoubles(featureVals);
+   const double * const aFeatureVals = REAL(featureVals);
+
+   const IntEbm cColumns = ConvertIndex(countColumns);
+   if(IntEbm { 0 } == cColumns) {
+      Rf_error("DiscretizeBatch_R IntEbm { 0 } == cColumns");
+   }
+   if(0 != countVals % cColumns) {
+      Rf_error("DiscretizeBatch_R featureVals is not a multiple of countColumns");
+   }
+   const IntEbm countSamples = countVals / cColumns;
+
+   if(VECSXP != TYPEOF(cutsLowerBoundInclusive)) {
+      Rf_error("DiscretizeBatch_R VECSXP != TYPEOF(cutsLowerBoundInclusive)");
+   }
+   if(static_cast<R_xlen_t>(cColumns) != Rf_xlength(cutsLowerBoundInclusive)) {
+      Rf_error("DiscretizeBatch_R cColumns != Rf_xlength(cutsLowerBoundInclusive)");
+   }
+
+   IntEbm * const acCuts = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != acCuts); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   size_t cCutsTotal = 0;
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      const IntEbm cCuts = CountDoubles(VECTOR_ELT(cutsLowerBoundInclusive, static_cast<R_xlen_t>(iColumn)));
+      acCuts[iColumn] = cCuts;
+      if(IsAddError(cCutsTotal, static_cast<size_t>(cCuts))) {
+         Rf_error("DiscretizeBatch_R IsAddError(cCutsTotal, static_cast<size_t>(cCuts))");
+      }
+      cCutsTotal += static_cast<size_t>(cCuts);
+   }
+
+   double * const aCutsLowerBoundInclusive = reinterpret_cast<double *>(
+      R_alloc(cCutsTotal, static_cast<int>(sizeof(double))));
+   EBM_ASSERT(nullptr != aCutsLowerBoundInclusive); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   double * pCutsLowerBoundInclusive = aCutsLowerBoundInclusive;
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      const double * const aColumnCuts = REAL(VECTOR_ELT(cutsLowerBoundInclusive, static_cast<R_xlen_t>(iColumn)));
+      for(size_t iCut = 0; iCut < static_cast<size_t>(acCuts[iColumn]); ++iCut) {
+         *pCutsLowerBoundInclusive = aColumnCuts[iCut];
+         ++pCutsLowerBoundInclusive;
+      }
+   }
+
+   const IntEbm countBytes = MeasureDiscretizeBatch(countSamples, cColumns, acCuts);
+   if(countBytes < 0) {
+      Rf_error("DiscretizeBatch_R MeasureDiscretizeBatch returned error code: %" ErrorEbmPrintf, static_cast<ErrorEbm>(countBytes));
+   }
+
+   IntEbm * const aiOffsets = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != aiOffsets); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   IntEbm * const acBytesPerBinIndex = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != acBytesPerBinIndex); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   // R aligns the data of its vectors for doubles, which satisfies the 4 byte alignment that DiscretizeBatch needs
+   SEXP ret = PROTECT(Rf_allocVector(VECSXP, R_xlen_t { 3 }));
+   SEXP binIndexes = PROTECT(Rf_allocVector(RAWSXP, static_cast<R_xlen_t>(countBytes)));
+   SET_VECTOR_ELT(ret, R_xlen_t { 0 }, binIndexes);
+   UNPROTECT(1);
+
+   const ErrorEbm err = DiscretizeBatch(
+      countSamples,
+      cColumns,
+      aFeatureVals,
+      acCuts,
+      aCutsLowerBoundInclusive,
+      countBytes,
+      RAW(binIndexes),
+      aiOffsets,
+      acBytesPerBinIndex
+   );
+   if(Error_None != err) {
+      Rf_error("DiscretizeBatch returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   // the offsets are less than countBytes and the widths are at most 4, so they stay exact as doubles
+   SEXP offsets = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cColumns)));
+   SEXP bytesPerBinIndex = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cColumns)));
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      REAL(offsets)[iColumn] = static_cast<double>(aiOffsets[iColumn]);
+      REAL(bytesPerBinIndex)[iColumn] = static_cast<double>(acBytesPerBinIndex[iColumn]);
+   }
+   SET_VECTOR_ELT(ret, R_xlen_t { 1 }, offsets);
+   SET_VECTOR_ELT(ret, R_xlen_t { 2 }, bytesPerBinIndex);
+   UNPROTECT(3);
+   return ret;
+}
+
 SEXP MeasureDataSetHeader_R(SEXP countFeatures, SEXP countWeights, SEXP countTargets) {
    EBM_ASSERT(nullptr != countFeatures);
    EBM_ASSERT(nullptr != countWeights);
@@ -384,28 +622,27 @@ SEXP MeasureDataSetHeader_R(SEXP countFeatures, SEXP countWeights, SEXP countTar
    return ret;
 }
 
-SEXP MeasureFeature_R(SEXP countBins, SEXP isMissing, SEXP isUnknown, SEXP isNominal, SEXP binIndexes) {
+SEXP MeasureFeature_R(SEXP countBins, SEXP isMissing, SEXP isUnknown, SEXP isNominal, SEXP countSamples) {
    EBM_ASSERT(nullptr != countBins);
    EBM_ASSERT(nullptr != isMissing);
    EBM_ASSERT(nullptr != isUnknown);
    EBM_ASSERT(nullptr != isNominal);
-   EBM_ASSERT(nullptr != binIndexes);
+   EBM_ASSERT(nullptr != countSamples);
 
    const IntEbm cBins = ConvertIndex(countBins);
    BoolEbm bMissing = ConvertBool(isMissing);
    BoolEbm bUnknown = ConvertBool(isUnknown);
    BoolEbm bNominal = ConvertBool(isNominal);
+   const IntEbm cSamples = ConvertIndex(countSamples);
 
-   const IntEbm cSamples = CountDoubles(binIndexes);
-   const IntEbm * const aiBins = ConvertDoublesToIndexes(cSamples, binIndexes);
-
+   // the size only depends on the counts, so we do not need the bin indexes until FillFeature_R
    const IntEbm countBytes = MeasureFeature(
       cBins,
       bMissing,
       bUnknown,
       bNominal,
       cSamples,
-      aiBins
+      nullptr
    );
    if(countBytes < 0) {
       Rf_error("MeasureFeature_R MeasureFeature returned error code: %" ErrorEbmPrintf, static_cast<ErrorEbm>(countBytes));
@@ -420,6 +657,73 @@ SEXP MeasureFeature_R(SEXP countBins, SEXP isMissing, SEXP isUnknown, SEXP isNom
    return ret;
 }
 
+static const void * GetExternalBinIndexes(
+   const IntEbm cSamples,
+   const SEXP binIndexes, 
+   const SEXP offset, 
+   const IntEbm cBytesPerBinIndex
+) {
+   if(RAWSXP != TYPEOF(binIndexes)) {
+      Rf_error("GetExternalBinIndexes RAWSXP != TYPEOF(binIndexes)");
+   }
+   const size_t iByteFirst = static_cast<size_t>(ConvertIndex(offset));
+   const size_t cBytes = static_cast<size_t>(Rf_xlength(binIndexes));
+   if(cBytes < iByteFirst || IsMultiplyError(static_cast<size_t>(cSamples), static_cast<size_t>(cBytesPerBinIndex)) ||
+      cBytes - iByteFirst < static_cast<size_t>(cSamples) * static_cast<size_t>(cBytesPerBinIndex)) {
+      Rf_error("GetExternalBinIndexes binIndexes is too short");
+   }
+   return RAW(binIndexes) + iByteFirst;
+}
+
+SEXP MeasureFeatureExternal_R(
+   SEXP countBins,
+   SEXP isMissing,
+   SEXP isUnknown,
+   SEXP isNominal,
+   SEXP countSamples,
+   SEXP binIndexes,
+   SEXP offset,
+   SEXP countBytesPerBinIndex
+) {
+   EBM_ASSERT(nullptr != countBins);
+   EBM_ASSERT(nullptr != isMissing);
+   EBM_ASSERT(nullptr != isUnknown);
+   EBM_ASSERT(nullptr != isNominal);
+   EBM_ASSERT(nullptr != countSamples);
+   EBM_ASSERT(nullptr != binIndexes);
+   EBM_ASSERT(nullptr != offset);
+   EBM_ASSERT(nullptr != countBytesPerBinIndex);
+
+   const IntEbm cBins = ConvertIndex(countBins);
+   BoolEbm bMissing = ConvertBool(isMissing);
+   BoolEbm bUnknown = ConvertBool(isUnknown);
+   BoolEbm bNominal = ConvertBool(isNominal);
+   const IntEbm cSamples = ConvertIndex(countSamples);
+   const IntEbm cBytesPerBinIndex = ConvertIndex(countBytesPerBinIndex);
+   const void * const aBinIndexes = GetExternalBinIndexes(cSamples, binIndexes, offset, cBytesPerBinIndex);
+
+   const IntEbm countBytes = MeasureFeatureExternal(
+      cBins,
+      bMissing,
+      bUnknown,
+      bNominal,
+      cSamples,
+      cBytesPerBinIndex,
+      aBinIndexes
+   );
+   if(countBytes < 0) {
+      Rf_error("MeasureFeatureExternal_R MeasureFeatureExternal returned error code: %" ErrorEbmPrintf, static_cast<ErrorEbm>(countBytes));
+   }
+   if(SAFE_FLOAT64_AS_INT64_MAX < countBytes) {
+      Rf_error("MeasureFeatureExternal_R SAFE_FLOAT64_AS_INT64_MAX < countBytes");
+   }
+
+   const SEXP ret = PROTECT(Rf_allocVector(REALSXP, R_xlen_t { 1 }));
+   REAL(ret)[0] = static_cast<double>(countBytes);
+   UNPROTECT(1);
+   return ret;
+}
+
 SEXP MeasureClassificationTarget_R(SEXP countClasses, SEXP targets) {
    EBM_ASSERT(nullptr != countClasses);
    EBM_ASSERT(nullptr != targets);
@@ -556,6 +860,63 @@ SEXP FillFeature_R(
    return R_NilValue;
 }
 
+SEXP FillFeatureExternal_R(
+   SEXP countBins,
+   SEXP isMissing,
+   SEXP isUnknown,
+   SEXP isNominal,
+   SEXP countSamples,
+   SEXP binIndexes,
+   SEXP offset,
+   SEXP countBytesPerBinIndex,
+   SEXP countBytesAllocated,
+   SEXP fillMemWrapped
+) {
+   EBM_ASSERT(nullptr != countBins);
+   EBM_ASSERT(nullptr != isMissing);
+   EBM_ASSERT(nullptr != isUnknown);
+   EBM_ASSERT(nullptr != isNominal);
+   EBM_ASSERT(nullptr != countSamples);
+   EBM_ASSERT(nullptr != binIndexes);
+   EBM_ASSERT(nullptr != offset);
+   EBM_ASSERT(nullptr != countBytesPerBinIndex);
+   EBM_ASSERT(nullptr != countBytesAllocated);
+   EBM_ASSERT(nullptr != fillMemWrapped);
+
+   const IntEbm cBins = ConvertIndex(countBins);
+   BoolEbm bMissing = ConvertBool(isMissing);
+   BoolEbm bUnknown = ConvertBool(isUnknown);
+   BoolEbm bNominal = ConvertBool(isNominal);
+   const IntEbm cSamples = ConvertIndex(countSamples);
+   const IntEbm cBytesPerBinIndex = ConvertIndex(countBytesPerBinIndex);
+   const void * const aBinIndexes = GetExternalBinIndexes(cSamples, binIndexes, offset, cBytesPerBinIndex);
+
+   const IntEbm cBytesAllocated = ConvertIndex(countBytesAllocated);
+
+   if(EXTPTRSXP != TYPEOF(fillMemWrapped)) {
+      Rf_error("FillFeatureExternal_R EXTPTRSXP != TYPEOF(fillMemWrapped)");
+   }
+   void * const pDataset = R_ExternalPtrAddr(fillMemWrapped);
+
+   // the dataset keeps a pointer into binIndexes, so the R caller needs to hold a reference to it while it is in use
+   const ErrorEbm err = FillFeatureExternal(
+      cBins,
+      bMissing,
+      bUnknown,
+      bNominal,
+      cSamples,
+      cBytesPerBinIndex,
+      aBinIndexes,
+      cBytesAllocated,
+      pDataset
+   );
+   if(Error_None != err) {
+      Rf_error("FillFeatureExternal returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   return R_NilValue;
+}
+
 SEXP FillClassificationTarget_R(SEXP countClasses, SEXP targets, SEXP countBytesAllocated, SEXP fillMemWrapped) {
    EBM_ASSERT(nullptr != countClasses);
    EBM_ASSERT(nullptr != targets);
@@ -588,6 +949,207 @@ SEXP FillClassificationTarget_R(SEXP countClasses, SEXP targets, SEXP countBytes
    return R_NilValue;
 }
 
+// Builds the whole boosting dataset in one .Call: every column is cut with CutQuantileBatch and discretized once
+// with DiscretizeBatch, then the header, the features and the target are measured and filled without returning to
+// R in between.  featureVals holds the columns one after the other.  Every feature gets countCuts + 3 bins, with
+// missing and unknown bins, as make_dataset has always done.  The dataset points into the returned bin indexes, so
+// the caller must keep them alive for as long as the dataset is in use.
+SEXP MakeDataSet_R(
+   SEXP countClasses,
+   SEXP featureVals,
+   SEXP countColumns,
+   SEXP minSamplesBin,
+   SEXP isRounded,
+   SEXP countCuts,
+   SEXP targets
+) {
+   EBM_ASSERT(nullptr != countClasses);
+   EBM_ASSERT(nullptr != featureVals);
+   EBM_ASSERT(nullptr != countColumns);
+   EBM_ASSERT(nullptr != minSamplesBin);
+   EBM_ASSERT(nullptr != isRounded);
+   EBM_ASSERT(nullptr != countCuts);
+   EBM_ASSERT(nullptr != targets);
+
+   ErrorEbm err;
+
+   const IntEbm cClasses = ConvertIndex(countClasses);
+
+   const IntEbm countVals = CountDoubles(featureVals);
+   const double * const aFeatureVals = REAL(featureVals);
+
+   const IntEbm cColumns = ConvertIndex(countColumns);
+   if(IntEbm { 0 } == cColumns) {
+      Rf_error("MakeDataSet_R IntEbm { 0 } == cColumns");
+   }
+   if(0 != countVals % cColumns) {
+      Rf_error("MakeDataSet_R featureVals is not a multiple of countColumns");
+   }
+   const IntEbm countSamples = countVals / cColumns;
+
+   if(countSamples != CountDoubles(targets)) {
+      Rf_error("MakeDataSet_R countSamples != CountDoubles(targets)");
+   }
+   const IntEbm * const aTargets = ConvertDoublesToIndexes(countSamples, targets);
+
+   const IntEbm samplesBinMin = ConvertIndexApprox(minSamplesBin);
+   const BoolEbm bRounded = ConvertBool(isRounded);
+   const IntEbm cCutsMax = ConvertIndex(countCuts);
+   if(IsMultiplyError(static_cast<size_t>(cCutsMax), static_cast<size_t>(cColumns))) {
+      Rf_error("MakeDataSet_R IsMultiplyError(cCutsMax, cColumns)");
+   }
+
+   IntEbm * const aSamplesBinMin = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != aSamplesBinMin); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   IntEbm * const acCuts = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != acCuts); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      aSamplesBinMin[iColumn] = samplesBinMin;
+      acCuts[iColumn] = cCutsMax;
+   }
+
+   double * const aCutsLowerBoundInclusive = reinterpret_cast<double *>(
+      R_alloc(static_cast<size_t>(cCutsMax) * static_cast<size_t>(cColumns), static_cast<int>(sizeof(double))));
+
+   err = CutQuantileBatch(
+      countSamples,
+      cColumns,
+      aFeatureVals,
+      aSamplesBinMin,
+      bRounded,
+      acCuts,
+      aCutsLowerBoundInclusive
+   );
+   if(Error_None != err) {
+      Rf_error("CutQuantileBatch returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   // CutQuantileBatch left column i's cuts at i * cCutsMax, but DiscretizeBatch wants them packed.  The packed
+   // position is never after the original one, so we can slide them down in place.
+   SEXP ret = PROTECT(Rf_allocVector(VECSXP, R_xlen_t { 3 }));
+   SEXP cuts = PROTECT(Rf_allocVector(VECSXP, static_cast<R_xlen_t>(cColumns)));
+   SET_VECTOR_ELT(ret, R_xlen_t { 1 }, cuts);
+   UNPROTECT(1);
+   double * pCutsPacked = aCutsLowerBoundInclusive;
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      const size_t cCutsColumn = static_cast<size_t>(acCuts[iColumn]);
+      SEXP columnCuts = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cCutsColumn)));
+      if(size_t { 0 } != cCutsColumn) {
+         const double * const aColumnCuts = aCutsLowerBoundInclusive + iColumn * static_cast<size_t>(cCutsMax);
+         memcpy(REAL(columnCuts), aColumnCuts, sizeof(double) * cCutsColumn);
+         memmove(pCutsPacked, aColumnCuts, sizeof(double) * cCutsColumn);
+      }
+      pCutsPacked += cCutsColumn;
+      SET_VECTOR_ELT(cuts, static_cast<R_xlen_t>(iColumn), columnCuts);
+      UNPROTECT(1);
+   }
+
+   const IntEbm countBytesBins = MeasureDiscretizeBatch(countSamples, cColumns, acCuts);
+   if(countBytesBins < 0) {
+      Rf_error("MakeDataSet_R MeasureDiscretizeBatch returned error code: %" ErrorEbmPrintf, static_cast<ErrorEbm>(countBytesBins));
+   }
+
+   IntEbm * const aiOffsets = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != aiOffsets); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   IntEbm * const acBytesPerBinIndex = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != acBytesPerBinIndex); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   // R aligns the data of its vectors for doubles, which satisfies the 4 byte alignment that DiscretizeBatch needs
+   SEXP binIndexes = PROTECT(Rf_allocVector(RAWSXP, static_cast<R_xlen_t>(countBytesBins)));
+   SET_VECTOR_ELT(ret, R_xlen_t { 2 }, binIndexes);
+   UNPROTECT(1);
+
+   err = DiscretizeBatch(
+      countSamples,
+      cColumns,
+      aFeatureVals,
+      acCuts,
+      aCutsLowerBoundInclusive,
+      countBytesBins,
+      RAW(binIndexes),
+      aiOffsets,
+      acBytesPerBinIndex
+   );
+   if(Error_None != err) {
+      Rf_error("DiscretizeBatch returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   IntEbm countBytes = MeasureDataSetHeader(cColumns, 0, 1);
+   if(countBytes < 0) {
+      Rf_error("MakeDataSet_R MeasureDataSetHeader returned error code: %" ErrorEbmPrintf, static_cast<ErrorEbm>(countBytes));
+   }
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      const IntEbm countBytesFeature = MeasureFeatureExternal(
+         acCuts[iColumn] + IntEbm { 3 },
+         EBM_TRUE,
+         EBM_TRUE,
+         EBM_FALSE,
+         countSamples,
+         acBytesPerBinIndex[iColumn],
+         RAW(binIndexes) + static_cast<size_t>(aiOffsets[iColumn])
+      );
+      if(countBytesFeature < 0) {
+         Rf_error("MakeDataSet_R MeasureFeatureExternal returned error code: %" ErrorEbmPrintf, static_cast<ErrorEbm>(countBytesFeature));
+      }
+      if(IsAddError(countBytes, countBytesFeature)) {
+         Rf_error("MakeDataSet_R IsAddError(countBytes, countBytesFeature)");
+      }
+      countBytes += countBytesFeature;
+   }
+   const IntEbm countBytesTarget = MeasureClassificationTarget(cClasses, countSamples, aTargets);
+   if(countBytesTarget < 0) {
+      Rf_error("MakeDataSet_R MeasureClassificationTarget returned error code: %" ErrorEbmPrintf, static_cast<ErrorEbm>(countBytesTarget));
+   }
+   if(IsAddError(countBytes, countBytesTarget) || IsConvertError<size_t>(countBytes + countBytesTarget)) {
+      Rf_error("MakeDataSet_R IsAddError(countBytes, countBytesTarget)");
+   }
+   countBytes += countBytesTarget;
+
+   // wrap the memory before filling it so that the finalizer frees it if any of the fills below raise an R error
+   void * const pDataSet = malloc(static_cast<size_t>(countBytes));
+   if(nullptr == pDataSet) {
+      Rf_error("MakeDataSet_R nullptr == pDataSet");
+   }
+   SEXP dataSetHandleWrapped = R_MakeExternalPtr(pDataSet, R_NilValue, R_NilValue); // makes an EXTPTRSXP
+   SET_VECTOR_ELT(ret, R_xlen_t { 0 }, dataSetHandleWrapped);
+   R_RegisterCFinalizerEx(dataSetHandleWrapped, &DataSetFinalizer, Rboolean::TRUE);
+
+   err = FillDataSetHeader(cColumns, 0, 1, countBytes, pDataSet);
+   if(Error_None != err) {
+      Rf_error("FillDataSetHeader returned error code: %" ErrorEbmPrintf, err);
+   }
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      err = FillFeatureExternal(
+         acCuts[iColumn] + IntEbm { 3 },
+         EBM_TRUE,
+         EBM_TRUE,
+         EBM_FALSE,
+         countSamples,
+         acBytesPerBinIndex[iColumn],
+         RAW(binIndexes) + static_cast<size_t>(aiOffsets[iColumn]),
+         countBytes,
+         pDataSet
+      );
+      if(Error_None != err) {
+         Rf_error("FillFeatureExternal returned error code: %" ErrorEbmPrintf, err);
+      }
+   }
+   err = FillClassificationTarget(cClasses, countSamples, aTargets, countBytes, pDataSet);
+   if(Error_None != err) {
+      Rf_error("FillClassificationTarget returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   UNPROTECT(1);
+   return ret;
+}
+
 SEXP SampleWithoutReplacement_R(SEXP rng, SEXP countTrainingSamples, SEXP countValidationSamples, SEXP bagOut) {
    EBM_ASSERT(nullptr != rng);
    EBM_ASSERT(nullptr != countTrainingSamples);
@@ -645,20 +1207,85 @@ SEXP SampleWithoutReplacement_R(SEXP rng, SEXP countTrainingSamples, SEXP countV
    return R_NilValue;
 }
 
-SEXP CreateBooster_R(
-   SEXP rng,
-   SEXP dataSetWrapped,
-   SEXP bag,
-   SEXP initScores,
-   SEXP dimensionCounts,
-   SEXP featureIndexes,
-   SEXP countInnerBags
-) {
+SEXP GenerateBags_R(SEXP rng, SEXP countBags, SEXP countTrainingSamples, SEXP countValidationSamples, SEXP bagsOut) {
    EBM_ASSERT(nullptr != rng);
-   EBM_ASSERT(nullptr != dataSetWrapped);
-   EBM_ASSERT(nullptr != bag);
-   EBM_ASSERT(nullptr != initScores);
-   EBM_ASSERT(nullptr != dimensionCounts);
+   EBM_ASSERT(nullptr != countBags);
+   EBM_ASSERT(nullptr != countTrainingSamples);
+   EBM_ASSERT(nullptr != countValidationSamples);
+   EBM_ASSERT(nullptr != bagsOut);
+
+   void * pRng = nullptr;
+   if(NILSXP != TYPEOF(rng)) {
+      if(EXTPTRSXP != TYPEOF(rng)) {
+         Rf_error("GenerateBags_R EXTPTRSXP != TYPEOF(rng)");
+      }
+      pRng = R_ExternalPtrAddr(rng);
+   }
+
+   const IntEbm cBags = ConvertIndex(countBags);
+   const IntEbm cTrainingSamples = ConvertIndex(countTrainingSamples);
+   const IntEbm cValidationSamples = ConvertIndex(countValidationSamples);
+   if(IsAddError(static_cast<size_t>(cTrainingSamples), static_cast<size_t>(cValidationSamples))) {
+      Rf_error("GenerateBags_R IsAddError(static_cast<size_t>(cTrainingSamples), static_cast<size_t>(cValidationSamples))");
+   }
+   const size_t cSamples = static_cast<size_t>(cTrainingSamples) + static_cast<size_t>(cValidationSamples);
+   if(IsMultiplyError(cSamples, static_cast<size_t>(cBags))) {
+      Rf_error("GenerateBags_R IsMultiplyError(cSamples, static_cast<size_t>(cBags))");
+   }
+   const size_t cItems = cSamples * static_cast<size_t>(cBags);
+
+   if(static_cast<size_t>(CountInts(bagsOut)) != cItems) {
+      Rf_error("GenerateBags_R cSamples * cBags != CountInts(bagsOut)");
+   }
+
+   if(0 != cItems) {
+      BagEbm * const aBags = 
+         reinterpret_cast<BagEbm *>(R_alloc(cItems, static_cast<int>(sizeof(BagEbm))));
+      EBM_ASSERT(nullptr != aBags); // this can't be nullptr since R_alloc uses R error handling
+
+      const ErrorEbm err = GenerateBags(
+         pRng,
+         cBags,
+         IntEbm { 0 },
+         cTrainingSamples,
+         cValidationSamples,
+         nullptr,
+         aBags
+      );
+      if(Error_None != err) {
+         Rf_error("GenerateBags returned error code: %" ErrorEbmPrintf, err);
+      }
+
+      int32_t * pSampleReplicationOut = INTEGER(bagsOut);
+      const BagEbm * pSampleReplication = aBags;
+      const BagEbm * const pSampleReplicationEnd = aBags + cItems;
+      do {
+         const BagEbm replication = *pSampleReplication;
+         if(IsConvertError<int32_t>(replication)) {
+            Rf_error("GenerateBags_R IsConvertError<int32_t>(replication)");
+         }
+         *pSampleReplicationOut = static_cast<int32_t>(replication);
+         ++pSampleReplicationOut;
+         ++pSampleReplication;
+      } while(pSampleReplicationEnd != pSampleReplication);
+   }
+   return R_NilValue;
+}
+
+SEXP CreateBooster_R(
+   SEXP rng,
+   SEXP dataSetWrapped,
+   SEXP bag,
+   SEXP initScores,
+   SEXP dimensionCounts,
+   SEXP featureIndexes,
+   SEXP countInnerBags
+) {
+   EBM_ASSERT(nullptr != rng);
+   EBM_ASSERT(nullptr != dataSetWrapped);
+   EBM_ASSERT(nullptr != bag);
+   EBM_ASSERT(nullptr != initScores);
+   EBM_ASSERT(nullptr != dimensionCounts);
    EBM_ASSERT(nullptr != featureIndexes);
    EBM_ASSERT(nullptr != countInnerBags);
 
@@ -749,11 +1376,13 @@ SEXP CreateBooster_R(
       cTerms,
       acTermDimensions,
       aiTermFeatures,
+      nullptr,
       cInnerBags,
       CreateBoosterFlags_Default,
       AccelerationFlags_ALL,
       "log_loss",
       nullptr,
+      nullptr,
       &boosterHandle
    );
    if(Error_None != err || nullptr == boosterHandle) {
@@ -869,29 +1498,324 @@ SEXP ApplyTermUpdate_R(SEXP boosterHandleWrapped) {
    return ret;
 }
 
-SEXP GetBestTermScores_R(SEXP boosterHandleWrapped, SEXP indexTerm) {
-   EBM_ASSERT(nullptr != boosterHandleWrapped); // shouldn't be possible
-   EBM_ASSERT(nullptr != indexTerm); // shouldn't be possible
+SEXP ApplyTermUpdateAndBinNext_R(SEXP boosterHandleWrapped, SEXP indexTermNext) {
+   EBM_ASSERT(nullptr != boosterHandleWrapped);
+   EBM_ASSERT(nullptr != indexTermNext);
 
    if(EXTPTRSXP != TYPEOF(boosterHandleWrapped)) {
-      Rf_error("GetBestTermScores_R EXTPTRSXP != TYPEOF(boosterHandleWrapped)");
+      Rf_error("ApplyTermUpdateAndBinNext_R EXTPTRSXP != TYPEOF(boosterHandleWrapped)");
+   }
+   const BoosterHandle boosterHandle = static_cast<BoosterHandle>(R_ExternalPtrAddr(boosterHandleWrapped));
+   // we don't use boosterHandle in this function, so let ApplyTermUpdateAndBinNext check if it's null or invalid
+
+   const IntEbm iTermNext = ConvertIndex(indexTermNext);
+
+   double avgValidationMetric;
+   const ErrorEbm err = ApplyTermUpdateAndBinNext(boosterHandle, iTermNext, &avgValidationMetric);
+   if(Error_None != err) {
+      Rf_error("ApplyTermUpdateAndBinNext returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   SEXP ret = PROTECT(Rf_allocVector(REALSXP, R_xlen_t { 1 }));
+   REAL(ret)[0] = avgValidationMetric;
+   UNPROTECT(1);
+   return ret;
+}
+
+SEXP BoostCyclic_R(
+   SEXP rng,
+   SEXP boosterHandleWrapped,
+   SEXP maxRounds,
+   SEXP earlyStoppingRounds,
+   SEXP earlyStoppingTolerance,
+   SEXP learningRate,
+   SEXP minHessian,
+   SEXP leavesMax
+) {
+   EBM_ASSERT(nullptr != rng);
+   EBM_ASSERT(nullptr != boosterHandleWrapped);
+   EBM_ASSERT(nullptr != maxRounds);
+   EBM_ASSERT(nullptr != earlyStoppingRounds);
+   EBM_ASSERT(nullptr != earlyStoppingTolerance);
+   EBM_ASSERT(nullptr != learningRate);
+   EBM_ASSERT(nullptr != minHessian);
+   EBM_ASSERT(nullptr != leavesMax);
+
+   void * pRng = nullptr;
+   if(NILSXP != TYPEOF(rng)) {
+      if(EXTPTRSXP != TYPEOF(rng)) {
+         Rf_error("BoostCyclic_R EXTPTRSXP != TYPEOF(rng)");
+      }
+      pRng = R_ExternalPtrAddr(rng);
+   }
+
+   if(EXTPTRSXP != TYPEOF(boosterHandleWrapped)) {
+      Rf_error("BoostCyclic_R EXTPTRSXP != TYPEOF(boosterHandleWrapped)");
    }
    const BoosterHandle boosterHandle = static_cast<BoosterHandle>(R_ExternalPtrAddr(boosterHandleWrapped));
    BoosterShell * const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
    if(nullptr == pBoosterShell) {
-      Rf_error("GetBestTermScores_R nullptr == pBoosterShell");
+      Rf_error("BoostCyclic_R nullptr == pBoosterShell");
    }
-   BoosterCore * const pBoosterCore = pBoosterShell->GetBoosterCore();
 
-   const IntEbm iTerm = ConvertIndex(indexTerm);
+   const IntEbm cRoundsMax = ConvertIndex(maxRounds);
+   // negative values disable early stopping, which ConvertIndex does not allow
+   const IntEbm cEarlyStoppingRounds = ConvertIndexApprox(earlyStoppingRounds);
+   const double earlyStoppingToleranceLocal = ConvertDouble(earlyStoppingTolerance);
+   const double learningRateLocal = ConvertDouble(learningRate);
+   const double hessianMin = ConvertDouble(minHessian);
 
-   if(pBoosterCore->GetCountTerms() <= static_cast<size_t>(iTerm)) {
-      Rf_error("GetBestTermScores_R pBoosterCore->GetCountTerms() <= static_cast<size_t>(iTerm)");
+   const IntEbm cDimensions = CountDoubles(leavesMax);
+   const IntEbm * const aLeavesMax = ConvertDoublesToIndexes(cDimensions, leavesMax);
+   const size_t cTerms = pBoosterShell->GetBoosterCore()->GetCountTerms();
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      if(static_cast<size_t>(cDimensions) < pBoosterShell->GetBoosterCore()->GetTerms()[iTerm]->GetCountDimensions()) {
+         Rf_error("BoostCyclic_R static_cast<size_t>(cDimensions) < pBoosterShell->GetBoosterCore()->GetTerms()[iTerm]->GetCountDimensions()");
+      }
    }
 
+   IntEbm cRounds;
+   double minMetric;
+
+   auto boost = [&]() -> ErrorEbm {
+      return BoostCyclic(
+         pRng,
+         boosterHandle,
+         cRoundsMax,
+         cEarlyStoppingRounds,
+         earlyStoppingToleranceLocal,
+         TermBoostFlags_Default,
+         learningRateLocal,
+         0,
+         hessianMin,
+         0,
+         0,
+         0,
+         aLeavesMax,
+         &cRounds,
+         &minMetric
+      );
+   };
+   const ErrorEbm err = RunInterruptible(boost);
+   if(Error_Cancelled == err) {
+      Rf_error("BoostCyclic_R interrupted by the user");
+   }
+   if(Error_None != err) {
+      Rf_error("BoostCyclic returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   SEXP ret = PROTECT(Rf_allocVector(REALSXP, R_xlen_t { 2 }));
+   REAL(ret)[0] = minMetric;
+   REAL(ret)[1] = static_cast<double>(cRounds);
+   UNPROTECT(1);
+   return ret;
+}
+
+SEXP BoostOuterBags_R(
+   SEXP rng,
+   SEXP dataSetWrapped,
+   SEXP countOuterBags,
+   SEXP bags,
+   SEXP countScores,
+   SEXP dimensionCounts,
+   SEXP featureIndexes,
+   SEXP countInnerBags,
+   SEXP maxRounds,
+   SEXP earlyStoppingRounds,
+   SEXP earlyStoppingTolerance,
+   SEXP learningRate,
+   SEXP minHessian,
+   SEXP leavesMax
+) {
+   EBM_ASSERT(nullptr != rng);
+   EBM_ASSERT(nullptr != dataSetWrapped);
+   EBM_ASSERT(nullptr != countOuterBags);
+   EBM_ASSERT(nullptr != bags);
+   EBM_ASSERT(nullptr != countScores);
+   EBM_ASSERT(nullptr != dimensionCounts);
+   EBM_ASSERT(nullptr != featureIndexes);
+   EBM_ASSERT(nullptr != countInnerBags);
+   EBM_ASSERT(nullptr != maxRounds);
+   EBM_ASSERT(nullptr != earlyStoppingRounds);
+   EBM_ASSERT(nullptr != earlyStoppingTolerance);
+   EBM_ASSERT(nullptr != learningRate);
+   EBM_ASSERT(nullptr != minHessian);
+   EBM_ASSERT(nullptr != leavesMax);
+
+   ErrorEbm err;
+
+   void * pRng = nullptr;
+   if(NILSXP != TYPEOF(rng)) {
+      if(EXTPTRSXP != TYPEOF(rng)) {
+         Rf_error("BoostOuterBags_R EXTPTRSXP != TYPEOF(rng)");
+      }
+      pRng = R_ExternalPtrAddr(rng);
+   }
+
+   if(EXTPTRSXP != TYPEOF(dataSetWrapped)) {
+      Rf_error("BoostOuterBags_R EXTPTRSXP != TYPEOF(dataSetWrapped)");
+   }
+   const void * pDataSet = R_ExternalPtrAddr(dataSetWrapped);
+
+   IntEbm countSamples;
+   IntEbm countFeatures;
+   IntEbm unused1;
+   IntEbm unused2;
+
+   err = ExtractDataSetHeader(pDataSet, &countSamples, &countFeatures, &unused1, &unused2);
+   if(Error_None != err) {
+      Rf_error("ExtractDataSetHeader returned error code: %" ErrorEbmPrintf, err);
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples); // we trust our internal code that this is convertible
+   const size_t cFeatures = static_cast<size_t>(countFeatures); // we trust our internal code that this is convertible
+
+   const IntEbm cOuterBags = ConvertIndex(countOuterBags);
+   if(IntEbm { 0 } == cOuterBags) {
+      Rf_error("BoostOuterBags_R IntEbm { 0 } == cOuterBags");
+   }
+
+   BagEbm * aBags = nullptr;
+   if(NILSXP != TYPEOF(bags)) {
+      const size_t cBagItems = static_cast<size_t>(CountInts(bags));
+      if(cSamples != cBagItems / static_cast<size_t>(cOuterBags) || size_t { 0 } != cBagItems % static_cast<size_t>(cOuterBags)) {
+         Rf_error("BoostOuterBags_R bags must have countSamples * countOuterBags items");
+      }
+
+      aBags = reinterpret_cast<BagEbm *>(R_alloc(cBagItems, static_cast<int>(sizeof(BagEbm))));
+      EBM_ASSERT(nullptr != aBags); // this can't be nullptr since R_alloc uses R error handling
+
+      const int32_t * const aSampleReplicationR = INTEGER(bags);
+      for(size_t iBagItem = 0; iBagItem < cBagItems; ++iBagItem) {
+         const int32_t replication = aSampleReplicationR[iBagItem];
+         if(IsConvertError<BagEbm>(replication)) {
+            Rf_error("BoostOuterBags_R IsConvertError<BagEbm>(replication)");
+         }
+         aBags[iBagItem] = static_cast<BagEbm>(replication);
+      }
+   }
+
+   const IntEbm cScores = ConvertIndex(countScores);
+
+   const IntEbm cTerms = CountDoubles(dimensionCounts);
+   const IntEbm * const acTermDimensions = ConvertDoublesToIndexes(cTerms, dimensionCounts);
+   const IntEbm cTotalDimensionsCheck = CountTotalDimensions(static_cast<size_t>(cTerms), acTermDimensions);
+
+   const IntEbm cTotalDimensionsActual = CountDoubles(featureIndexes);
+   if(cTotalDimensionsActual != cTotalDimensionsCheck) {
+      Rf_error("BoostOuterBags_R cTotalDimensionsActual != cTotalDimensionsCheck");
+   }
+   const IntEbm * const aiTermFeatures = ConvertDoublesToIndexes(cTotalDimensionsActual, featureIndexes);
+
+   const IntEbm cInnerBags = ConvertIndex(countInnerBags);
+   const IntEbm cRoundsMax = ConvertIndex(maxRounds);
+   // negative values disable early stopping, which ConvertIndex does not allow
+   const IntEbm cEarlyStoppingRounds = ConvertIndexApprox(earlyStoppingRounds);
+   const double earlyStoppingToleranceLocal = ConvertDouble(earlyStoppingTolerance);
+   const double learningRateLocal = ConvertDouble(learningRate);
+   const double hessianMin = ConvertDouble(minHessian);
+
+   const IntEbm cDimensionsMax = CountDoubles(leavesMax);
+   const IntEbm * const aLeavesMax = ConvertDoublesToIndexes(cDimensionsMax, leavesMax);
+
+   IntEbm * const aBinCounts = reinterpret_cast<IntEbm *>(R_alloc(cFeatures, static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != aBinCounts || size_t { 0 } == cFeatures); // R_alloc uses R error handling
+   err = ExtractBinCounts(pDataSet, countFeatures, aBinCounts);
+   if(Error_None != err) {
+      Rf_error("ExtractBinCounts returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   // the results come back as one tensor per term in the same layout as GetBestTermScores_R
+   size_t * const acTensorScores = reinterpret_cast<size_t *>(R_alloc(static_cast<size_t>(cTerms), static_cast<int>(sizeof(size_t))));
+   EBM_ASSERT(nullptr != acTensorScores || IntEbm { 0 } == cTerms); // R_alloc uses R error handling
+   size_t cTotalScores = 0;
+   const IntEbm * piTermFeature = aiTermFeatures;
+   for(size_t iTerm = 0; iTerm < static_cast<size_t>(cTerms); ++iTerm) {
+      const IntEbm cDimensions = acTermDimensions[iTerm];
+      if(cDimensionsMax < cDimensions) {
+         Rf_error("BoostOuterBags_R cDimensionsMax < cDimensions");
+      }
+      size_t cTensorScores = static_cast<size_t>(cScores);
+      for(IntEbm iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         const IntEbm iFeature = *piTermFeature;
+         if(countFeatures <= iFeature) {
+            Rf_error("BoostOuterBags_R countFeatures <= iFeature");
+         }
+         const size_t cBins = static_cast<size_t>(aBinCounts[iFeature]);
+         if(IsMultiplyError(cTensorScores, cBins)) {
+            Rf_error("BoostOuterBags_R IsMultiplyError(cTensorScores, cBins)");
+         }
+         cTensorScores *= cBins;
+         ++piTermFeature;
+      }
+      if(IsConvertError<R_xlen_t>(cTensorScores) || IsAddError(cTotalScores, cTensorScores)) {
+         Rf_error("BoostOuterBags_R IsConvertError<R_xlen_t>(cTensorScores) || IsAddError(cTotalScores, cTensorScores)");
+      }
+      acTensorScores[iTerm] = cTensorScores;
+      cTotalScores += cTensorScores;
+   }
+
+   double * const aAvgTermScores = reinterpret_cast<double *>(R_alloc(cTotalScores, static_cast<int>(sizeof(double))));
+   EBM_ASSERT(nullptr != aAvgTermScores || size_t { 0 } == cTotalScores); // R_alloc uses R error handling
+
+   auto boost = [&]() -> ErrorEbm {
+      return BoostOuterBags(
+         pRng,
+         pDataSet,
+         cOuterBags,
+         aBags,
+         cTerms,
+         acTermDimensions,
+         aiTermFeatures,
+         cInnerBags,
+         CreateBoosterFlags_Default,
+         AccelerationFlags_ALL,
+         "log_loss",
+         nullptr,
+         cRoundsMax,
+         cEarlyStoppingRounds,
+         earlyStoppingToleranceLocal,
+         TermBoostFlags_Default,
+         learningRateLocal,
+         0,
+         hessianMin,
+         0,
+         0,
+         0,
+         aLeavesMax,
+         aAvgTermScores
+      );
+   };
+   err = RunInterruptible(boost);
+   if(Error_Cancelled == err) {
+      Rf_error("BoostOuterBags_R interrupted by the user");
+   }
+   if(Error_None != err) {
+      Rf_error("BoostOuterBags returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   SEXP ret = PROTECT(Rf_allocVector(VECSXP, static_cast<R_xlen_t>(cTerms)));
+   const double * pAvgTermScores = aAvgTermScores;
+   for(size_t iTerm = 0; iTerm < static_cast<size_t>(cTerms); ++iTerm) {
+      const size_t cTensorScores = acTensorScores[iTerm];
+      SEXP termScores = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cTensorScores)));
+      if(size_t { 0 } != cTensorScores) {
+         memcpy(REAL(termScores), pAvgTermScores, sizeof(double) * cTensorScores);
+      }
+      pAvgTermScores += cTensorScores;
+      SET_VECTOR_ELT(ret, static_cast<R_xlen_t>(iTerm), termScores);
+      UNPROTECT(1);
+   }
+   UNPROTECT(1);
+   return ret;
+}
+
+static size_t CountTermTensorScores(const BoosterCore * const pBoosterCore, const size_t iTerm) {
+   EBM_ASSERT(nullptr != pBoosterCore);
+   EBM_ASSERT(iTerm < pBoosterCore->GetCountTerms());
+
    size_t cTensorScores = pBoosterCore->GetCountScores();
    if(size_t { 0 } != cTensorScores) {
-      const Term * const pTerm = pBoosterCore->GetTerms()[static_cast<size_t>(iTerm)];
+      const Term * const pTerm = pBoosterCore->GetTerms()[iTerm];
       const size_t cDimensions = pTerm->GetCountDimensions();
       if(0 != cDimensions) {
          const TermFeature * pTermFeature = pTerm->GetTermFeatures();
@@ -904,9 +1828,84 @@ SEXP GetBestTermScores_R(SEXP boosterHandleWrapped, SEXP indexTerm) {
             ++pTermFeature;
          } while(pTermFeaturesEnd != pTermFeature);
       }
+   }
+   return cTensorScores;
+}
+
+// returns a list with the best or current scores of every term.  Fetching the whole model in one .Call avoids
+// a round trip through the R interpreter per term, which dominates for models with many small terms.
+static SEXP GetModel(const SEXP boosterHandleWrapped, const bool bBest) {
+   EBM_ASSERT(nullptr != boosterHandleWrapped); // shouldn't be possible
+
+   if(EXTPTRSXP != TYPEOF(boosterHandleWrapped)) {
+      Rf_error("GetModel EXTPTRSXP != TYPEOF(boosterHandleWrapped)");
+   }
+   const BoosterHandle boosterHandle = static_cast<BoosterHandle>(R_ExternalPtrAddr(boosterHandleWrapped));
+   BoosterShell * const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      Rf_error("GetModel nullptr == pBoosterShell");
+   }
+   const BoosterCore * const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   if(IsConvertError<R_xlen_t>(cTerms)) {
+      Rf_error("GetModel IsConvertError<R_xlen_t>(cTerms)");
+   }
+
+   SEXP ret = PROTECT(Rf_allocVector(VECSXP, static_cast<R_xlen_t>(cTerms)));
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const size_t cTensorScores = CountTermTensorScores(pBoosterCore, iTerm);
       if(IsConvertError<R_xlen_t>(cTensorScores)) {
-         Rf_error("GetBestTermScores_R IsConvertError<R_xlen_t>(cTensorScores)");
+         Rf_error("GetModel IsConvertError<R_xlen_t>(cTensorScores)");
+      }
+      SEXP termScores = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cTensorScores)));
+
+      // the booster only gives out copies since its tensors are overwritten as boosting continues and are freed
+      // along with the booster, so we write straight into the R vector instead of copying through a buffer
+      const ErrorEbm err = bBest ? GetBestTermScores(boosterHandle, static_cast<IntEbm>(iTerm), REAL(termScores)) :
+            GetCurrentTermScores(boosterHandle, static_cast<IntEbm>(iTerm), REAL(termScores));
+      if(Error_None != err) {
+         UNPROTECT(2);
+         Rf_error("GetModel GetBestTermScores or GetCurrentTermScores returned error code: %" ErrorEbmPrintf, err);
       }
+      SET_VECTOR_ELT(ret, static_cast<R_xlen_t>(iTerm), termScores);
+      UNPROTECT(1);
+   }
+   UNPROTECT(1);
+   return ret;
+}
+
+SEXP GetBestModel_R(SEXP boosterHandleWrapped) {
+   return GetModel(boosterHandleWrapped, true);
+}
+
+SEXP GetCurrentModel_R(SEXP boosterHandleWrapped) {
+   return GetModel(boosterHandleWrapped, false);
+}
+
+SEXP GetBestTermScores_R(SEXP boosterHandleWrapped, SEXP indexTerm) {
+   EBM_ASSERT(nullptr != boosterHandleWrapped); // shouldn't be possible
+   EBM_ASSERT(nullptr != indexTerm); // shouldn't be possible
+
+   if(EXTPTRSXP != TYPEOF(boosterHandleWrapped)) {
+      Rf_error("GetBestTermScores_R EXTPTRSXP != TYPEOF(boosterHandleWrapped)");
+   }
+   const BoosterHandle boosterHandle = static_cast<BoosterHandle>(R_ExternalPtrAddr(boosterHandleWrapped));
+   BoosterShell * const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      Rf_error("GetBestTermScores_R nullptr == pBoosterShell");
+   }
+   BoosterCore * const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   const IntEbm iTerm = ConvertIndex(indexTerm);
+
+   if(pBoosterCore->GetCountTerms() <= static_cast<size_t>(iTerm)) {
+      Rf_error("GetBestTermScores_R pBoosterCore->GetCountTerms() <= static_cast<size_t>(iTerm)");
+   }
+
+   const size_t cTensorScores = CountTermTensorScores(pBoosterCore, static_cast<size_t>(iTerm));
+   if(IsConvertError<R_xlen_t>(cTensorScores)) {
+      Rf_error("GetBestTermScores_R IsConvertError<R_xlen_t>(cTensorScores)");
    }
    SEXP ret = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cTensorScores)));
    EBM_ASSERT(!IsMultiplyError(sizeof(double), cTensorScores)); // we've allocated this memory, so it should be reachable, so these numbers should multiply
@@ -941,24 +1940,9 @@ SEXP GetCurrentTermScores_R(SEXP boosterHandleWrapped, SEXP indexTerm) {
       Rf_error("GetCurrentTermScores_R pBoosterCore->GetCountTerms() <= static_cast<size_t>(iTerm)");
    }
 
-   size_t cTensorScores = pBoosterCore->GetCountScores();
-   if(ptrdiff_t { 0 } != cTensorScores) {
-      const Term * const pTerm = pBoosterCore->GetTerms()[static_cast<size_t>(iTerm)];
-      const size_t cDimensions = pTerm->GetCountDimensions();
-      if(0 != cDimensions) {
-         const TermFeature * pTermFeature = pTerm->GetTermFeatures();
-         const TermFeature * const pTermFeaturesEnd = &pTermFeature[cDimensions];
-         do {
-            const FeatureBoosting * const pFeature = pTermFeature->m_pFeature;
-            const size_t cBins = pFeature->GetCountBins();
-            EBM_ASSERT(!IsMultiplyError(cTensorScores, cBins)); // we've allocated this memory, so it should be reachable, so these numbers should multiply
-            cTensorScores *= cBins;
-            ++pTermFeature;
-         } while(pTermFeaturesEnd != pTermFeature);
-      }
-      if(IsConvertError<R_xlen_t>(cTensorScores)) {
-         Rf_error("GetCurrentTermScores_R IsConvertError<R_xlen_t>(cTensorScores)");
-      }
+   const size_t cTensorScores = CountTermTensorScores(pBoosterCore, static_cast<size_t>(iTerm));
+   if(IsConvertError<R_xlen_t>(cTensorScores)) {
+      Rf_error("GetCurrentTermScores_R IsConvertError<R_xlen_t>(cTensorScores)");
    }
    SEXP ret = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cTensorScores)));
    EBM_ASSERT(!IsMultiplyError(sizeof(double), cTensorScores)); // we've allocated this memory, so it should be reachable, so these numbers should multiply
@@ -973,6 +1957,281 @@ SEXP GetCurrentTermScores_R(SEXP boosterHandleWrapped, SEXP indexTerm) {
    return ret;
 }
 
+SEXP GetSampleScores_R(SEXP boosterHandleWrapped, SEXP direction) {
+   EBM_ASSERT(nullptr != boosterHandleWrapped); // shouldn't be possible
+   EBM_ASSERT(nullptr != direction); // shouldn't be possible
+
+   if(EXTPTRSXP != TYPEOF(boosterHandleWrapped)) {
+      Rf_error("GetSampleScores_R EXTPTRSXP != TYPEOF(boosterHandleWrapped)");
+   }
+   const BoosterHandle boosterHandle = static_cast<BoosterHandle>(R_ExternalPtrAddr(boosterHandleWrapped));
+   BoosterShell * const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      Rf_error("GetSampleScores_R nullptr == pBoosterShell");
+   }
+   BoosterCore * const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   const IntEbm iDirection = ConvertInt(direction);
+   if(IntEbm { 1 } != iDirection && IntEbm { -1 } != iDirection) {
+      Rf_error("GetSampleScores_R direction must be 1 or -1");
+   }
+   const bool isLoopValidation = iDirection < IntEbm { 0 };
+
+   // the booster keeps each replicated sample once per replication, so we count the distinct samples from the bag
+   const DataSetBoosting * const pDataSet =
+      isLoopValidation ? pBoosterCore->GetValidationSet() : pBoosterCore->GetTrainingSet();
+   size_t cReplicated = pDataSet->GetCountSamples();
+   size_t cSamples = cReplicated;
+   const BagEbm * pSampleReplication = pBoosterCore->GetPreparedTrainingData()->GetBag();
+   if(nullptr != pSampleReplication) {
+      cSamples = 0;
+      while(size_t { 0 } != cReplicated) {
+         const BagEbm replication = *pSampleReplication;
+         ++pSampleReplication;
+         if(BagEbm { 0 } != replication && isLoopValidation == (replication < BagEbm { 0 })) {
+            cReplicated -= static_cast<size_t>(isLoopValidation ? -replication : replication);
+            ++cSamples;
+         }
+      }
+   }
+
+   const size_t cScores = pBoosterCore->GetCountScores();
+   if(IsMultiplyError(cScores, cSamples) || IsConvertError<R_xlen_t>(cScores * cSamples)) {
+      Rf_error("GetSampleScores_R IsConvertError<R_xlen_t>(cScores * cSamples)");
+   }
+   SEXP ret = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cScores * cSamples)));
+
+   const ErrorEbm err = GetSampleScores(boosterHandle, static_cast<BagEbm>(iDirection), REAL(ret));
+
+   UNPROTECT(1);
+
+   if(Error_None != err) {
+      Rf_error("GetSampleScores returned error code: %" ErrorEbmPrintf, err);
+   }
+   return ret;
+}
+
+// makes a logit Predictor whose terms are the mains of the cColumns features, in column order. The caller allocates
+// its R results before calling this so that an R allocation error cannot leak the predictor
+static PredictorHandle CreateMainsPredictor(
+   const char * const sFunction,
+   const IntEbm cColumns,
+   SEXP cutsLowerBoundInclusive,
+   SEXP termScores
+) {
+   if(VECSXP != TYPEOF(cutsLowerBoundInclusive)) {
+      Rf_error("%s VECSXP != TYPEOF(cutsLowerBoundInclusive)", sFunction);
+   }
+   if(static_cast<R_xlen_t>(cColumns) != Rf_xlength(cutsLowerBoundInclusive)) {
+      Rf_error("%s cColumns != Rf_xlength(cutsLowerBoundInclusive)", sFunction);
+   }
+   if(VECSXP != TYPEOF(termScores)) {
+      Rf_error("%s VECSXP != TYPEOF(termScores)", sFunction);
+   }
+   if(static_cast<R_xlen_t>(cColumns) != Rf_xlength(termScores)) {
+      Rf_error("%s cColumns != Rf_xlength(termScores)", sFunction);
+   }
+
+   IntEbm * const acCuts = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != acCuts); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   IntEbm * const acBins = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != acBins); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   // each main is a term with a single dimension, so the dimension counts are all 1 and the features are in order
+   IntEbm * const acDimensions = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != acDimensions); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   IntEbm * const aiFeatures = reinterpret_cast<IntEbm *>(
+      R_alloc(static_cast<size_t>(cColumns), static_cast<int>(sizeof(IntEbm))));
+   EBM_ASSERT(nullptr != aiFeatures); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   size_t cCutsTotal = 0;
+   size_t cScoresTotal = 0;
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      const IntEbm cCuts = CountDoubles(VECTOR_ELT(cutsLowerBoundInclusive, static_cast<R_xlen_t>(iColumn)));
+      acCuts[iColumn] = cCuts;
+      if(IsAddError(cCutsTotal, static_cast<size_t>(cCuts))) {
+         Rf_error("%s IsAddError(cCutsTotal, static_cast<size_t>(cCuts))", sFunction);
+      }
+      cCutsTotal += static_cast<size_t>(cCuts);
+
+      // the term scores hold the missing bin, the regular bins, and the unknown bin
+      const IntEbm cBins = CountDoubles(VECTOR_ELT(termScores, static_cast<R_xlen_t>(iColumn)));
+      acBins[iColumn] = cBins;
+      if(IsAddError(cScoresTotal, static_cast<size_t>(cBins))) {
+         Rf_error("%s IsAddError(cScoresTotal, static_cast<size_t>(cBins))", sFunction);
+      }
+      cScoresTotal += static_cast<size_t>(cBins);
+
+      acDimensions[iColumn] = IntEbm { 1 };
+      aiFeatures[iColumn] = static_cast<IntEbm>(iColumn);
+   }
+
+   double * const aCutsLowerBoundInclusive = reinterpret_cast<double *>(
+      R_alloc(cCutsTotal, static_cast<int>(sizeof(double))));
+   EBM_ASSERT(nullptr != aCutsLowerBoundInclusive); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   double * const aTermScores = reinterpret_cast<double *>(
+      R_alloc(cScoresTotal, static_cast<int>(sizeof(double))));
+   EBM_ASSERT(nullptr != aTermScores); // R_alloc doesn't return nullptr, so we don't need to check aItems
+
+   double * pCutsLowerBoundInclusive = aCutsLowerBoundInclusive;
+   double * pTermScores = aTermScores;
+   for(size_t iColumn = 0; iColumn < static_cast<size_t>(cColumns); ++iColumn) {
+      const size_t cCuts = static_cast<size_t>(acCuts[iColumn]);
+      if(size_t { 0 } != cCuts) {
+         memcpy(pCutsLowerBoundInclusive,
+            REAL(VECTOR_ELT(cutsLowerBoundInclusive, static_cast<R_xlen_t>(iColumn))),
+            sizeof(double) * cCuts);
+         pCutsLowerBoundInclusive += cCuts;
+      }
+      const size_t cBins = static_cast<size_t>(acBins[iColumn]);
+      if(size_t { 0 } != cBins) {
+         memcpy(pTermScores, REAL(VECTOR_ELT(termScores, static_cast<R_xlen_t>(iColumn))), sizeof(double) * cBins);
+         pTermScores += cBins;
+      }
+   }
+
+   // the R package only supports binary classification for now, which has a single logit score
+   PredictorHandle predictorHandle = nullptr;
+   const ErrorEbm err = CreatePredictor(
+      Link_logit,
+      0.0,
+      IntEbm { 1 },
+      nullptr,
+      cColumns,
+      acBins,
+      acCuts,
+      aCutsLowerBoundInclusive,
+      cColumns,
+      acDimensions,
+      aiFeatures,
+      aTermScores,
+      &predictorHandle
+   );
+   if(Error_None != err) {
+      Rf_error("CreatePredictor returned error code: %" ErrorEbmPrintf, err);
+   }
+   return predictorHandle;
+}
+
+SEXP PredictMains_R(SEXP featureVals, SEXP countColumns, SEXP cutsLowerBoundInclusive, SEXP termScores) {
+   EBM_ASSERT(nullptr != featureVals);
+   EBM_ASSERT(nullptr != countColumns);
+   EBM_ASSERT(nullptr != cutsLowerBoundInclusive);
+   EBM_ASSERT(nullptr != termScores);
+
+   const IntEbm countVals = CountDoubles(featureVals);
+   const double * const aFeatureVals = REAL(featureVals);
+
+   const IntEbm cColumns = ConvertIndex(countColumns);
+   if(IntEbm { 0 } == cColumns) {
+      Rf_error("PredictMains_R IntEbm { 0 } == cColumns");
+   }
+   if(0 != countVals % cColumns) {
+      Rf_error("PredictMains_R featureVals is not a multiple of countColumns");
+   }
+   const IntEbm countSamples = countVals / cColumns;
+
+   // allocate the result before the predictor so that an R allocation error cannot leak it
+   SEXP ret = PROTECT(Rf_allocVector(REALSXP, static_cast<R_xlen_t>(countSamples)));
+
+   const PredictorHandle predictorHandle =
+      CreateMainsPredictor("PredictMains_R", cColumns, cutsLowerBoundInclusive, termScores);
+
+   const ErrorEbm err = Predict(predictorHandle, countSamples, aFeatureVals, EBM_FALSE, REAL(ret));
+   FreePredictor(predictorHandle);
+
+   UNPROTECT(1);
+
+   if(Error_None != err) {
+      Rf_error("Predict returned error code: %" ErrorEbmPrintf, err);
+   }
+   return ret;
+}
+
+SEXP PredictMainsContributions_R(
+   SEXP featureVals,
+   SEXP countColumns,
+   SEXP cutsLowerBoundInclusive,
+   SEXP termScores,
+   SEXP countTop
+) {
+   EBM_ASSERT(nullptr != featureVals);
+   EBM_ASSERT(nullptr != countColumns);
+   EBM_ASSERT(nullptr != cutsLowerBoundInclusive);
+   EBM_ASSERT(nullptr != termScores);
+   EBM_ASSERT(nullptr != countTop);
+
+   const IntEbm countVals = CountDoubles(featureVals);
+   const double * const aFeatureVals = REAL(featureVals);
+
+   const IntEbm cColumns = ConvertIndex(countColumns);
+   if(IntEbm { 0 } == cColumns) {
+      Rf_error("PredictMainsContributions_R IntEbm { 0 } == cColumns");
+   }
+   if(0 != countVals % cColumns) {
+      Rf_error("PredictMainsContributions_R featureVals is not a multiple of countColumns");
+   }
+   const IntEbm countSamples = countVals / cColumns;
+
+   const IntEbm cTop = ConvertIndex(countTop);
+   if(cColumns < cTop) {
+      Rf_error("PredictMainsContributions_R countColumns < countTop");
+   }
+   // each main is one term, so without a top count there is one contribution per sample and column
+   const size_t cTermsOut = static_cast<size_t>(IntEbm { 0 } == cTop ? cColumns : cTop);
+   if(IsMultiplyError(static_cast<size_t>(countSamples), cTermsOut) ||
+      IsConvertError<R_xlen_t>(static_cast<size_t>(countSamples) * cTermsOut)) {
+      Rf_error("PredictMainsContributions_R IsMultiplyError(countSamples, cTermsOut)");
+   }
+   const size_t cContributions = static_cast<size_t>(countSamples) * cTermsOut;
+
+   // the list holds the contributions of each sample in row order, followed by the 1-based term of each
+   // contribution when countTop is not zero. Allocate them before the predictor so that R cannot leak it
+   SEXP ret = PROTECT(Rf_allocVector(VECSXP, R_xlen_t { 2 }));
+   SET_VECTOR_ELT(ret, 0, Rf_allocVector(REALSXP, static_cast<R_xlen_t>(cContributions)));
+   SET_VECTOR_ELT(ret, 1,
+      Rf_allocVector(REALSXP, IntEbm { 0 } == cTop ? R_xlen_t { 0 } : static_cast<R_xlen_t>(cContributions)));
+
+   IntEbm * aTermIndexes = nullptr;
+   if(IntEbm { 0 } != cTop) {
+      aTermIndexes = reinterpret_cast<IntEbm *>(R_alloc(cContributions, static_cast<int>(sizeof(IntEbm))));
+      EBM_ASSERT(nullptr != aTermIndexes); // R_alloc doesn't return nullptr, so we don't need to check aItems
+   }
+
+   const PredictorHandle predictorHandle =
+      CreateMainsPredictor("PredictMainsContributions_R", cColumns, cutsLowerBoundInclusive, termScores);
+
+   const ErrorEbm err = PredictContributions(predictorHandle,
+      countSamples,
+      aFeatureVals,
+      cTop,
+      nullptr,
+      REAL(VECTOR_ELT(ret, 0)),
+      aTermIndexes);
+   FreePredictor(predictorHandle);
+
+   if(Error_None != err) {
+      UNPROTECT(1);
+      Rf_error("PredictContributions returned error code: %" ErrorEbmPrintf, err);
+   }
+
+   if(nullptr != aTermIndexes) {
+      double * const aTermsOut = REAL(VECTOR_ELT(ret, 1));
+      for(size_t iContribution = 0; iContribution < cContributions; ++iContribution) {
+         aTermsOut[iContribution] = static_cast<double>(aTermIndexes[iContribution] + IntEbm { 1 });
+      }
+   }
+
+   UNPROTECT(1);
+   return ret;
+}
+
 SEXP CreateInteractionDetector_R(SEXP dataSetWrapped, SEXP bag, SEXP initScores) {
    EBM_ASSERT(nullptr != dataSetWrapped);
    EBM_ASSERT(nullptr != bag);
@@ -1045,6 +2304,7 @@ SEXP CreateInteractionDetector_R(SEXP dataSetWrapped, SEXP bag, SEXP initScores)
       AccelerationFlags_ALL,
       "log_loss",
       nullptr,
+      nullptr,
       &interactionHandle
    );
    if(Error_None != err || nullptr == interactionHandle) {
@@ -1112,22 +2372,36 @@ SEXP CalcInteractionStrength_R(SEXP interactionHandleWrapped, SEXP featureIndexe
 static const R_CallMethodDef g_exposedFunctions[] = {
    { "CreateRNG_R", (DL_FUNC)&CreateRNG_R, 1 },
    { "CutQuantile_R", (DL_FUNC)&CutQuantile_R, 4 },
+   { "CutQuantileBatch_R", (DL_FUNC)&CutQuantileBatch_R, 5 },
    { "Discretize_R", (DL_FUNC)&Discretize_R, 3 },
+   { "DiscretizeBatch_R", (DL_FUNC)&DiscretizeBatch_R, 3 },
    { "MeasureDataSetHeader_R", (DL_FUNC)&MeasureDataSetHeader_R, 3 },
    { "MeasureFeature_R", (DL_FUNC)&MeasureFeature_R, 5 },
+   { "MeasureFeatureExternal_R", (DL_FUNC)&MeasureFeatureExternal_R, 8 },
    { "MeasureClassificationTarget_R", (DL_FUNC)&MeasureClassificationTarget_R, 2 },
    { "CreateDataSet_R", (DL_FUNC)&CreateDataSet_R, 1 },
    { "FreeDataSet_R", (DL_FUNC)&FreeDataSet_R, 1 },
    { "FillDataSetHeader_R", (DL_FUNC)&FillDataSetHeader_R, 5 },
    { "FillFeature_R", (DL_FUNC)&FillFeature_R, 7 },
+   { "FillFeatureExternal_R", (DL_FUNC)&FillFeatureExternal_R, 10 },
    { "FillClassificationTarget_R", (DL_FUNC)&FillClassificationTarget_R, 4 },
+   { "MakeDataSet_R", (DL_FUNC)&MakeDataSet_R, 7 },
    { "SampleWithoutReplacement_R", (DL_FUNC)&SampleWithoutReplacement_R, 4 },
+   { "GenerateBags_R", (DL_FUNC)&GenerateBags_R, 5 },
    { "CreateBooster_R", (DL_FUNC)&CreateBooster_R, 7 },
    { "FreeBooster_R", (DL_FUNC)&FreeBooster_R, 1 },
    { "GenerateTermUpdate_R", (DL_FUNC)&GenerateTermUpdate_R, 6 },
    { "ApplyTermUpdate_R", (DL_FUNC)&ApplyTermUpdate_R, 1 },
+   { "ApplyTermUpdateAndBinNext_R", (DL_FUNC)&ApplyTermUpdateAndBinNext_R, 2 },
+   { "BoostCyclic_R", (DL_FUNC)&BoostCyclic_R, 8 },
+   { "BoostOuterBags_R", (DL_FUNC)&BoostOuterBags_R, 14 },
    { "GetBestTermScores_R", (DL_FUNC)&GetBestTermScores_R, 2 },
    { "GetCurrentTermScores_R", (DL_FUNC)&GetCurrentTermScores_R, 2 },
+   { "GetSampleScores_R", (DL_FUNC)&GetSampleScores_R, 2 },
+   { "GetBestModel_R", (DL_FUNC)&GetBestModel_R, 1 },
+   { "GetCurrentModel_R", (DL_FUNC)&GetCurrentModel_R, 1 },
+   { "PredictMains_R", (DL_FUNC)&PredictMains_R, 4 },
+   { "PredictMainsContributions_R", (DL_FUNC)&PredictMainsContributions_R, 5 },
    { "CreateInteractionDetector_R", (DL_FUNC)&CreateInteractionDetector_R, 3 },
    { "FreeInteractionDetector_R", (DL_FUNC)&FreeInteractionDetector_R, 1 },
    { "CalcInteractionStrength_R", (DL_FUNC)&CalcInteractionStrength_R, 4 },
@@ -13,10 +13,13 @@
 #define ZONE_main
 #include "zones.h"
 
+#include "Bin.hpp"
 #include "Feature.hpp"
 #include "Term.hpp"
 #include "Transpose.hpp"
 #include "Tensor.hpp"
+#include "ThreadPool.hpp"
+#include "Profile.hpp"
 #include "BoosterCore.hpp"
 #include "BoosterShell.hpp"
 
@@ -31,31 +34,447 @@ namespace DEFINED_ZONE_NAME {
 // then we'll output this log message more times than desired, but we can live with that
 static int g_cLogApplyTermUpdate = 10;
 
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
-      BoosterHandle boosterHandle, double* avgValidationMetricOut) {
+extern ErrorEbm BinSumsBoostingSubset(BoosterCore* const pBoosterCore,
+      const size_t iTerm,
+      const size_t iBag,
+      const size_t cTensorBins,
+      DataSubsetBoosting* const pSubset,
+      BinBase* const aFastBins,
+      const GradientSamples* const pGradientSamples);
+
+extern void AddFastBinsToMainBins(BoosterCore* const pBoosterCore,
+      const size_t iTerm,
+      const size_t iBag,
+      const size_t cTensorBins,
+      const DataSubsetBoosting* const pSubset,
+      const bool bLastSubset,
+      const BinBase* const aFastBins,
+      BinBase* const aMainBins);
+
+extern ErrorEbm ApplyUpdateCompressed(
+      DataSubsetBoosting* const pSubset, ApplyUpdateBridge* const pData, void* const aGradHessTemp) {
+   // The objective writes the gradients of each chunk into aGradHessTemp in the zone's float type and we round them
+   // to bfloat16 in the subset's storage. The bit packs hold the partial pack at the start, so the first chunk takes
+   // the remainder and every chunk after it is a whole number of packs that starts on a pack boundary.
+   EBM_ASSERT(nullptr != pSubset);
+   EBM_ASSERT(nullptr != pData);
+   EBM_ASSERT(nullptr != aGradHessTemp);
+   EBM_ASSERT(EBM_FALSE == pData->m_bValidation);
+
+   const ObjectiveWrapper* const pObjective = pSubset->GetObjectiveWrapper();
+   const size_t cSIMDPack = pObjective->m_cSIMDPack;
+   const size_t cFloatBytes = pObjective->m_cFloatBytes;
+   const size_t cItemsPerBitPack =
+         k_cItemsPerBitPackUndefined == pData->m_cPack ? size_t{1} : static_cast<size_t>(pData->m_cPack);
+   const size_t cFloatsPerItem =
+         cSIMDPack * (EBM_FALSE != pData->m_bHessianNeeded ? size_t{2} : size_t{1}) * pData->m_cScores;
+   const size_t cChunkItems = GetGradHessChunkItems(cFloatBytes * cFloatsPerItem, cItemsPerBitPack);
+   const size_t cBytesTarget = pObjective->m_cTargetBytes;
+   EBM_ASSERT(0 == pData->m_cSamples % cSIMDPack);
+   const size_t cItems = pData->m_cSamples / cSIMDPack;
+   EBM_ASSERT(1 <= cItems);
+   Bfloat16* const aGradHess = static_cast<Bfloat16*>(pData->m_aGradientsAndHessians);
+
+   size_t iItem = 0;
+   size_t cChunkItemsCur = cItems - (cItems - size_t{1}) / cChunkItems * cChunkItems;
+   do {
+      ApplyUpdateBridge data = *pData;
+      data.m_cSamples = cChunkItemsCur * cSIMDPack;
+      data.m_aTargets = IndexByte(pData->m_aTargets, cBytesTarget * cSIMDPack * iItem);
+      data.m_aSampleScores = IndexByte(pData->m_aSampleScores, cFloatBytes * pData->m_cScores * cSIMDPack * iItem);
+      data.m_aGradientsAndHessians = aGradHessTemp;
+      if(nullptr != pData->m_aWeights) {
+         // the out of bag weights, whose metric is summed over the chunks
+         data.m_aWeights = IndexByte(pData->m_aWeights, cFloatBytes * cSIMDPack * iItem);
+         data.m_metricOut = 0.0;
+      }
+      if(nullptr != pData->m_aPacked) {
+         data.m_aPacked =
+               IndexByte(pData->m_aPacked, pObjective->m_cUIntBytes * cSIMDPack * (iItem / cItemsPerBitPack));
+      }
+      const ErrorEbm error = pSubset->ObjectiveApplyUpdate(&data);
+      if(Error_None != error) {
+         return error;
+      }
+      if(nullptr != pData->m_aWeights) {
+         pData->m_metricOut += data.m_metricOut;
+      }
+      CompressGradHess(
+            cFloatsPerItem * cChunkItemsCur, cFloatBytes, aGradHessTemp, &aGradHess[cFloatsPerItem * iItem]);
+
+      iItem += cChunkItemsCur;
+      cChunkItemsCur = cChunkItems;
+   } while(cItems != iItem);
+   return Error_None;
+}
+
+// The histograms of the validation subsets are merged in subset order and swept from the lowest score upwards. Each
+// positive outranks the negatives in the buckets below it and ties with the negatives in its own bucket.
+static double CalcAucFromBins(const size_t cValidationSubsets, const double* const aAucBins) {
+   EBM_ASSERT(1 <= cValidationSubsets);
+   EBM_ASSERT(nullptr != aAucBins);
+
+   double sumNegativeBelow = 0.0;
+   double sumPositive = 0.0;
+   double sumPairs = 0.0;
+   for(size_t iBin = 0; iBin < size_t{AUC_BINS_COUNT}; ++iBin) {
+      double negative = 0.0;
+      double positive = 0.0;
+      const double* pBin = &aAucBins[size_t{2} * iBin];
+      for(size_t iSubset = 0; iSubset < cValidationSubsets; ++iSubset) {
+         negative += pBin[0];
+         positive += pBin[1];
+         pBin += size_t{2} * size_t{AUC_BINS_COUNT};
+      }
+      sumPairs += positive * (sumNegativeBelow + 0.5 * negative);
+      sumNegativeBelow += negative;
+      sumPositive += positive;
+   }
+   const double totalPairs = sumNegativeBelow * sumPositive;
+   if(!(0.0 < totalPairs)) {
+      // AUC is undefined unless the validation set has both classes, so report a chance level ranking
+      return 0.5;
+   }
+   return sumPairs / totalPairs;
+}
+
+// the multi-term score kernel adds every term to this many items before moving on, so the items' scores stay in L1
+// while the terms are added to them
+static constexpr size_t k_cScoreBlockItems = 256;
+
+template<typename TScore, typename TUpdate>
+static void AddTermsToItems(const DataSubsetBoosting* const pSubset,
+      const size_t cScores,
+      const size_t cTerms,
+      const size_t* const aiTerms,
+      const TUpdate* const* const aaUpdateScores,
+      const size_t iItemFirst,
+      const size_t cItems,
+      TScore* const aScores) {
+   // Adds the tensors of several terms to the scores of the items [iItemFirst, iItemFirst + cItems) of a subset
+   // without computing gradients or metrics. aScores holds the scores of item iItemFirst onwards. The bin of each
+   // sample is decoded from the SIMD ordered bit packs like BinGradientSamples does, where the first pack of each
+   // lane holds the remainder of the items.
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(nullptr != aScores);
+
+   const ObjectiveWrapper* const pObjective = pSubset->GetObjectiveWrapper();
+   const size_t cSIMDPack = pObjective->m_cSIMDPack;
+   const size_t cUIntBytes = pObjective->m_cUIntBytes;
+   const size_t cSubsetSamples = pSubset->GetCountSamples();
+   EBM_ASSERT(1 <= cSIMDPack);
+   EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
+   EBM_ASSERT(iItemFirst + cItems <= cSubsetSamples / cSIMDPack);
+
+   for(size_t iBlock = 0; iBlock < cItems; iBlock += k_cScoreBlockItems) {
+      const size_t cBlockItems = EbmMin(k_cScoreBlockItems, cItems - iBlock);
+      TScore* const aBlockScores = aScores + cScores * cSIMDPack * iBlock;
+
+      for(size_t iTermLoop = 0; iTermLoop < cTerms; ++iTermLoop) {
+         const size_t iTerm = aiTerms[iTermLoop];
+         const TUpdate* const aUpdateScores = aaUpdateScores[iTermLoop];
+         EBM_ASSERT(nullptr != aUpdateScores);
+         const void* const aPacked = pSubset->GetTermData(iTerm);
+
+         size_t cItemsPerBitPack = 1;
+         int cBitsPerItem = 0;
+         size_t maskBits = 0;
+         size_t iItemShift = 0;
+         if(nullptr != aPacked) {
+            const int cPack = pSubset->GetTermPack(iTerm);
+            EBM_ASSERT(1 <= cPack);
+            cItemsPerBitPack = static_cast<size_t>(cPack);
+            cBitsPerItem = GetCountBits(cPack, cUIntBytes);
+            if(sizeof(UIntBig) == cUIntBytes) {
+               maskBits = static_cast<size_t>(MakeLowMask<UIntBig>(cBitsPerItem));
+            } else {
+               EBM_ASSERT(sizeof(UIntSmall) == cUIntBytes);
+               maskBits = static_cast<size_t>(MakeLowMask<UIntSmall>(cBitsPerItem));
+            }
+            iItemShift = cItemsPerBitPack - size_t{1} - cSubsetSamples / cSIMDPack % cItemsPerBitPack;
+         }
+
+         TScore* pScores = aBlockScores;
+         const size_t iItemBlockFirst = iItemFirst + iBlock;
+         for(size_t iItem = iItemBlockFirst; iItem < iItemBlockFirst + cBlockItems; ++iItem) {
+            size_t iPacked = 0;
+            int cShift = 0;
+            if(nullptr != aPacked) {
+               const size_t iItemShifted = iItem + iItemShift;
+               iPacked = iItemShifted / cItemsPerBitPack * cSIMDPack;
+               cShift =
+                     static_cast<int>(cItemsPerBitPack - size_t{1} - iItemShifted % cItemsPerBitPack) * cBitsPerItem;
+            }
+            for(size_t iLane = 0; iLane < cSIMDPack; ++iLane) {
+               size_t iTensor = 0;
+               if(nullptr != aPacked) {
+                  if(sizeof(UIntBig) == cUIntBytes) {
+                     iTensor = maskBits &
+                           static_cast<size_t>(static_cast<const UIntBig*>(aPacked)[iPacked + iLane] >> cShift);
+                  } else {
+                     iTensor = maskBits &
+                           static_cast<size_t>(static_cast<const UIntSmall*>(aPacked)[iPacked + iLane] >> cShift);
+                  }
+               }
+               const TUpdate* const aUpdate = &aUpdateScores[iTensor * cScores];
+               // the scores are interleaved in SIMD packs, one pack per score
+               for(size_t iScore = 0; iScore < cScores; ++iScore) {
+                  pScores[iScore * cSIMDPack + iLane] += static_cast<TScore>(aUpdate[iScore]);
+               }
+            }
+            pScores += cScores * cSIMDPack;
+         }
+      }
+   }
+}
+
+extern void AddTermsToSubsetScores(const DataSubsetBoosting* const pSubset,
+      const size_t cScores,
+      const size_t cTerms,
+      const size_t* const aiTerms,
+      const FloatScore* const* const aaTermScores,
+      const size_t iItemFirst,
+      const size_t cItems,
+      double* const aScores) {
+   AddTermsToItems<double, FloatScore>(pSubset, cScores, cTerms, aiTerms, aaTermScores, iItemFirst, cItems, aScores);
+}
+
+static void AddFusedUpdatesToSubset(BoosterCore* const pBoosterCore,
+      DataSubsetBoosting* const pSubset,
+      const size_t cTermsFused,
+      const size_t* const aiTermsFused,
+      FloatScore* const* const aaUpdateScoresFused) {
+   // The fused updates only move the scores. The objective then adds the last update and computes the gradients or
+   // the metric once from the combined scores. RMSE holds the residuals in the gradients instead of the scores, and
+   // a score update moves the residual by the same amount.
+   const ObjectiveWrapper* const pObjective = pSubset->GetObjectiveWrapper();
+   const size_t cScores = pBoosterCore->GetCountScores();
+   const bool bRmse = pBoosterCore->IsRmse();
+   EBM_ASSERT(!bRmse || !pBoosterCore->IsHessian());
+   EBM_ASSERT(!bRmse || !pBoosterCore->IsCompressGradients());
+   void* const aScores = bRmse ? pSubset->GetGradHess() : pSubset->GetSampleScores();
+   const size_t cItems = pSubset->GetCountSamples() / pObjective->m_cSIMDPack;
+   // the updates were already converted to the subset's float type
+   if(sizeof(FloatBig) == pObjective->m_cFloatBytes) {
+      AddTermsToItems<FloatBig, FloatBig>(pSubset,
+            cScores,
+            cTermsFused,
+            aiTermsFused,
+            reinterpret_cast<const FloatBig* const*>(aaUpdateScoresFused),
+            size_t{0},
+            cItems,
+            static_cast<FloatBig*>(aScores));
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == pObjective->m_cFloatBytes);
+      AddTermsToItems<FloatSmall, FloatSmall>(pSubset,
+            cScores,
+            cTermsFused,
+            aiTermsFused,
+            reinterpret_cast<const FloatSmall* const*>(aaUpdateScoresFused),
+            size_t{0},
+            cItems,
+            static_cast<FloatSmall*>(aScores));
+   }
+}
+
+static void ConvertUpdateToSmall(const size_t cFloats, FloatScore* const aUpdateScores) {
+   // these need to be void * to avoid breaking the C++ aliasing rules
+   void* pUpdateSmall = aUpdateScores;
+   void* pUpdateBig = aUpdateScores;
+   const void* const pUpdateBigEnd = IndexByte(reinterpret_cast<void*>(aUpdateScores), sizeof(FloatBig) * cFloats);
+   do {
+      *reinterpret_cast<FloatSmall*>(pUpdateSmall) = static_cast<FloatSmall>(*reinterpret_cast<FloatBig*>(pUpdateBig));
+      pUpdateBig = IndexByte(pUpdateBig, sizeof(FloatBig));
+      pUpdateSmall = IndexByte(pUpdateSmall, sizeof(FloatSmall));
+   } while(pUpdateBigEnd != pUpdateBig);
+}
+
+// turns the summed metrics of the validation subsets into the average metric that our callers minimize, and keeps
+// the current model as the best one if it is at least as good as the best so far
+static ErrorEbm FinishValidation(BoosterShell* const pBoosterShell,
+      const size_t cValidationSubsets,
+      const double* const aAucBins,
+      double* const pValidationMetricAvg) {
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   double validationMetricAvg = *pValidationMetricAvg;
+
+   if(nullptr != aAucBins) {
+      // the log loss was still summed in the same pass, but AUC is the early stopping metric that was asked for.
+      // Negate it since our callers minimize
+      validationMetricAvg = -CalcAucFromBins(cValidationSubsets, aAucBins);
+   } else if(0 != pBoosterCore->GetValidationSet()->GetCountSamples() || pBoosterCore->IsOutOfBagMetric()) {
+      validationMetricAvg = pBoosterCore->FinishMetric(validationMetricAvg);
+
+      if(EBM_FALSE != pBoosterCore->MaximizeMetric()) {
+         // make it so that we always return values such that the caller wants to minimize them. If the caller
+         // wants more information they can determine if they should negate the values we return them.
+         validationMetricAvg = -validationMetricAvg;
+      }
+
+      EBM_ASSERT(!std::isnan(validationMetricAvg)); // NaNs can happen, but we should have cleaned them up
+
+      // the out of bag metric was summed in the training pass over the samples that no inner bag draws
+      const double totalWeight = pBoosterCore->IsOutOfBagMetric() ?
+            pBoosterCore->GetTrainingSet()->GetOutOfBagWeightTotal() :
+            pBoosterCore->GetValidationSet()->GetBagWeightTotal(0);
+      EBM_ASSERT(!std::isnan(totalWeight));
+      EBM_ASSERT(!std::isinf(totalWeight));
+      EBM_ASSERT(0.0 < totalWeight);
+      validationMetricAvg /= totalWeight; // if totalWeight < 1.0 then this can overflow to +inf
+
+      EBM_ASSERT(!std::isnan(validationMetricAvg)); // NaNs can happen, but we should have cleaned them up
+   }
+
+   if(LIKELY(validationMetricAvg <= pBoosterCore->GetBestModelMetric())) {
+      pBoosterCore->SetBestModelMetric(validationMetricAvg);
+
+      const ErrorEbm error = pBoosterCore->UpdateBestModel();
+      if(Error_None != error) {
+         LOG_0(Trace_Verbose, "Exited FinishValidation with memory allocation error in copy");
+         return error;
+      }
+   }
+
+   *pValidationMetricAvg = validationMetricAvg;
+   return Error_None;
+}
+
+// applies every update that SetValidationBatch held back to the validation set in one pass. The last pending term
+// goes through the objective, which computes the metric from the combined scores, and the others are fused into it
+static ErrorEbm ApplyValidationPending(BoosterShell* const pBoosterShell, double* const pValidationMetricAvg) {
    ErrorEbm error;
 
-   LOG_COUNTED_N(&g_cLogApplyTermUpdate,
-         Trace_Info,
-         Trace_Verbose,
-         "ApplyTermUpdate: "
-         "boosterHandle=%p, "
-         "avgValidationMetricOut=%p",
-         static_cast<void*>(boosterHandle),
-         static_cast<void*>(avgValidationMetricOut));
+   *pValidationMetricAvg = std::numeric_limits<double>::infinity();
 
-   if(LIKELY(nullptr != avgValidationMetricOut)) {
-      // returning +inf means that boosting won't consider this to be an improvement.  After a few cycles
-      // it should exit with the last model that was good if the error was ignored (it shouldn't be ignored though)
-      *avgValidationMetricOut = std::numeric_limits<double>::infinity();
+   const size_t cPending = pBoosterShell->GetCountValidationPending();
+   if(size_t{0} == cPending) {
+      return Error_None;
    }
 
-   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
-   if(nullptr == pBoosterShell) {
-      // already logged
-      return Error_IllegalParamVal;
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   EBM_ASSERT(0 != pBoosterCore->GetValidationSet()->GetCountSamples());
+   const size_t cValidationSubsets = pBoosterCore->GetValidationSet()->GetCountSubsets();
+   DataSubsetBoosting* const aValidationSubsets = pBoosterCore->GetValidationSet()->GetSubsets();
+   double* const aValidationMetrics = pBoosterShell->GetValidationMetrics();
+   EBM_ASSERT(nullptr != aValidationMetrics);
+   double* const aAucBins = pBoosterShell->GetAucBins();
+   if(nullptr != aAucBins) {
+      memset(aAucBins, 0, sizeof(*aAucBins) * size_t{2} * size_t{AUC_BINS_COUNT} * cValidationSubsets);
+   }
+
+   const size_t cTermsFused = cPending - size_t{1};
+   const size_t* const aiTermsFused = pBoosterShell->GetValidationPendingTerms();
+   FloatScore* const* const aaUpdateScoresFused = pBoosterShell->GetValidationPendingUpdates();
+   const size_t iTerm = aiTermsFused[cTermsFused];
+   FloatScore* const aUpdateScores = aaUpdateScoresFused[cTermsFused];
+   const Term* const pTerm = pBoosterCore->GetTerms()[iTerm];
+
+   size_t cFloatSize = sizeof(aUpdateScores[0]);
+
+   auto applySubset = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      DataSubsetBoosting* const pSubset = &aValidationSubsets[iTask];
+      if(pSubset->GetObjectiveWrapper()->m_cFloatBytes != cFloatSize) {
+         return Error_None;
+      }
+
+      if(size_t{0} != cTermsFused) {
+         AddFusedUpdatesToSubset(pBoosterCore, pSubset, cTermsFused, aiTermsFused, aaUpdateScoresFused);
+      }
+
+      ApplyUpdateBridge data;
+      data.m_cScores = pBoosterCore->GetCountScores();
+      data.m_cPack = pSubset->GetTermPack(iTerm);
+      data.m_bHessianNeeded = EBM_FALSE;
+      data.m_bUseApprox = pBoosterCore->IsUseApprox();
+      data.m_bValidation = EBM_TRUE;
+      void* const aMulticlassMidwayTemp = pBoosterShell->GetMulticlassMidwayTemp();
+      data.m_aMulticlassMidwayTemp = nullptr == aMulticlassMidwayTemp ?
+            nullptr :
+            IndexByte(aMulticlassMidwayTemp, pBoosterShell->GetCountBytesMulticlassMidway() * iThread);
+      data.m_aUpdateTensorScores = aUpdateScores;
+      data.m_cTensorBins = pTerm->GetCountTensorBins();
+      data.m_cSamples = pSubset->GetCountSamples();
+      data.m_aPacked = pSubset->GetTermData(iTerm);
+      data.m_aTargets = pSubset->GetTargetData();
+      data.m_aWeights = pSubset->GetInnerBag(0)->GetWeights();
+      data.m_aSampleScores = pSubset->GetSampleScores();
+      data.m_aGradientsAndHessians = pSubset->GetGradHess();
+      data.m_aAucBins = nullptr != aAucBins ? &aAucBins[size_t{2} * size_t{AUC_BINS_COUNT} * iTask] : nullptr;
+      data.m_metricOut = 0.0;
+      const ProfileTimer timer(pBoosterCore->GetProfile());
+      const ErrorEbm errorSubset = pSubset->ObjectiveApplyUpdate(&data);
+      timer.Stop(ProfileSection_ApplyUpdate, data.m_cSamples, pSubset->CountBytesApplyUpdate(&data, false));
+      aValidationMetrics[iTask] = data.m_metricOut;
+      return errorSubset;
+   };
+
+   ThreadPool* pThreadPool = nullptr;
+   error = ThreadPool::Borrow(pBoosterCore->GetCountThreads(), &pThreadPool);
+   if(Error_None != error) {
+      return error;
+   }
+
+   double validationMetricAvg = 0.0;
+   while(true) {
+      bool bIgnored = false;
+      for(size_t iSubset = 0; iSubset < cValidationSubsets; ++iSubset) {
+         if(aValidationSubsets[iSubset].GetObjectiveWrapper()->m_cFloatBytes != cFloatSize) {
+            bIgnored = true;
+         }
+      }
+
+      error = pThreadPool->RunAffine(cValidationSubsets, applySubset);
+      if(Error_None != error) {
+         ThreadPool::Return(pThreadPool);
+         return error;
+      }
+
+      for(size_t iSubset = 0; iSubset < cValidationSubsets; ++iSubset) {
+         if(aValidationSubsets[iSubset].GetObjectiveWrapper()->m_cFloatBytes == cFloatSize) {
+            validationMetricAvg += aValidationMetrics[iSubset];
+         }
+      }
+
+      if(!bIgnored || sizeof(FloatSmall) == cFloatSize) {
+         break;
+      }
+
+      // the pending updates are dropped after this, so they can be converted in place like ApplyTermUpdateInternal
+      // does with its own updates
+      cFloatSize = sizeof(FloatSmall);
+      for(size_t iPending = 0; iPending < cPending; ++iPending) {
+         ConvertUpdateToSmall(pBoosterCore->GetCountScores() *
+                     pBoosterCore->GetTerms()[aiTermsFused[iPending]]->GetCountTensorBins(),
+               aaUpdateScoresFused[iPending]);
+      }
+   }
+   ThreadPool::Return(pThreadPool);
+
+   pBoosterShell->ClearValidationPending();
+
+   error = FinishValidation(pBoosterShell, cValidationSubsets, aAucBins, &validationMetricAvg);
+   if(Error_None != error) {
+      return error;
    }
 
+   *pValidationMetricAvg = validationMetricAvg;
+   return Error_None;
+}
+
+extern ErrorEbm ApplyTermUpdateInternal(BoosterShell* const pBoosterShell,
+      const size_t iTermNext,
+      const size_t cTermsFused,
+      const size_t* const aiTermsFused,
+      FloatScore* const* const aaUpdateScoresFused,
+      double* const avgValidationMetricOut) {
+   ErrorEbm error;
+
+   EBM_ASSERT(nullptr != pBoosterShell);
+
+   // any histogram from a prior call is stale once we update the gradients below
+   pBoosterShell->SetTermIndexBinned(BoosterShell::k_illegalTermIndex);
+
    const size_t iTerm = pBoosterShell->GetTermIndex();
    if(BoosterShell::k_illegalTermIndex == iTerm) {
       LOG_0(Trace_Error, "ERROR ApplyTermUpdate bad internal state.  No Term index set");
@@ -123,99 +542,261 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
    // don't want to overflow the values to NaN or +-infinity there, and it's very cheap for us to check for overflows
    // when applying the term score updates
    pBoosterCore->GetCurrentModel()[iTerm]->AddExpandedWithBadValueProtection(aUpdateScores);
+   pBoosterCore->MarkBestTermStale(iTerm);
+
+   // the fused updates were expanded by our caller and are applied to the sample scores alongside this one
+   EBM_ASSERT(0 == cTermsFused || nullptr != aiTermsFused);
+   EBM_ASSERT(0 == cTermsFused || nullptr != aaUpdateScoresFused);
+   for(size_t iFused = 0; iFused < cTermsFused; ++iFused) {
+      const size_t iTermFused = aiTermsFused[iFused];
+      EBM_ASSERT(iTermFused < pBoosterCore->GetCountTerms());
+      EBM_ASSERT(size_t{0} != pBoosterCore->GetTerms()[iTermFused]->GetCountTensorBins());
+      EBM_ASSERT(nullptr != pBoosterCore->GetCurrentModel()[iTermFused]);
+      pBoosterCore->GetCurrentModel()[iTermFused]->AddExpandedWithBadValueProtection(aaUpdateScoresFused[iFused]);
+      pBoosterCore->MarkBestTermStale(iTermFused);
+   }
 
    double validationMetricAvg = 0.0;
 
    static_assert(std::is_same<FloatBig, FloatScore>::value || std::is_same<FloatSmall, FloatScore>::value,
          "FloatScore must be either FloatBig or FloatSmall");
    size_t cFloatSize = sizeof(aUpdateScores[0]);
-   bool bIgnored = false;
+
+   const size_t cTrainingSubsets =
+         0 != pBoosterCore->GetTrainingSet()->GetCountSamples() ? pBoosterCore->GetTrainingSet()->GetCountSubsets() : 0;
+   // the update below replaces any quantized gradients with new full precision ones
+   pBoosterCore->ClearGradientsQuantized();
+   // with SetValidationBatch the validation subsets skip this call and get the update later along with the others
+   // that were held back. Updates that are still held back when the batch is lowered go out with the next one
+   const bool bDeferValidation = 0 != pBoosterCore->GetValidationSet()->GetCountSamples() &&
+         (size_t{1} < pBoosterShell->GetValidationBatch() || size_t{0} != pBoosterShell->GetCountValidationPending());
+   const size_t cValidationSubsets = 0 != pBoosterCore->GetValidationSet()->GetCountSamples() && !bDeferValidation ?
+         pBoosterCore->GetValidationSet()->GetCountSubsets() :
+         0;
+   DataSubsetBoosting* const aTrainingSubsets =
+         0 != cTrainingSubsets ? pBoosterCore->GetTrainingSet()->GetSubsets() : nullptr;
+   DataSubsetBoosting* const aValidationSubsets =
+         0 != cValidationSubsets ? pBoosterCore->GetValidationSet()->GetSubsets() : nullptr;
+   // with CreateBoosterFlags_OutOfBagMetric there is no validation set and the training subsets sum the metric
+   const bool bOutOfBag = pBoosterCore->IsOutOfBagMetric();
+   EBM_ASSERT(!bOutOfBag || 0 == pBoosterCore->GetValidationSet()->GetCountSamples());
+   double* const aValidationMetrics = pBoosterShell->GetValidationMetrics();
+   EBM_ASSERT((0 == cValidationSubsets && !bOutOfBag) || nullptr != aValidationMetrics);
+   double* const aAucBins = bDeferValidation ? nullptr : pBoosterShell->GetAucBins();
+   if(bDeferValidation) {
+      // this has to happen before the updates are converted to FloatSmall below
+      error = pBoosterShell->AddValidationPending(iTerm, aUpdateScores);
+      if(Error_None != error) {
+         return error;
+      }
+      for(size_t iFused = 0; iFused < cTermsFused; ++iFused) {
+         error = pBoosterShell->AddValidationPending(aiTermsFused[iFused], aaUpdateScoresFused[iFused]);
+         if(Error_None != error) {
+            return error;
+         }
+      }
+   }
+   if(nullptr != aAucBins) {
+      EBM_ASSERT(1 <= cValidationSubsets);
+      memset(aAucBins, 0, sizeof(*aAucBins) * size_t{2} * size_t{AUC_BINS_COUNT} * cValidationSubsets);
+   }
+
+   // Every subset applies its update independently, so the training and validation subsets all go to the thread
+   // pool as one batch of tasks. The validation metrics are collected per subset and then summed in subset order
+   // so that the result does not depend on the number of threads.
+   //
+   // if there is no validation set, it's pretty hard to know what the metric we'll get for our validation
+   // set we could in theory return anything from zero to infinity or possibly, NaN (probably legally the
+   // best), but we return 0 here because we want to kick our caller out of any loop it might be calling us
+   // in.  Infinity and NaN are odd values that might cause problems in a caller that isn't expecting those
+   // values, so 0 is the safest option, and our caller can avoid the situation entirely by not calling us
+   // with zero count validation sets
+   //
+   // if the count of training samples is zero, don't update the best term scores (it will stay as all
+   // zeros), and we don't need to update our non-existant training set either C++ doesn't define what
+   // happens when you compare NaN to annother number.  It probably follows IEEE 754, but it isn't
+   // guaranteed, so let's check for zero samples in the validation set this better way
+   // https://stackoverflow.com/questions/31225264/what-is-the-result-of-comparing-a-number-with-nan
+   auto applySubset = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      const bool bValidation = cTrainingSubsets <= iTask;
+      DataSubsetBoosting* const pSubset =
+            bValidation ? &aValidationSubsets[iTask - cTrainingSubsets] : &aTrainingSubsets[iTask];
+      if(pSubset->GetObjectiveWrapper()->m_cFloatBytes != cFloatSize) {
+         return Error_None;
+      }
+
+      if(size_t{0} != cTermsFused) {
+         AddFusedUpdatesToSubset(pBoosterCore, pSubset, cTermsFused, aiTermsFused, aaUpdateScoresFused);
+      }
+
+      ApplyUpdateBridge data;
+      data.m_cScores = pBoosterCore->GetCountScores();
+      data.m_cPack = pSubset->GetTermPack(iTerm);
+      // for the validation set we're calculating the metric and updating the scores, but we don't use
+      // the gradients, except for the special case of RMSE where the gradients are also the error
+      data.m_bHessianNeeded = !bValidation && pBoosterCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
+      data.m_bUseApprox = pBoosterCore->IsUseApprox();
+      data.m_bValidation = bValidation ? EBM_TRUE : EBM_FALSE;
+      void* const aMulticlassMidwayTemp = pBoosterShell->GetMulticlassMidwayTemp();
+      data.m_aMulticlassMidwayTemp = nullptr == aMulticlassMidwayTemp ?
+            nullptr :
+            IndexByte(aMulticlassMidwayTemp, pBoosterShell->GetCountBytesMulticlassMidway() * iThread);
+      data.m_aUpdateTensorScores = aUpdateScores;
+      data.m_cTensorBins = pTerm->GetCountTensorBins();
+      data.m_cSamples = pSubset->GetCountSamples();
+      data.m_aPacked = pSubset->GetTermData(iTerm);
+      data.m_aTargets = pSubset->GetTargetData();
+      // the training subsets only have weights for the out of bag metric
+      data.m_aWeights = bValidation ? pSubset->GetInnerBag(0)->GetWeights() : pSubset->GetOutOfBagWeights();
+      data.m_aSampleScores = pSubset->GetSampleScores();
+      data.m_aGradientsAndHessians = pSubset->GetGradHess();
+      data.m_aAucBins = bValidation && nullptr != aAucBins ?
+            &aAucBins[size_t{2} * size_t{AUC_BINS_COUNT} * (iTask - cTrainingSubsets)] :
+            nullptr;
+      data.m_metricOut = 0.0;
+      const ProfileTimer timer(pBoosterCore->GetProfile());
+      const bool bCompressed = !bValidation && pBoosterCore->IsCompressGradients();
+      ErrorEbm errorSubset;
+      if(bCompressed) {
+         errorSubset = ApplyUpdateCompressed(pSubset,
+               &data,
+               IndexBin(pBoosterShell->GetBoostingFastBinsTemp(),
+                     pBoosterCore->GetCountBytesFastBins() * iThread + pBoosterCore->GetIndexBytesGradHessTemp()));
+      } else {
+         errorSubset = pSubset->ObjectiveApplyUpdate(&data);
+      }
+      timer.Stop(ProfileSection_ApplyUpdate, data.m_cSamples, pSubset->CountBytesApplyUpdate(&data, bCompressed));
+      if(bValidation) {
+         aValidationMetrics[iTask - cTrainingSubsets] = data.m_metricOut;
+      } else if(bOutOfBag) {
+         aValidationMetrics[iTask] = data.m_metricOut;
+      }
+      return errorSubset;
+   };
+
+   // If we know which term is boosted next then we sum its histogram for inner bag zero right after each subset
+   // updates its gradients, while they are still in the cache. The next GenerateTermUpdate call for that term then
+   // skips its own pass over the gradients. The training subsets are done in waves with one fast bins slice per
+   // subset and reduced in subset order, exactly like GenerateTermUpdate does, so the histogram is identical.
+   // with SampleGradients the caller picks the samples again between this update and the next GenerateTermUpdate,
+   // so there is nothing to bin ahead of time. Quantized gradients are rounded with the rng of the next
+   // GenerateTermUpdate, so they cannot be binned ahead of time either
+   const size_t cTensorBinsNext = BoosterShell::k_illegalTermIndex == iTermNext || size_t{0} == cTrainingSubsets ||
+               nullptr != pBoosterShell->GetGradientSamples() || pBoosterCore->IsQuantizeGradients() ?
+         size_t{0} :
+         pBoosterCore->GetTerms()[iTermNext]->GetCountTensorBins();
+   BinBase* const aFastBinsAll = pBoosterShell->GetBoostingFastBinsTemp();
+   BinBase* const aMainBins = pBoosterShell->GetBoostingMainBins();
+   const size_t cBytesFastBinsSlice = pBoosterCore->GetCountBytesFastBins();
+   size_t cTrainingSubsetsBinned = 0;
+   if(size_t{0} != cTensorBinsNext) {
+      EBM_ASSERT(nullptr != aFastBinsAll);
+      EBM_ASSERT(nullptr != aMainBins);
+      const size_t cBytesPerMainBin =
+            GetBinSize<FloatMain, UIntMain>(true, true, pBoosterCore->IsHessian(), pBoosterCore->GetCountScores());
+      EBM_ASSERT(!IsMultiplyError(cBytesPerMainBin, cTensorBinsNext));
+      memset(aMainBins, 0, cBytesPerMainBin * cTensorBinsNext);
+   }
+
+   ThreadPool* pThreadPool = nullptr;
+   error = ThreadPool::Borrow(pBoosterCore->GetCountThreads(), &pThreadPool);
+   if(Error_None != error) {
+      return error;
+   }
+
    while(true) {
-      if(0 != pBoosterCore->GetTrainingSet()->GetCountSamples()) {
-         EBM_ASSERT(1 <= pBoosterCore->GetTrainingSet()->GetCountSubsets());
+      bool bIgnored = false;
+      for(size_t iTask = 0; iTask < cTrainingSubsets + cValidationSubsets; ++iTask) {
+         const DataSubsetBoosting* const pSubset = cTrainingSubsets <= iTask ?
+               &aValidationSubsets[iTask - cTrainingSubsets] :
+               &aTrainingSubsets[iTask];
+         if(pSubset->GetObjectiveWrapper()->m_cFloatBytes != cFloatSize) {
+            bIgnored = true;
+         }
+      }
+
+      if(size_t{0} != cTensorBinsNext) {
+         const size_t cThreads = pThreadPool->GetCountThreads();
 
-         DataSubsetBoosting* pSubset = pBoosterCore->GetTrainingSet()->GetSubsets();
-         const DataSubsetBoosting* const pSubsetsEnd = pSubset + pBoosterCore->GetTrainingSet()->GetCountSubsets();
+         size_t iSubsetWave = 0;
          do {
-            if(pSubset->GetObjectiveWrapper()->m_cFloatBytes != cFloatSize) {
-               bIgnored = true;
-            } else {
-               ApplyUpdateBridge data;
-               data.m_cScores = pBoosterCore->GetCountScores();
-               data.m_cPack = 0 == pTerm->GetBitsRequiredMin() ?
-                     k_cItemsPerBitPackUndefined :
-                     GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-               data.m_bHessianNeeded = pBoosterCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
-               data.m_bUseApprox = pBoosterCore->IsUseApprox();
-               data.m_bValidation = EBM_FALSE;
-               data.m_aMulticlassMidwayTemp = pBoosterShell->GetMulticlassMidwayTemp();
-               data.m_aUpdateTensorScores = aUpdateScores;
-               data.m_cSamples = pSubset->GetCountSamples();
-               data.m_aPacked = pSubset->GetTermData(iTerm);
-               data.m_aTargets = pSubset->GetTargetData();
-               data.m_aWeights = nullptr;
-               data.m_aSampleScores = pSubset->GetSampleScores();
-               data.m_aGradientsAndHessians = pSubset->GetGradHess();
-               data.m_metricOut = 0.0;
-               error = pSubset->ObjectiveApplyUpdate(&data);
-               if(Error_None != error) {
-                  return error;
+            const size_t cSubsetsWave = EbmMin(cThreads, cTrainingSubsets - iSubsetWave);
+
+            auto applyAndBinSubset = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+               DataSubsetBoosting* const pSubset = &aTrainingSubsets[iSubsetWave + iTask];
+               if(pSubset->GetObjectiveWrapper()->m_cFloatBytes != cFloatSize) {
+                  return Error_None;
                }
+               // the fast bins slice of this task also holds the buffer for its compressed gradients, and each
+               // task in the wave has a distinct index below cThreads, so it can stand in for the thread index
+               UNUSED(iThread);
+               const ErrorEbm errorApply = applySubset(iSubsetWave + iTask, iTask);
+               if(Error_None != errorApply) {
+                  return errorApply;
+               }
+               return BinSumsBoostingSubset(pBoosterCore,
+                     iTermNext,
+                     0,
+                     cTensorBinsNext,
+                     pSubset,
+                     IndexBin(aFastBinsAll, cBytesFastBinsSlice * iTask),
+                     nullptr);
+            };
+            error = pThreadPool->RunAffine(cSubsetsWave, applyAndBinSubset);
+            if(Error_None != error) {
+               ThreadPool::Return(pThreadPool);
+               return error;
             }
-            ++pSubset;
-         } while(pSubsetsEnd != pSubset);
-      }
 
-      if(0 != pBoosterCore->GetValidationSet()->GetCountSamples()) {
-         EBM_ASSERT(1 <= pBoosterCore->GetValidationSet()->GetCountSubsets());
-
-         DataSubsetBoosting* pSubset = pBoosterCore->GetValidationSet()->GetSubsets();
-         const DataSubsetBoosting* const pSubsetsEnd = pSubset + pBoosterCore->GetValidationSet()->GetCountSubsets();
-         do {
-            if(pSubset->GetObjectiveWrapper()->m_cFloatBytes != cFloatSize) {
-               bIgnored = true;
-            } else {
-               // if there is no validation set, it's pretty hard to know what the metric we'll get for our validation
-               // set we could in theory return anything from zero to infinity or possibly, NaN (probably legally the
-               // best), but we return 0 here because we want to kick our caller out of any loop it might be calling us
-               // in.  Infinity and NaN are odd values that might cause problems in a caller that isn't expecting those
-               // values, so 0 is the safest option, and our caller can avoid the situation entirely by not calling us
-               // with zero count validation sets
-
-               // if the count of training samples is zero, don't update the best term scores (it will stay as all
-               // zeros), and we don't need to update our non-existant training set either C++ doesn't define what
-               // happens when you compare NaN to annother number.  It probably follows IEEE 754, but it isn't
-               // guaranteed, so let's check for zero samples in the validation set this better way
-               // https://stackoverflow.com/questions/31225264/what-is-the-result-of-comparing-a-number-with-nan
-
-               ApplyUpdateBridge data;
-               data.m_cScores = pBoosterCore->GetCountScores();
-               data.m_cPack = 0 == pTerm->GetBitsRequiredMin() ?
-                     k_cItemsPerBitPackUndefined :
-                     GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-               // for the validation set we're calculating the metric and updating the scores, but we don't use
-               // the gradients, except for the special case of RMSE where the gradients are also the error
-               data.m_bHessianNeeded = EBM_FALSE;
-               data.m_bUseApprox = pBoosterCore->IsUseApprox();
-               data.m_bValidation = EBM_TRUE;
-               data.m_aMulticlassMidwayTemp = pBoosterShell->GetMulticlassMidwayTemp();
-               data.m_aUpdateTensorScores = aUpdateScores;
-               data.m_cSamples = pSubset->GetCountSamples();
-               data.m_aPacked = pSubset->GetTermData(iTerm);
-               data.m_aTargets = pSubset->GetTargetData();
-               data.m_aWeights = pSubset->GetInnerBag(0)->GetWeights();
-               data.m_aSampleScores = pSubset->GetSampleScores();
-               data.m_aGradientsAndHessians = pSubset->GetGradHess();
-               data.m_metricOut = 0.0;
-               error = pSubset->ObjectiveApplyUpdate(&data);
-               if(Error_None != error) {
-                  return error;
+            for(size_t iTask = 0; iTask < cSubsetsWave; ++iTask) {
+               const DataSubsetBoosting* const pSubset = &aTrainingSubsets[iSubsetWave + iTask];
+               if(pSubset->GetObjectiveWrapper()->m_cFloatBytes == cFloatSize) {
+                  ++cTrainingSubsetsBinned;
+                  AddFastBinsToMainBins(pBoosterCore,
+                        iTermNext,
+                        0,
+                        cTensorBinsNext,
+                        pSubset,
+                        cTrainingSubsets == cTrainingSubsetsBinned,
+                        IndexBin(aFastBinsAll, cBytesFastBinsSlice * iTask),
+                        aMainBins);
                }
-               validationMetricAvg += data.m_metricOut;
             }
-            ++pSubset;
-         } while(pSubsetsEnd != pSubset);
+
+            iSubsetWave += cSubsetsWave;
+         } while(cTrainingSubsets != iSubsetWave);
+
+         if(size_t{0} != cValidationSubsets) {
+            auto applyValidationSubset = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+               return applySubset(cTrainingSubsets + iTask, iThread);
+            };
+            error = pThreadPool->Run(cValidationSubsets, applyValidationSubset);
+            if(Error_None != error) {
+               ThreadPool::Return(pThreadPool);
+               return error;
+            }
+         }
+      } else if(0 != cTrainingSubsets + cValidationSubsets) {
+         error = pThreadPool->RunAffine(cTrainingSubsets + cValidationSubsets, applySubset);
+         if(Error_None != error) {
+            ThreadPool::Return(pThreadPool);
+            return error;
+         }
+      }
+
+      for(size_t iSubset = 0; iSubset < cValidationSubsets; ++iSubset) {
+         if(aValidationSubsets[iSubset].GetObjectiveWrapper()->m_cFloatBytes == cFloatSize) {
+            validationMetricAvg += aValidationMetrics[iSubset];
+         }
+      }
+      if(bOutOfBag) {
+         for(size_t iSubset = 0; iSubset < cTrainingSubsets; ++iSubset) {
+            if(aTrainingSubsets[iSubset].GetObjectiveWrapper()->m_cFloatBytes == cFloatSize) {
+               validationMetricAvg += aValidationMetrics[iSubset];
+            }
+         }
       }
+
       if(!bIgnored) {
          break;
       }
@@ -234,86 +815,192 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
 
       cFloatSize = sizeof(FloatSmall);
 
-      // these need to be void * to avoid breaking the C++ aliasing rules
-      void* pUpdateSmall = aUpdateScores;
-      void* pUpdateBig = aUpdateScores;
-      const void* const pUpdateBigEnd = IndexByte(reinterpret_cast<void*>(aUpdateScores),
-            sizeof(FloatBig) * pBoosterCore->GetCountScores() * pTerm->GetCountTensorBins());
-      do {
-         *reinterpret_cast<FloatSmall*>(pUpdateSmall) =
-               static_cast<FloatSmall>(*reinterpret_cast<FloatBig*>(pUpdateBig));
-         pUpdateBig = IndexByte(pUpdateBig, sizeof(FloatBig));
-         pUpdateSmall = IndexByte(pUpdateSmall, sizeof(FloatSmall));
-      } while(pUpdateBigEnd != pUpdateBig);
-   }
-
-   if(0 != pBoosterCore->GetValidationSet()->GetCountSamples()) {
-      validationMetricAvg = pBoosterCore->FinishMetric(validationMetricAvg);
-
-      if(EBM_FALSE != pBoosterCore->MaximizeMetric()) {
-         // make it so that we always return values such that the caller wants to minimize them. If the caller
-         // wants more information they can determine if they should negate the values we return them.
-         validationMetricAvg = -validationMetricAvg;
+      ConvertUpdateToSmall(pBoosterCore->GetCountScores() * pTerm->GetCountTensorBins(), aUpdateScores);
+      for(size_t iFused = 0; iFused < cTermsFused; ++iFused) {
+         ConvertUpdateToSmall(
+               pBoosterCore->GetCountScores() * pBoosterCore->GetTerms()[aiTermsFused[iFused]]->GetCountTensorBins(),
+               aaUpdateScoresFused[iFused]);
       }
-
-      EBM_ASSERT(!std::isnan(validationMetricAvg)); // NaNs can happen, but we should have cleaned them up
-
-      const double totalWeight = pBoosterCore->GetValidationSet()->GetBagWeightTotal(0);
-      EBM_ASSERT(!std::isnan(totalWeight));
-      EBM_ASSERT(!std::isinf(totalWeight));
-      EBM_ASSERT(0.0 < totalWeight);
-      validationMetricAvg /= totalWeight; // if totalWeight < 1.0 then this can overflow to +inf
-
-      EBM_ASSERT(!std::isnan(validationMetricAvg)); // NaNs can happen, but we should have cleaned them up
    }
-
-   if(LIKELY(validationMetricAvg <= pBoosterCore->GetBestModelMetric())) {
-      pBoosterCore->SetBestModelMetric(validationMetricAvg);
-
-      // TODO: We're doing a lot more work here than necessary.  Typically in the early phases we improve
-      // on each boosting step, and in that case we should only need to copy over the term's tensor that
-      // we just improved on since all the other ones are up to date.  Later though we'll get into a stage
-      // where some of the terms will improve on the metric but others won't. At that point if we see
-      // two terms not improve the stopping metric, then we see one that does, we'd need to copy over the
-      // last 3 terms to maintain consistency.  That requires that we keep track of the terms we boosted
-      // on since the last improvement.  This can get even more interesting if we do more than a full boosting
-      // round where a term might have been boosted on a few times.  In that case we only need to overwrite
-      // it once.  We can do this by keeping a set that holds the terms that have been bosted on since the last
-      // improvement and then we would overwrite only those whenever we see an improvement. Instead of a set though
-      // we could instead maintan a reversed linked list of terms that we've boosted on using a flat array
-      // with 1 pointer entry for each term.  If a term is already in the linked list there is no need to add it
-      // again.  This way we can avoid a sweep of the entire list of terms on each boosting round.
-      // Or just use an array of bools (1 per term) and sweep the array of bools each time. Since it's co-located
-      // doing the sweep will be fast and resetting to zero is easy with memset
-
-      size_t iTermCopy = 0;
-      size_t iTermCopyEnd = pBoosterCore->GetCountTerms();
-      do {
-         if(nullptr != pBoosterCore->GetCurrentModel()[iTermCopy]) {
-            EBM_ASSERT(nullptr != pBoosterCore->GetBestModel()[iTermCopy]);
-            error = pBoosterCore->GetBestModel()[iTermCopy]->Copy(*pBoosterCore->GetCurrentModel()[iTermCopy]);
-            if(Error_None != error) {
-               LOG_0(Trace_Verbose, "Exited ApplyTermUpdateInternal with memory allocation error in copy");
-               return error;
-            }
-         } else {
-            EBM_ASSERT(nullptr == pBoosterCore->GetBestModel()[iTermCopy]);
+   ThreadPool::Return(pThreadPool);
+
+   if(bDeferValidation) {
+      // the validation set has not seen this update yet, so there is no metric for it and the best model stays
+      pBoosterShell->IncrementValidationUpdates();
+      validationMetricAvg = std::numeric_limits<double>::infinity();
+      if(pBoosterShell->GetValidationBatch() <= pBoosterShell->GetCountValidationUpdates()) {
+         error = ApplyValidationPending(pBoosterShell, &validationMetricAvg);
+         if(Error_None != error) {
+            return error;
          }
-         ++iTermCopy;
-      } while(iTermCopy != iTermCopyEnd);
+      }
+   } else {
+      error = FinishValidation(pBoosterShell, cValidationSubsets, aAucBins, &validationMetricAvg);
+      if(Error_None != error) {
+         return error;
+      }
    }
 
    if(nullptr != avgValidationMetricOut) {
       *avgValidationMetricOut = validationMetricAvg;
    }
 
+   if(size_t{0} != cTensorBinsNext && cTrainingSubsets == cTrainingSubsetsBinned) {
+      pBoosterShell->SetTermIndexBinned(iTermNext);
+   }
+
+   error = pBoosterCore->PublishSnapshot();
+   if(Error_None != error) {
+      return error;
+   }
+
    LOG_COUNTED_N(pTerm->GetPointerCountLogExitApplyTermUpdateMessages(),
          Trace_Info,
          Trace_Verbose,
          "Exited ApplyTermUpdate: "
          "validationMetricAvg=%le",
          validationMetricAvg);
+   TRACE_EVENT(Trace_Info,
+         TraceEvent_ApplyTermUpdate,
+         pBoosterShell->GetHandle(),
+         static_cast<double>(iTerm),
+         validationMetricAvg);
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
+      BoosterHandle boosterHandle, double* avgValidationMetricOut) {
+   LOG_COUNTED_N(&g_cLogApplyTermUpdate,
+         Trace_Info,
+         Trace_Verbose,
+         "ApplyTermUpdate: "
+         "boosterHandle=%p, "
+         "avgValidationMetricOut=%p",
+         static_cast<void*>(boosterHandle),
+         static_cast<void*>(avgValidationMetricOut));
+
+   if(LIKELY(nullptr != avgValidationMetricOut)) {
+      // returning +inf means that boosting won't consider this to be an improvement.  After a few cycles
+      // it should exit with the last model that was good if the error was ignored (it shouldn't be ignored though)
+      *avgValidationMetricOut = std::numeric_limits<double>::infinity();
+   }
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   return ApplyTermUpdateInternal(
+         pBoosterShell, BoosterShell::k_illegalTermIndex, 0, nullptr, nullptr, avgValidationMetricOut);
+}
+
+static int g_cLogApplyTermUpdateAndBinNext = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdateAndBinNext(
+      BoosterHandle boosterHandle, IntEbm indexTermNext, double* avgValidationMetricOut) {
+   LOG_COUNTED_N(&g_cLogApplyTermUpdateAndBinNext,
+         Trace_Info,
+         Trace_Verbose,
+         "ApplyTermUpdateAndBinNext: "
+         "boosterHandle=%p, "
+         "indexTermNext=%" IntEbmPrintf ", "
+         "avgValidationMetricOut=%p",
+         static_cast<void*>(boosterHandle),
+         indexTermNext,
+         static_cast<void*>(avgValidationMetricOut));
+
+   if(LIKELY(nullptr != avgValidationMetricOut)) {
+      // returning +inf means that boosting won't consider this to be an improvement.  After a few cycles
+      // it should exit with the last model that was good if the error was ignored (it shouldn't be ignored though)
+      *avgValidationMetricOut = std::numeric_limits<double>::infinity();
+   }
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(indexTermNext < 0) {
+      LOG_0(Trace_Error, "ERROR ApplyTermUpdateAndBinNext indexTermNext must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(static_cast<IntEbm>(pBoosterShell->GetBoosterCore()->GetCountTerms()) <= indexTermNext) {
+      LOG_0(Trace_Error, "ERROR ApplyTermUpdateAndBinNext indexTermNext above the number of terms that we have");
+      return Error_IllegalParamVal;
+   }
+
+   return ApplyTermUpdateInternal(
+         pBoosterShell, static_cast<size_t>(indexTermNext), 0, nullptr, nullptr, avgValidationMetricOut);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SetValidationBatch(BoosterHandle boosterHandle, IntEbm countUpdates) {
+   LOG_N(Trace_Info,
+         "Entered SetValidationBatch: "
+         "boosterHandle=%p, "
+         "countUpdates=%" IntEbmPrintf,
+         static_cast<void*>(boosterHandle),
+         countUpdates);
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(countUpdates < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR SetValidationBatch countUpdates must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countUpdates)) {
+      LOG_0(Trace_Error, "ERROR SetValidationBatch IsConvertError<size_t>(countUpdates)");
+      return Error_IllegalParamVal;
+   }
+
+   // updates that are already held back stay that way until the next update or ApplyValidationUpdates
+   pBoosterShell->SetValidationBatch(static_cast<size_t>(countUpdates));
+
+   LOG_0(Trace_Info, "Exited SetValidationBatch");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyValidationUpdates(
+      BoosterHandle boosterHandle, double* avgValidationMetricOut) {
+   LOG_N(Trace_Info,
+         "Entered ApplyValidationUpdates: "
+         "boosterHandle=%p, "
+         "avgValidationMetricOut=%p",
+         static_cast<void*>(boosterHandle),
+         static_cast<void*>(avgValidationMetricOut));
+
+   if(LIKELY(nullptr != avgValidationMetricOut)) {
+      *avgValidationMetricOut = std::numeric_limits<double>::infinity();
+   }
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   double validationMetricAvg;
+   ErrorEbm error = ApplyValidationPending(pBoosterShell, &validationMetricAvg);
+   if(Error_None != error) {
+      return error;
+   }
+
+   error = pBoosterShell->GetBoosterCore()->PublishSnapshot();
+   if(Error_None != error) {
+      return error;
+   }
+
+   if(nullptr != avgValidationMetricOut) {
+      *avgValidationMetricOut = validationMetricAvg;
+   }
 
+   LOG_N(Trace_Info, "Exited ApplyValidationUpdates: validationMetricAvg=%le", validationMetricAvg);
    return Error_None;
 }
 
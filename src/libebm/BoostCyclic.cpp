@@ -0,0 +1,241 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // numeric_limits
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "BoosterCore.hpp"
+#include "BoosterShell.hpp"
+#include "CancelToken.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// BoostOuterBags runs this on its own boosters with the token it took when it started, so that a cancel that arrives
+// before an outer bag gets to a thread still stops that bag
+extern ErrorEbm BoostCyclicCancellable(const CancelToken& cancelToken,
+      void* const rng,
+      const BoosterHandle boosterHandle,
+      const IntEbm maxRounds,
+      const IntEbm earlyStoppingRounds,
+      const double earlyStoppingTolerance,
+      const TermBoostFlags flags,
+      const double learningRate,
+      const IntEbm minSamplesLeaf,
+      const double minHessian,
+      const double regAlpha,
+      const double regLambda,
+      const double maxDeltaStep,
+      const IntEbm* const leavesMax,
+      IntEbm* const countRoundsOut,
+      double* const minMetricOut) {
+   ErrorEbm error;
+
+   if(nullptr != countRoundsOut) {
+      *countRoundsOut = IntEbm{0};
+   }
+   if(nullptr != minMetricOut) {
+      *minMetricOut = std::numeric_limits<double>::infinity();
+   }
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(maxRounds < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR BoostCyclic maxRounds must be positive");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   EBM_ASSERT(nullptr != pBoosterCore);
+
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   if(size_t{0} == cTerms) {
+      LOG_0(Trace_Warning, "WARNING BoostCyclic size_t { 0 } == cTerms");
+      return Error_None;
+   }
+   EBM_ASSERT(nullptr != pBoosterCore->GetTerms());
+
+   const IntEbm cTermsIntEbm = static_cast<IntEbm>(cTerms);
+
+   // this mirrors the early stopping that our language wrappers do, with the exception that a non-positive
+   // earlyStoppingRounds disables early stopping instead of terminating after the first round
+   double minMetric = std::numeric_limits<double>::infinity();
+   double minMetricBreakpoint = std::numeric_limits<double>::infinity();
+   IntEbm cNoChangeRounds = 0;
+   IntEbm cRounds = 0;
+   while(cRounds < maxRounds) {
+      for(IntEbm iTerm = 0; iTerm < cTermsIntEbm; ++iTerm) {
+         if(cancelToken.IsCancelled()) {
+            // the best model was recorded by the last ApplyTermUpdateAndBinNext, so the booster is still usable
+            LOG_N(Trace_Info, "BoostCyclic cancelled after %" IntEbmPrintf " rounds", cRounds);
+            if(nullptr != countRoundsOut) {
+               *countRoundsOut = cRounds;
+            }
+            if(nullptr != minMetricOut) {
+               *minMetricOut = minMetric;
+            }
+            return Error_Cancelled;
+         }
+
+         // the same leavesMax array is used for every term, so it needs to hold as many items as the largest term
+         // has dimensions. A nullptr leavesMax is passed through to GenerateTermUpdate, which boosts without splits
+         double avgGain;
+         error = GenerateTermUpdate(rng,
+               boosterHandle,
+               iTerm,
+               flags,
+               learningRate,
+               minSamplesLeaf,
+               minHessian,
+               regAlpha,
+               regLambda,
+               maxDeltaStep,
+               leavesMax,
+               nullptr,
+               &avgGain);
+         if(Error_None != error) {
+            LOG_N(Trace_Warning, "WARNING BoostCyclic GenerateTermUpdate returned %" ErrorEbmPrintf, error);
+            return error;
+         }
+
+         // the next term in the cycle wraps around to the first term of the next round. On the last term of the
+         // last round this bins a histogram that we never use, but that is cheaper than the extra pass over the
+         // gradients that a plain ApplyTermUpdate would need on every other term
+         const IntEbm iTermNext = cTermsIntEbm - 1 == iTerm ? IntEbm{0} : iTerm + 1;
+
+         double avgValidationMetric;
+         error = ApplyTermUpdateAndBinNext(boosterHandle, iTermNext, &avgValidationMetric);
+         if(Error_None != error) {
+            LOG_N(Trace_Warning, "WARNING BoostCyclic ApplyTermUpdateAndBinNext returned %" ErrorEbmPrintf, error);
+            return error;
+         }
+
+         // ApplyTermUpdate has already recorded the best model with SetBestModelMetric, so we only need to
+         // track the metric for early stopping
+         if(avgValidationMetric < minMetric) {
+            minMetric = avgValidationMetric;
+         }
+      }
+
+      if(size_t{0} != pBoosterShell->GetCountValidationPending()) {
+         // with SetValidationBatch the validation set can still be missing some of the updates of this round
+         double avgValidationMetric;
+         error = ApplyValidationUpdates(boosterHandle, &avgValidationMetric);
+         if(Error_None != error) {
+            LOG_N(Trace_Warning, "WARNING BoostCyclic ApplyValidationUpdates returned %" ErrorEbmPrintf, error);
+            return error;
+         }
+         if(avgValidationMetric < minMetric) {
+            minMetric = avgValidationMetric;
+         }
+      }
+      ++cRounds;
+
+      if(IntEbm{0} == cNoChangeRounds) {
+         minMetricBreakpoint = minMetric;
+      }
+      if(minMetric + earlyStoppingTolerance < minMetricBreakpoint) {
+         cNoChangeRounds = 0;
+      } else {
+         ++cNoChangeRounds;
+      }
+
+      if(IntEbm{0} < earlyStoppingRounds && earlyStoppingRounds <= cNoChangeRounds) {
+         LOG_N(Trace_Info, "BoostCyclic early stopping after %" IntEbmPrintf " rounds", cRounds);
+         break;
+      }
+   }
+
+   if(nullptr != countRoundsOut) {
+      *countRoundsOut = cRounds;
+   }
+   if(nullptr != minMetricOut) {
+      *minMetricOut = minMetric;
+   }
+
+   LOG_0(Trace_Info, "Exited BoostCyclic");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION BoostCyclic(void* rng,
+      BoosterHandle boosterHandle,
+      IntEbm maxRounds,
+      IntEbm earlyStoppingRounds,
+      double earlyStoppingTolerance,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      IntEbm* countRoundsOut,
+      double* minMetricOut) {
+   LOG_N(Trace_Info,
+         "Entered BoostCyclic: "
+         "rng=%p, "
+         "boosterHandle=%p, "
+         "maxRounds=%" IntEbmPrintf ", "
+         "earlyStoppingRounds=%" IntEbmPrintf ", "
+         "earlyStoppingTolerance=%le, "
+         "flags=0x%" UTermBoostFlagsPrintf ", "
+         "learningRate=%le, "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "leavesMax=%p, "
+         "countRoundsOut=%p, "
+         "minMetricOut=%p",
+         rng,
+         static_cast<void*>(boosterHandle),
+         maxRounds,
+         earlyStoppingRounds,
+         earlyStoppingTolerance,
+         static_cast<UTermBoostFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<const void*>(leavesMax),
+         static_cast<void*>(countRoundsOut),
+         static_cast<void*>(minMetricOut));
+
+   return BoostCyclicCancellable(CancelToken(),
+         rng,
+         boosterHandle,
+         maxRounds,
+         earlyStoppingRounds,
+         earlyStoppingTolerance,
+         flags,
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         leavesMax,
+         countRoundsOut,
+         minMetricOut);
+}
+
+} // namespace DEFINED_ZONE_NAME
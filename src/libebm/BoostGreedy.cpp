@@ -0,0 +1,279 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // numeric_limits
+#include <algorithm> // std::sort
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsMultiplyError
+#include "BoosterCore.hpp"
+#include "BoosterShell.hpp"
+#include "CancelToken.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// highest gain first, and the lowest term index among equal gains so that the order is deterministic
+static bool IsBoostedBefore(const double* const aGains, const size_t iLeft, const size_t iRight) noexcept {
+   return aGains[iRight] < aGains[iLeft] || (aGains[iLeft] == aGains[iRight] && iLeft < iRight);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION BoostGreedy(void* rng,
+      BoosterHandle boosterHandle,
+      IntEbm maxRounds,
+      IntEbm refreshRounds,
+      IntEbm countTermsPerRound,
+      double gainTolerance,
+      IntEbm earlyStoppingRounds,
+      double earlyStoppingTolerance,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      IntEbm* countRoundsOut,
+      double* minMetricOut) {
+   LOG_N(Trace_Info,
+         "Entered BoostGreedy: "
+         "rng=%p, "
+         "boosterHandle=%p, "
+         "maxRounds=%" IntEbmPrintf ", "
+         "refreshRounds=%" IntEbmPrintf ", "
+         "countTermsPerRound=%" IntEbmPrintf ", "
+         "gainTolerance=%le, "
+         "earlyStoppingRounds=%" IntEbmPrintf ", "
+         "earlyStoppingTolerance=%le, "
+         "flags=0x%" UTermBoostFlagsPrintf ", "
+         "learningRate=%le, "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "leavesMax=%p, "
+         "countRoundsOut=%p, "
+         "minMetricOut=%p",
+         rng,
+         static_cast<void*>(boosterHandle),
+         maxRounds,
+         refreshRounds,
+         countTermsPerRound,
+         gainTolerance,
+         earlyStoppingRounds,
+         earlyStoppingTolerance,
+         static_cast<UTermBoostFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<const void*>(leavesMax),
+         static_cast<void*>(countRoundsOut),
+         static_cast<void*>(minMetricOut));
+
+   const CancelToken cancelToken;
+
+   ErrorEbm error;
+
+   if(nullptr != countRoundsOut) {
+      *countRoundsOut = IntEbm{0};
+   }
+   if(nullptr != minMetricOut) {
+      *minMetricOut = std::numeric_limits<double>::infinity();
+   }
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(maxRounds < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR BoostGreedy maxRounds must be positive");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   EBM_ASSERT(nullptr != pBoosterCore);
+
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   if(size_t{0} == cTerms) {
+      LOG_0(Trace_Warning, "WARNING BoostGreedy size_t { 0 } == cTerms");
+      return Error_None;
+   }
+   EBM_ASSERT(nullptr != pBoosterCore->GetTerms());
+
+   // a non-positive or oversized countTermsPerRound boosts every term on every round, which only differs from
+   // BoostCyclic in the order of the terms and in skipping the terms that are below gainTolerance
+   size_t cTermsPerRound = cTerms;
+   if(IntEbm{0} < countTermsPerRound && countTermsPerRound < static_cast<IntEbm>(cTerms)) {
+      cTermsPerRound = static_cast<size_t>(countTermsPerRound);
+   }
+
+   if(IsMultiplyError(sizeof(double), cTerms) || IsMultiplyError(sizeof(size_t), cTerms)) {
+      LOG_0(Trace_Warning, "WARNING BoostGreedy IsMultiplyError(sizeof(double), cTerms)");
+      return Error_OutOfMemory;
+   }
+   double* const aGains = static_cast<double*>(malloc(sizeof(double) * cTerms));
+   size_t* const aiTermsOrdered = static_cast<size_t*>(malloc(sizeof(size_t) * cTerms));
+   if(nullptr == aGains || nullptr == aiTermsOrdered) {
+      LOG_0(Trace_Warning, "WARNING BoostGreedy nullptr == aGains || nullptr == aiTermsOrdered");
+      free(aGains);
+      free(aiTermsOrdered);
+      return Error_OutOfMemory;
+   }
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      // terms that have not been boosted yet go first
+      aGains[iTerm] = std::numeric_limits<double>::infinity();
+      aiTermsOrdered[iTerm] = iTerm;
+   }
+
+   // the early stopping is the same as in BoostCyclic, except that a round here is one pass over the chosen terms
+   double minMetric = std::numeric_limits<double>::infinity();
+   double minMetricBreakpoint = std::numeric_limits<double>::infinity();
+   IntEbm cNoChangeRounds = 0;
+   IntEbm cRounds = 0;
+   while(cRounds < maxRounds) {
+      // the gains of the terms that were not boosted since the last refresh are stale, so every refreshRounds rounds
+      // we boost all the terms again to give the ones that fell behind a chance to come back
+      const bool bRefresh =
+            IntEbm{0} == cRounds || (IntEbm{0} < refreshRounds && IntEbm{0} == cRounds % refreshRounds);
+      const size_t cTermsRound = bRefresh ? cTerms : cTermsPerRound;
+
+      std::sort(aiTermsOrdered, aiTermsOrdered + cTerms, [aGains](const size_t iLeft, const size_t iRight) {
+         return IsBoostedBefore(aGains, iLeft, iRight);
+      });
+
+      size_t cTermsApplied = 0;
+      for(size_t iOrdered = 0; iOrdered < cTermsRound; ++iOrdered) {
+         if(cancelToken.IsCancelled()) {
+            // the best model was recorded by the last ApplyTermUpdateAndBinNext, so the booster is still usable
+            LOG_N(Trace_Info, "BoostGreedy cancelled after %" IntEbmPrintf " rounds", cRounds);
+            error = Error_Cancelled;
+            goto done;
+         }
+
+         const size_t iTerm = aiTermsOrdered[iOrdered];
+
+         double avgGain;
+         error = GenerateTermUpdate(rng,
+               boosterHandle,
+               static_cast<IntEbm>(iTerm),
+               flags,
+               learningRate,
+               minSamplesLeaf,
+               minHessian,
+               regAlpha,
+               regLambda,
+               maxDeltaStep,
+               leavesMax,
+               nullptr,
+               &avgGain);
+         if(Error_None != error) {
+            LOG_N(Trace_Warning, "WARNING BoostGreedy GenerateTermUpdate returned %" ErrorEbmPrintf, error);
+            goto done;
+         }
+         // a NaN gain would break the ordering, and a term that cannot report a gain has nothing useful to add
+         aGains[iTerm] = avgGain != avgGain ? 0.0 : avgGain;
+
+         if(aGains[iTerm] <= gainTolerance) {
+            // the term has converged, so we drop its update instead of paying for the pass over the samples that
+            // applying it would take. It sinks to the back of the order until its gain is refreshed
+            continue;
+         }
+
+         // we bin the term that goes next. After the last term of the round that is the term with the highest gain,
+         // which the next round boosts first
+         size_t iTermNext;
+         if(iOrdered + 1 < cTermsRound) {
+            iTermNext = aiTermsOrdered[iOrdered + 1];
+         } else {
+            iTermNext = 0;
+            for(size_t iTermCandidate = 1; iTermCandidate < cTerms; ++iTermCandidate) {
+               if(IsBoostedBefore(aGains, iTermCandidate, iTermNext)) {
+                  iTermNext = iTermCandidate;
+               }
+            }
+         }
+
+         double avgValidationMetric;
+         error = ApplyTermUpdateAndBinNext(boosterHandle, static_cast<IntEbm>(iTermNext), &avgValidationMetric);
+         if(Error_None != error) {
+            LOG_N(Trace_Warning, "WARNING BoostGreedy ApplyTermUpdateAndBinNext returned %" ErrorEbmPrintf, error);
+            goto done;
+         }
+         ++cTermsApplied;
+
+         if(avgValidationMetric < minMetric) {
+            minMetric = avgValidationMetric;
+         }
+      }
+
+      if(size_t{0} != pBoosterShell->GetCountValidationPending()) {
+         // with SetValidationBatch the validation set can still be missing some of the updates of this round
+         double avgValidationMetric;
+         error = ApplyValidationUpdates(boosterHandle, &avgValidationMetric);
+         if(Error_None != error) {
+            LOG_N(Trace_Warning, "WARNING BoostGreedy ApplyValidationUpdates returned %" ErrorEbmPrintf, error);
+            goto done;
+         }
+         if(avgValidationMetric < minMetric) {
+            minMetric = avgValidationMetric;
+         }
+      }
+      ++cRounds;
+
+      if(bRefresh && size_t{0} == cTermsApplied) {
+         // every term was checked and none of them had anything left to add
+         LOG_N(Trace_Info, "BoostGreedy converged after %" IntEbmPrintf " rounds", cRounds);
+         break;
+      }
+
+      if(IntEbm{0} == cNoChangeRounds) {
+         minMetricBreakpoint = minMetric;
+      }
+      if(minMetric + earlyStoppingTolerance < minMetricBreakpoint) {
+         cNoChangeRounds = 0;
+      } else {
+         ++cNoChangeRounds;
+      }
+
+      if(IntEbm{0} < earlyStoppingRounds && earlyStoppingRounds <= cNoChangeRounds) {
+         LOG_N(Trace_Info, "BoostGreedy early stopping after %" IntEbmPrintf " rounds", cRounds);
+         break;
+      }
+   }
+   error = Error_None;
+
+done:;
+   free(aGains);
+   free(aiTermsOrdered);
+
+   if(nullptr != countRoundsOut) {
+      *countRoundsOut = cRounds;
+   }
+   if(nullptr != minMetricOut) {
+      *minMetricOut = minMetric;
+   }
+
+   LOG_0(Trace_Info, "Exited BoostGreedy");
+   return error;
+}
+
+} // namespace DEFINED_ZONE_NAME
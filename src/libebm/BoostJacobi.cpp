@@ -0,0 +1,267 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // numeric_limits
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsMultiplyError
+#include "ebm_internal.hpp"
+#include "Term.hpp"
+#include "Tensor.hpp"
+#include "BoosterCore.hpp"
+#include "BoosterShell.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+extern ErrorEbm ApplyTermUpdateInternal(BoosterShell* const pBoosterShell,
+      const size_t iTermNext,
+      const size_t cTermsFused,
+      const size_t* const aiTermsFused,
+      FloatScore* const* const aaUpdateScoresFused,
+      double* const avgValidationMetricOut);
+
+static void FreeFusedUpdates(const size_t cTerms,
+      Tensor** const apTermUpdates,
+      size_t* const aiTermsFused,
+      FloatScore** const aaUpdateScoresFused) {
+   if(nullptr != apTermUpdates) {
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         Tensor::Free(apTermUpdates[iTerm]); // legal if nullptr
+      }
+      free(apTermUpdates);
+   }
+   free(aiTermsFused);
+   free(aaUpdateScoresFused);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION BoostJacobi(void* rng,
+      BoosterHandle boosterHandle,
+      IntEbm countTerms,
+      const IntEbm* indexTerms,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      double* avgGainsOut,
+      double* avgValidationMetricOut) {
+   LOG_N(Trace_Info,
+         "Entered BoostJacobi: "
+         "rng=%p, "
+         "boosterHandle=%p, "
+         "countTerms=%" IntEbmPrintf ", "
+         "indexTerms=%p, "
+         "flags=0x%" UTermBoostFlagsPrintf ", "
+         "learningRate=%le, "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "leavesMax=%p, "
+         "avgGainsOut=%p, "
+         "avgValidationMetricOut=%p",
+         rng,
+         static_cast<void*>(boosterHandle),
+         countTerms,
+         static_cast<const void*>(indexTerms),
+         static_cast<UTermBoostFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<const void*>(leavesMax),
+         static_cast<void*>(avgGainsOut),
+         static_cast<void*>(avgValidationMetricOut));
+
+   ErrorEbm error;
+
+   if(nullptr != avgValidationMetricOut) {
+      // returning +inf means that boosting won't consider this to be an improvement
+      *avgValidationMetricOut = std::numeric_limits<double>::infinity();
+   }
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(countTerms < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR BoostJacobi countTerms must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(IntEbm{0} == countTerms) {
+      LOG_0(Trace_Warning, "WARNING BoostJacobi IntEbm { 0 } == countTerms");
+      return Error_None;
+   }
+   if(IsConvertError<size_t>(countTerms)) {
+      LOG_0(Trace_Error, "ERROR BoostJacobi IsConvertError<size_t>(countTerms)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   if(nullptr == indexTerms) {
+      LOG_0(Trace_Error, "ERROR BoostJacobi nullptr == indexTerms");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   EBM_ASSERT(nullptr != pBoosterCore);
+
+   // the last term that has anything to update goes through the objective, which computes the gradients once for
+   // the combined scores, and the updates of all the other terms are fused into that same pass
+   const IntEbm cTermsBooster = static_cast<IntEbm>(pBoosterCore->GetCountTerms());
+   size_t iMain = cTerms;
+   for(size_t i = 0; i < cTerms; ++i) {
+      const IntEbm indexTerm = indexTerms[i];
+      if(indexTerm < IntEbm{0} || cTermsBooster <= indexTerm) {
+         LOG_0(Trace_Error, "ERROR BoostJacobi indexTerms must be positive and below the number of terms that we have");
+         return Error_IllegalParamVal;
+      }
+      if(size_t{0} != pBoosterCore->GetCountScores() &&
+            size_t{0} != pBoosterCore->GetTerms()[static_cast<size_t>(indexTerm)]->GetCountTensorBins()) {
+         iMain = i;
+      }
+   }
+
+   if(IsMultiplyError(sizeof(Tensor*), cTerms) || IsMultiplyError(sizeof(size_t), cTerms) ||
+         IsMultiplyError(sizeof(FloatScore*), cTerms)) {
+      LOG_0(Trace_Warning, "WARNING BoostJacobi IsMultiplyError(sizeof(Tensor *), cTerms)");
+      return Error_OutOfMemory;
+   }
+   Tensor** const apTermUpdates = static_cast<Tensor**>(malloc(sizeof(Tensor*) * cTerms));
+   if(nullptr == apTermUpdates) {
+      LOG_0(Trace_Warning, "WARNING BoostJacobi nullptr == apTermUpdates");
+      return Error_OutOfMemory;
+   }
+   for(size_t i = 0; i < cTerms; ++i) {
+      apTermUpdates[i] = nullptr;
+   }
+   size_t* const aiTermsFused = static_cast<size_t*>(malloc(sizeof(size_t) * cTerms));
+   FloatScore** const aaUpdateScoresFused = static_cast<FloatScore**>(malloc(sizeof(FloatScore*) * cTerms));
+   if(nullptr == aiTermsFused || nullptr == aaUpdateScoresFused) {
+      LOG_0(Trace_Warning, "WARNING BoostJacobi nullptr == aiTermsFused || nullptr == aaUpdateScoresFused");
+      FreeFusedUpdates(cTerms, apTermUpdates, aiTermsFused, aaUpdateScoresFused);
+      return Error_OutOfMemory;
+   }
+
+   // Every update is generated from the same gradients, so together they take a step as large as all of the
+   // terms would each take alone. Dividing the learning rate by the number of terms keeps the combined step no
+   // larger than a single cyclic step, and callers that boost nearly independent terms can raise it again.
+   const double learningRateTerm = learningRate / static_cast<double>(cTerms);
+
+   size_t cTermsFused = 0;
+   for(size_t i = 0; i < cTerms; ++i) {
+      if(iMain == i) {
+         // generated last since its update needs to stay in the BoosterShell for ApplyTermUpdateInternal
+         continue;
+      }
+      error = GenerateTermUpdate(rng,
+            boosterHandle,
+            indexTerms[i],
+            flags,
+            learningRateTerm,
+            minSamplesLeaf,
+            minHessian,
+            regAlpha,
+            regLambda,
+            maxDeltaStep,
+            leavesMax,
+            nullptr,
+            nullptr == avgGainsOut ? nullptr : &avgGainsOut[i]);
+      if(Error_None != error) {
+         LOG_N(Trace_Warning, "WARNING BoostJacobi GenerateTermUpdate returned %" ErrorEbmPrintf, error);
+         FreeFusedUpdates(cTerms, apTermUpdates, aiTermsFused, aaUpdateScoresFused);
+         return error;
+      }
+
+      const size_t iTerm = static_cast<size_t>(indexTerms[i]);
+      const Term* const pTerm = pBoosterCore->GetTerms()[iTerm];
+      if(cTerms == iMain || size_t{0} == pTerm->GetCountTensorBins()) {
+         // nothing to apply, just like ApplyTermUpdate would do for this term
+         continue;
+      }
+
+      Tensor* const pTermUpdate = Tensor::Allocate(pTerm->GetCountDimensions(), pBoosterCore->GetCountScores());
+      if(nullptr == pTermUpdate) {
+         LOG_0(Trace_Warning, "WARNING BoostJacobi nullptr == pTermUpdate");
+         FreeFusedUpdates(cTerms, apTermUpdates, aiTermsFused, aaUpdateScoresFused);
+         return Error_OutOfMemory;
+      }
+      apTermUpdates[i] = pTermUpdate;
+
+      error = pTermUpdate->Copy(*pBoosterShell->GetTermUpdate());
+      if(Error_None != error) {
+         FreeFusedUpdates(cTerms, apTermUpdates, aiTermsFused, aaUpdateScoresFused);
+         return error;
+      }
+      error = pTermUpdate->Expand(pTerm);
+      if(Error_None != error) {
+         FreeFusedUpdates(cTerms, apTermUpdates, aiTermsFused, aaUpdateScoresFused);
+         return error;
+      }
+
+      aiTermsFused[cTermsFused] = iTerm;
+      aaUpdateScoresFused[cTermsFused] = pTermUpdate->GetTensorScoresPointer();
+      ++cTermsFused;
+   }
+
+   if(cTerms != iMain) {
+      error = GenerateTermUpdate(rng,
+            boosterHandle,
+            indexTerms[iMain],
+            flags,
+            learningRateTerm,
+            minSamplesLeaf,
+            minHessian,
+            regAlpha,
+            regLambda,
+            maxDeltaStep,
+            leavesMax,
+            nullptr,
+            nullptr == avgGainsOut ? nullptr : &avgGainsOut[iMain]);
+      if(Error_None != error) {
+         LOG_N(Trace_Warning, "WARNING BoostJacobi GenerateTermUpdate returned %" ErrorEbmPrintf, error);
+         FreeFusedUpdates(cTerms, apTermUpdates, aiTermsFused, aaUpdateScoresFused);
+         return error;
+      }
+
+      error = ApplyTermUpdateInternal(pBoosterShell,
+            BoosterShell::k_illegalTermIndex,
+            cTermsFused,
+            aiTermsFused,
+            aaUpdateScoresFused,
+            avgValidationMetricOut);
+      if(Error_None != error) {
+         LOG_N(Trace_Warning, "WARNING BoostJacobi ApplyTermUpdateInternal returned %" ErrorEbmPrintf, error);
+         FreeFusedUpdates(cTerms, apTermUpdates, aiTermsFused, aaUpdateScoresFused);
+         return error;
+      }
+   }
+
+   FreeFusedUpdates(cTerms, apTermUpdates, aiTermsFused, aaUpdateScoresFused);
+
+   LOG_0(Trace_Info, "Exited BoostJacobi");
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,602 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memset, memcpy
+#include <limits> // std::numeric_limits
+#include <mutex>
+#include <condition_variable>
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // EbmMin
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsMultiplyError
+#include "Feature.hpp"
+#include "Term.hpp"
+#include "ThreadPool.hpp"
+#include "BoosterCore.hpp"
+#include "BoosterShell.hpp"
+#include "CancelToken.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+extern ErrorEbm BoostCyclicCancellable(const CancelToken& cancelToken,
+      void* const rng,
+      const BoosterHandle boosterHandle,
+      const IntEbm maxRounds,
+      const IntEbm earlyStoppingRounds,
+      const double earlyStoppingTolerance,
+      const TermBoostFlags flags,
+      const double learningRate,
+      const IntEbm minSamplesLeaf,
+      const double minHessian,
+      const double regAlpha,
+      const double regLambda,
+      const double maxDeltaStep,
+      const IntEbm* const leavesMax,
+      IntEbm* const countRoundsOut,
+      double* const minMetricOut);
+
+extern size_t GetCountTermScores(const Term* const pTerm, const size_t cScores);
+
+// Boosts the outer bags on the shared thread pool and hands the best term scores of each bag to outerBagFinished as
+// soon as it is done, after which its booster is freed. Each thread takes the next bag that has not been started, so
+// while some threads boost their bags the others are creating the boosters of the next ones, up to cBoostersLive
+// boosters at a time. The callbacks are made one at a time, in the order that the bags finish
+static ErrorEbm RunOuterBags(const CancelToken& cancelToken,
+      void* const rng,
+      const void* const dataSet,
+      const IntEbm countOuterBags,
+      const BagEbm* const bags,
+      const IntEbm countTerms,
+      const IntEbm* const dimensionCounts,
+      const IntEbm* const featureIndexes,
+      const IntEbm countInnerBags,
+      const CreateBoosterFlags createBoosterFlags,
+      const AccelerationFlags acceleration,
+      const char* const objective,
+      const double* const experimentalParams,
+      const size_t cBoostersLive,
+      const IntEbm maxRounds,
+      const IntEbm earlyStoppingRounds,
+      const double earlyStoppingTolerance,
+      const TermBoostFlags flags,
+      const double learningRate,
+      const IntEbm minSamplesLeaf,
+      const double minHessian,
+      const double regAlpha,
+      const double regLambda,
+      const double maxDeltaStep,
+      const IntEbm* const leavesMax,
+      const OuterBagFinishedFunction outerBagFinished,
+      void* const context) {
+   EBM_ASSERT(size_t{0} != cBoostersLive);
+   EBM_ASSERT(nullptr != outerBagFinished);
+
+   ErrorEbm error;
+
+   if(nullptr == dataSet) {
+      LOG_0(Trace_Error, "ERROR RunOuterBags nullptr == dataSet");
+      return Error_IllegalParamVal;
+   }
+
+   if(countOuterBags <= IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR RunOuterBags countOuterBags must be 1 or more");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countOuterBags)) {
+      LOG_0(Trace_Warning, "WARNING RunOuterBags IsConvertError<size_t>(countOuterBags)");
+      return Error_OutOfMemory;
+   }
+   const size_t cOuterBags = static_cast<size_t>(countOuterBags);
+
+   size_t cSamples = 0;
+   if(nullptr != bags) {
+      IntEbm countSamples;
+      error = ExtractDataSetHeader(dataSet, &countSamples, nullptr, nullptr, nullptr);
+      if(Error_None != error) {
+         // already logged
+         return error;
+      }
+      EBM_ASSERT(!IsConvertError<size_t>(countSamples)); // checked when the dataset was constructed
+      cSamples = static_cast<size_t>(countSamples);
+      if(IsMultiplyError(cSamples, cOuterBags)) {
+         // the caller could not have allocated a bags array this big
+         LOG_0(Trace_Error, "ERROR RunOuterBags IsMultiplyError(cSamples, cOuterBags)");
+         return Error_IllegalParamVal;
+      }
+   }
+
+   // each outer bag gets its own random stream. We branch them here on the calling thread before starting any
+   // work so that the results do not depend on the number of threads or on the order that the bags are run in
+   const size_t cBytesRng = static_cast<size_t>(MeasureRNG());
+   unsigned char* aRngs = nullptr;
+   if(nullptr != rng) {
+      if(IsMultiplyError(cBytesRng, cOuterBags)) {
+         LOG_0(Trace_Warning, "WARNING RunOuterBags IsMultiplyError(cBytesRng, cOuterBags)");
+         return Error_OutOfMemory;
+      }
+      aRngs = static_cast<unsigned char*>(malloc(cBytesRng * cOuterBags));
+      if(nullptr == aRngs) {
+         LOG_0(Trace_Warning, "WARNING RunOuterBags nullptr == aRngs");
+         return Error_OutOfMemory;
+      }
+      for(size_t iOuterBag = 0; iOuterBag < cOuterBags; ++iOuterBag) {
+         BranchRNG(rng, aRngs + cBytesRng * iOuterBag);
+      }
+   }
+
+   ThreadPool* pThreadPool = nullptr;
+   error = ThreadPool::Borrow(cOuterBags, &pThreadPool);
+   if(Error_None != error) {
+      free(aRngs);
+      return error;
+   }
+
+   std::mutex mutexBags;
+   std::condition_variable conditionLive;
+   std::mutex mutexFinished;
+   size_t iOuterBagNext = 0;
+   size_t cLive = 0;
+   ErrorEbm errorFirst = Error_None;
+
+   auto boostOuterBag = [&](const size_t iOuterBag, double** const paTermScores) -> ErrorEbm {
+      void* const rngBag = nullptr == aRngs ? nullptr : static_cast<void*>(aRngs + cBytesRng * iOuterBag);
+      const BagEbm* const bag = nullptr == bags ? nullptr : bags + cSamples * iOuterBag;
+
+      BoosterHandle boosterHandle = nullptr;
+      ErrorEbm errorBag = CreateBooster(rngBag,
+            dataSet,
+            bag,
+            nullptr,
+            countTerms,
+            dimensionCounts,
+            featureIndexes,
+            nullptr,
+            countInnerBags,
+            createBoosterFlags,
+            acceleration,
+            objective,
+            experimentalParams,
+            nullptr,
+            &boosterHandle);
+      if(Error_None != errorBag) {
+         return errorBag;
+      }
+
+      errorBag = BoostCyclicCancellable(cancelToken,
+            rngBag,
+            boosterHandle,
+            maxRounds,
+            earlyStoppingRounds,
+            earlyStoppingTolerance,
+            flags,
+            learningRate,
+            minSamplesLeaf,
+            minHessian,
+            regAlpha,
+            regLambda,
+            maxDeltaStep,
+            leavesMax,
+            nullptr,
+            nullptr);
+      if(Error_None != errorBag) {
+         FreeBooster(boosterHandle);
+         return errorBag;
+      }
+
+      BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+      EBM_ASSERT(nullptr != pBoosterShell);
+      const BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+      const size_t cScores = pBoosterCore->GetCountScores();
+      const size_t cTerms = pBoosterCore->GetCountTerms();
+
+      // every bag has the same terms, so the buffer that a thread allocates for its first bag fits all of them
+      size_t cTotalScores = 0;
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         cTotalScores += GetCountTermScores(pBoosterCore->GetTerms()[iTerm], cScores);
+      }
+      if(size_t{0} != cTotalScores && nullptr == *paTermScores) {
+         *paTermScores = static_cast<double*>(malloc(sizeof(double) * cTotalScores));
+         if(nullptr == *paTermScores) {
+            LOG_0(Trace_Warning, "WARNING RunOuterBags nullptr == *paTermScores");
+            FreeBooster(boosterHandle);
+            return Error_OutOfMemory;
+         }
+      }
+
+      double* pTermScores = *paTermScores;
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         const size_t cTensorScores = GetCountTermScores(pBoosterCore->GetTerms()[iTerm], cScores);
+         if(size_t{0} != cTensorScores) {
+            errorBag = GetBestTermScores(boosterHandle, static_cast<IntEbm>(iTerm), pTermScores);
+            if(Error_None != errorBag) {
+               FreeBooster(boosterHandle);
+               return errorBag;
+            }
+            pTermScores += cTensorScores;
+         }
+      }
+      FreeBooster(boosterHandle);
+
+      std::lock_guard<std::mutex> lockFinished(mutexFinished);
+      return outerBagFinished(
+            context, static_cast<IntEbm>(iOuterBag), static_cast<IntEbm>(cTotalScores), *paTermScores);
+   };
+
+   auto boostOuterBags = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      UNUSED(iTask);
+      UNUSED(iThread);
+      double* aTermScores = nullptr;
+      while(true) {
+         size_t iOuterBag;
+         {
+            std::unique_lock<std::mutex> lock(mutexBags);
+            conditionLive.wait(lock, [&]() {
+               return Error_None != errorFirst || cOuterBags == iOuterBagNext || cLive < cBoostersLive;
+            });
+            if(Error_None == errorFirst && cancelToken.IsCancelled()) {
+               errorFirst = Error_Cancelled;
+            }
+            if(Error_None != errorFirst || cOuterBags == iOuterBagNext) {
+               break;
+            }
+            iOuterBag = iOuterBagNext;
+            ++iOuterBagNext;
+            ++cLive;
+         }
+
+         const ErrorEbm errorBag = boostOuterBag(iOuterBag, &aTermScores);
+
+         {
+            std::lock_guard<std::mutex> lock(mutexBags);
+            --cLive;
+            if(Error_None == errorFirst) {
+               errorFirst = errorBag;
+            }
+         }
+         conditionLive.notify_all();
+      }
+      free(aTermScores);
+      return Error_None;
+   };
+
+   // more threads than boosters would only have the extra threads waiting
+   const size_t cWorkers = EbmMin(pThreadPool->GetCountThreads(), EbmMin(cOuterBags, cBoostersLive));
+   error = pThreadPool->Run(cWorkers, boostOuterBags);
+   ThreadPool::Return(pThreadPool);
+   free(aRngs);
+
+   if(Error_None == error) {
+      error = errorFirst;
+   }
+   if(Error_None != error) {
+      LOG_N(Trace_Warning, "WARNING RunOuterBags outer bag boosting returned %" ErrorEbmPrintf, error);
+   }
+   return error;
+}
+
+// BoostOuterBags keeps the scores of every bag until all of them are done so that it can average them in outer bag
+// order, which makes the result independent of the order that the bags finish in
+struct OuterBagScores final {
+   size_t m_cOuterBags;
+   size_t m_cTotalScores;
+   double* m_aScores;
+};
+
+static ErrorEbm KeepOuterBagScores(
+      void* context, IntEbm indexOuterBag, IntEbm countTermScores, const double* termScores) {
+   OuterBagScores* const pOuterBagScores = static_cast<OuterBagScores*>(context);
+   const size_t cTotalScores = static_cast<size_t>(countTermScores);
+   if(size_t{0} == cTotalScores) {
+      return Error_None;
+   }
+   if(nullptr == pOuterBagScores->m_aScores) {
+      // the callbacks are made one at a time, so the first one can allocate for all of them
+      if(IsMultiplyError(sizeof(double), cTotalScores, pOuterBagScores->m_cOuterBags)) {
+         LOG_0(Trace_Warning, "WARNING KeepOuterBagScores IsMultiplyError(sizeof(double), cTotalScores, cOuterBags)");
+         return Error_OutOfMemory;
+      }
+      pOuterBagScores->m_aScores =
+            static_cast<double*>(malloc(sizeof(double) * cTotalScores * pOuterBagScores->m_cOuterBags));
+      if(nullptr == pOuterBagScores->m_aScores) {
+         LOG_0(Trace_Warning, "WARNING KeepOuterBagScores nullptr == m_aScores");
+         return Error_OutOfMemory;
+      }
+      pOuterBagScores->m_cTotalScores = cTotalScores;
+   }
+   EBM_ASSERT(pOuterBagScores->m_cTotalScores == cTotalScores);
+   memcpy(pOuterBagScores->m_aScores + cTotalScores * static_cast<size_t>(indexOuterBag),
+         termScores,
+         sizeof(double) * cTotalScores);
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION BoostOuterBags(void* rng,
+      const void* dataSet,
+      IntEbm countOuterBags,
+      const BagEbm* bags,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      IntEbm countInnerBags,
+      CreateBoosterFlags createBoosterFlags,
+      AccelerationFlags acceleration,
+      const char* objective,
+      const double* experimentalParams,
+      IntEbm maxRounds,
+      IntEbm earlyStoppingRounds,
+      double earlyStoppingTolerance,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      double* avgTermScoresOut) {
+   LOG_N(Trace_Info,
+         "Entered BoostOuterBags: "
+         "rng=%p, "
+         "dataSet=%p, "
+         "countOuterBags=%" IntEbmPrintf ", "
+         "bags=%p, "
+         "countTerms=%" IntEbmPrintf ", "
+         "dimensionCounts=%p, "
+         "featureIndexes=%p, "
+         "countInnerBags=%" IntEbmPrintf ", "
+         "createBoosterFlags=0x%" UCreateBoosterFlagsPrintf ", "
+         "acceleration=0x%" UAccelerationFlagsPrintf ", "
+         "objective=%p, "
+         "experimentalParams=%p, "
+         "maxRounds=%" IntEbmPrintf ", "
+         "earlyStoppingRounds=%" IntEbmPrintf ", "
+         "earlyStoppingTolerance=%le, "
+         "flags=0x%" UTermBoostFlagsPrintf ", "
+         "learningRate=%le, "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "leavesMax=%p, "
+         "avgTermScoresOut=%p",
+         rng,
+         dataSet,
+         countOuterBags,
+         static_cast<const void*>(bags),
+         countTerms,
+         static_cast<const void*>(dimensionCounts),
+         static_cast<const void*>(featureIndexes),
+         countInnerBags,
+         static_cast<UCreateBoosterFlags>(createBoosterFlags), // signed to unsigned conversion is defined behavior
+         static_cast<UAccelerationFlags>(acceleration), // signed to unsigned conversion is defined behavior in C++
+         static_cast<const void*>(objective), // do not print the string for security reasons
+         static_cast<const void*>(experimentalParams),
+         maxRounds,
+         earlyStoppingRounds,
+         earlyStoppingTolerance,
+         static_cast<UTermBoostFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<const void*>(leavesMax),
+         static_cast<void*>(avgTermScoresOut));
+
+   // taken before any outer bag is scheduled so that a cancel also stops the bags still waiting for a thread
+   const CancelToken cancelToken;
+
+   OuterBagScores outerBagScores;
+   outerBagScores.m_cOuterBags = IntEbm{0} < countOuterBags ? static_cast<size_t>(countOuterBags) : size_t{0};
+   outerBagScores.m_cTotalScores = 0;
+   outerBagScores.m_aScores = nullptr;
+
+   // every booster is freed once its scores are kept, so there is no need to limit how many exist at once
+   ErrorEbm error = RunOuterBags(cancelToken,
+         rng,
+         dataSet,
+         countOuterBags,
+         bags,
+         countTerms,
+         dimensionCounts,
+         featureIndexes,
+         countInnerBags,
+         createBoosterFlags,
+         acceleration,
+         objective,
+         experimentalParams,
+         std::numeric_limits<size_t>::max(),
+         maxRounds,
+         earlyStoppingRounds,
+         earlyStoppingTolerance,
+         flags,
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         leavesMax,
+         KeepOuterBagScores,
+         &outerBagScores);
+   if(Error_None != error) {
+      free(outerBagScores.m_aScores);
+      return error;
+   }
+
+   const size_t cOuterBags = outerBagScores.m_cOuterBags;
+   const size_t cTotalScores = outerBagScores.m_cTotalScores;
+   if(size_t{0} != cTotalScores) {
+      if(nullptr == avgTermScoresOut) {
+         LOG_0(Trace_Error, "ERROR BoostOuterBags avgTermScoresOut cannot be nullptr");
+         free(outerBagScores.m_aScores);
+         return Error_IllegalParamVal;
+      }
+
+      memset(avgTermScoresOut, 0, sizeof(*avgTermScoresOut) * cTotalScores);
+
+      // sum in outer bag order so that the floating point result is deterministic
+      const double* pScores = outerBagScores.m_aScores;
+      for(size_t iOuterBag = 0; iOuterBag < cOuterBags; ++iOuterBag) {
+         for(size_t iScore = 0; iScore < cTotalScores; ++iScore) {
+            avgTermScoresOut[iScore] += pScores[iScore];
+         }
+         pScores += cTotalScores;
+      }
+
+      const double outerBagsDouble = static_cast<double>(cOuterBags);
+      for(size_t iScore = 0; iScore < cTotalScores; ++iScore) {
+         avgTermScoresOut[iScore] /= outerBagsDouble;
+      }
+   }
+   free(outerBagScores.m_aScores);
+
+   LOG_0(Trace_Info, "Exited BoostOuterBags");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION BoostOuterBagsStreaming(void* rng,
+      const void* dataSet,
+      IntEbm countOuterBags,
+      const BagEbm* bags,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      IntEbm countInnerBags,
+      CreateBoosterFlags createBoosterFlags,
+      AccelerationFlags acceleration,
+      const char* objective,
+      const double* experimentalParams,
+      IntEbm maxBoostersLive,
+      IntEbm maxRounds,
+      IntEbm earlyStoppingRounds,
+      double earlyStoppingTolerance,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      OuterBagFinishedFunction outerBagFinished,
+      void* context) {
+   LOG_N(Trace_Info,
+         "Entered BoostOuterBagsStreaming: "
+         "rng=%p, "
+         "dataSet=%p, "
+         "countOuterBags=%" IntEbmPrintf ", "
+         "bags=%p, "
+         "countTerms=%" IntEbmPrintf ", "
+         "dimensionCounts=%p, "
+         "featureIndexes=%p, "
+         "countInnerBags=%" IntEbmPrintf ", "
+         "createBoosterFlags=0x%" UCreateBoosterFlagsPrintf ", "
+         "acceleration=0x%" UAccelerationFlagsPrintf ", "
+         "objective=%p, "
+         "experimentalParams=%p, "
+         "maxBoostersLive=%" IntEbmPrintf ", "
+         "maxRounds=%" IntEbmPrintf ", "
+         "earlyStoppingRounds=%" IntEbmPrintf ", "
+         "earlyStoppingTolerance=%le, "
+         "flags=0x%" UTermBoostFlagsPrintf ", "
+         "learningRate=%le, "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "leavesMax=%p, "
+         "outerBagFinished=%p, "
+         "context=%p",
+         rng,
+         dataSet,
+         countOuterBags,
+         static_cast<const void*>(bags),
+         countTerms,
+         static_cast<const void*>(dimensionCounts),
+         static_cast<const void*>(featureIndexes),
+         countInnerBags,
+         static_cast<UCreateBoosterFlags>(createBoosterFlags), // signed to unsigned conversion is defined behavior
+         static_cast<UAccelerationFlags>(acceleration), // signed to unsigned conversion is defined behavior in C++
+         static_cast<const void*>(objective), // do not print the string for security reasons
+         static_cast<const void*>(experimentalParams),
+         maxBoostersLive,
+         maxRounds,
+         earlyStoppingRounds,
+         earlyStoppingTolerance,
+         static_cast<UTermBoostFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<const void*>(leavesMax),
+         reinterpret_cast<void*>(outerBagFinished),
+         context);
+
+   // taken before any outer bag is scheduled so that a cancel also stops the bags still waiting for a thread
+   const CancelToken cancelToken;
+
+   if(nullptr == outerBagFinished) {
+      LOG_0(Trace_Error, "ERROR BoostOuterBagsStreaming nullptr == outerBagFinished");
+      return Error_IllegalParamVal;
+   }
+   if(maxBoostersLive < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR BoostOuterBagsStreaming maxBoostersLive must be positive");
+      return Error_IllegalParamVal;
+   }
+   size_t cBoostersLive = std::numeric_limits<size_t>::max();
+   if(IntEbm{0} != maxBoostersLive && !IsConvertError<size_t>(maxBoostersLive)) {
+      cBoostersLive = static_cast<size_t>(maxBoostersLive);
+   }
+
+   const ErrorEbm error = RunOuterBags(cancelToken,
+         rng,
+         dataSet,
+         countOuterBags,
+         bags,
+         countTerms,
+         dimensionCounts,
+         featureIndexes,
+         countInnerBags,
+         createBoosterFlags,
+         acceleration,
+         objective,
+         experimentalParams,
+         cBoostersLive,
+         maxRounds,
+         earlyStoppingRounds,
+         earlyStoppingTolerance,
+         flags,
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         leavesMax,
+         outerBagFinished,
+         context);
+
+   LOG_0(Trace_Info, "Exited BoostOuterBagsStreaming");
+   return error;
+}
+
+} // namespace DEFINED_ZONE_NAME
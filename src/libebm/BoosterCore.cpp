@@ -4,28 +4,27 @@
 
 #include "pch.hpp"
 
-#include <stdlib.h> // free
+#include <stdlib.h> // malloc, free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memset, memcmp
 #include <limits> // numeric_limits
-#include <thread>
 
 #include "logging.h" // EBM_ASSERT
 
 #define ZONE_main
 #include "zones.h"
 
-#include "common.hpp" // IsConvertError, IsMultiplyError
-#include "Bin.hpp" // IsOverflowBinSize
+#include "common.hpp" // IsMultiplyError
 
 #include "ebm_internal.hpp"
-#include "dataset_shared.hpp" // GetDataSetSharedHeader
 #include "Tensor.hpp" // Tensor
-#include "Feature.hpp" // Feature
 #include "Term.hpp" // Term
 #include "InnerBag.hpp" // InnerBag
-#include "TreeNode.hpp" // IsOverflowTreeNodeSize
-#include "SplitPosition.hpp" // IsOverflowSplitPositionSize
+#include "RandomDeterministic.hpp" // RandomDeterministic
+#include "ThreadPool.hpp"
+#include "Profile.hpp"
 #include "BoosterCore.hpp"
+#include "ModelSnapshot.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -34,17 +33,6 @@ namespace DEFINED_ZONE_NAME {
 
 class RandomDeterministic;
 
-extern ErrorEbm Unbag(const size_t cSamples,
-      const BagEbm* const aBag,
-      size_t* const pcTrainingSamplesOut,
-      size_t* const pcValidationSamplesOut);
-
-NEVER_INLINE extern ErrorEbm GetObjective(const Config* const pConfig,
-      const char* sObjective,
-      const AccelerationFlags acceleration,
-      ObjectiveWrapper* const pCpuObjectiveWrapperOut,
-      ObjectiveWrapper* const pSIMDObjectiveWrapperOut) noexcept;
-
 void BoosterCore::DeleteTensors(const size_t cTerms, Tensor** const apTensors) {
    LOG_0(Trace_Info, "Entered DeleteTensors");
 
@@ -123,18 +111,24 @@ ErrorEbm BoosterCore::InitializeTensors(
 BoosterCore::~BoosterCore() {
    // this only gets called after our reference count has been decremented to zero
 
-   m_trainingSet.DestructDataSetBoosting(m_cTerms, m_cInnerBags);
-   m_validationSet.DestructDataSetBoosting(m_cTerms, 0);
+   // we only get here without prepared data if Create failed before taking a reference, and then nothing was built
+   const size_t cTerms = nullptr == m_pPreparedTrainingData ? size_t{0} : m_pPreparedTrainingData->GetCountTerms();
+
+   m_trainingSet.DestructDataSetBoosting(cTerms, m_cInnerBags);
+   m_validationSet.DestructDataSetBoosting(cTerms, 0);
 
-   Term::FreeTerms(m_cTerms, m_apTerms);
+   DeleteTensors(cTerms, m_apCurrentTermTensors);
+   DeleteTensors(cTerms, m_apBestTermTensors);
+   free(m_abBestTermStale);
+   free(m_aiBestTermStale);
 
-   free(m_aFeatures);
+   ModelSnapshot::Free(m_pSnapshot);
+   free(m_aSnapshotStale);
+   free(m_aiSnapshotStale);
 
-   DeleteTensors(m_cTerms, m_apCurrentTermTensors);
-   DeleteTensors(m_cTerms, m_apBestTermTensors);
+   Profile::Free(m_pProfile);
 
-   FreeObjectiveWrapperInternals(&m_objectiveCpu);
-   FreeObjectiveWrapperInternals(&m_objectiveSIMD);
+   PreparedTrainingData::Free(m_pPreparedTrainingData);
 };
 
 void BoosterCore::Free(BoosterCore* const pBoosterCore) {
@@ -161,149 +155,25 @@ void BoosterCore::Free(BoosterCore* const pBoosterCore) {
    LOG_0(Trace_Info, "Exited BoosterCore::Free");
 }
 
-template<typename TUInt>
-static bool CheckBoosterRestrictionsInternal(const BoosterCore* const pBoosterCore,
-      const ObjectiveWrapper* const pObjectiveWrapper,
-      const size_t cTensorBinsMax) {
-   EBM_ASSERT(nullptr != pBoosterCore);
-   EBM_ASSERT(nullptr != pObjectiveWrapper);
-   EBM_ASSERT(1 <= pBoosterCore->GetCountTerms());
-
-   const size_t cScores = pBoosterCore->GetCountScores();
-
-   if(IsConvertError<TUInt>(cScores)) {
-      // restriction from LogLossMulticlassObjective.hpp
-      // we cast the cScores value into a SIMD type before later multiplying.  If cScores was 1 + the max SIMD type
-      // value then it could overflow back to 0 before the multiplication. Normally this would be very rare, but
-      // we need to consider adversarial inputs to make this crash.
-
-      return true;
-   }
-
-   const bool bHessian = EBM_FALSE != pObjectiveWrapper->m_bObjectiveHasHessian;
-
-   // In BinSumsBoosting we calculate the BinSize value and put it into a SIMD pack, so it needs to fit
-   size_t cBytes;
-   if(sizeof(FloatBig) == pObjectiveWrapper->m_cFloatBytes) {
-      if(IsOverflowBinSize<FloatBig, TUInt>(false, false, bHessian, cScores)) {
-         return true;
-      }
-      cBytes = GetBinSize<FloatBig, TUInt>(false, false, bHessian, cScores);
-   } else {
-      EBM_ASSERT(sizeof(FloatSmall) == pObjectiveWrapper->m_cFloatBytes);
-      if(IsOverflowBinSize<FloatSmall, TUInt>(false, false, bHessian, cScores)) {
-         return true;
-      }
-      cBytes = GetBinSize<FloatSmall, TUInt>(false, false, bHessian, cScores);
-   }
-
-   EBM_ASSERT(1 <= cTensorBinsMax); // since cTensorBins can only be 0 if cSamples or cTerms is 0, and we checked that
-   if(IsMultiplyError(cTensorBinsMax, EbmMax(cBytes, cScores))) {
-      return true;
-   }
-   if(IsConvertError<typename std::make_signed<TUInt>::type>(cTensorBinsMax * cScores - size_t{1})) {
-      // In all objectives we take the binned feature index and use it to lookup the score update in the update
-      // tensor. The lookup indexes are packed together in an array of SIMDable integers, so obviously the SIMDable
-      // integer needs to be large enough to hold the maximum feature index.
-      //
-      // Additionally, we use a SIMD gather operations in the objectives to load from the score update tensor, which
-      // use signed indexes, which means we need to restrict ourselves to the range of positive values.
-
-      return true;
-   }
-   cBytes *= cTensorBinsMax;
-   EBM_ASSERT(1 <= cBytes); // since cTensorBinsMax is non-zero
-   if(IsConvertError<TUInt>(cBytes - 1)) {
-      // In BinSumsBoosting we use the SIMD pack to hold an index to memory, so we need to be able to hold
-      // the entire fast bin tensor
-      return true;
-   }
-
-   if(size_t{1} != cScores) {
-      // TODO: we currently index into the gradient array using the target, but the gradient array is also
-      // layed out per-SIMD pack.  Once we sort the dataset by the target we'll be able to use non-random
-      // indexing to fetch all the sample targets simultaneously, and we'll no longer need this indexing
-      size_t cIndexes = cScores;
-      if(bHessian) {
-         if(IsMultiplyError(size_t{2}, cIndexes)) {
-            return true;
-         }
-         cIndexes <<= 1;
-      }
-      if(IsMultiplyError(cIndexes, pObjectiveWrapper->m_cSIMDPack)) {
-         return true;
-      }
-      // restriction from LogLossMulticlassObjective.hpp
-      // we use the target value to index into the temp exp array and adjust the target gradient
-      if(IsConvertError<typename std::make_signed<TUInt>::type>(
-               cIndexes * pObjectiveWrapper->m_cSIMDPack - size_t{1})) {
-         return true;
-      }
-   }
-
-   return false;
-}
-
-static bool CheckBoosterRestrictions(const BoosterCore* const pBoosterCore,
-      const ObjectiveWrapper* const pObjectiveWrapper,
-      const size_t cTensorBinsMax) {
-   EBM_ASSERT(nullptr != pObjectiveWrapper);
-   if(sizeof(UIntBig) == pObjectiveWrapper->m_cUIntBytes) {
-      return CheckBoosterRestrictionsInternal<UIntBig>(pBoosterCore, pObjectiveWrapper, cTensorBinsMax);
-   } else {
-      EBM_ASSERT(sizeof(UIntSmall) == pObjectiveWrapper->m_cUIntBytes);
-      return CheckBoosterRestrictionsInternal<UIntSmall>(pBoosterCore, pObjectiveWrapper, cTensorBinsMax);
-   }
-}
-
-// static int g_TODO_removeThisThreadTest = 0;
-// void TODO_removeThisThreadTest() {
-//    g_TODO_removeThisThreadTest = 1;
-// }
-
 ErrorEbm BoosterCore::Create(void* const rng,
-      const size_t cTerms,
+      PreparedTrainingData* const pPreparedTrainingData,
       const size_t cInnerBags,
-      const double* const experimentalParams,
-      const IntEbm* const acTermDimensions,
-      const IntEbm* const aiTermFeatures,
-      const unsigned char* const pDataSetShared,
-      const BagEbm* const aBag,
       const double* const aInitScores,
-      const CreateBoosterFlags flags,
-      const AccelerationFlags acceleration,
-      const char* const sObjective,
+      const uint8_t* const aFoldMask,
       BoosterCore** const ppBoosterCoreOut) {
-   // experimentalParams isn't used by default.  It's meant to provide an easy way for python or other higher
-   // level languages to pass EXPERIMENTAL temporary parameters easily to the C++ code.
-   UNUSED(experimentalParams);
-
    LOG_0(Trace_Info, "Entered BoosterCore::Create");
 
+   EBM_ASSERT(nullptr != pPreparedTrainingData);
    EBM_ASSERT(nullptr != ppBoosterCoreOut);
    EBM_ASSERT(nullptr == *ppBoosterCoreOut);
-   EBM_ASSERT(nullptr != pDataSetShared);
 
    ErrorEbm error;
 
-   // try {
-   //    // TODO: eliminate this code I added to test that threads are available on the majority of our systems
-   //    std::thread testThread(TODO_removeThisThreadTest);
-   //    testThread.join();
-   //    if(0 == g_TODO_removeThisThreadTest) {
-   //       LOG_0(Trace_Warning, "WARNING BoosterCore::Create thread not started");
-   //       return Error_UnexpectedInternal;
-   //    }
-   // } catch(const std::bad_alloc &) {
-   //    LOG_0(Trace_Warning, "WARNING BoosterCore::Create thread start out of memory");
-   //    return Error_OutOfMemory;
-   // } catch(...) {
-   //    // the C++ standard doesn't really seem to say what kind of exceptions we'd get for various errors, so
-   //    // about the best we can do is catch(...) since the exact exceptions seem to be implementation specific
-   //    LOG_0(Trace_Warning, "WARNING BoosterCore::Create thread start failed");
-   //    return Error_ThreadStartFailed;
-   // }
-   // LOG_0(Trace_Info, "INFO BoosterCore::Create thread started");
+   if(pPreparedTrainingData->IsOutOfBagMetric() && size_t{0} == cInnerBags) {
+      // without inner bags every training sample is in the bag, so no sample could be out of bag
+      LOG_0(Trace_Error, "ERROR BoosterCore::Create CreateBoosterFlags_OutOfBagMetric requires inner bags");
+      return Error_IllegalParamVal;
+   }
 
    BoosterCore* pBoosterCore;
    try {
@@ -323,577 +193,315 @@ ErrorEbm BoosterCore::Create(void* const rng,
    // give ownership of our object back to the caller, even if there is a failure
    *ppBoosterCoreOut = pBoosterCore;
 
-   pBoosterCore->m_bUseApprox = CreateBoosterFlags_UseApprox & flags ? EBM_TRUE : EBM_FALSE;
+   pPreparedTrainingData->AddReferenceCount();
+   pBoosterCore->m_pPreparedTrainingData = pPreparedTrainingData;
 
-   UIntShared countSamples;
-   size_t cFeatures;
-   size_t cWeights;
-   size_t cTargets;
-   error = GetDataSetSharedHeader(pDataSetShared, &countSamples, &cFeatures, &cWeights, &cTargets);
-   if(Error_None != error) {
-      // already logged
-      return error;
+   if(pPreparedTrainingData->IsProfile()) {
+      pBoosterCore->m_pProfile = Profile::Create();
+      if(nullptr == pBoosterCore->m_pProfile) {
+         // already logged
+         return Error_OutOfMemory;
+      }
    }
 
-   if(IsConvertError<size_t>(countSamples)) {
-      LOG_0(Trace_Error, "ERROR BoosterCore::Create IsConvertError<size_t>(countSamples)");
-      return Error_IllegalParamVal;
-   }
-   if(IsConvertError<UIntMain>(countSamples)) {
-      LOG_0(Trace_Error, "ERROR BoosterCore::Create IsConvertError<UIntMain>(countSamples)");
-      return Error_IllegalParamVal;
-   }
-   size_t cSamples = static_cast<size_t>(countSamples);
+   const size_t cScores = pPreparedTrainingData->GetCountScores();
+   const size_t cTerms = pPreparedTrainingData->GetCountTerms();
+   if(size_t{0} != cScores && size_t{0} != cTerms) {
+      // the prepared data only picks a thread count when there are samples to split into subsets
+      const size_t cThreads = pPreparedTrainingData->GetCountThreads();
+      if(size_t{0} != cThreads) {
+         const bool bRmse = pBoosterCore->IsRmse();
+
+         // boosters that draw the same inner bags from the same prepared data share the per term bin counts and
+         // weights, so only the first one of them needs to visit every sample for every term and bag. Fold boosters
+         // draw their bags from their own fold, so they neither use nor fill that cache
+         RandomDeterministic rngBefore;
+         if(nullptr != rng) {
+            rngBefore.Initialize(*reinterpret_cast<const RandomDeterministic*>(rng));
+         }
+         const bool bCachedBags =
+               nullptr == aFoldMask && pPreparedTrainingData->LookupCachedBags(rng, cInnerBags);
+
+         const ProfileTimer timer(pBoosterCore->m_pProfile);
+
+         pBoosterCore->m_cInnerBags = cInnerBags; // this is used to destruct m_trainingSet, so store it first
+         error = pBoosterCore->m_trainingSet.InitDataSetBoosting(pPreparedTrainingData->GetTrainingSet(),
+               true,
+               pBoosterCore->IsHessian(),
+               pBoosterCore->IsCompressGradients(),
+               !bRmse,
+               true,
+               bCachedBags,
+               rng,
+               cScores,
+               BagEbm{1},
+               pPreparedTrainingData->GetBag(),
+               aInitScores,
+               aFoldMask,
+               cInnerBags,
+               cTerms,
+               pPreparedTrainingData->GetTerms());
+         if(Error_None != error) {
+            return error;
+         }
+         if(!bCachedBags && nullptr == aFoldMask) {
+            pPreparedTrainingData->CacheBags(&rngBefore, rng, cInnerBags, &pBoosterCore->m_trainingSet);
+         }
 
-   if(size_t{1} < cWeights) {
-      LOG_0(Trace_Warning, "WARNING BoosterCore::Create size_t { 1 } < cWeights");
-      return Error_IllegalParamVal;
-   }
-   if(size_t{1} != cTargets) {
-      LOG_0(Trace_Warning, "WARNING BoosterCore::Create 1 != cTargets");
-      return Error_IllegalParamVal;
-   }
+         if(pPreparedTrainingData->IsOutOfBagMetric() && size_t{0} != pBoosterCore->m_trainingSet.GetCountSamples()) {
+            error = pBoosterCore->m_trainingSet.InitOutOfBagWeights(cInnerBags);
+            if(Error_None != error) {
+               return error;
+            }
+            if(0.0 == pBoosterCore->m_trainingSet.GetOutOfBagWeightTotal()) {
+               LOG_0(Trace_Error,
+                     "ERROR BoosterCore::Create CreateBoosterFlags_OutOfBagMetric requires a sample that no inner bag "
+                     "draws");
+               return Error_UserParamVal;
+            }
+         }
 
-   LOG_0(Trace_Info, "BoosterCore::Create starting feature processing");
-   if(0 != cFeatures) {
-      pBoosterCore->m_cFeatures = cFeatures;
+         DataSetBoosting* const pTrainingSet = &pBoosterCore->m_trainingSet;
+         if(size_t{2} <= cThreads && size_t{2} <= ThreadPool::GetCountNumaNodes() &&
+               size_t{0} != pTrainingSet->GetCountSamples()) {
+            // every boosting loop runs training subset iSubset on worker iSubset % cThreads of the shared pool, and
+            // the workers are pinned to NUMA nodes, so move each subset's gradients and scores to the node of the
+            // worker that bins them. The packed term data is shared with the other boosters of the prepared data, so
+            // it stays put.
+            const bool bHessian = pBoosterCore->IsHessian();
+            const bool bCompressGradients = pBoosterCore->IsCompressGradients();
+            auto localizeSubset = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+               UNUSED(iThread);
+               return pTrainingSet->LocalizeSubset(iTask, cScores, bHessian, bCompressGradients);
+            };
+            ThreadPool* pThreadPool = nullptr;
+            error = ThreadPool::Borrow(cThreads, &pThreadPool);
+            if(Error_None != error) {
+               return error;
+            }
+            error = pThreadPool->RunAffine(pTrainingSet->GetCountSubsets(), localizeSubset);
+            ThreadPool::Return(pThreadPool);
+            if(Error_None != error) {
+               return error;
+            }
+         }
+
+         error = pBoosterCore->m_validationSet.InitDataSetBoosting(pPreparedTrainingData->GetValidationSet(),
+               bRmse,
+               false,
+               false,
+               !bRmse,
+               false,
+               false,
+               rng,
+               cScores,
+               BagEbm{-1},
+               pPreparedTrainingData->GetBag(),
+               aInitScores,
+               nullptr,
+               0,
+               cTerms,
+               pPreparedTrainingData->GetTerms());
+         if(Error_None != error) {
+            return error;
+         }
+
+         timer.Stop(ProfileSection_DataSet,
+               pBoosterCore->m_trainingSet.GetCountSamples() + pBoosterCore->m_validationSet.GetCountSamples(),
+               0);
+      }
 
-      if(IsMultiplyError(sizeof(FeatureBoosting), cFeatures)) {
-         LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(sizeof(Feature), cFeatures)");
+      error = InitializeTensors(
+            cTerms, pPreparedTrainingData->GetTerms(), cScores, &pBoosterCore->m_apCurrentTermTensors);
+      if(Error_None != error) {
+         return error;
+      }
+      error = InitializeTensors(cTerms, pPreparedTrainingData->GetTerms(), cScores, &pBoosterCore->m_apBestTermTensors);
+      if(Error_None != error) {
+         return error;
+      }
+
+      if(IsMultiplyError(sizeof(bool), cTerms)) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(sizeof(bool), cTerms)");
          return Error_OutOfMemory;
       }
-      FeatureBoosting* const aFeatures = static_cast<FeatureBoosting*>(malloc(sizeof(FeatureBoosting) * cFeatures));
-      if(nullptr == aFeatures) {
-         LOG_0(Trace_Warning, "WARNING BoosterCore::Create nullptr == aFeatures");
+      bool* const abBestTermStale = static_cast<bool*>(malloc(sizeof(bool) * cTerms));
+      if(nullptr == abBestTermStale) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::Create nullptr == abBestTermStale");
          return Error_OutOfMemory;
       }
-      pBoosterCore->m_aFeatures = aFeatures;
-
-      size_t iFeatureInitialize = size_t{0};
-      do {
-         bool bMissing;
-         bool bUnknown;
-         bool bNominal;
-         bool bSparse;
-         UIntShared countBins;
-         UIntShared defaultValSparse;
-         size_t cNonDefaultsSparse;
-         GetDataSetSharedFeature(pDataSetShared,
-               iFeatureInitialize,
-               &bMissing,
-               &bUnknown,
-               &bNominal,
-               &bSparse,
-               &countBins,
-               &defaultValSparse,
-               &cNonDefaultsSparse);
-         EBM_ASSERT(!bSparse); // we do not handle yet
-         if(IsConvertError<size_t>(countBins)) {
-            LOG_0(Trace_Error, "ERROR BoosterCore::Create IsConvertError<size_t>(countBins)");
-            return Error_IllegalParamVal;
-         }
-         if(IsConvertError<UIntSplit>(countBins)) {
-            LOG_0(Trace_Error, "ERROR BoosterCore::Create IsConvertError<UIntSplit>(countBins)");
-            return Error_IllegalParamVal;
-         }
-         const size_t cBins = static_cast<size_t>(countBins);
-         if(0 == cBins) {
-            if(0 != cSamples) {
-               LOG_0(Trace_Error, "ERROR BoosterCore::Create countBins cannot be zero unless there are zero samples");
-               return Error_IllegalParamVal;
-            }
-
-            // we can handle 0 == cBins even though that's a degenerate case that shouldn't be boosted on.  0 bins
-            // can only occur if there were zero training and zero validation cases since the
-            // features would require a value, even if it was 0.
-            LOG_0(Trace_Info, "INFO BoosterCore::Create feature with 0 values");
-         } else if(1 == cBins) {
-            // Dimensions with 1 bin don't contribute anything to the model since they always have the same value, but
-            // the user can specify interactions, so we handle them anyways in a consistent way by boosting on them
-            LOG_0(Trace_Info, "INFO BoosterCore::Create feature with 1 value");
-         }
-         aFeatures[iFeatureInitialize].Initialize(cBins, bMissing, bUnknown, bNominal);
+      // the current and best models both start at zero
+      memset(abBestTermStale, 0, sizeof(bool) * cTerms);
+      pBoosterCore->m_abBestTermStale = abBestTermStale;
 
-         ++iFeatureInitialize;
-      } while(cFeatures != iFeatureInitialize);
-   }
-   LOG_0(Trace_Info, "BoosterCore::Create done feature processing");
-
-   size_t cTensorBinsMax = 0;
-   size_t cMainBinsMax = 0;
-   size_t cSingleDimensionBinsMax = 0;
-
-   LOG_0(Trace_Info, "BoosterCore::Create starting term processing");
-   if(0 != cTerms) {
-      pBoosterCore->m_cTerms = cTerms;
-      pBoosterCore->m_apTerms = Term::AllocateTerms(cTerms);
-      if(UNLIKELY(nullptr == pBoosterCore->m_apTerms)) {
-         LOG_0(Trace_Warning, "WARNING BoosterCore::Create 0 != m_cTerms && nullptr == m_apTerms");
+      if(IsMultiplyError(sizeof(size_t), cTerms)) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(sizeof(size_t), cTerms)");
+         return Error_OutOfMemory;
+      }
+      size_t* const aiBestTermStale = static_cast<size_t*>(malloc(sizeof(size_t) * cTerms));
+      if(nullptr == aiBestTermStale) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::Create nullptr == aiBestTermStale");
          return Error_OutOfMemory;
       }
+      pBoosterCore->m_aiBestTermStale = aiBestTermStale;
 
-      const IntEbm* piTermFeature = aiTermFeatures;
-      size_t iTerm = 0;
-      do {
-         const IntEbm countDimensions = acTermDimensions[iTerm];
-         if(countDimensions < IntEbm{0}) {
-            LOG_0(Trace_Error, "ERROR BoosterCore::Create countDimensions cannot be negative");
-            return Error_IllegalParamVal;
-         }
-         if(IntEbm{k_cDimensionsMax} < countDimensions) {
-            LOG_0(Trace_Warning,
-                  "WARNING BoosterCore::Create countDimensions too large and would cause out of memory condition");
+      if(pPreparedTrainingData->IsModelSnapshots()) {
+         unsigned char* const aSnapshotStale = static_cast<unsigned char*>(malloc(sizeof(unsigned char) * cTerms));
+         if(nullptr == aSnapshotStale) {
+            LOG_0(Trace_Warning, "WARNING BoosterCore::Create nullptr == aSnapshotStale");
             return Error_OutOfMemory;
          }
-         const size_t cDimensions = static_cast<size_t>(countDimensions);
-         Term* const pTerm = Term::Allocate(cDimensions);
-         if(nullptr == pTerm) {
-            LOG_0(Trace_Warning, "WARNING BoosterCore::Create nullptr == pTerm");
+         memset(aSnapshotStale, 0, sizeof(unsigned char) * cTerms);
+         pBoosterCore->m_aSnapshotStale = aSnapshotStale;
+
+         size_t* const aiSnapshotStale = static_cast<size_t*>(malloc(sizeof(size_t) * cTerms));
+         if(nullptr == aiSnapshotStale) {
+            LOG_0(Trace_Warning, "WARNING BoosterCore::Create nullptr == aiSnapshotStale");
             return Error_OutOfMemory;
          }
-         // assign our pointer directly to our array right now so that we can't loose the memory if we decide to exit
-         // due to an error below
-         pBoosterCore->m_apTerms[iTerm] = pTerm;
-
-         pTerm->SetCountAuxillaryBins(0); // we only use these for pairs, so otherwise it gets left as zero
-
-         size_t cAuxillaryBinsForBuildFastTotals = 0;
-         size_t cRealDimensions = 0;
-         int cBitsRequiredMin = 0;
-         size_t cTensorBins = 1;
-         if(UNLIKELY(0 == cDimensions)) {
-            LOG_0(Trace_Info, "INFO BoosterCore::Create empty term");
-
-            cTensorBinsMax = EbmMax(cTensorBinsMax, size_t{1});
-            cMainBinsMax = EbmMax(cMainBinsMax, size_t{1});
-         } else {
-            if(nullptr == piTermFeature) {
-               LOG_0(Trace_Error,
-                     "ERROR BoosterCore::Create aiTermFeatures cannot be NULL when there are Terms with non-zero "
-                     "numbers of features");
-               return Error_IllegalParamVal;
-            }
-            size_t cSingleDimensionBins = 0;
-            TermFeature* pTermFeature = pTerm->GetTermFeatures();
-            const TermFeature* const pTermFeaturesEnd = &pTermFeature[cDimensions];
-            // TODO: Ideally we would flip our input dimensions so that we're aligned with the output ordering
-            //       and thus not need a transpose when transfering data to the caller. We're doing it this way
-            //       for now to test the transpose ability and also to maintain the same results as before for
-            //       comparison
-            size_t iTranspose = cDimensions - 1;
-            do {
-               const IntEbm indexFeature = *piTermFeature;
-               if(indexFeature < IntEbm{0}) {
-                  LOG_0(Trace_Error, "ERROR BoosterCore::Create aiTermFeatures value cannot be negative");
-                  return Error_IllegalParamVal;
-               }
-               if(IsConvertError<size_t>(indexFeature)) {
-                  LOG_0(Trace_Error, "ERROR BoosterCore::Create aiTermFeatures value too big to reference memory");
-                  return Error_IllegalParamVal;
-               }
-               const size_t iFeature = static_cast<size_t>(indexFeature);
-
-               if(cFeatures <= iFeature) {
-                  LOG_0(Trace_Error,
-                        "ERROR BoosterCore::Create aiTermFeatures value must be less than the number of features");
-                  return Error_IllegalParamVal;
-               }
-
-               EBM_ASSERT(1 <= cFeatures); // since our iFeature is valid and index 0 would mean cFeatures == 1
-               EBM_ASSERT(nullptr != pBoosterCore->m_aFeatures);
-
-               // Clang does not seems to understand that iFeature is bound to the legal
-               // range of m_aFeatures through the check "cFeatures <= iFeature" above
-               StopClangAnalysis();
-
-               const FeatureBoosting* const pInputFeature = &pBoosterCore->m_aFeatures[iFeature];
-               pTermFeature->m_pFeature = pInputFeature;
-               pTermFeature->m_cStride = cTensorBins;
-               pTermFeature->m_iTranspose = iTranspose; // TODO: no tranposition yet, but move it from python to C
-
-               const size_t cBins = pInputFeature->GetCountBins();
-               if(LIKELY(size_t{1} < cBins)) {
-                  // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting
-                  // tensor loses one dimension but is otherwise indistinquishable from the original data
-                  ++cRealDimensions;
-
-                  cSingleDimensionBins = cBins;
-
-                  if(IsMultiplyError(cTensorBins, cBins)) {
-                     // if this overflows, we definetly won't be able to allocate it
-                     LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(cTensorStates, cBins)");
-                     return Error_OutOfMemory;
-                  }
-
-                  // mathematically, cTensorBins grows faster than cAuxillaryBinsForBuildFastTotals
-                  EBM_ASSERT(0 == cTensorBins || cAuxillaryBinsForBuildFastTotals < cTensorBins);
-
-                  // since cBins must be 2 or more, cAuxillaryBinsForBuildFastTotals must grow slower than
-                  // cTensorBins, and we checked above that cTensorBins would not overflow
-                  EBM_ASSERT(!IsAddError(cAuxillaryBinsForBuildFastTotals, cTensorBins));
-
-                  cAuxillaryBinsForBuildFastTotals += cTensorBins;
-               } else {
-                  LOG_0(Trace_Info, "INFO BoosterCore::Create term with no useful features");
-               }
-               cTensorBins *= cBins;
-               // same reasoning as above: cAuxillaryBinsForBuildFastTotals grows slower than cTensorBins
-               EBM_ASSERT(0 == cTensorBins || cAuxillaryBinsForBuildFastTotals < cTensorBins);
-
-               --iTranspose;
-               ++piTermFeature;
-               ++pTermFeature;
-            } while(pTermFeaturesEnd != pTermFeature);
-
-            cTensorBinsMax = EbmMax(cTensorBinsMax, cTensorBins);
-            size_t cTotalMainBins = cTensorBins;
-            if(LIKELY(size_t{1} < cTensorBins)) {
-               EBM_ASSERT(1 <= cRealDimensions);
-
-               cBitsRequiredMin = CountBitsRequired(cTensorBins - size_t{1});
-               EBM_ASSERT(1 <= cBitsRequiredMin); // 1 < cTensorBins otherwise we'd have filtered it out above
-               EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(size_t));
-
-               if(size_t{1} == cRealDimensions) {
-                  cSingleDimensionBinsMax = EbmMax(cSingleDimensionBinsMax, cSingleDimensionBins);
-               } else {
-                  // we only use AuxillaryBins for pairs.  We wouldn't use them for random pairs, but we
-                  // don't know yet if the caller will set the random boosting flag on all pairs, so allocate it
-
-                  // we need to reserve 4 PAST the pointer we pass into SweepMultiDimensional!!!!.  We pass in index 20
-                  // at max, so we need 24
-                  static constexpr size_t cAuxillaryBinsForSplitting = 24;
-                  const size_t cAuxillaryBins = EbmMax(cAuxillaryBinsForBuildFastTotals, cAuxillaryBinsForSplitting);
-                  pTerm->SetCountAuxillaryBins(cAuxillaryBins);
-
-                  if(IsAddError(cTensorBins, cAuxillaryBins)) {
-                     LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsAddError(cTensorBins, cAuxillaryBins)");
-                     return Error_OutOfMemory;
-                  }
-                  cTotalMainBins += cAuxillaryBins;
-               }
-            } else {
-               EBM_ASSERT(0 == cRealDimensions);
-            }
-            cMainBinsMax = EbmMax(cMainBinsMax, cTotalMainBins);
-         }
-         pTerm->SetCountRealDimensions(cRealDimensions);
-         pTerm->SetBitsRequiredMin(cBitsRequiredMin);
-         pTerm->SetCountTensorBins(cTensorBins);
+         pBoosterCore->m_aiSnapshotStale = aiSnapshotStale;
 
-         ++iTerm;
-      } while(iTerm < cTerms);
+         // the first snapshot holds the zeroed models
+         pBoosterCore->MarkSnapshotAllStale();
+      }
    }
-   LOG_0(Trace_Info, "BoosterCore::Create finished term processing");
 
-   ptrdiff_t cClasses;
-   const void* const aTargets = GetDataSetSharedTarget(pDataSetShared, 0, &cClasses);
-   if(nullptr == aTargets) {
-      LOG_0(Trace_Warning, "WARNING BoosterCore::Create cClasses cannot fit into ptrdiff_t");
-      return Error_IllegalParamVal;
+   if(pPreparedTrainingData->IsModelSnapshots()) {
+      error = pBoosterCore->PublishSnapshot();
+      if(Error_None != error) {
+         return error;
+      }
    }
 
-   // having 1 class means that all predictions are perfect. In the C interface we reduce this into having 0 scores,
-   // which means that we do not write anything to our upper level callers, and we don't need a bunch of things
-   // since they have zero memory allocated to them. Having 0 classes means there are also 0 samples.
-   if(ptrdiff_t{0} != cClasses && ptrdiff_t{1} != cClasses) {
-      size_t cScores;
-      if(CreateBoosterFlags_BinaryAsMulticlass & flags) {
-         cScores = cClasses < ptrdiff_t{2} ? size_t{1} : static_cast<size_t>(cClasses);
-      } else {
-         cScores = cClasses <= ptrdiff_t{2} ? size_t{1} : static_cast<size_t>(cClasses);
-      }
-      pBoosterCore->m_cScores = cScores;
-
-      LOG_0(Trace_Info, "INFO BoosterCore::Create determining Objective");
-      Config config;
-      config.cOutputs = cScores;
-      config.isDifferentialPrivacy = CreateBoosterFlags_DifferentialPrivacy & flags ? EBM_TRUE : EBM_FALSE;
-      error = GetObjective(
-            &config, sObjective, acceleration, &pBoosterCore->m_objectiveCpu, &pBoosterCore->m_objectiveSIMD);
+   LOG_0(Trace_Info, "Exited BoosterCore::Create");
+   return Error_None;
+}
+
+ErrorEbm BoosterCore::UpdateBestModel() {
+   // Only the terms boosted on since the last improvement differ from the best model. Early on we typically
+   // improve on each step so this is a single term, and later when some terms fail to improve the metric the
+   // list grows until the next improvement. A term boosted several times in between is listed and copied once.
+   // Terms with 0 tensor bins are never listed since ApplyTermUpdate exits before touching them.
+   EBM_ASSERT(nullptr != m_abBestTermStale);
+   EBM_ASSERT(nullptr != m_aiBestTermStale);
+   while(size_t{0} != m_cBestTermStale) {
+      const size_t iTerm = m_aiBestTermStale[m_cBestTermStale - 1];
+      EBM_ASSERT(m_abBestTermStale[iTerm]);
+      EBM_ASSERT(nullptr != m_apCurrentTermTensors[iTerm]);
+      EBM_ASSERT(nullptr != m_apBestTermTensors[iTerm]);
+      const ErrorEbm error = m_apBestTermTensors[iTerm]->Copy(*m_apCurrentTermTensors[iTerm]);
       if(Error_None != error) {
-         // already logged
+         // the term stays listed so a later improvement retries the copy
+         LOG_0(Trace_Warning, "WARNING BoosterCore::UpdateBestModel Copy failed");
          return error;
       }
-      LOG_0(Trace_Info, "INFO BoosterCore::Create Objective determined");
+      m_abBestTermStale[iTerm] = false;
+      --m_cBestTermStale;
+      MarkSnapshotStale(iTerm, k_snapshotStaleBestCopied);
+   }
+   return Error_None;
+}
 
-      const TaskEbm task = IdentifyTask(pBoosterCore->m_objectiveCpu.m_linkFunction);
-      if(ptrdiff_t{Task_GeneralClassification} <= cClasses) {
-         if(task < Task_GeneralClassification) {
-            LOG_0(Trace_Error, "ERROR BoosterCore::Create mismatch in objective class model type");
-            return Error_IllegalParamVal;
-         }
-      } else {
-         if(Task_Regression != task) {
-            LOG_0(Trace_Error, "ERROR BoosterCore::Create mismatch in objective class model type");
-            return Error_IllegalParamVal;
+void BoosterCore::MarkSnapshotAllStale() {
+   if(nullptr != m_aSnapshotStale) {
+      const size_t cTerms = GetCountTerms();
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         if(size_t{0} != GetTerms()[iTerm]->GetCountTensorBins()) {
+            MarkSnapshotStale(iTerm, k_snapshotStaleCurrent | k_snapshotStaleBest);
          }
       }
-      if(0 != cTerms) {
-         if(0 != cSamples) {
-            if(EBM_FALSE != pBoosterCore->CheckTargets(cSamples, aTargets)) {
-               LOG_0(Trace_Warning, "WARNING BoosterCore::Create invalid target value");
-               return Error_ObjectiveIllegalTarget;
-            }
-            LOG_0(Trace_Info, "INFO BoosterCore::Create Targets verified");
-
-            if(CheckBoosterRestrictions(pBoosterCore, &pBoosterCore->m_objectiveCpu, cTensorBinsMax)) {
-               LOG_0(Trace_Warning, "WARNING BoosterCore::Create cannot fit indexes in the cpu zone");
-               return Error_IllegalParamVal;
-            }
-            if(0 != pBoosterCore->m_objectiveSIMD.m_cUIntBytes) {
-               if(CheckBoosterRestrictions(pBoosterCore, &pBoosterCore->m_objectiveSIMD, cTensorBinsMax)) {
-                  FreeObjectiveWrapperInternals(&pBoosterCore->m_objectiveSIMD);
-                  InitializeObjectiveWrapperUnfailing(&pBoosterCore->m_objectiveSIMD);
-               }
-            }
-
-            size_t cTrainingSamples;
-            size_t cValidationSamples;
-            error = Unbag(cSamples, aBag, &cTrainingSamples, &cValidationSamples);
-            if(Error_None != error) {
-               // already logged
-               return error;
-            }
-
-            // if we have 32 bit floats or ints, then we need to break large datasets into smaller data subsets
-            // because float32 values stop incrementing at 2^24 where the value 1 is below the threshold incrementing a
-            // float
-            const bool bForceMultipleSubsets = sizeof(UIntSmall) == pBoosterCore->m_objectiveCpu.m_cUIntBytes ||
-                  sizeof(FloatSmall) == pBoosterCore->m_objectiveCpu.m_cFloatBytes ||
-                  sizeof(UIntSmall) == pBoosterCore->m_objectiveSIMD.m_cUIntBytes ||
-                  sizeof(FloatSmall) == pBoosterCore->m_objectiveSIMD.m_cFloatBytes;
-
-            const bool bHessian = pBoosterCore->IsHessian();
-
-            pBoosterCore->m_cInnerBags = cInnerBags; // this is used to destruct m_trainingSet, so store it first
-            error = pBoosterCore->m_trainingSet.InitDataSetBoosting(true,
-                  bHessian,
-                  !pBoosterCore->IsRmse(),
-                  !pBoosterCore->IsRmse(),
-                  true,
-                  rng,
-                  cScores,
-                  bForceMultipleSubsets ? k_cSubsetSamplesMax : SIZE_MAX,
-                  &pBoosterCore->m_objectiveCpu,
-                  &pBoosterCore->m_objectiveSIMD,
-                  pDataSetShared,
-                  BagEbm{1},
-                  cSamples,
-                  aBag,
-                  aInitScores,
-                  cTrainingSamples,
-                  cInnerBags,
-                  cWeights,
-                  cTerms,
-                  pBoosterCore->m_apTerms,
-                  aiTermFeatures);
-            if(Error_None != error) {
-               return error;
-            }
-
-            error = pBoosterCore->m_validationSet.InitDataSetBoosting(pBoosterCore->IsRmse(),
-                  false,
-                  !pBoosterCore->IsRmse(),
-                  !pBoosterCore->IsRmse(),
-                  false,
-                  rng,
-                  cScores,
-                  bForceMultipleSubsets ? k_cSubsetSamplesMax : SIZE_MAX,
-                  &pBoosterCore->m_objectiveCpu,
-                  &pBoosterCore->m_objectiveSIMD,
-                  pDataSetShared,
-                  BagEbm{-1},
-                  cSamples,
-                  aBag,
-                  aInitScores,
-                  cValidationSamples,
-                  0,
-                  cWeights,
-                  cTerms,
-                  pBoosterCore->m_apTerms,
-                  aiTermFeatures);
-            if(Error_None != error) {
-               return error;
-            }
-
-            size_t cBytesPerFastBinMax = 0;
-#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
-            size_t cBytesParallelMax;
-            if(bHessian) {
-               if(size_t {1} == cScores) {
-                  // the caller can specify gradient boosting as an option for an objective with a hessian
-                  cBytesParallelMax = EbmMax(HESSIAN_PARALLEL_BIN_BYTES_MAX, GRADIENT_PARALLEL_BIN_BYTES_MAX);
-               } else {
-                  cBytesParallelMax = MULTISCORE_PARALLEL_BIN_BYTES_MAX;
-               }
-            } else {
-               if(size_t {1} == cScores) {
-                  cBytesParallelMax = GRADIENT_PARALLEL_BIN_BYTES_MAX;
-               } else {
-                  // don't allow parallel gradient multiclass boosting. multiclass should be hessian boosting
-                  cBytesParallelMax = 0;
-               }
-            }
-            size_t cBytesParallelBoostTrainingMax = 0;
-#endif
-
-            if(0 != cTrainingSamples) {
-               DataSubsetBoosting* pSubset = pBoosterCore->GetTrainingSet()->GetSubsets();
-               const DataSubsetBoosting* const pSubsetsEnd =
-                     pSubset + pBoosterCore->GetTrainingSet()->GetCountSubsets();
-               do {
-                  size_t cBytesPerFastBin;
-                  if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, bHessian, cScores);
-                     }
-                  } else {
-                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(false, false, bHessian, cScores);
-                     }
-                  }
-                  cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
-
-#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
-                  if(1 != pSubset->GetObjectiveWrapper()->m_cSIMDPack) {
-                     if(IsMultiplyError(
-                              cBytesPerFastBin, cTensorBinsMax, pSubset->GetObjectiveWrapper()->m_cSIMDPack)) {
-                        cBytesParallelBoostTrainingMax = cBytesParallelMax;
-                     } else {
-                        size_t cBytesParallelBoostTraining =
-                              cBytesPerFastBin * cTensorBinsMax * pSubset->GetObjectiveWrapper()->m_cSIMDPack;
-                        cBytesParallelBoostTraining = EbmMin(cBytesParallelBoostTraining, cBytesParallelMax);
-
-                        cBytesParallelBoostTrainingMax =
-                              EbmMax(cBytesParallelBoostTrainingMax, cBytesParallelBoostTraining);
-                     }
-                  }
-#endif
-
-                  ++pSubset;
-               } while(pSubsetsEnd != pSubset);
-            }
+   }
+}
 
-            if(0 != cValidationSamples) {
-               DataSubsetBoosting* pSubset = pBoosterCore->GetValidationSet()->GetSubsets();
-               const DataSubsetBoosting* const pSubsetsEnd =
-                     pSubset + pBoosterCore->GetValidationSet()->GetCountSubsets();
-               do {
-                  size_t cBytesPerFastBin;
-                  if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, bHessian, cScores);
-                     }
-                  } else {
-                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(false, false, bHessian, cScores);
-                     }
-                  }
-                  cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
-                  ++pSubset;
-               } while(pSubsetsEnd != pSubset);
-            }
+ErrorEbm BoosterCore::PublishSnapshot() {
+   if(!m_pPreparedTrainingData->IsModelSnapshots()) {
+      return Error_None;
+   }
 
-            if(IsMultiplyError(cBytesPerFastBinMax, cTensorBinsMax)) {
-               LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(cBytesPerFastBinMax, cTensorBinsMax)");
-               return Error_OutOfMemory;
-            }
-            cBytesPerFastBinMax *= cTensorBinsMax;
-#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
-            cBytesPerFastBinMax = EbmMax(cBytesParallelBoostTrainingMax, cBytesPerFastBinMax);
-#endif
-            pBoosterCore->m_cBytesFastBins = cBytesPerFastBinMax;
-
-            if(IsOverflowBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores)) {
-               LOG_0(Trace_Warning, "WARNING BoosterCore::Create bin size overflow");
-               return Error_OutOfMemory;
-            }
+   // the new snapshot starts out sharing every tensor of the last one, which only we write, so it can be read
+   // without taking the lock
+   ModelSnapshot* pSnapshot;
+   ErrorEbm error = ModelSnapshot::Create(
+         m_pPreparedTrainingData, m_pSnapshot, m_cSnapshotsPublished, m_bestModelMetric, &pSnapshot);
+   if(Error_None != error) {
+      // the terms stay listed so the next publish retries them
+      return error;
+   }
 
-            const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
-            if(IsMultiplyError(cBytesPerMainBin, cMainBinsMax)) {
-               LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(cBytesPerMainBin, cMainBinsMax)");
-               return Error_OutOfMemory;
-            }
-            pBoosterCore->m_cBytesMainBins = cBytesPerMainBin * cMainBinsMax;
-
-            if(0 != cSingleDimensionBinsMax) {
-               if(IsOverflowTreeNodeSize(bHessian, cScores) || IsOverflowSplitPositionSize(bHessian, cScores)) {
-                  LOG_0(Trace_Warning, "WARNING BoosterCore::Create bin tracking size overflow");
-                  return Error_OutOfMemory;
-               }
-
-               const size_t cSingleDimensionSplitsMax = cSingleDimensionBinsMax - 1;
-               const size_t cBytesPerSplitPosition = GetSplitPositionSize(bHessian, cScores);
-               if(IsMultiplyError(cBytesPerSplitPosition, cSingleDimensionSplitsMax)) {
-                  LOG_0(Trace_Warning,
-                        "WARNING BoosterCore::Create IsMultiplyError(cBytesPerSplitPosition, "
-                        "cSingleDimensionSplitsMax)");
-                  return Error_OutOfMemory;
-               }
-               // TODO : someday add equal gain multidimensional randomized picking.  I think for that we should
-               // generate
-               //        random numbers as we find equal gains, so we won't need this memory if we do that
-               pBoosterCore->m_cBytesSplitPositions = cBytesPerSplitPosition * cSingleDimensionSplitsMax;
-
-               // If we have N bins, then we can have at most N - 1 splits.
-               // At maximum if all splits are made, then we'll have a tree with N - 1 nodes.
-               // Each node will contain a the total gradient sums of their left and right sides
-               // Each of the N bins will also have a leaf in the tree, which will also consume a TreeNode structure
-               // because each split needs to preserve the gradient sums of its left and right sides, which in this
-               // case are individual bins.
-               // So, in total we consume N + N - 1 TreeNodes
-
-               if(IsAddError(cSingleDimensionSplitsMax, cSingleDimensionBinsMax)) {
-                  LOG_0(Trace_Warning,
-                        "WARNING BoosterCore::Create IsAddError(cSingleDimensionSplitsMax, cSingleDimensionBinsMax)");
-                  return Error_OutOfMemory;
-               }
-               const size_t cTreeNodes = cSingleDimensionSplitsMax + cSingleDimensionBinsMax;
-
-               const size_t cBytesPerTreeNode = GetTreeNodeSize(bHessian, cScores);
-               if(IsMultiplyError(cBytesPerTreeNode, cTreeNodes)) {
-                  LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(cBytesPerTreeNode, cTreeNodes)");
-                  return Error_OutOfMemory;
-               }
-               pBoosterCore->m_cBytesTreeNodes = cTreeNodes * cBytesPerTreeNode;
-            } else {
-               EBM_ASSERT(0 == pBoosterCore->m_cBytesSplitPositions);
-               EBM_ASSERT(0 == pBoosterCore->m_cBytesTreeNodes);
-            }
-         }
-         error = InitializeTensors(cTerms, pBoosterCore->m_apTerms, cScores, &pBoosterCore->m_apCurrentTermTensors);
-         if(Error_None != error) {
-            return error;
+   const size_t cScores = GetCountScores();
+   for(size_t iStale = 0; iStale < m_cSnapshotStale; ++iStale) {
+      const size_t iTerm = m_aiSnapshotStale[iStale];
+      const unsigned char flags = m_aSnapshotStale[iTerm];
+      EBM_ASSERT(0 != flags);
+      const size_t cTensorScores = cScores * GetTerms()[iTerm]->GetCountTensorBins();
+      EBM_ASSERT(size_t{0} != cTensorScores);
+
+      if(0 != (k_snapshotStaleCurrent & flags)) {
+         EBM_ASSERT(m_apCurrentTermTensors[iTerm]->GetExpanded());
+         SnapshotTensor* const pSnapshotTensor =
+               SnapshotTensor::Create(cTensorScores, m_apCurrentTermTensors[iTerm]->GetTensorScoresPointer());
+         if(nullptr == pSnapshotTensor) {
+            // already logged
+            ModelSnapshot::Free(pSnapshot);
+            return Error_OutOfMemory;
          }
-         error = InitializeTensors(cTerms, pBoosterCore->m_apTerms, cScores, &pBoosterCore->m_apBestTermTensors);
-         if(Error_None != error) {
-            return error;
+         pSnapshot->SetTensor(0, iTerm, pSnapshotTensor);
+      }
+      if(0 != (k_snapshotStaleBest & flags)) {
+         EBM_ASSERT(m_apBestTermTensors[iTerm]->GetExpanded());
+         SnapshotTensor* const pSnapshotTensor =
+               SnapshotTensor::Create(cTensorScores, m_apBestTermTensors[iTerm]->GetTensorScoresPointer());
+         if(nullptr == pSnapshotTensor) {
+            // already logged
+            ModelSnapshot::Free(pSnapshot);
+            return Error_OutOfMemory;
          }
+         pSnapshot->SetTensor(1, iTerm, pSnapshotTensor);
+      } else if(0 != (k_snapshotStaleBestCopied & flags)) {
+         // nothing changes the current model after UpdateBestModel within a call, so the best tensor still matches
+         // the current one and both models of the snapshot can share it
+         SnapshotTensor* const pSnapshotTensor = pSnapshot->GetTensor(0, iTerm);
+         EBM_ASSERT(nullptr != pSnapshotTensor);
+         EBM_ASSERT(0 ==
+               memcmp(pSnapshotTensor->GetScores(),
+                     m_apBestTermTensors[iTerm]->GetTensorScoresPointer(),
+                     sizeof(FloatScore) * cTensorScores));
+         pSnapshotTensor->AddReferenceCount();
+         pSnapshot->SetTensor(1, iTerm, pSnapshotTensor);
       }
+      m_aSnapshotStale[iTerm] = 0;
    }
+   m_cSnapshotStale = 0;
+   ++m_cSnapshotsPublished;
+
+   ModelSnapshot* pSnapshotOld;
+   {
+      std::lock_guard<std::mutex> guard(m_mutexSnapshot);
+      pSnapshotOld = m_pSnapshot;
+      m_pSnapshot = pSnapshot;
+   }
+   // readers that acquired the old snapshot hold their own references, so this only drops ours
+   ModelSnapshot::Free(pSnapshotOld);
 
-   LOG_0(Trace_Info, "Exited BoosterCore::Create");
    return Error_None;
 }
 
+ModelSnapshot* BoosterCore::AcquireSnapshot() {
+   std::lock_guard<std::mutex> guard(m_mutexSnapshot);
+   ModelSnapshot* const pSnapshot = m_pSnapshot;
+   if(nullptr != pSnapshot) {
+      pSnapshot->AddReferenceCount();
+   }
+   return pSnapshot;
+}
+
+extern ErrorEbm ApplyUpdateCompressed(
+      DataSubsetBoosting* const pSubset, ApplyUpdateBridge* const pData, void* const aGradHessTemp);
+
 ErrorEbm BoosterCore::InitializeBoosterGradientsAndHessians(
-      void* const aMulticlassMidwayTemp, FloatScore* const aUpdateScores) {
+      void* const aMulticlassMidwayTemp, void* const aGradHessTemp, FloatScore* const aUpdateScores) {
    DataSetBoosting* const pDataSet = GetTrainingSet();
+   ClearGradientsQuantized();
    if(size_t{0} != pDataSet->GetCountSamples()) {
       const size_t cScores = GetCountScores();
 
@@ -925,17 +533,22 @@ ErrorEbm BoosterCore::InitializeBoosterGradientsAndHessians(
          // scenario then we need to allocate a larger buffer of memory to zero out instead of using aUpdateScores
          EBM_ASSERT(pSubset->GetObjectiveWrapper()->m_cFloatBytes <= sizeof(FloatScore));
          data.m_aUpdateTensorScores = aUpdateScores;
+         data.m_cTensorBins = 1;
          data.m_cSamples = pSubset->GetCountSamples();
          data.m_aPacked = nullptr;
          data.m_aTargets = pSubset->GetTargetData();
          data.m_aWeights = nullptr;
          data.m_aSampleScores = pSubset->GetSampleScores();
          data.m_aGradientsAndHessians = pSubset->GetGradHess();
+         data.m_aAucBins = nullptr;
          data.m_metricOut = 0.0;
-         const ErrorEbm error = pSubset->ObjectiveApplyUpdate(&data);
+         const ProfileTimer timer(m_pProfile);
+         const ErrorEbm error = IsCompressGradients() ? ApplyUpdateCompressed(pSubset, &data, aGradHessTemp) :
+                                                        pSubset->ObjectiveApplyUpdate(&data);
          if(Error_None != error) {
             return error;
          }
+         timer.Stop(ProfileSection_ApplyUpdate, data.m_cSamples, pSubset->CountBytesApplyUpdate(&data, IsCompressGradients()));
 
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
@@ -9,6 +9,7 @@
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // numeric_limits
 #include <atomic>
+#include <mutex>
 
 #include "libebm.h" // ErrorEbm
 #include "unzoned.h"
@@ -17,6 +18,7 @@
 
 #include "ebm_internal.hpp" // FloatMain
 #include "DataSetBoosting.hpp"
+#include "PreparedTrainingData.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -28,6 +30,8 @@ class FeatureBoosting;
 class Term;
 struct InnerBag;
 class Tensor;
+class Profile;
+class ModelSnapshot;
 
 class BoosterCore final {
 
@@ -38,36 +42,62 @@ class BoosterCore final {
    // https://stackoverflow.com/questions/41308372/stdatomic-for-built-in-types-non-lock-free-vs-trivial-destructor
    std::atomic_size_t m_REFERENCE_COUNT;
 
-   size_t m_cScores;
-   BoolEbm m_bUseApprox;
-
-   size_t m_cFeatures;
-   FeatureBoosting* m_aFeatures;
-
-   size_t m_cTerms;
-   Term** m_apTerms;
+   // the features, terms, objective and packed data, which other boosters made from the same data also reference
+   PreparedTrainingData* m_pPreparedTrainingData;
 
    size_t m_cInnerBags;
 
    Tensor** m_apCurrentTermTensors;
    Tensor** m_apBestTermTensors;
+   // one flag per term, set when the current term scores have moved away from the best ones, and a list of the
+   // flagged term indexes so that an improving round only visits the terms boosted on since the last improvement
+   bool* m_abBestTermStale;
+   size_t* m_aiBestTermStale;
+   size_t m_cBestTermStale;
 
    double m_bestModelMetric;
 
-   size_t m_cBytesFastBins;
-   size_t m_cBytesMainBins;
-
-   size_t m_cBytesSplitPositions;
-   size_t m_cBytesTreeNodes;
+   // With CreateBoosterFlags_ModelSnapshots each term has bits for the parts of the latest snapshot that no longer
+   // match the booster, and the flagged terms are listed so that publishing only visits the terms changed since the
+   // last snapshot. m_pSnapshot is only written by the boosting thread, but GetModelSnapshot reads it from any
+   // thread, so both the swap and the read happen under m_mutexSnapshot
+   static constexpr unsigned char k_snapshotStaleCurrent = 1;
+   static constexpr unsigned char k_snapshotStaleBestCopied = 2; // the best tensor was copied from the current one
+   static constexpr unsigned char k_snapshotStaleBest = 4;
+   unsigned char* m_aSnapshotStale;
+   size_t* m_aiSnapshotStale;
+   size_t m_cSnapshotStale;
+   size_t m_cSnapshotsPublished;
+   ModelSnapshot* m_pSnapshot;
+   std::mutex m_mutexSnapshot;
 
    DataSetBoosting m_trainingSet;
    DataSetBoosting m_validationSet;
 
-   ObjectiveWrapper m_objectiveCpu;
-   ObjectiveWrapper m_objectiveSIMD;
+   // nullptr unless the booster was made with CreateBoosterFlags_Profile
+   Profile* m_pProfile;
+
+   // with CreateBoosterFlags_QuantizeGradients the training gradients hold integers from the first binning after an
+   // update until the next update replaces them. Multiplying the integer bin sums by these scales restores the units
+   bool m_bGradientsQuantized;
+   double m_quantizeScaleGradient;
+   double m_quantizeScaleHessian;
 
    static void DeleteTensors(const size_t cTerms, Tensor** const apTensors);
 
+   inline void MarkSnapshotStale(const size_t iTerm, const unsigned char flags) {
+      if(nullptr != m_aSnapshotStale) {
+         EBM_ASSERT(nullptr != m_aiSnapshotStale);
+         EBM_ASSERT(iTerm < GetCountTerms());
+         if(0 == m_aSnapshotStale[iTerm]) {
+            EBM_ASSERT(m_cSnapshotStale < GetCountTerms());
+            m_aiSnapshotStale[m_cSnapshotStale] = iTerm;
+            ++m_cSnapshotStale;
+         }
+         m_aSnapshotStale[iTerm] |= flags;
+      }
+   }
+
    static ErrorEbm InitializeTensors(
          const size_t cTerms, const Term* const* const apTerms, const size_t cScores, Tensor*** papTensorsOut);
 
@@ -75,24 +105,25 @@ class BoosterCore final {
 
    inline BoosterCore() noexcept :
          m_REFERENCE_COUNT(1), // we're not visible on any other thread yet, so no synchronization required
-         m_cScores(0),
-         m_bUseApprox(EBM_FALSE),
-         m_cFeatures(0),
-         m_aFeatures(nullptr),
-         m_cTerms(0),
-         m_apTerms(nullptr),
+         m_pPreparedTrainingData(nullptr),
          m_cInnerBags(0),
          m_apCurrentTermTensors(nullptr),
          m_apBestTermTensors(nullptr),
+         m_abBestTermStale(nullptr),
+         m_aiBestTermStale(nullptr),
+         m_cBestTermStale(0),
          m_bestModelMetric(std::numeric_limits<double>::infinity()),
-         m_cBytesFastBins(0),
-         m_cBytesMainBins(0),
-         m_cBytesSplitPositions(0),
-         m_cBytesTreeNodes(0) {
+         m_aSnapshotStale(nullptr),
+         m_aiSnapshotStale(nullptr),
+         m_cSnapshotStale(0),
+         m_cSnapshotsPublished(0),
+         m_pSnapshot(nullptr),
+         m_pProfile(nullptr),
+         m_bGradientsQuantized(false),
+         m_quantizeScaleGradient(1.0),
+         m_quantizeScaleHessian(1.0) {
       m_trainingSet.SafeInitDataSetBoosting();
       m_validationSet.SafeInitDataSetBoosting();
-      InitializeObjectiveWrapperUnfailing(&m_objectiveCpu);
-      InitializeObjectiveWrapperUnfailing(&m_objectiveSIMD);
    }
 
  public:
@@ -103,30 +134,84 @@ class BoosterCore final {
       m_REFERENCE_COUNT.fetch_add(1, std::memory_order_relaxed);
    };
 
-   inline size_t GetCountScores() const { return m_cScores; }
+   inline PreparedTrainingData* GetPreparedTrainingData() {
+      EBM_ASSERT(nullptr != m_pPreparedTrainingData);
+      return m_pPreparedTrainingData;
+   }
+
+   inline size_t GetCountScores() const { return m_pPreparedTrainingData->GetCountScores(); }
+
+   inline size_t GetCountBytesFastBins() const { return m_pPreparedTrainingData->GetCountBytesFastBins(); }
+
+   inline size_t GetIndexBytesWideBins() const { return m_pPreparedTrainingData->GetIndexBytesWideBins(); }
 
-   inline size_t GetCountBytesFastBins() const { return m_cBytesFastBins; }
+   inline size_t GetIndexBytesGradHessTemp() const { return m_pPreparedTrainingData->GetIndexBytesGradHessTemp(); }
 
-   inline size_t GetCountBytesMainBins() const { return m_cBytesMainBins; }
+   // the most threads that the calls on this booster borrow from the shared ThreadPool, or zero without samples
+   inline size_t GetCountThreads() const { return m_pPreparedTrainingData->GetCountThreads(); }
 
-   inline size_t GetCountBytesSplitPositions() const { return m_cBytesSplitPositions; }
+   inline Profile* GetProfile() { return m_pProfile; }
 
-   inline size_t GetCountBytesTreeNodes() const { return m_cBytesTreeNodes; }
+   inline size_t GetCountBytesMainBins() const { return m_pPreparedTrainingData->GetCountBytesMainBins(); }
 
-   inline size_t GetCountTerms() const { return m_cTerms; }
+   inline size_t GetCountBytesSplitPositions() const { return m_pPreparedTrainingData->GetCountBytesSplitPositions(); }
 
-   inline Term* const* GetTerms() const { return m_apTerms; }
+   inline size_t GetCountBytesTreeNodes() const { return m_pPreparedTrainingData->GetCountBytesTreeNodes(); }
+
+   inline size_t GetCountFeatures() const { return m_pPreparedTrainingData->GetCountFeatures(); }
+
+   inline const FeatureBoosting* GetFeatures() const { return m_pPreparedTrainingData->GetFeatures(); }
+
+   inline size_t GetCountTerms() const { return m_pPreparedTrainingData->GetCountTerms(); }
+
+   inline Term* const* GetTerms() const { return m_pPreparedTrainingData->GetTerms(); }
 
    inline DataSetBoosting* GetTrainingSet() { return &m_trainingSet; }
 
+   inline const ObjectiveWrapper* GetObjectiveCpu() const { return m_pPreparedTrainingData->GetObjectiveCpu(); }
+
+   inline const ObjectiveWrapper* GetObjectiveSIMD() const { return m_pPreparedTrainingData->GetObjectiveSIMD(); }
+
    inline DataSetBoosting* GetValidationSet() { return &m_validationSet; }
 
+   // with CreateBoosterFlags_OutOfBagMetric the training subsets hold out of bag weights and the training pass
+   // computes the metric in place of the validation pass
+   inline bool IsOutOfBagMetric() const {
+      return m_pPreparedTrainingData->IsOutOfBagMetric() && size_t{0} != m_trainingSet.GetCountSamples();
+   }
+
    inline size_t GetCountInnerBags() const { return m_cInnerBags; }
 
    inline Tensor* const* GetCurrentModel() const { return m_apCurrentTermTensors; }
 
    inline Tensor* const* GetBestModel() const { return m_apBestTermTensors; }
 
+   inline void MarkBestTermStale(const size_t iTerm) {
+      EBM_ASSERT(nullptr != m_abBestTermStale);
+      EBM_ASSERT(nullptr != m_aiBestTermStale);
+      EBM_ASSERT(iTerm < GetCountTerms());
+      if(!m_abBestTermStale[iTerm]) {
+         m_abBestTermStale[iTerm] = true;
+         EBM_ASSERT(m_cBestTermStale < GetCountTerms());
+         m_aiBestTermStale[m_cBestTermStale] = iTerm;
+         ++m_cBestTermStale;
+      }
+      // the best term only goes stale when the current one changes
+      MarkSnapshotStale(iTerm, k_snapshotStaleCurrent);
+   }
+
+   ErrorEbm UpdateBestModel();
+
+   // for when both models were replaced wholesale, like by LoadBoosterState
+   void MarkSnapshotAllStale();
+
+   // publishes the current and best models as a new snapshot if the booster was made with
+   // CreateBoosterFlags_ModelSnapshots. Only the terms marked stale since the last snapshot are copied
+   ErrorEbm PublishSnapshot();
+
+   // returns a new reference to the latest snapshot, or nullptr without CreateBoosterFlags_ModelSnapshots
+   ModelSnapshot* AcquireSnapshot();
+
    inline double GetBestModelMetric() const { return m_bestModelMetric; }
 
    inline void SetBestModelMetric(const double bestModelMetric) { m_bestModelMetric = bestModelMetric; }
@@ -134,82 +219,107 @@ class BoosterCore final {
    static void Free(BoosterCore* const pBoosterCore);
 
    static ErrorEbm Create(void* const rng,
-         const size_t cTerms,
+         PreparedTrainingData* const pPreparedTrainingData,
          const size_t cInnerBags,
-         const double* const experimentalParams,
-         const IntEbm* const acTermDimensions,
-         const IntEbm* const aiTermFeatures,
-         const unsigned char* const pDataSetShared,
-         const BagEbm* const aBag,
          const double* const aInitScores,
-         const CreateBoosterFlags flags,
-         const AccelerationFlags acceleration,
-         const char* const sObjective,
+         const uint8_t* const aFoldMask,
          BoosterCore** const ppBoosterCoreOut);
 
-   ErrorEbm InitializeBoosterGradientsAndHessians(void* const aMulticlassMidwayTemp, FloatScore* const aUpdateScores);
+   ErrorEbm InitializeBoosterGradientsAndHessians(
+         void* const aMulticlassMidwayTemp, void* const aGradHessTemp, FloatScore* const aUpdateScores);
 
    inline double FinishMetric(const double metricSum) {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return FinishMetricC(&m_objectiveCpu, metricSum);
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return FinishMetricC(GetObjectiveCpu(), metricSum);
    }
 
    inline BoolEbm CheckTargets(const size_t c, const void* const aTargets) const noexcept {
       EBM_ASSERT(nullptr != aTargets);
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return CheckTargetsC(&m_objectiveCpu, c, aTargets);
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return CheckTargetsC(GetObjectiveCpu(), c, aTargets);
    }
 
    inline bool IsRmse() {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return EBM_FALSE != m_objectiveCpu.m_bRmse;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return EBM_FALSE != GetObjectiveCpu()->m_bRmse;
    }
 
    inline bool IsHessian() {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return EBM_FALSE != m_objectiveCpu.m_bObjectiveHasHessian;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return EBM_FALSE != GetObjectiveCpu()->m_bObjectiveHasHessian;
+   }
+
+   inline BoolEbm IsUseApprox() const { return m_pPreparedTrainingData->IsUseApprox(); }
+
+   inline BoolEbm IsValidationAuc() const { return m_pPreparedTrainingData->IsValidationAuc(); }
+
+   // only the training gradients are ever compressed since the validation set keeps none outside of RMSE
+   inline bool IsCompressGradients() const { return m_pPreparedTrainingData->IsCompressGradients(); }
+
+   inline bool IsQuantizeGradients() const { return m_pPreparedTrainingData->IsQuantizeGradients(); }
+
+   inline bool IsGradientsQuantized() const { return m_bGradientsQuantized; }
+
+   inline void ClearGradientsQuantized() { m_bGradientsQuantized = false; }
+
+   inline void SetGradientsQuantized(const double scaleGradient, const double scaleHessian) {
+      m_bGradientsQuantized = true;
+      m_quantizeScaleGradient = scaleGradient;
+      m_quantizeScaleHessian = scaleHessian;
    }
 
-   inline BoolEbm IsUseApprox() const { return m_bUseApprox; }
+   inline double GetQuantizeScaleGradient() const { return m_quantizeScaleGradient; }
+
+   inline double GetQuantizeScaleHessian() const { return m_quantizeScaleHessian; }
 
    inline double LearningRateAdjustmentDifferentialPrivacy() const noexcept {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return m_objectiveCpu.m_learningRateAdjustmentDifferentialPrivacy;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_learningRateAdjustmentDifferentialPrivacy;
    }
 
    inline double LearningRateAdjustmentGradientBoosting() const noexcept {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return m_objectiveCpu.m_learningRateAdjustmentGradientBoosting;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_learningRateAdjustmentGradientBoosting;
    }
 
    inline double LearningRateAdjustmentHessianBoosting() const noexcept {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return m_objectiveCpu.m_learningRateAdjustmentHessianBoosting;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_learningRateAdjustmentHessianBoosting;
    }
 
    inline double GainAdjustmentGradientBoosting() const noexcept {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return m_objectiveCpu.m_gainAdjustmentGradientBoosting;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_gainAdjustmentGradientBoosting;
    }
 
    inline double GainAdjustmentHessianBoosting() const noexcept {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return m_objectiveCpu.m_gainAdjustmentHessianBoosting;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_gainAdjustmentHessianBoosting;
    }
 
    inline double GradientConstant() {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return m_objectiveCpu.m_gradientConstant;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_gradientConstant;
    }
 
    inline double HessianConstant() {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return m_objectiveCpu.m_hessianConstant;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_hessianConstant;
    }
 
    inline BoolEbm MaximizeMetric() {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return m_objectiveCpu.m_bMaximizeMetric;
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_bMaximizeMetric;
+   }
+
+   inline LinkEbm LinkFunction() const {
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_linkFunction;
+   }
+
+   inline double LinkParam() const {
+      EBM_ASSERT(nullptr != GetObjectiveCpu()->m_pObjective);
+      return GetObjectiveCpu()->m_linkParam;
    }
 };
 
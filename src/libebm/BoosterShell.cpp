@@ -4,9 +4,10 @@
 
 #include "pch.hpp"
 
-#include <stdlib.h> // free
+#include <stdlib.h> // malloc, free
 #include <stddef.h> // size_t, ptrdiff_t
 #include <string.h> // memcpy
+#include <limits> // numeric_limits
 
 #define ZONE_main
 #include "zones.h"
@@ -20,6 +21,8 @@
 
 #include "BoosterCore.hpp" // BoosterCore
 #include "BoosterShell.hpp"
+#include "CancelToken.hpp"
+#include "Profile.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -28,24 +31,75 @@ namespace DEFINED_ZONE_NAME {
 
 struct BinBase;
 
-extern void InitializeRmseGradientsAndHessiansBoosting(const unsigned char* const pDataSetShared,
-      const BagEbm direction,
+extern void InitializeRmseGradientsAndHessiansBoosting(const BagEbm direction,
       const BagEbm* const aBag,
       const double* const aInitScores,
       DataSetBoosting* const pDataSet);
 
+extern ErrorEbm ApplyTermUpdateInternal(BoosterShell* const pBoosterShell,
+      const size_t iTermNext,
+      const size_t cTermsFused,
+      const size_t* const aiTermsFused,
+      FloatScore* const* const aaUpdateScoresFused,
+      double* const avgValidationMetricOut);
+
+extern void AddTermsToSubsetScores(const DataSubsetBoosting* const pSubset,
+      const size_t cScores,
+      const size_t cTerms,
+      const size_t* const aiTerms,
+      const FloatScore* const* const aaTermScores,
+      const size_t iItemFirst,
+      const size_t cItems,
+      double* const aScores);
+
+extern size_t GetCountTermScores(const Term* const pTerm, const size_t cScores) {
+   // GetBestTermScores writes the tensor with the missing and unknown bins put back into every dimension, which can
+   // make it larger than our internal tensor
+   if(size_t{0} == pTerm->GetCountTensorBins()) {
+      // GetBestTermScores does not write anything in this case
+      return 0;
+   }
+   // the booster allocated tensors at least this big, so the multiplications cannot overflow
+   size_t cTermScores = cScores;
+   const TermFeature* pTermFeature = pTerm->GetTermFeatures();
+   const TermFeature* const pTermFeaturesEnd = pTermFeature + pTerm->GetCountDimensions();
+   for(; pTermFeaturesEnd != pTermFeature; ++pTermFeature) {
+      const FeatureBoosting* const pFeature = pTermFeature->m_pFeature;
+      const size_t cBins = pFeature->GetCountBins() + (pFeature->IsMissing() ? size_t{0} : size_t{1}) +
+            (pFeature->IsUnknown() ? size_t{0} : size_t{1});
+      EBM_ASSERT(!IsMultiplyError(cTermScores, cBins));
+      cTermScores *= cBins;
+   }
+   return cTermScores;
+}
+
 void BoosterShell::Free(BoosterShell* const pBoosterShell) {
    LOG_0(Trace_Info, "Entered BoosterShell::Free");
 
    if(nullptr != pBoosterShell) {
       Tensor::Free(pBoosterShell->m_pTermUpdate);
       Tensor::Free(pBoosterShell->m_pInnerTermUpdate);
-      AlignedFree(pBoosterShell->m_aBoostingFastBinsTemp);
-      AlignedFree(pBoosterShell->m_aBoostingMainBins);
-      AlignedFree(pBoosterShell->m_aMulticlassMidwayTemp);
-      AlignedFree(pBoosterShell->m_aSplitPositionsTemp);
-      AlignedFree(pBoosterShell->m_aTreeNodesTemp);
-      AlignedFree(pBoosterShell->m_aTemp1);
+      ScratchArena* const pScratchArena = pBoosterShell->m_pScratchArena;
+      ScratchArena::Release(pScratchArena,
+            pBoosterShell->m_aBoostingFastBinsTemp,
+            pBoosterShell->m_cBoostingFastBinsTempBytes);
+      ScratchArena::Release(
+            pScratchArena, pBoosterShell->m_aBoostingMainBins, pBoosterShell->m_cBoostingMainBinsBytes);
+      ScratchArena::Release(
+            pScratchArena, pBoosterShell->m_aMulticlassMidwayTemp, pBoosterShell->m_cMulticlassMidwayTempBytes);
+      free(pBoosterShell->m_aValidationMetrics);
+      free(pBoosterShell->m_aAucBins);
+      ScratchArena::Release(
+            pScratchArena, pBoosterShell->m_aSplitPositionsTemp, pBoosterShell->m_cSplitPositionsTempBytes);
+      ScratchArena::Release(pScratchArena, pBoosterShell->m_aTreeNodesTemp, pBoosterShell->m_cTreeNodesTempBytes);
+      ScratchArena::Release(pScratchArena, pBoosterShell->m_aTemp1, pBoosterShell->m_cTemp1Bytes);
+      ScratchArena::Release(pScratchArena, pBoosterShell->m_aPurifyTemp, pBoosterShell->m_cPurifyTempBytes);
+      pBoosterShell->FreeGradientSamples();
+      pBoosterShell->ClearValidationPending();
+      free(pBoosterShell->m_aiValidationPending);
+      free(pBoosterShell->m_aiValidationPendingSlot);
+      free(pBoosterShell->m_aaValidationPending);
+      ScratchArena::Free(pScratchArena);
       BoosterCore::Free(pBoosterShell->m_pBoosterCore);
 
       // before we free our memory, indicate it was freed so if our higher level language attempts to use it we have
@@ -57,7 +111,87 @@ void BoosterShell::Free(BoosterShell* const pBoosterShell) {
    LOG_0(Trace_Info, "Exited BoosterShell::Free");
 }
 
-BoosterShell* BoosterShell::Create(BoosterCore* const pBoosterCore) {
+void BoosterShell::FreeGradientSamples() {
+   GradientSamples* const aGradientSamples = m_aGradientSamples;
+   if(nullptr != aGradientSamples) {
+      for(size_t i = 0; i < m_cGradientSamples; ++i) {
+         free(aGradientSamples[i].m_aiSamples);
+      }
+      free(aGradientSamples);
+   }
+   m_cGradientSamples = 0;
+   m_aGradientSamples = nullptr;
+}
+
+ErrorEbm BoosterShell::AddValidationPending(const size_t iTerm, const FloatScore* const aUpdateScores) {
+   EBM_ASSERT(nullptr != aUpdateScores);
+
+   const size_t cTerms = m_pBoosterCore->GetCountTerms();
+   EBM_ASSERT(iTerm < cTerms);
+
+   if(nullptr == m_aiValidationPendingSlot) {
+      // most boosters validate every update, so these are only allocated once something is held back
+      if(IsMultiplyError(sizeof(size_t), cTerms) || IsMultiplyError(sizeof(FloatScore*), cTerms)) {
+         LOG_0(Trace_Warning, "WARNING BoosterShell::AddValidationPending IsMultiplyError(sizeof(size_t), cTerms)");
+         return Error_OutOfMemory;
+      }
+      size_t* const aiValidationPending = static_cast<size_t*>(malloc(sizeof(size_t) * cTerms));
+      size_t* const aiValidationPendingSlot = static_cast<size_t*>(malloc(sizeof(size_t) * cTerms));
+      FloatScore** const aaValidationPending = static_cast<FloatScore**>(malloc(sizeof(FloatScore*) * cTerms));
+      if(nullptr == aiValidationPending || nullptr == aiValidationPendingSlot || nullptr == aaValidationPending) {
+         LOG_0(Trace_Warning, "WARNING BoosterShell::AddValidationPending out of memory");
+         free(aiValidationPending);
+         free(aiValidationPendingSlot);
+         free(aaValidationPending);
+         return Error_OutOfMemory;
+      }
+      for(size_t iTermInit = 0; iTermInit < cTerms; ++iTermInit) {
+         aiValidationPendingSlot[iTermInit] = k_illegalTermIndex;
+      }
+      m_aiValidationPending = aiValidationPending;
+      m_aiValidationPendingSlot = aiValidationPendingSlot;
+      m_aaValidationPending = aaValidationPending;
+   }
+
+   // the term update tensor of the same size was already allocated, so this cannot overflow
+   const size_t cFloats = m_pBoosterCore->GetCountScores() * m_pBoosterCore->GetTerms()[iTerm]->GetCountTensorBins();
+   EBM_ASSERT(!IsMultiplyError(sizeof(FloatScore), cFloats));
+
+   const size_t iSlot = m_aiValidationPendingSlot[iTerm];
+   if(k_illegalTermIndex == iSlot) {
+      // the objective loads the update tensor with SIMD instructions when this is the last pending term
+      FloatScore* const aPending = static_cast<FloatScore*>(AlignedAlloc(sizeof(FloatScore) * cFloats));
+      if(nullptr == aPending) {
+         LOG_0(Trace_Warning, "WARNING BoosterShell::AddValidationPending nullptr == aPending");
+         return Error_OutOfMemory;
+      }
+      memcpy(aPending, aUpdateScores, sizeof(FloatScore) * cFloats);
+
+      EBM_ASSERT(m_cValidationPending < cTerms);
+      m_aiValidationPendingSlot[iTerm] = m_cValidationPending;
+      m_aiValidationPending[m_cValidationPending] = iTerm;
+      m_aaValidationPending[m_cValidationPending] = aPending;
+      ++m_cValidationPending;
+   } else {
+      EBM_ASSERT(iSlot < m_cValidationPending);
+      FloatScore* const aPending = m_aaValidationPending[iSlot];
+      for(size_t iFloat = 0; iFloat < cFloats; ++iFloat) {
+         aPending[iFloat] += aUpdateScores[iFloat];
+      }
+   }
+   return Error_None;
+}
+
+void BoosterShell::ClearValidationPending() {
+   for(size_t iSlot = 0; iSlot < m_cValidationPending; ++iSlot) {
+      AlignedFree(m_aaValidationPending[iSlot]);
+      m_aiValidationPendingSlot[m_aiValidationPending[iSlot]] = k_illegalTermIndex;
+   }
+   m_cValidationPending = 0;
+   m_cValidationUpdates = 0;
+}
+
+BoosterShell* BoosterShell::Create(BoosterCore* const pBoosterCore, ScratchArena* const pScratchArena) {
    LOG_0(Trace_Info, "Entered BoosterShell::Create");
 
    BoosterShell* const pNew = static_cast<BoosterShell*>(malloc(sizeof(BoosterShell)));
@@ -66,7 +200,10 @@ BoosterShell* BoosterShell::Create(BoosterCore* const pBoosterCore) {
       return nullptr;
    }
 
-   pNew->InitializeUnfailing(pBoosterCore); // take full ownership of the BoosterCore
+   pNew->InitializeUnfailing(pBoosterCore, pScratchArena); // take full ownership of the BoosterCore
+   if(nullptr != pScratchArena) {
+      pScratchArena->AddReferenceCount();
+   }
 
    LOG_0(Trace_Info, "Exited BoosterShell::Create");
 
@@ -91,14 +228,22 @@ ErrorEbm BoosterShell::FillAllocations() {
       }
 
       if(0 != m_pBoosterCore->GetCountBytesFastBins()) {
-         m_aBoostingFastBinsTemp = static_cast<BinBase*>(AlignedAlloc(m_pBoosterCore->GetCountBytesFastBins()));
+         // every thread that bins a subset concurrently gets its own slice of the fast bins
+         const size_t cThreads = m_pBoosterCore->GetCountThreads();
+         EBM_ASSERT(1 <= cThreads);
+         if(IsMultiplyError(m_pBoosterCore->GetCountBytesFastBins(), cThreads)) {
+            goto failed_allocation;
+         }
+         m_aBoostingFastBinsTemp = static_cast<BinBase*>(ScratchArena::Alloc(
+               m_pScratchArena, m_pBoosterCore->GetCountBytesFastBins() * cThreads, &m_cBoostingFastBinsTempBytes));
          if(nullptr == m_aBoostingFastBinsTemp) {
             goto failed_allocation;
          }
       }
 
       if(0 != m_pBoosterCore->GetCountBytesMainBins()) {
-         m_aBoostingMainBins = static_cast<BinBase*>(AlignedAlloc(m_pBoosterCore->GetCountBytesMainBins()));
+         m_aBoostingMainBins = static_cast<BinBase*>(ScratchArena::Alloc(
+               m_pScratchArena, m_pBoosterCore->GetCountBytesMainBins(), &m_cBoostingMainBinsBytes));
          if(nullptr == m_aBoostingMainBins) {
             goto failed_allocation;
          }
@@ -144,26 +289,73 @@ ErrorEbm BoosterShell::FillAllocations() {
 
          // if there are zero samples, cFloatBytesMax will be zero
          if(0 != cBytesMulticlassMidwayMax) {
-            m_aMulticlassMidwayTemp = AlignedAlloc(cBytesMulticlassMidwayMax);
+            // round up so that every thread's slice stays aligned
+            if(SIZE_MAX - (SIMD_BYTE_ALIGNMENT - 1) < cBytesMulticlassMidwayMax) {
+               goto failed_allocation;
+            }
+            cBytesMulticlassMidwayMax =
+                  (cBytesMulticlassMidwayMax + (SIMD_BYTE_ALIGNMENT - 1)) & ~(SIMD_BYTE_ALIGNMENT - 1);
+            const size_t cThreads = m_pBoosterCore->GetCountThreads();
+            EBM_ASSERT(1 <= cThreads);
+            if(IsMultiplyError(cBytesMulticlassMidwayMax, cThreads)) {
+               goto failed_allocation;
+            }
+            m_aMulticlassMidwayTemp = ScratchArena::Alloc(
+                  m_pScratchArena, cBytesMulticlassMidwayMax * cThreads, &m_cMulticlassMidwayTempBytes);
             if(nullptr == m_aMulticlassMidwayTemp) {
                goto failed_allocation;
             }
+            m_cBytesMulticlassMidway = cBytesMulticlassMidwayMax;
+         }
+      }
+
+      if(0 != GetBoosterCore()->GetValidationSet()->GetCountSamples()) {
+         const size_t cValidationSubsets = GetBoosterCore()->GetValidationSet()->GetCountSubsets();
+         if(IsMultiplyError(sizeof(*m_aValidationMetrics), cValidationSubsets)) {
+            goto failed_allocation;
+         }
+         m_aValidationMetrics =
+               static_cast<double*>(malloc(sizeof(*m_aValidationMetrics) * cValidationSubsets));
+         if(nullptr == m_aValidationMetrics) {
+            goto failed_allocation;
+         }
+
+         if(EBM_FALSE != GetBoosterCore()->IsValidationAuc()) {
+            if(IsMultiplyError(sizeof(*m_aAucBins) * size_t{2} * size_t{AUC_BINS_COUNT}, cValidationSubsets)) {
+               goto failed_allocation;
+            }
+            m_aAucBins = static_cast<double*>(
+                  malloc(sizeof(*m_aAucBins) * size_t{2} * size_t{AUC_BINS_COUNT} * cValidationSubsets));
+            if(nullptr == m_aAucBins) {
+               goto failed_allocation;
+            }
+         }
+      } else if(GetBoosterCore()->IsOutOfBagMetric()) {
+         // the out of bag metric is summed per training subset in the training pass
+         const size_t cTrainingSubsets = GetBoosterCore()->GetTrainingSet()->GetCountSubsets();
+         if(IsMultiplyError(sizeof(*m_aValidationMetrics), cTrainingSubsets)) {
+            goto failed_allocation;
+         }
+         m_aValidationMetrics = static_cast<double*>(malloc(sizeof(*m_aValidationMetrics) * cTrainingSubsets));
+         if(nullptr == m_aValidationMetrics) {
+            goto failed_allocation;
          }
       }
 
       if(0 != m_pBoosterCore->GetCountBytesSplitPositions()) {
-         m_aSplitPositionsTemp = AlignedAlloc(m_pBoosterCore->GetCountBytesSplitPositions());
+         m_aSplitPositionsTemp = ScratchArena::Alloc(
+               m_pScratchArena, m_pBoosterCore->GetCountBytesSplitPositions(), &m_cSplitPositionsTempBytes);
          if(nullptr == m_aSplitPositionsTemp) {
             goto failed_allocation;
          }
       }
 
       if(0 != m_pBoosterCore->GetCountBytesTreeNodes()) {
-         m_aTreeNodesTemp = AlignedAlloc(m_pBoosterCore->GetCountBytesTreeNodes());
+         m_aTreeNodesTemp =
+               ScratchArena::Alloc(m_pScratchArena, m_pBoosterCore->GetCountBytesTreeNodes(), &m_cTreeNodesTempBytes);
          if(nullptr == m_aTreeNodesTemp) {
             goto failed_allocation;
          }
-         m_cTreeNodesTempBytes = m_pBoosterCore->GetCountBytesTreeNodes();
       }
    }
 
@@ -175,6 +367,171 @@ failed_allocation:;
    return Error_OutOfMemory;
 }
 
+// Starts the model from the term tensors of a previous model instead of from zero. All the tensors are added to the
+// sample scores in a single pass like BoostJacobi does, so the gradients are computed once for the combined scores.
+// The best model tensors are still zero at this point, so they hold the fused updates until ApplyTermUpdateInternal
+// has added them to the current model, and then they receive a copy of it.
+static ErrorEbm WarmStartBooster(BoosterShell* const pBoosterShell, const double* const aInitTermScores) {
+   ErrorEbm error;
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   const size_t cScores = pBoosterCore->GetCountScores();
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   if(size_t{0} == cScores || size_t{0} == cTerms) {
+      return Error_None;
+   }
+   EBM_ASSERT(nullptr != pBoosterCore->GetTerms());
+   EBM_ASSERT(nullptr != pBoosterCore->GetBestModel());
+
+   // the last term that has a tensor goes through the objective and the others are fused into that same pass
+   size_t iMain = cTerms;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      if(size_t{0} != pBoosterCore->GetTerms()[iTerm]->GetCountTensorBins()) {
+         iMain = iTerm;
+      }
+   }
+   if(cTerms == iMain) {
+      return Error_None;
+   }
+
+   if(IsMultiplyError(sizeof(size_t), cTerms) || IsMultiplyError(sizeof(FloatScore*), cTerms)) {
+      LOG_0(Trace_Warning, "WARNING WarmStartBooster IsMultiplyError(sizeof(size_t), cTerms)");
+      return Error_OutOfMemory;
+   }
+   size_t* const aiTermsFused = static_cast<size_t*>(malloc(sizeof(size_t) * cTerms));
+   FloatScore** const aaUpdateScoresFused = static_cast<FloatScore**>(malloc(sizeof(FloatScore*) * cTerms));
+   if(nullptr == aiTermsFused || nullptr == aaUpdateScoresFused) {
+      LOG_0(Trace_Warning, "WARNING WarmStartBooster nullptr == aiTermsFused || nullptr == aaUpdateScoresFused");
+      free(aiTermsFused);
+      free(aaUpdateScoresFused);
+      return Error_OutOfMemory;
+   }
+
+   const double* pInitTermScores = aInitTermScores;
+   size_t cTermsFused = 0;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const Term* const pTerm = pBoosterCore->GetTerms()[iTerm];
+      const size_t cTermScores = GetCountTermScores(pTerm, cScores);
+      if(size_t{0} == cTermScores) {
+         continue;
+      }
+
+      Tensor* pTensor;
+      if(iMain == iTerm) {
+         pTensor = pBoosterShell->GetTermUpdate();
+         pTensor->SetCountDimensions(pTerm->GetCountDimensions());
+         pTensor->Reset();
+         error = pTensor->Expand(pTerm);
+         if(Error_None != error) {
+            free(aiTermsFused);
+            free(aaUpdateScoresFused);
+            return error;
+         }
+      } else {
+         pTensor = pBoosterCore->GetBestModel()[iTerm];
+         EBM_ASSERT(nullptr != pTensor);
+         EBM_ASSERT(pTensor->GetExpanded()); // the tensor should have been expanded at startup
+         aiTermsFused[cTermsFused] = iTerm;
+         aaUpdateScoresFused[cTermsFused] = pTensor->GetTensorScoresPointer();
+         ++cTermsFused;
+      }
+      // Transpose treats the caller's tensor as const when bCopyToIncrement is false
+      Transpose<false>(pTerm, cScores, const_cast<double*>(pInitTermScores), pTensor->GetTensorScoresPointer());
+      pInitTermScores += cTermScores;
+   }
+
+   pBoosterShell->SetTermIndex(iMain);
+   double validationMetricAvg;
+   error = ApplyTermUpdateInternal(pBoosterShell,
+         BoosterShell::k_illegalTermIndex,
+         cTermsFused,
+         aiTermsFused,
+         aaUpdateScoresFused,
+         &validationMetricAvg);
+   free(aiTermsFused);
+   free(aaUpdateScoresFused);
+   if(Error_None != error) {
+      return error;
+   }
+
+   // the previous model is where boosting starts, so it is the best model even if its metric is not an improvement
+   // on +inf, and later rounds have to improve on its metric
+   pBoosterCore->SetBestModelMetric(validationMetricAvg);
+   error = pBoosterCore->UpdateBestModel();
+   if(Error_None != error) {
+      return error;
+   }
+   return pBoosterCore->PublishSnapshot();
+}
+
+static ErrorEbm CreateBoosterFromPrepared(void* const rng,
+      PreparedTrainingData* const pPreparedTrainingData,
+      const double* const aInitScores,
+      const double* const aInitTermScores,
+      const size_t cInnerBags,
+      const uint8_t* const aFoldMask,
+      ScratchArena* const pScratchArena,
+      BoosterHandle* const pBoosterHandleOut) {
+   EBM_ASSERT(nullptr != pPreparedTrainingData);
+   EBM_ASSERT(nullptr != pBoosterHandleOut);
+
+   ErrorEbm error;
+
+   // TODO: since BoosterCore is a non-POD C++ class, we should probably move the call to new from inside
+   //       BoosterCore::Create to here and wrap it with a try catch at this level and rely on standard C++ behavior
+   BoosterCore* pBoosterCore = nullptr;
+   error = BoosterCore::Create(rng, pPreparedTrainingData, cInnerBags, aInitScores, aFoldMask, &pBoosterCore);
+   if(UNLIKELY(Error_None != error)) {
+      BoosterCore::Free(pBoosterCore); // legal if nullptr.  On error we can get back a legal pBoosterCore to delete
+      return error;
+   }
+
+   BoosterShell* const pBoosterShell = BoosterShell::Create(pBoosterCore, pScratchArena);
+   if(UNLIKELY(nullptr == pBoosterShell)) {
+      // if the memory allocation for pBoosterShell failed then there was no place to put the pBoosterCore, so free it
+      BoosterCore::Free(pBoosterCore);
+      return Error_OutOfMemory;
+   }
+
+   error = pBoosterShell->FillAllocations();
+   if(Error_None != error) {
+      BoosterShell::Free(pBoosterShell);
+      return error;
+   }
+
+   if(size_t{0} != pBoosterCore->GetCountScores()) {
+      if(!pBoosterCore->IsRmse()) {
+         // the subsets are initialized one at a time on this thread, so the first fast bins slice is free
+         void* const aGradHessTemp = pBoosterCore->IsCompressGradients() ?
+               IndexBin(pBoosterShell->GetBoostingFastBinsTemp(), pBoosterCore->GetIndexBytesGradHessTemp()) :
+               nullptr;
+         error = pBoosterCore->InitializeBoosterGradientsAndHessians(pBoosterShell->GetMulticlassMidwayTemp(),
+               aGradHessTemp,
+               pBoosterShell->GetTermUpdate()->GetTensorScoresPointer() // initialized to zero at this point
+         );
+         if(UNLIKELY(Error_None != error)) {
+            BoosterShell::Free(pBoosterShell);
+            return error;
+         }
+      } else {
+         const BagEbm* const aBag = pPreparedTrainingData->GetBag();
+         InitializeRmseGradientsAndHessiansBoosting(BagEbm{1}, aBag, aInitScores, pBoosterCore->GetTrainingSet());
+         InitializeRmseGradientsAndHessiansBoosting(BagEbm{-1}, aBag, aInitScores, pBoosterCore->GetValidationSet());
+      }
+   }
+
+   if(nullptr != aInitTermScores) {
+      error = WarmStartBooster(pBoosterShell, aInitTermScores);
+      if(Error_None != error) {
+         BoosterShell::Free(pBoosterShell);
+         return error;
+      }
+   }
+
+   *pBoosterHandleOut = pBoosterShell->GetHandle();
+   return Error_None;
+}
+
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
       const void* dataSet,
       const BagEbm* bag,
@@ -182,11 +539,13 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
       IntEbm countTerms,
       const IntEbm* dimensionCounts,
       const IntEbm* featureIndexes,
+      const double* initTermScores,
       IntEbm countInnerBags,
       CreateBoosterFlags flags,
       AccelerationFlags acceleration,
       const char* objective,
       const double* experimentalParams,
+      ScratchArenaHandle scratchArenaHandle,
       BoosterHandle* boosterHandleOut) {
    LOG_N(Trace_Info,
          "Entered CreateBooster: "
@@ -197,11 +556,13 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
          "countTerms=%" IntEbmPrintf ", "
          "dimensionCounts=%p, "
          "featureIndexes=%p, "
+         "initTermScores=%p, "
          "countInnerBags=%" IntEbmPrintf ", "
          "flags=0x%" UCreateBoosterFlagsPrintf ", "
          "acceleration=0x%" UAccelerationFlagsPrintf ", "
          "objective=%p, "
          "experimentalParams=%p, "
+         "scratchArenaHandle=%p, "
          "boosterHandleOut=%p",
          rng,
          dataSet,
@@ -210,11 +571,13 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
          countTerms,
          static_cast<const void*>(dimensionCounts),
          static_cast<const void*>(featureIndexes),
+         static_cast<const void*>(initTermScores),
          countInnerBags,
          static_cast<UCreateBoosterFlags>(flags), // signed to unsigned conversion is defined behavior in C++
          static_cast<UAccelerationFlags>(acceleration), // signed to unsigned conversion is defined behavior in C++
          static_cast<const void*>(objective), // do not print the string for security reasons
          static_cast<const void*>(experimentalParams),
+         static_cast<void*>(scratchArenaHandle),
          static_cast<const void*>(boosterHandleOut));
 
    ErrorEbm error;
@@ -227,7 +590,11 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
 
    if(flags &
          ~(CreateBoosterFlags_DifferentialPrivacy | CreateBoosterFlags_UseApprox |
-               CreateBoosterFlags_BinaryAsMulticlass)) {
+               CreateBoosterFlags_BinaryAsMulticlass | CreateBoosterFlags_ValidationAuc |
+               CreateBoosterFlags_MixedPrecision | CreateBoosterFlags_CompressGradients |
+               CreateBoosterFlags_ConstantHessian | CreateBoosterFlags_Profile |
+               CreateBoosterFlags_RequireAcceleration | CreateBoosterFlags_QuantizeGradients |
+               CreateBoosterFlags_ModelSnapshots | CreateBoosterFlags_OutOfBagMetric)) {
       LOG_0(Trace_Error, "ERROR CreateBooster flags contains unknown flags. Ignoring extras.");
    }
 
@@ -258,63 +625,232 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
    }
    const size_t cInnerBags = static_cast<size_t>(countInnerBags);
 
-   // TODO: since BoosterCore is a non-POD C++ class, we should probably move the call to new from inside
-   //       BoosterCore::Create to here and wrap it with a try catch at this level and rely on standard C++ behavior
-   BoosterCore* pBoosterCore = nullptr;
-   error = BoosterCore::Create(rng,
-         cTerms,
-         cInnerBags,
+   ScratchArena* pScratchArena = nullptr;
+   if(nullptr != scratchArenaHandle) {
+      pScratchArena = ScratchArena::GetScratchArenaFromHandle(scratchArenaHandle);
+      if(nullptr == pScratchArena) {
+         // already logged
+         return Error_IllegalParamVal;
+      }
+   }
+
+   PreparedTrainingData* pPreparedTrainingData = nullptr;
+   error = PreparedTrainingData::Create(cTerms,
          experimentalParams,
          dimensionCounts,
          featureIndexes,
          static_cast<const unsigned char*>(dataSet),
          bag,
-         initScores,
          flags,
          acceleration,
          objective,
-         &pBoosterCore);
+         &pPreparedTrainingData);
    if(UNLIKELY(Error_None != error)) {
-      BoosterCore::Free(pBoosterCore); // legal if nullptr.  On error we can get back a legal pBoosterCore to delete
+      PreparedTrainingData::Free(pPreparedTrainingData); // legal if nullptr
       return error;
    }
 
-   BoosterShell* const pBoosterShell = BoosterShell::Create(pBoosterCore);
-   if(UNLIKELY(nullptr == pBoosterShell)) {
-      // if the memory allocation for pBoosterShell failed then there was no place to put the pBoosterCore, so free it
-      BoosterCore::Free(pBoosterCore);
+   BoosterHandle handle = nullptr;
+   error = CreateBoosterFromPrepared(
+         rng, pPreparedTrainingData, initScores, initTermScores, cInnerBags, nullptr, pScratchArena, &handle);
+   // the booster holds its own reference, so on success this leaves the prepared data owned by the booster alone
+   PreparedTrainingData::Free(pPreparedTrainingData);
+   if(UNLIKELY(Error_None != error)) {
+      return error;
+   }
+
+   LOG_N(Trace_Info, "Exited CreateBooster: *boosterHandleOut=%p", static_cast<void*>(handle));
+
+   *boosterHandleOut = handle;
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBoosterFromPreparedTrainingData(void* rng,
+      PreparedTrainingDataHandle preparedTrainingDataHandle,
+      const double* initScores,
+      const double* initTermScores,
+      IntEbm countInnerBags,
+      ScratchArenaHandle scratchArenaHandle,
+      BoosterHandle* boosterHandleOut) {
+   LOG_N(Trace_Info,
+         "Entered CreateBoosterFromPreparedTrainingData: "
+         "rng=%p, "
+         "preparedTrainingDataHandle=%p, "
+         "initScores=%p, "
+         "initTermScores=%p, "
+         "countInnerBags=%" IntEbmPrintf ", "
+         "scratchArenaHandle=%p, "
+         "boosterHandleOut=%p",
+         rng,
+         static_cast<void*>(preparedTrainingDataHandle),
+         static_cast<const void*>(initScores),
+         static_cast<const void*>(initTermScores),
+         countInnerBags,
+         static_cast<void*>(scratchArenaHandle),
+         static_cast<const void*>(boosterHandleOut));
+
+   if(nullptr == boosterHandleOut) {
+      LOG_0(Trace_Error, "ERROR CreateBoosterFromPreparedTrainingData nullptr == boosterHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *boosterHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   PreparedTrainingData* const pPreparedTrainingData =
+         PreparedTrainingData::GetPreparedTrainingDataFromHandle(preparedTrainingDataHandle);
+   if(nullptr == pPreparedTrainingData) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countInnerBags)) {
+      // this is just a warning since the caller doesn't pass us anything material, but if it's this high
+      // then our allocation would fail since it can't even in pricipal fit into memory
+      LOG_0(Trace_Warning, "WARNING CreateBoosterFromPreparedTrainingData IsConvertError<size_t>(countInnerBags)");
       return Error_OutOfMemory;
    }
+   const size_t cInnerBags = static_cast<size_t>(countInnerBags);
+
+   ScratchArena* pScratchArena = nullptr;
+   if(nullptr != scratchArenaHandle) {
+      pScratchArena = ScratchArena::GetScratchArenaFromHandle(scratchArenaHandle);
+      if(nullptr == pScratchArena) {
+         // already logged
+         return Error_IllegalParamVal;
+      }
+   }
 
-   error = pBoosterShell->FillAllocations();
-   if(Error_None != error) {
-      BoosterShell::Free(pBoosterShell);
+   BoosterHandle handle = nullptr;
+   const ErrorEbm error = CreateBoosterFromPrepared(
+         rng, pPreparedTrainingData, initScores, initTermScores, cInnerBags, nullptr, pScratchArena, &handle);
+   if(UNLIKELY(Error_None != error)) {
       return error;
    }
 
-   if(size_t{0} != pBoosterCore->GetCountScores()) {
-      if(!pBoosterCore->IsRmse()) {
-         error = pBoosterCore->InitializeBoosterGradientsAndHessians(pBoosterShell->GetMulticlassMidwayTemp(),
-               pBoosterShell->GetTermUpdate()->GetTensorScoresPointer() // initialized to zero at this point
-         );
-         if(UNLIKELY(Error_None != error)) {
-            BoosterShell::Free(pBoosterShell);
-            return error;
+   LOG_N(Trace_Info, "Exited CreateBoosterFromPreparedTrainingData: *boosterHandleOut=%p", static_cast<void*>(handle));
+
+   *boosterHandleOut = handle;
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateFoldBoosterFromPreparedTrainingData(void* rng,
+      PreparedTrainingDataHandle preparedTrainingDataHandle,
+      const IntEbm* folds,
+      IntEbm indexFold,
+      const double* initScores,
+      const double* initTermScores,
+      IntEbm countInnerBags,
+      ScratchArenaHandle scratchArenaHandle,
+      BoosterHandle* boosterHandleOut) {
+   LOG_N(Trace_Info,
+         "Entered CreateFoldBoosterFromPreparedTrainingData: "
+         "rng=%p, "
+         "preparedTrainingDataHandle=%p, "
+         "folds=%p, "
+         "indexFold=%" IntEbmPrintf ", "
+         "initScores=%p, "
+         "initTermScores=%p, "
+         "countInnerBags=%" IntEbmPrintf ", "
+         "scratchArenaHandle=%p, "
+         "boosterHandleOut=%p",
+         rng,
+         static_cast<void*>(preparedTrainingDataHandle),
+         static_cast<const void*>(folds),
+         indexFold,
+         static_cast<const void*>(initScores),
+         static_cast<const void*>(initTermScores),
+         countInnerBags,
+         static_cast<void*>(scratchArenaHandle),
+         static_cast<const void*>(boosterHandleOut));
+
+   ErrorEbm error;
+
+   if(nullptr == boosterHandleOut) {
+      LOG_0(Trace_Error, "ERROR CreateFoldBoosterFromPreparedTrainingData nullptr == boosterHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *boosterHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   PreparedTrainingData* const pPreparedTrainingData =
+         PreparedTrainingData::GetPreparedTrainingDataFromHandle(preparedTrainingDataHandle);
+   if(nullptr == pPreparedTrainingData) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == folds) {
+      LOG_0(Trace_Error, "ERROR CreateFoldBoosterFromPreparedTrainingData nullptr == folds");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countInnerBags)) {
+      // this is just a warning since the caller doesn't pass us anything material, but if it's this high
+      // then our allocation would fail since it can't even in pricipal fit into memory
+      LOG_0(Trace_Warning, "WARNING CreateFoldBoosterFromPreparedTrainingData IsConvertError<size_t>(countInnerBags)");
+      return Error_OutOfMemory;
+   }
+   const size_t cInnerBags = static_cast<size_t>(countInnerBags);
+
+   ScratchArena* pScratchArena = nullptr;
+   if(nullptr != scratchArenaHandle) {
+      pScratchArena = ScratchArena::GetScratchArenaFromHandle(scratchArenaHandle);
+      if(nullptr == pScratchArena) {
+         // already logged
+         return Error_IllegalParamVal;
+      }
+   }
+
+   // the training subsets hold the samples in bag order with each replicated sample repeated, so we expand the
+   // folds into that order once here and the booster only ever sees which of its training samples are in the fold
+   uint8_t* aFoldMask = nullptr;
+   const size_t cTrainingSamples = pPreparedTrainingData->GetTrainingSet()->GetCountSamples();
+   if(size_t{0} != cTrainingSamples && size_t{0} != pPreparedTrainingData->GetCountScores()) {
+      aFoldMask = static_cast<uint8_t*>(malloc(sizeof(uint8_t) * cTrainingSamples));
+      if(nullptr == aFoldMask) {
+         LOG_0(Trace_Warning, "WARNING CreateFoldBoosterFromPreparedTrainingData nullptr == aFoldMask");
+         return Error_OutOfMemory;
+      }
+
+      const BagEbm* pSampleReplication = pPreparedTrainingData->GetBag();
+      const IntEbm* pFold = folds;
+      uint8_t* pFoldMask = aFoldMask;
+      const uint8_t* const pFoldMaskEnd = aFoldMask + cTrainingSamples;
+      size_t cFoldSamples = 0;
+      do {
+         BagEbm replication = 1;
+         if(nullptr != pSampleReplication) {
+            replication = *pSampleReplication;
+            ++pSampleReplication;
          }
-      } else {
-         InitializeRmseGradientsAndHessiansBoosting(
-               static_cast<const unsigned char*>(dataSet), BagEbm{1}, bag, initScores, pBoosterCore->GetTrainingSet());
-         InitializeRmseGradientsAndHessiansBoosting(static_cast<const unsigned char*>(dataSet),
-               BagEbm{-1},
-               bag,
-               initScores,
-               pBoosterCore->GetValidationSet());
+         const uint8_t bInFold = indexFold == *pFold ? uint8_t{0} : uint8_t{1};
+         ++pFold;
+         while(BagEbm{0} < replication) {
+            EBM_ASSERT(pFoldMaskEnd != pFoldMask);
+            *pFoldMask = bInFold;
+            ++pFoldMask;
+            cFoldSamples += static_cast<size_t>(bInFold);
+            --replication;
+         }
+      } while(pFoldMaskEnd != pFoldMask);
+
+      if(size_t{0} == cFoldSamples) {
+         LOG_0(Trace_Error, "ERROR CreateFoldBoosterFromPreparedTrainingData every training sample is in indexFold");
+         free(aFoldMask);
+         return Error_IllegalParamVal;
       }
    }
 
-   const BoosterHandle handle = pBoosterShell->GetHandle();
+   BoosterHandle handle = nullptr;
+   error = CreateBoosterFromPrepared(
+         rng, pPreparedTrainingData, initScores, initTermScores, cInnerBags, aFoldMask, pScratchArena, &handle);
+   // the booster's training set keeps only the bags drawn from the mask, not the mask itself
+   free(aFoldMask);
+   if(UNLIKELY(Error_None != error)) {
+      return error;
+   }
 
-   LOG_N(Trace_Info, "Exited CreateBooster: *boosterHandleOut=%p", static_cast<void*>(handle));
+   LOG_N(Trace_Info,
+         "Exited CreateFoldBoosterFromPreparedTrainingData: *boosterHandleOut=%p",
+         static_cast<void*>(handle));
 
    *boosterHandleOut = handle;
    return Error_None;
@@ -344,7 +880,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBoosterView(
    }
    BoosterCore* const pBoosterCore = pBoosterShellOriginal->GetBoosterCore();
 
-   BoosterShell* const pBoosterShellNew = BoosterShell::Create(pBoosterCore);
+   // views recycle their buffers through the same arena as the booster they view
+   BoosterShell* const pBoosterShellNew =
+         BoosterShell::Create(pBoosterCore, pBoosterShellOriginal->GetScratchArena());
    if(UNLIKELY(nullptr == pBoosterShellNew)) {
       LOG_0(Trace_Warning, "WARNING CreateBooster nullptr == pBoosterShellNew");
       return Error_OutOfMemory;
@@ -512,6 +1050,352 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetCurrentTermScores(
    return Error_None;
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetSampleScores(
+      BoosterHandle boosterHandle, BagEbm direction, double* sampleScoresOut) {
+   LOG_N(Trace_Info,
+         "Entered GetSampleScores: "
+         "boosterHandle=%p, "
+         "direction=%" BagEbmPrintf ", "
+         "sampleScoresOut=%p",
+         static_cast<void*>(boosterHandle),
+         direction,
+         static_cast<void*>(sampleScoresOut));
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(BagEbm{1} != direction && BagEbm{-1} != direction) {
+      LOG_0(Trace_Error, "ERROR GetSampleScores direction must be 1 for training or -1 for validation");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   const size_t cScores = pBoosterCore->GetCountScores();
+   if(size_t{0} == cScores) {
+      LOG_0(Trace_Info, "Exited GetSampleScores no scores");
+      return Error_None;
+   }
+
+   const bool isLoopValidation = direction < BagEbm{0};
+   DataSetBoosting* const pDataSet =
+         isLoopValidation ? pBoosterCore->GetValidationSet() : pBoosterCore->GetTrainingSet();
+   if(size_t{0} == pDataSet->GetCountSamples()) {
+      LOG_0(Trace_Info, "Exited GetSampleScores no samples");
+      return Error_None;
+   }
+
+   if(nullptr == sampleScoresOut) {
+      LOG_0(Trace_Error, "ERROR GetSampleScores sampleScoresOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   if(isLoopValidation && size_t{0} != pBoosterShell->GetCountValidationPending()) {
+      LOG_0(Trace_Error, "ERROR GetSampleScores call ApplyValidationUpdates before reading the validation scores");
+      return Error_IllegalParamVal;
+   }
+
+   // RMSE keeps the residuals in the gradients instead of keeping the scores, so we add the targets back
+   const bool bRmse = pBoosterCore->IsRmse();
+   const FloatShared* pTargetData = bRmse ? pDataSet->GetOriginalTargets() : nullptr;
+   EBM_ASSERT(!bRmse || nullptr != pTargetData);
+
+   // the subsets hold the samples in bag order with each replicated sample repeated, which is the same walk that
+   // InitSampleScores makes over initScores, except that we write only the first copy of each sample
+   const BagEbm* pSampleReplication = pBoosterCore->GetPreparedTrainingData()->GetBag();
+   EBM_ASSERT(nullptr != pSampleReplication || !isLoopValidation);
+   double* pScoreOut = sampleScoresOut;
+   BagEbm replication = 0;
+
+   DataSubsetBoosting* pSubset = pDataSet->GetSubsets();
+   const DataSubsetBoosting* const pSubsetsEnd = pSubset + pDataSet->GetCountSubsets();
+   do {
+      const size_t cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      EBM_ASSERT(1 <= cSIMDPack);
+      EBM_ASSERT(0 == pSubset->GetCountSamples() % cSIMDPack);
+      const void* const aScores = bRmse ? pSubset->GetGradHess() : pSubset->GetSampleScores();
+      EBM_ASSERT(nullptr != aScores);
+
+      const size_t cPacks = pSubset->GetCountSamples() / cSIMDPack;
+      for(size_t iPack = 0; iPack < cPacks; ++iPack) {
+         for(size_t iPartition = 0; iPartition < cSIMDPack; ++iPartition) {
+            if(BagEbm{0} == replication) {
+               replication = 1;
+               if(nullptr != pSampleReplication) {
+                  do {
+                     replication = *pSampleReplication;
+                     ++pSampleReplication;
+                  } while(BagEbm{0} == replication || isLoopValidation != (replication < BagEbm{0}));
+               }
+               for(size_t iScore = 0; iScore < cScores; ++iScore) {
+                  const size_t iFloat = (iPack * cScores + iScore) * cSIMDPack + iPartition;
+                  double score;
+                  if(sizeof(FloatBig) == cFloatBytes) {
+                     score = static_cast<double>(static_cast<const FloatBig*>(aScores)[iFloat]);
+                  } else {
+                     EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+                     score = static_cast<double>(static_cast<const FloatSmall*>(aScores)[iFloat]);
+                  }
+                  if(bRmse) {
+                     score += static_cast<double>(*pTargetData);
+                  }
+                  *pScoreOut = score;
+                  ++pScoreOut;
+               }
+            }
+            replication -= direction;
+            if(bRmse) {
+               ++pTargetData;
+            }
+         }
+      }
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+   EBM_ASSERT(BagEbm{0} == replication);
+
+   LOG_0(Trace_Info, "Exited GetSampleScores");
+   return Error_None;
+}
+
+// ScoreBoosterSamples scores this many items of a subset at a time, which bounds its scratch space
+static constexpr size_t k_cScoreChunkItems = 1024;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ScoreBoosterSamples(
+      BoosterHandle boosterHandle, BagEbm direction, const double* termScores, double* sampleScoresOut) {
+   LOG_N(Trace_Info,
+         "Entered ScoreBoosterSamples: "
+         "boosterHandle=%p, "
+         "direction=%" BagEbmPrintf ", "
+         "termScores=%p, "
+         "sampleScoresOut=%p",
+         static_cast<void*>(boosterHandle),
+         direction,
+         static_cast<const void*>(termScores),
+         static_cast<void*>(sampleScoresOut));
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(BagEbm{1} != direction && BagEbm{-1} != direction) {
+      LOG_0(Trace_Error, "ERROR ScoreBoosterSamples direction must be 1 for training or -1 for validation");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   const size_t cScores = pBoosterCore->GetCountScores();
+   if(size_t{0} == cScores) {
+      LOG_0(Trace_Info, "Exited ScoreBoosterSamples no scores");
+      return Error_None;
+   }
+
+   const bool isLoopValidation = direction < BagEbm{0};
+   DataSetBoosting* const pDataSet =
+         isLoopValidation ? pBoosterCore->GetValidationSet() : pBoosterCore->GetTrainingSet();
+   if(size_t{0} == pDataSet->GetCountSamples()) {
+      LOG_0(Trace_Info, "Exited ScoreBoosterSamples no samples");
+      return Error_None;
+   }
+
+   if(nullptr == sampleScoresOut) {
+      LOG_0(Trace_Error, "ERROR ScoreBoosterSamples sampleScoresOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   // the packed bins index our internal tensors, so the caller's tensors are transposed into that layout first
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   size_t cTermsScored = 0;
+   size_t cInternalScores = 0;
+   size_t cSIMDPackMax = 1;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const size_t cTensorBins = pBoosterCore->GetTerms()[iTerm]->GetCountTensorBins();
+      if(size_t{0} != cTensorBins) {
+         ++cTermsScored;
+         // the internal tensors of the booster fit in memory, so their total does too
+         cInternalScores += cTensorBins * cScores;
+      }
+   }
+   if(size_t{0} != cTermsScored && nullptr == termScores) {
+      LOG_0(Trace_Error, "ERROR ScoreBoosterSamples termScores cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+   {
+      const DataSubsetBoosting* pSubset = pDataSet->GetSubsets();
+      const DataSubsetBoosting* const pSubsetsEnd = pSubset + pDataSet->GetCountSubsets();
+      do {
+         cSIMDPackMax = EbmMax(cSIMDPackMax, pSubset->GetObjectiveWrapper()->m_cSIMDPack);
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
+
+   if(IsMultiplyError(sizeof(FloatScore), cInternalScores) || IsMultiplyError(sizeof(size_t), cTermsScored) ||
+         IsMultiplyError(sizeof(FloatScore*), cTermsScored) ||
+         IsMultiplyError(sizeof(double), cScores, cSIMDPackMax, k_cScoreChunkItems)) {
+      LOG_0(Trace_Warning, "WARNING ScoreBoosterSamples the scratch space does not fit into memory");
+      return Error_OutOfMemory;
+   }
+   FloatScore* const aInternalScores = size_t{0} == cInternalScores ?
+         nullptr :
+         static_cast<FloatScore*>(malloc(sizeof(FloatScore) * cInternalScores));
+   size_t* const aiTermsScored =
+         size_t{0} == cTermsScored ? nullptr : static_cast<size_t*>(malloc(sizeof(size_t) * cTermsScored));
+   const FloatScore** const aaTermScores = size_t{0} == cTermsScored ?
+         nullptr :
+         static_cast<const FloatScore**>(malloc(sizeof(FloatScore*) * cTermsScored));
+   double* const aChunkScores =
+         static_cast<double*>(malloc(sizeof(double) * cScores * cSIMDPackMax * k_cScoreChunkItems));
+   if((size_t{0} != cTermsScored &&
+             (nullptr == aInternalScores || nullptr == aiTermsScored || nullptr == aaTermScores)) ||
+         nullptr == aChunkScores) {
+      LOG_0(Trace_Warning, "WARNING ScoreBoosterSamples out of memory");
+      free(aInternalScores);
+      free(aiTermsScored);
+      free(aaTermScores);
+      free(aChunkScores);
+      return Error_OutOfMemory;
+   }
+
+   const double* pTermScores = termScores;
+   FloatScore* pInternalScores = aInternalScores;
+   size_t iTermScored = 0;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const Term* const pTerm = pBoosterCore->GetTerms()[iTerm];
+      const size_t cTensorBins = pTerm->GetCountTensorBins();
+      if(size_t{0} == cTensorBins) {
+         continue;
+      }
+      // Transpose treats the caller's tensor as const when bCopyToIncrement is false
+      Transpose<false>(pTerm, cScores, const_cast<double*>(pTermScores), pInternalScores);
+      pTermScores += GetCountTermScores(pTerm, cScores);
+      aiTermsScored[iTermScored] = iTerm;
+      aaTermScores[iTermScored] = pInternalScores;
+      ++iTermScored;
+      pInternalScores += cTensorBins * cScores;
+   }
+
+   // the same walk over the subsets and the bag as GetSampleScores, where a chunk of items at a time is scored with
+   // all the terms before it is written out
+   const BagEbm* pSampleReplication = pBoosterCore->GetPreparedTrainingData()->GetBag();
+   EBM_ASSERT(nullptr != pSampleReplication || !isLoopValidation);
+   double* pScoreOut = sampleScoresOut;
+   BagEbm replication = 0;
+
+   const DataSubsetBoosting* pSubset = pDataSet->GetSubsets();
+   const DataSubsetBoosting* const pSubsetsEnd = pSubset + pDataSet->GetCountSubsets();
+   do {
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      EBM_ASSERT(1 <= cSIMDPack);
+      EBM_ASSERT(0 == pSubset->GetCountSamples() % cSIMDPack);
+      const size_t cPacks = pSubset->GetCountSamples() / cSIMDPack;
+      for(size_t iPackFirst = 0; iPackFirst < cPacks; iPackFirst += k_cScoreChunkItems) {
+         const size_t cChunkPacks = EbmMin(k_cScoreChunkItems, cPacks - iPackFirst);
+         const size_t cChunkScores = cScores * cSIMDPack * cChunkPacks;
+         for(size_t iScore = 0; iScore < cChunkScores; ++iScore) {
+            aChunkScores[iScore] = 0.0;
+         }
+         AddTermsToSubsetScores(
+               pSubset, cScores, cTermsScored, aiTermsScored, aaTermScores, iPackFirst, cChunkPacks, aChunkScores);
+
+         for(size_t iPack = 0; iPack < cChunkPacks; ++iPack) {
+            for(size_t iPartition = 0; iPartition < cSIMDPack; ++iPartition) {
+               if(BagEbm{0} == replication) {
+                  replication = 1;
+                  if(nullptr != pSampleReplication) {
+                     do {
+                        replication = *pSampleReplication;
+                        ++pSampleReplication;
+                     } while(BagEbm{0} == replication || isLoopValidation != (replication < BagEbm{0}));
+                  }
+                  for(size_t iScore = 0; iScore < cScores; ++iScore) {
+                     *pScoreOut = aChunkScores[(iPack * cScores + iScore) * cSIMDPack + iPartition];
+                     ++pScoreOut;
+                  }
+               }
+               replication -= direction;
+            }
+         }
+      }
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+   EBM_ASSERT(BagEbm{0} == replication);
+
+   free(aInternalScores);
+   free(aiTermsScored);
+   free(aaTermScores);
+   free(aChunkScores);
+
+   LOG_0(Trace_Info, "Exited ScoreBoosterSamples");
+   return Error_None;
+}
+
+static void WriteProfileCount(IntEbm* const aOut, const size_t iSection, const uint64_t count) {
+   if(nullptr != aOut) {
+      // a count that overflows IntEbm would take centuries to accumulate, but saturate rather than wrap regardless
+      aOut[iSection] = IsConvertError<IntEbm>(count) ? std::numeric_limits<IntEbm>::max() : static_cast<IntEbm>(count);
+   }
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetBoosterProfile(BoosterHandle boosterHandle,
+      IntEbm countSections,
+      IntEbm* countCallsOut,
+      IntEbm* countItemsOut,
+      IntEbm* countBytesOut,
+      IntEbm* nanosecondsOut) {
+   LOG_N(Trace_Info,
+         "Entered GetBoosterProfile: "
+         "boosterHandle=%p, "
+         "countSections=%" IntEbmPrintf ", "
+         "countCallsOut=%p, "
+         "countItemsOut=%p, "
+         "countBytesOut=%p, "
+         "nanosecondsOut=%p",
+         static_cast<void*>(boosterHandle),
+         countSections,
+         static_cast<void*>(countCallsOut),
+         static_cast<void*>(countItemsOut),
+         static_cast<void*>(countBytesOut),
+         static_cast<void*>(nanosecondsOut));
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(countSections < IntEbm{0} || ProfileSection_COUNT < countSections) {
+      LOG_0(Trace_Error, "ERROR GetBoosterProfile countSections must be between 0 and ProfileSection_COUNT");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSections = static_cast<size_t>(countSections);
+
+   const Profile* const pProfile = pBoosterShell->GetBoosterCore()->GetProfile();
+   for(size_t iSection = 0; iSection < cSections; ++iSection) {
+      const bool bProfile = nullptr != pProfile;
+      WriteProfileCount(countCallsOut, iSection, bProfile ? pProfile->GetCountCalls(iSection) : uint64_t{0});
+      WriteProfileCount(countItemsOut, iSection, bProfile ? pProfile->GetCountItems(iSection) : uint64_t{0});
+      WriteProfileCount(countBytesOut, iSection, bProfile ? pProfile->GetCountBytes(iSection) : uint64_t{0});
+      WriteProfileCount(nanosecondsOut, iSection, bProfile ? pProfile->GetNanoseconds(iSection) : uint64_t{0});
+   }
+
+   LOG_0(Trace_Info, "Exited GetBoosterProfile");
+   return Error_None;
+}
+
+std::atomic<uint64_t> g_cancelGeneration(0);
+
+EBM_API_BODY void EBM_CALLING_CONVENTION CancelRunningCalls(void) {
+   LOG_0(Trace_Info, "Entered CancelRunningCalls");
+
+   g_cancelGeneration.fetch_add(uint64_t{1});
+
+   LOG_0(Trace_Info, "Exited CancelRunningCalls");
+}
+
 EBM_API_BODY void EBM_CALLING_CONVENTION FreeBooster(BoosterHandle boosterHandle) {
    LOG_N(Trace_Info, "Entered FreeBooster: boosterHandle=%p", static_cast<void*>(boosterHandle));
 
@@ -525,4 +1409,34 @@ EBM_API_BODY void EBM_CALLING_CONVENTION FreeBooster(BoosterHandle boosterHandle
    LOG_0(Trace_Info, "Exited FreeBooster");
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetBoosterAcceleration(
+      BoosterHandle boosterHandle, AccelerationFlags* accelerationOut) {
+   LOG_N(Trace_Info,
+         "Entered GetBoosterAcceleration: "
+         "boosterHandle=%p, "
+         "accelerationOut=%p",
+         static_cast<void*>(boosterHandle),
+         static_cast<void*>(accelerationOut));
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == accelerationOut) {
+      LOG_0(Trace_Error, "ERROR GetBoosterAcceleration accelerationOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   const BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   // boosters without terms or samples never build the SIMD objective, and those run entirely in cpu_64
+   const ObjectiveWrapper* const pObjectiveSIMD = pBoosterCore->GetObjectiveSIMD();
+   *accelerationOut = nullptr == pObjectiveSIMD->m_pObjective ? AccelerationFlags_NONE : pObjectiveSIMD->m_zone;
+
+   LOG_N(Trace_Info, "Exited GetBoosterAcceleration: *accelerationOut=0x%" UAccelerationFlagsPrintf,
+         static_cast<UAccelerationFlags>(*accelerationOut));
+   return Error_None;
+}
+
 } // namespace DEFINED_ZONE_NAME
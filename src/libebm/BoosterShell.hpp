@@ -12,6 +12,8 @@
 #include "logging.h" // EBM_ASSERT
 #include "unzoned.h"
 
+#include "ScratchArena.hpp"
+
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
@@ -26,6 +28,20 @@ template<bool bHessian, size_t cCompilerScores> struct SplitPosition;
 
 template<bool bHessian, size_t cCompilerScores> struct TreeNode;
 
+// the samples of one training subset that SampleGradients kept. m_aiSamples holds the m_cTop samples with the largest
+// gradients followed by the m_cOther samples drawn from the rest, and each of the two groups is in ascending order
+struct GradientSamples final {
+   size_t m_cTop;
+   size_t m_cOther;
+   // the drawn samples stand in for all of the samples outside of the top group, so they are weighted up by this
+   double m_otherWeight;
+   size_t* m_aiSamples;
+};
+static_assert(std::is_standard_layout<GradientSamples>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<GradientSamples>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
 class BoosterShell final {
    static constexpr size_t k_handleVerificationOk = 10995; // random 15 bit number
    static constexpr size_t k_handleVerificationFreed = 25073; // random 15 bit number
@@ -34,26 +50,65 @@ class BoosterShell final {
    BoosterCore* m_pBoosterCore;
    size_t m_iTerm;
 
+   // nullptr unless the caller gave us a ScratchArena. The buffers below come from it and go back to it when we are
+   // freed, which is why we keep their allocated sizes
+   ScratchArena* m_pScratchArena;
+
+   // the term whose inner bag zero histogram is already in m_aBoostingMainBins. ApplyTermUpdateAndBinNext fills
+   // in the histogram and the next call to GenerateTermUpdate consumes it
+   size_t m_iTermBinned;
+
    Tensor* m_pTermUpdate;
    Tensor* m_pInnerTermUpdate;
 
    // TODO: try to merge some of this memory so that we get more CPU cache residency
+   size_t m_cBoostingFastBinsTempBytes;
    BinBase* m_aBoostingFastBinsTemp;
+   size_t m_cBoostingMainBinsBytes;
    BinBase* m_aBoostingMainBins;
 
    // TODO: I think this can share memory with m_aBoostingFastBinsTemp since the GradientPair always contains a FLOAT,
    // and it always contains enough for the multiclass scores in the first bin, and we always have at least 1 bin,
    // right?
+   // each thread borrowed from the shared ThreadPool gets its own slice of m_aMulticlassMidwayTemp
+   size_t m_cBytesMulticlassMidway;
+   size_t m_cMulticlassMidwayTempBytes;
    void* m_aMulticlassMidwayTemp;
 
+   // ApplyTermUpdate gathers the validation metric of each subset here so that they can be summed in subset order
+   double* m_aValidationMetrics;
+
+   // with CreateBoosterFlags_ValidationAuc each validation subset fills its own AUC histogram so that the subsets
+   // can run on separate threads
+   double* m_aAucBins;
+
    size_t m_cTemp1Bytes;
    void* m_aTemp1;
 
    size_t m_cTreeNodesTempBytes;
    void* m_aTreeNodesTemp;
 
+   size_t m_cSplitPositionsTempBytes;
    void* m_aSplitPositionsTemp;
 
+   // the weight, gradient and hessian tensors that purified boosting builds for each candidate update
+   size_t m_cPurifyTempBytes;
+   double* m_aPurifyTemp;
+
+   // nullptr unless SampleGradients selected samples, otherwise one entry per training subset
+   size_t m_cGradientSamples;
+   GradientSamples* m_aGradientSamples;
+
+   // with a SetValidationBatch above 1 the validation set lags behind the training set. Each pending slot holds the
+   // sum of the updates to one term that the validation set has not seen yet, m_aiValidationPending gives the term
+   // of each slot, and m_aiValidationPendingSlot gives the slot of each term or k_illegalTermIndex
+   size_t m_cValidationBatch;
+   size_t m_cValidationUpdates;
+   size_t m_cValidationPending;
+   size_t* m_aiValidationPending;
+   size_t* m_aiValidationPendingSlot;
+   FloatScore** m_aaValidationPending;
+
 #ifndef NDEBUG
    const BinBase* m_pDebugMainBinsEnd;
 #endif // NDEBUG
@@ -66,27 +121,54 @@ class BoosterShell final {
 
    static constexpr size_t k_illegalTermIndex = std::numeric_limits<size_t>::max();
 
-   INLINE_ALWAYS void InitializeUnfailing(BoosterCore* const pBoosterCore) {
+   INLINE_ALWAYS void InitializeUnfailing(BoosterCore* const pBoosterCore, ScratchArena* const pScratchArena) {
       m_handleVerification = k_handleVerificationOk;
       m_pBoosterCore = pBoosterCore;
       m_iTerm = k_illegalTermIndex;
+      m_pScratchArena = pScratchArena;
+      m_iTermBinned = k_illegalTermIndex;
       m_pTermUpdate = nullptr;
       m_pInnerTermUpdate = nullptr;
+      m_cBoostingFastBinsTempBytes = 0;
       m_aBoostingFastBinsTemp = nullptr;
+      m_cBoostingMainBinsBytes = 0;
       m_aBoostingMainBins = nullptr;
+      m_cBytesMulticlassMidway = 0;
+      m_cMulticlassMidwayTempBytes = 0;
       m_aMulticlassMidwayTemp = nullptr;
+      m_aValidationMetrics = nullptr;
+      m_aAucBins = nullptr;
 
       m_cTemp1Bytes = 0;
       m_aTemp1 = nullptr;
 
       m_cTreeNodesTempBytes = 0;
       m_aTreeNodesTemp = nullptr;
+      m_cSplitPositionsTempBytes = 0;
       m_aSplitPositionsTemp = nullptr;
+
+      m_cPurifyTempBytes = 0;
+      m_aPurifyTemp = nullptr;
+
+      m_cGradientSamples = 0;
+      m_aGradientSamples = nullptr;
+      m_cValidationBatch = 0;
+      m_cValidationUpdates = 0;
+      m_cValidationPending = 0;
+      m_aiValidationPending = nullptr;
+      m_aiValidationPendingSlot = nullptr;
+      m_aaValidationPending = nullptr;
    }
 
    static void Free(BoosterShell* const pBoosterShell);
-   static BoosterShell* Create(BoosterCore* const pBoosterCore);
+   // takes ownership of one reference to pBoosterCore, and adds a reference to pScratchArena if it is not nullptr
+   static BoosterShell* Create(BoosterCore* const pBoosterCore, ScratchArena* const pScratchArena);
    ErrorEbm FillAllocations();
+   void FreeGradientSamples();
+   // adds aUpdateScores to the pending update of iTerm, which gets a new slot if it does not have one yet
+   ErrorEbm AddValidationPending(const size_t iTerm, const FloatScore* const aUpdateScores);
+   // forgets the pending updates once the validation set has seen them
+   void ClearValidationPending();
 
    INLINE_ALWAYS static BoosterShell* GetBoosterShellFromHandle(const BoosterHandle boosterHandle) {
       if(nullptr == boosterHandle) {
@@ -111,10 +193,16 @@ class BoosterShell final {
       return m_pBoosterCore;
    }
 
+   INLINE_ALWAYS ScratchArena* GetScratchArena() { return m_pScratchArena; }
+
    INLINE_ALWAYS size_t GetTermIndex() { return m_iTerm; }
 
    INLINE_ALWAYS void SetTermIndex(const size_t iTerm) { m_iTerm = iTerm; }
 
+   INLINE_ALWAYS size_t GetTermIndexBinned() { return m_iTermBinned; }
+
+   INLINE_ALWAYS void SetTermIndexBinned(const size_t iTermBinned) { m_iTermBinned = iTermBinned; }
+
    INLINE_ALWAYS Tensor* GetTermUpdate() { return m_pTermUpdate; }
 
    INLINE_ALWAYS Tensor* GetInnerTermUpdate() { return m_pInnerTermUpdate; }
@@ -131,6 +219,18 @@ class BoosterShell final {
 
    INLINE_ALWAYS void* GetMulticlassMidwayTemp() { return m_aMulticlassMidwayTemp; }
 
+   INLINE_ALWAYS size_t GetCountBytesMulticlassMidway() const { return m_cBytesMulticlassMidway; }
+
+   // the scratch buffers that this shell holds between calls, for GetBoosterMemoryUsage
+   inline size_t CountBytesScratch() const {
+      return m_cBoostingFastBinsTempBytes + m_cBoostingMainBinsBytes + m_cMulticlassMidwayTempBytes + m_cTemp1Bytes +
+            m_cTreeNodesTempBytes + m_cSplitPositionsTempBytes + m_cPurifyTempBytes;
+   }
+
+   INLINE_ALWAYS double* GetValidationMetrics() { return m_aValidationMetrics; }
+
+   INLINE_ALWAYS double* GetAucBins() { return m_aAucBins; }
+
    template<bool bHessian, size_t cCompilerScores = 1>
    INLINE_ALWAYS TreeNode<bHessian, cCompilerScores>* GetTreeNodesTemp() {
       return static_cast<TreeNode<bHessian, cCompilerScores>*>(m_aTreeNodesTemp);
@@ -139,12 +239,20 @@ class BoosterShell final {
    INLINE_ALWAYS void* GetTreeNodeMultiTemp() { return m_aTreeNodesTemp; }
 
    INLINE_ALWAYS ErrorEbm ReserveTreeNodesTemp(const size_t cBytes) {
-      return AlignedGrow(static_cast<void**>(&m_aTreeNodesTemp), &m_cTreeNodesTempBytes, cBytes, EBM_FALSE);
+      return ScratchArena::Grow(
+            m_pScratchArena, static_cast<void**>(&m_aTreeNodesTemp), &m_cTreeNodesTempBytes, cBytes);
    }
 
    INLINE_ALWAYS void* GetTemp1() { return m_aTemp1; }
    INLINE_ALWAYS ErrorEbm ReserveTemp1(const size_t cBytes) {
-      return AlignedGrow(static_cast<void**>(&m_aTemp1), &m_cTemp1Bytes, cBytes, EBM_FALSE);
+      return ScratchArena::Grow(m_pScratchArena, static_cast<void**>(&m_aTemp1), &m_cTemp1Bytes, cBytes);
+   }
+
+   INLINE_ALWAYS double* GetPurifyTemp() { return m_aPurifyTemp; }
+
+   INLINE_ALWAYS ErrorEbm ReservePurifyTemp(const size_t cBytes) {
+      return ScratchArena::Grow(
+            m_pScratchArena, reinterpret_cast<void**>(&m_aPurifyTemp), &m_cPurifyTempBytes, cBytes);
    }
 
    template<bool bHessian, size_t cCompilerScores = 1>
@@ -152,6 +260,22 @@ class BoosterShell final {
       return static_cast<SplitPosition<bHessian, cCompilerScores>*>(m_aSplitPositionsTemp);
    }
 
+   INLINE_ALWAYS const GradientSamples* GetGradientSamples() const { return m_aGradientSamples; }
+
+   INLINE_ALWAYS void SetGradientSamples(const size_t cGradientSamples, GradientSamples* const aGradientSamples) {
+      EBM_ASSERT(nullptr == m_aGradientSamples);
+      m_cGradientSamples = cGradientSamples;
+      m_aGradientSamples = aGradientSamples;
+   }
+
+   INLINE_ALWAYS size_t GetValidationBatch() const { return m_cValidationBatch; }
+   INLINE_ALWAYS void SetValidationBatch(const size_t cValidationBatch) { m_cValidationBatch = cValidationBatch; }
+   INLINE_ALWAYS size_t GetCountValidationUpdates() const { return m_cValidationUpdates; }
+   INLINE_ALWAYS void IncrementValidationUpdates() { ++m_cValidationUpdates; }
+   INLINE_ALWAYS size_t GetCountValidationPending() const { return m_cValidationPending; }
+   INLINE_ALWAYS const size_t* GetValidationPendingTerms() const { return m_aiValidationPending; }
+   INLINE_ALWAYS FloatScore* const* GetValidationPendingUpdates() const { return m_aaValidationPending; }
+
 #ifndef NDEBUG
    INLINE_ALWAYS const BinBase* GetDebugMainBinsEnd() const { return m_pDebugMainBinsEnd; }
 
@@ -0,0 +1,402 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdio.h> // fopen, fwrite, fread, fclose, remove
+#include <string.h> // memset
+#include <type_traits> // std::is_standard_layout
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // AlignedAlloc
+
+#define ZONE_main
+#include "zones.h"
+
+#include "bridge.h" // ObjectiveWrapper
+#include "common.hpp" // IsConvertError
+#include "Bin.hpp" // IndexBin
+
+#include "ebm_internal.hpp"
+#include "dataset_shared.hpp" // UIntShared
+#include "RandomDeterministic.hpp"
+#include "Term.hpp"
+#include "Tensor.hpp"
+#include "BoosterCore.hpp"
+#include "BoosterShell.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// A booster state file is a HeaderBoosterStateFile followed by the raw arrays that VisitBoosterState lists, in that
+// order, and then optionally the rng. The arrays are stored in the internal layouts of the booster that wrote them,
+// so the file can only be loaded into a booster made the same way: same dataset, bags, terms, flags, objective and
+// acceleration. The header records enough of the shape to reject most other boosters before anything is read.
+static constexpr UIntShared k_boosterStateFileMagic = 0x41545342304D4245; // "EBM0BSTA" when stored little endian
+static constexpr UIntShared k_boosterStateFileVersion = 1;
+static constexpr UIntShared k_boosterStateFileByteOrder = 0x0102030405060708;
+
+static constexpr UIntShared k_boosterStateGradients = 0x1;
+static constexpr UIntShared k_boosterStateRng = 0x2;
+static constexpr UIntShared k_boosterStateQuantized = 0x4;
+
+struct HeaderBoosterStateFile {
+   UIntShared m_magic;
+   UIntShared m_version;
+   UIntShared m_byteOrder;
+   UIntShared m_flags;
+   UIntShared m_cTerms;
+   UIntShared m_cScores;
+   UIntShared m_cTrainingSamples;
+   UIntShared m_cValidationSamples;
+   UIntShared m_cBytesState;
+   UIntShared m_cBytesRng;
+
+   double m_bestModelMetric;
+   double m_quantizeScaleGradient;
+   double m_quantizeScaleHessian;
+
+   // Must be zero in version 1
+   UIntShared m_reserved[3];
+};
+static_assert(std::is_standard_layout<HeaderBoosterStateFile>::value,
+      "HeaderBoosterStateFile is written to disk, so it definetly needs to be standard layout and trivial");
+static_assert(std::is_trivial<HeaderBoosterStateFile>::value,
+      "HeaderBoosterStateFile is written to disk, so it definetly needs to be standard layout and trivial");
+static_assert(0 == sizeof(HeaderBoosterStateFile) % 64, "The arrays should start on a cache line");
+
+// calls visit(pArray, cBytes) on every array of the booster state in file order. The sample scores are the state
+// that boosting builds up, so they are always included. The gradients can be recalculated from the sample scores in
+// one pass, so they are only included with bGradients, except for RMSE where they hold the residuals in place of
+// the sample scores
+template<typename TVisit>
+static ErrorEbm VisitBoosterState(BoosterCore* const pBoosterCore, const bool bGradients, TVisit visit) {
+   ErrorEbm error;
+
+   const size_t cScores = pBoosterCore->GetCountScores();
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   Tensor* const* const apCurrentTensors = pBoosterCore->GetCurrentModel();
+   Tensor* const* const apBestTensors = pBoosterCore->GetBestModel();
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      if(nullptr == apCurrentTensors || nullptr == apCurrentTensors[iTerm]) {
+         continue;
+      }
+      EBM_ASSERT(nullptr != apBestTensors && nullptr != apBestTensors[iTerm]);
+      // the model tensors are expanded when they are created and stay that way
+      const size_t cBytesTensor = sizeof(FloatScore) * cScores * pBoosterCore->GetTerms()[iTerm]->GetCountTensorBins();
+      error = visit(apCurrentTensors[iTerm]->GetTensorScoresPointer(), cBytesTensor);
+      if(Error_None != error) {
+         return error;
+      }
+      error = visit(apBestTensors[iTerm]->GetTensorScoresPointer(), cBytesTensor);
+      if(Error_None != error) {
+         return error;
+      }
+   }
+
+   const bool bHessian = pBoosterCore->IsHessian();
+   DataSetBoosting* const apDataSets[] = {pBoosterCore->GetTrainingSet(), pBoosterCore->GetValidationSet()};
+   for(DataSetBoosting* const pDataSet : apDataSets) {
+      if(size_t{0} == pDataSet->GetCountSubsets()) {
+         continue;
+      }
+      // only the training gradients are ever compressed
+      const bool bCompressed = pBoosterCore->GetTrainingSet() == pDataSet && pBoosterCore->IsCompressGradients();
+      DataSubsetBoosting* pSubset = pDataSet->GetSubsets();
+      const DataSubsetBoosting* const pSubsetsEnd = pSubset + pDataSet->GetCountSubsets();
+      do {
+         const size_t cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+         const size_t cSubsetScores = cScores * pSubset->GetCountSamples();
+         void* const aSampleScores = pSubset->GetSampleScores();
+         if(nullptr != aSampleScores) {
+            error = visit(aSampleScores, cFloatBytes * cSubsetScores);
+            if(Error_None != error) {
+               return error;
+            }
+         }
+         void* const aGradHess = pSubset->GetGradHess();
+         if(nullptr != aGradHess && (bGradients || nullptr == aSampleScores)) {
+            const size_t cBytesGradHess = (bCompressed ? sizeof(Bfloat16) : cFloatBytes) * cSubsetScores *
+                  (bHessian ? size_t{2} : size_t{1});
+            error = visit(aGradHess, cBytesGradHess);
+            if(Error_None != error) {
+               return error;
+            }
+         }
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
+   return Error_None;
+}
+
+static size_t CountBytesBoosterState(BoosterCore* const pBoosterCore, const bool bGradients) {
+   size_t cBytes = 0;
+   VisitBoosterState(pBoosterCore, bGradients, [&cBytes](void* const pArray, const size_t cBytesArray) {
+      UNUSED(pArray);
+      // every array is already allocated, so their sum fits in memory
+      cBytes += cBytesArray;
+      return Error_None;
+   });
+   return cBytes;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SaveBoosterState(
+      BoosterHandle boosterHandle, void* rng, BoolEbm isGradients, const char* filename) {
+   LOG_N(Trace_Info,
+         "Entered SaveBoosterState: "
+         "boosterHandle=%p, "
+         "rng=%p, "
+         "isGradients=%s, "
+         "filename=%p",
+         static_cast<void*>(boosterHandle),
+         rng,
+         ObtainTruth(isGradients),
+         static_cast<const void*>(filename));
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == filename) {
+      LOG_0(Trace_Error, "ERROR SaveBoosterState nullptr == filename");
+      return Error_IllegalParamVal;
+   }
+
+   if(size_t{0} != pBoosterShell->GetCountValidationPending()) {
+      // the validation sample scores are behind the model until the held back updates are applied
+      LOG_0(Trace_Error, "ERROR SaveBoosterState call ApplyValidationUpdates before saving the booster state");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   const bool bGradients = EBM_FALSE != isGradients;
+
+   HeaderBoosterStateFile header;
+   memset(&header, 0, sizeof(header));
+   header.m_magic = k_boosterStateFileMagic;
+   header.m_version = k_boosterStateFileVersion;
+   header.m_byteOrder = k_boosterStateFileByteOrder;
+   header.m_flags = (bGradients ? k_boosterStateGradients : UIntShared{0}) |
+         (nullptr != rng ? k_boosterStateRng : UIntShared{0}) |
+         (bGradients && pBoosterCore->IsGradientsQuantized() ? k_boosterStateQuantized : UIntShared{0});
+   header.m_cTerms = static_cast<UIntShared>(pBoosterCore->GetCountTerms());
+   header.m_cScores = static_cast<UIntShared>(pBoosterCore->GetCountScores());
+   header.m_cTrainingSamples = static_cast<UIntShared>(pBoosterCore->GetTrainingSet()->GetCountSamples());
+   header.m_cValidationSamples = static_cast<UIntShared>(pBoosterCore->GetValidationSet()->GetCountSamples());
+   header.m_cBytesState = static_cast<UIntShared>(CountBytesBoosterState(pBoosterCore, bGradients));
+   header.m_cBytesRng = nullptr != rng ? static_cast<UIntShared>(sizeof(RandomDeterministic)) : UIntShared{0};
+   header.m_bestModelMetric = pBoosterCore->GetBestModelMetric();
+   header.m_quantizeScaleGradient = pBoosterCore->GetQuantizeScaleGradient();
+   header.m_quantizeScaleHessian = pBoosterCore->GetQuantizeScaleHessian();
+
+   FILE* const pFile = fopen(filename, "wb");
+   if(nullptr == pFile) {
+      LOG_0(Trace_Error, "ERROR SaveBoosterState fopen failed");
+      return Error_FileIO;
+   }
+   bool bWriteFailed = size_t{1} != fwrite(&header, sizeof(header), 1, pFile);
+   if(!bWriteFailed) {
+      bWriteFailed = Error_None !=
+            VisitBoosterState(pBoosterCore, bGradients, [pFile](void* const pArray, const size_t cBytesArray) {
+               return size_t{1} != fwrite(pArray, cBytesArray, 1, pFile) ? Error_FileIO : Error_None;
+            });
+   }
+   if(!bWriteFailed && nullptr != rng) {
+      bWriteFailed = size_t{1} != fwrite(rng, sizeof(RandomDeterministic), 1, pFile);
+   }
+   // fclose flushes our buffered writes, so a failure there also means the file is incomplete
+   const bool bCloseFailed = 0 != fclose(pFile);
+   if(bWriteFailed || bCloseFailed) {
+      LOG_0(Trace_Error, "ERROR SaveBoosterState failed writing the file");
+      remove(filename);
+      return Error_FileIO;
+   }
+
+   LOG_0(Trace_Info, "Exited SaveBoosterState");
+   return Error_None;
+}
+
+static ErrorEbm CheckBoosterStateHeader(
+      const HeaderBoosterStateFile* const pHeader, BoosterCore* const pBoosterCore, const void* const rng) {
+   if(k_boosterStateFileMagic != pHeader->m_magic) {
+      LOG_0(Trace_Error, "ERROR CheckBoosterStateHeader the file is not a booster state file");
+      return Error_IllegalParamVal;
+   }
+   if(k_boosterStateFileByteOrder != pHeader->m_byteOrder) {
+      LOG_0(Trace_Error, "ERROR CheckBoosterStateHeader the file was written on a machine with a different byte order");
+      return Error_IllegalParamVal;
+   }
+   if(k_boosterStateFileVersion != pHeader->m_version) {
+      LOG_N(Trace_Error,
+            "ERROR CheckBoosterStateHeader unsupported booster state file version %" UIntEbmPrintf,
+            static_cast<UIntEbm>(pHeader->m_version));
+      return Error_IllegalParamVal;
+   }
+   for(const UIntShared reserved : pHeader->m_reserved) {
+      if(UIntShared{0} != reserved) {
+         LOG_0(Trace_Error, "ERROR CheckBoosterStateHeader UIntShared { 0 } != reserved");
+         return Error_IllegalParamVal;
+      }
+   }
+   if(UIntShared{0} !=
+         (pHeader->m_flags & ~(k_boosterStateGradients | k_boosterStateRng | k_boosterStateQuantized))) {
+      LOG_0(Trace_Error, "ERROR CheckBoosterStateHeader unknown flags");
+      return Error_IllegalParamVal;
+   }
+
+   const bool bGradients = UIntShared{0} != (pHeader->m_flags & k_boosterStateGradients);
+   if(static_cast<UIntShared>(pBoosterCore->GetCountTerms()) != pHeader->m_cTerms ||
+         static_cast<UIntShared>(pBoosterCore->GetCountScores()) != pHeader->m_cScores ||
+         static_cast<UIntShared>(pBoosterCore->GetTrainingSet()->GetCountSamples()) != pHeader->m_cTrainingSamples ||
+         static_cast<UIntShared>(pBoosterCore->GetValidationSet()->GetCountSamples()) !=
+               pHeader->m_cValidationSamples ||
+         static_cast<UIntShared>(CountBytesBoosterState(pBoosterCore, bGradients)) != pHeader->m_cBytesState) {
+      LOG_0(Trace_Error, "ERROR CheckBoosterStateHeader the file was saved from a booster that was made differently");
+      return Error_IllegalParamVal;
+   }
+
+   if(UIntShared{0} != (pHeader->m_flags & k_boosterStateRng)) {
+      if(static_cast<UIntShared>(sizeof(RandomDeterministic)) != pHeader->m_cBytesRng) {
+         LOG_0(Trace_Error, "ERROR CheckBoosterStateHeader the rng in the file has the wrong size");
+         return Error_IllegalParamVal;
+      }
+   } else {
+      if(UIntShared{0} != pHeader->m_cBytesRng) {
+         LOG_0(Trace_Error, "ERROR CheckBoosterStateHeader UIntShared { 0 } != pHeader->m_cBytesRng");
+         return Error_IllegalParamVal;
+      }
+      if(nullptr != rng) {
+         LOG_0(Trace_Error, "ERROR CheckBoosterStateHeader rng was given but the file was saved without one");
+         return Error_IllegalParamVal;
+      }
+   }
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION LoadBoosterState(
+      BoosterHandle boosterHandle, void* rng, const char* filename) {
+   LOG_N(Trace_Info,
+         "Entered LoadBoosterState: "
+         "boosterHandle=%p, "
+         "rng=%p, "
+         "filename=%p",
+         static_cast<void*>(boosterHandle),
+         rng,
+         static_cast<const void*>(filename));
+
+   ErrorEbm error;
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == filename) {
+      LOG_0(Trace_Error, "ERROR LoadBoosterState nullptr == filename");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   FILE* const pFile = fopen(filename, "rb");
+   if(nullptr == pFile) {
+      LOG_0(Trace_Error, "ERROR LoadBoosterState fopen failed");
+      return Error_FileIO;
+   }
+
+   HeaderBoosterStateFile header;
+   if(size_t{1} != fread(&header, sizeof(header), 1, pFile)) {
+      LOG_0(Trace_Error, "ERROR LoadBoosterState the file is too short for a booster state file");
+      fclose(pFile);
+      return Error_IllegalParamVal;
+   }
+   error = CheckBoosterStateHeader(&header, pBoosterCore, rng);
+   if(Error_None != error) {
+      // already logged
+      fclose(pFile);
+      return error;
+   }
+   const bool bGradients = UIntShared{0} != (header.m_flags & k_boosterStateGradients);
+
+   // the arrays are read straight into the booster's own buffers, so resuming is one sequential pass over the file.
+   // Nothing in the booster has changed until this point, but a file that ends early leaves it partly overwritten
+   error = VisitBoosterState(pBoosterCore, bGradients, [pFile](void* const pArray, const size_t cBytesArray) {
+      return size_t{1} != fread(pArray, cBytesArray, 1, pFile) ? Error_FileIO : Error_None;
+   });
+   if(Error_None == error && nullptr != rng) {
+      if(size_t{1} != fread(rng, sizeof(RandomDeterministic), 1, pFile)) {
+         error = Error_FileIO;
+      }
+   }
+   fclose(pFile);
+   if(Error_None != error) {
+      LOG_0(Trace_Error, "ERROR LoadBoosterState the file ended early. The booster needs to be freed");
+      return error;
+   }
+
+   pBoosterCore->SetBestModelMetric(header.m_bestModelMetric);
+   // we do not know which terms differ between the current and best models, so the next improvement copies them all
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      if(nullptr != pBoosterCore->GetCurrentModel() && nullptr != pBoosterCore->GetCurrentModel()[iTerm]) {
+         pBoosterCore->MarkBestTermStale(iTerm);
+      }
+   }
+
+   // anything that the shell derived from the gradients or model before the load is stale now
+   pBoosterShell->SetTermIndex(BoosterShell::k_illegalTermIndex);
+   pBoosterShell->SetTermIndexBinned(BoosterShell::k_illegalTermIndex);
+   pBoosterShell->FreeGradientSamples();
+   pBoosterShell->ClearValidationPending();
+
+   if(bGradients) {
+      if(UIntShared{0} != (header.m_flags & k_boosterStateQuantized)) {
+         pBoosterCore->SetGradientsQuantized(header.m_quantizeScaleGradient, header.m_quantizeScaleHessian);
+      } else {
+         pBoosterCore->ClearGradientsQuantized();
+      }
+   } else if(size_t{0} != pBoosterCore->GetCountScores() && !pBoosterCore->IsRmse() &&
+         size_t{0} != pBoosterCore->GetTrainingSet()->GetCountSamples()) {
+      // a zero update recalculates the gradients from the loaded sample scores without changing them
+      const size_t cScores = pBoosterCore->GetCountScores();
+      if(IsMultiplyError(sizeof(FloatScore), cScores)) {
+         LOG_0(Trace_Warning, "WARNING LoadBoosterState IsMultiplyError(sizeof(FloatScore), cScores)");
+         return Error_OutOfMemory;
+      }
+      FloatScore* const aZeroScores = static_cast<FloatScore*>(AlignedAlloc(sizeof(FloatScore) * cScores));
+      if(nullptr == aZeroScores) {
+         LOG_0(Trace_Warning, "WARNING LoadBoosterState nullptr == aZeroScores");
+         return Error_OutOfMemory;
+      }
+      memset(aZeroScores, 0, sizeof(FloatScore) * cScores);
+      // the subsets are handled one at a time on this thread, so the first fast bins slice is free
+      void* const aGradHessTemp = pBoosterCore->IsCompressGradients() ?
+            IndexBin(pBoosterShell->GetBoostingFastBinsTemp(), pBoosterCore->GetIndexBytesGradHessTemp()) :
+            nullptr;
+      error = pBoosterCore->InitializeBoosterGradientsAndHessians(
+            pBoosterShell->GetMulticlassMidwayTemp(), aGradHessTemp, aZeroScores);
+      AlignedFree(aZeroScores);
+      if(Error_None != error) {
+         return error;
+      }
+   }
+
+   pBoosterCore->MarkSnapshotAllStale();
+   error = pBoosterCore->PublishSnapshot();
+   if(Error_None != error) {
+      return error;
+   }
+
+   LOG_0(Trace_Info, "Exited LoadBoosterState");
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
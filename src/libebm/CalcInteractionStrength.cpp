@@ -4,9 +4,14 @@
 
 #include "pch.hpp"
 
+#include <stdlib.h> // malloc, free
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // numeric_limits
+#include <cmath> // std::sqrt
 #include <string.h> // memcpy
+#include <algorithm> // std::sort, std::push_heap, std::pop_heap
+#include <mutex>
+#include <type_traits> // std::is_standard_layout
 
 #include "libebm.h" // ErrorEbm
 #include "logging.h" // EBM_ASSERT
@@ -18,12 +23,15 @@
 #include "Bin.hpp" // GetBinSize
 
 #include "ebm_internal.hpp" // k_cDimensionsMax
+#include "ebm_stats.hpp" // CalcPartialGain
 #include "Feature.hpp"
 #include "DataSetInteraction.hpp"
 #include "Tensor.hpp"
 #include "TreeNode.hpp"
 #include "InteractionCore.hpp"
 #include "InteractionShell.hpp"
+#include "ThreadPool.hpp"
+#include "CancelToken.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -57,6 +65,21 @@ extern void TensorTotalsBuild(const bool bHessian,
 #endif // NDEBUG
 );
 
+extern ErrorEbm PartitionSparseInteraction(InteractionCore* const pInteractionCore,
+      const size_t cDimensions,
+      const IntEbm* const featureIndexes,
+      const size_t* const acBins,
+      const CalcInteractionFlags flags,
+      const size_t cSamplesLeafMin,
+      const FloatCalc hessianMin,
+      const FloatCalc regAlpha,
+      const FloatCalc regLambda,
+      const FloatCalc deltaStepMax,
+      double* const pGainOut);
+
+extern size_t GetPartitionTwoDimensionalInteractionSize(
+      const bool bHessian, const size_t cScores, const size_t cBins1);
+
 extern double PartitionTwoDimensionalInteraction(InteractionCore* const pInteractionCore,
       const size_t cRealDimensions,
       const size_t* const acBins,
@@ -95,7 +118,9 @@ extern ErrorEbm PartitionTwoDimensionalBoosting(const bool bHessian,
       double* const aTensorHess,
       double* const pTotalGain,
       const size_t cPossibleSplits,
-      void* const pTemp1
+      void* const pTemp1,
+      ThreadPool* const pThreadPool,
+      const size_t cTasks
 #ifndef NDEBUG
       ,
       const BinBase* const aDebugCopyBinsBase,
@@ -103,88 +128,49 @@ extern ErrorEbm PartitionTwoDimensionalBoosting(const bool bHessian,
 #endif // NDEBUG
 );
 
-// there is a race condition for decrementing this variable, but if a thread loses the
-// race then it just doesn't get decremented as quickly, which we can live with
-static int g_cLogCalcInteractionStrength = 10;
-
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(InteractionHandle interactionHandle,
-      IntEbm countDimensions,
-      const IntEbm* featureIndexes,
-      CalcInteractionFlags flags,
-      IntEbm maxCardinality,
-      IntEbm minSamplesLeaf,
-      double minHessian,
-      double regAlpha,
-      double regLambda,
-      double maxDeltaStep,
-      double* avgInteractionStrengthOut) {
-   LOG_COUNTED_N(&g_cLogCalcInteractionStrength,
-         Trace_Info,
-         Trace_Verbose,
-         "CalcInteractionStrength: "
-         "interactionHandle=%p, "
-         "countDimensions=%" IntEbmPrintf ", "
-         "featureIndexes=%p, "
-         "flags=0x%" UCalcInteractionFlagsPrintf ", "
-         "maxCardinality=%" IntEbmPrintf ", "
-         "minSamplesLeaf=%" IntEbmPrintf ", "
-         "minHessian=%le, "
-         "regAlpha=%le, "
-         "regLambda=%le, "
-         "maxDeltaStep=%le, "
-         "avgInteractionStrengthOut=%p",
-         static_cast<void*>(interactionHandle),
-         countDimensions,
-         static_cast<const void*>(featureIndexes),
-         static_cast<UCalcInteractionFlags>(flags), // signed to unsigned conversion is defined behavior in C++
-         maxCardinality,
-         minSamplesLeaf,
-         minHessian,
-         regAlpha,
-         regLambda,
-         maxDeltaStep,
-         static_cast<void*>(avgInteractionStrengthOut));
-
-   ErrorEbm error;
-
-   if(LIKELY(nullptr != avgInteractionStrengthOut)) {
-      *avgInteractionStrengthOut = k_illegalGainDouble;
-   }
-
-   InteractionShell* const pInteractionShell = InteractionShell::GetInteractionShellFromHandle(interactionHandle);
-   if(nullptr == pInteractionShell) {
-      // already logged
-      return Error_IllegalParamVal;
-   }
-   LOG_COUNTED_0(pInteractionShell->GetPointerCountLogEnterMessages(),
-         Trace_Info,
-         Trace_Verbose,
-         "Entered CalcInteractionStrength");
-
-   if(flags & ~(CalcInteractionFlags_DisableNewton | CalcInteractionFlags_Purify)) {
-      LOG_0(Trace_Error, "ERROR CalcInteractionStrength flags contains unknown flags. Ignoring extras.");
-   }
-
-   size_t cCardinalityMax = std::numeric_limits<size_t>::max(); // set off by default
+// the parameters shared by every term of a call, after replacing illegal values with their defaults
+struct InteractionParams final {
+   size_t m_cCardinalityMax;
+   size_t m_cSamplesLeafMin;
+   FloatCalc m_hessianMin;
+   FloatCalc m_regAlpha;
+   FloatCalc m_regLambda;
+   FloatCalc m_deltaStepMax;
+
+   // CalcInteractionStrengthInterval leaves the subsets from m_iSubsetSkip up to m_iSubsetSkip + m_cSubsetsSkip out
+   // of the bins, and m_weightSkipped is their total weight
+   size_t m_iSubsetSkip;
+   size_t m_cSubsetsSkip;
+   double m_weightSkipped;
+};
+
+static void NormalizeInteractionParams(const IntEbm maxCardinality,
+      const IntEbm minSamplesLeaf,
+      const double minHessian,
+      const double regAlpha,
+      const double regLambda,
+      const double maxDeltaStep,
+      InteractionParams* const pParamsOut) {
+   pParamsOut->m_cCardinalityMax = std::numeric_limits<size_t>::max(); // set off by default
    if(IntEbm{0} <= maxCardinality) {
       if(IntEbm{0} != maxCardinality) {
          if(!IsConvertError<size_t>(maxCardinality)) {
             // we can never exceed a size_t number of samples, so let's just set it to the maximum if we were going to
             // overflow because it will generate the same results as if we used the true number
-            cCardinalityMax = static_cast<size_t>(maxCardinality);
+            pParamsOut->m_cCardinalityMax = static_cast<size_t>(maxCardinality);
          }
       }
    } else {
       LOG_0(Trace_Warning, "WARNING CalcInteractionStrength maxCardinality can't be less than 0. Turning off.");
    }
 
-   size_t cSamplesLeafMin = size_t{0}; // this is the min value
+   pParamsOut->m_cSamplesLeafMin = size_t{0}; // this is the min value
    if(IntEbm{0} <= minSamplesLeaf) {
-      cSamplesLeafMin = static_cast<size_t>(minSamplesLeaf);
+      pParamsOut->m_cSamplesLeafMin = static_cast<size_t>(minSamplesLeaf);
       if(IsConvertError<size_t>(minSamplesLeaf)) {
          // we can never exceed a size_t number of samples, so let's just set it to the maximum if we were going to
          // overflow because it will generate the same results as if we used the true number
-         cSamplesLeafMin = std::numeric_limits<size_t>::max();
+         pParamsOut->m_cSamplesLeafMin = std::numeric_limits<size_t>::max();
       }
    } else {
       LOG_0(Trace_Warning, "WARNING CalcInteractionStrength minSamplesLeaf can't be less than 0. Adjusting to 0.");
@@ -219,12 +205,369 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
       deltaStepMax = std::numeric_limits<FloatCalc>::infinity();
    }
 
+   pParamsOut->m_hessianMin = hessianMin;
+   pParamsOut->m_regAlpha = regAlphaCalc;
+   pParamsOut->m_regLambda = regLambdaCalc;
+   pParamsOut->m_deltaStepMax = deltaStepMax;
+
+   pParamsOut->m_iSubsetSkip = 0;
+   pParamsOut->m_cSubsetsSkip = 0;
+   pParamsOut->m_weightSkipped = 0.0;
+}
+
+static size_t GetFastBinSize(const DataSubsetInteraction* const pSubset, const bool bHessian, const size_t cScores) {
+   if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+      if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         return GetBinSize<FloatBig, UIntBig>(true, true, bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         return GetBinSize<FloatSmall, UIntBig>(true, true, bHessian, cScores);
+      }
+   } else {
+      EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+      if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         return GetBinSize<FloatBig, UIntSmall>(true, true, bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         return GetBinSize<FloatSmall, UIntSmall>(true, true, bHessian, cScores);
+      }
+   }
+}
+
+// sums the gradients and hessians of the term with the cDimensions features in featureIndexes into the cTensorBins
+// aMainBins, which the caller zeros. pBinSums holds the count of bins of each dimension in m_acBins. pThreadPool is
+// used to bin the subsets concurrently, or nullptr to bin them on the calling thread. The cSubsetsSkip subsets that
+// start at iSubsetSkip are left out
+static ErrorEbm BinSumsTerm(InteractionCore* const pInteractionCore,
+      ThreadPool* const pThreadPool,
+      InteractionBins* const pBins,
+      const size_t cDimensions,
+      const IntEbm* const featureIndexes,
+      BinSumsInteractionBridge* const pBinSums,
+      const size_t cTensorBins,
+      const size_t iSubsetSkip,
+      const size_t cSubsetsSkip,
+      BinBase* const aMainBins) {
+   ErrorEbm error;
+
+   const size_t cScores = pInteractionCore->GetCountScores();
+   const bool bHessian = pInteractionCore->IsHessian();
+
+   const size_t cSubsets = pInteractionCore->GetDataSetInteraction()->GetCountSubsets();
+   EBM_ASSERT(1 <= cSubsets);
+   DataSubsetInteraction* const aSubsets = pInteractionCore->GetDataSetInteraction()->GetSubsets();
+   EBM_ASSERT(iSubsetSkip + cSubsetsSkip <= cSubsets);
+   EBM_ASSERT(cSubsetsSkip < cSubsets);
+   const size_t cSubsetsBinned = cSubsets - cSubsetsSkip;
+   const auto GetBinnedSubset = [aSubsets, iSubsetSkip, cSubsetsSkip](const size_t iBinned) {
+      return &aSubsets[iBinned < iSubsetSkip ? iBinned : iBinned + cSubsetsSkip];
+   };
+
+   // the subsets are binned in waves of up to cThreads at a time, each into its own slice of the fast bins. The slices
+   // are reduced into the main bins on this thread in subset order, which gives the same floating point sums as
+   // binning the subsets one after another
+   size_t cBytesFastBinsSlice = 0;
+   for(size_t iSubset = 0; iSubset < cSubsets; ++iSubset) {
+      const size_t cBytesPerFastBin = GetFastBinSize(&aSubsets[iSubset], bHessian, cScores);
+      if(IsMultiplyError(cBytesPerFastBin, cTensorBins)) {
+         LOG_0(Trace_Warning, "WARNING BinSumsTerm IsMultiplyError(cBytesPerBin, cTensorBins)");
+         return Error_OutOfMemory;
+      }
+      cBytesFastBinsSlice = EbmMax(cBytesFastBinsSlice, cBytesPerFastBin * cTensorBins);
+   }
+   if(SIZE_MAX - (SIMD_BYTE_ALIGNMENT - 1) < cBytesFastBinsSlice) {
+      LOG_0(Trace_Warning, "WARNING BinSumsTerm fast bins alignment overflow");
+      return Error_OutOfMemory;
+   }
+   cBytesFastBinsSlice = (cBytesFastBinsSlice + (SIMD_BYTE_ALIGNMENT - 1)) & ~(SIMD_BYTE_ALIGNMENT - 1);
+
+   const size_t cThreads = nullptr == pThreadPool ? size_t{1} : pThreadPool->GetCountThreads();
+   const size_t cSubsetsWaveMax = EbmMin(cThreads, cSubsetsBinned);
+   if(IsMultiplyError(cBytesFastBinsSlice, cSubsetsWaveMax)) {
+      LOG_0(Trace_Warning, "WARNING BinSumsTerm IsMultiplyError(cBytesFastBinsSlice, cSubsetsWaveMax)");
+      return Error_OutOfMemory;
+   }
+
+   // this doesn't need to be freed since it's tracked and re-used by the class InteractionShell
+   BinBase* const aFastBinsAll = pBins->GetFastBinsTemp(cBytesFastBinsSlice * cSubsetsWaveMax);
+   if(UNLIKELY(nullptr == aFastBinsAll)) {
+      // already logged
+      return Error_OutOfMemory;
+   }
+
+   pBinSums->m_cRuntimeRealDimensions = cDimensions;
+   pBinSums->m_bHessian = bHessian ? EBM_TRUE : EBM_FALSE;
+   pBinSums->m_cScores = cScores;
+   pBinSums->m_bPackedTrailingItem =
+         pInteractionCore->GetDataSetInteraction()->IsBorrowedData() ? EBM_TRUE : EBM_FALSE;
+   pBinSums->m_bWeightGradients = pBinSums->m_bPackedTrailingItem;
+
+   size_t iSubsetWave = 0;
+   do {
+      const size_t cSubsetsWave = EbmMin(cSubsetsWaveMax, cSubsetsBinned - iSubsetWave);
+
+      auto binSubset = [&](const size_t iTask, const size_t) -> ErrorEbm {
+         DataSubsetInteraction* const pSubset = GetBinnedSubset(iSubsetWave + iTask);
+         const size_t cBytesPerFastBin = GetFastBinSize(pSubset, bHessian, cScores);
+
+         BinBase* const aFastBins = IndexBin(aFastBinsAll, cBytesFastBinsSlice * iTask);
+         aFastBins->ZeroMem(cBytesPerFastBin, cTensorBins);
+
+         BinSumsInteractionBridge params = *pBinSums;
+
+#ifndef NDEBUG
+         params.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cTensorBins);
+#endif // NDEBUG
+
+         size_t iDimensionLoop = 0;
+         do {
+            const IntEbm indexFeature = featureIndexes[iDimensionLoop];
+            const size_t iFeature = static_cast<size_t>(indexFeature);
+
+            params.m_aaPacked[iDimensionLoop] = pSubset->GetFeatureData(iFeature);
+
+            params.m_acItemsPerBitPack[iDimensionLoop] = pSubset->GetFeaturePack(iFeature);
+            EBM_ASSERT(1 <= params.m_acItemsPerBitPack[iDimensionLoop]);
+
+            ++iDimensionLoop;
+         } while(cDimensions != iDimensionLoop);
+
+         params.m_cSamples = pSubset->GetCountSamples();
+         params.m_aGradientsAndHessians = pSubset->GetGradHess();
+         params.m_aWeights = pSubset->GetWeights();
+
+         params.m_aFastBins = aFastBins;
+
+         return pSubset->BinSumsInteraction(&params);
+      };
+      if(size_t{1} == cSubsetsWave) {
+         error = binSubset(size_t{0}, size_t{0});
+      } else {
+         error = pThreadPool->Run(cSubsetsWave, binSubset);
+      }
+      if(Error_None != error) {
+         return error;
+      }
+
+      for(size_t iTask = 0; iTask < cSubsetsWave; ++iTask) {
+         const DataSubsetInteraction* const pSubset = GetBinnedSubset(iSubsetWave + iTask);
+         ConvertAddBin(cScores,
+               bHessian,
+               cTensorBins,
+               sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes,
+               sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes,
+               true,
+               true,
+               IndexBin(aFastBinsAll, cBytesFastBinsSlice * iTask),
+               nullptr,
+               nullptr,
+               std::is_same<UIntMain, uint64_t>::value,
+               std::is_same<FloatMain, double>::value,
+               aMainBins);
+      }
+
+      iSubsetWave += cSubsetsWave;
+   } while(cSubsetsBinned != iSubsetWave);
+
+   return Error_None;
+}
+
+// A pair needs cSamplesLeafMin samples in each of its 4 quadrants, so both sides of a cut in either feature need at
+// least twice that many.  If no cut of the feature meets this then the pair has no legal cuts and its strength is 0
+static bool IsLegalPairCutPossible(
+      InteractionCore* const pInteractionCore, const size_t iFeature, const size_t cSamplesLeafMin) {
+   const BinBase* const aMarginalBins = pInteractionCore->GetMarginalBins(iFeature);
+   if(nullptr == aMarginalBins || size_t{0} == cSamplesLeafMin) {
+      // without the cache we cannot rule anything out
+      return true;
+   }
+   if(std::numeric_limits<UIntMain>::max() / UIntMain{2} < static_cast<UIntMain>(cSamplesLeafMin) ||
+         IsConvertError<UIntMain>(cSamplesLeafMin)) {
+      return false;
+   }
+   const UIntMain cSideSamplesMin = static_cast<UIntMain>(cSamplesLeafMin) * UIntMain{2};
+
+   // only the counts are read, and they come first in every bin
+   const size_t cBytesPerMainBin =
+         GetBinSize<FloatMain, UIntMain>(true, true, pInteractionCore->IsHessian(), pInteractionCore->GetCountScores());
+   const size_t cBins = pInteractionCore->GetFeatures()[iFeature].GetCountBins();
+   EBM_ASSERT(size_t{2} <= cBins);
+
+   UIntMain cSamplesTotal = 0;
+   for(size_t iBin = 0; iBin < cBins; ++iBin) {
+      cSamplesTotal += IndexBin(aMarginalBins, cBytesPerMainBin * iBin)
+                             ->Specialize<FloatMain, UIntMain, true, true, false>()
+                             ->GetCountSamples();
+   }
+   UIntMain cSamplesLow = 0;
+   for(size_t iBin = 0; iBin < cBins - size_t{1}; ++iBin) {
+      cSamplesLow += IndexBin(aMarginalBins, cBytesPerMainBin * iBin)
+                           ->Specialize<FloatMain, UIntMain, true, true, false>()
+                           ->GetCountSamples();
+      if(cSideSamplesMin <= cSamplesLow && cSideSamplesMin <= cSamplesTotal - cSamplesLow) {
+         return true;
+      }
+   }
+   return false;
+}
+
+// converts a gain in the units of the main bins into the units of the interaction strength
+static double ScaleInteractionGain(InteractionCore* const pInteractionCore,
+      const CalcInteractionFlags flags,
+      const double weightSkipped,
+      double gain) {
+   // if totalWeight < 1 then gain could overflow to +inf, so do the division first
+   const double totalWeight = pInteractionCore->GetDataSetInteraction()->GetWeightTotal() - weightSkipped;
+   EBM_ASSERT(0 < totalWeight); // if all are zeros we assume there are no weights and use the count
+   gain /= totalWeight;
+   if(CalcInteractionFlags_DisableNewton & flags) {
+      gain *= pInteractionCore->GainAdjustmentGradientBoosting();
+   } else {
+      gain /= pInteractionCore->HessianConstant();
+      gain *= pInteractionCore->GainAdjustmentHessianBoosting();
+   }
+   const double gradientConstant = pInteractionCore->GradientConstant();
+   gain *= gradientConstant;
+   gain *= gradientConstant;
+   return gain;
+}
+
+// maps a scaled gain onto the values that CalcInteractionStrength returns
+static double CleanInteractionStrength(double bestGain) {
+   if(UNLIKELY(/* NaN */ !LIKELY(bestGain <= std::numeric_limits<double>::max()))) {
+      // We simplify our caller's handling by returning -lowest as our error indicator. -lowest will sort to being
+      // the least important item, which is good, but it also signals an overflow without the weirness of NaNs.
+      EBM_ASSERT(std::isnan(bestGain) || std::numeric_limits<double>::infinity() == bestGain);
+      bestGain = k_illegalGainDouble;
+   } else if(UNLIKELY(bestGain < 0.0)) {
+      // gain can't mathematically be legally negative, but it can be here in the following situations:
+      //   1) for impure interaction gain we subtract the parent partial gain, and there can be floating point
+      //      noise that makes this slightly negative
+      //   2) for impure interaction gain we subtract the parent partial gain, but if there were no legal cuts
+      //      then the partial gain before subtracting the parent partial gain was zero and we then get a
+      //      substantially negative value.  In this case we should not have subtracted the parent partial gain
+      //      since we had never even calculated the 4 quadrant partial gain, but we handle this scenario
+      //      here instead of inside the templated function.
+
+      EBM_ASSERT(!std::isnan(bestGain));
+      // make bestGain k_illegalGainDouble if it's -infinity, otherwise make it zero
+      bestGain = std::numeric_limits<double>::lowest() <= bestGain ? 0.0 : k_illegalGainDouble;
+   } else {
+      EBM_ASSERT(!std::isnan(bestGain));
+      EBM_ASSERT(!std::isinf(bestGain));
+   }
+
+   EBM_ASSERT(k_illegalGainDouble == bestGain || 0.0 <= bestGain);
+   return bestGain;
+}
+
+// Every cut of a pair groups its tensor cells into 4 quadrants.  Without regularization the partial gain of a leaf is
+// G * G / H, which is never more than the sum of the partial gains of any split of the leaf, and regularization only
+// lowers it.  The sum over the individual cells therefore bounds the children partial gain of every cut of the pair.
+template<bool bHessian>
+static void SumCellPartialGains(const size_t cScores,
+      const bool bUseLogitBoost,
+      const size_t cTensorBins,
+      const BinBase* const aMainBins,
+      double* const pGainCellsOut,
+      double* const aGradientsOut,
+      double* const aHessiansOut) {
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+
+   double gainCells = 0.0;
+   for(size_t iScore = 0; iScore < cScores; ++iScore) {
+      aGradientsOut[iScore] = 0.0;
+      aHessiansOut[iScore] = 0.0;
+   }
+   for(size_t iBin = 0; iBin < cTensorBins; ++iBin) {
+      const auto* const pBin =
+            IndexBin(aMainBins, cBytesPerMainBin * iBin)->Specialize<FloatMain, UIntMain, true, true, bHessian>();
+      if(UIntMain{0} == pBin->GetCountSamples()) {
+         continue;
+      }
+      const auto* const aGradientPairs = pBin->GetGradientPairs();
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         const double grad = static_cast<double>(aGradientPairs[iScore].m_sumGradients);
+         const double hess = static_cast<double>(bUseLogitBoost ? aGradientPairs[iScore].GetHess() : pBin->GetWeight());
+         // a zero hessian gives +inf or NaN, which just prevents the pair from being skipped
+         gainCells += grad / hess * grad;
+         aGradientsOut[iScore] += grad;
+         aHessiansOut[iScore] += hess;
+      }
+   }
+   *pGainCellsOut = gainCells;
+}
+
+// returns an upper bound on the strength of the pair binned into aMainBins, which has not had its totals built yet
+static double CalcPairStrengthMax(InteractionCore* const pInteractionCore,
+      const CalcInteractionFlags flags,
+      const FloatCalc regAlpha,
+      const FloatCalc regLambda,
+      const FloatCalc deltaStepMax,
+      const double weightSkipped,
+      const size_t cTensorBins,
+      const BinBase* const aMainBins,
+      double* const aTemp) {
+   // the cell and parent sums are not added in the same order as the quadrant sums that they bound, so leave some
+   // room for floating point noise
+   static constexpr double k_boundSlack = 1e-7;
+
+   const size_t cScores = pInteractionCore->GetCountScores();
+   const bool bHessian = pInteractionCore->IsHessian();
+   const bool bUseLogitBoost = bHessian && !(CalcInteractionFlags_DisableNewton & flags);
+
+   double* const aGradients = aTemp;
+   double* const aHessians = aTemp + cScores;
+   double gain;
+   if(bHessian) {
+      SumCellPartialGains<true>(cScores, bUseLogitBoost, cTensorBins, aMainBins, &gain, aGradients, aHessians);
+   } else {
+      SumCellPartialGains<false>(cScores, bUseLogitBoost, cTensorBins, aMainBins, &gain, aGradients, aHessians);
+   }
+   gain *= 1.0 + k_boundSlack;
+
+   if(!(CalcInteractionFlags_Purify & flags)) {
+      // the impure strength is relative to not splitting the pair at all
+      double gainParent = 0.0;
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         gainParent += static_cast<double>(CalcPartialGain<true>(static_cast<FloatCalc>(aGradients[iScore]),
+               static_cast<FloatCalc>(aHessians[iScore]),
+               regAlpha,
+               regLambda,
+               deltaStepMax));
+      }
+      gain -= gainParent * (1.0 - k_boundSlack);
+   }
+
+   return ScaleInteractionGain(pInteractionCore, flags, weightSkipped, gain);
+}
+
+// pThreadPool is used to bin the subsets concurrently, or nullptr to bin them on the calling thread. A pair whose
+// strength is sure to be less than strengthPrune gets k_illegalGainDouble without being partitioned
+static ErrorEbm CalcInteractionStrengthTerm(InteractionCore* const pInteractionCore,
+      ThreadPool* const pThreadPool,
+      InteractionBins* const pBins,
+      const IntEbm countDimensions,
+      const IntEbm* const featureIndexes,
+      const CalcInteractionFlags flags,
+      const InteractionParams* const pParams,
+      const double strengthPrune,
+      double* const pInteractionStrengthOut) {
+   ErrorEbm error;
+
+   *pInteractionStrengthOut = k_illegalGainDouble;
+
+   const size_t cCardinalityMax = pParams->m_cCardinalityMax;
+   const size_t cSamplesLeafMin = pParams->m_cSamplesLeafMin;
+   const FloatCalc hessianMin = pParams->m_hessianMin;
+   const FloatCalc regAlphaCalc = pParams->m_regAlpha;
+   const FloatCalc regLambdaCalc = pParams->m_regLambda;
+   const FloatCalc deltaStepMax = pParams->m_deltaStepMax;
+
    if(countDimensions <= IntEbm{0}) {
       if(IntEbm{0} == countDimensions) {
          LOG_0(Trace_Info, "INFO CalcInteractionStrength empty feature list");
-         if(LIKELY(nullptr != avgInteractionStrengthOut)) {
-            *avgInteractionStrengthOut = 0.0;
-         }
+         *pInteractionStrengthOut = 0.0;
          return Error_None;
       } else {
          LOG_0(Trace_Error, "ERROR CalcInteractionStrength countDimensions must be positive");
@@ -242,14 +585,10 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
    }
    size_t cDimensions = static_cast<size_t>(countDimensions);
 
-   InteractionCore* const pInteractionCore = pInteractionShell->GetInteractionCore();
-
    const size_t cScores = pInteractionCore->GetCountScores();
    if(size_t{0} == cScores) {
       LOG_0(Trace_Info, "INFO CalcInteractionStrength target with 1 class perfectly predicts the target");
-      if(nullptr != avgInteractionStrengthOut) {
-         *avgInteractionStrengthOut = 0.0;
-      }
+      *pInteractionStrengthOut = 0.0;
       return Error_None;
    }
 
@@ -259,9 +598,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
    if(size_t{0} == pDataSet->GetCountSamples()) {
       // if there are zero samples, there isn't much basis to say whether there are interactions, so just return zero
       LOG_0(Trace_Info, "INFO CalcInteractionStrength zero samples");
-      if(nullptr != avgInteractionStrengthOut) {
-         *avgInteractionStrengthOut = 0.0;
-      }
+      *pInteractionStrengthOut = 0.0;
       return Error_None;
    }
 
@@ -295,11 +632,14 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
       const size_t cBins = pFeature->GetCountBins();
       if(UNLIKELY(cBins <= size_t{1})) {
          LOG_0(Trace_Info, "INFO CalcInteractionStrength term contains a feature with only 1 or 0 bins");
-         if(nullptr != avgInteractionStrengthOut) {
-            *avgInteractionStrengthOut = 0.0;
-         }
+         *pInteractionStrengthOut = 0.0;
          return Error_None;
       }
+      if(UNLIKELY(!pDataSet->IsFeatureBinned(iFeature))) {
+         LOG_0(Trace_Error,
+               "ERROR CalcInteractionStrength feature is not the only feature of any term in the attached booster");
+         return Error_IllegalParamVal;
+      }
       binSums.m_acBins[iDimension] = cBins;
 
       // if cBins could be 1, then we'd need to check at runtime for overflow of cAuxillaryBinsForBuildFastTotals
@@ -318,9 +658,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
          // scores, so we need to check if our caller gave us a tensor that overflows multiplication if we overflow
          // this, then we'd be above the cCardinalityMax value, so set it to 0.0
          LOG_0(Trace_Info, "INFO CalcInteractionStrength IsMultiplyError(cTensorBins, cBins)");
-         if(nullptr != avgInteractionStrengthOut) {
-            *avgInteractionStrengthOut = 0.0;
-         }
+         *pInteractionStrengthOut = 0.0;
          return Error_None;
       }
       cTensorBins *= cBins;
@@ -331,16 +669,58 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
       ++iDimension;
    } while(cDimensions != iDimension);
 
+   if(size_t{3} <= cDimensions && 0 != (CalcInteractionFlags_SparseBins & flags) &&
+         0 == (CalcInteractionFlags_Purify & flags)) {
+      // only the occupied cells are held in memory, so cCardinalityMax does not limit these terms
+      EBM_ASSERT(size_t{0} == pParams->m_cSubsetsSkip); // the sparse cells are binned from every subset
+      double gain;
+      error = PartitionSparseInteraction(pInteractionCore,
+            cDimensions,
+            featureIndexes,
+            binSums.m_acBins,
+            flags,
+            cSamplesLeafMin,
+            hessianMin,
+            regAlphaCalc,
+            regLambdaCalc,
+            deltaStepMax,
+            &gain);
+      if(Error_None != error) {
+         return error;
+      }
+      *pInteractionStrengthOut = CleanInteractionStrength(ScaleInteractionGain(pInteractionCore, flags, 0.0, gain));
+      return Error_None;
+   }
+
    if(cCardinalityMax < cTensorBins) {
       LOG_0(Trace_Info, "INFO CalcInteractionStrength cCardinalityMax < cTensorBins");
-      if(nullptr != avgInteractionStrengthOut) {
-         *avgInteractionStrengthOut = 0.0;
-      }
+      *pInteractionStrengthOut = 0.0;
       return Error_None;
    }
 
+   if(2 == cDimensions) {
+      if(!IsLegalPairCutPossible(pInteractionCore, static_cast<size_t>(featureIndexes[0]), cSamplesLeafMin) ||
+            !IsLegalPairCutPossible(pInteractionCore, static_cast<size_t>(featureIndexes[1]), cSamplesLeafMin)) {
+         LOG_0(Trace_Verbose, "CalcInteractionStrength the marginal bins rule out any legal cut");
+         *pInteractionStrengthOut = 0.0;
+         return Error_None;
+      }
+   }
+
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, pInteractionCore->IsHessian(), cScores);
+
    static constexpr size_t cAuxillaryBinsForSplitting = 4;
-   const size_t cAuxillaryBins = EbmMax(cAuxillaryBinsForBuildFastTotals, cAuxillaryBinsForSplitting);
+   size_t cAuxillaryBins = EbmMax(cAuxillaryBinsForBuildFastTotals, cAuxillaryBinsForSplitting);
+   if(2 == cDimensions) {
+      // the pair cut sweep keeps its rows in the auxiliary bins once the totals have been built
+      const size_t cBytesSweep =
+            GetPartitionTwoDimensionalInteractionSize(pInteractionCore->IsHessian(), cScores, binSums.m_acBins[1]);
+      if(size_t{0} == cBytesSweep) {
+         LOG_0(Trace_Warning, "WARNING CalcInteractionStrength GetPartitionTwoDimensionalInteractionSize overflow");
+         return Error_OutOfMemory;
+      }
+      cAuxillaryBins = EbmMax(cAuxillaryBins, cBytesSweep / cBytesPerMainBin + size_t{1});
+   }
 
    if(IsAddError(cTensorBins, cAuxillaryBins)) {
       LOG_0(Trace_Warning, "WARNING CalcInteractionStrength IsAddError(cTensorBins, cAuxillaryBins)");
@@ -348,13 +728,12 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
    }
    const size_t cTotalMainBins = cTensorBins + cAuxillaryBins;
 
-   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, pInteractionCore->IsHessian(), cScores);
    if(IsMultiplyError(cBytesPerMainBin, cTotalMainBins)) {
       LOG_0(Trace_Warning, "WARNING CalcInteractionStrength IsMultiplyError(cBytesPerBin, cTotalMainBins)");
       return Error_OutOfMemory;
    }
 
-   BinBase* const aMainBins = pInteractionShell->GetInteractionMainBins(cBytesPerMainBin, cTotalMainBins);
+   BinBase* const aMainBins = pBins->GetMainBins(cBytesPerMainBin, cTotalMainBins);
    if(UNLIKELY(nullptr == aMainBins)) {
       // already logged
       return Error_OutOfMemory;
@@ -368,98 +747,43 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
 
    const bool bHessian = pInteractionCore->IsHessian();
 
-   EBM_ASSERT(1 <= pInteractionCore->GetDataSetInteraction()->GetCountSubsets());
-   DataSubsetInteraction* pSubset = pInteractionCore->GetDataSetInteraction()->GetSubsets();
-   const DataSubsetInteraction* const pSubsetsEnd =
-         pSubset + pInteractionCore->GetDataSetInteraction()->GetCountSubsets();
-   do {
-      size_t cBytesPerFastBin;
-      if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-         if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-            cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(true, true, bHessian, cScores);
-         } else {
-            EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-            cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(true, true, bHessian, cScores);
-         }
-      } else {
-         EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-         if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-            cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(true, true, bHessian, cScores);
-         } else {
-            EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-            cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(true, true, bHessian, cScores);
-         }
-      }
-      if(IsMultiplyError(cBytesPerFastBin, cTensorBins)) {
-         LOG_0(Trace_Warning, "WARNING CalcInteractionStrength IsMultiplyError(cBytesPerBin, cTensorBins)");
-         return Error_OutOfMemory;
-      }
+   error = BinSumsTerm(pInteractionCore,
+         pThreadPool,
+         pBins,
+         cDimensions,
+         featureIndexes,
+         &binSums,
+         cTensorBins,
+         pParams->m_iSubsetSkip,
+         pParams->m_cSubsetsSkip,
+         aMainBins);
+   if(Error_None != error) {
+      return error;
+   }
 
-      // this doesn't need to be freed since it's tracked and re-used by the class InteractionShell
-      BinBase* const aFastBins = pInteractionShell->GetInteractionFastBinsTemp(cBytesPerFastBin * cTensorBins);
-      if(UNLIKELY(nullptr == aFastBins)) {
-         // already logged
-         return Error_OutOfMemory;
+   if(2 == cDimensions && k_illegalGainDouble != strengthPrune) {
+      // the auxiliary bins are not used until the totals are built, so borrow them for the per score sums
+      EBM_ASSERT(sizeof(double) * cScores * 2 <= cBytesPerMainBin * cAuxillaryBins);
+      double* const aTemp = reinterpret_cast<double*>(IndexBin(aMainBins, cBytesPerMainBin * cTensorBins));
+      const double strengthMax = CalcPairStrengthMax(pInteractionCore,
+            flags,
+            regAlphaCalc,
+            regLambdaCalc,
+            deltaStepMax,
+            pParams->m_weightSkipped,
+            cTensorBins,
+            aMainBins,
+            aTemp);
+      if(strengthMax < strengthPrune) {
+         LOG_0(Trace_Verbose, "CalcInteractionStrength the pair cannot reach strengthPrune");
+         return Error_None;
       }
+   }
 
-      aFastBins->ZeroMem(cBytesPerFastBin, cTensorBins);
+   // TODO: we can exit here back to python to allow caller modification to our bins
 
 #ifndef NDEBUG
-      binSums.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cTensorBins);
-#endif // NDEBUG
-
-      size_t iDimensionLoop = 0;
-      do {
-         const IntEbm indexFeature = featureIndexes[iDimensionLoop];
-         const size_t iFeature = static_cast<size_t>(indexFeature);
-         const FeatureInteraction* const pFeature = &aFeatures[iFeature];
-
-         binSums.m_aaPacked[iDimensionLoop] = pSubset->GetFeatureData(iFeature);
-
-         EBM_ASSERT(1 <= pFeature->GetBitsRequiredMin());
-         binSums.m_acItemsPerBitPack[iDimensionLoop] =
-               GetCountItemsBitPacked(pFeature->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-
-         ++iDimensionLoop;
-      } while(cDimensions != iDimensionLoop);
-
-      binSums.m_cRuntimeRealDimensions = cDimensions;
-
-      binSums.m_bHessian = pInteractionCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
-      binSums.m_cScores = cScores;
-
-      binSums.m_cSamples = pSubset->GetCountSamples();
-      binSums.m_aGradientsAndHessians = pSubset->GetGradHess();
-      binSums.m_aWeights = pSubset->GetWeights();
-
-      binSums.m_aFastBins = aFastBins;
-
-      error = pSubset->BinSumsInteraction(&binSums);
-      if(Error_None != error) {
-         return error;
-      }
-
-      ConvertAddBin(cScores,
-            pInteractionCore->IsHessian(),
-            cTensorBins,
-            sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes,
-            sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes,
-            true,
-            true,
-            aFastBins,
-            nullptr,
-            nullptr,
-            std::is_same<UIntMain, uint64_t>::value,
-            std::is_same<FloatMain, double>::value,
-            aMainBins);
-
-      ++pSubset;
-   } while(pSubsetsEnd != pSubset);
-
-   // TODO: we can exit here back to python to allow caller modification to our bins
-
-#ifndef NDEBUG
-   // make a copy of the original bins for debugging purposes
+   // make a copy of the original bins for debugging purposes
 
    BinBase* aDebugCopyBins = nullptr;
    if(!IsMultiplyError(cBytesPerMainBin, cTensorBins)) {
@@ -564,11 +888,12 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
       const size_t cBytesBest = cBytesTreeNodeMulti * (size_t{1} + (cDimensions << 1));
       EBM_ASSERT(cBytesBest <= cBytes);
 
-      // double it because we during the multi-dimensional sweep we need the best and we need the current
-      if(IsAddError(cBytesBest, cBytesBest)) {
+      // double it because we during the multi-dimensional sweep we need the best and we need the current.
+      // The terms can already be running on our thread pool, so the sweep is done by a single task here
+      if(IsAddError(cBytesBest, cBytesBest, sizeof(SweepResult))) {
          return Error_OutOfMemory;
       }
-      const size_t cBytesSweep = cBytesBest + cBytesBest;
+      const size_t cBytesSweep = cBytesBest + cBytesBest + sizeof(SweepResult);
 
       cBytes = EbmMax(cBytes, cBytesSweep);
 
@@ -635,8 +960,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
             flags,
             cSamplesLeafMin,
             hessianMin,
-            regAlpha,
-            regLambda,
+            regAlphaCalc,
+            regLambdaCalc,
             deltaStepMax,
             aMainBins,
             aAuxiliaryBins,
@@ -648,7 +973,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
             pHessian,
             &bestGain,
             cPossibleSplits,
-            pTemp1
+            pTemp1,
+            nullptr,
+            size_t{1}
 #ifndef NDEBUG
             ,
             aDebugCopyBins,
@@ -678,56 +1005,780 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
    free(aDebugCopyBins);
 #endif // NDEBUG
 
-   // if totalWeight < 1 then bestGain could overflow to +inf, so do the division first
-   const double totalWeight = pDataSet->GetWeightTotal();
-   EBM_ASSERT(0 < totalWeight); // if all are zeros we assume there are no weights and use the count
-   bestGain /= totalWeight;
-   if(CalcInteractionFlags_DisableNewton & flags) {
-      bestGain *= pInteractionCore->GainAdjustmentGradientBoosting();
-   } else {
-      bestGain /= pInteractionCore->HessianConstant();
-      bestGain *= pInteractionCore->GainAdjustmentHessianBoosting();
+   *pInteractionStrengthOut = CleanInteractionStrength(
+         ScaleInteractionGain(pInteractionCore, flags, pParams->m_weightSkipped, bestGain));
+   return Error_None;
+}
+
+// bins the subsets of a single term on the shared pool with up to the detector's count of threads
+static ErrorEbm CalcInteractionStrengthTermShared(InteractionCore* const pInteractionCore,
+      InteractionBins* const pBins,
+      const IntEbm countDimensions,
+      const IntEbm* const featureIndexes,
+      const CalcInteractionFlags flags,
+      const InteractionParams* const pParams,
+      double* const pInteractionStrengthOut) {
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(pInteractionCore->GetCountThreads(), &pThreadPool);
+   if(Error_None != error) {
+      *pInteractionStrengthOut = k_illegalGainDouble;
+      return error;
    }
-   const double gradientConstant = pInteractionCore->GradientConstant();
-   bestGain *= gradientConstant;
-   bestGain *= gradientConstant;
+   error = CalcInteractionStrengthTerm(pInteractionCore,
+         pThreadPool,
+         pBins,
+         countDimensions,
+         featureIndexes,
+         flags,
+         pParams,
+         k_illegalGainDouble,
+         pInteractionStrengthOut);
+   ThreadPool::Return(pThreadPool);
+   return error;
+}
 
-   if(UNLIKELY(/* NaN */ !LIKELY(bestGain <= std::numeric_limits<double>::max()))) {
-      // We simplify our caller's handling by returning -lowest as our error indicator. -lowest will sort to being
-      // the least important item, which is good, but it also signals an overflow without the weirness of NaNs.
-      EBM_ASSERT(std::isnan(bestGain) || std::numeric_limits<double>::infinity() == bestGain);
-      bestGain = k_illegalGainDouble;
-   } else if(UNLIKELY(bestGain < 0.0)) {
-      // gain can't mathematically be legally negative, but it can be here in the following situations:
-      //   1) for impure interaction gain we subtract the parent partial gain, and there can be floating point
-      //      noise that makes this slightly negative
-      //   2) for impure interaction gain we subtract the parent partial gain, but if there were no legal cuts
-      //      then the partial gain before subtracting the parent partial gain was zero and we then get a
-      //      substantially negative value.  In this case we should not have subtracted the parent partial gain
-      //      since we had never even calculated the 4 quadrant partial gain, but we handle this scenario
-      //      here instead of inside the templated function.
+// there is a race condition for decrementing this variable, but if a thread loses the
+// race then it just doesn't get decremented as quickly, which we can live with
+extern ErrorEbm CacheInteractionMarginals(InteractionShell* const pInteractionShell) {
+   LOG_0(Trace_Info, "Entered CacheInteractionMarginals");
 
-      EBM_ASSERT(!std::isnan(bestGain));
-      // make bestGain k_illegalGainDouble if it's -infinity, otherwise make it zero
-      bestGain = std::numeric_limits<double>::lowest() <= bestGain ? 0.0 : k_illegalGainDouble;
-   } else {
-      EBM_ASSERT(!std::isnan(bestGain));
-      EBM_ASSERT(!std::isinf(bestGain));
+   InteractionCore* const pInteractionCore = pInteractionShell->GetInteractionCore();
+   if(size_t{0} == pInteractionCore->GetCountScores() || size_t{0} == pInteractionCore->GetCountFeatures() ||
+         size_t{0} == pInteractionCore->GetDataSetInteraction()->GetCountSamples()) {
+      // CalcInteractionStrength returns before it would look at the marginals
+      return Error_None;
+   }
+
+   BinBase** apMarginalBins;
+   ErrorEbm error = pInteractionCore->AllocateMarginalBins(&apMarginalBins);
+   if(Error_None != error) {
+      return error;
+   }
+
+   InteractionBins* const aBins = pInteractionShell->GetBins(size_t{1});
+   if(UNLIKELY(nullptr == aBins)) {
+      // already logged
+      return Error_OutOfMemory;
+   }
+
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(
+         true, true, pInteractionCore->IsHessian(), pInteractionCore->GetCountScores());
+
+   const size_t cFeatures = pInteractionCore->GetCountFeatures();
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      BinBase* const aMarginalBins = apMarginalBins[iFeature];
+      if(nullptr != aMarginalBins) {
+         const size_t cBins = pInteractionCore->GetFeatures()[iFeature].GetCountBins();
+         memset(aMarginalBins, 0, cBytesPerMainBin * cBins);
+
+         BinSumsInteractionBridge binSums;
+         binSums.m_acBins[0] = cBins;
+         const IntEbm indexFeature = static_cast<IntEbm>(iFeature);
+         ThreadPool* pThreadPool = nullptr;
+         error = ThreadPool::Borrow(pInteractionCore->GetCountThreads(), &pThreadPool);
+         if(Error_None != error) {
+            return error;
+         }
+         error = BinSumsTerm(pInteractionCore,
+               pThreadPool,
+               aBins,
+               size_t{1},
+               &indexFeature,
+               &binSums,
+               cBins,
+               0,
+               0,
+               aMarginalBins);
+         ThreadPool::Return(pThreadPool);
+         if(Error_None != error) {
+            return error;
+         }
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited CacheInteractionMarginals");
+   return Error_None;
+}
+
+static int g_cLogCalcInteractionStrength = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(InteractionHandle interactionHandle,
+      IntEbm countDimensions,
+      const IntEbm* featureIndexes,
+      CalcInteractionFlags flags,
+      IntEbm maxCardinality,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      double* avgInteractionStrengthOut) {
+   LOG_COUNTED_N(&g_cLogCalcInteractionStrength,
+         Trace_Info,
+         Trace_Verbose,
+         "CalcInteractionStrength: "
+         "interactionHandle=%p, "
+         "countDimensions=%" IntEbmPrintf ", "
+         "featureIndexes=%p, "
+         "flags=0x%" UCalcInteractionFlagsPrintf ", "
+         "maxCardinality=%" IntEbmPrintf ", "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "avgInteractionStrengthOut=%p",
+         static_cast<void*>(interactionHandle),
+         countDimensions,
+         static_cast<const void*>(featureIndexes),
+         static_cast<UCalcInteractionFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         maxCardinality,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<void*>(avgInteractionStrengthOut));
+
+   if(LIKELY(nullptr != avgInteractionStrengthOut)) {
+      *avgInteractionStrengthOut = k_illegalGainDouble;
+   }
+
+   InteractionShell* const pInteractionShell = InteractionShell::GetInteractionShellFromHandle(interactionHandle);
+   if(nullptr == pInteractionShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+   LOG_COUNTED_0(pInteractionShell->GetPointerCountLogEnterMessages(),
+         Trace_Info,
+         Trace_Verbose,
+         "Entered CalcInteractionStrength");
+
+   if(flags &
+         ~(CalcInteractionFlags_DisableNewton | CalcInteractionFlags_Purify | CalcInteractionFlags_SparseBins)) {
+      LOG_0(Trace_Error, "ERROR CalcInteractionStrength flags contains unknown flags. Ignoring extras.");
+   }
+   InteractionParams params;
+   NormalizeInteractionParams(
+         maxCardinality, minSamplesLeaf, minHessian, regAlpha, regLambda, maxDeltaStep, &params);
+
+   InteractionBins* const aBins = pInteractionShell->GetBins(size_t{1});
+   if(UNLIKELY(nullptr == aBins)) {
+      // already logged
+      return Error_OutOfMemory;
+   }
+
+   double bestGain;
+   InteractionCore* const pInteractionCore = pInteractionShell->GetInteractionCore();
+   const ErrorEbm error = CalcInteractionStrengthTermShared(
+         pInteractionCore, aBins, countDimensions, featureIndexes, flags, &params, &bestGain);
+   if(Error_None != error) {
+      return error;
    }
 
    if(nullptr != avgInteractionStrengthOut) {
       *avgInteractionStrengthOut = bestGain;
    }
 
-   EBM_ASSERT(k_illegalGainDouble == bestGain || 0.0 <= bestGain);
    LOG_COUNTED_N(pInteractionShell->GetPointerCountLogExitMessages(),
          Trace_Info,
          Trace_Verbose,
          "Exited CalcInteractionStrength: "
          "bestGain=%le",
          bestGain);
+   TRACE_EVENT(Trace_Info,
+         TraceEvent_CalcInteractionStrength,
+         pInteractionShell->GetHandle(),
+         static_cast<double>(countDimensions),
+         static_cast<double>(flags),
+         bestGain);
+
+   return Error_None;
+}
+
+// the total weight of pSubset, which is its count of samples if the detector has no weights
+static double SumSubsetWeight(const DataSubsetInteraction* const pSubset) {
+   const size_t cSamples = pSubset->GetCountSamples();
+   const void* const aWeights = pSubset->GetWeights();
+   if(nullptr == aWeights) {
+      return static_cast<double>(cSamples);
+   }
+   double weight = 0.0;
+   if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         weight += static_cast<double>(static_cast<const FloatBig*>(aWeights)[iSample]);
+      }
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         weight += static_cast<double>(static_cast<const FloatSmall*>(aWeights)[iSample]);
+      }
+   }
+   return weight;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrengthInterval(InteractionHandle interactionHandle,
+      IntEbm countDimensions,
+      const IntEbm* featureIndexes,
+      CalcInteractionFlags flags,
+      IntEbm maxCardinality,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      double* avgInteractionStrengthOut,
+      double* standardErrorOut) {
+   LOG_N(Trace_Info,
+         "Entered CalcInteractionStrengthInterval: "
+         "interactionHandle=%p, "
+         "countDimensions=%" IntEbmPrintf ", "
+         "featureIndexes=%p, "
+         "flags=0x%" UCalcInteractionFlagsPrintf ", "
+         "maxCardinality=%" IntEbmPrintf ", "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "avgInteractionStrengthOut=%p, "
+         "standardErrorOut=%p",
+         static_cast<void*>(interactionHandle),
+         countDimensions,
+         static_cast<const void*>(featureIndexes),
+         static_cast<UCalcInteractionFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         maxCardinality,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<void*>(avgInteractionStrengthOut),
+         static_cast<void*>(standardErrorOut));
+
+   ErrorEbm error;
+
+   if(LIKELY(nullptr != avgInteractionStrengthOut)) {
+      *avgInteractionStrengthOut = k_illegalGainDouble;
+   }
+   if(LIKELY(nullptr != standardErrorOut)) {
+      *standardErrorOut = std::numeric_limits<double>::infinity();
+   }
+
+   InteractionShell* const pInteractionShell = InteractionShell::GetInteractionShellFromHandle(interactionHandle);
+   if(nullptr == pInteractionShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(flags &
+         ~(CalcInteractionFlags_DisableNewton | CalcInteractionFlags_Purify | CalcInteractionFlags_SparseBins)) {
+      LOG_0(Trace_Error, "ERROR CalcInteractionStrengthInterval flags contains unknown flags. Ignoring extras.");
+   }
+   // the sparse cells are binned from every subset at once, so the groups cannot be left out of them
+   const CalcInteractionFlags flagsDense = flags & ~CalcInteractionFlags_SparseBins;
+
+   InteractionParams params;
+   NormalizeInteractionParams(
+         maxCardinality, minSamplesLeaf, minHessian, regAlpha, regLambda, maxDeltaStep, &params);
+
+   InteractionBins* const aBins = pInteractionShell->GetBins(size_t{1});
+   if(UNLIKELY(nullptr == aBins)) {
+      // already logged
+      return Error_OutOfMemory;
+   }
+
+   InteractionCore* const pInteractionCore = pInteractionShell->GetInteractionCore();
+
+   double strength;
+   error = CalcInteractionStrengthTermShared(
+         pInteractionCore, aBins, countDimensions, featureIndexes, flagsDense, &params, &strength);
+   if(Error_None != error) {
+      return error;
+   }
+   if(nullptr != avgInteractionStrengthOut) {
+      *avgInteractionStrengthOut = strength;
+   }
+
+   // The delete-a-group jackknife recomputes the strength with each group of samples left out. The groups are runs
+   // of whole subsets, so they hold the samples in their dataset order
+   DataSetInteraction* const pDataSet = pInteractionCore->GetDataSetInteraction();
+   const size_t cSamples = pDataSet->GetCountSamples();
+   const size_t cSubsets = pDataSet->GetCountSubsets();
+   const size_t cGroups = EbmMin(k_cJackknifeGroups, cSubsets);
+   if(size_t{0} == pInteractionCore->GetCountScores() || size_t{0} == cSamples || cGroups < size_t{2} ||
+         k_illegalGainDouble == strength) {
+      LOG_0(Trace_Info, "Exited CalcInteractionStrengthInterval without groups to leave out");
+      return Error_None;
+   }
+   const DataSubsetInteraction* const aSubsets = pDataSet->GetSubsets();
+   const size_t cGroupSamples = (cSamples + cGroups - 1) / cGroups;
+
+   double aGroupStrengths[k_cJackknifeGroups];
+   size_t cGroupStrengths = 0;
+   size_t iSubset = 0;
+   size_t iSampleStart = 0;
+   while(cSubsets != iSubset) {
+      const size_t iGroup = iSampleStart / cGroupSamples;
+      params.m_iSubsetSkip = iSubset;
+      params.m_cSubsetsSkip = 0;
+      params.m_weightSkipped = 0.0;
+      do {
+         params.m_weightSkipped += SumSubsetWeight(&aSubsets[iSubset]);
+         iSampleStart += aSubsets[iSubset].GetCountSamples();
+         ++params.m_cSubsetsSkip;
+         ++iSubset;
+      } while(cSubsets != iSubset && iSampleStart / cGroupSamples == iGroup);
+
+      if(cSubsets == params.m_cSubsetsSkip) {
+         // a single subset holds every sample, so there is nothing to compare against
+         return Error_None;
+      }
+
+      double groupStrength;
+      error = CalcInteractionStrengthTermShared(
+            pInteractionCore, aBins, countDimensions, featureIndexes, flagsDense, &params, &groupStrength);
+      if(Error_None != error) {
+         return error;
+      }
+      if(k_illegalGainDouble == groupStrength) {
+         LOG_0(Trace_Warning, "WARNING CalcInteractionStrengthInterval a group left out gave an illegal strength");
+         return Error_None;
+      }
+      EBM_ASSERT(cGroupStrengths < k_cJackknifeGroups);
+      aGroupStrengths[cGroupStrengths] = groupStrength;
+      ++cGroupStrengths;
+   }
+   EBM_ASSERT(size_t{2} <= cGroupStrengths);
+
+   double groupStrengthAvg = 0.0;
+   for(size_t iGroup = 0; iGroup < cGroupStrengths; ++iGroup) {
+      groupStrengthAvg += aGroupStrengths[iGroup];
+   }
+   groupStrengthAvg /= static_cast<double>(cGroupStrengths);
 
+   double sumSquares = 0.0;
+   for(size_t iGroup = 0; iGroup < cGroupStrengths; ++iGroup) {
+      const double diff = aGroupStrengths[iGroup] - groupStrengthAvg;
+      sumSquares += diff * diff;
+   }
+   const double standardError = std::sqrt(
+         sumSquares * static_cast<double>(cGroupStrengths - 1) / static_cast<double>(cGroupStrengths));
+
+   if(nullptr != standardErrorOut) {
+      *standardErrorOut = standardError;
+   }
+
+   LOG_N(Trace_Info,
+         "Exited CalcInteractionStrengthInterval: strength=%le, standardError=%le, groups=%zu",
+         strength,
+         standardError,
+         cGroupStrengths);
    return Error_None;
 }
 
+static int g_cLogCalcInteractionStrengths = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrengths(InteractionHandle interactionHandle,
+      IntEbm countTerms,
+      IntEbm countDimensions,
+      const IntEbm* featureIndexes,
+      CalcInteractionFlags flags,
+      IntEbm maxCardinality,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      double* avgInteractionStrengthsOut) {
+   LOG_COUNTED_N(&g_cLogCalcInteractionStrengths,
+         Trace_Info,
+         Trace_Verbose,
+         "CalcInteractionStrengths: "
+         "interactionHandle=%p, "
+         "countTerms=%" IntEbmPrintf ", "
+         "countDimensions=%" IntEbmPrintf ", "
+         "featureIndexes=%p, "
+         "flags=0x%" UCalcInteractionFlagsPrintf ", "
+         "maxCardinality=%" IntEbmPrintf ", "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "avgInteractionStrengthsOut=%p",
+         static_cast<void*>(interactionHandle),
+         countTerms,
+         countDimensions,
+         static_cast<const void*>(featureIndexes),
+         static_cast<UCalcInteractionFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         maxCardinality,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<void*>(avgInteractionStrengthsOut));
+
+   InteractionShell* const pInteractionShell = InteractionShell::GetInteractionShellFromHandle(interactionHandle);
+   if(nullptr == pInteractionShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(countTerms <= IntEbm{0}) {
+      if(IntEbm{0} == countTerms) {
+         LOG_0(Trace_Info, "INFO CalcInteractionStrengths zero terms");
+         return Error_None;
+      }
+      LOG_0(Trace_Error, "ERROR CalcInteractionStrengths countTerms must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countTerms)) {
+      LOG_0(Trace_Error, "ERROR CalcInteractionStrengths IsConvertError<size_t>(countTerms)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   if(nullptr == avgInteractionStrengthsOut) {
+      LOG_0(Trace_Error, "ERROR CalcInteractionStrengths avgInteractionStrengthsOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+   if(IsMultiplyError(sizeof(*avgInteractionStrengthsOut), cTerms)) {
+      LOG_0(Trace_Error, "ERROR CalcInteractionStrengths IsMultiplyError(sizeof(*avgInteractionStrengthsOut), cTerms)");
+      return Error_IllegalParamVal;
+   }
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      avgInteractionStrengthsOut[iTerm] = k_illegalGainDouble;
+   }
+
+   // CalcInteractionStrengthTerm checks countDimensions itself, but we need it to step through featureIndexes
+   if(countDimensions < IntEbm{0} || IntEbm{k_cDimensionsMax} < countDimensions) {
+      LOG_0(Trace_Error, "ERROR CalcInteractionStrengths countDimensions is outside the legal range");
+      return Error_IllegalParamVal;
+   }
+   const size_t cDimensions = static_cast<size_t>(countDimensions);
+   if(size_t{0} != cDimensions) {
+      if(nullptr == featureIndexes) {
+         LOG_0(Trace_Error, "ERROR CalcInteractionStrengths featureIndexes cannot be nullptr if 0 < countDimensions");
+         return Error_IllegalParamVal;
+      }
+      if(IsMultiplyError(sizeof(*featureIndexes), cDimensions, cTerms)) {
+         LOG_0(Trace_Error,
+               "ERROR CalcInteractionStrengths IsMultiplyError(sizeof(*featureIndexes), cDimensions, cTerms)");
+         return Error_IllegalParamVal;
+      }
+   }
+
+   if(flags &
+         ~(CalcInteractionFlags_DisableNewton | CalcInteractionFlags_Purify | CalcInteractionFlags_SparseBins)) {
+      LOG_0(Trace_Error, "ERROR CalcInteractionStrengths flags contains unknown flags. Ignoring extras.");
+   }
+
+   InteractionParams params;
+   NormalizeInteractionParams(
+         maxCardinality, minSamplesLeaf, minHessian, regAlpha, regLambda, maxDeltaStep, &params);
+
+   // visit the terms sorted by their features so that terms sharing features are binned close together in time and
+   // the bit packed data of those features is more likely to still be in the cache
+   size_t* const aiTerms = static_cast<size_t*>(malloc(sizeof(size_t) * cTerms));
+   if(nullptr == aiTerms) {
+      LOG_0(Trace_Warning, "WARNING CalcInteractionStrengths nullptr == aiTerms");
+      return Error_OutOfMemory;
+   }
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      aiTerms[iTerm] = iTerm;
+   }
+   std::sort(aiTerms, aiTerms + cTerms, [featureIndexes, cDimensions](const size_t iLeft, const size_t iRight) {
+      const IntEbm* const pLeft = featureIndexes + iLeft * cDimensions;
+      const IntEbm* const pRight = featureIndexes + iRight * cDimensions;
+      return std::lexicographical_compare(pLeft, pLeft + cDimensions, pRight, pRight + cDimensions);
+   });
+
+   const CancelToken cancelToken;
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cTerms, &pThreadPool);
+   if(Error_None != error) {
+      free(aiTerms);
+      return error;
+   }
+
+   // each thread bins into its own buffers, which the shell keeps so that later calls do not need to reallocate them
+   InteractionBins* const aBins = pInteractionShell->GetBins(pThreadPool->GetCountThreads());
+   if(nullptr == aBins) {
+      // already logged
+      ThreadPool::Return(pThreadPool);
+      free(aiTerms);
+      return Error_OutOfMemory;
+   }
+
+   InteractionCore* const pInteractionCore = pInteractionShell->GetInteractionCore();
+   auto calcTerm = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      if(cancelToken.IsCancelled()) {
+         return Error_Cancelled;
+      }
+      const size_t iTerm = aiTerms[iTask];
+      return CalcInteractionStrengthTerm(pInteractionCore,
+            nullptr,
+            &aBins[iThread],
+            countDimensions,
+            size_t{0} == cDimensions ? nullptr : featureIndexes + iTerm * cDimensions,
+            flags,
+            &params,
+            k_illegalGainDouble,
+            &avgInteractionStrengthsOut[iTerm]);
+   };
+   error = pThreadPool->Run(cTerms, calcTerm);
+
+   ThreadPool::Return(pThreadPool);
+   free(aiTerms);
+
+   LOG_COUNTED_N(pInteractionShell->GetPointerCountLogExitMessages(),
+         Trace_Info,
+         Trace_Verbose,
+         "Exited CalcInteractionStrengths: "
+         "error=%" ErrorEbmPrintf,
+         error);
+
+   return error;
+}
+
+// the heap puts the weakest of the pairs kept so far first, so that it is the first to be replaced. Ties go to the
+// pair that comes first in the candidate order, which makes the result independent of the thread scheduling
+struct TopInteraction final {
+   TopInteraction() = default; // preserve our POD status
+   ~TopInteraction() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   double m_strength;
+   size_t m_iCandidate1;
+   size_t m_iCandidate2;
+};
+static_assert(std::is_standard_layout<TopInteraction>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<TopInteraction>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+struct CompareTopInteraction final {
+   INLINE_ALWAYS bool operator()(const TopInteraction& lhs, const TopInteraction& rhs) const noexcept {
+      // std::push_heap puts the greatest item first, so the stronger pair is the lesser one here
+      if(lhs.m_strength != rhs.m_strength) {
+         return rhs.m_strength < lhs.m_strength;
+      }
+      if(lhs.m_iCandidate1 != rhs.m_iCandidate1) {
+         return lhs.m_iCandidate1 < rhs.m_iCandidate1;
+      }
+      return lhs.m_iCandidate2 < rhs.m_iCandidate2;
+   }
+};
+
+static int g_cLogFindTopInteractions = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FindTopInteractions(InteractionHandle interactionHandle,
+      IntEbm countCandidates,
+      const IntEbm* candidateFeatureIndexes,
+      IntEbm countTop,
+      CalcInteractionFlags flags,
+      IntEbm maxCardinality,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      IntEbm* topFeatureIndexesOut,
+      double* topInteractionStrengthsOut) {
+   LOG_COUNTED_N(&g_cLogFindTopInteractions,
+         Trace_Info,
+         Trace_Verbose,
+         "FindTopInteractions: "
+         "interactionHandle=%p, "
+         "countCandidates=%" IntEbmPrintf ", "
+         "candidateFeatureIndexes=%p, "
+         "countTop=%" IntEbmPrintf ", "
+         "flags=0x%" UCalcInteractionFlagsPrintf ", "
+         "maxCardinality=%" IntEbmPrintf ", "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "topFeatureIndexesOut=%p, "
+         "topInteractionStrengthsOut=%p",
+         static_cast<void*>(interactionHandle),
+         countCandidates,
+         static_cast<const void*>(candidateFeatureIndexes),
+         countTop,
+         static_cast<UCalcInteractionFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         maxCardinality,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<void*>(topFeatureIndexesOut),
+         static_cast<void*>(topInteractionStrengthsOut));
+
+   InteractionShell* const pInteractionShell = InteractionShell::GetInteractionShellFromHandle(interactionHandle);
+   if(nullptr == pInteractionShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(countCandidates < IntEbm{0} || IsConvertError<size_t>(countCandidates)) {
+      LOG_0(Trace_Error, "ERROR FindTopInteractions countCandidates must be a non-negative size_t");
+      return Error_IllegalParamVal;
+   }
+   const size_t cCandidates = static_cast<size_t>(countCandidates);
+   if(size_t{0} != cCandidates && nullptr == candidateFeatureIndexes) {
+      LOG_0(Trace_Error, "ERROR FindTopInteractions candidateFeatureIndexes cannot be nullptr if 0 < countCandidates");
+      return Error_IllegalParamVal;
+   }
+
+   if(countTop < IntEbm{0} || IsConvertError<size_t>(countTop)) {
+      LOG_0(Trace_Error, "ERROR FindTopInteractions countTop must be a non-negative size_t");
+      return Error_IllegalParamVal;
+   }
+   size_t cTop = static_cast<size_t>(countTop);
+
+   size_t cPairs = 0;
+   if(size_t{2} <= cCandidates) {
+      if(IsMultiplyError(cCandidates, cCandidates - size_t{1})) {
+         LOG_0(Trace_Error, "ERROR FindTopInteractions IsMultiplyError(cCandidates, cCandidates - 1)");
+         return Error_IllegalParamVal;
+      }
+      cPairs = cCandidates * (cCandidates - size_t{1}) / size_t{2};
+   }
+   cTop = EbmMin(cTop, cPairs);
+   if(size_t{0} == cTop) {
+      LOG_0(Trace_Info, "INFO FindTopInteractions no pairs to find");
+      return Error_None;
+   }
+
+   if(nullptr == topFeatureIndexesOut) {
+      LOG_0(Trace_Error, "ERROR FindTopInteractions topFeatureIndexesOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+   if(IsMultiplyError(sizeof(*topFeatureIndexesOut), cTop, size_t{2})) {
+      LOG_0(Trace_Error, "ERROR FindTopInteractions IsMultiplyError(sizeof(*topFeatureIndexesOut), cTop, 2)");
+      return Error_IllegalParamVal;
+   }
+   if(IsMultiplyError(sizeof(TopInteraction), cTop)) {
+      LOG_0(Trace_Warning, "WARNING FindTopInteractions IsMultiplyError(sizeof(TopInteraction), cTop)");
+      return Error_OutOfMemory;
+   }
+
+   if(flags &
+         ~(CalcInteractionFlags_DisableNewton | CalcInteractionFlags_Purify | CalcInteractionFlags_SparseBins)) {
+      LOG_0(Trace_Error, "ERROR FindTopInteractions flags contains unknown flags. Ignoring extras.");
+   }
+
+   InteractionParams params;
+   NormalizeInteractionParams(
+         maxCardinality, minSamplesLeaf, minHessian, regAlpha, regLambda, maxDeltaStep, &params);
+
+   TopInteraction* const aHeap = static_cast<TopInteraction*>(malloc(sizeof(TopInteraction) * cTop));
+   if(nullptr == aHeap) {
+      LOG_0(Trace_Warning, "WARNING FindTopInteractions nullptr == aHeap");
+      return Error_OutOfMemory;
+   }
+   size_t cHeap = 0;
+   std::mutex mutexHeap;
+
+   const CancelToken cancelToken;
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cCandidates - 1, &pThreadPool);
+   if(Error_None != error) {
+      free(aHeap);
+      return error;
+   }
+
+   InteractionBins* const aBins = pInteractionShell->GetBins(pThreadPool->GetCountThreads());
+   if(nullptr == aBins) {
+      // already logged
+      ThreadPool::Return(pThreadPool);
+      free(aHeap);
+      return Error_OutOfMemory;
+   }
+
+   // each task pairs one candidate with all the candidates after it. Once the heap is full, a pair can only get in
+   // by beating the weakest pair in it, so that strength is where CalcInteractionStrengthTerm can stop early
+   InteractionCore* const pInteractionCore = pInteractionShell->GetInteractionCore();
+   auto findCandidate = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      const size_t iCandidate1 = iTask;
+      for(size_t iCandidate2 = iCandidate1 + size_t{1}; iCandidate2 < cCandidates; ++iCandidate2) {
+         // the early candidates pair with nearly all the others, so one task can be long enough to need its own check
+         if(cancelToken.IsCancelled()) {
+            return Error_Cancelled;
+         }
+         double strengthPrune = k_illegalGainDouble;
+         {
+            std::lock_guard<std::mutex> lock(mutexHeap);
+            if(cTop == cHeap) {
+               strengthPrune = aHeap[0].m_strength;
+            }
+         }
+
+         const IntEbm aFeatureIndexes[2] = {
+               candidateFeatureIndexes[iCandidate1], candidateFeatureIndexes[iCandidate2]};
+         TopInteraction top;
+         top.m_iCandidate1 = iCandidate1;
+         top.m_iCandidate2 = iCandidate2;
+         const ErrorEbm errorPair = CalcInteractionStrengthTerm(pInteractionCore,
+               nullptr,
+               &aBins[iThread],
+               IntEbm{2},
+               aFeatureIndexes,
+               flags,
+               &params,
+               strengthPrune,
+               &top.m_strength);
+         if(Error_None != errorPair) {
+            return errorPair;
+         }
+
+         std::lock_guard<std::mutex> lock(mutexHeap);
+         if(cHeap < cTop) {
+            aHeap[cHeap] = top;
+            ++cHeap;
+            std::push_heap(aHeap, aHeap + cHeap, CompareTopInteraction());
+         } else if(CompareTopInteraction()(top, aHeap[0])) {
+            std::pop_heap(aHeap, aHeap + cHeap, CompareTopInteraction());
+            aHeap[cHeap - size_t{1}] = top;
+            std::push_heap(aHeap, aHeap + cHeap, CompareTopInteraction());
+         }
+      }
+      return Error_None;
+   };
+   error = pThreadPool->Run(cCandidates - size_t{1}, findCandidate);
+
+   ThreadPool::Return(pThreadPool);
+
+   if(Error_None == error) {
+      EBM_ASSERT(cTop == cHeap);
+      // sort_heap leaves the items in ascending order of the comparison, which is strongest first
+      std::sort_heap(aHeap, aHeap + cHeap, CompareTopInteraction());
+      for(size_t iTop = 0; iTop < cTop; ++iTop) {
+         topFeatureIndexesOut[iTop * size_t{2}] = candidateFeatureIndexes[aHeap[iTop].m_iCandidate1];
+         topFeatureIndexesOut[iTop * size_t{2} + size_t{1}] = candidateFeatureIndexes[aHeap[iTop].m_iCandidate2];
+         if(nullptr != topInteractionStrengthsOut) {
+            topInteractionStrengthsOut[iTop] = aHeap[iTop].m_strength;
+         }
+      }
+   }
+
+   free(aHeap);
+
+   LOG_COUNTED_N(pInteractionShell->GetPointerCountLogExitMessages(),
+         Trace_Info,
+         Trace_Verbose,
+         "Exited FindTopInteractions: "
+         "error=%" ErrorEbmPrintf,
+         error);
+
+   return error;
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,38 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef CANCEL_TOKEN_HPP
+#define CANCEL_TOKEN_HPP
+
+#include <stdint.h> // uint64_t
+#include <atomic>
+
+#include "unzoned.h" // INLINE_ALWAYS
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// CancelRunningCalls increments this. It only ever moves forward, so a call can tell that it was cancelled by
+// comparing it with the value it saw when it started, and calls that start afterwards see the new value
+extern std::atomic<uint64_t> g_cancelGeneration;
+
+// a long running call makes one of these when it starts and polls it at its round, term, or task boundaries. It is
+// cheap to copy, so a call that fans out over a ThreadPool hands the same token to every task
+class CancelToken final {
+   uint64_t m_generation;
+
+ public:
+   INLINE_ALWAYS CancelToken() noexcept : m_generation(g_cancelGeneration.load()) {}
+
+   // polled often, so relaxed is enough. A cancel that has not become visible yet is picked up at the next poll
+   INLINE_ALWAYS bool IsCancelled() const noexcept {
+      return m_generation != g_cancelGeneration.load(std::memory_order_relaxed);
+   }
+};
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // CANCEL_TOKEN_HPP
@@ -21,6 +21,17 @@ namespace DEFINED_ZONE_NAME {
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
+template<typename TSrc, typename TDest>
+INLINE_ALWAYS static void AddConvertFlat(const size_t cItems, const void* const aSrc, void* const aAddDest) {
+   // the GradientPair arrays of both bins are tightly packed runs of floats in the same order, so the whole class
+   // loop is a single contiguous add that the compiler can vectorize
+   const TSrc* const pSrc = reinterpret_cast<const TSrc*>(aSrc);
+   TDest* const pAddDest = reinterpret_cast<TDest*>(aAddDest);
+   for(size_t i = 0; i < cItems; ++i) {
+      pAddDest[i] += static_cast<TDest>(pSrc[i]);
+   }
+}
+
 extern void ConvertAddBin(const size_t cScores,
       const bool bHessian,
       const size_t cBins,
@@ -469,6 +480,19 @@ extern void ConvertAddBin(const size_t cScores,
    const UIntMain* pCounts = aCounts;
    const FloatPrecomp* pWeights = aWeights;
 
+   // GradientPair holds only the gradient and the optional hessian, so unless the compiler inserted padding the
+   // per-class arrays are flat arrays of floats that we can add without walking the pairs one at a time
+   const size_t cItemsPerScore = bHessian ? size_t{2} : size_t{1};
+   const size_t cSrcFloatBytes = bDoubleSrc ? sizeof(double) : sizeof(float);
+   const size_t cDestFloatBytes = bDoubleDest ? sizeof(double) : sizeof(float);
+   const bool bFlat = ptrdiff_t{0} == iSrcGradient && ptrdiff_t{0} == iDestGradient &&
+         cSrcFloatBytes * cItemsPerScore == cSrcArrayItemBytes &&
+         cDestFloatBytes * cItemsPerScore == cDestArrayItemBytes &&
+         (!bHessian ||
+               (static_cast<ptrdiff_t>(cSrcFloatBytes) == iSrcHessian &&
+                     static_cast<ptrdiff_t>(cDestFloatBytes) == iDestHessian));
+   const size_t cFlatItems = cItemsPerScore * cScores;
+
    const unsigned char* pSrc = reinterpret_cast<const unsigned char*>(aSrc);
    const unsigned char* const pSrcEnd = pSrc + cSrcBinBytes * cBins;
    unsigned char* pAddDest = reinterpret_cast<unsigned char*>(aAddDest);
@@ -544,6 +568,25 @@ extern void ConvertAddBin(const size_t cScores,
          }
       }
 
+      if(bFlat) {
+         if(bDoubleSrc) {
+            if(bDoubleDest) {
+               AddConvertFlat<double, double>(cFlatItems, pSrc + iSrcArray, pAddDest + iDestArray);
+            } else {
+               AddConvertFlat<double, float>(cFlatItems, pSrc + iSrcArray, pAddDest + iDestArray);
+            }
+         } else {
+            if(bDoubleDest) {
+               AddConvertFlat<float, double>(cFlatItems, pSrc + iSrcArray, pAddDest + iDestArray);
+            } else {
+               AddConvertFlat<float, float>(cFlatItems, pSrc + iSrcArray, pAddDest + iDestArray);
+            }
+         }
+         pSrc += cSrcBinBytes;
+         pAddDest += cDestBinBytes;
+         continue;
+      }
+
       const unsigned char* pSrcArray = pSrc + iSrcArray;
       const unsigned char* pSrcArrayEnd = pSrcArray + cSrcArrayTotalBytes;
       unsigned char* pDestArray = pAddDest + iDestArray;
@@ -6,11 +6,8 @@
 
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // std::numeric_limits
-#include <algorithm> // std::sort
+#include <algorithm> // std::sort, std::make_heap
 #include <cmath> // std::round
-#include <vector> // std::vector (used in std::priority_queue)
-#include <queue> // std::priority_queue
-#include <set> // std::set
 #include <string.h> // strchr, memmove
 
 #include "libebm.h" // EBM_API_BODY
@@ -23,6 +20,7 @@
 #include "common.hpp" // IsConvertError
 
 #include "RandomDeterministic.hpp"
+#include "ThreadPool.hpp"
 
 // TODO: check this file for how we handle subnormal numbers.  NEVER RETURN SUBNORMALS!
 
@@ -114,6 +112,9 @@ struct CutPoint final {
    // comparing two Cuts that have the same distance to their endpoints
    size_t m_uniqueTiebreaker;
 
+   // our position within the CutPointHeap while we are in it
+   size_t m_iHeap;
+
    INLINE_ALWAYS void SetCut() noexcept { m_cPredeterminedMovementOnCut = k_movementDoneCut; }
    INLINE_ALWAYS bool IsCut() const noexcept { return k_movementDoneCut == m_cPredeterminedMovementOnCut; }
 };
@@ -196,6 +197,117 @@ class CompareCutPoint final {
    }
 };
 
+// std::make_heap and friends put the greatest item first, but we want the item that CompareCuttingRange puts first
+class CompareCuttingRangeHeap final {
+ public:
+   INLINE_ALWAYS bool operator()(const CuttingRange* const& lhs, const CuttingRange* const& rhs) const noexcept {
+      return CompareCuttingRange()(rhs, lhs);
+   }
+};
+
+// An indexed binary heap of CutPoints whose top is the CutPoint that CompareCutPoint would order first.  The
+// pointer array is allocated once for the entire CutQuantile call, and each CutPoint remembers its own position so
+// that we can remove or re-prioritize any CutPoint without searching for it.  CompareCutPoint is a strict total
+// order because m_uniqueTiebreaker is unique, so the order that CutPoints come off the heap is fully determined.
+class CutPointHeap final {
+   CutPoint** m_apCuts;
+   size_t m_cCuts;
+
+   INLINE_ALWAYS void Place(CutPoint* const pCut, const size_t iHeap) noexcept {
+      m_apCuts[iHeap] = pCut;
+      pCut->m_iHeap = iHeap;
+   }
+
+   void SiftUp(CutPoint* const pCut, size_t iHeap) noexcept {
+      while(size_t{0} != iHeap) {
+         const size_t iParent = (iHeap - size_t{1}) >> 1;
+         CutPoint* const pParent = m_apCuts[iParent];
+         if(!CompareCutPoint()(pCut, pParent)) {
+            break;
+         }
+         Place(pParent, iHeap);
+         iHeap = iParent;
+      }
+      Place(pCut, iHeap);
+   }
+
+   void SiftDown(CutPoint* const pCut, size_t iHeap) noexcept {
+      while(true) {
+         size_t iChild = (iHeap << 1) + size_t{1};
+         if(m_cCuts <= iChild) {
+            break;
+         }
+         if(iChild + size_t{1} < m_cCuts && CompareCutPoint()(m_apCuts[iChild + size_t{1}], m_apCuts[iChild])) {
+            ++iChild;
+         }
+         CutPoint* const pChild = m_apCuts[iChild];
+         if(!CompareCutPoint()(pChild, pCut)) {
+            break;
+         }
+         Place(pChild, iHeap);
+         iHeap = iChild;
+      }
+      Place(pCut, iHeap);
+   }
+
+ public:
+   CutPointHeap() = default; // preserve our POD status
+   ~CutPointHeap() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   INLINE_ALWAYS void Initialize(CutPoint** const apCuts) noexcept {
+      m_apCuts = apCuts;
+      m_cCuts = 0;
+   }
+
+   INLINE_ALWAYS bool IsEmpty() const noexcept { return size_t{0} == m_cCuts; }
+
+   INLINE_ALWAYS CutPoint* GetTop() const noexcept {
+      EBM_ASSERT(!IsEmpty());
+      return m_apCuts[0];
+   }
+
+   INLINE_ALWAYS bool IsContained(const CutPoint* const pCut) const noexcept {
+      return pCut->m_iHeap < m_cCuts && pCut == m_apCuts[pCut->m_iHeap];
+   }
+
+   INLINE_ALWAYS void Insert(CutPoint* const pCut) noexcept {
+      ++m_cCuts;
+      SiftUp(pCut, m_cCuts - size_t{1});
+   }
+
+   void Remove(CutPoint* const pCut) noexcept {
+      EBM_ASSERT(IsContained(pCut));
+      const size_t iHeap = pCut->m_iHeap;
+      --m_cCuts;
+      if(iHeap != m_cCuts) {
+         // move the last item into the hole and let it find its level, which can be in either direction
+         CutPoint* const pLast = m_apCuts[m_cCuts];
+         if(size_t{0} != iHeap && CompareCutPoint()(pLast, m_apCuts[(iHeap - size_t{1}) >> 1])) {
+            SiftUp(pLast, iHeap);
+         } else {
+            SiftDown(pLast, iHeap);
+         }
+      }
+   }
+
+   // call this after changing the m_priority of a CutPoint that is in the heap
+   void Update(CutPoint* const pCut) noexcept {
+      EBM_ASSERT(IsContained(pCut));
+      const size_t iHeap = pCut->m_iHeap;
+      if(size_t{0} != iHeap && CompareCutPoint()(pCut, m_apCuts[(iHeap - size_t{1}) >> 1])) {
+         SiftUp(pCut, iHeap);
+      } else {
+         SiftDown(pCut, iHeap);
+      }
+   }
+};
+static_assert(std::is_standard_layout<CutPointHeap>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<CutPointHeap>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
 INLINE_RELEASE_UNTEMPLATED static size_t CalculateRangesMaximizeMin(const double sideDistance,
       const double totalDistance,
       const size_t cRanges,
@@ -791,7 +903,7 @@ static void BuildNeighbourhoodPlan(const size_t cSamples,
    EBM_ASSERT(!pCutCur->IsCut());
 }
 
-static ErrorEbm CutCuttingRange(std::set<CutPoint*, CompareCutPoint>* const pBestCuts,
+static ErrorEbm CutCuttingRange(CutPointHeap* const pBestCuts,
 
       const size_t cSamples,
       const bool bSymmetryReversal,
@@ -812,11 +924,8 @@ static ErrorEbm CutCuttingRange(std::set<CutPoint*, CompareCutPoint>* const pBes
    EBM_ASSERT(cCuttableItems <= cSamples);
    EBM_ASSERT(nullptr != aNeighbourJumps);
 
-   // TODO: someday, for performance, it might make sense to use a non-allocating tree, like:
-   //       https://github.com/attractivechaos/klib/blob/master/kavl.h
-
    try {
-      while(!pBestCuts->empty()) {
+      while(!pBestCuts->IsEmpty()) {
          // We've located our desired cut points previously.  Sometimes those desired cut points
          // are placed in the bulk of a long run of identical values and we have to decide if we'll be putting
          // the cut at the start or the end of those long runs of identical values.
@@ -908,7 +1017,7 @@ static ErrorEbm CutCuttingRange(std::set<CutPoint*, CompareCutPoint>* const pBes
          //       the N item window at any point (but won't change them)
 
          // all fields of our pCutBest should have been filled with initialized data previously
-         CutPoint* const pCutBest = *pBestCuts->begin();
+         CutPoint* const pCutBest = pBestCuts->GetTop();
 
 #ifdef LOG_SUPERVERBOSE_DISCRETIZATION_ORDERED
          LOG_N(Trace_Verbose,
@@ -1305,8 +1414,7 @@ static ErrorEbm CutCuttingRange(std::set<CutPoint*, CompareCutPoint>* const pBes
          // visibility window.  Perhaps we allow changes to ASPIRATIONAL cuts within our hard change boundary, but don't
          // change things outside of this window.
 
-         EBM_ASSERT(pBestCuts->end() != pBestCuts->find(pCutCur));
-         pBestCuts->erase(pCutCur);
+         pBestCuts->Remove(pCutCur);
 
          // Ok, so now we've computed our aspirational cut points, and decided where we'd go for each cut point if we
          // were forced to select a cut point now.  We now need to calculate the PRIORITY for all our cut points
@@ -1411,15 +1519,12 @@ static ErrorEbm CutCuttingRange(std::set<CutPoint*, CompareCutPoint>* const pBes
                ++cRangesLowHighPriority;
             }
 
-            EBM_ASSERT(pBestCuts->end() != pBestCuts->find(pCutLowPriorityCur));
-            pBestCuts->erase(pCutLowPriorityCur);
-
             pCutLowPriorityCur->m_priority =
                   CalculatePriority(pCutLowLowPriorityInclusiveBoundary->m_iValAspirationalFloat,
                         pCutLowHighPriorityInclusiveBoundary->m_iValAspirationalFloat,
                         pCutLowPriorityCur);
 
-            pBestCuts->insert(pCutLowPriorityCur);
+            pBestCuts->Update(pCutLowPriorityCur);
          }
 
          CutPoint* pCutHighHighPriorityInclusiveBoundary = pCutHighHighVisibilityInclusiveBoundary;
@@ -1467,15 +1572,12 @@ static ErrorEbm CutCuttingRange(std::set<CutPoint*, CompareCutPoint>* const pBes
                ++cRangesHighLowPriority;
             }
 
-            EBM_ASSERT(pBestCuts->end() != pBestCuts->find(pCutHighPriorityCur));
-            pBestCuts->erase(pCutHighPriorityCur);
-
             pCutHighPriorityCur->m_priority =
                   CalculatePriority(pCutHighLowPriorityInclusiveBoundary->m_iValAspirationalFloat,
                         pCutHighHighPriorityInclusiveBoundary->m_iValAspirationalFloat,
                         pCutHighPriorityCur);
 
-            pBestCuts->insert(pCutHighPriorityCur);
+            pBestCuts->Update(pCutHighPriorityCur);
          }
       }
    } catch(const std::bad_alloc&) {
@@ -1491,7 +1593,7 @@ static ErrorEbm CutCuttingRange(std::set<CutPoint*, CompareCutPoint>* const pBes
    return Error_None;
 }
 
-static ErrorEbm TreeSearchCutSegment(std::set<CutPoint*, CompareCutPoint>* pBestCuts,
+static ErrorEbm TreeSearchCutSegment(CutPointHeap* const pBestCuts,
 
       const size_t cSamples,
       const bool bSymmetryReversal,
@@ -1506,7 +1608,7 @@ static ErrorEbm TreeSearchCutSegment(std::set<CutPoint*, CompareCutPoint>* pBest
       CutPoint* const aCutsWithENDPOINTS) noexcept {
    try {
       EBM_ASSERT(nullptr != pBestCuts);
-      EBM_ASSERT(pBestCuts->empty());
+      EBM_ASSERT(pBestCuts->IsEmpty());
 
       EBM_ASSERT(2 <= cSamples); // we need at least 2 to cut, otherwise we'd have exited before calling here
       EBM_ASSERT(1 <= cSamplesBinMin);
@@ -1648,7 +1750,7 @@ static ErrorEbm TreeSearchCutSegment(std::set<CutPoint*, CompareCutPoint>* pBest
                CalculatePriority(pCutLow->m_iValAspirationalFloat, pCutHigh->m_iValAspirationalFloat, pCutCenter);
 
          EBM_ASSERT(!pCutCenter->IsCut());
-         pBestCuts->insert(pCutCenter);
+         pBestCuts->Insert(pCutCenter);
 
          if(UNLIKELY(k_cutExploreDistance != cLowRanges)) {
             ++cLowRanges;
@@ -1674,7 +1776,7 @@ static ErrorEbm TreeSearchCutSegment(std::set<CutPoint*, CompareCutPoint>* pBest
          pBestCuts, cSamples, bSymmetryReversal, cSamplesBinMin, iValStart, cCuttableItems, aNeighbourJumps);
 }
 
-INLINE_RELEASE_UNTEMPLATED static ErrorEbm TradeCutSegment(std::set<CutPoint*, CompareCutPoint>* const pBestCuts,
+INLINE_RELEASE_UNTEMPLATED static ErrorEbm TradeCutSegment(CutPointHeap* const pBestCuts,
 
       const size_t cSamples,
       const bool bSymmetryReversal,
@@ -1776,16 +1878,17 @@ INLINE_RELEASE_UNTEMPLATED static size_t DetermineRangesMax(
    return cRanges;
 }
 
-static bool AddCutToRanges(std::set<CuttingRange*, CompareCuttingRange>& queue) {
-   EBM_ASSERT(!queue.empty());
+static bool AddCutToRanges(const size_t cCuttingRanges, CuttingRange** const apCuttingRangeHeap) {
+   EBM_ASSERT(1 <= cCuttingRanges);
+   EBM_ASSERT(nullptr != apCuttingRangeHeap);
 
-   auto iterator = queue.begin();
-   CuttingRange* const pCuttingRangeAdd = *iterator;
+   CuttingRange* const pCuttingRangeAdd = apCuttingRangeHeap[0];
    if(k_illegalAvgCuttableRangeWidthAfterAddingOneCut == pCuttingRangeAdd->m_avgCuttableRangeWidthAfterAddingOneCut) {
       // nothing remaining in the queue can accept new cuts
       return true;
    }
-   queue.erase(iterator);
+   // every CuttingRange stays in the queue, so move the top to the end, change it, and then push it back in
+   std::pop_heap(apCuttingRangeHeap, apCuttingRangeHeap + cCuttingRanges, CompareCuttingRangeHeap());
 
    // this is how many ranges we were assigned before deciding that this range would recieve a new cut
    const size_t cRangesPrev = pCuttingRangeAdd->m_cRangesAssigned;
@@ -1811,15 +1914,16 @@ static bool AddCutToRanges(std::set<CuttingRange*, CompareCuttingRange>& queue)
       // priorities, unlike for Cuts
    }
    pCuttingRangeAdd->m_avgCuttableRangeWidthAfterAddingOneCut = avgRangeWidthAfterAddingOneCut;
-   queue.insert(pCuttingRangeAdd);
+   std::push_heap(apCuttingRangeHeap, apCuttingRangeHeap + cCuttingRanges, CompareCuttingRangeHeap());
    return false;
 }
 
-static void StuffCutsIntoCuttingRanges(std::set<CuttingRange*, CompareCuttingRange>& queue,
+static void StuffCutsIntoCuttingRanges(CuttingRange** const apCuttingRangeHeap,
       const size_t cCuttingRanges,
       CuttingRange* const aCuttingRange,
       const size_t cSamplesBinMin,
       const size_t cCutsAssignable) {
+   EBM_ASSERT(nullptr != apCuttingRangeHeap);
    EBM_ASSERT(1 <= cCuttingRanges);
    EBM_ASSERT(nullptr != aCuttingRange);
    EBM_ASSERT(1 <= cSamplesBinMin);
@@ -1836,6 +1940,7 @@ static void StuffCutsIntoCuttingRanges(std::set<CuttingRange*, CompareCuttingRan
    // until there are no items in the heap because they've all exhausted the possibilities of cuts
    // OR until we run out of cuts to dole out.
 
+   CuttingRange** ppCuttingRangeHeap = apCuttingRangeHeap;
    CuttingRange* pCuttingRangeInit = aCuttingRange;
    const CuttingRange* const pCuttingRangeEnd = aCuttingRange + cCuttingRanges;
    do {
@@ -1885,10 +1990,12 @@ static void StuffCutsIntoCuttingRanges(std::set<CuttingRange*, CompareCuttingRan
       }
       pCuttingRangeInit->m_avgCuttableRangeWidthAfterAddingOneCut = avgRangeWidthAfterAddingOneCut;
       pCuttingRangeInit->m_cRangesMax = cRangesMax;
-      queue.insert(pCuttingRangeInit);
+      *ppCuttingRangeHeap = pCuttingRangeInit;
+      ++ppCuttingRangeHeap;
 
       ++pCuttingRangeInit;
    } while(LIKELY(pCuttingRangeEnd != pCuttingRangeInit));
+   std::make_heap(apCuttingRangeHeap, apCuttingRangeHeap + cCuttingRanges, CompareCuttingRangeHeap());
 
    size_t cRemainingCuts = cCutsAssignable;
    if(UNLIKELY(0 == aCuttingRange[0].m_cUncuttableLowVals)) {
@@ -1911,7 +2018,7 @@ static void StuffCutsIntoCuttingRanges(std::set<CuttingRange*, CompareCuttingRan
    cRemainingCuts -= cCuttingRanges;
    // the queue can initially be empty if all the ranges are too short to make them cSamplesBinMin
    while(LIKELY(0 != cRemainingCuts)) {
-      if(AddCutToRanges(queue)) {
+      if(AddCutToRanges(cCuttingRanges, apCuttingRangeHeap)) {
          break;
       }
       --cRemainingCuts;
@@ -2412,12 +2519,56 @@ INLINE_RELEASE_UNTEMPLATED static size_t GetUncuttableRangeLengthMin(
 static int g_cLogEnterCutQuantile = 25;
 static int g_cLogExitCutQuantile = 25;
 
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
+// CutQuantileBatch calls CutQuantileColumn once per column, so we hold onto the working memory between calls
+// and only reallocate it when a column needs more than the previous ones did
+struct CutQuantileScratch final {
+   void* m_aFeatureVals;
+   size_t m_cBytesFeatureVals;
+   void* m_pMem;
+   size_t m_cBytesMem;
+};
+static_assert(std::is_standard_layout<CutQuantileScratch>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<CutQuantileScratch>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+static_assert(
+      std::is_pod<CutQuantileScratch>::value, "We use a lot of C constructs, so disallow non-POD types in general");
+
+static void InitScratch(CutQuantileScratch* const pScratch) {
+   EBM_ASSERT(nullptr != pScratch);
+   pScratch->m_aFeatureVals = nullptr;
+   pScratch->m_cBytesFeatureVals = 0;
+   pScratch->m_pMem = nullptr;
+   pScratch->m_cBytesMem = 0;
+}
+
+static void* GrowScratch(void** const ppMem, size_t* const pcBytes, const size_t cBytes) {
+   EBM_ASSERT(nullptr != ppMem);
+   EBM_ASSERT(nullptr != pcBytes);
+   if(*pcBytes < cBytes) {
+      free(*ppMem);
+      *pcBytes = 0;
+      *ppMem = malloc(cBytes);
+      if(nullptr != *ppMem) {
+         *pcBytes = cBytes;
+      }
+   }
+   return *ppMem;
+}
+
+static void FreeScratch(CutQuantileScratch* const pScratch) {
+   EBM_ASSERT(nullptr != pScratch);
+   free(pScratch->m_aFeatureVals);
+   free(pScratch->m_pMem);
+}
+
+static ErrorEbm CutQuantileColumn(IntEbm countSamples,
       const double* featureVals,
       IntEbm minSamplesBin,
       BoolEbm isRounded,
       IntEbm* countCutsInOut,
-      double* cutsLowerBoundInclusiveOut) {
+      double* cutsLowerBoundInclusiveOut,
+      CutQuantileScratch* const pScratch) {
    // don't expose this random seed.  It's used to settle tiebreakers and will only make
    // marginal changes to where the cuts are placed.  Exposing it just means we need to
    // use the same value in every language that we support, and any preprocessors then need to
@@ -2485,7 +2636,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
             goto exit_with_log;
          }
          const size_t cBytesFeatureVals = sizeof(double) * cSamplesIncludingMissingVals;
-         double* const aFeatureVals = static_cast<double*>(malloc(cBytesFeatureVals));
+         double* const aFeatureVals = static_cast<double*>(
+               GrowScratch(&pScratch->m_aFeatureVals, &pScratch->m_cBytesFeatureVals, cBytesFeatureVals));
          if(UNLIKELY(nullptr == aFeatureVals)) {
             LOG_0(Trace_Error, "ERROR CutQuantile nullptr == aFeatureVals");
 
@@ -2504,7 +2656,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
          EBM_ASSERT(cSamples <= cSamplesIncludingMissingVals);
 
          if(UNLIKELY(cSamples <= size_t{1})) {
-            free(aFeatureVals);
             // we can't really cut 0 or 1 samples.  Now that we know our min, max, etc values, we can exit
             // or if there was only 1 non-missing value
             countCutsRet = IntEbm{0};
@@ -2516,7 +2667,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
          const IntEbm countCuts = *countCutsInOut;
 
          if(UNLIKELY(countCuts <= IntEbm{0})) {
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_None;
             if(UNLIKELY(countCuts < IntEbm{0})) {
@@ -2530,7 +2680,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
             // if we have a potential bin cut, then cutsLowerBoundInclusiveOut shouldn't be nullptr
             LOG_0(Trace_Error, "ERROR CutQuantile nullptr == cutsLowerBoundInclusiveOut");
 
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_IllegalParamVal;
 
@@ -2549,7 +2698,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
             // in order to make any cuts.  Anything less and we should just return now.
             // We also use this as a comparison to ensure that minSamplesBin is convertible to a size_t
 
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_None;
             goto exit_with_log;
@@ -2587,12 +2735,28 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
             LOG_0(Trace_Warning,
                   "WARNING CutQuantile IsMultiplyError(std::max(sizeof(*cutsLowerBoundInclusiveOut), sizeof(double "
                   "*)), cCutsMax)");
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_OutOfMemory;
             goto exit_with_log;
          }
 
+         // Everything below needs the full sorted order, since the cutting ranges and neighbour jumps are built from
+         // the runs of equal values.  A column with a single distinct value has no runs to separate though, and
+         // CountCuttingRanges would return zero for it, so detect that with a linear scan before paying for the sort.
+         {
+            const double valFirst = aFeatureVals[0];
+            const double* pScan = aFeatureVals + size_t{1};
+            const double* const pValsEnd = aFeatureVals + cSamples;
+            while(pValsEnd != pScan && valFirst == *pScan) {
+               ++pScan;
+            }
+            if(UNLIKELY(pValsEnd == pScan)) {
+               countCutsRet = IntEbm{0};
+               error = Error_None;
+               goto exit_with_log;
+            }
+         }
+
          std::sort(aFeatureVals, aFeatureVals + cSamples);
 
          EBM_ASSERT(cCutsMax < cSamples); // so we can add 1 to cCutsMax safely
@@ -2610,7 +2774,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
          // cSamples is a size_t
          EBM_ASSERT(cCuttingRanges <= cCutsMax + size_t{1});
          if(UNLIKELY(size_t{0} == cCuttingRanges)) {
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_None;
             goto exit_with_log;
@@ -2618,7 +2781,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
 
          if(UNLIKELY(IsMultiplyError(sizeof(NeighbourJump), cSamples))) {
             LOG_0(Trace_Warning, "WARNING CutQuantile IsMultiplyError(sizeof(NeighbourJump), cSamples)");
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_OutOfMemory;
             goto exit_with_log;
@@ -2638,7 +2800,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
          const size_t cCutsWithEndpointsMax = cCutsMax + size_t{2};
          if(UNLIKELY(IsMultiplyError(sizeof(CutPoint), cCutsWithEndpointsMax))) {
             LOG_0(Trace_Warning, "WARNING CutQuantile IsMultiplyError(sizeof(CutPoint), cCutsWithEndpointsMax)");
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_OutOfMemory;
             goto exit_with_log;
@@ -2647,19 +2808,23 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
 
          if(UNLIKELY(IsMultiplyError(sizeof(CuttingRange), cCuttingRanges))) {
             LOG_0(Trace_Warning, "WARNING CutQuantile IsMultiplyError(sizeof(CuttingRange), cCuttingRanges)");
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_OutOfMemory;
             goto exit_with_log;
          }
          const size_t cBytesCuttingRanges = sizeof(CuttingRange) * cCuttingRanges;
 
+         // we checked above that CuttingRange, which is larger than a pointer, does not overflow
+         const size_t cBytesCuttingRangePointers = sizeof(CuttingRange*) * cCuttingRanges;
+
+         // we checked above that CutPoint, which is larger than a pointer, does not overflow
+         const size_t cBytesCutPointers = sizeof(CutPoint*) * cCutsWithEndpointsMax;
+
          const size_t cBytesToNeighbourJump = size_t{0};
          const size_t cBytesToValCutPointers = cBytesToNeighbourJump + cBytesNeighbourJumps;
 
          if(UNLIKELY(IsAddError(cBytesToValCutPointers, cBytesValCutPointers))) {
             LOG_0(Trace_Warning, "WARNING CutQuantile IsAddError(cBytesToValCutPointers, cBytesValCutPointers))");
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_OutOfMemory;
             goto exit_with_log;
@@ -2668,7 +2833,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
 
          if(UNLIKELY(IsAddError(cBytesToCuts, cBytesCuts))) {
             LOG_0(Trace_Warning, "WARNING CutQuantile IsAddError(cBytesToCuts, cBytesCuts))");
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_OutOfMemory;
             goto exit_with_log;
@@ -2677,17 +2841,32 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
 
          if(UNLIKELY(IsAddError(cBytesToCuttingRange, cBytesCuttingRanges))) {
             LOG_0(Trace_Warning, "WARNING CutQuantile IsAddError(cBytesToCuttingRange, cBytesCuttingRanges))");
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_OutOfMemory;
             goto exit_with_log;
          }
-         const size_t cBytesToEnd = cBytesToCuttingRange + cBytesCuttingRanges;
+         const size_t cBytesToCuttingRangePointers = cBytesToCuttingRange + cBytesCuttingRanges;
 
-         char* const pMem = static_cast<char*>(malloc(cBytesToEnd));
+         if(UNLIKELY(IsAddError(cBytesToCuttingRangePointers, cBytesCuttingRangePointers))) {
+            LOG_0(Trace_Warning,
+                  "WARNING CutQuantile IsAddError(cBytesToCuttingRangePointers, cBytesCuttingRangePointers))");
+            countCutsRet = IntEbm{0};
+            error = Error_OutOfMemory;
+            goto exit_with_log;
+         }
+         const size_t cBytesToCutPointers = cBytesToCuttingRangePointers + cBytesCuttingRangePointers;
+
+         if(UNLIKELY(IsAddError(cBytesToCutPointers, cBytesCutPointers))) {
+            LOG_0(Trace_Warning, "WARNING CutQuantile IsAddError(cBytesToCutPointers, cBytesCutPointers))");
+            countCutsRet = IntEbm{0};
+            error = Error_OutOfMemory;
+            goto exit_with_log;
+         }
+         const size_t cBytesToEnd = cBytesToCutPointers + cBytesCutPointers;
+
+         char* const pMem = static_cast<char*>(GrowScratch(&pScratch->m_pMem, &pScratch->m_cBytesMem, cBytesToEnd));
          if(UNLIKELY(nullptr == pMem)) {
             LOG_0(Trace_Warning, "WARNING CutQuantile nullptr == pMem");
-            free(aFeatureVals);
             countCutsRet = IntEbm{0};
             error = Error_OutOfMemory;
             goto exit_with_log;
@@ -2697,6 +2876,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
          const double** const apValCutTops = reinterpret_cast<const double**>(pMem + cBytesToValCutPointers);
          CutPoint* const aCuts = reinterpret_cast<CutPoint*>(pMem + cBytesToCuts);
          CuttingRange* const aCuttingRange = reinterpret_cast<CuttingRange*>(pMem + cBytesToCuttingRange);
+         CuttingRange** const apCuttingRanges =
+               reinterpret_cast<CuttingRange**>(pMem + cBytesToCuttingRangePointers);
+         CutPoint** const apCutsHeap = reinterpret_cast<CutPoint**>(pMem + cBytesToCutPointers);
 
          ConstructJumps(cSamples, aFeatureVals, aNeighbourJumps);
 
@@ -2715,16 +2897,18 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
 
          const double** ppValCutTop = apValCutTops;
          try {
-            std::set<CuttingRange*, CompareCuttingRange> priorityQueue;
-            StuffCutsIntoCuttingRanges(priorityQueue, cCuttingRanges, aCuttingRange, cSamplesBinMin, cCutsMax);
+            StuffCutsIntoCuttingRanges(apCuttingRanges, cCuttingRanges, aCuttingRange, cSamplesBinMin, cCutsMax);
+
+            // nothing is added to the queue from here on, so we only need to visit the CuttingRanges in order once
+            std::sort(apCuttingRanges, apCuttingRanges + cCuttingRanges, CompareCuttingRange());
+            size_t iCuttingRange = cCuttingRanges;
             do {
-               EBM_ASSERT(!priorityQueue.empty());
+               EBM_ASSERT(size_t{0} != iCuttingRange);
                // remove the item that is the worst CuttingRange for us to add a new cut to.  We'll keep
                // the cutting ranges that are closest to the threshold for adding new cuts in the queue so that
                // if we can't use all our cuts, we can move the cuts to the next best choice
-               auto iterator = prev(priorityQueue.end());
-               CuttingRange* const pCuttingRange = *iterator;
-               priorityQueue.erase(iterator);
+               --iCuttingRange;
+               CuttingRange* const pCuttingRange = apCuttingRanges[iCuttingRange];
 
                const size_t cRanges = pCuttingRange->m_cRangesAssigned;
 
@@ -2744,7 +2928,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
                if(PREDICTABLE(size_t{1} < cRanges)) {
                   // we have cuts on our ends, either explicit or implicit at the tail ends that don't have uncuttable
                   // ranges on the tails, and at least one cut in our center, so we have to make decisions
-                  std::set<CutPoint*, CompareCutPoint> bestCuts;
+                  CutPointHeap bestCuts;
+                  bestCuts.Initialize(apCutsHeap);
 
 #ifdef NEVER
                   // TODO : in the future fill this priority queue with the average length within our
@@ -2791,9 +2976,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
                   if(Error_None != error) {
                      // any error messages should have been written to the log inside TradeCutSegment
 
-                     free(pMem);
-                     free(aFeatureVals);
-
                      countCutsRet = IntEbm{0};
                      goto exit_with_log;
                   }
@@ -2940,22 +3122,16 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
                      ++ppValCutTop;
                   }
                }
-            } while(!priorityQueue.empty());
+            } while(size_t{0} != iCuttingRange);
          } catch(const std::bad_alloc&) {
             LOG_0(Trace_Warning, "WARNING CutQuantile out of memory");
 
-            free(pMem);
-            free(aFeatureVals);
-
             countCutsRet = IntEbm{0};
             error = Error_OutOfMemory;
             goto exit_with_log;
          } catch(...) {
             LOG_0(Trace_Warning, "WARNING CutQuantile exception");
 
-            free(pMem);
-            free(aFeatureVals);
-
             countCutsRet = IntEbm{0};
             error = Error_UnexpectedInternal;
             goto exit_with_log;
@@ -3169,9 +3345,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
          countCutsRet = static_cast<IntEbm>(cCutsRet);
          EBM_ASSERT(countCutsRet <= countCuts);
 
-         free(pMem);
-         free(aFeatureVals);
-
          error = Error_None;
       }
 
@@ -3193,4 +3366,155 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
    return error;
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
+      const double* featureVals,
+      IntEbm minSamplesBin,
+      BoolEbm isRounded,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut) {
+   CutQuantileScratch scratch;
+   InitScratch(&scratch);
+   const ErrorEbm error = CutQuantileColumn(
+         countSamples, featureVals, minSamplesBin, isRounded, countCutsInOut, cutsLowerBoundInclusiveOut, &scratch);
+   FreeScratch(&scratch);
+   return error;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantileBatch(IntEbm countSamples,
+      IntEbm countColumns,
+      const double* featureVals,
+      const IntEbm* minSamplesBin,
+      BoolEbm isRounded,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut) {
+   LOG_N(Trace_Info,
+         "Entered CutQuantileBatch: "
+         "countSamples=%" IntEbmPrintf ", "
+         "countColumns=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "minSamplesBin=%p, "
+         "isRounded=%s, "
+         "countCutsInOut=%p, "
+         "cutsLowerBoundInclusiveOut=%p",
+         countSamples,
+         countColumns,
+         static_cast<const void*>(featureVals),
+         static_cast<const void*>(minSamplesBin),
+         ObtainTruth(isRounded),
+         static_cast<void*>(countCutsInOut),
+         static_cast<void*>(cutsLowerBoundInclusiveOut));
+
+   if(UNLIKELY(countColumns <= IntEbm{0})) {
+      if(UNLIKELY(countColumns < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR CutQuantileBatch countColumns < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countColumns))) {
+      LOG_0(Trace_Error, "ERROR CutQuantileBatch IsConvertError<size_t>(countColumns)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cColumns = static_cast<size_t>(countColumns);
+
+   if(UNLIKELY(countSamples < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR CutQuantileBatch countSamples < IntEbm { 0 }");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
+      LOG_0(Trace_Error, "ERROR CutQuantileBatch IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   if(UNLIKELY(IsMultiplyError(sizeof(double), cSamples, cColumns))) {
+      LOG_0(Trace_Error, "ERROR CutQuantileBatch IsMultiplyError(sizeof(double), cSamples, cColumns)");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(nullptr == minSamplesBin)) {
+      LOG_0(Trace_Error, "ERROR CutQuantileBatch nullptr == minSamplesBin");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == countCutsInOut)) {
+      LOG_0(Trace_Error, "ERROR CutQuantileBatch nullptr == countCutsInOut");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(IsMultiplyError(sizeof(size_t), cColumns))) {
+      LOG_0(Trace_Warning, "WARNING CutQuantileBatch IsMultiplyError(sizeof(size_t), cColumns)");
+      return Error_OutOfMemory;
+   }
+   size_t* const aiCutsFirst = static_cast<size_t*>(malloc(sizeof(size_t) * cColumns));
+   if(UNLIKELY(nullptr == aiCutsFirst)) {
+      LOG_0(Trace_Warning, "WARNING CutQuantileBatch nullptr == aiCutsFirst");
+      return Error_OutOfMemory;
+   }
+
+   // the cuts for each column are written directly after the space that the previous columns were given, so
+   // column i begins at the sum of the countCutsInOut values for the columns before it. We need to take these
+   // offsets before any column runs since the columns overwrite their countCutsInOut with the number of cuts made
+   size_t cCutsTotal = 0;
+   for(size_t iColumn = 0; iColumn < cColumns; ++iColumn) {
+      aiCutsFirst[iColumn] = cCutsTotal;
+      const IntEbm countCuts = countCutsInOut[iColumn];
+      if(UNLIKELY(countCuts < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR CutQuantileBatch countCuts can't be negative.");
+         free(aiCutsFirst);
+         return Error_IllegalParamVal;
+      }
+      if(UNLIKELY(IsConvertError<size_t>(countCuts) || IsAddError(cCutsTotal, static_cast<size_t>(countCuts)))) {
+         LOG_0(Trace_Error, "ERROR CutQuantileBatch the total number of cuts does not fit into a size_t");
+         free(aiCutsFirst);
+         return Error_IllegalParamVal;
+      }
+      cCutsTotal += static_cast<size_t>(countCuts);
+   }
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cColumns, &pThreadPool);
+   if(Error_None != error) {
+      free(aiCutsFirst);
+      return error;
+   }
+   const size_t cThreads = pThreadPool->GetCountThreads();
+
+   // this can't overflow since the ThreadPool already allocated at least this many std::thread objects
+   EBM_ASSERT(!IsMultiplyError(sizeof(CutQuantileScratch), cThreads));
+   CutQuantileScratch* const aScratch =
+         static_cast<CutQuantileScratch*>(malloc(sizeof(CutQuantileScratch) * cThreads));
+   if(UNLIKELY(nullptr == aScratch)) {
+      LOG_0(Trace_Warning, "WARNING CutQuantileBatch nullptr == aScratch");
+      ThreadPool::Return(pThreadPool);
+      free(aiCutsFirst);
+      return Error_OutOfMemory;
+   }
+   for(size_t iThread = 0; iThread < cThreads; ++iThread) {
+      InitScratch(&aScratch[iThread]);
+   }
+
+   auto cutColumn = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      EBM_ASSERT(iThread < cThreads);
+      return CutQuantileColumn(countSamples,
+            nullptr == featureVals ? nullptr : featureVals + cSamples * iTask,
+            minSamplesBin[iTask],
+            isRounded,
+            &countCutsInOut[iTask],
+            nullptr == cutsLowerBoundInclusiveOut ? nullptr : cutsLowerBoundInclusiveOut + aiCutsFirst[iTask],
+            &aScratch[iThread]);
+   };
+   error = pThreadPool->Run(cColumns, cutColumn);
+
+   for(size_t iThread = 0; iThread < cThreads; ++iThread) {
+      FreeScratch(&aScratch[iThread]);
+   }
+   free(aScratch);
+   ThreadPool::Return(pThreadPool);
+   free(aiCutsFirst);
+
+   LOG_N(Trace_Info, "Exited CutQuantileBatch: return=%" ErrorEbmPrintf, error);
+
+   return error;
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,497 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // std::numeric_limits
+#include <algorithm> // std::sort
+#include <cmath> // std::asin, std::sin
+#include <string.h> // memcpy
+
+#include "libebm.h" // EBM_API_BODY
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // LIKELY
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError
+
+#include "ebm_internal.hpp"
+#include "dataset_shared.hpp" // UIntShared
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+extern double GetInterpretableCutPointFloat(double low, double high) noexcept;
+
+// A quantile sketch is a merging t-digest held in memory that our caller owns.  It has no pointers, so a partial
+// sketch can be copied to another process running on the same architecture and merged there.  The centroids are
+// kept sorted by their mean and compressed after every call that modifies them.  The second half of the centroid
+// array is the space where incoming samples wait until they are compressed into the first half.
+
+static constexpr UIntShared k_quantileSketchId = 0x3C57; // random 15 bit number
+static constexpr double k_pi = 3.14159265358979323846;
+
+struct QuantileSketchCentroid {
+   double m_mean;
+   double m_weight;
+   // we need the true extremes of the values within a centroid to place exact cuts between neighbouring centroids
+   double m_min;
+   double m_max;
+};
+static_assert(std::is_standard_layout<QuantileSketchCentroid>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(std::is_trivial<QuantileSketchCentroid>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+
+struct QuantileSketchHeader {
+   // m_id should be in the first position since we use it to mark validity
+   UIntShared m_id;
+   UIntShared m_cCentroidsMax;
+   UIntShared m_cCentroids;
+
+   // IMPORTANT: m_aCentroids must be in the last position for the struct hack and this must be standard layout
+   QuantileSketchCentroid m_aCentroids[1];
+};
+static_assert(std::is_standard_layout<QuantileSketchHeader>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(std::is_trivial<QuantileSketchHeader>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+
+static bool CompareCentroid(const QuantileSketchCentroid& lhs, const QuantileSketchCentroid& rhs) noexcept {
+   // break ties on the extremes and weights so that the order, and therefore the result, does not depend on the
+   // order that std::sort visits equal means
+   if(lhs.m_mean != rhs.m_mean) {
+      return lhs.m_mean < rhs.m_mean;
+   }
+   if(lhs.m_min != rhs.m_min) {
+      return lhs.m_min < rhs.m_min;
+   }
+   if(lhs.m_max != rhs.m_max) {
+      return lhs.m_max < rhs.m_max;
+   }
+   return lhs.m_weight < rhs.m_weight;
+}
+
+static size_t GetCountBytesQuantileSketch(const size_t cCentroidsMax) noexcept {
+   // returns 0 on overflow
+   if(IsMultiplyError(size_t{2}, cCentroidsMax)) {
+      return 0;
+   }
+   const size_t cSlots = size_t{2} * cCentroidsMax;
+   if(IsMultiplyError(sizeof(QuantileSketchCentroid), cSlots)) {
+      return 0;
+   }
+   const size_t cBytesCentroids = sizeof(QuantileSketchCentroid) * cSlots;
+   static constexpr size_t k_cBytesHeader = offsetof(QuantileSketchHeader, m_aCentroids);
+   if(IsAddError(k_cBytesHeader, cBytesCentroids)) {
+      return 0;
+   }
+   return k_cBytesHeader + cBytesCentroids;
+}
+
+static QuantileSketchHeader* GetQuantileSketch(void* const sketch, const char* const sFunction) {
+   if(nullptr == sketch) {
+      LOG_N(Trace_Error, "ERROR %s nullptr == sketch", sFunction);
+      return nullptr;
+   }
+   QuantileSketchHeader* const pHeader = static_cast<QuantileSketchHeader*>(sketch);
+   if(k_quantileSketchId != pHeader->m_id) {
+      LOG_N(Trace_Error, "ERROR %s k_quantileSketchId != pHeader->m_id", sFunction);
+      return nullptr;
+   }
+   if(IsConvertError<size_t>(pHeader->m_cCentroidsMax) || IsConvertError<size_t>(pHeader->m_cCentroids)) {
+      LOG_N(Trace_Error, "ERROR %s the sketch counts are not valid sizes", sFunction);
+      return nullptr;
+   }
+   if(pHeader->m_cCentroidsMax < pHeader->m_cCentroids ||
+         size_t{0} == GetCountBytesQuantileSketch(static_cast<size_t>(pHeader->m_cCentroidsMax))) {
+      LOG_N(Trace_Error, "ERROR %s the sketch is corrupt", sFunction);
+      return nullptr;
+   }
+   return pHeader;
+}
+
+static double GetWeightLimit(const double compression, const double weightTotal, const double weightBefore) noexcept {
+   // the k1 scale function of the t-digest paper.  Each centroid can span at most one unit of k, which keeps the
+   // centroids small near the tails where the quantiles change quickly
+   const double q = EbmMin(EbmMax(weightBefore / weightTotal, 0.0), 1.0);
+   const double kNext = compression / (2.0 * k_pi) * std::asin(2.0 * q - 1.0) + 1.0;
+   if(compression * 0.25 <= kNext) {
+      return std::numeric_limits<double>::infinity();
+   }
+   return weightTotal * 0.5 * (std::sin(kNext * (2.0 * k_pi) / compression) + 1.0);
+}
+
+static size_t CompressCentroids(
+      const size_t cCentroidsMax, const size_t cItems, QuantileSketchCentroid* const aCentroids) noexcept {
+   EBM_ASSERT(size_t{2} <= cCentroidsMax);
+   EBM_ASSERT(nullptr != aCentroids);
+
+   if(size_t{0} == cItems) {
+      return 0;
+   }
+
+   std::sort(aCentroids, aCentroids + cItems, CompareCentroid);
+
+   double weightTotal = 0.0;
+   for(size_t iItem = 0; iItem < cItems; ++iItem) {
+      weightTotal += aCentroids[iItem].m_weight;
+   }
+
+   // with k1 any two neighbouring centroids span more than one unit of k out of the compression / 2 units
+   // available, so there can be at most compression + 1 centroids afterwards.  Floating point nonsense could in
+   // theory push us over by one, so repeat with a lower compression if that ever happens
+   double compression = static_cast<double>(cCentroidsMax - size_t{1});
+   size_t cCentroids = cItems;
+   do {
+      size_t iOut = 0;
+      QuantileSketchCentroid cur = aCentroids[0];
+      double weightBefore = 0.0;
+      double weightLimit = GetWeightLimit(compression, weightTotal, weightBefore);
+      for(size_t iItem = 1; iItem < cCentroids; ++iItem) {
+         const QuantileSketchCentroid& next = aCentroids[iItem];
+         if(weightBefore + cur.m_weight + next.m_weight <= weightLimit) {
+            const double weight = cur.m_weight + next.m_weight;
+            // this form avoids overflowing when the values are close to the limits of a double
+            cur.m_mean += (next.m_mean - cur.m_mean) * (next.m_weight / weight);
+            cur.m_weight = weight;
+            cur.m_min = EbmMin(cur.m_min, next.m_min);
+            cur.m_max = EbmMax(cur.m_max, next.m_max);
+         } else {
+            weightBefore += cur.m_weight;
+            // iOut < iItem, so we never overwrite an item that we have not yet visited
+            aCentroids[iOut] = cur;
+            ++iOut;
+            weightLimit = GetWeightLimit(compression, weightTotal, weightBefore);
+            cur = next;
+         }
+      }
+      aCentroids[iOut] = cur;
+      ++iOut;
+      cCentroids = iOut;
+      compression *= 0.5;
+   } while(cCentroidsMax < cCentroids);
+
+   return cCentroids;
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureQuantileSketch(IntEbm countCentroidsMax) {
+   if(countCentroidsMax < IntEbm{2}) {
+      LOG_0(Trace_Error, "ERROR MeasureQuantileSketch countCentroidsMax must be at least 2");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countCentroidsMax) || IsConvertError<UIntShared>(countCentroidsMax)) {
+      LOG_0(Trace_Error, "ERROR MeasureQuantileSketch countCentroidsMax is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytes = GetCountBytesQuantileSketch(static_cast<size_t>(countCentroidsMax));
+   if(size_t{0} == cBytes || IsConvertError<IntEbm>(cBytes)) {
+      LOG_0(Trace_Error, "ERROR MeasureQuantileSketch the sketch would be too large");
+      return Error_IllegalParamVal;
+   }
+   return static_cast<IntEbm>(cBytes);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION InitQuantileSketch(
+      IntEbm countCentroidsMax, IntEbm countBytesAllocated, void* sketchOut) {
+   LOG_N(Trace_Info,
+         "Entered InitQuantileSketch: "
+         "countCentroidsMax=%" IntEbmPrintf ", "
+         "countBytesAllocated=%" IntEbmPrintf ", "
+         "sketchOut=%p",
+         countCentroidsMax,
+         countBytesAllocated,
+         sketchOut);
+
+   if(nullptr == sketchOut) {
+      LOG_0(Trace_Error, "ERROR InitQuantileSketch nullptr == sketchOut");
+      return Error_IllegalParamVal;
+   }
+
+   const IntEbm countBytesRequired = MeasureQuantileSketch(countCentroidsMax);
+   if(countBytesRequired < IntEbm{0}) {
+      // already logged
+      return static_cast<ErrorEbm>(countBytesRequired);
+   }
+   if(countBytesAllocated < countBytesRequired) {
+      LOG_0(Trace_Error, "ERROR InitQuantileSketch countBytesAllocated < countBytesRequired");
+      return Error_IllegalParamVal;
+   }
+
+   QuantileSketchHeader* const pHeader = static_cast<QuantileSketchHeader*>(sketchOut);
+   pHeader->m_id = k_quantileSketchId;
+   pHeader->m_cCentroidsMax = static_cast<UIntShared>(countCentroidsMax);
+   pHeader->m_cCentroids = 0;
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION AppendQuantileSketch(
+      IntEbm countSamples, const double* featureVals, const double* weights, void* sketchInOut) {
+   LOG_N(Trace_Verbose,
+         "Entered AppendQuantileSketch: "
+         "countSamples=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "weights=%p, "
+         "sketchInOut=%p",
+         countSamples,
+         static_cast<const void*>(featureVals),
+         static_cast<const void*>(weights),
+         sketchInOut);
+
+   QuantileSketchHeader* const pHeader = GetQuantileSketch(sketchInOut, "AppendQuantileSketch");
+   if(nullptr == pHeader) {
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR AppendQuantileSketch countSamples is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+   if(size_t{0} == cSamples) {
+      return Error_None;
+   }
+   if(nullptr == featureVals) {
+      LOG_0(Trace_Error, "ERROR AppendQuantileSketch nullptr == featureVals");
+      return Error_IllegalParamVal;
+   }
+
+   // check the weights before touching the sketch so that a bad chunk leaves the sketch as it was
+   if(nullptr != weights) {
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         const double weight = weights[iSample];
+         if(std::isnan(weight) || std::isinf(weight) || weight < 0.0) {
+            LOG_0(Trace_Error, "ERROR AppendQuantileSketch weights must be finite and non-negative");
+            return Error_IllegalParamVal;
+         }
+      }
+   }
+
+   const size_t cCentroidsMax = static_cast<size_t>(pHeader->m_cCentroidsMax);
+   const size_t cSlots = size_t{2} * cCentroidsMax;
+   QuantileSketchCentroid* const aCentroids = ArrayToPointer(pHeader->m_aCentroids);
+
+   size_t cItems = static_cast<size_t>(pHeader->m_cCentroids);
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      double val = featureVals[iSample];
+      const double weight = nullptr == weights ? 1.0 : weights[iSample];
+      if(std::isnan(val) || 0.0 == weight) {
+         // missing values go into their own bin, so they do not affect the cuts
+         continue;
+      }
+      // the same conversion that RemoveMissingValsAndReplaceInfinities does for CutQuantile
+      if(std::numeric_limits<double>::max() < val) {
+         val = std::numeric_limits<double>::max();
+      } else if(val < std::numeric_limits<double>::lowest()) {
+         val = std::numeric_limits<double>::lowest();
+      }
+
+      if(cSlots == cItems) {
+         cItems = CompressCentroids(cCentroidsMax, cItems, aCentroids);
+      }
+      EBM_ASSERT(cItems < cSlots);
+      QuantileSketchCentroid* const pCentroid = &aCentroids[cItems];
+      pCentroid->m_mean = val;
+      pCentroid->m_weight = weight;
+      pCentroid->m_min = val;
+      pCentroid->m_max = val;
+      ++cItems;
+   }
+   pHeader->m_cCentroids = static_cast<UIntShared>(CompressCentroids(cCentroidsMax, cItems, aCentroids));
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION MergeQuantileSketch(const void* sketchFrom, void* sketchInOut) {
+   LOG_N(Trace_Verbose,
+         "Entered MergeQuantileSketch: "
+         "sketchFrom=%p, "
+         "sketchInOut=%p",
+         sketchFrom,
+         sketchInOut);
+
+   if(sketchFrom == sketchInOut) {
+      LOG_0(Trace_Error, "ERROR MergeQuantileSketch sketchFrom == sketchInOut");
+      return Error_IllegalParamVal;
+   }
+
+   // GetQuantileSketch does not modify the sketch
+   const QuantileSketchHeader* const pHeaderFrom =
+         GetQuantileSketch(const_cast<void*>(sketchFrom), "MergeQuantileSketch");
+   if(nullptr == pHeaderFrom) {
+      return Error_IllegalParamVal;
+   }
+   QuantileSketchHeader* const pHeader = GetQuantileSketch(sketchInOut, "MergeQuantileSketch");
+   if(nullptr == pHeader) {
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cCentroidsMax = static_cast<size_t>(pHeader->m_cCentroidsMax);
+   const size_t cSlots = size_t{2} * cCentroidsMax;
+   QuantileSketchCentroid* const aCentroids = ArrayToPointer(pHeader->m_aCentroids);
+
+   // the two sketches do not need the same capacity, so we might need several rounds of compression
+   const QuantileSketchCentroid* pCentroidFrom = ArrayToPointer(pHeaderFrom->m_aCentroids);
+   size_t cRemaining = static_cast<size_t>(pHeaderFrom->m_cCentroids);
+   size_t cItems = static_cast<size_t>(pHeader->m_cCentroids);
+   while(size_t{0} != cRemaining) {
+      EBM_ASSERT(cItems <= cCentroidsMax);
+      const size_t cCopy = EbmMin(cRemaining, cSlots - cItems);
+      memcpy(&aCentroids[cItems], pCentroidFrom, sizeof(*pCentroidFrom) * cCopy);
+      pCentroidFrom += cCopy;
+      cRemaining -= cCopy;
+      cItems = CompressCentroids(cCentroidsMax, cItems + cCopy, aCentroids);
+   }
+   pHeader->m_cCentroids = static_cast<UIntShared>(cItems);
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantileSketch(const void* sketch,
+      IntEbm minSamplesBin,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut) {
+   LOG_N(Trace_Info,
+         "Entered CutQuantileSketch: "
+         "sketch=%p, "
+         "minSamplesBin=%" IntEbmPrintf ", "
+         "countCutsInOut=%p, "
+         "cutsLowerBoundInclusiveOut=%p",
+         sketch,
+         minSamplesBin,
+         static_cast<void*>(countCutsInOut),
+         static_cast<void*>(cutsLowerBoundInclusiveOut));
+
+   if(nullptr == countCutsInOut) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch nullptr == countCutsInOut");
+      return Error_IllegalParamVal;
+   }
+   const IntEbm countCuts = *countCutsInOut;
+   *countCutsInOut = IntEbm{0};
+
+   const QuantileSketchHeader* const pHeader = GetQuantileSketch(const_cast<void*>(sketch), "CutQuantileSketch");
+   if(nullptr == pHeader) {
+      return Error_IllegalParamVal;
+   }
+
+   if(countCuts <= IntEbm{0}) {
+      if(countCuts < IntEbm{0}) {
+         LOG_0(Trace_Error, "ERROR CutQuantileSketch countCuts can't be negative.");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(IsConvertError<size_t>(countCuts)) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch countCuts is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   if(nullptr == cutsLowerBoundInclusiveOut) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch nullptr == cutsLowerBoundInclusiveOut");
+      return Error_IllegalParamVal;
+   }
+
+   if(minSamplesBin <= IntEbm{0}) {
+      LOG_0(Trace_Warning, "WARNING CutQuantileSketch minSamplesBin shouldn't be zero or negative.  Setting to 1");
+      minSamplesBin = IntEbm{1};
+   }
+   const double weightBinMin = static_cast<double>(minSamplesBin);
+
+   const size_t cCentroids = static_cast<size_t>(pHeader->m_cCentroids);
+   const QuantileSketchCentroid* const aCentroids = ArrayToPointer(pHeader->m_aCentroids);
+
+   double weightTotal = 0.0;
+   for(size_t iCentroid = 0; iCentroid < cCentroids; ++iCentroid) {
+      weightTotal += aCentroids[iCentroid].m_weight;
+   }
+
+   // like CutQuantile, we aim for bins of equal weight but never make a bin lighter than minSamplesBin
+   const double cBinsPossible = std::floor(weightTotal / weightBinMin);
+   const size_t cCutsMax = static_cast<size_t>(countCuts);
+   const double cBinsDouble = EbmMin(static_cast<double>(cCutsMax) + 1.0, cBinsPossible);
+   if(cBinsDouble < 2.0) {
+      return Error_None;
+   }
+   size_t cBinsRemaining = static_cast<size_t>(cBinsDouble);
+
+   // we can only cut on the boundaries between centroids.  Boundary b sits between centroids b - 1 and b and has
+   // the weight of centroids [0, b) below it.  Each cut goes on the legal boundary nearest to the point that would
+   // split the remaining weight evenly between the remaining bins.  Recalculating the target after each cut lets a
+   // heavy centroid that swallows several targets use up only one bin, like long runs of equal values in CutQuantile
+   size_t cCutsRet = 0;
+   double weightLastCut = 0.0;
+   double cutPrev = std::numeric_limits<double>::lowest();
+   size_t iBoundary = 1;
+   double weightBoundary = size_t{0} == cCentroids ? 0.0 : aCentroids[0].m_weight;
+   while(size_t{2} <= cBinsRemaining && cCutsRet < cCutsMax) {
+      const double weightTarget =
+            weightLastCut + (weightTotal - weightLastCut) / static_cast<double>(cBinsRemaining);
+
+      size_t iBest = 0;
+      double weightBest = 0.0;
+      double cutBest = 0.0;
+      double distanceBest = std::numeric_limits<double>::infinity();
+      while(iBoundary < cCentroids) {
+         const QuantileSketchCentroid& low = aCentroids[iBoundary - 1];
+         const QuantileSketchCentroid& high = aCentroids[iBoundary];
+
+         if(weightBinMin <= weightBoundary - weightLastCut && weightBinMin <= weightTotal - weightBoundary) {
+            // when the centroids do not overlap we can put an exact cut between their extremes.  Otherwise we
+            // cannot be sure which side of the cut each value lands on, so fall back to cutting between the
+            // means, which is as close as the sketch allows us to get
+            double valLow = low.m_max;
+            double valHigh = high.m_min;
+            if(valHigh <= valLow) {
+               valLow = low.m_mean;
+               valHigh = high.m_mean;
+            }
+            if(valLow < valHigh && !std::isinf(valLow) && !std::isinf(valHigh)) {
+               const double cut = GetInterpretableCutPointFloat(valLow, valHigh);
+               const double distance = std::abs(weightBoundary - weightTarget);
+               if(cutPrev < cut && distance < distanceBest) {
+                  iBest = iBoundary;
+                  weightBest = weightBoundary;
+                  cutBest = cut;
+                  distanceBest = distance;
+               }
+            }
+         }
+
+         if(weightTarget <= weightBoundary && size_t{0} != iBest) {
+            // any boundary further along is further from the target than the best one we have
+            break;
+         }
+         weightBoundary += high.m_weight;
+         ++iBoundary;
+      }
+      if(size_t{0} == iBest) {
+         // there are no legal boundaries left above the last cut
+         break;
+      }
+
+      cutsLowerBoundInclusiveOut[cCutsRet] = cutBest;
+      ++cCutsRet;
+      --cBinsRemaining;
+      cutPrev = cutBest;
+      weightLastCut = weightBest;
+
+      // restart the search at the boundary above the cut we just made
+      iBoundary = iBest + 1;
+      weightBoundary = weightBest + aCentroids[iBest].m_weight;
+   }
+
+   EBM_ASSERT(!IsConvertError<IntEbm>(cCutsRet)); // cCutsRet <= countCuts
+   *countCutsInOut = static_cast<IntEbm>(cCutsRet);
+
+   LOG_N(Trace_Info, "Exited CutQuantileSketch: countCuts=%" IntEbmPrintf, *countCutsInOut);
+
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
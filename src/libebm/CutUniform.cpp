@@ -17,6 +17,7 @@
 #include "common.hpp" // IsConvertError
 
 #include "ebm_internal.hpp" // CleanFloat, FloatTickIncrement
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -365,8 +366,53 @@ EBM_API_BODY void EBM_CALLING_CONVENTION CleanFloats(IntEbm count, double* valsI
    }
 }
 
-EBM_API_BODY IntEbm EBM_CALLING_CONVENTION CutUniform(
-      IntEbm countSamples, const double* featureVals, IntEbm countDesiredCuts, double* cutsLowerBoundInclusiveOut) {
+static void FindMinMax(const size_t cSamples, const double* const aVals, double* const pMinOut, double* const pMaxOut) {
+   // Use independent running minimums and maximums for each lane so that the comparisons do not form one long
+   // serial dependency chain and the compiler can turn them into SIMD min/max instructions. NaN compares false
+   // against everything, so missing values never replace a lane value, which matches the explicit NaN check in
+   // the scalar version. The min and max of a set of non-NaN values does not depend on the order of the
+   // comparisons, except for which sign of zero wins, and our caller passes both results through CleanFloat,
+   // which turns negative zero into zero.
+
+   static constexpr size_t k_cLanes = 4;
+
+   double aMin[k_cLanes];
+   double aMax[k_cLanes];
+   for(size_t iLane = 0; iLane < k_cLanes; ++iLane) {
+      aMin[iLane] = k_maxNonInf;
+      aMax[iLane] = -k_maxNonInf;
+   }
+
+   const double* pVal = aVals;
+   const double* const pValsLanedEnd = aVals + (cSamples - cSamples % k_cLanes);
+   const double* const pValsEnd = aVals + cSamples;
+   while(pValsLanedEnd != pVal) {
+      for(size_t iLane = 0; iLane < k_cLanes; ++iLane) {
+         const double val = pVal[iLane];
+         aMin[iLane] = val < aMin[iLane] ? val : aMin[iLane];
+         aMax[iLane] = aMax[iLane] < val ? val : aMax[iLane];
+      }
+      pVal += k_cLanes;
+   }
+   while(pValsEnd != pVal) {
+      const double val = *pVal;
+      aMin[0] = val < aMin[0] ? val : aMin[0];
+      aMax[0] = aMax[0] < val ? val : aMax[0];
+      ++pVal;
+   }
+
+   double valMin = aMin[0];
+   double valMax = aMax[0];
+   for(size_t iLane = 1; iLane < k_cLanes; ++iLane) {
+      valMin = aMin[iLane] < valMin ? aMin[iLane] : valMin;
+      valMax = valMax < aMax[iLane] ? aMax[iLane] : valMax;
+   }
+   *pMinOut = valMin;
+   *pMaxOut = valMax;
+}
+
+static IntEbm CutUniformFromMinMax(
+      double valMin, double valMax, IntEbm countDesiredCuts, double* cutsLowerBoundInclusiveOut) {
    // DO NOT CHANGE THIS FUNCTION'S ALGORITHM.  IT IS PART OF THE EBM HISTOGRAM SPEC
    //
    // This function is also used when choosing histograms cuts. Since we don't store the histogram
@@ -446,10 +492,6 @@ EBM_API_BODY IntEbm EBM_CALLING_CONVENTION CutUniform(
    // complexity since we want this code to be cross-language portable, and this only affects extremely tiny numbers
    // in the range of 10^-308.  Numbers that small are really skirting close to being zero anyways.
 
-   double valMin;
-   double valMax;
-   size_t iSample;
-   double val;
    double walkVal;
    size_t iCut;
    double multiple;
@@ -479,39 +521,8 @@ EBM_API_BODY IntEbm EBM_CALLING_CONVENTION CutUniform(
       return 0;
    }
 
-   if(IsConvertError<size_t>(countSamples)) {
-      LOG_0(Trace_Error, "ERROR CutUniform countSamples is not a valid index into an array");
-      return 0;
-   }
-   const size_t cSamples = static_cast<size_t>(countSamples);
-   if(IsMultiplyError(sizeof(*featureVals), cSamples)) {
-      LOG_0(Trace_Error, "ERROR CutUniform countSamples value too large to index into memory");
-      return 0;
-   }
-
-   if(nullptr == featureVals) {
-      LOG_0(Trace_Error, "ERROR CutUniform featureVals cannot be NULL");
-      return 0;
-   }
-
-   valMin = k_maxNonInf;
-   valMax = -k_maxNonInf;
-
-   for(iSample = 0; iSample < cSamples; ++iSample) {
-      val = featureVals[iSample];
-      // Use this check for NaN for cross-language portability.  It is not technically needed
-      // if IEEE-754 is followed, since "NaN < anything" and "anything < NaN" are false
-      if(!std::isnan(val)) {
-         if(valMax < val) {
-            // this works for NaN values which evals to false
-            valMax = val;
-         }
-         if(val < valMin) {
-            // this works for NaN values which evals to false
-            valMin = val;
-         }
-      }
-   }
+   // valMin and valMax are the raw minimum and maximum of the non-missing feature values, or k_maxNonInf and
+   // -k_maxNonInf respectively if all the values are missing
 
    EBM_ASSERT(!std::isnan(valMin));
    EBM_ASSERT(!std::isnan(valMax));
@@ -659,4 +670,186 @@ EBM_API_BODY IntEbm EBM_CALLING_CONVENTION CutUniform(
    return countDesiredCuts;
 }
 
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION CutUniform(
+      IntEbm countSamples, const double* featureVals, IntEbm countDesiredCuts, double* cutsLowerBoundInclusiveOut) {
+   if(0 == countDesiredCuts) {
+      // CutUniformFromMinMax would return zero, so don't bother scanning
+      return 0;
+   }
+
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR CutUniform countSamples is not a valid index into an array");
+      return 0;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+   if(IsMultiplyError(sizeof(*featureVals), cSamples)) {
+      LOG_0(Trace_Error, "ERROR CutUniform countSamples value too large to index into memory");
+      return 0;
+   }
+
+   if(nullptr == featureVals) {
+      LOG_0(Trace_Error, "ERROR CutUniform featureVals cannot be NULL");
+      return 0;
+   }
+
+   // Other language implementations should use this scalar loop, with the explicit NaN check kept for portability.
+   // FindMinMax returns the same values, apart from the sign of zero which CutUniformFromMinMax removes with CleanFloat.
+   //
+   // valMin = k_maxNonInf;
+   // valMax = -k_maxNonInf;
+   // for(iSample = 0; iSample < cSamples; ++iSample) {
+   //    val = featureVals[iSample];
+   //    if(!std::isnan(val)) {
+   //       if(valMax < val) {
+   //          valMax = val;
+   //       }
+   //       if(val < valMin) {
+   //          valMin = val;
+   //       }
+   //    }
+   // }
+   double valMin;
+   double valMax;
+   FindMinMax(cSamples, featureVals, &valMin, &valMax);
+
+   return CutUniformFromMinMax(valMin, valMax, countDesiredCuts, cutsLowerBoundInclusiveOut);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutUniformBatch(IntEbm countSamples,
+      IntEbm countColumns,
+      const double* featureVals,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut,
+      double* minFeatureValsOut,
+      double* maxFeatureValsOut) {
+   LOG_N(Trace_Info,
+         "Entered CutUniformBatch: "
+         "countSamples=%" IntEbmPrintf ", "
+         "countColumns=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "countCutsInOut=%p, "
+         "cutsLowerBoundInclusiveOut=%p, "
+         "minFeatureValsOut=%p, "
+         "maxFeatureValsOut=%p",
+         countSamples,
+         countColumns,
+         static_cast<const void*>(featureVals),
+         static_cast<void*>(countCutsInOut),
+         static_cast<void*>(cutsLowerBoundInclusiveOut),
+         static_cast<void*>(minFeatureValsOut),
+         static_cast<void*>(maxFeatureValsOut));
+
+   if(UNLIKELY(countColumns <= IntEbm{0})) {
+      if(UNLIKELY(countColumns < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR CutUniformBatch countColumns < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countColumns))) {
+      LOG_0(Trace_Error, "ERROR CutUniformBatch IsConvertError<size_t>(countColumns)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cColumns = static_cast<size_t>(countColumns);
+
+   if(UNLIKELY(countSamples < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR CutUniformBatch countSamples < IntEbm { 0 }");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
+      LOG_0(Trace_Error, "ERROR CutUniformBatch IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   if(UNLIKELY(IsMultiplyError(sizeof(double), cSamples, cColumns))) {
+      LOG_0(Trace_Error, "ERROR CutUniformBatch IsMultiplyError(sizeof(double), cSamples, cColumns)");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == featureVals)) {
+      LOG_0(Trace_Error, "ERROR CutUniformBatch nullptr == featureVals");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == countCutsInOut)) {
+      LOG_0(Trace_Error, "ERROR CutUniformBatch nullptr == countCutsInOut");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(IsMultiplyError(sizeof(size_t), cColumns))) {
+      LOG_0(Trace_Warning, "WARNING CutUniformBatch IsMultiplyError(sizeof(size_t), cColumns)");
+      return Error_OutOfMemory;
+   }
+   size_t* const aiCutsFirst = static_cast<size_t*>(malloc(sizeof(size_t) * cColumns));
+   if(UNLIKELY(nullptr == aiCutsFirst)) {
+      LOG_0(Trace_Warning, "WARNING CutUniformBatch nullptr == aiCutsFirst");
+      return Error_OutOfMemory;
+   }
+
+   // same layout as CutQuantileBatch: column i writes its cuts at the sum of the countCutsInOut values of the
+   // columns before it, so take the offsets before any column overwrites its count with the number of cuts made
+   size_t cCutsTotal = 0;
+   for(size_t iColumn = 0; iColumn < cColumns; ++iColumn) {
+      aiCutsFirst[iColumn] = cCutsTotal;
+      const IntEbm countCuts = countCutsInOut[iColumn];
+      if(UNLIKELY(countCuts < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR CutUniformBatch countCuts can't be negative.");
+         free(aiCutsFirst);
+         return Error_IllegalParamVal;
+      }
+      if(UNLIKELY(IsConvertError<size_t>(countCuts) || IsAddError(cCutsTotal, static_cast<size_t>(countCuts)))) {
+         LOG_0(Trace_Error, "ERROR CutUniformBatch the total number of cuts does not fit into a size_t");
+         free(aiCutsFirst);
+         return Error_IllegalParamVal;
+      }
+      cCutsTotal += static_cast<size_t>(countCuts);
+   }
+   if(UNLIKELY(IsMultiplyError(sizeof(*cutsLowerBoundInclusiveOut), cCutsTotal))) {
+      LOG_0(Trace_Error, "ERROR CutUniformBatch the total number of cuts is too large to index into memory");
+      free(aiCutsFirst);
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == cutsLowerBoundInclusiveOut && size_t{0} != cCutsTotal)) {
+      LOG_0(Trace_Error, "ERROR CutUniformBatch nullptr == cutsLowerBoundInclusiveOut");
+      free(aiCutsFirst);
+      return Error_IllegalParamVal;
+   }
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cColumns, &pThreadPool);
+   if(Error_None != error) {
+      free(aiCutsFirst);
+      return error;
+   }
+
+   // CutUniform only reads its column, so unlike CutQuantileBatch there is no per-thread copy or scratch memory.
+   // The min/max scan is shared between the cuts and the optional feature bounds that SuggestGraphBoundsBatch uses.
+   auto cutColumn = [&](const size_t iTask, const size_t) -> ErrorEbm {
+      double valMin;
+      double valMax;
+      FindMinMax(cSamples, featureVals + cSamples * iTask, &valMin, &valMax);
+      const bool bAllMissing = k_maxNonInf == valMin && -k_maxNonInf == valMax;
+      if(nullptr != minFeatureValsOut) {
+         minFeatureValsOut[iTask] = bAllMissing ? std::numeric_limits<double>::quiet_NaN() : valMin;
+      }
+      if(nullptr != maxFeatureValsOut) {
+         maxFeatureValsOut[iTask] = bAllMissing ? std::numeric_limits<double>::quiet_NaN() : valMax;
+      }
+      const IntEbm countCuts = countCutsInOut[iTask];
+      countCutsInOut[iTask] = IntEbm{0} == countCuts ? IntEbm{0} :
+            CutUniformFromMinMax(valMin,
+                  valMax,
+                  countCuts,
+                  nullptr == cutsLowerBoundInclusiveOut ? nullptr : cutsLowerBoundInclusiveOut + aiCutsFirst[iTask]);
+      return Error_None;
+   };
+   error = pThreadPool->Run(cColumns, cutColumn);
+
+   ThreadPool::Return(pThreadPool);
+   free(aiCutsFirst);
+
+   LOG_N(Trace_Info, "Exited CutUniformBatch: return=%" ErrorEbmPrintf, error);
+
+   return error;
+}
+
 } // namespace DEFINED_ZONE_NAME
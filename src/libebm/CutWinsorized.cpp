@@ -6,7 +6,7 @@
 
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // std::numeric_limits
-#include <algorithm> // std::sort
+#include <algorithm> // std::nth_element
 #include <string.h> // memcpy
 
 #include "libebm.h" // EBM_API_BODY
@@ -19,6 +19,7 @@
 #include "common.hpp" // IsConvertError
 
 #include "ebm_internal.hpp" // FloatTickIncrement
+#include "ThreadPool.hpp"
 
 // TODO: check this file for how we handle subnormal numbers.  NEVER RETURN SUBNORMALS!
 
@@ -35,9 +36,66 @@ extern double ArithmeticMean(const double low, const double high) noexcept;
 static int g_cLogEnterCutWinsorized = 25;
 static int g_cLogExitCutWinsorized = 25;
 
-// TODO: add this as a python/R option "winsorized"
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
-      IntEbm countSamples, const double* featureVals, IntEbm* countCutsInOut, double* cutsLowerBoundInclusiveOut) {
+// Winsorized binning only needs a couple of order statistics and the distinct values that neighbour them, so instead
+// of sorting the column we select the order statistics with std::nth_element and then find the neighbours with
+// linear scans.  This keeps the work O(n) for any number of cuts.  NeighbourVals finds the closest distinct values on
+// either side of val, and how many values are strictly below and above it.  If there are no values below val then
+// *pBelowOut is set to val, and likewise for *pAboveOut.
+static void NeighbourVals(const size_t cSamples,
+      const double* const aVals,
+      const double val,
+      double* const pBelowOut,
+      double* const pAboveOut,
+      size_t* const pcBelowOut,
+      size_t* const pcAboveOut) {
+   EBM_ASSERT(nullptr != aVals);
+
+   double below = std::numeric_limits<double>::lowest();
+   double above = std::numeric_limits<double>::max();
+   size_t cBelow = 0;
+   size_t cAbove = 0;
+   const double* pVal = aVals;
+   const double* const pValsEnd = aVals + cSamples;
+   do {
+      const double cur = *pVal;
+      if(cur < val) {
+         ++cBelow;
+         below = below < cur ? cur : below;
+      } else if(val < cur) {
+         ++cAbove;
+         above = cur < above ? cur : above;
+      }
+      ++pVal;
+   } while(pValsEnd != pVal);
+
+   *pBelowOut = size_t{0} == cBelow ? val : below;
+   *pAboveOut = size_t{0} == cAbove ? val : above;
+   *pcBelowOut = cBelow;
+   *pcAboveOut = cAbove;
+}
+
+// selects the order statistics at iLow and iHigh (iLow <= iHigh), leaving both in place in aVals
+static void SelectPair(const size_t cSamples, double* const aVals, const size_t iLow, const size_t iHigh) {
+   EBM_ASSERT(iLow <= iHigh);
+   EBM_ASSERT(iHigh < cSamples);
+   std::nth_element(aVals, aVals + iHigh, aVals + cSamples);
+   if(iLow != iHigh) {
+      // nth_element leaves everything before iHigh no greater than aVals[iHigh], so iLow is within that part
+      std::nth_element(aVals, aVals + iLow, aVals + iHigh);
+   }
+}
+
+// CutWinsorizedBatch calls CutWinsorizedColumn once per column on each thread, so the sorted copy of the values
+// is kept between columns and only reallocated when a column has more samples than the earlier ones
+static ErrorEbm CutWinsorizedColumn(IntEbm countSamples,
+      const double* featureVals,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut,
+      double** const paFeatureValsScratch,
+      size_t* const pcBytesFeatureValsScratch) {
+   EBM_ASSERT(nullptr != paFeatureValsScratch);
+   EBM_ASSERT(nullptr != pcBytesFeatureValsScratch);
+
    LOG_COUNTED_N(&g_cLogEnterCutWinsorized,
          Trace_Info,
          Trace_Verbose,
@@ -89,7 +147,15 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
             goto exit_with_log;
          }
          const size_t cBytesFeatureVals = sizeof(double) * cSamplesIncludingMissingVals;
-         double* const aFeatureVals = static_cast<double*>(malloc(cBytesFeatureVals));
+         if(*pcBytesFeatureValsScratch < cBytesFeatureVals) {
+            free(*paFeatureValsScratch);
+            *pcBytesFeatureValsScratch = 0;
+            *paFeatureValsScratch = static_cast<double*>(malloc(cBytesFeatureVals));
+            if(nullptr != *paFeatureValsScratch) {
+               *pcBytesFeatureValsScratch = cBytesFeatureVals;
+            }
+         }
+         double* const aFeatureVals = *paFeatureValsScratch;
          if(UNLIKELY(nullptr == aFeatureVals)) {
             LOG_0(Trace_Error, "ERROR CutWinsorized nullptr == aFeatureVals");
 
@@ -113,7 +179,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
             const IntEbm countCuts = *countCutsInOut;
 
             if(UNLIKELY(countCuts <= IntEbm{0})) {
-               free(aFeatureVals);
                error = Error_None;
                if(UNLIKELY(countCuts < IntEbm{0})) {
                   LOG_0(Trace_Error, "ERROR CutWinsorized countCuts can't be negative.");
@@ -124,7 +189,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
 
             if(UNLIKELY(IsConvertError<size_t>(countCuts))) {
                LOG_0(Trace_Warning, "WARNING CutWinsorized IsConvertError<size_t>(countCuts)");
-               free(aFeatureVals);
                error = Error_IllegalParamVal;
                goto exit_with_log;
             }
@@ -132,7 +196,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
 
             if(UNLIKELY(IsMultiplyError(sizeof(*cutsLowerBoundInclusiveOut), cCuts))) {
                LOG_0(Trace_Error, "ERROR CutWinsorized countCuts was too large to fit into cutsLowerBoundInclusiveOut");
-               free(aFeatureVals);
                error = Error_IllegalParamVal;
                goto exit_with_log;
             }
@@ -140,7 +203,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
             if(UNLIKELY(nullptr == cutsLowerBoundInclusiveOut)) {
                // if we have a potential bin cut, then cutsLowerBoundInclusiveOut shouldn't be nullptr
                LOG_0(Trace_Error, "ERROR CutWinsorized nullptr == cutsLowerBoundInclusiveOut");
-               free(aFeatureVals);
                error = Error_IllegalParamVal;
                goto exit_with_log;
             }
@@ -151,39 +213,51 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
             // uniform we just need to find a single cut between values and we can divide the space up between
             // uniform bins between those values.
 
-            std::sort(aFeatureVals, aFeatureVals + cSamples);
-
             if(UNLIKELY(size_t{1} == cCuts)) {
                // if we're only given 1 cut, then we need do so something special since we can't have an upper and
                // lower cut from which to range between.  We want to find the best central cut and use that
-
-               const double valMin = aFeatureVals[0];
-               const double valMax = aFeatureVals[cSamples - size_t{1}];
-
-               // if this fails there are no transitions at all, so we can't have a cut
-               if(LIKELY(valMin != valMax)) {
-                  const size_t iCenterHigh = cSamples >> 1;
-                  // put the low on the high side so that in our first loop we decrement it to it's actual position
-                  const double* pLow = &aFeatureVals[iCenterHigh];
-                  const double* pHigh = pLow - (size_t{1} & (cSamples - size_t{1}));
-
-                  double lowCur;
-                  double highCur;
-                  do {
-                     --pLow;
-                     ++pHigh;
-
-                     EBM_ASSERT(aFeatureVals <= pLow && pLow < aFeatureVals + cSamples);
-                     lowCur = *pLow;
-                     EBM_ASSERT(aFeatureVals <= pHigh && pHigh < aFeatureVals + cSamples);
-                     highCur = *pHigh;
-                     // since valMin != valMax per above, we know there is a transition SOMEWHERE, which will exit us
-                  } while(LIKELY(lowCur == highCur));
+               //
+               // In sorted order we would walk outwards from the center, one step on each side at a time, until
+               // the low and high values differ. The two center values are order statistics, and if they are equal
+               // then both sit inside the run of that value, so the walk ends when the shorter side leaves the run.
+
+               const size_t iCenterHigh = cSamples >> 1;
+               const size_t iLowStart = iCenterHigh - size_t{1};
+               const size_t iHighStart = iCenterHigh + (size_t{1} & cSamples);
+               SelectPair(cSamples, aFeatureVals, iLowStart, iHighStart);
+
+               double lowCur = aFeatureVals[iLowStart];
+               double highCur = aFeatureVals[iHighStart];
+               if(lowCur == highCur) {
+                  const double valCenter = lowCur;
+                  double below;
+                  double above;
+                  size_t cBelow;
+                  size_t cAbove;
+                  NeighbourVals(cSamples, aFeatureVals, valCenter, &below, &above, &cBelow, &cAbove);
+
+                  // if this fails there are no transitions at all, so we can't have a cut
+                  if(LIKELY(size_t{0} != cBelow || size_t{0} != cAbove)) {
+                     // the run of valCenter occupies sorted indexes [cBelow, cSamples - cAbove - 1].  The low walk
+                     // leaves it after iLowStart - cBelow + 1 steps and the high walk after
+                     // cSamples - cAbove - iHighStart steps.  Runs that reach the end on one side take no part.
+                     const size_t cStepsLow = size_t{0} == cBelow ? cSamples : iLowStart - cBelow + size_t{1};
+                     const size_t cStepsHigh = size_t{0} == cAbove ? cSamples : cSamples - cAbove - iHighStart;
+                     if(cStepsLow <= cStepsHigh) {
+                        lowCur = below;
+                     }
+                     if(cStepsHigh <= cStepsLow) {
+                        highCur = above;
+                     }
+                  }
+               }
+               if(LIKELY(lowCur != highCur)) {
                   EBM_ASSERT(lowCur < highCur);
 
                   // if both lowCur and highCur have changed, we'll get the average value between them, but that'll
-                  // put the valCenter either on the low or high bin dependent on the values.  Unlike quantile binning,
-                  // winsorized binning is senitive to the values and not invariant to operations, so this is fine
+                  // put the valCenter either on the low or high bin dependent on the values.  Unlike quantile
+                  // binning, winsorized binning is senitive to the values and not invariant to operations, so this
+                  // is fine
 
                   const double avg = ArithmeticMean(lowCur, highCur);
                   *cutsLowerBoundInclusiveOut = avg;
@@ -199,18 +273,20 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
                const size_t iOuterBound = (cSamples - size_t{1}) / cBins;
                EBM_ASSERT(iOuterBound < cSamples);
 
-               // position ourselves at low-high and move inwards
-               const double* pLow = &aFeatureVals[iOuterBound];
-               // position ourselves at high-low and move inwards
-               const double* pHigh = &aFeatureVals[cSamples - iOuterBound - size_t{1}];
-
-               EBM_ASSERT(aFeatureVals <= pLow && pLow < aFeatureVals + cSamples);
-               EBM_ASSERT(aFeatureVals <= pHigh && pHigh < aFeatureVals + cSamples);
+               // the low-high and high-low outer values are order statistics
+               const size_t iLowOuter = iOuterBound;
+               const size_t iHighOuter = cSamples - iOuterBound - size_t{1};
+               SelectPair(cSamples, aFeatureVals, iLowOuter, iHighOuter);
 
-               const double lowOuterVal = *pLow;
-               const double highOuterVal = *pHigh;
+               const double lowOuterVal = aFeatureVals[iLowOuter];
+               const double highOuterVal = aFeatureVals[iHighOuter];
                EBM_ASSERT(lowOuterVal <= highOuterVal);
 
+               double below;
+               double above;
+               size_t cBelow;
+               size_t cAbove;
+
                if(UNLIKELY(lowOuterVal == highOuterVal)) {
                   // there are no transitions between our outer values.  We have just 1 single value between them
                   // one way to handle this would be to wrap the value on the low side with the exact value
@@ -218,55 +294,34 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
                   // tight.  We instead put the two cuts between the outer values and the next transition outwards
 
                   const double valCenter = lowOuterVal;
-
-                  const double valMin = aFeatureVals[0];
-                  const double valMax = aFeatureVals[cSamples - size_t{1}];
+                  NeighbourVals(cSamples, aFeatureVals, valCenter, &below, &above, &cBelow, &cAbove);
 
                   double* pCutsLowerBoundInclusive = cutsLowerBoundInclusiveOut;
-                  if(PREDICTABLE(valMin != valCenter)) {
+                  if(PREDICTABLE(size_t{0} != cBelow)) {
                      // there's a transition somewhere on the low side
                      EBM_ASSERT(std::numeric_limits<double>::lowest() < valCenter);
-                     EBM_ASSERT(valMin < valCenter);
-
-                     double valCur;
-                     do {
-                        --pLow;
-                        EBM_ASSERT(aFeatureVals <= pLow && pLow < aFeatureVals + cSamples);
-                        valCur = *pLow;
-                     } while(valCenter == valCur);
-                     EBM_ASSERT(valCur < valCenter);
+                     EBM_ASSERT(below < valCenter);
 
-                     const double avg = ArithmeticMean(valCur, valCenter);
+                     const double avg = ArithmeticMean(below, valCenter);
                      *pCutsLowerBoundInclusive = avg;
                      ++pCutsLowerBoundInclusive;
                      ++countCutsRet;
                   }
-                  if(PREDICTABLE(valMax != valCenter)) {
+                  if(PREDICTABLE(size_t{0} != cAbove)) {
                      // there's a transition somewhere on the high side
                      EBM_ASSERT(valCenter < std::numeric_limits<double>::max());
-                     EBM_ASSERT(valCenter < valMax);
+                     EBM_ASSERT(valCenter < above);
 
-                     double valCur;
-                     do {
-                        ++pHigh;
-                        EBM_ASSERT(aFeatureVals <= pHigh && pHigh < aFeatureVals + cSamples);
-                        valCur = *pHigh;
-                     } while(valCenter == valCur);
-                     EBM_ASSERT(valCenter < valCur);
-
-                     const double avg = ArithmeticMean(valCenter, valCur);
+                     const double avg = ArithmeticMean(valCenter, above);
                      *pCutsLowerBoundInclusive = avg;
                      ++countCutsRet;
                   }
                } else {
-                  // because lowVal != highVal, we know there's a transition that'll exit our loops somewhere in between
-
-                  double lowInnerVal;
-                  do {
-                     ++pLow;
-                     EBM_ASSERT(aFeatureVals <= pLow && pLow < aFeatureVals + cSamples);
-                     lowInnerVal = *pLow;
-                  } while(lowOuterVal == lowInnerVal);
+                  // because lowVal != highVal, we know there's a transition between them, so the next distinct
+                  // value above lowOuterVal exists and is at most highOuterVal
+
+                  NeighbourVals(cSamples, aFeatureVals, lowOuterVal, &below, &above, &cBelow, &cAbove);
+                  const double lowInnerVal = above;
                   EBM_ASSERT(std::numeric_limits<double>::lowest() < lowInnerVal);
                   EBM_ASSERT(lowOuterVal < lowInnerVal);
                   EBM_ASSERT(lowInnerVal <= highOuterVal);
@@ -281,12 +336,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
                      *cutsLowerBoundInclusiveOut = avg;
                      countCutsRet = IntEbm{1};
                   } else {
-                     double highInnerVal;
-                     do {
-                        --pHigh;
-                        EBM_ASSERT(aFeatureVals <= pHigh && pHigh < aFeatureVals + cSamples);
-                        highInnerVal = *pHigh;
-                     } while(highOuterVal == highInnerVal);
+                     NeighbourVals(cSamples, aFeatureVals, highOuterVal, &below, &above, &cBelow, &cAbove);
+                     double highInnerVal = below;
                      EBM_ASSERT(highInnerVal < std::numeric_limits<double>::max());
                      EBM_ASSERT(highInnerVal < highOuterVal);
                      EBM_ASSERT(lowInnerVal <= highInnerVal);
@@ -394,7 +445,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
                }
             }
          }
-         free(aFeatureVals);
          error = Error_None;
       }
 
@@ -416,4 +466,145 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
    return error;
 }
 
+// TODO: add this as a python/R option "winsorized"
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
+      IntEbm countSamples, const double* featureVals, IntEbm* countCutsInOut, double* cutsLowerBoundInclusiveOut) {
+   double* aFeatureVals = nullptr;
+   size_t cBytesFeatureVals = 0;
+   const ErrorEbm error = CutWinsorizedColumn(
+         countSamples, featureVals, countCutsInOut, cutsLowerBoundInclusiveOut, &aFeatureVals, &cBytesFeatureVals);
+   free(aFeatureVals);
+   return error;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutWinsorizedBatch(IntEbm countSamples,
+      IntEbm countColumns,
+      const double* featureVals,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut) {
+   LOG_N(Trace_Info,
+         "Entered CutWinsorizedBatch: "
+         "countSamples=%" IntEbmPrintf ", "
+         "countColumns=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "countCutsInOut=%p, "
+         "cutsLowerBoundInclusiveOut=%p",
+         countSamples,
+         countColumns,
+         static_cast<const void*>(featureVals),
+         static_cast<void*>(countCutsInOut),
+         static_cast<void*>(cutsLowerBoundInclusiveOut));
+
+   if(UNLIKELY(countColumns <= IntEbm{0})) {
+      if(UNLIKELY(countColumns < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR CutWinsorizedBatch countColumns < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countColumns))) {
+      LOG_0(Trace_Error, "ERROR CutWinsorizedBatch IsConvertError<size_t>(countColumns)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cColumns = static_cast<size_t>(countColumns);
+
+   if(UNLIKELY(countSamples < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR CutWinsorizedBatch countSamples < IntEbm { 0 }");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
+      LOG_0(Trace_Error, "ERROR CutWinsorizedBatch IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   if(UNLIKELY(IsMultiplyError(sizeof(double), cSamples, cColumns))) {
+      LOG_0(Trace_Error, "ERROR CutWinsorizedBatch IsMultiplyError(sizeof(double), cSamples, cColumns)");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(nullptr == countCutsInOut)) {
+      LOG_0(Trace_Error, "ERROR CutWinsorizedBatch nullptr == countCutsInOut");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(IsMultiplyError(sizeof(size_t), cColumns))) {
+      LOG_0(Trace_Warning, "WARNING CutWinsorizedBatch IsMultiplyError(sizeof(size_t), cColumns)");
+      return Error_OutOfMemory;
+   }
+   size_t* const aiCutsFirst = static_cast<size_t*>(malloc(sizeof(size_t) * cColumns));
+   if(UNLIKELY(nullptr == aiCutsFirst)) {
+      LOG_0(Trace_Warning, "WARNING CutWinsorizedBatch nullptr == aiCutsFirst");
+      return Error_OutOfMemory;
+   }
+
+   // same layout as CutQuantileBatch: column i writes its cuts at the sum of the countCutsInOut values of the
+   // columns before it, so take the offsets before any column overwrites its count with the number of cuts made
+   size_t cCutsTotal = 0;
+   for(size_t iColumn = 0; iColumn < cColumns; ++iColumn) {
+      aiCutsFirst[iColumn] = cCutsTotal;
+      const IntEbm countCuts = countCutsInOut[iColumn];
+      if(UNLIKELY(countCuts < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR CutWinsorizedBatch countCuts can't be negative.");
+         free(aiCutsFirst);
+         return Error_IllegalParamVal;
+      }
+      if(UNLIKELY(IsConvertError<size_t>(countCuts) || IsAddError(cCutsTotal, static_cast<size_t>(countCuts)))) {
+         LOG_0(Trace_Error, "ERROR CutWinsorizedBatch the total number of cuts does not fit into a size_t");
+         free(aiCutsFirst);
+         return Error_IllegalParamVal;
+      }
+      cCutsTotal += static_cast<size_t>(countCuts);
+   }
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cColumns, &pThreadPool);
+   if(Error_None != error) {
+      free(aiCutsFirst);
+      return error;
+   }
+   const size_t cThreads = pThreadPool->GetCountThreads();
+
+   // one sorted copy buffer per thread, reused by every column that the thread cuts
+   // this can't overflow since the ThreadPool already allocated at least this many std::thread objects
+   EBM_ASSERT(!IsMultiplyError(sizeof(double*) + sizeof(size_t), cThreads));
+   double** const aaFeatureVals = static_cast<double**>(malloc(sizeof(double*) * cThreads));
+   size_t* const acBytesFeatureVals = static_cast<size_t*>(malloc(sizeof(size_t) * cThreads));
+   if(UNLIKELY(nullptr == aaFeatureVals || nullptr == acBytesFeatureVals)) {
+      LOG_0(Trace_Warning, "WARNING CutWinsorizedBatch nullptr == aaFeatureVals || nullptr == acBytesFeatureVals");
+      free(acBytesFeatureVals);
+      free(aaFeatureVals);
+      ThreadPool::Return(pThreadPool);
+      free(aiCutsFirst);
+      return Error_OutOfMemory;
+   }
+   for(size_t iThread = 0; iThread < cThreads; ++iThread) {
+      aaFeatureVals[iThread] = nullptr;
+      acBytesFeatureVals[iThread] = 0;
+   }
+
+   auto cutColumn = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      EBM_ASSERT(iThread < cThreads);
+      return CutWinsorizedColumn(countSamples,
+            nullptr == featureVals ? nullptr : featureVals + cSamples * iTask,
+            &countCutsInOut[iTask],
+            nullptr == cutsLowerBoundInclusiveOut ? nullptr : cutsLowerBoundInclusiveOut + aiCutsFirst[iTask],
+            &aaFeatureVals[iThread],
+            &acBytesFeatureVals[iThread]);
+   };
+   error = pThreadPool->Run(cColumns, cutColumn);
+
+   for(size_t iThread = 0; iThread < cThreads; ++iThread) {
+      free(aaFeatureVals[iThread]);
+   }
+   free(acBytesFeatureVals);
+   free(aaFeatureVals);
+   ThreadPool::Return(pThreadPool);
+   free(aiCutsFirst);
+
+   LOG_N(Trace_Info, "Exited CutWinsorizedBatch: return=%" ErrorEbmPrintf, error);
+
+   return error;
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -5,7 +5,7 @@
 #include "pch.hpp"
 
 #include <stdlib.h> // free
-#include <stddef.h> // size_t, ptrdiff_t
+#include <stddef.h> // size_t, ptrdiff_t, offsetof
 
 #define ZONE_main
 #include "zones.h"
@@ -17,36 +17,70 @@
 #include "Term.hpp" // Term
 #include "dataset_shared.hpp" // UIntShared
 #include "DataSetBoosting.hpp"
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
-void DataSubsetBoosting::DestructDataSubsetBoosting(const size_t cTerms, const size_t cInnerBags) {
+void DataSubsetBoosting::DestructDataSubsetBoosting(
+      const size_t cTerms, const size_t cInnerBags, const bool bBorrowedData) {
    LOG_0(Trace_Info, "Entered DataSubsetBoosting::DestructDataSubsetBoosting");
 
-   InnerBag::FreeInnerBags(cInnerBags, m_aInnerBags);
+   // the subset's arrays came from the allocator of its objective's zone, which is only unset if we failed before
+   // allocating any of them
+   const ALIGNED_FREE_C pAlignedFree = nullptr == m_pObjective ? &AlignedFree : m_pObjective->m_pAlignedFreeC;
 
-   void** paTermData = m_aaTermData;
-   if(nullptr != paTermData) {
-      EBM_ASSERT(1 <= cTerms);
-      const void* const* const paTermDataEnd = paTermData + cTerms;
-      do {
-         AlignedFree(*paTermData);
-         ++paTermData;
-      } while(paTermDataEnd != paTermData);
-      free(m_aaTermData);
-   }
+   InnerBag::FreeInnerBags(cInnerBags, m_aInnerBags, pAlignedFree);
+
+   (*pAlignedFree)(m_aOutOfBagWeights);
+   (*pAlignedFree)(m_aSampleScores);
+   (*pAlignedFree)(m_aGradHess);
+
+   if(!bBorrowedData) {
+      SparseTermData** paSparseTermData = m_aaSparseTermData;
+      if(nullptr != paSparseTermData) {
+         EBM_ASSERT(1 <= cTerms);
+         const SparseTermData* const* const paSparseTermDataEnd = paSparseTermData + cTerms;
+         do {
+            free(*paSparseTermData);
+            ++paSparseTermData;
+         } while(paSparseTermDataEnd != paSparseTermData);
+         free(m_aaSparseTermData);
+      }
+
+      size_t** paiBlockedSamples = m_aaiBlockedSamples;
+      if(nullptr != paiBlockedSamples) {
+         EBM_ASSERT(1 <= cTerms);
+         const size_t* const* const paiBlockedSamplesEnd = paiBlockedSamples + cTerms;
+         do {
+            free(*paiBlockedSamples);
+            ++paiBlockedSamples;
+         } while(paiBlockedSamplesEnd != paiBlockedSamples);
+         free(m_aaiBlockedSamples);
+      }
+
+      void** paTermData = m_aaTermData;
+      if(nullptr != paTermData) {
+         EBM_ASSERT(1 <= cTerms);
+         const void* const* const paTermDataEnd = paTermData + cTerms;
+         do {
+            (*pAlignedFree)(*paTermData);
+            ++paTermData;
+         } while(paTermDataEnd != paTermData);
+         free(m_aaTermData);
+      }
+      free(m_acTermPacks);
 
-   AlignedFree(m_aTargetData);
-   AlignedFree(m_aSampleScores);
-   AlignedFree(m_aGradHess);
+      (*pAlignedFree)(m_aTargetData);
+   }
 
    LOG_0(Trace_Info, "Exited DataSubsetBoosting::DestructDataSubsetBoosting");
 }
 
-ErrorEbm DataSetBoosting::InitGradHess(const bool bAllocateHessians, const size_t cScores) {
+ErrorEbm DataSetBoosting::InitGradHess(
+      const bool bAllocateHessians, const bool bCompressGradients, const size_t cScores) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitGradHess");
 
    EBM_ASSERT(1 <= cScores);
@@ -67,21 +101,24 @@ ErrorEbm DataSetBoosting::InitGradHess(const bool bAllocateHessians, const size_
       EBM_ASSERT(1 <= cSubsetSamples);
 
       EBM_ASSERT(nullptr != pSubset->m_pObjective);
-      if(IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, cTotalScores, cSubsetSamples)) {
+      const size_t cBytesPerGradHess =
+            bCompressGradients ? sizeof(Bfloat16) : pSubset->m_pObjective->m_cFloatBytes;
+      if(IsMultiplyError(cBytesPerGradHess, cTotalScores, cSubsetSamples)) {
          LOG_0(Trace_Warning,
-               "WARNING DataSetBoosting::InitGradHess IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, "
-               "cTotalScores, cSubsetSamples)");
+               "WARNING DataSetBoosting::InitGradHess IsMultiplyError(cBytesPerGradHess, cTotalScores, "
+               "cSubsetSamples)");
          return Error_OutOfMemory;
       }
-      const size_t cBytesGradHess = pSubset->m_pObjective->m_cFloatBytes * cTotalScores * cSubsetSamples;
+      const size_t cBytesGradHess = cBytesPerGradHess * cTotalScores * cSubsetSamples;
       ANALYSIS_ASSERT(0 != cBytesGradHess);
 
-      void* const aGradHess = AlignedAlloc(cBytesGradHess);
+      void* const aGradHess = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytesGradHess);
       if(nullptr == aGradHess) {
          LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHess nullptr == aGradHess");
          return Error_OutOfMemory;
       }
       pSubset->m_aGradHess = aGradHess;
+      AddCountBytes(MemorySection_Gradients, cBytesGradHess);
 
       ++pSubset;
    } while(pSubsetsEnd != pSubset);
@@ -120,12 +157,13 @@ ErrorEbm DataSetBoosting::InitSampleScores(
          }
          const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cScores * cSubsetSamples;
          ANALYSIS_ASSERT(0 != cBytes);
-         void* pSampleScore = AlignedAlloc(cBytes);
+         void* pSampleScore = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
          if(nullptr == pSampleScore) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSampleScores nullptr == pSampleScore");
             return Error_OutOfMemory;
          }
          pSubset->m_aSampleScores = pSampleScore;
+         AddCountBytes(MemorySection_SampleScores, cBytes);
 
          memset(pSampleScore, 0, cBytes);
 
@@ -153,12 +191,13 @@ ErrorEbm DataSetBoosting::InitSampleScores(
          }
          const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cScores * cSubsetSamples;
          ANALYSIS_ASSERT(0 != cBytes);
-         void* pSampleScore = AlignedAlloc(cBytes);
+         void* pSampleScore = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
          if(nullptr == pSampleScore) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSampleScores nullptr == pSampleScore");
             return Error_OutOfMemory;
          }
          pSubset->m_aSampleScores = pSampleScore;
+         AddCountBytes(MemorySection_SampleScores, cBytes);
          const void* pSampleScoresEnd = IndexByte(pSampleScore, cBytes);
 
          do {
@@ -214,6 +253,42 @@ ErrorEbm DataSetBoosting::InitSampleScores(
 }
 WARNING_POP
 
+ErrorEbm DataSetBoosting::LocalizeSubset(
+      const size_t iSubset, const size_t cScores, const bool bHessian, const bool bCompressGradients) {
+   EBM_ASSERT(iSubset < m_cSubsets);
+   DataSubsetBoosting* const pSubset = &m_aSubsets[iSubset];
+   const ObjectiveWrapper* const pObjective = pSubset->m_pObjective;
+   EBM_ASSERT(nullptr != pObjective);
+   const size_t cSubsetSamples = pSubset->m_cSamples;
+
+   // InitGradHess and InitSampleScores already checked these sizes for overflow
+   if(nullptr != pSubset->m_aGradHess) {
+      const size_t cBytesGradHess = (bCompressGradients ? sizeof(Bfloat16) : pObjective->m_cFloatBytes) * cScores *
+            (bHessian ? size_t{2} : size_t{1}) * cSubsetSamples;
+      void* const aGradHess = (*pObjective->m_pAlignedAllocC)(cBytesGradHess);
+      if(nullptr == aGradHess) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::LocalizeSubset nullptr == aGradHess");
+         return Error_OutOfMemory;
+      }
+      // the gradients are not calculated yet, so zeroing is enough to touch every page
+      memset(aGradHess, 0, cBytesGradHess);
+      (*pObjective->m_pAlignedFreeC)(pSubset->m_aGradHess);
+      pSubset->m_aGradHess = aGradHess;
+   }
+   if(nullptr != pSubset->m_aSampleScores) {
+      const size_t cBytesSampleScores = pObjective->m_cFloatBytes * cScores * cSubsetSamples;
+      void* const aSampleScores = (*pObjective->m_pAlignedAllocC)(cBytesSampleScores);
+      if(nullptr == aSampleScores) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::LocalizeSubset nullptr == aSampleScores");
+         return Error_OutOfMemory;
+      }
+      memcpy(aSampleScores, pSubset->m_aSampleScores, cBytesSampleScores);
+      (*pObjective->m_pAlignedFreeC)(pSubset->m_aSampleScores);
+      pSubset->m_aSampleScores = aSampleScores;
+   }
+   return Error_None;
+}
+
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 ErrorEbm DataSetBoosting::InitTargetData(
@@ -244,19 +319,23 @@ ErrorEbm DataSetBoosting::InitTargetData(
          const size_t cSubsetSamples = pSubset->m_cSamples;
          EBM_ASSERT(1 <= cSubsetSamples);
 
-         if(IsMultiplyError(pSubset->m_pObjective->m_cUIntBytes, cSubsetSamples)) {
+         // m_cTargetBytes is either m_cUIntBytes or a single byte for objectives that only see the classes 0 and 1
+         const size_t cTargetBytes = pSubset->m_pObjective->m_cTargetBytes;
+         EBM_ASSERT(sizeof(uint8_t) == cTargetBytes || pSubset->m_pObjective->m_cUIntBytes == cTargetBytes);
+         EBM_ASSERT(sizeof(uint8_t) != cTargetBytes || cClasses <= ptrdiff_t{2});
+         if(IsMultiplyError(cTargetBytes, cSubsetSamples)) {
             LOG_0(Trace_Warning,
-                  "WARNING DataSetBoosting::InitTargetData IsMultiplyError(pSubset->m_pObjective->m_cUIntBytes, "
-                  "cSubsetSamples)");
+                  "WARNING DataSetBoosting::InitTargetData IsMultiplyError(cTargetBytes, cSubsetSamples)");
             return Error_OutOfMemory;
          }
-         const size_t cBytes = pSubset->m_pObjective->m_cUIntBytes * cSubsetSamples;
-         void* pTargetTo = AlignedAlloc(cBytes);
+         const size_t cBytes = cTargetBytes * cSubsetSamples;
+         void* pTargetTo = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
          if(nullptr == pTargetTo) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData nullptr == pTargetTo");
             return Error_OutOfMemory;
          }
          pSubset->m_aTargetData = pTargetTo;
+         AddCountBytes(MemorySection_Targets, cBytes);
          const void* const pTargetToEnd = IndexByte(pTargetTo, cBytes);
          do {
             if(BagEbm{0} == replication) {
@@ -290,13 +369,15 @@ ErrorEbm DataSetBoosting::InitTargetData(
                }
 #endif // NDEBUG
             }
-            if(sizeof(UIntBig) == pSubset->m_pObjective->m_cUIntBytes) {
+            if(sizeof(uint8_t) == cTargetBytes) {
+               *reinterpret_cast<uint8_t*>(pTargetTo) = static_cast<uint8_t>(iData);
+            } else if(sizeof(UIntBig) == cTargetBytes) {
                *reinterpret_cast<UIntBig*>(pTargetTo) = static_cast<UIntBig>(iData);
             } else {
-               EBM_ASSERT(sizeof(UIntSmall) == pSubset->m_pObjective->m_cUIntBytes);
+               EBM_ASSERT(sizeof(UIntSmall) == cTargetBytes);
                *reinterpret_cast<UIntSmall*>(pTargetTo) = static_cast<UIntSmall>(iData);
             }
-            pTargetTo = IndexByte(pTargetTo, pSubset->m_pObjective->m_cUIntBytes);
+            pTargetTo = IndexByte(pTargetTo, cTargetBytes);
 
             replication -= direction;
          } while(pTargetToEnd != pTargetTo);
@@ -317,12 +398,13 @@ ErrorEbm DataSetBoosting::InitTargetData(
             return Error_OutOfMemory;
          }
          const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
-         void* pTargetTo = AlignedAlloc(cBytes);
+         void* pTargetTo = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
          if(nullptr == pTargetTo) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData nullptr == pTargetTo");
             return Error_OutOfMemory;
          }
          pSubset->m_aTargetData = pTargetTo;
+         AddCountBytes(MemorySection_Targets, cBytes);
          const void* const pTargetToEnd = IndexByte(pTargetTo, cBytes);
          do {
             if(BagEbm{0} == replication) {
@@ -369,6 +451,11 @@ struct FeatureDimension {
    void operator delete(void*) = delete; // we only use malloc/free in this library
 
    const UIntShared* m_pFeatureDataFrom;
+   // external features read the caller's unpacked array instead of m_pFeatureDataFrom. m_cBytesExternal is zero
+   // for features that are bit packed within the shared dataset
+   const unsigned char* m_pExternalFrom;
+   size_t m_cBytesExternal;
+   size_t m_iBinExternalOffset;
    size_t m_maskBitsFrom;
    size_t m_cBins;
    int m_cItemsPerBitPackFrom;
@@ -388,7 +475,8 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
       const BagEbm* const aBag,
       const size_t cTerms,
       const Term* const* const apTerms,
-      const IntEbm* const aiTermFeatures) {
+      const IntEbm* const aiTermFeatures,
+      ThreadPool* const pThreadPool) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitTermData");
 
    EBM_ASSERT(nullptr != pDataSetShared);
@@ -396,24 +484,73 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
    EBM_ASSERT(1 <= cSharedSamples);
    EBM_ASSERT(1 <= cTerms);
    EBM_ASSERT(nullptr != apTerms);
+   EBM_ASSERT(nullptr != pThreadPool);
 
    EBM_ASSERT(nullptr != m_aSubsets);
    EBM_ASSERT(1 <= m_cSubsets);
    const DataSubsetBoosting* const pSubsetsEnd = m_aSubsets + m_cSubsets;
 
-   const bool isLoopValidation = direction < BagEbm{0};
-   const IntEbm* piTermFeature = aiTermFeatures;
-   size_t iTerm = 0;
+   size_t cSubsetSamplesMax = 0;
+   const DataSubsetBoosting* pSubsetMax = m_aSubsets;
    do {
+      cSubsetSamplesMax = EbmMax(cSubsetSamplesMax, pSubsetMax->GetCountSamples());
+      ++pSubsetMax;
+   } while(pSubsetsEnd != pSubsetMax);
+
+   // the terms are packed independently of each other, so each thread packs whole terms into its own scratch space.
+   // Subsets are limited to k_cSubsetSamplesMax samples, so this scratch space stays small, except for the training
+   // subsets of CreateBoosterFlags_MixedPrecision, which can be as large as k_cSubsetSamplesMixedMax
+   const size_t cThreads = pThreadPool->GetCountThreads();
+   if(IsMultiplyError(sizeof(size_t), cSubsetSamplesMax, cThreads)) {
+      LOG_0(Trace_Warning,
+            "WARNING DataSetBoosting::InitTermData IsMultiplyError(sizeof(size_t), cSubsetSamplesMax, cThreads)");
+      return Error_OutOfMemory;
+   }
+   size_t* const aTensorIndexesThreads = static_cast<size_t*>(malloc(sizeof(size_t) * cSubsetSamplesMax * cThreads));
+   if(nullptr == aTensorIndexesThreads) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData nullptr == aTensorIndexesThreads");
+      return Error_OutOfMemory;
+   }
+   // cThreads is smaller than cSubsetSamplesMax * cThreads, so this cannot overflow
+   size_t* const acBytesThreads = static_cast<size_t*>(malloc(sizeof(size_t) * cThreads));
+   if(nullptr == acBytesThreads) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData nullptr == acBytesThreads");
+      free(aTensorIndexesThreads);
+      return Error_OutOfMemory;
+   }
+   memset(acBytesThreads, 0, sizeof(size_t) * cThreads);
+
+   if(IsMultiplyError(sizeof(const IntEbm*), cTerms)) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData IsMultiplyError(sizeof(const IntEbm *), cTerms)");
+      free(acBytesThreads);
+      free(aTensorIndexesThreads);
+      return Error_OutOfMemory;
+   }
+   const IntEbm** const apiTermFeatures = static_cast<const IntEbm**>(malloc(sizeof(const IntEbm*) * cTerms));
+   if(nullptr == apiTermFeatures) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData nullptr == apiTermFeatures");
+      free(acBytesThreads);
+      free(aTensorIndexesThreads);
+      return Error_OutOfMemory;
+   }
+   const IntEbm* piTermFeatureNext = aiTermFeatures;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      apiTermFeatures[iTerm] = piTermFeatureNext;
+      // we need to check if there are zero dimensions since if there are then piTermFeatures could be nullptr
+      if(0 != apTerms[iTerm]->GetCountDimensions()) {
+         EBM_ASSERT(nullptr != piTermFeatureNext); // we would have exited when constructing the terms if nullptr
+         piTermFeatureNext += apTerms[iTerm]->GetCountDimensions();
+      }
+   }
+
+   const bool isLoopValidation = direction < BagEbm{0};
+   auto initTerm = [&](const size_t iTerm, const size_t iThread) -> ErrorEbm {
       const Term* const pTerm = apTerms[iTerm];
       EBM_ASSERT(nullptr != pTerm);
-      if(0 == pTerm->GetCountRealDimensions()) {
-         // we need to check if there are zero dimensions since if there are then piTermFeatures could be nullptr
-         if(0 != pTerm->GetCountDimensions()) {
-            EBM_ASSERT(nullptr != piTermFeature); // we would have exited when constructing the terms if nullptr
-            piTermFeature += pTerm->GetCountDimensions();
-         }
-      } else {
+      if(0 != pTerm->GetCountRealDimensions()) {
+         const IntEbm* piTermFeature = apiTermFeatures[iTerm];
+         size_t* const aTensorIndexes = &aTensorIndexesThreads[cSubsetSamplesMax * iThread];
+
          const TermFeature* pTermFeature = pTerm->GetTermFeatures();
          EBM_ASSERT(1 <= pTerm->GetCountDimensions());
          const TermFeature* const pTermFeaturesEnd = &pTermFeature[pTerm->GetCountDimensions()];
@@ -436,6 +573,7 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
                UIntShared cBinsUnused;
                UIntShared defaultValSparse;
                size_t cNonDefaultsSparse;
+               size_t cBytesExternal;
                const void* pFeatureDataFrom = GetDataSetSharedFeature(pDataSetShared,
                      iFeature,
                      &bMissing,
@@ -444,42 +582,57 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
                      &bSparse,
                      &cBinsUnused,
                      &defaultValSparse,
-                     &cNonDefaultsSparse);
+                     &cNonDefaultsSparse,
+                     &cBytesExternal);
                EBM_ASSERT(nullptr != pFeatureDataFrom);
                EBM_ASSERT(!bSparse); // we don't support sparse yet
 
                EBM_ASSERT(!IsConvertError<size_t>(cBinsUnused)); // since we previously extracted cBins and checked
                EBM_ASSERT(static_cast<size_t>(cBinsUnused) == cBins);
 
-               pDimensionInfoInit->m_pFeatureDataFrom = static_cast<const UIntShared*>(pFeatureDataFrom);
                pDimensionInfoInit->m_cBins = cBins;
-
-               const int cBitsRequiredMin = CountBitsRequired(cBins - size_t{1});
-               EBM_ASSERT(1 <= cBitsRequiredMin);
-               EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(UIntShared)); // comes from shared data set
-               EBM_ASSERT(cBitsRequiredMin <=
-                     COUNT_BITS(size_t)); // since cBins fits into size_t (previous call to GetDataSetSharedFeature)
-
-               const int cItemsPerBitPackFrom = GetCountItemsBitPacked<UIntShared>(cBitsRequiredMin);
-               EBM_ASSERT(1 <= cItemsPerBitPackFrom);
-               EBM_ASSERT(cItemsPerBitPackFrom <= COUNT_BITS(UIntShared));
-
-               const int cBitsPerItemMaxFrom = GetCountBits<UIntShared>(cItemsPerBitPackFrom);
-               EBM_ASSERT(1 <= cBitsPerItemMaxFrom);
-               EBM_ASSERT(cBitsPerItemMaxFrom <= COUNT_BITS(UIntShared));
-
-               // we can only guarantee that cBitsPerItemMaxFrom is less than or equal to COUNT_BITS(UIntShared)
-               // so we need to construct our mask in that type, but afterwards we can convert it to a
-               // size_t since we know the ultimate answer must fit into that since cBins fits into a size_t. If in
-               // theory UIntShared were allowed to be a billion bits, then the mask could be 65 bits while the end
-               // result would be forced to be 64 bits or less since we use the maximum number of bits per item possible
-               const size_t maskBitsFrom = static_cast<size_t>(MakeLowMask<UIntShared>(cBitsPerItemMaxFrom));
-
-               pDimensionInfoInit->m_cItemsPerBitPackFrom = cItemsPerBitPackFrom;
-               pDimensionInfoInit->m_cBitsPerItemMaxFrom = cBitsPerItemMaxFrom;
-               pDimensionInfoInit->m_maskBitsFrom = maskBitsFrom;
-               pDimensionInfoInit->m_iShiftFrom =
-                     static_cast<int>((cSharedSamples - size_t{1}) % static_cast<size_t>(cItemsPerBitPackFrom));
+               pDimensionInfoInit->m_cBytesExternal = cBytesExternal;
+               if(size_t{0} != cBytesExternal) {
+                  pDimensionInfoInit->m_pFeatureDataFrom = nullptr;
+                  pDimensionInfoInit->m_pExternalFrom = static_cast<const unsigned char*>(pFeatureDataFrom);
+                  pDimensionInfoInit->m_iBinExternalOffset = bMissing ? size_t{0} : size_t{1};
+                  pDimensionInfoInit->m_maskBitsFrom = 0;
+                  pDimensionInfoInit->m_cItemsPerBitPackFrom = 0;
+                  pDimensionInfoInit->m_cBitsPerItemMaxFrom = 0;
+                  pDimensionInfoInit->m_iShiftFrom = 0;
+               } else {
+                  pDimensionInfoInit->m_pFeatureDataFrom = static_cast<const UIntShared*>(pFeatureDataFrom);
+                  pDimensionInfoInit->m_pExternalFrom = nullptr;
+                  pDimensionInfoInit->m_iBinExternalOffset = 0;
+
+                  const int cBitsRequiredMin = CountBitsRequired(cBins - size_t{1});
+                  EBM_ASSERT(1 <= cBitsRequiredMin);
+                  EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(UIntShared)); // comes from shared data set
+                  EBM_ASSERT(cBitsRequiredMin <=
+                        COUNT_BITS(size_t)); // since cBins fits into size_t (previous call to GetDataSetSharedFeature)
+
+                  const int cItemsPerBitPackFrom = GetCountItemsBitPacked<UIntShared>(cBitsRequiredMin);
+                  EBM_ASSERT(1 <= cItemsPerBitPackFrom);
+                  EBM_ASSERT(cItemsPerBitPackFrom <= COUNT_BITS(UIntShared));
+
+                  const int cBitsPerItemMaxFrom = GetCountBits<UIntShared>(cItemsPerBitPackFrom);
+                  EBM_ASSERT(1 <= cBitsPerItemMaxFrom);
+                  EBM_ASSERT(cBitsPerItemMaxFrom <= COUNT_BITS(UIntShared));
+
+                  // we can only guarantee that cBitsPerItemMaxFrom is less than or equal to COUNT_BITS(UIntShared)
+                  // so we need to construct our mask in that type, but afterwards we can convert it to a
+                  // size_t since we know the ultimate answer must fit into that since cBins fits into a size_t. If
+                  // in theory UIntShared were allowed to be a billion bits, then the mask could be 65 bits while the
+                  // end result would be forced to be 64 bits or less since we use the maximum number of bits per item
+                  // possible
+                  const size_t maskBitsFrom = static_cast<size_t>(MakeLowMask<UIntShared>(cBitsPerItemMaxFrom));
+
+                  pDimensionInfoInit->m_cItemsPerBitPackFrom = cItemsPerBitPackFrom;
+                  pDimensionInfoInit->m_cBitsPerItemMaxFrom = cBitsPerItemMaxFrom;
+                  pDimensionInfoInit->m_maskBitsFrom = maskBitsFrom;
+                  pDimensionInfoInit->m_iShiftFrom =
+                        static_cast<int>((cSharedSamples - size_t{1}) % static_cast<size_t>(cItemsPerBitPackFrom));
+               }
 
                ++pDimensionInfoInit;
             }
@@ -495,23 +648,131 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
 
          DataSubsetBoosting* pSubset = m_aSubsets;
          do {
-            EBM_ASSERT(1 <= pTerm->GetBitsRequiredMin());
+            const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+            EBM_ASSERT(1 <= cSIMDPack);
+
+            const size_t cSubsetSamples = pSubset->GetCountSamples();
+            EBM_ASSERT(1 <= cSubsetSamples);
+            EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
+            EBM_ASSERT(cSubsetSamples <= cSubsetSamplesMax);
+
+            // extract the tensor indexes of the subset first since we can only choose how densely to pack them
+            // after we know the largest one
+            size_t iTensorMax = 0;
+            size_t* pTensorIndex = aTensorIndexes;
+            const size_t* const pTensorIndexesEnd = aTensorIndexes + cSubsetSamples;
+            do {
+               if(BagEbm{0} == replication) {
+                  replication = 1;
+                  if(nullptr != pSampleReplication) {
+                     const BagEbm* pSampleReplicationOriginal = pSampleReplication;
+                     bool isItemValidation;
+                     do {
+                        do {
+                           replication = *pSampleReplication;
+                           ++pSampleReplication;
+                        } while(BagEbm{0} == replication);
+                        isItemValidation = replication < BagEbm{0};
+                     } while(isLoopValidation != isItemValidation);
+                     const size_t cAdvances = pSampleReplication - pSampleReplicationOriginal - 1;
+                     if(0 != cAdvances) {
+                        FeatureDimension* pDimensionInfo = dimensionInfo;
+                        do {
+                           if(size_t{0} != pDimensionInfo->m_cBytesExternal) {
+                              // CheckDataSet verified the external array holds cSharedSamples items
+                              pDimensionInfo->m_pExternalFrom += cAdvances * pDimensionInfo->m_cBytesExternal;
+                           } else {
+                              const int cItemsPerBitPackFrom = pDimensionInfo->m_cItemsPerBitPackFrom;
+                              size_t cCompleteAdvanced = cAdvances / static_cast<size_t>(cItemsPerBitPackFrom);
+                              int iShiftFrom = pDimensionInfo->m_iShiftFrom;
+                              EBM_ASSERT(0 <= iShiftFrom);
+                              iShiftFrom -=
+                                    static_cast<int>(cAdvances % static_cast<size_t>(cItemsPerBitPackFrom));
+                              pDimensionInfo->m_iShiftFrom = iShiftFrom;
+                              if(iShiftFrom < 0) {
+                                 pDimensionInfo->m_iShiftFrom = iShiftFrom + cItemsPerBitPackFrom;
+                                 EBM_ASSERT(0 <= pDimensionInfo->m_iShiftFrom);
+                                 ++cCompleteAdvanced;
+                              }
+                              pDimensionInfo->m_pFeatureDataFrom += cCompleteAdvanced;
+                           }
+
+                           ++pDimensionInfo;
+                        } while(pDimensionInfoInit != pDimensionInfo);
+                     }
+                  }
+
+                  iTensor = 0;
+                  size_t tensorMultiple = 1;
+                  FeatureDimension* pDimensionInfo = dimensionInfo;
+                  do {
+                     size_t iFeatureBin;
+                     if(size_t{0} != pDimensionInfo->m_cBytesExternal) {
+                        const unsigned char* const pExternalFrom = pDimensionInfo->m_pExternalFrom;
+                        iFeatureBin = static_cast<size_t>(
+                              GetExternalBinIndex(pExternalFrom, pDimensionInfo->m_cBytesExternal, 0)) -
+                              pDimensionInfo->m_iBinExternalOffset;
+                        pDimensionInfo->m_pExternalFrom = pExternalFrom + pDimensionInfo->m_cBytesExternal;
+                     } else {
+                        const UIntShared* const pFeatureDataFrom = pDimensionInfo->m_pFeatureDataFrom;
+                        const UIntShared bitsFrom = *pFeatureDataFrom;
+
+                        int iShiftFrom = pDimensionInfo->m_iShiftFrom;
+                        EBM_ASSERT(0 <= iShiftFrom);
+                        EBM_ASSERT(iShiftFrom * pDimensionInfo->m_cBitsPerItemMaxFrom < COUNT_BITS(UIntShared));
+                        iFeatureBin = static_cast<size_t>(
+                                            bitsFrom >> (iShiftFrom * pDimensionInfo->m_cBitsPerItemMaxFrom)) &
+                              pDimensionInfo->m_maskBitsFrom;
+
+                        --iShiftFrom;
+                        pDimensionInfo->m_iShiftFrom = iShiftFrom;
+                        if(iShiftFrom < 0) {
+                           EBM_ASSERT(-1 == iShiftFrom);
+                           pDimensionInfo->m_iShiftFrom = iShiftFrom + pDimensionInfo->m_cItemsPerBitPackFrom;
+                           pDimensionInfo->m_pFeatureDataFrom = pFeatureDataFrom + 1;
+                        }
+                     }
+
+                     // we check our dataSet when we get the header, and cBins has been checked to fit into size_t
+                     EBM_ASSERT(iFeatureBin < pDimensionInfo->m_cBins);
+
+                     // we check for overflows during Term construction, but let's check here again
+                     EBM_ASSERT(!IsMultiplyError(tensorMultiple, pDimensionInfo->m_cBins));
+
+                     // this can't overflow if the multiplication below doesn't overflow, and we checked for that
+                     // above
+                     iTensor += tensorMultiple * iFeatureBin;
+                     tensorMultiple *= pDimensionInfo->m_cBins;
+
+                     ++pDimensionInfo;
+                  } while(pDimensionInfoInit != pDimensionInfo);
+
+                  EBM_ASSERT(iTensor < pTerm->GetCountTensorBins());
+               }
+
+               EBM_ASSERT(0 != replication);
+               EBM_ASSERT(0 < replication && 0 < direction || replication < 0 && direction < 0);
+               replication -= direction;
+
+               iTensorMax = EbmMax(iTensorMax, iTensor);
+               *pTensorIndex = iTensor;
+               ++pTensorIndex;
+            } while(pTensorIndexesEnd != pTensorIndex);
+
+            // a subset that does not reach the highest bins of the term can use fewer bits per item than the term
+            // requires, and we keep at least 1 bit so that every term with dimensions remains packed
+            const int cBitsRequired = EbmMax(1, CountBitsRequired(iTensorMax));
+            EBM_ASSERT(cBitsRequired <= pTerm->GetBitsRequiredMin());
             const int cItemsPerBitPackTo =
-                  GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+                  GetCountItemsBitPacked(cBitsRequired, pSubset->GetObjectiveWrapper()->m_cUIntBytes);
             EBM_ASSERT(1 <= cItemsPerBitPackTo);
             ANALYSIS_ASSERT(0 != cItemsPerBitPackTo);
+            pSubset->m_acTermPacks[iTerm] = cItemsPerBitPackTo;
 
             const int cBitsPerItemMaxTo =
                   GetCountBits(cItemsPerBitPackTo, pSubset->GetObjectiveWrapper()->m_cUIntBytes);
             EBM_ASSERT(1 <= cBitsPerItemMaxTo);
 
-            const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
-            EBM_ASSERT(1 <= cSIMDPack);
-
-            const size_t cSubsetSamples = pSubset->GetCountSamples();
-            EBM_ASSERT(1 <= cSubsetSamples);
-            EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
-
             size_t cParallelSamples = cSubsetSamples / cSIMDPack;
             EBM_ASSERT(1 <= cParallelSamples);
 
@@ -526,15 +787,17 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
                return Error_OutOfMemory;
             }
             const size_t cBytes = pSubset->GetObjectiveWrapper()->m_cUIntBytes * cDataUnitsTo;
-            void* pTermDataTo = AlignedAlloc(cBytes);
+            void* pTermDataTo = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
             if(nullptr == pTermDataTo) {
                LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData nullptr == pTermDataTo");
                return Error_OutOfMemory;
             }
             pSubset->m_aaTermData[iTerm] = pTermDataTo;
+            acBytesThreads[iThread] += cBytes;
 
             memset(pTermDataTo, 0, cBytes);
 
+            pTensorIndex = aTensorIndexes;
             int cShiftTo =
                   static_cast<int>(cParallelSamples % static_cast<size_t>(cItemsPerBitPackTo)) * cBitsPerItemMaxTo;
             const int cShiftResetTo = (cItemsPerBitPackTo - 1) * cBitsPerItemMaxTo;
@@ -542,90 +805,16 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
                do {
                   size_t iPartition = 0;
                   do {
-                     if(BagEbm{0} == replication) {
-                        replication = 1;
-                        if(nullptr != pSampleReplication) {
-                           const BagEbm* pSampleReplicationOriginal = pSampleReplication;
-                           bool isItemValidation;
-                           do {
-                              do {
-                                 replication = *pSampleReplication;
-                                 ++pSampleReplication;
-                              } while(BagEbm{0} == replication);
-                              isItemValidation = replication < BagEbm{0};
-                           } while(isLoopValidation != isItemValidation);
-                           const size_t cAdvances = pSampleReplication - pSampleReplicationOriginal - 1;
-                           if(0 != cAdvances) {
-                              FeatureDimension* pDimensionInfo = dimensionInfo;
-                              do {
-                                 const int cItemsPerBitPackFrom = pDimensionInfo->m_cItemsPerBitPackFrom;
-                                 size_t cCompleteAdvanced = cAdvances / static_cast<size_t>(cItemsPerBitPackFrom);
-                                 int iShiftFrom = pDimensionInfo->m_iShiftFrom;
-                                 EBM_ASSERT(0 <= iShiftFrom);
-                                 iShiftFrom -= static_cast<int>(cAdvances % static_cast<size_t>(cItemsPerBitPackFrom));
-                                 pDimensionInfo->m_iShiftFrom = iShiftFrom;
-                                 if(iShiftFrom < 0) {
-                                    pDimensionInfo->m_iShiftFrom = iShiftFrom + cItemsPerBitPackFrom;
-                                    EBM_ASSERT(0 <= pDimensionInfo->m_iShiftFrom);
-                                    ++cCompleteAdvanced;
-                                 }
-                                 pDimensionInfo->m_pFeatureDataFrom += cCompleteAdvanced;
-
-                                 ++pDimensionInfo;
-                              } while(pDimensionInfoInit != pDimensionInfo);
-                           }
-                        }
-
-                        iTensor = 0;
-                        size_t tensorMultiple = 1;
-                        FeatureDimension* pDimensionInfo = dimensionInfo;
-                        do {
-                           const UIntShared* const pFeatureDataFrom = pDimensionInfo->m_pFeatureDataFrom;
-                           const UIntShared bitsFrom = *pFeatureDataFrom;
-
-                           int iShiftFrom = pDimensionInfo->m_iShiftFrom;
-                           EBM_ASSERT(0 <= iShiftFrom);
-                           EBM_ASSERT(iShiftFrom * pDimensionInfo->m_cBitsPerItemMaxFrom < COUNT_BITS(UIntShared));
-                           const size_t iFeatureBin =
-                                 static_cast<size_t>(bitsFrom >> (iShiftFrom * pDimensionInfo->m_cBitsPerItemMaxFrom)) &
-                                 pDimensionInfo->m_maskBitsFrom;
-
-                           // we check our dataSet when we get the header, and cBins has been checked to fit into size_t
-                           EBM_ASSERT(iFeatureBin < pDimensionInfo->m_cBins);
-
-                           --iShiftFrom;
-                           pDimensionInfo->m_iShiftFrom = iShiftFrom;
-                           if(iShiftFrom < 0) {
-                              EBM_ASSERT(-1 == iShiftFrom);
-                              pDimensionInfo->m_iShiftFrom = iShiftFrom + pDimensionInfo->m_cItemsPerBitPackFrom;
-                              pDimensionInfo->m_pFeatureDataFrom = pFeatureDataFrom + 1;
-                           }
-
-                           // we check for overflows during Term construction, but let's check here again
-                           EBM_ASSERT(!IsMultiplyError(tensorMultiple, pDimensionInfo->m_cBins));
-
-                           // this can't overflow if the multiplication below doesn't overflow, and we checked for that
-                           // above
-                           iTensor += tensorMultiple * iFeatureBin;
-                           tensorMultiple *= pDimensionInfo->m_cBins;
-
-                           ++pDimensionInfo;
-                        } while(pDimensionInfoInit != pDimensionInfo);
-
-                        EBM_ASSERT(iTensor < pTerm->GetCountTensorBins());
-                     }
-
-                     EBM_ASSERT(0 != replication);
-                     EBM_ASSERT(0 < replication && 0 < direction || replication < 0 && direction < 0);
-                     replication -= direction;
+                     const size_t iTensorTo = *pTensorIndex;
+                     ++pTensorIndex;
 
                      EBM_ASSERT(0 <= cShiftTo);
                      if(sizeof(UIntBig) == pSubset->m_pObjective->m_cUIntBytes) {
-                        *(reinterpret_cast<UIntBig*>(pTermDataTo) + iPartition) |= static_cast<UIntBig>(iTensor)
+                        *(reinterpret_cast<UIntBig*>(pTermDataTo) + iPartition) |= static_cast<UIntBig>(iTensorTo)
                               << cShiftTo;
                      } else {
                         EBM_ASSERT(sizeof(UIntSmall) == pSubset->m_pObjective->m_cUIntBytes);
-                        *(reinterpret_cast<UIntSmall*>(pTermDataTo) + iPartition) |= static_cast<UIntSmall>(iTensor)
+                        *(reinterpret_cast<UIntSmall*>(pTermDataTo) + iPartition) |= static_cast<UIntSmall>(iTensorTo)
                               << cShiftTo;
                      }
 
@@ -650,14 +839,367 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
          } while(pSubsetsEnd != pSubset);
          EBM_ASSERT(0 == replication);
       }
-      ++iTerm;
-   } while(cTerms != iTerm);
+      return Error_None;
+   };
+   const ErrorEbm error = pThreadPool->Run(cTerms, initTerm);
+
+   for(size_t iThread = 0; iThread < cThreads; ++iThread) {
+      AddCountBytes(MemorySection_TermData, acBytesThreads[iThread]);
+   }
+   free(apiTermFeatures);
+   free(acBytesThreads);
+   free(aTensorIndexesThreads);
+
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
 
    LOG_0(Trace_Info, "Exited DataSetBoosting::InitTermData");
    return Error_None;
 }
 WARNING_POP
 
+// a single feature term is only stored sparsely if at most 1 in this many samples fall outside of the default bin.
+// Below that the collapsed pass over the gradients plus the scattered non-default samples is no longer a win
+static constexpr size_t k_sparseNonDefaultsDivisor = 10;
+
+template<typename TFunc>
+static void VisitTermData(const DataSubsetBoosting* const pSubset,
+      const size_t iTerm,
+      const Term* const pTerm,
+      const void* pTermData,
+      const TFunc& func) {
+   // calls func(iSample, iTensor) for every sample in the subset in the order that the gradients are stored
+   UNUSED(pTerm); // only the debug checks of the tensor indexes use it
+   const size_t cUIntBytes = pSubset->GetObjectiveWrapper()->m_cUIntBytes;
+   const int cItemsPerBitPack = pSubset->GetTermPack(iTerm);
+   EBM_ASSERT(1 <= cItemsPerBitPack);
+   ANALYSIS_ASSERT(0 != cItemsPerBitPack);
+
+   const int cBitsPerItemMax = GetCountBits(cItemsPerBitPack, cUIntBytes);
+   EBM_ASSERT(1 <= cBitsPerItemMax);
+
+   const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+   EBM_ASSERT(1 <= cSIMDPack);
+
+   const size_t cSubsetSamples = pSubset->GetCountSamples();
+   EBM_ASSERT(1 <= cSubsetSamples);
+   EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
+
+   size_t cParallelSamples = cSubsetSamples / cSIMDPack;
+
+   size_t maskBits;
+   if(sizeof(UIntBig) == cUIntBytes) {
+      maskBits = static_cast<size_t>(MakeLowMask<UIntBig>(cBitsPerItemMax));
+   } else {
+      EBM_ASSERT(sizeof(UIntSmall) == cUIntBytes);
+      maskBits = static_cast<size_t>(MakeLowMask<UIntSmall>(cBitsPerItemMax));
+   }
+
+   const int cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
+   int cShift = static_cast<int>(cParallelSamples % static_cast<size_t>(cItemsPerBitPack)) * cBitsPerItemMax;
+
+   size_t iSample = 0;
+   while(true) {
+      do {
+         size_t iPartition = 0;
+         do {
+            size_t iTensor;
+            EBM_ASSERT(0 <= cShift);
+            if(sizeof(UIntBig) == cUIntBytes) {
+               iTensor = maskBits & static_cast<size_t>(*(reinterpret_cast<const UIntBig*>(pTermData) + iPartition) >>
+                                          cShift);
+            } else {
+               iTensor = maskBits & static_cast<size_t>(
+                                          *(reinterpret_cast<const UIntSmall*>(pTermData) + iPartition) >> cShift);
+            }
+            EBM_ASSERT(iTensor < pTerm->GetCountTensorBins());
+
+            func(iSample, iTensor);
+
+            ++iSample;
+            ++iPartition;
+         } while(cSIMDPack != iPartition);
+
+         --cParallelSamples;
+         if(0 == cParallelSamples) {
+            EBM_ASSERT(cSubsetSamples == iSample);
+            return;
+         }
+
+         cShift -= cBitsPerItemMax;
+      } while(0 <= cShift);
+      cShift = cShiftReset;
+
+      pTermData = IndexByte(pTermData, cUIntBytes * cSIMDPack);
+   }
+}
+
+ErrorEbm DataSetBoosting::InitSparseTermData(
+      const size_t cTerms, const Term* const* const apTerms, ThreadPool* const pThreadPool) {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::InitSparseTermData");
+
+   EBM_ASSERT(1 <= cTerms);
+   EBM_ASSERT(nullptr != apTerms);
+   EBM_ASSERT(nullptr != pThreadPool);
+
+   EBM_ASSERT(nullptr != m_aSubsets);
+   EBM_ASSERT(1 <= m_cSubsets);
+   DataSubsetBoosting* pSubset = m_aSubsets;
+   const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_cSubsets;
+   do {
+      if(IsMultiplyError(sizeof(SparseTermData*), cTerms)) {
+         LOG_0(Trace_Warning,
+               "WARNING DataSetBoosting::InitSparseTermData IsMultiplyError(sizeof(SparseTermData *), cTerms)");
+         return Error_OutOfMemory;
+      }
+      SparseTermData** const aaSparseTermData = static_cast<SparseTermData**>(malloc(sizeof(SparseTermData*) * cTerms));
+      if(nullptr == aaSparseTermData) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSparseTermData nullptr == aaSparseTermData");
+         return Error_OutOfMemory;
+      }
+      pSubset->m_aaSparseTermData = aaSparseTermData;
+
+      size_t iTerm = 0;
+      do {
+         aaSparseTermData[iTerm] = nullptr;
+         ++iTerm;
+      } while(cTerms != iTerm);
+
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+
+   const size_t cThreads = pThreadPool->GetCountThreads();
+   size_t* const acBytesThreads = static_cast<size_t*>(malloc(sizeof(size_t) * cThreads));
+   if(nullptr == acBytesThreads) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSparseTermData nullptr == acBytesThreads");
+      return Error_OutOfMemory;
+   }
+   memset(acBytesThreads, 0, sizeof(size_t) * cThreads);
+
+   // each term of each subset is independent of the others
+   auto initTerm = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      const size_t iTerm = iTask / m_cSubsets;
+      DataSubsetBoosting* const pSubset = &m_aSubsets[iTask % m_cSubsets];
+      SparseTermData** const aaSparseTermData = pSubset->m_aaSparseTermData;
+      const size_t cSubsetSamples = pSubset->GetCountSamples();
+      const Term* const pTerm = apTerms[iTerm];
+      EBM_ASSERT(nullptr != pTerm);
+      // total minus the non-default samples only works out cleanly when each tensor bin is one feature bin
+      if(1 == pTerm->GetCountRealDimensions()) {
+         const size_t cTensorBins = pTerm->GetCountTensorBins();
+         EBM_ASSERT(2 <= cTensorBins);
+         const void* const pTermData = pSubset->m_aaTermData[iTerm];
+         EBM_ASSERT(nullptr != pTermData);
+
+         if(IsMultiplyError(sizeof(size_t), cTensorBins)) {
+            LOG_0(Trace_Warning,
+                  "WARNING DataSetBoosting::InitSparseTermData IsMultiplyError(sizeof(size_t), cTensorBins)");
+            return Error_OutOfMemory;
+         }
+         size_t* const aBinCounts = static_cast<size_t*>(malloc(sizeof(size_t) * cTensorBins));
+         if(nullptr == aBinCounts) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSparseTermData nullptr == aBinCounts");
+            return Error_OutOfMemory;
+         }
+         memset(aBinCounts, 0, sizeof(size_t) * cTensorBins);
+
+         VisitTermData(pSubset, iTerm, pTerm, pTermData, [aBinCounts](const size_t iSample, const size_t iTensor) {
+            UNUSED(iSample);
+            ++aBinCounts[iTensor];
+         });
+
+         size_t iTensorDefault = 0;
+         for(size_t iTensor = 1; iTensor < cTensorBins; ++iTensor) {
+            if(aBinCounts[iTensorDefault] < aBinCounts[iTensor]) {
+               iTensorDefault = iTensor;
+            }
+         }
+         const size_t cNonDefaults = cSubsetSamples - aBinCounts[iTensorDefault];
+         free(aBinCounts);
+
+         if(cNonDefaults <= cSubsetSamples / k_sparseNonDefaultsDivisor) {
+            const size_t cBytesHeader = offsetof(SparseTermData, m_aNonDefaults);
+            // cNonDefaults is less than cSubsetSamples, which we have already allocated gradients for
+            const size_t cBytes = cBytesHeader + sizeof(SparseTermEntry) * cNonDefaults;
+            SparseTermData* const pSparseTermData = static_cast<SparseTermData*>(malloc(cBytes));
+            if(nullptr == pSparseTermData) {
+               LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSparseTermData nullptr == pSparseTermData");
+               return Error_OutOfMemory;
+            }
+            aaSparseTermData[iTerm] = pSparseTermData;
+            acBytesThreads[iThread] += cBytes;
+
+            pSparseTermData->m_iTensorDefault = iTensorDefault;
+            pSparseTermData->m_cNonDefaults = cNonDefaults;
+
+            SparseTermEntry* pNonDefault = pSparseTermData->GetNonDefaults();
+            VisitTermData(pSubset,
+                  iTerm,
+                  pTerm,
+                  pTermData,
+                  [iTensorDefault, &pNonDefault](const size_t iSample, const size_t iTensor) {
+                     if(iTensorDefault != iTensor) {
+                        pNonDefault->m_iSample = iSample;
+                        pNonDefault->m_iTensor = iTensor;
+                        ++pNonDefault;
+                     }
+                  });
+            EBM_ASSERT(pSparseTermData->GetNonDefaults() + cNonDefaults == pNonDefault);
+         }
+      }
+      return Error_None;
+   };
+   // m_cSubsets * cTerms cannot overflow since every subset has an array of cTerms pointers
+   const ErrorEbm error = pThreadPool->Run(m_cSubsets * cTerms, initTerm);
+
+   for(size_t iThread = 0; iThread < cThreads; ++iThread) {
+      AddCountBytes(MemorySection_TermData, acBytesThreads[iThread]);
+   }
+   free(acBytesThreads);
+
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   LOG_0(Trace_Info, "Exited DataSetBoosting::InitSparseTermData");
+   return Error_None;
+}
+
+extern size_t GetL1DataCacheBytes();
+
+ErrorEbm DataSetBoosting::InitBlockedSamples(
+      const size_t cTerms, const Term* const* const apTerms, ThreadPool* const pThreadPool) {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::InitBlockedSamples");
+
+   EBM_ASSERT(1 <= cTerms);
+   EBM_ASSERT(nullptr != apTerms);
+   EBM_ASSERT(nullptr != pThreadPool);
+
+   EBM_ASSERT(nullptr != m_aSubsets);
+   EBM_ASSERT(1 <= m_cSubsets);
+   DataSubsetBoosting* pSubset = m_aSubsets;
+   const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_cSubsets;
+   do {
+      if(IsMultiplyError(sizeof(size_t*), cTerms)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBlockedSamples IsMultiplyError(sizeof(size_t *), cTerms)");
+         return Error_OutOfMemory;
+      }
+      size_t** const aaiBlockedSamples = static_cast<size_t**>(malloc(sizeof(size_t*) * cTerms));
+      if(nullptr == aaiBlockedSamples) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBlockedSamples nullptr == aaiBlockedSamples");
+         return Error_OutOfMemory;
+      }
+      pSubset->m_aaiBlockedSamples = aaiBlockedSamples;
+
+      size_t iTerm = 0;
+      do {
+         aaiBlockedSamples[iTerm] = nullptr;
+         ++iTerm;
+      } while(cTerms != iTerm);
+
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+
+   const size_t cThreads = pThreadPool->GetCountThreads();
+   size_t* const acBytesThreads = static_cast<size_t*>(malloc(sizeof(size_t) * cThreads));
+   if(nullptr == acBytesThreads) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBlockedSamples nullptr == acBytesThreads");
+      return Error_OutOfMemory;
+   }
+   memset(acBytesThreads, 0, sizeof(size_t) * cThreads);
+
+   const size_t cL1DataCacheBytes = GetL1DataCacheBytes();
+
+   // each term of each subset is independent of the others
+   auto initTerm = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      const size_t iTerm = iTask / m_cSubsets;
+      DataSubsetBoosting* const pSubset = &m_aSubsets[iTask % m_cSubsets];
+      size_t** const aaiBlockedSamples = pSubset->m_aaiBlockedSamples;
+      const size_t cSubsetSamples = pSubset->GetCountSamples();
+
+      // The booster does not know yet how many scores or whether it needs hessians, so we size the blocks for the
+      // smallest bins that hold a gradient and a hessian. Half of the L1 data cache is left for the streaming reads.
+      const size_t cBytesPerBin = size_t{2} * pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+      const size_t cBinsPerBlock = cL1DataCacheBytes / size_t{2} / cBytesPerBin;
+      EBM_ASSERT(1 <= cBinsPerBlock);
+
+      const Term* const pTerm = apTerms[iTerm];
+      EBM_ASSERT(nullptr != pTerm);
+      const size_t cTensorBins = pTerm->GetCountTensorBins();
+      // sparse terms already avoid scattering into the default bin, which holds nearly all of their samples
+      if(cBinsPerBlock < cTensorBins && nullptr == pSubset->GetSparseTermData(iTerm)) {
+         const void* const pTermData = pSubset->m_aaTermData[iTerm];
+         EBM_ASSERT(nullptr != pTermData);
+
+         const size_t cBlocks = (cTensorBins - size_t{1}) / cBinsPerBlock + size_t{1};
+         size_t* const aBlockPositions = static_cast<size_t*>(malloc(sizeof(size_t) * cBlocks));
+         if(nullptr == aBlockPositions) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBlockedSamples nullptr == aBlockPositions");
+            return Error_OutOfMemory;
+         }
+         memset(aBlockPositions, 0, sizeof(size_t) * cBlocks);
+
+         VisitTermData(pSubset,
+               iTerm,
+               pTerm,
+               pTermData,
+               [aBlockPositions, cBinsPerBlock](const size_t iSample, const size_t iTensor) {
+                  UNUSED(iSample);
+                  ++aBlockPositions[iTensor / cBinsPerBlock];
+               });
+
+         // each block starts where the samples of the blocks before it end
+         size_t iPosition = 0;
+         for(size_t iBlock = 0; iBlock < cBlocks; ++iBlock) {
+            const size_t cBlockSamples = aBlockPositions[iBlock];
+            aBlockPositions[iBlock] = iPosition;
+            iPosition += cBlockSamples;
+         }
+         EBM_ASSERT(cSubsetSamples == iPosition);
+
+         // we have already allocated gradients for cSubsetSamples, so this cannot overflow
+         size_t* const aiBlockedSamples = static_cast<size_t*>(malloc(sizeof(size_t) * cSubsetSamples));
+         if(nullptr == aiBlockedSamples) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBlockedSamples nullptr == aiBlockedSamples");
+            free(aBlockPositions);
+            return Error_OutOfMemory;
+         }
+         aaiBlockedSamples[iTerm] = aiBlockedSamples;
+         acBytesThreads[iThread] += sizeof(size_t) * cSubsetSamples;
+
+         // visiting in sample order keeps the samples within each block ascending, so each bin sums its samples in
+         // the same order as the unblocked kernel and the gradient reads of each block move forward through memory
+         VisitTermData(pSubset,
+               iTerm,
+               pTerm,
+               pTermData,
+               [aBlockPositions, cBinsPerBlock, aiBlockedSamples](const size_t iSample, const size_t iTensor) {
+                  aiBlockedSamples[aBlockPositions[iTensor / cBinsPerBlock]++] = iSample;
+               });
+         free(aBlockPositions);
+      }
+      return Error_None;
+   };
+   // m_cSubsets * cTerms cannot overflow since every subset has an array of cTerms pointers
+   const ErrorEbm error = pThreadPool->Run(m_cSubsets * cTerms, initTerm);
+
+   for(size_t iThread = 0; iThread < cThreads; ++iThread) {
+      AddCountBytes(MemorySection_TermData, acBytesThreads[iThread]);
+   }
+   free(acBytesThreads);
+
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   LOG_0(Trace_Info, "Exited DataSetBoosting::InitBlockedSamples");
+   return Error_None;
+}
+
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 ErrorEbm DataSetBoosting::CopyWeights(
@@ -688,6 +1230,7 @@ ErrorEbm DataSetBoosting::CopyWeights(
       return Error_OutOfMemory;
    }
    m_aOriginalWeights = pWeightTo;
+   AddCountBytes(MemorySection_Weights, sizeof(FloatShared) * m_cSamples);
 
    const FloatShared* const pWeightsToEnd = &pWeightTo[m_cSamples];
    do {
@@ -727,11 +1270,82 @@ ErrorEbm DataSetBoosting::CopyWeights(
 }
 WARNING_POP
 
+WARNING_PUSH
+WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
+ErrorEbm DataSetBoosting::CopyTargets(
+      const unsigned char* const pDataSetShared, const BagEbm direction, const BagEbm* const aBag) {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::CopyTargets");
+
+   EBM_ASSERT(nullptr != pDataSetShared);
+   EBM_ASSERT(BagEbm{-1} == direction || BagEbm{1} == direction);
+   EBM_ASSERT(1 <= m_cSamples);
+
+   ptrdiff_t cClasses;
+   const FloatShared* pTargetFrom =
+         static_cast<const FloatShared*>(GetDataSetSharedTarget(pDataSetShared, 0, &cClasses));
+   EBM_ASSERT(nullptr != pTargetFrom); // we previously called GetDataSetSharedTarget and got back non-null result
+   EBM_ASSERT(ptrdiff_t{Task_Regression} == cClasses);
+
+   const bool isLoopValidation = direction < BagEbm{0};
+   EBM_ASSERT(nullptr != aBag || !isLoopValidation); // if aBag is nullptr then we have no validation samples
+
+   const BagEbm* pSampleReplication = aBag;
+
+   BagEbm replication = 0;
+   FloatShared target;
+   if(IsMultiplyError(sizeof(FloatShared), m_cSamples)) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::CopyTargets IsMultiplyError(sizeof(FloatShared), m_cSamples)");
+      return Error_OutOfMemory;
+   }
+   FloatShared* pTargetTo = reinterpret_cast<FloatShared*>(malloc(sizeof(FloatShared) * m_cSamples));
+   if(nullptr == pTargetTo) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::CopyTargets nullptr == pTargetTo");
+      return Error_OutOfMemory;
+   }
+   m_aOriginalTargets = pTargetTo;
+   AddCountBytes(MemorySection_Targets, sizeof(FloatShared) * m_cSamples);
+
+   const FloatShared* const pTargetsToEnd = &pTargetTo[m_cSamples];
+   do {
+      if(BagEbm{0} == replication) {
+         replication = 1;
+         if(nullptr != pSampleReplication) {
+            bool isItemValidation;
+            do {
+               do {
+                  replication = *pSampleReplication;
+                  ++pSampleReplication;
+                  ++pTargetFrom;
+               } while(BagEbm{0} == replication);
+               isItemValidation = replication < BagEbm{0};
+            } while(isLoopValidation != isItemValidation);
+            --pTargetFrom;
+         }
+
+         target = *pTargetFrom;
+         ++pTargetFrom;
+      }
+
+      *pTargetTo = target;
+      ++pTargetTo;
+
+      replication -= direction;
+   } while(pTargetsToEnd != pTargetTo);
+   EBM_ASSERT(0 == replication);
+
+   LOG_0(Trace_Info, "Exited DataSetBoosting::CopyTargets");
+   return Error_None;
+}
+WARNING_POP
+
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 WARNING_DISABLE_UNINITIALIZED_LOCAL_POINTER
-ErrorEbm DataSetBoosting::InitBags(
-      void* const rng, const size_t cInnerBags, const size_t cTerms, const Term* const* const apTerms) {
+ErrorEbm DataSetBoosting::InitBags(void* const rng,
+      const uint8_t* const aFoldMask,
+      const size_t cInnerBags,
+      const size_t cTerms,
+      const Term* const* const apTerms) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitBags");
 
    EBM_ASSERT(1 <= cTerms);
@@ -740,6 +1354,18 @@ ErrorEbm DataSetBoosting::InitBags(
    const size_t cIncludedSamples = m_cSamples;
    EBM_ASSERT(1 <= cIncludedSamples);
 
+   // the samples held out of the fold stay in the subsets so that their scores keep being updated, but they get
+   // zero occurrences in every bag, which gives them zero weight in the histograms
+   size_t cFoldSamples = cIncludedSamples;
+   if(nullptr != aFoldMask) {
+      cFoldSamples = 0;
+      for(size_t iSample = 0; iSample < cIncludedSamples; ++iSample) {
+         EBM_ASSERT(uint8_t{0} == aFoldMask[iSample] || uint8_t{1} == aFoldMask[iSample]);
+         cFoldSamples += static_cast<size_t>(aFoldMask[iSample]);
+      }
+      EBM_ASSERT(1 <= cFoldSamples);
+   }
+
    const size_t cInnerBagsAfterZero = size_t{0} == cInnerBags ? size_t{1} : cInnerBags;
 
    if(IsMultiplyError(sizeof(double), cInnerBagsAfterZero)) {
@@ -788,6 +1414,9 @@ ErrorEbm DataSetBoosting::InitBags(
       }
    }
 
+   // without inner bags the fold mask is itself the count of occurrences of every sample
+   const uint8_t* const aOccurrences = nullptr == aOccurrencesFrom ? aFoldMask : aOccurrencesFrom;
+
    EBM_ASSERT(nullptr != m_aSubsets);
    EBM_ASSERT(1 <= m_cSubsets);
    const DataSubsetBoosting* const pSubsetsEnd = m_aSubsets + m_cSubsets;
@@ -798,9 +1427,13 @@ ErrorEbm DataSetBoosting::InitBags(
          EBM_ASSERT(size_t{0} != cInnerBags);
          memset(aOccurrencesFrom, 0, sizeof(*aOccurrencesFrom) * cIncludedSamples);
 
-         size_t cSamplesRemaining = cIncludedSamples;
+         size_t cSamplesRemaining = cFoldSamples;
          do {
             const size_t iSample = cpuRng.NextFast(cIncludedSamples);
+            if(nullptr != aFoldMask && uint8_t{0} == aFoldMask[iSample]) {
+               // held out samples are never drawn, so the bag is a bootstrap of the fold alone
+               continue;
+            }
             const uint8_t existing = aOccurrencesFrom[iSample];
             if(std::numeric_limits<uint8_t>::max() == existing) {
                // it should be essentially impossible for sampling with replacement to get to 255 items in the bin
@@ -812,7 +1445,7 @@ ErrorEbm DataSetBoosting::InitBags(
          } while(size_t{0} != cSamplesRemaining);
       }
       const FloatShared* pWeightFrom = m_aOriginalWeights;
-      const uint8_t* pOccurrencesFrom = aOccurrencesFrom;
+      const uint8_t* pOccurrencesFrom = aOccurrences;
       DataSubsetBoosting* pSubset = m_aSubsets;
       double totalWeight = 0.0;
       do {
@@ -833,13 +1466,14 @@ ErrorEbm DataSetBoosting::InitBags(
                return Error_OutOfMemory;
             }
             size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
-            void* pWeightTo = AlignedAlloc(cBytes);
+            void* pWeightTo = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
             if(nullptr == pWeightTo) {
                LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBags nullptr == pWeightTo");
                free(aOccurrencesFrom);
                return Error_OutOfMemory;
             }
             pInnerBag->m_aWeights = pWeightTo;
+            AddCountBytes(MemorySection_Weights, cBytes);
 
             const void* const pWeightToEnd = IndexByte(pWeightTo, cBytes);
             do {
@@ -856,7 +1490,6 @@ ErrorEbm DataSetBoosting::InitBags(
                }
 
                if(nullptr != pOccurrencesFrom) {
-                  EBM_ASSERT(size_t{0} != cInnerBags);
                   const uint8_t cOccurrences = *pOccurrencesFrom;
                   ++pOccurrencesFrom;
                   weight *= static_cast<double>(cOccurrences);
@@ -881,7 +1514,7 @@ ErrorEbm DataSetBoosting::InitBags(
 
       if(nullptr == pWeightFrom) {
          // use this more accurate non-floating point version if we can
-         totalWeight = static_cast<double>(cIncludedSamples);
+         totalWeight = static_cast<double>(cFoldSamples);
       }
 
       EBM_ASSERT(!std::isnan(totalWeight));
@@ -897,24 +1530,23 @@ ErrorEbm DataSetBoosting::InitBags(
       ++pBagWeightTotals;
 
       if(nullptr != m_aaTermInnerBags) {
-         size_t iTerm = 0;
-         do {
+         // every term bins the same bag into its own counts and weights, so the terms can be visited in parallel
+         auto countTerm = [&](const size_t iTerm, const size_t iThread) -> ErrorEbm {
+            UNUSED(iThread);
             const Term* const pTerm = apTerms[iTerm];
 
-            *TermInnerBag::GetCounts(true, iTerm, iBag, m_aaTermInnerBags) = cIncludedSamples;
+            *TermInnerBag::GetCounts(true, iTerm, iBag, m_aaTermInnerBags) = cFoldSamples;
             *TermInnerBag::GetWeights(true, iTerm, iBag, m_aaTermInnerBags) = totalWeight;
 
             if(1 != pTerm->GetCountTensorBins()) {
                UIntMain* const aCounts = TermInnerBag::GetCounts(false, iTerm, iBag, m_aaTermInnerBags);
                FloatPrecomp* const aWeights = TermInnerBag::GetWeights(false, iTerm, iBag, m_aaTermInnerBags);
 
-               pWeightFrom = m_aOriginalWeights;
-               pOccurrencesFrom = aOccurrencesFrom;
-               pSubset = m_aSubsets;
+               const FloatShared* pWeightFrom = m_aOriginalWeights;
+               const uint8_t* pOccurrencesFrom = aOccurrences;
+               const DataSubsetBoosting* pSubset = m_aSubsets;
                do {
-                  EBM_ASSERT(1 <= pTerm->GetBitsRequiredMin());
-                  const int cItemsPerBitPack = GetCountItemsBitPacked(
-                        pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+                  const int cItemsPerBitPack = pSubset->GetTermPack(iTerm);
                   EBM_ASSERT(1 <= cItemsPerBitPack);
                   ANALYSIS_ASSERT(0 != cItemsPerBitPack);
 
@@ -940,7 +1572,7 @@ ErrorEbm DataSetBoosting::InitBags(
                      maskBits = static_cast<size_t>(MakeLowMask<UIntSmall>(cBitsPerItemMax));
                   }
 
-                  void* pTermData = pSubset->m_aaTermData[iTerm];
+                  const void* pTermData = pSubset->m_aaTermData[iTerm];
 
                   const int cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
                   int cShift =
@@ -956,12 +1588,12 @@ ErrorEbm DataSetBoosting::InitBags(
                            if(sizeof(UIntBig) == pSubset->m_pObjective->m_cUIntBytes) {
                               iTensor = maskBits &
                                     static_cast<size_t>(
-                                          *(reinterpret_cast<UIntBig*>(pTermData) + iPartition) >> cShift);
+                                          *(reinterpret_cast<const UIntBig*>(pTermData) + iPartition) >> cShift);
                            } else {
                               EBM_ASSERT(sizeof(UIntSmall) == pSubset->m_pObjective->m_cUIntBytes);
                               iTensor = maskBits &
                                     static_cast<size_t>(
-                                          *(reinterpret_cast<UIntSmall*>(pTermData) + iPartition) >> cShift);
+                                          *(reinterpret_cast<const UIntSmall*>(pTermData) + iPartition) >> cShift);
                            }
                            EBM_ASSERT(iTensor < pTerm->GetCountTensorBins());
 
@@ -973,7 +1605,6 @@ ErrorEbm DataSetBoosting::InitBags(
 
                            uint8_t cOccurrences = 1;
                            if(nullptr != pOccurrencesFrom) {
-                              EBM_ASSERT(size_t{0} != cInnerBags);
                               cOccurrences = *pOccurrencesFrom;
                               ++pOccurrencesFrom;
                               weight *= static_cast<double>(cOccurrences);
@@ -1007,8 +1638,19 @@ ErrorEbm DataSetBoosting::InitBags(
                   ++pSubset;
                } while(pSubsetsEnd != pSubset);
             }
-            ++iTerm;
-         } while(cTerms != iTerm);
+            return Error_None;
+         };
+
+         ThreadPool* pThreadPool = nullptr;
+         ErrorEbm error = ThreadPool::Borrow(cTerms, &pThreadPool);
+         if(Error_None == error) {
+            error = pThreadPool->Run(cTerms, countTerm);
+            ThreadPool::Return(pThreadPool);
+         }
+         if(Error_None != error) {
+            free(aOccurrencesFrom);
+            return error;
+         }
       }
       ++iBag;
    } while(cInnerBagsAfterZero != iBag);
@@ -1027,13 +1669,235 @@ ErrorEbm DataSetBoosting::InitBags(
 }
 WARNING_POP
 
-ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
-      const bool bAllocateHessians,
-      const bool bAllocateSampleScores,
-      const bool bAllocateTargetData,
-      const bool bAllocateCachedTensors,
-      void* const rng,
-      const size_t cScores,
+ErrorEbm DataSetBoosting::CopyBags(const DataSetBoosting* const pFrom,
+      const size_t cInnerBags,
+      const size_t cTerms,
+      const Term* const* const apTerms) {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::CopyBags");
+
+   EBM_ASSERT(nullptr != pFrom);
+   EBM_ASSERT(1 <= cTerms);
+   EBM_ASSERT(nullptr != apTerms);
+   EBM_ASSERT(m_cSamples == pFrom->m_cSamples);
+   EBM_ASSERT(m_cSubsets == pFrom->m_cSubsets);
+   EBM_ASSERT(nullptr != pFrom->m_aBagWeightTotals);
+
+   const size_t cInnerBagsAfterZero = size_t{0} == cInnerBags ? size_t{1} : cInnerBags;
+
+   // pFrom allocated the same number of totals, so this cannot overflow
+   EBM_ASSERT(!IsMultiplyError(sizeof(double), cInnerBagsAfterZero));
+   double* const aBagWeightTotals = static_cast<double*>(malloc(sizeof(double) * cInnerBagsAfterZero));
+   if(nullptr == aBagWeightTotals) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::CopyBags nullptr == aBagWeightTotals");
+      return Error_OutOfMemory;
+   }
+   memcpy(aBagWeightTotals, pFrom->m_aBagWeightTotals, sizeof(double) * cInnerBagsAfterZero);
+   m_aBagWeightTotals = aBagWeightTotals;
+
+   EBM_ASSERT(nullptr != m_aSubsets);
+   EBM_ASSERT(1 <= m_cSubsets);
+   const DataSubsetBoosting* pSubsetFrom = pFrom->m_aSubsets;
+   DataSubsetBoosting* pSubset = m_aSubsets;
+   const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_cSubsets;
+   do {
+      EBM_ASSERT(pSubset->m_cSamples == pSubsetFrom->m_cSamples);
+      EBM_ASSERT(nullptr != pSubset->m_aInnerBags);
+      EBM_ASSERT(nullptr != pSubsetFrom->m_aInnerBags);
+
+      // pFrom allocated the same weights, so this cannot overflow
+      EBM_ASSERT(!IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, pSubset->m_cSamples));
+      const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * pSubset->m_cSamples;
+      for(size_t iBag = 0; iBag < cInnerBagsAfterZero; ++iBag) {
+         const void* const aWeightsFrom = pSubsetFrom->m_aInnerBags[iBag].m_aWeights;
+         // the bag has no weights when the dataset is unweighted and the bag includes every sample once
+         if(nullptr != aWeightsFrom) {
+            void* const aWeights = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
+            if(nullptr == aWeights) {
+               LOG_0(Trace_Warning, "WARNING DataSetBoosting::CopyBags nullptr == aWeights");
+               return Error_OutOfMemory;
+            }
+            memcpy(aWeights, aWeightsFrom, cBytes);
+            pSubset->m_aInnerBags[iBag].m_aWeights = aWeights;
+            AddCountBytes(MemorySection_Weights, cBytes);
+         }
+      }
+      ++pSubsetFrom;
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+
+   if(nullptr != m_aaTermInnerBags) {
+      EBM_ASSERT(nullptr != pFrom->m_aaTermInnerBags);
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         const size_t cTensorBins = apTerms[iTerm]->GetCountTensorBins();
+         const bool bCollapsed = size_t{1} == cTensorBins;
+         for(size_t iBag = 0; iBag < cInnerBagsAfterZero; ++iBag) {
+            const TermInnerBag* const* const aaTermInnerBagsFrom = pFrom->m_aaTermInnerBags;
+            *TermInnerBag::GetCounts(true, iTerm, iBag, m_aaTermInnerBags) =
+                  *TermInnerBag::GetCounts(true, iTerm, iBag, aaTermInnerBagsFrom);
+            *TermInnerBag::GetWeights(true, iTerm, iBag, m_aaTermInnerBags) =
+                  *TermInnerBag::GetWeights(true, iTerm, iBag, aaTermInnerBagsFrom);
+            if(!bCollapsed) {
+               // InitTermInnerBags allocated both arrays with these sizes, so they cannot overflow
+               memcpy(TermInnerBag::GetCounts(false, iTerm, iBag, m_aaTermInnerBags),
+                     TermInnerBag::GetCounts(false, iTerm, iBag, aaTermInnerBagsFrom),
+                     sizeof(UIntMain) * cTensorBins);
+               memcpy(TermInnerBag::GetWeights(false, iTerm, iBag, m_aaTermInnerBags),
+                     TermInnerBag::GetWeights(false, iTerm, iBag, aaTermInnerBagsFrom),
+                     sizeof(FloatPrecomp) * cTensorBins);
+            }
+         }
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited DataSetBoosting::CopyBags");
+   return Error_None;
+}
+
+ErrorEbm DataSetBoosting::InitOutOfBagWeights(const size_t cInnerBags) {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::InitOutOfBagWeights");
+
+   EBM_ASSERT(1 <= m_cSamples);
+   EBM_ASSERT(nullptr != m_aSubsets);
+   EBM_ASSERT(1 <= m_cSubsets);
+
+   const size_t cInnerBagsAfterZero = size_t{0} == cInnerBags ? size_t{1} : cInnerBags;
+
+   const FloatShared* pWeightFrom = m_aOriginalWeights;
+   double totalWeight = 0.0;
+
+   DataSubsetBoosting* pSubset = m_aSubsets;
+   const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_cSubsets;
+   do {
+      EBM_ASSERT(nullptr == pSubset->m_aOutOfBagWeights);
+      EBM_ASSERT(nullptr != pSubset->m_aInnerBags);
+
+      const size_t cFloatBytes = pSubset->m_pObjective->m_cFloatBytes;
+      const size_t cSubsetSamples = pSubset->GetCountSamples();
+      EBM_ASSERT(1 <= cSubsetSamples);
+
+      if(IsMultiplyError(cFloatBytes, cSubsetSamples)) {
+         LOG_0(Trace_Warning,
+               "WARNING DataSetBoosting::InitOutOfBagWeights IsMultiplyError(cFloatBytes, cSubsetSamples)");
+         return Error_OutOfMemory;
+      }
+      const size_t cBytes = cFloatBytes * cSubsetSamples;
+      void* const aWeightTo = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
+      if(nullptr == aWeightTo) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitOutOfBagWeights nullptr == aWeightTo");
+         return Error_OutOfMemory;
+      }
+      pSubset->m_aOutOfBagWeights = aWeightTo;
+      AddCountBytes(MemorySection_Weights, cBytes);
+
+      // add the weights in 2 stages to preserve precision
+      double subsetWeight = 0.0;
+      for(size_t iSample = 0; iSample < cSubsetSamples; ++iSample) {
+         double weight = double{1};
+         if(nullptr != pWeightFrom) {
+            weight = static_cast<double>(*pWeightFrom);
+            ++pWeightFrom;
+         }
+
+         // a sample is out of bag only if no inner bag draws it. Bags without weights include every sample
+         for(size_t iBag = 0; iBag < cInnerBagsAfterZero; ++iBag) {
+            const void* const aBagWeights = pSubset->m_aInnerBags[iBag].m_aWeights;
+            if(nullptr == aBagWeights) {
+               weight = 0.0;
+               break;
+            }
+            const double bagWeight = sizeof(FloatBig) == cFloatBytes ?
+                  static_cast<double>(reinterpret_cast<const FloatBig*>(aBagWeights)[iSample]) :
+                  static_cast<double>(reinterpret_cast<const FloatSmall*>(aBagWeights)[iSample]);
+            if(0.0 != bagWeight) {
+               weight = 0.0;
+               break;
+            }
+         }
+
+         subsetWeight += weight;
+
+         if(sizeof(FloatBig) == cFloatBytes) {
+            reinterpret_cast<FloatBig*>(aWeightTo)[iSample] = static_cast<FloatBig>(weight);
+         } else {
+            EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+            reinterpret_cast<FloatSmall*>(aWeightTo)[iSample] = static_cast<FloatSmall>(weight);
+         }
+      }
+      totalWeight += subsetWeight;
+
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+
+   EBM_ASSERT(!std::isnan(totalWeight));
+   if(std::isinf(totalWeight)) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitOutOfBagWeights std::isinf(totalWeight)");
+      return Error_UserParamVal;
+   }
+   m_outOfBagWeightTotal = totalWeight;
+
+   LOG_0(Trace_Info, "Exited DataSetBoosting::InitOutOfBagWeights");
+   return Error_None;
+}
+
+ErrorEbm DataSetBoosting::CacheBags(const DataSetBoosting* const pFrom,
+      const size_t cInnerBags,
+      const size_t cTerms,
+      const Term* const* const apTerms) {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::CacheBags");
+
+   ErrorEbm error;
+
+   EBM_ASSERT(nullptr != pFrom);
+   EBM_ASSERT(!m_bBorrowedData);
+   EBM_ASSERT(nullptr == m_aBagWeightTotals);
+   EBM_ASSERT(nullptr == m_aaTermInnerBags);
+
+   if(0 != m_cSamples) {
+      EBM_ASSERT(nullptr != m_aSubsets);
+      DataSubsetBoosting* pSubset = m_aSubsets;
+      const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_cSubsets;
+      do {
+         EBM_ASSERT(nullptr == pSubset->m_aInnerBags);
+         InnerBag* const aInnerBags = InnerBag::AllocateInnerBags(cInnerBags);
+         if(nullptr == aInnerBags) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::CacheBags nullptr == aInnerBags");
+            return Error_OutOfMemory;
+         }
+         pSubset->m_aInnerBags = aInnerBags;
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+
+      if(nullptr != pFrom->m_aaTermInnerBags) {
+         TermInnerBag** const aaTermInnerBags = TermInnerBag::AllocateTermInnerBags(cTerms);
+         if(nullptr == aaTermInnerBags) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::CacheBags nullptr == aaTermInnerBags");
+            return Error_OutOfMemory;
+         }
+         m_aaTermInnerBags = aaTermInnerBags;
+
+         error = TermInnerBag::InitTermInnerBags(cTerms, apTerms, aaTermInnerBags, cInnerBags);
+         if(Error_None != error) {
+            return error;
+         }
+         for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+            AddCountBytes(MemorySection_Weights,
+                  TermInnerBag::CountBytesTermInnerBags(apTerms[iTerm]->GetCountTensorBins(), cInnerBags));
+         }
+      }
+
+      error = CopyBags(pFrom, cInnerBags, cTerms, apTerms);
+      if(Error_None != error) {
+         return error;
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited DataSetBoosting::CacheBags");
+   return Error_None;
+}
+
+ErrorEbm DataSetBoosting::InitSharedData(const bool bAllocateTargetData,
+      const bool bCopyTargets,
+      const bool bAllocateSparseTermData,
       const size_t cSubsetItemsMax,
       const ObjectiveWrapper* const pObjectiveCpu,
       const ObjectiveWrapper* const pObjectiveSIMD,
@@ -1041,18 +1905,15 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
       const BagEbm direction,
       const size_t cSharedSamples,
       const BagEbm* const aBag,
-      const double* const aInitScores,
       const size_t cIncludedSamples,
-      const size_t cInnerBags,
       const size_t cWeights,
       const size_t cTerms,
       const Term* const* const apTerms,
       const IntEbm* const aiTermFeatures) {
-   LOG_0(Trace_Info, "Entered DataSetBoosting::InitDataSetBoosting");
+   LOG_0(Trace_Info, "Entered DataSetBoosting::InitSharedData");
 
    ErrorEbm error;
 
-   EBM_ASSERT(1 <= cScores);
    EBM_ASSERT(1 <= cSubsetItemsMax);
    EBM_ASSERT(nullptr != pObjectiveCpu);
    EBM_ASSERT(nullptr != pObjectiveCpu->m_pObjective); // the objective for the CPU zone cannot be null unlike SIMD
@@ -1066,6 +1927,8 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
    EBM_ASSERT(nullptr == m_aSubsets);
    EBM_ASSERT(nullptr == m_aBagWeightTotals);
    EBM_ASSERT(nullptr == m_aOriginalWeights);
+   EBM_ASSERT(nullptr == m_aOriginalTargets);
+   EBM_ASSERT(!m_bBorrowedData);
 
    if(0 != cIncludedSamples) {
       EBM_ASSERT(1 <= cSharedSamples);
@@ -1073,8 +1936,9 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
       m_cSamples = cIncludedSamples;
 
       EBM_ASSERT(1 == pObjectiveCpu->m_cSIMDPack);
+      // the CUDA zone has a SIMD pack of 1 since each GPU thread processes one item at a time
       EBM_ASSERT(nullptr == pObjectiveSIMD->m_pObjective && 0 == pObjectiveSIMD->m_cSIMDPack ||
-            nullptr != pObjectiveSIMD->m_pObjective && 2 <= pObjectiveSIMD->m_cSIMDPack);
+            nullptr != pObjectiveSIMD->m_pObjective && 1 <= pObjectiveSIMD->m_cSIMDPack);
       const size_t cSIMDPack = pObjectiveSIMD->m_cSIMDPack;
 
       size_t cSubsets = 0;
@@ -1097,12 +1961,12 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
 
       if(IsMultiplyError(sizeof(DataSubsetBoosting), cSubsets)) {
          LOG_0(Trace_Warning,
-               "WARNING DataSetBoosting::InitDataSetBoosting IsMultiplyError(sizeof(DataSubsetBoosting), cSubsets)");
+               "WARNING DataSetBoosting::InitSharedData IsMultiplyError(sizeof(DataSubsetBoosting), cSubsets)");
          return Error_OutOfMemory;
       }
       DataSubsetBoosting* pSubset = static_cast<DataSubsetBoosting*>(malloc(sizeof(DataSubsetBoosting) * cSubsets));
       if(nullptr == pSubset) {
-         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == pSubset");
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSharedData nullptr == pSubset");
          return Error_OutOfMemory;
       }
       m_aSubsets = pSubset;
@@ -1140,13 +2004,12 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
 
          EBM_ASSERT(1 <= cTerms);
          if(IsMultiplyError(sizeof(void*), cTerms)) {
-            LOG_0(Trace_Warning,
-                  "WARNING DataSetBoosting::InitDataSetBoosting IsMultiplyError(sizeof(void *), cTerms)");
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSharedData IsMultiplyError(sizeof(void *), cTerms)");
             return Error_OutOfMemory;
          }
          void** paTermData = static_cast<void**>(malloc(sizeof(void*) * cTerms));
          if(nullptr == paTermData) {
-            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == paTermData");
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSharedData nullptr == paTermData");
             return Error_OutOfMemory;
          }
          pSubset->m_aaTermData = paTermData;
@@ -1157,41 +2020,59 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
             ++paTermData;
          } while(paTermDataEnd != paTermData);
 
-         InnerBag* const aInnerBags = InnerBag::AllocateInnerBags(cInnerBags);
-         if(nullptr == aInnerBags) {
-            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == aInnerBags");
+         if(IsMultiplyError(sizeof(int), cTerms)) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSharedData IsMultiplyError(sizeof(int), cTerms)");
             return Error_OutOfMemory;
          }
-         pSubset->m_aInnerBags = aInnerBags;
+         int* const acTermPacks = static_cast<int*>(malloc(sizeof(int) * cTerms));
+         if(nullptr == acTermPacks) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSharedData nullptr == acTermPacks");
+            return Error_OutOfMemory;
+         }
+         pSubset->m_acTermPacks = acTermPacks;
+
+         // terms without any real dimensions have no term data, and InitTermData sets the packs of the others
+         for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+            acTermPacks[iTerm] = k_cItemsPerBitPackUndefined;
+         }
 
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
       EBM_ASSERT(0 == cIncludedSamplesRemaining);
 
-      if(bAllocateGradients) {
-         error = InitGradHess(bAllocateHessians, cScores);
+      if(bAllocateTargetData) {
+         error = InitTargetData(pDataSetShared, direction, aBag);
          if(Error_None != error) {
             return error;
          }
-      } else {
-         EBM_ASSERT(!bAllocateHessians);
       }
 
-      if(bAllocateSampleScores) {
-         error = InitSampleScores(cScores, direction, aBag, aInitScores);
+      if(bCopyTargets) {
+         error = CopyTargets(pDataSetShared, direction, aBag);
          if(Error_None != error) {
             return error;
          }
       }
 
-      if(bAllocateTargetData) {
-         error = InitTargetData(pDataSetShared, direction, aBag);
-         if(Error_None != error) {
-            return error;
+      // packing the terms is most of the work of creating a booster when there are many pairs, and the terms are
+      // independent of each other, so we spread them over the threads
+      ThreadPool* pThreadPool = nullptr;
+      error = ThreadPool::Borrow(cTerms * m_cSubsets, &pThreadPool);
+      if(Error_None != error) {
+         return error;
+      }
+
+      error = InitTermData(
+            pDataSetShared, direction, cSharedSamples, aBag, cTerms, apTerms, aiTermFeatures, pThreadPool);
+      if(Error_None == error && bAllocateSparseTermData) {
+         // only the training set sums histograms, so the validation set has no use for the sparse term data
+         error = InitSparseTermData(cTerms, apTerms, pThreadPool);
+         if(Error_None == error) {
+            error = InitBlockedSamples(cTerms, apTerms, pThreadPool);
          }
       }
 
-      error = InitTermData(pDataSetShared, direction, cSharedSamples, aBag, cTerms, apTerms, aiTermFeatures);
+      ThreadPool::Return(pThreadPool);
       if(Error_None != error) {
          return error;
       }
@@ -1202,6 +2083,110 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
             return error;
          }
       }
+   }
+
+   LOG_0(Trace_Info, "Exited DataSetBoosting::InitSharedData");
+   return Error_None;
+}
+
+ErrorEbm DataSetBoosting::InitDataSetBoosting(const DataSetBoosting* const pSharedData,
+      const bool bAllocateGradients,
+      const bool bAllocateHessians,
+      const bool bCompressGradients,
+      const bool bAllocateSampleScores,
+      const bool bAllocateCachedTensors,
+      const bool bCopyCachedBags,
+      void* const rng,
+      const size_t cScores,
+      const BagEbm direction,
+      const BagEbm* const aBag,
+      const double* const aInitScores,
+      const uint8_t* const aFoldMask,
+      const size_t cInnerBags,
+      const size_t cTerms,
+      const Term* const* const apTerms) {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::InitDataSetBoosting");
+
+   ErrorEbm error;
+
+   EBM_ASSERT(nullptr != pSharedData);
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(BagEbm{-1} == direction || BagEbm{1} == direction);
+   EBM_ASSERT(1 <= cTerms);
+   EBM_ASSERT(nullptr == aFoldMask || !bCopyCachedBags);
+
+   EBM_ASSERT(0 == m_cSamples);
+   EBM_ASSERT(0 == m_cSubsets);
+   EBM_ASSERT(nullptr == m_aSubsets);
+   EBM_ASSERT(nullptr == m_aBagWeightTotals);
+   EBM_ASSERT(nullptr == m_aOriginalWeights);
+   EBM_ASSERT(nullptr == m_aOriginalTargets);
+
+   // even with zero samples there is nothing of our own to free in the borrowed arrays
+   m_bBorrowedData = true;
+
+   const size_t cIncludedSamples = pSharedData->m_cSamples;
+   if(0 != cIncludedSamples) {
+      m_cSamples = cIncludedSamples;
+      m_aOriginalWeights = pSharedData->m_aOriginalWeights;
+      m_aOriginalTargets = pSharedData->m_aOriginalTargets;
+
+      const size_t cSubsets = pSharedData->m_cSubsets;
+      EBM_ASSERT(1 <= cSubsets);
+      // the shared data already allocated this many subsets, so this cannot overflow
+      EBM_ASSERT(!IsMultiplyError(sizeof(DataSubsetBoosting), cSubsets));
+      DataSubsetBoosting* pSubset = static_cast<DataSubsetBoosting*>(malloc(sizeof(DataSubsetBoosting) * cSubsets));
+      if(nullptr == pSubset) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == pSubset");
+         return Error_OutOfMemory;
+      }
+      m_aSubsets = pSubset;
+      m_cSubsets = cSubsets;
+
+      const DataSubsetBoosting* const pSubsetsEnd = pSubset + cSubsets;
+
+      const DataSubsetBoosting* pSubsetShared = pSharedData->m_aSubsets;
+      DataSubsetBoosting* pSubsetInit = pSubset;
+      do {
+         pSubsetInit->SafeInitDataSubsetBoosting();
+         pSubsetInit->m_cSamples = pSubsetShared->m_cSamples;
+         pSubsetInit->m_pObjective = pSubsetShared->m_pObjective;
+         pSubsetInit->m_aTargetData = pSubsetShared->m_aTargetData;
+         pSubsetInit->m_aaTermData = pSubsetShared->m_aaTermData;
+         pSubsetInit->m_acTermPacks = pSubsetShared->m_acTermPacks;
+         pSubsetInit->m_aaSparseTermData = pSubsetShared->m_aaSparseTermData;
+         pSubsetInit->m_aaiBlockedSamples = pSubsetShared->m_aaiBlockedSamples;
+         ++pSubsetShared;
+         ++pSubsetInit;
+      } while(pSubsetsEnd != pSubsetInit);
+
+      do {
+         InnerBag* const aInnerBags = InnerBag::AllocateInnerBags(cInnerBags);
+         if(nullptr == aInnerBags) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == aInnerBags");
+            return Error_OutOfMemory;
+         }
+         pSubset->m_aInnerBags = aInnerBags;
+
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+
+      if(bAllocateGradients) {
+         error = InitGradHess(bAllocateHessians, bCompressGradients, cScores);
+         if(Error_None != error) {
+            return error;
+         }
+      } else {
+         EBM_ASSERT(!bAllocateHessians);
+         EBM_ASSERT(!bCompressGradients);
+      }
+
+      if(bAllocateSampleScores) {
+         error = InitSampleScores(cScores, direction, aBag, aInitScores);
+         if(Error_None != error) {
+            return error;
+         }
+      }
 
       if(bAllocateCachedTensors) {
          TermInnerBag** const aaTermInnerBags = TermInnerBag::AllocateTermInnerBags(cTerms);
@@ -1215,9 +2200,17 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
          if(Error_None != error) {
             return error;
          }
+         for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+            AddCountBytes(MemorySection_Weights,
+                  TermInnerBag::CountBytesTermInnerBags(apTerms[iTerm]->GetCountTensorBins(), cInnerBags));
+         }
       }
 
-      error = InitBags(rng, cInnerBags, cTerms, apTerms);
+      if(bCopyCachedBags) {
+         error = CopyBags(pSharedData, cInnerBags, cTerms, apTerms);
+      } else {
+         error = InitBags(rng, aFoldMask, cInnerBags, cTerms, apTerms);
+      }
       if(Error_None != error) {
          return error;
       }
@@ -1231,7 +2224,10 @@ void DataSetBoosting::DestructDataSetBoosting(const size_t cTerms, const size_t
    LOG_0(Trace_Info, "Entered DataSetBoosting::DestructDataSetBoosting");
 
    free(m_aBagWeightTotals);
-   free(m_aOriginalWeights);
+   if(!m_bBorrowedData) {
+      free(m_aOriginalWeights);
+      free(m_aOriginalTargets);
+   }
 
    TermInnerBag::FreeTermInnerBags(cTerms, m_aaTermInnerBags, cInnerBags);
 
@@ -1240,7 +2236,7 @@ void DataSetBoosting::DestructDataSetBoosting(const size_t cTerms, const size_t
       EBM_ASSERT(1 <= m_cSubsets);
       const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_cSubsets;
       do {
-         pSubset->DestructDataSubsetBoosting(cTerms, cInnerBags);
+         pSubset->DestructDataSubsetBoosting(cTerms, cInnerBags, m_bBorrowedData);
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
       free(m_aSubsets);
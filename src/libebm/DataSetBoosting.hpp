@@ -6,12 +6,15 @@
 #define DATA_SET_BOOSTING_HPP
 
 #include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memcpy
 
 #include "libebm.h" // ErrorEbm
 #include "logging.h" // EBM_ASSERT
 #include "unzoned.h"
 
 #include "bridge.h" // UIntMain
+#include "bridge.hpp" // k_cItemsPerBitPackUndefined
+#include "common.hpp" // ArrayToPointer
 
 #include "InnerBag.hpp" // InnerBag
 #include "TermInnerBag.hpp" // TermInnerBag
@@ -22,8 +25,113 @@ namespace DEFINED_ZONE_NAME {
 #endif // DEFINED_ZONE_NAME
 
 class Term;
+class ThreadPool;
 struct DataSetBoosting;
 
+struct SparseTermEntry final {
+   size_t m_iSample;
+   size_t m_iTensor;
+};
+static_assert(std::is_standard_layout<SparseTermEntry>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<SparseTermEntry>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+// For single feature terms where nearly every sample lands in the same bin we keep a list of the samples that
+// do not. BinSumsBoosting can then sum the whole subset into the default bin with the fast collapsed kernel and
+// move only the non-default samples to their own bins. The bit packed term data is still kept since ApplyUpdate
+// needs to update the scores of every sample.
+struct SparseTermData final {
+   SparseTermData() = default; // preserve our POD status
+   ~SparseTermData() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   size_t m_iTensorDefault;
+   size_t m_cNonDefaults;
+
+   // IMPORTANT: m_aNonDefaults must be in the last position for the struct hack and this must be standard layout
+   SparseTermEntry m_aNonDefaults[1];
+
+   inline const SparseTermEntry* GetNonDefaults() const { return ArrayToPointer(m_aNonDefaults); }
+   inline SparseTermEntry* GetNonDefaults() { return ArrayToPointer(m_aNonDefaults); }
+};
+static_assert(std::is_standard_layout<SparseTermData>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<SparseTermData>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+// With CreateBoosterFlags_CompressGradients the training gradients and hessians are stored as bfloat16, which has
+// the exponent range of float32 and so needs no scaling. The objectives and BinSumsBoosting kernels only handle the
+// zone's float type, so the gradients pass through a small per-thread buffer one chunk at a time: ApplyUpdate writes
+// a chunk there that we then round to bfloat16, and BinSumsBoosting reads a chunk that we expanded there.
+typedef uint16_t Bfloat16;
+
+static constexpr size_t k_cBytesGradHessChunk = 65536;
+
+inline static Bfloat16 FloatToBfloat16(const float val) {
+   uint32_t bits;
+   memcpy(&bits, &val, sizeof(bits));
+   if(UNLIKELY(0x7F800000 < (bits & 0x7FFFFFFF))) {
+      // keep NaN a NaN even if its payload is only in the low bits that we drop
+      return static_cast<Bfloat16>((bits >> 16) | 0x0040);
+   }
+   // round to nearest even
+   bits += uint32_t{0x7FFF} + ((bits >> 16) & uint32_t{1});
+   return static_cast<Bfloat16>(bits >> 16);
+}
+
+inline static float Bfloat16ToFloat(const Bfloat16 val) {
+   const uint32_t bits = static_cast<uint32_t>(val) << 16;
+   float ret;
+   memcpy(&ret, &bits, sizeof(ret));
+   return ret;
+}
+
+inline static void CompressGradHess(
+      const size_t cFloats, const size_t cFloatBytes, const void* const aFrom, Bfloat16* const aTo) {
+   if(sizeof(FloatBig) == cFloatBytes) {
+      const FloatBig* const aFromSpecific = static_cast<const FloatBig*>(aFrom);
+      for(size_t i = 0; i < cFloats; ++i) {
+         aTo[i] = FloatToBfloat16(static_cast<float>(aFromSpecific[i]));
+      }
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+      const FloatSmall* const aFromSpecific = static_cast<const FloatSmall*>(aFrom);
+      for(size_t i = 0; i < cFloats; ++i) {
+         aTo[i] = FloatToBfloat16(aFromSpecific[i]);
+      }
+   }
+}
+
+inline static void ExpandGradHess(
+      const size_t cFloats, const size_t cFloatBytes, const Bfloat16* const aFrom, void* const aTo) {
+   if(sizeof(FloatBig) == cFloatBytes) {
+      FloatBig* const aToSpecific = static_cast<FloatBig*>(aTo);
+      for(size_t i = 0; i < cFloats; ++i) {
+         aToSpecific[i] = static_cast<FloatBig>(Bfloat16ToFloat(aFrom[i]));
+      }
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+      FloatSmall* const aToSpecific = static_cast<FloatSmall*>(aTo);
+      for(size_t i = 0; i < cFloats; ++i) {
+         aToSpecific[i] = Bfloat16ToFloat(aFrom[i]);
+      }
+   }
+}
+
+inline static size_t GetGradHessChunkItems(const size_t cBytesPerItem, const size_t cItemsPerBitPack) {
+   // a whole number of bit packs so that every chunk after the first one starts on a pack boundary
+   EBM_ASSERT(1 <= cBytesPerItem);
+   EBM_ASSERT(1 <= cItemsPerBitPack);
+   return EbmMax(size_t{1}, k_cBytesGradHessChunk / cBytesPerItem / cItemsPerBitPack) * cItemsPerBitPack;
+}
+
+inline static size_t GetGradHessTempBytes(const size_t cBytesPerItem) {
+   // the largest chunk that GetGradHessChunkItems returns for any bit pack
+   return EbmMax(k_cBytesGradHessChunk / cBytesPerItem, static_cast<size_t>(COUNT_BITS(UIntBig))) * cBytesPerItem;
+}
+
 struct DataSubsetBoosting final {
    friend DataSetBoosting;
 
@@ -39,10 +147,14 @@ struct DataSubsetBoosting final {
       m_aSampleScores = nullptr;
       m_aTargetData = nullptr;
       m_aaTermData = nullptr;
+      m_acTermPacks = nullptr;
+      m_aaSparseTermData = nullptr;
+      m_aaiBlockedSamples = nullptr;
       m_aInnerBags = nullptr;
+      m_aOutOfBagWeights = nullptr;
    }
 
-   void DestructDataSubsetBoosting(const size_t cTerms, const size_t cInnerBags);
+   void DestructDataSubsetBoosting(const size_t cTerms, const size_t cInnerBags, const bool bBorrowedData);
 
    inline size_t GetCountSamples() const { return m_cSamples; }
 
@@ -67,6 +179,36 @@ struct DataSubsetBoosting final {
       return (*m_pObjective->m_pBinSumsBoostingC)(m_pObjective, pParams);
    }
 
+   // estimates of the sample data that one ApplyUpdate or BinSumsBoosting pass streams through memory, which only
+   // GetBoosterProfile uses. Compressed gradients and hessians are stored as bfloat16
+   inline size_t CountBytesPacked(const size_t cSamples, const int cPack) const {
+      return k_cItemsPerBitPackUndefined == cPack ? size_t{0} :
+                                                     cSamples / static_cast<size_t>(cPack) * m_pObjective->m_cUIntBytes;
+   }
+
+   inline size_t CountBytesApplyUpdate(const ApplyUpdateBridge* const pData, const bool bCompressed) const {
+      const size_t cFloatBytes = m_pObjective->m_cFloatBytes;
+      const size_t cGradHessBytes = (bCompressed ? size_t{2} : cFloatBytes) * pData->m_cScores *
+            (EBM_FALSE != pData->m_bHessianNeeded ? size_t{2} : size_t{1});
+      // the sample scores are read and written back
+      const size_t cBytesPerSample = cFloatBytes * pData->m_cScores * size_t{2} + cGradHessBytes +
+            m_pObjective->m_cTargetBytes + (nullptr != pData->m_aWeights ? cFloatBytes : size_t{0});
+      return pData->m_cSamples * cBytesPerSample + CountBytesPacked(pData->m_cSamples, pData->m_cPack);
+   }
+
+   inline size_t CountBytesBinSums(const size_t cSamples,
+         const size_t cScores,
+         const bool bHessian,
+         const bool bCompressed,
+         const bool bWeights,
+         const int cPack) const {
+      const size_t cFloatBytes = m_pObjective->m_cFloatBytes;
+      const size_t cBytesPerSample =
+            (bCompressed ? size_t{2} : cFloatBytes) * cScores * (bHessian ? size_t{2} : size_t{1}) +
+            (bWeights ? cFloatBytes : size_t{0});
+      return cSamples * cBytesPerSample + CountBytesPacked(cSamples, cPack);
+   }
+
    inline void* GetGradHess() { return m_aGradHess; }
 
    inline void* GetSampleScores() { return m_aSampleScores; }
@@ -78,11 +220,31 @@ struct DataSubsetBoosting final {
       return m_aaTermData[iTerm];
    }
 
+   inline int GetTermPack(const size_t iTerm) const {
+      // each subset packs its term data as densely as the largest tensor index that it holds allows
+      EBM_ASSERT(nullptr != m_acTermPacks);
+      return m_acTermPacks[iTerm];
+   }
+
+   inline const SparseTermData* GetSparseTermData(const size_t iTerm) const {
+      // only the training set keeps sparse term data, and terms that are not sparse enough hold nullptr
+      return nullptr == m_aaSparseTermData ? nullptr : m_aaSparseTermData[iTerm];
+   }
+
+   inline const size_t* GetBlockedSamples(const size_t iTerm) const {
+      // the subset's sample indexes grouped by blocks of tensor bins that fit in the L1 data cache. Only the training
+      // set keeps them, and terms whose fast bins already fit in the L1 data cache hold nullptr
+      return nullptr == m_aaiBlockedSamples ? nullptr : m_aaiBlockedSamples[iTerm];
+   }
+
    inline const InnerBag* GetInnerBag(const size_t iBag) const {
       EBM_ASSERT(nullptr != m_aInnerBags);
       return &m_aInnerBags[iBag];
    }
 
+   // nullptr unless the booster computes an out of bag metric
+   inline void* GetOutOfBagWeights() { return m_aOutOfBagWeights; }
+
  private:
    size_t m_cSamples;
    const ObjectiveWrapper* m_pObjective;
@@ -90,7 +252,11 @@ struct DataSubsetBoosting final {
    void* m_aSampleScores;
    void* m_aTargetData;
    void** m_aaTermData;
+   int* m_acTermPacks;
+   SparseTermData** m_aaSparseTermData;
+   size_t** m_aaiBlockedSamples;
    InnerBag* m_aInnerBags;
+   void* m_aOutOfBagWeights;
 };
 static_assert(std::is_standard_layout<DataSubsetBoosting>::value,
       "We use the struct hack in several places, so disallow non-standard_layout types in general");
@@ -110,15 +276,19 @@ struct DataSetBoosting final {
       m_aBagWeightTotals = nullptr;
       m_aOriginalWeights = nullptr;
       m_aaTermInnerBags = nullptr;
+      m_aOriginalTargets = nullptr;
+      m_outOfBagWeightTotal = 0.0;
+      m_bBorrowedData = false;
+      for(size_t iSection = 0; iSection < k_cMemorySections; ++iSection) {
+         m_acBytes[iSection] = 0;
+      }
    }
 
-   ErrorEbm InitDataSetBoosting(const bool bAllocateGradients,
-         const bool bAllocateHessians,
-         const bool bAllocateSampleScores,
-         const bool bAllocateTargetData,
-         const bool bAllocateCachedTensors,
-         void* const rng,
-         const size_t cScores,
+   // fills the parts that do not depend on the inner bags or the scores: the subsets, their bit packed term data and
+   // targets, and the weights. PreparedTrainingData owns a DataSetBoosting made this way for each direction
+   ErrorEbm InitSharedData(const bool bAllocateTargetData,
+         const bool bCopyTargets,
+         const bool bAllocateSparseTermData,
          const size_t cSubsetItemsMax,
          const ObjectiveWrapper* const pObjectiveCpu,
          const ObjectiveWrapper* const pObjectiveSIMD,
@@ -126,14 +296,49 @@ struct DataSetBoosting final {
          const BagEbm direction,
          const size_t cSharedSamples,
          const BagEbm* const aBag,
-         const double* const aInitScores,
          const size_t cIncludedSamples,
-         const size_t cInnerBags,
          const size_t cWeights,
          const size_t cTerms,
          const Term* const* const apTerms,
          const IntEbm* const aiTermFeatures);
 
+   // borrows the shared data of pSharedData, which must outlive us, and allocates only what each booster needs.
+   // With bCopyCachedBags the inner bags are copied from the ones that CacheBags stored in pSharedData instead of
+   // being drawn from rng. aFoldMask, when not nullptr, holds a 0 or 1 for every sample of pSharedData in subset
+   // order, and the samples with a 0 get zero weight in every inner bag
+   ErrorEbm InitDataSetBoosting(const DataSetBoosting* const pSharedData,
+         const bool bAllocateGradients,
+         const bool bAllocateHessians,
+         const bool bCompressGradients,
+         const bool bAllocateSampleScores,
+         const bool bAllocateCachedTensors,
+         const bool bCopyCachedBags,
+         void* const rng,
+         const size_t cScores,
+         const BagEbm direction,
+         const BagEbm* const aBag,
+         const double* const aInitScores,
+         const uint8_t* const aFoldMask,
+         const size_t cInnerBags,
+         const size_t cTerms,
+         const Term* const* const apTerms);
+
+   // replaces the gradients and sample scores of subset iSubset with copies first touched by the calling thread, which
+   // Linux places on that thread's NUMA node. Call it from the worker that keeps processing the subset
+   ErrorEbm LocalizeSubset(
+         const size_t iSubset, const size_t cScores, const bool bHessian, const bool bCompressGradients);
+
+   // keeps a copy of the inner bags of pFrom, and the bin counts and weights of its terms, in this shared data so
+   // that boosters made later with the same bags can copy them instead of revisiting every sample
+   ErrorEbm CacheBags(const DataSetBoosting* const pFrom,
+         const size_t cInnerBags,
+         const size_t cTerms,
+         const Term* const* const apTerms);
+
+   // gives each subset the original weights of the samples that no inner bag draws and zero for the rest, which the
+   // training ApplyUpdate pass uses to compute the metric of CreateBoosterFlags_OutOfBagMetric
+   ErrorEbm InitOutOfBagWeights(const size_t cInnerBags);
+
    void DestructDataSetBoosting(const size_t cTerms, const size_t cInnerBags);
 
    inline size_t GetCountSamples() const { return m_cSamples; }
@@ -146,13 +351,27 @@ struct DataSetBoosting final {
       EBM_ASSERT(nullptr != m_aBagWeightTotals);
       return m_aBagWeightTotals[iBag];
    }
+   inline double GetOutOfBagWeightTotal() const { return m_outOfBagWeightTotal; }
+   // nullptr if the dataset is unweighted
+   inline const FloatShared* GetOriginalWeights() const { return m_aOriginalWeights; }
+   // one target per sample, which is only kept for RMSE since its gradients are calculated from the targets directly
+   inline const FloatShared* GetOriginalTargets() const { return m_aOriginalTargets; }
    inline const TermInnerBag* const* GetTermInnerBags() {
       EBM_ASSERT(nullptr != m_aaTermInnerBags);
       return m_aaTermInnerBags;
    }
+   // the bytes that this dataset allocated for a MemorySection, which excludes anything borrowed from shared data
+   inline size_t GetCountBytes(const size_t iSection) const {
+      EBM_ASSERT(iSection < k_cMemorySections);
+      return m_acBytes[iSection];
+   }
 
  private:
-   ErrorEbm InitGradHess(const bool bAllocateHessians, const size_t cScores);
+   inline void AddCountBytes(const IntEbm section, const size_t cBytes) {
+      m_acBytes[static_cast<size_t>(section)] += cBytes;
+   }
+
+   ErrorEbm InitGradHess(const bool bAllocateHessians, const bool bCompressGradients, const size_t cScores);
 
    ErrorEbm InitSampleScores(
          const size_t cScores, const BagEbm direction, const BagEbm* const aBag, const double* const aInitScores);
@@ -165,11 +384,27 @@ struct DataSetBoosting final {
          const BagEbm* const aBag,
          const size_t cTerms,
          const Term* const* const apTerms,
-         const IntEbm* const aiTermFeatures);
+         const IntEbm* const aiTermFeatures,
+         ThreadPool* const pThreadPool);
+
+   ErrorEbm InitSparseTermData(const size_t cTerms, const Term* const* const apTerms, ThreadPool* const pThreadPool);
+
+   ErrorEbm InitBlockedSamples(const size_t cTerms, const Term* const* const apTerms, ThreadPool* const pThreadPool);
 
    ErrorEbm CopyWeights(const unsigned char* const pDataSetShared, const BagEbm direction, const BagEbm* const aBag);
 
-   ErrorEbm InitBags(void* const rng, const size_t cInnerBags, const size_t cTerms, const Term* const* const apTerms);
+   ErrorEbm CopyTargets(const unsigned char* const pDataSetShared, const BagEbm direction, const BagEbm* const aBag);
+
+   ErrorEbm InitBags(void* const rng,
+         const uint8_t* const aFoldMask,
+         const size_t cInnerBags,
+         const size_t cTerms,
+         const Term* const* const apTerms);
+
+   ErrorEbm CopyBags(const DataSetBoosting* const pFrom,
+         const size_t cInnerBags,
+         const size_t cTerms,
+         const Term* const* const apTerms);
 
    size_t m_cSamples;
    size_t m_cSubsets;
@@ -177,6 +412,10 @@ struct DataSetBoosting final {
    double* m_aBagWeightTotals;
    FloatShared* m_aOriginalWeights;
    TermInnerBag** m_aaTermInnerBags;
+   FloatShared* m_aOriginalTargets;
+   double m_outOfBagWeightTotal;
+   bool m_bBorrowedData;
+   size_t m_acBytes[k_cMemorySections];
 };
 static_assert(std::is_standard_layout<DataSetBoosting>::value,
       "We use the struct hack in several places, so disallow non-standard_layout types in general");
@@ -12,6 +12,7 @@
 
 #include "ebm_internal.hpp"
 #include "dataset_shared.hpp" // UIntShared
+#include "DataSetBoosting.hpp" // DataSetBoosting
 #include "DataSetInteraction.hpp"
 
 namespace DEFINED_ZONE_NAME {
@@ -19,23 +20,35 @@ namespace DEFINED_ZONE_NAME {
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
-void DataSubsetInteraction::DestructDataSubsetInteraction(const size_t cFeatures) {
+void DataSubsetInteraction::DestructDataSubsetInteraction(
+      const size_t cFeatures, const bool bBorrowedData, const bool bBorrowedWeights) {
    LOG_0(Trace_Info, "Entered DataSubsetInteraction::DestructDataSubsetInteraction");
 
-   AlignedFree(m_aWeights);
+   // like the boosting subsets, these arrays came from the allocator of the objective's zone
+   const ALIGNED_FREE_C pAlignedFree = nullptr == m_pObjective ? &AlignedFree : m_pObjective->m_pAlignedFreeC;
+
+   if(!bBorrowedWeights) {
+      (*pAlignedFree)(m_aWeights);
+   }
+
+   free(m_acFeaturePacks);
 
    void** paFeatureData = m_aaFeatureData;
    if(nullptr != paFeatureData) {
       EBM_ASSERT(1 <= cFeatures);
-      const void* const* const paFeatureDataEnd = paFeatureData + cFeatures;
-      do {
-         AlignedFree(*paFeatureData);
-         ++paFeatureData;
-      } while(paFeatureDataEnd != paFeatureData);
+      if(!bBorrowedData) {
+         const void* const* const paFeatureDataEnd = paFeatureData + cFeatures;
+         do {
+            (*pAlignedFree)(*paFeatureData);
+            ++paFeatureData;
+         } while(paFeatureDataEnd != paFeatureData);
+      }
       free(m_aaFeatureData);
    }
 
-   AlignedFree(m_aGradHess);
+   if(!bBorrowedData) {
+      (*pAlignedFree)(m_aGradHess);
+   }
 
    LOG_0(Trace_Info, "Exited DataSubsetInteraction::DestructDataSubsetInteraction");
 }
@@ -70,12 +83,13 @@ ErrorEbm DataSetInteraction::InitGradHess(const bool bAllocateHessians, const si
       const size_t cBytesGradHess = pSubset->m_pObjective->m_cFloatBytes * cTotalScores * cSubsetSamples;
       ANALYSIS_ASSERT(0 != cBytesGradHess);
 
-      void* const aGradHess = AlignedAlloc(cBytesGradHess);
+      void* const aGradHess = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytesGradHess);
       if(nullptr == aGradHess) {
          LOG_0(Trace_Warning, "WARNING DataSetInteraction::InitGradHess nullptr == aGradHess");
          return Error_OutOfMemory;
       }
       pSubset->m_aGradHess = aGradHess;
+      AddCountBytes(MemorySection_Gradients, cBytesGradHess);
 
       ++pSubset;
    } while(pSubsetsEnd != pSubset);
@@ -109,6 +123,7 @@ ErrorEbm DataSetInteraction::InitFeatureData(const unsigned char* const pDataSet
       UIntShared countBins;
       UIntShared defaultValSparse;
       size_t cNonDefaultsSparse;
+      size_t cBytesExternal;
       const void* aFeatureDataFrom = GetDataSetSharedFeature(pDataSetShared,
             iFeature,
             &bMissing,
@@ -117,7 +132,8 @@ ErrorEbm DataSetInteraction::InitFeatureData(const unsigned char* const pDataSet
             &bSparse,
             &countBins,
             &defaultValSparse,
-            &cNonDefaultsSparse);
+            &cNonDefaultsSparse,
+            &cBytesExternal);
       EBM_ASSERT(nullptr != aFeatureDataFrom);
       EBM_ASSERT(!bSparse); // we don't support sparse yet
 
@@ -151,7 +167,10 @@ ErrorEbm DataSetInteraction::InitFeatureData(const unsigned char* const pDataSet
 
          int iShiftFrom = static_cast<int>((cSharedSamples - size_t{1}) % static_cast<size_t>(cItemsPerBitPackFrom));
 
+         // external features point to the caller's unpacked array, which we read instead of pFeatureDataFrom
          const UIntShared* pFeatureDataFrom = static_cast<const UIntShared*>(aFeatureDataFrom);
+         const unsigned char* pExternalFrom = static_cast<const unsigned char*>(aFeatureDataFrom);
+         const UIntShared iBinExternalOffset = bMissing ? UIntShared{0} : UIntShared{1};
          const BagEbm* pSampleReplication = aBag;
          BagEbm replication = 0;
          UIntShared iFeatureBin;
@@ -188,12 +207,14 @@ ErrorEbm DataSetInteraction::InitFeatureData(const unsigned char* const pDataSet
                return Error_OutOfMemory;
             }
             const size_t cBytes = pSubset->GetObjectiveWrapper()->m_cUIntBytes * cDataUnitsTo;
-            void* pFeatureDataTo = AlignedAlloc(cBytes);
+            void* pFeatureDataTo = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
             if(nullptr == pFeatureDataTo) {
                LOG_0(Trace_Warning, "WARNING DataSetInteraction::InitFeatureData nullptr == pFeatureDataTo");
                return Error_OutOfMemory;
             }
             pSubset->m_aaFeatureData[iFeature] = pFeatureDataTo;
+            AddCountBytes(MemorySection_TermData, cBytes);
+            pSubset->m_acFeaturePacks[iFeature] = cItemsPerBitPackTo;
             const void* const pFeatureDataToEnd = IndexByte(pFeatureDataTo, cBytes);
 
             memset(pFeatureDataTo, 0, cBytes);
@@ -216,31 +237,41 @@ ErrorEbm DataSetInteraction::InitFeatureData(const unsigned char* const pDataSet
                            } while(replication <= BagEbm{0});
                            const size_t cAdvances = pSampleReplication - pSampleReplicationOriginal - 1;
 
-                           size_t cCompleteAdvanced = cAdvances / static_cast<size_t>(cItemsPerBitPackFrom);
-                           iShiftFrom -= static_cast<int>(cAdvances % static_cast<size_t>(cItemsPerBitPackFrom));
-                           if(iShiftFrom < 0) {
-                              iShiftFrom += cItemsPerBitPackFrom;
-                              EBM_ASSERT(0 <= iShiftFrom);
-                              ++cCompleteAdvanced;
+                           if(size_t{0} != cBytesExternal) {
+                              pExternalFrom += cAdvances * cBytesExternal;
+                           } else {
+                              size_t cCompleteAdvanced = cAdvances / static_cast<size_t>(cItemsPerBitPackFrom);
+                              iShiftFrom -= static_cast<int>(cAdvances % static_cast<size_t>(cItemsPerBitPackFrom));
+                              if(iShiftFrom < 0) {
+                                 iShiftFrom += cItemsPerBitPackFrom;
+                                 EBM_ASSERT(0 <= iShiftFrom);
+                                 ++cCompleteAdvanced;
+                              }
+                              pFeatureDataFrom += cCompleteAdvanced;
                            }
-                           pFeatureDataFrom += cCompleteAdvanced;
                         }
 
-                        const UIntShared bitsFrom = *pFeatureDataFrom;
+                        if(size_t{0} != cBytesExternal) {
+                           // CheckDataSet verified that external bin indexes are not below iBinExternalOffset
+                           iFeatureBin = GetExternalBinIndex(pExternalFrom, cBytesExternal, 0) - iBinExternalOffset;
+                           pExternalFrom += cBytesExternal;
+                        } else {
+                           const UIntShared bitsFrom = *pFeatureDataFrom;
+
+                           EBM_ASSERT(0 <= iShiftFrom);
+                           EBM_ASSERT(iShiftFrom * cBitsPerItemMaxFrom < COUNT_BITS(UIntShared));
+                           iFeatureBin = (bitsFrom >> (iShiftFrom * cBitsPerItemMaxFrom)) & maskBitsFrom;
 
-                        EBM_ASSERT(0 <= iShiftFrom);
-                        EBM_ASSERT(iShiftFrom * cBitsPerItemMaxFrom < COUNT_BITS(UIntShared));
-                        iFeatureBin = (bitsFrom >> (iShiftFrom * cBitsPerItemMaxFrom)) & maskBitsFrom;
+                           --iShiftFrom;
+                           if(iShiftFrom < 0) {
+                              EBM_ASSERT(-1 == iShiftFrom);
+                              iShiftFrom += cItemsPerBitPackFrom;
+                              ++pFeatureDataFrom;
+                           }
+                        }
 
                         EBM_ASSERT(!IsConvertError<size_t>(iFeatureBin));
                         EBM_ASSERT(static_cast<size_t>(iFeatureBin) < cBins);
-
-                        --iShiftFrom;
-                        if(iShiftFrom < 0) {
-                           EBM_ASSERT(-1 == iShiftFrom);
-                           iShiftFrom += cItemsPerBitPackFrom;
-                           ++pFeatureDataFrom;
-                        }
                      }
 
                      EBM_ASSERT(1 <= replication);
@@ -309,12 +340,13 @@ ErrorEbm DataSetInteraction::InitWeights(const unsigned char* const pDataSetShar
          return Error_OutOfMemory;
       }
       const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
-      void* pWeightTo = AlignedAlloc(cBytes);
+      void* pWeightTo = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
       if(nullptr == pWeightTo) {
          LOG_0(Trace_Warning, "WARNING DataSetInteraction::InitWeights nullptr == pWeightTo");
          return Error_OutOfMemory;
       }
       pSubset->m_aWeights = pWeightTo;
+      AddCountBytes(MemorySection_Weights, cBytes);
 
       const void* const pWeightsToEnd = IndexByte(pWeightTo, cBytes);
       // add the weights in 2 stages to preserve precision
@@ -408,8 +440,9 @@ ErrorEbm DataSetInteraction::InitDataSetInteraction(const bool bAllocateHessians
       m_cSamples = cIncludedSamples;
 
       EBM_ASSERT(1 == pObjectiveCpu->m_cSIMDPack);
+      // the CUDA zone has a SIMD pack of 1 since each GPU thread processes one item at a time
       EBM_ASSERT(nullptr == pObjectiveSIMD->m_pObjective && 0 == pObjectiveSIMD->m_cSIMDPack ||
-            nullptr != pObjectiveSIMD->m_pObjective && 2 <= pObjectiveSIMD->m_cSIMDPack);
+            nullptr != pObjectiveSIMD->m_pObjective && 1 <= pObjectiveSIMD->m_cSIMDPack);
       const size_t cSIMDPack = pObjectiveSIMD->m_cSIMDPack;
 
       size_t cSubsets = 0;
@@ -493,6 +526,19 @@ ErrorEbm DataSetInteraction::InitDataSetInteraction(const bool bAllocateHessians
                *paFeatureData = nullptr;
                ++paFeatureData;
             } while(paFeatureDataEnd != paFeatureData);
+
+            if(IsMultiplyError(sizeof(int), cFeatures)) {
+               LOG_0(Trace_Warning,
+                     "WARNING DataSetInteraction::InitDataSetInteraction IsMultiplyError(sizeof(int), cFeatures)");
+               return Error_OutOfMemory;
+            }
+            int* const acFeaturePacks = static_cast<int*>(malloc(sizeof(int) * cFeatures));
+            if(nullptr == acFeaturePacks) {
+               LOG_0(Trace_Warning, "WARNING DataSetInteraction::InitDataSetInteraction nullptr == acFeaturePacks");
+               return Error_OutOfMemory;
+            }
+            memset(acFeaturePacks, 0, sizeof(int) * cFeatures);
+            pSubset->m_acFeaturePacks = acFeaturePacks;
          }
 
          ++pSubset;
@@ -524,6 +570,160 @@ ErrorEbm DataSetInteraction::InitDataSetInteraction(const bool bAllocateHessians
    return Error_None;
 }
 
+ErrorEbm DataSetInteraction::InitDataSetInteractionFromBoosting(DataSetBoosting* const pTrainingSet,
+      const size_t cInnerBags,
+      const size_t cFeatures,
+      const size_t* const aiFeatureTerms) {
+   LOG_0(Trace_Info, "Entered DataSetInteraction::InitDataSetInteractionFromBoosting");
+
+   EBM_ASSERT(nullptr != pTrainingSet);
+   EBM_ASSERT(0 == cFeatures || nullptr != aiFeatureTerms);
+
+   EBM_ASSERT(0 == m_cSamples);
+   EBM_ASSERT(0 == m_cSubsets);
+   EBM_ASSERT(nullptr == m_aSubsets);
+   EBM_ASSERT(0.0 == m_weightTotal);
+
+   // set these first so that a failure part way through does not free memory that belongs to the booster
+   m_bBorrowedData = true;
+   m_bBorrowedWeights = size_t{0} == cInnerBags;
+
+   const size_t cIncludedSamples = pTrainingSet->GetCountSamples();
+   if(size_t{0} != cIncludedSamples) {
+      const size_t cSubsets = pTrainingSet->GetCountSubsets();
+      EBM_ASSERT(1 <= cSubsets);
+
+      if(IsMultiplyError(sizeof(DataSubsetInteraction), cSubsets)) {
+         LOG_0(Trace_Warning,
+               "WARNING DataSetInteraction::InitDataSetInteractionFromBoosting "
+               "IsMultiplyError(sizeof(DataSubsetInteraction), cSubsets)");
+         return Error_OutOfMemory;
+      }
+      DataSubsetInteraction* const aSubsets =
+            static_cast<DataSubsetInteraction*>(malloc(sizeof(DataSubsetInteraction) * cSubsets));
+      if(nullptr == aSubsets) {
+         LOG_0(Trace_Warning, "WARNING DataSetInteraction::InitDataSetInteractionFromBoosting nullptr == aSubsets");
+         return Error_OutOfMemory;
+      }
+      m_aSubsets = aSubsets;
+      m_cSubsets = cSubsets;
+      m_cSamples = cIncludedSamples;
+
+      for(size_t iSubset = 0; iSubset < cSubsets; ++iSubset) {
+         aSubsets[iSubset].SafeInitDataSubsetInteraction();
+      }
+
+      // the weights of bag 0 are the original weights only when the booster has no inner bags
+      const FloatShared* pWeightFrom = pTrainingSet->GetOriginalWeights();
+      double totalWeight = 0.0;
+
+      DataSubsetBoosting* const aSubsetsFrom = pTrainingSet->GetSubsets();
+      for(size_t iSubset = 0; iSubset < cSubsets; ++iSubset) {
+         DataSubsetBoosting* const pSubsetFrom = &aSubsetsFrom[iSubset];
+         DataSubsetInteraction* const pSubset = &aSubsets[iSubset];
+
+         pSubset->m_cSamples = pSubsetFrom->GetCountSamples();
+         pSubset->m_pObjective = pSubsetFrom->GetObjectiveWrapper();
+         pSubset->m_aGradHess = pSubsetFrom->GetGradHess();
+         EBM_ASSERT(nullptr != pSubset->m_aGradHess);
+
+         if(0 != cFeatures) {
+            if(IsMultiplyError(sizeof(void*), cFeatures)) {
+               LOG_0(Trace_Warning,
+                     "WARNING DataSetInteraction::InitDataSetInteractionFromBoosting "
+                     "IsMultiplyError(sizeof(void *), cFeatures)");
+               return Error_OutOfMemory;
+            }
+            void** const aaFeatureData = static_cast<void**>(malloc(sizeof(void*) * cFeatures));
+            if(nullptr == aaFeatureData) {
+               LOG_0(Trace_Warning,
+                     "WARNING DataSetInteraction::InitDataSetInteractionFromBoosting nullptr == aaFeatureData");
+               return Error_OutOfMemory;
+            }
+            pSubset->m_aaFeatureData = aaFeatureData;
+
+            // sizeof(int) <= sizeof(void*), so this cannot overflow if the allocation above did not
+            int* const acFeaturePacks = static_cast<int*>(malloc(sizeof(int) * cFeatures));
+            if(nullptr == acFeaturePacks) {
+               LOG_0(Trace_Warning,
+                     "WARNING DataSetInteraction::InitDataSetInteractionFromBoosting nullptr == acFeaturePacks");
+               return Error_OutOfMemory;
+            }
+            pSubset->m_acFeaturePacks = acFeaturePacks;
+
+            for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+               const size_t iTerm = aiFeatureTerms[iFeature];
+               if(SIZE_MAX == iTerm) {
+                  aaFeatureData[iFeature] = nullptr;
+                  acFeaturePacks[iFeature] = 0;
+               } else {
+                  // for a term of a single feature the tensor index that DataSetBoosting packs is the feature bin
+                  aaFeatureData[iFeature] = const_cast<void*>(pSubsetFrom->GetTermData(iTerm));
+                  EBM_ASSERT(nullptr != aaFeatureData[iFeature]);
+                  acFeaturePacks[iFeature] = pSubsetFrom->GetTermPack(iTerm);
+               }
+            }
+         }
+
+         if(m_bBorrowedWeights) {
+            pSubset->m_aWeights = const_cast<void*>(pSubsetFrom->GetInnerBag(0)->GetWeights());
+         } else if(nullptr != pWeightFrom) {
+            const size_t cSubsetSamples = pSubset->m_cSamples;
+            if(IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, cSubsetSamples)) {
+               LOG_0(Trace_Warning,
+                     "WARNING DataSetInteraction::InitDataSetInteractionFromBoosting "
+                     "IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, cSubsetSamples)");
+               return Error_OutOfMemory;
+            }
+            const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
+            void* pWeightTo = (*pSubset->m_pObjective->m_pAlignedAllocC)(cBytes);
+            if(nullptr == pWeightTo) {
+               LOG_0(Trace_Warning,
+                     "WARNING DataSetInteraction::InitDataSetInteractionFromBoosting nullptr == pWeightTo");
+               return Error_OutOfMemory;
+            }
+            pSubset->m_aWeights = pWeightTo;
+            AddCountBytes(MemorySection_Weights, cBytes);
+
+            const void* const pWeightsToEnd = IndexByte(pWeightTo, cBytes);
+            // add the weights in 2 stages to preserve precision
+            double subsetWeight = 0.0;
+            do {
+               const double weight = static_cast<double>(*pWeightFrom);
+               ++pWeightFrom;
+               subsetWeight += weight;
+
+               if(sizeof(FloatBig) == pSubset->m_pObjective->m_cFloatBytes) {
+                  *reinterpret_cast<FloatBig*>(pWeightTo) = static_cast<FloatBig>(weight);
+               } else {
+                  EBM_ASSERT(sizeof(FloatSmall) == pSubset->m_pObjective->m_cFloatBytes);
+                  *reinterpret_cast<FloatSmall*>(pWeightTo) = static_cast<FloatSmall>(weight);
+               }
+               pWeightTo = IndexByte(pWeightTo, pSubset->m_pObjective->m_cFloatBytes);
+            } while(pWeightsToEnd != pWeightTo);
+            totalWeight += subsetWeight;
+         }
+      }
+
+      if(m_bBorrowedWeights) {
+         m_weightTotal = pTrainingSet->GetBagWeightTotal(0);
+      } else if(nullptr != pWeightFrom) {
+         EBM_ASSERT(!std::isnan(totalWeight));
+         if(std::isinf(totalWeight)) {
+            LOG_0(Trace_Warning,
+                  "WARNING DataSetInteraction::InitDataSetInteractionFromBoosting std::isinf(totalWeight)");
+            return Error_UserParamVal;
+         }
+         m_weightTotal = totalWeight;
+      } else {
+         m_weightTotal = static_cast<double>(cIncludedSamples);
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited DataSetInteraction::InitDataSetInteractionFromBoosting");
+   return Error_None;
+}
+
 void DataSetInteraction::DestructDataSetInteraction(const size_t cFeatures) {
    LOG_0(Trace_Info, "Entered DataSetInteraction::DestructDataSetInteraction");
 
@@ -532,7 +732,7 @@ void DataSetInteraction::DestructDataSetInteraction(const size_t cFeatures) {
       EBM_ASSERT(1 <= m_cSubsets);
       const DataSubsetInteraction* const pSubsetsEnd = pSubset + m_cSubsets;
       do {
-         pSubset->DestructDataSubsetInteraction(cFeatures);
+         pSubset->DestructDataSubsetInteraction(cFeatures, m_bBorrowedData, m_bBorrowedWeights);
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
       free(m_aSubsets);
@@ -13,12 +13,15 @@
 
 #include "bridge.h" // UIntMain
 
+#include "ebm_internal.hpp" // k_cMemorySections
+
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
 struct DataSetInteraction;
+struct DataSetBoosting;
 
 struct DataSubsetInteraction final {
    friend DataSetInteraction;
@@ -33,10 +36,11 @@ struct DataSubsetInteraction final {
       m_pObjective = nullptr;
       m_aGradHess = nullptr;
       m_aaFeatureData = nullptr;
+      m_acFeaturePacks = nullptr;
       m_aWeights = nullptr;
    }
 
-   void DestructDataSubsetInteraction(const size_t cFeatures);
+   void DestructDataSubsetInteraction(const size_t cFeatures, const bool bBorrowedData, const bool bBorrowedWeights);
 
    inline size_t GetCountSamples() const { return m_cSamples; }
 
@@ -71,6 +75,11 @@ struct DataSubsetInteraction final {
       return m_aaFeatureData[iFeature];
    }
 
+   inline int GetFeaturePack(const size_t iFeature) const {
+      EBM_ASSERT(nullptr != m_acFeaturePacks);
+      return m_acFeaturePacks[iFeature];
+   }
+
    inline const void* GetWeights() const { return m_aWeights; }
 
  private:
@@ -78,6 +87,7 @@ struct DataSubsetInteraction final {
    const ObjectiveWrapper* m_pObjective;
    void* m_aGradHess;
    void** m_aaFeatureData;
+   int* m_acFeaturePacks;
    void* m_aWeights;
 };
 static_assert(std::is_standard_layout<DataSubsetInteraction>::value,
@@ -96,6 +106,11 @@ struct DataSetInteraction final {
       m_cSubsets = 0;
       m_aSubsets = nullptr;
       m_weightTotal = 0.0;
+      m_bBorrowedData = false;
+      m_bBorrowedWeights = false;
+      for(size_t iSection = 0; iSection < k_cMemorySections; ++iSection) {
+         m_acBytes[iSection] = 0;
+      }
    }
 
    ErrorEbm InitDataSetInteraction(const bool bAllocateHessians,
@@ -110,6 +125,14 @@ struct DataSetInteraction final {
          const size_t cWeights,
          const size_t cFeatures);
 
+   // points the subsets at the training subsets of a booster instead of copying them. The gradients, hessians and
+   // feature data belong to pTrainingSet. The feature data of iFeature is the term data of aiFeatureTerms[iFeature],
+   // which must be a term of only that feature, or SIZE_MAX for a feature that cannot be used
+   ErrorEbm InitDataSetInteractionFromBoosting(DataSetBoosting* const pTrainingSet,
+         const size_t cInnerBags,
+         const size_t cFeatures,
+         const size_t* const aiFeatureTerms);
+
    void DestructDataSetInteraction(const size_t cFeatures);
 
    inline size_t GetCountSamples() const { return m_cSamples; }
@@ -120,7 +143,26 @@ struct DataSetInteraction final {
    }
    inline double GetWeightTotal() const { return m_weightTotal; }
 
+   // the borrowed term data of DataSetBoosting holds one more packed item per lane than the samples, and the borrowed
+   // gradients and hessians are not premultiplied by the weights
+   inline bool IsBorrowedData() const { return m_bBorrowedData; }
+
+   // the bytes that this dataset allocated for a MemorySection, which excludes anything borrowed from a booster
+   inline size_t GetCountBytes(const size_t iSection) const {
+      EBM_ASSERT(iSection < k_cMemorySections);
+      return m_acBytes[iSection];
+   }
+
+   inline bool IsFeatureBinned(const size_t iFeature) const {
+      EBM_ASSERT(nullptr != m_aSubsets);
+      return nullptr != m_aSubsets[0].GetFeatureData(iFeature);
+   }
+
  private:
+   inline void AddCountBytes(const IntEbm section, const size_t cBytes) {
+      m_acBytes[static_cast<size_t>(section)] += cBytes;
+   }
+
    ErrorEbm InitGradHess(const bool bAllocateHessians, const size_t cScores);
 
    ErrorEbm InitFeatureData(const unsigned char* const pDataSetShared,
@@ -134,6 +176,9 @@ struct DataSetInteraction final {
    size_t m_cSubsets;
    DataSubsetInteraction* m_aSubsets;
    double m_weightTotal;
+   bool m_bBorrowedData;
+   bool m_bBorrowedWeights;
+   size_t m_acBytes[k_cMemorySections];
 };
 static_assert(std::is_standard_layout<DataSetInteraction>::value,
       "We use the struct hack in several places, so disallow non-standard_layout types in general");
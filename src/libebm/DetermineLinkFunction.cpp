@@ -11,7 +11,7 @@
 #define ZONE_main
 #include "zones.h"
 
-#include "bridge.hpp" // IdentifyTask
+#include "bridge.hpp" // ObjectiveWrapper
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -52,7 +52,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DetermineTask(const char* objective
    FreeObjectiveWrapperInternals(&objectiveWrapper);
 
    if(nullptr != taskOut) {
-      *taskOut = IdentifyTask(objectiveWrapper.m_linkFunction);
+      *taskOut = objectiveWrapper.m_task;
    }
 
    LOG_0(Trace_Info, "Exited DetermineTask");
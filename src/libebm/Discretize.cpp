@@ -10,6 +10,8 @@
 // otherwise use the C versions that provide this guarantee
 
 #include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint8_t, uint16_t, uint32_t, uintptr_t
+#include <stdlib.h> // malloc, free
 #include <limits> // std::numeric_limits
 #include <string.h> // memcpy
 
@@ -21,6 +23,8 @@
 #include "zones.h"
 
 #include "common.hpp" // IsConvertError
+#include "ThreadPool.hpp"
+#include "Discretize.hpp"
 
 // TODO: check this file for how we handle subnormal numbers!  It's tricky if we get them
 
@@ -216,15 +220,48 @@ EBM_API_BODY IntEbm EBM_CALLING_CONVENTION DiscretizeOneSample(
    return static_cast<IntEbm>(middle);
 }
 
+// up to this many cuts we count the cuts lower or equal to each value instead of searching for them
+static constexpr size_t k_cDiscretizeLinearCutsMax = 16;
+
+extern void BuildEytzinger(const size_t cCuts,
+      const double* const cutsLowerBoundInclusive,
+      const size_t cLevels,
+      double* const aTree) {
+   // The Eytzinger layout stores a complete binary search tree in breadth first order with the root at index 1 and
+   // the children of node k at 2k and 2k+1.  The top levels that every search visits are packed together at the
+   // front of the array, and the 8 grandchildren-of-grandchildren of a node share a cache line, so unlike a sorted
+   // array the memory we touch during a search is mostly contiguous.  We fill every node of the complete tree so
+   // that all searches take exactly cLevels steps.  Nodes beyond the real cuts get NaN, which compares false and
+   // therefore acts like +infinity.
+
+   EBM_ASSERT(size_t{1} <= cLevels);
+   EBM_ASSERT(cCuts < size_t{1} << cLevels);
+
+   aTree[0] = std::numeric_limits<double>::quiet_NaN(); // unused, but keep the memory defined
+   size_t iNode = 1;
+   for(size_t iLevel = 0; iLevel < cLevels; ++iLevel) {
+      // the in-order rank of the first node on a level is 2^(cLevels-1-iLevel) - 1, and consecutive nodes on the
+      // same level are 2^(cLevels-iLevel) apart in the sorted order
+      const size_t iShift = cLevels - size_t{1} - iLevel;
+      const size_t iNodeEnd = iNode << 1;
+      size_t iRank = (size_t{1} << iShift) - size_t{1};
+      do {
+         aTree[iNode] = iRank < cCuts ? cutsLowerBoundInclusive[iRank] : std::numeric_limits<double>::quiet_NaN();
+         iRank += size_t{2} << iShift;
+         ++iNode;
+      } while(iNodeEnd != iNode);
+   }
+}
+
 // don't bother using a lock here.  We don't care if an extra log message is written out due to thread parallism
 static int g_cLogEnterDiscretize = 25;
 static int g_cLogExitDiscretize = 25;
 
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
-      const double* featureVals,
-      IntEbm countCuts,
-      const double* cutsLowerBoundInclusive,
-      IntEbm* binIndexesOut) {
+static ErrorEbm DiscretizeColumn(const IntEbm countSamples,
+      const double* const featureVals,
+      const IntEbm countCuts,
+      const double* const cutsLowerBoundInclusive,
+      IntEbm* const binIndexesOut) {
    // make the 0th bin always the missing value.  This makes cutting mains easier, since we always know where the
    // missing bin will be, and also the first non-missing bin.  We can also increment the pointer to the histogram
    // to the first non-missing bin and reduce our bin index numbers by one, which will allow us to compress
@@ -271,65 +308,41 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
    //         then doing our upper bound comparison all in one check.  We can then filter our 0 ==countCuts
    //         after that as a special case
 
-   LOG_COUNTED_N(&g_cLogEnterDiscretize,
-         Trace_Info,
-         Trace_Verbose,
-         "Entered Discretize: "
-         "countSamples=%" IntEbmPrintf ", "
-         "featureVals=%p, "
-         "countCuts=%" IntEbmPrintf ", "
-         "cutsLowerBoundInclusive=%p, "
-         "binIndexesOut=%p",
-         countSamples,
-         static_cast<const void*>(featureVals),
-         countCuts,
-         static_cast<const void*>(cutsLowerBoundInclusive),
-         static_cast<void*>(binIndexesOut));
-
-   ErrorEbm error;
-
    if(UNLIKELY(countSamples <= IntEbm{0})) {
       if(UNLIKELY(countSamples < IntEbm{0})) {
          LOG_0(Trace_Error, "ERROR Discretize countSamples cannot be negative");
-         error = Error_IllegalParamVal;
-         goto exit_with_log;
+         return Error_IllegalParamVal;
       } else {
          EBM_ASSERT(IntEbm{0} == countSamples);
-         error = Error_None;
-         goto exit_with_log;
+         return Error_None;
       }
    } else {
       if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
          // this needs to point to real memory, otherwise it's invalid
          LOG_0(Trace_Error, "ERROR Discretize countSamples was too large to fit into memory");
-         error = Error_IllegalParamVal;
-         goto exit_with_log;
+         return Error_IllegalParamVal;
       }
 
       const size_t cSamples = static_cast<size_t>(countSamples);
 
       if(IsMultiplyError(sizeof(*featureVals), cSamples)) {
          LOG_0(Trace_Error, "ERROR Discretize countSamples was too large to fit into featureVals");
-         error = Error_IllegalParamVal;
-         goto exit_with_log;
+         return Error_IllegalParamVal;
       }
 
       if(IsMultiplyError(sizeof(*binIndexesOut), cSamples)) {
          LOG_0(Trace_Error, "ERROR Discretize countSamples was too large to fit into binIndexesOut");
-         error = Error_IllegalParamVal;
-         goto exit_with_log;
+         return Error_IllegalParamVal;
       }
 
       if(UNLIKELY(nullptr == featureVals)) {
          LOG_0(Trace_Error, "ERROR Discretize featureVals cannot be null");
-         error = Error_IllegalParamVal;
-         goto exit_with_log;
+         return Error_IllegalParamVal;
       }
 
       if(UNLIKELY(nullptr == binIndexesOut)) {
          LOG_0(Trace_Error, "ERROR Discretize binIndexesOut cannot be null");
-         error = Error_IllegalParamVal;
-         goto exit_with_log;
+         return Error_IllegalParamVal;
       }
 
       const double* pVal = featureVals;
@@ -339,8 +352,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
       if(UNLIKELY(countCuts <= IntEbm{0})) {
          if(UNLIKELY(countCuts < IntEbm{0})) {
             LOG_0(Trace_Error, "ERROR Discretize countCuts cannot be negative");
-            error = Error_IllegalParamVal;
-            goto exit_with_log;
+            return Error_IllegalParamVal;
          }
          EBM_ASSERT(IntEbm{0} == countCuts);
 
@@ -353,14 +365,12 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
             ++piBin;
             ++pVal;
          } while(LIKELY(pValsEnd != pVal));
-         error = Error_None;
-         goto exit_with_log;
+         return Error_None;
       }
 
       if(UNLIKELY(nullptr == cutsLowerBoundInclusive)) {
          LOG_0(Trace_Error, "ERROR Discretize cutsLowerBoundInclusive cannot be null");
-         error = Error_IllegalParamVal;
-         goto exit_with_log;
+         return Error_IllegalParamVal;
       }
 
 #ifndef NDEBUG
@@ -398,8 +408,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
             ++piBin;
             ++pVal;
          } while(LIKELY(pValsEnd != pVal));
-         error = Error_None;
-         goto exit_with_log;
+         return Error_None;
       }
 
       if(PREDICTABLE(IntEbm{2} == countCuts)) {
@@ -419,8 +428,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
             ++piBin;
             ++pVal;
          } while(LIKELY(pValsEnd != pVal));
-         error = Error_None;
-         goto exit_with_log;
+         return Error_None;
       }
 
       if(PREDICTABLE(IntEbm{3} == countCuts)) {
@@ -442,8 +450,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
             ++piBin;
             ++pVal;
          } while(LIKELY(pValsEnd != pVal));
-         error = Error_None;
-         goto exit_with_log;
+         return Error_None;
       }
 
       if(PREDICTABLE(IntEbm{4} == countCuts)) {
@@ -467,8 +474,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
             ++piBin;
             ++pVal;
          } while(LIKELY(pValsEnd != pVal));
-         error = Error_None;
-         goto exit_with_log;
+         return Error_None;
       }
 
       if(PREDICTABLE(IntEbm{5} == countCuts)) {
@@ -494,8 +500,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
             ++piBin;
             ++pVal;
          } while(LIKELY(pValsEnd != pVal));
-         error = Error_None;
-         goto exit_with_log;
+         return Error_None;
       }
 
       if(PREDICTABLE(IntEbm{6} == countCuts)) {
@@ -523,8 +528,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
             ++piBin;
             ++pVal;
          } while(LIKELY(pValsEnd != pVal));
-         error = Error_None;
-         goto exit_with_log;
+         return Error_None;
       }
 
       double cutsLowerBoundInclusiveCopy[1023];
@@ -579,8 +583,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
                ++piBin;
                ++pVal;
             } while(LIKELY(pValsEnd != pVal));
-            error = Error_None;
-            goto exit_with_log;
+            return Error_None;
          }
       } else if(PREDICTABLE(countCuts <= IntEbm{30})) {
          static constexpr size_t cPower = 32;
@@ -629,8 +632,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
                ++piBin;
                ++pVal;
             } while(LIKELY(pValsEnd != pVal));
-            error = Error_None;
-            goto exit_with_log;
+            return Error_None;
          }
       } else if(PREDICTABLE(countCuts <= IntEbm{62})) {
          static constexpr size_t cPower = 64;
@@ -682,8 +684,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
                ++piBin;
                ++pVal;
             } while(LIKELY(pValsEnd != pVal));
-            error = Error_None;
-            goto exit_with_log;
+            return Error_None;
          }
       } else if(PREDICTABLE(countCuts <= IntEbm{126})) {
          static constexpr size_t cPower = 128;
@@ -738,8 +739,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
                ++piBin;
                ++pVal;
             } while(LIKELY(pValsEnd != pVal));
-            error = Error_None;
-            goto exit_with_log;
+            return Error_None;
          }
       } else if(PREDICTABLE(countCuts <= IntEbm{254})) {
          static constexpr size_t cPower = 256;
@@ -797,8 +797,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
                ++piBin;
                ++pVal;
             } while(LIKELY(pValsEnd != pVal));
-            error = Error_None;
-            goto exit_with_log;
+            return Error_None;
          }
       } else if(PREDICTABLE(countCuts <= IntEbm{510})) {
          static constexpr size_t cPower = 512;
@@ -859,8 +858,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
                ++piBin;
                ++pVal;
             } while(LIKELY(pValsEnd != pVal));
-            error = Error_None;
-            goto exit_with_log;
+            return Error_None;
          }
       } else if(PREDICTABLE(countCuts <= IntEbm{1022})) {
          static constexpr size_t cPower = 1024;
@@ -924,22 +922,48 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
                ++piBin;
                ++pVal;
             } while(LIKELY(pValsEnd != pVal));
-            error = Error_None;
-            goto exit_with_log;
+            return Error_None;
+         }
+      }
+
+      if(PREDICTABLE(countCuts <= IntEbm{k_cDiscretizeLinearCutsMax})) {
+         // we get here when there are too few samples to amortize padding the cuts for the searches above.  For a
+         // handful of cuts the bin index is just 1 + the count of cuts that are lower or equal to the value.
+         // Comparing against every cut has no dependency chain between loads like the binary search below does,
+         // and the fixed length inner loop is something the compiler turns into a few SIMD compares and adds.
+         // We pad with NaN which always compares false, so the padding never counts.
+         double cutsPadded[k_cDiscretizeLinearCutsMax];
+         memcpy(cutsPadded, cutsLowerBoundInclusive, sizeof(*cutsLowerBoundInclusive) * cCuts);
+         for(size_t iPad = cCuts; iPad < k_cDiscretizeLinearCutsMax; ++iPad) {
+            cutsPadded[iPad] = std::numeric_limits<double>::quiet_NaN();
          }
+
+         do {
+            const double val = *pVal;
+            size_t cLowerOrEqual = size_t{1};
+            for(size_t iCut = 0; iCut < k_cDiscretizeLinearCutsMax; ++iCut) {
+               cLowerOrEqual += static_cast<size_t>(cutsPadded[iCut] <= val);
+            }
+            const IntEbm iBin = UNPREDICTABLE(std::isnan(val)) ? IntEbm{0} : static_cast<IntEbm>(cLowerOrEqual);
+
+            EBM_ASSERT(iBin == DiscretizeOneSample(val, countCuts, cutsLowerBoundInclusive));
+
+            *piBin = iBin;
+            ++piBin;
+            ++pVal;
+         } while(LIKELY(pValsEnd != pVal));
+         return Error_None;
       }
 
       if(UNLIKELY(IsConvertError<size_t>(countCuts))) {
          // this needs to point to real memory, otherwise it's invalid
          LOG_0(Trace_Error, "ERROR Discretize countCuts was too large to fit into memory");
-         error = Error_IllegalParamVal; // the cutsLowerBoundInclusive wouldn't be possible
-         goto exit_with_log;
+         return Error_IllegalParamVal; // the cutsLowerBoundInclusive wouldn't be possible
       }
 
       if(IsMultiplyError(sizeof(*cutsLowerBoundInclusive), cCuts)) {
          LOG_0(Trace_Error, "ERROR Discretize countCuts was too large to fit into cutsLowerBoundInclusive");
-         error = Error_IllegalParamVal; // the cutsLowerBoundInclusive array wouldn't be possible
-         goto exit_with_log;
+         return Error_IllegalParamVal; // the cutsLowerBoundInclusive array wouldn't be possible
       }
 
       if(UNLIKELY(std::numeric_limits<IntEbm>::max() - IntEbm{2} < countCuts)) {
@@ -953,8 +977,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
          // this is a non-overflow somewhat arbitrary number for the upper level software to understand
          // so instead of returning illegal parameter, we should return out of memory and pretend that we
          // tried to allocate it since it doesn't seem worth creating a new error class for it
-         error = Error_OutOfMemory;
-         goto exit_with_log;
+         return Error_OutOfMemory;
       }
 
       if(UNLIKELY(std::numeric_limits<size_t>::max() == cCuts)) {
@@ -964,8 +987,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
          // this is a non-overflow somewhat arbitrary number for the upper level software to understand
          // so instead of returning illegal parameter, we should return out of memory and pretend that we
          // tried to allocate it since it doesn't seem worth creating a new error class for it
-         error = Error_OutOfMemory;
-         goto exit_with_log;
+         return Error_OutOfMemory;
       }
 
       if(UNLIKELY(size_t{std::numeric_limits<ptrdiff_t>::max()} < cCuts)) {
@@ -976,8 +998,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
          // this is a non-overflow somewhat arbitrary number for the upper level software to understand
          // so instead of returning illegal parameter, we should return out of memory and pretend that we
          // tried to allocate it since it doesn't seem worth creating a new error class for it
-         error = Error_OutOfMemory;
-         goto exit_with_log;
+         return Error_OutOfMemory;
       }
 
       if(UNLIKELY(std::numeric_limits<size_t>::max() / size_t{2} + size_t{1} < cCuts)) {
@@ -989,8 +1010,42 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
          // this is a non-overflow somewhat arbitrary number for the upper level software to understand
          // so instead of returning illegal parameter, we should return out of memory and pretend that we
          // tried to allocate it since it doesn't seem worth creating a new error class for it
-         error = Error_OutOfMemory;
-         goto exit_with_log;
+         return Error_OutOfMemory;
+      }
+
+      const size_t cLevels = GetEytzingerLevels(cCuts);
+      EBM_ASSERT(cLevels < static_cast<size_t>(COUNT_BITS(size_t)));
+      const size_t cTreeNodes = size_t{1} << cLevels;
+
+      // Building the tree touches every node once, which costs less than the mispredicted branches that the
+      // binary search below takes on each sample once we have at least as many samples as tree nodes
+      if(cTreeNodes <= cSamples && !IsMultiplyError(sizeof(double), cTreeNodes)) {
+         double* const aTree = static_cast<double*>(AlignedAlloc(sizeof(double) * cTreeNodes));
+         if(LIKELY(nullptr != aTree)) {
+            BuildEytzinger(cCuts, cutsLowerBoundInclusive, cLevels, aTree);
+
+            const double* const pValsLanesEnd = pValsEnd - cSamples % k_cDiscretizeLanes;
+            while(pValsLanesEnd != pVal) {
+               DiscretizeEytzinger(k_cDiscretizeLanes, pVal, piBin, cLevels, aTree);
+               pVal += k_cDiscretizeLanes;
+               piBin += k_cDiscretizeLanes;
+            }
+            if(pValsEnd != pVal) {
+               DiscretizeEytzinger(static_cast<size_t>(pValsEnd - pVal), pVal, piBin, cLevels, aTree);
+            }
+
+#ifndef NDEBUG
+            for(size_t iDebug = 0; iDebug < cSamples; ++iDebug) {
+               EBM_ASSERT(binIndexesOut[iDebug] ==
+                     DiscretizeOneSample(featureVals[iDebug], countCuts, cutsLowerBoundInclusive));
+            }
+#endif // NDEBUG
+
+            AlignedFree(aTree);
+            return Error_None;
+         }
+         // if we can't get the memory then the binary search below still works without it
+         LOG_0(Trace_Warning, "WARNING Discretize AlignedAlloc failed, falling back to binary search");
       }
 
       EBM_ASSERT(cCuts < std::numeric_limits<size_t>::max());
@@ -1060,10 +1115,34 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
          ++piBin;
          ++pVal;
       } while(LIKELY(pValsEnd != pVal));
-      error = Error_None;
+      return Error_None;
    }
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
+      const double* featureVals,
+      IntEbm countCuts,
+      const double* cutsLowerBoundInclusive,
+      IntEbm* binIndexesOut) {
+   // DiscretizeColumn does not log since DiscretizeBatch calls it from multiple threads and the log counts are not
+   // thread safe
+   LOG_COUNTED_N(&g_cLogEnterDiscretize,
+         Trace_Info,
+         Trace_Verbose,
+         "Entered Discretize: "
+         "countSamples=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "countCuts=%" IntEbmPrintf ", "
+         "cutsLowerBoundInclusive=%p, "
+         "binIndexesOut=%p",
+         countSamples,
+         static_cast<const void*>(featureVals),
+         countCuts,
+         static_cast<const void*>(cutsLowerBoundInclusive),
+         static_cast<void*>(binIndexesOut));
 
-exit_with_log:;
+   const ErrorEbm error =
+         DiscretizeColumn(countSamples, featureVals, countCuts, cutsLowerBoundInclusive, binIndexesOut);
 
    LOG_COUNTED_N(&g_cLogExitDiscretize,
          Trace_Info,
@@ -1075,4 +1154,273 @@ exit_with_log:;
    return error;
 }
 
+// DiscretizeBatch works on chunks of each column so that the IntEbm bins that DiscretizeColumn writes stay in cache
+// until we narrow them.  The chunk is large enough that the setup in DiscretizeColumn is amortized for most cut counts
+static constexpr size_t k_cDiscretizeBatchChunk = 16384;
+// every column starts on a boundary that works for all of the bin index widths
+static constexpr size_t k_cBytesDiscretizeBatchAlign = sizeof(uint32_t);
+
+static size_t GetDiscretizeBatchBytesPerBinIndex(const size_t cCuts) {
+   // the highest bin index that Discretize returns is 1 + cCuts, and the callers have ensured it fits in a uint32_t
+   if(cCuts < size_t{std::numeric_limits<uint8_t>::max()}) {
+      return sizeof(uint8_t);
+   }
+   if(cCuts < size_t{std::numeric_limits<uint16_t>::max()}) {
+      return sizeof(uint16_t);
+   }
+   return sizeof(uint32_t);
+}
+
+// returns the number of bytes that the bin indexes of all the columns need, or a negative ErrorEbm.  If the
+// output arrays are not nullptr, they receive the byte offset and bin index width of each column
+static IntEbm LayoutDiscretizeBatch(const IntEbm countSamples,
+      const IntEbm countColumns,
+      const IntEbm* const countCuts,
+      IntEbm* const binIndexesOffsetsOut,
+      IntEbm* const countBytesPerBinIndexOut) {
+   if(UNLIKELY(countSamples < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch countSamples < IntEbm { 0 }");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
+      LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   if(UNLIKELY(countColumns < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch countColumns < IntEbm { 0 }");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countColumns))) {
+      LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch IsConvertError<size_t>(countColumns)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cColumns = static_cast<size_t>(countColumns);
+
+   if(UNLIKELY(size_t{0} != cColumns && nullptr == countCuts)) {
+      LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch nullptr == countCuts");
+      return Error_IllegalParamVal;
+   }
+
+   size_t cBytesTotal = 0;
+   for(size_t iColumn = 0; iColumn < cColumns; ++iColumn) {
+      const IntEbm countCutsColumn = countCuts[iColumn];
+      if(UNLIKELY(countCutsColumn < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch countCuts can't be negative");
+         return Error_IllegalParamVal;
+      }
+      if(UNLIKELY(IsConvertError<size_t>(countCutsColumn) ||
+               size_t{std::numeric_limits<uint32_t>::max()} - size_t{1} <= static_cast<size_t>(countCutsColumn))) {
+         LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch countCuts too large for a uint32_t bin index");
+         return Error_IllegalParamVal;
+      }
+      const size_t cBytesPerBinIndex = GetDiscretizeBatchBytesPerBinIndex(static_cast<size_t>(countCutsColumn));
+
+      if(UNLIKELY(IsMultiplyError(cBytesPerBinIndex, cSamples))) {
+         LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch IsMultiplyError(cBytesPerBinIndex, cSamples)");
+         return Error_IllegalParamVal;
+      }
+      size_t cBytesColumn = cBytesPerBinIndex * cSamples;
+      if(UNLIKELY(IsAddError(cBytesColumn, k_cBytesDiscretizeBatchAlign - size_t{1}))) {
+         LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch IsAddError(cBytesColumn, k_cBytesDiscretizeBatchAlign - 1)");
+         return Error_IllegalParamVal;
+      }
+      cBytesColumn = (cBytesColumn + k_cBytesDiscretizeBatchAlign - size_t{1}) / k_cBytesDiscretizeBatchAlign *
+            k_cBytesDiscretizeBatchAlign;
+
+      if(UNLIKELY(IsAddError(cBytesTotal, cBytesColumn) || IsConvertError<IntEbm>(cBytesTotal + cBytesColumn))) {
+         LOG_0(Trace_Error, "ERROR LayoutDiscretizeBatch the total number of bytes does not fit into an IntEbm");
+         return Error_IllegalParamVal;
+      }
+
+      if(nullptr != binIndexesOffsetsOut) {
+         binIndexesOffsetsOut[iColumn] = static_cast<IntEbm>(cBytesTotal);
+      }
+      if(nullptr != countBytesPerBinIndexOut) {
+         countBytesPerBinIndexOut[iColumn] = static_cast<IntEbm>(cBytesPerBinIndex);
+      }
+      cBytesTotal += cBytesColumn;
+   }
+   return static_cast<IntEbm>(cBytesTotal);
+}
+
+template<typename TUInt> static void NarrowBinIndexes(const size_t cSamples, const IntEbm* const aiBins, void* const p) {
+   TUInt* const aNarrow = static_cast<TUInt*>(p);
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      EBM_ASSERT(!IsConvertError<TUInt>(aiBins[iSample]));
+      aNarrow[iSample] = static_cast<TUInt>(aiBins[iSample]);
+   }
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureDiscretizeBatch(
+      IntEbm countSamples, IntEbm countColumns, const IntEbm* countCuts) {
+   return LayoutDiscretizeBatch(countSamples, countColumns, countCuts, nullptr, nullptr);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DiscretizeBatch(IntEbm countSamples,
+      IntEbm countColumns,
+      const double* featureVals,
+      const IntEbm* countCuts,
+      const double* cutsLowerBoundInclusive,
+      IntEbm countBytesAllocated,
+      void* binIndexesOut,
+      IntEbm* binIndexesOffsetsOut,
+      IntEbm* countBytesPerBinIndexOut) {
+   LOG_N(Trace_Info,
+         "Entered DiscretizeBatch: "
+         "countSamples=%" IntEbmPrintf ", "
+         "countColumns=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "countCuts=%p, "
+         "cutsLowerBoundInclusive=%p, "
+         "countBytesAllocated=%" IntEbmPrintf ", "
+         "binIndexesOut=%p, "
+         "binIndexesOffsetsOut=%p, "
+         "countBytesPerBinIndexOut=%p",
+         countSamples,
+         countColumns,
+         static_cast<const void*>(featureVals),
+         static_cast<const void*>(countCuts),
+         static_cast<const void*>(cutsLowerBoundInclusive),
+         countBytesAllocated,
+         binIndexesOut,
+         static_cast<void*>(binIndexesOffsetsOut),
+         static_cast<void*>(countBytesPerBinIndexOut));
+
+   if(UNLIKELY(nullptr == binIndexesOffsetsOut)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeBatch nullptr == binIndexesOffsetsOut");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == countBytesPerBinIndexOut)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeBatch nullptr == countBytesPerBinIndexOut");
+      return Error_IllegalParamVal;
+   }
+
+   const IntEbm countBytesRequired =
+         LayoutDiscretizeBatch(countSamples, countColumns, countCuts, binIndexesOffsetsOut, countBytesPerBinIndexOut);
+   if(UNLIKELY(countBytesRequired < IntEbm{0})) {
+      return static_cast<ErrorEbm>(countBytesRequired);
+   }
+   if(UNLIKELY(countBytesAllocated < countBytesRequired)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeBatch countBytesAllocated < MeasureDiscretizeBatch");
+      return Error_IllegalParamVal;
+   }
+
+   // LayoutDiscretizeBatch checked these
+   const size_t cSamples = static_cast<size_t>(countSamples);
+   const size_t cColumns = static_cast<size_t>(countColumns);
+   if(size_t{0} == cSamples || size_t{0} == cColumns) {
+      return Error_None;
+   }
+
+   if(UNLIKELY(nullptr == binIndexesOut)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeBatch nullptr == binIndexesOut");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(size_t{0} != reinterpret_cast<uintptr_t>(binIndexesOut) % k_cBytesDiscretizeBatchAlign)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeBatch binIndexesOut must be aligned to 4 bytes");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == featureVals)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeBatch nullptr == featureVals");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsMultiplyError(sizeof(*featureVals), cSamples, cColumns))) {
+      LOG_0(Trace_Error, "ERROR DiscretizeBatch IsMultiplyError(sizeof(*featureVals), cSamples, cColumns)");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cChunks = (cSamples - size_t{1}) / k_cDiscretizeBatchChunk + size_t{1};
+   if(UNLIKELY(IsMultiplyError(cChunks, cColumns))) {
+      LOG_0(Trace_Error, "ERROR DiscretizeBatch IsMultiplyError(cChunks, cColumns)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTasks = cChunks * cColumns;
+
+   if(UNLIKELY(IsMultiplyError(sizeof(size_t), cColumns))) {
+      LOG_0(Trace_Warning, "WARNING DiscretizeBatch IsMultiplyError(sizeof(size_t), cColumns)");
+      return Error_OutOfMemory;
+   }
+   size_t* const aiCutsFirst = static_cast<size_t*>(malloc(sizeof(size_t) * cColumns));
+   if(UNLIKELY(nullptr == aiCutsFirst)) {
+      LOG_0(Trace_Warning, "WARNING DiscretizeBatch nullptr == aiCutsFirst");
+      return Error_OutOfMemory;
+   }
+   // LayoutDiscretizeBatch checked each countCuts, but not that their total fits
+   size_t cCutsTotal = 0;
+   for(size_t iColumn = 0; iColumn < cColumns; ++iColumn) {
+      aiCutsFirst[iColumn] = cCutsTotal;
+      const size_t cCuts = static_cast<size_t>(countCuts[iColumn]);
+      if(UNLIKELY(IsAddError(cCutsTotal, cCuts))) {
+         LOG_0(Trace_Error, "ERROR DiscretizeBatch the total number of cuts does not fit into a size_t");
+         free(aiCutsFirst);
+         return Error_IllegalParamVal;
+      }
+      cCutsTotal += cCuts;
+   }
+   if(UNLIKELY(size_t{0} != cCutsTotal && nullptr == cutsLowerBoundInclusive)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeBatch nullptr == cutsLowerBoundInclusive");
+      free(aiCutsFirst);
+      return Error_IllegalParamVal;
+   }
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cTasks, &pThreadPool);
+   if(Error_None != error) {
+      free(aiCutsFirst);
+      return error;
+   }
+   const size_t cThreads = pThreadPool->GetCountThreads();
+
+   // this can't overflow since k_cDiscretizeBatchChunk is small and the ThreadPool allocated cThreads std::thread
+   EBM_ASSERT(!IsMultiplyError(sizeof(IntEbm), k_cDiscretizeBatchChunk, cThreads));
+   IntEbm* const aScratch = static_cast<IntEbm*>(malloc(sizeof(IntEbm) * k_cDiscretizeBatchChunk * cThreads));
+   if(UNLIKELY(nullptr == aScratch)) {
+      LOG_0(Trace_Warning, "WARNING DiscretizeBatch nullptr == aScratch");
+      ThreadPool::Return(pThreadPool);
+      free(aiCutsFirst);
+      return Error_OutOfMemory;
+   }
+
+   auto discretizeChunk = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      EBM_ASSERT(iThread < cThreads);
+      const size_t iColumn = iTask / cChunks;
+      const size_t iSampleFirst = iTask % cChunks * k_cDiscretizeBatchChunk;
+      const size_t cSamplesChunk = EbmMin(k_cDiscretizeBatchChunk, cSamples - iSampleFirst);
+
+      IntEbm* const aiBins = &aScratch[k_cDiscretizeBatchChunk * iThread];
+      const ErrorEbm errorChunk = DiscretizeColumn(static_cast<IntEbm>(cSamplesChunk),
+            featureVals + cSamples * iColumn + iSampleFirst,
+            countCuts[iColumn],
+            nullptr == cutsLowerBoundInclusive ? nullptr : cutsLowerBoundInclusive + aiCutsFirst[iColumn],
+            aiBins);
+      if(Error_None != errorChunk) {
+         return errorChunk;
+      }
+
+      const size_t cBytesPerBinIndex = static_cast<size_t>(countBytesPerBinIndexOut[iColumn]);
+      void* const pNarrow = static_cast<unsigned char*>(binIndexesOut) +
+            static_cast<size_t>(binIndexesOffsetsOut[iColumn]) + cBytesPerBinIndex * iSampleFirst;
+      if(sizeof(uint8_t) == cBytesPerBinIndex) {
+         NarrowBinIndexes<uint8_t>(cSamplesChunk, aiBins, pNarrow);
+      } else if(sizeof(uint16_t) == cBytesPerBinIndex) {
+         NarrowBinIndexes<uint16_t>(cSamplesChunk, aiBins, pNarrow);
+      } else {
+         EBM_ASSERT(sizeof(uint32_t) == cBytesPerBinIndex);
+         NarrowBinIndexes<uint32_t>(cSamplesChunk, aiBins, pNarrow);
+      }
+      return Error_None;
+   };
+   error = pThreadPool->Run(cTasks, discretizeChunk);
+
+   free(aScratch);
+   ThreadPool::Return(pThreadPool);
+   free(aiCutsFirst);
+
+   LOG_N(Trace_Info, "Exited DiscretizeBatch: return=%" ErrorEbmPrintf, error);
+
+   return error;
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,89 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef DISCRETIZE_HPP
+#define DISCRETIZE_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <cmath> // std::isnan
+
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // INLINE_ALWAYS, PREFETCH_READ
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// the Eytzinger search below advances this many samples in lockstep so that their memory fetches overlap
+static constexpr size_t k_cDiscretizeLanes = 8;
+// each level of the Eytzinger tree doubles the index, so 4 levels ahead is 16 nodes or 2 cache lines of doubles
+static constexpr size_t k_cDiscretizePrefetchLevels = 4;
+
+// the number of levels in the smallest complete tree that holds cCuts.  There is always at least 1 level so that
+// zero cuts still has a node to compare against
+INLINE_ALWAYS static size_t GetEytzingerLevels(const size_t cCuts) {
+   size_t cLevels = 1;
+   while((size_t{1} << cLevels) - size_t{1} < cCuts) {
+      ++cLevels;
+   }
+   return cLevels;
+}
+
+// aTree needs 2^cLevels doubles
+extern void BuildEytzinger(const size_t cCuts,
+      const double* const cutsLowerBoundInclusive,
+      const size_t cLevels,
+      double* const aTree);
+
+template<typename TBin>
+INLINE_ALWAYS static void DiscretizeEytzinger(const size_t cLanes,
+      const double* const pVal,
+      TBin* const piBin,
+      const size_t cLevels,
+      const double* const aTree) {
+   // Each lane walks the tree going right when the node is lower or equal to its value.  In a complete tree the
+   // path taken spells out the in-order rank of the leaf we exit at, so after cLevels steps the node index minus
+   // 2^cLevels is the count of cuts lower or equal to the value.  NaN values compare false everywhere and arrive at
+   // rank 0, which we then move to the missing bin.  Interleaving the lanes lets the CPU have several independent
+   // loads in flight instead of waiting on each one, and there are no branches for it to mispredict.
+
+   EBM_ASSERT(cLanes <= k_cDiscretizeLanes);
+
+   double aVals[k_cDiscretizeLanes];
+   size_t aiNode[k_cDiscretizeLanes];
+   for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+      aVals[iLane] = pVal[iLane];
+      aiNode[iLane] = size_t{1};
+   }
+
+   size_t iLevel = 0;
+   while(iLevel + k_cDiscretizePrefetchLevels < cLevels) {
+      for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+         const size_t iNode = aiNode[iLane];
+         PREFETCH_READ(&aTree[iNode << k_cDiscretizePrefetchLevels]);
+         aiNode[iLane] = (iNode << 1) + static_cast<size_t>(aTree[iNode] <= aVals[iLane]);
+      }
+      ++iLevel;
+   }
+   while(iLevel < cLevels) {
+      for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+         const size_t iNode = aiNode[iLane];
+         aiNode[iLane] = (iNode << 1) + static_cast<size_t>(aTree[iNode] <= aVals[iLane]);
+      }
+      ++iLevel;
+   }
+
+   // the leaf index is 2^cLevels + rank, and our bins start at 1 since bin 0 is for missing values
+   const size_t iLeafToBin = (size_t{1} << cLevels) - size_t{1};
+   for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+      const TBin iBin =
+            UNPREDICTABLE(std::isnan(aVals[iLane])) ? TBin{0} : static_cast<TBin>(aiNode[iLane] - iLeafToBin);
+      piBin[iLane] = iBin;
+   }
+}
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // DISCRETIZE_HPP
@@ -262,19 +262,35 @@ template<typename TRng> inline static bool CoinFlip(TRng& rng) {
    return static_cast<bool>(rng.Next(uint64_t{1}));
 }
 
-inline static double ApproximateBinomialProbability(double sqrt_n, int64_t m) {
+struct BinomialApproximation final {
    // Approximates the probability of a random sample m + n / 2 drawn from a
    // binomial distribution of n Bernoulli trials that have a success probability
    // of 1 / 2 each. The approximation is taken from Lemma 7 of the noise
    // generation documentation available in
    // https://github.com/google/differential-privacy/blob/main/common_docs/Secure_Noise_Generation.pdf
-
-   const double n = sqrt_n * sqrt_n;
-   if(std::abs(m) > sqrt_n * std::sqrt(std::log(n)) / 2) {
-      return 0;
+   //
+   // Google's version recomputes the log, sqrt and pow terms below on every rejection sampling round.  They depend
+   // only on sqrt_n, so we compute them once per fill.  The expressions and their evaluation order are unchanged,
+   // so the probabilities are bit-identical to the per-call version.
+
+   double n;
+   double bound;
+   double scale;
+   double correction;
+
+   inline BinomialApproximation(double sqrt_n) :
+         n(sqrt_n * sqrt_n),
+         bound(sqrt_n * std::sqrt(std::log(n)) / 2),
+         scale(std::sqrt(2 / kPi) / sqrt_n),
+         correction(1 - (0.4 * std::pow(std::log(n), 1.5) / sqrt_n)) {}
+
+   inline double Probability(int64_t m) const {
+      if(std::abs(m) > bound) {
+         return 0;
+      }
+      return scale * std::exp(-2.0 * m * m / n) * correction;
    }
-   return std::sqrt(2 / kPi) / sqrt_n * std::exp(-2.0 * m * m / n) * (1 - (0.4 * std::pow(std::log(n), 1.5) / sqrt_n));
-}
+};
 
 inline static int CountLeadingZeroes64(uint64_t x) {
    // FROM:
@@ -363,23 +379,44 @@ class GaussianDistribution final {
       return GetNextPowerOfTwo(2 * sigma / kBinomialBound);
    }
 
-   template<typename TRng> inline double Sample(TRng& rng, double scale) {
-      EBM_ASSERT(0 < scale);
-
+   inline double GetSqrtN(double scale, double granularity) const {
       double sigma = scale * stddev_;
-      // Use at least the lowest positive floating point number as granularity when
-      // sigma is very small.
-      double granularity = std::max(GetGranularity(scale), std::numeric_limits<double>::min());
-
       // The square root of n is chosen in a way that ensures that the respective
       // binomial distribution approximates a Gaussian distribution close enough.
       // The sqrt(n) is taken instead of n, to ensure that all results of arithmetic
       // operations fit in 64 bit integer range.
-      double sqrt_n = 2.0 * sigma / granularity;
-      return SampleBinomial(rng, sqrt_n) * granularity;
+      return 2.0 * sigma / granularity;
+   }
+
+   template<typename TRng> inline double Sample(TRng& rng, double scale) {
+      double result;
+      Fill(rng, scale, 1, &result);
+      return result;
    }
 
-   template<typename TRng> inline double SampleBinomial(TRng& rng, double sqrt_n) {
+   template<typename TRng> inline void Fill(TRng& rng, double scale, size_t cSamples, double* aOut) {
+      // Fills aOut with cSamples independent samples.  Everything except the rejection sampling itself depends only
+      // on scale and stddev_, so it is computed once here instead of once per sample.
+
+      EBM_ASSERT(0 < scale);
+      EBM_ASSERT(0 == cSamples || nullptr != aOut);
+
+      // Use at least the lowest positive floating point number as granularity when
+      // sigma is very small.
+      const double granularity = std::max(GetGranularity(scale), std::numeric_limits<double>::min());
+      const double sqrt_n = GetSqrtN(scale, granularity);
+      const int64_t step_size = static_cast<int64_t>(std::round(std::sqrt(2.0) * sqrt_n + 1));
+      const BinomialApproximation approximation(sqrt_n);
+
+      const double* const aOutEnd = aOut + cSamples;
+      while(aOutEnd != aOut) {
+         *aOut = SampleBinomial(rng, step_size, approximation) * granularity;
+         ++aOut;
+      }
+   }
+
+   template<typename TRng>
+   inline double SampleBinomial(TRng& rng, const int64_t step_size, const BinomialApproximation& approximation) {
       // Returns a random sample m where {@code m + n / 2} is drawn from a binomial
       // distribution of n Bernoulli trials that have a success probability of 1 / 2
       // each. The sampling technique is based on Bringmann et al.'s rejection
@@ -389,19 +426,18 @@ class GaussianDistribution final {
       // of n must be at least 10^6. This is to ensure an accurate approximation of a
       // Gaussian distribution.
 
-      int64_t step_size = static_cast<int64_t>(std::round(std::sqrt(2.0) * sqrt_n + 1));
-
       while(true) {
          int geom_sample = SampleGeometric(rng);
          int two_sided_geom = CoinFlip(rng) ? geom_sample : (-geom_sample - 1);
          int64_t uniform_sample = static_cast<int64_t>(rng.Next(static_cast<uint64_t>(step_size)));
          int64_t result = step_size * two_sided_geom + uniform_sample;
 
-         double result_prob = ApproximateBinomialProbability(sqrt_n, result);
+         double result_prob = approximation.Probability(result);
          double reject_prob = UniformDouble(rng);
 
+         // std::ldexp(1.0, k) is exactly std::pow(2.0, k) for the small integer k here, without the general pow
          if(result_prob > 0 && reject_prob > 0 &&
-               reject_prob < result_prob * step_size * std::pow(2.0, geom_sample - 2)) {
+               reject_prob < result_prob * step_size * std::ldexp(1.0, geom_sample - 2)) {
             return static_cast<double>(result);
          }
       }
@@ -29,6 +29,8 @@
 #include "InnerBag.hpp"
 #include "Tensor.hpp"
 #include "TreeNode.hpp"
+#include "ThreadPool.hpp"
+#include "Profile.hpp"
 #include "BoosterCore.hpp"
 #include "BoosterShell.hpp"
 
@@ -37,6 +39,9 @@ namespace DEFINED_ZONE_NAME {
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
+// the multi-dimensional sweep is only split across threads if each task gets at least this many cut combinations
+static constexpr size_t k_cCutCombinationsPerTaskMin = size_t{256};
+
 extern ErrorEbm PurifyInternal(const double tolerance,
       const size_t cScores,
       const size_t cTensorBins,
@@ -47,7 +52,8 @@ extern ErrorEbm PurifyInternal(const double tolerance,
       const double* const aWeights,
       double* const pScores,
       double* const pImpurities,
-      double* const pIntercept);
+      double* const pIntercept,
+      size_t* const pcSweeps);
 
 extern void ConvertAddBin(const size_t cScores,
       const bool bHessian,
@@ -88,6 +94,7 @@ extern ErrorEbm PartitionOneDimensionalBoosting(RandomDeterministic* const pRng,
       const FloatCalc deltaStepMax,
       const size_t cSplitsMax,
       const MonotoneDirection direction,
+      const bool bSortNominal,
       const size_t cSamplesTotal,
       const FloatMain weightTotal,
       double* const pTotalGain);
@@ -112,7 +119,9 @@ extern ErrorEbm PartitionTwoDimensionalBoosting(const bool bHessian,
       double* const aTensorHess,
       double* const pTotalGain,
       const size_t cPossibleSplits,
-      void* const pTemp1
+      void* const pTemp1,
+      ThreadPool* const pThreadPool,
+      const size_t cTasks
 #ifndef NDEBUG
       ,
       const BinBase* const aDebugCopyBinsBase,
@@ -198,6 +207,7 @@ static ErrorEbm BoostSingleDimensional(RandomDeterministic* const pRng,
       BoosterShell* const pBoosterShell,
       const TermBoostFlags flags,
       const size_t cBins,
+      const size_t cSamplesTotal,
       const FloatMain weightTotal,
       const size_t iDimension,
       const size_t cSamplesLeafMin,
@@ -207,6 +217,7 @@ static ErrorEbm BoostSingleDimensional(RandomDeterministic* const pRng,
       const FloatCalc deltaStepMax,
       const IntEbm countLeavesMax,
       const MonotoneDirection direction,
+      const bool bSortNominal,
       double* const pTotalGain) {
    ErrorEbm error;
 
@@ -222,8 +233,9 @@ static ErrorEbm BoostSingleDimensional(RandomDeterministic* const pRng,
 
    BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
 
-   EBM_ASSERT(1 <= pBoosterCore->GetTrainingSet()->GetCountSamples());
+   EBM_ASSERT(1 <= cSamplesTotal);
 
+   const ProfileTimer timer(pBoosterCore->GetProfile());
    error = PartitionOneDimensionalBoosting(pRng,
          pBoosterShell,
          flags,
@@ -236,9 +248,13 @@ static ErrorEbm BoostSingleDimensional(RandomDeterministic* const pRng,
          deltaStepMax,
          cSplitsMax,
          direction,
-         pBoosterCore->GetTrainingSet()->GetCountSamples(),
+         bSortNominal,
+         cSamplesTotal,
          weightTotal,
          pTotalGain);
+   timer.Stop(ProfileSection_PartitionOneDimensional,
+         cBins,
+         cBins * GetBinSize<FloatMain, UIntMain>(true, true, pBoosterCore->IsHessian(), pBoosterCore->GetCountScores()));
 
    LOG_0(Trace_Verbose, "Exited BoostSingleDimensional");
    return error;
@@ -317,6 +333,7 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
 
    BinBase* aAuxiliaryBins = IndexBin(aMainBins, cBytesPerMainBin * cTensorBins);
 
+   const ProfileTimer timerTotals(pBoosterCore->GetProfile());
    TensorTotalsBuild(pBoosterCore->IsHessian(),
          cScores,
          pTerm->GetCountRealDimensions(),
@@ -329,6 +346,7 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
          pBoosterShell->GetDebugMainBinsEnd()
 #endif // NDEBUG
    );
+   timerTotals.Stop(ProfileSection_TensorTotalsBuild, cTensorBins, cBytesPerMainBin * (cTensorBins + cAuxillaryBins));
 
    const bool bHessian = pBoosterCore->IsHessian();
 
@@ -336,10 +354,7 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
    double* pGradient = nullptr;
    double* pHessian = nullptr;
    if(0 != ((TermBoostFlags_PurifyUpdate | TermBoostFlags_PurifyGain) & flags)) {
-      // allocate the biggest tensor that is possible to split into
-
-      // TODO: cache this memory allocation so that we don't do it each time
-
+      // reserve the biggest tensor that is possible to split into. The BoosterShell keeps it between calls
       if(IsAddError(size_t{1}, cScores)) {
          return Error_OutOfMemory;
       }
@@ -354,10 +369,11 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
       if(IsMultiplyError(sizeof(double), cItems, cTensorBins)) {
          return Error_OutOfMemory;
       }
-      aWeights = static_cast<double*>(malloc(sizeof(double) * cItems * cTensorBins));
-      if(nullptr == aWeights) {
-         return Error_OutOfMemory;
+      const ErrorEbm errorPurify = pBoosterShell->ReservePurifyTemp(sizeof(double) * cItems * cTensorBins);
+      if(Error_None != errorPurify) {
+         return errorPurify;
       }
+      aWeights = pBoosterShell->GetPurifyTemp();
       pGradient = aWeights + cTensorBins;
       if(bUseLogitBoost) {
          pHessian = pGradient + cTensorBins * cScores;
@@ -368,6 +384,7 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
    const size_t cRealDimensions = pTerm->GetCountRealDimensions();
    size_t cPossibleSplits;
    size_t acBins2[k_cDimensionsMax];
+   size_t cSweepTasks;
    {
       if(IsOverflowBinSize<FloatMain, UIntMain>(true, true, bHessian, cRuntimeScores)) {
          // TODO: move this to init
@@ -383,6 +400,11 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
 
       size_t cBytes = 1;
 
+      // the sweep tasks each take every cSweepTasks-th cut of the first dimension, so all dimensions need
+      // at least cSweepTasks cuts
+      size_t cSplitsMin = std::numeric_limits<size_t>::max();
+      size_t cCutCombinations = 1;
+
       size_t* pcBins2 = acBins2;
 
       pTermFeature = pTerm->GetTermFeatures();
@@ -396,6 +418,11 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
             return Error_OutOfMemory;
          }
          cPossibleSplits += cSplits;
+         if(size_t{0} != cSplits) {
+            cSplitsMin = EbmMin(cSplitsMin, cSplits);
+            cCutCombinations = IsMultiplyError(cCutCombinations, cSplits) ? std::numeric_limits<size_t>::max() :
+                                                                            cCutCombinations * cSplits;
+         }
          if(IsMultiplyError(cBins, cBytes)) {
             return Error_OutOfMemory;
          }
@@ -425,11 +452,26 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
       const size_t cBytesBest = cBytesTreeNodeMulti * (size_t{1} + (cRealDimensions << 1));
       EBM_ASSERT(cBytesBest <= cBytes);
 
-      // double it because we during the multi-dimensional sweep we need the best and we need the current
+      // MakeTensor writes to shared buffers when calculating the purified gain, so that sweep is not split
+      cSweepTasks = 1;
+      if(0 == (TermBoostFlags_PurifyGain & flags)) {
+         cSweepTasks = EbmMin(EbmMax(size_t{1}, pBoosterCore->GetCountThreads()),
+               cSplitsMin,
+               EbmMax(size_t{1}, cCutCombinations / k_cCutCombinationsPerTaskMin));
+      }
+
+      // double it because we during the multi-dimensional sweep we need the best and we need the current.
+      // Each sweep task has its own pair, and the task results are stored after them
       if(IsAddError(cBytesBest, cBytesBest)) {
          return Error_OutOfMemory;
       }
-      const size_t cBytesSweep = cBytesBest + cBytesBest;
+      if(IsMultiplyError(cBytesBest + cBytesBest, cSweepTasks)) {
+         return Error_OutOfMemory;
+      }
+      if(IsAddError((cBytesBest + cBytesBest) * cSweepTasks, sizeof(SweepResult) * cSweepTasks)) {
+         return Error_OutOfMemory;
+      }
+      const size_t cBytesSweep = (cBytesBest + cBytesBest) * cSweepTasks + sizeof(SweepResult) * cSweepTasks;
 
       cBytes = EbmMax(cBytes, cBytesSweep);
 
@@ -444,6 +486,16 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
       }
    }
 
+   ThreadPool* pThreadPool = nullptr;
+   error = ThreadPool::Borrow(cSweepTasks, &pThreadPool);
+   if(Error_None != error) {
+#ifndef NDEBUG
+      free(aDebugCopyBins);
+#endif // NDEBUG
+      return error;
+   }
+
+   const ProfileTimer timerPartition(pBoosterCore->GetProfile());
    error = PartitionTwoDimensionalBoosting(bHessian,
          cRuntimeScores,
          pTerm->GetCountDimensions(),
@@ -464,15 +516,17 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
          pHessian,
          pTotalGain,
          cPossibleSplits,
-         pBoosterShell->GetTemp1()
+         pBoosterShell->GetTemp1(),
+         pThreadPool,
+         cSweepTasks
 #ifndef NDEBUG
                ,
          aDebugCopyBins,
          pBoosterShell->GetDebugMainBinsEnd()
 #endif // NDEBUG
    );
+   ThreadPool::Return(pThreadPool);
    if(Error_None != error) {
-      free(aWeights);
 #ifndef NDEBUG
       free(aDebugCopyBins);
 #endif // NDEBUG
@@ -481,6 +535,7 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
 
       return error;
    }
+   timerPartition.Stop(ProfileSection_PartitionTwoDimensional, cTensorBins, cBytesPerMainBin * cTensorBins);
    EBM_ASSERT(!std::isnan(*pTotalGain));
    EBM_ASSERT(0 <= *pTotalGain);
 
@@ -518,6 +573,7 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
       //       though if we're purifying to the 0.0 tolerance, and it might make things slower, although we
       //       could see a speed increase if it allows us to use bigger tolerance values.
 
+      const ProfileTimer timerPurify(pBoosterCore->GetProfile());
       double* pScores = pTensor->GetTensorScoresPointer();
       const double* const pScoreMulticlassEnd = &pScores[cScores];
       do {
@@ -533,9 +589,14 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
                aWeights,
                pScores,
                nullptr,
+               nullptr,
                nullptr);
          ++pScores;
       } while(pScoreMulticlassEnd != pScores);
+      // the weights are read and the scores are read and written for every score
+      timerPurify.Stop(ProfileSection_Purify,
+            cTensorBinsPurify * cScores,
+            sizeof(double) * cTensorBinsPurify * (size_t{1} + size_t{2} * cScores));
 
       // When calculating purified gain, we do not subtract
       // the parent since the pure partial gain is always zero.
@@ -571,8 +632,6 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
       }
 
       *pTotalGain = gain;
-
-      free(aWeights);
    }
 
 #ifndef NDEBUG
@@ -625,13 +684,1058 @@ static ErrorEbm BoostRandom(RandomDeterministic* const pRng,
    return Error_None;
 }
 
+static const SparseTermData* GetSparseTermData(
+      const DataSubsetBoosting* const pSubset, const size_t iTerm, const size_t cTensorBins) {
+   // when everything is summed into a single bin the collapsed kernel is already as cheap as it gets
+   return size_t{1} == cTensorBins ? nullptr : pSubset->GetSparseTermData(iTerm);
+}
+
+static const size_t* GetBlockedSamples(
+      const DataSubsetBoosting* const pSubset, const size_t iTerm, const size_t cTensorBins) {
+   // the blocks are cut from the full tensor of the term, which a single bin does not use
+   return size_t{1} == cTensorBins ? nullptr : pSubset->GetBlockedSamples(iTerm);
+}
+
+static bool IsSingleCopyBins(const DataSubsetBoosting* const pSubset, const size_t iTerm, const size_t cTensorBins) {
+   // the sparse and the blocked kernels sum each subset into a single copy of the fast bins
+   return nullptr != GetSparseTermData(pSubset, iTerm, cTensorBins) ||
+         nullptr != GetBlockedSamples(pSubset, iTerm, cTensorBins);
+}
+
+extern size_t GetL1DataCacheBytes();
+
+extern size_t GetParallelBinBytesMax(const bool bHessian, const size_t cScores, const size_t cSIMDPack) {
+   // returns the largest size of all the lanes' copies of the fast bins together for which parallel bins are used
+   size_t cBytesMax;
+   if(bHessian) {
+      cBytesMax = size_t{1} == cScores ? HESSIAN_PARALLEL_BIN_BYTES_MAX : MULTISCORE_PARALLEL_BIN_BYTES_MAX;
+   } else {
+      cBytesMax = size_t{1} == cScores ? GRADIENT_PARALLEL_BIN_BYTES_MAX : MULTISCORE_PARALLEL_BIN_BYTES_MAX;
+   }
+   // Measured on AVX2 and AVX512F, the parallel bins break even once a single lane's copy outgrows about 1/16th of
+   // the L1 data cache for one score, and 1/8th for multiclass where the non-parallel kernel is slower.
+   const size_t cBytesLane = GetL1DataCacheBytes() / (size_t{1} == cScores ? size_t{16} : size_t{8});
+   if(IsMultiplyError(cBytesLane, cSIMDPack)) {
+      return cBytesMax;
+   }
+   return EbmMin(cBytesMax, cBytesLane * cSIMDPack);
+}
+
+static void GetFastBinLayout(BoosterCore* const pBoosterCore,
+      const size_t iTerm,
+      const DataSubsetBoosting* const pSubset,
+      const size_t cTensorBins,
+      const bool bSingleCopy,
+      int* const pcPackOut,
+      size_t* const pcBytesPerFastBinOut,
+      bool* const pbParallelBinsOut) {
+   // the binning and the reduction into the main bins run in different places, so both of them call this to
+   // agree on how the fast bins of a subset are laid out
+   const size_t cScores = pBoosterCore->GetCountScores();
+
+   int cPack;
+   if(1 == cTensorBins) {
+      // this is kind of hacky where if any one of a number of things occurs (like we have only 1 leaf)
+      // we sum everything into a single bin. The alternative would be to always sum into the tensor bins
+      // but then collapse them afterwards into a single bin, but that's more work.
+      cPack = k_cItemsPerBitPackUndefined;
+   } else {
+      cPack = pSubset->GetTermPack(iTerm);
+      EBM_ASSERT(1 <= cPack);
+   }
+   *pcPackOut = cPack;
+
+   size_t cBytesPerFastBin;
+   if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+      if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, pBoosterCore->IsHessian(), cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, pBoosterCore->IsHessian(), cScores);
+      }
+   } else {
+      EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+      if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, pBoosterCore->IsHessian(), cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(false, false, pBoosterCore->IsHessian(), cScores);
+      }
+   }
+   EBM_ASSERT(!IsMultiplyError(cBytesPerFastBin, cTensorBins));
+   *pcBytesPerFastBinOut = cBytesPerFastBin;
+
+   bool bParallelBins = false;
+#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
+   const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+   if(1 != cSIMDPack && 1 != cTensorBins && !bSingleCopy) {
+      const size_t cBytesParallel = cBytesPerFastBin * cTensorBins * cSIMDPack;
+      if(cBytesParallel <= GetParallelBinBytesMax(pBoosterCore->IsHessian(), cScores, cSIMDPack)) {
+         // use parallel bins
+         bParallelBins = true;
+      }
+   }
+#endif
+   *pbParallelBinsOut = bParallelBins;
+}
+
+template<typename TFloat, bool bHessian>
+static void MoveSparseNonDefaults(const size_t cScores,
+      const size_t cSIMDPack,
+      const bool bCompressed,
+      const void* const aGradientsAndHessians,
+      const void* const aWeights,
+      const SparseTermData* const pSparseTermData,
+      const size_t cBytesPerFastBin,
+      BinBase* const aFastBins) {
+   // the collapsed kernel left the sums of the entire subset in bin 0, which belong in the default bin
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(1 <= cSIMDPack);
+   EBM_ASSERT(nullptr != aGradientsAndHessians);
+   EBM_ASSERT(nullptr != pSparseTermData);
+
+   typedef GradientPair<TFloat, bHessian> GradientPairSpecific;
+   static_assert(sizeof(GradientPairSpecific) * 1 == GetBinSize<TFloat, UIntBig>(false, false, bHessian, 1),
+         "fast bins without counts or weights should only hold gradient pairs");
+   EBM_ASSERT(sizeof(GradientPairSpecific) * cScores == cBytesPerFastBin);
+
+   const size_t iTensorDefault = pSparseTermData->m_iTensorDefault;
+   GradientPairSpecific* const aDefault =
+         reinterpret_cast<GradientPairSpecific*>(IndexBin(aFastBins, cBytesPerFastBin * iTensorDefault));
+   if(size_t{0} != iTensorDefault) {
+      memcpy(aDefault, aFastBins, cBytesPerFastBin);
+      aFastBins->ZeroMem(cBytesPerFastBin);
+   }
+
+   const size_t cItems = bHessian ? size_t{2} : size_t{1};
+   const TFloat* const aGradHess = static_cast<const TFloat*>(aGradientsAndHessians);
+   const Bfloat16* const aGradHessCompressed = static_cast<const Bfloat16*>(aGradientsAndHessians);
+   const TFloat* const aWeightsSpecific = static_cast<const TFloat*>(aWeights);
+
+   const SparseTermEntry* pNonDefault = pSparseTermData->GetNonDefaults();
+   const SparseTermEntry* const pNonDefaultsEnd = pNonDefault + pSparseTermData->m_cNonDefaults;
+   for(; pNonDefaultsEnd != pNonDefault; ++pNonDefault) {
+      const size_t iSample = pNonDefault->m_iSample;
+      GradientPairSpecific* const aGradientPairs =
+            reinterpret_cast<GradientPairSpecific*>(IndexBin(aFastBins, cBytesPerFastBin * pNonDefault->m_iTensor));
+
+      // the gradients and hessians are interleaved in SIMD packs, one pack per score
+      size_t iGradHess = (iSample / cSIMDPack) * cSIMDPack * cItems * cScores + iSample % cSIMDPack;
+      const TFloat weight = nullptr == aWeightsSpecific ? TFloat{1} : aWeightsSpecific[iSample];
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         const TFloat gradient = (bCompressed ? static_cast<TFloat>(Bfloat16ToFloat(aGradHessCompressed[iGradHess])) :
+                                                aGradHess[iGradHess]) *
+               weight;
+         aGradientPairs[iScore].m_sumGradients += gradient;
+         aDefault[iScore].m_sumGradients -= gradient;
+         if(bHessian) {
+            const size_t iHess = iGradHess + cSIMDPack;
+            const TFloat hessian = (bCompressed ? static_cast<TFloat>(Bfloat16ToFloat(aGradHessCompressed[iHess])) :
+                                                  aGradHess[iHess]) *
+                  weight;
+            aGradientPairs[iScore].SetHess(aGradientPairs[iScore].GetHess() + hessian);
+            aDefault[iScore].SetHess(aDefault[iScore].GetHess() - hessian);
+         }
+         iGradHess += cSIMDPack * cItems;
+      }
+   }
+}
+
+template<typename TFloat, typename TFloatBin, bool bHessian>
+static void BinGradientSamples(const size_t cScores,
+      const size_t cSIMDPack,
+      const bool bCompressed,
+      const void* const aGradientsAndHessians,
+      const void* const aWeights,
+      const size_t cUIntBytes,
+      const int cPack,
+      const void* const aPacked,
+      const size_t cSubsetSamples,
+      const GradientSamples* const pGradientSamples,
+      BinBase* const aBins) {
+   // Sums the samples that SampleGradients kept, or every sample in blocked order, gathering them one at a time
+   // instead of streaming the subset through BinSumsBoosting. The bin of each sample is decoded from the SIMD ordered
+   // bit packs, where the first pack of each lane holds the remainder of the items.
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(1 <= cSIMDPack);
+   EBM_ASSERT(nullptr != aGradientsAndHessians);
+   EBM_ASSERT(nullptr != pGradientSamples);
+   EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
+
+   typedef GradientPair<TFloatBin, bHessian> GradientPairSpecific;
+   const size_t cBytesPerBin = sizeof(GradientPairSpecific) * cScores;
+
+   size_t cItemsPerBitPack = 1;
+   int cBitsPerItem = 0;
+   size_t maskBits = 0;
+   size_t iItemShift = 0;
+   if(nullptr != aPacked) {
+      EBM_ASSERT(1 <= cPack);
+      cItemsPerBitPack = static_cast<size_t>(cPack);
+      cBitsPerItem = GetCountBits(cPack, cUIntBytes);
+      if(sizeof(UIntBig) == cUIntBytes) {
+         maskBits = static_cast<size_t>(MakeLowMask<UIntBig>(cBitsPerItem));
+      } else {
+         EBM_ASSERT(sizeof(UIntSmall) == cUIntBytes);
+         maskBits = static_cast<size_t>(MakeLowMask<UIntSmall>(cBitsPerItem));
+      }
+      iItemShift = cItemsPerBitPack - size_t{1} - cSubsetSamples / cSIMDPack % cItemsPerBitPack;
+   }
+
+   const size_t cItems = bHessian ? size_t{2} : size_t{1};
+   const TFloat* const aGradHess = static_cast<const TFloat*>(aGradientsAndHessians);
+   const Bfloat16* const aGradHessCompressed = static_cast<const Bfloat16*>(aGradientsAndHessians);
+   const TFloat* const aWeightsSpecific = static_cast<const TFloat*>(aWeights);
+
+   const size_t* piSample = pGradientSamples->m_aiSamples;
+   const size_t* const piSamplesTopEnd = piSample + pGradientSamples->m_cTop;
+   const size_t* const piSamplesEnd = piSamplesTopEnd + pGradientSamples->m_cOther;
+   for(; piSamplesEnd != piSample; ++piSample) {
+      const size_t iSample = *piSample;
+      EBM_ASSERT(iSample < cSubsetSamples);
+
+      size_t iTensor = 0;
+      if(nullptr != aPacked) {
+         const size_t iItem = iSample / cSIMDPack + iItemShift;
+         const size_t iPacked = iItem / cItemsPerBitPack * cSIMDPack + iSample % cSIMDPack;
+         const int cShift =
+               static_cast<int>(cItemsPerBitPack - size_t{1} - iItem % cItemsPerBitPack) * cBitsPerItem;
+         if(sizeof(UIntBig) == cUIntBytes) {
+            iTensor = maskBits & static_cast<size_t>(static_cast<const UIntBig*>(aPacked)[iPacked] >> cShift);
+         } else {
+            iTensor = maskBits & static_cast<size_t>(static_cast<const UIntSmall*>(aPacked)[iPacked] >> cShift);
+         }
+      }
+      GradientPairSpecific* const aGradientPairs =
+            reinterpret_cast<GradientPairSpecific*>(IndexBin(aBins, cBytesPerBin * iTensor));
+
+      TFloatBin weight = piSamplesTopEnd <= piSample ? static_cast<TFloatBin>(pGradientSamples->m_otherWeight) :
+                                                       TFloatBin{1};
+      if(nullptr != aWeightsSpecific) {
+         weight *= static_cast<TFloatBin>(aWeightsSpecific[iSample]);
+      }
+
+      // the gradients and hessians are interleaved in SIMD packs, one pack per score
+      size_t iGradHess = (iSample / cSIMDPack) * cSIMDPack * cItems * cScores + iSample % cSIMDPack;
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         const TFloatBin gradient = static_cast<TFloatBin>(bCompressed ?
+                                          static_cast<TFloat>(Bfloat16ToFloat(aGradHessCompressed[iGradHess])) :
+                                          aGradHess[iGradHess]);
+         aGradientPairs[iScore].m_sumGradients += gradient * weight;
+         if(bHessian) {
+            const size_t iHess = iGradHess + cSIMDPack;
+            const TFloatBin hessian = static_cast<TFloatBin>(bCompressed ?
+                                            static_cast<TFloat>(Bfloat16ToFloat(aGradHessCompressed[iHess])) :
+                                            aGradHess[iHess]);
+            aGradientPairs[iScore].SetHess(aGradientPairs[iScore].GetHess() + hessian * weight);
+         }
+         iGradHess += cSIMDPack * cItems;
+      }
+   }
+}
+
+template<typename TFloat, typename TFloatBin>
+static void BinGradientSamplesDispatch(const bool bHessian,
+      const size_t cScores,
+      const bool bCompressed,
+      DataSubsetBoosting* const pSubset,
+      const void* const aWeights,
+      const int cPack,
+      const void* const aPacked,
+      const GradientSamples* const pGradientSamples,
+      BinBase* const aBins) {
+   if(bHessian) {
+      BinGradientSamples<TFloat, TFloatBin, true>(cScores,
+            pSubset->GetObjectiveWrapper()->m_cSIMDPack,
+            bCompressed,
+            pSubset->GetGradHess(),
+            aWeights,
+            pSubset->GetObjectiveWrapper()->m_cUIntBytes,
+            cPack,
+            aPacked,
+            pSubset->GetCountSamples(),
+            pGradientSamples,
+            aBins);
+   } else {
+      BinGradientSamples<TFloat, TFloatBin, false>(cScores,
+            pSubset->GetObjectiveWrapper()->m_cSIMDPack,
+            bCompressed,
+            pSubset->GetGradHess(),
+            aWeights,
+            pSubset->GetObjectiveWrapper()->m_cUIntBytes,
+            cPack,
+            aPacked,
+            pSubset->GetCountSamples(),
+            pGradientSamples,
+            aBins);
+   }
+}
+
+static bool IsWideBinsSubset(const DataSubsetBoosting* const pSubset) {
+   // only CreateBoosterFlags_MixedPrecision allows float32 subsets with more than k_cSubsetSamplesMax samples
+   return sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes &&
+         k_cSubsetSamplesMax < pSubset->GetCountSamples();
+}
+
+static void AddFastBinsToWideBins(const size_t cFloats,
+      const size_t cCopies,
+      const size_t cBytesPerCopy,
+      BinBase* const aFastBins,
+      BinBase* const aWideBins) {
+   // the float32 fast bins hold nothing but gradient pairs, so they are flat arrays of cFloats values per copy
+   FloatBig* const aWide = reinterpret_cast<FloatBig*>(aWideBins);
+   const BinBase* pFastBins = aFastBins;
+   for(size_t iCopy = 0; iCopy < cCopies; ++iCopy) {
+      const FloatSmall* const aFast = reinterpret_cast<const FloatSmall*>(pFastBins);
+      for(size_t i = 0; i < cFloats; ++i) {
+         aWide[i] += static_cast<FloatBig>(aFast[i]);
+      }
+      pFastBins = IndexBin(pFastBins, cBytesPerCopy);
+   }
+   aFastBins->ZeroMem(cBytesPerCopy * cCopies);
+}
+
+static ErrorEbm BinSumsBoostingChunks(DataSubsetBoosting* const pSubset,
+      const size_t cFloatsPerCopy,
+      const size_t cCopies,
+      const size_t cBytesPerCopy,
+      BinSumsBoostingBridge* const pParams,
+      BinBase* const aWideBins,
+      void* const aGradHessTemp) {
+   if(nullptr == aWideBins && nullptr == aGradHessTemp) {
+      return pSubset->BinSumsBoosting(pParams);
+   }
+
+   // Compressed gradients are expanded into aGradHessTemp one small chunk at a time. Wide bins sum at most
+   // k_cSubsetSamplesMax samples into the float32 fast bins before adding them to the float64 wide bins.
+   // The bit packs hold the partial pack at the start, so the first chunk takes the remainder and every chunk
+   // after it is a whole number of packs that starts on a pack boundary.
+   const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+   const size_t cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+   const size_t cItemsPerBitPack =
+         k_cItemsPerBitPackUndefined == pParams->m_cPack ? size_t{1} : static_cast<size_t>(pParams->m_cPack);
+   const size_t cFloatsPerItem =
+         cSIMDPack * (EBM_FALSE != pParams->m_bHessian ? size_t{2} : size_t{1}) * pParams->m_cScores;
+   size_t cChunkItems = SIZE_MAX;
+   if(nullptr != aGradHessTemp) {
+      cChunkItems = GetGradHessChunkItems(cFloatBytes * cFloatsPerItem, cItemsPerBitPack);
+   }
+   if(nullptr != aWideBins) {
+      cChunkItems = EbmMin(cChunkItems, k_cSubsetSamplesMax / cSIMDPack / cItemsPerBitPack * cItemsPerBitPack);
+   }
+   EBM_ASSERT(1 <= cChunkItems);
+   EBM_ASSERT(0 == pParams->m_cSamples % cSIMDPack);
+   const size_t cItems = pParams->m_cSamples / cSIMDPack;
+   EBM_ASSERT(1 <= cItems);
+   const size_t cBytesUInt = pSubset->GetObjectiveWrapper()->m_cUIntBytes;
+
+   size_t iItem = 0;
+   size_t cChunkItemsCur = cItems - (cItems - size_t{1}) / cChunkItems * cChunkItems;
+   size_t cItemsUnflushed = 0;
+   do {
+      BinSumsBoostingBridge params = *pParams;
+      params.m_cSamples = cChunkItemsCur * cSIMDPack;
+      if(nullptr != aGradHessTemp) {
+         ExpandGradHess(cFloatsPerItem * cChunkItemsCur,
+               cFloatBytes,
+               &static_cast<const Bfloat16*>(pParams->m_aGradientsAndHessians)[cFloatsPerItem * iItem],
+               aGradHessTemp);
+         params.m_aGradientsAndHessians = aGradHessTemp;
+      } else {
+         params.m_aGradientsAndHessians =
+               IndexByte(pParams->m_aGradientsAndHessians, cFloatBytes * cFloatsPerItem * iItem);
+      }
+      if(nullptr != pParams->m_aWeights) {
+         params.m_aWeights = IndexByte(pParams->m_aWeights, cFloatBytes * cSIMDPack * iItem);
+      }
+      if(nullptr != pParams->m_aPacked) {
+         params.m_aPacked = IndexByte(pParams->m_aPacked, cBytesUInt * cSIMDPack * (iItem / cItemsPerBitPack));
+      }
+      const ErrorEbm error = pSubset->BinSumsBoosting(&params);
+      if(Error_None != error) {
+         return error;
+      }
+
+      iItem += cChunkItemsCur;
+      cItemsUnflushed += cChunkItemsCur;
+      cChunkItemsCur = cChunkItems;
+
+      if(nullptr != aWideBins &&
+            (cItems == iItem || k_cSubsetSamplesMax < (cItemsUnflushed + cChunkItems) * cSIMDPack)) {
+         AddFastBinsToWideBins(
+               cFloatsPerCopy, cCopies, cBytesPerCopy, static_cast<BinBase*>(pParams->m_aFastBins), aWideBins);
+         cItemsUnflushed = 0;
+      }
+   } while(cItems != iItem);
+   return Error_None;
+}
+
+static ErrorEbm BinSumsBoostingSubsetUntimed(BoosterCore* const pBoosterCore,
+      const size_t iTerm,
+      const size_t iBag,
+      const size_t cTensorBins,
+      DataSubsetBoosting* const pSubset,
+      BinBase* const aFastBins,
+      const GradientSamples* const pGradientSamples) {
+   const SparseTermData* const pSparseTermData = GetSparseTermData(pSubset, iTerm, cTensorBins);
+
+   int cPack;
+   size_t cBytesPerFastBin;
+   bool bParallelBins;
+   GetFastBinLayout(pBoosterCore,
+         iTerm,
+         pSubset,
+         cTensorBins,
+         IsSingleCopyBins(pSubset, iTerm, cTensorBins),
+         &cPack,
+         &cBytesPerFastBin,
+         &bParallelBins);
+   const size_t cParallelTensorBins =
+         bParallelBins ? cTensorBins * pSubset->GetObjectiveWrapper()->m_cSIMDPack : cTensorBins;
+
+   aFastBins->ZeroMem(cBytesPerFastBin, cParallelTensorBins);
+
+   const size_t cFloatsPerBin = (pBoosterCore->IsHessian() ? size_t{2} : size_t{1}) * pBoosterCore->GetCountScores();
+   BinBase* aWideBins = nullptr;
+   if(IsWideBinsSubset(pSubset)) {
+      EBM_ASSERT(size_t{0} != pBoosterCore->GetIndexBytesWideBins());
+      EBM_ASSERT(sizeof(FloatSmall) * cFloatsPerBin == cBytesPerFastBin);
+      aWideBins = IndexBin(aFastBins, pBoosterCore->GetIndexBytesWideBins());
+      memset(aWideBins, 0, sizeof(FloatBig) * cFloatsPerBin * cTensorBins);
+   }
+   const size_t cBytesPerCopy = cBytesPerFastBin * cTensorBins;
+   const size_t cCopies = bParallelBins ? pSubset->GetObjectiveWrapper()->m_cSIMDPack : size_t{1};
+
+   GradientSamples blockedSamples;
+   const GradientSamples* pGatherSamples = pGradientSamples;
+   if(nullptr == pGatherSamples) {
+      const size_t* const aiBlockedSamples = GetBlockedSamples(pSubset, iTerm, cTensorBins);
+      if(nullptr != aiBlockedSamples) {
+         // The fast bins of this term outgrow the L1 data cache, so visiting the samples in sample order would miss
+         // the cache on nearly every bin. Gathering them block by block keeps the bins that are written in the L1.
+         blockedSamples.m_cTop = pSubset->GetCountSamples();
+         blockedSamples.m_cOther = 0;
+         blockedSamples.m_otherWeight = 1.0;
+         blockedSamples.m_aiSamples = const_cast<size_t*>(aiBlockedSamples);
+         pGatherSamples = &blockedSamples;
+      }
+   }
+
+   if(nullptr != pGatherSamples) {
+      // the samples are summed into the first copy of the fast bins, or straight into the wide bins, which is where
+      // AddFastBinsToMainBins expects the sums of this subset. Any other parallel copies stay zeroed
+      const bool bHessian = pBoosterCore->IsHessian();
+      const size_t cScores = pBoosterCore->GetCountScores();
+      const bool bCompressed = pBoosterCore->IsCompressGradients();
+      const void* const aWeights = pSubset->GetInnerBag(iBag)->GetWeights();
+      const void* const aPacked = size_t{1} == cTensorBins ? nullptr : pSubset->GetTermData(iTerm);
+      if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         BinGradientSamplesDispatch<FloatBig, FloatBig>(
+               bHessian, cScores, bCompressed, pSubset, aWeights, cPack, aPacked, pGatherSamples, aFastBins);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         if(nullptr != aWideBins) {
+            BinGradientSamplesDispatch<FloatSmall, FloatBig>(
+                  bHessian, cScores, bCompressed, pSubset, aWeights, cPack, aPacked, pGatherSamples, aWideBins);
+         } else {
+            BinGradientSamplesDispatch<FloatSmall, FloatSmall>(
+                  bHessian, cScores, bCompressed, pSubset, aWeights, cPack, aPacked, pGatherSamples, aFastBins);
+         }
+      }
+      return Error_None;
+   }
+   void* const aGradHessTemp = pBoosterCore->IsCompressGradients() ?
+         IndexBin(aFastBins, pBoosterCore->GetIndexBytesGradHessTemp()) :
+         nullptr;
+
+   // in the future use TermBoostFlags_DisableNewtonGain and TermBoostFlags_DisableNewtonUpdate and
+   // TermBoostFlags_GradientSums flags in addition to what the objective allows when setting bHessian
+   BinSumsBoostingBridge params;
+   params.m_bParallelBins = bParallelBins ? EBM_TRUE : EBM_FALSE;
+   params.m_bHessian = pBoosterCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
+   params.m_cScores = pBoosterCore->GetCountScores();
+   params.m_cPack = cPack;
+   params.m_cSamples = pSubset->GetCountSamples();
+   params.m_cBytesFastBins = cBytesPerFastBin * cTensorBins;
+   params.m_aGradientsAndHessians = pSubset->GetGradHess();
+   params.m_aWeights = pSubset->GetInnerBag(iBag)->GetWeights();
+   params.m_aPacked = pSubset->GetTermData(iTerm);
+   params.m_aFastBins = aFastBins;
+#ifndef NDEBUG
+   params.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cParallelTensorBins);
+#endif // NDEBUG
+
+   if(nullptr != pSparseTermData) {
+      // sum every sample into the first bin with the collapsed kernel, then move the few samples that are not in
+      // the default bin out of it. The kernel requires aligned bins, which is why it cannot target the default bin
+      params.m_cPack = k_cItemsPerBitPackUndefined;
+      params.m_cBytesFastBins = cBytesPerFastBin;
+      params.m_aPacked = nullptr;
+      const ErrorEbm error = BinSumsBoostingChunks(
+            pSubset, cFloatsPerBin, size_t{1}, cBytesPerFastBin, &params, aWideBins, aGradHessTemp);
+      if(Error_None != error) {
+         return error;
+      }
+      if(nullptr != aWideBins && size_t{0} != pSparseTermData->m_iTensorDefault) {
+         // the chunks already carried bin 0 into the wide bins, where it belongs to the default bin
+         FloatBig* const aWide = reinterpret_cast<FloatBig*>(aWideBins);
+         FloatBig* const aWideDefault = aWide + cFloatsPerBin * pSparseTermData->m_iTensorDefault;
+         for(size_t i = 0; i < cFloatsPerBin; ++i) {
+            aWideDefault[i] = aWide[i];
+            aWide[i] = 0;
+         }
+      }
+
+      const bool bHessian = pBoosterCore->IsHessian();
+      const size_t cScores = pBoosterCore->GetCountScores();
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      const void* const aWeights = pSubset->GetInnerBag(iBag)->GetWeights();
+      const bool bCompressed = pBoosterCore->IsCompressGradients();
+      if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         if(bHessian) {
+            MoveSparseNonDefaults<FloatBig, true>(cScores,
+                  cSIMDPack,
+                  bCompressed,
+                  pSubset->GetGradHess(),
+                  aWeights,
+                  pSparseTermData,
+                  cBytesPerFastBin,
+                  aFastBins);
+         } else {
+            MoveSparseNonDefaults<FloatBig, false>(cScores,
+                  cSIMDPack,
+                  bCompressed,
+                  pSubset->GetGradHess(),
+                  aWeights,
+                  pSparseTermData,
+                  cBytesPerFastBin,
+                  aFastBins);
+         }
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         if(bHessian) {
+            MoveSparseNonDefaults<FloatSmall, true>(cScores,
+                  cSIMDPack,
+                  bCompressed,
+                  pSubset->GetGradHess(),
+                  aWeights,
+                  pSparseTermData,
+                  cBytesPerFastBin,
+                  aFastBins);
+         } else {
+            MoveSparseNonDefaults<FloatSmall, false>(cScores,
+                  cSIMDPack,
+                  bCompressed,
+                  pSubset->GetGradHess(),
+                  aWeights,
+                  pSparseTermData,
+                  cBytesPerFastBin,
+                  aFastBins);
+         }
+      }
+      if(nullptr != aWideBins) {
+         AddFastBinsToWideBins(cFloatsPerBin * cTensorBins, size_t{1}, cBytesPerCopy, aFastBins, aWideBins);
+      }
+      return Error_None;
+   }
+
+   return BinSumsBoostingChunks(
+         pSubset, cFloatsPerBin * cTensorBins, cCopies, cBytesPerCopy, &params, aWideBins, aGradHessTemp);
+}
+
+extern ErrorEbm BinSumsBoostingSubset(BoosterCore* const pBoosterCore,
+      const size_t iTerm,
+      const size_t iBag,
+      const size_t cTensorBins,
+      DataSubsetBoosting* const pSubset,
+      BinBase* const aFastBins,
+      const GradientSamples* const pGradientSamples) {
+   const ProfileTimer timer(pBoosterCore->GetProfile());
+   const ErrorEbm error =
+         BinSumsBoostingSubsetUntimed(pBoosterCore, iTerm, iBag, cTensorBins, pSubset, aFastBins, pGradientSamples);
+   const size_t cSamples = nullptr == pGradientSamples ? pSubset->GetCountSamples() :
+                                                         pGradientSamples->m_cTop + pGradientSamples->m_cOther;
+   timer.Stop(ProfileSection_BinSumsBoosting,
+         cSamples,
+         pSubset->CountBytesBinSums(cSamples,
+               pBoosterCore->GetCountScores(),
+               pBoosterCore->IsHessian(),
+               pBoosterCore->IsCompressGradients(),
+               nullptr != pSubset->GetInnerBag(iBag)->GetWeights(),
+               size_t{1} == cTensorBins ? k_cItemsPerBitPackUndefined : pSubset->GetTermPack(iTerm)));
+   return error;
+}
+
+extern void AddFastBinsToMainBins(BoosterCore* const pBoosterCore,
+      const size_t iTerm,
+      const size_t iBag,
+      const size_t cTensorBins,
+      const DataSubsetBoosting* const pSubset,
+      const bool bLastSubset,
+      const BinBase* const aFastBins,
+      BinBase* const aMainBins) {
+   int cPack;
+   size_t cBytesPerFastBin;
+   bool bParallelBins;
+   GetFastBinLayout(pBoosterCore,
+         iTerm,
+         pSubset,
+         cTensorBins,
+         IsSingleCopyBins(pSubset, iTerm, cTensorBins),
+         &cPack,
+         &cBytesPerFastBin,
+         &bParallelBins);
+
+   size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+   bool bUInt64Src = sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes;
+   bool bDoubleSrc = sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+
+   const BinBase* pFastBins = aFastBins;
+   if(IsWideBinsSubset(pSubset)) {
+      // BinSumsBoostingSubset already reduced the fast bins of this subset into a single set of float64 bins
+      cSIMDPack = 1;
+      bUInt64Src = true;
+      bDoubleSrc = true;
+      bParallelBins = false;
+      pFastBins = IndexBin(aFastBins, pBoosterCore->GetIndexBytesWideBins());
+   }
+   for(size_t i = 0; i < cSIMDPack; ++i) {
+      const UIntMain* aCounts = nullptr;
+      const FloatPrecomp* aWeights = nullptr;
+      if(bLastSubset && (!bParallelBins || i == cSIMDPack - 1)) {
+         // the aCounts and aWeights tensors contain the final counts and weights, so when calling
+         // ConvertAddBin we only want to call it once with these tensors since otherwise they
+         // would be added multiple times
+         aCounts = TermInnerBag::GetCounts(
+               size_t{1} == cTensorBins, iTerm, iBag, pBoosterCore->GetTrainingSet()->GetTermInnerBags());
+         aWeights = TermInnerBag::GetWeights(
+               size_t{1} == cTensorBins, iTerm, iBag, pBoosterCore->GetTrainingSet()->GetTermInnerBags());
+      }
+
+      ConvertAddBin(pBoosterCore->GetCountScores(),
+            pBoosterCore->IsHessian(),
+            cTensorBins,
+            bUInt64Src,
+            bDoubleSrc,
+            false,
+            false,
+            pFastBins,
+            aCounts,
+            aWeights,
+            std::is_same<UIntMain, uint64_t>::value,
+            std::is_same<FloatMain, double>::value,
+            aMainBins);
+
+      if(!bParallelBins) {
+         break;
+      }
+      pFastBins = IndexBin(pFastBins, cBytesPerFastBin * cTensorBins);
+   }
+}
+
+// CreateBoosterFlags_QuantizeGradients rounds each gradient and hessian to an integer in [-127, 127]. A subset holds
+// at most k_cSubsetSamplesMax samples, so the float32 fast bins sum these integers exactly.
+static constexpr double k_quantizeLevels = 127.0;
+
+template<typename TStore> struct QuantizeStore final {
+   INLINE_ALWAYS static double Load(const TStore val) { return static_cast<double>(val); }
+   INLINE_ALWAYS static TStore Store(const double val) { return static_cast<TStore>(val); }
+};
+template<> struct QuantizeStore<Bfloat16> final {
+   // bfloat16 has 8 significant bits, so the quantized integers are exact in it
+   INLINE_ALWAYS static double Load(const Bfloat16 val) { return static_cast<double>(Bfloat16ToFloat(val)); }
+   INLINE_ALWAYS static Bfloat16 Store(const double val) { return FloatToBfloat16(static_cast<float>(val)); }
+};
+
+template<typename TStore>
+static void MaxAbsGradHess(const size_t cValues,
+      const size_t cSIMDPack,
+      const bool bHessian,
+      const void* const aGradHess,
+      double* const pMaxGradientOut,
+      double* const pMaxHessianOut) {
+   // each SIMD pack of gradients is followed by the SIMD pack of their hessians, if there are hessians
+   const TStore* pGradHess = static_cast<const TStore*>(aGradHess);
+   const TStore* const pGradHessEnd = pGradHess + cValues;
+   double maxGradient = 0.0;
+   double maxHessian = 0.0;
+   do {
+      for(size_t i = 0; i < cSIMDPack; ++i) {
+         maxGradient = EbmMax(maxGradient, std::abs(QuantizeStore<TStore>::Load(pGradHess[i])));
+      }
+      pGradHess += cSIMDPack;
+      if(bHessian) {
+         for(size_t i = 0; i < cSIMDPack; ++i) {
+            maxHessian = EbmMax(maxHessian, std::abs(QuantizeStore<TStore>::Load(pGradHess[i])));
+         }
+         pGradHess += cSIMDPack;
+      }
+   } while(pGradHessEnd != pGradHess);
+   *pMaxGradientOut = maxGradient;
+   *pMaxHessianOut = maxHessian;
+}
+
+INLINE_ALWAYS static double RoundStochastic(const double val, RandomDeterministic& rng) {
+   // rounds up with a probability equal to the fraction, which keeps the expected value of the sums unchanged
+   const double fraction = static_cast<double>(rng.Next<uint32_t>()) * (1.0 / 4294967296.0);
+   return EbmMin(EbmMax(std::floor(val + fraction), -k_quantizeLevels), k_quantizeLevels);
+}
+
+template<typename TStore>
+static void QuantizeGradHess(const size_t cValues,
+      const size_t cSIMDPack,
+      const bool bHessian,
+      const double multipleGradient,
+      const double multipleHessian,
+      RandomDeterministic& rng,
+      void* const aGradHess) {
+   TStore* pGradHess = static_cast<TStore*>(aGradHess);
+   const TStore* const pGradHessEnd = pGradHess + cValues;
+   do {
+      for(size_t i = 0; i < cSIMDPack; ++i) {
+         pGradHess[i] = QuantizeStore<TStore>::Store(
+               RoundStochastic(QuantizeStore<TStore>::Load(pGradHess[i]) * multipleGradient, rng));
+      }
+      pGradHess += cSIMDPack;
+      if(bHessian) {
+         for(size_t i = 0; i < cSIMDPack; ++i) {
+            pGradHess[i] = QuantizeStore<TStore>::Store(
+                  RoundStochastic(QuantizeStore<TStore>::Load(pGradHess[i]) * multipleHessian, rng));
+         }
+         pGradHess += cSIMDPack;
+      }
+   } while(pGradHessEnd != pGradHess);
+}
+
+// Replaces the training gradients and hessians with integers. The gradients share one scale and the hessians another
+// across all subsets, so the integer sums of any set of subsets can be added exactly and then multiplied by the
+// scale once. The gradients stay quantized until the next update, so further terms boosted from the same gradients
+// do not round them again.
+static ErrorEbm QuantizeGradients(BoosterCore* const pBoosterCore, RandomDeterministic* const pRng) {
+   EBM_ASSERT(pBoosterCore->IsQuantizeGradients());
+   EBM_ASSERT(!pBoosterCore->IsGradientsQuantized());
+
+   const size_t cSubsets = pBoosterCore->GetTrainingSet()->GetCountSubsets();
+   EBM_ASSERT(1 <= cSubsets);
+   DataSubsetBoosting* const aSubsets = pBoosterCore->GetTrainingSet()->GetSubsets();
+   const size_t cThreads = pBoosterCore->GetCountThreads();
+   const size_t cScores = pBoosterCore->GetCountScores();
+   const bool bHessian = pBoosterCore->IsHessian();
+   const bool bCompressed = pBoosterCore->IsCompressGradients();
+
+   if(IsMultiplyError(sizeof(double) * size_t{2}, cSubsets)) {
+      LOG_0(Trace_Warning, "WARNING QuantizeGradients IsMultiplyError(sizeof(double) * size_t{2}, cSubsets)");
+      return Error_OutOfMemory;
+   }
+   double* const aMax = static_cast<double*>(malloc(sizeof(double) * size_t{2} * cSubsets));
+   if(nullptr == aMax) {
+      LOG_0(Trace_Warning, "WARNING QuantizeGradients nullptr == aMax");
+      return Error_OutOfMemory;
+   }
+
+   auto getValues = [&](const size_t iSubset) -> size_t {
+      return aSubsets[iSubset].GetCountSamples() * cScores * (bHessian ? size_t{2} : size_t{1});
+   };
+
+   auto maxSubset = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      UNUSED(iThread);
+      DataSubsetBoosting* const pSubset = &aSubsets[iTask];
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      if(bCompressed) {
+         MaxAbsGradHess<Bfloat16>(
+               getValues(iTask), cSIMDPack, bHessian, pSubset->GetGradHess(), &aMax[iTask * 2], &aMax[iTask * 2 + 1]);
+      } else if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         MaxAbsGradHess<FloatBig>(
+               getValues(iTask), cSIMDPack, bHessian, pSubset->GetGradHess(), &aMax[iTask * 2], &aMax[iTask * 2 + 1]);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         MaxAbsGradHess<FloatSmall>(
+               getValues(iTask), cSIMDPack, bHessian, pSubset->GetGradHess(), &aMax[iTask * 2], &aMax[iTask * 2 + 1]);
+      }
+      return Error_None;
+   };
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cThreads, &pThreadPool);
+   if(Error_None == error) {
+      error = pThreadPool->RunAffine(cSubsets, maxSubset);
+      ThreadPool::Return(pThreadPool);
+   }
+   if(Error_None != error) {
+      free(aMax);
+      return error;
+   }
+
+   double maxGradient = 0.0;
+   double maxHessian = 0.0;
+   for(size_t iSubset = 0; iSubset < cSubsets; ++iSubset) {
+      maxGradient = EbmMax(maxGradient, aMax[iSubset * 2]);
+      maxHessian = EbmMax(maxHessian, aMax[iSubset * 2 + 1]);
+   }
+   free(aMax);
+
+   if(std::numeric_limits<double>::max() < maxGradient || std::numeric_limits<double>::max() < maxHessian) {
+      // there is no scale for infinities, so this round is binned at full precision
+      LOG_0(Trace_Warning, "WARNING QuantizeGradients gradients or hessians are infinite. Not quantizing.");
+      return Error_None;
+   }
+   const double scaleGradient = 0.0 == maxGradient ? 1.0 : maxGradient / k_quantizeLevels;
+   const double scaleHessian = 0.0 == maxHessian ? 1.0 : maxHessian / k_quantizeLevels;
+   const double multipleGradient = 1.0 / scaleGradient;
+   const double multipleHessian = 1.0 / scaleHessian;
+
+   // every subset gets its own stream of the round's generator, so the result does not depend on the thread count
+   RandomDeterministic rngRound;
+   rngRound.Initialize(pRng->NextFast(std::numeric_limits<uint64_t>::max()));
+
+   auto quantizeSubset = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      UNUSED(iThread);
+      DataSubsetBoosting* const pSubset = &aSubsets[iTask];
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      RandomDeterministic rng;
+      rng.InitializeStream(rngRound, static_cast<uint64_t>(iTask));
+      if(bCompressed) {
+         QuantizeGradHess<Bfloat16>(getValues(iTask),
+               cSIMDPack,
+               bHessian,
+               multipleGradient,
+               multipleHessian,
+               rng,
+               pSubset->GetGradHess());
+      } else if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         QuantizeGradHess<FloatBig>(getValues(iTask),
+               cSIMDPack,
+               bHessian,
+               multipleGradient,
+               multipleHessian,
+               rng,
+               pSubset->GetGradHess());
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         QuantizeGradHess<FloatSmall>(getValues(iTask),
+               cSIMDPack,
+               bHessian,
+               multipleGradient,
+               multipleHessian,
+               rng,
+               pSubset->GetGradHess());
+      }
+      return Error_None;
+   };
+   pThreadPool = nullptr;
+   error = ThreadPool::Borrow(cThreads, &pThreadPool);
+   if(Error_None != error) {
+      return error;
+   }
+   error = pThreadPool->RunAffine(cSubsets, quantizeSubset);
+   ThreadPool::Return(pThreadPool);
+   if(Error_None != error) {
+      return error;
+   }
+
+   pBoosterCore->SetGradientsQuantized(scaleGradient, scaleHessian);
+   return Error_None;
+}
+
+// the main bins summed the quantized integers exactly, and this returns them to the units of the gradients
+template<bool bHessian>
+static void RescaleQuantizedBins(const size_t cScores,
+      const size_t cTensorBins,
+      const double scaleGradient,
+      const double scaleHessian,
+      BinBase* const aMainBins) {
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+   for(size_t iBin = 0; iBin < cTensorBins; ++iBin) {
+      auto* const pBin =
+            IndexBin(aMainBins, cBytesPerMainBin * iBin)->Specialize<FloatMain, UIntMain, true, true, bHessian>();
+      auto* const aGradientPairs = pBin->GetGradientPairs();
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         aGradientPairs[iScore].m_sumGradients *= static_cast<FloatMain>(scaleGradient);
+         if(bHessian) {
+            aGradientPairs[iScore].SetHess(aGradientPairs[iScore].GetHess() * static_cast<FloatMain>(scaleHessian));
+         }
+      }
+   }
+}
+
+// sums the gradients of inner bag iBag over the whole training set into the first cTensorBins main bins of the term
+static ErrorEbm BinTermSubsets(
+      BoosterShell* const pBoosterShell, const size_t iTerm, const size_t iBag, const size_t cTensorBins) {
+   ErrorEbm error;
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   BinBase* const aMainBins = pBoosterShell->GetBoostingMainBins();
+   EBM_ASSERT(nullptr != aMainBins);
+   BinBase* const aFastBinsAll = pBoosterShell->GetBoostingFastBinsTemp();
+   EBM_ASSERT(nullptr != aFastBinsAll);
+
+   const size_t cBytesPerMainBin =
+         GetBinSize<FloatMain, UIntMain>(true, true, pBoosterCore->IsHessian(), pBoosterCore->GetCountScores());
+   EBM_ASSERT(!IsMultiplyError(cBytesPerMainBin, cTensorBins));
+   memset(aMainBins, 0, cBytesPerMainBin * cTensorBins);
+
+   const size_t cSubsets = pBoosterCore->GetTrainingSet()->GetCountSubsets();
+   EBM_ASSERT(1 <= cSubsets);
+   DataSubsetBoosting* const aSubsets = pBoosterCore->GetTrainingSet()->GetSubsets();
+   const size_t cBytesFastBinsSlice = pBoosterCore->GetCountBytesFastBins();
+   const GradientSamples* const aGradientSamples = pBoosterShell->GetGradientSamples();
+
+   ThreadPool* pThreadPool = nullptr;
+   error = ThreadPool::Borrow(pBoosterCore->GetCountThreads(), &pThreadPool);
+   if(Error_None != error) {
+      return error;
+   }
+   const size_t cThreads = pThreadPool->GetCountThreads();
+
+   // the subsets are binned in waves of up to cThreads at a time with each one getting its own slice of the fast bins.
+   // The reduction into the main bins happens afterwards on this thread in subset order, so the floating point sums
+   // are identical regardless of how the work was scheduled.
+   size_t iSubsetWave = 0;
+   do {
+      const size_t cSubsetsWave = EbmMin(cThreads, cSubsets - iSubsetWave);
+
+      auto binSubset = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+         UNUSED(iThread);
+         return BinSumsBoostingSubset(pBoosterCore,
+               iTerm,
+               iBag,
+               cTensorBins,
+               &aSubsets[iSubsetWave + iTask],
+               IndexBin(aFastBinsAll, cBytesFastBinsSlice * iTask),
+               nullptr == aGradientSamples ? nullptr : &aGradientSamples[iSubsetWave + iTask]);
+      };
+      error = pThreadPool->RunAffine(cSubsetsWave, binSubset);
+      if(Error_None != error) {
+         ThreadPool::Return(pThreadPool);
+         return error;
+      }
+
+      for(size_t iTask = 0; iTask < cSubsetsWave; ++iTask) {
+         AddFastBinsToMainBins(pBoosterCore,
+               iTerm,
+               iBag,
+               cTensorBins,
+               &aSubsets[iSubsetWave + iTask],
+               cSubsets == iSubsetWave + iTask + 1,
+               IndexBin(aFastBinsAll, cBytesFastBinsSlice * iTask),
+               aMainBins);
+      }
+
+      iSubsetWave += cSubsetsWave;
+   } while(cSubsets != iSubsetWave);
+   ThreadPool::Return(pThreadPool);
+
+   if(pBoosterCore->IsGradientsQuantized()) {
+      if(pBoosterCore->IsHessian()) {
+         RescaleQuantizedBins<true>(pBoosterCore->GetCountScores(),
+               cTensorBins,
+               pBoosterCore->GetQuantizeScaleGradient(),
+               pBoosterCore->GetQuantizeScaleHessian(),
+               aMainBins);
+      } else {
+         RescaleQuantizedBins<false>(pBoosterCore->GetCountScores(),
+               cTensorBins,
+               pBoosterCore->GetQuantizeScaleGradient(),
+               pBoosterCore->GetQuantizeScaleHessian(),
+               aMainBins);
+      }
+   }
+
+   return Error_None;
+}
+
+// ComputeTermHistogram exports each tensor bin as its sample count, its weight, and then the gradient and hessian
+// sums of each score, all as doubles so that the histograms of several machines can be summed elementwise. Without
+// hessians only the gradient sums are stored.
+static size_t CountHistogramValuesPerBin(const bool bHessian, const size_t cScores) {
+   return size_t{2} + (bHessian ? size_t{2} : size_t{1}) * cScores;
+}
+
+template<bool bHessian>
+static void PackHistogram(
+      const size_t cScores, const size_t cTensorBins, const BinBase* const aMainBins, double* pValue) {
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+   for(size_t iBin = 0; iBin < cTensorBins; ++iBin) {
+      const auto* const pBin =
+            IndexBin(aMainBins, cBytesPerMainBin * iBin)->Specialize<FloatMain, UIntMain, true, true, bHessian>();
+      *pValue = static_cast<double>(pBin->GetCountSamples());
+      ++pValue;
+      *pValue = static_cast<double>(pBin->GetWeight());
+      ++pValue;
+      const auto* const aGradientPairs = pBin->GetGradientPairs();
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         *pValue = static_cast<double>(aGradientPairs[iScore].m_sumGradients);
+         ++pValue;
+         if(bHessian) {
+            *pValue = static_cast<double>(aGradientPairs[iScore].GetHess());
+            ++pValue;
+         }
+      }
+   }
+}
+
+// fills the first cTensorBins main bins from the cHistogramBins bins of one inner bag's histogram. When the update is
+// collapsed into a single bin, every histogram bin is summed into it
+template<bool bHessian>
+static ErrorEbm UnpackHistogram(const size_t cScores,
+      const size_t cHistogramBins,
+      const double* pValue,
+      const size_t cTensorBins,
+      BinBase* const aMainBins,
+      size_t* const pCountSamplesTotalOut,
+      double* const pWeightTotalOut) {
+   EBM_ASSERT(size_t{1} == cTensorBins || cHistogramBins == cTensorBins);
+
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+   memset(aMainBins, 0, cBytesPerMainBin * cTensorBins);
+
+   UIntMain cSamplesTotal = 0;
+   double weightTotal = 0.0;
+   for(size_t iBin = 0; iBin < cHistogramBins; ++iBin) {
+      auto* const pBin = IndexBin(aMainBins, size_t{1} == cTensorBins ? size_t{0} : cBytesPerMainBin * iBin)
+                               ->Specialize<FloatMain, UIntMain, true, true, bHessian>();
+      const double count = *pValue;
+      ++pValue;
+      const double weight = *pValue;
+      ++pValue;
+      if(/* NaN */ !(0.0 <= count) || !(count < static_cast<double>(std::numeric_limits<UIntMain>::max())) ||
+            /* NaN */ !(0.0 <= weight) || std::numeric_limits<double>::infinity() == weight) {
+         LOG_0(Trace_Error,
+               "ERROR GenerateTermUpdateFromHistogram histogram counts and weights must be finite and non-negative");
+         return Error_IllegalParamVal;
+      }
+      pBin->SetCountSamples(pBin->GetCountSamples() + static_cast<UIntMain>(count));
+      pBin->SetWeight(pBin->GetWeight() + static_cast<FloatMain>(weight));
+      cSamplesTotal += static_cast<UIntMain>(count);
+      weightTotal += weight;
+
+      auto* const aGradientPairs = pBin->GetGradientPairs();
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         aGradientPairs[iScore].m_sumGradients += static_cast<FloatMain>(*pValue);
+         ++pValue;
+         if(bHessian) {
+            aGradientPairs[iScore].SetHess(aGradientPairs[iScore].GetHess() + static_cast<FloatMain>(*pValue));
+            ++pValue;
+         }
+      }
+   }
+   if(IsConvertError<size_t>(cSamplesTotal)) {
+      LOG_0(Trace_Error, "ERROR GenerateTermUpdateFromHistogram IsConvertError<size_t>(cSamplesTotal)");
+      return Error_IllegalParamVal;
+   }
+   *pCountSamplesTotalOut = static_cast<size_t>(cSamplesTotal);
+   *pWeightTotalOut = weightTotal;
+   return Error_None;
+}
+
 // we made this a global because if we had put this variable inside the BoosterCore object, then we would need to
 // dereference that before getting the count.  By making this global we can send a log message incase a bad BoosterCore
 // object is sent into us we only decrease the count if the count is non-zero, so at worst if there is a race condition
 // then we'll output this log message more times than desired, but we can live with that
 static int g_cLogGenerateTermUpdate = 10;
 
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
+// with histograms, the gradients are not binned here. Instead, the main bins of each inner bag are filled from the
+// histograms, which ComputeTermHistogram exported and which the caller may have summed across machines
+static ErrorEbm GenerateTermUpdateInternal(void* rng,
       BoosterHandle boosterHandle,
       IntEbm indexTerm,
       TermBoostFlags flags,
@@ -643,40 +1747,11 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
       double maxDeltaStep,
       const IntEbm* leavesMax,
       const MonotoneDirection* direction,
+      const IntEbm countHistogramValues,
+      const double* const histograms,
       double* avgGainOut) {
    ErrorEbm error;
 
-   LOG_COUNTED_N(&g_cLogGenerateTermUpdate,
-         Trace_Info,
-         Trace_Verbose,
-         "GenerateTermUpdate: "
-         "rng=%p, "
-         "boosterHandle=%p, "
-         "indexTerm=%" IntEbmPrintf ", "
-         "flags=0x%" UTermBoostFlagsPrintf ", "
-         "learningRate=%le, "
-         "minSamplesLeaf=%" IntEbmPrintf ", "
-         "minHessian=%le, "
-         "regAlpha=%le, "
-         "regLambda=%le, "
-         "maxDeltaStep=%le, "
-         "leavesMax=%p, "
-         "direction=%p, "
-         "avgGainOut=%p",
-         rng,
-         static_cast<void*>(boosterHandle),
-         indexTerm,
-         static_cast<UTermBoostFlags>(flags), // signed to unsigned conversion is defined behavior in C++
-         learningRate,
-         minSamplesLeaf,
-         minHessian,
-         regAlpha,
-         regLambda,
-         maxDeltaStep,
-         static_cast<const void*>(leavesMax),
-         static_cast<const void*>(direction),
-         static_cast<void*>(avgGainOut));
-
    if(LIKELY(nullptr != avgGainOut)) {
       *avgGainOut = k_illegalGainDouble;
    }
@@ -690,6 +1765,10 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
    // set this to illegal so if we exit with an error we have an invalid index
    pBoosterShell->SetTermIndex(BoosterShell::k_illegalTermIndex);
 
+   // the histogram left by ApplyTermUpdateAndBinNext is only good for this call
+   const size_t iTermBinned = pBoosterShell->GetTermIndexBinned();
+   pBoosterShell->SetTermIndexBinned(BoosterShell::k_illegalTermIndex);
+
    if(indexTerm < 0) {
       LOG_0(Trace_Error, "ERROR GenerateTermUpdate indexTerm must be positive");
       return Error_IllegalParamVal;
@@ -716,7 +1795,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
 
    if(flags &
          ~(TermBoostFlags_DisableNewtonGain | TermBoostFlags_DisableNewtonUpdate | TermBoostFlags_GradientSums |
-               TermBoostFlags_RandomSplits)) {
+               TermBoostFlags_RandomSplits | TermBoostFlags_SortNominal)) {
       LOG_0(Trace_Error, "ERROR GenerateTermUpdate flags contains unknown flags. Ignoring extras.");
    }
 
@@ -803,6 +1882,23 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
 
    const size_t cInnerBagsAfterZero =
          size_t{0} == pBoosterCore->GetCountInnerBags() ? size_t{1} : pBoosterCore->GetCountInnerBags();
+   const size_t cHistogramValuesPerBag =
+         CountHistogramValuesPerBin(pBoosterCore->IsHessian(), cScores) * pTerm->GetCountTensorBins();
+   if(nullptr != histograms) {
+      // the main bins already hold a histogram of this term for each thread, so these cannot overflow
+      if(IsConvertError<size_t>(countHistogramValues) ||
+            static_cast<size_t>(countHistogramValues) != cHistogramValuesPerBag * cInnerBagsAfterZero) {
+         LOG_0(Trace_Error,
+               "ERROR GenerateTermUpdateFromHistogram countHistogramValues must be MeasureTermHistogram times the "
+               "number of inner bags");
+         return Error_IllegalParamVal;
+      }
+      if(size_t{0} == pBoosterCore->GetTrainingSet()->GetCountSamples()) {
+         // the bins and split buffers are only allocated for boosters that have training samples
+         LOG_0(Trace_Error, "ERROR GenerateTermUpdateFromHistogram the booster needs local training samples");
+         return Error_IllegalParamVal;
+      }
+   }
    const size_t cRealDimensions = pTerm->GetCountRealDimensions();
    const size_t cDimensions = pTerm->GetCountDimensions();
 
@@ -813,6 +1909,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
    // and g++ seems to warn about all of that usage, even in other downstream functions!
    size_t cSignificantBinCount = size_t{0};
    MonotoneDirection significantDirection = MONOTONE_NONE;
+   bool bSignificantNominal = false;
    size_t iDimensionImportant = 0;
    if(nullptr == leavesMax) {
       LOG_0(Trace_Warning, "WARNING GenerateTermUpdate leavesMax was null, so there won't be any splits");
@@ -838,6 +1935,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
 
                iDimensionImportant = iDimensionInit;
                cSignificantBinCount = cBins;
+               bSignificantNominal = pFeature->IsNominal();
                significantDirection |= featureDirection;
                EBM_ASSERT(nullptr != pLeavesMax);
                const IntEbm countLeavesMax = *pLeavesMax;
@@ -864,7 +1962,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
    pBoosterShell->GetTermUpdate()->Reset();
 
    double gainAvg = 0.0;
-   if(0 != pBoosterCore->GetTrainingSet()->GetCountSamples()) {
+   if(nullptr != histograms || 0 != pBoosterCore->GetTrainingSet()->GetCountSamples()) {
       const double gradientConstant = pBoosterCore->GradientConstant();
 
       const double multipleCommon = gradientConstant / cInnerBagsAfterZero;
@@ -917,6 +2015,13 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
          pRng = &rngInternal;
       }
 
+      if(nullptr == histograms && pBoosterCore->IsQuantizeGradients() && !pBoosterCore->IsGradientsQuantized()) {
+         error = QuantizeGradients(pBoosterCore, pRng);
+         if(Error_None != error) {
+            return error;
+         }
+      }
+
       pBoosterShell->GetInnerTermUpdate()->SetCountDimensions(cDimensions);
       // if we have ignored dimensions, set the splits count to zero!
       // we only need to do this once instead of per-loop since any dimensions with 1 bin
@@ -930,17 +2035,12 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
          cTensorBins = 1;
       }
 
-      BinBase* const aFastBins = pBoosterShell->GetBoostingFastBinsTemp();
-      EBM_ASSERT(nullptr != aFastBins);
-
-      const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, pBoosterCore->IsHessian(), cScores);
-      EBM_ASSERT(!IsMultiplyError(cBytesPerMainBin, cTensorBins));
-      const size_t cBytesMainBins = cBytesPerMainBin * cTensorBins;
-
       BinBase* const aMainBins = pBoosterShell->GetBoostingMainBins();
       EBM_ASSERT(nullptr != aMainBins);
 
 #ifndef NDEBUG
+      const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, pBoosterCore->IsHessian(), cScores);
+      EBM_ASSERT(!IsMultiplyError(cBytesPerMainBin, cTensorBins));
       size_t cAuxillaryBins = pTerm->GetCountAuxillaryBins();
       if(0 != (TermBoostFlags_RandomSplits & flags)) {
          // if we're doing random boosting we allocated the auxillary memory, but we don't need it
@@ -954,137 +2054,56 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
       size_t iBag = 0;
       EBM_ASSERT(1 <= cInnerBagsAfterZero);
       do {
-         memset(aMainBins, 0, cBytesMainBins);
-
-         EBM_ASSERT(1 <= pBoosterCore->GetTrainingSet()->GetCountSubsets());
-         DataSubsetBoosting* pSubset = pBoosterCore->GetTrainingSet()->GetSubsets();
-         const DataSubsetBoosting* const pSubsetsEnd = pSubset + pBoosterCore->GetTrainingSet()->GetCountSubsets();
-         do {
-            int cPack;
-            if(1 == cTensorBins) {
-               // this is kind of hacky where if any one of a number of things occurs (like we have only 1 leaf)
-               // we sum everything into a single bin. The alternative would be to always sum into the tensor bins
-               // but then collapse them afterwards into a single bin, but that's more work.
-               cPack = k_cItemsPerBitPackUndefined;
-            } else {
-               EBM_ASSERT(1 <= pTerm->GetBitsRequiredMin());
-               cPack =
-                     GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-            }
-
-            size_t cBytesPerFastBin;
-            if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-               if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                  cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, pBoosterCore->IsHessian(), cScores);
-               } else {
-                  EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                  cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, pBoosterCore->IsHessian(), cScores);
-               }
-            } else {
-               EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-               if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                  cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, pBoosterCore->IsHessian(), cScores);
-               } else {
-                  EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                  cBytesPerFastBin =
-                        GetBinSize<FloatSmall, UIntSmall>(false, false, pBoosterCore->IsHessian(), cScores);
-               }
-            }
-            EBM_ASSERT(!IsMultiplyError(cBytesPerFastBin, cTensorBins));
-
-            size_t cParallelTensorBins = cTensorBins;
-            bool bParallelBins = false;
-            const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
-
-            // in the future use TermBoostFlags_DisableNewtonGain and TermBoostFlags_DisableNewtonUpdate and
-            // TermBoostFlags_GradientSums flags in addition to what the objective allows when setting bHessian
-            const bool bHessian = pBoosterCore->IsHessian();
-#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
-            size_t cBytesParallelMax;
-            if(bHessian) {
-               if(size_t {1} == cScores) {
-                  cBytesParallelMax = HESSIAN_PARALLEL_BIN_BYTES_MAX;
-               } else {
-                  cBytesParallelMax = MULTISCORE_PARALLEL_BIN_BYTES_MAX;
-               }
-            } else {
-               if(size_t {1} == cScores) {
-                  cBytesParallelMax = GRADIENT_PARALLEL_BIN_BYTES_MAX;
-               } else {
-                  // don't allow parallel gradient multiclass boosting. multiclass should be hessian boosting
-                  cBytesParallelMax = 0;
-               }
+         size_t cSamplesTotal;
+         double weightTotal;
+         if(nullptr != histograms) {
+            // the weights of a histogram summed across machines add up to the weight of all their training samples
+            error = pBoosterCore->IsHessian() ?
+                  UnpackHistogram<true>(cScores,
+                        pTerm->GetCountTensorBins(),
+                        &histograms[cHistogramValuesPerBag * iBag],
+                        cTensorBins,
+                        aMainBins,
+                        &cSamplesTotal,
+                        &weightTotal) :
+                  UnpackHistogram<false>(cScores,
+                        pTerm->GetCountTensorBins(),
+                        &histograms[cHistogramValuesPerBag * iBag],
+                        cTensorBins,
+                        aMainBins,
+                        &cSamplesTotal,
+                        &weightTotal);
+            if(Error_None != error) {
+               return error;
             }
-            if(1 != cSIMDPack && 1 != cTensorBins) {
-               const size_t cBytesParallel = cBytesPerFastBin * cTensorBins * cSIMDPack;
-               if(cBytesParallel <= cBytesParallelMax) {
-                  // use parallel bins
-                  bParallelBins = true;
-                  cParallelTensorBins *= cSIMDPack;
-               }
+            if(size_t{0} == cSamplesTotal || /* NaN */ !(0.0 < weightTotal)) {
+               LOG_0(Trace_Error,
+                     "ERROR GenerateTermUpdateFromHistogram the histogram counts and weights must not all be zero");
+               return Error_IllegalParamVal;
             }
-#endif
-
-            aFastBins->ZeroMem(cBytesPerFastBin, cParallelTensorBins);
-
-            BinSumsBoostingBridge params;
-            params.m_bParallelBins = bParallelBins ? EBM_TRUE : EBM_FALSE;
-            params.m_bHessian = bHessian ? EBM_TRUE : EBM_FALSE;
-            params.m_cScores = cScores;
-            params.m_cPack = cPack;
-            params.m_cSamples = pSubset->GetCountSamples();
-            params.m_cBytesFastBins = cBytesPerFastBin * cTensorBins;
-            params.m_aGradientsAndHessians = pSubset->GetGradHess();
-            params.m_aWeights = pSubset->GetInnerBag(iBag)->GetWeights();
-            params.m_aPacked = pSubset->GetTermData(iTerm);
-            params.m_aFastBins = aFastBins;
-#ifndef NDEBUG
-            params.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cParallelTensorBins);
-#endif // NDEBUG
-            error = pSubset->BinSumsBoosting(&params);
+         } else if(size_t{0} == iBag && iTerm == iTermBinned && pTerm->GetCountTensorBins() == cTensorBins) {
+            // ApplyTermUpdateAndBinNext already summed the gradients of inner bag zero into aMainBins
+            LOG_0(Trace_Verbose, "GenerateTermUpdate using the histogram from ApplyTermUpdateAndBinNext");
+         } else {
+            // TODO: LightGBM style histogram subtraction (bag = full + sum over samples whose bag weight differs)
+            //       does not pay off for our inner bags. They are sampled with replacement, so about 63% of the
+            //       samples have an occurrence count other than 1 and the delta pass would touch most of the data
+            //       anyways. It would also need a gather version of BinSumsBoosting in every zone since our term
+            //       data is bit packed in SIMD order. The counts and weights already come precomputed from
+            //       TermInnerBag, so only the gradients and hessians are summed here. If we move to subsampling
+            //       without replacement with a high sampling rate, then revisit this. Sibling node histograms
+            //       are already derived by subtraction from the parent in PartitionOneDimensionalBoosting.
+            error = BinTermSubsets(pBoosterShell, iTerm, iBag, cTensorBins);
             if(Error_None != error) {
                return error;
             }
-
-            const bool bUInt64Src = sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes;
-            const bool bDoubleSrc = sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes;
-
-            ++pSubset;
-
-            BinBase* pFastBins = aFastBins;
-            for(size_t i = 0; i < cSIMDPack; ++i) {
-               const UIntMain* aCounts = nullptr;
-               const FloatPrecomp* aWeights = nullptr;
-               if(pSubsetsEnd == pSubset && (!bParallelBins || i == cSIMDPack - 1)) {
-                  // the aCounts and aWeights tensors contain the final counts and weights, so when calling
-                  // ConvertAddBin we only want to call it once with these tensors since otherwise they
-                  // would be added multiple times
-                  aCounts = TermInnerBag::GetCounts(
-                        size_t{1} == cTensorBins, iTerm, iBag, pBoosterCore->GetTrainingSet()->GetTermInnerBags());
-                  aWeights = TermInnerBag::GetWeights(
-                        size_t{1} == cTensorBins, iTerm, iBag, pBoosterCore->GetTrainingSet()->GetTermInnerBags());
-               }
-
-               ConvertAddBin(cScores,
-                     pBoosterCore->IsHessian(),
-                     cTensorBins,
-                     bUInt64Src,
-                     bDoubleSrc,
-                     false,
-                     false,
-                     pFastBins,
-                     aCounts,
-                     aWeights,
-                     std::is_same<UIntMain, uint64_t>::value,
-                     std::is_same<FloatMain, double>::value,
-                     aMainBins);
-
-               if(!bParallelBins) {
-                  break;
-               }
-               pFastBins = IndexBin(pFastBins, cBytesPerFastBin * cTensorBins);
-            }
-         } while(pSubsetsEnd != pSubset);
+         }
+         if(nullptr == histograms) {
+            // fold boosters hold out some of the training samples, so the bag's own total is what the bins sum to
+            cSamplesTotal = static_cast<size_t>(
+                  *TermInnerBag::GetCounts(true, iTerm, iBag, pBoosterCore->GetTrainingSet()->GetTermInnerBags()));
+            weightTotal = pBoosterCore->GetTrainingSet()->GetBagWeightTotal(iBag);
+         }
 
          // TODO: we can exit here back to python to allow caller modification to our histograms
          //       although having inner bags makes this complicated since each inner bag has it's own
@@ -1098,7 +2117,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
             LOG_0(Trace_Warning, "WARNING GenerateTermUpdate boosting zero dimensional");
             BoostZeroDimensional(pBoosterShell, flags, regAlphaCalc, regLambdaCalc, deltaStepMax);
          } else {
-            const double weightTotal = pBoosterCore->GetTrainingSet()->GetBagWeightTotal(iBag);
             EBM_ASSERT(0 < weightTotal); // if all are zeros we assume there are no weights and use the count
 
             double gain;
@@ -1131,6 +2149,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
                      pBoosterShell,
                      flags,
                      cSignificantBinCount,
+                     cSamplesTotal,
                      static_cast<FloatMain>(weightTotal),
                      iDimensionImportant,
                      cSamplesLeafMin,
@@ -1140,6 +2159,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
                      deltaStepMax,
                      lastDimensionLeavesMax,
                      significantDirection,
+                     0 != (TermBoostFlags_SortNominal & flags) && bSignificantNominal,
                      &gain);
                if(Error_None != error) {
                   return error;
@@ -1239,8 +2259,257 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
          "Exited GenerateTermUpdate: "
          "gainAvg=%le",
          gainAvg);
+   TRACE_EVENT(Trace_Info,
+         TraceEvent_GenerateTermUpdate,
+         pBoosterShell->GetHandle(),
+         static_cast<double>(iTerm),
+         learningRate,
+         static_cast<double>(flags),
+         gainAvg);
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
+      BoosterHandle boosterHandle,
+      IntEbm indexTerm,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      const MonotoneDirection* direction,
+      double* avgGainOut) {
+   LOG_COUNTED_N(&g_cLogGenerateTermUpdate,
+         Trace_Info,
+         Trace_Verbose,
+         "GenerateTermUpdate: "
+         "rng=%p, "
+         "boosterHandle=%p, "
+         "indexTerm=%" IntEbmPrintf ", "
+         "flags=0x%" UTermBoostFlagsPrintf ", "
+         "learningRate=%le, "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "leavesMax=%p, "
+         "direction=%p, "
+         "avgGainOut=%p",
+         rng,
+         static_cast<void*>(boosterHandle),
+         indexTerm,
+         static_cast<UTermBoostFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<const void*>(leavesMax),
+         static_cast<const void*>(direction),
+         static_cast<void*>(avgGainOut));
+
+   return GenerateTermUpdateInternal(rng,
+         boosterHandle,
+         indexTerm,
+         flags,
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         leavesMax,
+         direction,
+         0,
+         nullptr,
+         avgGainOut);
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureTermHistogram(BoosterHandle boosterHandle, IntEbm indexTerm) {
+   LOG_N(Trace_Info,
+         "Entered MeasureTermHistogram: "
+         "boosterHandle=%p, "
+         "indexTerm=%" IntEbmPrintf,
+         static_cast<void*>(boosterHandle),
+         indexTerm);
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   if(indexTerm < IntEbm{0} || static_cast<IntEbm>(pBoosterCore->GetCountTerms()) <= indexTerm) {
+      LOG_0(Trace_Error, "ERROR MeasureTermHistogram indexTerm is not a valid term index");
+      return Error_IllegalParamVal;
+   }
+   const Term* const pTerm = pBoosterCore->GetTerms()[static_cast<size_t>(indexTerm)];
 
+   // the main bins hold this many bins of this size, so neither this nor the conversion to IntEbm can overflow
+   const size_t cValues = size_t{0} == pBoosterCore->GetCountScores() ?
+         size_t{0} :
+         CountHistogramValuesPerBin(pBoosterCore->IsHessian(), pBoosterCore->GetCountScores()) *
+               pTerm->GetCountTensorBins();
+   EBM_ASSERT(!IsConvertError<IntEbm>(cValues));
+
+   LOG_N(Trace_Info, "Exited MeasureTermHistogram: %zu", cValues);
+   return static_cast<IntEbm>(cValues);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ComputeTermHistogram(BoosterHandle boosterHandle,
+      IntEbm indexTerm,
+      IntEbm indexBag,
+      IntEbm countHistogramValues,
+      double* histogramOut) {
+   LOG_N(Trace_Info,
+         "Entered ComputeTermHistogram: "
+         "boosterHandle=%p, "
+         "indexTerm=%" IntEbmPrintf ", "
+         "indexBag=%" IntEbmPrintf ", "
+         "countHistogramValues=%" IntEbmPrintf ", "
+         "histogramOut=%p",
+         static_cast<void*>(boosterHandle),
+         indexTerm,
+         indexBag,
+         countHistogramValues,
+         static_cast<void*>(histogramOut));
+
+   const IntEbm countValues = MeasureTermHistogram(boosterHandle, indexTerm);
+   if(countValues < IntEbm{0}) {
+      // already logged
+      return static_cast<ErrorEbm>(countValues);
+   }
+   if(countValues != countHistogramValues) {
+      LOG_0(Trace_Error, "ERROR ComputeTermHistogram countHistogramValues must be the value from MeasureTermHistogram");
+      return Error_IllegalParamVal;
+   }
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   EBM_ASSERT(nullptr != pBoosterShell);
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   const size_t cInnerBagsAfterZero =
+         size_t{0} == pBoosterCore->GetCountInnerBags() ? size_t{1} : pBoosterCore->GetCountInnerBags();
+   if(indexBag < IntEbm{0} || static_cast<IntEbm>(cInnerBagsAfterZero) <= indexBag) {
+      LOG_0(Trace_Error, "ERROR ComputeTermHistogram indexBag is not a valid inner bag index");
+      return Error_IllegalParamVal;
+   }
+   if(IntEbm{0} == countValues) {
+      LOG_0(Trace_Info, "Exited ComputeTermHistogram with no values");
+      return Error_None;
+   }
+   if(nullptr == histogramOut) {
+      LOG_0(Trace_Error, "ERROR ComputeTermHistogram histogramOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t iTerm = static_cast<size_t>(indexTerm);
+   const size_t iBag = static_cast<size_t>(indexBag);
+   const size_t cTensorBins = pBoosterCore->GetTerms()[iTerm]->GetCountTensorBins();
+   const size_t cScores = pBoosterCore->GetCountScores();
+   if(size_t{0} == pBoosterCore->GetTrainingSet()->GetCountSamples()) {
+      // a machine without training samples adds nothing to the sums
+      memset(histogramOut, 0, sizeof(*histogramOut) * static_cast<size_t>(countValues));
+   } else {
+      if(size_t{0} != iBag || iTerm != pBoosterShell->GetTermIndexBinned()) {
+         // the histogram left by ApplyTermUpdateAndBinNext is overwritten, but if it is ours we can use it instead
+         pBoosterShell->SetTermIndexBinned(BoosterShell::k_illegalTermIndex);
+         const ErrorEbm error = BinTermSubsets(pBoosterShell, iTerm, iBag, cTensorBins);
+         if(Error_None != error) {
+            return error;
+         }
+      }
+      if(pBoosterCore->IsHessian()) {
+         PackHistogram<true>(cScores, cTensorBins, pBoosterShell->GetBoostingMainBins(), histogramOut);
+      } else {
+         PackHistogram<false>(cScores, cTensorBins, pBoosterShell->GetBoostingMainBins(), histogramOut);
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited ComputeTermHistogram");
    return Error_None;
 }
 
+static int g_cLogGenerateTermUpdateFromHistogram = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdateFromHistogram(void* rng,
+      BoosterHandle boosterHandle,
+      IntEbm indexTerm,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      const MonotoneDirection* direction,
+      IntEbm countHistogramValues,
+      const double* histograms,
+      double* avgGainOut) {
+   LOG_COUNTED_N(&g_cLogGenerateTermUpdateFromHistogram,
+         Trace_Info,
+         Trace_Verbose,
+         "GenerateTermUpdateFromHistogram: "
+         "rng=%p, "
+         "boosterHandle=%p, "
+         "indexTerm=%" IntEbmPrintf ", "
+         "flags=0x%" UTermBoostFlagsPrintf ", "
+         "learningRate=%le, "
+         "minSamplesLeaf=%" IntEbmPrintf ", "
+         "minHessian=%le, "
+         "regAlpha=%le, "
+         "regLambda=%le, "
+         "maxDeltaStep=%le, "
+         "leavesMax=%p, "
+         "direction=%p, "
+         "countHistogramValues=%" IntEbmPrintf ", "
+         "histograms=%p, "
+         "avgGainOut=%p",
+         rng,
+         static_cast<void*>(boosterHandle),
+         indexTerm,
+         static_cast<UTermBoostFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         static_cast<const void*>(leavesMax),
+         static_cast<const void*>(direction),
+         countHistogramValues,
+         static_cast<const void*>(histograms),
+         static_cast<void*>(avgGainOut));
+
+   if(nullptr == histograms) {
+      if(nullptr != avgGainOut) {
+         *avgGainOut = k_illegalGainDouble;
+      }
+      LOG_0(Trace_Error, "ERROR GenerateTermUpdateFromHistogram histograms cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   return GenerateTermUpdateInternal(rng,
+         boosterHandle,
+         indexTerm,
+         flags,
+         learningRate,
+         minSamplesLeaf,
+         minHessian,
+         regAlpha,
+         regLambda,
+         maxDeltaStep,
+         leavesMax,
+         direction,
+         countHistogramValues,
+         histograms,
+         avgGainOut);
+}
+
 } // namespace DEFINED_ZONE_NAME
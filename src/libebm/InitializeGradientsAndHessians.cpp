@@ -27,8 +27,7 @@ namespace DEFINED_ZONE_NAME {
 
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
-extern void InitializeRmseGradientsAndHessiansBoosting(const unsigned char* const pDataSetShared,
-      const BagEbm direction,
+extern void InitializeRmseGradientsAndHessiansBoosting(const BagEbm direction,
       const BagEbm* const aBag,
       const double* const aInitScores,
       DataSetBoosting* const pDataSet) {
@@ -36,16 +35,13 @@ extern void InitializeRmseGradientsAndHessiansBoosting(const unsigned char* cons
 
    LOG_0(Trace_Info, "Entered InitializeRmseGradientsAndHessiansBoosting");
 
-   EBM_ASSERT(nullptr != pDataSetShared);
    EBM_ASSERT(BagEbm{-1} == direction || BagEbm{1} == direction);
    EBM_ASSERT(nullptr != pDataSet);
 
    if(size_t{0} != pDataSet->GetCountSamples()) {
-      ptrdiff_t cRuntimeClasses;
-      const FloatShared* pTargetData =
-            static_cast<const FloatShared*>(GetDataSetSharedTarget(pDataSetShared, 0, &cRuntimeClasses));
-      EBM_ASSERT(nullptr != pTargetData); // we previously called GetDataSetSharedTarget and got back non-null result
-      EBM_ASSERT(ptrdiff_t{Task_Regression} == cRuntimeClasses);
+      // the targets were copied with one entry per sample, so replicated samples already have their own copies
+      const FloatShared* pTargetData = pDataSet->GetOriginalTargets();
+      EBM_ASSERT(nullptr != pTargetData);
 
       const BagEbm* pSampleReplication = aBag;
       const double* pInitScore = aInitScores;
@@ -62,7 +58,6 @@ extern void InitializeRmseGradientsAndHessiansBoosting(const unsigned char* cons
 
       double initScore = 0;
       BagEbm replication = 0;
-      double gradient;
       do {
          EBM_ASSERT(1 <= pSubset->GetCountSamples());
          void* pGradHess = pSubset->GetGradHess();
@@ -81,38 +76,36 @@ extern void InitializeRmseGradientsAndHessiansBoosting(const unsigned char* cons
                      do {
                         replication = *pSampleReplication;
                         ++pSampleReplication;
-                        ++pTargetData;
                      } while(BagEbm{0} == replication);
                      isItemValidation = replication < BagEbm{0};
                      ++cInitAdvances;
                   } while(isLoopValidation != isItemValidation);
-                  --pTargetData;
                }
-               const FloatShared data = *pTargetData;
-               ++pTargetData;
 
                if(nullptr != pInitScore) {
                   pInitScore += cInitAdvances;
                   initScore = pInitScore[-1];
                }
+            }
+            const FloatShared data = *pTargetData;
+            ++pTargetData;
 
-               // TODO : our caller should handle NaN *pTargetData values, which means that the target is missing, which
-               // means we should delete that sample
-               //   from the input data
+            // TODO : our caller should handle NaN *pTargetData values, which means that the target is missing, which
+            // means we should delete that sample
+            //   from the input data
 
-               // if data is NaN, we pass this along and NaN propagation will ensure that we stop boosting immediately.
-               // There is no need to check it here since we already have graceful detection later for other reasons.
+            // if data is NaN, we pass this along and NaN propagation will ensure that we stop boosting immediately.
+            // There is no need to check it here since we already have graceful detection later for other reasons.
 
-               // TODO: NaN target values essentially mean missing, so we should be filtering those samples out, but our
-               // caller should do that so
-               //   that we don't need to do the work here per outer bag.  Our job in C++ is just not to crash or return
-               //   inexplicable values.
+            // TODO: NaN target values essentially mean missing, so we should be filtering those samples out, but our
+            // caller should do that so
+            //   that we don't need to do the work here per outer bag.  Our job in C++ is just not to crash or return
+            //   inexplicable values.
 
-               // for RMSE regression, the gradient is the residual, and we can calculate it once at init and we don't
-               // need to keep the original scores when computing the gradient updates.
+            // for RMSE regression, the gradient is the residual, and we can calculate it once at init and we don't
+            // need to keep the original scores when computing the gradient updates.
 
-               gradient = initScore - static_cast<double>(data);
-            }
+            const double gradient = initScore - static_cast<double>(data);
 
             if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
                *reinterpret_cast<FloatBig*>(pGradHess) = static_cast<FloatBig>(gradient);
@@ -9,7 +9,7 @@
 #include <string.h> // memcpy
 
 #include "logging.h" // EBM_ASSERT
-#include "unzoned.h" // AlignedFree
+#include "unzoned.h"
 
 #define ZONE_main
 #include "zones.h"
@@ -52,7 +52,8 @@ InnerBag* InnerBag::AllocateInnerBags(const size_t cInnerBags) {
 // Visual Studio compiler seems to not like the index addition by 1 to make cInnerBagsAfterZero
 WARNING_PUSH
 WARNING_DISABLE_USING_UNINITIALIZED_MEMORY
-void InnerBag::FreeInnerBags(const size_t cInnerBags, InnerBag* const aInnerBags) {
+void InnerBag::FreeInnerBags(
+      const size_t cInnerBags, InnerBag* const aInnerBags, const ALIGNED_FREE_C pAlignedFree) {
    LOG_0(Trace_Info, "Entered InnerBag::FreeInnerBags");
 
    if(LIKELY(nullptr != aInnerBags)) {
@@ -60,7 +61,7 @@ void InnerBag::FreeInnerBags(const size_t cInnerBags, InnerBag* const aInnerBags
       InnerBag* pInnerBag = aInnerBags;
       const InnerBag* const pInnerBagsEnd = aInnerBags + cInnerBagsAfterZero;
       do {
-         AlignedFree(pInnerBag->m_aWeights);
+         (*pAlignedFree)(pInnerBag->m_aWeights);
          ++pInnerBag;
       } while(pInnerBagsEnd != pInnerBag);
       free(aInnerBags);
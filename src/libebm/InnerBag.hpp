@@ -9,6 +9,8 @@
 
 #include "unzoned.h"
 
+#include "bridge.h" // ALIGNED_FREE_C
+
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
@@ -25,7 +27,8 @@ struct InnerBag final {
    void operator delete(void*) = delete; // we only use malloc/free in this library
 
    static InnerBag* AllocateInnerBags(const size_t cInnerBags);
-   static void FreeInnerBags(const size_t cInnerBags, InnerBag* const aInnerBags);
+   static void FreeInnerBags(
+         const size_t cInnerBags, InnerBag* const aInnerBags, const ALIGNED_FREE_C pAlignedFree);
 
    inline const void* GetWeights() const { return m_aWeights; }
 
@@ -18,7 +18,9 @@
 
 #include "ebm_internal.hpp"
 #include "Feature.hpp" // Feature
+#include "Term.hpp" // Term
 #include "dataset_shared.hpp" // GetDataSetSharedHeader
+#include "ThreadPool.hpp" // ThreadPool
 #include "InteractionCore.hpp"
 
 namespace DEFINED_ZONE_NAME {
@@ -31,6 +33,10 @@ extern ErrorEbm Unbag(const size_t cSamples,
       size_t* const pcTrainingSamplesOut,
       size_t* const pcValidationSamplesOut);
 
+// splitting the samples across threads pays for the thread wake ups and the extra fast bin reductions only once each
+// thread has this many samples to bin
+static constexpr size_t k_cSamplesPerThreadMin = size_t{65536};
+
 NEVER_INLINE extern ErrorEbm GetObjective(const Config* const pConfig,
       const char* sObjective,
       const AccelerationFlags acceleration,
@@ -208,6 +214,7 @@ ErrorEbm InteractionCore::Create(const unsigned char* const pDataSetShared,
          UIntShared countBins;
          UIntShared defaultValSparse;
          size_t cNonDefaultsSparse;
+         size_t cBytesExternal;
          GetDataSetSharedFeature(pDataSetShared,
                iFeatureInitialize,
                &bMissing,
@@ -216,7 +223,8 @@ ErrorEbm InteractionCore::Create(const unsigned char* const pDataSetShared,
                &bSparse,
                &countBins,
                &defaultValSparse,
-               &cNonDefaultsSparse);
+               &cNonDefaultsSparse,
+               &cBytesExternal);
          EBM_ASSERT(!bSparse); // not handled yet
 
          if(IsConvertError<size_t>(countBins)) {
@@ -275,7 +283,16 @@ ErrorEbm InteractionCore::Create(const unsigned char* const pDataSetShared,
       }
       LOG_0(Trace_Info, "INFO InteractionCore::Create Objective determined");
 
-      const TaskEbm task = IdentifyTask(pInteractionCore->m_objectiveCpu.m_linkFunction);
+      const bool bRequireAcceleration = 0 != (CreateInteractionFlags_RequireAcceleration & flags);
+      if(bRequireAcceleration && AccelerationFlags_NONE != acceleration &&
+            nullptr == pInteractionCore->m_objectiveSIMD.m_pObjective) {
+         LOG_0(Trace_Warning,
+               "WARNING InteractionCore::Create CreateInteractionFlags_RequireAcceleration and no requested zone is "
+               "available for this objective");
+         return Error_UserParamVal;
+      }
+
+      const TaskEbm task = pInteractionCore->m_objectiveCpu.m_task;
       if(ptrdiff_t{Task_GeneralClassification} <= cClasses) {
          if(task < Task_GeneralClassification) {
             LOG_0(Trace_Error, "ERROR InteractionCore::Create mismatch in objective class model type");
@@ -301,6 +318,12 @@ ErrorEbm InteractionCore::Create(const unsigned char* const pDataSetShared,
          }
          if(0 != pInteractionCore->m_objectiveSIMD.m_cUIntBytes) {
             if(CheckInteractionRestrictions(pInteractionCore, &pInteractionCore->m_objectiveCpu, cBinsMax)) {
+               if(bRequireAcceleration) {
+                  LOG_0(Trace_Warning,
+                        "WARNING InteractionCore::Create CreateInteractionFlags_RequireAcceleration and cannot fit "
+                        "indexes in the SIMD zone");
+                  return Error_UserParamVal;
+               }
                FreeObjectiveWrapperInternals(&pInteractionCore->m_objectiveSIMD);
                InitializeObjectiveWrapperUnfailing(&pInteractionCore->m_objectiveSIMD);
             }
@@ -324,9 +347,30 @@ ErrorEbm InteractionCore::Create(const unsigned char* const pDataSetShared,
 
          const bool bHessian = pInteractionCore->IsHessian();
 
+         const size_t cThreads = EbmMin(
+               ThreadPool::GetCountThreadsMax(), EbmMax(size_t{1}, cTrainingSamples / k_cSamplesPerThreadMin));
+         pInteractionCore->m_cThreads = cThreads;
+
+         // give each thread at least one subset to bin, as BoosterCore does for its training set
+         static constexpr size_t k_cSubsetSamplesMultiple = 64;
+         size_t cSubsetItemsMax = bForceMultipleSubsets ? k_cSubsetSamplesMax : SIZE_MAX;
+         if(size_t{1} != cThreads) {
+            size_t cSamplesPerThread = (cTrainingSamples + cThreads - 1) / cThreads;
+            cSamplesPerThread = (cSamplesPerThread + k_cSubsetSamplesMultiple - 1) / k_cSubsetSamplesMultiple *
+                  k_cSubsetSamplesMultiple;
+            cSubsetItemsMax = EbmMin(cSubsetItemsMax, cSamplesPerThread);
+         }
+         if(CreateInteractionFlags_JackknifeGroups & flags) {
+            // each jackknife group is a run of whole subsets, so we need at least as many subsets as groups
+            size_t cSamplesPerGroup = (cTrainingSamples + k_cJackknifeGroups - 1) / k_cJackknifeGroups;
+            cSamplesPerGroup = (cSamplesPerGroup + k_cSubsetSamplesMultiple - 1) / k_cSubsetSamplesMultiple *
+                  k_cSubsetSamplesMultiple;
+            cSubsetItemsMax = EbmMin(cSubsetItemsMax, cSamplesPerGroup);
+         }
+
          error = pInteractionCore->m_dataFrame.InitDataSetInteraction(bHessian,
                cScores,
-               bForceMultipleSubsets ? k_cSubsetSamplesMax : SIZE_MAX,
+               cSubsetItemsMax,
                &pInteractionCore->m_objectiveCpu,
                &pInteractionCore->m_objectiveSIMD,
                pDataSetShared,
@@ -350,6 +394,208 @@ ErrorEbm InteractionCore::Create(const unsigned char* const pDataSetShared,
    return Error_None;
 }
 
+ErrorEbm InteractionCore::CreateFromBooster(BoosterCore* const pBoosterCore,
+      const CreateInteractionFlags flags,
+      InteractionCore** const ppInteractionCoreOut) {
+   LOG_0(Trace_Info, "Entered InteractionCore::CreateFromBooster");
+
+   EBM_ASSERT(nullptr != pBoosterCore);
+   EBM_ASSERT(nullptr != ppInteractionCoreOut);
+   EBM_ASSERT(nullptr == *ppInteractionCoreOut);
+
+   ErrorEbm error;
+
+   InteractionCore* pInteractionCore;
+   try {
+      pInteractionCore = new InteractionCore();
+   } catch(const std::bad_alloc&) {
+      LOG_0(Trace_Warning, "WARNING InteractionCore::CreateFromBooster Out of memory allocating InteractionCore");
+      return Error_OutOfMemory;
+   } catch(...) {
+      LOG_0(Trace_Warning, "WARNING InteractionCore::CreateFromBooster Unknown error");
+      return Error_UnexpectedInternal;
+   }
+   if(nullptr == pInteractionCore) {
+      // this should be impossible since bad_alloc should have been thrown, but let's be untrusting
+      LOG_0(Trace_Warning, "WARNING InteractionCore::CreateFromBooster nullptr == pInteractionCore");
+      return Error_OutOfMemory;
+   }
+   // give ownership of our object back to the caller, even if there is a failure
+   *ppInteractionCoreOut = pInteractionCore;
+
+   // from here on our destructor must not free the booster's objective, so take the reference first
+   pBoosterCore->AddReferenceCount();
+   pInteractionCore->m_pBoosterCore = pBoosterCore;
+
+   pInteractionCore->m_bUseApprox = CreateInteractionFlags_UseApprox & flags ? EBM_TRUE : EBM_FALSE;
+
+   const size_t cScores = pBoosterCore->GetCountScores();
+   pInteractionCore->m_cScores = cScores;
+
+   const size_t cFeatures = pBoosterCore->GetCountFeatures();
+   if(size_t{0} == cFeatures) {
+      LOG_0(Trace_Info, "Exited InteractionCore::CreateFromBooster");
+      return Error_None;
+   }
+
+   if(IsMultiplyError(sizeof(FeatureInteraction), cFeatures)) {
+      LOG_0(Trace_Warning,
+            "WARNING InteractionCore::CreateFromBooster IsMultiplyError(sizeof(FeatureInteraction), cFeatures)");
+      return Error_OutOfMemory;
+   }
+   FeatureInteraction* const aFeatures =
+         static_cast<FeatureInteraction*>(malloc(sizeof(FeatureInteraction) * cFeatures));
+   if(nullptr == aFeatures) {
+      LOG_0(Trace_Warning, "WARNING InteractionCore::CreateFromBooster nullptr == aFeatures");
+      return Error_OutOfMemory;
+   }
+   pInteractionCore->m_cFeatures = cFeatures;
+   pInteractionCore->m_aFeatures = aFeatures;
+
+   if(IsMultiplyError(sizeof(size_t), cFeatures)) {
+      LOG_0(Trace_Warning, "WARNING InteractionCore::CreateFromBooster IsMultiplyError(sizeof(size_t), cFeatures)");
+      return Error_OutOfMemory;
+   }
+   size_t* const aiFeatureTerms = static_cast<size_t*>(malloc(sizeof(size_t) * cFeatures));
+   if(nullptr == aiFeatureTerms) {
+      LOG_0(Trace_Warning, "WARNING InteractionCore::CreateFromBooster nullptr == aiFeatureTerms");
+      return Error_OutOfMemory;
+   }
+
+   const FeatureBoosting* const aFeaturesFrom = pBoosterCore->GetFeatures();
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const FeatureBoosting* const pFeatureFrom = &aFeaturesFrom[iFeature];
+      aFeatures[iFeature].Initialize(pFeatureFrom->GetCountBins(),
+            pFeatureFrom->IsMissing(),
+            pFeatureFrom->IsUnknown(),
+            pFeatureFrom->IsNominal());
+      aiFeatureTerms[iFeature] = SIZE_MAX;
+   }
+
+   // DataSetBoosting packs the tensor index of each term, which is the feature bin for a term of only one feature.
+   // Features with fewer than 2 bins have no packed data and CalcInteractionStrength returns 0 before needing any
+   size_t cBinsMax = 1;
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   Term* const* const apTerms = pBoosterCore->GetTerms();
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const Term* const pTerm = apTerms[iTerm];
+      if(size_t{1} == pTerm->GetCountDimensions()) {
+         const FeatureBoosting* const pFeatureFrom = pTerm->GetTermFeatures()[0].m_pFeature;
+         const size_t iFeature = static_cast<size_t>(pFeatureFrom - aFeaturesFrom);
+         EBM_ASSERT(iFeature < cFeatures);
+         const size_t cBins = pFeatureFrom->GetCountBins();
+         if(size_t{2} <= cBins && SIZE_MAX == aiFeatureTerms[iFeature]) {
+            aiFeatureTerms[iFeature] = iTerm;
+            cBinsMax = EbmMax(cBinsMax, cBins);
+         }
+      }
+   }
+
+   if(size_t{0} != cScores) {
+      pInteractionCore->m_objectiveCpu = *pBoosterCore->GetObjectiveCpu();
+
+      const size_t cTrainingSamples = pBoosterCore->GetTrainingSet()->GetCountSamples();
+      if(size_t{0} != cTrainingSamples) {
+         if(CheckInteractionRestrictions(pInteractionCore, pBoosterCore->GetObjectiveCpu(), cBinsMax) ||
+               (0 != pBoosterCore->GetObjectiveSIMD()->m_cUIntBytes &&
+                     CheckInteractionRestrictions(pInteractionCore, pBoosterCore->GetObjectiveSIMD(), cBinsMax))) {
+            // the booster's subsets are already laid out for its zones, so unlike Create we cannot fall back
+            LOG_0(Trace_Warning,
+                  "WARNING InteractionCore::CreateFromBooster cannot fit indexes in the booster's zones");
+            free(aiFeatureTerms);
+            return Error_IllegalParamVal;
+         }
+
+         if(IsOverflowBinSize<FloatMain, UIntMain>(true, true, pInteractionCore->IsHessian(), cScores)) {
+            LOG_0(Trace_Warning, "WARNING InteractionCore::CreateFromBooster IsOverflowBinSize overflow");
+            free(aiFeatureTerms);
+            return Error_OutOfMemory;
+         }
+
+         const size_t cThreads = EbmMin(
+               ThreadPool::GetCountThreadsMax(), EbmMax(size_t{1}, cTrainingSamples / k_cSamplesPerThreadMin));
+         pInteractionCore->m_cThreads = cThreads;
+
+         error = pInteractionCore->m_dataFrame.InitDataSetInteractionFromBoosting(
+               pBoosterCore->GetTrainingSet(), pBoosterCore->GetCountInnerBags(), cFeatures, aiFeatureTerms);
+         if(Error_None != error) {
+            free(aiFeatureTerms);
+            return error;
+         }
+      }
+   }
+   free(aiFeatureTerms);
+
+   LOG_0(Trace_Info, "Exited InteractionCore::CreateFromBooster");
+   return Error_None;
+}
+
+ErrorEbm InteractionCore::AllocateMarginalBins(BinBase*** const papMarginalBinsOut) {
+   LOG_0(Trace_Info, "Entered InteractionCore::AllocateMarginalBins");
+
+   EBM_ASSERT(nullptr == m_apMarginalBins);
+   EBM_ASSERT(nullptr == m_aMarginalBins);
+   EBM_ASSERT(1 <= m_cFeatures);
+
+   // the size of the main bins was checked for overflow in InteractionCore::Create
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, IsHessian(), m_cScores);
+
+   size_t cMarginalBins = 0;
+   for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+      const size_t cBins = m_aFeatures[iFeature].GetCountBins();
+      if(size_t{2} <= cBins) {
+         if(IsAddError(cMarginalBins, cBins)) {
+            LOG_0(Trace_Warning, "WARNING InteractionCore::AllocateMarginalBins IsAddError(cMarginalBins, cBins)");
+            return Error_OutOfMemory;
+         }
+         cMarginalBins += cBins;
+      }
+   }
+   if(IsMultiplyError(cBytesPerMainBin, cMarginalBins)) {
+      LOG_0(Trace_Warning,
+            "WARNING InteractionCore::AllocateMarginalBins IsMultiplyError(cBytesPerMainBin, cMarginalBins)");
+      return Error_OutOfMemory;
+   }
+   if(IsMultiplyError(sizeof(*m_apMarginalBins), m_cFeatures)) {
+      LOG_0(Trace_Warning,
+            "WARNING InteractionCore::AllocateMarginalBins IsMultiplyError(sizeof(*m_apMarginalBins), m_cFeatures)");
+      return Error_OutOfMemory;
+   }
+
+   BinBase** const apMarginalBins = static_cast<BinBase**>(malloc(sizeof(*m_apMarginalBins) * m_cFeatures));
+   if(nullptr == apMarginalBins) {
+      LOG_0(Trace_Warning, "WARNING InteractionCore::AllocateMarginalBins nullptr == apMarginalBins");
+      return Error_OutOfMemory;
+   }
+   m_apMarginalBins = apMarginalBins;
+
+   BinBase* pMarginalBins = nullptr;
+   if(size_t{0} != cMarginalBins) {
+      pMarginalBins = static_cast<BinBase*>(AlignedAlloc(cBytesPerMainBin * cMarginalBins));
+      if(nullptr == pMarginalBins) {
+         LOG_0(Trace_Warning, "WARNING InteractionCore::AllocateMarginalBins nullptr == pMarginalBins");
+         return Error_OutOfMemory;
+      }
+      m_aMarginalBins = pMarginalBins;
+      m_cBytesMarginalBins = cBytesPerMainBin * cMarginalBins;
+   }
+
+   for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+      const size_t cBins = m_aFeatures[iFeature].GetCountBins();
+      if(size_t{2} <= cBins) {
+         apMarginalBins[iFeature] = pMarginalBins;
+         pMarginalBins = IndexBin(pMarginalBins, cBytesPerMainBin * cBins);
+      } else {
+         apMarginalBins[iFeature] = nullptr;
+      }
+   }
+
+   *papMarginalBinsOut = apMarginalBins;
+
+   LOG_0(Trace_Info, "Exited InteractionCore::AllocateMarginalBins");
+   return Error_None;
+}
+
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(const unsigned char* const pDataSetShared,
@@ -395,13 +641,13 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(const unsign
          cBytesTempMax = EbmMax(cBytesTempMax, cBytesTemp);
 
          if(ptrdiff_t{Task_GeneralClassification} <= cClasses) {
-            if(IsMultiplyError(pSubsetInit->GetObjectiveWrapper()->m_cUIntBytes, cSamples)) {
+            if(IsMultiplyError(pSubsetInit->GetObjectiveWrapper()->m_cTargetBytes, cSamples)) {
                LOG_0(Trace_Warning,
                      "WARNING InteractionCore::InitializeInteractionGradientsAndHessians "
-                     "IsMultiplyError(pSubsetInit->GetObjectiveWrapper()->m_cUIntBytes, cSamples)");
+                     "IsMultiplyError(pSubsetInit->GetObjectiveWrapper()->m_cTargetBytes, cSamples)");
                return Error_OutOfMemory;
             }
-            const size_t cBytesTarget = pSubsetInit->GetObjectiveWrapper()->m_cUIntBytes * cSamples;
+            const size_t cBytesTarget = pSubsetInit->GetObjectiveWrapper()->m_cTargetBytes * cSamples;
             cBytesTargetMax = EbmMax(cBytesTargetMax, cBytesTarget);
          } else {
             if(IsMultiplyError(pSubsetInit->GetObjectiveWrapper()->m_cFloatBytes, cSamples)) {
@@ -418,6 +664,7 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(const unsign
       } while(pSubsetsEnd != pSubsetInit);
 
       ApplyUpdateBridge data;
+      data.m_aAucBins = nullptr;
 
       void* const aSampleScoreTo = AlignedAlloc(cBytesAllScoresMax);
       if(UNLIKELY(nullptr == aSampleScoreTo)) {
@@ -435,6 +682,7 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(const unsign
          goto free_sample_scores;
       }
       data.m_aUpdateTensorScores = aUpdateScores;
+      data.m_cTensorBins = 1;
 
       memset(aUpdateScores, 0, cBytesScoresMax);
 
@@ -478,8 +726,8 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(const unsign
 
             void* pTargetTo = aTargetTo;
             void* pSampleScoreTo = aSampleScoreTo;
-            const void* const pTargetToEnd =
-                  IndexByte(aTargetTo, pSubset->GetObjectiveWrapper()->m_cUIntBytes * pSubset->GetCountSamples());
+            const size_t cTargetBytes = pSubset->GetObjectiveWrapper()->m_cTargetBytes;
+            const void* const pTargetToEnd = IndexByte(aTargetTo, cTargetBytes * pSubset->GetCountSamples());
             double initScore = 0.0;
             do {
                size_t iPartition = 0;
@@ -515,13 +763,15 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(const unsign
                      EBM_ASSERT(target < static_cast<UIntShared>(cClasses));
                   }
 
-                  if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+                  if(sizeof(uint8_t) == cTargetBytes) {
+                     *reinterpret_cast<uint8_t*>(pTargetTo) = static_cast<uint8_t>(target);
+                  } else if(sizeof(UIntBig) == cTargetBytes) {
                      *reinterpret_cast<UIntBig*>(pTargetTo) = static_cast<UIntBig>(target);
                   } else {
-                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+                     EBM_ASSERT(sizeof(UIntSmall) == cTargetBytes);
                      *reinterpret_cast<UIntSmall*>(pTargetTo) = static_cast<UIntSmall>(target);
                   }
-                  pTargetTo = IndexByte(pTargetTo, pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+                  pTargetTo = IndexByte(pTargetTo, cTargetBytes);
 
                   size_t iScore = 0;
                   do {
@@ -11,7 +11,9 @@
 #include <atomic>
 
 #include "libebm.h" // ErrorEbm
+#include "unzoned.h" // AlignedFree
 
+#include "BoosterCore.hpp"
 #include "DataSetInteraction.hpp"
 
 namespace DEFINED_ZONE_NAME {
@@ -20,6 +22,10 @@ namespace DEFINED_ZONE_NAME {
 #endif // DEFINED_ZONE_NAME
 
 class FeatureInteraction;
+struct BinBase;
+
+// CalcInteractionStrengthInterval leaves out up to this many groups of subsets, one at a time
+static constexpr size_t k_cJackknifeGroups = 16;
 
 class InteractionCore final {
 
@@ -41,13 +47,33 @@ class InteractionCore final {
    ObjectiveWrapper m_objectiveCpu;
    ObjectiveWrapper m_objectiveSIMD;
 
+   // the most threads that CalcInteractionStrength borrows from the shared ThreadPool to bin the subsets, or zero if
+   // there are no samples to bin. The terms of CalcInteractionStrengths are already spread across threads
+   size_t m_cThreads;
+
+   // with CreateInteractionFlags_CacheMarginals we keep the 1 dimensional bins of each feature, which let
+   // CalcInteractionStrength skip pairs that cannot have a legal cut without binning them. The features with fewer
+   // than 2 bins have nullptr
+   BinBase** m_apMarginalBins;
+   BinBase* m_aMarginalBins;
+   size_t m_cBytesMarginalBins;
+
+   // non-null if we were created by CreateFromBooster. We hold a reference to the booster since m_dataFrame
+   // borrows its training set, and m_objectiveCpu is a copy of the booster's that we do not free
+   BoosterCore* m_pBoosterCore;
+
    inline ~InteractionCore() {
       // this only gets called after our reference count has been decremented to zero
 
       m_dataFrame.DestructDataSetInteraction(m_cFeatures);
       free(m_aFeatures);
-      FreeObjectiveWrapperInternals(&m_objectiveCpu);
-      FreeObjectiveWrapperInternals(&m_objectiveSIMD);
+      if(nullptr == m_pBoosterCore) {
+         FreeObjectiveWrapperInternals(&m_objectiveCpu);
+         FreeObjectiveWrapperInternals(&m_objectiveSIMD);
+      }
+      BoosterCore::Free(m_pBoosterCore);
+      free(m_apMarginalBins);
+      AlignedFree(m_aMarginalBins);
    };
 
    inline InteractionCore() noexcept :
@@ -55,7 +81,12 @@ class InteractionCore final {
          m_cScores(0),
          m_bUseApprox(EBM_FALSE),
          m_cFeatures(0),
-         m_aFeatures(nullptr) {
+         m_aFeatures(nullptr),
+         m_cThreads(0),
+         m_apMarginalBins(nullptr),
+         m_aMarginalBins(nullptr),
+         m_cBytesMarginalBins(0),
+         m_pBoosterCore(nullptr) {
       m_dataFrame.SafeInitDataSetInteraction();
       InitializeObjectiveWrapperUnfailing(&m_objectiveCpu);
       InitializeObjectiveWrapperUnfailing(&m_objectiveSIMD);
@@ -71,6 +102,15 @@ class InteractionCore final {
 
    inline size_t GetCountScores() const { return m_cScores; }
 
+   inline AccelerationFlags GetAcceleration() const {
+      // detectors made from a booster bin with the booster's objectives
+      const ObjectiveWrapper* const pObjectiveSIMD =
+            nullptr == m_pBoosterCore ? &m_objectiveSIMD : m_pBoosterCore->GetObjectiveSIMD();
+      return nullptr == pObjectiveSIMD->m_pObjective ? AccelerationFlags_NONE : pObjectiveSIMD->m_zone;
+   }
+
+   inline size_t GetCountBytesMarginalBins() const { return m_cBytesMarginalBins; }
+
    inline const DataSetInteraction* GetDataSetInteraction() const { return &m_dataFrame; }
    inline DataSetInteraction* GetDataSetInteraction() { return &m_dataFrame; }
 
@@ -78,6 +118,15 @@ class InteractionCore final {
 
    inline size_t GetCountFeatures() const { return m_cFeatures; }
 
+   inline size_t GetCountThreads() const { return m_cThreads; }
+
+   inline const BinBase* GetMarginalBins(const size_t iFeature) const {
+      return nullptr == m_apMarginalBins ? nullptr : m_apMarginalBins[iFeature];
+   }
+
+   // allocates the marginal bins, which the caller fills, and returns the array indexed by feature
+   ErrorEbm AllocateMarginalBins(BinBase*** const papMarginalBinsOut);
+
    static void Free(InteractionCore* const pInteractionCore);
    static ErrorEbm Create(const unsigned char* const pDataSetShared,
          const size_t cSamples,
@@ -90,6 +139,12 @@ class InteractionCore final {
          const double* const experimentalParams,
          InteractionCore** const ppInteractionCoreOut);
 
+   // the features with a term of only that feature in pBoosterCore can be used, and their interaction strengths
+   // use the booster's current gradients and hessians. Boosting must not run while interactions are being calculated
+   static ErrorEbm CreateFromBooster(BoosterCore* const pBoosterCore,
+         const CreateInteractionFlags flags,
+         InteractionCore** const ppInteractionCoreOut);
+
    ErrorEbm InitializeInteractionGradientsAndHessians(const unsigned char* const pDataSetShared,
          const size_t cWeights,
          const BagEbm* const aBag,
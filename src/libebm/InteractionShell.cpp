@@ -14,6 +14,7 @@
 #include "bridge.hpp"
 
 #include "dataset_shared.hpp" // GetDataSetSharedHeader
+#include "BoosterShell.hpp"
 #include "InteractionCore.hpp"
 #include "InteractionShell.hpp"
 
@@ -28,12 +29,20 @@ extern void InitializeRmseGradientsAndHessiansInteraction(const unsigned char* c
       const double* const aInitScores,
       DataSetInteraction* const pDataSet);
 
+extern ErrorEbm CacheInteractionMarginals(InteractionShell* const pInteractionShell);
+
 void InteractionShell::Free(InteractionShell* const pInteractionShell) {
    LOG_0(Trace_Info, "Entered InteractionShell::Free");
 
    if(nullptr != pInteractionShell) {
-      AlignedFree(pInteractionShell->m_aInteractionFastBinsTemp);
-      AlignedFree(pInteractionShell->m_aInteractionMainBins);
+      ScratchArena* const pScratchArena = pInteractionShell->m_pScratchArena;
+      InteractionBins* const aBins = pInteractionShell->m_aBins;
+      for(size_t iBins = 0; iBins < pInteractionShell->m_cBins; ++iBins) {
+         ScratchArena::Release(pScratchArena, aBins[iBins].m_aFastBinsTemp, aBins[iBins].m_cBytesFastBins);
+         ScratchArena::Release(pScratchArena, aBins[iBins].m_aMainBins, aBins[iBins].m_cAllocatedMainBinBytes);
+      }
+      free(aBins);
+      ScratchArena::Free(pScratchArena);
       InteractionCore::Free(pInteractionShell->m_pInteractionCore);
 
       // before we free our memory, indicate it was freed so if our higher level language attempts to use it we have
@@ -45,7 +54,7 @@ void InteractionShell::Free(InteractionShell* const pInteractionShell) {
    LOG_0(Trace_Info, "Exited InteractionShell::Free");
 }
 
-InteractionShell* InteractionShell::Create(InteractionCore* const pInteractionCore) {
+InteractionShell* InteractionShell::Create(InteractionCore* const pInteractionCore, ScratchArena* const pScratchArena) {
    LOG_0(Trace_Info, "Entered InteractionShell::Create");
 
    InteractionShell* const pNew = static_cast<InteractionShell*>(malloc(sizeof(InteractionShell)));
@@ -54,37 +63,65 @@ InteractionShell* InteractionShell::Create(InteractionCore* const pInteractionCo
       return nullptr;
    }
 
-   pNew->InitializeUnfailing(pInteractionCore);
+   pNew->InitializeUnfailing(pInteractionCore, pScratchArena);
+   if(nullptr != pScratchArena) {
+      pScratchArena->AddReferenceCount();
+   }
 
    LOG_0(Trace_Info, "Exited InteractionShell::Create");
 
    return pNew;
 }
 
-BinBase* InteractionShell::GetInteractionFastBinsTemp(const size_t cBytes) {
+InteractionBins* InteractionShell::GetBins(const size_t cThreads) {
+   EBM_ASSERT(1 <= cThreads);
+   if(m_cBins < cThreads) {
+      if(IsMultiplyError(sizeof(InteractionBins), cThreads)) {
+         LOG_0(Trace_Warning, "WARNING InteractionShell::GetBins IsMultiplyError(sizeof(InteractionBins), cThreads)");
+         return nullptr;
+      }
+      InteractionBins* const aBins =
+            static_cast<InteractionBins*>(realloc(m_aBins, sizeof(InteractionBins) * cThreads));
+      if(nullptr == aBins) {
+         LOG_0(Trace_Warning, "WARNING InteractionShell::GetBins nullptr == aBins");
+         return nullptr;
+      }
+      for(size_t iBins = m_cBins; iBins < cThreads; ++iBins) {
+         aBins[iBins].m_pScratchArena = m_pScratchArena;
+         aBins[iBins].m_aFastBinsTemp = nullptr;
+         aBins[iBins].m_cBytesFastBins = 0;
+         aBins[iBins].m_aMainBins = nullptr;
+         aBins[iBins].m_cAllocatedMainBinBytes = 0;
+      }
+      m_aBins = aBins;
+      m_cBins = cThreads;
+   }
+   return m_aBins;
+}
+
+BinBase* InteractionBins::GetFastBinsTemp(const size_t cBytes) {
    const ErrorEbm error =
-         AlignedGrow(reinterpret_cast<void**>(&m_aInteractionFastBinsTemp), &m_cBytesFastBins, cBytes, EBM_FALSE);
+         ScratchArena::Grow(m_pScratchArena, reinterpret_cast<void**>(&m_aFastBinsTemp), &m_cBytesFastBins, cBytes);
    if(Error_None != error) {
-      LOG_0(Trace_Warning, "WARNING InteractionShell::GetInteractionFastBinsTemp AlignedGrow failed");
+      LOG_0(Trace_Warning, "WARNING InteractionBins::GetFastBinsTemp ScratchArena::Grow failed");
       return nullptr;
    }
-   return m_aInteractionFastBinsTemp;
+   return m_aFastBinsTemp;
 }
 
-BinBase* InteractionShell::GetInteractionMainBins(const size_t cBytesPerMainBin, const size_t cMainBins) {
+BinBase* InteractionBins::GetMainBins(const size_t cBytesPerMainBin, const size_t cMainBins) {
    if(IsMultiplyError(cBytesPerMainBin, cMainBins)) {
-      LOG_0(Trace_Warning,
-            "WARNING InteractionShell::GetInteractionMainBins IsMultiplyError(cBytesPerMainBin, cMainBins)");
+      LOG_0(Trace_Warning, "WARNING InteractionBins::GetMainBins IsMultiplyError(cBytesPerMainBin, cMainBins)");
       return nullptr;
    }
    const size_t cBytes = cBytesPerMainBin * cMainBins;
-   const ErrorEbm error =
-         AlignedGrow(reinterpret_cast<void**>(&m_aInteractionMainBins), &m_cAllocatedMainBinBytes, cBytes, EBM_FALSE);
+   const ErrorEbm error = ScratchArena::Grow(
+         m_pScratchArena, reinterpret_cast<void**>(&m_aMainBins), &m_cAllocatedMainBinBytes, cBytes);
    if(Error_None != error) {
-      LOG_0(Trace_Warning, "WARNING InteractionShell::GetInteractionMainBins AlignedGrow failed");
+      LOG_0(Trace_Warning, "WARNING InteractionBins::GetMainBins ScratchArena::Grow failed");
       return nullptr;
    }
-   return m_aInteractionMainBins;
+   return m_aMainBins;
 }
 
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const void* dataSet,
@@ -94,6 +131,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
       AccelerationFlags acceleration,
       const char* objective,
       const double* experimentalParams,
+      ScratchArenaHandle scratchArenaHandle,
       InteractionHandle* interactionHandleOut) {
    LOG_N(Trace_Info,
          "Entered CreateInteractionDetector: "
@@ -104,6 +142,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
          "acceleration=0x%" UAccelerationFlagsPrintf ", "
          "objective=%p, "
          "experimentalParams=%p, "
+         "scratchArenaHandle=%p, "
          "interactionHandleOut=%p",
          static_cast<const void*>(dataSet),
          static_cast<const void*>(bag),
@@ -112,6 +151,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
          static_cast<UAccelerationFlags>(acceleration), // signed to unsigned conversion is defined behavior in C++
          static_cast<const void*>(objective), // do not print the string for security reasons
          static_cast<const void*>(experimentalParams),
+         static_cast<void*>(scratchArenaHandle),
          static_cast<const void*>(interactionHandleOut));
 
    ErrorEbm error;
@@ -124,7 +164,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
 
    if(flags &
          ~(CreateInteractionFlags_DifferentialPrivacy | CreateInteractionFlags_UseApprox |
-               CreateInteractionFlags_BinaryAsMulticlass)) {
+               CreateInteractionFlags_BinaryAsMulticlass | CreateInteractionFlags_CacheMarginals |
+               CreateInteractionFlags_RequireAcceleration | CreateInteractionFlags_JackknifeGroups)) {
       LOG_0(Trace_Error, "ERROR CreateInteractionDetector flags contains unknown flags. Ignoring extras.");
    }
 
@@ -133,6 +174,15 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
       return Error_IllegalParamVal;
    }
 
+   ScratchArena* pScratchArena = nullptr;
+   if(nullptr != scratchArenaHandle) {
+      pScratchArena = ScratchArena::GetScratchArenaFromHandle(scratchArenaHandle);
+      if(nullptr == pScratchArena) {
+         // already logged
+         return Error_IllegalParamVal;
+      }
+   }
+
    UIntShared countSamples;
    size_t cFeatures;
    size_t cWeights;
@@ -176,7 +226,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
       return error;
    }
 
-   InteractionShell* const pInteractionShell = InteractionShell::Create(pInteractionCore);
+   InteractionShell* const pInteractionShell = InteractionShell::Create(pInteractionCore, pScratchArena);
    if(UNLIKELY(nullptr == pInteractionShell)) {
       // if the memory allocation for pInteractionShell failed then
       // there was no place to put the pInteractionCore, so free it
@@ -202,6 +252,15 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
       }
    }
 
+   if(CreateInteractionFlags_CacheMarginals & flags) {
+      error = CacheInteractionMarginals(pInteractionShell);
+      if(Error_None != error) {
+         // DO NOT FREE pInteractionCore since it's owned by pInteractionShell, which we free here
+         InteractionShell::Free(pInteractionShell);
+         return error;
+      }
+   }
+
    const InteractionHandle handle = pInteractionShell->GetHandle();
 
    LOG_N(Trace_Info, "Exited CreateInteractionDetector: *interactionHandleOut=%p", static_cast<void*>(handle));
@@ -210,6 +269,76 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
    return Error_None;
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetectorFromBooster(BoosterHandle boosterHandle,
+      CreateInteractionFlags flags,
+      ScratchArenaHandle scratchArenaHandle,
+      InteractionHandle* interactionHandleOut) {
+   LOG_N(Trace_Info,
+         "Entered CreateInteractionDetectorFromBooster: "
+         "boosterHandle=%p, "
+         "flags=0x%" UCreateInteractionFlagsPrintf ", "
+         "scratchArenaHandle=%p, "
+         "interactionHandleOut=%p",
+         static_cast<void*>(boosterHandle),
+         static_cast<UCreateInteractionFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         static_cast<void*>(scratchArenaHandle),
+         static_cast<const void*>(interactionHandleOut));
+
+   ErrorEbm error;
+
+   if(nullptr == interactionHandleOut) {
+      LOG_0(Trace_Error, "ERROR CreateInteractionDetectorFromBooster nullptr == interactionHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *interactionHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   // the booster already decided the objective, the privacy and whether binary is treated as multiclass. Cached
+   // marginals would go stale as soon as the booster updates its gradients, so they are not offered here
+   if(flags & ~CreateInteractionFlags_UseApprox) {
+      LOG_0(Trace_Error, "ERROR CreateInteractionDetectorFromBooster flags contains unknown flags. Ignoring extras.");
+   }
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   ScratchArena* pScratchArena = nullptr;
+   if(nullptr != scratchArenaHandle) {
+      pScratchArena = ScratchArena::GetScratchArenaFromHandle(scratchArenaHandle);
+      if(nullptr == pScratchArena) {
+         // already logged
+         return Error_IllegalParamVal;
+      }
+   }
+
+   InteractionCore* pInteractionCore = nullptr;
+   error = InteractionCore::CreateFromBooster(pBoosterShell->GetBoosterCore(), flags, &pInteractionCore);
+   if(Error_None != error) {
+      // legal to call if nullptr. On error we can get back a legal pInteractionCore to delete
+      InteractionCore::Free(pInteractionCore);
+      return error;
+   }
+
+   InteractionShell* const pInteractionShell = InteractionShell::Create(pInteractionCore, pScratchArena);
+   if(UNLIKELY(nullptr == pInteractionShell)) {
+      // if the memory allocation for pInteractionShell failed then
+      // there was no place to put the pInteractionCore, so free it
+      InteractionCore::Free(pInteractionCore);
+      return Error_OutOfMemory;
+   }
+
+   const InteractionHandle handle = pInteractionShell->GetHandle();
+
+   LOG_N(Trace_Info,
+         "Exited CreateInteractionDetectorFromBooster: *interactionHandleOut=%p",
+         static_cast<void*>(handle));
+
+   *interactionHandleOut = handle;
+   return Error_None;
+}
+
 EBM_API_BODY void EBM_CALLING_CONVENTION FreeInteractionDetector(InteractionHandle interactionHandle) {
    LOG_N(Trace_Info, "Entered FreeInteractionDetector: interactionHandle=%p", static_cast<void*>(interactionHandle));
 
@@ -223,4 +352,32 @@ EBM_API_BODY void EBM_CALLING_CONVENTION FreeInteractionDetector(InteractionHand
    LOG_0(Trace_Info, "Exited FreeInteractionDetector");
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetInteractionAcceleration(
+      InteractionHandle interactionHandle, AccelerationFlags* accelerationOut) {
+   LOG_N(Trace_Info,
+         "Entered GetInteractionAcceleration: "
+         "interactionHandle=%p, "
+         "accelerationOut=%p",
+         static_cast<void*>(interactionHandle),
+         static_cast<void*>(accelerationOut));
+
+   InteractionShell* const pInteractionShell = InteractionShell::GetInteractionShellFromHandle(interactionHandle);
+   if(nullptr == pInteractionShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == accelerationOut) {
+      LOG_0(Trace_Error, "ERROR GetInteractionAcceleration accelerationOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   *accelerationOut = pInteractionShell->GetInteractionCore()->GetAcceleration();
+
+   LOG_N(Trace_Info,
+         "Exited GetInteractionAcceleration: *accelerationOut=0x%" UAccelerationFlagsPrintf,
+         static_cast<UAccelerationFlags>(*accelerationOut));
+   return Error_None;
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -6,10 +6,13 @@
 #define INTERACTION_SHELL_HPP
 
 #include <stddef.h> // size_t
+#include <type_traits> // std::is_standard_layout
 
 #include "libebm.h" // InteractionHandle
 #include "logging.h" // LOG_0
 
+#include "ScratchArena.hpp"
+
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
@@ -18,6 +21,32 @@ namespace DEFINED_ZONE_NAME {
 struct BinBase;
 class InteractionCore;
 
+// the scratch bins that one thread needs to calculate the strength of one term.  They are kept between calls and only
+// grow, so repeated calls on the same InteractionShell do not allocate
+struct InteractionBins final {
+   InteractionBins() = default; // preserve our POD status
+   ~InteractionBins() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   // the ScratchArena of the InteractionShell that owns us, or nullptr
+   ScratchArena* m_pScratchArena;
+
+   BinBase* m_aFastBinsTemp;
+   size_t m_cBytesFastBins;
+
+   BinBase* m_aMainBins;
+   size_t m_cAllocatedMainBinBytes;
+
+   BinBase* GetFastBinsTemp(const size_t cBytes);
+
+   BinBase* GetMainBins(const size_t cBytesPerMainBin, const size_t cMainBins);
+};
+static_assert(std::is_standard_layout<InteractionBins>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<InteractionBins>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
 class InteractionShell final {
    static constexpr size_t k_handleVerificationOk = 21773; // random 15 bit number
    static constexpr size_t k_handleVerificationFreed = 27913; // random 15 bit number
@@ -25,11 +54,12 @@ class InteractionShell final {
 
    InteractionCore* m_pInteractionCore;
 
-   BinBase* m_aInteractionFastBinsTemp;
-   size_t m_cBytesFastBins;
+   // nullptr unless the caller gave us a ScratchArena, which then supplies and recycles the buffers of m_aBins
+   ScratchArena* m_pScratchArena;
 
-   BinBase* m_aInteractionMainBins;
-   size_t m_cAllocatedMainBinBytes;
+   // one InteractionBins per thread that has worked on this InteractionShell
+   InteractionBins* m_aBins;
+   size_t m_cBins;
 
    int m_cLogEnterMessages;
    int m_cLogExitMessages;
@@ -40,22 +70,21 @@ class InteractionShell final {
    void* operator new(std::size_t) = delete; // we only use malloc/free in this library
    void operator delete(void*) = delete; // we only use malloc/free in this library
 
-   inline void InitializeUnfailing(InteractionCore* const pInteractionCore) {
+   inline void InitializeUnfailing(InteractionCore* const pInteractionCore, ScratchArena* const pScratchArena) {
       m_handleVerification = k_handleVerificationOk;
       m_pInteractionCore = pInteractionCore;
+      m_pScratchArena = pScratchArena;
 
-      m_aInteractionFastBinsTemp = nullptr;
-      m_cBytesFastBins = 0;
-
-      m_aInteractionMainBins = nullptr;
-      m_cAllocatedMainBinBytes = 0;
+      m_aBins = nullptr;
+      m_cBins = 0;
 
       m_cLogEnterMessages = 1000;
       m_cLogExitMessages = 1000;
    }
 
    static void Free(InteractionShell* const pInteractionShell);
-   static InteractionShell* Create(InteractionCore* const pInteractionCore);
+   // takes ownership of one reference to pInteractionCore, and adds a reference to pScratchArena if it is not nullptr
+   static InteractionShell* Create(InteractionCore* const pInteractionCore, ScratchArena* const pScratchArena);
 
    inline static InteractionShell* GetInteractionShellFromHandle(const InteractionHandle interactionHandle) {
       if(nullptr == interactionHandle) {
@@ -84,9 +113,17 @@ class InteractionShell final {
 
    inline int* GetPointerCountLogExitMessages() { return &m_cLogExitMessages; }
 
-   BinBase* GetInteractionFastBinsTemp(const size_t cBytes);
+   // returns cThreads InteractionBins, which can be indexed by the iThread of a ThreadPool
+   InteractionBins* GetBins(const size_t cThreads);
 
-   BinBase* GetInteractionMainBins(const size_t cBytesPerMainBin, const size_t cMainBins);
+   // the scratch bins that the threads hold between calls, for GetInteractionMemoryUsage
+   inline size_t CountBytesBins() const {
+      size_t cBytes = 0;
+      for(size_t iBins = 0; iBins < m_cBins; ++iBins) {
+         cBytes += m_aBins[iBins].m_cBytesFastBins + m_aBins[iBins].m_cAllocatedMainBinBytes;
+      }
+      return cBytes;
+   }
 };
 static_assert(std::is_standard_layout<InteractionShell>::value,
       "We use the struct hack in several places, so disallow non-standard_layout types in general");
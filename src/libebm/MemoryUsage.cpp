@@ -0,0 +1,433 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // numeric_limits
+
+#define ZONE_main
+#include "zones.h"
+
+#include "ebm_internal.hpp"
+#include "dataset_shared.hpp" // GetDataSetSharedHeader
+#include "Bin.hpp" // GetBinSize
+#include "TreeNode.hpp" // GetTreeNodeSize
+#include "SplitPosition.hpp" // GetSplitPositionSize
+#include "Tensor.hpp" // Tensor
+#include "ThreadPool.hpp" // ThreadPool
+#include "TermInnerBag.hpp" // TermInnerBag
+#include "DataSetBoosting.hpp" // DataSetBoosting
+#include "DataSetInteraction.hpp" // DataSetInteraction
+#include "PreparedTrainingData.hpp" // PreparedTrainingData
+#include "BoosterCore.hpp" // BoosterCore
+#include "BoosterShell.hpp" // BoosterShell
+#include "InteractionCore.hpp" // InteractionCore
+#include "InteractionShell.hpp" // InteractionShell
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+extern ErrorEbm Unbag(const size_t cSamples,
+      const BagEbm* const aBag,
+      size_t* const pcTrainingSamplesOut,
+      size_t* const pcValidationSamplesOut);
+
+extern size_t GetL1DataCacheBytes();
+
+static ErrorEbm CheckCountSections(const IntEbm countSections, const IntEbm* const bytesOut) {
+   if(countSections < IntEbm{0} || MemorySection_COUNT < countSections) {
+      LOG_0(Trace_Error, "ERROR CheckCountSections countSections must be between 0 and MemorySection_COUNT");
+      return Error_IllegalParamVal;
+   }
+   if(IntEbm{0} != countSections && nullptr == bytesOut) {
+      LOG_0(Trace_Error, "ERROR CheckCountSections bytesOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+   return Error_None;
+}
+
+template<typename T> static IntEbm SaturateBytes(const T cBytes) {
+   return static_cast<T>(std::numeric_limits<IntEbm>::max()) <= cBytes ? std::numeric_limits<IntEbm>::max() :
+                                                                          static_cast<IntEbm>(cBytes);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetBoosterMemoryUsage(
+      BoosterHandle boosterHandle, IntEbm countSections, IntEbm* bytesOut) {
+   LOG_N(Trace_Info,
+         "Entered GetBoosterMemoryUsage: "
+         "boosterHandle=%p, "
+         "countSections=%" IntEbmPrintf ", "
+         "bytesOut=%p",
+         static_cast<void*>(boosterHandle),
+         countSections,
+         static_cast<void*>(bytesOut));
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   const ErrorEbm error = CheckCountSections(countSections, bytesOut);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   const PreparedTrainingData* const pPreparedTrainingData = pBoosterCore->GetPreparedTrainingData();
+
+   size_t acBytes[k_cMemorySections];
+   for(size_t iSection = 0; iSection < k_cMemorySections; ++iSection) {
+      // the booster's datasets borrow the term data, targets and weights of the shared datasets
+      acBytes[iSection] = pPreparedTrainingData->GetTrainingSet()->GetCountBytes(iSection) +
+            pPreparedTrainingData->GetValidationSet()->GetCountBytes(iSection) +
+            pBoosterCore->GetTrainingSet()->GetCountBytes(iSection) +
+            pBoosterCore->GetValidationSet()->GetCountBytes(iSection);
+   }
+
+   size_t cBytesTensors = 0;
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      if(nullptr != pBoosterCore->GetCurrentModel()) {
+         cBytesTensors += pBoosterCore->GetCurrentModel()[iTerm]->CountBytes();
+      }
+      if(nullptr != pBoosterCore->GetBestModel()) {
+         cBytesTensors += pBoosterCore->GetBestModel()[iTerm]->CountBytes();
+      }
+   }
+   if(nullptr != pBoosterShell->GetTermUpdate()) {
+      cBytesTensors += pBoosterShell->GetTermUpdate()->CountBytes();
+   }
+   if(nullptr != pBoosterShell->GetInnerTermUpdate()) {
+      cBytesTensors += pBoosterShell->GetInnerTermUpdate()->CountBytes();
+   }
+   acBytes[static_cast<size_t>(MemorySection_Tensors)] += cBytesTensors;
+   acBytes[static_cast<size_t>(MemorySection_Scratch)] += pBoosterShell->CountBytesScratch();
+
+   for(size_t iSection = 0; iSection < static_cast<size_t>(countSections); ++iSection) {
+      bytesOut[iSection] = SaturateBytes(acBytes[iSection]);
+   }
+
+   LOG_0(Trace_Info, "Exited GetBoosterMemoryUsage");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetInteractionMemoryUsage(
+      InteractionHandle interactionHandle, IntEbm countSections, IntEbm* bytesOut) {
+   LOG_N(Trace_Info,
+         "Entered GetInteractionMemoryUsage: "
+         "interactionHandle=%p, "
+         "countSections=%" IntEbmPrintf ", "
+         "bytesOut=%p",
+         static_cast<void*>(interactionHandle),
+         countSections,
+         static_cast<void*>(bytesOut));
+
+   InteractionShell* const pInteractionShell = InteractionShell::GetInteractionShellFromHandle(interactionHandle);
+   if(nullptr == pInteractionShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   const ErrorEbm error = CheckCountSections(countSections, bytesOut);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   const InteractionCore* const pInteractionCore = pInteractionShell->GetInteractionCore();
+
+   size_t acBytes[k_cMemorySections];
+   for(size_t iSection = 0; iSection < k_cMemorySections; ++iSection) {
+      acBytes[iSection] = pInteractionCore->GetDataSetInteraction()->GetCountBytes(iSection);
+   }
+   acBytes[static_cast<size_t>(MemorySection_Scratch)] +=
+         pInteractionCore->GetCountBytesMarginalBins() + pInteractionShell->CountBytesBins();
+
+   for(size_t iSection = 0; iSection < static_cast<size_t>(countSections); ++iSection) {
+      bytesOut[iSection] = SaturateBytes(acBytes[iSection]);
+   }
+
+   LOG_0(Trace_Info, "Exited GetInteractionMemoryUsage");
+   return Error_None;
+}
+
+// bytes of bit packed term data for cSamples samples, packed like DataSetBoosting::InitTermData packs it for 64 bit
+// integers, which is the most that any zone uses
+static double EstimateTermDataBytes(const size_t cSamples, const size_t cTensorBins) {
+   if(size_t{0} == cSamples || cTensorBins <= size_t{1}) {
+      return 0.0;
+   }
+   const size_t cItemsPerBitPack =
+         static_cast<size_t>(COUNT_BITS(uint64_t)) / static_cast<size_t>(CountBitsRequired(cTensorBins - size_t{1}));
+   return static_cast<double>(sizeof(uint64_t)) * static_cast<double>(cSamples / cItemsPerBitPack + size_t{1});
+}
+
+// AlignedGrow adds about half again and its alignment padding to whatever it is asked for
+static double EstimateGrownBytes(const double cBytes) {
+   return 0.0 == cBytes ? 0.0 : cBytes + cBytes * 0.5 + 128.0;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION EstimateBoosterMemoryUsage(const void* dataSet,
+      const BagEbm* bag,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      IntEbm countInnerBags,
+      IntEbm countSections,
+      IntEbm* bytesOut) {
+   LOG_N(Trace_Info,
+         "Entered EstimateBoosterMemoryUsage: "
+         "dataSet=%p, "
+         "bag=%p, "
+         "countTerms=%" IntEbmPrintf ", "
+         "dimensionCounts=%p, "
+         "featureIndexes=%p, "
+         "countInnerBags=%" IntEbmPrintf ", "
+         "countSections=%" IntEbmPrintf ", "
+         "bytesOut=%p",
+         static_cast<const void*>(dataSet),
+         static_cast<const void*>(bag),
+         countTerms,
+         static_cast<const void*>(dimensionCounts),
+         static_cast<const void*>(featureIndexes),
+         countInnerBags,
+         countSections,
+         static_cast<void*>(bytesOut));
+
+   ErrorEbm error = CheckCountSections(countSections, bytesOut);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   if(nullptr == dataSet) {
+      LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage nullptr == dataSet");
+      return Error_IllegalParamVal;
+   }
+   if(countTerms < IntEbm{0} || IsConvertError<size_t>(countTerms)) {
+      LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage countTerms must be a positive number");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+   if(size_t{0} != cTerms && nullptr == dimensionCounts) {
+      LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage dimensionCounts cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+   if(countInnerBags < IntEbm{0} || IsConvertError<size_t>(countInnerBags)) {
+      LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage countInnerBags must be a positive number");
+      return Error_IllegalParamVal;
+   }
+   const size_t cInnerBags = static_cast<size_t>(countInnerBags);
+   const size_t cInnerBagsAfterZero = size_t{0} == cInnerBags ? size_t{1} : cInnerBags;
+
+   const unsigned char* const pDataSetShared = static_cast<const unsigned char*>(dataSet);
+   UIntShared countSamples;
+   size_t cFeatures;
+   size_t cWeights;
+   size_t cTargets;
+   error = GetDataSetSharedHeader(pDataSetShared, &countSamples, &cFeatures, &cWeights, &cTargets);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+   if(size_t{1} != cTargets) {
+      LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage the dataset must have exactly one target");
+      return Error_IllegalParamVal;
+   }
+
+   size_t cTrainingSamples;
+   size_t cValidationSamples;
+   error = Unbag(cSamples, bag, &cTrainingSamples, &cValidationSamples);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   ptrdiff_t cClasses;
+   if(nullptr == GetDataSetSharedTarget(pDataSetShared, 0, &cClasses)) {
+      LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage cClasses cannot fit into ptrdiff_t");
+      return Error_IllegalParamVal;
+   }
+   const bool bClassification = ptrdiff_t{Task_GeneralClassification} <= cClasses;
+   // with 0 or 1 classes the booster allocates no scores and we report nothing, like GetBoosterMemoryUsage would
+   const size_t cScores = ptrdiff_t{0} == cClasses || ptrdiff_t{1} == cClasses ? size_t{0} :
+         cClasses <= ptrdiff_t{2}                                              ? size_t{1} :
+                                                                                 static_cast<size_t>(cClasses);
+
+   double aBytes[k_cMemorySections];
+   for(size_t iSection = 0; iSection < k_cMemorySections; ++iSection) {
+      aBytes[iSection] = 0.0;
+   }
+
+   // the booster blocks the samples of a term when its fast bins do not fit in half the L1 data cache
+   const size_t cBinsPerBlock = GetL1DataCacheBytes() / size_t{2} / (size_t{2} * sizeof(double));
+   const size_t cThreads = ThreadPool::GetCountThreadsMax();
+   const double cBytesPerScores = static_cast<double>(sizeof(FloatScore)) * static_cast<double>(cScores);
+   const size_t cScoresSizing = EbmMax(cScores, size_t{1});
+   const double cBytesPerTreeNode = static_cast<double>(
+         EbmMax(GetTreeNodeSize(true, cScoresSizing), GetTreeNodeMultiSize(true, cScoresSizing)));
+   const double cBytesPerSplitPosition = static_cast<double>(GetSplitPositionSize(true, cScoresSizing));
+
+   double cTensorBinsMax = 1.0;
+   double cMainBinsMax = 1.0;
+   double cSplitsMax = 0.0;
+   double cBytesTreeNodesMax = 0.0;
+   double cBytesSplitPositionsMax = 0.0;
+   const IntEbm* piTermFeature = featureIndexes;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const IntEbm countDimensions = dimensionCounts[iTerm];
+      if(countDimensions < IntEbm{0} || IntEbm{k_cDimensionsMax} < countDimensions) {
+         LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage dimensionCounts value out of range");
+         return Error_IllegalParamVal;
+      }
+      if(IntEbm{0} != countDimensions && nullptr == featureIndexes) {
+         LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage featureIndexes cannot be nullptr");
+         return Error_IllegalParamVal;
+      }
+      double cTensorBins = 1.0;
+      double cSplits = 0.0;
+      size_t cRealDimensions = 0;
+      for(IntEbm iDimension = 0; iDimension < countDimensions; ++iDimension) {
+         const IntEbm indexFeature = *piTermFeature;
+         ++piTermFeature;
+         if(indexFeature < IntEbm{0} || IsConvertError<size_t>(indexFeature) ||
+               cFeatures <= static_cast<size_t>(indexFeature)) {
+            LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage featureIndexes value out of range");
+            return Error_IllegalParamVal;
+         }
+         bool bMissing;
+         bool bUnknown;
+         bool bNominal;
+         bool bSparse;
+         UIntShared countBins;
+         UIntShared defaultValSparse;
+         size_t cNonDefaultsSparse;
+         size_t cBytesExternal;
+         if(nullptr == GetDataSetSharedFeature(pDataSetShared,
+                             static_cast<size_t>(indexFeature),
+                             &bMissing,
+                             &bUnknown,
+                             &bNominal,
+                             &bSparse,
+                             &countBins,
+                             &defaultValSparse,
+                             &cNonDefaultsSparse,
+                             &cBytesExternal)) {
+            LOG_0(Trace_Error, "ERROR EstimateBoosterMemoryUsage GetDataSetSharedFeature failed");
+            return Error_IllegalParamVal;
+         }
+         cTensorBins *= static_cast<double>(countBins);
+         if(UIntShared{1} < countBins) {
+            ++cRealDimensions;
+            cSplits += static_cast<double>(countBins - UIntShared{1});
+         }
+      }
+      if(size_t{0} == cScores) {
+         continue;
+      }
+      // beyond this the booster could not allocate the term anyway, and the doubles below would lose precision
+      if(static_cast<double>(std::numeric_limits<IntEbm>::max()) <= cTensorBins) {
+         LOG_0(Trace_Warning, "WARNING EstimateBoosterMemoryUsage the tensor of a term cannot fit into memory");
+         return Error_OutOfMemory;
+      }
+      const size_t cTensorBinsSize = static_cast<size_t>(cTensorBins);
+
+      cTensorBinsMax = EbmMax(cTensorBinsMax, cTensorBins);
+      cSplitsMax = EbmMax(cSplitsMax, cSplits);
+      double cTreeNodes = cTensorBins + cTensorBins;
+      if(size_t{2} <= cRealDimensions) {
+         // pairs and above keep auxiliary bins for the totals and sweep through the cuts on every thread
+         cMainBinsMax = EbmMax(cMainBinsMax, cTensorBins + EbmMax(cTensorBins, 24.0));
+         cTreeNodes = EbmMax(cTreeNodes,
+               static_cast<double>((size_t{2} + (cRealDimensions << 2)) * cThreads) + static_cast<double>(cThreads));
+      } else {
+         cMainBinsMax = EbmMax(cMainBinsMax, cTensorBins);
+         cBytesSplitPositionsMax = EbmMax(cBytesSplitPositionsMax, cBytesPerSplitPosition * cSplits);
+      }
+      // PartitionOneDimensionalBoosting keeps its heap of leaves after the tree nodes
+      cBytesTreeNodesMax = EbmMax(
+            cBytesTreeNodesMax, cBytesPerTreeNode * cTreeNodes + static_cast<double>(sizeof(void*)) * cTensorBins);
+
+      aBytes[static_cast<size_t>(MemorySection_TermData)] +=
+            EstimateTermDataBytes(cTrainingSamples, cTensorBinsSize) +
+            EstimateTermDataBytes(cValidationSamples, cTensorBinsSize);
+      if(cBinsPerBlock < cTensorBinsSize) {
+         aBytes[static_cast<size_t>(MemorySection_TermData)] +=
+               static_cast<double>(sizeof(size_t)) * static_cast<double>(cTrainingSamples);
+      }
+      // the shared training set caches the inner bags and the booster keeps its own copy
+      aBytes[static_cast<size_t>(MemorySection_Weights)] +=
+            2.0 * static_cast<double>(TermInnerBag::CountBytesTermInnerBags(cTensorBinsSize, cInnerBags));
+      // the current and the best model, which are expanded to every bin
+      aBytes[static_cast<size_t>(MemorySection_Tensors)] += 2.0 *
+            (static_cast<double>(Tensor::CountBytesFixed(static_cast<size_t>(countDimensions))) +
+                  EstimateGrownBytes(cBytesPerScores * cTensorBins) +
+                  EstimateGrownBytes(static_cast<double>(sizeof(UIntSplit)) * cSplits));
+   }
+
+   if(size_t{0} != cScores) {
+      const double cTrainingSamplesDouble = static_cast<double>(cTrainingSamples);
+      const double cSamplesDouble = static_cast<double>(cTrainingSamples + cValidationSamples);
+
+      aBytes[static_cast<size_t>(MemorySection_Targets)] += static_cast<double>(sizeof(uint64_t)) * cSamplesDouble;
+      if(!bClassification) {
+         // regression objectives like RMSE keep a copy of the original targets
+         aBytes[static_cast<size_t>(MemorySection_Targets)] +=
+               static_cast<double>(sizeof(FloatShared)) * cTrainingSamplesDouble;
+      }
+
+      if(size_t{0} != cWeights) {
+         aBytes[static_cast<size_t>(MemorySection_Weights)] +=
+               static_cast<double>(sizeof(FloatShared) + sizeof(double)) * cSamplesDouble;
+      }
+      if(size_t{0} != cWeights || size_t{0} != cInnerBags) {
+         aBytes[static_cast<size_t>(MemorySection_Weights)] += static_cast<double>(sizeof(double)) *
+               static_cast<double>(cInnerBagsAfterZero) * cTrainingSamplesDouble;
+      }
+
+      aBytes[static_cast<size_t>(MemorySection_Gradients)] += 2.0 * cBytesPerScores * cTrainingSamplesDouble;
+      aBytes[static_cast<size_t>(MemorySection_SampleScores)] += cBytesPerScores * cSamplesDouble;
+
+      // the term update and the inner term update, which are sized for any term
+      aBytes[static_cast<size_t>(MemorySection_Tensors)] += 2.0 *
+            (static_cast<double>(Tensor::CountBytesFixed(k_cDimensionsMax)) +
+                  EstimateGrownBytes(cBytesPerScores * cTensorBinsMax) +
+                  EstimateGrownBytes(static_cast<double>(sizeof(UIntSplit)) * cSplitsMax));
+
+      const double cBytesFastBins = static_cast<double>(GetBinSize<FloatBig, UIntBig>(false, false, true, cScores)) *
+                  cTensorBinsMax + static_cast<double>(SIMD_BYTE_ALIGNMENT);
+      const double cBytesMainBins =
+            static_cast<double>(GetBinSize<FloatMain, UIntMain>(true, true, true, cScores)) * cMainBinsMax;
+      // purification holds the weights and the scores of the largest update
+      const double cBytesPurify = static_cast<double>(sizeof(double)) *
+            static_cast<double>(size_t{1} + (cScores << 1)) * cTensorBinsMax;
+      aBytes[static_cast<size_t>(MemorySection_Scratch)] += cBytesFastBins * static_cast<double>(cThreads) +
+            cBytesMainBins + cBytesSplitPositionsMax + EstimateGrownBytes(cBytesTreeNodesMax) +
+            EstimateGrownBytes(cBytesPurify) + EstimateGrownBytes(cBytesPerScores * 2.0 * cSplitsMax);
+      if(size_t{1} != cScores) {
+         // multiclass keeps the scores of one SIMD pack of samples per thread, and no zone packs more than 16
+         aBytes[static_cast<size_t>(MemorySection_Scratch)] +=
+               (cBytesPerScores * 16.0 + static_cast<double>(SIMD_BYTE_ALIGNMENT)) * static_cast<double>(cThreads);
+      }
+   }
+
+   for(size_t iSection = 0; iSection < static_cast<size_t>(countSections); ++iSection) {
+      bytesOut[iSection] = SaturateBytes(aBytes[iSection]);
+   }
+
+   LOG_0(Trace_Info, "Exited EstimateBoosterMemoryUsage");
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,291 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memcpy
+#include <new> // std::nothrow
+
+#include "libebm.h"
+#include "logging.h"
+#include "unzoned.h"
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError, IsMultiplyError
+#include "Term.hpp"
+#include "Transpose.hpp"
+#include "PreparedTrainingData.hpp"
+#include "BoosterCore.hpp"
+#include "BoosterShell.hpp"
+#include "ModelSnapshot.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+SnapshotTensor::~SnapshotTensor() { free(m_aScores); }
+
+SnapshotTensor* SnapshotTensor::Create(const size_t cScores, const FloatScore* const aScores) {
+   EBM_ASSERT(size_t{0} != cScores);
+   EBM_ASSERT(nullptr != aScores);
+
+   if(IsMultiplyError(sizeof(FloatScore), cScores)) {
+      LOG_0(Trace_Warning, "WARNING SnapshotTensor::Create IsMultiplyError(sizeof(FloatScore), cScores)");
+      return nullptr;
+   }
+   FloatScore* const aScoresCopy = static_cast<FloatScore*>(malloc(sizeof(FloatScore) * cScores));
+   if(nullptr == aScoresCopy) {
+      LOG_0(Trace_Warning, "WARNING SnapshotTensor::Create nullptr == aScoresCopy");
+      return nullptr;
+   }
+   memcpy(aScoresCopy, aScores, sizeof(FloatScore) * cScores);
+
+   SnapshotTensor* const pSnapshotTensor = new(std::nothrow) SnapshotTensor();
+   if(nullptr == pSnapshotTensor) {
+      LOG_0(Trace_Warning, "WARNING SnapshotTensor::Create nullptr == pSnapshotTensor");
+      free(aScoresCopy);
+      return nullptr;
+   }
+   pSnapshotTensor->m_aScores = aScoresCopy;
+   return pSnapshotTensor;
+}
+
+void SnapshotTensor::Free(SnapshotTensor* const pSnapshotTensor) {
+   if(nullptr != pSnapshotTensor) {
+      // see BoosterCore::Free for the memory ordering
+      if(size_t{1} == pSnapshotTensor->m_REFERENCE_COUNT.fetch_sub(1, std::memory_order_release)) {
+         std::atomic_thread_fence(std::memory_order_acquire);
+         delete pSnapshotTensor;
+      }
+   }
+}
+
+ModelSnapshot::~ModelSnapshot() {
+   // this only gets called after our reference count has been decremented to zero
+
+   if(nullptr != m_apTensors) {
+      for(size_t iTensor = 0; iTensor < size_t{2} * m_cTerms; ++iTensor) {
+         SnapshotTensor::Free(m_apTensors[iTensor]);
+      }
+      free(m_apTensors);
+   }
+   PreparedTrainingData::Free(m_pPreparedTrainingData);
+
+   m_handleVerification = k_handleVerificationFreed;
+}
+
+ErrorEbm ModelSnapshot::Create(PreparedTrainingData* const pPreparedTrainingData,
+      const ModelSnapshot* const pSnapshotPrev,
+      const size_t version,
+      const double bestModelMetric,
+      ModelSnapshot** const ppModelSnapshotOut) {
+   EBM_ASSERT(nullptr != pPreparedTrainingData);
+   EBM_ASSERT(nullptr != ppModelSnapshotOut);
+   EBM_ASSERT(nullptr == pSnapshotPrev || pPreparedTrainingData == pSnapshotPrev->m_pPreparedTrainingData);
+
+   *ppModelSnapshotOut = nullptr;
+
+   const size_t cTerms = pPreparedTrainingData->GetCountTerms();
+   if(IsMultiplyError(sizeof(SnapshotTensor*), size_t{2}, cTerms)) {
+      LOG_0(Trace_Warning, "WARNING ModelSnapshot::Create IsMultiplyError(sizeof(SnapshotTensor*), 2, cTerms)");
+      return Error_OutOfMemory;
+   }
+   SnapshotTensor** apTensors = nullptr;
+   if(size_t{0} != cTerms) {
+      apTensors = static_cast<SnapshotTensor**>(malloc(sizeof(SnapshotTensor*) * size_t{2} * cTerms));
+      if(nullptr == apTensors) {
+         LOG_0(Trace_Warning, "WARNING ModelSnapshot::Create nullptr == apTensors");
+         return Error_OutOfMemory;
+      }
+   }
+
+   ModelSnapshot* const pModelSnapshot = new(std::nothrow) ModelSnapshot();
+   if(nullptr == pModelSnapshot) {
+      LOG_0(Trace_Warning, "WARNING ModelSnapshot::Create nullptr == pModelSnapshot");
+      free(apTensors);
+      return Error_OutOfMemory;
+   }
+
+   for(size_t iTensor = 0; iTensor < size_t{2} * cTerms; ++iTensor) {
+      SnapshotTensor* const pSnapshotTensor = nullptr == pSnapshotPrev ? nullptr : pSnapshotPrev->m_apTensors[iTensor];
+      if(nullptr != pSnapshotTensor) {
+         pSnapshotTensor->AddReferenceCount();
+      }
+      apTensors[iTensor] = pSnapshotTensor;
+   }
+
+   pPreparedTrainingData->AddReferenceCount();
+   pModelSnapshot->m_pPreparedTrainingData = pPreparedTrainingData;
+   pModelSnapshot->m_cTerms = cTerms;
+   pModelSnapshot->m_version = version;
+   pModelSnapshot->m_bestModelMetric = bestModelMetric;
+   pModelSnapshot->m_apTensors = apTensors;
+
+   *ppModelSnapshotOut = pModelSnapshot;
+   return Error_None;
+}
+
+void ModelSnapshot::Free(ModelSnapshot* const pModelSnapshot) {
+   LOG_0(Trace_Info, "Entered ModelSnapshot::Free");
+   if(nullptr != pModelSnapshot) {
+      // see BoosterCore::Free for the memory ordering
+      if(size_t{1} == pModelSnapshot->m_REFERENCE_COUNT.fetch_sub(1, std::memory_order_release)) {
+         std::atomic_thread_fence(std::memory_order_acquire);
+         LOG_0(Trace_Info, "INFO ModelSnapshot::Free deleting ModelSnapshot");
+         delete pModelSnapshot;
+      }
+   }
+   LOG_0(Trace_Info, "Exited ModelSnapshot::Free");
+}
+
+void ModelSnapshot::SetTensor(const size_t iModel, const size_t iTerm, SnapshotTensor* const pSnapshotTensor) {
+   EBM_ASSERT(iModel <= size_t{1});
+   EBM_ASSERT(iTerm < m_cTerms);
+   SnapshotTensor** const ppSnapshotTensor = &m_apTensors[iModel * m_cTerms + iTerm];
+   SnapshotTensor::Free(*ppSnapshotTensor);
+   *ppSnapshotTensor = pSnapshotTensor;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetModelSnapshot(
+      BoosterHandle boosterHandle, ModelSnapshotHandle* modelSnapshotHandleOut) {
+   LOG_N(Trace_Info,
+         "Entered GetModelSnapshot: "
+         "boosterHandle=%p, "
+         "modelSnapshotHandleOut=%p",
+         static_cast<void*>(boosterHandle),
+         static_cast<void*>(modelSnapshotHandleOut));
+
+   if(nullptr == modelSnapshotHandleOut) {
+      LOG_0(Trace_Error, "ERROR GetModelSnapshot nullptr == modelSnapshotHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *modelSnapshotHandleOut = nullptr;
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   ModelSnapshot* const pModelSnapshot = pBoosterShell->GetBoosterCore()->AcquireSnapshot();
+   if(nullptr == pModelSnapshot) {
+      LOG_0(Trace_Error, "ERROR GetModelSnapshot the booster was not created with CreateBoosterFlags_ModelSnapshots");
+      return Error_IllegalParamVal;
+   }
+   *modelSnapshotHandleOut = pModelSnapshot->GetHandle();
+
+   LOG_0(Trace_Info, "Exited GetModelSnapshot");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetModelSnapshotVersion(
+      ModelSnapshotHandle modelSnapshotHandle, IntEbm* versionOut, double* bestModelMetricOut) {
+   LOG_N(Trace_Info,
+         "Entered GetModelSnapshotVersion: "
+         "modelSnapshotHandle=%p, "
+         "versionOut=%p, "
+         "bestModelMetricOut=%p",
+         static_cast<void*>(modelSnapshotHandle),
+         static_cast<void*>(versionOut),
+         static_cast<void*>(bestModelMetricOut));
+
+   const ModelSnapshot* const pModelSnapshot = ModelSnapshot::GetModelSnapshotFromHandle(modelSnapshotHandle);
+   if(nullptr == pModelSnapshot) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr != versionOut) {
+      if(IsConvertError<IntEbm>(pModelSnapshot->GetVersion())) {
+         LOG_0(Trace_Error, "ERROR GetModelSnapshotVersion IsConvertError<IntEbm>(pModelSnapshot->GetVersion())");
+         return Error_IllegalParamVal;
+      }
+      *versionOut = static_cast<IntEbm>(pModelSnapshot->GetVersion());
+   }
+   if(nullptr != bestModelMetricOut) {
+      *bestModelMetricOut = pModelSnapshot->GetBestModelMetric();
+   }
+
+   LOG_0(Trace_Info, "Exited GetModelSnapshotVersion");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetModelSnapshotTermScores(
+      ModelSnapshotHandle modelSnapshotHandle, IntEbm indexTerm, BoolEbm isBest, double* termScoresTensorOut) {
+   LOG_N(Trace_Info,
+         "Entered GetModelSnapshotTermScores: "
+         "modelSnapshotHandle=%p, "
+         "indexTerm=%" IntEbmPrintf ", "
+         "isBest=%s, "
+         "termScoresTensorOut=%p",
+         static_cast<void*>(modelSnapshotHandle),
+         indexTerm,
+         ObtainTruth(isBest),
+         static_cast<void*>(termScoresTensorOut));
+
+   const ModelSnapshot* const pModelSnapshot = ModelSnapshot::GetModelSnapshotFromHandle(modelSnapshotHandle);
+   if(nullptr == pModelSnapshot) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(EBM_FALSE != isBest && EBM_TRUE != isBest) {
+      LOG_0(Trace_Error, "ERROR GetModelSnapshotTermScores isBest must be EBM_FALSE or EBM_TRUE");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(indexTerm)) {
+      LOG_0(Trace_Error, "ERROR GetModelSnapshotTermScores indexTerm is too high to index");
+      return Error_IllegalParamVal;
+   }
+   const size_t iTerm = static_cast<size_t>(indexTerm);
+
+   const PreparedTrainingData* const pPreparedTrainingData = pModelSnapshot->GetPreparedTrainingData();
+   if(pPreparedTrainingData->GetCountTerms() <= iTerm) {
+      LOG_0(Trace_Error, "ERROR GetModelSnapshotTermScores indexTerm above the number of terms that we have");
+      return Error_IllegalParamVal;
+   }
+
+   const SnapshotTensor* const pSnapshotTensor =
+         pModelSnapshot->GetTensor(EBM_FALSE != isBest ? size_t{1} : size_t{0}, iTerm);
+   if(nullptr == pSnapshotTensor) {
+      // like GetBestTermScores, nothing is written when there are no scores or the term has a feature with no bins
+      LOG_0(Trace_Info, "Exited GetModelSnapshotTermScores no scores");
+      return Error_None;
+   }
+
+   if(nullptr == termScoresTensorOut) {
+      LOG_0(Trace_Error, "ERROR GetModelSnapshotTermScores termScoresTensorOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   // Transpose only reads the stride side when copying to the increment side
+   Transpose<true>(pPreparedTrainingData->GetTerms()[iTerm],
+         pPreparedTrainingData->GetCountScores(),
+         termScoresTensorOut,
+         const_cast<FloatScore*>(pSnapshotTensor->GetScores()));
+
+   LOG_0(Trace_Info, "Exited GetModelSnapshotTermScores");
+   return Error_None;
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION FreeModelSnapshot(ModelSnapshotHandle modelSnapshotHandle) {
+   LOG_N(Trace_Info, "Entered FreeModelSnapshot: modelSnapshotHandle=%p", static_cast<void*>(modelSnapshotHandle));
+
+   ModelSnapshot* const pModelSnapshot = ModelSnapshot::GetModelSnapshotFromHandle(modelSnapshotHandle);
+   // if the conversion above doesn't work, it'll return null, and our free will not in fact free any memory,
+   // but it will not crash. We'll leak memory, but at least we'll log that.
+
+   // it's legal to call free on nullptr, just like for free().  This is checked inside ModelSnapshot::Free()
+   ModelSnapshot::Free(pModelSnapshot);
+
+   LOG_0(Trace_Info, "Exited FreeModelSnapshot");
+}
+
+} // namespace DEFINED_ZONE_NAME
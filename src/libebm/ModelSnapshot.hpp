@@ -0,0 +1,134 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef MODEL_SNAPSHOT_HPP
+#define MODEL_SNAPSHOT_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <atomic>
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h"
+
+#include "ebm_internal.hpp" // FloatScore
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+class PreparedTrainingData;
+
+// An immutable copy of the scores of one term in the expanded layout of the model tensors. Every snapshot that is
+// published while the term does not change points to the same SnapshotTensor, so publishing after a round only copies
+// the terms that the round updated.
+class SnapshotTensor final {
+   std::atomic_size_t m_REFERENCE_COUNT;
+   FloatScore* m_aScores;
+
+   inline SnapshotTensor() noexcept :
+         m_REFERENCE_COUNT(1), // we're not visible on any other thread yet, so no synchronization required
+         m_aScores(nullptr) {}
+
+   ~SnapshotTensor();
+
+ public:
+   static SnapshotTensor* Create(const size_t cScores, const FloatScore* const aScores);
+   static void Free(SnapshotTensor* const pSnapshotTensor);
+
+   inline void AddReferenceCount() {
+      // see BoosterCore::AddReferenceCount
+      m_REFERENCE_COUNT.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   inline const FloatScore* GetScores() const { return m_aScores; }
+};
+
+// A ModelSnapshot is the current and best model of a booster as they were at the end of one ApplyTermUpdate or other
+// call that changed them. The booster publishes a new snapshot after each such call and keeps a reference to the
+// latest one, and GetModelSnapshot hands out further references under a lock that is only held while the pointer is
+// read. Nothing in a snapshot changes after it is published, so other threads can read it while boosting continues,
+// and it keeps the prepared data alive for the term layouts even after the booster is freed.
+class ModelSnapshot final {
+   static constexpr size_t k_handleVerificationOk = 12889; // random 15 bit number
+   static constexpr size_t k_handleVerificationFreed = 29153; // random 15 bit number
+   size_t m_handleVerification; // this needs to be at the top and make it pointer sized to keep best alignment
+
+   // the booster holds one reference to its latest snapshot and every handle given out holds another
+   std::atomic_size_t m_REFERENCE_COUNT;
+
+   PreparedTrainingData* m_pPreparedTrainingData;
+   size_t m_cTerms;
+
+   size_t m_version;
+   double m_bestModelMetric;
+
+   // the current model tensors followed by the best model tensors, nullptr for the terms without a tensor
+   SnapshotTensor** m_apTensors;
+
+   inline ModelSnapshot() noexcept :
+         m_handleVerification(k_handleVerificationOk),
+         m_REFERENCE_COUNT(1), // we're not visible on any other thread yet, so no synchronization required
+         m_pPreparedTrainingData(nullptr),
+         m_cTerms(0),
+         m_version(0),
+         m_bestModelMetric(0.0),
+         m_apTensors(nullptr) {}
+
+   ~ModelSnapshot();
+
+ public:
+   // the new snapshot shares all the tensors of pSnapshotPrev, or has none if pSnapshotPrev is nullptr, and the
+   // publisher then replaces the tensors of the terms that changed
+   static ErrorEbm Create(PreparedTrainingData* const pPreparedTrainingData,
+         const ModelSnapshot* const pSnapshotPrev,
+         const size_t version,
+         const double bestModelMetric,
+         ModelSnapshot** const ppModelSnapshotOut);
+   static void Free(ModelSnapshot* const pModelSnapshot);
+
+   inline void AddReferenceCount() {
+      // see BoosterCore::AddReferenceCount
+      m_REFERENCE_COUNT.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   inline static ModelSnapshot* GetModelSnapshotFromHandle(const ModelSnapshotHandle modelSnapshotHandle) {
+      if(nullptr == modelSnapshotHandle) {
+         LOG_0(Trace_Error, "ERROR GetModelSnapshotFromHandle null modelSnapshotHandle");
+         return nullptr;
+      }
+      ModelSnapshot* const pModelSnapshot = reinterpret_cast<ModelSnapshot*>(modelSnapshotHandle);
+      if(k_handleVerificationOk == pModelSnapshot->m_handleVerification) {
+         return pModelSnapshot;
+      }
+      if(k_handleVerificationFreed == pModelSnapshot->m_handleVerification) {
+         LOG_0(Trace_Error, "ERROR GetModelSnapshotFromHandle attempt to use freed ModelSnapshotHandle");
+      } else {
+         LOG_0(Trace_Error, "ERROR GetModelSnapshotFromHandle attempt to use invalid ModelSnapshotHandle");
+      }
+      return nullptr;
+   }
+   inline ModelSnapshotHandle GetHandle() { return reinterpret_cast<ModelSnapshotHandle>(this); }
+
+   inline PreparedTrainingData* GetPreparedTrainingData() const { return m_pPreparedTrainingData; }
+
+   inline size_t GetVersion() const { return m_version; }
+
+   inline double GetBestModelMetric() const { return m_bestModelMetric; }
+
+   // iModel is 0 for the current model and 1 for the best model
+   inline SnapshotTensor* GetTensor(const size_t iModel, const size_t iTerm) const {
+      EBM_ASSERT(iModel <= size_t{1});
+      EBM_ASSERT(iTerm < m_cTerms);
+      return m_apTensors[iModel * m_cTerms + iTerm];
+   }
+
+   // takes over the caller's reference to pSnapshotTensor and releases the tensor that it replaces
+   void SetTensor(const size_t iModel, const size_t iTerm, SnapshotTensor* const pSnapshotTensor);
+};
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // MODEL_SNAPSHOT_HPP
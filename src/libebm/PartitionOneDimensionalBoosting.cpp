@@ -7,8 +7,7 @@
 #include <type_traits> // std::is_standard_layout
 #include <stddef.h> // size_t, ptrdiff_t
 #include <string.h> // memcpy
-#include <vector>
-#include <queue>
+#include <algorithm> // std::push_heap, std::pop_heap, std::sort
 
 #include "libebm.h" // ErrorEbm
 #include "logging.h" // EBM_ASSERT
@@ -295,21 +294,17 @@ static int FindBestSplitGain(RandomDeterministic* const pRng,
 #endif // NDEBUG
 
    Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)> binParent;
-   Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)> binLeft;
 
    // if we know how many scores there are, use the memory on the stack where the compiler can optimize access
    static constexpr bool bUseStackMemory = k_dynamicScores != cCompilerScores;
    const auto* const aParentGradientPairs =
          bUseStackMemory ? binParent.GetGradientPairs() : pTreeNode->GetBin()->GetGradientPairs();
-   auto* const aLeftGradientPairs =
-         bUseStackMemory ? binLeft.GetGradientPairs() : pLeftChild->GetBin()->GetGradientPairs();
    if(bUseStackMemory) {
       binParent.Copy(cScores, *pTreeNode->GetBin());
    } else {
       binParent.SetCountSamples(pTreeNode->GetBin()->GetCountSamples());
       binParent.SetWeight(pTreeNode->GetBin()->GetWeight());
    }
-   binLeft.Zero(cScores, aLeftGradientPairs);
 
    auto* pBinCur = pTreeNode->BEFORE_GetBinFirst();
    const auto* const pBinLast = pTreeNode->BEFORE_GetBinLast();
@@ -323,118 +318,184 @@ static int FindBestSplitGain(RandomDeterministic* const pRng,
    auto* pBestSplitsStart = pBoosterShell->GetSplitPositionsTemp<bHessian, GetArrayScores(cCompilerScores)>();
    auto* pBestSplitsCur = pBestSplitsStart;
 
-   UIntMain cSamplesRight = binParent.GetCountSamples();
-
    const bool bUseLogitBoost = bHessian && !(TermBoostFlags_DisableNewtonGain & flags);
    const bool bUpdateWithHessian = bHessian && !(TermBoostFlags_DisableNewtonUpdate & flags);
 
-   EBM_ASSERT(FloatCalc{0} <= k_gainMin);
-   FloatCalc bestGain = k_gainMin; // it must at least be this, and maybe it needs to be more
    EBM_ASSERT(std::numeric_limits<FloatCalc>::min() <= hessianMin);
    EBM_ASSERT(pBinLast != pBinCur); // then we would be non-splitable and would have exited above
-   do {
-      ASSERT_BIN_OK(cBytesPerBin, pBinCur, pBoosterShell->GetDebugMainBinsEnd());
 
-      const UIntMain cSamplesChange = pBinCur->GetCountSamples();
-      cSamplesRight -= cSamplesChange;
-      if(UNLIKELY(cSamplesRight < cSamplesLeafMin)) {
-         // we'll just keep subtracting if we continue, so there won't be any more splits, so we're done
-         goto done;
-      }
-      binLeft.SetCountSamples(binLeft.GetCountSamples() + cSamplesChange);
-
-      FloatMain sumHessiansLeftOrig = binLeft.GetWeight() + pBinCur->GetWeight();
-      FloatCalc sumHessiansRight = static_cast<FloatCalc>(binParent.GetWeight() - sumHessiansLeftOrig);
+   // The sweep is done in 3 passes over arrays with one entry per possible cut, which PartitionOneDimensionalBoosting
+   // reserved in Temp1. The first pass accumulates the left side sums, which is inherently serial. The second pass
+   // computes the gains one score at a time over contiguous memory, which the compiler can vectorize. The third pass
+   // picks the best cut. The floating point operations happen in the same order as a single pass would do them.
+   const auto* const pBinFirst = pBinCur;
+   const size_t cCutsMax = CountBins(pBinLast, pBinFirst, cBytesPerBin);
+   FloatMain* const aLeftWeights = static_cast<FloatMain*>(pBoosterShell->GetTemp1());
+   FloatMain* const aLeftGradients = aLeftWeights + cCutsMax;
+   FloatMain* const aLeftHessians = aLeftGradients + cScores * cCutsMax;
+   FloatCalc* const aGains = reinterpret_cast<FloatCalc*>(aLeftHessians + (bHessian ? cScores * cCutsMax : size_t{0}));
+   UIntMain* const aLeftCounts = reinterpret_cast<UIntMain*>(aGains + cCutsMax);
+   bool* const aIllegal = reinterpret_cast<bool*>(aLeftCounts + cCutsMax);
+
+   size_t cCuts = 0;
+   {
+      UIntMain cSamplesRight = binParent.GetCountSamples();
+      UIntMain cSamplesLeft = 0;
+      FloatMain sumHessiansLeftOrig = 0;
+      do {
+         ASSERT_BIN_OK(cBytesPerBin, pBinCur, pBoosterShell->GetDebugMainBinsEnd());
 
-      if(!bUseLogitBoost) {
-         if(UNLIKELY(sumHessiansRight < hessianMin)) {
+         const UIntMain cSamplesChange = pBinCur->GetCountSamples();
+         cSamplesRight -= cSamplesChange;
+         if(UNLIKELY(cSamplesRight < cSamplesLeafMin)) {
             // we'll just keep subtracting if we continue, so there won't be any more splits, so we're done
             goto done;
          }
-      }
-      bool bLegal = true;
+         cSamplesLeft += cSamplesChange;
 
-      binLeft.SetWeight(sumHessiansLeftOrig);
-      FloatCalc sumHessiansLeft = static_cast<FloatCalc>(sumHessiansLeftOrig);
+         sumHessiansLeftOrig += pBinCur->GetWeight();
+         if(!bUseLogitBoost) {
+            if(UNLIKELY(static_cast<FloatCalc>(binParent.GetWeight() - sumHessiansLeftOrig) < hessianMin)) {
+               // we'll just keep subtracting if we continue, so there won't be any more splits, so we're done
+               goto done;
+            }
+         }
+         bool bIllegal = cSamplesLeft < cSamplesLeafMin ||
+               (!bUseLogitBoost && static_cast<FloatCalc>(sumHessiansLeftOrig) < hessianMin);
 
-      FloatCalc sumHessiansRightUpdate = sumHessiansRight;
-      FloatCalc sumHessiansLeftUpdate = sumHessiansLeft;
+         const auto* const aBinGradientPairs = pBinCur->GetGradientPairs();
+         size_t iScore = 0;
+         do {
+            FloatMain* const pLeftGradient = &aLeftGradients[iScore * cCutsMax + cCuts];
+            *pLeftGradient =
+                  (size_t{0} == cCuts ? FloatMain{0} : pLeftGradient[-1]) + aBinGradientPairs[iScore].m_sumGradients;
+            if(bHessian) {
+               FloatMain* const pLeftHessian = &aLeftHessians[iScore * cCutsMax + cCuts];
+               const FloatMain newSumHessiansLeftOrig =
+                     (size_t{0} == cCuts ? FloatMain{0} : pLeftHessian[-1]) + aBinGradientPairs[iScore].GetHess();
+               *pLeftHessian = newSumHessiansLeftOrig;
+               if(bUseLogitBoost) {
+                  if(UNLIKELY(static_cast<FloatCalc>(aParentGradientPairs[iScore].GetHess() - newSumHessiansLeftOrig) <
+                           hessianMin)) {
+                     // we'll just keep subtracting if we continue, so there won't be any more splits, so we're done
+                     goto done;
+                  }
+                  bIllegal = bIllegal || static_cast<FloatCalc>(newSumHessiansLeftOrig) < hessianMin;
+               }
+            }
+            ++iScore;
+         } while(cScores != iScore);
+
+         aLeftWeights[cCuts] = sumHessiansLeftOrig;
+         aLeftCounts[cCuts] = cSamplesLeft;
+         aIllegal[cCuts] = bIllegal;
+         aGains[cCuts] = 0;
+         ++cCuts;
+
+         pBinCur = IndexBin(pBinCur, cBytesPerBin);
+      } while(pBinLast != pBinCur);
+   }
+done:;
 
-      const auto* const aBinGradientPairs = pBinCur->GetGradientPairs();
-      FloatCalc gain = 0;
+   if(size_t{0} != cCuts) {
+      const FloatMain weightParent = binParent.GetWeight();
       size_t iScore = 0;
       do {
-         const FloatMain sumGradientsLeftOrig =
-               aLeftGradientPairs[iScore].m_sumGradients + aBinGradientPairs[iScore].m_sumGradients;
-         aLeftGradientPairs[iScore].m_sumGradients = sumGradientsLeftOrig;
-         const FloatCalc sumGradientsRight =
-               static_cast<FloatCalc>(aParentGradientPairs[iScore].m_sumGradients - sumGradientsLeftOrig);
-
-         if(bHessian) {
-            const FloatMain newSumHessiansLeftOrig =
-                  aLeftGradientPairs[iScore].GetHess() + aBinGradientPairs[iScore].GetHess();
-            aLeftGradientPairs[iScore].SetHess(newSumHessiansLeftOrig);
-            const FloatCalc newSumHessiansRight =
-                  static_cast<FloatCalc>(aParentGradientPairs[iScore].GetHess() - newSumHessiansLeftOrig);
-            const FloatCalc newSumHessiansLeft = static_cast<FloatCalc>(newSumHessiansLeftOrig);
-            if(bUseLogitBoost) {
-               if(UNLIKELY(newSumHessiansRight < hessianMin)) {
-                  // we'll just keep subtracting if we continue, so there won't be any more splits, so we're done
-                  goto done;
-               }
-               if(UNLIKELY(newSumHessiansLeft < hessianMin)) {
-                  bLegal = false;
+         const FloatMain* const aScoreLeftGradients = &aLeftGradients[iScore * cCutsMax];
+         const FloatMain* const aScoreLeftHessians = &aLeftHessians[iScore * cCutsMax];
+         const FloatMain sumGradientsParent = aParentGradientPairs[iScore].m_sumGradients;
+         const FloatMain sumHessiansParent = bHessian ? aParentGradientPairs[iScore].GetHess() : FloatMain{0};
+
+         if(MONOTONE_NONE == direction && std::numeric_limits<FloatCalc>::infinity() == deltaStepMax) {
+            // the common case has no branches, so this loop can be vectorized
+            size_t iCut = 0;
+            do {
+               const FloatCalc sumGradientsLeft = static_cast<FloatCalc>(aScoreLeftGradients[iCut]);
+               const FloatCalc sumGradientsRight =
+                     static_cast<FloatCalc>(sumGradientsParent - aScoreLeftGradients[iCut]);
+               FloatCalc sumHessiansLeft = static_cast<FloatCalc>(aLeftWeights[iCut]);
+               FloatCalc sumHessiansRight = static_cast<FloatCalc>(weightParent - aLeftWeights[iCut]);
+               if(bUseLogitBoost) {
+                  sumHessiansLeft = static_cast<FloatCalc>(aScoreLeftHessians[iCut]);
+                  sumHessiansRight = static_cast<FloatCalc>(sumHessiansParent - aScoreLeftHessians[iCut]);
                }
-               sumHessiansLeft = newSumHessiansLeft;
-               sumHessiansRight = newSumHessiansRight;
-            }
-            if(bUpdateWithHessian) {
-               sumHessiansLeftUpdate = newSumHessiansLeft;
-               sumHessiansRightUpdate = newSumHessiansRight;
-            }
-         }
-         const FloatCalc sumGradientsLeft = static_cast<FloatCalc>(sumGradientsLeftOrig);
-
-         if(MONOTONE_NONE != direction) {
-            const FloatCalc negUpdateRight =
-                  CalcNegUpdate<true>(sumGradientsRight, sumHessiansRightUpdate, regAlpha, regLambda, deltaStepMax);
-            const FloatCalc negUpdateLeft =
-                  CalcNegUpdate<true>(sumGradientsLeft, sumHessiansLeftUpdate, regAlpha, regLambda, deltaStepMax);
-            if(MonotoneDirection{0} < direction) {
-               if(negUpdateLeft < negUpdateRight) {
-                  bLegal = false;
+               // this is CalcPartialGain<true>, which returns zero for the left side of illegal cuts
+               const bool bZeroLeft = sumHessiansLeft < std::numeric_limits<FloatCalc>::min();
+               const FloatCalc gainRight =
+                     CalcPartialGainUnclipped(sumGradientsRight, sumHessiansRight, regAlpha, regLambda);
+               const FloatCalc gainLeft = CalcPartialGainUnclipped(
+                     sumGradientsLeft, bZeroLeft ? FloatCalc{1} : sumHessiansLeft, regAlpha, regLambda);
+               aGains[iCut] += gainRight;
+               aGains[iCut] += bZeroLeft ? FloatCalc{0} : gainLeft;
+               ++iCut;
+            } while(cCuts != iCut);
+         } else {
+            size_t iCut = 0;
+            do {
+               const FloatCalc sumGradientsLeft = static_cast<FloatCalc>(aScoreLeftGradients[iCut]);
+               const FloatCalc sumGradientsRight =
+                     static_cast<FloatCalc>(sumGradientsParent - aScoreLeftGradients[iCut]);
+               FloatCalc sumHessiansLeft = static_cast<FloatCalc>(aLeftWeights[iCut]);
+               FloatCalc sumHessiansRight = static_cast<FloatCalc>(weightParent - aLeftWeights[iCut]);
+               FloatCalc sumHessiansLeftUpdate = sumHessiansLeft;
+               FloatCalc sumHessiansRightUpdate = sumHessiansRight;
+               if(bHessian) {
+                  const FloatCalc newSumHessiansLeft = static_cast<FloatCalc>(aScoreLeftHessians[iCut]);
+                  const FloatCalc newSumHessiansRight =
+                        static_cast<FloatCalc>(sumHessiansParent - aScoreLeftHessians[iCut]);
+                  if(bUseLogitBoost) {
+                     sumHessiansLeft = newSumHessiansLeft;
+                     sumHessiansRight = newSumHessiansRight;
+                  }
+                  if(bUpdateWithHessian) {
+                     sumHessiansLeftUpdate = newSumHessiansLeft;
+                     sumHessiansRightUpdate = newSumHessiansRight;
+                  }
                }
-            } else {
-               EBM_ASSERT(direction < MonotoneDirection{0});
-               if(negUpdateRight < negUpdateLeft) {
-                  bLegal = false;
+
+               if(MONOTONE_NONE != direction) {
+                  const FloatCalc negUpdateRight = CalcNegUpdate<true>(
+                        sumGradientsRight, sumHessiansRightUpdate, regAlpha, regLambda, deltaStepMax);
+                  const FloatCalc negUpdateLeft = CalcNegUpdate<true>(
+                        sumGradientsLeft, sumHessiansLeftUpdate, regAlpha, regLambda, deltaStepMax);
+                  if(MonotoneDirection{0} < direction) {
+                     if(negUpdateLeft < negUpdateRight) {
+                        aIllegal[iCut] = true;
+                     }
+                  } else {
+                     EBM_ASSERT(direction < MonotoneDirection{0});
+                     if(negUpdateRight < negUpdateLeft) {
+                        aIllegal[iCut] = true;
+                     }
+                  }
                }
-            }
-         }
 
-         const FloatCalc gainRight =
-               CalcPartialGain<false>(sumGradientsRight, sumHessiansRight, regAlpha, regLambda, deltaStepMax);
-         EBM_ASSERT(!bLegal || std::isnan(gainRight) || 0 <= gainRight);
-         gain += gainRight;
+               const FloatCalc gainRight =
+                     CalcPartialGain<false>(sumGradientsRight, sumHessiansRight, regAlpha, regLambda, deltaStepMax);
+               EBM_ASSERT(aIllegal[iCut] || std::isnan(gainRight) || 0 <= gainRight);
+               aGains[iCut] += gainRight;
 
-         // if bLegal was set to false, sumHessiansLeft can be negative
-         const FloatCalc gainLeft =
-               CalcPartialGain<true>(sumGradientsLeft, sumHessiansLeft, regAlpha, regLambda, deltaStepMax);
-         EBM_ASSERT(!bLegal || std::isnan(gainLeft) || 0 <= gainLeft);
-         gain += gainLeft;
+               // if the cut is illegal, sumHessiansLeft can be negative
+               const FloatCalc gainLeft =
+                     CalcPartialGain<true>(sumGradientsLeft, sumHessiansLeft, regAlpha, regLambda, deltaStepMax);
+               EBM_ASSERT(aIllegal[iCut] || std::isnan(gainLeft) || 0 <= gainLeft);
+               aGains[iCut] += gainLeft;
 
+               ++iCut;
+            } while(cCuts != iCut);
+         }
          ++iScore;
       } while(cScores != iScore);
-      EBM_ASSERT(std::isnan(gain) || 0 <= gain);
+   }
 
-      if(!bLegal || binLeft.GetCountSamples() < cSamplesLeafMin) {
-         goto next;
-      }
+   EBM_ASSERT(FloatCalc{0} <= k_gainMin);
+   FloatCalc bestGain = k_gainMin; // it must at least be this, and maybe it needs to be more
+   for(size_t iCut = 0; iCut < cCuts; ++iCut) {
+      const FloatCalc gain = aGains[iCut];
+      EBM_ASSERT(std::isnan(gain) || 0 <= gain);
 
-      if(!bUseLogitBoost) {
-         if(UNLIKELY(sumHessiansLeft < hessianMin)) {
-            goto next;
-         }
+      if(aIllegal[iCut]) {
+         continue;
       }
 
       if(UNLIKELY(/* NaN */ !LIKELY(gain < bestGain))) {
@@ -472,21 +533,14 @@ static int FindBestSplitGain(RandomDeterministic* const pRng,
          pBestSplitsCur = UNPREDICTABLE(bestGain == gain) ? pBestSplitsCur : pBestSplitsStart;
          bestGain = gain;
 
-         pBestSplitsCur->SetBinPosition(pBinCur);
-
-         pBestSplitsCur->GetLeftSum()->Copy(cScores, binLeft, aLeftGradientPairs);
+         // the left sums are filled in from the cut arrays once the tie is resolved
+         pBestSplitsCur->SetBinPosition(IndexBin(pBinFirst, cBytesPerBin * iCut));
 
          pBestSplitsCur = IndexSplitPosition(pBestSplitsCur, cBytesPerSplitPosition);
       } else {
          EBM_ASSERT(!std::isnan(gain));
       }
-
-   next:;
-
-      pBinCur = IndexBin(pBinCur, cBytesPerBin);
-   } while(pBinLast != pBinCur);
-
-done:;
+   }
 
    if(UNLIKELY(pBestSplitsStart == pBestSplitsCur)) {
       // no valid splits found
@@ -565,10 +619,23 @@ done:;
    const auto* const pBestBinPosition = pBestSplitsStart->GetBinPosition();
    pLeftChild->BEFORE_SetBinLast(pBestBinPosition);
 
-   memcpy(pLeftChild->GetBin(), pBestSplitsStart->GetLeftSum(), cBytesPerBin);
+   auto* const pLeftSum = pLeftChild->GetBin();
+   const size_t iBestCut = CountBins(pBestBinPosition, pBinFirst, cBytesPerBin);
+   EBM_ASSERT(iBestCut < cCuts);
+   pLeftSum->SetCountSamples(aLeftCounts[iBestCut]);
+   pLeftSum->SetWeight(aLeftWeights[iBestCut]);
+   auto* const aLeftSumGradientPairs = pLeftSum->GetGradientPairs();
+   size_t iScoreLeft = 0;
+   do {
+      aLeftSumGradientPairs[iScoreLeft].m_sumGradients = aLeftGradients[iScoreLeft * cCutsMax + iBestCut];
+      if(bHessian) {
+         aLeftSumGradientPairs[iScoreLeft].SetHess(aLeftHessians[iScoreLeft * cCutsMax + iBestCut]);
+      }
+      ++iScoreLeft;
+   } while(cScores != iScoreLeft);
 
-   const auto* const pBinFirst = IndexBin(pBestBinPosition, cBytesPerBin);
-   ASSERT_BIN_OK(cBytesPerBin, pBinFirst, pBoosterShell->GetDebugMainBinsEnd());
+   const auto* const pBinRightFirst = IndexBin(pBestBinPosition, cBytesPerBin);
+   ASSERT_BIN_OK(cBytesPerBin, pBinRightFirst, pBoosterShell->GetDebugMainBinsEnd());
 
    EBM_ASSERT(!IsOverflowTreeNodeSize(bHessian, cScores)); // we're accessing allocated memory
    const size_t cBytesPerTreeNode = GetTreeNodeSize(bHessian, cScores);
@@ -577,14 +644,13 @@ done:;
    pRightChild->SetDebugProgression(0);
 #endif // NDEBUG
    pRightChild->BEFORE_SetBinLast(pBinLast);
-   pRightChild->BEFORE_SetBinFirst(pBinFirst);
+   pRightChild->BEFORE_SetBinFirst(pBinRightFirst);
 
-   pRightChild->GetBin()->SetCountSamples(
-         binParent.GetCountSamples() - pBestSplitsStart->GetLeftSum()->GetCountSamples());
-   pRightChild->GetBin()->SetWeight(binParent.GetWeight() - pBestSplitsStart->GetLeftSum()->GetWeight());
+   pRightChild->GetBin()->SetCountSamples(binParent.GetCountSamples() - pLeftSum->GetCountSamples());
+   pRightChild->GetBin()->SetWeight(binParent.GetWeight() - pLeftSum->GetWeight());
 
    auto* const aRightGradientPairs = pRightChild->GetBin()->GetGradientPairs();
-   const auto* const aBestGradientPairs = pBestSplitsStart->GetLeftSum()->GetGradientPairs();
+   const auto* const aBestGradientPairs = aLeftSumGradientPairs;
    size_t iScoreCopy = 0;
    do {
       auto temp = aParentGradientPairs[iScoreCopy];
@@ -608,6 +674,107 @@ done:;
    return 0;
 }
 
+// The categories of a nominal feature have no order, so any subset of them can go to either side of a split. With a
+// single score the best subsets are prefixes of the bins once they are ordered by gradient over hessian (Fisher's
+// grouping), so we sort the bins into that order in place, partition them with the ordered sweep, and then restore
+// them. The leaves are no longer ranges of the original bins, so the update gets one slice per bin.
+template<bool bHessian>
+static void SortNominalBins(BoosterShell* const pBoosterShell,
+      const TermBoostFlags flags,
+      const FloatCalc regLambda,
+      const size_t cBins,
+      FloatCalc* const aKeys,
+      size_t* const aiOrder,
+      void* const aBinsCopy) {
+   const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, size_t{1});
+   auto* const aBins = pBoosterShell->GetBoostingMainBins()->Specialize<FloatMain, UIntMain, true, true, bHessian>();
+
+   const bool bUpdateWithHessian = bHessian && !(TermBoostFlags_DisableNewtonUpdate & flags);
+
+   const auto* pBin = aBins;
+   for(size_t iBin = 0; iBin < cBins; ++iBin) {
+      const FloatCalc sumGradients = static_cast<FloatCalc>(pBin->GetGradientPairs()[0].m_sumGradients);
+      const FloatCalc sumHessians = regLambda +
+            static_cast<FloatCalc>(bUpdateWithHessian ? pBin->GetGradientPairs()[0].GetHess() : pBin->GetWeight());
+      // empty categories have no gradient either way, so they sort among the bins that want no update
+      aKeys[iBin] = sumHessians <= FloatCalc{0} ? FloatCalc{0} : sumGradients / sumHessians;
+      aiOrder[iBin] = iBin;
+      pBin = IndexBin(pBin, cBytesPerBin);
+   }
+
+   // ties go by bin index so that the order does not depend on the sort implementation. NaN keys would break the
+   // weak ordering, but they also make the sweep reject the update, so we move them to the front first
+   size_t* const aiOrderEnd = aiOrder + cBins;
+   size_t* const aiOrderNumbers =
+         std::partition(aiOrder, aiOrderEnd, [aKeys](const size_t iBin) { return std::isnan(aKeys[iBin]); });
+   std::sort(aiOrderNumbers, aiOrderEnd, [aKeys](const size_t iLeft, const size_t iRight) {
+      return aKeys[iLeft] < aKeys[iRight] || (aKeys[iLeft] == aKeys[iRight] && iLeft < iRight);
+   });
+
+   memcpy(aBinsCopy, aBins, cBytesPerBin * cBins);
+   auto* pBinSorted = aBins;
+   for(size_t iSorted = 0; iSorted < cBins; ++iSorted) {
+      memcpy(pBinSorted, IndexByte(aBinsCopy, cBytesPerBin * aiOrder[iSorted]), cBytesPerBin);
+      pBinSorted = IndexBin(pBinSorted, cBytesPerBin);
+   }
+}
+
+template<bool bHessian>
+static ErrorEbm UnsortNominalBins(BoosterShell* const pBoosterShell,
+      const size_t iDimension,
+      const size_t cBins,
+      const size_t* const aiOrder,
+      size_t* const aiSlices,
+      void* const aBinsCopy) {
+   const size_t cScores = pBoosterShell->GetBoosterCore()->GetCountScores();
+   const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+   memcpy(pBoosterShell->GetBoostingMainBins(), aBinsCopy, cBytesPerBin * cBins);
+
+   Tensor* const pInnerTermUpdate = pBoosterShell->GetInnerTermUpdate();
+   const size_t cSlices = pInnerTermUpdate->GetCountSlices(iDimension);
+   if(size_t{1} == cSlices) {
+      return Error_None;
+   }
+
+   const UIntSplit* const aSplits = pInnerTermUpdate->GetSplitPointer(iDimension);
+   size_t iSlice = 0;
+   for(size_t iSorted = 0; iSorted < cBins; ++iSorted) {
+      if(iSlice + size_t{1} != cSlices && static_cast<size_t>(aSplits[iSlice]) <= iSorted) {
+         ++iSlice;
+      }
+      aiSlices[aiOrder[iSorted]] = iSlice;
+   }
+
+   // the bins are back in place, so their copy has room for the scores of the slices
+   EBM_ASSERT(sizeof(FloatScore) * cScores * cSlices <= cBytesPerBin * cBins);
+   FloatScore* const aSliceScores = static_cast<FloatScore*>(aBinsCopy);
+   memcpy(aSliceScores, pInnerTermUpdate->GetTensorScoresPointer(), sizeof(FloatScore) * cScores * cSlices);
+
+   ErrorEbm error = pInnerTermUpdate->SetCountSlices(iDimension, cBins);
+   if(UNLIKELY(Error_None != error)) {
+      // already logged
+      return error;
+   }
+   EBM_ASSERT(!IsMultiplyError(cScores, cBins));
+   error = pInnerTermUpdate->EnsureTensorScoreCapacity(cScores * cBins);
+   if(UNLIKELY(Error_None != error)) {
+      // already logged
+      return error;
+   }
+
+   UIntSplit* const aSplitsBins = pInnerTermUpdate->GetSplitPointer(iDimension);
+   FloatScore* const aUpdateScores = pInnerTermUpdate->GetTensorScoresPointer();
+   for(size_t iBin = 0; iBin < cBins; ++iBin) {
+      if(size_t{0} != iBin) {
+         // we checked earlier that countBins could be converted to a UIntSplit
+         EBM_ASSERT(!IsConvertError<UIntSplit>(iBin));
+         aSplitsBins[iBin - 1] = static_cast<UIntSplit>(iBin);
+      }
+      memcpy(&aUpdateScores[cScores * iBin], &aSliceScores[cScores * aiSlices[iBin]], sizeof(FloatScore) * cScores);
+   }
+   return Error_None;
+}
+
 template<bool bHessian> class CompareNodeGain final {
  public:
    INLINE_ALWAYS bool operator()(
@@ -634,6 +801,7 @@ template<bool bHessian, size_t cCompilerScores> class PartitionOneDimensionalBoo
          const FloatCalc deltaStepMax,
          const size_t cSplitsMax,
          const MonotoneDirection direction,
+         const bool bSortNominal,
          const size_t cSamplesTotal,
          const FloatMain weightTotal,
          double* const pTotalGain) {
@@ -646,6 +814,47 @@ template<bool bHessian, size_t cCompilerScores> class PartitionOneDimensionalBoo
 
       const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
 
+      // FindBestSplitGain sweeps the cuts of a node through arrays that hold one entry per cut
+      const size_t cFloatsPerCut = size_t{1} + (bHessian ? size_t{2} : size_t{1}) * cScores;
+      const size_t cBytesPerCut =
+            sizeof(FloatMain) * cFloatsPerCut + sizeof(FloatCalc) + sizeof(UIntMain) + sizeof(bool);
+      if(IsMultiplyError(cBytesPerCut, cBins - size_t{1})) {
+         LOG_0(Trace_Warning, "WARNING PartitionOneDimensionalBoosting IsMultiplyError(cBytesPerCut, cBins - 1)");
+         return Error_OutOfMemory;
+      }
+      size_t cBytesTemp1 = cBytesPerCut * (cBins - size_t{1});
+
+      // the nominal sort keeps its keys, the sorted order, the slice of each bin, and a copy of the unsorted bins
+      // after the cut arrays. Orders of gradients over hessians only exist for a single score, and a monotone
+      // constraint needs the original order of the bins
+      const bool bSort = bSortNominal && size_t{1} == cScores && MONOTONE_NONE == direction;
+      static constexpr size_t k_cBytesAlign = sizeof(FloatMain) < sizeof(size_t) ? sizeof(size_t) : sizeof(FloatMain);
+      const size_t cBytesSortOffset = (cBytesTemp1 + (k_cBytesAlign - size_t{1})) / k_cBytesAlign * k_cBytesAlign;
+      if(bSort) {
+         const size_t cBytesPerSortBin = sizeof(FloatCalc) + sizeof(size_t) + sizeof(size_t) + cBytesPerBin;
+         if(IsMultiplyError(cBytesPerSortBin, cBins) || IsAddError(cBytesSortOffset, cBytesPerSortBin * cBins)) {
+            LOG_0(Trace_Warning, "WARNING PartitionOneDimensionalBoosting IsMultiplyError(cBytesPerSortBin, cBins)");
+            return Error_OutOfMemory;
+         }
+         cBytesTemp1 = cBytesSortOffset + cBytesPerSortBin * cBins;
+      }
+
+      ErrorEbm error = pBoosterShell->ReserveTemp1(cBytesTemp1);
+      if(Error_None != error) {
+         return error;
+      }
+
+      size_t* aiSortOrder = nullptr;
+      size_t* aiSortSlices = nullptr;
+      void* aSortBinsCopy = nullptr;
+      if(bSort) {
+         aiSortOrder = static_cast<size_t*>(IndexByte(pBoosterShell->GetTemp1(), cBytesSortOffset));
+         aiSortSlices = aiSortOrder + cBins;
+         FloatCalc* const aSortKeys = reinterpret_cast<FloatCalc*>(aiSortSlices + cBins);
+         aSortBinsCopy = IndexByte(aSortKeys, sizeof(FloatCalc) * cBins);
+         SortNominalBins<bHessian>(pBoosterShell, flags, regLambda, cBins, aSortKeys, aiSortOrder, aSortBinsCopy);
+      }
+
       auto* const pRootTreeNode = pBoosterShell->GetTreeNodesTemp<bHessian, GetArrayScores(cCompilerScores)>();
 
 #ifndef NDEBUG
@@ -696,11 +905,13 @@ template<bool bHessian, size_t cCompilerScores> class PartitionOneDimensionalBoo
          EBM_ASSERT(!std::isinf(pRootTreeNode->AFTER_GetSplitGain()));
          EBM_ASSERT(0 <= pRootTreeNode->AFTER_GetSplitGain());
 
-         try {
-            // TODO: someday see if we can replace this with an in-class priority queue that stores it's info inside
-            //       the TreeNode datastructure
-            std::priority_queue<TreeNode<bHessian>*, std::vector<TreeNode<bHessian>*>, CompareNodeGain<bHessian>>
-                  nodeGainRanking;
+         {
+            // The leaves that can still be split are kept in a max heap on their gain. It lives at the end of the
+            // tree node memory, which PreparedTrainingData sized for one entry per bin since each entry is a distinct
+            // leaf. Using the std heap functions keeps the order identical to std::priority_queue for equal gains.
+            TreeNode<bHessian>** const apNodeGainRanking = reinterpret_cast<TreeNode<bHessian>**>(
+                  IndexByte(pRootTreeNode, pBoosterCore->GetCountBytesTreeNodes() - sizeof(void*) * cBins));
+            size_t cNodeGainRanking = 0;
 
             auto* pTreeNode = pRootTreeNode;
 
@@ -710,9 +921,9 @@ template<bool bHessian, size_t cCompilerScores> class PartitionOneDimensionalBoo
             goto skip_first_push_pop;
 
             do {
-               // there is no way to get the top and pop at the same time.. would be good to get a better queue, but our
-               // code isn't bottlenecked by it
-               pTreeNode = nodeGainRanking.top()->template Upgrade<GetArrayScores(cCompilerScores)>();
+               std::pop_heap(apNodeGainRanking, apNodeGainRanking + cNodeGainRanking, CompareNodeGain<bHessian>());
+               --cNodeGainRanking;
+               pTreeNode = apNodeGainRanking[cNodeGainRanking]->template Upgrade<GetArrayScores(cCompilerScores)>();
                // In theory we can have nodes with equal gain values here, but this is very very rare to occur in
                // practice We handle equal gain values in FindBestSplitGain because we can have zero instances in bins,
                // in which case it occurs, but those equivalent situations have been cleansed by the time we reach this
@@ -723,7 +934,6 @@ template<bool bHessian, size_t cCompilerScores> class PartitionOneDimensionalBoo
                // split, we won't see that scenario anymore since the gradients won't be symetric anymore.  This is so
                // rare, and limited to one split, so we shouldn't bother to handle it since the complexity of doing so
                // outweights the benefits.
-               nodeGainRanking.pop();
 
             skip_first_push_pop:
 
@@ -760,7 +970,10 @@ template<bool bHessian, size_t cCompilerScores> class PartitionOneDimensionalBoo
                   EBM_ASSERT(!std::isnan(pLeftChild->AFTER_GetSplitGain()));
                   EBM_ASSERT(!std::isinf(pLeftChild->AFTER_GetSplitGain()));
                   EBM_ASSERT(0 <= pLeftChild->AFTER_GetSplitGain());
-                  nodeGainRanking.push(pLeftChild->Downgrade());
+                  EBM_ASSERT(cNodeGainRanking < cBins);
+                  apNodeGainRanking[cNodeGainRanking] = pLeftChild->Downgrade();
+                  ++cNodeGainRanking;
+                  std::push_heap(apNodeGainRanking, apNodeGainRanking + cNodeGainRanking, CompareNodeGain<bHessian>());
                }
 
                auto* const pRightChild = GetRightNode(pTreeNode->AFTER_GetChildren(), cBytesPerTreeNode);
@@ -785,29 +998,29 @@ template<bool bHessian, size_t cCompilerScores> class PartitionOneDimensionalBoo
                   EBM_ASSERT(!std::isnan(pRightChild->AFTER_GetSplitGain()));
                   EBM_ASSERT(!std::isinf(pRightChild->AFTER_GetSplitGain()));
                   EBM_ASSERT(0 <= pRightChild->AFTER_GetSplitGain());
-                  nodeGainRanking.push(pRightChild->Downgrade());
+                  EBM_ASSERT(cNodeGainRanking < cBins);
+                  apNodeGainRanking[cNodeGainRanking] = pRightChild->Downgrade();
+                  ++cNodeGainRanking;
+                  std::push_heap(apNodeGainRanking, apNodeGainRanking + cNodeGainRanking, CompareNodeGain<bHessian>());
                }
 
                --cSplitsRemaining;
-            } while(0 != cSplitsRemaining && UNLIKELY(!nodeGainRanking.empty()));
+            } while(0 != cSplitsRemaining && UNLIKELY(0 != cNodeGainRanking));
 
             EBM_ASSERT(!std::isnan(totalGain));
             EBM_ASSERT(0 <= totalGain);
 
-            EBM_ASSERT(CountBytes(pTreeNodeScratchSpace, pRootTreeNode) <= pBoosterCore->GetCountBytesTreeNodes());
-         } catch(const std::bad_alloc&) {
-            // calling anything inside nodeGainRanking can throw exceptions
-            LOG_0(Trace_Warning, "WARNING PartitionOneDimensionalBoosting out of memory exception");
-            return Error_OutOfMemory;
-         } catch(...) {
-            // calling anything inside nodeGainRanking can throw exceptions
-            LOG_0(Trace_Warning, "WARNING PartitionOneDimensionalBoosting exception");
-            return Error_UnexpectedInternal;
+            EBM_ASSERT(reinterpret_cast<const void*>(pTreeNodeScratchSpace) <=
+                  reinterpret_cast<const void*>(apNodeGainRanking));
          }
       }
       *pTotalGain = static_cast<double>(totalGain);
       const size_t cSplits = cSplitsMax - cSplitsRemaining;
-      return Flatten<bHessian>(pBoosterShell, flags, regAlpha, regLambda, deltaStepMax, iDimension, cBins, cSplits + 1);
+      error = Flatten<bHessian>(pBoosterShell, flags, regAlpha, regLambda, deltaStepMax, iDimension, cBins, cSplits + 1);
+      if(bSort && Error_None == error) {
+         error = UnsortNominalBins<bHessian>(pBoosterShell, iDimension, cBins, aiSortOrder, aiSortSlices, aSortBinsCopy);
+      }
+      return error;
    }
 };
 
@@ -823,6 +1036,7 @@ extern ErrorEbm PartitionOneDimensionalBoosting(RandomDeterministic* const pRng,
       const FloatCalc deltaStepMax,
       const size_t cSplitsMax,
       const MonotoneDirection direction,
+      const bool bSortNominal,
       const size_t cSamplesTotal,
       const FloatMain weightTotal,
       double* const pTotalGain) {
@@ -848,6 +1062,7 @@ extern ErrorEbm PartitionOneDimensionalBoosting(RandomDeterministic* const pRng,
                deltaStepMax,
                cSplitsMax,
                direction,
+               bSortNominal,
                cSamplesTotal,
                weightTotal,
                pTotalGain);
@@ -865,6 +1080,7 @@ extern ErrorEbm PartitionOneDimensionalBoosting(RandomDeterministic* const pRng,
                deltaStepMax,
                cSplitsMax,
                direction,
+               bSortNominal,
                cSamplesTotal,
                weightTotal,
                pTotalGain);
@@ -882,6 +1098,7 @@ extern ErrorEbm PartitionOneDimensionalBoosting(RandomDeterministic* const pRng,
                deltaStepMax,
                cSplitsMax,
                direction,
+               bSortNominal,
                cSamplesTotal,
                weightTotal,
                pTotalGain);
@@ -900,6 +1117,7 @@ extern ErrorEbm PartitionOneDimensionalBoosting(RandomDeterministic* const pRng,
                deltaStepMax,
                cSplitsMax,
                direction,
+               bSortNominal,
                cSamplesTotal,
                weightTotal,
                pTotalGain);
@@ -917,6 +1135,7 @@ extern ErrorEbm PartitionOneDimensionalBoosting(RandomDeterministic* const pRng,
                deltaStepMax,
                cSplitsMax,
                direction,
+               bSortNominal,
                cSamplesTotal,
                weightTotal,
                pTotalGain);
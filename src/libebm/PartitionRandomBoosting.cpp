@@ -175,6 +175,11 @@ template<bool bHessian, size_t cCompilerScores> class PartitionRandomBoostingInt
       }
       size_t* const acItemsInNextSliceOrBytesInCurrentSlice = reinterpret_cast<size_t*>(pBuffer);
 
+      // the RNG state lives behind a pointer that the compiler cannot prove is unaliased, so draw the splits from
+      // a copy on the stack that can be kept in registers and write the advanced state back once we are done
+      RandomDeterministic rng;
+      rng.Initialize(*pRng);
+
       const IntEbm* pLeavesMax2 = aLeavesMax;
       size_t* pcItemsInNextSliceOrBytesInCurrentSlice2 = acItemsInNextSliceOrBytesInCurrentSlice;
       const TermFeature* pTermFeature2 = pTerm->GetTermFeatures();
@@ -220,7 +225,7 @@ template<bool bHessian, size_t cCompilerScores> class PartitionRandomBoostingInt
                const size_t* const pcItemsInNextSliceOrBytesInCurrentSliceEnd =
                      pcItemsInNextSliceOrBytesInCurrentSlice2 + cSplits;
                do {
-                  const size_t iRandom = pRng->NextFast(cPossibleSplitLocations);
+                  const size_t iRandom = rng.NextFast(cPossibleSplitLocations);
                   size_t* const pRandomSwap = pcItemsInNextSliceOrBytesInCurrentSlice2 + iRandom;
                   const size_t temp = *pRandomSwap;
                   *pRandomSwap = *pcItemsInNextSliceOrBytesInCurrentSlice2;
@@ -237,6 +242,8 @@ template<bool bHessian, size_t cCompilerScores> class PartitionRandomBoostingInt
          ++pTermFeature2;
       } while(pTermFeaturesEnd != pTermFeature2);
 
+      pRng->Initialize(rng);
+
       const IntEbm* pLeavesMax3 = aLeavesMax;
       const size_t* pcBytesInSliceEnd;
       const TermFeature* pTermFeature3 = pTerm->GetTermFeatures();
@@ -377,6 +384,10 @@ template<bool bHessian, size_t cCompilerScores> class PartitionRandomBoostingInt
       const auto* pBin = aBins;
       auto* pCollapsedBin1 = aCollapsedBins;
 
+      // if we know how many scores there are, use the memory on the stack where the compiler can optimize access
+      static constexpr bool bUseStackMemory = k_dynamicScores != cCompilerScores;
+      Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)> binSlice;
+
       {
       move_next_slice:;
 
@@ -388,16 +399,26 @@ template<bool bHessian, size_t cCompilerScores> class PartitionRandomBoostingInt
          const size_t* pcItemsInNextSliceOrBytesInCurrentSlice = acItemsInNextSliceOrBytesInCurrentSlice;
          do {
             const auto* const pBinSliceEnd = IndexBin(pBin, *pcItemsInNextSliceOrBytesInCurrentSlice);
-            do {
-               ASSERT_BIN_OK(cBytesPerBin, pBin, pBoosterShell->GetDebugMainBinsEnd());
-               // TODO: add this first into a local Bin that can be put in registers then write it to
-               // pCollapsedBin1 aferwards
-               pCollapsedBin1->Add(cScores, *pBin);
-
-               // we're walking through all bins, so just move to the next one in the flat array,
-               // with the knowledge that we'll figure out it's multi-dimenional index below
-               pBin = IndexBin(pBin, cBytesPerBin);
-            } while(LIKELY(pBinSliceEnd != pBin));
+            if(bUseStackMemory) {
+               // sum the run into a local Bin that can be kept in registers. We start from the collapsed bin
+               // instead of zero so that the additions happen in the same order as summing in place
+               binSlice.Copy(cScores, *pCollapsedBin1);
+               do {
+                  ASSERT_BIN_OK(cBytesPerBin, pBin, pBoosterShell->GetDebugMainBinsEnd());
+                  binSlice.Add(cScores, *pBin);
+
+                  // we're walking through all bins, so just move to the next one in the flat array,
+                  // with the knowledge that we'll figure out it's multi-dimenional index below
+                  pBin = IndexBin(pBin, cBytesPerBin);
+               } while(LIKELY(pBinSliceEnd != pBin));
+               pCollapsedBin1->Copy(cScores, binSlice);
+            } else {
+               do {
+                  ASSERT_BIN_OK(cBytesPerBin, pBin, pBoosterShell->GetDebugMainBinsEnd());
+                  pCollapsedBin1->Add(cScores, *pBin);
+                  pBin = IndexBin(pBin, cBytesPerBin);
+               } while(LIKELY(pBinSliceEnd != pBin));
+            }
 
             pCollapsedBin1 = IndexBin(pCollapsedBin1, cBytesPerBin);
 
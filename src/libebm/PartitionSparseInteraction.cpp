@@ -0,0 +1,655 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memcpy
+#include <limits> // numeric_limits
+#include <type_traits> // std::is_standard_layout
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // LIKELY
+
+#define ZONE_main
+#include "zones.h"
+
+#include "GradientPair.hpp"
+#include "Bin.hpp"
+
+#include "ebm_internal.hpp"
+#include "ebm_stats.hpp" // CalcPartialGain
+#include "DataSetInteraction.hpp"
+#include "InteractionCore.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// A term of 3 or more features can have far more tensor cells than samples, so only the cells that hold samples are
+// kept.  They live in an open addressing hash table keyed by the flat tensor index (dimension 0 varies fastest), where
+// each slot is the key followed by the cell's Bin.  The table is at most half full, so it stays within a small factor
+// of the number of occupied cells.
+static constexpr size_t k_emptyCellKey = std::numeric_limits<size_t>::max();
+static constexpr int k_cBitsSlotsInitial = 8;
+static constexpr uint64_t k_hashMultiplier = uint64_t{0x9E3779B97F4A7C15};
+
+// coordinate ascent stops after this many passes over the dimensions even if some cut is still moving
+static constexpr size_t k_cRoundsMax = 8;
+
+struct SparseCells final {
+   SparseCells() = default; // preserve our POD status
+   ~SparseCells() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   size_t m_cBytesPerBin;
+   size_t m_cBytesPerSlot;
+   int m_cBitsSlots;
+   size_t m_cOccupied;
+   unsigned char* m_aSlots;
+
+   INLINE_ALWAYS size_t GetCountSlots() const { return size_t{1} << m_cBitsSlots; }
+   INLINE_ALWAYS size_t* GetKey(const size_t iSlot) const {
+      return reinterpret_cast<size_t*>(m_aSlots + m_cBytesPerSlot * iSlot);
+   }
+   INLINE_ALWAYS BinBase* GetBin(const size_t iSlot) const {
+      return reinterpret_cast<BinBase*>(m_aSlots + m_cBytesPerSlot * iSlot + sizeof(size_t));
+   }
+   INLINE_ALWAYS size_t GetHomeSlot(const size_t key) const {
+      return static_cast<size_t>((static_cast<uint64_t>(key) * k_hashMultiplier) >> (64 - m_cBitsSlots));
+   }
+
+   ErrorEbm Allocate(const size_t cBytesPerBin, const int cBitsSlots) {
+      m_cBytesPerBin = cBytesPerBin;
+      m_cBytesPerSlot = sizeof(size_t) + cBytesPerBin;
+      m_cBitsSlots = cBitsSlots;
+      m_cOccupied = 0;
+      const size_t cSlots = GetCountSlots();
+      if(IsMultiplyError(m_cBytesPerSlot, cSlots)) {
+         LOG_0(Trace_Warning, "WARNING SparseCells::Allocate IsMultiplyError(m_cBytesPerSlot, cSlots)");
+         return Error_OutOfMemory;
+      }
+      m_aSlots = static_cast<unsigned char*>(malloc(m_cBytesPerSlot * cSlots));
+      if(nullptr == m_aSlots) {
+         LOG_0(Trace_Warning, "WARNING SparseCells::Allocate nullptr == m_aSlots");
+         return Error_OutOfMemory;
+      }
+      for(size_t iSlot = 0; iSlot < cSlots; ++iSlot) {
+         *GetKey(iSlot) = k_emptyCellKey;
+      }
+      return Error_None;
+   }
+
+   ErrorEbm Grow() {
+      if(static_cast<int>(sizeof(size_t) * 8 - 2) <= m_cBitsSlots) {
+         LOG_0(Trace_Warning, "WARNING SparseCells::Grow too many cells");
+         return Error_OutOfMemory;
+      }
+      SparseCells old = *this;
+      const ErrorEbm error = Allocate(old.m_cBytesPerBin, old.m_cBitsSlots + 1);
+      if(Error_None != error) {
+         *this = old;
+         return error;
+      }
+      m_cOccupied = old.m_cOccupied;
+      const size_t cSlotsOld = old.GetCountSlots();
+      const size_t maskSlots = GetCountSlots() - size_t{1};
+      for(size_t iSlotOld = 0; iSlotOld < cSlotsOld; ++iSlotOld) {
+         const size_t key = *old.GetKey(iSlotOld);
+         if(k_emptyCellKey != key) {
+            size_t iSlot = GetHomeSlot(key);
+            while(k_emptyCellKey != *GetKey(iSlot)) {
+               iSlot = (iSlot + size_t{1}) & maskSlots;
+            }
+            memcpy(GetKey(iSlot), old.GetKey(iSlotOld), m_cBytesPerSlot);
+         }
+      }
+      free(old.m_aSlots);
+      return Error_None;
+   }
+
+   // returns the Bin of the cell, which is zeroed the first time the cell is seen, or nullptr if out of memory
+   INLINE_ALWAYS BinBase* FindOrInsert(const size_t key) {
+      EBM_ASSERT(k_emptyCellKey != key);
+      if(GetCountSlots() < (m_cOccupied + size_t{1}) * size_t{2}) {
+         if(Error_None != Grow()) {
+            return nullptr;
+         }
+      }
+      const size_t maskSlots = GetCountSlots() - size_t{1};
+      size_t iSlot = GetHomeSlot(key);
+      while(true) {
+         size_t* const pKey = GetKey(iSlot);
+         if(key == *pKey) {
+            return GetBin(iSlot);
+         }
+         if(k_emptyCellKey == *pKey) {
+            *pKey = key;
+            ++m_cOccupied;
+            BinBase* const pBin = GetBin(iSlot);
+            pBin->ZeroMem(m_cBytesPerBin);
+            return pBin;
+         }
+         iSlot = (iSlot + size_t{1}) & maskSlots;
+      }
+   }
+
+   // moves the occupied slots to the front of the table in slot order
+   void Compact() {
+      const size_t cSlots = GetCountSlots();
+      size_t iSlotTo = 0;
+      for(size_t iSlot = 0; iSlot < cSlots; ++iSlot) {
+         if(k_emptyCellKey != *GetKey(iSlot)) {
+            if(iSlotTo != iSlot) {
+               memcpy(GetKey(iSlotTo), GetKey(iSlot), m_cBytesPerSlot);
+            }
+            ++iSlotTo;
+         }
+      }
+      EBM_ASSERT(m_cOccupied == iSlotTo);
+   }
+};
+static_assert(std::is_standard_layout<SparseCells>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<SparseCells>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+template<bool bHessian> class PartitionSparseInteractionInternal final {
+ public:
+   PartitionSparseInteractionInternal() = delete; // this is a static class.  Do not construct
+
+   // decodes the bit packed features of one subset the same way as the BinSumsInteraction compute kernels, but adds
+   // each sample into its cell of pCells instead of into a dense tensor
+   template<typename TUInt, typename TFloat>
+   static ErrorEbm BinSubset(DataSubsetInteraction* const pSubset,
+         const bool bBorrowedData,
+         const size_t cDimensions,
+         const IntEbm* const featureIndexes,
+         const size_t* const acBins,
+         const size_t cScores,
+         SparseCells* const pCells) {
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      EBM_ASSERT(1 <= cSIMDPack);
+      const size_t cSamples = pSubset->GetCountSamples();
+      EBM_ASSERT(1 <= cSamples);
+      EBM_ASSERT(0 == cSamples % cSIMDPack);
+      const size_t cParallelSamples = cSamples / cSIMDPack;
+      const size_t cPackedItems = cParallelSamples + (bBorrowedData ? size_t{1} : size_t{0});
+
+      const TUInt* apData[k_cDimensionsMax];
+      int acShift[k_cDimensionsMax];
+      int acBitsPerItem[k_cDimensionsMax];
+      int acShiftReset[k_cDimensionsMax];
+      TUInt aMasks[k_cDimensionsMax];
+      size_t acStrides[k_cDimensionsMax];
+
+      size_t cStride = 1;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         const size_t iFeature = static_cast<size_t>(featureIndexes[iDimension]);
+         const int cItemsPerBitPack = pSubset->GetFeaturePack(iFeature);
+         EBM_ASSERT(1 <= cItemsPerBitPack);
+         const int cBitsPerItem = GetCountBits(cItemsPerBitPack, sizeof(TUInt));
+         EBM_ASSERT(1 <= cBitsPerItem);
+
+         apData[iDimension] = static_cast<const TUInt*>(pSubset->GetFeatureData(iFeature));
+         acBitsPerItem[iDimension] = cBitsPerItem;
+         acShiftReset[iDimension] = (cItemsPerBitPack - 1) * cBitsPerItem;
+         acShift[iDimension] =
+               static_cast<int>((cPackedItems - size_t{1}) % static_cast<size_t>(cItemsPerBitPack) + size_t{1}) *
+               cBitsPerItem;
+         aMasks[iDimension] = MakeLowMask<TUInt>(cBitsPerItem);
+         acStrides[iDimension] = cStride;
+         cStride *= acBins[iDimension];
+      }
+
+      const size_t cGradHessPerScore = bHessian ? size_t{2} : size_t{1};
+      const TFloat* pGradHess = static_cast<const TFloat*>(pSubset->GetGradHess());
+      const TFloat* pWeight = static_cast<const TFloat*>(pSubset->GetWeights());
+
+      for(size_t iParallel = 0; iParallel < cParallelSamples; ++iParallel) {
+         for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+            acShift[iDimension] -= acBitsPerItem[iDimension];
+            if(acShift[iDimension] < 0) {
+               apData[iDimension] += cSIMDPack;
+               acShift[iDimension] = acShiftReset[iDimension];
+            }
+         }
+         for(size_t iLane = 0; iLane < cSIMDPack; ++iLane) {
+            size_t key = 0;
+            for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+               const size_t iBin =
+                     static_cast<size_t>((apData[iDimension][iLane] >> acShift[iDimension]) & aMasks[iDimension]);
+               EBM_ASSERT(iBin < acBins[iDimension]);
+               key += iBin * acStrides[iDimension];
+            }
+
+            BinBase* const pBinBase = pCells->FindOrInsert(key);
+            if(nullptr == pBinBase) {
+               // already logged
+               return Error_OutOfMemory;
+            }
+            auto* const pBin = pBinBase->Specialize<FloatMain, UIntMain, true, true, bHessian>();
+            pBin->SetCountSamples(pBin->GetCountSamples() + UIntMain{1});
+            pBin->SetWeight(
+                  pBin->GetWeight() + (nullptr == pWeight ? FloatMain{1} : static_cast<FloatMain>(pWeight[iLane])));
+            auto* const aGradientPairs = pBin->GetGradientPairs();
+            // the gradients of a booster are not premultiplied by the weights like ours are
+            const FloatMain gradientWeight =
+                  bBorrowedData && nullptr != pWeight ? static_cast<FloatMain>(pWeight[iLane]) : FloatMain{1};
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               const TFloat* const pGradient = &pGradHess[iScore * cGradHessPerScore * cSIMDPack + iLane];
+               aGradientPairs[iScore].m_sumGradients += static_cast<FloatMain>(*pGradient) * gradientWeight;
+               if(bHessian) {
+                  aGradientPairs[iScore].SetHess(aGradientPairs[iScore].GetHess() +
+                        static_cast<FloatMain>(pGradient[cSIMDPack]) * gradientWeight);
+               }
+            }
+         }
+         pGradHess += cScores * cGradHessPerScore * cSIMDPack;
+         if(nullptr != pWeight) {
+            pWeight += cSIMDPack;
+         }
+      }
+      return Error_None;
+   }
+
+   INLINE_ALWAYS static void AddBin(const size_t cScores, BinBase* const pDest, const BinBase* const pSrc) {
+      pDest->Specialize<FloatMain, UIntMain, true, true, bHessian>()->Add(
+            cScores, *pSrc->Specialize<FloatMain, UIntMain, true, true, bHessian>());
+   }
+
+   // sums the children partial gains of the cut where the low side of each orthant is in aLow and the whole orthant
+   // is in aTotal.  Returns false if any of the 2^cDimensions cells is illegal
+   static bool CalcCutGain(const size_t cScores,
+         const bool bUseLogitBoost,
+         const size_t cOrthants,
+         const BinBase* const aLowBase,
+         const BinBase* const aTotalBase,
+         const size_t cSamplesLeafMin,
+         const FloatCalc hessianMin,
+         const FloatCalc regAlpha,
+         const FloatCalc regLambda,
+         const FloatCalc deltaStepMax,
+         FloatCalc* const pGainOut) {
+      const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+      FloatCalc gain = 0;
+      for(size_t iOrthant = 0; iOrthant < cOrthants; ++iOrthant) {
+         const auto* const pLow =
+               IndexBin(aLowBase, cBytesPerBin * iOrthant)->Specialize<FloatMain, UIntMain, true, true, bHessian>();
+         const auto* const pTotal =
+               IndexBin(aTotalBase, cBytesPerBin * iOrthant)->Specialize<FloatMain, UIntMain, true, true, bHessian>();
+         const UIntMain cLow = pLow->GetCountSamples();
+         const UIntMain cHigh = pTotal->GetCountSamples() - cLow;
+         if(cLow < cSamplesLeafMin || cHigh < cSamplesLeafMin) {
+            return false;
+         }
+         const FloatMain weightLow = pLow->GetWeight();
+         const FloatMain weightHigh = pTotal->GetWeight() - weightLow;
+         const auto* const aLowPairs = pLow->GetGradientPairs();
+         const auto* const aTotalPairs = pTotal->GetGradientPairs();
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            const FloatCalc gradLow = static_cast<FloatCalc>(aLowPairs[iScore].m_sumGradients);
+            const FloatCalc gradHigh =
+                  static_cast<FloatCalc>(aTotalPairs[iScore].m_sumGradients - aLowPairs[iScore].m_sumGradients);
+            FloatCalc hessLow;
+            FloatCalc hessHigh;
+            if(bUseLogitBoost) {
+               hessLow = static_cast<FloatCalc>(aLowPairs[iScore].GetHess());
+               hessHigh = static_cast<FloatCalc>(aTotalPairs[iScore].GetHess() - aLowPairs[iScore].GetHess());
+            } else {
+               hessLow = static_cast<FloatCalc>(weightLow);
+               hessHigh = static_cast<FloatCalc>(weightHigh);
+            }
+            if(hessLow < hessianMin || hessHigh < hessianMin) {
+               return false;
+            }
+            gain += CalcPartialGain<false>(gradLow, hessLow, regAlpha, regLambda, deltaStepMax);
+            gain += CalcPartialGain<false>(gradHigh, hessHigh, regAlpha, regLambda, deltaStepMax);
+         }
+      }
+      *pGainOut = gain;
+      return true;
+   }
+
+   static ErrorEbm Func(InteractionCore* const pInteractionCore,
+         const size_t cDimensions,
+         const IntEbm* const featureIndexes,
+         const size_t* const acBins,
+         const CalcInteractionFlags flags,
+         const size_t cSamplesLeafMin,
+         const FloatCalc hessianMin,
+         const FloatCalc regAlpha,
+         const FloatCalc regLambda,
+         const FloatCalc deltaStepMax,
+         double* const pGainOut) {
+      ErrorEbm error;
+
+      *pGainOut = 0.0;
+
+      EBM_ASSERT(size_t{3} <= cDimensions);
+      EBM_ASSERT(cDimensions <= k_cDimensionsMax);
+      EBM_ASSERT(std::numeric_limits<FloatCalc>::min() <= hessianMin);
+
+      const size_t cScores = pInteractionCore->GetCountScores();
+      const bool bUseLogitBoost = bHessian && !(CalcInteractionFlags_DisableNewton & flags);
+      const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+
+      // every one of the 2^cDimensions cells of a cut needs cSamplesLeafMin samples, and at least one sample to
+      // reach hessianMin
+      static_assert(k_cDimensionsMax < sizeof(size_t) * 8, "2^k_cDimensionsMax must fit in size_t");
+      const size_t cCutCells = size_t{1} << cDimensions;
+      DataSetInteraction* const pDataSet = pInteractionCore->GetDataSetInteraction();
+      if(pDataSet->GetCountSamples() / EbmMax(cSamplesLeafMin, size_t{1}) < cCutCells) {
+         LOG_0(Trace_Verbose, "PartitionSparseInteraction too few samples for every cell of a cut");
+         return Error_None;
+      }
+
+      SparseCells cells;
+      error = cells.Allocate(cBytesPerBin, k_cBitsSlotsInitial);
+      if(Error_None != error) {
+         return error;
+      }
+
+      const bool bBorrowedData = pDataSet->IsBorrowedData();
+      DataSubsetInteraction* const aSubsets = pDataSet->GetSubsets();
+      const size_t cSubsets = pDataSet->GetCountSubsets();
+      for(size_t iSubset = 0; iSubset < cSubsets; ++iSubset) {
+         DataSubsetInteraction* const pSubset = &aSubsets[iSubset];
+         const size_t cUIntBytes = pSubset->GetObjectiveWrapper()->m_cUIntBytes;
+         const size_t cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+         EBM_ASSERT(sizeof(UIntBig) == cUIntBytes || sizeof(UIntSmall) == cUIntBytes);
+         EBM_ASSERT(sizeof(FloatBig) == cFloatBytes || sizeof(FloatSmall) == cFloatBytes);
+         if(sizeof(UIntBig) == cUIntBytes) {
+            if(sizeof(FloatBig) == cFloatBytes) {
+               error = BinSubset<UIntBig, FloatBig>(
+                     pSubset, bBorrowedData, cDimensions, featureIndexes, acBins, cScores, &cells);
+            } else {
+               error = BinSubset<UIntBig, FloatSmall>(
+                     pSubset, bBorrowedData, cDimensions, featureIndexes, acBins, cScores, &cells);
+            }
+         } else {
+            if(sizeof(FloatBig) == cFloatBytes) {
+               error = BinSubset<UIntSmall, FloatBig>(
+                     pSubset, bBorrowedData, cDimensions, featureIndexes, acBins, cScores, &cells);
+            } else {
+               error = BinSubset<UIntSmall, FloatSmall>(
+                     pSubset, bBorrowedData, cDimensions, featureIndexes, acBins, cScores, &cells);
+            }
+         }
+         if(Error_None != error) {
+            free(cells.m_aSlots);
+            return error;
+         }
+      }
+
+      const size_t cCells = cells.m_cOccupied;
+      if(cCells < cCutCells) {
+         LOG_0(Trace_Verbose, "PartitionSparseInteraction too few occupied cells for every cell of a cut");
+         free(cells.m_aSlots);
+         return Error_None;
+      }
+      cells.Compact();
+
+      size_t cBinsMax = 0;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         cBinsMax = EbmMax(cBinsMax, acBins[iDimension]);
+      }
+
+      // the orthants are the 2^(cDimensions-1) combinations of sides of the cuts in all but the swept dimension.
+      // Since every cell of a cut holds an occupied cell, this is less than cCells
+      const size_t cOrthants = cCutCells >> 1;
+      EBM_ASSERT(cOrthants < cCells);
+
+      // the slot table already holds more than twice cCells slots that are each larger than a size_t, so only the
+      // per cell bin indexes and the per bin arrays can overflow
+      if(IsMultiplyError(sizeof(size_t), cCells, cDimensions) || IsAddError(cBinsMax, size_t{1}) ||
+            IsMultiplyError(EbmMax(sizeof(size_t), sizeof(UIntMain)), cBinsMax + size_t{1})) {
+         LOG_0(Trace_Warning, "WARNING PartitionSparseInteraction scratch size overflow");
+         free(cells.m_aSlots);
+         return Error_OutOfMemory;
+      }
+      const size_t cBytesOrthants = cBytesPerBin * cOrthants;
+      // the bin starts of the sweep reuse the memory of the marginal counts
+      const size_t cBytesStarts = EbmMax(sizeof(size_t), sizeof(UIntMain)) * (cBinsMax + size_t{1});
+      const size_t cBytesCellBins = sizeof(size_t) * cCells * cDimensions;
+      const size_t cBytesOrder = sizeof(size_t) * cCells;
+      if(IsAddError(cBytesOrthants, cBytesOrthants, cBytesPerBin, cBytesStarts, cBytesCellBins, cBytesOrder)) {
+         LOG_0(Trace_Warning, "WARNING PartitionSparseInteraction scratch size overflow");
+         free(cells.m_aSlots);
+         return Error_OutOfMemory;
+      }
+      // the bins go first to keep their alignment
+      unsigned char* const pScratch = static_cast<unsigned char*>(
+            malloc(cBytesOrthants + cBytesOrthants + cBytesPerBin + cBytesStarts + cBytesCellBins + cBytesOrder));
+      if(nullptr == pScratch) {
+         LOG_0(Trace_Warning, "WARNING PartitionSparseInteraction nullptr == pScratch");
+         free(cells.m_aSlots);
+         return Error_OutOfMemory;
+      }
+      BinBase* const aLow = reinterpret_cast<BinBase*>(pScratch);
+      BinBase* const aTotal = reinterpret_cast<BinBase*>(pScratch + cBytesOrthants);
+      BinBase* const pParentBase = reinterpret_cast<BinBase*>(pScratch + cBytesOrthants + cBytesOrthants);
+      auto* const pParent = pParentBase->Specialize<FloatMain, UIntMain, true, true, bHessian>();
+      unsigned char* const pStarts = pScratch + cBytesOrthants + cBytesOrthants + cBytesPerBin;
+      size_t* const aStarts = reinterpret_cast<size_t*>(pStarts);
+      UIntMain* const aMarginalCounts = reinterpret_cast<UIntMain*>(pStarts);
+      size_t* const aCellBins = reinterpret_cast<size_t*>(pStarts + cBytesStarts);
+      size_t* const aOrder = aCellBins + cCells * cDimensions;
+
+      pParentBase->ZeroMem(cBytesPerBin);
+      for(size_t iCell = 0; iCell < cCells; ++iCell) {
+         size_t key = *cells.GetKey(iCell);
+         for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+            aCellBins[iCell * cDimensions + iDimension] = key % acBins[iDimension];
+            key /= acBins[iDimension];
+         }
+         AddBin(cScores, pParentBase, cells.GetBin(iCell));
+      }
+
+      // start each cut at the median of its marginal sample counts
+      size_t aiCuts[k_cDimensionsMax];
+      const UIntMain cSamplesTotal = pParent->GetCountSamples();
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         const size_t cBins = acBins[iDimension];
+         EBM_ASSERT(size_t{2} <= cBins);
+         for(size_t iBin = 0; iBin < cBins; ++iBin) {
+            aMarginalCounts[iBin] = 0;
+         }
+         for(size_t iCell = 0; iCell < cCells; ++iCell) {
+            aMarginalCounts[aCellBins[iCell * cDimensions + iDimension]] +=
+                  cells.GetBin(iCell)->Specialize<FloatMain, UIntMain, true, true, bHessian>()->GetCountSamples();
+         }
+         size_t iCut = 0;
+         UIntMain cLow = aMarginalCounts[0];
+         while(iCut < cBins - size_t{2} && cLow < cSamplesTotal - cLow) {
+            ++iCut;
+            cLow += aMarginalCounts[iCut];
+         }
+         aiCuts[iDimension] = iCut;
+      }
+
+      bool bAnyLegal = false;
+      // if a negative value were to occur, then it would be due to numeric instability, so clip it to zero here
+      FloatCalc bestGain = 0;
+
+      for(size_t iRound = 0; iRound < k_cRoundsMax; ++iRound) {
+         bool bMoved = false;
+         for(size_t iDimensionSweep = 0; iDimensionSweep < cDimensions; ++iDimensionSweep) {
+            const size_t cBins = acBins[iDimensionSweep];
+
+            // counting sort the cells by their bin in the swept dimension
+            for(size_t iBin = 0; iBin <= cBins; ++iBin) {
+               aStarts[iBin] = 0;
+            }
+            for(size_t iCell = 0; iCell < cCells; ++iCell) {
+               ++aStarts[aCellBins[iCell * cDimensions + iDimensionSweep] + size_t{1}];
+            }
+            for(size_t iBin = 0; iBin < cBins; ++iBin) {
+               aStarts[iBin + size_t{1}] += aStarts[iBin];
+            }
+            for(size_t iCell = 0; iCell < cCells; ++iCell) {
+               aOrder[aStarts[aCellBins[iCell * cDimensions + iDimensionSweep]]++] = iCell;
+            }
+            // the increments above moved each start to the start of the next bin
+            for(size_t iBin = cBins; size_t{0} != iBin; --iBin) {
+               aStarts[iBin] = aStarts[iBin - size_t{1}];
+            }
+            aStarts[0] = 0;
+
+            auto getOrthant = [&](const size_t iCell) {
+               const size_t* const aiBins = &aCellBins[iCell * cDimensions];
+               size_t iOrthant = 0;
+               size_t iBit = 0;
+               for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+                  if(iDimensionSweep != iDimension) {
+                     iOrthant |= (aiCuts[iDimension] < aiBins[iDimension] ? size_t{1} : size_t{0}) << iBit;
+                     ++iBit;
+                  }
+               }
+               return iOrthant;
+            };
+
+            aLow->ZeroMem(cBytesPerBin, cOrthants);
+            aTotal->ZeroMem(cBytesPerBin, cOrthants);
+            for(size_t iCell = 0; iCell < cCells; ++iCell) {
+               AddBin(cScores, IndexBin(aTotal, cBytesPerBin * getOrthant(iCell)), cells.GetBin(iCell));
+            }
+
+            bool bFound = false;
+            size_t iCutBest = aiCuts[iDimensionSweep];
+            FloatCalc gainBest = 0;
+            bool bCurrentLegal = false;
+            FloatCalc gainCurrent = 0;
+            for(size_t iCut = 0; iCut < cBins - size_t{1}; ++iCut) {
+               for(size_t iOrder = aStarts[iCut]; iOrder < aStarts[iCut + size_t{1}]; ++iOrder) {
+                  const size_t iCell = aOrder[iOrder];
+                  AddBin(cScores, IndexBin(aLow, cBytesPerBin * getOrthant(iCell)), cells.GetBin(iCell));
+               }
+               if(size_t{0} != iCut && aStarts[iCut] == aStarts[iCut + size_t{1}] &&
+                     aiCuts[iDimensionSweep] != iCut) {
+                  // no cell moved to the low side, so this cut groups the samples the same as the previous one
+                  continue;
+               }
+               FloatCalc gain;
+               if(CalcCutGain(cScores,
+                        bUseLogitBoost,
+                        cOrthants,
+                        aLow,
+                        aTotal,
+                        cSamplesLeafMin,
+                        hessianMin,
+                        regAlpha,
+                        regLambda,
+                        deltaStepMax,
+                        &gain)) {
+                  if(aiCuts[iDimensionSweep] == iCut) {
+                     bCurrentLegal = true;
+                     gainCurrent = gain;
+                  }
+                  // flip the comparison so that a NaN gain is kept
+                  if(!bFound || UNLIKELY(/* NaN */ !LIKELY(gain <= gainBest))) {
+                     bFound = true;
+                     gainBest = gain;
+                     iCutBest = iCut;
+                  }
+               }
+            }
+
+            if(bFound) {
+               if(bCurrentLegal && !(gainCurrent < gainBest)) {
+                  // stay put on ties so that the ascent cannot cycle between equal cuts
+                  iCutBest = aiCuts[iDimensionSweep];
+                  gainBest = gainCurrent;
+               }
+               if(aiCuts[iDimensionSweep] != iCutBest) {
+                  aiCuts[iDimensionSweep] = iCutBest;
+                  bMoved = true;
+               }
+               if(!bAnyLegal || UNLIKELY(/* NaN */ !LIKELY(gainBest <= bestGain))) {
+                  bestGain = gainBest;
+               }
+               bAnyLegal = true;
+            }
+         }
+         if(!bMoved) {
+            break;
+         }
+      }
+
+      if(bAnyLegal && FloatCalc{0} < bestGain) {
+         // the separable cut gain so far is only the children partial gain, so subtract the partial gain of not
+         // cutting the term at all
+         const FloatMain weightAll = pParent->GetWeight();
+         const auto* const aGradientPairs = pParent->GetGradientPairs();
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            const FloatCalc hess =
+                  static_cast<FloatCalc>(bUseLogitBoost ? aGradientPairs[iScore].GetHess() : weightAll);
+            bestGain -= CalcPartialGain<false>(static_cast<FloatCalc>(aGradientPairs[iScore].m_sumGradients),
+                  hess,
+                  regAlpha,
+                  regLambda,
+                  deltaStepMax);
+         }
+      } else if(!bAnyLegal) {
+         bestGain = 0;
+      }
+
+      free(pScratch);
+      free(cells.m_aSlots);
+
+      // we clean up bestGain in the caller
+      *pGainOut = static_cast<double>(bestGain);
+      return Error_None;
+   }
+};
+
+// Scores a term of 3 or more features by the best separable cut, which cuts each feature once so that the term splits
+// into 2^cDimensions cells.  The cuts are found by coordinate ascent from the marginal medians, sweeping one feature at
+// a time with the others held fixed, so the gain is a lower bound on the best separable cut.  Memory is bounded by the
+// number of occupied tensor cells instead of the product of the bin counts.  pGainOut receives the impure gain in the
+// units of the main bins, or 0 if no legal cut was found
+extern ErrorEbm PartitionSparseInteraction(InteractionCore* const pInteractionCore,
+      const size_t cDimensions,
+      const IntEbm* const featureIndexes,
+      const size_t* const acBins,
+      const CalcInteractionFlags flags,
+      const size_t cSamplesLeafMin,
+      const FloatCalc hessianMin,
+      const FloatCalc regAlpha,
+      const FloatCalc regLambda,
+      const FloatCalc deltaStepMax,
+      double* const pGainOut) {
+   EBM_ASSERT(!(CalcInteractionFlags_Purify & flags));
+   if(pInteractionCore->IsHessian()) {
+      return PartitionSparseInteractionInternal<true>::Func(pInteractionCore,
+            cDimensions,
+            featureIndexes,
+            acBins,
+            flags,
+            cSamplesLeafMin,
+            hessianMin,
+            regAlpha,
+            regLambda,
+            deltaStepMax,
+            pGainOut);
+   } else {
+      return PartitionSparseInteractionInternal<false>::Func(pInteractionCore,
+            cDimensions,
+            featureIndexes,
+            acBins,
+            flags,
+            cSamplesLeafMin,
+            hessianMin,
+            regAlpha,
+            regLambda,
+            deltaStepMax,
+            pGainOut);
+   }
+}
+
+} // namespace DEFINED_ZONE_NAME
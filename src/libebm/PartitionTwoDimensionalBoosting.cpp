@@ -22,6 +22,7 @@
 #include "Tensor.hpp"
 #include "TensorTotalsSum.hpp"
 #include "TreeNode.hpp"
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -38,7 +39,8 @@ extern ErrorEbm PurifyInternal(const double tolerance,
       const double* const aWeights,
       double* const pScores,
       double* const pImpurities,
-      double* const pIntercept);
+      double* const pIntercept,
+      size_t* const pcSweeps);
 
 template<bool bHessian, size_t cCompilerScores, size_t cCompilerDimensions>
 INLINE_RELEASE_TEMPLATED static ErrorEbm MakeTensor(const size_t cRuntimeScores,
@@ -266,7 +268,7 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
 
    WARNING_PUSH
    WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
-   INLINE_RELEASE_UNTEMPLATED static ErrorEbm Func(const size_t cRuntimeScores,
+   INLINE_RELEASE_UNTEMPLATED static ErrorEbm Sweep(const size_t cScores,
          const size_t cDimensions,
          const size_t cRealDimensions,
          const TermBoostFlags flags,
@@ -275,20 +277,23 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
          const FloatCalc regAlpha,
          const FloatCalc regLambda,
          const FloatCalc deltaStepMax,
-         const BinBase* const aBinsBase,
-         BinBase* const aAuxiliaryBinsBase,
+         const Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>* const aBins,
+         Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>* const aAuxiliaryBins,
          Tensor* const pInnerTermUpdate,
-         void* const pRootTreeNodeBase,
-         const size_t* const acBins,
+         TreeNodeMulti<bHessian, GetArrayScores(cCompilerScores)>* const pBestTreeNode,
+         const size_t* const aiOriginalIndex,
+         const TensorSumDimension* const aDimensionsInit,
          double* const aTensorWeights,
          double* const aTensorGrad,
          double* const aTensorHess,
-         double* const pTotalGain,
          const size_t cPossibleSplits,
-         unsigned char** const aaSplits
+         unsigned char** const aaSplits,
+         const size_t iTask,
+         const size_t cTasks,
+         SweepResult* const pResult
 #ifndef NDEBUG
          ,
-         const BinBase* const aDebugCopyBinsBase,
+         const Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>* const aDebugCopyBins,
          const BinBase* const pBinsEndDebug
 #endif // NDEBUG
    ) {
@@ -296,85 +301,57 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
 
       ErrorEbm error;
 
-      auto* const aBins =
-            aBinsBase->Specialize<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>();
-
-      const size_t cScores = GET_COUNT_SCORES(cCompilerScores, cRuntimeScores);
-      const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
       const size_t cBytesTreeNodeMulti = GetTreeNodeMultiSize(bHessian, cScores);
 
-      auto* const pRootTreeNode =
-            reinterpret_cast<TreeNodeMulti<bHessian, GetArrayScores(cCompilerScores)>*>(pRootTreeNodeBase);
-
-      // each dimension requires 2 tree nodes, plus one for the last
+      // each dimension requires 2 tree nodes, plus one for the last. The tree that we are currently evaluating
+      // is kept directly after the best tree that this task has found so far
       const size_t cBytesBest = cBytesTreeNodeMulti * (size_t{1} + (cRealDimensions << 1));
-      auto* const pDeepTreeNode = IndexTreeNodeMulti(pRootTreeNode, cBytesBest);
+      auto* const pDeepTreeNode = IndexTreeNodeMulti(pBestTreeNode, cBytesBest);
 
       auto* const pLastTreeNode = IndexTreeNodeMulti(pDeepTreeNode, cBytesBest - (cBytesTreeNodeMulti << 1));
       auto* const pLastSplitTreeNode = NegativeIndexByte(pLastTreeNode, cBytesTreeNodeMulti);
 
       const bool bUseLogitBoost = bHessian && !(TermBoostFlags_DisableNewtonGain & flags);
 
-      auto* const aAuxiliaryBins =
-            aAuxiliaryBinsBase
-                  ->Specialize<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>();
-
       TensorSumDimension
             aDimensions[k_dynamicDimensions == cCompilerDimensions ? k_cDimensionsMax : cCompilerDimensions];
-
-#ifndef NDEBUG
-      const auto* const aDebugCopyBins =
-            aDebugCopyBinsBase
-                  ->Specialize<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>();
-#endif // NDEBUG
+      memcpy(aDimensions, aDimensionsInit, sizeof(aDimensions[0]) * cRealDimensions);
 
       TreeNodeMulti<bHessian, GetArrayScores(cCompilerScores)>* pParentTreeNode = nullptr;
       auto* pTreeNode = pDeepTreeNode;
       auto* pHigh = IndexTreeNodeMulti(pTreeNode, cBytesTreeNodeMulti);
-      EBM_ASSERT(1 <= cRealDimensions);
 
-      size_t iDimensionLoop = 0;
-      size_t iDimInit = 0;
-      size_t aiOriginalIndex[k_dynamicDimensions == cCompilerDimensions ? k_cDimensionsMax : cCompilerDimensions];
 #ifndef NDEBUG
       size_t aiDEBUGDim[k_dynamicDimensions == cCompilerDimensions ? k_cDimensionsMax : cCompilerDimensions];
 #endif // NDEBUG
+      size_t iDimInit = 0;
       EBM_ASSERT(1 <= cRealDimensions);
       do {
-         EBM_ASSERT(iDimensionLoop < cDimensions);
-         const size_t cBins = acBins[iDimensionLoop];
-         EBM_ASSERT(size_t{1} <= cBins); // we don't boost on empty training sets
-         if(size_t{1} < cBins) {
-            aiOriginalIndex[iDimInit] = iDimensionLoop;
-            aDimensions[iDimInit].m_cBins = cBins;
-
 #ifndef NDEBUG
-            aiDEBUGDim[iDimInit] = cRealDimensions - 1 - iDimInit;
+         aiDEBUGDim[iDimInit] = cRealDimensions - 1 - iDimInit;
 #endif // NDEBUG
 
-            pTreeNode->SplitNode();
-            pTreeNode->SetSplitIndex(0);
-            pTreeNode->SetDimensionIndex(cRealDimensions - size_t{1} - iDimInit);
-            pTreeNode->SetParent(pParentTreeNode);
-            pTreeNode->SetChildren(pHigh);
-
-            pParentTreeNode = pTreeNode;
-            pTreeNode = IndexTreeNodeMulti(pHigh, cBytesTreeNodeMulti);
-            auto* const pNextHigh = IndexTreeNodeMulti(pTreeNode, cBytesTreeNodeMulti);
-            ++iDimInit;
-
-            // High child Node
-            pHigh->SetSplitGain(0.0);
-            pHigh->SetSplitIndex(0);
-            pHigh->SetDimensionIndex(cRealDimensions - size_t{1} - iDimInit);
-            pHigh->SetParent(pParentTreeNode);
-            // set both high and low nodes to point to the same children. It isn't valid
-            // if the node isn't split but this avoids having to continually swap them
-            pHigh->SetChildren(pNextHigh);
-
-            pHigh = pNextHigh;
-         }
-         ++iDimensionLoop;
+         pTreeNode->SplitNode();
+         pTreeNode->SetSplitIndex(0);
+         pTreeNode->SetDimensionIndex(cRealDimensions - size_t{1} - iDimInit);
+         pTreeNode->SetParent(pParentTreeNode);
+         pTreeNode->SetChildren(pHigh);
+
+         pParentTreeNode = pTreeNode;
+         pTreeNode = IndexTreeNodeMulti(pHigh, cBytesTreeNodeMulti);
+         auto* const pNextHigh = IndexTreeNodeMulti(pTreeNode, cBytesTreeNodeMulti);
+         ++iDimInit;
+
+         // High child Node
+         pHigh->SetSplitGain(0.0);
+         pHigh->SetSplitIndex(0);
+         pHigh->SetDimensionIndex(cRealDimensions - size_t{1} - iDimInit);
+         pHigh->SetParent(pParentTreeNode);
+         // set both high and low nodes to point to the same children. It isn't valid
+         // if the node isn't split but this avoids having to continually swap them
+         pHigh->SetChildren(pNextHigh);
+
+         pHigh = pNextHigh;
       } while(cRealDimensions != iDimInit);
 
       // Low child node
@@ -386,6 +363,9 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
       // number we can calculate the minimum gain we need to reach k_gainMin after the cuts are made
       // which will allow us to avoid some work when the eventual gain will be less than our minimum
       FloatCalc bestGain = -std::numeric_limits<double>::infinity(); // do not allow bad cuts that lead to negative gain
+      size_t iShape = 0;
+      size_t iBestShape = 0;
+      size_t iBestRootSplit = 0;
 
       EBM_ASSERT(std::numeric_limits<FloatCalc>::min() <= hessianMin);
 
@@ -428,6 +408,11 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
          }
 
          while(true) {
+            // each task sweeps the root cuts iTask, iTask + cTasks, iTask + 2 * cTasks, ... of every tree shape
+            EBM_ASSERT(0 == pDeepTreeNode->GetSplitIndex());
+            EBM_ASSERT(iTask < aDimensions[pDeepTreeNode->GetDimensionIndex()].m_cBins - size_t{1});
+            pDeepTreeNode->SetSplitIndex(iTask);
+
             while(true) {
                EBM_ASSERT(1 <= cRealDimensions);
                TensorSumDimension* pDimension = aDimensions;
@@ -651,6 +636,7 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
                            aTensorWeights,
                            pScores,
                            nullptr,
+                           nullptr,
                            nullptr);
                      ++pScores;
                   } while(pScoreMulticlassEnd != pScores);
@@ -681,7 +667,9 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
                if(UNLIKELY(/* NaN */ !LIKELY(gain <= bestGain))) {
                   // propagate NaNs
                   bestGain = gain;
-                  memcpy(pRootTreeNode, pDeepTreeNode, cBytesBest);
+                  iBestShape = iShape;
+                  iBestRootSplit = pDeepTreeNode->GetSplitIndex();
+                  memcpy(pBestTreeNode, pDeepTreeNode, cBytesBest);
                } else {
                   EBM_ASSERT(!std::isnan(gain));
                }
@@ -694,12 +682,12 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
                while(true) {
                   EBM_ASSERT(pTreeNode->IsSplit());
                   const size_t iTreeDim = pTreeNode->GetDimensionIndex();
-                  const size_t iSplit = pTreeNode->GetSplitIndex() + 1;
+                  const size_t cStep = nullptr == pTreeNode->GetParent() ? cTasks : size_t{1};
+                  const size_t iSplit = pTreeNode->GetSplitIndex() + cStep;
                   const size_t cBinsMinusOne = aDimensions[iTreeDim].m_cBins - 1;
                   EBM_ASSERT(1 <= cBinsMinusOne);
-                  EBM_ASSERT(iSplit <= cBinsMinusOne);
-                  pTreeNode->SetSplitIndex(iSplit);
-                  if(iSplit != cBinsMinusOne) {
+                  if(iSplit < cBinsMinusOne) {
+                     pTreeNode->SetSplitIndex(iSplit);
                      break;
                   }
                   pTreeNode->SetSplitIndex(0);
@@ -710,6 +698,7 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
                }
             }
          next_tree:;
+            ++iShape;
 
             EBM_ASSERT(!pLastTreeNode->IsSplit());
             pTreeNode = pLastTreeNode->GetParent();
@@ -813,6 +802,166 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
       }
    done:;
 
+      pResult->m_bestGain = bestGain;
+      pResult->m_iShape = iBestShape;
+      pResult->m_iRootSplit = iBestRootSplit;
+      return Error_None;
+   }
+   WARNING_POP
+
+   WARNING_PUSH
+   WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
+   INLINE_RELEASE_UNTEMPLATED static ErrorEbm Func(const size_t cRuntimeScores,
+         const size_t cDimensions,
+         const size_t cRealDimensions,
+         const TermBoostFlags flags,
+         const size_t cSamplesLeafMin,
+         const FloatCalc hessianMin,
+         const FloatCalc regAlpha,
+         const FloatCalc regLambda,
+         const FloatCalc deltaStepMax,
+         const BinBase* const aBinsBase,
+         BinBase* const aAuxiliaryBinsBase,
+         Tensor* const pInnerTermUpdate,
+         void* const pRootTreeNodeBase,
+         const size_t* const acBins,
+         double* const aTensorWeights,
+         double* const aTensorGrad,
+         double* const aTensorHess,
+         double* const pTotalGain,
+         const size_t cPossibleSplits,
+         unsigned char** const aaSplits,
+         ThreadPool* const pThreadPool,
+         const size_t cTasks
+#ifndef NDEBUG
+         ,
+         const BinBase* const aDebugCopyBinsBase,
+         const BinBase* const pBinsEndDebug
+#endif // NDEBUG
+   ) {
+      static constexpr size_t cCompilerDimensions = k_dynamicDimensions;
+
+      ErrorEbm error;
+
+      auto* const aBins =
+            aBinsBase->Specialize<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>();
+
+      const size_t cScores = GET_COUNT_SCORES(cCompilerScores, cRuntimeScores);
+      const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+      const size_t cBytesTreeNodeMulti = GetTreeNodeMultiSize(bHessian, cScores);
+
+      auto* const pRootTreeNode =
+            reinterpret_cast<TreeNodeMulti<bHessian, GetArrayScores(cCompilerScores)>*>(pRootTreeNodeBase);
+
+      // each dimension requires 2 tree nodes, plus one for the last
+      const size_t cBytesBest = cBytesTreeNodeMulti * (size_t{1} + (cRealDimensions << 1));
+      auto* const pDeepTreeNode = IndexTreeNodeMulti(pRootTreeNode, cBytesBest);
+
+      const bool bUseLogitBoost = bHessian && !(TermBoostFlags_DisableNewtonGain & flags);
+
+      auto* const aAuxiliaryBins =
+            aAuxiliaryBinsBase
+                  ->Specialize<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>();
+
+      TensorSumDimension
+            aDimensions[k_dynamicDimensions == cCompilerDimensions ? k_cDimensionsMax : cCompilerDimensions];
+
+#ifndef NDEBUG
+      const auto* const aDebugCopyBins =
+            aDebugCopyBinsBase
+                  ->Specialize<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>();
+#endif // NDEBUG
+
+      EBM_ASSERT(1 <= cRealDimensions);
+
+      size_t iDimensionLoop = 0;
+      size_t iDimInit = 0;
+      size_t aiOriginalIndex[k_dynamicDimensions == cCompilerDimensions ? k_cDimensionsMax : cCompilerDimensions];
+      do {
+         EBM_ASSERT(iDimensionLoop < cDimensions);
+         const size_t cBins = acBins[iDimensionLoop];
+         EBM_ASSERT(size_t{1} <= cBins); // we don't boost on empty training sets
+         if(size_t{1} < cBins) {
+            // every task needs at least one root cut in each tree shape
+            EBM_ASSERT(cTasks < cBins);
+            aiOriginalIndex[iDimInit] = iDimensionLoop;
+            aDimensions[iDimInit].m_cBins = cBins;
+            ++iDimInit;
+         }
+         ++iDimensionLoop;
+      } while(cRealDimensions != iDimInit);
+
+      // Each task gets its own best and current trees, one after the other, and the task results follow them.
+      // MakeTensor writes to shared buffers, so purified gain is always swept by a single task.
+      EBM_ASSERT(1 <= cTasks);
+      EBM_ASSERT(size_t{1} == cTasks || 0 == (TermBoostFlags_PurifyGain & flags));
+      EBM_ASSERT(size_t{1} == cTasks || nullptr != pThreadPool);
+      SweepResult* const aResults =
+            reinterpret_cast<SweepResult*>(IndexTreeNodeMulti(pRootTreeNode, (cBytesBest << 1) * cTasks));
+
+      auto sweepTask = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+         UNUSED(iThread);
+         return Sweep(cScores,
+               cDimensions,
+               cRealDimensions,
+               flags,
+               cSamplesLeafMin,
+               hessianMin,
+               regAlpha,
+               regLambda,
+               deltaStepMax,
+               aBins,
+               aAuxiliaryBins,
+               pInnerTermUpdate,
+               IndexTreeNodeMulti(pRootTreeNode, (cBytesBest << 1) * iTask),
+               aiOriginalIndex,
+               aDimensions,
+               aTensorWeights,
+               aTensorGrad,
+               aTensorHess,
+               cPossibleSplits,
+               aaSplits,
+               iTask,
+               cTasks,
+               &aResults[iTask]
+#ifndef NDEBUG
+               ,
+               aDebugCopyBins,
+               pBinsEndDebug
+#endif // NDEBUG
+         );
+      };
+      if(size_t{1} == cTasks) {
+         error = sweepTask(0, 0);
+      } else {
+         error = pThreadPool->Run(cTasks, sweepTask);
+      }
+      if(Error_None != error) {
+         return error;
+      }
+
+      // For equal gains keep the tree that the serial sweep would have reached first, which is the one with the
+      // lowest shape number and then the lowest root cut. This makes the result independent of cTasks.
+      // NaN gains win so that the overflow is reported to our caller.
+      size_t iTaskBest = 0;
+      for(size_t iTask = 1; iTask < cTasks; ++iTask) {
+         const SweepResult* const pResult = &aResults[iTask];
+         const SweepResult* const pBest = &aResults[iTaskBest];
+         const bool bEarlier = pResult->m_iShape < pBest->m_iShape ||
+               (pResult->m_iShape == pBest->m_iShape && pResult->m_iRootSplit < pBest->m_iRootSplit);
+         if(std::isnan(pBest->m_bestGain)) {
+            if(!std::isnan(pResult->m_bestGain) || !bEarlier) {
+               continue;
+            }
+         } else if(!std::isnan(pResult->m_bestGain)) {
+            if(pResult->m_bestGain < pBest->m_bestGain || (pResult->m_bestGain == pBest->m_bestGain && !bEarlier)) {
+               continue;
+            }
+         }
+         iTaskBest = iTask;
+      }
+      FloatCalc bestGain = aResults[iTaskBest].m_bestGain;
+
       EBM_ASSERT(std::isnan(bestGain) || k_illegalGainFloat == bestGain || FloatCalc{0} <= bestGain);
 
       // the bin before the aAuxiliaryBins is the last summation bin of aBinsBase,
@@ -878,12 +1027,19 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
                if(LIKELY(k_gainMin <= bestGain)) {
                   *pTotalGain = static_cast<double>(bestGain);
 
+                  // the best tree of the winning task points into the current tree of that task
+                  auto* const pBestTreeNode = IndexTreeNodeMulti(pRootTreeNode, (cBytesBest << 1) * iTaskBest);
+                  if(pRootTreeNode != pBestTreeNode) {
+                     memcpy(pRootTreeNode, pBestTreeNode, cBytesBest);
+                  }
+                  auto* const pBestDeepTreeNode = IndexTreeNodeMulti(pBestTreeNode, cBytesBest);
+
                   auto* pCurTreeNode = pRootTreeNode;
                   EBM_ASSERT(nullptr == pCurTreeNode->GetParent());
                   while(true) {
                      EBM_ASSERT(nullptr != pCurTreeNode->GetChildren());
                      const size_t cBytesOffset1 = reinterpret_cast<char*>(pCurTreeNode->GetChildren()) -
-                           reinterpret_cast<char*>(pDeepTreeNode);
+                           reinterpret_cast<char*>(pBestDeepTreeNode);
                      TreeNodeMulti<bHessian, GetArrayScores(cCompilerScores)>* const pNode1 =
                            IndexTreeNodeMulti(pRootTreeNode, cBytesOffset1);
                      pCurTreeNode->SetChildren(pNode1);
@@ -894,8 +1050,8 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalBoo
                      }
 
                      EBM_ASSERT(nullptr != pCurTreeNode->GetParent());
-                     const size_t cBytesOffset2 =
-                           reinterpret_cast<char*>(pCurTreeNode->GetParent()) - reinterpret_cast<char*>(pDeepTreeNode);
+                     const size_t cBytesOffset2 = reinterpret_cast<char*>(pCurTreeNode->GetParent()) -
+                           reinterpret_cast<char*>(pBestDeepTreeNode);
                      TreeNodeMulti<bHessian, GetArrayScores(cCompilerScores)>* const pNode2 =
                            IndexTreeNodeMulti(pRootTreeNode, cBytesOffset2);
                      pCurTreeNode->SetParent(pNode2);
@@ -1007,7 +1163,9 @@ template<bool bHessian, size_t cPossibleScores> class PartitionTwoDimensionalBoo
          double* const aTensorHess,
          double* const pTotalGain,
          const size_t cPossibleSplits,
-         unsigned char** const aaSplits
+         unsigned char** const aaSplits,
+         ThreadPool* const pThreadPool,
+         const size_t cTasks
 #ifndef NDEBUG
          ,
          const BinBase* const aDebugCopyBinsBase,
@@ -1034,7 +1192,9 @@ template<bool bHessian, size_t cPossibleScores> class PartitionTwoDimensionalBoo
                aTensorHess,
                pTotalGain,
                cPossibleSplits,
-               aaSplits
+               aaSplits,
+               pThreadPool,
+               cTasks
 #ifndef NDEBUG
                ,
                aDebugCopyBinsBase,
@@ -1061,7 +1221,9 @@ template<bool bHessian, size_t cPossibleScores> class PartitionTwoDimensionalBoo
                aTensorHess,
                pTotalGain,
                cPossibleSplits,
-               aaSplits
+               aaSplits,
+               pThreadPool,
+               cTasks
 #ifndef NDEBUG
                ,
                aDebugCopyBinsBase,
@@ -1095,7 +1257,9 @@ template<bool bHessian> class PartitionTwoDimensionalBoostingTarget<bHessian, k_
          double* const aTensorHess,
          double* const pTotalGain,
          const size_t cPossibleSplits,
-         unsigned char** const aaSplits
+         unsigned char** const aaSplits,
+         ThreadPool* const pThreadPool,
+         const size_t cTasks
 #ifndef NDEBUG
          ,
          const BinBase* const aDebugCopyBinsBase,
@@ -1121,7 +1285,9 @@ template<bool bHessian> class PartitionTwoDimensionalBoostingTarget<bHessian, k_
             aTensorHess,
             pTotalGain,
             cPossibleSplits,
-            aaSplits
+            aaSplits,
+            pThreadPool,
+            cTasks
 #ifndef NDEBUG
             ,
             aDebugCopyBinsBase,
@@ -1151,7 +1317,9 @@ extern ErrorEbm PartitionTwoDimensionalBoosting(const bool bHessian,
       double* const aTensorHess,
       double* const pTotalGain,
       const size_t cPossibleSplits,
-      void* const pTemp1
+      void* const pTemp1,
+      ThreadPool* const pThreadPool,
+      const size_t cTasks
 #ifndef NDEBUG
       ,
       const BinBase* const aDebugCopyBinsBase,
@@ -1199,7 +1367,9 @@ extern ErrorEbm PartitionTwoDimensionalBoosting(const bool bHessian,
                aTensorHess,
                pTotalGain,
                cPossibleSplits,
-               aaSplits
+               aaSplits,
+               pThreadPool,
+               cTasks
 #ifndef NDEBUG
                ,
                aDebugCopyBinsBase,
@@ -1226,7 +1396,9 @@ extern ErrorEbm PartitionTwoDimensionalBoosting(const bool bHessian,
                aTensorHess,
                pTotalGain,
                cPossibleSplits,
-               aaSplits
+               aaSplits,
+               pThreadPool,
+               cTasks
 #ifndef NDEBUG
                ,
                aDebugCopyBinsBase,
@@ -1256,7 +1428,9 @@ extern ErrorEbm PartitionTwoDimensionalBoosting(const bool bHessian,
                aTensorHess,
                pTotalGain,
                cPossibleSplits,
-               aaSplits
+               aaSplits,
+               pThreadPool,
+               cTasks
 #ifndef NDEBUG
                ,
                aDebugCopyBinsBase,
@@ -1283,7 +1457,9 @@ extern ErrorEbm PartitionTwoDimensionalBoosting(const bool bHessian,
                aTensorHess,
                pTotalGain,
                cPossibleSplits,
-               aaSplits
+               aaSplits,
+               pThreadPool,
+               cTasks
 #ifndef NDEBUG
                ,
                aDebugCopyBinsBase,
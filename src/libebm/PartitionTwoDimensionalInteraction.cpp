@@ -17,7 +17,6 @@
 
 #include "ebm_internal.hpp"
 #include "ebm_stats.hpp"
-#include "TensorTotalsSum.hpp"
 #include "InteractionCore.hpp"
 
 namespace DEFINED_ZONE_NAME {
@@ -26,6 +25,101 @@ namespace DEFINED_ZONE_NAME {
 #endif // DEFINED_ZONE_NAME
 
 template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalInteractionInternal final {
+   // copies the prefix sums for the cuts of dimension 1 that start at pBin into contiguous rows, so that neighbouring
+   // cuts can be evaluated together
+   INLINE_ALWAYS static void GatherRow(const size_t cScores,
+         const size_t cCuts,
+         const size_t cBytesStride,
+         const Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>* const pBinStart,
+         UIntMain* const aCounts,
+         FloatMain* const aWeights,
+         FloatMain* const aGradients,
+         FloatMain* const aHessians
+#ifndef NDEBUG
+         ,
+         const BinBase* const pBinsEndDebug
+#endif // NDEBUG
+   ) {
+      const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+      UNUSED(cBytesPerBin); // only the debug bin checks use it
+      const auto* pBin = pBinStart;
+      size_t iCut = 0;
+      do {
+         ASSERT_BIN_OK(cBytesPerBin, pBin, pBinsEndDebug);
+         aCounts[iCut] = pBin->GetCountSamples();
+         aWeights[iCut] = pBin->GetWeight();
+         const auto* const aGradientPairs = pBin->GetGradientPairs();
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            aGradients[iScore * cCuts + iCut] = aGradientPairs[iScore].m_sumGradients;
+            if(bHessian) {
+               aHessians[iScore * cCuts + iCut] = aGradientPairs[iScore].GetHess();
+            }
+         }
+         pBin = IndexBin(pBin, cBytesStride);
+         ++iCut;
+      } while(cCuts != iCut);
+   }
+
+   // adds the unpurified partial gains of one score for every cut of dimension 1 into aGains, and clears aLegal for
+   // the cuts where a quadrant's hessian is below hessianMin.  Those quadrants are computed with hessianMin instead
+   // so that this loop has no branches
+   template<bool bUnclipped>
+   INLINE_ALWAYS static void SweepImpure(const size_t cCuts,
+         const FloatMain* const aGradientLow,
+         const FloatMain* const aGradientHigh,
+         const FloatMain gradLowEnd,
+         const FloatMain gradTotal,
+         const FloatMain* const aHessianLow,
+         const FloatMain* const aHessianHigh,
+         const FloatMain hessLowEnd,
+         const FloatMain hessTotal,
+         const FloatCalc hessianMin,
+         const FloatCalc regAlpha,
+         const FloatCalc regLambda,
+         const FloatCalc deltaStepMax,
+         FloatCalc* const aGains,
+         FloatCalc* const aLegal) {
+      size_t iCut = 0;
+      do {
+         const FloatCalc grad00 = static_cast<FloatCalc>(aGradientLow[iCut]);
+         const FloatCalc grad01 = static_cast<FloatCalc>(aGradientHigh[iCut] - aGradientLow[iCut]);
+         const FloatCalc grad10 = static_cast<FloatCalc>(gradLowEnd - aGradientLow[iCut]);
+         const FloatCalc grad11 =
+               static_cast<FloatCalc>(aGradientLow[iCut] - aGradientHigh[iCut] - gradLowEnd + gradTotal);
+
+         FloatCalc hess00 = static_cast<FloatCalc>(aHessianLow[iCut]);
+         FloatCalc hess01 = static_cast<FloatCalc>(aHessianHigh[iCut] - aHessianLow[iCut]);
+         FloatCalc hess10 = static_cast<FloatCalc>(hessLowEnd - aHessianLow[iCut]);
+         FloatCalc hess11 = static_cast<FloatCalc>(aHessianLow[iCut] - aHessianHigh[iCut] - hessLowEnd + hessTotal);
+
+         FloatCalc legal = aLegal[iCut];
+         legal = hess00 < hessianMin ? FloatCalc{0} : legal;
+         legal = hess01 < hessianMin ? FloatCalc{0} : legal;
+         legal = hess10 < hessianMin ? FloatCalc{0} : legal;
+         legal = hess11 < hessianMin ? FloatCalc{0} : legal;
+         aLegal[iCut] = legal;
+         hess00 = hess00 < hessianMin ? hessianMin : hess00;
+         hess01 = hess01 < hessianMin ? hessianMin : hess01;
+         hess10 = hess10 < hessianMin ? hessianMin : hess10;
+         hess11 = hess11 < hessianMin ? hessianMin : hess11;
+
+         FloatCalc gain = aGains[iCut];
+         if(bUnclipped) {
+            gain += CalcPartialGainUnclipped(grad00, hess00, regAlpha, regLambda);
+            gain += CalcPartialGainUnclipped(grad01, hess01, regAlpha, regLambda);
+            gain += CalcPartialGainUnclipped(grad10, hess10, regAlpha, regLambda);
+            gain += CalcPartialGainUnclipped(grad11, hess11, regAlpha, regLambda);
+         } else {
+            gain += CalcPartialGain<false>(grad00, hess00, regAlpha, regLambda, deltaStepMax);
+            gain += CalcPartialGain<false>(grad01, hess01, regAlpha, regLambda, deltaStepMax);
+            gain += CalcPartialGain<false>(grad10, hess10, regAlpha, regLambda, deltaStepMax);
+            gain += CalcPartialGain<false>(grad11, hess11, regAlpha, regLambda, deltaStepMax);
+         }
+         aGains[iCut] = gain;
+         ++iCut;
+      } while(cCuts != iCut);
+   }
+
  public:
    PartitionTwoDimensionalInteractionInternal() = delete; // this is a static class.  Do not construct
 
@@ -51,13 +145,11 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalInt
       auto* const aAuxiliaryBins =
             aAuxiliaryBinsBase
                   ->Specialize<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>();
-      auto* const aBins =
+      const auto* const aBins =
             aBinsBase->Specialize<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>();
 
 #ifndef NDEBUG
-      auto* const aDebugCopyBins =
-            aDebugCopyBinsBase
-                  ->Specialize<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>();
+      UNUSED(aDebugCopyBinsBase);
 #endif // NDEBUG
 
       const size_t cScores = GET_COUNT_SCORES(cCompilerScores, pInteractionCore->GetCountScores());
@@ -65,41 +157,56 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalInt
 
       const size_t cRealDimensions = GET_COUNT_DIMENSIONS(cCompilerDimensions, cRuntimeRealDimensions);
       EBM_ASSERT(k_dynamicDimensions == cCompilerDimensions || cCompilerDimensions == cRuntimeRealDimensions);
-
-      TensorSumDimension
-            aDimensions[k_dynamicDimensions == cCompilerDimensions ? k_cDimensionsMax : cCompilerDimensions];
-      size_t iDimensionInit = 0;
-      do {
-         // move data to a local variable that the compiler can reason about and then eliminate by moving to CPU
-         // registers
-         aDimensions[iDimensionInit].m_cBins = acBins[iDimensionInit];
-         ++iDimensionInit;
-      } while(cRealDimensions != iDimensionInit);
-
-      auto* const p_DO_NOT_USE_DIRECTLY_00 = IndexBin(aAuxiliaryBins, cBytesPerBin * 0);
-      ASSERT_BIN_OK(cBytesPerBin, p_DO_NOT_USE_DIRECTLY_00, pBinsEndDebug);
-      auto* const p_DO_NOT_USE_DIRECTLY_01 = IndexBin(aAuxiliaryBins, cBytesPerBin * 1);
-      ASSERT_BIN_OK(cBytesPerBin, p_DO_NOT_USE_DIRECTLY_01, pBinsEndDebug);
-      auto* const p_DO_NOT_USE_DIRECTLY_10 = IndexBin(aAuxiliaryBins, cBytesPerBin * 2);
-      ASSERT_BIN_OK(cBytesPerBin, p_DO_NOT_USE_DIRECTLY_10, pBinsEndDebug);
-      auto* const p_DO_NOT_USE_DIRECTLY_11 = IndexBin(aAuxiliaryBins, cBytesPerBin * 3);
-      ASSERT_BIN_OK(cBytesPerBin, p_DO_NOT_USE_DIRECTLY_11, pBinsEndDebug);
-
-      Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)> bin00;
-      Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)> bin01;
-      Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)> bin10;
-      Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)> bin11;
-
-      // if we know how many scores there are, use the memory on the stack where the compiler can optimize access
-      static constexpr bool bUseStackMemory = k_dynamicScores != cCompilerScores;
-      auto* const aGradientPairs00 =
-            bUseStackMemory ? bin00.GetGradientPairs() : p_DO_NOT_USE_DIRECTLY_00->GetGradientPairs();
-      auto* const aGradientPairs01 =
-            bUseStackMemory ? bin01.GetGradientPairs() : p_DO_NOT_USE_DIRECTLY_01->GetGradientPairs();
-      auto* const aGradientPairs10 =
-            bUseStackMemory ? bin10.GetGradientPairs() : p_DO_NOT_USE_DIRECTLY_10->GetGradientPairs();
-      auto* const aGradientPairs11 =
-            bUseStackMemory ? bin11.GetGradientPairs() : p_DO_NOT_USE_DIRECTLY_11->GetGradientPairs();
+      EBM_ASSERT(2 == cRealDimensions);
+      UNUSED(cRealDimensions);
+
+      const size_t cBins0 = acBins[0];
+      const size_t cBins1 = acBins[1];
+      EBM_ASSERT(2 <= cBins0); // 1 cBins in any dimension returns an interaction score of 0
+      EBM_ASSERT(2 <= cBins1); // 1 cBins in any dimension returns an interaction score of 0
+      const size_t cCuts1 = cBins1 - 1;
+      const size_t cBytesStride1 = cBytesPerBin * cBins0;
+
+      // aBins holds prefix sums, so P(x, y) is the total of every bin at or before x in dimension 0 and at or before
+      // y in dimension 1.  Cutting after x and after y gives the quadrants:
+      //   00 = P(x, y)
+      //   01 = P(L0, y) - P(x, y)
+      //   10 = P(x, L1) - P(x, y)
+      //   11 = P(x, y) - P(L0, y) - P(x, L1) + P(L0, L1)
+      // which are the operations, in the same order, that TensorTotalsSum would use, so the gains are unchanged.
+      // P(x, y) is strided in y, so for each x we gather P(x, *) into contiguous rows next to the P(L0, *) rows and
+      // evaluate every cut of dimension 1 with straight line arithmetic that the compiler can vectorize.  Illegal cuts
+      // are computed too, but with clamped hessians, and are then skipped when we scan the row for the best gain.
+      FloatCalc* const aGains = reinterpret_cast<FloatCalc*>(aAuxiliaryBins);
+      UIntMain* const aCountsLow = reinterpret_cast<UIntMain*>(aGains + cCuts1);
+      UIntMain* const aCountsHigh = aCountsLow + cCuts1;
+      FloatMain* const aWeightsLow = reinterpret_cast<FloatMain*>(aCountsHigh + cCuts1);
+      FloatMain* const aWeightsHigh = aWeightsLow + cCuts1;
+      FloatMain* const aGradientsLow = aWeightsHigh + cCuts1;
+      FloatMain* const aGradientsHigh = aGradientsLow + cScores * cCuts1;
+      FloatMain* const aHessiansLow = aGradientsHigh + cScores * cCuts1;
+      FloatMain* const aHessiansHigh = aHessiansLow + (bHessian ? cScores * cCuts1 : size_t{0});
+      // the legal flags are kept as FloatCalc so that they are as wide as the gains and hessians they are set beside
+      FloatCalc* const aLegal = aHessiansHigh + (bHessian ? cScores * cCuts1 : size_t{0});
+      EBM_ASSERT(reinterpret_cast<const BinBase*>(aLegal + cCuts1) <= pBinsEndDebug);
+
+      // the last bin has the totals of all bins
+      const auto* const pTotal = IndexBin(aBins, cBytesPerBin * (cBins0 - 1) + cBytesStride1 * cCuts1);
+      ASSERT_BIN_OK(cBytesPerBin, pTotal, pBinsEndDebug);
+
+      GatherRow(cScores,
+            cCuts1,
+            cBytesStride1,
+            IndexBin(aBins, cBytesPerBin * (cBins0 - 1)),
+            aCountsHigh,
+            aWeightsHigh,
+            aGradientsHigh,
+            aHessiansHigh
+#ifndef NDEBUG
+            ,
+            pBinsEndDebug
+#endif // NDEBUG
+      );
 
       EBM_ASSERT(std::numeric_limits<FloatCalc>::min() <= hessianMin);
 
@@ -108,271 +215,254 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalInt
 #endif // NDEBUG
 
       const bool bUseLogitBoost = bHessian && !(CalcInteractionFlags_DisableNewton & flags);
+      const bool bUnclipped = std::numeric_limits<FloatCalc>::infinity() == deltaStepMax;
 
       // if a negative value were to occur, then it would be due to numeric instability, so clip it to zero here
       FloatCalc bestGain = 0;
 
-      EBM_ASSERT(2 == cRealDimensions); // our TensorTotalsSum needs to be templated as dynamic if we want to have
-                                        // something other than 2 dimensions
+      const UIntMain cTotal = pTotal->GetCountSamples();
+      const FloatMain weightTotal = pTotal->GetWeight();
 
-      EBM_ASSERT(2 <= aDimensions[0].m_cBins); // 1 cBins in any dimension returns an interaction score of 0
       size_t x = 0;
       do {
-         EBM_ASSERT(2 <= aDimensions[1].m_cBins); // 1 cBins in any dimension returns an interaction score of 0
-         size_t y = 0;
-         do {
-            aDimensions[0].m_iLow = 0;
-            aDimensions[0].m_iHigh = x + 1;
-            aDimensions[1].m_iLow = 0;
-            aDimensions[1].m_iHigh = y + 1;
-            TensorTotalsSum<bHessian, cCompilerScores, cCompilerDimensions>(cScores,
-                  cRealDimensions,
-                  aDimensions,
-                  aBins,
-                  bin00,
-                  aGradientPairs00
+         const auto* const pLowEnd = IndexBin(aBins, cBytesPerBin * x + cBytesStride1 * cCuts1);
+         ASSERT_BIN_OK(cBytesPerBin, pLowEnd, pBinsEndDebug);
+
+         GatherRow(cScores,
+               cCuts1,
+               cBytesStride1,
+               IndexBin(aBins, cBytesPerBin * x),
+               aCountsLow,
+               aWeightsLow,
+               aGradientsLow,
+               aHessiansLow
 #ifndef NDEBUG
-                  ,
-                  aDebugCopyBins,
-                  pBinsEndDebug
-#endif // NDEBUG
-            );
-            if(bin00.GetCountSamples() < cSamplesLeafMin) {
-               goto next;
-            }
-
-            aDimensions[0].m_iLow = x + 1;
-            aDimensions[0].m_iHigh = aDimensions[0].m_cBins;
-            aDimensions[1].m_iLow = 0;
-            aDimensions[1].m_iHigh = y + 1;
-            TensorTotalsSum<bHessian, cCompilerScores, cCompilerDimensions>(cScores,
-                  cRealDimensions,
-                  aDimensions,
-                  aBins,
-                  bin01,
-                  aGradientPairs01
-#ifndef NDEBUG
-                  ,
-                  aDebugCopyBins,
-                  pBinsEndDebug
+               ,
+               pBinsEndDebug
 #endif // NDEBUG
-            );
-            if(bin01.GetCountSamples() < cSamplesLeafMin) {
-               goto next;
-            }
+         );
 
-            aDimensions[0].m_iLow = 0;
-            aDimensions[0].m_iHigh = x + 1;
-            aDimensions[1].m_iLow = y + 1;
-            aDimensions[1].m_iHigh = aDimensions[1].m_cBins;
-            TensorTotalsSum<bHessian, cCompilerScores, cCompilerDimensions>(cScores,
-                  cRealDimensions,
-                  aDimensions,
-                  aBins,
-                  bin10,
-                  aGradientPairs10
-#ifndef NDEBUG
-                  ,
-                  aDebugCopyBins,
-                  pBinsEndDebug
-#endif // NDEBUG
-            );
-            if(bin10.GetCountSamples() < cSamplesLeafMin) {
-               goto next;
-            }
+         const UIntMain cLowEnd = pLowEnd->GetCountSamples();
+         const FloatMain weightLowEnd = pLowEnd->GetWeight();
 
-            aDimensions[0].m_iLow = x + 1;
-            aDimensions[0].m_iHigh = aDimensions[0].m_cBins;
-            aDimensions[1].m_iLow = y + 1;
-            aDimensions[1].m_iHigh = aDimensions[1].m_cBins;
-            TensorTotalsSum<bHessian, cCompilerScores, cCompilerDimensions>(cScores,
-                  cRealDimensions,
-                  aDimensions,
-                  aBins,
-                  bin11,
-                  aGradientPairs11
-#ifndef NDEBUG
-                  ,
-                  aDebugCopyBins,
-                  pBinsEndDebug
-#endif // NDEBUG
-            );
-            if(bin11.GetCountSamples() < cSamplesLeafMin) {
-               goto next;
+         size_t y = 0;
+         do {
+            const UIntMain c00 = aCountsLow[y];
+            const UIntMain c01 = aCountsHigh[y] - c00;
+            const UIntMain c10 = cLowEnd - c00;
+            const UIntMain c11 = c00 - aCountsHigh[y] - cLowEnd + cTotal;
+            const bool bLegal = cSamplesLeafMin <= c00 && cSamplesLeafMin <= c01 && cSamplesLeafMin <= c10 &&
+                  cSamplesLeafMin <= c11;
+            aLegal[y] = bLegal ? FloatCalc{1} : FloatCalc{0};
+            aGains[y] = 0;
+            ++y;
+         } while(cCuts1 != y);
+
+         const auto* const aGradientPairsLowEnd = pLowEnd->GetGradientPairs();
+         const auto* const aGradientPairsTotal = pTotal->GetGradientPairs();
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            const FloatMain* const aGradientLow = &aGradientsLow[iScore * cCuts1];
+            const FloatMain* const aGradientHigh = &aGradientsHigh[iScore * cCuts1];
+            const FloatMain* const aHessianLow = bUseLogitBoost ? &aHessiansLow[iScore * cCuts1] : aWeightsLow;
+            const FloatMain* const aHessianHigh = bUseLogitBoost ? &aHessiansHigh[iScore * cCuts1] : aWeightsHigh;
+
+            const FloatMain gradLowEnd = aGradientPairsLowEnd[iScore].m_sumGradients;
+            const FloatMain gradTotal = aGradientPairsTotal[iScore].m_sumGradients;
+            const FloatMain hessLowEnd = bUseLogitBoost ? aGradientPairsLowEnd[iScore].GetHess() : weightLowEnd;
+            const FloatMain hessTotal = bUseLogitBoost ? aGradientPairsTotal[iScore].GetHess() : weightTotal;
+
+            if(CalcInteractionFlags_Purify & flags) {
+               // purified gain
+
+               // TODO: The interaction score is exactly equivalent to the gain calculated during
+               // boosting, so we can simplify our codebase by eliminating the interaction detection
+               // code if we generalize the boosting code to accept multiple term indexes.
+               // This change would have the additional benefit that we'd be able to use
+               // the more complex splits that we currently handle for boosting during interaction detection for
+               // no additional complexity, and we'll be able to benefit from the even more complex spits that
+               // we'll eventuall support for boosting interactions (allowing more than one cut in each of the
+               // interaction dimensions)
+               //
+               // TODO: We are purififying the simple 2x2 solution below using a simple system of equations
+               // but the solution below can be generalized to handle any size matrix and/or any size
+               // of tensor for 3-way and higher interactions.  The system of equations below were solved
+               // using the substitution/elimination method, but to solve these in the general case we'll
+               // need to implement a system of equations solver.  First try something like the matrix or
+               // inverse matrix method, and if that fails use an iterative solution like the
+               // Jacobi or Gauss-Seidel methods. This would be a better solution than the iterative
+               // solution that we currently use in the python purify() function.
+               //
+               // TODO: Once more efficient purification is done, we can use the same purification
+               // method during boosting where we could then keep the interactions pure while we
+               // simultaneously boost mains and interactions togehter at the same time.  This would
+               // be desirable in order to keep from overboosting on mains that are also included
+               // within interactions.
+               //
+               // If we have a 2x2 matrix of updates, we can purify the updates using an equation
+               // -------------------
+               // |update00|update01|
+               // |-----------------|
+               // |update10|update11|
+               // -------------------
+               //
+               // The update in each cell consists of a main update from feature0,
+               // a main update from feature1, and a purified update:
+               //   update00 = main0_0 + main1_0 + pure00
+               //   update01 = main0_1 + main1_0 + pure01
+               //   update10 = main0_0 + main1_1 + pure10
+               //   update11 = main0_1 + main1_1 + pure11
+               // We can add and subtract these to remove the main contributions:
+               //   update00 - update01 - update10 + update11 =
+               //        main0_0 + main1_0 + pure00
+               //      - main0_1 - main1_0 - pure01
+               //      - main0_0 - main1_1 - pure10
+               //      + main0_1 + main1_1 + pure11
+               // Which simplifies to:
+               //   update00 - update01 - update10 + update11 = pure00 - pure01 - pure10 + pure11
+               // Purification means the pure update multiplied by the weight must sum to zero
+               // across all rows/columns:
+               //   pure00 * weight00 + pure01 * weight01 = 0
+               //   pure01 * weight01 + pure11 * weight11 = 0
+               //   pure11 * weight11 + pure10 * weight10 = 0
+               //   pure10 * weight10 + pure00 * weight00 = 0
+               // So:
+               //   pure01 = -pure00 * weight00 / weight01
+               //   pure10 = -pure00 * weight00 / weight10
+               // And we can relate pure00 to pure11 by adding/subtracting the above:
+               //     pure00 * weight00 + pure01 * weight01
+               //   - pure01 * weight01 - pure11 * weight11
+               //   - pure11 * weight11 - pure10 * weight10
+               //   + pure10 * weight10 + pure00 * weight00 = 0
+               // which simplifies to:
+               //   2 * pure00 * weight00 - 2 * pure11 * weight11 = 0
+               // and then:
+               //   pure11 = pure00 * weight00 / weight11
+               // From the above:
+               //   update00 - update01 - update10 + update11 = pure00 - pure01 - pure10 + pure11
+               // we can substitute to get:
+               //   update00 - update01 - update10 + update11 =
+               //      pure00
+               //      + pure00 * weight00 / weight01
+               //      + pure00 * weight00 / weight10
+               //      + pure00 * weight00 / weight11
+               // Which simplifies to:
+               //   pure00 = (update00 - update01 - update10 + update11) /
+               //     (1 + weight00 / weight01 + weight00 / weight10 + weight00 / weight11)
+               // The other pure effects can be derived the same way.
+
+               y = 0;
+               do {
+                  const FloatCalc grad00 = static_cast<FloatCalc>(aGradientLow[y]);
+                  const FloatCalc grad01 = static_cast<FloatCalc>(aGradientHigh[y] - aGradientLow[y]);
+                  const FloatCalc grad10 = static_cast<FloatCalc>(gradLowEnd - aGradientLow[y]);
+                  const FloatCalc grad11 =
+                        static_cast<FloatCalc>(aGradientLow[y] - aGradientHigh[y] - gradLowEnd + gradTotal);
+
+                  FloatCalc hess00 = static_cast<FloatCalc>(aHessianLow[y]);
+                  FloatCalc hess01 = static_cast<FloatCalc>(aHessianHigh[y] - aHessianLow[y]);
+                  FloatCalc hess10 = static_cast<FloatCalc>(hessLowEnd - aHessianLow[y]);
+                  FloatCalc hess11 = static_cast<FloatCalc>(aHessianLow[y] - aHessianHigh[y] - hessLowEnd + hessTotal);
+
+                  FloatCalc legal = aLegal[y];
+                  legal = hess00 < hessianMin ? FloatCalc{0} : legal;
+                  legal = hess01 < hessianMin ? FloatCalc{0} : legal;
+                  legal = hess10 < hessianMin ? FloatCalc{0} : legal;
+                  legal = hess11 < hessianMin ? FloatCalc{0} : legal;
+                  aLegal[y] = legal;
+                  hess00 = hess00 < hessianMin ? hessianMin : hess00;
+                  hess01 = hess01 < hessianMin ? hessianMin : hess01;
+                  hess10 = hess10 < hessianMin ? hessianMin : hess10;
+                  hess11 = hess11 < hessianMin ? hessianMin : hess11;
+
+                  FloatCalc w00 = static_cast<FloatCalc>(aWeightsLow[y]);
+                  FloatCalc w01 = static_cast<FloatCalc>(aWeightsHigh[y] - aWeightsLow[y]);
+                  FloatCalc w10 = static_cast<FloatCalc>(weightLowEnd - aWeightsLow[y]);
+                  FloatCalc w11 = static_cast<FloatCalc>(aWeightsLow[y] - aWeightsHigh[y] - weightLowEnd + weightTotal);
+
+                  // if any of the weights are zero then the purified gain will be zero
+                  const bool bNonZero = (FloatCalc{0} != w00) & (FloatCalc{0} != w01) & (FloatCalc{0} != w10) &
+                        (FloatCalc{0} != w11);
+                  w00 = bNonZero ? w00 : FloatCalc{1};
+                  w01 = bNonZero ? w01 : FloatCalc{1};
+                  w10 = bNonZero ? w10 : FloatCalc{1};
+                  w11 = bNonZero ? w11 : FloatCalc{1};
+
+                  // Calculate the unpurified updates. Purification is invariant to the sign,
+                  // so we can purify the negative updates and get the same result.
+                  const FloatCalc negUpdate00 = CalcNegUpdate<false>(grad00, hess00, regAlpha, regLambda, deltaStepMax);
+                  const FloatCalc negUpdate01 = CalcNegUpdate<false>(grad01, hess01, regAlpha, regLambda, deltaStepMax);
+                  const FloatCalc negUpdate10 = CalcNegUpdate<false>(grad10, hess10, regAlpha, regLambda, deltaStepMax);
+                  const FloatCalc negUpdate11 = CalcNegUpdate<false>(grad11, hess11, regAlpha, regLambda, deltaStepMax);
+
+                  // common part of equations (positive for 00 & 11 equations, negative for 01 and 10)
+                  const FloatCalc common = negUpdate00 - negUpdate01 - negUpdate10 + negUpdate11;
+
+                  const FloatCalc negPure00 = common / (FloatCalc{1} + w00 / w01 + w00 / w10 + w00 / w11);
+                  const FloatCalc negPure01 = common / (FloatCalc{-1} - w01 / w00 - w01 / w10 - w01 / w11);
+                  const FloatCalc negPure10 = common / (FloatCalc{-1} - w10 / w00 - w10 / w01 - w10 / w11);
+                  const FloatCalc negPure11 = common / (FloatCalc{1} + w11 / w00 + w11 / w01 + w11 / w10);
+
+                  // g = partial gain
+                  const FloatCalc g00 =
+                        CalcPartialGainFromUpdate<false>(grad00, hess00, negPure00, regAlpha, regLambda);
+                  const FloatCalc g01 =
+                        CalcPartialGainFromUpdate<false>(grad01, hess01, negPure01, regAlpha, regLambda);
+                  const FloatCalc g10 =
+                        CalcPartialGainFromUpdate<false>(grad10, hess10, negPure10, regAlpha, regLambda);
+                  const FloatCalc g11 =
+                        CalcPartialGainFromUpdate<false>(grad11, hess11, negPure11, regAlpha, regLambda);
+
+                  const FloatCalc gain = aGains[y];
+                  aGains[y] = bNonZero ? gain + g00 + g01 + g10 + g11 : gain;
+                  ++y;
+               } while(cCuts1 != y);
+            } else {
+               // non-purified gain
+               if(bUnclipped) {
+                  SweepImpure<true>(cCuts1,
+                        aGradientLow,
+                        aGradientHigh,
+                        gradLowEnd,
+                        gradTotal,
+                        aHessianLow,
+                        aHessianHigh,
+                        hessLowEnd,
+                        hessTotal,
+                        hessianMin,
+                        regAlpha,
+                        regLambda,
+                        deltaStepMax,
+                        aGains,
+                        aLegal);
+               } else {
+                  SweepImpure<false>(cCuts1,
+                        aGradientLow,
+                        aGradientHigh,
+                        gradLowEnd,
+                        gradTotal,
+                        aHessianLow,
+                        aHessianHigh,
+                        hessLowEnd,
+                        hessTotal,
+                        hessianMin,
+                        regAlpha,
+                        regLambda,
+                        deltaStepMax,
+                        aGains,
+                        aLegal);
+               }
             }
+         }
 
-            {
+         y = 0;
+         do {
+            if(FloatCalc{0} != aLegal[y]) {
 #ifndef NDEBUG
                bAnySplits = true;
 #endif // NDEBUG
 
-               const FloatCalc w00 = static_cast<FloatCalc>(bin00.GetWeight());
-               const FloatCalc w01 = static_cast<FloatCalc>(bin01.GetWeight());
-               const FloatCalc w10 = static_cast<FloatCalc>(bin10.GetWeight());
-               const FloatCalc w11 = static_cast<FloatCalc>(bin11.GetWeight());
-
-               FloatCalc gain = 0;
-               for(size_t iScore = 0; iScore < cScores; ++iScore) {
-                  const FloatCalc grad00 = static_cast<FloatCalc>(aGradientPairs00[iScore].m_sumGradients);
-                  const FloatCalc grad01 = static_cast<FloatCalc>(aGradientPairs01[iScore].m_sumGradients);
-                  const FloatCalc grad10 = static_cast<FloatCalc>(aGradientPairs10[iScore].m_sumGradients);
-                  const FloatCalc grad11 = static_cast<FloatCalc>(aGradientPairs11[iScore].m_sumGradients);
-
-                  FloatCalc hess00;
-                  FloatCalc hess01;
-                  FloatCalc hess10;
-                  FloatCalc hess11;
-                  if(bUseLogitBoost) {
-                     hess00 = static_cast<FloatCalc>(aGradientPairs00[iScore].GetHess());
-                     hess01 = static_cast<FloatCalc>(aGradientPairs01[iScore].GetHess());
-                     hess10 = static_cast<FloatCalc>(aGradientPairs10[iScore].GetHess());
-                     hess11 = static_cast<FloatCalc>(aGradientPairs11[iScore].GetHess());
-                  } else {
-                     hess00 = w00;
-                     hess01 = w01;
-                     hess10 = w10;
-                     hess11 = w11;
-                  }
-                  if(hess00 < hessianMin) {
-                     goto next;
-                  }
-                  if(hess01 < hessianMin) {
-                     goto next;
-                  }
-                  if(hess10 < hessianMin) {
-                     goto next;
-                  }
-                  if(hess11 < hessianMin) {
-                     goto next;
-                  }
-
-                  if(CalcInteractionFlags_Purify & flags) {
-                     // purified gain
-
-                     // TODO: The interaction score is exactly equivalent to the gain calculated during
-                     // boosting, so we can simplify our codebase by eliminating the interaction detection
-                     // code if we generalize the boosting code to accept multiple term indexes.
-                     // This change would have the additional benefit that we'd be able to use
-                     // the more complex splits that we currently handle for boosting during interaction detection for
-                     // no additional complexity, and we'll be able to benefit from the even more complex spits that
-                     // we'll eventuall support for boosting interactions (allowing more than one cut in each of the
-                     // interaction dimensions)
-                     //
-                     // TODO: We are purififying the simple 2x2 solution below using a simple system of equations
-                     // but the solution below can be generalized to handle any size matrix and/or any size
-                     // of tensor for 3-way and higher interactions.  The system of equations below were solved
-                     // using the substitution/elimination method, but to solve these in the general case we'll
-                     // need to implement a system of equations solver.  First try something like the matrix or
-                     // inverse matrix method, and if that fails use an iterative solution like the
-                     // Jacobi or Gauss-Seidel methods. This would be a better solution than the iterative
-                     // solution that we currently use in the python purify() function.
-                     //
-                     // TODO: Once more efficient purification is done, we can use the same purification
-                     // method during boosting where we could then keep the interactions pure while we
-                     // simultaneously boost mains and interactions togehter at the same time.  This would
-                     // be desirable in order to keep from overboosting on mains that are also included
-                     // within interactions.
-                     //
-                     // If we have a 2x2 matrix of updates, we can purify the updates using an equation
-                     // -------------------
-                     // |update00|update01|
-                     // |-----------------|
-                     // |update10|update11|
-                     // -------------------
-                     //
-                     // The update in each cell consists of a main update from feature0,
-                     // a main update from feature1, and a purified update:
-                     //   update00 = main0_0 + main1_0 + pure00
-                     //   update01 = main0_1 + main1_0 + pure01
-                     //   update10 = main0_0 + main1_1 + pure10
-                     //   update11 = main0_1 + main1_1 + pure11
-                     // We can add and subtract these to remove the main contributions:
-                     //   update00 - update01 - update10 + update11 =
-                     //        main0_0 + main1_0 + pure00
-                     //      - main0_1 - main1_0 - pure01
-                     //      - main0_0 - main1_1 - pure10
-                     //      + main0_1 + main1_1 + pure11
-                     // Which simplifies to:
-                     //   update00 - update01 - update10 + update11 = pure00 - pure01 - pure10 + pure11
-                     // Purification means the pure update multiplied by the weight must sum to zero
-                     // across all rows/columns:
-                     //   pure00 * weight00 + pure01 * weight01 = 0
-                     //   pure01 * weight01 + pure11 * weight11 = 0
-                     //   pure11 * weight11 + pure10 * weight10 = 0
-                     //   pure10 * weight10 + pure00 * weight00 = 0
-                     // So:
-                     //   pure01 = -pure00 * weight00 / weight01
-                     //   pure10 = -pure00 * weight00 / weight10
-                     // And we can relate pure00 to pure11 by adding/subtracting the above:
-                     //     pure00 * weight00 + pure01 * weight01
-                     //   - pure01 * weight01 - pure11 * weight11
-                     //   - pure11 * weight11 - pure10 * weight10
-                     //   + pure10 * weight10 + pure00 * weight00 = 0
-                     // which simplifies to:
-                     //   2 * pure00 * weight00 - 2 * pure11 * weight11 = 0
-                     // and then:
-                     //   pure11 = pure00 * weight00 / weight11
-                     // From the above:
-                     //   update00 - update01 - update10 + update11 = pure00 - pure01 - pure10 + pure11
-                     // we can substitute to get:
-                     //   update00 - update01 - update10 + update11 =
-                     //      pure00
-                     //      + pure00 * weight00 / weight01
-                     //      + pure00 * weight00 / weight10
-                     //      + pure00 * weight00 / weight11
-                     // Which simplifies to:
-                     //   pure00 = (update00 - update01 - update10 + update11) /
-                     //     (1 + weight00 / weight01 + weight00 / weight10 + weight00 / weight11)
-                     // The other pure effects can be derived the same way.
-
-                     // if any of the weights are zero then the purified gain will be zero
-                     if(FloatCalc{0} != w00 && FloatCalc{0} != w01 && FloatCalc{0} != w10 && FloatCalc{0} != w11) {
-
-                        // TODO: instead of checking the denominators for zero above, can we do it earlier?
-                        // If we're using hessians then we'd need it here, but we aren't using them yet
-
-                        // Calculate the unpurified updates. Purification is invariant to the sign,
-                        // so we can purify the negative updates and get the same result.
-                        const FloatCalc negUpdate00 =
-                              CalcNegUpdate<false>(grad00, hess00, regAlpha, regLambda, deltaStepMax);
-                        const FloatCalc negUpdate01 =
-                              CalcNegUpdate<false>(grad01, hess01, regAlpha, regLambda, deltaStepMax);
-                        const FloatCalc negUpdate10 =
-                              CalcNegUpdate<false>(grad10, hess10, regAlpha, regLambda, deltaStepMax);
-                        const FloatCalc negUpdate11 =
-                              CalcNegUpdate<false>(grad11, hess11, regAlpha, regLambda, deltaStepMax);
-
-                        // common part of equations (positive for 00 & 11 equations, negative for 01 and 10)
-                        const FloatCalc common = negUpdate00 - negUpdate01 - negUpdate10 + negUpdate11;
-
-                        const FloatCalc negPure00 = common / (FloatCalc{1} + w00 / w01 + w00 / w10 + w00 / w11);
-                        const FloatCalc negPure01 = common / (FloatCalc{-1} - w01 / w00 - w01 / w10 - w01 / w11);
-                        const FloatCalc negPure10 = common / (FloatCalc{-1} - w10 / w00 - w10 / w01 - w10 / w11);
-                        const FloatCalc negPure11 = common / (FloatCalc{1} + w11 / w00 + w11 / w01 + w11 / w10);
-
-                        // g = partial gain
-                        const FloatCalc g00 =
-                              CalcPartialGainFromUpdate<false>(grad00, hess00, negPure00, regAlpha, regLambda);
-                        const FloatCalc g01 =
-                              CalcPartialGainFromUpdate<false>(grad01, hess01, negPure01, regAlpha, regLambda);
-                        const FloatCalc g10 =
-                              CalcPartialGainFromUpdate<false>(grad10, hess10, negPure10, regAlpha, regLambda);
-                        const FloatCalc g11 =
-                              CalcPartialGainFromUpdate<false>(grad11, hess11, negPure11, regAlpha, regLambda);
-
-                        gain += g00;
-                        gain += g01;
-                        gain += g10;
-                        gain += g11;
-                     }
-                  } else {
-                     // non-purified gain
-                     gain += CalcPartialGain<false>(grad00, hess00, regAlpha, regLambda, deltaStepMax);
-                     gain += CalcPartialGain<false>(grad01, hess01, regAlpha, regLambda, deltaStepMax);
-                     gain += CalcPartialGain<false>(grad10, hess10, regAlpha, regLambda, deltaStepMax);
-                     gain += CalcPartialGain<false>(grad11, hess11, regAlpha, regLambda, deltaStepMax);
-                  }
-               }
+               const FloatCalc gain = aGains[y];
+
                // gain should be positive if we're dealing with unpurified updates
                EBM_ASSERT(0 != (CalcInteractionFlags_Purify & flags) || std::isnan(gain) || 0 <= gain);
 
@@ -385,13 +475,11 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalInt
                   EBM_ASSERT(!std::isnan(gain));
                }
             }
-
-         next:;
-
             ++y;
-         } while(aDimensions[1].m_cBins - 1 != y);
+         } while(cCuts1 != y);
+
          ++x;
-      } while(aDimensions[0].m_cBins - 1 != x);
+      } while(cBins0 - 1 != x);
 
       // we start from zero, so bestGain can't be negative here
       EBM_ASSERT(std::isnan(bestGain) || 0 <= bestGain);
@@ -407,9 +495,6 @@ template<bool bHessian, size_t cCompilerScores> class PartitionTwoDimensionalInt
             // gain. All the splits we've analyzed so far though had the same non-split partial gain, so we subtract it
             // here instead of inside the loop.
 
-            // the bin before the aAuxiliaryBins is the last summation bin of aBinsBase,
-            // which contains the totals of all bins
-            const auto* const pTotal = NegativeIndexBin(aAuxiliaryBins, cBytesPerBin);
             const FloatMain weightAll = pTotal->GetWeight();
             const auto* const aGradientPairs = pTotal->GetGradientPairs();
             for(size_t iScore = 0; iScore < cScores; ++iScore) {
@@ -550,6 +635,31 @@ template<bool bHessian> class PartitionTwoDimensionalInteractionTarget<bHessian,
    }
 };
 
+// the bytes that PartitionTwoDimensionalInteraction needs in aAuxiliaryBinsBase for the rows of its cut sweep, or 0 if
+// that would overflow
+extern size_t GetPartitionTwoDimensionalInteractionSize(
+      const bool bHessian, const size_t cScores, const size_t cBins1) {
+   EBM_ASSERT(2 <= cBins1);
+   const size_t cCuts1 = cBins1 - 1;
+
+   // each cut has a gain, a legal flag, and for both sides of x a count, a weight, and the gradients and hessians
+   const size_t cValuesPerScore = bHessian ? size_t{4} : size_t{2};
+   if(IsMultiplyError(sizeof(FloatMain), cValuesPerScore, cScores)) {
+      return 0;
+   }
+   const size_t cBytesValues = sizeof(FloatMain) * cValuesPerScore * cScores;
+   static constexpr size_t cBytesFixed =
+         sizeof(FloatCalc) * size_t{2} + (sizeof(UIntMain) + sizeof(FloatMain)) * size_t{2};
+   if(IsAddError(cBytesFixed, cBytesValues)) {
+      return 0;
+   }
+   const size_t cBytesPerCut = cBytesFixed + cBytesValues;
+   if(IsMultiplyError(cBytesPerCut, cCuts1)) {
+      return 0;
+   }
+   return cBytesPerCut * cCuts1;
+}
+
 extern double PartitionTwoDimensionalInteraction(InteractionCore* const pInteractionCore,
       const size_t cRealDimensions,
       const size_t* const acBins,
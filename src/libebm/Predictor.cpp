@@ -0,0 +1,1502 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memcpy, memset, memcmp
+#include <limits> // std::numeric_limits
+#include <cmath> // std::exp, std::pow, std::erfc, std::atan, std::sqrt, std::abs
+#include <algorithm> // std::partial_sort
+
+#include "libebm.h"
+#include "logging.h"
+#include "unzoned.h" // LIKELY
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError
+#include "Feature.hpp" // FeatureBoosting
+#include "Term.hpp" // Term
+#include "Transpose.hpp"
+#include "Tensor.hpp" // Tensor
+#include "ThreadPool.hpp"
+#include "BoosterCore.hpp" // BoosterCore
+#include "BoosterShell.hpp"
+#include "Discretize.hpp"
+#include "Predictor.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// each task of Predict scores this many samples.  The block's scores stay in L1/L2 while all the terms are added
+// to them, and a block is large enough that the thread handoff costs little in comparison
+static constexpr size_t k_cPredictBlock = 1024;
+
+// when PredictContributions keeps only the top terms, each thread gathers the contributions of this many samples at
+// a time into its scratch space before choosing among them, which keeps the scratch small even with many terms
+static constexpr size_t k_cContributeBlock = 64;
+
+// the Eytzinger trees and tensors are each rounded up to a whole number of cache lines so that they start aligned
+static constexpr size_t k_cDoublesPerCacheLine = SIMD_BYTE_ALIGNMENT / sizeof(double);
+
+INLINE_ALWAYS static size_t RoundUpToCacheLine(const size_t cDoubles) {
+   return (cDoubles + (k_cDoublesPerCacheLine - size_t{1})) & ~(k_cDoublesPerCacheLine - size_t{1});
+}
+
+void Predictor::Free(Predictor* const pPredictor) {
+   LOG_0(Trace_Info, "Entered Predictor::Free");
+
+   if(nullptr != pPredictor) {
+      // before we free our memory, indicate it was freed so if our higher level language attempts to use it we have
+      // a chance to detect the error
+      pPredictor->m_handleVerification = k_handleVerificationFreed;
+      AlignedFree(pPredictor);
+   }
+
+   LOG_0(Trace_Info, "Exited Predictor::Free");
+}
+
+ErrorEbm Predictor::Build(const LinkEbm link,
+      const double linkParam,
+      const IntEbm countScores,
+      const double* const intercept,
+      const IntEbm countFeatures,
+      const IntEbm* const countBins,
+      const IntEbm* const countCuts,
+      const double* const cutsLowerBoundInclusive,
+      const IntEbm countTerms,
+      const IntEbm* const dimensionCounts,
+      const IntEbm* const featureIndexes,
+      const double* const termScores,
+      Predictor** const ppPredictorOut) {
+   LOG_0(Trace_Info, "Entered Predictor::Build");
+
+   EBM_ASSERT(nullptr != ppPredictorOut);
+   EBM_ASSERT(nullptr == *ppPredictorOut);
+
+   if(UNLIKELY(countScores < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build countScores must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countScores))) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build IsConvertError<size_t>(countScores)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cScores = static_cast<size_t>(countScores);
+
+   if(UNLIKELY(countFeatures < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build countFeatures must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countFeatures))) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build IsConvertError<size_t>(countFeatures)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+
+   if(UNLIKELY(countTerms < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build countTerms must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countTerms))) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build IsConvertError<size_t>(countTerms)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   if(size_t{0} != cFeatures && (nullptr == countBins || nullptr == countCuts)) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build countBins and countCuts cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+   if(size_t{0} != cTerms && nullptr == dimensionCounts) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build nullptr == dimensionCounts");
+      return Error_IllegalParamVal;
+   }
+
+   // First pass: check everything and measure the arena.  We index the doubles by size_t, so all we need to know
+   // is that they fit into memory, which IsMultiplyError on the final byte count checks.
+
+   size_t cDoubles = RoundUpToCacheLine(cScores);
+
+   size_t cCutsTotal = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const IntEbm countCutsFeature = countCuts[iFeature];
+      if(UNLIKELY(countCutsFeature < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR Predictor::Build countCuts must be positive");
+         return Error_IllegalParamVal;
+      }
+      // the largest tree we build has the next power of two above cCuts nodes, so keep cCuts well under that limit
+      if(UNLIKELY(IsConvertError<size_t>(countCutsFeature) ||
+               std::numeric_limits<size_t>::max() / size_t{4} < static_cast<size_t>(countCutsFeature))) {
+         LOG_0(Trace_Error, "ERROR Predictor::Build countCuts too large");
+         return Error_IllegalParamVal;
+      }
+      const size_t cCuts = static_cast<size_t>(countCutsFeature);
+
+      const IntEbm countBinsFeature = countBins[iFeature];
+      if(UNLIKELY(IsConvertError<size_t>(countBinsFeature))) {
+         LOG_0(Trace_Error, "ERROR Predictor::Build IsConvertError<size_t>(countBins)");
+         return Error_IllegalParamVal;
+      }
+      // the missing bin, the cCuts + 1 regular bins, and possibly an unknown bin that Discretize never returns
+      if(UNLIKELY(static_cast<size_t>(countBinsFeature) < cCuts + size_t{2})) {
+         LOG_0(Trace_Error, "ERROR Predictor::Build countBins must be at least countCuts + 2");
+         return Error_IllegalParamVal;
+      }
+
+      if(UNLIKELY(IsAddError(cCutsTotal, cCuts))) {
+         LOG_0(Trace_Error, "ERROR Predictor::Build the total number of cuts does not fit into a size_t");
+         return Error_IllegalParamVal;
+      }
+      cCutsTotal += cCuts;
+
+      const size_t cTreeNodes = RoundUpToCacheLine(size_t{1} << GetEytzingerLevels(cCuts));
+      if(UNLIKELY(IsAddError(cDoubles, cTreeNodes))) {
+         LOG_0(Trace_Warning, "WARNING Predictor::Build IsAddError(cDoubles, cTreeNodes)");
+         return Error_OutOfMemory;
+      }
+      cDoubles += cTreeNodes;
+   }
+   if(UNLIKELY(size_t{0} != cCutsTotal && nullptr == cutsLowerBoundInclusive)) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build nullptr == cutsLowerBoundInclusive");
+      return Error_IllegalParamVal;
+   }
+
+   size_t cDimensionsTotal = 0;
+   size_t cTermScoresTotal = 0;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const IntEbm countDimensions = dimensionCounts[iTerm];
+      if(UNLIKELY(countDimensions < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR Predictor::Build dimensionCounts must be positive");
+         return Error_IllegalParamVal;
+      }
+      if(UNLIKELY(static_cast<IntEbm>(k_cDimensionsMax) < countDimensions)) {
+         LOG_0(Trace_Error, "ERROR Predictor::Build dimensionCounts too large");
+         return Error_IllegalParamVal;
+      }
+      const size_t cDimensions = static_cast<size_t>(countDimensions);
+      if(size_t{0} != cDimensions && nullptr == featureIndexes) {
+         LOG_0(Trace_Error, "ERROR Predictor::Build nullptr == featureIndexes");
+         return Error_IllegalParamVal;
+      }
+
+      size_t cTensorScores = cScores;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         // cDimensionsTotal cannot overflow since each term adds at most k_cDimensionsMax and cTerms fit in memory
+         const IntEbm indexFeature = featureIndexes[cDimensionsTotal + iDimension];
+         if(UNLIKELY(indexFeature < IntEbm{0} || countFeatures <= indexFeature)) {
+            LOG_0(Trace_Error, "ERROR Predictor::Build featureIndexes value out of range");
+            return Error_IllegalParamVal;
+         }
+         const size_t cBins = static_cast<size_t>(countBins[static_cast<size_t>(indexFeature)]);
+         if(UNLIKELY(IsMultiplyError(cTensorScores, cBins))) {
+            LOG_0(Trace_Warning, "WARNING Predictor::Build IsMultiplyError(cTensorScores, cBins)");
+            return Error_OutOfMemory;
+         }
+         cTensorScores *= cBins;
+      }
+      cDimensionsTotal += cDimensions;
+
+      if(UNLIKELY(IsAddError(cTermScoresTotal, cTensorScores))) {
+         LOG_0(Trace_Warning, "WARNING Predictor::Build IsAddError(cTermScoresTotal, cTensorScores)");
+         return Error_OutOfMemory;
+      }
+      cTermScoresTotal += cTensorScores;
+
+      const size_t cTensorDoubles = RoundUpToCacheLine(cTensorScores);
+      if(UNLIKELY(cTensorDoubles < cTensorScores || IsAddError(cDoubles, cTensorDoubles))) {
+         LOG_0(Trace_Warning, "WARNING Predictor::Build IsAddError(cDoubles, cTensorDoubles)");
+         return Error_OutOfMemory;
+      }
+      cDoubles += cTensorDoubles;
+   }
+   if(UNLIKELY(size_t{0} != cTermScoresTotal && nullptr == termScores)) {
+      LOG_0(Trace_Error, "ERROR Predictor::Build nullptr == termScores");
+      return Error_IllegalParamVal;
+   }
+
+   // the descriptions go after the Predictor object, and the doubles start on the first cache line after them
+   const size_t cBytesPredictor = sizeof(Predictor);
+   const size_t cBytesFeatures = sizeof(PredictorFeature) * cFeatures;
+   const size_t cBytesTerms = sizeof(PredictorTerm) * cTerms;
+   const size_t cBytesDimensions = sizeof(PredictorDimension) * cDimensionsTotal;
+   if(UNLIKELY(IsMultiplyError(sizeof(PredictorFeature), cFeatures) ||
+            IsMultiplyError(sizeof(PredictorTerm), cTerms) ||
+            IsMultiplyError(sizeof(PredictorDimension), cDimensionsTotal) ||
+            IsAddError(cBytesPredictor, cBytesFeatures, cBytesTerms, cBytesDimensions, SIMD_BYTE_ALIGNMENT))) {
+      LOG_0(Trace_Warning, "WARNING Predictor::Build the descriptions do not fit into memory");
+      return Error_OutOfMemory;
+   }
+   const size_t cBytesHeader = (cBytesPredictor + cBytesFeatures + cBytesTerms + cBytesDimensions +
+                                      (SIMD_BYTE_ALIGNMENT - size_t{1})) &
+         ~(SIMD_BYTE_ALIGNMENT - size_t{1});
+   if(UNLIKELY(IsMultiplyError(sizeof(double), cDoubles) || IsAddError(cBytesHeader, sizeof(double) * cDoubles))) {
+      LOG_0(Trace_Warning, "WARNING Predictor::Build the arena does not fit into memory");
+      return Error_OutOfMemory;
+   }
+   const size_t cBytesArena = cBytesHeader + sizeof(double) * cDoubles;
+
+   unsigned char* const pArena = static_cast<unsigned char*>(AlignedAlloc(cBytesArena));
+   if(UNLIKELY(nullptr == pArena)) {
+      LOG_0(Trace_Warning, "WARNING Predictor::Build nullptr == pArena");
+      return Error_OutOfMemory;
+   }
+
+   // Second pass: fill the arena.  Nothing below can fail.
+
+   Predictor* const pPredictor = reinterpret_cast<Predictor*>(pArena);
+   PredictorFeature* const aFeatures = reinterpret_cast<PredictorFeature*>(pArena + cBytesPredictor);
+   PredictorTerm* const aTerms = reinterpret_cast<PredictorTerm*>(pArena + cBytesPredictor + cBytesFeatures);
+   PredictorDimension* const aDimensions =
+         reinterpret_cast<PredictorDimension*>(pArena + cBytesPredictor + cBytesFeatures + cBytesTerms);
+   double* const aDoubles = reinterpret_cast<double*>(pArena + cBytesHeader);
+
+   pPredictor->m_handleVerification = k_handleVerificationOk;
+   pPredictor->m_link = link;
+   pPredictor->m_linkParam = linkParam;
+   pPredictor->m_cScores = cScores;
+   pPredictor->m_cFeatures = cFeatures;
+   pPredictor->m_cTerms = cTerms;
+   pPredictor->m_aFeatures = aFeatures;
+   pPredictor->m_aTerms = aTerms;
+   pPredictor->m_aDimensions = aDimensions;
+   pPredictor->m_aIntercept = aDoubles;
+   pPredictor->m_aDoubles = aDoubles;
+
+   size_t iDouble = 0;
+   for(size_t iScore = 0; iScore < cScores; ++iScore) {
+      aDoubles[iScore] = nullptr == intercept ? 0.0 : intercept[iScore];
+   }
+   iDouble += RoundUpToCacheLine(cScores);
+
+   const double* pCuts = cutsLowerBoundInclusive;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const size_t cCuts = static_cast<size_t>(countCuts[iFeature]);
+      const size_t cLevels = GetEytzingerLevels(cCuts);
+
+      PredictorFeature* const pFeature = &aFeatures[iFeature];
+      pFeature->m_cLevels = cLevels;
+      pFeature->m_iTree = iDouble;
+      pFeature->m_cBins = static_cast<size_t>(countBins[iFeature]);
+
+      BuildEytzinger(cCuts, pCuts, cLevels, &aDoubles[iDouble]);
+      const size_t cTreeNodes = size_t{1} << cLevels;
+      const size_t cTreeDoubles = RoundUpToCacheLine(cTreeNodes);
+      for(size_t iPad = cTreeNodes; iPad < cTreeDoubles; ++iPad) {
+         aDoubles[iDouble + iPad] = 0.0;
+      }
+      iDouble += cTreeDoubles;
+      if(size_t{0} != cCuts) {
+         pCuts += cCuts;
+      }
+   }
+
+   size_t iDimensionFirst = 0;
+   const double* pTermScores = termScores;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const size_t cDimensions = static_cast<size_t>(dimensionCounts[iTerm]);
+
+      PredictorTerm* const pTerm = &aTerms[iTerm];
+      pTerm->m_cDimensions = cDimensions;
+      pTerm->m_iDimensionFirst = iDimensionFirst;
+      pTerm->m_iTensor = iDouble;
+
+      // like the tensors from GetBestTermScores, the scores are innermost and the last dimension changes fastest
+      size_t cStride = cScores;
+      size_t iDimension = cDimensions;
+      while(size_t{0} != iDimension) {
+         --iDimension;
+         const size_t iFeature = static_cast<size_t>(featureIndexes[iDimensionFirst + iDimension]);
+         PredictorDimension* const pDimension = &aDimensions[iDimensionFirst + iDimension];
+         pDimension->m_iFeature = iFeature;
+         pDimension->m_cStride = cStride;
+         cStride *= aFeatures[iFeature].m_cBins;
+      }
+      iDimensionFirst += cDimensions;
+
+      const size_t cTensorScores = cStride;
+      if(size_t{0} != cTensorScores) {
+         memcpy(&aDoubles[iDouble], pTermScores, sizeof(double) * cTensorScores);
+         pTermScores += cTensorScores;
+      }
+      const size_t cTensorDoubles = RoundUpToCacheLine(cTensorScores);
+      for(size_t iPad = cTensorScores; iPad < cTensorDoubles; ++iPad) {
+         aDoubles[iDouble + iPad] = 0.0;
+      }
+      iDouble += cTensorDoubles;
+   }
+   EBM_ASSERT(cDoubles == iDouble);
+   EBM_ASSERT(cDimensionsTotal == iDimensionFirst);
+
+   *ppPredictorOut = pPredictor;
+
+   LOG_0(Trace_Info, "Exited Predictor::Build");
+   return Error_None;
+}
+
+// Finds the cuts that can be dropped without changing any prediction.  A cut can go when, in every term that uses its
+// feature, the slice of the tensor at the regular bin below the cut is bitwise equal to the slice at the bin above
+// it.  aKeepOut receives 1 for each cut that must stay, in the order of cutsLowerBoundInclusive.  The model must
+// already have been checked by Build
+static size_t FindKeptCuts(const size_t cScores,
+      const size_t cFeatures,
+      const IntEbm* const countBins,
+      const IntEbm* const countCuts,
+      const size_t* const aiCutFirst,
+      const size_t cTerms,
+      const IntEbm* const dimensionCounts,
+      const IntEbm* const featureIndexes,
+      const double* const termScores,
+      unsigned char* const aKeepOut) {
+   size_t cCutsTotal = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      cCutsTotal += static_cast<size_t>(countCuts[iFeature]);
+   }
+   // a feature that no term uses keeps none of its cuts
+   memset(aKeepOut, 0, cCutsTotal);
+
+   size_t iDimensionFirst = 0;
+   const double* pTermScores = termScores;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const size_t cDimensions = static_cast<size_t>(dimensionCounts[iTerm]);
+
+      size_t aStrides[k_cDimensionsMax];
+      size_t cTensorScores = cScores;
+      size_t iDimension = cDimensions;
+      while(size_t{0} != iDimension) {
+         --iDimension;
+         aStrides[iDimension] = cTensorScores;
+         const size_t iFeature = static_cast<size_t>(featureIndexes[iDimensionFirst + iDimension]);
+         cTensorScores *= static_cast<size_t>(countBins[iFeature]);
+      }
+
+      if(size_t{0} != cTensorScores) {
+         for(iDimension = 0; iDimension < cDimensions; ++iDimension) {
+            const size_t iFeature = static_cast<size_t>(featureIndexes[iDimensionFirst + iDimension]);
+            const size_t cCuts = static_cast<size_t>(countCuts[iFeature]);
+            const size_t cStride = aStrides[iDimension];
+            // everything in the dimensions after this one and the scores is contiguous, so each slice is made of
+            // cOuter runs of cStride doubles
+            const size_t cSpan = cStride * static_cast<size_t>(countBins[iFeature]);
+            const size_t cOuter = cTensorScores / cSpan;
+            unsigned char* const aKeep = &aKeepOut[aiCutFirst[iFeature]];
+            for(size_t iCut = 0; iCut < cCuts; ++iCut) {
+               if(0 != aKeep[iCut]) {
+                  continue;
+               }
+               // the regular bins start after the missing bin, so cut iCut divides bins iCut + 1 and iCut + 2
+               const double* pLow = pTermScores + cStride * (iCut + size_t{1});
+               for(size_t iOuter = 0; iOuter < cOuter; ++iOuter) {
+                  if(0 != memcmp(pLow, pLow + cStride, sizeof(double) * cStride)) {
+                     aKeep[iCut] = 1;
+                     break;
+                  }
+                  pLow += cSpan;
+               }
+            }
+         }
+         pTermScores += cTensorScores;
+      }
+      iDimensionFirst += cDimensions;
+   }
+
+   size_t cKept = 0;
+   for(size_t iCut = 0; iCut < cCutsTotal; ++iCut) {
+      cKept += static_cast<size_t>(aKeepOut[iCut]);
+   }
+   return cKept;
+}
+
+ErrorEbm Predictor::Create(const LinkEbm link,
+      const double linkParam,
+      const IntEbm countScores,
+      const double* const intercept,
+      const IntEbm countFeatures,
+      const IntEbm* const countBins,
+      const IntEbm* const countCuts,
+      const double* const cutsLowerBoundInclusive,
+      const IntEbm countTerms,
+      const IntEbm* const dimensionCounts,
+      const IntEbm* const featureIndexes,
+      const double* const termScores,
+      Predictor** const ppPredictorOut) {
+   LOG_0(Trace_Info, "Entered Predictor::Create");
+
+   EBM_ASSERT(nullptr != ppPredictorOut);
+   EBM_ASSERT(nullptr == *ppPredictorOut);
+
+   // Build checks the model, so after it succeeds we can read the arrays below without checking them again.  The
+   // exact Predictor is also what we return if there is nothing to compact or no memory to compact it with
+   Predictor* pPredictor = nullptr;
+   ErrorEbm error = Build(link,
+         linkParam,
+         countScores,
+         intercept,
+         countFeatures,
+         countBins,
+         countCuts,
+         cutsLowerBoundInclusive,
+         countTerms,
+         dimensionCounts,
+         featureIndexes,
+         termScores,
+         &pPredictor);
+   if(Error_None != error) {
+      return error;
+   }
+
+   const size_t cScores = static_cast<size_t>(countScores);
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   size_t cCutsTotal = 0;
+   size_t cBinsTotal = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      cCutsTotal += static_cast<size_t>(countCuts[iFeature]);
+      cBinsTotal += static_cast<size_t>(countBins[iFeature]);
+   }
+   size_t cDimensionsTotal = 0;
+   size_t cTermScoresTotal = 0;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const size_t cDimensions = static_cast<size_t>(dimensionCounts[iTerm]);
+      size_t cTensorScores = cScores;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         const size_t iFeature = static_cast<size_t>(featureIndexes[cDimensionsTotal + iDimension]);
+         cTensorScores *= static_cast<size_t>(countBins[iFeature]);
+      }
+      cDimensionsTotal += cDimensions;
+      cTermScoresTotal += cTensorScores;
+   }
+
+   if(size_t{0} == cCutsTotal) {
+      *ppPredictorOut = pPredictor;
+      LOG_0(Trace_Info, "Exited Predictor::Create without cuts to compact");
+      return Error_None;
+   }
+
+   // Build allocated the whole model, so these sizes are known to fit in memory
+   EBM_ASSERT(!IsMultiplyError(sizeof(size_t), cFeatures + cBinsTotal));
+   EBM_ASSERT(!IsMultiplyError(sizeof(double), cTermScoresTotal));
+   size_t* const aIndexes = static_cast<size_t*>(malloc(sizeof(size_t) * (cFeatures + cBinsTotal)));
+   unsigned char* const aKeep = static_cast<unsigned char*>(malloc(cCutsTotal));
+   IntEbm* const aCounts = static_cast<IntEbm*>(malloc(sizeof(IntEbm) * (cFeatures + cFeatures)));
+   double* const aCuts = static_cast<double*>(malloc(sizeof(double) * cCutsTotal));
+   double* const aTermScores =
+         size_t{0} == cTermScoresTotal ? nullptr : static_cast<double*>(malloc(sizeof(double) * cTermScoresTotal));
+   if(nullptr == aIndexes || nullptr == aKeep || nullptr == aCounts || nullptr == aCuts ||
+         (size_t{0} != cTermScoresTotal && nullptr == aTermScores)) {
+      // compacting only makes scoring faster, so the exact Predictor is still a good result
+      LOG_0(Trace_Warning, "WARNING Predictor::Create out of memory to compact the model");
+      free(aIndexes);
+      free(aKeep);
+      free(aCounts);
+      free(aCuts);
+      free(aTermScores);
+      *ppPredictorOut = pPredictor;
+      return Error_None;
+   }
+   size_t* const aiCutFirst = aIndexes;
+   // for each bin of the compacted features, the bin of the original feature whose scores it takes
+   size_t* const aiBinsOriginal = aIndexes + cFeatures;
+   IntEbm* const acBins = aCounts;
+   IntEbm* const acCuts = aCounts + cFeatures;
+
+   size_t iCutFirst = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      aiCutFirst[iFeature] = iCutFirst;
+      iCutFirst += static_cast<size_t>(countCuts[iFeature]);
+   }
+
+   const size_t cKept = FindKeptCuts(cScores,
+         cFeatures,
+         countBins,
+         countCuts,
+         aiCutFirst,
+         cTerms,
+         dimensionCounts,
+         featureIndexes,
+         termScores,
+         aKeep);
+   if(cKept != cCutsTotal) {
+      double* pCuts = aCuts;
+      size_t* piBinOriginal = aiBinsOriginal;
+      for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+         const size_t cCuts = static_cast<size_t>(countCuts[iFeature]);
+         const size_t cBins = static_cast<size_t>(countBins[iFeature]);
+         const double* const aCutsFeature = &cutsLowerBoundInclusive[aiCutFirst[iFeature]];
+         const unsigned char* const aKeepFeature = &aKeep[aiCutFirst[iFeature]];
+
+         size_t* const aiBinsFeature = piBinOriginal;
+         *piBinOriginal++ = 0; // missing
+         *piBinOriginal++ = 1; // the first regular bin
+         for(size_t iCut = 0; iCut < cCuts; ++iCut) {
+            if(0 != aKeepFeature[iCut]) {
+               *pCuts++ = aCutsFeature[iCut];
+               *piBinOriginal++ = iCut + size_t{2};
+            }
+         }
+         // the unknown bin, if any, is after the regular bins
+         for(size_t iBin = cCuts + size_t{2}; iBin < cBins; ++iBin) {
+            *piBinOriginal++ = iBin;
+         }
+         const size_t cBinsCompact = static_cast<size_t>(piBinOriginal - aiBinsFeature);
+         acBins[iFeature] = static_cast<IntEbm>(cBinsCompact);
+         acCuts[iFeature] = static_cast<IntEbm>(cBinsCompact - (cBins - cCuts));
+      }
+
+      // each compacted tensor takes the scores of its cells from the original bins that they stand for. We walk the
+      // cells of the compacted tensor in order, keeping the offset of the matching original cell
+      size_t* const aiFeatureBinFirst = aiCutFirst; // the cut offsets are no longer needed
+      size_t iBinFirst = 0;
+      for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+         aiFeatureBinFirst[iFeature] = iBinFirst;
+         iBinFirst += static_cast<size_t>(acBins[iFeature]);
+      }
+
+      size_t iDimensionFirst = 0;
+      const double* pTermScoresOriginal = termScores;
+      double* pTermScores = aTermScores;
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         const size_t cDimensions = static_cast<size_t>(dimensionCounts[iTerm]);
+
+         size_t aStrides[k_cDimensionsMax];
+         size_t aiBins[k_cDimensionsMax];
+         size_t cTensorScoresOriginal = cScores;
+         size_t cTensorScores = cScores;
+         size_t iDimension = cDimensions;
+         while(size_t{0} != iDimension) {
+            --iDimension;
+            const size_t iFeature = static_cast<size_t>(featureIndexes[iDimensionFirst + iDimension]);
+            aStrides[iDimension] = cTensorScoresOriginal;
+            aiBins[iDimension] = 0;
+            cTensorScoresOriginal *= static_cast<size_t>(countBins[iFeature]);
+            cTensorScores *= static_cast<size_t>(acBins[iFeature]);
+         }
+
+         if(size_t{0} != cTensorScores) {
+            const double* const pTermScoresEnd = pTermScores + cTensorScores;
+            while(true) {
+               size_t iCellOriginal = 0;
+               for(iDimension = 0; iDimension < cDimensions; ++iDimension) {
+                  const size_t iFeature = static_cast<size_t>(featureIndexes[iDimensionFirst + iDimension]);
+                  const size_t iBinOriginal = aiBinsOriginal[aiFeatureBinFirst[iFeature] + aiBins[iDimension]];
+                  iCellOriginal += iBinOriginal * aStrides[iDimension];
+               }
+               memcpy(pTermScores, &pTermScoresOriginal[iCellOriginal], sizeof(double) * cScores);
+               pTermScores += cScores;
+               if(pTermScoresEnd == pTermScores) {
+                  break;
+               }
+
+               // the last dimension changes fastest
+               iDimension = cDimensions;
+               while(true) {
+                  EBM_ASSERT(size_t{0} != iDimension);
+                  --iDimension;
+                  const size_t iFeature = static_cast<size_t>(featureIndexes[iDimensionFirst + iDimension]);
+                  ++aiBins[iDimension];
+                  if(aiBins[iDimension] != static_cast<size_t>(acBins[iFeature])) {
+                     break;
+                  }
+                  aiBins[iDimension] = 0;
+               }
+            }
+            pTermScoresOriginal += cTensorScoresOriginal;
+         }
+         iDimensionFirst += cDimensions;
+      }
+
+      Predictor* pPredictorCompact = nullptr;
+      error = Build(link,
+            linkParam,
+            countScores,
+            intercept,
+            countFeatures,
+            acBins,
+            acCuts,
+            aCuts,
+            countTerms,
+            dimensionCounts,
+            featureIndexes,
+            aTermScores,
+            &pPredictorCompact);
+      if(Error_None == error) {
+         Free(pPredictor);
+         pPredictor = pPredictorCompact;
+      } else {
+         // the compacted model is smaller than the exact one, so this can only be a transient allocation failure
+         LOG_0(Trace_Warning, "WARNING Predictor::Create could not build the compacted model");
+      }
+   }
+
+   free(aIndexes);
+   free(aKeep);
+   free(aCounts);
+   free(aCuts);
+   free(aTermScores);
+
+   *ppPredictorOut = pPredictor;
+
+   LOG_N(Trace_Info, "Exited Predictor::Create keeping %zu of %zu cuts", cKept, cCutsTotal);
+   return Error_None;
+}
+
+INLINE_ALWAYS void Predictor::GatherCells(const PredictorTerm* const pTerm,
+      const size_t cLanes,
+      const size_t cSamplesStride,
+      const double* const featureVals,
+      size_t* const aiCellOut) const {
+   EBM_ASSERT(cLanes <= k_cDiscretizeLanes);
+
+   for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+      aiCellOut[iLane] = 0;
+   }
+   const PredictorDimension* pDimension = &m_aDimensions[pTerm->m_iDimensionFirst];
+   const PredictorDimension* const pDimensionsEnd = pDimension + pTerm->m_cDimensions;
+   for(; pDimensionsEnd != pDimension; ++pDimension) {
+      const PredictorFeature* const pFeature = &m_aFeatures[pDimension->m_iFeature];
+      size_t aiBin[k_cDiscretizeLanes];
+      DiscretizeEytzinger(cLanes,
+            featureVals + cSamplesStride * pDimension->m_iFeature,
+            aiBin,
+            pFeature->m_cLevels,
+            &m_aDoubles[pFeature->m_iTree]);
+      const size_t cStride = pDimension->m_cStride;
+      for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+         EBM_ASSERT(aiBin[iLane] < pFeature->m_cBins);
+         aiCellOut[iLane] += aiBin[iLane] * cStride;
+      }
+   }
+}
+
+void Predictor::ScoreBlock(const size_t cSamples,
+      const size_t cSamplesStride,
+      const double* const featureVals,
+      double* const scoresOut) const {
+   const size_t cScores = m_cScores;
+   if(size_t{0} == cScores) {
+      return;
+   }
+
+   double* pScores = scoresOut;
+   const double* const pScoresEnd = scoresOut + cScores * cSamples;
+   while(pScoresEnd != pScores) {
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         pScores[iScore] = m_aIntercept[iScore];
+      }
+      pScores += cScores;
+   }
+
+   for(size_t iTerm = 0; iTerm < m_cTerms; ++iTerm) {
+      const PredictorTerm* const pTerm = &m_aTerms[iTerm];
+      const double* const aTensor = &m_aDoubles[pTerm->m_iTensor];
+
+      // Work through the samples k_cDiscretizeLanes at a time.  For each lane we find the bin in every dimension
+      // and accumulate the tensor offset of the cell, then add the cell's scores.  The tensor lookups of the lanes
+      // are independent, so like the tree search they overlap in the memory system.
+      size_t iSample = 0;
+      while(iSample != cSamples) {
+         const size_t cLanes = EbmMin(k_cDiscretizeLanes, cSamples - iSample);
+
+         size_t aiCell[k_cDiscretizeLanes];
+         GatherCells(pTerm, cLanes, cSamplesStride, featureVals + iSample, aiCell);
+
+         double* pScoresLane = scoresOut + cScores * iSample;
+         for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+            const double* const pCell = aTensor + aiCell[iLane];
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               pScoresLane[iScore] += pCell[iScore];
+            }
+            pScoresLane += cScores;
+         }
+
+         iSample += cLanes;
+      }
+   }
+}
+
+void Predictor::ContributeBlock(const size_t cSamples,
+      const size_t cSamplesStride,
+      const double* const featureVals,
+      double* const contributionsOut) const {
+   const size_t cScores = m_cScores;
+   const size_t cSampleContributions = cScores * m_cTerms;
+   if(size_t{0} == cSampleContributions) {
+      return;
+   }
+
+   // the same lane-parallel gather as ScoreBlock, except that each cell's scores are copied into the sample's slot
+   // for the term instead of being summed
+   for(size_t iTerm = 0; iTerm < m_cTerms; ++iTerm) {
+      const PredictorTerm* const pTerm = &m_aTerms[iTerm];
+      const double* const aTensor = &m_aDoubles[pTerm->m_iTensor];
+
+      size_t iSample = 0;
+      while(iSample != cSamples) {
+         const size_t cLanes = EbmMin(k_cDiscretizeLanes, cSamples - iSample);
+
+         size_t aiCell[k_cDiscretizeLanes];
+         GatherCells(pTerm, cLanes, cSamplesStride, featureVals + iSample, aiCell);
+
+         double* pContributionsLane = contributionsOut + cSampleContributions * iSample + cScores * iTerm;
+         for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+            const double* const pCell = aTensor + aiCell[iLane];
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               pContributionsLane[iScore] = pCell[iScore];
+            }
+            pContributionsLane += cSampleContributions;
+         }
+
+         iSample += cLanes;
+      }
+   }
+}
+
+void Predictor::ScoreOne(const double* const row, double* const scoresOut) const {
+   const size_t cScores = m_cScores;
+   for(size_t iScore = 0; iScore < cScores; ++iScore) {
+      scoresOut[iScore] = m_aIntercept[iScore];
+   }
+
+   const PredictorTerm* pTerm = m_aTerms;
+   const PredictorTerm* const pTermsEnd = m_aTerms + m_cTerms;
+   for(; pTermsEnd != pTerm; ++pTerm) {
+      const PredictorDimension* pDimension = &m_aDimensions[pTerm->m_iDimensionFirst];
+      const PredictorDimension* const pDimensionsEnd = pDimension + pTerm->m_cDimensions;
+      size_t iCell = 0;
+      for(; pDimensionsEnd != pDimension; ++pDimension) {
+         const PredictorFeature* const pFeature = &m_aFeatures[pDimension->m_iFeature];
+         size_t iBin;
+         DiscretizeEytzinger(size_t{1},
+               &row[pDimension->m_iFeature],
+               &iBin,
+               pFeature->m_cLevels,
+               &m_aDoubles[pFeature->m_iTree]);
+         EBM_ASSERT(iBin < pFeature->m_cBins);
+         iCell += iBin * pDimension->m_cStride;
+      }
+
+      const double* const pCell = &m_aDoubles[pTerm->m_iTensor + iCell];
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         scoresOut[iScore] += pCell[iScore];
+      }
+   }
+}
+
+static bool IsInverseLinkKnown(const LinkEbm link) {
+   switch(link) {
+      case Link_monoclassification:
+      case Link_mlogit:
+      case Link_vlogit:
+      case Link_logit:
+      case Link_probit:
+      case Link_cloglog:
+      case Link_loglog:
+      case Link_cauchit:
+      case Link_power:
+      case Link_identity:
+      case Link_log:
+      case Link_inverse:
+      case Link_inverse_square:
+      case Link_sqrt:
+         return true;
+      default:
+         return false;
+   }
+}
+
+extern void ApplyInverseLink(
+      const LinkEbm link, const double linkParam, const size_t cScores, const size_t cSamples, double* const aScores) {
+   EBM_ASSERT(IsInverseLinkKnown(link));
+
+   const size_t cVals = cScores * cSamples;
+   switch(link) {
+      case Link_monoclassification:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = 1.0;
+         }
+         break;
+      case Link_mlogit:
+         for(double* pScores = aScores; aScores + cVals != pScores; pScores += cScores) {
+            // subtract the max so that exp cannot overflow
+            double maxScore = pScores[0];
+            for(size_t iScore = 1; iScore < cScores; ++iScore) {
+               maxScore = pScores[iScore] < maxScore ? maxScore : pScores[iScore];
+            }
+            double sum = 0.0;
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               const double val = std::exp(pScores[iScore] - maxScore);
+               pScores[iScore] = val;
+               sum += val;
+            }
+            const double invSum = 1.0 / sum;
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               pScores[iScore] *= invSum;
+            }
+         }
+         break;
+      case Link_vlogit:
+      case Link_logit:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = 1.0 / (1.0 + std::exp(-aScores[iVal]));
+         }
+         break;
+      case Link_probit:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = 0.5 * std::erfc(aScores[iVal] * -0.70710678118654752440);
+         }
+         break;
+      case Link_cloglog:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = 1.0 - std::exp(-std::exp(aScores[iVal]));
+         }
+         break;
+      case Link_loglog:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = std::exp(-std::exp(-aScores[iVal]));
+         }
+         break;
+      case Link_cauchit:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = 0.5 + std::atan(aScores[iVal]) * 0.31830988618379067154;
+         }
+         break;
+      case Link_power:
+         if(0.0 == linkParam) {
+            for(size_t iVal = 0; iVal < cVals; ++iVal) {
+               aScores[iVal] = std::exp(aScores[iVal]);
+            }
+         } else {
+            const double invPower = 1.0 / linkParam;
+            for(size_t iVal = 0; iVal < cVals; ++iVal) {
+               aScores[iVal] = std::pow(aScores[iVal], invPower);
+            }
+         }
+         break;
+      case Link_identity:
+         break;
+      case Link_log:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = std::exp(aScores[iVal]);
+         }
+         break;
+      case Link_inverse:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = 1.0 / aScores[iVal];
+         }
+         break;
+      case Link_inverse_square:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = 1.0 / std::sqrt(aScores[iVal]);
+         }
+         break;
+      case Link_sqrt:
+         for(size_t iVal = 0; iVal < cVals; ++iVal) {
+            aScores[iVal] = aScores[iVal] * aScores[iVal];
+         }
+         break;
+      default:
+         break;
+   }
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreatePredictor(LinkEbm link,
+      double linkParam,
+      IntEbm countScores,
+      const double* intercept,
+      IntEbm countFeatures,
+      const IntEbm* countBins,
+      const IntEbm* countCuts,
+      const double* cutsLowerBoundInclusive,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      const double* termScores,
+      PredictorHandle* predictorHandleOut) {
+   LOG_N(Trace_Info,
+         "Entered CreatePredictor: "
+         "link=%" LinkEbmPrintf ", "
+         "linkParam=%le, "
+         "countScores=%" IntEbmPrintf ", "
+         "intercept=%p, "
+         "countFeatures=%" IntEbmPrintf ", "
+         "countBins=%p, "
+         "countCuts=%p, "
+         "cutsLowerBoundInclusive=%p, "
+         "countTerms=%" IntEbmPrintf ", "
+         "dimensionCounts=%p, "
+         "featureIndexes=%p, "
+         "termScores=%p, "
+         "predictorHandleOut=%p",
+         link,
+         linkParam,
+         countScores,
+         static_cast<const void*>(intercept),
+         countFeatures,
+         static_cast<const void*>(countBins),
+         static_cast<const void*>(countCuts),
+         static_cast<const void*>(cutsLowerBoundInclusive),
+         countTerms,
+         static_cast<const void*>(dimensionCounts),
+         static_cast<const void*>(featureIndexes),
+         static_cast<const void*>(termScores),
+         static_cast<void*>(predictorHandleOut));
+
+   if(UNLIKELY(nullptr == predictorHandleOut)) {
+      LOG_0(Trace_Error, "ERROR CreatePredictor nullptr == predictorHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *predictorHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   Predictor* pPredictor = nullptr;
+   const ErrorEbm error = Predictor::Create(link,
+         linkParam,
+         countScores,
+         intercept,
+         countFeatures,
+         countBins,
+         countCuts,
+         cutsLowerBoundInclusive,
+         countTerms,
+         dimensionCounts,
+         featureIndexes,
+         termScores,
+         &pPredictor);
+   if(Error_None != error) {
+      return error;
+   }
+
+   *predictorHandleOut = pPredictor->GetHandle();
+
+   LOG_N(Trace_Info, "Exited CreatePredictor: *predictorHandleOut=%p", static_cast<void*>(*predictorHandleOut));
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreatePredictorFromBooster(BoosterHandle boosterHandle,
+      const IntEbm* countCuts,
+      const double* cutsLowerBoundInclusive,
+      const double* intercept,
+      PredictorHandle* predictorHandleOut) {
+   LOG_N(Trace_Info,
+         "Entered CreatePredictorFromBooster: "
+         "boosterHandle=%p, "
+         "countCuts=%p, "
+         "cutsLowerBoundInclusive=%p, "
+         "intercept=%p, "
+         "predictorHandleOut=%p",
+         static_cast<void*>(boosterHandle),
+         static_cast<const void*>(countCuts),
+         static_cast<const void*>(cutsLowerBoundInclusive),
+         static_cast<const void*>(intercept),
+         static_cast<void*>(predictorHandleOut));
+
+   if(UNLIKELY(nullptr == predictorHandleOut)) {
+      LOG_0(Trace_Error, "ERROR CreatePredictorFromBooster nullptr == predictorHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *predictorHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+   const BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   const size_t cScores = pBoosterCore->GetCountScores();
+   const size_t cFeatures = pBoosterCore->GetCountFeatures();
+   const size_t cTerms = pBoosterCore->GetCountTerms();
+   const FeatureBoosting* const aFeatures = pBoosterCore->GetFeatures();
+
+   // the booster only knows the binned features, so the caller supplies the cuts that made the bins
+   if(size_t{0} != cFeatures && nullptr == countCuts) {
+      LOG_0(Trace_Error, "ERROR CreatePredictorFromBooster nullptr == countCuts");
+      return Error_IllegalParamVal;
+   }
+
+   size_t cDimensionsTotal = 0;
+   size_t cTermScoresTotal = 0;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const Term* const pTerm = pBoosterCore->GetTerms()[iTerm];
+      const size_t cDimensions = pTerm->GetCountDimensions();
+      size_t cTensorScores = cScores;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         const FeatureBoosting* const pFeature = pTerm->GetTermFeatures()[iDimension].m_pFeature;
+         if(pFeature->IsNominal()) {
+            LOG_0(Trace_Error, "ERROR CreatePredictorFromBooster nominal features cannot be binned with cuts");
+            return Error_IllegalParamVal;
+         }
+         // the external tensor always has the missing and unknown bins even where the booster dropped them
+         const size_t cBins = pFeature->GetCountBins() + (pFeature->IsMissing() ? size_t{0} : size_t{1}) +
+               (pFeature->IsUnknown() ? size_t{0} : size_t{1});
+         if(UNLIKELY(IsMultiplyError(cTensorScores, cBins))) {
+            LOG_0(Trace_Warning, "WARNING CreatePredictorFromBooster IsMultiplyError(cTensorScores, cBins)");
+            return Error_OutOfMemory;
+         }
+         cTensorScores *= cBins;
+      }
+      cDimensionsTotal += cDimensions;
+      if(UNLIKELY(IsAddError(cTermScoresTotal, cTensorScores))) {
+         LOG_0(Trace_Warning, "WARNING CreatePredictorFromBooster IsAddError(cTermScoresTotal, cTensorScores)");
+         return Error_OutOfMemory;
+      }
+      cTermScoresTotal += cTensorScores;
+   }
+
+   if(UNLIKELY(IsAddError(cFeatures, cTerms, cDimensionsTotal) ||
+            IsMultiplyError(sizeof(IntEbm), cFeatures + cTerms + cDimensionsTotal) ||
+            IsMultiplyError(sizeof(double), cTermScoresTotal))) {
+      LOG_0(Trace_Warning, "WARNING CreatePredictorFromBooster the model does not fit into memory");
+      return Error_OutOfMemory;
+   }
+   IntEbm* const aIndexes = static_cast<IntEbm*>(malloc(sizeof(IntEbm) * (cFeatures + cTerms + cDimensionsTotal)));
+   if(UNLIKELY(nullptr == aIndexes)) {
+      LOG_0(Trace_Warning, "WARNING CreatePredictorFromBooster nullptr == aIndexes");
+      return Error_OutOfMemory;
+   }
+   IntEbm* const acBins = aIndexes;
+   IntEbm* const acDimensions = acBins + cFeatures;
+   IntEbm* const aiFeatures = acDimensions + cTerms;
+
+   double* aTermScores = nullptr;
+   if(size_t{0} != cTermScoresTotal) {
+      aTermScores = static_cast<double*>(malloc(sizeof(double) * cTermScoresTotal));
+      if(UNLIKELY(nullptr == aTermScores)) {
+         LOG_0(Trace_Warning, "WARNING CreatePredictorFromBooster nullptr == aTermScores");
+         free(aIndexes);
+         return Error_OutOfMemory;
+      }
+   }
+
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const FeatureBoosting* const pFeature = &aFeatures[iFeature];
+      acBins[iFeature] = static_cast<IntEbm>(pFeature->GetCountBins() +
+            (pFeature->IsMissing() ? size_t{0} : size_t{1}) + (pFeature->IsUnknown() ? size_t{0} : size_t{1}));
+   }
+
+   IntEbm* piFeature = aiFeatures;
+   double* pTermScores = aTermScores;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const Term* const pTerm = pBoosterCore->GetTerms()[iTerm];
+      const size_t cDimensions = pTerm->GetCountDimensions();
+      acDimensions[iTerm] = static_cast<IntEbm>(cDimensions);
+
+      // the term features are in the order given to CreateBooster, which is also the dimension order of the tensor
+      // that Transpose writes for GetBestTermScores
+      const TermFeature* const aTermFeatures = pTerm->GetTermFeatures();
+      size_t cTensorScores = cScores;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         const size_t iFeature = static_cast<size_t>(aTermFeatures[iDimension].m_pFeature - aFeatures);
+         *piFeature = static_cast<IntEbm>(iFeature);
+         ++piFeature;
+         cTensorScores *= static_cast<size_t>(acBins[iFeature]);
+      }
+
+      if(size_t{0} != cTensorScores) {
+         if(size_t{0} == pTerm->GetCountTensorBins()) {
+            // the booster holds no tensor when a feature has no bins, which means the term contributes nothing
+            for(size_t iScore = 0; iScore < cTensorScores; ++iScore) {
+               pTermScores[iScore] = 0.0;
+            }
+         } else {
+            Tensor* const pTensor = pBoosterCore->GetBestModel()[iTerm];
+            EBM_ASSERT(nullptr != pTensor);
+            EBM_ASSERT(pTensor->GetExpanded()); // the tensor should have been expanded at startup
+            Transpose<true>(pTerm, cScores, pTermScores, pTensor->GetTensorScoresPointer());
+         }
+         pTermScores += cTensorScores;
+      }
+   }
+
+   // with zero scores every prediction is certain, and the booster has no objective to ask for its link
+   const LinkEbm link = size_t{0} == cScores ? Link_monoclassification : pBoosterCore->LinkFunction();
+   const double linkParam = size_t{0} == cScores ? 0.0 : pBoosterCore->LinkParam();
+
+   Predictor* pPredictor = nullptr;
+   const ErrorEbm error = Predictor::Create(link,
+         linkParam,
+         static_cast<IntEbm>(cScores),
+         intercept,
+         static_cast<IntEbm>(cFeatures),
+         acBins,
+         countCuts,
+         cutsLowerBoundInclusive,
+         static_cast<IntEbm>(cTerms),
+         acDimensions,
+         aiFeatures,
+         aTermScores,
+         &pPredictor);
+
+   free(aTermScores);
+   free(aIndexes);
+
+   if(Error_None != error) {
+      return error;
+   }
+
+   *predictorHandleOut = pPredictor->GetHandle();
+
+   LOG_N(Trace_Info,
+         "Exited CreatePredictorFromBooster: *predictorHandleOut=%p",
+         static_cast<void*>(*predictorHandleOut));
+
+   return Error_None;
+}
+
+static int g_cLogPredict = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Predict(PredictorHandle predictorHandle,
+      IntEbm countSamples,
+      const double* featureVals,
+      BoolEbm isRawScores,
+      double* predictionsOut) {
+   LOG_COUNTED_N(&g_cLogPredict,
+         Trace_Info,
+         Trace_Verbose,
+         "Predict: "
+         "predictorHandle=%p, "
+         "countSamples=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "isRawScores=%s, "
+         "predictionsOut=%p",
+         static_cast<void*>(predictorHandle),
+         countSamples,
+         static_cast<const void*>(featureVals),
+         ObtainTruth(isRawScores),
+         static_cast<void*>(predictionsOut));
+
+   const Predictor* const pPredictor = Predictor::GetPredictorFromHandle(predictorHandle);
+   if(nullptr == pPredictor) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(countSamples < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR Predict countSamples must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
+      LOG_0(Trace_Error, "ERROR Predict IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   const LinkEbm link = pPredictor->GetLink();
+   if(EBM_FALSE != isRawScores) {
+      if(EBM_TRUE != isRawScores) {
+         LOG_0(Trace_Error, "ERROR Predict isRawScores must be EBM_FALSE or EBM_TRUE");
+         return Error_IllegalParamVal;
+      }
+   } else if(UNLIKELY(!IsInverseLinkKnown(link))) {
+      LOG_0(Trace_Error, "ERROR Predict the link function has no built-in inverse, so only raw scores are available");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cScores = pPredictor->GetCountScores();
+   if(size_t{0} == cSamples || size_t{0} == cScores) {
+      return Error_None;
+   }
+
+   if(UNLIKELY(size_t{0} != pPredictor->GetCountFeatures() && nullptr == featureVals)) {
+      LOG_0(Trace_Error, "ERROR Predict nullptr == featureVals");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsMultiplyError(sizeof(*featureVals), cSamples, pPredictor->GetCountFeatures()))) {
+      LOG_0(Trace_Error, "ERROR Predict IsMultiplyError(sizeof(*featureVals), cSamples, cFeatures)");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == predictionsOut)) {
+      LOG_0(Trace_Error, "ERROR Predict nullptr == predictionsOut");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsMultiplyError(sizeof(*predictionsOut), cSamples, cScores))) {
+      LOG_0(Trace_Error, "ERROR Predict IsMultiplyError(sizeof(*predictionsOut), cSamples, cScores)");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cTasks = (cSamples - size_t{1}) / k_cPredictBlock + size_t{1};
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cTasks, &pThreadPool);
+   if(Error_None != error) {
+      return error;
+   }
+
+   const double linkParam = pPredictor->GetLinkParam();
+   auto predictBlock = [&](const size_t iTask, const size_t) -> ErrorEbm {
+      const size_t iSampleFirst = iTask * k_cPredictBlock;
+      const size_t cSamplesBlock = EbmMin(k_cPredictBlock, cSamples - iSampleFirst);
+      double* const aScores = predictionsOut + cScores * iSampleFirst;
+
+      pPredictor->ScoreBlock(cSamplesBlock, cSamples, featureVals + iSampleFirst, aScores);
+      if(EBM_FALSE == isRawScores) {
+         ApplyInverseLink(link, linkParam, cScores, cSamplesBlock, aScores);
+      }
+      return Error_None;
+   };
+   error = pThreadPool->Run(cTasks, predictBlock);
+
+   ThreadPool::Return(pThreadPool);
+
+   return error;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION PredictOne(
+      PredictorHandle predictorHandle, const double* featureVals, BoolEbm isRawScores, double* predictionsOut) {
+   // this is meant for latency sensitive callers, so unlike Predict it skips the entry logging and only checks what
+   // is needed to avoid bad memory accesses
+
+   const Predictor* const pPredictor = Predictor::GetPredictorFromHandle(predictorHandle);
+   if(nullptr == pPredictor) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   const LinkEbm link = pPredictor->GetLink();
+   if(EBM_FALSE == isRawScores) {
+      if(UNLIKELY(!IsInverseLinkKnown(link))) {
+         LOG_0(Trace_Error,
+               "ERROR PredictOne the link function has no built-in inverse, so only raw scores are available");
+         return Error_IllegalParamVal;
+      }
+   } else if(UNLIKELY(EBM_TRUE != isRawScores)) {
+      LOG_0(Trace_Error, "ERROR PredictOne isRawScores must be EBM_FALSE or EBM_TRUE");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cScores = pPredictor->GetCountScores();
+   if(size_t{0} == cScores) {
+      return Error_None;
+   }
+   if(UNLIKELY(size_t{0} != pPredictor->GetCountFeatures() && nullptr == featureVals)) {
+      LOG_0(Trace_Error, "ERROR PredictOne nullptr == featureVals");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == predictionsOut)) {
+      LOG_0(Trace_Error, "ERROR PredictOne nullptr == predictionsOut");
+      return Error_IllegalParamVal;
+   }
+
+   pPredictor->ScoreOne(featureVals, predictionsOut);
+   if(EBM_FALSE == isRawScores) {
+      ApplyInverseLink(link, pPredictor->GetLinkParam(), cScores, size_t{1}, predictionsOut);
+   }
+   return Error_None;
+}
+
+static int g_cLogPredictContributions = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION PredictContributions(PredictorHandle predictorHandle,
+      IntEbm countSamples,
+      const double* featureVals,
+      IntEbm countTop,
+      double* scoresOut,
+      double* contributionsOut,
+      IntEbm* termIndexesOut) {
+   LOG_COUNTED_N(&g_cLogPredictContributions,
+         Trace_Info,
+         Trace_Verbose,
+         "PredictContributions: "
+         "predictorHandle=%p, "
+         "countSamples=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "countTop=%" IntEbmPrintf ", "
+         "scoresOut=%p, "
+         "contributionsOut=%p, "
+         "termIndexesOut=%p",
+         static_cast<void*>(predictorHandle),
+         countSamples,
+         static_cast<const void*>(featureVals),
+         countTop,
+         static_cast<void*>(scoresOut),
+         static_cast<void*>(contributionsOut),
+         static_cast<void*>(termIndexesOut));
+
+   const Predictor* const pPredictor = Predictor::GetPredictorFromHandle(predictorHandle);
+   if(nullptr == pPredictor) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(countSamples < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR PredictContributions countSamples must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
+      LOG_0(Trace_Error, "ERROR PredictContributions IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   const size_t cTerms = pPredictor->GetCountTerms();
+   if(UNLIKELY(countTop < IntEbm{0})) {
+      LOG_0(Trace_Error, "ERROR PredictContributions countTop must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(static_cast<IntEbm>(cTerms) < countTop)) {
+      LOG_0(Trace_Error, "ERROR PredictContributions countTop cannot exceed the number of terms");
+      return Error_IllegalParamVal;
+   }
+   // zero means every term in term order, which needs no ranking
+   const bool bTop = IntEbm{0} != countTop;
+   const size_t cTop = bTop ? static_cast<size_t>(countTop) : cTerms;
+
+   const size_t cScores = pPredictor->GetCountScores();
+   if(size_t{0} == cSamples || size_t{0} == cScores) {
+      return Error_None;
+   }
+
+   if(UNLIKELY(size_t{0} != pPredictor->GetCountFeatures() && nullptr == featureVals)) {
+      LOG_0(Trace_Error, "ERROR PredictContributions nullptr == featureVals");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsMultiplyError(sizeof(*featureVals), cSamples, pPredictor->GetCountFeatures()))) {
+      LOG_0(Trace_Error, "ERROR PredictContributions IsMultiplyError(sizeof(*featureVals), cSamples, cFeatures)");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsMultiplyError(sizeof(double), cSamples, cScores, cTerms))) {
+      LOG_0(Trace_Error, "ERROR PredictContributions IsMultiplyError(sizeof(double), cSamples, cScores, cTerms)");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(size_t{0} != cTop && nullptr == contributionsOut)) {
+      LOG_0(Trace_Error, "ERROR PredictContributions nullptr == contributionsOut");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(bTop && nullptr == termIndexesOut)) {
+      LOG_0(Trace_Error, "ERROR PredictContributions nullptr == termIndexesOut");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cTasks = (cSamples - size_t{1}) / k_cPredictBlock + size_t{1};
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cTasks, &pThreadPool);
+   if(Error_None != error) {
+      return error;
+   }
+
+   const size_t cSampleContributions = cScores * cTerms;
+
+   // to keep only the top terms, each thread needs room for the contributions of k_cContributeBlock samples and for
+   // the term order of one sample
+   double* aScratch = nullptr;
+   size_t* aiTermsScratch = nullptr;
+   if(bTop) {
+      const size_t cThreads = pThreadPool->GetCountThreads();
+      if(IsMultiplyError(sizeof(double), k_cContributeBlock, cSampleContributions, cThreads) ||
+            IsMultiplyError(sizeof(size_t), cTerms, cThreads)) {
+         LOG_0(Trace_Warning, "WARNING PredictContributions the scratch space does not fit into memory");
+         ThreadPool::Return(pThreadPool);
+         return Error_OutOfMemory;
+      }
+      aScratch = static_cast<double*>(malloc(sizeof(double) * k_cContributeBlock * cSampleContributions * cThreads));
+      aiTermsScratch = static_cast<size_t*>(malloc(sizeof(size_t) * cTerms * cThreads));
+      if(nullptr == aScratch || nullptr == aiTermsScratch) {
+         LOG_0(Trace_Warning, "WARNING PredictContributions nullptr == aScratch || nullptr == aiTermsScratch");
+         free(aScratch);
+         free(aiTermsScratch);
+         ThreadPool::Return(pThreadPool);
+         return Error_OutOfMemory;
+      }
+   }
+
+   const double* const aIntercept = pPredictor->GetIntercept();
+   auto contributeBlock = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      const size_t iSampleTask = iTask * k_cPredictBlock;
+      const size_t iSampleTaskEnd = EbmMin(iSampleTask + k_cPredictBlock, cSamples);
+
+      // without ranking, the gathered contributions are exactly the output so they go straight into caller memory
+      const size_t cSamplesChunk = bTop ? k_cContributeBlock : k_cPredictBlock;
+      double* const aThreadScratch = bTop ? aScratch + k_cContributeBlock * cSampleContributions * iThread : nullptr;
+      size_t* const aiTerms = bTop ? aiTermsScratch + cTerms * iThread : nullptr;
+
+      for(size_t iSampleFirst = iSampleTask; iSampleFirst < iSampleTaskEnd; iSampleFirst += cSamplesChunk) {
+         const size_t cSamplesBlock = EbmMin(cSamplesChunk, iSampleTaskEnd - iSampleFirst);
+         double* const aContributions =
+               bTop ? aThreadScratch : contributionsOut + cSampleContributions * iSampleFirst;
+         pPredictor->ContributeBlock(cSamplesBlock, cSamples, featureVals + iSampleFirst, aContributions);
+
+         for(size_t iSampleBlock = 0; iSampleBlock < cSamplesBlock; ++iSampleBlock) {
+            const size_t iSample = iSampleFirst + iSampleBlock;
+            const double* const aSampleContributions = aContributions + cSampleContributions * iSampleBlock;
+
+            if(nullptr != scoresOut) {
+               // summed in the same order as ScoreBlock so that the scores match Predict exactly
+               double* const aSampleScores = scoresOut + cScores * iSample;
+               for(size_t iScore = 0; iScore < cScores; ++iScore) {
+                  aSampleScores[iScore] = aIntercept[iScore];
+               }
+               for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+                  for(size_t iScore = 0; iScore < cScores; ++iScore) {
+                     aSampleScores[iScore] += aSampleContributions[cScores * iTerm + iScore];
+                  }
+               }
+            }
+
+            if(bTop) {
+               // the terms are ranked by the sum of the absolute values of their scores, which for a single score
+               // is simply the magnitude. Ties go to the lower term index so that the result is deterministic
+               for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+                  aiTerms[iTerm] = iTerm;
+               }
+               auto magnitude = [aSampleContributions, cScores](const size_t iTerm) {
+                  double sum = 0.0;
+                  for(size_t iScore = 0; iScore < cScores; ++iScore) {
+                     sum += std::abs(aSampleContributions[cScores * iTerm + iScore]);
+                  }
+                  return sum;
+               };
+               std::partial_sort(
+                     aiTerms, aiTerms + cTop, aiTerms + cTerms, [&](const size_t iLeft, const size_t iRight) {
+                        const double left = magnitude(iLeft);
+                        const double right = magnitude(iRight);
+                        return right < left || (left == right && iLeft < iRight);
+                     });
+
+               double* pTopContributions = contributionsOut + cScores * cTop * iSample;
+               IntEbm* pTopTerms = termIndexesOut + cTop * iSample;
+               for(size_t iTop = 0; iTop < cTop; ++iTop) {
+                  const size_t iTerm = aiTerms[iTop];
+                  *pTopTerms = static_cast<IntEbm>(iTerm);
+                  ++pTopTerms;
+                  for(size_t iScore = 0; iScore < cScores; ++iScore) {
+                     *pTopContributions = aSampleContributions[cScores * iTerm + iScore];
+                     ++pTopContributions;
+                  }
+               }
+            }
+         }
+      }
+      return Error_None;
+   };
+   error = pThreadPool->Run(cTasks, contributeBlock);
+
+   ThreadPool::Return(pThreadPool);
+
+   free(aScratch);
+   free(aiTermsScratch);
+
+   return error;
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION FreePredictor(PredictorHandle predictorHandle) {
+   LOG_N(Trace_Info, "Entered FreePredictor: predictorHandle=%p", static_cast<void*>(predictorHandle));
+
+   Predictor* const pPredictor = Predictor::GetPredictorFromHandle(predictorHandle);
+   // if the conversion above doesn't work, it'll return null, and our free will not in fact free any memory,
+   // but it will not crash. We'll leak memory, but at least we'll log that.
+
+   // it's legal to call free on nullptr, just like for free().  This is checked inside Predictor::Free()
+   Predictor::Free(pPredictor);
+
+   LOG_0(Trace_Info, "Exited FreePredictor");
+}
+
+} // namespace DEFINED_ZONE_NAME
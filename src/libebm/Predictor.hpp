@@ -0,0 +1,187 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef PREDICTOR_HPP
+#define PREDICTOR_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <type_traits> // std::is_standard_layout
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // INLINE_ALWAYS
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+struct PredictorFeature final {
+   PredictorFeature() = default; // preserve our POD status
+   ~PredictorFeature() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   // the cuts are held as an Eytzinger tree (see Discretize.hpp) of 2^m_cLevels doubles
+   size_t m_cLevels;
+   size_t m_iTree;
+   size_t m_cBins;
+};
+static_assert(std::is_standard_layout<PredictorFeature>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<PredictorFeature>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+struct PredictorDimension final {
+   PredictorDimension() = default; // preserve our POD status
+   ~PredictorDimension() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   size_t m_iFeature;
+   // the number of doubles between a bin and the next bin of this dimension in the term's tensor
+   size_t m_cStride;
+};
+static_assert(std::is_standard_layout<PredictorDimension>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<PredictorDimension>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+struct PredictorTerm final {
+   PredictorTerm() = default; // preserve our POD status
+   ~PredictorTerm() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   size_t m_cDimensions;
+   size_t m_iDimensionFirst;
+   size_t m_iTensor;
+};
+static_assert(std::is_standard_layout<PredictorTerm>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<PredictorTerm>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+// A Predictor is a single cache line aligned allocation that begins with this object and holds everything needed to
+// score a model: the feature, term and dimension descriptions, followed by the intercept, the Eytzinger trees of the
+// cuts, and the term tensors in the GetBestTermScores layout.  Create drops every cut whose two neighbouring bins
+// score the same in all the terms that use the feature, which shrinks both the trees and the tensors without changing
+// any prediction.  Nothing is allocated or modified after creation, so any number of threads can score with the same
+// Predictor at once.
+class Predictor final {
+   static constexpr size_t k_handleVerificationOk = 17413; // random 15 bit number
+   static constexpr size_t k_handleVerificationFreed = 6217; // random 15 bit number
+   size_t m_handleVerification; // this needs to be at the top and make it pointer sized to keep best alignment
+
+   LinkEbm m_link;
+   double m_linkParam;
+   size_t m_cScores;
+   size_t m_cFeatures;
+   size_t m_cTerms;
+
+   const PredictorFeature* m_aFeatures;
+   const PredictorTerm* m_aTerms;
+   const PredictorDimension* m_aDimensions;
+   const double* m_aIntercept;
+   // the Eytzinger trees and term tensors are indexed from here
+   const double* m_aDoubles;
+
+   // Build makes the Predictor exactly as described, which Create then compacts
+   static ErrorEbm Build(const LinkEbm link,
+         const double linkParam,
+         const IntEbm countScores,
+         const double* const intercept,
+         const IntEbm countFeatures,
+         const IntEbm* const countBins,
+         const IntEbm* const countCuts,
+         const double* const cutsLowerBoundInclusive,
+         const IntEbm countTerms,
+         const IntEbm* const dimensionCounts,
+         const IntEbm* const featureIndexes,
+         const double* const termScores,
+         Predictor** const ppPredictorOut);
+
+   // aiCellOut receives the tensor offset of pTerm's cell for each of the cLanes samples starting at featureVals
+   void GatherCells(const PredictorTerm* const pTerm,
+         const size_t cLanes,
+         const size_t cSamplesStride,
+         const double* const featureVals,
+         size_t* const aiCellOut) const;
+
+ public:
+   Predictor() = default; // preserve our POD status
+   ~Predictor() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   static ErrorEbm Create(const LinkEbm link,
+         const double linkParam,
+         const IntEbm countScores,
+         const double* const intercept,
+         const IntEbm countFeatures,
+         const IntEbm* const countBins,
+         const IntEbm* const countCuts,
+         const double* const cutsLowerBoundInclusive,
+         const IntEbm countTerms,
+         const IntEbm* const dimensionCounts,
+         const IntEbm* const featureIndexes,
+         const double* const termScores,
+         Predictor** const ppPredictorOut);
+   static void Free(Predictor* const pPredictor);
+
+   INLINE_ALWAYS static Predictor* GetPredictorFromHandle(const PredictorHandle predictorHandle) {
+      if(nullptr == predictorHandle) {
+         LOG_0(Trace_Error, "ERROR GetPredictorFromHandle null predictorHandle");
+         return nullptr;
+      }
+      Predictor* const pPredictor = reinterpret_cast<Predictor*>(predictorHandle);
+      if(k_handleVerificationOk == pPredictor->m_handleVerification) {
+         return pPredictor;
+      }
+      if(k_handleVerificationFreed == pPredictor->m_handleVerification) {
+         LOG_0(Trace_Error, "ERROR GetPredictorFromHandle attempt to use freed PredictorHandle");
+      } else {
+         LOG_0(Trace_Error, "ERROR GetPredictorFromHandle attempt to use invalid PredictorHandle");
+      }
+      return nullptr;
+   }
+   INLINE_ALWAYS PredictorHandle GetHandle() { return reinterpret_cast<PredictorHandle>(this); }
+
+   INLINE_ALWAYS LinkEbm GetLink() const { return m_link; }
+   INLINE_ALWAYS double GetLinkParam() const { return m_linkParam; }
+   INLINE_ALWAYS size_t GetCountScores() const { return m_cScores; }
+   INLINE_ALWAYS size_t GetCountFeatures() const { return m_cFeatures; }
+   INLINE_ALWAYS size_t GetCountTerms() const { return m_cTerms; }
+   INLINE_ALWAYS const double* GetIntercept() const { return m_aIntercept; }
+
+   // scoresOut receives GetCountScores() scores for each of the cSamples samples.  featureVals is column-major, with
+   // the column of each feature starting cSamplesStride values after the previous feature's column
+   void ScoreBlock(const size_t cSamples,
+         const size_t cSamplesStride,
+         const double* const featureVals,
+         double* const scoresOut) const;
+
+   // contributionsOut receives GetCountTerms() * GetCountScores() values for each of the cSamples samples, which are
+   // the scores that each term adds to the sample in term order.  featureVals is laid out as in ScoreBlock
+   void ContributeBlock(const size_t cSamples,
+         const size_t cSamplesStride,
+         const double* const featureVals,
+         double* const contributionsOut) const;
+
+   // scoresOut receives GetCountScores() scores for the single sample whose value for each feature is in row.  This
+   // allocates nothing and takes no locks, so it suits scoring requests one at a time
+   void ScoreOne(const double* const row, double* const scoresOut) const;
+};
+static_assert(std::is_standard_layout<Predictor>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<Predictor>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+// converts the cScores scores of each sample in place from the additive scale into predictions
+extern void ApplyInverseLink(
+      const LinkEbm link, const double linkParam, const size_t cScores, const size_t cSamples, double* const aScores);
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // PREDICTOR_HPP
@@ -0,0 +1,1123 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memcpy
+#include <new> // std::bad_alloc
+
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError, IsMultiplyError
+#include "Bin.hpp" // IsOverflowBinSize
+
+#include "ebm_internal.hpp"
+#include "dataset_shared.hpp" // GetDataSetSharedHeader
+#include "Feature.hpp" // Feature
+#include "Term.hpp" // Term
+#include "TreeNode.hpp" // IsOverflowTreeNodeSize
+#include "SplitPosition.hpp" // IsOverflowSplitPositionSize
+#include "ThreadPool.hpp"
+#include "PreparedTrainingData.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// below this many samples per subset the cost of waking the workers and reducing each subset's fast bins into the
+// main bins exceeds the time saved by working on the subsets in parallel
+static constexpr size_t k_cSamplesPerSubsetMin = size_t{65536};
+// enough subsets to keep the threads on large machines evenly loaded
+static constexpr size_t k_cSubsetsParallel = size_t{256};
+// keep the subsets a multiple of this so that no subset except the last hands a tail to the CPU zone
+static constexpr size_t k_cSubsetSamplesMultiple = size_t{64};
+
+static size_t GetSubsetSamplesMax(const size_t cSamples, const size_t cSubsetSamplesLimit) {
+   // Subsets are sized from the sample count alone and never from the number of threads. Histograms and metrics are
+   // summed per subset and then combined in subset order, so this keeps the results bit-identical on any machine.
+   size_t cSubsetSamplesMax = cSubsetSamplesLimit;
+   if(k_cSamplesPerSubsetMin < cSamples) {
+      size_t cSamplesPerSubset = cSamples / k_cSubsetsParallel + size_t{1};
+      cSamplesPerSubset = EbmMax(cSamplesPerSubset, k_cSamplesPerSubsetMin);
+      cSamplesPerSubset = (cSamplesPerSubset + k_cSubsetSamplesMultiple - 1) / k_cSubsetSamplesMultiple *
+            k_cSubsetSamplesMultiple;
+      cSubsetSamplesMax = EbmMin(cSubsetSamplesMax, cSamplesPerSubset);
+   }
+   return cSubsetSamplesMax;
+}
+
+extern ErrorEbm Unbag(const size_t cSamples,
+      const BagEbm* const aBag,
+      size_t* const pcTrainingSamplesOut,
+      size_t* const pcValidationSamplesOut);
+
+extern size_t GetParallelBinBytesMax(const bool bHessian, const size_t cScores, const size_t cSIMDPack);
+
+NEVER_INLINE extern ErrorEbm GetObjective(const Config* const pConfig,
+      const char* sObjective,
+      const AccelerationFlags acceleration,
+      ObjectiveWrapper* const pCpuObjectiveWrapperOut,
+      ObjectiveWrapper* const pSIMDObjectiveWrapperOut) noexcept;
+
+PreparedTrainingData::~PreparedTrainingData() {
+   // this only gets called after our reference count has been decremented to zero
+
+   m_trainingSet.DestructDataSetBoosting(m_cTerms, m_cCachedInnerBags);
+   m_validationSet.DestructDataSetBoosting(m_cTerms, 0);
+
+   free(m_aBag);
+
+   Term::FreeTerms(m_cTerms, m_apTerms);
+
+   free(m_aFeatures);
+
+   FreeObjectiveWrapperInternals(&m_objectiveCpu);
+   FreeObjectiveWrapperInternals(&m_objectiveSIMD);
+}
+
+void PreparedTrainingData::Free(PreparedTrainingData* const pPreparedTrainingData) {
+   LOG_0(Trace_Info, "Entered PreparedTrainingData::Free");
+   if(nullptr != pPreparedTrainingData) {
+      // see BoosterCore::Free for the memory ordering
+      if(size_t{1} == pPreparedTrainingData->m_REFERENCE_COUNT.fetch_sub(1, std::memory_order_release)) {
+         std::atomic_thread_fence(std::memory_order_acquire);
+         LOG_0(Trace_Info, "INFO PreparedTrainingData::Free deleting PreparedTrainingData");
+         delete pPreparedTrainingData;
+      }
+   }
+   LOG_0(Trace_Info, "Exited PreparedTrainingData::Free");
+}
+
+bool PreparedTrainingData::LookupCachedBags(void* const rng, const size_t cInnerBags) {
+   if(size_t{0} != cInnerBags && nullptr == rng) {
+      // the bags are drawn non-deterministically, so no other booster can have the same ones
+      return false;
+   }
+
+   std::lock_guard<std::mutex> lock(m_mutexBags);
+   if(!m_bBagsCached || cInnerBags != m_cCachedInnerBags) {
+      return false;
+   }
+   if(size_t{0} != cInnerBags) {
+      // without inner bags the RNG is not used, so any state matches
+      RandomDeterministic* const pRng = reinterpret_cast<RandomDeterministic*>(rng);
+      if(!pRng->IsSameState(m_rngBagsBefore)) {
+         return false;
+      }
+      pRng->Initialize(m_rngBagsAfter);
+   }
+   LOG_0(Trace_Info, "INFO PreparedTrainingData::LookupCachedBags copying the cached inner bags");
+   return true;
+}
+
+void PreparedTrainingData::CacheBags(const RandomDeterministic* const pRngBefore,
+      const void* const rng,
+      const size_t cInnerBags,
+      const DataSetBoosting* const pTrainingSet) {
+   if(size_t{0} != cInnerBags && nullptr == rng) {
+      return;
+   }
+   EBM_ASSERT(nullptr == rng || nullptr != pRngBefore);
+
+   std::lock_guard<std::mutex> lock(m_mutexBags);
+   if(m_bBagsCacheTried) {
+      return;
+   }
+   // anything allocated is freed with this count, even if we fail part way through
+   m_bBagsCacheTried = true;
+   m_cCachedInnerBags = cInnerBags;
+
+   const ErrorEbm error = m_trainingSet.CacheBags(pTrainingSet, cInnerBags, m_cTerms, m_apTerms);
+   if(Error_None != error) {
+      // the cache only saves time, so the booster that offered its bags does not need to fail
+      LOG_0(Trace_Warning, "WARNING PreparedTrainingData::CacheBags unable to cache the inner bags");
+      return;
+   }
+
+   if(nullptr != rng) {
+      m_rngBagsBefore.Initialize(*pRngBefore);
+      m_rngBagsAfter.Initialize(*reinterpret_cast<const RandomDeterministic*>(rng));
+   }
+   m_bBagsCached = true;
+}
+
+template<typename TUInt>
+static bool CheckBoosterRestrictionsInternal(
+      const size_t cScores, const ObjectiveWrapper* const pObjectiveWrapper, const size_t cTensorBinsMax) {
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(nullptr != pObjectiveWrapper);
+
+   if(IsConvertError<TUInt>(cScores)) {
+      // restriction from LogLossMulticlassObjective.hpp
+      // we cast the cScores value into a SIMD type before later multiplying.  If cScores was 1 + the max SIMD type
+      // value then it could overflow back to 0 before the multiplication. Normally this would be very rare, but
+      // we need to consider adversarial inputs to make this crash.
+
+      return true;
+   }
+
+   const bool bHessian = EBM_FALSE != pObjectiveWrapper->m_bObjectiveHasHessian;
+
+   // In BinSumsBoosting we calculate the BinSize value and put it into a SIMD pack, so it needs to fit
+   size_t cBytes;
+   if(sizeof(FloatBig) == pObjectiveWrapper->m_cFloatBytes) {
+      if(IsOverflowBinSize<FloatBig, TUInt>(false, false, bHessian, cScores)) {
+         return true;
+      }
+      cBytes = GetBinSize<FloatBig, TUInt>(false, false, bHessian, cScores);
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == pObjectiveWrapper->m_cFloatBytes);
+      if(IsOverflowBinSize<FloatSmall, TUInt>(false, false, bHessian, cScores)) {
+         return true;
+      }
+      cBytes = GetBinSize<FloatSmall, TUInt>(false, false, bHessian, cScores);
+   }
+
+   EBM_ASSERT(1 <= cTensorBinsMax); // since cTensorBins can only be 0 if cSamples or cTerms is 0, and we checked that
+   if(IsMultiplyError(cTensorBinsMax, EbmMax(cBytes, cScores))) {
+      return true;
+   }
+   if(IsConvertError<typename std::make_signed<TUInt>::type>(cTensorBinsMax * cScores - size_t{1})) {
+      // In all objectives we take the binned feature index and use it to lookup the score update in the update
+      // tensor. The lookup indexes are packed together in an array of SIMDable integers, so obviously the SIMDable
+      // integer needs to be large enough to hold the maximum feature index.
+      //
+      // Additionally, we use a SIMD gather operations in the objectives to load from the score update tensor, which
+      // use signed indexes, which means we need to restrict ourselves to the range of positive values.
+
+      return true;
+   }
+   cBytes *= cTensorBinsMax;
+   EBM_ASSERT(1 <= cBytes); // since cTensorBinsMax is non-zero
+   if(IsConvertError<TUInt>(cBytes - 1)) {
+      // In BinSumsBoosting we use the SIMD pack to hold an index to memory, so we need to be able to hold
+      // the entire fast bin tensor
+      return true;
+   }
+
+   if(size_t{1} != cScores) {
+      // TODO: we currently index into the gradient array using the target, but the gradient array is also
+      // layed out per-SIMD pack.  Once we sort the dataset by the target we'll be able to use non-random
+      // indexing to fetch all the sample targets simultaneously, and we'll no longer need this indexing
+      size_t cIndexes = cScores;
+      if(bHessian) {
+         if(IsMultiplyError(size_t{2}, cIndexes)) {
+            return true;
+         }
+         cIndexes <<= 1;
+      }
+      if(IsMultiplyError(cIndexes, pObjectiveWrapper->m_cSIMDPack)) {
+         return true;
+      }
+      // restriction from LogLossMulticlassObjective.hpp
+      // we use the target value to index into the temp exp array and adjust the target gradient
+      if(IsConvertError<typename std::make_signed<TUInt>::type>(
+               cIndexes * pObjectiveWrapper->m_cSIMDPack - size_t{1})) {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+static bool CheckBoosterRestrictions(
+      const size_t cScores, const ObjectiveWrapper* const pObjectiveWrapper, const size_t cTensorBinsMax) {
+   EBM_ASSERT(nullptr != pObjectiveWrapper);
+   if(sizeof(UIntBig) == pObjectiveWrapper->m_cUIntBytes) {
+      return CheckBoosterRestrictionsInternal<UIntBig>(cScores, pObjectiveWrapper, cTensorBinsMax);
+   } else {
+      EBM_ASSERT(sizeof(UIntSmall) == pObjectiveWrapper->m_cUIntBytes);
+      return CheckBoosterRestrictionsInternal<UIntSmall>(cScores, pObjectiveWrapper, cTensorBinsMax);
+   }
+}
+
+ErrorEbm PreparedTrainingData::Create(const size_t cTerms,
+      const double* const experimentalParams,
+      const IntEbm* const acTermDimensions,
+      const IntEbm* const aiTermFeatures,
+      const unsigned char* const pDataSetShared,
+      const BagEbm* const aBag,
+      const CreateBoosterFlags flags,
+      const AccelerationFlags acceleration,
+      const char* const sObjective,
+      PreparedTrainingData** const ppPreparedTrainingDataOut) {
+   // experimentalParams isn't used by default.  It's meant to provide an easy way for python or other higher
+   // level languages to pass EXPERIMENTAL temporary parameters easily to the C++ code.
+   UNUSED(experimentalParams);
+
+   LOG_0(Trace_Info, "Entered PreparedTrainingData::Create");
+
+   EBM_ASSERT(nullptr != ppPreparedTrainingDataOut);
+   EBM_ASSERT(nullptr == *ppPreparedTrainingDataOut);
+   EBM_ASSERT(nullptr != pDataSetShared);
+
+   ErrorEbm error;
+
+   PreparedTrainingData* pPreparedTrainingData;
+   try {
+      pPreparedTrainingData = new PreparedTrainingData();
+   } catch(const std::bad_alloc&) {
+      LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create Out of memory allocating PreparedTrainingData");
+      return Error_OutOfMemory;
+   } catch(...) {
+      LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create Unknown error");
+      return Error_UnexpectedInternal;
+   }
+   if(nullptr == pPreparedTrainingData) {
+      // this should be impossible since bad_alloc should have been thrown, but let's be untrusting
+      LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create nullptr == pPreparedTrainingData");
+      return Error_OutOfMemory;
+   }
+   // give ownership of our object back to the caller, even if there is a failure
+   *ppPreparedTrainingDataOut = pPreparedTrainingData;
+
+   pPreparedTrainingData->m_bUseApprox = CreateBoosterFlags_UseApprox & flags ? EBM_TRUE : EBM_FALSE;
+   pPreparedTrainingData->m_bValidationAuc = CreateBoosterFlags_ValidationAuc & flags ? EBM_TRUE : EBM_FALSE;
+   pPreparedTrainingData->m_bProfile = 0 != (CreateBoosterFlags_Profile & flags);
+   pPreparedTrainingData->m_bModelSnapshots = 0 != (CreateBoosterFlags_ModelSnapshots & flags);
+   pPreparedTrainingData->m_bOutOfBagMetric = 0 != (CreateBoosterFlags_OutOfBagMetric & flags);
+
+   UIntShared countSamples;
+   size_t cFeatures;
+   size_t cWeights;
+   size_t cTargets;
+   error = GetDataSetSharedHeader(pDataSetShared, &countSamples, &cFeatures, &cWeights, &cTargets);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR PreparedTrainingData::Create IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<UIntMain>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR PreparedTrainingData::Create IsConvertError<UIntMain>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   size_t cSamples = static_cast<size_t>(countSamples);
+
+   if(size_t{1} < cWeights) {
+      LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create size_t { 1 } < cWeights");
+      return Error_IllegalParamVal;
+   }
+   if(size_t{1} != cTargets) {
+      LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create 1 != cTargets");
+      return Error_IllegalParamVal;
+   }
+
+   LOG_0(Trace_Info, "PreparedTrainingData::Create starting feature processing");
+   if(0 != cFeatures) {
+      pPreparedTrainingData->m_cFeatures = cFeatures;
+
+      if(IsMultiplyError(sizeof(FeatureBoosting), cFeatures)) {
+         LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create IsMultiplyError(sizeof(Feature), cFeatures)");
+         return Error_OutOfMemory;
+      }
+      FeatureBoosting* const aFeatures = static_cast<FeatureBoosting*>(malloc(sizeof(FeatureBoosting) * cFeatures));
+      if(nullptr == aFeatures) {
+         LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create nullptr == aFeatures");
+         return Error_OutOfMemory;
+      }
+      pPreparedTrainingData->m_aFeatures = aFeatures;
+
+      size_t iFeatureInitialize = size_t{0};
+      do {
+         bool bMissing;
+         bool bUnknown;
+         bool bNominal;
+         bool bSparse;
+         UIntShared countBins;
+         UIntShared defaultValSparse;
+         size_t cNonDefaultsSparse;
+         size_t cBytesExternal;
+         GetDataSetSharedFeature(pDataSetShared,
+               iFeatureInitialize,
+               &bMissing,
+               &bUnknown,
+               &bNominal,
+               &bSparse,
+               &countBins,
+               &defaultValSparse,
+               &cNonDefaultsSparse,
+               &cBytesExternal);
+         EBM_ASSERT(!bSparse); // we do not handle yet
+         if(IsConvertError<size_t>(countBins)) {
+            LOG_0(Trace_Error, "ERROR PreparedTrainingData::Create IsConvertError<size_t>(countBins)");
+            return Error_IllegalParamVal;
+         }
+         if(IsConvertError<UIntSplit>(countBins)) {
+            LOG_0(Trace_Error, "ERROR PreparedTrainingData::Create IsConvertError<UIntSplit>(countBins)");
+            return Error_IllegalParamVal;
+         }
+         const size_t cBins = static_cast<size_t>(countBins);
+         if(0 == cBins) {
+            if(0 != cSamples) {
+               LOG_0(Trace_Error,
+                     "ERROR PreparedTrainingData::Create countBins cannot be zero unless there are zero samples");
+               return Error_IllegalParamVal;
+            }
+
+            // we can handle 0 == cBins even though that's a degenerate case that shouldn't be boosted on.  0 bins
+            // can only occur if there were zero training and zero validation cases since the
+            // features would require a value, even if it was 0.
+            LOG_0(Trace_Info, "INFO PreparedTrainingData::Create feature with 0 values");
+         } else if(1 == cBins) {
+            // Dimensions with 1 bin don't contribute anything to the model since they always have the same value, but
+            // the user can specify interactions, so we handle them anyways in a consistent way by boosting on them
+            LOG_0(Trace_Info, "INFO PreparedTrainingData::Create feature with 1 value");
+         }
+         aFeatures[iFeatureInitialize].Initialize(cBins, bMissing, bUnknown, bNominal);
+
+         ++iFeatureInitialize;
+      } while(cFeatures != iFeatureInitialize);
+   }
+   LOG_0(Trace_Info, "PreparedTrainingData::Create done feature processing");
+
+   size_t cTensorBinsMax = 0;
+   size_t cMainBinsMax = 0;
+   size_t cSingleDimensionBinsMax = 0;
+
+   LOG_0(Trace_Info, "PreparedTrainingData::Create starting term processing");
+   if(0 != cTerms) {
+      pPreparedTrainingData->m_cTerms = cTerms;
+      pPreparedTrainingData->m_apTerms = Term::AllocateTerms(cTerms);
+      if(UNLIKELY(nullptr == pPreparedTrainingData->m_apTerms)) {
+         LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create 0 != m_cTerms && nullptr == m_apTerms");
+         return Error_OutOfMemory;
+      }
+
+      const IntEbm* piTermFeature = aiTermFeatures;
+      size_t iTerm = 0;
+      do {
+         const IntEbm countDimensions = acTermDimensions[iTerm];
+         if(countDimensions < IntEbm{0}) {
+            LOG_0(Trace_Error, "ERROR PreparedTrainingData::Create countDimensions cannot be negative");
+            return Error_IllegalParamVal;
+         }
+         if(IntEbm{k_cDimensionsMax} < countDimensions) {
+            LOG_0(Trace_Warning,
+                  "WARNING PreparedTrainingData::Create countDimensions too large and would cause out of memory "
+                  "condition");
+            return Error_OutOfMemory;
+         }
+         const size_t cDimensions = static_cast<size_t>(countDimensions);
+         Term* const pTerm = Term::Allocate(cDimensions);
+         if(nullptr == pTerm) {
+            LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create nullptr == pTerm");
+            return Error_OutOfMemory;
+         }
+         // assign our pointer directly to our array right now so that we can't loose the memory if we decide to exit
+         // due to an error below
+         pPreparedTrainingData->m_apTerms[iTerm] = pTerm;
+
+         pTerm->SetCountAuxillaryBins(0); // we only use these for pairs, so otherwise it gets left as zero
+
+         size_t cAuxillaryBinsForBuildFastTotals = 0;
+         size_t cRealDimensions = 0;
+         int cBitsRequiredMin = 0;
+         size_t cTensorBins = 1;
+         if(UNLIKELY(0 == cDimensions)) {
+            LOG_0(Trace_Info, "INFO PreparedTrainingData::Create empty term");
+
+            cTensorBinsMax = EbmMax(cTensorBinsMax, size_t{1});
+            cMainBinsMax = EbmMax(cMainBinsMax, size_t{1});
+         } else {
+            if(nullptr == piTermFeature) {
+               LOG_0(Trace_Error,
+                     "ERROR PreparedTrainingData::Create aiTermFeatures cannot be NULL when there are Terms with "
+                     "non-zero numbers of features");
+               return Error_IllegalParamVal;
+            }
+            size_t cSingleDimensionBins = 0;
+            TermFeature* pTermFeature = pTerm->GetTermFeatures();
+            const TermFeature* const pTermFeaturesEnd = &pTermFeature[cDimensions];
+            // TODO: Ideally we would flip our input dimensions so that we're aligned with the output ordering
+            //       and thus not need a transpose when transfering data to the caller. We're doing it this way
+            //       for now to test the transpose ability and also to maintain the same results as before for
+            //       comparison
+            size_t iTranspose = cDimensions - 1;
+            do {
+               const IntEbm indexFeature = *piTermFeature;
+               if(indexFeature < IntEbm{0}) {
+                  LOG_0(Trace_Error, "ERROR PreparedTrainingData::Create aiTermFeatures value cannot be negative");
+                  return Error_IllegalParamVal;
+               }
+               if(IsConvertError<size_t>(indexFeature)) {
+                  LOG_0(Trace_Error,
+                        "ERROR PreparedTrainingData::Create aiTermFeatures value too big to reference memory");
+                  return Error_IllegalParamVal;
+               }
+               const size_t iFeature = static_cast<size_t>(indexFeature);
+
+               if(cFeatures <= iFeature) {
+                  LOG_0(Trace_Error,
+                        "ERROR PreparedTrainingData::Create aiTermFeatures value must be less than the number of "
+                        "features");
+                  return Error_IllegalParamVal;
+               }
+
+               EBM_ASSERT(1 <= cFeatures); // since our iFeature is valid and index 0 would mean cFeatures == 1
+               EBM_ASSERT(nullptr != pPreparedTrainingData->m_aFeatures);
+
+               // Clang does not seems to understand that iFeature is bound to the legal
+               // range of m_aFeatures through the check "cFeatures <= iFeature" above
+               StopClangAnalysis();
+
+               const FeatureBoosting* const pInputFeature = &pPreparedTrainingData->m_aFeatures[iFeature];
+               pTermFeature->m_pFeature = pInputFeature;
+               pTermFeature->m_cStride = cTensorBins;
+               pTermFeature->m_iTranspose = iTranspose; // TODO: no tranposition yet, but move it from python to C
+
+               const size_t cBins = pInputFeature->GetCountBins();
+               if(LIKELY(size_t{1} < cBins)) {
+                  // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting
+                  // tensor loses one dimension but is otherwise indistinquishable from the original data
+                  ++cRealDimensions;
+
+                  cSingleDimensionBins = cBins;
+
+                  if(IsMultiplyError(cTensorBins, cBins)) {
+                     // if this overflows, we definetly won't be able to allocate it
+                     LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create IsMultiplyError(cTensorStates, cBins)");
+                     return Error_OutOfMemory;
+                  }
+
+                  // mathematically, cTensorBins grows faster than cAuxillaryBinsForBuildFastTotals
+                  EBM_ASSERT(0 == cTensorBins || cAuxillaryBinsForBuildFastTotals < cTensorBins);
+
+                  // since cBins must be 2 or more, cAuxillaryBinsForBuildFastTotals must grow slower than
+                  // cTensorBins, and we checked above that cTensorBins would not overflow
+                  EBM_ASSERT(!IsAddError(cAuxillaryBinsForBuildFastTotals, cTensorBins));
+
+                  cAuxillaryBinsForBuildFastTotals += cTensorBins;
+               } else {
+                  LOG_0(Trace_Info, "INFO PreparedTrainingData::Create term with no useful features");
+               }
+               cTensorBins *= cBins;
+               // same reasoning as above: cAuxillaryBinsForBuildFastTotals grows slower than cTensorBins
+               EBM_ASSERT(0 == cTensorBins || cAuxillaryBinsForBuildFastTotals < cTensorBins);
+
+               --iTranspose;
+               ++piTermFeature;
+               ++pTermFeature;
+            } while(pTermFeaturesEnd != pTermFeature);
+
+            cTensorBinsMax = EbmMax(cTensorBinsMax, cTensorBins);
+            size_t cTotalMainBins = cTensorBins;
+            if(LIKELY(size_t{1} < cTensorBins)) {
+               EBM_ASSERT(1 <= cRealDimensions);
+
+               cBitsRequiredMin = CountBitsRequired(cTensorBins - size_t{1});
+               EBM_ASSERT(1 <= cBitsRequiredMin); // 1 < cTensorBins otherwise we'd have filtered it out above
+               EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(size_t));
+
+               if(size_t{1} == cRealDimensions) {
+                  cSingleDimensionBinsMax = EbmMax(cSingleDimensionBinsMax, cSingleDimensionBins);
+               } else {
+                  // we only use AuxillaryBins for pairs.  We wouldn't use them for random pairs, but we
+                  // don't know yet if the caller will set the random boosting flag on all pairs, so allocate it
+
+                  // we need to reserve 4 PAST the pointer we pass into SweepMultiDimensional!!!!.  We pass in index 20
+                  // at max, so we need 24
+                  static constexpr size_t cAuxillaryBinsForSplitting = 24;
+                  const size_t cAuxillaryBins = EbmMax(cAuxillaryBinsForBuildFastTotals, cAuxillaryBinsForSplitting);
+                  pTerm->SetCountAuxillaryBins(cAuxillaryBins);
+
+                  if(IsAddError(cTensorBins, cAuxillaryBins)) {
+                     LOG_0(Trace_Warning,
+                           "WARNING PreparedTrainingData::Create IsAddError(cTensorBins, cAuxillaryBins)");
+                     return Error_OutOfMemory;
+                  }
+                  cTotalMainBins += cAuxillaryBins;
+               }
+            } else {
+               EBM_ASSERT(0 == cRealDimensions);
+            }
+            cMainBinsMax = EbmMax(cMainBinsMax, cTotalMainBins);
+         }
+         pTerm->SetCountRealDimensions(cRealDimensions);
+         pTerm->SetBitsRequiredMin(cBitsRequiredMin);
+         pTerm->SetCountTensorBins(cTensorBins);
+
+         ++iTerm;
+      } while(iTerm < cTerms);
+   }
+   LOG_0(Trace_Info, "PreparedTrainingData::Create finished term processing");
+
+   ptrdiff_t cClasses;
+   const void* const aTargets = GetDataSetSharedTarget(pDataSetShared, 0, &cClasses);
+   if(nullptr == aTargets) {
+      LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create cClasses cannot fit into ptrdiff_t");
+      return Error_IllegalParamVal;
+   }
+
+   // having 1 class means that all predictions are perfect. In the C interface we reduce this into having 0 scores,
+   // which means that we do not write anything to our upper level callers, and we don't need a bunch of things
+   // since they have zero memory allocated to them. Having 0 classes means there are also 0 samples.
+   if(ptrdiff_t{0} != cClasses && ptrdiff_t{1} != cClasses) {
+      size_t cScores;
+      if(CreateBoosterFlags_BinaryAsMulticlass & flags) {
+         cScores = cClasses < ptrdiff_t{2} ? size_t{1} : static_cast<size_t>(cClasses);
+      } else {
+         cScores = cClasses <= ptrdiff_t{2} ? size_t{1} : static_cast<size_t>(cClasses);
+      }
+      pPreparedTrainingData->m_cScores = cScores;
+
+      LOG_0(Trace_Info, "INFO PreparedTrainingData::Create determining Objective");
+      Config config;
+      config.cOutputs = cScores;
+      config.isDifferentialPrivacy = CreateBoosterFlags_DifferentialPrivacy & flags ? EBM_TRUE : EBM_FALSE;
+      error = GetObjective(&config,
+            sObjective,
+            acceleration,
+            &pPreparedTrainingData->m_objectiveCpu,
+            &pPreparedTrainingData->m_objectiveSIMD);
+      if(Error_None != error) {
+         // already logged
+         return error;
+      }
+      LOG_0(Trace_Info, "INFO PreparedTrainingData::Create Objective determined");
+
+      const bool bRequireAcceleration = 0 != (CreateBoosterFlags_RequireAcceleration & flags);
+      if(bRequireAcceleration && AccelerationFlags_NONE != acceleration &&
+            nullptr == pPreparedTrainingData->m_objectiveSIMD.m_pObjective) {
+         LOG_0(Trace_Warning,
+               "WARNING PreparedTrainingData::Create CreateBoosterFlags_RequireAcceleration and no requested zone is "
+               "available for this objective");
+         return Error_UserParamVal;
+      }
+
+      if(0 != (CreateBoosterFlags_ConstantHessian & flags)) {
+         if(EBM_FALSE != pPreparedTrainingData->m_objectiveCpu.m_bObjectiveHasHessian &&
+               EBM_FALSE == pPreparedTrainingData->m_objectiveCpu.m_bConstantHessian) {
+            LOG_0(Trace_Error,
+                  "ERROR PreparedTrainingData::Create CreateBoosterFlags_ConstantHessian requires an objective with a "
+                  "constant hessian");
+            return Error_IllegalParamVal;
+         }
+         pPreparedTrainingData->m_objectiveCpu.m_bObjectiveHasHessian = EBM_FALSE;
+         pPreparedTrainingData->m_objectiveSIMD.m_bObjectiveHasHessian = EBM_FALSE;
+      }
+
+      const TaskEbm task = pPreparedTrainingData->m_objectiveCpu.m_task;
+      if(ptrdiff_t{Task_GeneralClassification} <= cClasses) {
+         if(task < Task_GeneralClassification) {
+            LOG_0(Trace_Error, "ERROR PreparedTrainingData::Create mismatch in objective class model type");
+            return Error_IllegalParamVal;
+         }
+      } else {
+         if(Task_Regression != task) {
+            LOG_0(Trace_Error, "ERROR PreparedTrainingData::Create mismatch in objective class model type");
+            return Error_IllegalParamVal;
+         }
+      }
+      if(EBM_FALSE != pPreparedTrainingData->m_bValidationAuc) {
+         // only the binary log loss kernel fills the AUC histogram
+         if(task < Task_GeneralClassification || size_t{1} != cScores) {
+            LOG_0(Trace_Error,
+                  "ERROR PreparedTrainingData::Create CreateBoosterFlags_ValidationAuc requires binary classification");
+            return Error_IllegalParamVal;
+         }
+         if(pPreparedTrainingData->m_bOutOfBagMetric) {
+            // the AUC histogram is only filled in the validation pass
+            LOG_0(Trace_Error,
+                  "ERROR PreparedTrainingData::Create CreateBoosterFlags_ValidationAuc cannot be combined with "
+                  "CreateBoosterFlags_OutOfBagMetric");
+            return Error_IllegalParamVal;
+         }
+      }
+      if(0 != cTerms) {
+         if(0 != cSamples) {
+            if(EBM_FALSE != CheckTargetsC(&pPreparedTrainingData->m_objectiveCpu, cSamples, aTargets)) {
+               LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create invalid target value");
+               return Error_ObjectiveIllegalTarget;
+            }
+            LOG_0(Trace_Info, "INFO PreparedTrainingData::Create Targets verified");
+
+            if(CheckBoosterRestrictions(cScores, &pPreparedTrainingData->m_objectiveCpu, cTensorBinsMax)) {
+               LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create cannot fit indexes in the cpu zone");
+               return Error_IllegalParamVal;
+            }
+            if(0 != pPreparedTrainingData->m_objectiveSIMD.m_cUIntBytes) {
+               if(CheckBoosterRestrictions(cScores, &pPreparedTrainingData->m_objectiveSIMD, cTensorBinsMax)) {
+                  if(bRequireAcceleration) {
+                     LOG_0(Trace_Warning,
+                           "WARNING PreparedTrainingData::Create CreateBoosterFlags_RequireAcceleration and cannot fit "
+                           "indexes in the SIMD zone");
+                     return Error_UserParamVal;
+                  }
+                  FreeObjectiveWrapperInternals(&pPreparedTrainingData->m_objectiveSIMD);
+                  InitializeObjectiveWrapperUnfailing(&pPreparedTrainingData->m_objectiveSIMD);
+               }
+            }
+
+            size_t cTrainingSamples;
+            size_t cValidationSamples;
+            error = Unbag(cSamples, aBag, &cTrainingSamples, &cValidationSamples);
+            if(Error_None != error) {
+               // already logged
+               return error;
+            }
+            if(pPreparedTrainingData->m_bOutOfBagMetric && 0 != cValidationSamples) {
+               LOG_0(Trace_Error,
+                     "ERROR PreparedTrainingData::Create CreateBoosterFlags_OutOfBagMetric replaces the validation set, "
+                     "so the bag cannot hold validation samples");
+               return Error_IllegalParamVal;
+            }
+
+            if(nullptr != aBag) {
+               // Unbag succeeded, so the bag is cSamples long and that many items fit into memory
+               BagEbm* const aBagCopy = static_cast<BagEbm*>(malloc(sizeof(BagEbm) * cSamples));
+               if(nullptr == aBagCopy) {
+                  LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create nullptr == aBagCopy");
+                  return Error_OutOfMemory;
+               }
+               memcpy(aBagCopy, aBag, sizeof(BagEbm) * cSamples);
+               pPreparedTrainingData->m_aBag = aBagCopy;
+            }
+
+            const ObjectiveWrapper* const pObjectiveCpu = &pPreparedTrainingData->m_objectiveCpu;
+            const ObjectiveWrapper* const pObjectiveSIMD = &pPreparedTrainingData->m_objectiveSIMD;
+
+            // if we have 32 bit floats or ints, then we need to break large datasets into smaller data subsets
+            // because float32 values stop incrementing at 2^24 where the value 1 is below the threshold incrementing a
+            // float
+            const bool bForceMultipleSubsets = sizeof(UIntSmall) == pObjectiveCpu->m_cUIntBytes ||
+                  sizeof(FloatSmall) == pObjectiveCpu->m_cFloatBytes ||
+                  sizeof(UIntSmall) == pObjectiveSIMD->m_cUIntBytes ||
+                  sizeof(FloatSmall) == pObjectiveSIMD->m_cFloatBytes;
+            const size_t cSubsetSamplesLimit = bForceMultipleSubsets ? k_cSubsetSamplesMax : SIZE_MAX;
+            // In mixed precision the training histograms are carried in float64 between chunks (see
+            // BinSumsBoostingSubset), so only the uint32 limit applies. The validation subsets keep the float32
+            // limit since their metric is summed in the objective's float type, and a validation subset costs us
+            // no more than a thread pool task.
+            const size_t cTrainingSubsetSamplesLimit =
+                  bForceMultipleSubsets && 0 != (CreateBoosterFlags_MixedPrecision & flags) ?
+                  k_cSubsetSamplesMixedMax :
+                  cSubsetSamplesLimit;
+
+            const bool bHessian = EBM_FALSE != pObjectiveCpu->m_bObjectiveHasHessian;
+            const bool bRmse = EBM_FALSE != pObjectiveCpu->m_bRmse;
+
+            if(0 != (CreateBoosterFlags_CompressGradients & flags) && 0 != cTrainingSamples) {
+               if(bRmse) {
+                  // RMSE updates its gradients in place as residuals, so rounding them on every update would
+                  // accumulate error instead of just adding noise to the histograms
+                  LOG_0(Trace_Warning,
+                        "WARNING PreparedTrainingData::Create CreateBoosterFlags_CompressGradients ignored for RMSE");
+               } else {
+                  pPreparedTrainingData->m_bCompressGradients = true;
+               }
+            }
+            if(0 != (CreateBoosterFlags_QuantizeGradients & flags) && 0 != cTrainingSamples) {
+               if(bRmse) {
+                  // the quantized values overwrite the gradients until the next update, and RMSE never recalculates
+                  // its residuals from the scores
+                  LOG_0(Trace_Warning,
+                        "WARNING PreparedTrainingData::Create CreateBoosterFlags_QuantizeGradients ignored for RMSE");
+               } else {
+                  pPreparedTrainingData->m_bQuantizeGradients = true;
+               }
+            }
+
+            const size_t cSamplesMax = EbmMax(cTrainingSamples, cValidationSamples);
+            pPreparedTrainingData->m_cThreads = EbmMin(ThreadPool::GetCountThreadsMax(),
+                  EbmMax(size_t{1}, cSamplesMax / k_cSamplesPerSubsetMin));
+
+            // RMSE keeps no targets in the objective's format since its gradients are calculated once from the
+            // original targets when each booster is created
+            error = pPreparedTrainingData->m_trainingSet.InitSharedData(!bRmse,
+                  bRmse,
+                  true,
+                  GetSubsetSamplesMax(cTrainingSamples, cTrainingSubsetSamplesLimit),
+                  pObjectiveCpu,
+                  pObjectiveSIMD,
+                  pDataSetShared,
+                  BagEbm{1},
+                  cSamples,
+                  aBag,
+                  cTrainingSamples,
+                  cWeights,
+                  cTerms,
+                  pPreparedTrainingData->m_apTerms,
+                  aiTermFeatures);
+            if(Error_None != error) {
+               return error;
+            }
+
+            error = pPreparedTrainingData->m_validationSet.InitSharedData(!bRmse,
+                  bRmse,
+                  false,
+                  GetSubsetSamplesMax(cValidationSamples, cSubsetSamplesLimit),
+                  pObjectiveCpu,
+                  pObjectiveSIMD,
+                  pDataSetShared,
+                  BagEbm{-1},
+                  cSamples,
+                  aBag,
+                  cValidationSamples,
+                  cWeights,
+                  cTerms,
+                  pPreparedTrainingData->m_apTerms,
+                  aiTermFeatures);
+            if(Error_None != error) {
+               return error;
+            }
+
+            size_t cBytesPerFastBinMax = 0;
+            bool bWideBins = false;
+            size_t cBytesGradHessTempMax = 0;
+#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
+            size_t cBytesParallelBoostTrainingMax = 0;
+#endif
+
+            if(0 != cTrainingSamples) {
+               DataSubsetBoosting* pSubset = pPreparedTrainingData->m_trainingSet.GetSubsets();
+               const DataSubsetBoosting* const pSubsetsEnd =
+                     pSubset + pPreparedTrainingData->m_trainingSet.GetCountSubsets();
+               do {
+                  size_t cBytesPerFastBin;
+                  if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+                        cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores);
+                     } else {
+                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, bHessian, cScores);
+                     }
+                  } else {
+                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+                        cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, bHessian, cScores);
+                     } else {
+                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(false, false, bHessian, cScores);
+                     }
+                  }
+                  cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
+
+                  if(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes &&
+                        k_cSubsetSamplesMax < pSubset->GetCountSamples()) {
+                     // only possible with CreateBoosterFlags_MixedPrecision
+                     bWideBins = true;
+                  }
+
+                  if(pPreparedTrainingData->m_bCompressGradients) {
+                     const size_t cFloatsPerSample = bHessian ? cScores << 1 : cScores;
+                     if(IsMultiplyError(pSubset->GetObjectiveWrapper()->m_cFloatBytes,
+                              pSubset->GetObjectiveWrapper()->m_cSIMDPack,
+                              cFloatsPerSample,
+                              static_cast<size_t>(COUNT_BITS(UIntBig)))) {
+                        LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create gradient chunk size overflow");
+                        return Error_OutOfMemory;
+                     }
+                     const size_t cBytesPerItem = pSubset->GetObjectiveWrapper()->m_cFloatBytes *
+                           pSubset->GetObjectiveWrapper()->m_cSIMDPack * cFloatsPerSample;
+                     cBytesGradHessTempMax = EbmMax(cBytesGradHessTempMax, GetGradHessTempBytes(cBytesPerItem));
+                  }
+
+#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
+                  if(1 != pSubset->GetObjectiveWrapper()->m_cSIMDPack) {
+                     size_t cBytesParallelMax =
+                           GetParallelBinBytesMax(bHessian, cScores, pSubset->GetObjectiveWrapper()->m_cSIMDPack);
+                     if(bHessian && size_t{1} == cScores) {
+                        // the caller can specify gradient boosting as an option for an objective with a hessian
+                        cBytesParallelMax = EbmMax(cBytesParallelMax,
+                              GetParallelBinBytesMax(false, cScores, pSubset->GetObjectiveWrapper()->m_cSIMDPack));
+                     }
+                     if(IsMultiplyError(
+                              cBytesPerFastBin, cTensorBinsMax, pSubset->GetObjectiveWrapper()->m_cSIMDPack)) {
+                        cBytesParallelBoostTrainingMax = cBytesParallelMax;
+                     } else {
+                        size_t cBytesParallelBoostTraining =
+                              cBytesPerFastBin * cTensorBinsMax * pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+                        cBytesParallelBoostTraining = EbmMin(cBytesParallelBoostTraining, cBytesParallelMax);
+
+                        cBytesParallelBoostTrainingMax =
+                              EbmMax(cBytesParallelBoostTrainingMax, cBytesParallelBoostTraining);
+                     }
+                  }
+#endif
+
+                  ++pSubset;
+               } while(pSubsetsEnd != pSubset);
+            }
+
+            if(0 != cValidationSamples) {
+               DataSubsetBoosting* pSubset = pPreparedTrainingData->m_validationSet.GetSubsets();
+               const DataSubsetBoosting* const pSubsetsEnd =
+                     pSubset + pPreparedTrainingData->m_validationSet.GetCountSubsets();
+               do {
+                  size_t cBytesPerFastBin;
+                  if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+                        cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores);
+                     } else {
+                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, bHessian, cScores);
+                     }
+                  } else {
+                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+                        cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, bHessian, cScores);
+                     } else {
+                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(false, false, bHessian, cScores);
+                     }
+                  }
+                  cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
+                  ++pSubset;
+               } while(pSubsetsEnd != pSubset);
+            }
+
+            if(IsMultiplyError(cBytesPerFastBinMax, cTensorBinsMax)) {
+               LOG_0(Trace_Warning,
+                     "WARNING PreparedTrainingData::Create IsMultiplyError(cBytesPerFastBinMax, cTensorBinsMax)");
+               return Error_OutOfMemory;
+            }
+            cBytesPerFastBinMax *= cTensorBinsMax;
+#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
+            cBytesPerFastBinMax = EbmMax(cBytesParallelBoostTrainingMax, cBytesPerFastBinMax);
+#endif
+            // each thread gets its own slice of the fast bins, so round the slices up to keep them aligned
+            if(SIZE_MAX - (SIMD_BYTE_ALIGNMENT - 1) < cBytesPerFastBinMax) {
+               LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create fast bins alignment overflow");
+               return Error_OutOfMemory;
+            }
+            cBytesPerFastBinMax = (cBytesPerFastBinMax + (SIMD_BYTE_ALIGNMENT - 1)) & ~(SIMD_BYTE_ALIGNMENT - 1);
+
+            if(bWideBins) {
+               // the float64 bins that the oversized float32 subsets accumulate their chunks into go after the fast
+               // bins in each thread's slice
+               if(IsOverflowBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores)) {
+                  LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create wide bin size overflow");
+                  return Error_OutOfMemory;
+               }
+               const size_t cBytesPerWideBin = GetBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores);
+               if(IsMultiplyError(cBytesPerWideBin, cTensorBinsMax)) {
+                  LOG_0(Trace_Warning,
+                        "WARNING PreparedTrainingData::Create IsMultiplyError(cBytesPerWideBin, cTensorBinsMax)");
+                  return Error_OutOfMemory;
+               }
+               const size_t cBytesWideBins = cBytesPerWideBin * cTensorBinsMax;
+               if(IsAddError(cBytesPerFastBinMax, cBytesWideBins, SIMD_BYTE_ALIGNMENT - 1)) {
+                  LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create wide bins alignment overflow");
+                  return Error_OutOfMemory;
+               }
+               pPreparedTrainingData->m_iBytesWideBins = cBytesPerFastBinMax;
+               cBytesPerFastBinMax = (cBytesPerFastBinMax + cBytesWideBins + (SIMD_BYTE_ALIGNMENT - 1)) &
+                     ~(SIMD_BYTE_ALIGNMENT - 1);
+            }
+            if(size_t{0} != cBytesGradHessTempMax) {
+               // the buffer that each thread expands its compressed gradients into also goes in its slice
+               if(IsAddError(cBytesPerFastBinMax, cBytesGradHessTempMax, SIMD_BYTE_ALIGNMENT - 1)) {
+                  LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create gradient buffer alignment overflow");
+                  return Error_OutOfMemory;
+               }
+               pPreparedTrainingData->m_iBytesGradHessTemp = cBytesPerFastBinMax;
+               cBytesPerFastBinMax = (cBytesPerFastBinMax + cBytesGradHessTempMax + (SIMD_BYTE_ALIGNMENT - 1)) &
+                     ~(SIMD_BYTE_ALIGNMENT - 1);
+            }
+            pPreparedTrainingData->m_cBytesFastBins = cBytesPerFastBinMax;
+
+            if(IsOverflowBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores)) {
+               LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create bin size overflow");
+               return Error_OutOfMemory;
+            }
+
+            const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+            if(IsMultiplyError(cBytesPerMainBin, cMainBinsMax)) {
+               LOG_0(Trace_Warning,
+                     "WARNING PreparedTrainingData::Create IsMultiplyError(cBytesPerMainBin, cMainBinsMax)");
+               return Error_OutOfMemory;
+            }
+            pPreparedTrainingData->m_cBytesMainBins = cBytesPerMainBin * cMainBinsMax;
+
+            if(0 != cSingleDimensionBinsMax) {
+               if(IsOverflowTreeNodeSize(bHessian, cScores) || IsOverflowSplitPositionSize(bHessian, cScores)) {
+                  LOG_0(Trace_Warning, "WARNING PreparedTrainingData::Create bin tracking size overflow");
+                  return Error_OutOfMemory;
+               }
+
+               const size_t cSingleDimensionSplitsMax = cSingleDimensionBinsMax - 1;
+               const size_t cBytesPerSplitPosition = GetSplitPositionSize(bHessian, cScores);
+               if(IsMultiplyError(cBytesPerSplitPosition, cSingleDimensionSplitsMax)) {
+                  LOG_0(Trace_Warning,
+                        "WARNING PreparedTrainingData::Create IsMultiplyError(cBytesPerSplitPosition, "
+                        "cSingleDimensionSplitsMax)");
+                  return Error_OutOfMemory;
+               }
+               // TODO : someday add equal gain multidimensional randomized picking.  I think for that we should
+               // generate
+               //        random numbers as we find equal gains, so we won't need this memory if we do that
+               pPreparedTrainingData->m_cBytesSplitPositions = cBytesPerSplitPosition * cSingleDimensionSplitsMax;
+
+               // If we have N bins, then we can have at most N - 1 splits.
+               // At maximum if all splits are made, then we'll have a tree with N - 1 nodes.
+               // Each node will contain a the total gradient sums of their left and right sides
+               // Each of the N bins will also have a leaf in the tree, which will also consume a TreeNode structure
+               // because each split needs to preserve the gradient sums of its left and right sides, which in this
+               // case are individual bins.
+               // So, in total we consume N + N - 1 TreeNodes
+
+               if(IsAddError(cSingleDimensionSplitsMax, cSingleDimensionBinsMax)) {
+                  LOG_0(Trace_Warning,
+                        "WARNING PreparedTrainingData::Create IsAddError(cSingleDimensionSplitsMax, "
+                        "cSingleDimensionBinsMax)");
+                  return Error_OutOfMemory;
+               }
+               const size_t cTreeNodes = cSingleDimensionSplitsMax + cSingleDimensionBinsMax;
+
+               const size_t cBytesPerTreeNode = GetTreeNodeSize(bHessian, cScores);
+               if(IsMultiplyError(cBytesPerTreeNode, cTreeNodes)) {
+                  LOG_0(Trace_Warning,
+                        "WARNING PreparedTrainingData::Create IsMultiplyError(cBytesPerTreeNode, cTreeNodes)");
+                  return Error_OutOfMemory;
+               }
+               const size_t cBytesTreeNodes = cTreeNodes * cBytesPerTreeNode;
+
+               // PartitionOneDimensionalBoosting keeps its heap of splittable leaves at the end of this memory. There
+               // can never be more leaves than bins, so it never needs to allocate.
+               if(IsMultiplyError(sizeof(void*), cSingleDimensionBinsMax)) {
+                  LOG_0(Trace_Warning,
+                        "WARNING PreparedTrainingData::Create IsMultiplyError(sizeof(void*), cSingleDimensionBinsMax)");
+                  return Error_OutOfMemory;
+               }
+               const size_t cBytesLeafHeap = sizeof(void*) * cSingleDimensionBinsMax;
+               if(IsAddError(cBytesTreeNodes, cBytesLeafHeap)) {
+                  LOG_0(Trace_Warning,
+                        "WARNING PreparedTrainingData::Create IsAddError(cBytesTreeNodes, cBytesLeafHeap)");
+                  return Error_OutOfMemory;
+               }
+               pPreparedTrainingData->m_cBytesTreeNodes = cBytesTreeNodes + cBytesLeafHeap;
+            } else {
+               EBM_ASSERT(0 == pPreparedTrainingData->m_cBytesSplitPositions);
+               EBM_ASSERT(0 == pPreparedTrainingData->m_cBytesTreeNodes);
+            }
+         }
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited PreparedTrainingData::Create");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreatePreparedTrainingData(const void* dataSet,
+      const BagEbm* bag,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      CreateBoosterFlags flags,
+      AccelerationFlags acceleration,
+      const char* objective,
+      const double* experimentalParams,
+      PreparedTrainingDataHandle* preparedTrainingDataHandleOut) {
+   LOG_N(Trace_Info,
+         "Entered CreatePreparedTrainingData: "
+         "dataSet=%p, "
+         "bag=%p, "
+         "countTerms=%" IntEbmPrintf ", "
+         "dimensionCounts=%p, "
+         "featureIndexes=%p, "
+         "flags=0x%" UCreateBoosterFlagsPrintf ", "
+         "acceleration=0x%" UAccelerationFlagsPrintf ", "
+         "objective=%p, "
+         "experimentalParams=%p, "
+         "preparedTrainingDataHandleOut=%p",
+         dataSet,
+         static_cast<const void*>(bag),
+         countTerms,
+         static_cast<const void*>(dimensionCounts),
+         static_cast<const void*>(featureIndexes),
+         static_cast<UCreateBoosterFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         static_cast<UAccelerationFlags>(acceleration), // signed to unsigned conversion is defined behavior in C++
+         static_cast<const void*>(objective), // do not print the string for security reasons
+         static_cast<const void*>(experimentalParams),
+         static_cast<const void*>(preparedTrainingDataHandleOut));
+
+   if(nullptr == preparedTrainingDataHandleOut) {
+      LOG_0(Trace_Error, "ERROR CreatePreparedTrainingData nullptr == preparedTrainingDataHandleOut");
+      return Error_IllegalParamVal;
+   }
+   // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+   *preparedTrainingDataHandleOut = nullptr;
+
+   if(flags &
+         ~(CreateBoosterFlags_DifferentialPrivacy | CreateBoosterFlags_UseApprox |
+               CreateBoosterFlags_BinaryAsMulticlass | CreateBoosterFlags_ValidationAuc |
+               CreateBoosterFlags_MixedPrecision | CreateBoosterFlags_CompressGradients |
+               CreateBoosterFlags_ConstantHessian | CreateBoosterFlags_Profile |
+               CreateBoosterFlags_RequireAcceleration | CreateBoosterFlags_QuantizeGradients |
+               CreateBoosterFlags_ModelSnapshots | CreateBoosterFlags_OutOfBagMetric)) {
+      LOG_0(Trace_Error, "ERROR CreatePreparedTrainingData flags contains unknown flags. Ignoring extras.");
+   }
+
+   if(nullptr == dataSet) {
+      LOG_0(Trace_Error, "ERROR CreatePreparedTrainingData nullptr == dataSet");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countTerms)) {
+      // the caller should not have been able to allocate memory for dimensionCounts if this wasn't fittable in size_t
+      LOG_0(Trace_Error, "ERROR CreatePreparedTrainingData IsConvertError<size_t>(countTerms)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   if(nullptr == dimensionCounts && size_t{0} != cTerms) {
+      LOG_0(Trace_Error, "ERROR CreatePreparedTrainingData dimensionCounts cannot be null if 0 < countTerms");
+      return Error_IllegalParamVal;
+   }
+
+   PreparedTrainingData* pPreparedTrainingData = nullptr;
+   const ErrorEbm error = PreparedTrainingData::Create(cTerms,
+         experimentalParams,
+         dimensionCounts,
+         featureIndexes,
+         static_cast<const unsigned char*>(dataSet),
+         bag,
+         flags,
+         acceleration,
+         objective,
+         &pPreparedTrainingData);
+   if(UNLIKELY(Error_None != error)) {
+      PreparedTrainingData::Free(pPreparedTrainingData); // legal if nullptr
+      return error;
+   }
+
+   const PreparedTrainingDataHandle handle = pPreparedTrainingData->GetHandle();
+
+   LOG_N(Trace_Info,
+         "Exited CreatePreparedTrainingData: *preparedTrainingDataHandleOut=%p",
+         static_cast<void*>(handle));
+
+   *preparedTrainingDataHandleOut = handle;
+   return Error_None;
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION FreePreparedTrainingData(
+      PreparedTrainingDataHandle preparedTrainingDataHandle) {
+   LOG_N(Trace_Info,
+         "Entered FreePreparedTrainingData: preparedTrainingDataHandle=%p",
+         static_cast<void*>(preparedTrainingDataHandle));
+
+   if(nullptr != preparedTrainingDataHandle) {
+      PreparedTrainingData* const pPreparedTrainingData =
+            PreparedTrainingData::GetPreparedTrainingDataFromHandle(preparedTrainingDataHandle);
+      if(nullptr != pPreparedTrainingData) {
+         pPreparedTrainingData->InvalidateHandle();
+         PreparedTrainingData::Free(pPreparedTrainingData);
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited FreePreparedTrainingData");
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,230 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef PREPARED_TRAINING_DATA_HPP
+#define PREPARED_TRAINING_DATA_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <atomic>
+#include <mutex>
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h"
+
+#include "bridge.h" // ObjectiveWrapper
+
+#include "RandomDeterministic.hpp"
+#include "DataSetBoosting.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+class FeatureBoosting;
+class Term;
+
+// PreparedTrainingData holds everything about a booster that is decided by the dataset, bag, terms and objective:
+// the features, terms and objective, and for the training and validation sets the bit packed term data, targets and
+// weights. Any number of BoosterCore objects can reference it, and each one then allocates only its own gradients,
+// sample scores, inner bags and model tensors.
+class PreparedTrainingData final {
+   static constexpr size_t k_handleVerificationOk = 24593; // random 15 bit number
+   static constexpr size_t k_handleVerificationFreed = 7351; // random 15 bit number
+   size_t m_handleVerification; // this needs to be at the top and make it pointer sized to keep best alignment
+
+   // the caller's handle holds one reference and every BoosterCore made from it holds another
+   std::atomic_size_t m_REFERENCE_COUNT;
+
+   size_t m_cScores;
+   BoolEbm m_bUseApprox;
+   BoolEbm m_bValidationAuc;
+   bool m_bCompressGradients;
+   bool m_bQuantizeGradients;
+   bool m_bProfile;
+   bool m_bModelSnapshots;
+   bool m_bOutOfBagMetric;
+
+   size_t m_cFeatures;
+   FeatureBoosting* m_aFeatures;
+
+   size_t m_cTerms;
+   Term** m_apTerms;
+
+   // the caller's initScores are indexed by the samples that the bag includes, so we need the bag to place them
+   BagEbm* m_aBag;
+
+   size_t m_cThreads;
+
+   // the fast bins are allocated once per thread, and this is the size of each thread's slice, which is rounded up
+   // to keep every slice SIMD aligned
+   size_t m_cBytesFastBins;
+   // byte offset within each fast bins slice of the float64 bins that the float32 subsets larger than
+   // k_cSubsetSamplesMax sum their chunks into, or zero if there are no such subsets
+   size_t m_iBytesWideBins;
+   // byte offset within each fast bins slice of the buffer that compressed gradients are expanded into, or zero
+   size_t m_iBytesGradHessTemp;
+   size_t m_cBytesMainBins;
+
+   size_t m_cBytesSplitPositions;
+   size_t m_cBytesTreeNodes;
+
+   DataSetBoosting m_trainingSet;
+   DataSetBoosting m_validationSet;
+
+   // The first booster that draws its inner bags reproducibly stores them in m_trainingSet, keyed by the count of
+   // inner bags and the state of the RNG before and after drawing them. Once stored they never change, so boosters
+   // that find a match can copy them after releasing the mutex.
+   std::mutex m_mutexBags;
+   bool m_bBagsCacheTried;
+   bool m_bBagsCached;
+   size_t m_cCachedInnerBags;
+   RandomDeterministic m_rngBagsBefore;
+   RandomDeterministic m_rngBagsAfter;
+
+   ObjectiveWrapper m_objectiveCpu;
+   ObjectiveWrapper m_objectiveSIMD;
+
+   ~PreparedTrainingData();
+
+   inline PreparedTrainingData() noexcept :
+         m_handleVerification(k_handleVerificationOk),
+         m_REFERENCE_COUNT(1), // we're not visible on any other thread yet, so no synchronization required
+         m_cScores(0),
+         m_bUseApprox(EBM_FALSE),
+         m_bValidationAuc(EBM_FALSE),
+         m_bCompressGradients(false),
+         m_bQuantizeGradients(false),
+         m_bProfile(false),
+         m_bModelSnapshots(false),
+         m_bOutOfBagMetric(false),
+         m_cFeatures(0),
+         m_aFeatures(nullptr),
+         m_cTerms(0),
+         m_apTerms(nullptr),
+         m_aBag(nullptr),
+         m_cThreads(0),
+         m_cBytesFastBins(0),
+         m_iBytesWideBins(0),
+         m_iBytesGradHessTemp(0),
+         m_cBytesMainBins(0),
+         m_cBytesSplitPositions(0),
+         m_cBytesTreeNodes(0),
+         m_bBagsCacheTried(false),
+         m_bBagsCached(false),
+         m_cCachedInnerBags(0) {
+      m_trainingSet.SafeInitDataSetBoosting();
+      m_validationSet.SafeInitDataSetBoosting();
+      InitializeObjectiveWrapperUnfailing(&m_objectiveCpu);
+      InitializeObjectiveWrapperUnfailing(&m_objectiveSIMD);
+   }
+
+ public:
+   static ErrorEbm Create(const size_t cTerms,
+         const double* const experimentalParams,
+         const IntEbm* const acTermDimensions,
+         const IntEbm* const aiTermFeatures,
+         const unsigned char* const pDataSetShared,
+         const BagEbm* const aBag,
+         const CreateBoosterFlags flags,
+         const AccelerationFlags acceleration,
+         const char* const sObjective,
+         PreparedTrainingData** const ppPreparedTrainingDataOut);
+   static void Free(PreparedTrainingData* const pPreparedTrainingData);
+
+   inline void AddReferenceCount() {
+      // incrementing reference counts can be relaxed memory order since we're guaranteed to be above 1,
+      // so no result will change our behavior below
+      // https://www.boost.org/doc/libs/1_59_0/doc/html/atomic/usage_examples.html
+      m_REFERENCE_COUNT.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   inline static PreparedTrainingData* GetPreparedTrainingDataFromHandle(
+         const PreparedTrainingDataHandle preparedTrainingDataHandle) {
+      if(nullptr == preparedTrainingDataHandle) {
+         LOG_0(Trace_Error, "ERROR GetPreparedTrainingDataFromHandle null preparedTrainingDataHandle");
+         return nullptr;
+      }
+      PreparedTrainingData* const pPreparedTrainingData =
+            reinterpret_cast<PreparedTrainingData*>(preparedTrainingDataHandle);
+      if(k_handleVerificationOk == pPreparedTrainingData->m_handleVerification) {
+         return pPreparedTrainingData;
+      }
+      if(k_handleVerificationFreed == pPreparedTrainingData->m_handleVerification) {
+         LOG_0(Trace_Error,
+               "ERROR GetPreparedTrainingDataFromHandle attempt to use freed PreparedTrainingDataHandle");
+      } else {
+         LOG_0(Trace_Error,
+               "ERROR GetPreparedTrainingDataFromHandle attempt to use invalid PreparedTrainingDataHandle");
+      }
+      return nullptr;
+   }
+   inline PreparedTrainingDataHandle GetHandle() { return reinterpret_cast<PreparedTrainingDataHandle>(this); }
+
+   // the boosters made from the prepared data keep it alive after the caller frees the handle
+   inline void InvalidateHandle() { m_handleVerification = k_handleVerificationFreed; }
+
+   inline size_t GetCountScores() const { return m_cScores; }
+
+   inline BoolEbm IsUseApprox() const { return m_bUseApprox; }
+
+   inline BoolEbm IsValidationAuc() const { return m_bValidationAuc; }
+
+   inline bool IsCompressGradients() const { return m_bCompressGradients; }
+
+   inline bool IsQuantizeGradients() const { return m_bQuantizeGradients; }
+
+   inline bool IsProfile() const { return m_bProfile; }
+
+   inline bool IsModelSnapshots() const { return m_bModelSnapshots; }
+
+   inline bool IsOutOfBagMetric() const { return m_bOutOfBagMetric; }
+
+   inline size_t GetCountFeatures() const { return m_cFeatures; }
+
+   inline const FeatureBoosting* GetFeatures() const { return m_aFeatures; }
+
+   inline size_t GetCountTerms() const { return m_cTerms; }
+
+   inline Term* const* GetTerms() const { return m_apTerms; }
+
+   inline const BagEbm* GetBag() const { return m_aBag; }
+
+   inline size_t GetCountThreads() const { return m_cThreads; }
+
+   inline size_t GetCountBytesFastBins() const { return m_cBytesFastBins; }
+
+   inline size_t GetIndexBytesWideBins() const { return m_iBytesWideBins; }
+
+   inline size_t GetIndexBytesGradHessTemp() const { return m_iBytesGradHessTemp; }
+
+   inline size_t GetCountBytesMainBins() const { return m_cBytesMainBins; }
+
+   inline size_t GetCountBytesSplitPositions() const { return m_cBytesSplitPositions; }
+
+   inline size_t GetCountBytesTreeNodes() const { return m_cBytesTreeNodes; }
+
+   inline const DataSetBoosting* GetTrainingSet() const { return &m_trainingSet; }
+
+   inline const DataSetBoosting* GetValidationSet() const { return &m_validationSet; }
+
+   inline const ObjectiveWrapper* GetObjectiveCpu() const { return &m_objectiveCpu; }
+
+   inline const ObjectiveWrapper* GetObjectiveSIMD() const { return &m_objectiveSIMD; }
+
+   // returns true if GetTrainingSet holds the inner bags that cInnerBags draws from rng, which is then advanced past
+   // them as if they had been drawn
+   bool LookupCachedBags(void* const rng, const size_t cInnerBags);
+
+   // pRngBefore is the state of rng before pTrainingSet drew its inner bags. Only the first call stores anything
+   void CacheBags(const RandomDeterministic* const pRngBefore,
+         const void* const rng,
+         const size_t cInnerBags,
+         const DataSetBoosting* const pTrainingSet);
+};
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // PREPARED_TRAINING_DATA_HPP
@@ -0,0 +1,108 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <atomic>
+#include <chrono>
+#include <new> // std::nothrow
+
+#include "libebm.h" // ProfileSection_COUNT
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // INLINE_ALWAYS
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+static constexpr size_t k_cProfileSections = static_cast<size_t>(ProfileSection_COUNT);
+
+// The counters behind GetBoosterProfile. The sections are timed on whichever threads run them, so the counters are
+// atomic, and the nanoseconds of a section that runs on several threads at once add up to more than the wall time.
+// A booster made without CreateBoosterFlags_Profile has no Profile, and every ProfileTimer then does nothing.
+class Profile final {
+   struct ProfileCounters final {
+      std::atomic<uint64_t> m_cCalls;
+      std::atomic<uint64_t> m_cItems;
+      std::atomic<uint64_t> m_cBytes;
+      std::atomic<uint64_t> m_cNanoseconds;
+   };
+
+   ProfileCounters m_aCounters[k_cProfileSections];
+
+   inline Profile() noexcept {
+      for(size_t iSection = 0; iSection < k_cProfileSections; ++iSection) {
+         m_aCounters[iSection].m_cCalls.store(0, std::memory_order_relaxed);
+         m_aCounters[iSection].m_cItems.store(0, std::memory_order_relaxed);
+         m_aCounters[iSection].m_cBytes.store(0, std::memory_order_relaxed);
+         m_aCounters[iSection].m_cNanoseconds.store(0, std::memory_order_relaxed);
+      }
+   }
+
+ public:
+   inline static Profile* Create() noexcept {
+      Profile* const pProfile = new(std::nothrow) Profile();
+      if(nullptr == pProfile) {
+         LOG_0(Trace_Warning, "WARNING Profile::Create nullptr == pProfile");
+      }
+      return pProfile;
+   }
+
+   inline static void Free(Profile* const pProfile) noexcept { delete pProfile; }
+
+   INLINE_ALWAYS void Record(
+         const size_t iSection, const size_t cItems, const size_t cBytes, const uint64_t cNanoseconds) noexcept {
+      EBM_ASSERT(iSection < k_cProfileSections);
+      ProfileCounters* const pCounters = &m_aCounters[iSection];
+      pCounters->m_cCalls.fetch_add(1, std::memory_order_relaxed);
+      pCounters->m_cItems.fetch_add(static_cast<uint64_t>(cItems), std::memory_order_relaxed);
+      pCounters->m_cBytes.fetch_add(static_cast<uint64_t>(cBytes), std::memory_order_relaxed);
+      pCounters->m_cNanoseconds.fetch_add(cNanoseconds, std::memory_order_relaxed);
+   }
+
+   inline uint64_t GetCountCalls(const size_t iSection) const noexcept {
+      return m_aCounters[iSection].m_cCalls.load(std::memory_order_relaxed);
+   }
+   inline uint64_t GetCountItems(const size_t iSection) const noexcept {
+      return m_aCounters[iSection].m_cItems.load(std::memory_order_relaxed);
+   }
+   inline uint64_t GetCountBytes(const size_t iSection) const noexcept {
+      return m_aCounters[iSection].m_cBytes.load(std::memory_order_relaxed);
+   }
+   inline uint64_t GetNanoseconds(const size_t iSection) const noexcept {
+      return m_aCounters[iSection].m_cNanoseconds.load(std::memory_order_relaxed);
+   }
+};
+
+// starts the clock when made, and records one call of a section when Stop is called. With a nullptr Profile neither
+// reads the clock, so leaving the timers in the hot paths costs a predictable branch when profiling is off
+class ProfileTimer final {
+   Profile* const m_pProfile;
+   std::chrono::steady_clock::time_point m_start;
+
+ public:
+   INLINE_ALWAYS explicit ProfileTimer(Profile* const pProfile) noexcept : m_pProfile(pProfile) {
+      if(nullptr != pProfile) {
+         m_start = std::chrono::steady_clock::now();
+      }
+   }
+
+   INLINE_ALWAYS void Stop(const IntEbm section, const size_t cItems, const size_t cBytes) const noexcept {
+      if(nullptr != m_pProfile) {
+         const auto elapsed = std::chrono::steady_clock::now() - m_start;
+         m_pProfile->Record(static_cast<size_t>(section),
+               cItems,
+               cBytes,
+               static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+      }
+   }
+};
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // PROFILE_HPP
@@ -21,6 +21,7 @@
 #include "bridge.hpp" // k_dynamicScores
 
 #include "RandomDeterministic.hpp" // RandomDeterministic
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -215,6 +216,250 @@ EBM_API_BODY double EBM_CALLING_CONVENTION MeasureImpurity(IntEbm countMultiScor
    return impurityTotal;
 }
 
+// Two dimensional tensors with no more than this many bins per dimension are purified by solving the marginal
+// constraints directly. The solve is cubic in the shorter dimension, and this keeps the work on the stack.
+static constexpr size_t k_cPurifyDirectBinsMax = 64;
+// pivots below this fraction of their row weight belong to the null space (the constant that can be moved between
+// the two sets of effects, or a disconnected group of bins) and the corresponding effect is pinned at zero
+static constexpr double k_purifyPivotRelativeMin = 1e-10;
+// weights whose cells are all within this relative distance of the outer product of their marginals are treated
+// as rank one
+static constexpr double k_purifyRankOneTolerance = 1e-6;
+
+static bool PurifyTwoDimensionalDirect(const size_t cScores,
+      const size_t cBins0,
+      const size_t cBins1,
+      const double* const aWeights,
+      double* const pScores,
+      double* const pImpurities) {
+   // For 2 dimensions the fully purified tensor is f(i0, i1) - e0(i0) - e1(i1) where the effects satisfy the
+   // weighted marginal constraints of both dimensions. Eliminating the effects of the longer dimension leaves a
+   // symmetric positive semi-definite system in the effects of the shorter one, which we solve in place. We return
+   // false without modifying anything if the inputs contain non-finite values so that the caller can iterate.
+
+   EBM_ASSERT(2 <= cBins0);
+   EBM_ASSERT(2 <= cBins1);
+
+   if(k_cPurifyDirectBinsMax < cBins0 || k_cPurifyDirectBinsMax < cBins1) {
+      return false;
+   }
+
+   const bool bSwap = cBins1 < cBins0;
+   const size_t cA = bSwap ? cBins1 : cBins0;
+   const size_t cB = bSwap ? cBins0 : cBins1;
+   const size_t strideA = bSwap ? cBins0 : size_t{1};
+   const size_t strideB = bSwap ? size_t{1} : cBins0;
+
+   double aWeightsA[k_cPurifyDirectBinsMax];
+   double aWeightsB[k_cPurifyDirectBinsMax];
+   double aSumsA[k_cPurifyDirectBinsMax];
+   double aSumsB[k_cPurifyDirectBinsMax];
+   double aEffectsA[k_cPurifyDirectBinsMax];
+   double aEffectsB[k_cPurifyDirectBinsMax];
+   double aMatrix[k_cPurifyDirectBinsMax * k_cPurifyDirectBinsMax];
+
+   for(size_t iA = 0; iA < cA; ++iA) {
+      aWeightsA[iA] = 0.0;
+      aSumsA[iA] = 0.0;
+   }
+   for(size_t iB = 0; iB < cB; ++iB) {
+      aWeightsB[iB] = 0.0;
+      aSumsB[iB] = 0.0;
+   }
+
+   double weightTotal = 0.0;
+   for(size_t iB = 0; iB < cB; ++iB) {
+      for(size_t iA = 0; iA < cA; ++iA) {
+         const size_t iTensor = iA * strideA + iB * strideB;
+         const double weight = aWeights[iTensor];
+         const double score = pScores[iTensor * cScores];
+         if(std::isinf(weight) || std::isnan(score) || std::isinf(score)) {
+            return false;
+         }
+         const double weightedScore = weight * score;
+         aWeightsA[iA] += weight;
+         aWeightsB[iB] += weight;
+         aSumsA[iA] += weightedScore;
+         aSumsB[iB] += weightedScore;
+         weightTotal += weight;
+      }
+   }
+   if(std::isinf(weightTotal)) {
+      return false;
+   }
+
+   double* pRow = aMatrix;
+   for(size_t iA = 0; iA < cA; ++iA) {
+      for(size_t iA2 = 0; iA2 < cA; ++iA2) {
+         pRow[iA2] = 0.0;
+      }
+      pRow[iA] = aWeightsA[iA];
+      pRow += cA;
+   }
+   // aEffectsA holds the right hand side until the back substitution replaces it with the solution
+   for(size_t iA = 0; iA < cA; ++iA) {
+      aEffectsA[iA] = aSumsA[iA];
+   }
+   for(size_t iB = 0; iB < cB; ++iB) {
+      const double weightB = aWeightsB[iB];
+      if(std::numeric_limits<double>::min() <= weightB) {
+         const double weightBInverted = 1.0 / weightB;
+         const double* const pWeightsB = &aWeights[iB * strideB];
+         const double sumB = aSumsB[iB] * weightBInverted;
+         pRow = aMatrix;
+         for(size_t iA = 0; iA < cA; ++iA) {
+            const double weight = pWeightsB[iA * strideA];
+            if(0.0 != weight) {
+               aEffectsA[iA] -= weight * sumB;
+               const double weightScaled = weight * weightBInverted;
+               for(size_t iA2 = 0; iA2 < cA; ++iA2) {
+                  pRow[iA2] -= weightScaled * pWeightsB[iA2 * strideA];
+               }
+            }
+            pRow += cA;
+         }
+      }
+   }
+
+   bool abFree[k_cPurifyDirectBinsMax];
+   for(size_t iPivot = 0; iPivot < cA; ++iPivot) {
+      const double* const pPivotRow = &aMatrix[iPivot * cA];
+      const double pivot = pPivotRow[iPivot];
+      // the matrix is positive semi-definite, so once a pivot vanishes its remaining row and column do too
+      const bool bFree = !(k_purifyPivotRelativeMin * aWeightsA[iPivot] < pivot);
+      abFree[iPivot] = bFree;
+      if(!bFree) {
+         const double pivotInverted = 1.0 / pivot;
+         for(size_t iA = iPivot + 1; iA < cA; ++iA) {
+            double* const pEliminateRow = &aMatrix[iA * cA];
+            const double factor = pEliminateRow[iPivot] * pivotInverted;
+            if(0.0 != factor) {
+               for(size_t iA2 = iPivot + 1; iA2 < cA; ++iA2) {
+                  pEliminateRow[iA2] -= factor * pPivotRow[iA2];
+               }
+               aEffectsA[iA] -= factor * aEffectsA[iPivot];
+            }
+         }
+      }
+   }
+   size_t iPivot = cA;
+   do {
+      --iPivot;
+      if(abFree[iPivot]) {
+         aEffectsA[iPivot] = 0.0;
+      } else {
+         const double* const pPivotRow = &aMatrix[iPivot * cA];
+         double sum = aEffectsA[iPivot];
+         for(size_t iA2 = iPivot + 1; iA2 < cA; ++iA2) {
+            sum -= pPivotRow[iA2] * aEffectsA[iA2];
+         }
+         aEffectsA[iPivot] = sum / pPivotRow[iPivot];
+      }
+   } while(size_t{0} != iPivot);
+
+   // any constant can be moved between the two sets of effects. Give the effects of the shorter dimension a zero
+   // weighted mean so that the result does not depend on which pivots were pinned
+   double shift = 0.0;
+   if(std::numeric_limits<double>::min() <= weightTotal) {
+      for(size_t iA = 0; iA < cA; ++iA) {
+         shift += aWeightsA[iA] * aEffectsA[iA];
+      }
+      shift /= weightTotal;
+   }
+   for(size_t iA = 0; iA < cA; ++iA) {
+      const double effect = aEffectsA[iA] - shift;
+      if(std::isnan(effect) || std::isinf(effect)) {
+         return false;
+      }
+      aEffectsA[iA] = effect;
+   }
+   for(size_t iB = 0; iB < cB; ++iB) {
+      const double weightB = aWeightsB[iB];
+      double effect = 0.0;
+      if(std::numeric_limits<double>::min() <= weightB) {
+         const double* const pWeightsB = &aWeights[iB * strideB];
+         double sum = aSumsB[iB];
+         for(size_t iA = 0; iA < cA; ++iA) {
+            sum -= pWeightsB[iA * strideA] * aEffectsA[iA];
+         }
+         effect = sum / weightB;
+         if(std::isnan(effect) || std::isinf(effect)) {
+            return false;
+         }
+      }
+      aEffectsB[iB] = effect;
+   }
+
+   for(size_t iB = 0; iB < cB; ++iB) {
+      const double effectB = aEffectsB[iB];
+      for(size_t iA = 0; iA < cA; ++iA) {
+         pScores[(iA * strideA + iB * strideB) * cScores] -= aEffectsA[iA] + effectB;
+      }
+   }
+
+   if(nullptr != pImpurities) {
+      // the first cBins1 surface bins exclude dimension 0 and are indexed by dimension 1, then the next cBins0
+      // surface bins exclude dimension 1 and are indexed by dimension 0
+      const size_t iSurfaceA = bSwap ? size_t{0} : cBins1;
+      const size_t iSurfaceB = bSwap ? cBins1 : size_t{0};
+      for(size_t iA = 0; iA < cA; ++iA) {
+         pImpurities[(iSurfaceA + iA) * cScores] += aEffectsA[iA];
+      }
+      for(size_t iB = 0; iB < cB; ++iB) {
+         pImpurities[(iSurfaceB + iB) * cScores] += aEffectsB[iB];
+      }
+   }
+
+   return true;
+}
+
+static bool IsRankOneWeights(const size_t cBins0, const size_t cBins1, const double* const aWeights) {
+   // With weights w(i0, i1) = a(i0) * b(i1) the effects of one dimension do not disturb the weighted means of the
+   // other, so sweeping all of dimension 0 and then all of dimension 1 purifies the tensor in a single pass.
+   double weightTotal = 0.0;
+   const double* const pWeightsEnd = &aWeights[cBins0 * cBins1];
+   for(const double* pWeight = aWeights; pWeightsEnd != pWeight; ++pWeight) {
+      weightTotal += *pWeight;
+   }
+   if(!(std::numeric_limits<double>::min() <= weightTotal) || std::isinf(weightTotal)) {
+      return false;
+   }
+   const double weightTotalInverted = 1.0 / weightTotal;
+
+   double* const aWeights0 = static_cast<double*>(malloc(sizeof(double) * cBins0));
+   if(nullptr == aWeights0) {
+      // this is only an optimization, so fall back to the randomized sweeps
+      return false;
+   }
+   for(size_t i0 = 0; i0 < cBins0; ++i0) {
+      aWeights0[i0] = 0.0;
+   }
+   for(size_t i1 = 0; i1 < cBins1; ++i1) {
+      const double* const pWeights1 = &aWeights[i1 * cBins0];
+      for(size_t i0 = 0; i0 < cBins0; ++i0) {
+         aWeights0[i0] += pWeights1[i0];
+      }
+   }
+
+   for(size_t i1 = 0; i1 < cBins1; ++i1) {
+      const double* const pWeights1 = &aWeights[i1 * cBins0];
+      double weight1 = 0.0;
+      for(size_t i0 = 0; i0 < cBins0; ++i0) {
+         weight1 += pWeights1[i0];
+      }
+      weight1 *= weightTotalInverted;
+      for(size_t i0 = 0; i0 < cBins0; ++i0) {
+         const double expected = aWeights0[i0] * weight1;
+         if(k_purifyRankOneTolerance * expected < std::abs(pWeights1[i0] - expected)) {
+            free(aWeights0);
+            return false;
+         }
+      }
+   }
+   free(aWeights0);
+   return true;
+}
+
 extern ErrorEbm PurifyInternal(const double tolerance,
       const size_t cScores,
       const size_t cTensorBins,
@@ -225,7 +470,8 @@ extern ErrorEbm PurifyInternal(const double tolerance,
       const double* const aWeights,
       double* const pScores,
       double* const pImpurities,
-      double* const pIntercept) {
+      double* const pIntercept,
+      size_t* const pcSweeps) {
    EBM_ASSERT(!std::isnan(tolerance));
    EBM_ASSERT(!std::isinf(tolerance));
    EBM_ASSERT(0.0 <= tolerance);
@@ -422,6 +668,25 @@ extern ErrorEbm PurifyInternal(const double tolerance,
             double impurityPrev;
             double impurityCur = std::numeric_limits<double>::infinity();
             bool bRetry;
+
+            size_t* aRandomizeSweep = aRandomize;
+            const size_t cBins0 = aDimensionLengths[0];
+            const size_t cBins1 = aDimensionLengths[1];
+            if(cBins0 + cBins1 == cSurfaceBins && cBins0 * cBins1 == cTensorBins && 2 <= cBins0 && 2 <= cBins1) {
+               // only 2 dimensions have this many surface bins
+               if(PurifyTwoDimensionalDirect(cScores, cBins0, cBins1, aWeights, pScores, pImpurities)) {
+                  if(nullptr != pcSweeps) {
+                     ++*pcSweeps;
+                  }
+                  impurityCur = 0.0;
+                  goto purified;
+               }
+               if(nullptr != aRandomize && IsRankOneWeights(cBins0, cBins1, aWeights)) {
+                  // sweeping the dimensions in order converges after one pass, which randomizing would destroy
+                  aRandomizeSweep = nullptr;
+               }
+            }
+
             do {
                // if any non-infinite value was flipped to an infinite value, it could increase the impurity
                // so we set impurityCur to NaN. We need to reset it to +inf to avoid stopping early
@@ -429,8 +694,11 @@ extern ErrorEbm PurifyInternal(const double tolerance,
                impurityPrev = impurityCur;
                impurityCur = 0.0;
                bRetry = false;
+               if(nullptr != pcSweeps) {
+                  ++*pcSweeps;
+               }
 
-               if(nullptr != aRandomize) {
+               if(nullptr != aRandomizeSweep) {
                   // TODO: We're currently generating different randomized ordering for each class when doing
                   // multiclass This might cause problems during boosting, especially if we use a non-zero tolerance
                   // because then there are small impurities that creep in and would change the multiclass
@@ -441,24 +709,24 @@ extern ErrorEbm PurifyInternal(const double tolerance,
                   size_t cRemaining = cSurfaceBins;
                   do {
                      --cRemaining;
-                     aRandomize[cRemaining] = cRemaining;
+                     aRandomizeSweep[cRemaining] = cRemaining;
                   } while(size_t{0} != cRemaining);
 
                   cRemaining = cSurfaceBins;
                   do {
                      const size_t iSwap = pRng->NextFast(cRemaining);
-                     const size_t iOriginal = aRandomize[iSwap];
+                     const size_t iOriginal = aRandomizeSweep[iSwap];
                      --cRemaining;
-                     aRandomize[iSwap] = aRandomize[cRemaining];
-                     aRandomize[cRemaining] = iOriginal;
+                     aRandomizeSweep[iSwap] = aRandomizeSweep[cRemaining];
+                     aRandomizeSweep[cRemaining] = iOriginal;
                   } while(size_t{0} != cRemaining);
                }
 
                size_t iRandom = 0;
                do {
                   size_t iSurfaceBin = iRandom;
-                  if(nullptr != aRandomize) {
-                     iSurfaceBin = aRandomize[iRandom];
+                  if(nullptr != aRandomizeSweep) {
+                     iSurfaceBin = aRandomizeSweep[iRandom];
                   }
 
                   size_t cTensorWeightIncrement = sizeof(double);
@@ -668,6 +936,7 @@ extern ErrorEbm PurifyInternal(const double tolerance,
                } while(cSurfaceBins != iRandom);
                // this loops on std::isnan(impurityCur)
             } while(bRetry && !(impurityPrev <= impurityCur));
+         purified:;
             EBM_ASSERT(!std::isnan(impurityCur));
 
             if(nullptr != pIntercept) {
@@ -1067,7 +1336,8 @@ static ErrorEbm PurifyNormalizedMulticlass(const size_t cScores,
       const double* const aWeights,
       double* const aScoresInOut,
       double* const aImpuritiesOut,
-      double* const aInterceptOut) {
+      double* const aInterceptOut,
+      size_t* const pcSweeps) {
    EBM_ASSERT(1 <= cScores);
    EBM_ASSERT(1 <= cTensorBins);
    EBM_ASSERT(nullptr != pRng || aRandomize == nullptr);
@@ -1260,6 +1530,9 @@ static ErrorEbm PurifyNormalizedMulticlass(const size_t cScores,
          impurityCur = std::isnan(impurityCur) ? std::numeric_limits<double>::infinity() : impurityCur;
          impurityPrev = impurityCur;
          impurityCur = 0.0;
+         if(nullptr != pcSweeps) {
+            ++*pcSweeps;
+         }
 
          if(nullptr != aRandomize) {
             size_t cRemaining = cSurfaceBins;
@@ -1666,38 +1939,19 @@ static ErrorEbm PurifyNormalizedMulticlass(const size_t cScores,
    return Error_None;
 }
 
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
-      BoolEbm isRandomized,
-      BoolEbm isMulticlassNormalization,
-      IntEbm countMultiScores,
-      IntEbm countDimensions,
-      const IntEbm* dimensionLengths,
-      const double* weights,
-      double* scoresInOut,
-      double* impuritiesOut,
-      double* interceptOut) {
-   LOG_N(Trace_Info,
-         "Entered Purify: "
-         "tolerance=%le, "
-         "isRandomized=%s, "
-         "isMulticlassNormalization=%s, "
-         "countMultiScores=%" IntEbmPrintf ", "
-         "countDimensions=%" IntEbmPrintf ", "
-         "dimensionLengths=%p, "
-         "weights=%p, "
-         "scoresInOut=%p, "
-         "impuritiesOut=%p, "
-         "interceptOut=%p",
-         tolerance,
-         ObtainTruth(isRandomized),
-         ObtainTruth(isMulticlassNormalization),
-         countMultiScores,
-         countDimensions,
-         static_cast<const void*>(dimensionLengths),
-         static_cast<const void*>(weights),
-         static_cast<const void*>(scoresInOut),
-         static_cast<const void*>(impuritiesOut),
-         static_cast<const void*>(interceptOut));
+static ErrorEbm PurifyTerm(const double tolerance,
+      const BoolEbm isRandomized,
+      const BoolEbm isMulticlassNormalization,
+      const IntEbm countMultiScores,
+      const IntEbm countDimensions,
+      const IntEbm* const dimensionLengths,
+      const double* const weights,
+      double* const scoresInOut,
+      double* const impuritiesOut,
+      double* const interceptOut,
+      size_t* const pcSweeps) {
+   // pcSweeps, if not nullptr, is incremented once for each sweep over the surface bins. Multiclass scores that are
+   // purified one at a time add their sweeps together
 
    ErrorEbm error;
 
@@ -1872,7 +2126,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
             weights,
             scoresInOut,
             impuritiesOut,
-            interceptOut);
+            interceptOut,
+            pcSweeps);
    } else {
       const size_t cBytesScoreClasses = sizeof(double) * cScores;
       if(nullptr != impuritiesOut) {
@@ -1894,7 +2149,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
                weights,
                pScores,
                pImpurities,
-               pIntercept);
+               pIntercept,
+               pcSweeps);
 
          ++pScores;
          if(nullptr != pImpurities) {
@@ -1908,9 +2164,263 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
 
    free(aRandomize);
 
+   return error;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
+      BoolEbm isRandomized,
+      BoolEbm isMulticlassNormalization,
+      IntEbm countMultiScores,
+      IntEbm countDimensions,
+      const IntEbm* dimensionLengths,
+      const double* weights,
+      double* scoresInOut,
+      double* impuritiesOut,
+      double* interceptOut) {
+   LOG_N(Trace_Info,
+         "Entered Purify: "
+         "tolerance=%le, "
+         "isRandomized=%s, "
+         "isMulticlassNormalization=%s, "
+         "countMultiScores=%" IntEbmPrintf ", "
+         "countDimensions=%" IntEbmPrintf ", "
+         "dimensionLengths=%p, "
+         "weights=%p, "
+         "scoresInOut=%p, "
+         "impuritiesOut=%p, "
+         "interceptOut=%p",
+         tolerance,
+         ObtainTruth(isRandomized),
+         ObtainTruth(isMulticlassNormalization),
+         countMultiScores,
+         countDimensions,
+         static_cast<const void*>(dimensionLengths),
+         static_cast<const void*>(weights),
+         static_cast<const void*>(scoresInOut),
+         static_cast<const void*>(impuritiesOut),
+         static_cast<const void*>(interceptOut));
+
+   const ErrorEbm error = PurifyTerm(tolerance,
+         isRandomized,
+         isMulticlassNormalization,
+         countMultiScores,
+         countDimensions,
+         dimensionLengths,
+         weights,
+         scoresInOut,
+         impuritiesOut,
+         interceptOut,
+         nullptr);
+
    LOG_0(Trace_Info, "Exited Purify");
 
    return error;
 }
 
+// where each term of PurifyModel begins within the flattened arrays that the caller passes in
+struct PurifyTermOffsets final {
+   size_t m_iDimensionLength;
+   size_t m_iWeight;
+   size_t m_iScore;
+   size_t m_iImpurity;
+};
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION PurifyModel(double tolerance,
+      BoolEbm isRandomized,
+      BoolEbm isMulticlassNormalization,
+      IntEbm countMultiScores,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* dimensionLengths,
+      const double* weights,
+      double* scoresInOut,
+      double* impuritiesOut,
+      double* interceptsOut,
+      IntEbm* sweepCountsOut) {
+   LOG_N(Trace_Info,
+         "Entered PurifyModel: "
+         "tolerance=%le, "
+         "isRandomized=%s, "
+         "isMulticlassNormalization=%s, "
+         "countMultiScores=%" IntEbmPrintf ", "
+         "countTerms=%" IntEbmPrintf ", "
+         "dimensionCounts=%p, "
+         "dimensionLengths=%p, "
+         "weights=%p, "
+         "scoresInOut=%p, "
+         "impuritiesOut=%p, "
+         "interceptsOut=%p, "
+         "sweepCountsOut=%p",
+         tolerance,
+         ObtainTruth(isRandomized),
+         ObtainTruth(isMulticlassNormalization),
+         countMultiScores,
+         countTerms,
+         static_cast<const void*>(dimensionCounts),
+         static_cast<const void*>(dimensionLengths),
+         static_cast<const void*>(weights),
+         static_cast<const void*>(scoresInOut),
+         static_cast<const void*>(impuritiesOut),
+         static_cast<const void*>(interceptsOut),
+         static_cast<const void*>(sweepCountsOut));
+
+   if(countTerms <= IntEbm{0}) {
+      if(countTerms < IntEbm{0}) {
+         LOG_0(Trace_Error, "ERROR PurifyModel countTerms must not be negative");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(IsConvertError<size_t>(countTerms)) {
+      LOG_0(Trace_Error, "ERROR PurifyModel IsConvertError<size_t>(countTerms)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   if(countMultiScores <= IntEbm{0}) {
+      if(IntEbm{0} == countMultiScores) {
+         LOG_0(Trace_Info, "INFO PurifyModel zero scores");
+         if(nullptr != sweepCountsOut) {
+            memset(sweepCountsOut, 0, sizeof(*sweepCountsOut) * cTerms);
+         }
+         return Error_None;
+      }
+      LOG_0(Trace_Error, "ERROR PurifyModel countMultiScores must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countMultiScores)) {
+      LOG_0(Trace_Error, "ERROR PurifyModel IsConvertError<size_t>(countMultiScores)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cScores = static_cast<size_t>(countMultiScores);
+
+   if(nullptr == dimensionCounts) {
+      LOG_0(Trace_Error, "ERROR PurifyModel nullptr == dimensionCounts");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsMultiplyError(sizeof(PurifyTermOffsets), cTerms)) {
+      LOG_0(Trace_Warning, "WARNING PurifyModel IsMultiplyError(sizeof(PurifyTermOffsets), cTerms)");
+      return Error_OutOfMemory;
+   }
+   PurifyTermOffsets* const aOffsets =
+         static_cast<PurifyTermOffsets*>(malloc(sizeof(PurifyTermOffsets) * cTerms));
+   if(nullptr == aOffsets) {
+      LOG_0(Trace_Warning, "WARNING PurifyModel nullptr == aOffsets");
+      return Error_OutOfMemory;
+   }
+
+   // The tensors of the terms are laid out one after the other in each array. A term's tensor has the product of its
+   // dimension lengths as bins, so a term without dimensions has a single bin, and its impurities have the same
+   // number of surface bins that Purify would fill. The offsets are found before any term runs so that every term
+   // can be purified independently.
+   size_t iDimensionLength = 0;
+   size_t iWeight = 0;
+   size_t iImpurity = 0;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      aOffsets[iTerm].m_iDimensionLength = iDimensionLength;
+      aOffsets[iTerm].m_iWeight = iWeight;
+      aOffsets[iTerm].m_iImpurity = iImpurity;
+
+      const IntEbm countDimensions = dimensionCounts[iTerm];
+      if(countDimensions < IntEbm{0} || IntEbm{k_cDimensionsMax} < countDimensions) {
+         LOG_0(Trace_Error, "ERROR PurifyModel countDimensions must be between 0 and k_cDimensionsMax");
+         free(aOffsets);
+         return Error_IllegalParamVal;
+      }
+      const size_t cDimensions = static_cast<size_t>(countDimensions);
+      if(size_t{0} != cDimensions && nullptr == dimensionLengths) {
+         LOG_0(Trace_Error, "ERROR PurifyModel nullptr == dimensionLengths");
+         free(aOffsets);
+         return Error_IllegalParamVal;
+      }
+
+      size_t cTensorBins = 1;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         const IntEbm dimensionLength = dimensionLengths[iDimensionLength + iDimension];
+         if(dimensionLength < IntEbm{0} || IsConvertError<size_t>(dimensionLength) ||
+               IsMultiplyError(cTensorBins, static_cast<size_t>(dimensionLength))) {
+            LOG_0(Trace_Error, "ERROR PurifyModel invalid dimensionLength");
+            free(aOffsets);
+            return Error_IllegalParamVal;
+         }
+         cTensorBins *= static_cast<size_t>(dimensionLength);
+      }
+
+      size_t cSurfaceBins = 0;
+      if(1 < cDimensions && size_t{0} != cTensorBins) {
+         for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+            // each addend is no larger than cTensorBins, and there are at most k_cDimensionsMax of them
+            cSurfaceBins += cTensorBins / static_cast<size_t>(dimensionLengths[iDimensionLength + iDimension]);
+         }
+      }
+
+      iDimensionLength += cDimensions;
+      if(IsAddError(iWeight, cTensorBins) || IsAddError(iImpurity, cSurfaceBins)) {
+         LOG_0(Trace_Error, "ERROR PurifyModel the total size of the tensors does not fit into a size_t");
+         free(aOffsets);
+         return Error_IllegalParamVal;
+      }
+      iWeight += cTensorBins;
+      iImpurity += cSurfaceBins;
+   }
+   if(IsMultiplyError(sizeof(double), cScores, iWeight) || IsMultiplyError(sizeof(double), cScores, iImpurity) ||
+         IsMultiplyError(sizeof(double), cScores, cTerms)) {
+      LOG_0(Trace_Error, "ERROR PurifyModel the total size of the tensors does not fit into memory");
+      free(aOffsets);
+      return Error_IllegalParamVal;
+   }
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      aOffsets[iTerm].m_iScore = aOffsets[iTerm].m_iWeight * cScores;
+      aOffsets[iTerm].m_iImpurity *= cScores;
+   }
+
+   if(size_t{0} != iWeight && (nullptr == weights || nullptr == scoresInOut)) {
+      LOG_0(Trace_Error, "ERROR PurifyModel weights and scoresInOut cannot be nullptr");
+      free(aOffsets);
+      return Error_IllegalParamVal;
+   }
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cTerms, &pThreadPool);
+   if(Error_None != error) {
+      free(aOffsets);
+      return error;
+   }
+
+   // each term seeds its own RNG in PurifyTerm, so the results match calling Purify on every term no matter which
+   // thread purifies which term
+   auto purifyTerm = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      UNUSED(iThread);
+      const PurifyTermOffsets* const pOffsets = &aOffsets[iTask];
+      const IntEbm countDimensions = dimensionCounts[iTask];
+      size_t cSweeps = 0;
+      const ErrorEbm errorTerm = PurifyTerm(tolerance,
+            isRandomized,
+            isMulticlassNormalization,
+            countMultiScores,
+            countDimensions,
+            IntEbm{0} == countDimensions ? nullptr : &dimensionLengths[pOffsets->m_iDimensionLength],
+            nullptr == weights ? nullptr : &weights[pOffsets->m_iWeight],
+            nullptr == scoresInOut ? nullptr : &scoresInOut[pOffsets->m_iScore],
+            nullptr == impuritiesOut ? nullptr : &impuritiesOut[pOffsets->m_iImpurity],
+            nullptr == interceptsOut ? nullptr : &interceptsOut[iTask * cScores],
+            &cSweeps);
+      if(nullptr != sweepCountsOut) {
+         // saturate instead of wrapping on the unlikely chance that a term never stops improving
+         sweepCountsOut[iTask] = IsConvertError<IntEbm>(cSweeps) ? std::numeric_limits<IntEbm>::max() :
+                                                                   static_cast<IntEbm>(cSweeps);
+      }
+      return errorTerm;
+   };
+   error = pThreadPool->Run(cTerms, purifyTerm);
+
+   ThreadPool::Return(pThreadPool);
+   free(aOffsets);
+
+   LOG_N(Trace_Info, "Exited PurifyModel: return=%" ErrorEbmPrintf, error);
+
+   return error;
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -85,6 +85,39 @@ class RandomDeterministic final {
       m_stateSeedConst = other.m_stateSeedConst;
    }
 
+   INLINE_ALWAYS static uint64_t Squares64(const uint64_t counter, const uint64_t key) {
+      // the counter based generator from https://arxiv.org/abs/2004.06278v2. Each result depends only on the counter
+      // and the key, so any element of the sequence can be computed directly. Initialize sanitizes m_stateSeedConst
+      // into the form that the paper requires of its keys, so our seed constants can be used as keys.
+      uint64_t x = counter * key;
+      const uint64_t y = x;
+      const uint64_t z = y + key;
+      x = x * x + y;
+      x = (x >> 32) | (x << 32);
+      x = x * x + z;
+      x = (x >> 32) | (x << 32);
+      x = x * x + y;
+      x = (x >> 32) | (x << 32);
+      x = x * x + z;
+      const uint64_t t = x;
+      x = (x >> 32) | (x << 32);
+      return t ^ ((x * x + y) >> 32);
+   }
+
+   INLINE_ALWAYS void InitializeStream(const RandomDeterministic& parent, const uint64_t iStream) {
+      // Unlike branching with parent.Next, this does not advance the parent, so threads can each take their own
+      // stream from a shared parent without coordinating, and stream iStream is the same no matter which streams
+      // were taken before it. The streams of a parent differ from those of the parent after it has advanced since
+      // m_state2 moves along its Weyl sequence.
+      const uint64_t seed = Squares64(parent.m_state2 + iStream, parent.m_stateSeedConst);
+      Initialize(seed);
+   }
+
+   INLINE_ALWAYS bool IsSameState(const RandomDeterministic& other) const {
+      // two generators in the same state will produce the same sequence from here on
+      return m_state1 == other.m_state1 && m_state2 == other.m_state2 && m_stateSeedConst == other.m_stateSeedConst;
+   }
+
    template<typename T>
    INLINE_ALWAYS typename std::enable_if<std::is_unsigned<T>::value &&
                std::numeric_limits<uint32_t>::max() < std::numeric_limits<T>::max(),
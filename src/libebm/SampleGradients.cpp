@@ -0,0 +1,310 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memcpy, memset
+#include <limits> // numeric_limits
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "ebm_internal.hpp"
+#include "RandomDeterministic.hpp"
+#include "RandomNondeterministic.hpp"
+#include "DataSetBoosting.hpp"
+#include "ThreadPool.hpp"
+#include "BoosterCore.hpp"
+#include "BoosterShell.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// The samples are ranked by the upper 16 bits of their float32 gradient magnitude, which is bfloat16 precision. The
+// magnitudes are never negative, so the sign bit is always clear and 15 bits remain for the bucket index.
+static constexpr size_t k_cGradientBuckets = size_t{1} << 15;
+
+template<typename TFloat, typename TFunc>
+static void VisitGradientBuckets(const size_t cScores,
+      const bool bHessian,
+      const bool bCompressed,
+      DataSubsetBoosting* const pSubset,
+      const TFunc& func) {
+   // calls func(iSample, iBucket) for every sample in the subset, where iBucket orders the samples by the sum of the
+   // absolute values of their gradients
+   const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+   const size_t cSamples = pSubset->GetCountSamples();
+   EBM_ASSERT(0 == cSamples % cSIMDPack);
+
+   const size_t cItems = bHessian ? size_t{2} : size_t{1};
+   const TFloat* const aGradHess = static_cast<const TFloat*>(pSubset->GetGradHess());
+   const Bfloat16* const aGradHessCompressed = static_cast<const Bfloat16*>(pSubset->GetGradHess());
+
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      size_t iGradHess = (iSample / cSIMDPack) * cSIMDPack * cItems * cScores + iSample % cSIMDPack;
+      float sum = 0.0f;
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         const float gradient = bCompressed ? Bfloat16ToFloat(aGradHessCompressed[iGradHess]) :
+                                              static_cast<float>(aGradHess[iGradHess]);
+         sum += std::abs(gradient);
+         iGradHess += cSIMDPack * cItems;
+      }
+      uint32_t bits;
+      memcpy(&bits, &sum, sizeof(bits));
+      const size_t iBucket = static_cast<size_t>(bits >> 16);
+      EBM_ASSERT(iBucket < k_cGradientBuckets);
+      func(iSample, iBucket);
+   }
+}
+
+template<typename TFunc>
+static void VisitGradientBuckets(
+      BoosterCore* const pBoosterCore, DataSubsetBoosting* const pSubset, const TFunc& func) {
+   const size_t cScores = pBoosterCore->GetCountScores();
+   const bool bHessian = pBoosterCore->IsHessian();
+   const bool bCompressed = pBoosterCore->IsCompressGradients();
+   if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+      VisitGradientBuckets<FloatBig>(cScores, bHessian, bCompressed, pSubset, func);
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+      VisitGradientBuckets<FloatSmall>(cScores, bHessian, bCompressed, pSubset, func);
+   }
+}
+
+static ErrorEbm SampleGradientsSubset(BoosterCore* const pBoosterCore,
+      DataSubsetBoosting* const pSubset,
+      const double topFraction,
+      const double otherFraction,
+      const uint64_t seed,
+      size_t* const aBuckets,
+      GradientSamples* const pGradientSamples) {
+   const size_t cSamples = pSubset->GetCountSamples();
+   EBM_ASSERT(1 <= cSamples);
+
+   const size_t cTop = EbmMin(static_cast<size_t>(topFraction * static_cast<double>(cSamples)), cSamples);
+   const size_t cRest = cSamples - cTop;
+   const size_t cOther = EbmMin(static_cast<size_t>(otherFraction * static_cast<double>(cSamples)), cRest);
+
+   pGradientSamples->m_cTop = cTop;
+   pGradientSamples->m_cOther = cOther;
+   pGradientSamples->m_otherWeight =
+         size_t{0} == cOther ? 0.0 : static_cast<double>(cRest) / static_cast<double>(cOther);
+   pGradientSamples->m_aiSamples = nullptr;
+   if(size_t{0} == cTop + cOther) {
+      return Error_None;
+   }
+
+   // cTop + cOther is at most cSamples, and we already have gradients for that many samples
+   size_t* const aiSamples = static_cast<size_t*>(malloc(sizeof(size_t) * (cTop + cOther)));
+   if(nullptr == aiSamples) {
+      LOG_0(Trace_Warning, "WARNING SampleGradientsSubset nullptr == aiSamples");
+      return Error_OutOfMemory;
+   }
+   pGradientSamples->m_aiSamples = aiSamples;
+
+   // find the bucket that the smallest of the top samples falls into. Everything above it is in the top group and
+   // the first cTopThreshold samples in it join them
+   size_t iBucketThreshold = k_cGradientBuckets;
+   size_t cTopThreshold = 0;
+   if(size_t{0} != cTop) {
+      memset(aBuckets, 0, sizeof(*aBuckets) * k_cGradientBuckets);
+      VisitGradientBuckets(pBoosterCore, pSubset, [aBuckets](const size_t iSample, const size_t iBucket) {
+         UNUSED(iSample);
+         ++aBuckets[iBucket];
+      });
+      size_t cAbove = 0;
+      do {
+         --iBucketThreshold;
+         if(cTop <= cAbove + aBuckets[iBucketThreshold]) {
+            break;
+         }
+         cAbove += aBuckets[iBucketThreshold];
+      } while(size_t{0} != iBucketThreshold);
+      cTopThreshold = cTop - cAbove;
+   }
+
+   // the rest is drawn with selection sampling, which visits the samples in order and keeps each one with the
+   // probability of the number still needed over the number still available
+   RandomDeterministic rng;
+   rng.Initialize(seed);
+
+   size_t* piTop = aiSamples;
+   size_t* piOther = aiSamples + cTop;
+   size_t cRestRemaining = cRest;
+   size_t cOtherRemaining = cOther;
+   VisitGradientBuckets(pBoosterCore, pSubset, [&](const size_t iSample, const size_t iBucket) {
+      if(iBucketThreshold < iBucket || (iBucketThreshold == iBucket && size_t{0} != cTopThreshold)) {
+         if(iBucketThreshold == iBucket) {
+            --cTopThreshold;
+         }
+         *piTop = iSample;
+         ++piTop;
+      } else {
+         EBM_ASSERT(1 <= cRestRemaining);
+         if(size_t{0} != cOtherRemaining && rng.NextFast(cRestRemaining) < cOtherRemaining) {
+            *piOther = iSample;
+            ++piOther;
+            --cOtherRemaining;
+         }
+         --cRestRemaining;
+      }
+   });
+   EBM_ASSERT(aiSamples + cTop == piTop);
+   EBM_ASSERT(aiSamples + cTop + cOther == piOther);
+   EBM_ASSERT(size_t{0} == cRestRemaining);
+   EBM_ASSERT(size_t{0} == cOtherRemaining);
+
+   return Error_None;
+}
+
+// we made this a global because if we had put this variable inside the BoosterCore object, then we would need to
+// dereference that before getting the count.  By making this global we can send a log message incase a bad BoosterCore
+// object is sent into us we only decrease the count if the count is non-zero, so at worst if there is a race condition
+// then we'll output this log message more times than desired, but we can live with that
+static int g_cLogSampleGradients = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleGradients(
+      void* rng, BoosterHandle boosterHandle, double topFraction, double otherFraction) {
+   LOG_COUNTED_N(&g_cLogSampleGradients,
+         Trace_Info,
+         Trace_Verbose,
+         "SampleGradients: "
+         "rng=%p, "
+         "boosterHandle=%p, "
+         "topFraction=%le, "
+         "otherFraction=%le",
+         rng,
+         static_cast<void*>(boosterHandle),
+         topFraction,
+         otherFraction);
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   // written so that NaN fails the comparisons
+   if(!(0.0 <= topFraction && topFraction <= 1.0)) {
+      LOG_0(Trace_Error, "ERROR SampleGradients topFraction must be between 0.0 and 1.0");
+      return Error_IllegalParamVal;
+   }
+   if(!(0.0 <= otherFraction && otherFraction <= 1.0)) {
+      LOG_0(Trace_Error, "ERROR SampleGradients otherFraction must be between 0.0 and 1.0");
+      return Error_IllegalParamVal;
+   }
+
+   // a histogram left by ApplyTermUpdateAndBinNext would include every sample
+   pBoosterShell->SetTermIndexBinned(BoosterShell::k_illegalTermIndex);
+   pBoosterShell->FreeGradientSamples();
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   EBM_ASSERT(nullptr != pBoosterCore);
+
+   if(1.0 <= topFraction + otherFraction) {
+      // every sample would be kept, so boost on all of them without the reweighting
+      return Error_None;
+   }
+   if(size_t{0} == pBoosterCore->GetCountScores()) {
+      LOG_0(Trace_Warning, "WARNING SampleGradients size_t { 0 } == pBoosterCore->GetCountScores()");
+      return Error_None;
+   }
+   if(size_t{0} == pBoosterCore->GetTrainingSet()->GetCountSamples()) {
+      LOG_0(Trace_Warning, "WARNING SampleGradients size_t { 0 } == pBoosterCore->GetTrainingSet()->GetCountSamples()");
+      return Error_None;
+   }
+
+   RandomDeterministic* pRng = reinterpret_cast<RandomDeterministic*>(rng);
+   RandomDeterministic rngInternal;
+   if(nullptr == pRng) {
+      // the samples outside of the top group only need to be spread evenly, so a non-deterministic seed is enough
+      uint64_t seed;
+      try {
+         RandomNondeterministic<uint64_t> randomGenerator;
+         seed = randomGenerator.Next(std::numeric_limits<uint64_t>::max());
+      } catch(const std::bad_alloc&) {
+         LOG_0(Trace_Warning, "WARNING SampleGradients Out of memory in std::random_device");
+         return Error_OutOfMemory;
+      } catch(...) {
+         LOG_0(Trace_Warning, "WARNING SampleGradients Unknown error in std::random_device");
+         return Error_UnexpectedInternal;
+      }
+      rngInternal.Initialize(seed);
+      pRng = &rngInternal;
+   }
+
+   const size_t cSubsets = pBoosterCore->GetTrainingSet()->GetCountSubsets();
+   EBM_ASSERT(1 <= cSubsets);
+   DataSubsetBoosting* const aSubsets = pBoosterCore->GetTrainingSet()->GetSubsets();
+   const size_t cThreads = pBoosterCore->GetCountThreads();
+   EBM_ASSERT(1 <= cThreads);
+
+   if(IsMultiplyError(sizeof(GradientSamples), cSubsets)) {
+      LOG_0(Trace_Warning, "WARNING SampleGradients IsMultiplyError(sizeof(GradientSamples), cSubsets)");
+      return Error_OutOfMemory;
+   }
+   GradientSamples* const aGradientSamples = static_cast<GradientSamples*>(malloc(sizeof(GradientSamples) * cSubsets));
+   if(nullptr == aGradientSamples) {
+      LOG_0(Trace_Warning, "WARNING SampleGradients nullptr == aGradientSamples");
+      return Error_OutOfMemory;
+   }
+   for(size_t iSubset = 0; iSubset < cSubsets; ++iSubset) {
+      aGradientSamples[iSubset].m_aiSamples = nullptr;
+   }
+   pBoosterShell->SetGradientSamples(cSubsets, aGradientSamples);
+
+   // the seeds are drawn on this thread in subset order so that the result does not depend on the number of threads.
+   // Each thread gets its own slice of the bucket counts
+   if(IsMultiplyError(sizeof(size_t), k_cGradientBuckets, cThreads)) {
+      LOG_0(Trace_Warning, "WARNING SampleGradients IsMultiplyError(sizeof(size_t), k_cGradientBuckets, cThreads)");
+      pBoosterShell->FreeGradientSamples();
+      return Error_OutOfMemory;
+   }
+   size_t* const aBuckets = static_cast<size_t*>(malloc(sizeof(size_t) * k_cGradientBuckets * cThreads));
+   uint64_t* const aSeeds = static_cast<uint64_t*>(malloc(sizeof(uint64_t) * cSubsets));
+   if(nullptr == aBuckets || nullptr == aSeeds) {
+      LOG_0(Trace_Warning, "WARNING SampleGradients nullptr == aBuckets || nullptr == aSeeds");
+      free(aBuckets);
+      free(aSeeds);
+      pBoosterShell->FreeGradientSamples();
+      return Error_OutOfMemory;
+   }
+   for(size_t iSubset = 0; iSubset < cSubsets; ++iSubset) {
+      aSeeds[iSubset] = pRng->NextFast(std::numeric_limits<uint64_t>::max());
+   }
+
+   auto sampleSubset = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      return SampleGradientsSubset(pBoosterCore,
+            &aSubsets[iTask],
+            topFraction,
+            otherFraction,
+            aSeeds[iTask],
+            &aBuckets[k_cGradientBuckets * iThread],
+            &aGradientSamples[iTask]);
+   };
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cThreads, &pThreadPool);
+   if(Error_None == error) {
+      error = pThreadPool->RunAffine(cSubsets, sampleSubset);
+      ThreadPool::Return(pThreadPool);
+   }
+
+   free(aBuckets);
+   free(aSeeds);
+
+   if(Error_None != error) {
+      pBoosterShell->FreeGradientSamples();
+      return error;
+   }
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
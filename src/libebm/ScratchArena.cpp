@@ -0,0 +1,304 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <new> // std::bad_alloc
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError
+#include "ScratchArena.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+ScratchArena::~ScratchArena() {
+   // every shell holds a reference, so nothing can still be in use once we are deleted
+   EBM_ASSERT(0 == m_cBytesInUse);
+   for(size_t iBlock = 0; iBlock < m_cBlocks; ++iBlock) {
+      AlignedFree(m_aBlocks[iBlock].m_p);
+   }
+}
+
+void ScratchArena::Free(ScratchArena* const pScratchArena) {
+   LOG_0(Trace_Info, "Entered ScratchArena::Free");
+   if(nullptr != pScratchArena) {
+      // see BoosterCore::Free for the memory ordering
+      if(size_t{1} == pScratchArena->m_REFERENCE_COUNT.fetch_sub(1, std::memory_order_release)) {
+         std::atomic_thread_fence(std::memory_order_acquire);
+         LOG_0(Trace_Info, "INFO ScratchArena::Free deleting ScratchArena");
+         delete pScratchArena;
+      }
+   }
+   LOG_0(Trace_Info, "Exited ScratchArena::Free");
+}
+
+ErrorEbm ScratchArena::Create(ScratchArena** const ppScratchArenaOut) {
+   LOG_0(Trace_Info, "Entered ScratchArena::Create");
+
+   EBM_ASSERT(nullptr != ppScratchArenaOut);
+   EBM_ASSERT(nullptr == *ppScratchArenaOut);
+
+   ScratchArena* pScratchArena;
+   try {
+      pScratchArena = new ScratchArena();
+   } catch(const std::bad_alloc&) {
+      LOG_0(Trace_Warning, "WARNING ScratchArena::Create Out of memory allocating ScratchArena");
+      return Error_OutOfMemory;
+   } catch(...) {
+      LOG_0(Trace_Warning, "WARNING ScratchArena::Create Unknown error");
+      return Error_UnexpectedInternal;
+   }
+   if(nullptr == pScratchArena) {
+      // this should be impossible since bad_alloc should have been thrown, but let's be untrusting
+      LOG_0(Trace_Warning, "WARNING ScratchArena::Create nullptr == pScratchArena");
+      return Error_OutOfMemory;
+   }
+   *ppScratchArenaOut = pScratchArena;
+
+   LOG_0(Trace_Info, "Exited ScratchArena::Create");
+   return Error_None;
+}
+
+void* ScratchArena::Take(const size_t cBytes, size_t* const pcBytesOut) {
+   EBM_ASSERT(nullptr != pcBytesOut);
+
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      // take the smallest cached block that is big enough, so the large blocks stay available for large requests
+      size_t iBest = k_cBlocksMax;
+      for(size_t iBlock = 0; iBlock < m_cBlocks; ++iBlock) {
+         const size_t cBlockBytes = m_aBlocks[iBlock].m_cBytes;
+         if(cBytes <= cBlockBytes && (k_cBlocksMax == iBest || cBlockBytes < m_aBlocks[iBest].m_cBytes)) {
+            iBest = iBlock;
+         }
+      }
+      if(k_cBlocksMax != iBest) {
+         void* const p = m_aBlocks[iBest].m_p;
+         const size_t cBlockBytes = m_aBlocks[iBest].m_cBytes;
+         --m_cBlocks;
+         m_aBlocks[iBest] = m_aBlocks[m_cBlocks];
+
+         EBM_ASSERT(cBlockBytes <= m_cBytesCached);
+         m_cBytesCached -= cBlockBytes;
+         m_cBytesInUse += cBlockBytes;
+         ++m_cReuses;
+
+         *pcBytesOut = cBlockBytes;
+         return p;
+      }
+   }
+
+   // allocate outside of the lock so that other threads can recycle blocks in the meantime
+   void* const p = AlignedAlloc(cBytes);
+   if(nullptr == p) {
+      LOG_0(Trace_Warning, "WARNING ScratchArena::Take nullptr == p");
+      return nullptr;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_cBytesInUse += cBytes;
+      ++m_cAllocations;
+   }
+
+   *pcBytesOut = cBytes;
+   return p;
+}
+
+void ScratchArena::Give(void* const p, const size_t cBytes) {
+   EBM_ASSERT(nullptr != p);
+
+   void* pFree;
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      EBM_ASSERT(cBytes <= m_cBytesInUse);
+      m_cBytesInUse -= cBytes;
+
+      if(m_cBlocks < k_cBlocksMax) {
+         m_aBlocks[m_cBlocks].m_p = p;
+         m_aBlocks[m_cBlocks].m_cBytes = cBytes;
+         ++m_cBlocks;
+         m_cBytesCached += cBytes;
+         return;
+      }
+
+      // the cache is full, so keep the larger of p and the smallest cached block
+      size_t iSmallest = 0;
+      for(size_t iBlock = 1; iBlock < m_cBlocks; ++iBlock) {
+         if(m_aBlocks[iBlock].m_cBytes < m_aBlocks[iSmallest].m_cBytes) {
+            iSmallest = iBlock;
+         }
+      }
+      if(m_aBlocks[iSmallest].m_cBytes < cBytes) {
+         pFree = m_aBlocks[iSmallest].m_p;
+         m_cBytesCached -= m_aBlocks[iSmallest].m_cBytes;
+         m_cBytesCached += cBytes;
+         m_aBlocks[iSmallest].m_p = p;
+         m_aBlocks[iSmallest].m_cBytes = cBytes;
+      } else {
+         pFree = p;
+      }
+   }
+   AlignedFree(pFree);
+}
+
+void* ScratchArena::Alloc(ScratchArena* const pScratchArena, const size_t cBytes, size_t* const pcBytesOut) {
+   EBM_ASSERT(nullptr != pcBytesOut);
+   if(nullptr == pScratchArena) {
+      void* const p = AlignedAlloc(cBytes);
+      *pcBytesOut = nullptr == p ? size_t{0} : cBytes;
+      return p;
+   }
+   void* const p = pScratchArena->Take(cBytes, pcBytesOut);
+   if(nullptr == p) {
+      *pcBytesOut = 0;
+   }
+   return p;
+}
+
+void ScratchArena::Release(ScratchArena* const pScratchArena, void* const p, const size_t cBytes) {
+   if(nullptr != p) {
+      if(nullptr == pScratchArena) {
+         AlignedFree(p);
+      } else {
+         pScratchArena->Give(p, cBytes);
+      }
+   }
+}
+
+ErrorEbm ScratchArena::Grow(
+      ScratchArena* const pScratchArena, void** const pp, size_t* const pcBytes, const size_t cRequiredBytes) {
+   EBM_ASSERT(nullptr != pp);
+   EBM_ASSERT(nullptr != pcBytes);
+   if(nullptr == pScratchArena) {
+      return AlignedGrow(pp, pcBytes, cRequiredBytes, EBM_FALSE);
+   }
+   if(*pcBytes < cRequiredBytes) {
+      Release(pScratchArena, *pp, *pcBytes);
+      *pp = nullptr;
+      *pcBytes = 0;
+
+      void* const p = pScratchArena->Take(cRequiredBytes, pcBytes);
+      if(nullptr == p) {
+         *pcBytes = 0;
+         return Error_OutOfMemory;
+      }
+      *pp = p;
+   }
+   return Error_None;
+}
+
+void ScratchArena::GetCounts(size_t* const pcBytesInUseOut,
+      size_t* const pcBytesCachedOut,
+      size_t* const pcAllocationsOut,
+      size_t* const pcReusesOut) {
+   std::lock_guard<std::mutex> lock(m_mutex);
+   *pcBytesInUseOut = m_cBytesInUse;
+   *pcBytesCachedOut = m_cBytesCached;
+   *pcAllocationsOut = m_cAllocations;
+   *pcReusesOut = m_cReuses;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateScratchArena(ScratchArenaHandle* scratchArenaHandleOut) {
+   LOG_N(Trace_Info,
+         "Entered CreateScratchArena: scratchArenaHandleOut=%p",
+         static_cast<void*>(scratchArenaHandleOut));
+
+   if(nullptr == scratchArenaHandleOut) {
+      LOG_0(Trace_Error, "ERROR CreateScratchArena nullptr == scratchArenaHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *scratchArenaHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   ScratchArena* pScratchArena = nullptr;
+   const ErrorEbm error = ScratchArena::Create(&pScratchArena);
+   if(Error_None != error) {
+      return error;
+   }
+
+   const ScratchArenaHandle handle = pScratchArena->GetHandle();
+
+   LOG_N(Trace_Info, "Exited CreateScratchArena: *scratchArenaHandleOut=%p", static_cast<void*>(handle));
+
+   *scratchArenaHandleOut = handle;
+   return Error_None;
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION FreeScratchArena(ScratchArenaHandle scratchArenaHandle) {
+   LOG_N(Trace_Info, "Entered FreeScratchArena: scratchArenaHandle=%p", static_cast<void*>(scratchArenaHandle));
+
+   if(nullptr != scratchArenaHandle) {
+      ScratchArena* const pScratchArena = ScratchArena::GetScratchArenaFromHandle(scratchArenaHandle);
+      if(nullptr != pScratchArena) {
+         pScratchArena->InvalidateHandle();
+         ScratchArena::Free(pScratchArena);
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited FreeScratchArena");
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetScratchArenaCounts(ScratchArenaHandle scratchArenaHandle,
+      IntEbm* countBytesInUseOut,
+      IntEbm* countBytesCachedOut,
+      IntEbm* countAllocationsOut,
+      IntEbm* countReusesOut) {
+   LOG_N(Trace_Info,
+         "Entered GetScratchArenaCounts: "
+         "scratchArenaHandle=%p, "
+         "countBytesInUseOut=%p, "
+         "countBytesCachedOut=%p, "
+         "countAllocationsOut=%p, "
+         "countReusesOut=%p",
+         static_cast<void*>(scratchArenaHandle),
+         static_cast<void*>(countBytesInUseOut),
+         static_cast<void*>(countBytesCachedOut),
+         static_cast<void*>(countAllocationsOut),
+         static_cast<void*>(countReusesOut));
+
+   ScratchArena* const pScratchArena = ScratchArena::GetScratchArenaFromHandle(scratchArenaHandle);
+   if(nullptr == pScratchArena) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   size_t cBytesInUse;
+   size_t cBytesCached;
+   size_t cAllocations;
+   size_t cReuses;
+   pScratchArena->GetCounts(&cBytesInUse, &cBytesCached, &cAllocations, &cReuses);
+
+   if(IsConvertError<IntEbm>(cBytesInUse) || IsConvertError<IntEbm>(cBytesCached) ||
+         IsConvertError<IntEbm>(cAllocations) || IsConvertError<IntEbm>(cReuses)) {
+      // the memory could not all exist if these did not fit
+      LOG_0(Trace_Error, "ERROR GetScratchArenaCounts IsConvertError<IntEbm>");
+      return Error_UnexpectedInternal;
+   }
+
+   if(nullptr != countBytesInUseOut) {
+      *countBytesInUseOut = static_cast<IntEbm>(cBytesInUse);
+   }
+   if(nullptr != countBytesCachedOut) {
+      *countBytesCachedOut = static_cast<IntEbm>(cBytesCached);
+   }
+   if(nullptr != countAllocationsOut) {
+      *countAllocationsOut = static_cast<IntEbm>(cAllocations);
+   }
+   if(nullptr != countReusesOut) {
+      *countReusesOut = static_cast<IntEbm>(cReuses);
+   }
+
+   LOG_0(Trace_Info, "Exited GetScratchArenaCounts");
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
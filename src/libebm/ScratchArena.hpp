@@ -0,0 +1,112 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef SCRATCH_ARENA_HPP
+#define SCRATCH_ARENA_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <atomic>
+#include <mutex>
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // AlignedAlloc
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// A ScratchArena recycles the bin, split position and tree node buffers of BoosterShell and InteractionShell objects.
+// When a shell is freed its buffers are cached here instead of being returned to the heap, and the next shell takes
+// them instead of allocating.  Every block is an AlignedAlloc allocation, so the static functions accept a nullptr
+// arena and then behave like AlignedAlloc, AlignedFree and AlignedGrow.  Any number of threads can use one arena.
+class ScratchArena final {
+   static constexpr size_t k_handleVerificationOk = 8191; // random 15 bit number
+   static constexpr size_t k_handleVerificationFreed = 19507; // random 15 bit number
+   size_t m_handleVerification; // this needs to be at the top and make it pointer sized to keep best alignment
+
+   // the caller's handle holds one reference and every shell made with the arena holds another
+   std::atomic_size_t m_REFERENCE_COUNT;
+
+   // more blocks than this are not worth searching, so the smallest cached block is freed instead
+   static constexpr size_t k_cBlocksMax = 64;
+
+   struct ScratchBlock {
+      void* m_p;
+      size_t m_cBytes;
+   };
+
+   std::mutex m_mutex;
+   size_t m_cBlocks;
+   ScratchBlock m_aBlocks[k_cBlocksMax];
+
+   size_t m_cBytesCached;
+   size_t m_cBytesInUse;
+   size_t m_cAllocations;
+   size_t m_cReuses;
+
+   inline ScratchArena() noexcept :
+         m_handleVerification(k_handleVerificationOk),
+         m_REFERENCE_COUNT(1), // we're not visible on any other thread yet, so no synchronization required
+         m_cBlocks(0),
+         m_cBytesCached(0),
+         m_cBytesInUse(0),
+         m_cAllocations(0),
+         m_cReuses(0) {}
+
+   ~ScratchArena();
+
+   void* Take(const size_t cBytes, size_t* const pcBytesOut);
+   void Give(void* const p, const size_t cBytes);
+
+ public:
+   static ErrorEbm Create(ScratchArena** const ppScratchArenaOut);
+   static void Free(ScratchArena* const pScratchArena);
+
+   inline void AddReferenceCount() {
+      // incrementing reference counts can be relaxed memory order since we're guaranteed to be above 1,
+      // so no result will change our behavior below
+      // https://www.boost.org/doc/libs/1_59_0/doc/html/atomic/usage_examples.html
+      m_REFERENCE_COUNT.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   inline static ScratchArena* GetScratchArenaFromHandle(const ScratchArenaHandle scratchArenaHandle) {
+      if(nullptr == scratchArenaHandle) {
+         LOG_0(Trace_Error, "ERROR GetScratchArenaFromHandle null scratchArenaHandle");
+         return nullptr;
+      }
+      ScratchArena* const pScratchArena = reinterpret_cast<ScratchArena*>(scratchArenaHandle);
+      if(k_handleVerificationOk == pScratchArena->m_handleVerification) {
+         return pScratchArena;
+      }
+      if(k_handleVerificationFreed == pScratchArena->m_handleVerification) {
+         LOG_0(Trace_Error, "ERROR GetScratchArenaFromHandle attempt to use freed ScratchArenaHandle");
+      } else {
+         LOG_0(Trace_Error, "ERROR GetScratchArenaFromHandle attempt to use invalid ScratchArenaHandle");
+      }
+      return nullptr;
+   }
+   inline ScratchArenaHandle GetHandle() { return reinterpret_cast<ScratchArenaHandle>(this); }
+
+   // the shells made from the arena keep it alive after the caller frees the handle
+   inline void InvalidateHandle() { m_handleVerification = k_handleVerificationFreed; }
+
+   // *pcBytesOut receives the usable size of the block, which can be larger than cBytes if a cached block was reused
+   static void* Alloc(ScratchArena* const pScratchArena, const size_t cBytes, size_t* const pcBytesOut);
+   // cBytes must be the size that Alloc or Grow returned for p.  p can be nullptr
+   static void Release(ScratchArena* const pScratchArena, void* const p, const size_t cBytes);
+   // the same as AlignedGrow without copying
+   static ErrorEbm Grow(
+         ScratchArena* const pScratchArena, void** const pp, size_t* const pcBytes, const size_t cRequiredBytes);
+
+   void GetCounts(size_t* const pcBytesInUseOut,
+         size_t* const pcBytesCachedOut,
+         size_t* const pcAllocationsOut,
+         size_t* const pcReusesOut);
+};
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // SCRATCH_ARENA_HPP
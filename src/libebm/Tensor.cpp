@@ -7,7 +7,7 @@
 #include <type_traits> // std::is_standard_layout
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
-#include <string.h> // memcpy
+#include <string.h> // memcpy, memcmp
 
 #define ZONE_main
 #include "zones.h"
@@ -245,7 +245,53 @@ ErrorEbm Tensor::Expand(const Term* const pTerm) {
 
    EBM_ASSERT(nullptr != pTerm);
    const size_t cDimensions = pTerm->GetCountDimensions();
-   if(size_t{0} != cDimensions) {
+   if(size_t{1} == cDimensions) {
+      // most terms are single features, and with only one split array to follow we do not need the dimension stack
+      const size_t cBins = pTerm->GetTermFeatures()[0].m_pFeature->GetCountBins();
+      EBM_ASSERT(size_t{1} <= cBins); // we exited above on tensors with zero bins in any dimension
+      const DimensionInfo* const pDimension = GetDimensions();
+      const size_t cSlices = pDimension->m_cSlices;
+      if(cSlices != cBins) {
+         EBM_ASSERT(cSlices < cBins);
+         EBM_ASSERT(!IsMultiplyError(m_cScores, cBins));
+         error = EnsureTensorScoreCapacity(m_cScores * cBins);
+         if(UNLIKELY(Error_None != error)) {
+            // already logged
+            return error;
+         }
+
+         // traverse in reverse so that we never overwrite a slice before we have copied it into all of its bins
+         FloatScore* const aTensorScores = m_aTensorScores;
+         const UIntSplit* const aSplits = pDimension->m_aSplits;
+         size_t iSlice = cSlices - 1;
+         size_t iBin = cBins;
+         do {
+            --iBin;
+            while(size_t{0} != iSlice && iBin < static_cast<size_t>(aSplits[iSlice - 1])) {
+               --iSlice;
+            }
+            if(iSlice == iBin) {
+               // the splits below are 1, 2, 3, ... so the remaining slices are already in their bins
+               break;
+            }
+            memcpy(&aTensorScores[iBin * m_cScores], &aTensorScores[iSlice * m_cScores], sizeof(FloatScore) * m_cScores);
+         } while(size_t{0} != iBin);
+
+         error = SetCountSlices(0, cBins);
+         if(UNLIKELY(Error_None != error)) {
+            // already logged
+            return error;
+         }
+         UIntSplit* const aSplit = GetDimensions()->m_aSplits;
+         size_t iEdge = 1;
+         do {
+            // we checked earlier that countBins could be converted to a UIntSplit
+            EBM_ASSERT(!IsConvertError<UIntSplit>(iEdge));
+            aSplit[iEdge - 1] = static_cast<UIntSplit>(iEdge);
+            ++iEdge;
+         } while(cBins != iEdge);
+      }
+   } else if(size_t{0} != cDimensions) {
       const TermFeature* pTermFeature1 = pTerm->GetTermFeatures();
       const TermFeature* const pTermFeaturesEnd = &pTermFeature1[cDimensions];
       DimensionInfoStackExpand aDimensionInfoStackExpand[k_cDimensionsMax];
@@ -481,12 +527,31 @@ ErrorEbm Tensor::Add(const Tensor& rhs) {
       return Error_None;
    }
 
-   if(m_bExpanded) {
-      // TODO: the existing code below works, but handle this differently (we can do it more efficiently)
-   }
-
-   if(rhs.m_bExpanded) {
-      // TODO: the existing code below works, but handle this differently (we can do it more efficiently)
+   // When both tensors have the same splits, which is always the case when both are expanded, the cells line up
+   // and we can add them directly without merging the splits
+   // TODO: handle the case where only one of the tensors is expanded more efficiently too
+   size_t cSameCells = m_cScores;
+   const DimensionInfo* const aDimensionSame1 = GetDimensions();
+   const DimensionInfo* const aDimensionSame2 = rhs.GetDimensions();
+   size_t iDimensionSame = 0;
+   do {
+      const size_t cSlices = aDimensionSame1[iDimensionSame].m_cSlices;
+      if(cSlices != aDimensionSame2[iDimensionSame].m_cSlices ||
+            0 != memcmp(aDimensionSame1[iDimensionSame].m_aSplits,
+                       aDimensionSame2[iDimensionSame].m_aSplits,
+                       sizeof(UIntSplit) * (cSlices - 1))) {
+         break;
+      }
+      cSameCells *= cSlices; // this can't overflow since we're counting existing allocated memory
+      ++iDimensionSame;
+   } while(m_cDimensions != iDimensionSame);
+   if(m_cDimensions == iDimensionSame) {
+      FloatScore* const aTo = m_aTensorScores;
+      const FloatScore* const aFrom = rhs.m_aTensorScores;
+      for(size_t i = 0; i < cSameCells; ++i) {
+         aTo[i] += aFrom[i];
+      }
+      return Error_None;
    }
 
    const DimensionInfo* pDimensionFirst1 = GetDimensions();
@@ -218,6 +218,20 @@ class Tensor final {
    }
 
    inline FloatScore* GetTensorScoresPointer() { return m_aTensorScores; }
+
+   // the bytes of the Tensor object itself, excluding the score and split arrays
+   inline static size_t CountBytesFixed(const size_t cDimensionsMax) {
+      return offsetof(Tensor, m_aDimensions) + sizeof(DimensionInfo) * cDimensionsMax;
+   }
+
+   // the bytes held by this tensor, including the capacity that has not been used yet
+   inline size_t CountBytes() const {
+      size_t cBytes = CountBytesFixed(m_cDimensionsMax) + m_cTensorScoreCapacity;
+      for(size_t iDimension = 0; iDimension < m_cDimensionsMax; ++iDimension) {
+         cBytes += sizeof(UIntSplit) * (GetDimensions()[iDimension].m_cSliceCapacity - size_t{1});
+      }
+      return cBytes;
+   }
 };
 static_assert(std::is_standard_layout<Tensor>::value,
       "We use the struct hack in several places, so disallow non-standard_layout types in general");
@@ -24,6 +24,9 @@ namespace DEFINED_ZONE_NAME {
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
+// the sums along the lowest dimensions of a tensor are finished one block of at most this many bytes at a time
+static constexpr size_t k_cBytesTotalsBlockMax = size_t{32768};
+
 // TODO: Implement a far more efficient boosting algorithm for higher dimensional interactions.  The algorithm works as
 // follows:
 //   - instead of first calculating the sums at each point for the hyper-dimensional region from the origin to each
@@ -219,6 +222,34 @@ template<bool bHessian, size_t cCompilerScores, size_t cCompilerDimensions> clas
  public:
    TensorTotalsBuildInternal() = delete; // this is a static class.  Do not construct
 
+   // turns the bins in [pStart, pEnd) into running sums along one dimension. The range is made of independent runs
+   // of cBytesRun bytes, and within a run each bin adds the bin that is cBytesStride bytes before it. Both bins are
+   // read in order, so this streams through memory regardless of the stride.
+   INLINE_ALWAYS static void SumDimension(const size_t cScores,
+         unsigned char* const pStart,
+         const unsigned char* const pEnd,
+         const size_t cBytesStride,
+         const size_t cBytesRun) {
+      static constexpr size_t cArrayScores = GetArrayScores(cCompilerScores);
+
+      const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+
+      EBM_ASSERT(cBytesStride < cBytesRun);
+      EBM_ASSERT(0 == (pEnd - pStart) % cBytesRun);
+
+      unsigned char* pRun = pStart;
+      do {
+         auto* pBin = reinterpret_cast<Bin<FloatMain, UIntMain, true, true, bHessian, cArrayScores>*>(pRun);
+         const auto* const pBinEnd = IndexBin(pBin, cBytesRun);
+         pBin = IndexBin(pBin, cBytesStride);
+         do {
+            pBin->Add(cScores, *NegativeIndexBin(pBin, cBytesStride));
+            pBin = IndexBin(pBin, cBytesPerBin);
+         } while(pBinEnd != pBin);
+         pRun += cBytesRun;
+      } while(pEnd != pRun);
+   }
+
    static void Func(const size_t cRuntimeScores,
          const size_t cRuntimeRealDimensions,
          const size_t* const acBins,
@@ -232,17 +263,11 @@ template<bool bHessian, size_t cCompilerScores, size_t cCompilerDimensions> clas
    ) {
       static constexpr size_t cArrayScores = GetArrayScores(cCompilerScores);
 
-      struct FastTotalState {
-         Bin<FloatMain, UIntMain, true, true, bHessian, cArrayScores>* m_pDimensionalCur;
-         Bin<FloatMain, UIntMain, true, true, bHessian, cArrayScores>* m_pDimensionalWrap;
-         Bin<FloatMain, UIntMain, true, true, bHessian, cArrayScores>* m_pDimensionalFirst;
-         size_t m_iCur;
-         size_t m_cBins;
-      };
-
       LOG_0(Trace_Verbose, "Entered BuildFastTotals");
 
-      auto* pAuxiliaryBin = aAuxiliaryBinsBase->Specialize<FloatMain, UIntMain, true, true, bHessian, cArrayScores>();
+      // the totals are built in place, so we no longer need the auxiliary bins, which our callers zero and
+      // use for other scratch space afterwards
+      UNUSED(aAuxiliaryBinsBase);
 
       auto* const aBins = aBinsBase->Specialize<FloatMain, UIntMain, true, true, bHessian, cArrayScores>();
 
@@ -252,114 +277,73 @@ template<bool bHessian, size_t cCompilerScores, size_t cCompilerDimensions> clas
       const size_t cScores = GET_COUNT_SCORES(cCompilerScores, cRuntimeScores);
       const size_t cBytesPerBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
 
-      FastTotalState fastTotalState[k_cDimensionsMax];
-      FastTotalState* pFastTotalStateInitialize = fastTotalState;
+      // acBytesStride[iDimension] is the distance between neighbouring bins along iDimension and
+      // acBytesStride[iDimension + 1] is the length of the runs that the sums along iDimension stay within.
+      // The lowest cDimensionsBlock dimensions together span no more than k_cBytesTotalsBlockMax bytes.
+      size_t acBytesStride[k_cDimensionsMax + 1];
+      size_t cDimensionsBlock = 0;
       {
-         const size_t* pcBins = acBins;
-         const size_t* const pcBinsEnd = &acBins[cRuntimeRealDimensions];
-         size_t iAuxiliaryByte = cBytesPerBin;
+         size_t cBytesStride = cBytesPerBin;
+         size_t iDimension = 0;
          do {
-            ASSERT_BIN_OK(cBytesPerBin, pAuxiliaryBin, pBinsEndDebug);
-
-            const size_t cBins = *pcBins;
+            const size_t cBins = acBins[iDimension];
             // cBins can only be 0 if there are zero training and zero validation samples
             // we don't boost or allow interaction updates if there are zero training samples
             EBM_ASSERT(2 <= cBins);
-            pFastTotalStateInitialize->m_iCur = 0;
-            pFastTotalStateInitialize->m_cBins = cBins;
-
-            pFastTotalStateInitialize->m_pDimensionalFirst = pAuxiliaryBin;
-            pFastTotalStateInitialize->m_pDimensionalCur = pAuxiliaryBin;
-            // when we exit, pAuxiliaryBin should be == to pBinsEndDebug, which is legal in C++ since it doesn't extend
-            // beyond 1 item past the end of the array
-            pAuxiliaryBin = IndexBin(pAuxiliaryBin, iAuxiliaryByte);
-
-#ifndef NDEBUG
-            if(&fastTotalState[cRealDimensions] == pFastTotalStateInitialize + 1) {
-               // this is the last iteration, so pAuxiliaryBin should normally point to the memory address one byte past
-               // the legal buffer (normally pBinsEndDebug), BUT in rare cases we allocate more memory for the
-               // BinAuxiliaryBuildZone than we use in this function, so the only thing that we can guarantee is that
-               // we're equal or less than pBinsEndDebug
-               EBM_ASSERT(pAuxiliaryBin <= pBinsEndDebug);
-            } else {
-               // if this isn't the last iteration, then we'll actually be using this memory, so the entire bin had
-               // better be useable
-               EBM_ASSERT(IndexBin(pAuxiliaryBin, cBytesPerBin) <= pBinsEndDebug);
+            acBytesStride[iDimension] = cBytesStride;
+            // we've allocated this memory, so it should be reachable, so these numbers should multiply
+            EBM_ASSERT(!IsMultiplyError(cBytesStride, cBins));
+            cBytesStride *= cBins;
+            if(cBytesStride <= k_cBytesTotalsBlockMax) {
+               cDimensionsBlock = iDimension + 1;
             }
-            for(auto* pDimensionalCur = pFastTotalStateInitialize->m_pDimensionalCur; pAuxiliaryBin != pDimensionalCur;
-                  pDimensionalCur = IndexBin(pDimensionalCur, cBytesPerBin)) {
-               pDimensionalCur->AssertZero(cScores);
-            }
-#endif // NDEBUG
-
-            // TODO : we don't need either the first or the wrap values since they are the next ones in the list.. we
-            // may need to populate one item past the end and make the list one larger
-            pFastTotalStateInitialize->m_pDimensionalWrap = pAuxiliaryBin;
+            ++iDimension;
+         } while(cRealDimensions != iDimension);
+         acBytesStride[cRealDimensions] = cBytesStride;
+      }
 
-            iAuxiliaryByte *= cBins;
-            ++pFastTotalStateInitialize;
-            ++pcBins;
-         } while(LIKELY(pcBinsEnd != pcBins));
+      unsigned char* const pTensor = reinterpret_cast<unsigned char*>(aBins);
+      const unsigned char* const pTensorEnd = pTensor + acBytesStride[cRealDimensions];
+      ASSERT_BIN_OK(cBytesPerBin, aBins, pBinsEndDebug);
+      EBM_ASSERT(reinterpret_cast<const BinBase*>(pTensorEnd) <= pBinsEndDebug);
+
+      // The sums are taken from the highest dimension down to the lowest, which adds the values in the same order
+      // as accumulating the whole tensor in a single pass. The sums along the low dimensions never cross a block,
+      // so each block is finished while it is still in the cache instead of sweeping the whole tensor again.
+      size_t iDimension = cRealDimensions;
+      while(cDimensionsBlock != iDimension) {
+         --iDimension;
+         SumDimension(cScores, pTensor, pTensorEnd, acBytesStride[iDimension], acBytesStride[iDimension + 1]);
+      }
+      if(0 != cDimensionsBlock) {
+         const size_t cBytesBlock = acBytesStride[cDimensionsBlock];
+         unsigned char* pBlock = pTensor;
+         do {
+            unsigned char* const pBlockEnd = pBlock + cBytesBlock;
+            iDimension = cDimensionsBlock;
+            do {
+               --iDimension;
+               SumDimension(cScores, pBlock, pBlockEnd, acBytesStride[iDimension], acBytesStride[iDimension + 1]);
+            } while(0 != iDimension);
+            pBlock = pBlockEnd;
+         } while(pTensorEnd != pBlock);
       }
-      EBM_ASSERT(pFastTotalStateInitialize == &fastTotalState[cRealDimensions]);
 
 #ifndef NDEBUG
       UNUSED(aDebugCopyBinsBase);
 #ifdef CHECK_TENSORS
-
       auto* const pDebugBin =
             static_cast<Bin<FloatMain, UIntMain, true, true, bHessian, cArrayScores>*>(malloc(cBytesPerBin));
-
       auto* aDebugCopyBins = aDebugCopyBinsBase->Specialize<FloatMain, UIntMain, true, true, bHessian, cArrayScores>();
-
-#endif // CHECK_TENSORS
-#endif // NDEBUG
-
-      auto* pBin = aBins;
-
-      while(true) {
-         ASSERT_BIN_OK(cBytesPerBin, pBin, pBinsEndDebug);
-
-         // TODO: on the 0th dimension, we could preserve the prev bin sum and avoid at least one read by
-         //       eliminating one dimension loop iteration.  This would allow us to keep the
-         //       cSamples, weight, gradient and hessian in CPU regsiters. Keep the loop as a do loop however and
-         //       require that 2 <= cDimensions
-
-         // TODO: if we have 3 dimensions (as an example), we don't have to keep storing the results of the Add
-         //       function back into memory.  We can first load the original Bin into CPU registers and then
-         //       add all the other dimensions, and at the end write it back to memory
-
-         auto* pAddPrev = pBin;
-         size_t iDimension = cRealDimensions;
-         do {
-            // TODO: Is there any benefit in making a pair/tripple specific version of this function
-            //       This loop might be optimizable away (although the loop inside Add might prevent this
-            //       loop from disapparing).  Even so, we could probably eliminate the auxillary memory
-            //       for pairs and keep both the left bin and the left up bin on the stack and only read
-            //       the up bin since that one will move.  The up left bin can be preserved in registers when reading
-            //       the up bin. Perhaps we could optimize all dimensions to preserve these things though.
-
-            --iDimension;
-            auto* pAddTo = fastTotalState[iDimension].m_pDimensionalCur;
-            pAddTo->Add(cScores, *pAddPrev);
-            pAddPrev = pAddTo;
-            pAddTo = IndexBin(pAddTo, cBytesPerBin);
-            if(pAddTo == fastTotalState[iDimension].m_pDimensionalWrap) {
-               pAddTo = fastTotalState[iDimension].m_pDimensionalFirst;
-            }
-            fastTotalState[iDimension].m_pDimensionalCur = pAddTo;
-         } while(0 != iDimension);
-         memcpy(pBin, pAddPrev, cBytesPerBin);
-
-#ifndef NDEBUG
-#ifdef CHECK_TENSORS
-         if(nullptr != aDebugCopyBins && nullptr != pDebugBin) {
-            size_t aiStart[k_cDimensionsMax];
-            size_t aiLast[k_cDimensionsMax];
-            for(size_t iDebugDimension = 0; iDebugDimension < cRealDimensions; ++iDebugDimension) {
-               aiStart[iDebugDimension] = 0;
-               aiLast[iDebugDimension] = fastTotalState[iDebugDimension].m_iCur;
-            }
+      if(nullptr != aDebugCopyBins && nullptr != pDebugBin) {
+         size_t aiStart[k_cDimensionsMax];
+         size_t aiLast[k_cDimensionsMax];
+         for(size_t iDebugDimension = 0; iDebugDimension < cRealDimensions; ++iDebugDimension) {
+            aiStart[iDebugDimension] = 0;
+            aiLast[iDebugDimension] = 0;
+         }
+         const auto* pBin = aBins;
+         while(true) {
             TensorTotalsSumDebugSlow<bHessian>(cScores,
                   cRealDimensions,
                   aiStart,
@@ -368,43 +352,28 @@ template<bool bHessian, size_t cCompilerScores, size_t cCompilerDimensions> clas
                   aDebugCopyBins->Downgrade(),
                   *pDebugBin->Downgrade());
             EBM_ASSERT(pDebugBin->GetCountSamples() == pBin->GetCountSamples());
-         }
-#endif // CHECK_TENSORS
-#endif // NDEBUG
-
-         // we're walking through all bins, so just move to the next one in the flat array,
-         // with the knowledge that we'll figure out it's multi-dimenional index below
-         pBin = IndexBin(pBin, cBytesPerBin);
-
-         FastTotalState* pFastTotalState = &fastTotalState[0];
-         while(true) {
-            ++pFastTotalState->m_iCur;
-            if(LIKELY(pFastTotalState->m_cBins != pFastTotalState->m_iCur)) {
-               break;
+            pBin = IndexBin(pBin, cBytesPerBin);
+
+            size_t iDebugDimension = 0;
+            while(true) {
+               ++aiLast[iDebugDimension];
+               if(acBins[iDebugDimension] != aiLast[iDebugDimension]) {
+                  break;
+               }
+               aiLast[iDebugDimension] = 0;
+               ++iDebugDimension;
+               if(cRealDimensions == iDebugDimension) {
+                  goto done_check;
+               }
             }
-            pFastTotalState->m_iCur = 0;
-
-            EBM_ASSERT(pFastTotalState->m_pDimensionalFirst == pFastTotalState->m_pDimensionalCur);
-
-            auto* const pDimensionalFirst = pFastTotalState->m_pDimensionalFirst;
-            const auto* const pDimensionalWrap = pFastTotalState->m_pDimensionalWrap;
-            EBM_ASSERT(pDimensionalFirst != pDimensionalWrap);
-            const size_t cBytesToZero = CountBytes(pDimensionalWrap, pDimensionalFirst);
-            pDimensionalFirst->ZeroMem(cBytesToZero);
-            ++pFastTotalState;
-
-            if(UNLIKELY(pFastTotalStateInitialize == pFastTotalState)) {
-#ifndef NDEBUG
-#ifdef CHECK_TENSORS
-               free(pDebugBin);
+         }
+      done_check:;
+      }
+      free(pDebugBin);
 #endif // CHECK_TENSORS
 #endif // NDEBUG
 
-               LOG_0(Trace_Verbose, "Exited BuildFastTotals");
-               return;
-            }
-         }
-      }
+      LOG_0(Trace_Verbose, "Exited BuildFastTotals");
    }
 };
 
@@ -18,6 +18,9 @@ namespace DEFINED_ZONE_NAME {
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
+// TensorTotalsSumMulti precomputes the corner offsets when at most this many dimensions need a low corner
+static constexpr int k_cCornerTableDimensionsMax = 8;
+
 struct TensorSumDimension {
    size_t m_iLow;
    size_t m_iHigh;
@@ -219,38 +222,84 @@ INLINE_ALWAYS static void TensorTotalsSumMulti(const size_t cRuntimeScores,
 
    binOut.Zero(cScores, aGradientPairsOut);
 
-   // for every dimension that we're processing, set the dimension bit flag to 1 to start
-   ptrdiff_t dimensionFlags = static_cast<ptrdiff_t>(MakeLowMask<size_t>(cProcessingDimensions));
-   do {
-      const unsigned char* pRawBin = pStartingBin;
-      size_t evenOdd = 0;
-      size_t dimensionFlagsDestroy = static_cast<size_t>(dimensionFlags);
-      const TotalsDimension* pTotalsDimensionLoop = totalsDimension;
-      do {
-         evenOdd ^= dimensionFlagsDestroy; // flip least significant bit if the dimension bit is set
-         // TODO: check if it's faster to load both m_cLast and m_cIncrement instead of selecting the right
-         // address and loading it.  Loading both would be more prefetch predictable for the CPU
-         pRawBin += *(UNPREDICTABLE(0 == (1 & dimensionFlagsDestroy)) ? &pTotalsDimensionLoop->m_cLast :
-                                                                        &pTotalsDimensionLoop->m_cIncrement);
-         dimensionFlagsDestroy >>= 1;
-         ++pTotalsDimensionLoop;
-      } while(LIKELY(pTotalsDimensionEnd != pTotalsDimensionLoop));
+   if(cProcessingDimensions <= k_cCornerTableDimensionsMax) {
+      // Build the byte offsets of all 2^N corners up front. Bit i of a corner's index selects the low side of
+      // the i-th processing dimension, and corners with an odd number of low sides are subtracted. Doubling the
+      // table once per dimension takes one addition per corner instead of N selects per corner.
+      size_t aCornerBytes[size_t{1} << k_cCornerTableDimensionsMax];
+      bool aCornerSubtract[size_t{1} << k_cCornerTableDimensionsMax];
 
-      const auto* const pBin =
-            reinterpret_cast<const Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>*>(
-                  pRawBin);
-
-      // TODO: for pairs and tripples and anything else that we want to make special case code for we can
-      // avoid this unpredictable branch, which would be very helpful
-      if(UNPREDICTABLE(0 != (1 & evenOdd))) {
-         ASSERT_BIN_OK(cBytesPerBin, pBin, pBinsEndDebug);
-         binOut.Subtract(cScores, *pBin, pBin->GetGradientPairs(), aGradientPairsOut);
-      } else {
+      size_t cBytesAllHigh = 0;
+      const TotalsDimension* pTotalsDimension = totalsDimension;
+      do {
+         cBytesAllHigh += pTotalsDimension->m_cLast;
+         ++pTotalsDimension;
+      } while(LIKELY(pTotalsDimensionEnd != pTotalsDimension));
+      aCornerBytes[0] = cBytesAllHigh;
+      aCornerSubtract[0] = false;
+
+      size_t cCorners = 1;
+      pTotalsDimension = totalsDimension;
+      do {
+         EBM_ASSERT(pTotalsDimension->m_cIncrement < pTotalsDimension->m_cLast);
+         const size_t cBytesLowerBy = pTotalsDimension->m_cLast - pTotalsDimension->m_cIncrement;
+         size_t iCorner = 0;
+         do {
+            aCornerBytes[cCorners + iCorner] = aCornerBytes[iCorner] - cBytesLowerBy;
+            aCornerSubtract[cCorners + iCorner] = !aCornerSubtract[iCorner];
+            ++iCorner;
+         } while(cCorners != iCorner);
+         cCorners <<= 1;
+         ++pTotalsDimension;
+      } while(LIKELY(pTotalsDimensionEnd != pTotalsDimension));
+
+      // visit the corners in the same order as the general loop below so that the sums are identical
+      do {
+         --cCorners;
+         const auto* const pBin =
+               reinterpret_cast<const Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>*>(
+                     pStartingBin + aCornerBytes[cCorners]);
          ASSERT_BIN_OK(cBytesPerBin, pBin, pBinsEndDebug);
-         binOut.Add(cScores, *pBin, pBin->GetGradientPairs(), aGradientPairsOut);
-      }
-      --dimensionFlags;
-   } while(LIKELY(0 <= dimensionFlags));
+         if(UNPREDICTABLE(aCornerSubtract[cCorners])) {
+            binOut.Subtract(cScores, *pBin, pBin->GetGradientPairs(), aGradientPairsOut);
+         } else {
+            binOut.Add(cScores, *pBin, pBin->GetGradientPairs(), aGradientPairsOut);
+         }
+      } while(LIKELY(0 != cCorners));
+   } else {
+      // for every dimension that we're processing, set the dimension bit flag to 1 to start
+      ptrdiff_t dimensionFlags = static_cast<ptrdiff_t>(MakeLowMask<size_t>(cProcessingDimensions));
+      do {
+         const unsigned char* pRawBin = pStartingBin;
+         size_t evenOdd = 0;
+         size_t dimensionFlagsDestroy = static_cast<size_t>(dimensionFlags);
+         const TotalsDimension* pTotalsDimensionLoop = totalsDimension;
+         do {
+            evenOdd ^= dimensionFlagsDestroy; // flip least significant bit if the dimension bit is set
+            // TODO: check if it's faster to load both m_cLast and m_cIncrement instead of selecting the right
+            // address and loading it.  Loading both would be more prefetch predictable for the CPU
+            pRawBin += *(UNPREDICTABLE(0 == (1 & dimensionFlagsDestroy)) ? &pTotalsDimensionLoop->m_cLast :
+                                                                           &pTotalsDimensionLoop->m_cIncrement);
+            dimensionFlagsDestroy >>= 1;
+            ++pTotalsDimensionLoop;
+         } while(LIKELY(pTotalsDimensionEnd != pTotalsDimensionLoop));
+
+         const auto* const pBin =
+               reinterpret_cast<const Bin<FloatMain, UIntMain, true, true, bHessian, GetArrayScores(cCompilerScores)>*>(
+                     pRawBin);
+
+         // TODO: for pairs and tripples and anything else that we want to make special case code for we can
+         // avoid this unpredictable branch, which would be very helpful
+         if(UNPREDICTABLE(0 != (1 & evenOdd))) {
+            ASSERT_BIN_OK(cBytesPerBin, pBin, pBinsEndDebug);
+            binOut.Subtract(cScores, *pBin, pBin->GetGradientPairs(), aGradientPairsOut);
+         } else {
+            ASSERT_BIN_OK(cBytesPerBin, pBin, pBinsEndDebug);
+            binOut.Add(cScores, *pBin, pBin->GetGradientPairs(), aGradientPairsOut);
+         }
+         --dimensionFlags;
+      } while(LIKELY(0 <= dimensionFlags));
+   }
 
 #ifndef NDEBUG
    UNUSED(aDebugCopyBins);
@@ -34,6 +34,14 @@ struct TermInnerBag final {
          const size_t cInnerBags);
    static void FreeTermInnerBags(const size_t cTerms, TermInnerBag** const aaTermInnerBags, const size_t cInnerBags);
 
+   // the bytes that InitTermInnerBags allocates for one term, which the caller has checked cannot overflow
+   static inline size_t CountBytesTermInnerBags(const size_t cTensorBins, const size_t cInnerBags) {
+      const size_t cInnerBagsAfterZero = size_t{0} == cInnerBags ? size_t{1} : cInnerBags;
+      const size_t cBytesBins =
+            size_t{1} == cTensorBins ? size_t{0} : (sizeof(UIntMain) + sizeof(FloatPrecomp)) * cTensorBins;
+      return (sizeof(TermInnerBag) + cBytesBins) * cInnerBagsAfterZero;
+   }
+
    static inline const UIntMain* GetCounts(const bool bCollapsed,
          const size_t iTerm,
          const size_t iBag,
@@ -0,0 +1,467 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <new> // placement new
+
+#ifndef _WIN32
+#include <unistd.h> // getpid
+#include <pthread.h> // pthread_atfork
+#endif // _WIN32
+
+#ifdef __linux__
+#include <stdio.h> // fopen, fscanf, snprintf
+#include <pthread.h> // pthread_setaffinity_np
+#include <sched.h> // cpu_set_t, sched_getaffinity
+#endif // __linux__
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsMultiplyError, IsConvertError, EbmMax, EbmMin
+#include "ThreadPool.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+size_t ThreadPool::GetCountHardwareThreads() noexcept {
+   // hardware_concurrency is allowed to return 0 if the value is not computable
+   const unsigned int cHardwareThreads = std::thread::hardware_concurrency();
+   return 0u == cHardwareThreads ? size_t{1} : static_cast<size_t>(cHardwareThreads);
+}
+
+// zero means that we use all the hardware threads
+static std::atomic_size_t s_cThreadsMax{0};
+static std::atomic_bool s_bAffinity{true};
+
+size_t ThreadPool::GetCountThreadsMax() noexcept {
+   const size_t cThreadsMax = s_cThreadsMax.load(std::memory_order_relaxed);
+   return size_t{0} == cThreadsMax ? GetCountHardwareThreads() : cThreadsMax;
+}
+
+void ThreadPool::SetCountThreadsMax(const size_t cThreadsMax) noexcept {
+   // the shared pool checks this the next time it is borrowed. Pools that already exist keep their threads
+   s_cThreadsMax.store(cThreadsMax, std::memory_order_relaxed);
+}
+
+void ThreadPool::SetAffinity(const bool bAffinity) noexcept { s_bAffinity.store(bAffinity, std::memory_order_relaxed); }
+
+#ifdef __linux__
+static constexpr size_t k_cNumaNodesMax = 64;
+
+struct NumaNodes final {
+   size_t m_cNodes;
+   cpu_set_t m_aCpus[k_cNumaNodesMax];
+};
+
+// sysfs cpulist files hold comma separated ranges like "0-15,32-47"
+static bool ReadCpuList(const char* const sPath, cpu_set_t* const pCpus) {
+   FILE* const pFile = fopen(sPath, "r");
+   if(nullptr == pFile) {
+      return false;
+   }
+   CPU_ZERO(pCpus);
+   unsigned long iFirst;
+   while(1 == fscanf(pFile, "%lu", &iFirst)) {
+      unsigned long iLast = iFirst;
+      int ch = fgetc(pFile);
+      if('-' == ch) {
+         if(1 != fscanf(pFile, "%lu", &iLast)) {
+            break;
+         }
+         ch = fgetc(pFile);
+      }
+      for(unsigned long iCpu = iFirst; iCpu <= iLast && iCpu < static_cast<unsigned long>(CPU_SETSIZE); ++iCpu) {
+         CPU_SET(static_cast<int>(iCpu), pCpus);
+      }
+      if(',' != ch) {
+         break;
+      }
+   }
+   fclose(pFile);
+   return 0 != CPU_COUNT(pCpus);
+}
+
+static NumaNodes DetectNumaNodes() noexcept {
+   NumaNodes nodes;
+   nodes.m_cNodes = 0;
+   cpu_set_t allowed;
+   if(0 != sched_getaffinity(0, sizeof(allowed), &allowed)) {
+      return nodes;
+   }
+   for(size_t iNode = 0; iNode < k_cNumaNodesMax; ++iNode) {
+      char sPath[64];
+      snprintf(sPath, sizeof(sPath), "/sys/devices/system/node/node%zu/cpulist", iNode);
+      cpu_set_t cpus;
+      // node numbers can have gaps, and nodes with only memory have an empty cpulist
+      if(ReadCpuList(sPath, &cpus)) {
+         // if we were started with taskset or numactl then only use the nodes and cpus that we were given
+         CPU_AND(&cpus, &cpus, &allowed);
+         if(0 != CPU_COUNT(&cpus)) {
+            nodes.m_aCpus[nodes.m_cNodes] = cpus;
+            ++nodes.m_cNodes;
+         }
+      }
+   }
+   return nodes;
+}
+
+static const NumaNodes* GetNumaNodes() noexcept {
+   static const NumaNodes s_nodes = DetectNumaNodes();
+   return &s_nodes;
+}
+#endif // __linux__
+
+size_t ThreadPool::GetCountNumaNodes() noexcept {
+#ifdef __linux__
+   return EbmMax(size_t{1}, GetNumaNodes()->m_cNodes);
+#else // __linux__
+   return size_t{1};
+#endif // __linux__
+}
+
+ThreadPool::~ThreadPool() { StopWorkers(m_cThreads - 1); }
+
+bool ThreadPool::IsForked() const noexcept {
+#ifdef _WIN32
+   return false;
+#else // _WIN32
+   return getpid() != m_pid;
+#endif // _WIN32
+}
+
+void ThreadPool::StopWorkers(const size_t cWorkers) {
+   if(nullptr != m_aWorkers) {
+      if(IsForked()) {
+         // the workers belong to our parent process. There is nothing to join, and destroying a std::thread that
+         // is still joinable would terminate us, so we leak the handles
+         m_aWorkers = nullptr;
+         return;
+      }
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_bStop = true;
+      }
+      m_conditionWork.notify_all();
+      for(size_t iWorker = 0; iWorker < cWorkers; ++iWorker) {
+         m_aWorkers[iWorker].join();
+      }
+      for(size_t iWorker = 0; iWorker < m_cThreads - 1; ++iWorker) {
+         m_aWorkers[iWorker].~thread();
+      }
+      free(m_aWorkers);
+      m_aWorkers = nullptr;
+   }
+}
+
+void ThreadPool::Free(ThreadPool* const pThreadPool) {
+   LOG_0(Trace_Info, "Entered ThreadPool::Free");
+   delete pThreadPool;
+   LOG_0(Trace_Info, "Exited ThreadPool::Free");
+}
+
+ErrorEbm ThreadPool::Create(const size_t cThreads, ThreadPool** const ppThreadPoolOut) {
+   LOG_N(Trace_Info, "Entered ThreadPool::Create: cThreads=%zu", cThreads);
+
+   EBM_ASSERT(1 <= cThreads);
+   EBM_ASSERT(nullptr != ppThreadPoolOut);
+   EBM_ASSERT(nullptr == *ppThreadPoolOut);
+
+   ThreadPool* pThreadPool;
+   try {
+      pThreadPool = new ThreadPool();
+   } catch(const std::bad_alloc&) {
+      LOG_0(Trace_Warning, "WARNING ThreadPool::Create Out of memory allocating ThreadPool");
+      return Error_OutOfMemory;
+   } catch(...) {
+      LOG_0(Trace_Warning, "WARNING ThreadPool::Create Unknown error");
+      return Error_UnexpectedInternal;
+   }
+   if(nullptr == pThreadPool) {
+      // this should be impossible since bad_alloc should have been thrown, but let's be untrusting
+      LOG_0(Trace_Warning, "WARNING ThreadPool::Create nullptr == pThreadPool");
+      return Error_OutOfMemory;
+   }
+
+   pThreadPool->m_bAffinity = s_bAffinity.load(std::memory_order_relaxed);
+#ifndef _WIN32
+   pThreadPool->m_pid = getpid();
+#endif // _WIN32
+
+   const size_t cWorkers = cThreads - 1;
+   if(size_t{0} != cWorkers) {
+      if(IsMultiplyError(sizeof(std::thread), cWorkers)) {
+         LOG_0(Trace_Warning, "WARNING ThreadPool::Create IsMultiplyError(sizeof(std::thread), cWorkers)");
+         delete pThreadPool;
+         return Error_OutOfMemory;
+      }
+      std::thread* const aWorkers = static_cast<std::thread*>(malloc(sizeof(std::thread) * cWorkers));
+      if(nullptr == aWorkers) {
+         LOG_0(Trace_Warning, "WARNING ThreadPool::Create nullptr == aWorkers");
+         delete pThreadPool;
+         return Error_OutOfMemory;
+      }
+      for(size_t iWorker = 0; iWorker < cWorkers; ++iWorker) {
+         // default constructed threads are not joinable and do not own any OS resources
+         new(&aWorkers[iWorker]) std::thread();
+      }
+      pThreadPool->m_aWorkers = aWorkers;
+      pThreadPool->m_cThreads = cThreads;
+      pThreadPool->m_cThreadsActive = cThreads;
+
+      size_t cStarted = 0;
+      try {
+         while(cStarted < cWorkers) {
+            aWorkers[cStarted] = std::thread(&ThreadPool::WorkerLoop, pThreadPool, cStarted + 1);
+            ++cStarted;
+         }
+      } catch(...) {
+         // the C++ standard doesn't really seem to say what kind of exceptions we'd get for various errors, so
+         // about the best we can do is catch(...) since the exact exceptions seem to be implementation specific
+         LOG_0(Trace_Warning, "WARNING ThreadPool::Create thread start failed");
+         pThreadPool->StopWorkers(cStarted);
+         pThreadPool->m_cThreads = 1;
+         pThreadPool->m_cThreadsActive = 1;
+         delete pThreadPool;
+         return Error_ThreadStartFailed;
+      }
+   }
+
+   *ppThreadPoolOut = pThreadPool;
+
+   LOG_0(Trace_Info, "Exited ThreadPool::Create");
+   return Error_None;
+}
+
+static std::mutex s_mutexShared;
+static ThreadPool* s_pThreadPoolShared = nullptr;
+
+// set on the thread that has borrowed the shared pool. A call nested inside one of its tasks on that thread cannot
+// try_lock the m_mutexRun that the thread already holds, so it goes straight to the single threaded pool
+static thread_local bool t_bBorrowedShared = false;
+
+#ifndef _WIN32
+static void LockShared() { s_mutexShared.lock(); }
+static void UnlockShared() { s_mutexShared.unlock(); }
+static void UnlockSharedChild() {
+   // R's parallel and future packages fork the process, and only the thread that called fork lives on in the child.
+   // The shared pool's workers are gone, so the child leaks the parent's pool and makes its own when it needs one
+   s_pThreadPoolShared = nullptr;
+   s_mutexShared.unlock();
+}
+#endif // _WIN32
+
+ErrorEbm ThreadPool::Borrow(const size_t cThreadsMax, ThreadPool** const ppThreadPoolOut) {
+   EBM_ASSERT(nullptr != ppThreadPoolOut);
+   EBM_ASSERT(nullptr == *ppThreadPoolOut);
+
+   // a single threaded pool runs everything on the caller's thread without touching any of its members, so every
+   // caller that cannot have the shared pool can use this one at the same time
+   static ThreadPool s_threadPoolSerial;
+
+   const size_t cThreads = GetCountThreadsMax();
+   if(cThreads <= size_t{1} || cThreadsMax <= size_t{1} || t_bBorrowedShared) {
+      *ppThreadPoolOut = &s_threadPoolSerial;
+      return Error_None;
+   }
+
+#ifndef _WIN32
+   // the handlers keep another thread from holding s_mutexShared while we fork, which would leave it locked forever
+   // in the child
+   static const int s_errorAtfork = pthread_atfork(&LockShared, &UnlockShared, &UnlockSharedChild);
+   UNUSED(s_errorAtfork);
+#endif // _WIN32
+
+   std::lock_guard<std::mutex> lock(s_mutexShared);
+
+   ThreadPool* pThreadPool = s_pThreadPoolShared;
+   if(nullptr != pThreadPool) {
+      if(!pThreadPool->m_mutexRun.try_lock()) {
+         LOG_0(Trace_Info, "ThreadPool::Borrow the shared pool is in use, so running on the calling thread");
+         *ppThreadPoolOut = &s_threadPoolSerial;
+         return Error_None;
+      }
+      if(cThreads != pThreadPool->m_cThreads ||
+            s_bAffinity.load(std::memory_order_relaxed) != pThreadPool->m_bAffinity) {
+         // SetThreadCount or SetThreadAffinity was called since we made the pool
+         pThreadPool->m_mutexRun.unlock();
+         Free(pThreadPool);
+         s_pThreadPoolShared = nullptr;
+         pThreadPool = nullptr;
+      }
+   }
+   if(nullptr == pThreadPool) {
+      const ErrorEbm error = Create(cThreads, &pThreadPool);
+      if(Error_None != error) {
+         // already logged
+         return error;
+      }
+      s_pThreadPoolShared = pThreadPool;
+      pThreadPool->m_mutexRun.lock();
+   }
+
+   pThreadPool->m_bBorrowed = true;
+   pThreadPool->m_cThreadsActive = EbmMin(cThreadsMax, pThreadPool->m_cThreads);
+   t_bBorrowedShared = true;
+
+   *ppThreadPoolOut = pThreadPool;
+   return Error_None;
+}
+
+void ThreadPool::Return(ThreadPool* const pThreadPool) {
+   EBM_ASSERT(nullptr != pThreadPool);
+   if(pThreadPool->m_bBorrowed) {
+      pThreadPool->m_cThreadsActive = pThreadPool->m_cThreads;
+      pThreadPool->m_bBorrowed = false;
+      t_bBorrowedShared = false;
+      pThreadPool->m_mutexRun.unlock();
+   }
+}
+
+void ThreadPool::WorkerLoop(const size_t iThread) {
+#ifdef __linux__
+   const NumaNodes* const pNodes = GetNumaNodes();
+   if(m_bAffinity && size_t{2} <= pNodes->m_cNodes) {
+      // thread 0 is our caller's thread, which we leave alone. If pinning fails the OS places the worker as usual.
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &pNodes->m_aCpus[iThread % pNodes->m_cNodes]);
+   }
+#endif // __linux__
+
+   size_t iGenerationSeen = 0;
+   while(true) {
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_conditionWork.wait(lock, [&] { return m_bStop || iGenerationSeen != m_iGeneration; });
+         if(m_bStop) {
+            return;
+         }
+         iGenerationSeen = m_iGeneration;
+         if(m_cThreadsRun <= iThread) {
+            // the borrower capped the threads below us, so we are not counted in m_cWorkersBusy
+            continue;
+         }
+      }
+
+      ExecuteTasks(iThread);
+
+      bool bLast;
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         EBM_ASSERT(1 <= m_cWorkersBusy);
+         --m_cWorkersBusy;
+         bLast = size_t{0} == m_cWorkersBusy;
+      }
+      if(bLast) {
+         m_conditionDone.notify_one();
+      }
+   }
+}
+
+void ThreadPool::ExecuteTasks(const size_t iThread) {
+   const THREAD_TASK pTask = m_pTask;
+   void* const pContext = m_pContext;
+   const size_t cTasks = m_cTasks;
+   const size_t cThreads = m_cThreadsRun;
+   const bool bAffine = m_bAffine;
+   size_t iTaskAffine = iThread;
+   while(true) {
+      size_t iTask;
+      if(bAffine) {
+         iTask = iTaskAffine;
+         iTaskAffine += cThreads;
+      } else {
+         iTask = m_iTaskNext.fetch_add(1, std::memory_order_relaxed);
+      }
+      if(cTasks <= iTask) {
+         return;
+      }
+      const ErrorEbm error = (*pTask)(pContext, iTask, iThread);
+      if(Error_None != error) {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         if(Error_None == m_error || iTask < m_iTaskError) {
+            m_error = error;
+            m_iTaskError = iTask;
+         }
+      }
+   }
+}
+
+ErrorEbm ThreadPool::RunTasks(
+      const size_t cTasks, const THREAD_TASK pTask, void* const pContext, const bool bAffine) {
+   EBM_ASSERT(nullptr != pTask);
+
+   if(size_t{1} == m_cThreadsActive || cTasks <= size_t{1} || IsForked()) {
+      // no need to involve the workers, and executing in order lets us exit early on the first error
+      for(size_t iTask = 0; iTask < cTasks; ++iTask) {
+         const ErrorEbm error = (*pTask)(pContext, iTask, 0);
+         if(Error_None != error) {
+            return error;
+         }
+      }
+      return Error_None;
+   }
+
+   // a borrower already holds m_mutexRun from Borrow until Return
+   std::unique_lock<std::mutex> lockRun(m_mutexRun, std::defer_lock);
+   if(!m_bBorrowed) {
+      lockRun.lock();
+   }
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_pTask = pTask;
+      m_pContext = pContext;
+      m_cTasks = cTasks;
+      m_bAffine = bAffine;
+      m_iTaskNext.store(0, std::memory_order_relaxed);
+      m_iTaskError = 0;
+      m_error = Error_None;
+      m_cThreadsRun = m_cThreadsActive;
+      m_cWorkersBusy = m_cThreadsActive - 1;
+      ++m_iGeneration;
+   }
+   m_conditionWork.notify_all();
+
+   ExecuteTasks(0);
+
+   std::unique_lock<std::mutex> lock(m_mutex);
+   m_conditionDone.wait(lock, [&] { return size_t{0} == m_cWorkersBusy; });
+   return m_error;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SetThreadCount(IntEbm countThreads) {
+   LOG_N(Trace_Info, "Entered SetThreadCount: countThreads=%" IntEbmPrintf, countThreads);
+
+   if(countThreads < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR SetThreadCount countThreads < IntEbm { 0 }");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countThreads)) {
+      LOG_0(Trace_Error, "ERROR SetThreadCount IsConvertError<size_t>(countThreads)");
+      return Error_IllegalParamVal;
+   }
+   ThreadPool::SetCountThreadsMax(static_cast<size_t>(countThreads));
+
+   LOG_0(Trace_Info, "Exited SetThreadCount");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SetThreadAffinity(BoolEbm isAffinity) {
+   LOG_N(Trace_Info, "Entered SetThreadAffinity: isAffinity=%" BoolEbmPrintf, isAffinity);
+
+   if(EBM_FALSE != isAffinity && EBM_TRUE != isAffinity) {
+      LOG_0(Trace_Error, "ERROR SetThreadAffinity isAffinity is not EBM_FALSE or EBM_TRUE");
+      return Error_IllegalParamVal;
+   }
+   ThreadPool::SetAffinity(EBM_FALSE != isAffinity);
+
+   LOG_0(Trace_Info, "Exited SetThreadAffinity");
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
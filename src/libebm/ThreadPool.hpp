@@ -0,0 +1,155 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/types.h> // pid_t
+#endif // _WIN32
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// iThread is in the range [0, GetCountThreads()) and can be used to index into per-thread scratch memory.
+// iThread 0 is always the thread that called Run.
+typedef ErrorEbm (*THREAD_TASK)(void* const pContext, const size_t iTask, const size_t iThread);
+
+class ThreadPool final {
+   // the calling thread participates in the work, so we hold one less worker than m_cThreads
+   size_t m_cThreads;
+   std::thread* m_aWorkers;
+
+   // the shared pool is borrowed with a cap on the number of threads, and the workers at or above the cap sit out the
+   // runs of that borrower
+   size_t m_cThreadsActive;
+   bool m_bBorrowed;
+   bool m_bAffinity;
+
+#ifndef _WIN32
+   // the workers do not survive a fork, so a child process that inherits a pool runs its tasks on the calling thread
+   pid_t m_pid;
+#endif // _WIN32
+
+   // only one caller at a time can own the workers. BoosterCore objects can be shared between views that
+   // might be used on different threads, so serialize them here rather than requiring it of our callers
+   std::mutex m_mutexRun;
+
+   std::mutex m_mutex;
+   std::condition_variable m_conditionWork;
+   std::condition_variable m_conditionDone;
+   size_t m_iGeneration;
+   size_t m_cWorkersBusy;
+   bool m_bStop;
+
+   THREAD_TASK m_pTask;
+   void* m_pContext;
+   size_t m_cTasks;
+   size_t m_cThreadsRun;
+   bool m_bAffine;
+   std::atomic_size_t m_iTaskNext;
+
+   // if several tasks fail we report the error from the lowest task index so that the result does not depend
+   // on how the tasks were scheduled
+   size_t m_iTaskError;
+   ErrorEbm m_error;
+
+   inline ThreadPool() noexcept :
+         m_cThreads(1),
+         m_aWorkers(nullptr),
+         m_cThreadsActive(1),
+         m_bBorrowed(false),
+         m_bAffinity(false),
+#ifndef _WIN32
+         m_pid(0),
+#endif // _WIN32
+         m_iGeneration(0),
+         m_cWorkersBusy(0),
+         m_bStop(false),
+         m_pTask(nullptr),
+         m_pContext(nullptr),
+         m_cTasks(0),
+         m_cThreadsRun(1),
+         m_bAffine(false),
+         m_iTaskNext(0),
+         m_iTaskError(0),
+         m_error(Error_None) {}
+
+   ~ThreadPool();
+
+   static void Free(ThreadPool* const pThreadPool);
+   static ErrorEbm Create(const size_t cThreads, ThreadPool** const ppThreadPoolOut);
+
+   bool IsForked() const noexcept;
+   void StopWorkers(const size_t cWorkers);
+   void WorkerLoop(const size_t iThread);
+   void ExecuteTasks(const size_t iThread);
+   ErrorEbm RunTasks(const size_t cTasks, const THREAD_TASK pTask, void* const pContext, const bool bAffine);
+
+   template<typename TFunc>
+   static ErrorEbm ExecuteFunctor(void* const pContext, const size_t iTask, const size_t iThread) {
+      return (*static_cast<TFunc*>(pContext))(iTask, iThread);
+   }
+
+ public:
+   static size_t GetCountHardwareThreads() noexcept;
+
+   // the number of threads that libebm may use at once, which is set through SetThreadCount and otherwise defaults
+   // to the number of hardware threads. Pools should be sized by this and not by GetCountHardwareThreads
+   static size_t GetCountThreadsMax() noexcept;
+   static void SetCountThreadsMax(const size_t cThreadsMax) noexcept;
+   static void SetAffinity(const bool bAffinity) noexcept;
+
+   // one call into libebm can take the process wide pool with at most cThreadsMax threads until it calls Return.
+   // Boosters and interaction detectors borrow it for each call with the thread count that they picked when they
+   // split their samples into subsets, so worker iThread of every call is the same thread. If the shared pool is
+   // already taken, which happens for concurrent calls and for calls nested inside the tasks of another pool, the
+   // caller gets a pool with a single thread instead of adding more threads to the machine
+   static ErrorEbm Borrow(const size_t cThreadsMax, ThreadPool** const ppThreadPoolOut);
+   static void Return(ThreadPool* const pThreadPool);
+
+   inline size_t GetCountThreads() const noexcept { return m_cThreadsActive; }
+
+   // runs pTask for every iTask in [0, cTasks) and returns once all tasks have completed. Tasks can run in any order.
+   // Each thread claims the next unstarted task when it finishes its last one, so a few expensive tasks mixed in with
+   // many cheap ones do not leave the other threads idle.
+   ErrorEbm Run(const size_t cTasks, const THREAD_TASK pTask, void* const pContext) {
+      return RunTasks(cTasks, pTask, pContext, false);
+   }
+
+   // like Run, except that iTask always runs on thread iTask % GetCountThreads(). The boosting loops visit the same
+   // subsets on every call, so each subset keeps running on the worker whose NUMA node holds its memory.
+   ErrorEbm RunAffine(const size_t cTasks, const THREAD_TASK pTask, void* const pContext) {
+      return RunTasks(cTasks, pTask, pContext, true);
+   }
+
+   // convenience wrappers for lambdas and other functors with the signature: ErrorEbm (size_t iTask, size_t iThread)
+   template<typename TFunc> inline ErrorEbm Run(const size_t cTasks, TFunc& func) {
+      return Run(cTasks, &ExecuteFunctor<TFunc>, static_cast<void*>(&func));
+   }
+   template<typename TFunc> inline ErrorEbm RunAffine(const size_t cTasks, TFunc& func) {
+      return RunAffine(cTasks, &ExecuteFunctor<TFunc>, static_cast<void*>(&func));
+   }
+
+   // the number of NUMA nodes that this process can run on. When there is more than one, the workers are pinned
+   // round robin to the nodes so that memory first touched by a worker stays local to it, unless SetThreadAffinity
+   // turned the pinning off.
+   static size_t GetCountNumaNodes() noexcept;
+};
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // THREAD_POOL_HPP
@@ -9,6 +9,7 @@
 
 #include "logging.h" // EBM_ASSERT
 
+#include "common.hpp" // IndexByte, k_cCompilerOptimizedCountDimensionsMax
 #include "Feature.hpp"
 #include "Term.hpp"
 
@@ -27,26 +28,36 @@ struct TransposeDimension {
    size_t cBytesStride;
 };
 
+inline static void InitTransposeDimension(const TermFeature* const aTermFeatures,
+      const TermFeature* const pTermFeature,
+      const size_t cBytesPerCell,
+      TransposeDimension* const pDim) {
+   // we process this in the order of pIncrement. The m_iTranspose of the TermFeature indicates where
+   // we need to look to find the feature we are transposing to the location of the pIncrement dimension
+
+   const FeatureBoosting* const pFeature = aTermFeatures[pTermFeature->m_iTranspose].m_pFeature;
+   pDim->cBytesStride = aTermFeatures[pTermFeature->m_iTranspose].m_cStride * cBytesPerCell;
+
+   const size_t cBinsReduced = pFeature->GetCountBins();
+   EBM_ASSERT(1 <= cBinsReduced); // otherwise we should have exited in the caller
+   bool bMissing = pFeature->IsMissing();
+   bool bUnknown = pFeature->IsUnknown();
+   const size_t cBins = cBinsReduced + (bMissing ? size_t{0} : size_t{1}) + (bUnknown ? size_t{0} : size_t{1});
+   EBM_ASSERT(2 <= cBins); // just missing and unknown required
+
+   pDim->cBins = cBins;
+   pDim->bDropFirst = !bMissing;
+   pDim->bDropLast = !bUnknown;
+
+   pDim->cBinsReduced = cBinsReduced;
+   pDim->iBinsRemaining = cBins;
+}
+
+// handles any number of dimensions, but we only use it above k_cCompilerOptimizedCountDimensionsMax
 template<bool bCopyToIncrement, typename TIncrement, typename TStride>
-extern void Transpose(const Term* const pTerm, const size_t cScores, TIncrement* pIncrement, TStride* pStride) {
-   EBM_ASSERT(0 < cScores);
+static void TransposeDynamic(const Term* const pTerm, const size_t cScores, TIncrement* pIncrement, TStride* pStride) {
    const size_t cBytesPerCell = sizeof(*pStride) * cScores;
-
    const size_t cDimensions = pTerm->GetCountDimensions();
-   if(size_t{0} == cDimensions) {
-      TIncrement* const pIncrementEnd = pIncrement + cScores;
-      do {
-         if(bCopyToIncrement) {
-            *pIncrement = static_cast<TIncrement>(*pStride);
-         } else {
-            *pStride = static_cast<TStride>(*pIncrement);
-         }
-         ++pStride;
-         ++pIncrement;
-      } while(pIncrementEnd != pIncrement);
-
-      return;
-   }
 
    const TermFeature* const aTermFeatures = pTerm->GetTermFeatures();
    const TermFeature* pTermFeature = aTermFeatures;
@@ -63,31 +74,13 @@ extern void Transpose(const Term* const pTerm, const size_t cScores, TIncrement*
       cSkipLevelInit = 1;
    }
    do {
-      // we process this in the order of pIncrement. The m_iTranspose of the TermFeature indicates where
-      // we need to look to find the feature we are transposing to the location of the pIncrement dimension
-
-      const FeatureBoosting* const pFeature = aTermFeatures[pTermFeature->m_iTranspose].m_pFeature;
-      pDimInit->cBytesStride = aTermFeatures[pTermFeature->m_iTranspose].m_cStride * cBytesPerCell;
-
-      const size_t cBinsReduced = pFeature->GetCountBins();
-      EBM_ASSERT(1 <= cBinsReduced); // otherwise we should have exited in the caller
-      bool bMissing = pFeature->IsMissing();
-      bool bUnknown = pFeature->IsUnknown();
-      const size_t cBins = cBinsReduced + (bMissing ? size_t{0} : size_t{1}) + (bUnknown ? size_t{0} : size_t{1});
-      EBM_ASSERT(2 <= cBins); // just missing and unknown required
-
-      pDimInit->cBins = cBins;
-      pDimInit->bDropFirst = !bMissing;
-      pDimInit->bDropLast = !bUnknown;
-
-      pDimInit->cBinsReduced = cBinsReduced;
-      pDimInit->iBinsRemaining = cBins;
+      InitTransposeDimension(aTermFeatures, pTermFeature, cBytesPerCell, pDimInit);
 
       if(!bCopyToIncrement) {
-         if(!bMissing) {
+         if(pDimInit->bDropFirst) {
             cSkip += cSkipLevelInit;
          }
-         cSkipLevelInit *= cBinsReduced;
+         cSkipLevelInit *= pDimInit->cBinsReduced;
       }
 
       ++pTermFeature;
@@ -192,6 +185,161 @@ extern void Transpose(const Term* const pTerm, const size_t cScores, TIncrement*
    }
 }
 
+template<bool bCopyToIncrement, typename TIncrement, typename TStride>
+INLINE_ALWAYS static void TransposeCells(const size_t cItems, TIncrement*& pIncrement, TStride* const pStride) {
+   // kept as a simple indexed loop over contiguous memory in both tensors so that the compiler can vectorize it
+   TIncrement* const pIncrementLocal = pIncrement;
+   for(size_t i = 0; i < cItems; ++i) {
+      if(bCopyToIncrement) {
+         pIncrementLocal[i] = static_cast<TIncrement>(pStride[i]);
+      } else {
+         pStride[i] = static_cast<TStride>(pIncrementLocal[i]);
+      }
+   }
+   pIncrement = pIncrementLocal + cItems;
+}
+
+// Walks the dimension iDimension of pIncrement, which is stored outside of the dimensions below it. bSkip is set when
+// an outer dimension is on a dropped missing or unknown bin. Those cells read from the nearest kept bin when copying
+// to pIncrement, and are not written when copying to pStride.
+template<bool bCopyToIncrement, typename TIncrement, typename TStride, size_t iDimension> struct TransposeLevel final {
+   INLINE_RELEASE_UNTEMPLATED static void Func(const TransposeDimension* const aDim,
+         const size_t cScores,
+         TIncrement*& pIncrement,
+         TStride* const pStride,
+         const bool bSkip) {
+      const TransposeDimension* const pDim = &aDim[iDimension];
+      const size_t cBinsReduced = pDim->cBinsReduced;
+      const size_t cBytesStride = pDim->cBytesStride;
+
+      if(pDim->bDropFirst) {
+         TransposeLevel<bCopyToIncrement, TIncrement, TStride, iDimension - 1>::Func(
+               aDim, cScores, pIncrement, pStride, true);
+      }
+      TStride* pStrideBin = pStride;
+      size_t cBinsRemaining = cBinsReduced;
+      do {
+         TransposeLevel<bCopyToIncrement, TIncrement, TStride, iDimension - 1>::Func(
+               aDim, cScores, pIncrement, pStrideBin, bSkip);
+         pStrideBin = IndexByte(pStrideBin, cBytesStride);
+         --cBinsRemaining;
+      } while(size_t{0} != cBinsRemaining);
+      if(pDim->bDropLast) {
+         TransposeLevel<bCopyToIncrement, TIncrement, TStride, iDimension - 1>::Func(
+               aDim, cScores, pIncrement, IndexByte(pStride, cBytesStride * (cBinsReduced - 1)), true);
+      }
+   }
+};
+template<bool bCopyToIncrement, typename TIncrement, typename TStride>
+struct TransposeLevel<bCopyToIncrement, TIncrement, TStride, 0> final {
+   INLINE_RELEASE_UNTEMPLATED static void Func(const TransposeDimension* const aDim,
+         const size_t cScores,
+         TIncrement*& pIncrement,
+         TStride* const pStride,
+         const bool bSkip) {
+      const TransposeDimension* const pDim = aDim;
+      const size_t cBinsReduced = pDim->cBinsReduced;
+      const size_t cBytesStride = pDim->cBytesStride;
+
+      if(!bCopyToIncrement && bSkip) {
+         pIncrement += pDim->cBins * cScores;
+         return;
+      }
+
+      if(pDim->bDropFirst) {
+         if(bCopyToIncrement) {
+            TransposeCells<bCopyToIncrement>(cScores, pIncrement, pStride);
+         } else {
+            pIncrement += cScores;
+         }
+      }
+      if(sizeof(*pStride) * cScores == cBytesStride) {
+         // this dimension is not transposed, so the kept bins of the row are contiguous in both tensors
+         TransposeCells<bCopyToIncrement>(cBinsReduced * cScores, pIncrement, pStride);
+      } else {
+         TStride* pStrideBin = pStride;
+         size_t cBinsRemaining = cBinsReduced;
+         do {
+            TransposeCells<bCopyToIncrement>(cScores, pIncrement, pStrideBin);
+            pStrideBin = IndexByte(pStrideBin, cBytesStride);
+            --cBinsRemaining;
+         } while(size_t{0} != cBinsRemaining);
+      }
+      if(pDim->bDropLast) {
+         if(bCopyToIncrement) {
+            TransposeCells<bCopyToIncrement>(
+                  cScores, pIncrement, IndexByte(pStride, cBytesStride * (cBinsReduced - 1)));
+         } else {
+            pIncrement += cScores;
+         }
+      }
+   }
+};
+
+template<bool bCopyToIncrement, typename TIncrement, typename TStride, size_t cCompilerDimensions>
+static void TransposeStatic(const Term* const pTerm, const size_t cScores, TIncrement* pIncrement, TStride* pStride) {
+   static_assert(1 <= cCompilerDimensions, "zero dimensions are handled in Transpose");
+   EBM_ASSERT(cCompilerDimensions == pTerm->GetCountDimensions());
+
+   const size_t cBytesPerCell = sizeof(*pStride) * cScores;
+
+   const TermFeature* const aTermFeatures = pTerm->GetTermFeatures();
+   TransposeDimension aDim[cCompilerDimensions];
+   for(size_t iDimension = 0; iDimension < cCompilerDimensions; ++iDimension) {
+      InitTransposeDimension(aTermFeatures, &aTermFeatures[iDimension], cBytesPerCell, &aDim[iDimension]);
+   }
+
+   TransposeLevel<bCopyToIncrement, TIncrement, TStride, cCompilerDimensions - 1>::Func(
+         aDim, cScores, pIncrement, pStride, false);
+}
+
+template<bool bCopyToIncrement, typename TIncrement, typename TStride, size_t cCompilerDimensionsPossible>
+struct TransposeCountDimensions final {
+   INLINE_RELEASE_UNTEMPLATED static void Func(
+         const Term* const pTerm, const size_t cScores, TIncrement* const pIncrement, TStride* const pStride) {
+      if(cCompilerDimensionsPossible == pTerm->GetCountDimensions()) {
+         TransposeStatic<bCopyToIncrement, TIncrement, TStride, cCompilerDimensionsPossible>(
+               pTerm, cScores, pIncrement, pStride);
+      } else {
+         TransposeCountDimensions<bCopyToIncrement, TIncrement, TStride, cCompilerDimensionsPossible + 1>::Func(
+               pTerm, cScores, pIncrement, pStride);
+      }
+   }
+};
+template<bool bCopyToIncrement, typename TIncrement, typename TStride>
+struct TransposeCountDimensions<bCopyToIncrement, TIncrement, TStride, k_cCompilerOptimizedCountDimensionsMax + 1>
+      final {
+   INLINE_RELEASE_UNTEMPLATED static void Func(
+         const Term* const pTerm, const size_t cScores, TIncrement* const pIncrement, TStride* const pStride) {
+      TransposeDynamic<bCopyToIncrement>(pTerm, cScores, pIncrement, pStride);
+   }
+};
+
+template<bool bCopyToIncrement, typename TIncrement, typename TStride>
+extern void Transpose(const Term* const pTerm, const size_t cScores, TIncrement* pIncrement, TStride* pStride) {
+   EBM_ASSERT(0 < cScores);
+
+   const size_t cDimensions = pTerm->GetCountDimensions();
+   if(size_t{0} == cDimensions) {
+      TIncrement* const pIncrementEnd = pIncrement + cScores;
+      do {
+         if(bCopyToIncrement) {
+            *pIncrement = static_cast<TIncrement>(*pStride);
+         } else {
+            *pStride = static_cast<TStride>(*pIncrement);
+         }
+         ++pStride;
+         ++pIncrement;
+      } while(pIncrementEnd != pIncrement);
+
+      return;
+   }
+
+   // most terms have 1 to 3 dimensions, and for those the dimension walk is unrolled by the compiler and the rows
+   // that are not transposed become flat copies
+   TransposeCountDimensions<bCopyToIncrement, TIncrement, TStride, 1>::Func(pTerm, cScores, pIncrement, pStride);
+}
+
 } // namespace DEFINED_ZONE_NAME
 
 #endif // TRANSPOSE_HPP
@@ -356,6 +356,14 @@ inline static TreeNodeMulti<bHessian, cCompilerScores>* GetHighNode(
    return pChildren;
 }
 
+// The best tree found by one task of the multi-dimensional sweep. The sweep visits the tree shapes in the same
+// order in every task, so iShape and iRootSplit give the position of the tree in the serial sweep order.
+struct SweepResult final {
+   FloatCalc m_bestGain;
+   size_t m_iShape;
+   size_t m_iRootSplit;
+};
+
 } // namespace DEFINED_ZONE_NAME
 
 #endif // TREE_NODE_HPP
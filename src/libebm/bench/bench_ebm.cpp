@@ -0,0 +1,764 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// Standalone micro-benchmarks for the libebm compute kernels. This is not part of the package build. It only uses the
+// public interface, so build libebm as a shared library first and then something like:
+//
+//   g++ -std=c++17 -O2 -I../inc bench_ebm.cpp -o bench_ebm -L<dir> -lebm -Wl,-rpath,<dir> -pthread
+//   ./bench_ebm [--samples N] [--repeats N] [--quick] > results.jsonl
+//   ./bench_ebm train [--rows N] [--features N] [--bins N] [--classes N] [--sparsity F] [--weights] ...
+//
+// The first form times each kernel on its own. The train form runs a whole workload instead: CreateBooster and some
+// rounds of cyclic boosting over every feature, then CreateInteractionDetector and the strength of every pair, and
+// reports the wall time of each phase with the boosting time broken down by the profile sections.
+//
+// Each measurement is written to stdout as one JSON object per line so that runs from two versions of the package
+// can be joined on every field except the rate fields. The boosting kernels are timed through the
+// CreateBoosterFlags_Profile counters, which isolates BinSumsBoosting and ApplyUpdate from the rest of boosting. Each
+// compute zone is selected through its AccelerationFlags bit with the RequireAcceleration flags, so a zone that cannot
+// be used fails rather than silently falling back to cpu_64, and zones missing from GetAvailableAcceleration are
+// skipped.
+
+#include <stddef.h> // size_t
+#include <stdio.h> // printf, fprintf
+#include <stdlib.h> // strtoll
+#include <string.h> // strcmp
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "libebm.h"
+
+namespace {
+
+struct Zone {
+   const char* m_sName;
+   AccelerationFlags m_acceleration;
+};
+
+struct ObjectiveCase {
+   const char* m_sObjective;
+   IntEbm m_cClasses; // Task_Regression for regression
+   bool m_bConstantHessian; // accepts CreateBoosterFlags_ConstantHessian
+};
+
+struct Options {
+   IntEbm m_cSamples = 100000;
+   int m_cRepeats = 5;
+   bool m_bQuick = false;
+};
+
+static bool IsZoneSupported(const Zone& zone) {
+   return AccelerationFlags_NONE == zone.m_acceleration || 0 != (GetAvailableAcceleration() & zone.m_acceleration);
+}
+
+static int CountBitsRequired(IntEbm maxValue) {
+   int cBits = 0;
+   while(0 != maxValue) {
+      ++cBits;
+      maxValue >>= 1;
+   }
+   return cBits;
+}
+
+static double SecondsSince(const std::chrono::steady_clock::time_point start) {
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void PrintRate(const char* sKernel,
+      const char* sZone,
+      const char* sObjective,
+      const IntEbm cBins,
+      const IntEbm cScores,
+      const bool bWeights,
+      const bool bHessian,
+      const double cItems,
+      const double seconds) {
+   printf("{\"kernel\":\"%s\",\"zone\":\"%s\",\"objective\":\"%s\",\"bins\":%lld,\"bits\":%d,\"scores\":%lld,"
+          "\"weights\":%s,\"hessian\":%s,\"items\":%.0f,\"seconds\":%.9g,\"items_per_sec\":%.6g}\n",
+         sKernel,
+         sZone,
+         sObjective,
+         static_cast<long long>(cBins),
+         CountBitsRequired(cBins - 1),
+         static_cast<long long>(cScores),
+         bWeights ? "true" : "false",
+         bHessian ? "true" : "false",
+         cItems,
+         seconds,
+         0.0 < seconds ? cItems / seconds : 0.0);
+   fflush(stdout);
+}
+
+// builds a dataset of cFeatures features of cBins bins each. The first bin is for missing values and the last for
+// unknown values, so both are left empty. A sparsity fraction of the samples go into bin 1, which is how a mostly
+// zero column looks after binning
+static std::vector<unsigned char> MakeDataSet(std::mt19937_64& rng,
+      const IntEbm cSamples,
+      const IntEbm cFeatures,
+      const IntEbm cBins,
+      const bool bWeights,
+      const IntEbm cClasses,
+      const double sparsity) {
+   std::uniform_int_distribution<IntEbm> binDistribution(1, cBins - 2);
+   std::uniform_real_distribution<double> sparsityDistribution(0.0, 1.0);
+   std::vector<std::vector<IntEbm>> features(static_cast<size_t>(cFeatures));
+   for(std::vector<IntEbm>& binIndexes : features) {
+      binIndexes.resize(static_cast<size_t>(cSamples));
+      for(IntEbm& iBin : binIndexes) {
+         // only draw for the sparsity when it is used so that dense datasets stay the same
+         iBin = 0.0 < sparsity && sparsityDistribution(rng) < sparsity ? IntEbm{1} : binDistribution(rng);
+      }
+   }
+   std::uniform_real_distribution<double> unitDistribution(0.05, 0.95);
+   std::vector<double> weights;
+   if(bWeights) {
+      weights.resize(static_cast<size_t>(cSamples));
+      for(double& weight : weights) {
+         weight = unitDistribution(rng) * 2.0;
+      }
+   }
+   std::vector<double> regressionTargets;
+   std::vector<IntEbm> classificationTargets;
+   if(Task_Regression == cClasses) {
+      // in (0, 1) so that the same targets suit the deviance objectives and cross_entropy
+      regressionTargets.resize(static_cast<size_t>(cSamples));
+      for(double& target : regressionTargets) {
+         target = unitDistribution(rng);
+      }
+   } else {
+      std::uniform_int_distribution<IntEbm> classDistribution(0, cClasses - 1);
+      classificationTargets.resize(static_cast<size_t>(cSamples));
+      for(IntEbm& target : classificationTargets) {
+         target = classDistribution(rng);
+      }
+   }
+
+   IntEbm cBytes = MeasureDataSetHeader(cFeatures, bWeights ? 1 : 0, 1);
+   for(const std::vector<IntEbm>& binIndexes : features) {
+      cBytes += MeasureFeature(cBins, EBM_TRUE, EBM_FALSE, EBM_FALSE, cSamples, binIndexes.data());
+   }
+   if(bWeights) {
+      cBytes += MeasureWeight(cSamples, weights.data());
+   }
+   if(Task_Regression == cClasses) {
+      cBytes += MeasureRegressionTarget(cSamples, regressionTargets.data());
+   } else {
+      cBytes += MeasureClassificationTarget(cClasses, cSamples, classificationTargets.data());
+   }
+
+   std::vector<unsigned char> dataSet(static_cast<size_t>(cBytes));
+   ErrorEbm error = FillDataSetHeader(cFeatures, bWeights ? 1 : 0, 1, cBytes, dataSet.data());
+   for(const std::vector<IntEbm>& binIndexes : features) {
+      error |= FillFeature(cBins, EBM_TRUE, EBM_FALSE, EBM_FALSE, cSamples, binIndexes.data(), cBytes, dataSet.data());
+   }
+   if(bWeights) {
+      error |= FillWeight(cSamples, weights.data(), cBytes, dataSet.data());
+   }
+   error |= Task_Regression == cClasses ?
+         FillRegressionTarget(cSamples, regressionTargets.data(), cBytes, dataSet.data()) :
+         FillClassificationTarget(cClasses, cSamples, classificationTargets.data(), cBytes, dataSet.data());
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: could not build the dataset\n");
+      dataSet.clear();
+   }
+   return dataSet;
+}
+
+static void BenchBoosting(const Options& options,
+      const Zone& zone,
+      const ObjectiveCase& objective,
+      const IntEbm cBins,
+      const bool bWeights,
+      const bool bHessian,
+      std::mt19937_64& rng) {
+   const std::vector<unsigned char> dataSet =
+         MakeDataSet(rng, options.m_cSamples, 1, cBins, bWeights, objective.m_cClasses, 0.0);
+   if(dataSet.empty()) {
+      return;
+   }
+
+   const IntEbm dimensionCounts[1] = {1};
+   const IntEbm featureIndexes[1] = {0};
+   const CreateBoosterFlags flags =
+         CreateBoosterFlags_Profile | CreateBoosterFlags_RequireAcceleration |
+         (bHessian ? CreateBoosterFlags_Default : CreateBoosterFlags_ConstantHessian);
+   BoosterHandle boosterHandle = nullptr;
+   ErrorEbm error = CreateBooster(nullptr,
+         dataSet.data(),
+         nullptr,
+         nullptr,
+         1,
+         dimensionCounts,
+         featureIndexes,
+         nullptr,
+         0,
+         flags,
+         zone.m_acceleration,
+         objective.m_sObjective,
+         nullptr,
+         nullptr,
+         &boosterHandle);
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: CreateBooster failed for %s with %d\n", objective.m_sObjective, error);
+      return;
+   }
+
+   const IntEbm leavesMax[1] = {cBins};
+   for(int iRepeat = 0; iRepeat < options.m_cRepeats; ++iRepeat) {
+      double gain;
+      error = GenerateTermUpdate(nullptr,
+            boosterHandle,
+            0,
+            TermBoostFlags_Default,
+            0.01,
+            1,
+            0.0,
+            0.0,
+            0.0,
+            0.0,
+            leavesMax,
+            nullptr,
+            &gain);
+      if(Error_None != error) {
+         break;
+      }
+      double validationMetric;
+      error = ApplyTermUpdate(boosterHandle, &validationMetric);
+      if(Error_None != error) {
+         break;
+      }
+   }
+
+   IntEbm aItems[ProfileSection_COUNT];
+   IntEbm aNanoseconds[ProfileSection_COUNT];
+   if(Error_None == error &&
+         Error_None ==
+               GetBoosterProfile(boosterHandle, ProfileSection_COUNT, nullptr, aItems, nullptr, aNanoseconds)) {
+      const IntEbm cScores = Task_Regression == objective.m_cClasses || objective.m_cClasses <= 2 ?
+            IntEbm{1} :
+            objective.m_cClasses;
+      PrintRate("BinSumsBoosting",
+            zone.m_sName,
+            objective.m_sObjective,
+            cBins,
+            cScores,
+            bWeights,
+            bHessian,
+            static_cast<double>(aItems[ProfileSection_BinSumsBoosting]),
+            static_cast<double>(aNanoseconds[ProfileSection_BinSumsBoosting]) * 1e-9);
+      PrintRate("ApplyUpdate",
+            zone.m_sName,
+            objective.m_sObjective,
+            cBins,
+            cScores,
+            bWeights,
+            bHessian,
+            static_cast<double>(aItems[ProfileSection_ApplyUpdate]),
+            static_cast<double>(aNanoseconds[ProfileSection_ApplyUpdate]) * 1e-9);
+   } else {
+      fprintf(stderr, "bench_ebm: boosting failed for %s with %d\n", objective.m_sObjective, error);
+   }
+
+   FreeBooster(boosterHandle);
+}
+
+static void BenchInteraction(const Options& options,
+      const Zone& zone,
+      const IntEbm cClasses,
+      const IntEbm cBins,
+      const bool bWeights,
+      std::mt19937_64& rng) {
+   const std::vector<unsigned char> dataSet = MakeDataSet(rng, options.m_cSamples, 2, cBins, bWeights, cClasses, 0.0);
+   if(dataSet.empty()) {
+      return;
+   }
+   const char* const sObjective = Task_Regression == cClasses ? "rmse" : "log_loss";
+
+   InteractionHandle interactionHandle = nullptr;
+   ErrorEbm error = CreateInteractionDetector(dataSet.data(),
+         nullptr,
+         nullptr,
+         CreateInteractionFlags_RequireAcceleration,
+         zone.m_acceleration,
+         sObjective,
+         nullptr,
+         nullptr,
+         &interactionHandle);
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: CreateInteractionDetector failed with %d\n", error);
+      return;
+   }
+
+   const IntEbm featureIndexes[2] = {0, 1};
+   const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   for(int iRepeat = 0; iRepeat < options.m_cRepeats; ++iRepeat) {
+      double strength;
+      error = CalcInteractionStrength(interactionHandle,
+            2,
+            featureIndexes,
+            CalcInteractionFlags_Default,
+            0,
+            0,
+            0.0,
+            0.0,
+            0.0,
+            0.0,
+            &strength);
+      if(Error_None != error) {
+         break;
+      }
+   }
+   const double seconds = SecondsSince(start);
+   if(Error_None == error) {
+      // the pair is binned once per call, so the rate mostly reflects BinSumsInteraction
+      PrintRate("BinSumsInteraction",
+            zone.m_sName,
+            sObjective,
+            cBins,
+            Task_Regression == cClasses || cClasses <= 2 ? IntEbm{1} : cClasses,
+            bWeights,
+            Task_Regression != cClasses,
+            static_cast<double>(options.m_cSamples) * static_cast<double>(options.m_cRepeats),
+            seconds);
+   } else {
+      fprintf(stderr, "bench_ebm: CalcInteractionStrength failed with %d\n", error);
+   }
+
+   FreeInteractionDetector(interactionHandle);
+}
+
+static void BenchCutAndDiscretize(const Options& options, const IntEbm cBins, std::mt19937_64& rng) {
+   std::normal_distribution<double> distribution(0.0, 1.0);
+   std::vector<double> featureVals(static_cast<size_t>(options.m_cSamples));
+   for(double& val : featureVals) {
+      val = distribution(rng);
+   }
+
+   std::vector<double> cuts(static_cast<size_t>(cBins));
+   IntEbm cCuts = cBins - 1;
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   ErrorEbm error = Error_None;
+   for(int iRepeat = 0; iRepeat < options.m_cRepeats; ++iRepeat) {
+      cCuts = cBins - 1;
+      error = CutQuantile(options.m_cSamples, featureVals.data(), 1, EBM_FALSE, &cCuts, cuts.data());
+      if(Error_None != error) {
+         break;
+      }
+   }
+   double seconds = SecondsSince(start);
+   const double cItems = static_cast<double>(options.m_cSamples) * static_cast<double>(options.m_cRepeats);
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: CutQuantile failed with %d\n", error);
+      return;
+   }
+   PrintRate("CutQuantile", "main", "", cBins, 0, false, false, cItems, seconds);
+
+   std::vector<IntEbm> binIndexes(static_cast<size_t>(options.m_cSamples));
+   start = std::chrono::steady_clock::now();
+   for(int iRepeat = 0; iRepeat < options.m_cRepeats; ++iRepeat) {
+      error = Discretize(options.m_cSamples, featureVals.data(), cCuts, cuts.data(), binIndexes.data());
+      if(Error_None != error) {
+         break;
+      }
+   }
+   seconds = SecondsSince(start);
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: Discretize failed with %d\n", error);
+      return;
+   }
+   PrintRate("Discretize", "main", "", cCuts + 1, 0, false, false, cItems, seconds);
+}
+
+static void BenchPurify(const Options& options, const IntEbm cBins, const IntEbm cScores, std::mt19937_64& rng) {
+   const IntEbm dimensionLengths[2] = {cBins, cBins};
+   const size_t cCells = static_cast<size_t>(cBins * cBins);
+   std::uniform_real_distribution<double> distribution(0.5, 2.0);
+   std::vector<double> weights(cCells);
+   for(double& weight : weights) {
+      weight = distribution(rng);
+   }
+   std::vector<double> original(cCells * static_cast<size_t>(cScores));
+   for(double& score : original) {
+      score = distribution(rng) - 1.25;
+   }
+   std::vector<double> scores;
+   std::vector<double> impurities(static_cast<size_t>(cBins + cBins) * static_cast<size_t>(cScores));
+   std::vector<double> intercept(static_cast<size_t>(cScores));
+
+   double seconds = 0.0;
+   for(int iRepeat = 0; iRepeat < options.m_cRepeats; ++iRepeat) {
+      scores = original;
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      const ErrorEbm error = Purify(0.0,
+            EBM_FALSE,
+            1 < cScores ? EBM_TRUE : EBM_FALSE,
+            cScores,
+            2,
+            dimensionLengths,
+            weights.data(),
+            scores.data(),
+            impurities.data(),
+            intercept.data());
+      seconds += SecondsSince(start);
+      if(Error_None != error) {
+         fprintf(stderr, "bench_ebm: Purify failed with %d\n", error);
+         return;
+      }
+   }
+   PrintRate("Purify",
+         "main",
+         "",
+         cBins,
+         cScores,
+         true,
+         false,
+         static_cast<double>(cCells) * static_cast<double>(options.m_cRepeats),
+         seconds);
+}
+
+// a macro workload: boost every feature as a main term for some rounds, then score every pair of features
+struct Workload {
+   IntEbm m_cSamples = 100000;
+   IntEbm m_cFeatures = 10;
+   IntEbm m_cBins = 32;
+   IntEbm m_cClasses = Task_Regression;
+   double m_sparsity = 0.0;
+   bool m_bWeights = false;
+   IntEbm m_cInnerBags = 0;
+   int m_cRounds = 100;
+   AccelerationFlags m_acceleration = AccelerationFlags_ALL;
+};
+
+static void PrintPhase(const Workload& workload, const char* sPhase, const double cCalls, const double seconds) {
+   printf("{\"phase\":\"%s\",\"rows\":%lld,\"features\":%lld,\"bins\":%lld,\"classes\":%lld,\"sparsity\":%g,"
+          "\"weights\":%s,\"inner_bags\":%lld,\"rounds\":%d,\"simd\":%s,\"calls\":%.0f,\"seconds\":%.9g}\n",
+         sPhase,
+         static_cast<long long>(workload.m_cSamples),
+         static_cast<long long>(workload.m_cFeatures),
+         static_cast<long long>(workload.m_cBins),
+         // regression is written as zero classes
+         Task_Regression == workload.m_cClasses ? 0LL : static_cast<long long>(workload.m_cClasses),
+         workload.m_sparsity,
+         workload.m_bWeights ? "true" : "false",
+         static_cast<long long>(workload.m_cInnerBags),
+         workload.m_cRounds,
+         AccelerationFlags_NONE != workload.m_acceleration ? "true" : "false",
+         cCalls,
+         seconds);
+   fflush(stdout);
+}
+
+static int RunWorkload(const Workload& workload) {
+   std::mt19937_64 rng(42);
+   const std::vector<unsigned char> dataSet = MakeDataSet(rng,
+         workload.m_cSamples,
+         workload.m_cFeatures,
+         workload.m_cBins,
+         workload.m_bWeights,
+         workload.m_cClasses,
+         workload.m_sparsity);
+   if(dataSet.empty()) {
+      return 1;
+   }
+   const char* const sObjective = Task_Regression == workload.m_cClasses ? "rmse" : "log_loss";
+
+   std::vector<IntEbm> dimensionCounts(static_cast<size_t>(workload.m_cFeatures), 1);
+   std::vector<IntEbm> featureIndexes(static_cast<size_t>(workload.m_cFeatures));
+   for(IntEbm iFeature = 0; iFeature < workload.m_cFeatures; ++iFeature) {
+      featureIndexes[static_cast<size_t>(iFeature)] = iFeature;
+   }
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   BoosterHandle boosterHandle = nullptr;
+   ErrorEbm error = CreateBooster(nullptr,
+         dataSet.data(),
+         nullptr,
+         nullptr,
+         workload.m_cFeatures,
+         dimensionCounts.data(),
+         featureIndexes.data(),
+         nullptr,
+         workload.m_cInnerBags,
+         CreateBoosterFlags_Profile,
+         workload.m_acceleration,
+         sObjective,
+         nullptr,
+         nullptr,
+         &boosterHandle);
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: CreateBooster failed with %d\n", error);
+      return 1;
+   }
+   PrintPhase(workload, "CreateBooster", 1.0, SecondsSince(start));
+
+   const IntEbm leavesMax[1] = {3};
+   start = std::chrono::steady_clock::now();
+   for(int iRound = 0; iRound < workload.m_cRounds && Error_None == error; ++iRound) {
+      for(IntEbm iTerm = 0; iTerm < workload.m_cFeatures; ++iTerm) {
+         double gain;
+         error = GenerateTermUpdate(nullptr,
+               boosterHandle,
+               iTerm,
+               TermBoostFlags_Default,
+               0.01,
+               2,
+               0.0,
+               0.0,
+               0.0,
+               0.0,
+               leavesMax,
+               nullptr,
+               &gain);
+         if(Error_None != error) {
+            break;
+         }
+         double validationMetric;
+         error = ApplyTermUpdate(boosterHandle, &validationMetric);
+         if(Error_None != error) {
+            break;
+         }
+      }
+   }
+   const double secondsBoosting = SecondsSince(start);
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: boosting failed with %d\n", error);
+      FreeBooster(boosterHandle);
+      return 1;
+   }
+   const double cBoostingCalls = static_cast<double>(workload.m_cRounds) * static_cast<double>(workload.m_cFeatures);
+   PrintPhase(workload, "Boosting", cBoostingCalls, secondsBoosting);
+
+   static const char* const k_asSections[] = {
+         "Boosting.DataSet",
+         "Boosting.BinSumsBoosting",
+         "Boosting.TensorTotalsBuild",
+         "Boosting.PartitionOneDimensional",
+         "Boosting.PartitionTwoDimensional",
+         "Boosting.Purify",
+         "Boosting.ApplyUpdate",
+   };
+   static_assert(sizeof(k_asSections) / sizeof(k_asSections[0]) == static_cast<size_t>(ProfileSection_COUNT),
+         "every profile section needs a name");
+   IntEbm aCalls[ProfileSection_COUNT];
+   IntEbm aNanoseconds[ProfileSection_COUNT];
+   error = GetBoosterProfile(boosterHandle, ProfileSection_COUNT, aCalls, nullptr, nullptr, aNanoseconds);
+   FreeBooster(boosterHandle);
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: GetBoosterProfile failed with %d\n", error);
+      return 1;
+   }
+   double secondsProfiled = 0.0;
+   for(size_t iSection = 0; iSection < static_cast<size_t>(ProfileSection_COUNT); ++iSection) {
+      const double seconds = static_cast<double>(aNanoseconds[iSection]) * 1e-9;
+      if(ProfileSection_DataSet != static_cast<IntEbm>(iSection)) {
+         // the dataset is built inside CreateBooster, not during the boosting rounds
+         secondsProfiled += seconds;
+      }
+      PrintPhase(workload, k_asSections[iSection], static_cast<double>(aCalls[iSection]), seconds);
+   }
+   // the sections add up the time of every thread, so with threads this can reach zero before boosting does
+   PrintPhase(workload,
+         "Boosting.Other",
+         cBoostingCalls,
+         secondsProfiled < secondsBoosting ? secondsBoosting - secondsProfiled : 0.0);
+
+   start = std::chrono::steady_clock::now();
+   InteractionHandle interactionHandle = nullptr;
+   error = CreateInteractionDetector(dataSet.data(),
+         nullptr,
+         nullptr,
+         CreateInteractionFlags_Default,
+         workload.m_acceleration,
+         sObjective,
+         nullptr,
+         nullptr,
+         &interactionHandle);
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: CreateInteractionDetector failed with %d\n", error);
+      return 1;
+   }
+   PrintPhase(workload, "CreateInteractionDetector", 1.0, SecondsSince(start));
+
+   std::vector<IntEbm> pairs;
+   for(IntEbm iFeature1 = 0; iFeature1 < workload.m_cFeatures; ++iFeature1) {
+      for(IntEbm iFeature2 = iFeature1 + 1; iFeature2 < workload.m_cFeatures; ++iFeature2) {
+         pairs.push_back(iFeature1);
+         pairs.push_back(iFeature2);
+      }
+   }
+   const IntEbm cPairs = static_cast<IntEbm>(pairs.size() / 2);
+   std::vector<double> strengths(static_cast<size_t>(cPairs));
+   start = std::chrono::steady_clock::now();
+   if(0 != cPairs) {
+      error = CalcInteractionStrengths(interactionHandle,
+            cPairs,
+            2,
+            pairs.data(),
+            CalcInteractionFlags_Default,
+            0,
+            2,
+            0.0,
+            0.0,
+            0.0,
+            0.0,
+            strengths.data());
+   }
+   const double secondsPairs = SecondsSince(start);
+   FreeInteractionDetector(interactionHandle);
+   if(Error_None != error) {
+      fprintf(stderr, "bench_ebm: CalcInteractionStrengths failed with %d\n", error);
+      return 1;
+   }
+   PrintPhase(workload, "CalcInteractionStrengths", static_cast<double>(cPairs), secondsPairs);
+   return 0;
+}
+
+static bool ParseWorkload(const int argc, char** const argv, Workload* const pWorkload) {
+   for(int iArg = 0; iArg < argc; ++iArg) {
+      const char* const sArg = argv[iArg];
+      const char* const sVal = iArg + 1 < argc ? argv[iArg + 1] : nullptr;
+      if(0 == strcmp("--weights", sArg)) {
+         pWorkload->m_bWeights = true;
+      } else if(0 == strcmp("--no-simd", sArg)) {
+         pWorkload->m_acceleration = AccelerationFlags_NONE;
+      } else if(nullptr == sVal) {
+         return false;
+      } else {
+         ++iArg;
+         if(0 == strcmp("--rows", sArg)) {
+            pWorkload->m_cSamples = static_cast<IntEbm>(strtoll(sVal, nullptr, 10));
+         } else if(0 == strcmp("--features", sArg)) {
+            pWorkload->m_cFeatures = static_cast<IntEbm>(strtoll(sVal, nullptr, 10));
+         } else if(0 == strcmp("--bins", sArg)) {
+            pWorkload->m_cBins = static_cast<IntEbm>(strtoll(sVal, nullptr, 10));
+         } else if(0 == strcmp("--classes", sArg)) {
+            const IntEbm cClasses = static_cast<IntEbm>(strtoll(sVal, nullptr, 10));
+            pWorkload->m_cClasses = cClasses < IntEbm{2} ? IntEbm{Task_Regression} : cClasses;
+         } else if(0 == strcmp("--sparsity", sArg)) {
+            pWorkload->m_sparsity = strtod(sVal, nullptr);
+         } else if(0 == strcmp("--inner-bags", sArg)) {
+            pWorkload->m_cInnerBags = static_cast<IntEbm>(strtoll(sVal, nullptr, 10));
+         } else if(0 == strcmp("--rounds", sArg)) {
+            pWorkload->m_cRounds = static_cast<int>(strtoll(sVal, nullptr, 10));
+         } else {
+            return false;
+         }
+      }
+   }
+   return 2 <= pWorkload->m_cSamples && 1 <= pWorkload->m_cFeatures && 3 <= pWorkload->m_cBins &&
+         0.0 <= pWorkload->m_sparsity && pWorkload->m_sparsity <= 1.0 && 0 <= pWorkload->m_cInnerBags &&
+         0 <= pWorkload->m_cRounds;
+}
+
+static bool ParseOptions(const int argc, char** const argv, Options* const pOptions) {
+   for(int iArg = 1; iArg < argc; ++iArg) {
+      if(0 == strcmp("--quick", argv[iArg])) {
+         pOptions->m_bQuick = true;
+      } else if(0 == strcmp("--samples", argv[iArg]) && iArg + 1 < argc) {
+         ++iArg;
+         pOptions->m_cSamples = static_cast<IntEbm>(strtoll(argv[iArg], nullptr, 10));
+      } else if(0 == strcmp("--repeats", argv[iArg]) && iArg + 1 < argc) {
+         ++iArg;
+         pOptions->m_cRepeats = static_cast<int>(strtoll(argv[iArg], nullptr, 10));
+      } else {
+         return false;
+      }
+   }
+   return 2 <= pOptions->m_cSamples && 1 <= pOptions->m_cRepeats;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+   if(2 <= argc && 0 == strcmp("train", argv[1])) {
+      Workload workload;
+      if(!ParseWorkload(argc - 2, argv + 2, &workload)) {
+         fprintf(stderr,
+               "usage: bench_ebm train [--rows N] [--features N] [--bins N] [--classes N] [--sparsity F] [--weights]"
+               " [--inner-bags N] [--rounds N] [--no-simd]\n");
+         return 1;
+      }
+      return RunWorkload(workload);
+   }
+
+   Options options;
+   if(!ParseOptions(argc, argv, &options)) {
+      fprintf(stderr, "usage: bench_ebm [--samples N] [--repeats N] [--quick]\n");
+      return 1;
+   }
+   if(options.m_bQuick) {
+      options.m_cSamples = options.m_cSamples < IntEbm{10000} ? options.m_cSamples : IntEbm{10000};
+      options.m_cRepeats = 1;
+   }
+
+   static const Zone k_aZones[] = {
+         {"cpu_64", AccelerationFlags_NONE},
+         {"avx2", AccelerationFlags_AVX2},
+         {"avx512f", AccelerationFlags_AVX512F},
+   };
+   static const ObjectiveCase k_aObjectives[] = {
+         {"rmse", Task_Regression, true},
+         {"rmse_log", Task_Regression, true},
+         {"poisson_deviance", Task_Regression, false},
+         {"tweedie_deviance", Task_Regression, false},
+         {"gamma_deviance", Task_Regression, false},
+         {"pseudo_huber", Task_Regression, true},
+         {"cross_entropy", Task_Regression, false},
+         {"log_loss", 2, false},
+         {"log_loss", 3, false},
+         {"log_loss", 8, false},
+   };
+   // the bin counts step through the bit packing widths of the term data
+   static const IntEbm k_aBins[] = {4, 8, 32, 256, 4096};
+   static const IntEbm k_aBinsQuick[] = {8, 256};
+
+   const IntEbm* const aBins = options.m_bQuick ? k_aBinsQuick : k_aBins;
+   const size_t cBinCases = options.m_bQuick ? sizeof(k_aBinsQuick) / sizeof(k_aBinsQuick[0]) :
+                                               sizeof(k_aBins) / sizeof(k_aBins[0]);
+
+   // a fixed seed keeps the data identical between the runs being compared
+   std::mt19937_64 rng(42);
+
+   for(const Zone& zone : k_aZones) {
+      if(!IsZoneSupported(zone)) {
+         fprintf(stderr, "bench_ebm: skipping zone %s that this CPU does not support\n", zone.m_sName);
+         continue;
+      }
+      for(const ObjectiveCase& objective : k_aObjectives) {
+         for(size_t iBins = 0; iBins < cBinCases; ++iBins) {
+            for(const bool bWeights : {false, true}) {
+               for(const bool bHessian : {true, false}) {
+                  if(!bHessian && !objective.m_bConstantHessian) {
+                     continue;
+                  }
+                  BenchBoosting(options, zone, objective, aBins[iBins], bWeights, bHessian, rng);
+               }
+            }
+         }
+      }
+      for(const IntEbm cClasses : {IntEbm{Task_Regression}, IntEbm{2}, IntEbm{3}}) {
+         for(size_t iBins = 0; iBins < cBinCases; ++iBins) {
+            // pairs of the widest features would not fit in memory as a tensor
+            if(IntEbm{256} < aBins[iBins]) {
+               continue;
+            }
+            for(const bool bWeights : {false, true}) {
+               BenchInteraction(options, zone, cClasses, aBins[iBins], bWeights, rng);
+            }
+         }
+      }
+   }
+
+   for(size_t iBins = 0; iBins < cBinCases; ++iBins) {
+      BenchCutAndDiscretize(options, aBins[iBins], rng);
+   }
+   for(const IntEbm cBins : {IntEbm{4}, IntEbm{32}}) {
+      for(const IntEbm cScores : {IntEbm{1}, IntEbm{3}}) {
+         BenchPurify(options, cBins, cScores, rng);
+      }
+   }
+
+   return 0;
+}
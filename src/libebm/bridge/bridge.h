@@ -25,26 +25,31 @@ typedef float FloatSmall;
 static_assert(sizeof(UIntSmall) < sizeof(UIntBig), "UIntBig must be able to contain UIntSmall");
 static_assert(sizeof(FloatSmall) < sizeof(FloatBig), "FloatBig must be able to contain FloatSmall");
 
-// When hessians are present, parallel binning seems to be slighly faster, at least while all
-// the histograms fit into the L1 data cache.  512 bins * 8 bytes/bin * 8 parallel histograms
-// takes 32768 bytes, which is also the L1 data cache for older CPUs. At this size the difference
-// between parallel and non-parallel histograms is very small, and keeping it at 512 bins allows us
-// to keep excercising the non-parallel version at our default of 1024 bin.
-#define HESSIAN_PARALLEL_BIN_BYTES_MAX 32768
+// Parallel bins give each SIMD lane its own copy of the fast bins, so the lanes can gather and scatter without
+// colliding on a shared bin and the copies are summed afterwards. These are compile time caps that decide which
+// kernels exist and bound the lane offsets held in the SIMD integers. Below them, GetParallelBinBytesMax picks the
+// limit at runtime from the L1 data cache size, since the copies only pay off while the gathers stay close to L1.
+#define HESSIAN_PARALLEL_BIN_BYTES_MAX 262144
 #ifdef NDEBUG
-// When there are no hessians, non-parallel histograms seem to always be faster, so disable it.
-// With 2 bins the speed difference is marginal, with parallel binning around 8% slower.
-// The speed differential increases with the number of bins however.
+// When there are no hessians, non-parallel histograms are faster on AVX2 at every size, and only marginally slower
+// on AVX512F for tiny tensors, so disable it.
 #define GRADIENT_PARALLEL_BIN_BYTES_MAX 0
-// multiclass is always significantly slower, so disable it.
-// TODO: check if it's still slower now that we double-load the hessians
-#define MULTISCORE_PARALLEL_BIN_BYTES_MAX 0
+// The non-parallel multiclass kernel serializes every score of every lane, so parallel bins win by a larger margin
+// than for a single score and keep winning on tensors a few times larger than L1.
+#define MULTISCORE_PARALLEL_BIN_BYTES_MAX 262144
 #else
 // for DEBUG, enable parallel gradient and parallel multiclass
 #define GRADIENT_PARALLEL_BIN_BYTES_MAX   1024
 #define MULTISCORE_PARALLEL_BIN_BYTES_MAX 1024
 #endif
 
+// The validation AUC is computed without sorting from a histogram of the validation scores that the binary log loss
+// kernel fills in the same pass that computes the log loss. The buckets split [-AUC_SCORE_MAX, +AUC_SCORE_MAX]
+// evenly and hold the negative and then the positive weight, and scores outside of the range share the end buckets.
+// Samples that land in the same bucket count as ties, so the AUC is exact to within the bucket width of 1/128 logits.
+#define AUC_BINS_COUNT 4096
+#define AUC_SCORE_MAX  16.0
+
 struct ApplyUpdateBridge {
    size_t m_cScores;
    int m_cPack;
@@ -55,12 +60,14 @@ struct ApplyUpdateBridge {
    BoolEbm m_bUseApprox;
    void* m_aMulticlassMidwayTemp; // float or double
    const void* m_aUpdateTensorScores; // float or double
+   size_t m_cTensorBins; // m_aUpdateTensorScores holds m_cScores scores for each of these bins
    size_t m_cSamples;
    const void* m_aPacked; // uint64_t or uint32_t
    const void* m_aTargets; // uint64_t or uint32_t or float or double
    const void* m_aWeights; // float or double
    void* m_aSampleScores; // float or double
    void* m_aGradientsAndHessians; // float or double
+   double* m_aAucBins; // nullptr, or the validation AUC histogram of this subset (see AUC_BINS_COUNT)
 
    double m_metricOut;
 };
@@ -97,6 +104,10 @@ struct BinSumsInteractionBridge {
    size_t m_acBins[k_cDimensionsMax];
    int m_acItemsPerBitPack[k_cDimensionsMax];
    const void* m_aaPacked[k_cDimensionsMax]; // uint64_t or uint32_t
+   // the packed data uses the DataSetBoosting layout, which holds one unused item after the last sample
+   BoolEbm m_bPackedTrailingItem;
+   // gradients and hessians from DataSetBoosting are not premultiplied by the weights, so multiply them while binning
+   BoolEbm m_bWeightGradients;
 
    void* m_aFastBins; // Bin<...> (can't use BinBase * since this is only C here)
 
@@ -118,10 +129,17 @@ typedef ErrorEbm (*BIN_SUMS_BOOSTING_C)(
 typedef ErrorEbm (*BIN_SUMS_INTERACTION_C)(
       const ObjectiveWrapper* const pObjectiveWrapper, BinSumsInteractionBridge* const pParams);
 
+typedef void* (*ALIGNED_ALLOC_C)(const size_t cBytes);
+typedef void (*ALIGNED_FREE_C)(void* const p);
+
 struct ObjectiveWrapper {
    APPLY_UPDATE_C m_pApplyUpdateC;
    BIN_SUMS_BOOSTING_C m_pBinSumsBoostingC;
    BIN_SUMS_INTERACTION_C m_pBinSumsInteractionC;
+   // the data subsets allocate their gradients, scores, targets, weights and bit packed term data with these, so a
+   // zone that runs on a separate device can keep them in memory that the device reaches without copying every round
+   ALIGNED_ALLOC_C m_pAlignedAllocC;
+   ALIGNED_FREE_C m_pAlignedFreeC;
    // everything below here the C++ *Objective specific class needs to fill out
 
    // this needs to be void since our Registrable object is C++ visible and we cannot define it initially
@@ -135,6 +153,9 @@ struct ObjectiveWrapper {
    LinkEbm m_linkFunction;
    double m_linkParam;
 
+   // usually IdentifyTask(m_linkFunction), but an objective can pair a classification link with float targets
+   TaskEbm m_task;
+
    double m_learningRateAdjustmentDifferentialPrivacy;
    double m_learningRateAdjustmentGradientBoosting;
    double m_learningRateAdjustmentHessianBoosting;
@@ -144,24 +165,33 @@ struct ObjectiveWrapper {
    double m_gradientConstant;
    double m_hessianConstant;
    BoolEbm m_bObjectiveHasHessian;
+   BoolEbm m_bConstantHessian;
    BoolEbm m_bRmse;
 
    size_t m_cSIMDPack;
 
    size_t m_cFloatBytes;
    size_t m_cUIntBytes;
+   // bytes per sample of the target data. Classification targets are usually m_cUIntBytes wide, but objectives with
+   // only the classes 0 and 1 can store them in single bytes. All other targets are m_cFloatBytes wide
+   size_t m_cTargetBytes;
 
    AccelerationFlags m_zones;
+   // the zone that the kernels of this wrapper run in, which is AccelerationFlags_NONE for the cpu_64 zone
+   AccelerationFlags m_zone;
 
    // these are C++ function pointer definitions that exist per-zone, and must remain hidden in the C interface
    void* m_pFunctionPointersCpp;
 };
 
 inline static void InitializeObjectiveWrapperUnfailing(ObjectiveWrapper* const pObjectiveWrapper) {
+   pObjectiveWrapper->m_pAlignedAllocC = &AlignedAlloc;
+   pObjectiveWrapper->m_pAlignedFreeC = &AlignedFree;
    pObjectiveWrapper->m_pObjective = NULL;
    pObjectiveWrapper->m_bMaximizeMetric = EBM_FALSE;
    pObjectiveWrapper->m_linkFunction = Link_ERROR;
    pObjectiveWrapper->m_linkParam = 0.0;
+   pObjectiveWrapper->m_task = Task_Unknown;
    pObjectiveWrapper->m_learningRateAdjustmentDifferentialPrivacy = 0.0;
    pObjectiveWrapper->m_learningRateAdjustmentGradientBoosting = 0.0;
    pObjectiveWrapper->m_learningRateAdjustmentHessianBoosting = 0.0;
@@ -170,10 +200,13 @@ inline static void InitializeObjectiveWrapperUnfailing(ObjectiveWrapper* const p
    pObjectiveWrapper->m_gradientConstant = 0.0;
    pObjectiveWrapper->m_hessianConstant = 0.0;
    pObjectiveWrapper->m_bObjectiveHasHessian = EBM_FALSE;
+   pObjectiveWrapper->m_bConstantHessian = EBM_FALSE;
    pObjectiveWrapper->m_bRmse = EBM_FALSE;
    pObjectiveWrapper->m_cSIMDPack = 0;
    pObjectiveWrapper->m_cFloatBytes = 0;
    pObjectiveWrapper->m_cUIntBytes = 0;
+   pObjectiveWrapper->m_cTargetBytes = 0;
+   pObjectiveWrapper->m_zone = AccelerationFlags_NONE;
    pObjectiveWrapper->m_pFunctionPointersCpp = NULL;
 }
 
@@ -203,10 +236,16 @@ INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateObjective_Avx2_32(const Config* co
       const char* const sObjectiveEnd,
       ObjectiveWrapper* const pObjectiveWrapperOut);
 
+INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateObjective_Neon_32(const Config* const pConfig,
+      const char* const sObjective,
+      const char* const sObjectiveEnd,
+      ObjectiveWrapper* const pObjectiveWrapperOut);
+
 INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateObjective_Cuda_32(const Config* const pConfig,
       const char* const sObjective,
       const char* const sObjectiveEnd,
       ObjectiveWrapper* const pObjectiveWrapperOut);
+INTERNAL_IMPORT_EXPORT_INCLUDE BoolEbm IsAvailable_Cuda_32(void);
 
 INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateMetric_Cpu_64(
       const Config* const pConfig, const char* const sMetric, const char* const sMetricEnd
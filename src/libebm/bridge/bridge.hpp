@@ -27,6 +27,10 @@ namespace DEFINED_ZONE_NAME {
 //   2) We want to store integer counts in uint32_t integers to match the size of our float32 values. uint32 values
 //      have a maximum of 2^32, which is much lower than the 2^24/128 that we've set for the float considerations.
 static constexpr size_t k_cSubsetSamplesMax = REPRESENTABLE_INT32_AS_FLOAT32_MAX / 128;
+// With CreateBoosterFlags_MixedPrecision the training subsets of the float32 zones are not limited to
+// k_cSubsetSamplesMax. Their histograms are instead summed in chunks of at most k_cSubsetSamplesMax samples and
+// each chunk's float32 sums are added into float64 bins, so only the uint32 limit from #2 above remains.
+static constexpr size_t k_cSubsetSamplesMixedMax = size_t{1} << 31;
 
 static constexpr size_t k_oneScore = 1;
 static constexpr size_t k_dynamicScores = 0;
@@ -14,6 +14,8 @@
 #define DEFINED_ZONE_NAME NAMESPACE_AVX2
 #elif defined(ZONE_avx512f)
 #define DEFINED_ZONE_NAME NAMESPACE_AVX512F
+#elif defined(ZONE_neon)
+#define DEFINED_ZONE_NAME NAMESPACE_NEON
 #elif defined(ZONE_cuda)
 #define DEFINED_ZONE_NAME NAMESPACE_CUDA
 #else
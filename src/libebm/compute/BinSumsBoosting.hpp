@@ -22,6 +22,15 @@ namespace DEFINED_ZONE_NAME {
 static constexpr int k_cItemsPerBitPackBoostingMax = 64;
 static constexpr int k_cItemsPerBitPackBoostingMin = 1;
 
+// Terms whose bit packs hold indexes of at most this many bits (8 bins) are summed into SIMD registers instead of
+// scattered into memory. Each tensor bin costs one or two registers, so going higher would spill on AVX2.
+static constexpr int k_cRegisterBinsBitsMax = 3;
+
+template<typename TFloat, int cCompilerPack> GPU_DEVICE inline constexpr static bool IsRegisterBins() noexcept {
+   return 1 != TFloat::k_cSIMDPack && k_cItemsPerBitPackUndefined != cCompilerPack &&
+         GetCountBits<typename TFloat::TInt::T>(cCompilerPack) <= k_cRegisterBinsBitsMax;
+}
+
 template<typename TFloat,
       bool bHessian,
       bool bWeight,
@@ -391,7 +400,8 @@ template<typename TFloat,
       size_t cCompilerScores,
       bool bParallel,
       int cCompilerPack,
-      typename std::enable_if<!bCollapsed && 1 != TFloat::k_cSIMDPack && !bParallel && 1 == cCompilerScores,
+      typename std::enable_if<!bCollapsed && 1 != TFloat::k_cSIMDPack && !bParallel && 1 == cCompilerScores &&
+                  !IsRegisterBins<TFloat, cCompilerPack>(),
             int>::type = 0>
 GPU_DEVICE NEVER_INLINE static void BinSumsBoostingInternal(BinSumsBoostingBridge* const pParams) {
 
@@ -566,7 +576,8 @@ template<typename TFloat,
       size_t cCompilerScores,
       bool bParallel,
       int cCompilerPack,
-      typename std::enable_if<bParallel && 1 == cCompilerScores, int>::type = 0>
+      typename std::enable_if<bParallel && 1 == cCompilerScores && !IsRegisterBins<TFloat, cCompilerPack>(),
+            int>::type = 0>
 GPU_DEVICE NEVER_INLINE static void BinSumsBoostingInternal(BinSumsBoostingBridge* const pParams) {
 
    static_assert(!bCollapsed, "bCollapsed cannot be true for parallel histograms.");
@@ -1203,6 +1214,144 @@ GPU_DEVICE NEVER_INLINE static void BinSumsBoostingInternal(BinSumsBoostingBridg
    } while(pGradientsAndHessiansEnd != pGradientAndHessian);
 }
 
+template<typename TFloat,
+      bool bHessian,
+      bool bWeight,
+      bool bCollapsed,
+      size_t cCompilerScores,
+      bool bParallel,
+      int cCompilerPack,
+      typename std::enable_if<!bCollapsed && 1 == cCompilerScores && IsRegisterBins<TFloat, cCompilerPack>(),
+            int>::type = 0>
+GPU_DEVICE NEVER_INLINE static void BinSumsBoostingInternal(BinSumsBoostingBridge* const pParams) {
+
+   // When there are only a few bins, we keep one SIMD accumulator per bin and add each sample into the accumulator
+   // of its bin by comparing the bin index and masking the add. This avoids both the serialized scatter of the
+   // non-parallel kernel and the memory traffic of the parallel kernel. If the host allocated parallel bins, we only
+   // fill the first copy since the other copies are zeroed and get merged in anyway.
+
+   static constexpr int cBitsPerItemMax = GetCountBits<typename TFloat::TInt::T>(cCompilerPack);
+   static constexpr size_t cRegisterBins = size_t{1} << cBitsPerItemMax;
+   static constexpr int cShiftReset = (cCompilerPack - 1) * cBitsPerItemMax;
+
+   static_assert(0 == Bin<typename TFloat::T, typename TFloat::TInt::T, false, false, bHessian>::k_offsetGrad,
+         "We treat aBins as a flat array of TFloat::T, so the Bin class needs to be ordered in an exact way");
+   static_assert(!bHessian ||
+               sizeof(typename TFloat::T) ==
+                     Bin<typename TFloat::T, typename TFloat::TInt::T, false, false, bHessian>::k_offsetHess,
+         "We treat aBins as a flat array of TFloat::T, so the Bin class needs to be ordered in an exact way");
+   static_assert((bHessian ? size_t{2} : size_t{1}) * sizeof(typename TFloat::T) ==
+               sizeof(Bin<typename TFloat::T, typename TFloat::TInt::T, false, false, bHessian>),
+         "We treat aBins as a flat array of TFloat::T, so the Bin class needs to be ordered in an exact way");
+
+#ifndef GPU_COMPILE
+   EBM_ASSERT(nullptr != pParams);
+   EBM_ASSERT(1 <= pParams->m_cSamples);
+   EBM_ASSERT(0 == pParams->m_cSamples % size_t{cCompilerPack * TFloat::k_cSIMDPack});
+   EBM_ASSERT(nullptr != pParams->m_aGradientsAndHessians);
+   EBM_ASSERT(nullptr != pParams->m_aFastBins);
+   EBM_ASSERT(size_t{1} == pParams->m_cScores);
+   EBM_ASSERT(cCompilerPack == pParams->m_cPack);
+   EBM_ASSERT(0 != pParams->m_cBytesFastBins);
+#endif // GPU_COMPILE
+
+   const size_t cSamples = pParams->m_cSamples;
+
+   typename TFloat::T* const aBins = reinterpret_cast<typename TFloat::T*>(pParams->m_aFastBins);
+
+   const typename TFloat::T* pGradientAndHessian =
+         reinterpret_cast<const typename TFloat::T*>(pParams->m_aGradientsAndHessians);
+   const typename TFloat::T* const pGradientsAndHessiansEnd =
+         pGradientAndHessian + (bHessian ? size_t{2} : size_t{1}) * cSamples;
+
+   static constexpr size_t cBytesPerBin =
+         GetBinSize<typename TFloat::T, typename TFloat::TInt::T>(false, false, bHessian, size_t{1});
+#ifndef GPU_COMPILE
+   EBM_ASSERT(0 == pParams->m_cBytesFastBins % cBytesPerBin);
+#endif // GPU_COMPILE
+
+   // the subset can be packed with more bits than the tensor needs and the tensor can have bins that never
+   // appear in the subset, so we only write back the bins that exist in both
+   const size_t cTensorBins = pParams->m_cBytesFastBins / cBytesPerBin;
+   const size_t cWriteBins = cTensorBins < cRegisterBins ? cTensorBins : cRegisterBins;
+
+   const typename TFloat::TInt maskBits = MakeLowMask<typename TFloat::TInt::T>(cBitsPerItemMax);
+
+   const typename TFloat::TInt::T* pInputData = reinterpret_cast<const typename TFloat::TInt::T*>(pParams->m_aPacked);
+#ifndef GPU_COMPILE
+   EBM_ASSERT(nullptr != pInputData);
+#endif // GPU_COMPILE
+
+   TFloat aSumGradients[cRegisterBins];
+   TFloat aSumHessians[cRegisterBins];
+   for(size_t iBin = 0; iBin < cRegisterBins; ++iBin) {
+      aSumGradients[iBin] = 0.0;
+      if(bHessian) {
+         aSumHessians[iBin] = 0.0;
+      }
+   }
+
+   typename TFloat::TInt iTensorBin = TFloat::TInt::Load(pInputData) & maskBits;
+   pInputData += TFloat::TInt::k_cSIMDPack;
+
+   const typename TFloat::T* pWeight;
+   if(bWeight) {
+      pWeight = reinterpret_cast<const typename TFloat::T*>(pParams->m_aWeights);
+#ifndef GPU_COMPILE
+      EBM_ASSERT(nullptr != pWeight);
+#endif // GPU_COMPILE
+   }
+
+   do {
+      const typename TFloat::TInt iTensorBinCombined = TFloat::TInt::Load(pInputData);
+      pInputData += TFloat::TInt::k_cSIMDPack;
+      int cShift = cShiftReset;
+      do {
+         TFloat weight;
+         if(bWeight) {
+            weight = TFloat::Load(pWeight);
+            pWeight += TFloat::k_cSIMDPack;
+         }
+
+         TFloat gradient = TFloat::Load(pGradientAndHessian);
+         TFloat hessian;
+         if(bHessian) {
+            hessian = TFloat::Load(&pGradientAndHessian[TFloat::k_cSIMDPack]);
+         }
+         pGradientAndHessian += (bHessian ? size_t{2} : size_t{1}) * TFloat::k_cSIMDPack;
+
+         if(bWeight) {
+            gradient *= weight;
+            if(bHessian) {
+               hessian *= weight;
+            }
+         }
+
+         for(size_t iBin = 0; iBin < cRegisterBins; ++iBin) {
+            const typename TFloat::TInt bMatch =
+                  iTensorBin == typename TFloat::TInt(static_cast<typename TFloat::TInt::T>(iBin));
+            aSumGradients[iBin] = IfAdd(bMatch, aSumGradients[iBin], gradient);
+            if(bHessian) {
+               aSumHessians[iBin] = IfAdd(bMatch, aSumHessians[iBin], hessian);
+            }
+         }
+
+         iTensorBin = (iTensorBinCombined >> cShift) & maskBits;
+
+         cShift -= cBitsPerItemMax;
+      } while(0 <= cShift);
+   } while(pGradientsAndHessiansEnd != pGradientAndHessian);
+
+   typename TFloat::T* pBin = aBins;
+   for(size_t iBin = 0; iBin < cWriteBins; ++iBin) {
+      pBin[0] += Sum(aSumGradients[iBin]);
+      if(bHessian) {
+         pBin[1] += Sum(aSumHessians[iBin]);
+      }
+      pBin += bHessian ? size_t{2} : size_t{1};
+   }
+}
+
 template<typename TFloat,
       bool bHessian,
       bool bWeight,
@@ -1328,8 +1477,7 @@ template<typename TFloat,
       typename std::enable_if<bCollapsed || 1 == TFloat::k_cSIMDPack ||
                   0 == HESSIAN_PARALLEL_BIN_BYTES_MAX && bHessian && 1 == cCompilerScores ||
                   0 == GRADIENT_PARALLEL_BIN_BYTES_MAX && !bHessian && 1 == cCompilerScores ||
-                  0 == MULTISCORE_PARALLEL_BIN_BYTES_MAX && bHessian && 1 != cCompilerScores ||
-                  !bHessian && 1 != cCompilerScores,
+                  0 == MULTISCORE_PARALLEL_BIN_BYTES_MAX && 1 != cCompilerScores,
             int>::type = 0>
 INLINE_RELEASE_TEMPLATED static ErrorEbm DoneScores(BinSumsBoostingBridge* const pParams) {
    EBM_ASSERT(EBM_FALSE == pParams->m_bParallelBins);
@@ -1345,8 +1493,7 @@ template<typename TFloat,
       typename std::enable_if<!(bCollapsed || 1 == TFloat::k_cSIMDPack ||
                                     0 == HESSIAN_PARALLEL_BIN_BYTES_MAX && bHessian && 1 == cCompilerScores ||
                                     0 == GRADIENT_PARALLEL_BIN_BYTES_MAX && !bHessian && 1 == cCompilerScores ||
-                                    0 == MULTISCORE_PARALLEL_BIN_BYTES_MAX && bHessian && 1 != cCompilerScores ||
-                                    !bHessian && 1 != cCompilerScores),
+                                    0 == MULTISCORE_PARALLEL_BIN_BYTES_MAX && 1 != cCompilerScores),
             int>::type = 0>
 INLINE_RELEASE_TEMPLATED static ErrorEbm DoneScores(BinSumsBoostingBridge* const pParams) {
    if(pParams->m_bParallelBins) {
@@ -1425,10 +1572,13 @@ INLINE_RELEASE_TEMPLATED static ErrorEbm BinSumsBoosting(BinSumsBoostingBridge*
                      MULTISCORE_PARALLEL_BIN_BYTES_MAX - 1),
          "MULTISCORE_PARALLEL_BIN_BYTES_MAX is too large");
 
-   // all our memory should be aligned. It is required by SIMD for correctness or performance
-   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians));
-   EBM_ASSERT(IsAligned(pParams->m_aWeights));
-   EBM_ASSERT(IsAligned(pParams->m_aPacked));
+   // all our memory should be aligned. It is required by SIMD for correctness or performance. A subset can be
+   // binned in chunks that begin at any SIMD pack, so the per-sample arrays are only pack aligned
+   static constexpr size_t cBytesSamplesAlignment = sizeof(typename TFloat::T) * size_t{TFloat::k_cSIMDPack};
+   UNUSED(cBytesSamplesAlignment);
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians, cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights, cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aPacked, cBytesSamplesAlignment));
    EBM_ASSERT(IsAligned(pParams->m_aFastBins));
 
    ErrorEbm error;
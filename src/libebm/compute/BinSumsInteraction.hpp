@@ -51,6 +51,9 @@ GPU_DEVICE NEVER_INLINE static void BinSumsInteractionInternal(BinSumsInteractio
                ->Specialize<typename TFloat::T, typename TFloat::TInt::T, true, true, bHessian, cArrayScores>();
 
    const size_t cSamples = pParams->m_cSamples;
+   const bool bPackedTrailingItem = EBM_FALSE != pParams->m_bPackedTrailingItem;
+   const bool bWeightGradients = EBM_FALSE != pParams->m_bWeightGradients;
+   const size_t cPackedItems = (cSamples >> TFloat::k_cSIMDShift) + (bPackedTrailingItem ? size_t{1} : size_t{0});
 
    const typename TFloat::T* pGradientAndHessian =
          reinterpret_cast<const typename TFloat::T*>(pParams->m_aGradientsAndHessians);
@@ -103,9 +106,8 @@ GPU_DEVICE NEVER_INLINE static void BinSumsInteractionInternal(BinSumsInteractio
       pDimensionalData->maskBits = MakeLowMask<typename TFloat::TInt::T>(cBitsPerItemMax);
 
       pDimensionalData->m_cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
-      pDimensionalData->m_cShift = (static_cast<int>(((cSamples >> TFloat::k_cSIMDShift) - size_t{1}) %
-                                          static_cast<size_t>(cItemsPerBitPack)) +
-                                         1) *
+      pDimensionalData->m_cShift =
+            (static_cast<int>((cPackedItems - size_t{1}) % static_cast<size_t>(cItemsPerBitPack)) + 1) *
             cBitsPerItemMax;
 
       pDimensionalData->m_cBins = pParams->m_acBins[iDimensionInit];
@@ -127,6 +129,11 @@ GPU_DEVICE NEVER_INLINE static void BinSumsInteractionInternal(BinSumsInteractio
    }
 
    while(true) {
+      if(bPackedTrailingItem && pGradientsAndHessiansEnd == pGradientAndHessian) {
+         // the unused trailing item means the last sample does not end a pack, so the check below never sees the end
+         return;
+      }
+
       // for SIMD we'll want scatter/gather semantics since each parallel unit must load from a different pointer:
       // otherwise we'll need to execute the scatter/gather as separate instructions in a templated loop
       // I think we can 6 dimensional 32 bin dimensions with that, and if we need more then we can use the 64
@@ -232,8 +239,9 @@ GPU_DEVICE NEVER_INLINE static void BinSumsInteractionInternal(BinSumsInteractio
          pBin->SetCountSamples(pBin->GetCountSamples() + typename TFloat::TInt::T{1});
       });
 
+      TFloat weight;
       if(bWeight) {
-         const TFloat weight = TFloat::Load(pWeight);
+         weight = TFloat::Load(pWeight);
          pWeight += TFloat::k_cSIMDPack;
 
          TFloat::Execute(
@@ -259,9 +267,13 @@ GPU_DEVICE NEVER_INLINE static void BinSumsInteractionInternal(BinSumsInteractio
       size_t iScore = 0;
       do {
          if(bHessian) {
-            const TFloat gradient = TFloat::Load(&pGradientAndHessian[iScore << (TFloat::k_cSIMDShift + 1)]);
-            const TFloat hessian =
+            TFloat gradient = TFloat::Load(&pGradientAndHessian[iScore << (TFloat::k_cSIMDShift + 1)]);
+            TFloat hessian =
                   TFloat::Load(&pGradientAndHessian[(iScore << (TFloat::k_cSIMDShift + 1)) + TFloat::k_cSIMDPack]);
+            if(bWeight && bWeightGradients) {
+               gradient *= weight;
+               hessian *= weight;
+            }
             TFloat::Execute(
                   [apBins, iScore](const int i, const typename TFloat::T grad, const typename TFloat::T hess) {
                      // BEWARE: unless we generate a separate histogram for each SIMD stream and later merge them, pBin
@@ -280,7 +292,10 @@ GPU_DEVICE NEVER_INLINE static void BinSumsInteractionInternal(BinSumsInteractio
                   gradient,
                   hessian);
          } else {
-            const TFloat gradient = TFloat::Load(&pGradientAndHessian[iScore << TFloat::k_cSIMDShift]);
+            TFloat gradient = TFloat::Load(&pGradientAndHessian[iScore << TFloat::k_cSIMDShift]);
+            if(bWeight && bWeightGradients) {
+               gradient *= weight;
+            }
             TFloat::Execute(
                   [apBins, iScore](const int i, const typename TFloat::T grad) {
                      // BEWARE: unless we generate a separate histogram for each SIMD stream and later merge them, pBin
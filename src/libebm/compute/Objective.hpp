@@ -72,6 +72,70 @@ GPU_DEVICE inline GradientHessian<TFloat> MakeGradientHessian(const double gradi
    return GradientHessian<TFloat>(gradient, hessian);
 }
 
+// ApplyUpdate gathers the update score of every sample from the update tensor, and the gathers of a packed word can
+// only start once the word is loaded and decoded. Update tensors that do not fit in the L2 cache miss on most of those
+// gathers, so the ApplyUpdate loops decode the packed word this many words ahead of the current one and prefetch the
+// update scores that it indexes while they process the current word. Zero turns the prefetching off
+static constexpr size_t k_cApplyUpdatePrefetchWords = 8;
+// update tensors smaller than this are expected to stay in the L2 cache, where prefetching would only add work
+static constexpr size_t k_cBytesApplyUpdatePrefetchMin = size_t{256} * size_t{1024};
+
+// returns the packed word where the ApplyUpdate loop stops prefetching, which is the first word that has no word
+// k_cApplyUpdatePrefetchWords ahead of it. If the update tensor is too small to benefit it returns the first word.
+// The SIMD zones also return the first word since their gathers would have to be split into one prefetch per lane,
+// which costs more than the hardware gather saves
+template<typename TFloat>
+GPU_DEVICE inline static const typename TFloat::TInt::T* GetApplyUpdatePrefetchEnd(
+      const ApplyUpdateBridge* const pData, const int cItemsPerBitPack, const size_t cScores) {
+   const typename TFloat::TInt::T* const aPacked = reinterpret_cast<const typename TFloat::TInt::T*>(pData->m_aPacked);
+#ifndef GPU_COMPILE
+   if(size_t{0} != k_cApplyUpdatePrefetchWords && 1 == TFloat::k_cSIMDPack &&
+         k_cBytesApplyUpdatePrefetchMin <= pData->m_cTensorBins * cScores * sizeof(typename TFloat::T)) {
+      // the first word holds the partial pack, so the word count rounds up
+      const size_t cItems = pData->m_cSamples >> TFloat::k_cSIMDShift;
+      const size_t cWords =
+            (cItems + static_cast<size_t>(cItemsPerBitPack) - size_t{1}) / static_cast<size_t>(cItemsPerBitPack);
+      if(k_cApplyUpdatePrefetchWords < cWords) {
+         return aPacked + (cWords - k_cApplyUpdatePrefetchWords) * size_t{TFloat::TInt::k_cSIMDPack};
+      }
+   }
+#else // GPU_COMPILE
+   UNUSED(cItemsPerBitPack);
+   UNUSED(cScores);
+#endif // GPU_COMPILE
+   return aPacked;
+}
+
+// prefetches the update scores of every item in the packed word at pInputData. Only words after the first are
+// prefetched, so every item of the word is a valid tensor index
+template<typename TFloat>
+GPU_DEVICE INLINE_ALWAYS static void PrefetchUpdateScores(const typename TFloat::T* const aUpdateTensorScores,
+      const typename TFloat::TInt::T* const pInputData,
+      const typename TFloat::TInt& maskBits,
+      const int cBitsPerItemMax,
+      const int cShiftReset,
+      const size_t cScores) {
+#ifndef GPU_COMPILE
+   const typename TFloat::TInt iTensorBinCombined = TFloat::TInt::Load(pInputData);
+   int cShift = cShiftReset;
+   do {
+      TFloat::TInt::Execute(
+            [aUpdateTensorScores, cScores](int, const typename TFloat::TInt::T iTensorBin) {
+               PREFETCH_READ(&aUpdateTensorScores[static_cast<size_t>(iTensorBin) * cScores]);
+            },
+            (iTensorBinCombined >> cShift) & maskBits);
+      cShift -= cBitsPerItemMax;
+   } while(0 <= cShift);
+#else // GPU_COMPILE
+   UNUSED(aUpdateTensorScores);
+   UNUSED(pInputData);
+   UNUSED(maskBits);
+   UNUSED(cBitsPerItemMax);
+   UNUSED(cShiftReset);
+   UNUSED(cScores);
+#endif // GPU_COMPILE
+}
+
 template<typename TObjective,
       bool bCollapsed,
       bool bValidation,
@@ -157,7 +221,10 @@ struct BitPackObjective final {
                EBM_ASSERT(nullptr != pData->m_aSampleScores);
 
                constexpr bool bClassification = Task_GeneralClassification == TObjective::k_task;
-               if(bClassification) {
+               if(bClassification && TObjective::k_bByteTargets) {
+                  // targets are bytes
+                  pData->m_aTargets = IndexByte(pData->m_aTargets, sizeof(uint8_t) * cRemnants);
+               } else if(bClassification) {
                   // targets are integers
                   pData->m_aTargets =
                         IndexByte(pData->m_aTargets, sizeof(typename TObjective::TFloatInternal::TInt::T) * cRemnants);
@@ -327,12 +394,15 @@ struct Objective : public Registrable {
 
          EBM_ASSERT(nullptr != pData->m_aGradientsAndHessians);
 
-         // we only use weights for calculating the metric. Weights get applied
-         // in BinSumsBoosting or during initialization for interactions
-         EBM_ASSERT(nullptr == pData->m_aWeights);
-         static constexpr bool bWeight = false;
-
-         return HessianApplyUpdate<TObjective, bCollapsed, bValidation, bWeight>(pData);
+         // we only use weights for calculating the metric. Weights get applied in BinSumsBoosting or during
+         // initialization for interactions, so training weights are only here for the out of bag metric
+         if(nullptr != pData->m_aWeights) {
+            static constexpr bool bWeight = true;
+            return HessianApplyUpdate<TObjective, bCollapsed, bValidation, bWeight>(pData);
+         } else {
+            static constexpr bool bWeight = false;
+            return HessianApplyUpdate<TObjective, bCollapsed, bValidation, bWeight>(pData);
+         }
       }
    }
    template<typename TObjective, bool bCollapsed, typename std::enable_if<TObjective::k_bRmse, int>::type = 0>
@@ -355,12 +425,15 @@ struct Objective : public Registrable {
       } else {
          static constexpr bool bValidation = false;
 
-         // we only use weights for calculating the metric. Weights get applied
-         // in BinSumsBoosting or during initialization for interactions
-         EBM_ASSERT(nullptr == pData->m_aWeights);
-         static constexpr bool bWeight = false; // if we are not calculating the metric then we never need the weights
-
-         return ApproxApplyUpdate<TObjective, bCollapsed, bValidation, bWeight, bHessian>(pData);
+         // we only use weights for calculating the metric. Weights get applied in BinSumsBoosting or during
+         // initialization for interactions, so training weights are only here for the out of bag metric
+         if(nullptr != pData->m_aWeights) {
+            static constexpr bool bWeight = true;
+            return ApproxApplyUpdate<TObjective, bCollapsed, bValidation, bWeight, bHessian>(pData);
+         } else {
+            static constexpr bool bWeight = false;
+            return ApproxApplyUpdate<TObjective, bCollapsed, bValidation, bWeight, bHessian>(pData);
+         }
       }
    }
 
@@ -555,7 +628,8 @@ struct Objective : public Registrable {
 
       static_assert(k_oneScore == cCompilerScores, "We special case the classifiers so do not need to handle them");
       static_assert(!bValidation || !bHessian, "bHessian can only be true if bValidation is false");
-      static_assert(bValidation || !bWeight, "bWeight can only be true if bValidation is true");
+      // weights on the training set are the out of bag weights, which only the metric uses
+      static constexpr bool bMetric = bValidation || bWeight;
 
       static constexpr bool bFixedSizePack = k_cItemsPerBitPackUndefined != cCompilerPack;
 
@@ -583,6 +657,7 @@ struct Objective : public Registrable {
       int cShiftReset;
       typename TFloat::TInt maskBits;
       const typename TFloat::TInt::T* pInputData;
+      const typename TFloat::TInt::T* pPrefetchEnd;
 
       TFloat updateScore;
 
@@ -607,6 +682,7 @@ struct Objective : public Registrable {
 #ifndef GPU_COMPILE
          EBM_ASSERT(nullptr != pInputData);
 #endif // GPU_COMPILE
+         pPrefetchEnd = GetApplyUpdatePrefetchEnd<TFloat>(pData, cItemsPerBitPack, size_t{1});
 
          cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
          if(bFixedSizePack) {
@@ -629,7 +705,7 @@ struct Objective : public Registrable {
       typename TFloat::T* pGradientAndHessian;
       const typename TFloat::T* pWeight;
       TFloat metricSum;
-      if(bValidation) {
+      if(bMetric) {
          if(bWeight) {
             pWeight = reinterpret_cast<const typename TFloat::T*>(pData->m_aWeights);
 #ifndef GPU_COMPILE
@@ -637,7 +713,8 @@ struct Objective : public Registrable {
 #endif // GPU_COMPILE
          }
          metricSum = 0.0;
-      } else {
+      }
+      if(!bValidation) {
          pGradientAndHessian = reinterpret_cast<typename TFloat::T*>(pData->m_aGradientsAndHessians);
 #ifndef GPU_COMPILE
          EBM_ASSERT(nullptr != pGradientAndHessian);
@@ -655,6 +732,14 @@ struct Objective : public Registrable {
 
          typename TFloat::TInt iTensorBinCombined;
          if(!bCollapsed) {
+            if(pInputData < pPrefetchEnd) {
+               PrefetchUpdateScores<TFloat>(aUpdateTensorScores,
+                     pInputData + k_cApplyUpdatePrefetchWords * size_t{TFloat::TInt::k_cSIMDPack},
+                     maskBits,
+                     cBitsPerItemMax,
+                     cShiftReset,
+                     size_t{1});
+            }
             iTensorBinCombined = TFloat::TInt::Load(pInputData);
             pInputData += TFloat::TInt::k_cSIMDPack;
          }
@@ -671,11 +756,9 @@ struct Objective : public Registrable {
             pTargetData += TFloat::k_cSIMDPack;
 
             TFloat weight;
-            if(bValidation) {
-               if(bWeight) {
-                  weight = TFloat::Load(pWeight);
-                  pWeight += TFloat::k_cSIMDPack;
-               }
+            if(bWeight) {
+               weight = TFloat::Load(pWeight);
+               pWeight += TFloat::k_cSIMDPack;
             }
 
             typename TFloat::TInt iTensorBin;
@@ -690,14 +773,15 @@ struct Objective : public Registrable {
             sampleScore.Store(pSampleScore);
             pSampleScore += TFloat::k_cSIMDPack;
 
-            if(bValidation) {
+            if(bMetric) {
                TFloat metric = pObjective->CalcMetric(sampleScore, target);
                if(bWeight) {
                   metricSum = FusedMultiplyAdd(metric, weight, metricSum);
                } else {
                   metricSum += metric;
                }
-            } else {
+            }
+            if(!bValidation) {
                pGradientAndHessian =
                      HandleGradHess<TObjective, TFloat, bHessian>(pGradientAndHessian, sampleScore, target);
             }
@@ -721,7 +805,7 @@ struct Objective : public Registrable {
          }
       } while(pSampleScoresEnd != pSampleScore);
 
-      if(bValidation) {
+      if(bMetric) {
          pData->m_metricOut += static_cast<double>(Sum(metricSum));
       }
    }
@@ -822,6 +906,12 @@ struct Objective : public Registrable {
       static_assert(bLinkParamGood, "this->LinkParam() should return a double");
       pObjectiveWrapperOut->m_linkParam = linkParam;
 
+      pObjectiveWrapperOut->m_task = TObjective::k_task;
+
+      pObjectiveWrapperOut->m_cTargetBytes = Task_GeneralClassification == TObjective::k_task ?
+            (TObjective::k_bByteTargets ? sizeof(uint8_t) : sizeof(typename TObjective::TFloatInternal::TInt::T)) :
+            sizeof(typename TObjective::TFloatInternal::T);
+
       const auto learningRateAdjustmentDifferentialPrivacy =
             (static_cast<TObjective*>(this))->LearningRateAdjustmentDifferentialPrivacy();
       constexpr bool bLearningRateAdjustmentDifferentialPrivacyGood =
@@ -870,6 +960,7 @@ struct Objective : public Registrable {
       pObjectiveWrapperOut->m_hessianConstant = hessianConstant;
 
       pObjectiveWrapperOut->m_bObjectiveHasHessian = TObjective::k_bHessian ? EBM_TRUE : EBM_FALSE;
+      pObjectiveWrapperOut->m_bConstantHessian = TObjective::k_bConstantHessian ? EBM_TRUE : EBM_FALSE;
       pObjectiveWrapperOut->m_bRmse = TObjective::k_bRmse ? EBM_TRUE : EBM_FALSE;
 
       pObjectiveWrapperOut->m_pObjective = this;
@@ -883,6 +974,13 @@ struct Objective : public Registrable {
    ~Objective() = default;
 
  public:
+   // classification objectives whose targets are only ever 0 or 1 can set this to have their targets stored as bytes
+   // and loaded with TInt::LoadBytes, which cuts the bytes streamed per sample
+   static constexpr bool k_bByteTargets = false;
+
+   // objectives whose hessian never exceeds HessianConstant can set this to allow CreateBoosterFlags_ConstantHessian
+   static constexpr bool k_bConstantHessian = false;
+
    template<typename TFloat>
    static ErrorEbm CreateObjective(const Config* const pConfig,
          const char* const sObjective,
@@ -0,0 +1,682 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <cmath> // exp, log
+#include <limits> // numeric_limits
+#include <type_traits> // is_unsigned
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else // compiler type
+// clang or gcc
+#include <x86intrin.h>
+#endif // compiler type
+
+#include "libebm.h"
+#include "logging.h"
+#include "unzoned.h"
+
+#define ZONE_avx2
+#include "zones.h"
+
+#include "bridge.h"
+#include "common.hpp"
+#include "bridge.hpp"
+
+#include "Registration.hpp"
+#include "Objective.hpp"
+
+#include "math.hpp"
+#include "approximate_math.hpp"
+#include "compute_wrapper.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+static constexpr size_t k_cAlignment = 32;
+
+struct Avx2_32_Float;
+struct Avx2_32_Int;
+
+template<bool bNegateInput = false,
+      bool bNaNPossible = true,
+      bool bUnderflowPossible = true,
+      bool bOverflowPossible = true>
+inline Avx2_32_Float Exp(const Avx2_32_Float& val) noexcept;
+template<bool bNegateOutput = false,
+      bool bNaNPossible = true,
+      bool bNegativePossible = true,
+      bool bZeroPossible = true,
+      bool bPositiveInfinityPossible = true>
+inline Avx2_32_Float Log(const Avx2_32_Float& val) noexcept;
+
+// this is super-special and included inside the zone namespace
+#include "objective_registrations.hpp"
+
+// SIMD registers cannot be indexed, so for the operations that need to go lane by lane (scatters, and lambdas
+// passed to Execute) we spill each register into an aligned array and then iterate the lanes
+template<typename TSIMD> struct alignas(k_cAlignment) Avx2Lanes final {
+   inline explicit Avx2Lanes(const TSIMD& val) noexcept { val.Store(m_a); }
+   typename TSIMD::T m_a[TSIMD::k_cSIMDPack];
+};
+
+template<int cPack, typename TFunc, typename... TLanes>
+inline static void ExecuteLanes(const TFunc& func, const TLanes&... lanes) noexcept {
+   for(int i = 0; i < cPack; ++i) {
+      func(i, lanes.m_a[i]...);
+   }
+}
+
+struct Avx2_32_Int final {
+   friend Avx2_32_Float;
+   friend inline Avx2_32_Float IfThenElse(
+         const Avx2_32_Int& cmp, const Avx2_32_Float& trueVal, const Avx2_32_Float& falseVal) noexcept;
+   friend inline Avx2_32_Float IfAdd(
+         const Avx2_32_Int& cmp, const Avx2_32_Float& base, const Avx2_32_Float& addend) noexcept;
+
+   using T = uint32_t;
+   using TPack = __m256i;
+   static_assert(std::is_unsigned<T>::value, "T must be an unsigned integer type");
+   static_assert(
+         std::is_same<UIntBig, T>::value || std::is_same<UIntSmall, T>::value, "T must be either UIntBig or UIntSmall");
+   static constexpr AccelerationFlags k_zone = AccelerationFlags_AVX2;
+   static constexpr int k_cSIMDShift = 3;
+   static constexpr int k_cSIMDPack = 1 << k_cSIMDShift;
+   static constexpr int k_cTypeShift = 2;
+   static_assert(1 << k_cTypeShift == sizeof(T), "k_cTypeShift must be equivalent to the type size");
+
+   ATTRIBUTE_WARNING_DISABLE_UNINITIALIZED_MEMBER
+   inline Avx2_32_Int() noexcept {}
+
+   inline Avx2_32_Int(const T& val) noexcept : m_data(_mm256_set1_epi32(static_cast<int32_t>(val))) {}
+   inline Avx2_32_Int(const TPack& data) noexcept : m_data(data) {}
+
+   inline static Avx2_32_Int Load(const T* const a) noexcept {
+      EBM_ASSERT(IsAligned(a, sizeof(TPack)));
+      return Avx2_32_Int(_mm256_load_si256(reinterpret_cast<const TPack*>(a)));
+   }
+
+   inline void Store(T* const a) const noexcept {
+      EBM_ASSERT(IsAligned(a, sizeof(TPack)));
+      _mm256_store_si256(reinterpret_cast<TPack*>(a), m_data);
+   }
+
+   inline static Avx2_32_Int LoadBytes(const uint8_t* const a) noexcept {
+      return Avx2_32_Int(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a))));
+   }
+
+   template<typename TFunc, typename... TArgs>
+   static inline void Execute(const TFunc& func, const TArgs&... args) noexcept {
+      ExecuteLanes<k_cSIMDPack>(func, Avx2Lanes<TArgs>(args)...);
+   }
+
+   inline static Avx2_32_Int MakeIndexes() noexcept { return Avx2_32_Int(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+
+   inline Avx2_32_Int operator~() const noexcept {
+      return Avx2_32_Int(_mm256_xor_si256(m_data, _mm256_set1_epi32(-1)));
+   }
+
+   friend inline Avx2_32_Int operator==(const Avx2_32_Int& left, const Avx2_32_Int& right) noexcept {
+      return Avx2_32_Int(_mm256_cmpeq_epi32(left.m_data, right.m_data));
+   }
+
+   inline Avx2_32_Int operator+(const Avx2_32_Int& other) const noexcept {
+      return Avx2_32_Int(_mm256_add_epi32(m_data, other.m_data));
+   }
+
+   inline Avx2_32_Int operator-(const Avx2_32_Int& other) const noexcept {
+      return Avx2_32_Int(_mm256_sub_epi32(m_data, other.m_data));
+   }
+
+   inline Avx2_32_Int operator*(const T& other) const noexcept {
+      return Avx2_32_Int(_mm256_mullo_epi32(m_data, _mm256_set1_epi32(static_cast<int32_t>(other))));
+   }
+
+   inline Avx2_32_Int operator>>(int shift) const noexcept {
+      return Avx2_32_Int(_mm256_srl_epi32(m_data, _mm_cvtsi32_si128(shift)));
+   }
+
+   inline Avx2_32_Int operator<<(int shift) const noexcept {
+      return Avx2_32_Int(_mm256_sll_epi32(m_data, _mm_cvtsi32_si128(shift)));
+   }
+
+   inline Avx2_32_Int operator&(const Avx2_32_Int& other) const noexcept {
+      return Avx2_32_Int(_mm256_and_si256(m_data, other.m_data));
+   }
+
+   inline Avx2_32_Int operator|(const Avx2_32_Int& other) const noexcept {
+      return Avx2_32_Int(_mm256_or_si256(m_data, other.m_data));
+   }
+
+   friend inline Avx2_32_Int IfThenElse(
+         const Avx2_32_Int& cmp, const Avx2_32_Int& trueVal, const Avx2_32_Int& falseVal) noexcept {
+      return Avx2_32_Int(_mm256_blendv_epi8(falseVal.m_data, trueVal.m_data, cmp.m_data));
+   }
+
+   friend inline Avx2_32_Int IfAdd(const Avx2_32_Int& cmp, const Avx2_32_Int& base, const Avx2_32_Int& addend) noexcept {
+      return base + Avx2_32_Int(_mm256_and_si256(cmp.m_data, addend.m_data));
+   }
+
+   friend inline Avx2_32_Int PermuteForInterleaf(const Avx2_32_Int& val) noexcept {
+      // this permutes the lanes into the order that Avx2_32_Float::Interleaf produces. _mm256_unpacklo_ps and
+      // _mm256_unpackhi_ps operate within each 128 bit half, so the first DoubleLoad gathers samples 0,1,4,5
+      // and the second gathers samples 2,3,6,7
+      return Avx2_32_Int(_mm256_permutevar8x32_epi32(val.m_data, _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7)));
+   }
+
+ private:
+   TPack m_data;
+};
+static_assert(std::is_standard_layout<Avx2_32_Int>::value && std::is_trivially_copyable<Avx2_32_Int>::value,
+      "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
+
+struct Avx2_32_Float final {
+   template<bool bNegateInput, bool bNaNPossible, bool bUnderflowPossible, bool bOverflowPossible>
+   friend Avx2_32_Float Exp(const Avx2_32_Float& val) noexcept;
+   template<bool bNegateOutput,
+         bool bNaNPossible,
+         bool bNegativePossible,
+         bool bZeroPossible,
+         bool bPositiveInfinityPossible>
+   friend Avx2_32_Float Log(const Avx2_32_Float& val) noexcept;
+
+   using T = float;
+   using TPack = __m256;
+   using TInt = Avx2_32_Int;
+   static_assert(std::is_same<FloatBig, T>::value || std::is_same<FloatSmall, T>::value,
+         "T must be either FloatBig or FloatSmall");
+   static constexpr AccelerationFlags k_zone = TInt::k_zone;
+   static constexpr int k_cSIMDShift = TInt::k_cSIMDShift;
+   static constexpr int k_cSIMDPack = TInt::k_cSIMDPack;
+   static constexpr int k_cTypeShift = 2;
+   static_assert(1 << k_cTypeShift == sizeof(T), "k_cTypeShift must be equivalent to the type size");
+
+   ATTRIBUTE_WARNING_DISABLE_UNINITIALIZED_MEMBER
+   inline Avx2_32_Float() noexcept {}
+
+   inline Avx2_32_Float(const TPack& data) noexcept : m_data(data) {}
+   inline Avx2_32_Float(const double val) noexcept : m_data(_mm256_set1_ps(static_cast<T>(val))) {}
+   inline Avx2_32_Float(const float val) noexcept : m_data(_mm256_set1_ps(static_cast<T>(val))) {}
+   inline Avx2_32_Float(const int val) noexcept : m_data(_mm256_set1_ps(static_cast<T>(val))) {}
+   inline Avx2_32_Float(const int64_t val) noexcept : m_data(_mm256_set1_ps(static_cast<T>(val))) {}
+   explicit Avx2_32_Float(const Avx2_32_Int& val) : m_data(_mm256_cvtepi32_ps(val.m_data)) {}
+
+   inline Avx2_32_Float operator+() const noexcept { return *this; }
+
+   inline Avx2_32_Float operator-() const noexcept {
+      return Avx2_32_Float(_mm256_castsi256_ps(
+            _mm256_xor_si256(_mm256_castps_si256(m_data), _mm256_set1_epi32(static_cast<int32_t>(0x80000000)))));
+   }
+
+   inline Avx2_32_Float operator+(const Avx2_32_Float& other) const noexcept {
+      return Avx2_32_Float(_mm256_add_ps(m_data, other.m_data));
+   }
+
+   inline Avx2_32_Float operator-(const Avx2_32_Float& other) const noexcept {
+      return Avx2_32_Float(_mm256_sub_ps(m_data, other.m_data));
+   }
+
+   inline Avx2_32_Float operator*(const Avx2_32_Float& other) const noexcept {
+      return Avx2_32_Float(_mm256_mul_ps(m_data, other.m_data));
+   }
+
+   inline Avx2_32_Float operator/(const Avx2_32_Float& other) const noexcept {
+      return Avx2_32_Float(_mm256_div_ps(m_data, other.m_data));
+   }
+
+   inline Avx2_32_Float& operator+=(const Avx2_32_Float& other) noexcept {
+      *this = (*this) + other;
+      return *this;
+   }
+
+   inline Avx2_32_Float& operator-=(const Avx2_32_Float& other) noexcept {
+      *this = (*this) - other;
+      return *this;
+   }
+
+   inline Avx2_32_Float& operator*=(const Avx2_32_Float& other) noexcept {
+      *this = (*this) * other;
+      return *this;
+   }
+
+   inline Avx2_32_Float& operator/=(const Avx2_32_Float& other) noexcept {
+      *this = (*this) / other;
+      return *this;
+   }
+
+   friend inline Avx2_32_Float operator+(const double val, const Avx2_32_Float& other) noexcept {
+      return Avx2_32_Float(val) + other;
+   }
+
+   friend inline Avx2_32_Float operator-(const double val, const Avx2_32_Float& other) noexcept {
+      return Avx2_32_Float(val) - other;
+   }
+
+   friend inline Avx2_32_Float operator*(const double val, const Avx2_32_Float& other) noexcept {
+      return Avx2_32_Float(val) * other;
+   }
+
+   friend inline Avx2_32_Float operator/(const double val, const Avx2_32_Float& other) noexcept {
+      return Avx2_32_Float(val) / other;
+   }
+
+   friend inline Avx2_32_Float operator+(const float val, const Avx2_32_Float& other) noexcept {
+      return Avx2_32_Float(val) + other;
+   }
+
+   friend inline Avx2_32_Float operator-(const float val, const Avx2_32_Float& other) noexcept {
+      return Avx2_32_Float(val) - other;
+   }
+
+   friend inline Avx2_32_Float operator*(const float val, const Avx2_32_Float& other) noexcept {
+      return Avx2_32_Float(val) * other;
+   }
+
+   friend inline Avx2_32_Float operator/(const float val, const Avx2_32_Float& other) noexcept {
+      return Avx2_32_Float(val) / other;
+   }
+
+   friend inline Avx2_32_Int operator==(const Avx2_32_Float& left, const Avx2_32_Float& right) noexcept {
+      return Avx2_32_Int(_mm256_castps_si256(_mm256_cmp_ps(left.m_data, right.m_data, _CMP_EQ_OQ)));
+   }
+
+   friend inline Avx2_32_Int operator<(const Avx2_32_Float& left, const Avx2_32_Float& right) noexcept {
+      return Avx2_32_Int(_mm256_castps_si256(_mm256_cmp_ps(left.m_data, right.m_data, _CMP_LT_OQ)));
+   }
+
+   friend inline Avx2_32_Int operator<=(const Avx2_32_Float& left, const Avx2_32_Float& right) noexcept {
+      return Avx2_32_Int(_mm256_castps_si256(_mm256_cmp_ps(left.m_data, right.m_data, _CMP_LE_OQ)));
+   }
+
+   inline static Avx2_32_Float Load(const T* const a) noexcept {
+      EBM_ASSERT(IsAligned(a, sizeof(TPack)));
+      return Avx2_32_Float(_mm256_load_ps(a));
+   }
+
+   inline void Store(T* const a) const noexcept {
+      EBM_ASSERT(IsAligned(a, sizeof(TPack)));
+      _mm256_store_ps(a, m_data);
+   }
+
+   template<int cShift = k_cTypeShift> inline static Avx2_32_Float Load(const T* const a, const TInt& i) noexcept {
+      // i is treated as signed by the gather instruction, so we only use the lower 31 bits otherwise we would
+      // read from memory before a
+      static_assert(0 <= cShift && cShift <= 3, "the scale of a gathering load can only be 1, 2, 4, or 8");
+      return Avx2_32_Float(_mm256_i32gather_ps(a, i.m_data, 1 << cShift));
+   }
+
+   template<int cShift>
+   inline static void DoubleLoad(const T* const a,
+         const Avx2_32_Int& i,
+         Avx2_32_Float& ret1,
+         Avx2_32_Float& ret2) noexcept {
+      // i is treated as signed, so we only use the lower 31 bits otherwise we would read from memory before a
+      static_assert(0 <= cShift && cShift <= 3, "the scale of a gathering load can only be 1, 2, 4, or 8");
+      // we use the 64-bit double gather since we want to fetch the gradient and hessian together in one operation
+      const __m128i i1 = _mm256_extracti128_si256(i.m_data, 0);
+      ret1 = Avx2_32_Float(_mm256_castpd_ps(_mm256_i32gather_pd(reinterpret_cast<const double*>(a), i1, 1 << cShift)));
+      const __m128i i2 = _mm256_extracti128_si256(i.m_data, 1);
+      ret2 = Avx2_32_Float(_mm256_castpd_ps(_mm256_i32gather_pd(reinterpret_cast<const double*>(a), i2, 1 << cShift)));
+   }
+
+   template<int cShift = k_cTypeShift> inline void Store(T* const a, const TInt& i) const noexcept {
+      // AVX2 does not have a scattering store, so store each lane individually
+      const Avx2Lanes<Avx2_32_Int> indexes(i);
+      const Avx2Lanes<Avx2_32_Float> vals(*this);
+      for(int iLane = 0; iLane < k_cSIMDPack; ++iLane) {
+         *IndexByte(a, static_cast<size_t>(indexes.m_a[iLane]) << cShift) = vals.m_a[iLane];
+      }
+   }
+
+   template<int cShift>
+   inline static void DoubleStore(T* const a,
+         const Avx2_32_Int& i,
+         const Avx2_32_Float& val1,
+         const Avx2_32_Float& val2) noexcept {
+      // AVX2 does not have a scattering store, so store each gradient/hessian pair as a single 64-bit value
+      const Avx2Lanes<Avx2_32_Int> indexes(i);
+
+      alignas(k_cAlignment) uint64_t pairs[k_cSIMDPack];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(&pairs[0]), _mm256_castps_si256(val1.m_data));
+      _mm256_store_si256(reinterpret_cast<__m256i*>(&pairs[k_cSIMDPack / 2]), _mm256_castps_si256(val2.m_data));
+
+      for(int iLane = 0; iLane < k_cSIMDPack; ++iLane) {
+         *IndexByte(reinterpret_cast<uint64_t*>(a), static_cast<size_t>(indexes.m_a[iLane]) << cShift) = pairs[iLane];
+      }
+   }
+
+   inline static void Interleaf(const Avx2_32_Float& val0,
+         const Avx2_32_Float& val1,
+         Avx2_32_Float& ret0,
+         Avx2_32_Float& ret1) noexcept {
+      // this function permutes the values into positions that the PermuteForInterleaf function expects
+      // but for any SIMD implementation, the positions can be variable as long as they work together
+      ret0 = Avx2_32_Float(_mm256_unpacklo_ps(val0.m_data, val1.m_data));
+      ret1 = Avx2_32_Float(_mm256_unpackhi_ps(val0.m_data, val1.m_data));
+   }
+
+   template<typename TFunc> friend inline Avx2_32_Float ApplyFunc(const TFunc& func, const Avx2_32_Float& val) noexcept {
+      alignas(k_cAlignment) T aTemp[k_cSIMDPack];
+      val.Store(aTemp);
+      for(int i = 0; i < k_cSIMDPack; ++i) {
+         aTemp[i] = func(aTemp[i]);
+      }
+      return Load(aTemp);
+   }
+
+   template<typename TFunc, typename... TArgs>
+   static inline void Execute(const TFunc& func, const TArgs&... args) noexcept {
+      ExecuteLanes<k_cSIMDPack>(func, Avx2Lanes<TArgs>(args)...);
+   }
+
+   friend inline Avx2_32_Float IfThenElse(
+         const Avx2_32_Int& cmp, const Avx2_32_Float& trueVal, const Avx2_32_Float& falseVal) noexcept {
+      return Avx2_32_Float(_mm256_blendv_ps(falseVal.m_data, trueVal.m_data, _mm256_castsi256_ps(cmp.m_data)));
+   }
+
+   friend inline Avx2_32_Float IfAdd(
+         const Avx2_32_Int& cmp, const Avx2_32_Float& base, const Avx2_32_Float& addend) noexcept {
+      return base + Avx2_32_Float(_mm256_and_ps(_mm256_castsi256_ps(cmp.m_data), addend.m_data));
+   }
+
+   friend inline Avx2_32_Int IsNaN(const Avx2_32_Float& cmp) noexcept {
+      return Avx2_32_Int(_mm256_castps_si256(_mm256_cmp_ps(cmp.m_data, cmp.m_data, _CMP_UNORD_Q)));
+   }
+
+   static inline Avx2_32_Int ReinterpretInt(const Avx2_32_Float& val) noexcept {
+      return Avx2_32_Int(_mm256_castps_si256(val.m_data));
+   }
+
+   static inline Avx2_32_Float ReinterpretFloat(const Avx2_32_Int& val) noexcept {
+      return Avx2_32_Float(_mm256_castsi256_ps(val.m_data));
+   }
+
+   friend inline Avx2_32_Float Round(const Avx2_32_Float& val) noexcept {
+      return Avx2_32_Float(_mm256_round_ps(val.m_data, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+   }
+
+   friend inline Avx2_32_Float Abs(const Avx2_32_Float& val) noexcept {
+      return Avx2_32_Float(_mm256_and_ps(val.m_data, _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF))));
+   }
+
+   friend inline Avx2_32_Float FastApproxReciprocal(const Avx2_32_Float& val) noexcept {
+#ifdef FAST_DIVISION
+      return Avx2_32_Float(_mm256_rcp_ps(val.m_data));
+#else // FAST_DIVISION
+      return Avx2_32_Float(_mm256_div_ps(_mm256_set1_ps(1.0f), val.m_data));
+#endif // FAST_DIVISION
+   }
+
+   friend inline Avx2_32_Float FastApproxDivide(
+         const Avx2_32_Float& dividend, const Avx2_32_Float& divisor) noexcept {
+#ifdef FAST_DIVISION
+      return Avx2_32_Float(_mm256_mul_ps(dividend.m_data, _mm256_rcp_ps(divisor.m_data)));
+#else // FAST_DIVISION
+      return Avx2_32_Float(_mm256_div_ps(dividend.m_data, divisor.m_data));
+#endif // FAST_DIVISION
+   }
+
+   friend inline Avx2_32_Float FusedMultiplyAdd(
+         const Avx2_32_Float& mul1, const Avx2_32_Float& mul2, const Avx2_32_Float& add) noexcept {
+      // For AVX, Intel initially built FMA3, and AMD built FMA4, but AMD later depricated FMA4 and supported
+      // FMA3 by the time AVX2 was introduced. We only choose the AVX2 zone when the CPU reports FMA3 support
+      return Avx2_32_Float(_mm256_fmadd_ps(mul1.m_data, mul2.m_data, add.m_data));
+   }
+
+   friend inline Avx2_32_Float FusedNegateMultiplyAdd(
+         const Avx2_32_Float& mul1, const Avx2_32_Float& mul2, const Avx2_32_Float& add) noexcept {
+      // equivalent to: -(mul1 * mul2) + add
+      return Avx2_32_Float(_mm256_fnmadd_ps(mul1.m_data, mul2.m_data, add.m_data));
+   }
+
+   friend inline Avx2_32_Float FusedMultiplySubtract(
+         const Avx2_32_Float& mul1, const Avx2_32_Float& mul2, const Avx2_32_Float& subtract) noexcept {
+      // equivalent to: mul1 * mul2 - subtract
+      return Avx2_32_Float(_mm256_fmsub_ps(mul1.m_data, mul2.m_data, subtract.m_data));
+   }
+
+   friend inline Avx2_32_Float Sqrt(const Avx2_32_Float& val) noexcept {
+      return Avx2_32_Float(_mm256_sqrt_ps(val.m_data));
+   }
+
+   template<bool bUseApprox,
+         bool bNegateInput = false,
+         bool bNaNPossible = true,
+         bool bUnderflowPossible = true,
+         bool bOverflowPossible = true,
+         bool bSpecialCaseZero = false,
+         typename std::enable_if<!bUseApprox, int>::type = 0>
+   static inline Avx2_32_Float ApproxExp(const Avx2_32_Float& val,
+         const int32_t addExpSchraudolphTerm = k_expTermZeroMeanErrorForSoftmaxWithZeroedLogit) noexcept {
+      UNUSED(addExpSchraudolphTerm);
+      return Exp<bNegateInput, bNaNPossible, bUnderflowPossible, bOverflowPossible>(val);
+   }
+
+   template<bool bUseApprox,
+         bool bNegateInput = false,
+         bool bNaNPossible = true,
+         bool bUnderflowPossible = true,
+         bool bOverflowPossible = true,
+         bool bSpecialCaseZero = false,
+         typename std::enable_if<bUseApprox, int>::type = 0>
+   static inline Avx2_32_Float ApproxExp(const Avx2_32_Float& val,
+         const int32_t addExpSchraudolphTerm = k_expTermZeroMeanErrorForSoftmaxWithZeroedLogit) noexcept {
+      // This is the SIMD equivalent of ExpApproxSchraudolph in approximate_math.hpp. The float to int conversion
+      // is defined for all inputs in AVX2, so we compute all lanes and then patch up the special cases afterwards.
+      // TODO: we might want different constants for binary classification and multiclass. See notes in
+      // approximate_math.hpp
+      static constexpr float signedExpMultiple = bNegateInput ? -k_expMultiple : k_expMultiple;
+      const __m256i product = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_set1_ps(signedExpMultiple), val.m_data));
+      const __m256i retInt = _mm256_add_epi32(product, _mm256_set1_epi32(addExpSchraudolphTerm));
+      Avx2_32_Float result = Avx2_32_Float(_mm256_castsi256_ps(retInt));
+      if(bSpecialCaseZero) {
+         result = IfThenElse(Avx2_32_Float(0.0f) == val, Avx2_32_Float(1.0f), result);
+      }
+      if(bOverflowPossible) {
+         if(bNegateInput) {
+            result = IfThenElse(val < Avx2_32_Float(-k_expOverflowPoint), std::numeric_limits<T>::infinity(), result);
+         } else {
+            result = IfThenElse(Avx2_32_Float(k_expOverflowPoint) < val, std::numeric_limits<T>::infinity(), result);
+         }
+      }
+      if(bUnderflowPossible) {
+         if(bNegateInput) {
+            result = IfThenElse(Avx2_32_Float(-k_expUnderflowPoint) < val, Avx2_32_Float(0.0f), result);
+         } else {
+            result = IfThenElse(val < Avx2_32_Float(k_expUnderflowPoint), Avx2_32_Float(0.0f), result);
+         }
+      }
+      if(bNaNPossible) {
+         result = IfThenElse(IsNaN(val), val, result);
+      }
+      return result;
+   }
+
+   template<bool bUseApprox,
+         bool bNegateOutput = false,
+         bool bNaNPossible = true,
+         bool bNegativePossible = true,
+         bool bZeroPossible = true, // if false, positive zero returns a big negative number, negative zero returns a
+                                    // big positive number
+         bool bPositiveInfinityPossible = true, // if false, +inf returns a big positive number.  If val can be a
+                                                // double that is above the largest representable float, then setting
+                                                // this is necessary to avoid undefined behavior
+         typename std::enable_if<!bUseApprox, int>::type = 0>
+   static inline Avx2_32_Float ApproxLog(
+         const Avx2_32_Float& val, const float addLogSchraudolphTerm = k_logTermLowerBoundInputCloseToOne) noexcept {
+      UNUSED(addLogSchraudolphTerm);
+      return Log<bNegateOutput, bNaNPossible, bNegativePossible, bZeroPossible, bPositiveInfinityPossible>(val);
+   }
+
+   template<bool bUseApprox,
+         bool bNegateOutput = false,
+         bool bNaNPossible = true,
+         bool bNegativePossible = true,
+         bool bZeroPossible = true, // if false, positive zero returns a big negative number, negative zero returns a
+                                    // big positive number
+         bool bPositiveInfinityPossible = true, // if false, +inf returns a big positive number.  If val can be a
+                                                // double that is above the largest representable float, then setting
+                                                // this is necessary to avoid undefined behavior
+         typename std::enable_if<bUseApprox, int>::type = 0>
+   static inline Avx2_32_Float ApproxLog(
+         const Avx2_32_Float& val, const float addLogSchraudolphTerm = k_logTermLowerBoundInputCloseToOne) noexcept {
+      // This is the SIMD equivalent of LogApproxSchraudolph in approximate_math.hpp
+      Avx2_32_Float result = Avx2_32_Float(_mm256_cvtepi32_ps(_mm256_castps_si256(val.m_data)));
+      if(bNaNPossible) {
+         if(bPositiveInfinityPossible) {
+            result = IfThenElse(val < std::numeric_limits<T>::infinity(), result, val);
+         } else {
+            result = IfThenElse(IsNaN(val), val, result);
+         }
+      } else {
+         if(bPositiveInfinityPossible) {
+            result = IfThenElse(std::numeric_limits<T>::infinity() == val, val, result);
+         }
+      }
+      if(bNegateOutput) {
+         result = FusedMultiplyAdd(result, Avx2_32_Float(-k_logMultiple), Avx2_32_Float(-addLogSchraudolphTerm));
+      } else {
+         result = FusedMultiplyAdd(result, Avx2_32_Float(k_logMultiple), Avx2_32_Float(addLogSchraudolphTerm));
+      }
+      if(bZeroPossible) {
+         result = IfThenElse(val < std::numeric_limits<T>::min(),
+               bNegateOutput ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity(),
+               result);
+      }
+      if(bNegativePossible) {
+         result = IfThenElse(val < Avx2_32_Float(0.0f), std::numeric_limits<T>::quiet_NaN(), result);
+      }
+      return result;
+   }
+
+   friend inline T Sum(const Avx2_32_Float& val) noexcept {
+      const __m128 low = _mm256_castps256_ps128(val.m_data);
+      const __m128 high = _mm256_extractf128_ps(val.m_data, 1);
+      const __m128 sum4 = _mm_add_ps(low, high);
+      const __m128 sum2 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+      const __m128 sum1 = _mm_add_ss(sum2, _mm_movehdup_ps(sum2));
+      return _mm_cvtss_f32(sum1);
+   }
+
+   template<typename TObjective,
+         bool bCollapsed,
+         bool bValidation,
+         bool bWeight,
+         bool bHessian,
+         bool bUseApprox,
+         size_t cCompilerScores>
+   INLINE_RELEASE_TEMPLATED static ErrorEbm OperatorApplyUpdate(
+         const Objective* const pObjective, ApplyUpdateBridge* const pData) noexcept {
+      RemoteApplyUpdate<TObjective, bCollapsed, bValidation, bWeight, bHessian, bUseApprox, cCompilerScores>(
+            pObjective, pData);
+      return Error_None;
+   }
+
+   template<bool bHessian, bool bWeight, bool bCollapsed, size_t cCompilerScores, bool bParallel>
+   INLINE_RELEASE_TEMPLATED static ErrorEbm OperatorBinSumsBoosting(BinSumsBoostingBridge* const pParams) noexcept {
+      RemoteBinSumsBoosting<Avx2_32_Float, bHessian, bWeight, bCollapsed, cCompilerScores, bParallel>(pParams);
+      return Error_None;
+   }
+
+   template<bool bHessian, bool bWeight, size_t cCompilerScores, size_t cCompilerDimensions>
+   INLINE_RELEASE_TEMPLATED static ErrorEbm OperatorBinSumsInteraction(
+         BinSumsInteractionBridge* const pParams) noexcept {
+      RemoteBinSumsInteraction<Avx2_32_Float, bHessian, bWeight, cCompilerScores, cCompilerDimensions>(pParams);
+      return Error_None;
+   }
+
+ private:
+   TPack m_data;
+};
+static_assert(std::is_standard_layout<Avx2_32_Float>::value && std::is_trivially_copyable<Avx2_32_Float>::value,
+      "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
+
+template<bool bNegateInput, bool bNaNPossible, bool bUnderflowPossible, bool bOverflowPossible>
+inline Avx2_32_Float Exp(const Avx2_32_Float& val) noexcept {
+   return Exp32<Avx2_32_Float, bNegateInput, bNaNPossible, bUnderflowPossible, bOverflowPossible>(val);
+}
+
+template<bool bNegateOutput,
+      bool bNaNPossible,
+      bool bNegativePossible,
+      bool bZeroPossible,
+      bool bPositiveInfinityPossible>
+inline Avx2_32_Float Log(const Avx2_32_Float& val) noexcept {
+   return Log32<Avx2_32_Float, bNegateOutput, bNaNPossible, bNegativePossible, bZeroPossible, bPositiveInfinityPossible>(
+         val);
+}
+
+// a subset can be processed in chunks that begin at any SIMD pack, so the per-sample arrays are only pack aligned
+static constexpr size_t k_cBytesSamplesAlignment = sizeof(Avx2_32_Float::T) * size_t{Avx2_32_Float::k_cSIMDPack};
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm ApplyUpdate_Avx2_32(
+      const ObjectiveWrapper* const pObjectiveWrapper, ApplyUpdateBridge* const pData) {
+   const Objective* const pObjective = static_cast<const Objective*>(pObjectiveWrapper->m_pObjective);
+   const APPLY_UPDATE_CPP pApplyUpdateCpp =
+         (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pApplyUpdateCpp;
+
+   // all our memory should be aligned. It is required by SIMD for correctness or performance
+   EBM_ASSERT(IsAligned(pData->m_aMulticlassMidwayTemp));
+   EBM_ASSERT(IsAligned(pData->m_aUpdateTensorScores));
+   EBM_ASSERT(IsAligned(pData->m_aPacked, k_cBytesSamplesAlignment));
+   EBM_ASSERT(
+         IsAligned(pData->m_aTargets, pObjectiveWrapper->m_cTargetBytes * size_t{Avx2_32_Float::k_cSIMDPack}));
+   EBM_ASSERT(IsAligned(pData->m_aWeights, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pData->m_aSampleScores, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pData->m_aGradientsAndHessians, k_cBytesSamplesAlignment));
+
+   return (*pApplyUpdateCpp)(pObjective, pData);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsBoosting_Avx2_32(
+      const ObjectiveWrapper* const pObjectiveWrapper, BinSumsBoostingBridge* const pParams) {
+   const BIN_SUMS_BOOSTING_CPP pBinSumsBoostingCpp =
+         (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsBoostingCpp;
+
+   // all our memory should be aligned. It is required by SIMD for correctness or performance
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aPacked, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aFastBins));
+
+   return (*pBinSumsBoostingCpp)(pParams);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsInteraction_Avx2_32(
+      const ObjectiveWrapper* const pObjectiveWrapper, BinSumsInteractionBridge* const pParams) {
+   const BIN_SUMS_INTERACTION_CPP pBinSumsInteractionCpp =
+         (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsInteractionCpp;
+
+#ifndef NDEBUG
+   // all our memory should be aligned. It is required by SIMD for correctness or performance
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights));
+   EBM_ASSERT(IsAligned(pParams->m_aFastBins));
+   for(size_t iDebug = 0; iDebug < pParams->m_cRuntimeRealDimensions; ++iDebug) {
+      EBM_ASSERT(IsAligned(pParams->m_aaPacked[iDebug]));
+   }
+#endif // NDEBUG
+
+   return (*pBinSumsInteractionCpp)(pParams);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateObjective_Avx2_32(const Config* const pConfig,
+      const char* const sObjective,
+      const char* const sObjectiveEnd,
+      ObjectiveWrapper* const pObjectiveWrapperOut) {
+   pObjectiveWrapperOut->m_pApplyUpdateC = ApplyUpdate_Avx2_32;
+   pObjectiveWrapperOut->m_pBinSumsBoostingC = BinSumsBoosting_Avx2_32;
+   pObjectiveWrapperOut->m_pBinSumsInteractionC = BinSumsInteraction_Avx2_32;
+   ErrorEbm error = ComputeWrapper<Avx2_32_Float>::FillWrapper(pObjectiveWrapperOut);
+   if(Error_None != error) {
+      return error;
+   }
+   return Objective::CreateObjective<Avx2_32_Float>(pConfig, sObjective, sObjectiveEnd, pObjectiveWrapperOut);
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -424,6 +424,9 @@ inline Cpu_64_Float Log(const Cpu_64_Float& val) noexcept {
          val);
 }
 
+// a subset can be processed in chunks that begin at any SIMD pack, so the per-sample arrays are only pack aligned
+static constexpr size_t k_cBytesSamplesAlignment = sizeof(Cpu_64_Float::T) * size_t{Cpu_64_Float::k_cSIMDPack};
+
 INTERNAL_IMPORT_EXPORT_BODY ErrorEbm ApplyUpdate_Cpu_64(
       const ObjectiveWrapper* const pObjectiveWrapper, ApplyUpdateBridge* const pData) {
    const Objective* const pObjective = static_cast<const Objective*>(pObjectiveWrapper->m_pObjective);
@@ -433,11 +436,12 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm ApplyUpdate_Cpu_64(
    // all our memory should be aligned. It is required by SIMD for correctness or performance
    EBM_ASSERT(IsAligned(pData->m_aMulticlassMidwayTemp));
    EBM_ASSERT(IsAligned(pData->m_aUpdateTensorScores));
-   EBM_ASSERT(IsAligned(pData->m_aPacked));
-   EBM_ASSERT(IsAligned(pData->m_aTargets));
-   EBM_ASSERT(IsAligned(pData->m_aWeights));
-   EBM_ASSERT(IsAligned(pData->m_aSampleScores));
-   EBM_ASSERT(IsAligned(pData->m_aGradientsAndHessians));
+   EBM_ASSERT(IsAligned(pData->m_aPacked, k_cBytesSamplesAlignment));
+   EBM_ASSERT(
+         IsAligned(pData->m_aTargets, pObjectiveWrapper->m_cTargetBytes * size_t{Cpu_64_Float::k_cSIMDPack}));
+   EBM_ASSERT(IsAligned(pData->m_aWeights, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pData->m_aSampleScores, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pData->m_aGradientsAndHessians, k_cBytesSamplesAlignment));
 
    return (*pApplyUpdateCpp)(pObjective, pData);
 }
@@ -448,9 +452,9 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsBoosting_Cpu_64(
          (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsBoostingCpp;
 
    // all our memory should be aligned. It is required by SIMD for correctness or performance
-   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians));
-   EBM_ASSERT(IsAligned(pParams->m_aWeights));
-   EBM_ASSERT(IsAligned(pParams->m_aPacked));
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aPacked, k_cBytesSamplesAlignment));
    EBM_ASSERT(IsAligned(pParams->m_aFastBins));
 
    return (*pBinSumsBoostingCpp)(pParams);
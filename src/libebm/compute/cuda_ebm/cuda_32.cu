@@ -0,0 +1,1202 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <cmath> // expf, logf
+#include <limits> // numeric_limits
+#include <type_traits> // is_unsigned
+#include <string.h> // memcpy
+
+#include <cuda_runtime.h>
+
+#include "libebm.h"
+#include "logging.h"
+#include "unzoned.h"
+
+#define ZONE_cuda
+#include "zones.h"
+
+#include "bridge.h"
+#include "common.hpp"
+#include "bridge.hpp"
+
+#include "Registration.hpp"
+#include "Objective.hpp"
+
+#include "math.hpp"
+#include "approximate_math.hpp"
+#include "compute_wrapper.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+struct Cuda_32_Float;
+struct Cuda_32_Int;
+
+template<bool bNegateInput = false,
+      bool bNaNPossible = true,
+      bool bUnderflowPossible = true,
+      bool bOverflowPossible = true>
+GPU_BOTH inline Cuda_32_Float Exp(const Cuda_32_Float& val) noexcept;
+template<bool bNegateOutput = false,
+      bool bNaNPossible = true,
+      bool bNegativePossible = true,
+      bool bZeroPossible = true,
+      bool bPositiveInfinityPossible = true>
+GPU_BOTH inline Cuda_32_Float Log(const Cuda_32_Float& val) noexcept;
+
+template<typename TObjective,
+      bool bCollapsed,
+      bool bValidation,
+      bool bWeight,
+      bool bHessian,
+      bool bUseApprox,
+      size_t cCompilerScores>
+static cudaError_t CudaApplyUpdate(const Objective* const pObjective, ApplyUpdateBridge* const pData) noexcept;
+template<bool bHessian, bool bWeight, bool bCollapsed, size_t cCompilerScores, bool bParallel>
+static cudaError_t CudaBinSumsBoosting(BinSumsBoostingBridge* const pParams) noexcept;
+template<bool bHessian, bool bWeight, size_t cCompilerScores, size_t cCompilerDimensions>
+static cudaError_t CudaBinSumsInteraction(BinSumsInteractionBridge* const pParams) noexcept;
+static ErrorEbm ErrorFromCuda(const cudaError_t result) noexcept;
+
+// this is super-special and included inside the zone namespace
+#include "objective_registrations.hpp"
+
+// Each GPU thread does the work of one CPU SIMD lane, so the types are scalar like the cpu_64 zone and the parallelism
+// comes from splitting every subset into many small chunks below.
+struct Cuda_32_Int final {
+   friend Cuda_32_Float;
+   friend GPU_BOTH inline Cuda_32_Float IfThenElse(
+         const Cuda_32_Int& cmp, const Cuda_32_Float& trueVal, const Cuda_32_Float& falseVal) noexcept;
+   friend GPU_BOTH inline Cuda_32_Float IfAdd(
+         const Cuda_32_Int& cmp, const Cuda_32_Float& base, const Cuda_32_Float& addend) noexcept;
+
+   using T = uint32_t;
+   using TPack = uint32_t;
+   static_assert(std::is_unsigned<T>::value, "T must be an unsigned integer type");
+   static_assert(
+         std::is_same<UIntBig, T>::value || std::is_same<UIntSmall, T>::value, "T must be either UIntBig or UIntSmall");
+   static constexpr AccelerationFlags k_zone = AccelerationFlags_Nvidia;
+   static constexpr int k_cSIMDShift = 0;
+   static constexpr int k_cSIMDPack = 1 << k_cSIMDShift;
+   static constexpr int k_cTypeShift = 2;
+   static_assert(1 << k_cTypeShift == sizeof(T), "k_cTypeShift must be equivalent to the type size");
+
+   ATTRIBUTE_WARNING_DISABLE_UNINITIALIZED_MEMBER
+   GPU_BOTH inline Cuda_32_Int() noexcept {}
+
+   GPU_BOTH inline Cuda_32_Int(const T& val) noexcept : m_data(val) {}
+
+   GPU_BOTH inline static Cuda_32_Int Load(const T* const a) noexcept { return Cuda_32_Int(*a); }
+
+   GPU_BOTH inline void Store(T* const a) const noexcept { *a = m_data; }
+
+   GPU_BOTH inline static Cuda_32_Int LoadBytes(const uint8_t* const a) noexcept { return Cuda_32_Int(*a); }
+
+   template<typename TFunc, typename... TArgs>
+   GPU_DEVICE static inline void Execute(const TFunc& func, const TArgs&... args) noexcept {
+      func(0, (args.m_data)...);
+   }
+
+   GPU_BOTH inline static Cuda_32_Int MakeIndexes() noexcept { return Cuda_32_Int(0); }
+
+   GPU_BOTH inline Cuda_32_Int operator~() const noexcept { return Cuda_32_Int(~m_data); }
+
+   friend GPU_BOTH inline Cuda_32_Int operator==(const Cuda_32_Int& left, const Cuda_32_Int& right) noexcept {
+      return left.m_data == right.m_data ? Cuda_32_Int{static_cast<uint32_t>(int32_t{-1})} : Cuda_32_Int{0};
+   }
+
+   GPU_BOTH inline Cuda_32_Int operator+(const Cuda_32_Int& other) const noexcept {
+      return Cuda_32_Int(m_data + other.m_data);
+   }
+
+   GPU_BOTH inline Cuda_32_Int operator-(const Cuda_32_Int& other) const noexcept {
+      return Cuda_32_Int(m_data - other.m_data);
+   }
+
+   GPU_BOTH inline Cuda_32_Int operator*(const T& other) const noexcept { return Cuda_32_Int(m_data * other); }
+
+   GPU_BOTH inline Cuda_32_Int operator>>(int shift) const noexcept { return Cuda_32_Int(m_data >> shift); }
+
+   GPU_BOTH inline Cuda_32_Int operator<<(int shift) const noexcept { return Cuda_32_Int(m_data << shift); }
+
+   GPU_BOTH inline Cuda_32_Int operator&(const Cuda_32_Int& other) const noexcept {
+      return Cuda_32_Int(m_data & other.m_data);
+   }
+
+   GPU_BOTH inline Cuda_32_Int operator|(const Cuda_32_Int& other) const noexcept {
+      return Cuda_32_Int(m_data | other.m_data);
+   }
+
+   friend GPU_BOTH inline Cuda_32_Int IfThenElse(
+         const Cuda_32_Int& cmp, const Cuda_32_Int& trueVal, const Cuda_32_Int& falseVal) noexcept {
+      return cmp.m_data ? trueVal : falseVal;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Int IfAdd(
+         const Cuda_32_Int& cmp, const Cuda_32_Int& base, const Cuda_32_Int& addend) noexcept {
+      return cmp.m_data ? base + addend : base;
+   }
+
+ private:
+   TPack m_data;
+};
+static_assert(std::is_standard_layout<Cuda_32_Int>::value && std::is_trivially_copyable<Cuda_32_Int>::value,
+      "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
+
+struct Cuda_32_Float final {
+   template<bool bNegateInput, bool bNaNPossible, bool bUnderflowPossible, bool bOverflowPossible>
+   friend GPU_BOTH Cuda_32_Float Exp(const Cuda_32_Float& val) noexcept;
+   template<bool bNegateOutput,
+         bool bNaNPossible,
+         bool bNegativePossible,
+         bool bZeroPossible,
+         bool bPositiveInfinityPossible>
+   friend GPU_BOTH Cuda_32_Float Log(const Cuda_32_Float& val) noexcept;
+
+   using T = float;
+   using TPack = float;
+   using TInt = Cuda_32_Int;
+   static_assert(std::is_same<FloatBig, T>::value || std::is_same<FloatSmall, T>::value,
+         "T must be either FloatBig or FloatSmall");
+   static constexpr AccelerationFlags k_zone = TInt::k_zone;
+   static constexpr int k_cSIMDShift = TInt::k_cSIMDShift;
+   static constexpr int k_cSIMDPack = TInt::k_cSIMDPack;
+   static constexpr int k_cTypeShift = TInt::k_cTypeShift;
+   static_assert(1 << k_cTypeShift == sizeof(T), "k_cTypeShift must be equivalent to the type size");
+
+   ATTRIBUTE_WARNING_DISABLE_UNINITIALIZED_MEMBER
+   GPU_BOTH inline Cuda_32_Float() noexcept {}
+
+   GPU_BOTH inline Cuda_32_Float(const double val) noexcept : m_data(static_cast<T>(val)) {}
+   GPU_BOTH inline Cuda_32_Float(const float val) noexcept : m_data(static_cast<T>(val)) {}
+   GPU_BOTH inline Cuda_32_Float(const int val) noexcept : m_data(static_cast<T>(val)) {}
+   GPU_BOTH inline Cuda_32_Float(const int64_t val) noexcept : m_data(static_cast<T>(val)) {}
+   GPU_BOTH explicit Cuda_32_Float(const Cuda_32_Int& val) : m_data(static_cast<T>(val.m_data)) {}
+
+   GPU_BOTH inline Cuda_32_Float operator+() const noexcept { return *this; }
+
+   GPU_BOTH inline Cuda_32_Float operator-() const noexcept { return Cuda_32_Float(-m_data); }
+
+   GPU_BOTH inline Cuda_32_Float operator+(const Cuda_32_Float& other) const noexcept {
+      return Cuda_32_Float(m_data + other.m_data);
+   }
+
+   GPU_BOTH inline Cuda_32_Float operator-(const Cuda_32_Float& other) const noexcept {
+      return Cuda_32_Float(m_data - other.m_data);
+   }
+
+   GPU_BOTH inline Cuda_32_Float operator*(const Cuda_32_Float& other) const noexcept {
+      return Cuda_32_Float(m_data * other.m_data);
+   }
+
+   GPU_BOTH inline Cuda_32_Float operator/(const Cuda_32_Float& other) const noexcept {
+      return Cuda_32_Float(m_data / other.m_data);
+   }
+
+   GPU_BOTH inline Cuda_32_Float& operator+=(const Cuda_32_Float& other) noexcept {
+      *this = (*this) + other;
+      return *this;
+   }
+
+   GPU_BOTH inline Cuda_32_Float& operator-=(const Cuda_32_Float& other) noexcept {
+      *this = (*this) - other;
+      return *this;
+   }
+
+   GPU_BOTH inline Cuda_32_Float& operator*=(const Cuda_32_Float& other) noexcept {
+      *this = (*this) * other;
+      return *this;
+   }
+
+   GPU_BOTH inline Cuda_32_Float& operator/=(const Cuda_32_Float& other) noexcept {
+      *this = (*this) / other;
+      return *this;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float operator+(const double val, const Cuda_32_Float& other) noexcept {
+      return Cuda_32_Float(val) + other;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float operator-(const double val, const Cuda_32_Float& other) noexcept {
+      return Cuda_32_Float(val) - other;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float operator*(const double val, const Cuda_32_Float& other) noexcept {
+      return Cuda_32_Float(val) * other;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float operator/(const double val, const Cuda_32_Float& other) noexcept {
+      return Cuda_32_Float(val) / other;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float operator+(const float val, const Cuda_32_Float& other) noexcept {
+      return Cuda_32_Float(val) + other;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float operator-(const float val, const Cuda_32_Float& other) noexcept {
+      return Cuda_32_Float(val) - other;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float operator*(const float val, const Cuda_32_Float& other) noexcept {
+      return Cuda_32_Float(val) * other;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float operator/(const float val, const Cuda_32_Float& other) noexcept {
+      return Cuda_32_Float(val) / other;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Int operator==(const Cuda_32_Float& left, const Cuda_32_Float& right) noexcept {
+      return left.m_data == right.m_data ? Cuda_32_Int{static_cast<uint32_t>(int32_t{-1})} : Cuda_32_Int{0};
+   }
+
+   friend GPU_BOTH inline Cuda_32_Int operator<(const Cuda_32_Float& left, const Cuda_32_Float& right) noexcept {
+      return left.m_data < right.m_data ? Cuda_32_Int{static_cast<uint32_t>(int32_t{-1})} : Cuda_32_Int{0};
+   }
+
+   friend GPU_BOTH inline Cuda_32_Int operator<=(const Cuda_32_Float& left, const Cuda_32_Float& right) noexcept {
+      return left.m_data <= right.m_data ? Cuda_32_Int{static_cast<uint32_t>(int32_t{-1})} : Cuda_32_Int{0};
+   }
+
+   GPU_BOTH inline static Cuda_32_Float Load(const T* const a) noexcept { return Cuda_32_Float(*a); }
+
+   GPU_BOTH inline void Store(T* const a) const noexcept { *a = m_data; }
+
+   template<int cShift = k_cTypeShift>
+   GPU_BOTH inline static Cuda_32_Float Load(const T* const a, const TInt& i) noexcept {
+      return Cuda_32_Float(*IndexByte(a, static_cast<size_t>(i.m_data) << cShift));
+   }
+
+   template<int cShift = k_cTypeShift> GPU_BOTH inline void Store(T* const a, const TInt& i) const noexcept {
+      *IndexByte(a, static_cast<size_t>(i.m_data) << cShift) = m_data;
+   }
+
+   template<typename TFunc>
+   friend GPU_DEVICE inline Cuda_32_Float ApplyFunc(const TFunc& func, const Cuda_32_Float& val) noexcept {
+      return Cuda_32_Float(func(val.m_data));
+   }
+
+   template<typename TFunc, typename... TArgs>
+   GPU_DEVICE static inline void Execute(const TFunc& func, const TArgs&... args) noexcept {
+      func(0, (args.m_data)...);
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float IfThenElse(
+         const Cuda_32_Int& cmp, const Cuda_32_Float& trueVal, const Cuda_32_Float& falseVal) noexcept {
+      return cmp.m_data ? trueVal : falseVal;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float IfAdd(
+         const Cuda_32_Int& cmp, const Cuda_32_Float& base, const Cuda_32_Float& addend) noexcept {
+      return cmp.m_data ? base + addend : base;
+   }
+
+   friend GPU_BOTH inline Cuda_32_Int IsNaN(const Cuda_32_Float& cmp) noexcept {
+      // NaN is the only value that is unequal to itself, and this avoids picking between std::isnan and CUDA's isnan
+      return cmp.m_data != cmp.m_data ? Cuda_32_Int{static_cast<uint32_t>(int32_t{-1})} : Cuda_32_Int{0};
+   }
+
+   GPU_BOTH static inline Cuda_32_Int ReinterpretInt(const Cuda_32_Float& val) noexcept {
+      typename Cuda_32_Int::T mem;
+      memcpy(&mem, &val.m_data, sizeof(T));
+      return Cuda_32_Int(mem);
+   }
+
+   GPU_BOTH static inline Cuda_32_Float ReinterpretFloat(const Cuda_32_Int& val) noexcept {
+      T mem;
+      memcpy(&mem, &val.m_data, sizeof(T));
+      return Cuda_32_Float(mem);
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float Round(const Cuda_32_Float& val) noexcept {
+      return Cuda_32_Float(roundf(val.m_data));
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float Abs(const Cuda_32_Float& val) noexcept {
+      return Cuda_32_Float(fabsf(val.m_data));
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float FastApproxReciprocal(const Cuda_32_Float& val) noexcept {
+      return Cuda_32_Float(T{1.0} / val.m_data);
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float FastApproxDivide(
+         const Cuda_32_Float& dividend, const Cuda_32_Float& divisor) noexcept {
+      return Cuda_32_Float(dividend.m_data / divisor.m_data);
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float FusedMultiplyAdd(
+         const Cuda_32_Float& mul1, const Cuda_32_Float& mul2, const Cuda_32_Float& add) noexcept {
+      return Cuda_32_Float(fmaf(mul1.m_data, mul2.m_data, add.m_data));
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float FusedNegateMultiplyAdd(
+         const Cuda_32_Float& mul1, const Cuda_32_Float& mul2, const Cuda_32_Float& add) noexcept {
+      return Cuda_32_Float(fmaf(-mul1.m_data, mul2.m_data, add.m_data));
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float FusedMultiplySubtract(
+         const Cuda_32_Float& mul1, const Cuda_32_Float& mul2, const Cuda_32_Float& subtract) noexcept {
+      return Cuda_32_Float(fmaf(mul1.m_data, mul2.m_data, -subtract.m_data));
+   }
+
+   friend GPU_BOTH inline Cuda_32_Float Sqrt(const Cuda_32_Float& val) noexcept {
+      return Cuda_32_Float(sqrtf(val.m_data));
+   }
+
+   template<bool bUseApprox,
+         bool bNegateInput = false,
+         bool bNaNPossible = true,
+         bool bUnderflowPossible = true,
+         bool bOverflowPossible = true,
+         bool bSpecialCaseZero = false,
+         typename std::enable_if<!bUseApprox, int>::type = 0>
+   GPU_BOTH static inline Cuda_32_Float ApproxExp(const Cuda_32_Float& val,
+         const int32_t addExpSchraudolphTerm = k_expTermZeroMeanErrorForSoftmaxWithZeroedLogit) noexcept {
+      UNUSED(addExpSchraudolphTerm);
+      return Exp<bNegateInput, bNaNPossible, bUnderflowPossible, bOverflowPossible>(val);
+   }
+
+   template<bool bUseApprox,
+         bool bNegateInput = false,
+         bool bNaNPossible = true,
+         bool bUnderflowPossible = true,
+         bool bOverflowPossible = true,
+         bool bSpecialCaseZero = false,
+         typename std::enable_if<bUseApprox, int>::type = 0>
+   GPU_DEVICE static inline Cuda_32_Float ApproxExp(const Cuda_32_Float& val,
+         const int32_t addExpSchraudolphTerm = k_expTermZeroMeanErrorForSoftmaxWithZeroedLogit) noexcept {
+      return Cuda_32_Float(
+            ExpApproxSchraudolph<bNegateInput, bNaNPossible, bUnderflowPossible, bOverflowPossible, bSpecialCaseZero>(
+                  val.m_data, addExpSchraudolphTerm));
+   }
+
+   template<bool bUseApprox,
+         bool bNegateOutput = false,
+         bool bNaNPossible = true,
+         bool bNegativePossible = true,
+         bool bZeroPossible = true, // if false, positive zero returns a big negative number, negative zero returns a
+                                    // big positive number
+         bool bPositiveInfinityPossible = true, // if false, +inf returns a big positive number.  If val can be a
+                                                // double that is above the largest representable float, then setting
+                                                // this is necessary to avoid undefined behavior
+         typename std::enable_if<!bUseApprox, int>::type = 0>
+   GPU_BOTH static inline Cuda_32_Float ApproxLog(
+         const Cuda_32_Float& val, const float addLogSchraudolphTerm = k_logTermLowerBoundInputCloseToOne) noexcept {
+      UNUSED(addLogSchraudolphTerm);
+      return Log<bNegateOutput, bNaNPossible, bNegativePossible, bZeroPossible, bPositiveInfinityPossible>(val);
+   }
+
+   template<bool bUseApprox,
+         bool bNegateOutput = false,
+         bool bNaNPossible = true,
+         bool bNegativePossible = true,
+         bool bZeroPossible = true, // if false, positive zero returns a big negative number, negative zero returns a
+                                    // big positive number
+         bool bPositiveInfinityPossible = true, // if false, +inf returns a big positive number.  If val can be a
+                                                // double that is above the largest representable float, then setting
+                                                // this is necessary to avoid undefined behavior
+         typename std::enable_if<bUseApprox, int>::type = 0>
+   GPU_DEVICE static inline Cuda_32_Float ApproxLog(
+         const Cuda_32_Float& val, const float addLogSchraudolphTerm = k_logTermLowerBoundInputCloseToOne) noexcept {
+      return Cuda_32_Float(LogApproxSchraudolph<bNegateOutput,
+            bNaNPossible,
+            bNegativePossible,
+            bZeroPossible,
+            bPositiveInfinityPossible>(val.m_data, addLogSchraudolphTerm));
+   }
+
+   friend GPU_BOTH inline T Sum(const Cuda_32_Float& val) noexcept { return val.m_data; }
+
+   template<typename TObjective,
+         bool bCollapsed,
+         bool bValidation,
+         bool bWeight,
+         bool bHessian,
+         bool bUseApprox,
+         size_t cCompilerScores>
+   INLINE_RELEASE_TEMPLATED static ErrorEbm OperatorApplyUpdate(
+         const Objective* const pObjective, ApplyUpdateBridge* const pData) noexcept {
+      return ErrorFromCuda(
+            CudaApplyUpdate<TObjective, bCollapsed, bValidation, bWeight, bHessian, bUseApprox, cCompilerScores>(
+                  pObjective, pData));
+   }
+
+   template<bool bHessian, bool bWeight, bool bCollapsed, size_t cCompilerScores, bool bParallel>
+   INLINE_RELEASE_TEMPLATED static ErrorEbm OperatorBinSumsBoosting(BinSumsBoostingBridge* const pParams) noexcept {
+      return ErrorFromCuda(CudaBinSumsBoosting<bHessian, bWeight, bCollapsed, cCompilerScores, bParallel>(pParams));
+   }
+
+   template<bool bHessian, bool bWeight, size_t cCompilerScores, size_t cCompilerDimensions>
+   INLINE_RELEASE_TEMPLATED static ErrorEbm OperatorBinSumsInteraction(
+         BinSumsInteractionBridge* const pParams) noexcept {
+      return ErrorFromCuda(CudaBinSumsInteraction<bHessian, bWeight, cCompilerScores, cCompilerDimensions>(pParams));
+   }
+
+ private:
+   TPack m_data;
+};
+static_assert(std::is_standard_layout<Cuda_32_Float>::value && std::is_trivially_copyable<Cuda_32_Float>::value,
+      "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
+
+// expf and logf exist on both the host and the device, and the device versions are already accurate to a few ulps, so
+// there is no benefit in the bit manipulating polynomials that the SIMD zones use
+template<bool bNegateInput, bool bNaNPossible, bool bUnderflowPossible, bool bOverflowPossible>
+GPU_BOTH inline Cuda_32_Float Exp(const Cuda_32_Float& val) noexcept {
+   return Cuda_32_Float(expf(bNegateInput ? -val.m_data : val.m_data));
+}
+
+template<bool bNegateOutput,
+      bool bNaNPossible,
+      bool bNegativePossible,
+      bool bZeroPossible,
+      bool bPositiveInfinityPossible>
+GPU_BOTH inline Cuda_32_Float Log(const Cuda_32_Float& val) noexcept {
+   const float result = logf(val.m_data);
+   return Cuda_32_Float(bNegateOutput ? -result : result);
+}
+
+// Every launch splits its subset into one contiguous chunk per GPU thread. The chunks use the same layout as the
+// chunked CPU paths: the first chunk takes the remainder and every later chunk is a whole number of bit packs, so
+// each chunk starts on a pack boundary of the DataSetBoosting term data and the kernels need no changes.
+static constexpr size_t k_cThreadsPerBlock = 256;
+static constexpr size_t k_cThreadsMax = 65536;
+// fewer items than this per thread and the per-thread setup costs more than the items
+static constexpr size_t k_cItemsPerThreadMin = 32;
+// each thread sums into its own copy of the fast bins, which are then summed in float64, so this bounds the device
+// memory that those copies take
+static constexpr size_t k_cBytesThreadBinsMax = size_t{64} << 20;
+// each thread also keeps its own validation AUC histogram, and those are 64KB each
+static constexpr size_t k_cThreadsAucMax = 256;
+// cudaMalloc aligns to 256 bytes, and we keep every region that we carve out of the scratch buffer aligned the same
+static constexpr size_t k_cBytesDeviceAlignment = 256;
+
+// The boosting threads call into this zone concurrently on different subsets, so each host thread keeps its own
+// scratch buffers, which grow to the largest call seen, and launches its work on its own per-thread default stream.
+class CudaScratch final {
+   const bool m_bDevice;
+   void* m_p;
+   size_t m_cBytes;
+
+   inline void Release() noexcept {
+      if(nullptr != m_p) {
+         // at process exit the CUDA runtime may already be gone, and there is nothing to do about a failure here
+         if(m_bDevice) {
+            cudaFree(m_p);
+         } else {
+            cudaFreeHost(m_p);
+         }
+         m_p = nullptr;
+         m_cBytes = 0;
+      }
+   }
+
+ public:
+   inline explicit CudaScratch(const bool bDevice) noexcept : m_bDevice(bDevice), m_p(nullptr), m_cBytes(0) {}
+   inline ~CudaScratch() noexcept { Release(); }
+   CudaScratch(const CudaScratch&) = delete;
+   CudaScratch& operator=(const CudaScratch&) = delete;
+
+   inline void* Get(const size_t cBytes) noexcept {
+      if(m_cBytes < cBytes) {
+         Release();
+         void* p = nullptr;
+         // the host buffer is pinned so that the final copies back to the host can run asynchronously
+         const cudaError_t result = m_bDevice ? cudaMalloc(&p, cBytes) : cudaMallocHost(&p, cBytes);
+         if(cudaSuccess != result) {
+            return nullptr;
+         }
+         m_p = p;
+         m_cBytes = cBytes;
+      }
+      return m_p;
+   }
+};
+
+static thread_local CudaScratch g_deviceScratch(true);
+static thread_local CudaScratch g_hostScratch(false);
+
+static ErrorEbm ErrorFromCuda(const cudaError_t result) noexcept {
+   if(cudaSuccess == result) {
+      return Error_None;
+   }
+   LOG_N(Trace_Warning, "WARNING ErrorFromCuda CUDA returned %s", cudaGetErrorString(result));
+   return cudaErrorMemoryAllocation == result ? Error_OutOfMemory : Error_UnexpectedInternal;
+}
+
+inline static size_t Reserve(size_t* const pcBytesScratch, const size_t cBytes) noexcept {
+   const size_t iBytes = *pcBytesScratch;
+   *pcBytesScratch =
+         iBytes + (cBytes + (k_cBytesDeviceAlignment - 1)) / k_cBytesDeviceAlignment * k_cBytesDeviceAlignment;
+   return iBytes;
+}
+
+inline static size_t GetChunkItems(
+      const size_t cItems, const size_t cThreadsMax, const size_t cItemsPerBitPack) noexcept {
+   EBM_ASSERT(1 <= cItems);
+   EBM_ASSERT(1 <= cThreadsMax);
+   EBM_ASSERT(1 <= cItemsPerBitPack);
+   const size_t cItemsPerThread = EbmMax((cItems - size_t{1}) / cThreadsMax + size_t{1}, k_cItemsPerThreadMin);
+   return (cItemsPerThread - size_t{1}) / cItemsPerBitPack * cItemsPerBitPack + cItemsPerBitPack;
+}
+
+inline static unsigned int GetBlocks(const size_t cThreads) noexcept {
+   return static_cast<unsigned int>((cThreads - size_t{1}) / k_cThreadsPerBlock + size_t{1});
+}
+
+GPU_DEVICE inline static size_t GetThreadIndex() noexcept {
+   return static_cast<size_t>(blockIdx.x) * static_cast<size_t>(blockDim.x) + static_cast<size_t>(threadIdx.x);
+}
+
+GPU_DEVICE inline static size_t GetChunk(
+      const size_t cItems, const size_t cChunkItems, const size_t iThread, size_t* const pcChunkItemsOut) noexcept {
+   const size_t cFirstChunkItems = cItems - (cItems - size_t{1}) / cChunkItems * cChunkItems;
+   if(size_t{0} == iThread) {
+      *pcChunkItemsOut = cFirstChunkItems;
+      return 0;
+   }
+   *pcChunkItemsOut = cChunkItems;
+   return cFirstChunkItems + (iThread - size_t{1}) * cChunkItems;
+}
+
+// The arrays of the data subsets come from AlignedAlloc_Cuda_32, so they are already resident on the device. Other
+// buffers like the update tensor, the interaction detector's initial scores and the temporary buffers of compressed
+// gradients are ordinary host memory, which we copy into the device scratch buffer before the launch and back again.
+struct Staged final {
+   void* m_pHost;
+   size_t m_cBytes; // zero if the device reads m_pHost in place
+   size_t m_iScratch;
+};
+
+static bool IsDeviceAccessible(const void* const p) noexcept {
+   cudaPointerAttributes attributes;
+   if(cudaSuccess != cudaPointerGetAttributes(&attributes, p)) {
+      // older runtimes fail on unregistered host memory, so clear the error before the next call sees it
+      cudaGetLastError();
+      return false;
+   }
+   return cudaMemoryTypeDevice == attributes.type || cudaMemoryTypeManaged == attributes.type;
+}
+
+inline static void PlanStaged(
+      Staged* const pStaged, const void* const pHost, const size_t cBytes, size_t* const pcBytesScratch) noexcept {
+   pStaged->m_pHost = const_cast<void*>(pHost);
+   pStaged->m_cBytes = 0;
+   pStaged->m_iScratch = 0;
+   if(nullptr != pHost && !IsDeviceAccessible(pHost)) {
+      pStaged->m_cBytes = cBytes;
+      pStaged->m_iScratch = Reserve(pcBytesScratch, cBytes);
+   }
+}
+
+inline static void* StageIn(
+      const Staged* const pStaged, unsigned char* const aScratch, cudaError_t* const pResult) noexcept {
+   if(size_t{0} == pStaged->m_cBytes) {
+      return pStaged->m_pHost;
+   }
+   void* const pDevice = aScratch + pStaged->m_iScratch;
+   if(cudaSuccess == *pResult) {
+      *pResult = cudaMemcpyAsync(
+            pDevice, pStaged->m_pHost, pStaged->m_cBytes, cudaMemcpyHostToDevice, cudaStreamPerThread);
+   }
+   return pDevice;
+}
+
+inline static void StageOut(
+      const Staged* const pStaged, const unsigned char* const aScratch, cudaError_t* const pResult) noexcept {
+   if(size_t{0} != pStaged->m_cBytes && cudaSuccess == *pResult) {
+      *pResult = cudaMemcpyAsync(pStaged->m_pHost,
+            aScratch + pStaged->m_iScratch,
+            pStaged->m_cBytes,
+            cudaMemcpyDeviceToHost,
+            cudaStreamPerThread);
+   }
+}
+
+// sums the cCopies consecutive copies of an array into the first copy
+template<typename T>
+GPU_GLOBAL static void CudaSumCopiesKernel(T* const a, const size_t cItems, const size_t cCopies) {
+   const size_t iItem = GetThreadIndex();
+   if(cItems <= iItem) {
+      return;
+   }
+   const T* p = &a[iItem];
+   const T* const pEnd = p + cItems * cCopies;
+   double sum = 0.0;
+   do {
+      sum += static_cast<double>(*p);
+      p += cItems;
+   } while(pEnd != p);
+   a[iItem] = static_cast<T>(sum);
+}
+
+template<typename TObjective> GPU_BOTH inline constexpr static size_t GetTargetBytes() {
+   // the same as the m_cTargetBytes that FillObjectiveWrapper reports for this objective
+   return Task_GeneralClassification == TObjective::k_task ?
+         (TObjective::k_bByteTargets ? sizeof(uint8_t) : sizeof(Cuda_32_Int::T)) :
+         sizeof(Cuda_32_Float::T);
+}
+
+template<typename TObjective,
+      bool bCollapsed,
+      bool bValidation,
+      bool bWeight,
+      bool bHessian,
+      bool bUseApprox,
+      size_t cCompilerScores>
+GPU_GLOBAL static void CudaApplyUpdateKernel(const Objective* const pObjective,
+      const ApplyUpdateBridge* const pData,
+      const size_t cThreads,
+      const size_t cChunkItems,
+      const size_t cItemsPerBitPack,
+      double* const aMetrics) {
+   const size_t iThread = GetThreadIndex();
+   if(cThreads <= iThread) {
+      return;
+   }
+   size_t cChunkItemsCur;
+   const size_t iItem = GetChunk(pData->m_cSamples, cChunkItems, iThread, &cChunkItemsCur);
+
+   const size_t cScores = pData->m_cScores;
+   ApplyUpdateBridge data = *pData;
+   data.m_cSamples = cChunkItemsCur;
+   if(nullptr != pData->m_aMulticlassMidwayTemp) {
+      data.m_aMulticlassMidwayTemp =
+            IndexByte(pData->m_aMulticlassMidwayTemp, sizeof(Cuda_32_Float::T) * cScores * iThread);
+   }
+   if(nullptr != pData->m_aPacked) {
+      data.m_aPacked = IndexByte(pData->m_aPacked, sizeof(Cuda_32_Int::T) * (iItem / cItemsPerBitPack));
+   }
+   if(nullptr != pData->m_aTargets) {
+      data.m_aTargets = IndexByte(pData->m_aTargets, GetTargetBytes<TObjective>() * iItem);
+   }
+   if(nullptr != pData->m_aWeights) {
+      data.m_aWeights = IndexByte(pData->m_aWeights, sizeof(Cuda_32_Float::T) * iItem);
+   }
+   if(nullptr != pData->m_aSampleScores) {
+      data.m_aSampleScores = IndexByte(pData->m_aSampleScores, sizeof(Cuda_32_Float::T) * cScores * iItem);
+   }
+   if(nullptr != pData->m_aGradientsAndHessians) {
+      data.m_aGradientsAndHessians = IndexByte(pData->m_aGradientsAndHessians,
+            sizeof(Cuda_32_Float::T) * (EBM_FALSE != pData->m_bHessianNeeded ? size_t{2} : size_t{1}) * cScores *
+                  iItem);
+   }
+   if(nullptr != pData->m_aAucBins) {
+      data.m_aAucBins = pData->m_aAucBins + size_t{2} * size_t{AUC_BINS_COUNT} * iThread;
+   }
+   data.m_metricOut = 0.0;
+
+   ApplyBitpacking<TObjective, bCollapsed, bValidation, bWeight, bHessian, bUseApprox, cCompilerScores>(
+         pObjective, &data);
+
+   aMetrics[iThread] = data.m_metricOut;
+}
+
+template<typename TObjective,
+      bool bCollapsed,
+      bool bValidation,
+      bool bWeight,
+      bool bHessian,
+      bool bUseApprox,
+      size_t cCompilerScores>
+static cudaError_t CudaApplyUpdate(const Objective* const pObjective, ApplyUpdateBridge* const pData) noexcept {
+   static_assert(std::is_trivially_copyable<TObjective>::value, "the objective is copied to the device bytewise");
+
+   const size_t cScores = pData->m_cScores;
+   const size_t cItems = pData->m_cSamples;
+   EBM_ASSERT(1 <= cItems);
+   const size_t cItemsPerBitPack = bCollapsed || k_cItemsPerBitPackUndefined == pData->m_cPack ?
+         size_t{1} :
+         static_cast<size_t>(pData->m_cPack);
+   const size_t cChunkItems =
+         GetChunkItems(cItems, nullptr == pData->m_aAucBins ? k_cThreadsMax : k_cThreadsAucMax, cItemsPerBitPack);
+   const size_t cThreads = (cItems - size_t{1}) / cChunkItems + size_t{1};
+
+   const size_t cBytesScores = sizeof(Cuda_32_Float::T) * cScores * cItems;
+   const size_t cBytesAucBins = sizeof(double) * size_t{2} * size_t{AUC_BINS_COUNT};
+
+   size_t cBytesScratch = 0;
+   const size_t iObjective = Reserve(&cBytesScratch, sizeof(TObjective));
+   const size_t iBridge = Reserve(&cBytesScratch, sizeof(ApplyUpdateBridge));
+   const size_t iMetrics = Reserve(&cBytesScratch, sizeof(double) * cThreads);
+   const size_t iMidway = Reserve(&cBytesScratch,
+         nullptr == pData->m_aMulticlassMidwayTemp ? size_t{0} : sizeof(Cuda_32_Float::T) * cScores * cThreads);
+   const size_t iAucBins = Reserve(&cBytesScratch, nullptr == pData->m_aAucBins ? size_t{0} : cBytesAucBins * cThreads);
+
+   Staged update;
+   PlanStaged(&update,
+         pData->m_aUpdateTensorScores,
+         sizeof(Cuda_32_Float::T) * cScores * pData->m_cTensorBins,
+         &cBytesScratch);
+   Staged packed;
+   PlanStaged(&packed,
+         bCollapsed ? nullptr : pData->m_aPacked,
+         sizeof(Cuda_32_Int::T) * (cItems / cItemsPerBitPack + size_t{1}),
+         &cBytesScratch);
+   Staged targets;
+   PlanStaged(&targets, pData->m_aTargets, GetTargetBytes<TObjective>() * cItems, &cBytesScratch);
+   Staged weights;
+   PlanStaged(&weights, pData->m_aWeights, sizeof(Cuda_32_Float::T) * cItems, &cBytesScratch);
+   Staged scores;
+   PlanStaged(&scores, pData->m_aSampleScores, cBytesScores, &cBytesScratch);
+   Staged gradHess;
+   PlanStaged(&gradHess,
+         pData->m_aGradientsAndHessians,
+         cBytesScores * (EBM_FALSE != pData->m_bHessianNeeded ? size_t{2} : size_t{1}),
+         &cBytesScratch);
+
+   unsigned char* const aScratch = static_cast<unsigned char*>(g_deviceScratch.Get(cBytesScratch));
+   if(nullptr == aScratch) {
+      return cudaErrorMemoryAllocation;
+   }
+   double* const aMetrics = static_cast<double*>(g_hostScratch.Get(sizeof(double) * cThreads));
+   if(nullptr == aMetrics) {
+      return cudaErrorMemoryAllocation;
+   }
+
+   cudaError_t result = cudaMemcpyAsync(
+         aScratch + iObjective, pObjective, sizeof(TObjective), cudaMemcpyHostToDevice, cudaStreamPerThread);
+
+   ApplyUpdateBridge data = *pData;
+   data.m_aMulticlassMidwayTemp = nullptr == pData->m_aMulticlassMidwayTemp ? nullptr : aScratch + iMidway;
+   data.m_aUpdateTensorScores = StageIn(&update, aScratch, &result);
+   data.m_aPacked = StageIn(&packed, aScratch, &result);
+   data.m_aTargets = StageIn(&targets, aScratch, &result);
+   data.m_aWeights = StageIn(&weights, aScratch, &result);
+   data.m_aSampleScores = StageIn(&scores, aScratch, &result);
+   data.m_aGradientsAndHessians = StageIn(&gradHess, aScratch, &result);
+   double* const aAucBins = nullptr == pData->m_aAucBins ? nullptr : reinterpret_cast<double*>(aScratch + iAucBins);
+   data.m_aAucBins = aAucBins;
+   if(nullptr != aAucBins && cudaSuccess == result) {
+      // the first copy continues the caller's histogram and the others start from zero
+      result = cudaMemcpyAsync(
+            aAucBins, pData->m_aAucBins, cBytesAucBins, cudaMemcpyHostToDevice, cudaStreamPerThread);
+      if(cudaSuccess == result && size_t{1} < cThreads) {
+         result = cudaMemsetAsync(IndexByte(aAucBins, cBytesAucBins),
+               0,
+               cBytesAucBins * (cThreads - size_t{1}),
+               cudaStreamPerThread);
+      }
+   }
+   if(cudaSuccess == result) {
+      result = cudaMemcpyAsync(
+            aScratch + iBridge, &data, sizeof(data), cudaMemcpyHostToDevice, cudaStreamPerThread);
+   }
+   if(cudaSuccess != result) {
+      return result;
+   }
+
+   CudaApplyUpdateKernel<TObjective, bCollapsed, bValidation, bWeight, bHessian, bUseApprox, cCompilerScores>
+         <<<GetBlocks(cThreads), k_cThreadsPerBlock, 0, cudaStreamPerThread>>>(
+               reinterpret_cast<const Objective*>(aScratch + iObjective),
+               reinterpret_cast<const ApplyUpdateBridge*>(aScratch + iBridge),
+               cThreads,
+               cChunkItems,
+               cItemsPerBitPack,
+               reinterpret_cast<double*>(aScratch + iMetrics));
+   result = cudaGetLastError();
+
+   if(nullptr != aAucBins && cudaSuccess == result) {
+      if(size_t{1} < cThreads) {
+         CudaSumCopiesKernel<double><<<GetBlocks(size_t{2} * size_t{AUC_BINS_COUNT}),
+               k_cThreadsPerBlock,
+               0,
+               cudaStreamPerThread>>>(aAucBins, size_t{2} * size_t{AUC_BINS_COUNT}, cThreads);
+         result = cudaGetLastError();
+      }
+      if(cudaSuccess == result) {
+         result = cudaMemcpyAsync(
+               pData->m_aAucBins, aAucBins, cBytesAucBins, cudaMemcpyDeviceToHost, cudaStreamPerThread);
+      }
+   }
+   StageOut(&scores, aScratch, &result);
+   StageOut(&gradHess, aScratch, &result);
+   if(cudaSuccess == result) {
+      result = cudaMemcpyAsync(aMetrics,
+            aScratch + iMetrics,
+            sizeof(double) * cThreads,
+            cudaMemcpyDeviceToHost,
+            cudaStreamPerThread);
+   }
+   const cudaError_t resultSynchronize = cudaStreamSynchronize(cudaStreamPerThread);
+   if(cudaSuccess != result) {
+      return result;
+   }
+   if(cudaSuccess != resultSynchronize) {
+      return resultSynchronize;
+   }
+
+   // summed in chunk order on the host so that the metric does not depend on the order that the threads finish
+   double metric = 0.0;
+   for(size_t iThread = 0; iThread < cThreads; ++iThread) {
+      metric += aMetrics[iThread];
+   }
+   pData->m_metricOut += metric;
+   return cudaSuccess;
+}
+
+template<bool bHessian, bool bWeight, bool bCollapsed, size_t cCompilerScores, bool bParallel>
+GPU_GLOBAL static void CudaBinSumsBoostingKernel(const BinSumsBoostingBridge* const pParams,
+      const size_t cThreads,
+      const size_t cChunkItems,
+      const size_t cItemsPerBitPack) {
+   const size_t iThread = GetThreadIndex();
+   if(cThreads <= iThread) {
+      return;
+   }
+   size_t cChunkItemsCur;
+   const size_t iItem = GetChunk(pParams->m_cSamples, cChunkItems, iThread, &cChunkItemsCur);
+
+   BinSumsBoostingBridge params = *pParams;
+   params.m_cSamples = cChunkItemsCur;
+   params.m_aGradientsAndHessians = IndexByte(pParams->m_aGradientsAndHessians,
+         sizeof(Cuda_32_Float::T) * (bHessian ? size_t{2} : size_t{1}) * pParams->m_cScores * iItem);
+   if(bWeight) {
+      params.m_aWeights = IndexByte(pParams->m_aWeights, sizeof(Cuda_32_Float::T) * iItem);
+   }
+   if(!bCollapsed) {
+      params.m_aPacked = IndexByte(pParams->m_aPacked, sizeof(Cuda_32_Int::T) * (iItem / cItemsPerBitPack));
+   }
+   params.m_aFastBins = IndexByte(pParams->m_aFastBins, pParams->m_cBytesFastBins * iThread);
+#ifndef NDEBUG
+   params.m_pDebugFastBinsEnd = IndexByte(params.m_aFastBins, pParams->m_cBytesFastBins);
+#endif // NDEBUG
+
+   BitPackBoosting<Cuda_32_Float, bHessian, bWeight, bCollapsed, cCompilerScores, bParallel>(&params);
+}
+
+template<bool bHessian, bool bWeight, bool bCollapsed, size_t cCompilerScores, bool bParallel>
+static cudaError_t CudaBinSumsBoosting(BinSumsBoostingBridge* const pParams) noexcept {
+   const size_t cItems = pParams->m_cSamples;
+   EBM_ASSERT(1 <= cItems);
+   const size_t cItemsPerBitPack = bCollapsed || k_cItemsPerBitPackUndefined == pParams->m_cPack ?
+         size_t{1} :
+         static_cast<size_t>(pParams->m_cPack);
+   // the boosting fast bins only hold floats, so the copies can be summed as one flat array of floats
+   const size_t cBytesFastBins = pParams->m_cBytesFastBins;
+   EBM_ASSERT(0 == cBytesFastBins % sizeof(Cuda_32_Float::T));
+   const size_t cThreadsMax = EbmMin(k_cThreadsMax, EbmMax(size_t{1}, k_cBytesThreadBinsMax / cBytesFastBins));
+   const size_t cChunkItems = GetChunkItems(cItems, cThreadsMax, cItemsPerBitPack);
+   const size_t cThreads = (cItems - size_t{1}) / cChunkItems + size_t{1};
+
+   size_t cBytesScratch = 0;
+   const size_t iBridge = Reserve(&cBytesScratch, sizeof(BinSumsBoostingBridge));
+   const size_t iFastBins = Reserve(&cBytesScratch, cBytesFastBins * cThreads);
+
+   Staged gradHess;
+   PlanStaged(&gradHess,
+         pParams->m_aGradientsAndHessians,
+         sizeof(Cuda_32_Float::T) * (bHessian ? size_t{2} : size_t{1}) * pParams->m_cScores * cItems,
+         &cBytesScratch);
+   Staged weights;
+   PlanStaged(&weights, bWeight ? pParams->m_aWeights : nullptr, sizeof(Cuda_32_Float::T) * cItems, &cBytesScratch);
+   Staged packed;
+   PlanStaged(&packed,
+         bCollapsed ? nullptr : pParams->m_aPacked,
+         sizeof(Cuda_32_Int::T) * (cItems / cItemsPerBitPack + size_t{1}),
+         &cBytesScratch);
+
+   unsigned char* const aScratch = static_cast<unsigned char*>(g_deviceScratch.Get(cBytesScratch));
+   if(nullptr == aScratch) {
+      return cudaErrorMemoryAllocation;
+   }
+   void* const aFastBins = aScratch + iFastBins;
+
+   // the first copy continues the caller's bins and the others start from zero
+   cudaError_t result = cudaMemcpyAsync(
+         aFastBins, pParams->m_aFastBins, cBytesFastBins, cudaMemcpyHostToDevice, cudaStreamPerThread);
+   if(cudaSuccess == result && size_t{1} < cThreads) {
+      result = cudaMemsetAsync(
+            IndexByte(aFastBins, cBytesFastBins), 0, cBytesFastBins * (cThreads - size_t{1}), cudaStreamPerThread);
+   }
+
+   BinSumsBoostingBridge params = *pParams;
+   params.m_aGradientsAndHessians = StageIn(&gradHess, aScratch, &result);
+   params.m_aWeights = StageIn(&weights, aScratch, &result);
+   params.m_aPacked = StageIn(&packed, aScratch, &result);
+   params.m_aFastBins = aFastBins;
+   if(cudaSuccess == result) {
+      result = cudaMemcpyAsync(
+            aScratch + iBridge, &params, sizeof(params), cudaMemcpyHostToDevice, cudaStreamPerThread);
+   }
+   if(cudaSuccess != result) {
+      return result;
+   }
+
+   CudaBinSumsBoostingKernel<bHessian, bWeight, bCollapsed, cCompilerScores, bParallel>
+         <<<GetBlocks(cThreads), k_cThreadsPerBlock, 0, cudaStreamPerThread>>>(
+               reinterpret_cast<const BinSumsBoostingBridge*>(aScratch + iBridge),
+               cThreads,
+               cChunkItems,
+               cItemsPerBitPack);
+   result = cudaGetLastError();
+
+   if(cudaSuccess == result && size_t{1} < cThreads) {
+      const size_t cFloats = cBytesFastBins / sizeof(Cuda_32_Float::T);
+      CudaSumCopiesKernel<Cuda_32_Float::T><<<GetBlocks(cFloats), k_cThreadsPerBlock, 0, cudaStreamPerThread>>>(
+            static_cast<Cuda_32_Float::T*>(aFastBins), cFloats, cThreads);
+      result = cudaGetLastError();
+   }
+   if(cudaSuccess == result) {
+      // only the small bin tensor comes back to the host for the partitioning
+      result = cudaMemcpyAsync(
+            pParams->m_aFastBins, aFastBins, cBytesFastBins, cudaMemcpyDeviceToHost, cudaStreamPerThread);
+   }
+   const cudaError_t resultSynchronize = cudaStreamSynchronize(cudaStreamPerThread);
+   return cudaSuccess != result ? result : resultSynchronize;
+}
+
+// the interaction bins begin with an integer count, so their copies cannot be summed as one flat array of floats
+GPU_GLOBAL static void CudaSumInteractionCopiesKernel(
+      Cuda_32_Int::T* const a, const size_t cWords, const size_t cWordsPerBin, const size_t cCopies) {
+   const size_t iWord = GetThreadIndex();
+   if(cWords <= iWord) {
+      return;
+   }
+   Cuda_32_Int::T* p = &a[iWord];
+   const Cuda_32_Int::T* const pEnd = p + cWords * cCopies;
+   if(size_t{0} == iWord % cWordsPerBin) {
+      Cuda_32_Int::T sum = 0;
+      do {
+         sum += *p;
+         p += cWords;
+      } while(pEnd != p);
+      a[iWord] = sum;
+   } else {
+      double sum = 0.0;
+      do {
+         Cuda_32_Float::T val;
+         memcpy(&val, p, sizeof(val));
+         sum += static_cast<double>(val);
+         p += cWords;
+      } while(pEnd != p);
+      const Cuda_32_Float::T result = static_cast<Cuda_32_Float::T>(sum);
+      memcpy(&a[iWord], &result, sizeof(result));
+   }
+}
+
+template<bool bHessian, bool bWeight, size_t cCompilerScores, size_t cCompilerDimensions>
+GPU_GLOBAL static void CudaBinSumsInteractionKernel(const BinSumsInteractionBridge* const pParams,
+      const size_t cThreads,
+      const size_t cChunkItems,
+      const size_t cBytesFastBins) {
+   const size_t iThread = GetThreadIndex();
+   if(cThreads <= iThread) {
+      return;
+   }
+   // the chunks split the packed items, which include the unused trailing item of borrowed data if there is one
+   const bool bPackedTrailingItem = EBM_FALSE != pParams->m_bPackedTrailingItem;
+   const size_t cPackedItems = pParams->m_cSamples + (bPackedTrailingItem ? size_t{1} : size_t{0});
+   size_t cChunkItemsCur;
+   const size_t iItem = GetChunk(cPackedItems, cChunkItems, iThread, &cChunkItemsCur);
+
+   BinSumsInteractionBridge params = *pParams;
+   params.m_bPackedTrailingItem = EBM_FALSE;
+   params.m_cSamples = cChunkItemsCur;
+   if(bPackedTrailingItem && cThreads - size_t{1} == iThread) {
+      params.m_bPackedTrailingItem = EBM_TRUE;
+      --params.m_cSamples;
+   }
+   params.m_aGradientsAndHessians = IndexByte(pParams->m_aGradientsAndHessians,
+         sizeof(Cuda_32_Float::T) * (bHessian ? size_t{2} : size_t{1}) * pParams->m_cScores * iItem);
+   if(bWeight) {
+      params.m_aWeights = IndexByte(pParams->m_aWeights, sizeof(Cuda_32_Float::T) * iItem);
+   }
+   for(size_t iDimension = 0; iDimension < pParams->m_cRuntimeRealDimensions; ++iDimension) {
+      // the first pack of each dimension holds the remainder, and every chunk after the first one starts a pack
+      const size_t cItemsPerBitPack = static_cast<size_t>(pParams->m_acItemsPerBitPack[iDimension]);
+      const size_t cFirstPackItems = (cPackedItems - size_t{1}) % cItemsPerBitPack + size_t{1};
+      params.m_aaPacked[iDimension] = IndexByte(pParams->m_aaPacked[iDimension],
+            sizeof(Cuda_32_Int::T) * ((iItem + cItemsPerBitPack - cFirstPackItems) / cItemsPerBitPack));
+   }
+   params.m_aFastBins = IndexByte(pParams->m_aFastBins, cBytesFastBins * iThread);
+#ifndef NDEBUG
+   params.m_pDebugFastBinsEnd = IndexByte(params.m_aFastBins, cBytesFastBins);
+#endif // NDEBUG
+
+   BinSumsInteractionInternal<Cuda_32_Float, bHessian, bWeight, cCompilerScores, cCompilerDimensions>(&params);
+}
+
+template<bool bHessian, bool bWeight, size_t cCompilerScores, size_t cCompilerDimensions>
+static cudaError_t CudaBinSumsInteraction(BinSumsInteractionBridge* const pParams) noexcept {
+   const size_t cSamples = pParams->m_cSamples;
+   EBM_ASSERT(1 <= cSamples);
+   const size_t cScores = pParams->m_cScores;
+   const size_t cRealDimensions = pParams->m_cRuntimeRealDimensions;
+   EBM_ASSERT(1 <= cRealDimensions);
+   const size_t cPackedItems = cSamples + (EBM_FALSE != pParams->m_bPackedTrailingItem ? size_t{1} : size_t{0});
+
+   // Each dimension is packed with its own count of items per pack, and every dimension's packs end on the last
+   // packed item. A chunk boundary is a pack boundary in all dimensions if the items after it are a multiple of every
+   // dimension's pack size, so the chunks are multiples of their least common multiple.
+   size_t cTensorBins = 1;
+   size_t cItemsCommonPack = 1;
+   for(size_t iDimension = 0; iDimension < cRealDimensions; ++iDimension) {
+      cTensorBins *= pParams->m_acBins[iDimension];
+
+      const size_t cItemsPerBitPack = static_cast<size_t>(pParams->m_acItemsPerBitPack[iDimension]);
+      EBM_ASSERT(1 <= cItemsPerBitPack);
+      size_t a = cItemsCommonPack;
+      size_t b = cItemsPerBitPack;
+      while(size_t{0} != b) {
+         const size_t remainder = a % b;
+         a = b;
+         b = remainder;
+      }
+      // once the common pack exceeds the data the whole subset is a single chunk anyway
+      cItemsCommonPack = EbmMin(cItemsCommonPack / a * cItemsPerBitPack, cPackedItems);
+   }
+   const size_t cBytesPerBin = GetBinSize<Cuda_32_Float::T, Cuda_32_Int::T>(true, true, bHessian, cScores);
+   EBM_ASSERT(0 == cBytesPerBin % sizeof(Cuda_32_Int::T));
+   const size_t cBytesFastBins = cBytesPerBin * cTensorBins;
+   const size_t cThreadsMax = EbmMin(k_cThreadsMax, EbmMax(size_t{1}, k_cBytesThreadBinsMax / cBytesFastBins));
+   const size_t cChunkItems = GetChunkItems(cPackedItems, cThreadsMax, cItemsCommonPack);
+   const size_t cThreads = (cPackedItems - size_t{1}) / cChunkItems + size_t{1};
+
+   size_t cBytesScratch = 0;
+   const size_t iBridge = Reserve(&cBytesScratch, sizeof(BinSumsInteractionBridge));
+   const size_t iFastBins = Reserve(&cBytesScratch, cBytesFastBins * cThreads);
+
+   Staged gradHess;
+   PlanStaged(&gradHess,
+         pParams->m_aGradientsAndHessians,
+         sizeof(Cuda_32_Float::T) * (bHessian ? size_t{2} : size_t{1}) * cScores * cSamples,
+         &cBytesScratch);
+   Staged weights;
+   PlanStaged(&weights, bWeight ? pParams->m_aWeights : nullptr, sizeof(Cuda_32_Float::T) * cSamples, &cBytesScratch);
+   Staged aPacked[k_cDimensionsMax];
+   for(size_t iDimension = 0; iDimension < cRealDimensions; ++iDimension) {
+      const size_t cItemsPerBitPack = static_cast<size_t>(pParams->m_acItemsPerBitPack[iDimension]);
+      PlanStaged(&aPacked[iDimension],
+            pParams->m_aaPacked[iDimension],
+            sizeof(Cuda_32_Int::T) * ((cPackedItems - size_t{1}) / cItemsPerBitPack + size_t{1}),
+            &cBytesScratch);
+   }
+
+   unsigned char* const aScratch = static_cast<unsigned char*>(g_deviceScratch.Get(cBytesScratch));
+   if(nullptr == aScratch) {
+      return cudaErrorMemoryAllocation;
+   }
+   void* const aFastBins = aScratch + iFastBins;
+
+   // the first copy continues the caller's bins and the others start from zero
+   cudaError_t result = cudaMemcpyAsync(
+         aFastBins, pParams->m_aFastBins, cBytesFastBins, cudaMemcpyHostToDevice, cudaStreamPerThread);
+   if(cudaSuccess == result && size_t{1} < cThreads) {
+      result = cudaMemsetAsync(
+            IndexByte(aFastBins, cBytesFastBins), 0, cBytesFastBins * (cThreads - size_t{1}), cudaStreamPerThread);
+   }
+
+   BinSumsInteractionBridge params = *pParams;
+   params.m_aGradientsAndHessians = StageIn(&gradHess, aScratch, &result);
+   params.m_aWeights = StageIn(&weights, aScratch, &result);
+   for(size_t iDimension = 0; iDimension < cRealDimensions; ++iDimension) {
+      params.m_aaPacked[iDimension] = StageIn(&aPacked[iDimension], aScratch, &result);
+   }
+   params.m_aFastBins = aFastBins;
+   if(cudaSuccess == result) {
+      result = cudaMemcpyAsync(
+            aScratch + iBridge, &params, sizeof(params), cudaMemcpyHostToDevice, cudaStreamPerThread);
+   }
+   if(cudaSuccess != result) {
+      return result;
+   }
+
+   CudaBinSumsInteractionKernel<bHessian, bWeight, cCompilerScores, cCompilerDimensions>
+         <<<GetBlocks(cThreads), k_cThreadsPerBlock, 0, cudaStreamPerThread>>>(
+               reinterpret_cast<const BinSumsInteractionBridge*>(aScratch + iBridge),
+               cThreads,
+               cChunkItems,
+               cBytesFastBins);
+   result = cudaGetLastError();
+
+   if(cudaSuccess == result && size_t{1} < cThreads) {
+      const size_t cWords = cBytesFastBins / sizeof(Cuda_32_Int::T);
+      CudaSumInteractionCopiesKernel<<<GetBlocks(cWords), k_cThreadsPerBlock, 0, cudaStreamPerThread>>>(
+            static_cast<Cuda_32_Int::T*>(aFastBins), cWords, cBytesPerBin / sizeof(Cuda_32_Int::T), cThreads);
+      result = cudaGetLastError();
+   }
+   if(cudaSuccess == result) {
+      result = cudaMemcpyAsync(
+            pParams->m_aFastBins, aFastBins, cBytesFastBins, cudaMemcpyDeviceToHost, cudaStreamPerThread);
+   }
+   const cudaError_t resultSynchronize = cudaStreamSynchronize(cudaStreamPerThread);
+   return cudaSuccess != result ? result : resultSynchronize;
+}
+
+// Managed memory lets the main zone fill the subsets from the host once and the kernels then read them on the device
+// in every round without any copies. Preferring the device keeps the pages there after the host writes them.
+static void* AlignedAlloc_Cuda_32(const size_t cBytes) {
+   void* p = nullptr;
+   if(cudaSuccess != cudaMallocManaged(&p, cBytes)) {
+      cudaGetLastError();
+      LOG_0(Trace_Warning, "WARNING AlignedAlloc_Cuda_32 cudaMallocManaged failed");
+      return nullptr;
+   }
+   int iDevice;
+   if(cudaSuccess == cudaGetDevice(&iDevice)) {
+      cudaMemAdvise(p, cBytes, cudaMemAdviseSetPreferredLocation, iDevice);
+   }
+   cudaGetLastError();
+   return p;
+}
+
+static void AlignedFree_Cuda_32(void* const p) {
+   if(nullptr != p) {
+      cudaFree(p);
+   }
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm ApplyUpdate_Cuda_32(
+      const ObjectiveWrapper* const pObjectiveWrapper, ApplyUpdateBridge* const pData) {
+   const Objective* const pObjective = static_cast<const Objective*>(pObjectiveWrapper->m_pObjective);
+   const APPLY_UPDATE_CPP pApplyUpdateCpp =
+         (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pApplyUpdateCpp;
+   return (*pApplyUpdateCpp)(pObjective, pData);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsBoosting_Cuda_32(
+      const ObjectiveWrapper* const pObjectiveWrapper, BinSumsBoostingBridge* const pParams) {
+   const BIN_SUMS_BOOSTING_CPP pBinSumsBoostingCpp =
+         (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsBoostingCpp;
+   return (*pBinSumsBoostingCpp)(pParams);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsInteraction_Cuda_32(
+      const ObjectiveWrapper* const pObjectiveWrapper, BinSumsInteractionBridge* const pParams) {
+   const BIN_SUMS_INTERACTION_CPP pBinSumsInteractionCpp =
+         (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsInteractionCpp;
+   return (*pBinSumsInteractionCpp)(pParams);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY BoolEbm IsAvailable_Cuda_32(void) {
+   int cDevices = 0;
+   if(cudaSuccess != cudaGetDeviceCount(&cDevices)) {
+      // there is no driver or no device, and the error would otherwise surface in the next CUDA call
+      cudaGetLastError();
+      return EBM_FALSE;
+   }
+   return 0 < cDevices ? EBM_TRUE : EBM_FALSE;
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateObjective_Cuda_32(const Config* const pConfig,
+      const char* const sObjective,
+      const char* const sObjectiveEnd,
+      ObjectiveWrapper* const pObjectiveWrapperOut) {
+   pObjectiveWrapperOut->m_pApplyUpdateC = ApplyUpdate_Cuda_32;
+   pObjectiveWrapperOut->m_pBinSumsBoostingC = BinSumsBoosting_Cuda_32;
+   pObjectiveWrapperOut->m_pBinSumsInteractionC = BinSumsInteraction_Cuda_32;
+   pObjectiveWrapperOut->m_pAlignedAllocC = AlignedAlloc_Cuda_32;
+   pObjectiveWrapperOut->m_pAlignedFreeC = AlignedFree_Cuda_32;
+   ErrorEbm error = ComputeWrapper<Cuda_32_Float>::FillWrapper(pObjectiveWrapperOut);
+   if(Error_None != error) {
+      return error;
+   }
+   return Objective::CreateObjective<Cuda_32_Float>(pConfig, sObjective, sObjectiveEnd, pObjectiveWrapperOut);
+}
+
+} // namespace DEFINED_ZONE_NAME
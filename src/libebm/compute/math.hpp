@@ -344,6 +344,121 @@ static INLINE_ALWAYS TFloat Exp64(const TFloat val) {
    return ret;
 }
 
+// The maximum relative errors of ExpReduced before float rounding. The coefficients minimize the relative error on
+// the [-ln(2)/2, +ln(2)/2] interval left after range reduction, so a lower degree polynomial meets a looser bound.
+static constexpr double k_expReducedErrorDegree3 = 7.5e-5;
+static constexpr double k_expReducedErrorDegree4 = 2.7e-6;
+
+// picks the lowest degree ExpReduced that keeps within maxError, or zero for the full precision Exp
+inline constexpr static int GetExpReducedDegree(const double maxError) noexcept {
+   return k_expReducedErrorDegree3 <= maxError ? 3 : k_expReducedErrorDegree4 <= maxError ? 4 : 0;
+}
+
+template<typename TFloat, typename std::enable_if<sizeof(float) == sizeof(typename TFloat::T), int>::type = 0>
+static INLINE_ALWAYS TFloat PowerOfTwo(const TFloat val) {
+   return Power32(val);
+}
+template<typename TFloat, typename std::enable_if<sizeof(double) == sizeof(typename TFloat::T), int>::type = 0>
+static INLINE_ALWAYS TFloat PowerOfTwo(const TFloat val) {
+   return Power64(val);
+}
+
+template<typename TFloat,
+      int cDegree,
+      bool bNegateInput = false,
+      bool bNaNPossible = true,
+      bool bUnderflowPossible = true,
+      bool bOverflowPossible = true>
+static INLINE_ALWAYS TFloat ExpReduced(const TFloat val) {
+   // Exp32/Exp64 with a shorter polynomial after the same range reduction. This is for callers like softmax that
+   // spend most of their time in exp and can tolerate a known error bound in exchange for fewer multiplies.
+   static_assert(3 == cDegree || 4 == cDegree, "ExpReduced only has coefficients for degree 3 and 4");
+
+   static constexpr bool b64 = sizeof(double) == sizeof(typename TFloat::T);
+   static constexpr double k_expUnderflow = b64 ? -708.25 : -87.25;
+   static constexpr double k_expOverflow = b64 ? 708.25 : 87.25;
+   static constexpr double k_ln2High = b64 ? -0.693145751953125 : -0.693359375;
+   static constexpr double k_ln2Low = b64 ? -1.42860682030941723212E-6 : 2.12194440e-4;
+
+   TFloat rounded;
+   TFloat x;
+   if(bNegateInput) {
+      rounded = Round(val * TFloat{-1.44269504088896340736});
+      x = FusedMultiplySubtract(rounded, TFloat{k_ln2High}, val);
+   } else {
+      rounded = Round(val * TFloat{1.44269504088896340736});
+      x = FusedMultiplyAdd(rounded, TFloat{k_ln2High}, val);
+   }
+   x = FusedMultiplyAdd(rounded, TFloat{k_ln2Low}, x);
+
+   TFloat ret;
+   if(3 == cDegree) {
+      ret = FusedMultiplyAdd(
+            FusedMultiplyAdd(FusedMultiplyAdd(TFloat{1.6566690138e-1}, x, TFloat{5.0496780427e-1}),
+                  x,
+                  TFloat{1.0001645253}),
+            x,
+            TFloat{9.9992794411e-1});
+   } else {
+      const TFloat x2 = x * x;
+      ret = FusedMultiplyAdd(FusedMultiplyAdd(TFloat{4.1458332094e-2},
+                                   x2,
+                                   FusedMultiplyAdd(TFloat{1.6791027799e-1}, x, TFloat{5.0004367840e-1})),
+            x2,
+            FusedMultiplyAdd(TFloat{9.9996333431e-1}, x, TFloat{9.9999925922e-1}));
+   }
+
+   ret *= PowerOfTwo(rounded);
+
+   if(bOverflowPossible) {
+      if(bNegateInput) {
+         ret = IfThenElse(val < TFloat{-k_expOverflow}, std::numeric_limits<typename TFloat::T>::infinity(), ret);
+      } else {
+         ret = IfThenElse(TFloat{k_expOverflow} < val, std::numeric_limits<typename TFloat::T>::infinity(), ret);
+      }
+   }
+   if(bUnderflowPossible) {
+      if(bNegateInput) {
+         ret = IfThenElse(TFloat{-k_expUnderflow} < val, TFloat{0}, ret);
+      } else {
+         ret = IfThenElse(val < TFloat{k_expUnderflow}, TFloat{0}, ret);
+      }
+   }
+   if(bNaNPossible) {
+      ret = IfThenElse(IsNaN(val), val, ret);
+   }
+
+#ifndef NDEBUG
+   TFloat::Execute(
+         [](int, typename TFloat::T orig, typename TFloat::T retDebug) {
+            EBM_ASSERT(IsApproxEqual(std::exp(orig),
+                  retDebug,
+                  typename TFloat::T{(3 == cDegree ? k_expReducedErrorDegree3 : k_expReducedErrorDegree4) + 1e-6}));
+         },
+         bNegateInput ? -val : val,
+         ret);
+#endif // NDEBUG
+
+   return ret;
+}
+
+// the exp used by the log loss kernels. Degree zero means full precision, or Schraudolph's approximation if bUseApprox
+template<typename TFloat,
+      bool bUseApprox,
+      int cExpDegree,
+      typename std::enable_if<0 == cExpDegree, int>::type = 0>
+static INLINE_ALWAYS TFloat ExpForDegree(const TFloat& val) {
+   return TFloat::template ApproxExp<bUseApprox, false>(val);
+}
+template<typename TFloat,
+      bool bUseApprox,
+      int cExpDegree,
+      typename std::enable_if<0 != cExpDegree, int>::type = 0>
+static INLINE_ALWAYS TFloat ExpForDegree(const TFloat& val) {
+   static_assert(!bUseApprox, "the Schraudolph approximation replaces the polynomial entirely");
+   return ExpReduced<TFloat, cExpDegree>(val);
+}
+
 template<typename TFloat,
       bool bNegateOutput = false,
       bool bNaNPossible = true,
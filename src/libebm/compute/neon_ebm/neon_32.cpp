@@ -0,0 +1,683 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <cmath> // exp, log
+#include <limits> // numeric_limits
+#include <type_traits> // is_unsigned
+
+#include <arm_neon.h>
+
+#include "libebm.h"
+#include "logging.h"
+#include "unzoned.h"
+
+#define ZONE_neon
+#include "zones.h"
+
+#include "bridge.h"
+#include "common.hpp"
+#include "bridge.hpp"
+
+#include "Registration.hpp"
+#include "Objective.hpp"
+
+#include "math.hpp"
+#include "approximate_math.hpp"
+#include "compute_wrapper.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+static constexpr size_t k_cAlignment = 16;
+
+struct Neon_32_Float;
+struct Neon_32_Int;
+
+template<bool bNegateInput = false,
+      bool bNaNPossible = true,
+      bool bUnderflowPossible = true,
+      bool bOverflowPossible = true>
+inline Neon_32_Float Exp(const Neon_32_Float& val) noexcept;
+template<bool bNegateOutput = false,
+      bool bNaNPossible = true,
+      bool bNegativePossible = true,
+      bool bZeroPossible = true,
+      bool bPositiveInfinityPossible = true>
+inline Neon_32_Float Log(const Neon_32_Float& val) noexcept;
+
+// this is super-special and included inside the zone namespace
+#include "objective_registrations.hpp"
+
+// SIMD registers cannot be indexed, so for the operations that need to go lane by lane (scatters, and lambdas
+// passed to Execute) we spill each register into an aligned array and then iterate the lanes
+template<typename TSIMD> struct alignas(k_cAlignment) NeonLanes final {
+   inline explicit NeonLanes(const TSIMD& val) noexcept { val.Store(m_a); }
+   typename TSIMD::T m_a[TSIMD::k_cSIMDPack];
+};
+
+template<int cPack, typename TFunc, typename... TLanes>
+inline static void ExecuteLanes(const TFunc& func, const TLanes&... lanes) noexcept {
+   for(int i = 0; i < cPack; ++i) {
+      func(i, lanes.m_a[i]...);
+   }
+}
+
+struct Neon_32_Int final {
+   friend Neon_32_Float;
+   friend inline Neon_32_Float IfThenElse(
+         const Neon_32_Int& cmp, const Neon_32_Float& trueVal, const Neon_32_Float& falseVal) noexcept;
+   friend inline Neon_32_Float IfAdd(
+         const Neon_32_Int& cmp, const Neon_32_Float& base, const Neon_32_Float& addend) noexcept;
+
+   using T = uint32_t;
+   using TPack = uint32x4_t;
+   static_assert(std::is_unsigned<T>::value, "T must be an unsigned integer type");
+   static_assert(
+         std::is_same<UIntBig, T>::value || std::is_same<UIntSmall, T>::value, "T must be either UIntBig or UIntSmall");
+   static constexpr AccelerationFlags k_zone = AccelerationFlags_NEON;
+   static constexpr int k_cSIMDShift = 2;
+   static constexpr int k_cSIMDPack = 1 << k_cSIMDShift;
+   static constexpr int k_cTypeShift = 2;
+   static_assert(1 << k_cTypeShift == sizeof(T), "k_cTypeShift must be equivalent to the type size");
+
+   ATTRIBUTE_WARNING_DISABLE_UNINITIALIZED_MEMBER
+   inline Neon_32_Int() noexcept {}
+
+   inline Neon_32_Int(const T& val) noexcept : m_data(vdupq_n_u32(val)) {}
+   inline Neon_32_Int(const TPack& data) noexcept : m_data(data) {}
+
+   inline static Neon_32_Int Load(const T* const a) noexcept {
+      EBM_ASSERT(IsAligned(a, sizeof(TPack)));
+      return Neon_32_Int(vld1q_u32(a));
+   }
+
+   inline void Store(T* const a) const noexcept {
+      EBM_ASSERT(IsAligned(a, sizeof(TPack)));
+      vst1q_u32(a, m_data);
+   }
+
+   inline static Neon_32_Int LoadBytes(const uint8_t* const a) noexcept {
+      alignas(k_cAlignment) const T aTemp[k_cSIMDPack] = {a[0], a[1], a[2], a[3]};
+      return Neon_32_Int(vld1q_u32(aTemp));
+   }
+
+   template<typename TFunc, typename... TArgs>
+   static inline void Execute(const TFunc& func, const TArgs&... args) noexcept {
+      ExecuteLanes<k_cSIMDPack>(func, NeonLanes<TArgs>(args)...);
+   }
+
+   inline static Neon_32_Int MakeIndexes() noexcept {
+      alignas(k_cAlignment) static constexpr T aIndexes[k_cSIMDPack] = {0, 1, 2, 3};
+      return Neon_32_Int(vld1q_u32(aIndexes));
+   }
+
+   inline Neon_32_Int operator~() const noexcept {
+      return Neon_32_Int(vmvnq_u32(m_data));
+   }
+
+   friend inline Neon_32_Int operator==(const Neon_32_Int& left, const Neon_32_Int& right) noexcept {
+      return Neon_32_Int(vceqq_u32(left.m_data, right.m_data));
+   }
+
+   inline Neon_32_Int operator+(const Neon_32_Int& other) const noexcept {
+      return Neon_32_Int(vaddq_u32(m_data, other.m_data));
+   }
+
+   inline Neon_32_Int operator-(const Neon_32_Int& other) const noexcept {
+      return Neon_32_Int(vsubq_u32(m_data, other.m_data));
+   }
+
+   inline Neon_32_Int operator*(const T& other) const noexcept {
+      return Neon_32_Int(vmulq_n_u32(m_data, other));
+   }
+
+   inline Neon_32_Int operator>>(int shift) const noexcept {
+      return Neon_32_Int(vshlq_u32(m_data, vdupq_n_s32(-shift)));
+   }
+
+   inline Neon_32_Int operator<<(int shift) const noexcept {
+      return Neon_32_Int(vshlq_u32(m_data, vdupq_n_s32(shift)));
+   }
+
+   inline Neon_32_Int operator&(const Neon_32_Int& other) const noexcept {
+      return Neon_32_Int(vandq_u32(m_data, other.m_data));
+   }
+
+   inline Neon_32_Int operator|(const Neon_32_Int& other) const noexcept {
+      return Neon_32_Int(vorrq_u32(m_data, other.m_data));
+   }
+
+   friend inline Neon_32_Int IfThenElse(
+         const Neon_32_Int& cmp, const Neon_32_Int& trueVal, const Neon_32_Int& falseVal) noexcept {
+      return Neon_32_Int(vbslq_u32(cmp.m_data, trueVal.m_data, falseVal.m_data));
+   }
+
+   friend inline Neon_32_Int IfAdd(
+         const Neon_32_Int& cmp, const Neon_32_Int& base, const Neon_32_Int& addend) noexcept {
+      return base + Neon_32_Int(vandq_u32(cmp.m_data, addend.m_data));
+   }
+
+   friend inline Neon_32_Int PermuteForInterleaf(const Neon_32_Int& val) noexcept {
+      // vzip1q_f32 and vzip2q_f32 (see Neon_32_Float::Interleaf) keep the samples in their natural order
+      return val;
+   }
+
+ private:
+   TPack m_data;
+};
+static_assert(std::is_standard_layout<Neon_32_Int>::value && std::is_trivially_copyable<Neon_32_Int>::value,
+      "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
+
+struct Neon_32_Float final {
+   template<bool bNegateInput, bool bNaNPossible, bool bUnderflowPossible, bool bOverflowPossible>
+   friend Neon_32_Float Exp(const Neon_32_Float& val) noexcept;
+   template<bool bNegateOutput,
+         bool bNaNPossible,
+         bool bNegativePossible,
+         bool bZeroPossible,
+         bool bPositiveInfinityPossible>
+   friend Neon_32_Float Log(const Neon_32_Float& val) noexcept;
+
+   using T = float;
+   using TPack = float32x4_t;
+   using TInt = Neon_32_Int;
+   static_assert(std::is_same<FloatBig, T>::value || std::is_same<FloatSmall, T>::value,
+         "T must be either FloatBig or FloatSmall");
+   static constexpr AccelerationFlags k_zone = TInt::k_zone;
+   static constexpr int k_cSIMDShift = TInt::k_cSIMDShift;
+   static constexpr int k_cSIMDPack = TInt::k_cSIMDPack;
+   static constexpr int k_cTypeShift = 2;
+   static_assert(1 << k_cTypeShift == sizeof(T), "k_cTypeShift must be equivalent to the type size");
+
+   ATTRIBUTE_WARNING_DISABLE_UNINITIALIZED_MEMBER
+   inline Neon_32_Float() noexcept {}
+
+   inline Neon_32_Float(const TPack& data) noexcept : m_data(data) {}
+   inline Neon_32_Float(const double val) noexcept : m_data(vdupq_n_f32(static_cast<T>(val))) {}
+   inline Neon_32_Float(const float val) noexcept : m_data(vdupq_n_f32(static_cast<T>(val))) {}
+   inline Neon_32_Float(const int val) noexcept : m_data(vdupq_n_f32(static_cast<T>(val))) {}
+   inline Neon_32_Float(const int64_t val) noexcept : m_data(vdupq_n_f32(static_cast<T>(val))) {}
+   explicit Neon_32_Float(const Neon_32_Int& val) : m_data(vcvtq_f32_s32(vreinterpretq_s32_u32(val.m_data))) {}
+
+   inline Neon_32_Float operator+() const noexcept { return *this; }
+
+   inline Neon_32_Float operator-() const noexcept {
+      return Neon_32_Float(vnegq_f32(m_data));
+   }
+
+   inline Neon_32_Float operator+(const Neon_32_Float& other) const noexcept {
+      return Neon_32_Float(vaddq_f32(m_data, other.m_data));
+   }
+
+   inline Neon_32_Float operator-(const Neon_32_Float& other) const noexcept {
+      return Neon_32_Float(vsubq_f32(m_data, other.m_data));
+   }
+
+   inline Neon_32_Float operator*(const Neon_32_Float& other) const noexcept {
+      return Neon_32_Float(vmulq_f32(m_data, other.m_data));
+   }
+
+   inline Neon_32_Float operator/(const Neon_32_Float& other) const noexcept {
+      return Neon_32_Float(vdivq_f32(m_data, other.m_data));
+   }
+
+   inline Neon_32_Float& operator+=(const Neon_32_Float& other) noexcept {
+      *this = (*this) + other;
+      return *this;
+   }
+
+   inline Neon_32_Float& operator-=(const Neon_32_Float& other) noexcept {
+      *this = (*this) - other;
+      return *this;
+   }
+
+   inline Neon_32_Float& operator*=(const Neon_32_Float& other) noexcept {
+      *this = (*this) * other;
+      return *this;
+   }
+
+   inline Neon_32_Float& operator/=(const Neon_32_Float& other) noexcept {
+      *this = (*this) / other;
+      return *this;
+   }
+
+   friend inline Neon_32_Float operator+(const double val, const Neon_32_Float& other) noexcept {
+      return Neon_32_Float(val) + other;
+   }
+
+   friend inline Neon_32_Float operator-(const double val, const Neon_32_Float& other) noexcept {
+      return Neon_32_Float(val) - other;
+   }
+
+   friend inline Neon_32_Float operator*(const double val, const Neon_32_Float& other) noexcept {
+      return Neon_32_Float(val) * other;
+   }
+
+   friend inline Neon_32_Float operator/(const double val, const Neon_32_Float& other) noexcept {
+      return Neon_32_Float(val) / other;
+   }
+
+   friend inline Neon_32_Float operator+(const float val, const Neon_32_Float& other) noexcept {
+      return Neon_32_Float(val) + other;
+   }
+
+   friend inline Neon_32_Float operator-(const float val, const Neon_32_Float& other) noexcept {
+      return Neon_32_Float(val) - other;
+   }
+
+   friend inline Neon_32_Float operator*(const float val, const Neon_32_Float& other) noexcept {
+      return Neon_32_Float(val) * other;
+   }
+
+   friend inline Neon_32_Float operator/(const float val, const Neon_32_Float& other) noexcept {
+      return Neon_32_Float(val) / other;
+   }
+
+   friend inline Neon_32_Int operator==(const Neon_32_Float& left, const Neon_32_Float& right) noexcept {
+      return Neon_32_Int(vceqq_f32(left.m_data, right.m_data));
+   }
+
+   friend inline Neon_32_Int operator<(const Neon_32_Float& left, const Neon_32_Float& right) noexcept {
+      return Neon_32_Int(vcltq_f32(left.m_data, right.m_data));
+   }
+
+   friend inline Neon_32_Int operator<=(const Neon_32_Float& left, const Neon_32_Float& right) noexcept {
+      return Neon_32_Int(vcleq_f32(left.m_data, right.m_data));
+   }
+
+   inline static Neon_32_Float Load(const T* const a) noexcept {
+      EBM_ASSERT(IsAligned(a, sizeof(TPack)));
+      return Neon_32_Float(vld1q_f32(a));
+   }
+
+   inline void Store(T* const a) const noexcept {
+      EBM_ASSERT(IsAligned(a, sizeof(TPack)));
+      vst1q_f32(a, m_data);
+   }
+
+   template<int cShift = k_cTypeShift> inline static Neon_32_Float Load(const T* const a, const TInt& i) noexcept {
+      // NEON does not have a gathering load, so load each lane individually
+      const NeonLanes<Neon_32_Int> indexes(i);
+      alignas(k_cAlignment) T aTemp[k_cSIMDPack];
+      for(int iLane = 0; iLane < k_cSIMDPack; ++iLane) {
+         aTemp[iLane] = *IndexByte(a, static_cast<size_t>(indexes.m_a[iLane]) << cShift);
+      }
+      return Load(aTemp);
+   }
+
+   template<int cShift>
+   inline static void DoubleLoad(const T* const a,
+         const Neon_32_Int& i,
+         Neon_32_Float& ret1,
+         Neon_32_Float& ret2) noexcept {
+      // NEON does not have a gathering load, so load each gradient/hessian pair as a single 64-bit value
+      const NeonLanes<Neon_32_Int> indexes(i);
+      alignas(k_cAlignment) uint64_t pairs[k_cSIMDPack];
+      for(int iLane = 0; iLane < k_cSIMDPack; ++iLane) {
+         pairs[iLane] =
+               *IndexByte(reinterpret_cast<const uint64_t*>(a), static_cast<size_t>(indexes.m_a[iLane]) << cShift);
+      }
+      ret1 = Neon_32_Float(vreinterpretq_f32_u64(vld1q_u64(&pairs[0])));
+      ret2 = Neon_32_Float(vreinterpretq_f32_u64(vld1q_u64(&pairs[k_cSIMDPack / 2])));
+   }
+
+   template<int cShift = k_cTypeShift> inline void Store(T* const a, const TInt& i) const noexcept {
+      // NEON does not have a scattering store, so store each lane individually
+      const NeonLanes<Neon_32_Int> indexes(i);
+      const NeonLanes<Neon_32_Float> vals(*this);
+      for(int iLane = 0; iLane < k_cSIMDPack; ++iLane) {
+         *IndexByte(a, static_cast<size_t>(indexes.m_a[iLane]) << cShift) = vals.m_a[iLane];
+      }
+   }
+
+   template<int cShift>
+   inline static void DoubleStore(T* const a,
+         const Neon_32_Int& i,
+         const Neon_32_Float& val1,
+         const Neon_32_Float& val2) noexcept {
+      // NEON does not have a scattering store, so store each gradient/hessian pair as a single 64-bit value
+      const NeonLanes<Neon_32_Int> indexes(i);
+
+      alignas(k_cAlignment) uint64_t pairs[k_cSIMDPack];
+      vst1q_u64(&pairs[0], vreinterpretq_u64_f32(val1.m_data));
+      vst1q_u64(&pairs[k_cSIMDPack / 2], vreinterpretq_u64_f32(val2.m_data));
+
+      for(int iLane = 0; iLane < k_cSIMDPack; ++iLane) {
+         *IndexByte(reinterpret_cast<uint64_t*>(a), static_cast<size_t>(indexes.m_a[iLane]) << cShift) = pairs[iLane];
+      }
+   }
+
+   inline static void Interleaf(const Neon_32_Float& val0,
+         const Neon_32_Float& val1,
+         Neon_32_Float& ret0,
+         Neon_32_Float& ret1) noexcept {
+      // this function permutes the values into positions that the PermuteForInterleaf function expects
+      // but for any SIMD implementation, the positions can be variable as long as they work together
+      ret0 = Neon_32_Float(vzip1q_f32(val0.m_data, val1.m_data));
+      ret1 = Neon_32_Float(vzip2q_f32(val0.m_data, val1.m_data));
+   }
+
+   template<typename TFunc>
+   friend inline Neon_32_Float ApplyFunc(const TFunc& func, const Neon_32_Float& val) noexcept {
+      alignas(k_cAlignment) T aTemp[k_cSIMDPack];
+      val.Store(aTemp);
+      for(int i = 0; i < k_cSIMDPack; ++i) {
+         aTemp[i] = func(aTemp[i]);
+      }
+      return Load(aTemp);
+   }
+
+   template<typename TFunc, typename... TArgs>
+   static inline void Execute(const TFunc& func, const TArgs&... args) noexcept {
+      ExecuteLanes<k_cSIMDPack>(func, NeonLanes<TArgs>(args)...);
+   }
+
+   friend inline Neon_32_Float IfThenElse(
+         const Neon_32_Int& cmp, const Neon_32_Float& trueVal, const Neon_32_Float& falseVal) noexcept {
+      return Neon_32_Float(vbslq_f32(cmp.m_data, trueVal.m_data, falseVal.m_data));
+   }
+
+   friend inline Neon_32_Float IfAdd(
+         const Neon_32_Int& cmp, const Neon_32_Float& base, const Neon_32_Float& addend) noexcept {
+      return base + Neon_32_Float(vreinterpretq_f32_u32(vandq_u32(cmp.m_data, vreinterpretq_u32_f32(addend.m_data))));
+   }
+
+   friend inline Neon_32_Int IsNaN(const Neon_32_Float& cmp) noexcept {
+      return Neon_32_Int(vmvnq_u32(vceqq_f32(cmp.m_data, cmp.m_data)));
+   }
+
+   static inline Neon_32_Int ReinterpretInt(const Neon_32_Float& val) noexcept {
+      return Neon_32_Int(vreinterpretq_u32_f32(val.m_data));
+   }
+
+   static inline Neon_32_Float ReinterpretFloat(const Neon_32_Int& val) noexcept {
+      return Neon_32_Float(vreinterpretq_f32_u32(val.m_data));
+   }
+
+   friend inline Neon_32_Float Round(const Neon_32_Float& val) noexcept {
+      return Neon_32_Float(vrndnq_f32(val.m_data));
+   }
+
+   friend inline Neon_32_Float Abs(const Neon_32_Float& val) noexcept {
+      return Neon_32_Float(vabsq_f32(val.m_data));
+   }
+
+   friend inline Neon_32_Float FastApproxReciprocal(const Neon_32_Float& val) noexcept {
+#ifdef FAST_DIVISION
+      return Neon_32_Float(vrecpeq_f32(val.m_data));
+#else // FAST_DIVISION
+      return Neon_32_Float(vdivq_f32(vdupq_n_f32(1.0f), val.m_data));
+#endif // FAST_DIVISION
+   }
+
+   friend inline Neon_32_Float FastApproxDivide(
+         const Neon_32_Float& dividend, const Neon_32_Float& divisor) noexcept {
+#ifdef FAST_DIVISION
+      return Neon_32_Float(vmulq_f32(dividend.m_data, vrecpeq_f32(divisor.m_data)));
+#else // FAST_DIVISION
+      return Neon_32_Float(vdivq_f32(dividend.m_data, divisor.m_data));
+#endif // FAST_DIVISION
+   }
+
+   friend inline Neon_32_Float FusedMultiplyAdd(
+         const Neon_32_Float& mul1, const Neon_32_Float& mul2, const Neon_32_Float& add) noexcept {
+      // fused multiply add is part of the base AArch64 instruction set
+      return Neon_32_Float(vfmaq_f32(add.m_data, mul1.m_data, mul2.m_data));
+   }
+
+   friend inline Neon_32_Float FusedNegateMultiplyAdd(
+         const Neon_32_Float& mul1, const Neon_32_Float& mul2, const Neon_32_Float& add) noexcept {
+      // equivalent to: -(mul1 * mul2) + add
+      return Neon_32_Float(vfmsq_f32(add.m_data, mul1.m_data, mul2.m_data));
+   }
+
+   friend inline Neon_32_Float FusedMultiplySubtract(
+         const Neon_32_Float& mul1, const Neon_32_Float& mul2, const Neon_32_Float& subtract) noexcept {
+      // equivalent to: mul1 * mul2 - subtract
+      return Neon_32_Float(vnegq_f32(vfmsq_f32(subtract.m_data, mul1.m_data, mul2.m_data)));
+   }
+
+   friend inline Neon_32_Float Sqrt(const Neon_32_Float& val) noexcept {
+      return Neon_32_Float(vsqrtq_f32(val.m_data));
+   }
+
+   template<bool bUseApprox,
+         bool bNegateInput = false,
+         bool bNaNPossible = true,
+         bool bUnderflowPossible = true,
+         bool bOverflowPossible = true,
+         bool bSpecialCaseZero = false,
+         typename std::enable_if<!bUseApprox, int>::type = 0>
+   static inline Neon_32_Float ApproxExp(const Neon_32_Float& val,
+         const int32_t addExpSchraudolphTerm = k_expTermZeroMeanErrorForSoftmaxWithZeroedLogit) noexcept {
+      UNUSED(addExpSchraudolphTerm);
+      return Exp<bNegateInput, bNaNPossible, bUnderflowPossible, bOverflowPossible>(val);
+   }
+
+   template<bool bUseApprox,
+         bool bNegateInput = false,
+         bool bNaNPossible = true,
+         bool bUnderflowPossible = true,
+         bool bOverflowPossible = true,
+         bool bSpecialCaseZero = false,
+         typename std::enable_if<bUseApprox, int>::type = 0>
+   static inline Neon_32_Float ApproxExp(const Neon_32_Float& val,
+         const int32_t addExpSchraudolphTerm = k_expTermZeroMeanErrorForSoftmaxWithZeroedLogit) noexcept {
+      // This is the SIMD equivalent of ExpApproxSchraudolph in approximate_math.hpp. The float to int conversion
+      // saturates in NEON, so we compute all lanes and then patch up the special cases afterwards.
+      // TODO: we might want different constants for binary classification and multiclass. See notes in
+      // approximate_math.hpp
+      static constexpr float signedExpMultiple = bNegateInput ? -k_expMultiple : k_expMultiple;
+      const int32x4_t product = vcvtq_s32_f32(vmulq_n_f32(val.m_data, signedExpMultiple));
+      const int32x4_t retInt = vaddq_s32(product, vdupq_n_s32(addExpSchraudolphTerm));
+      Neon_32_Float result = Neon_32_Float(vreinterpretq_f32_s32(retInt));
+      if(bSpecialCaseZero) {
+         result = IfThenElse(Neon_32_Float(0.0f) == val, Neon_32_Float(1.0f), result);
+      }
+      if(bOverflowPossible) {
+         if(bNegateInput) {
+            result = IfThenElse(val < Neon_32_Float(-k_expOverflowPoint), std::numeric_limits<T>::infinity(), result);
+         } else {
+            result = IfThenElse(Neon_32_Float(k_expOverflowPoint) < val, std::numeric_limits<T>::infinity(), result);
+         }
+      }
+      if(bUnderflowPossible) {
+         if(bNegateInput) {
+            result = IfThenElse(Neon_32_Float(-k_expUnderflowPoint) < val, Neon_32_Float(0.0f), result);
+         } else {
+            result = IfThenElse(val < Neon_32_Float(k_expUnderflowPoint), Neon_32_Float(0.0f), result);
+         }
+      }
+      if(bNaNPossible) {
+         result = IfThenElse(IsNaN(val), val, result);
+      }
+      return result;
+   }
+
+   template<bool bUseApprox,
+         bool bNegateOutput = false,
+         bool bNaNPossible = true,
+         bool bNegativePossible = true,
+         bool bZeroPossible = true, // if false, positive zero returns a big negative number, negative zero returns a
+                                    // big positive number
+         bool bPositiveInfinityPossible = true, // if false, +inf returns a big positive number.  If val can be a
+                                                // double that is above the largest representable float, then setting
+                                                // this is necessary to avoid undefined behavior
+         typename std::enable_if<!bUseApprox, int>::type = 0>
+   static inline Neon_32_Float ApproxLog(
+         const Neon_32_Float& val, const float addLogSchraudolphTerm = k_logTermLowerBoundInputCloseToOne) noexcept {
+      UNUSED(addLogSchraudolphTerm);
+      return Log<bNegateOutput, bNaNPossible, bNegativePossible, bZeroPossible, bPositiveInfinityPossible>(val);
+   }
+
+   template<bool bUseApprox,
+         bool bNegateOutput = false,
+         bool bNaNPossible = true,
+         bool bNegativePossible = true,
+         bool bZeroPossible = true, // if false, positive zero returns a big negative number, negative zero returns a
+                                    // big positive number
+         bool bPositiveInfinityPossible = true, // if false, +inf returns a big positive number.  If val can be a
+                                                // double that is above the largest representable float, then setting
+                                                // this is necessary to avoid undefined behavior
+         typename std::enable_if<bUseApprox, int>::type = 0>
+   static inline Neon_32_Float ApproxLog(
+         const Neon_32_Float& val, const float addLogSchraudolphTerm = k_logTermLowerBoundInputCloseToOne) noexcept {
+      // This is the SIMD equivalent of LogApproxSchraudolph in approximate_math.hpp
+      Neon_32_Float result = Neon_32_Float(vcvtq_f32_s32(vreinterpretq_s32_f32(val.m_data)));
+      if(bNaNPossible) {
+         if(bPositiveInfinityPossible) {
+            result = IfThenElse(val < std::numeric_limits<T>::infinity(), result, val);
+         } else {
+            result = IfThenElse(IsNaN(val), val, result);
+         }
+      } else {
+         if(bPositiveInfinityPossible) {
+            result = IfThenElse(std::numeric_limits<T>::infinity() == val, val, result);
+         }
+      }
+      if(bNegateOutput) {
+         result = FusedMultiplyAdd(result, Neon_32_Float(-k_logMultiple), Neon_32_Float(-addLogSchraudolphTerm));
+      } else {
+         result = FusedMultiplyAdd(result, Neon_32_Float(k_logMultiple), Neon_32_Float(addLogSchraudolphTerm));
+      }
+      if(bZeroPossible) {
+         result = IfThenElse(val < std::numeric_limits<T>::min(),
+               bNegateOutput ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity(),
+               result);
+      }
+      if(bNegativePossible) {
+         result = IfThenElse(val < Neon_32_Float(0.0f), std::numeric_limits<T>::quiet_NaN(), result);
+      }
+      return result;
+   }
+
+   friend inline T Sum(const Neon_32_Float& val) noexcept {
+      return vaddvq_f32(val.m_data);
+   }
+
+   template<typename TObjective,
+         bool bCollapsed,
+         bool bValidation,
+         bool bWeight,
+         bool bHessian,
+         bool bUseApprox,
+         size_t cCompilerScores>
+   INLINE_RELEASE_TEMPLATED static ErrorEbm OperatorApplyUpdate(
+         const Objective* const pObjective, ApplyUpdateBridge* const pData) noexcept {
+      RemoteApplyUpdate<TObjective, bCollapsed, bValidation, bWeight, bHessian, bUseApprox, cCompilerScores>(
+            pObjective, pData);
+      return Error_None;
+   }
+
+   template<bool bHessian, bool bWeight, bool bCollapsed, size_t cCompilerScores, bool bParallel>
+   INLINE_RELEASE_TEMPLATED static ErrorEbm OperatorBinSumsBoosting(BinSumsBoostingBridge* const pParams) noexcept {
+      RemoteBinSumsBoosting<Neon_32_Float, bHessian, bWeight, bCollapsed, cCompilerScores, bParallel>(pParams);
+      return Error_None;
+   }
+
+   template<bool bHessian, bool bWeight, size_t cCompilerScores, size_t cCompilerDimensions>
+   INLINE_RELEASE_TEMPLATED static ErrorEbm OperatorBinSumsInteraction(
+         BinSumsInteractionBridge* const pParams) noexcept {
+      RemoteBinSumsInteraction<Neon_32_Float, bHessian, bWeight, cCompilerScores, cCompilerDimensions>(pParams);
+      return Error_None;
+   }
+
+ private:
+   TPack m_data;
+};
+static_assert(std::is_standard_layout<Neon_32_Float>::value && std::is_trivially_copyable<Neon_32_Float>::value,
+      "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
+
+template<bool bNegateInput, bool bNaNPossible, bool bUnderflowPossible, bool bOverflowPossible>
+inline Neon_32_Float Exp(const Neon_32_Float& val) noexcept {
+   return Exp32<Neon_32_Float, bNegateInput, bNaNPossible, bUnderflowPossible, bOverflowPossible>(val);
+}
+
+template<bool bNegateOutput,
+      bool bNaNPossible,
+      bool bNegativePossible,
+      bool bZeroPossible,
+      bool bPositiveInfinityPossible>
+inline Neon_32_Float Log(const Neon_32_Float& val) noexcept {
+   return Log32<Neon_32_Float,
+         bNegateOutput,
+         bNaNPossible,
+         bNegativePossible,
+         bZeroPossible,
+         bPositiveInfinityPossible>(val);
+}
+
+// a subset can be processed in chunks that begin at any SIMD pack, so the per-sample arrays are only pack aligned
+static constexpr size_t k_cBytesSamplesAlignment = sizeof(Neon_32_Float::T) * size_t{Neon_32_Float::k_cSIMDPack};
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm ApplyUpdate_Neon_32(
+      const ObjectiveWrapper* const pObjectiveWrapper, ApplyUpdateBridge* const pData) {
+   const Objective* const pObjective = static_cast<const Objective*>(pObjectiveWrapper->m_pObjective);
+   const APPLY_UPDATE_CPP pApplyUpdateCpp =
+         (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pApplyUpdateCpp;
+
+   // all our memory should be aligned. It is required by SIMD for correctness or performance
+   EBM_ASSERT(IsAligned(pData->m_aMulticlassMidwayTemp));
+   EBM_ASSERT(IsAligned(pData->m_aUpdateTensorScores));
+   EBM_ASSERT(IsAligned(pData->m_aPacked, k_cBytesSamplesAlignment));
+   EBM_ASSERT(
+         IsAligned(pData->m_aTargets, pObjectiveWrapper->m_cTargetBytes * size_t{Neon_32_Float::k_cSIMDPack}));
+   EBM_ASSERT(IsAligned(pData->m_aWeights, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pData->m_aSampleScores, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pData->m_aGradientsAndHessians, k_cBytesSamplesAlignment));
+
+   return (*pApplyUpdateCpp)(pObjective, pData);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsBoosting_Neon_32(
+      const ObjectiveWrapper* const pObjectiveWrapper, BinSumsBoostingBridge* const pParams) {
+   const BIN_SUMS_BOOSTING_CPP pBinSumsBoostingCpp =
+         (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsBoostingCpp;
+
+   // all our memory should be aligned. It is required by SIMD for correctness or performance
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aPacked, k_cBytesSamplesAlignment));
+   EBM_ASSERT(IsAligned(pParams->m_aFastBins));
+
+   return (*pBinSumsBoostingCpp)(pParams);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsInteraction_Neon_32(
+      const ObjectiveWrapper* const pObjectiveWrapper, BinSumsInteractionBridge* const pParams) {
+   const BIN_SUMS_INTERACTION_CPP pBinSumsInteractionCpp =
+         (static_cast<FunctionPointersCpp*>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsInteractionCpp;
+
+#ifndef NDEBUG
+   // all our memory should be aligned. It is required by SIMD for correctness or performance
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights));
+   EBM_ASSERT(IsAligned(pParams->m_aFastBins));
+   for(size_t iDebug = 0; iDebug < pParams->m_cRuntimeRealDimensions; ++iDebug) {
+      EBM_ASSERT(IsAligned(pParams->m_aaPacked[iDebug]));
+   }
+#endif // NDEBUG
+
+   return (*pBinSumsInteractionCpp)(pParams);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateObjective_Neon_32(const Config* const pConfig,
+      const char* const sObjective,
+      const char* const sObjectiveEnd,
+      ObjectiveWrapper* const pObjectiveWrapperOut) {
+   pObjectiveWrapperOut->m_pApplyUpdateC = ApplyUpdate_Neon_32;
+   pObjectiveWrapperOut->m_pBinSumsBoostingC = BinSumsBoosting_Neon_32;
+   pObjectiveWrapperOut->m_pBinSumsInteractionC = BinSumsInteraction_Neon_32;
+   ErrorEbm error = ComputeWrapper<Neon_32_Float>::FillWrapper(pObjectiveWrapperOut);
+   if(Error_None != error) {
+      return error;
+   }
+   return Objective::CreateObjective<Neon_32_Float>(pConfig, sObjective, sObjectiveEnd, pObjectiveWrapperOut);
+}
+
+} // namespace DEFINED_ZONE_NAME
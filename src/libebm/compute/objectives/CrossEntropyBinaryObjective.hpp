@@ -4,7 +4,102 @@
 
 // !! To add a new objective in C++ follow the steps at the top of the "objective_registrations.hpp" file !!
 
+// Do not use this file as a reference for other objectives. CrossEntropy is special.
+
+// CrossEntropy is LogLoss where the targets are probabilities in the range [0, 1] instead of class labels, which
+// is useful for distillation and for labels that were averaged across annotators. The logit link would normally
+// make this a classification task with integer targets, so we declare the regression task ourselves to get float
+// targets through the shared dataset and the generic ChildApplyUpdate.
+
 // TFloat could be double, float, or some SIMD intrinsic type
 template<typename TFloat> struct CrossEntropyBinaryObjective : BinaryObjective {
-   // this one needs to be special cased!
+   using TFloatInternal = TFloat;
+   static constexpr bool k_bRmse = false;
+   static constexpr bool k_bHessian = true;
+   static constexpr bool k_bHasApprox = false;
+   static constexpr BoolEbm k_bMaximizeMetric = MINIMIZE_METRIC;
+   static constexpr LinkEbm k_linkFunction = Link_logit;
+   static constexpr TaskEbm k_task = Task_Regression;
+   static constexpr int k_cItemsPerBitPackMax = 64;
+   static constexpr int k_cItemsPerBitPackMin = 1;
+   static ErrorEbm StaticApplyUpdate(const Objective* const pThis, ApplyUpdateBridge* const pData) {
+      return (static_cast<const CrossEntropyBinaryObjective<TFloat>*>(pThis))
+            ->ParentApplyUpdate<const CrossEntropyBinaryObjective<TFloat>>(pData);
+   }
+   template<typename T = void, typename std::enable_if<AccelerationFlags_NONE == TFloat::k_zone, T>::type* = nullptr>
+   static double StaticFinishMetric(const Objective* const pThis, const double metricSum) {
+      return (static_cast<const CrossEntropyBinaryObjective<TFloat>*>(pThis))->FinishMetric(metricSum);
+   }
+   template<typename T = void, typename std::enable_if<AccelerationFlags_NONE == TFloat::k_zone, T>::type* = nullptr>
+   static BoolEbm StaticCheckTargets(const Objective* const pThis, const size_t c, const void* const aTargets) {
+      return (static_cast<const CrossEntropyBinaryObjective<TFloat>*>(pThis))
+            ->ParentCheckTargets<const CrossEntropyBinaryObjective<TFloat>>(c, aTargets);
+   }
+   void FillWrapper(const AccelerationFlags zones, void* const pWrapperOut) noexcept {
+      FillObjectiveWrapper<CrossEntropyBinaryObjective>(zones, pWrapperOut);
+   }
+
+   OBJECTIVE_TEMPLATE_BOILERPLATE
+
+   inline CrossEntropyBinaryObjective(const Config& config) {
+      if(1 != config.cOutputs) {
+         throw ParamMismatchWithConfigException();
+      }
+   }
+
+   inline bool CheckRegressionTarget(const double target) const noexcept {
+      // written so that NaN fails both comparisons
+      return !(0.0 <= target && target <= 1.0);
+   }
+
+   inline double LinkParam() const noexcept { return std::numeric_limits<double>::quiet_NaN(); }
+
+   inline double LearningRateAdjustmentDifferentialPrivacy() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double LearningRateAdjustmentGradientBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double LearningRateAdjustmentHessianBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double GainAdjustmentGradientBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double GainAdjustmentHessianBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double GradientConstant() const noexcept { return 1.0; }
+
+   inline double HessianConstant() const noexcept { return 1.0; }
+
+   inline double FinishMetric(const double metricSum) const noexcept { return metricSum; }
+
+   GPU_DEVICE inline TFloat CalcMetric(const TFloat& score, const TFloat& target) const noexcept {
+      // -t*log(p) - (1-t)*log(1-p) simplifies to log(1 + exp(score)) - t*score. We write the softplus as
+      // max(score, 0) + log(1 + exp(-|score|)) so that exp cannot overflow for large scores.
+      const TFloat absScore = Abs(score);
+      const TFloat positivePart = (score + absScore) * 0.5;
+      const TFloat softplus = positivePart + Log(1.0 + Exp(-absScore));
+      return softplus - target * score;
+   }
+
+   GPU_DEVICE inline TFloat CalcGradient(const TFloat& score, const TFloat& target) const noexcept {
+      const TFloat prediction = 1.0 / (1.0 + Exp(-score)); // logit link function
+      const TFloat gradient = prediction - target;
+      return gradient;
+   }
+
+   GPU_DEVICE inline GradientHessian<TFloat> CalcGradientHessian(
+         const TFloat& score, const TFloat& target) const noexcept {
+      const TFloat prediction = 1.0 / (1.0 + Exp(-score)); // logit link function
+      const TFloat gradient = prediction - target;
+      const TFloat hessian = prediction * (1.0 - prediction);
+      return MakeGradientHessian(gradient, hessian);
+   }
 };
@@ -9,11 +9,23 @@
 template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
    OBJECTIVE_CONSTANTS_BOILERPLATE(LogLossBinaryObjective, MINIMIZE_METRIC, Link_logit, true, true, 64, 1)
 
-   inline LogLossBinaryObjective(const Config& config) {
+   // the targets are 0 or 1, so they are stored as bytes instead of full width integers
+   static constexpr bool k_bByteTargets = true;
+
+   // The constructor parameters following config must match the RegisterObjective parameters in
+   // objective_registrations.hpp
+   inline LogLossBinaryObjective(const Config& config, const double maxExpError) {
       if(1 != config.cOutputs) {
          // we share the tag "log_loss" with multiclass classification
          throw SkipRegistrationException();
       }
+
+      // max_exp_error is shared with multiclass, which is where the reduced exp pays off. We make only one exp call
+      // per sample, so we always stay within the requested bound by using the full precision exp.
+      if(!(0.0 <= maxExpError)) {
+         // written so that NaN fails too
+         throw ParamValOutOfRangeException();
+      }
    }
 
    inline double LinkParam() const noexcept { return std::numeric_limits<double>::quiet_NaN(); }
@@ -63,6 +75,18 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
       UNUSED(target);
    }
 
+   GPU_DEVICE inline static void AddAucBin(
+         double* const aAucBins, const double score, const bool bPositive, const double weight) noexcept {
+      const double bucket = (score + AUC_SCORE_MAX) * (static_cast<double>(AUC_BINS_COUNT) / (2.0 * AUC_SCORE_MAX));
+      // NaN fails the comparison and lands in the lowest bucket
+      size_t iBin = 0;
+      if(0.0 < bucket) {
+         iBin = bucket < static_cast<double>(AUC_BINS_COUNT - 1) ? static_cast<size_t>(bucket) :
+                                                                   size_t{AUC_BINS_COUNT - 1};
+      }
+      aAucBins[size_t{2} * iBin + (bPositive ? size_t{1} : size_t{0})] += weight;
+   }
+
    template<bool bCollapsed,
          bool bValidation,
          bool bWeight,
@@ -73,7 +97,8 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
    GPU_DEVICE NEVER_INLINE void InjectedApplyUpdate(ApplyUpdateBridge* const pData) const {
       static_assert(k_oneScore == cCompilerScores, "We special case the classifiers so do not need to handle them");
       static_assert(!bValidation || !bHessian, "bHessian can only be true if bValidation is false");
-      static_assert(bValidation || !bWeight, "bWeight can only be true if bValidation is true");
+      // weights on the training set are the out of bag weights, which only the metric uses
+      static constexpr bool bMetric = bValidation || bWeight;
 
       static constexpr bool bFixedSizePack = k_cItemsPerBitPackUndefined != cCompilerPack;
 
@@ -101,6 +126,7 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
       int cShiftReset;
       typename TFloat::TInt maskBits;
       const typename TFloat::TInt::T* pInputData;
+      const typename TFloat::TInt::T* pPrefetchEnd;
 
       TFloat updateScore;
 
@@ -125,6 +151,7 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
 #ifndef GPU_COMPILE
          EBM_ASSERT(nullptr != pInputData);
 #endif // GPU_COMPILE
+         pPrefetchEnd = GetApplyUpdatePrefetchEnd<TFloat>(pData, cItemsPerBitPack, size_t{1});
 
          cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
          if(bFixedSizePack) {
@@ -142,13 +169,14 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
          }
       }
 
-      const typename TFloat::TInt::T* pTargetData =
-            reinterpret_cast<const typename TFloat::TInt::T*>(pData->m_aTargets);
+      const uint8_t* pTargetData = reinterpret_cast<const uint8_t*>(pData->m_aTargets);
 
       const typename TFloat::T* pWeight;
       TFloat metricSum;
+      double* aAucBins;
       typename TFloat::T* pGradientAndHessian;
-      if(bValidation) {
+      if(bMetric) {
+         aAucBins = pData->m_aAucBins;
          if(bWeight) {
             pWeight = reinterpret_cast<const typename TFloat::T*>(pData->m_aWeights);
 #ifndef GPU_COMPILE
@@ -156,7 +184,8 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
 #endif // GPU_COMPILE
          }
          metricSum = 0.0;
-      } else {
+      }
+      if(!bValidation) {
          pGradientAndHessian = reinterpret_cast<typename TFloat::T*>(pData->m_aGradientsAndHessians);
 #ifndef GPU_COMPILE
          EBM_ASSERT(nullptr != pGradientAndHessian);
@@ -165,6 +194,14 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
       do {
          typename TFloat::TInt iTensorBinCombined;
          if(!bCollapsed) {
+            if(pInputData < pPrefetchEnd) {
+               PrefetchUpdateScores<TFloat>(aUpdateTensorScores,
+                     pInputData + k_cApplyUpdatePrefetchWords * size_t{TFloat::TInt::k_cSIMDPack},
+                     maskBits,
+                     cBitsPerItemMax,
+                     cShiftReset,
+                     size_t{1});
+            }
             iTensorBinCombined = TFloat::TInt::Load(pInputData);
             pInputData += TFloat::TInt::k_cSIMDPack;
          }
@@ -177,15 +214,13 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
          while(true) {
             TFloat sampleScore = TFloat::Load(pSampleScore);
 
-            const typename TFloat::TInt target = TFloat::TInt::Load(pTargetData);
+            const typename TFloat::TInt target = TFloat::TInt::LoadBytes(pTargetData);
             pTargetData += TFloat::TInt::k_cSIMDPack;
 
             TFloat weight;
-            if(bValidation) {
-               if(bWeight) {
-                  weight = TFloat::Load(pWeight);
-                  pWeight += TFloat::k_cSIMDPack;
-               }
+            if(bWeight) {
+               weight = TFloat::Load(pWeight);
+               pWeight += TFloat::k_cSIMDPack;
             }
 
             // TODO: the speed of this loop can probably be improved by (AFTER eliminating the target by sorting the
@@ -211,7 +246,7 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
             sampleScore.Store(pSampleScore);
             pSampleScore += TFloat::k_cSIMDPack;
 
-            if(bValidation) {
+            if(bMetric) {
                // TODO: similar to the gradient calculation above, once we sort our data by the target values we
                //       will be able to pass all the targets==0 and target==1 in to a single call to this function
                //       and we can therefore template the target value.  We can then call ApproxExp
@@ -229,7 +264,34 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
                } else {
                   metricSum += metric;
                }
-            } else {
+
+               if(nullptr != aAucBins) {
+                  // samples within the SIMD pack can land in the same bucket, so serialize the histogram updates
+                  if(bWeight) {
+                     TFloat::Execute(
+                           [aAucBins](int,
+                                 const typename TFloat::T score,
+                                 const typename TFloat::TInt::T targetLane,
+                                 const typename TFloat::T weightLane) {
+                              AddAucBin(aAucBins,
+                                    static_cast<double>(score),
+                                    0 != targetLane,
+                                    static_cast<double>(weightLane));
+                           },
+                           sampleScore,
+                           target,
+                           weight);
+                  } else {
+                     TFloat::Execute(
+                           [aAucBins](int, const typename TFloat::T score, const typename TFloat::TInt::T targetLane) {
+                              AddAucBin(aAucBins, static_cast<double>(score), 0 != targetLane, 1.0);
+                           },
+                           sampleScore,
+                           target);
+                  }
+               }
+            }
+            if(!bValidation) {
                // gradient will be 0.0 if we perfectly predict the target with 100% certainty.
                //    To do so, sampleScore would need to be either +infinity or -infinity
                // gradient will be +1.0 if actual value was 1 but we incorrectly predicted with
@@ -368,7 +430,7 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
          }
       } while(pSampleScoresEnd != pSampleScore);
 
-      if(bValidation) {
+      if(bMetric) {
          pData->m_metricOut += static_cast<double>(Sum(metricSum));
       }
    }
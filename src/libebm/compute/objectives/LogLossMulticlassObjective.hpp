@@ -16,8 +16,11 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
          k_cItemsPerBitPackUndefined)
 
    double m_hessianFactor;
+   int m_cExpDegree;
 
-   inline LogLossMulticlassObjective(const Config& config) {
+   // The constructor parameters following config must match the RegisterObjective parameters in
+   // objective_registrations.hpp
+   inline LogLossMulticlassObjective(const Config& config, const double maxExpError) {
       if(1 == config.cOutputs) {
          // we share the tag "log_loss" with binary classification
          throw SkipRegistrationException();
@@ -36,6 +39,15 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
       // Ping Li paper (algorithm #1, line 5, (K - 1) / K )
       // https://arxiv.org/pdf/1006.5051.pdf
       m_hessianFactor = static_cast<double>(config.cOutputs) / static_cast<double>(config.cOutputs - 1);
+
+      // max_exp_error is the relative error we allow in the exp of the softmax. Zero (the default) keeps the full
+      // precision exp. Larger values select a shorter polynomial, which matters here because multiclass calls exp
+      // cScores times per sample and the exp dominates the update for large cScores.
+      if(!(0.0 <= maxExpError)) {
+         // written so that NaN fails too
+         throw ParamValOutOfRangeException();
+      }
+      m_cExpDegree = GetExpReducedDegree(maxExpError);
    }
 
    inline double LinkParam() const noexcept { return std::numeric_limits<double>::quiet_NaN(); }
@@ -92,10 +104,46 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
          bool bUseApprox,
          size_t cCompilerScores,
          int cCompilerPack>
-   GPU_DEVICE NEVER_INLINE void InjectedApplyUpdate(ApplyUpdateBridge* const pData) const {
+   GPU_DEVICE INLINE_ALWAYS void InjectedApplyUpdate(ApplyUpdateBridge* const pData) const {
+      // the Schraudolph approximation (bUseApprox) already trades away more accuracy than any of our polynomials
+      if(bUseApprox || 0 == m_cExpDegree) {
+         ApplyUpdateExp<bCollapsed, bValidation, bWeight, bHessian, bUseApprox, cCompilerScores, cCompilerPack, 0>(
+               pData);
+      } else if(3 == m_cExpDegree) {
+         ApplyUpdateExp<bCollapsed,
+               bValidation,
+               bWeight,
+               bHessian,
+               bUseApprox,
+               cCompilerScores,
+               cCompilerPack,
+               bUseApprox ? 0 : 3>(pData);
+      } else {
+         EBM_ASSERT(4 == m_cExpDegree);
+         ApplyUpdateExp<bCollapsed,
+               bValidation,
+               bWeight,
+               bHessian,
+               bUseApprox,
+               cCompilerScores,
+               cCompilerPack,
+               bUseApprox ? 0 : 4>(pData);
+      }
+   }
+
+   template<bool bCollapsed,
+         bool bValidation,
+         bool bWeight,
+         bool bHessian,
+         bool bUseApprox,
+         size_t cCompilerScores,
+         int cCompilerPack,
+         int cExpDegree>
+   GPU_DEVICE NEVER_INLINE void ApplyUpdateExp(ApplyUpdateBridge* const pData) const {
       static_assert(k_dynamicScores == cCompilerScores || 2 <= cCompilerScores, "Multiclass needs more than 1 score");
       static_assert(!bValidation || !bHessian, "bHessian can only be true if bValidation is false");
-      static_assert(bValidation || !bWeight, "bWeight can only be true if bValidation is true");
+      // weights on the training set are the out of bag weights, which only the metric uses
+      static constexpr bool bMetric = bValidation || bWeight;
 
       static constexpr bool bDynamic = k_dynamicScores == cCompilerScores;
       static constexpr bool bFixedSizePack = k_cItemsPerBitPackUndefined != cCompilerPack;
@@ -133,6 +181,7 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
       int cShiftReset;
       typename TFloat::TInt maskBits;
       const typename TFloat::TInt::T* pInputData;
+      const typename TFloat::TInt::T* pPrefetchEnd;
       typename TFloat::TInt::T cCastScores;
       typename TFloat::TInt iTensorBin;
 
@@ -155,6 +204,7 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
 #ifndef GPU_COMPILE
          EBM_ASSERT(nullptr != pInputData);
 #endif // GPU_COMPILE
+         pPrefetchEnd = GetApplyUpdatePrefetchEnd<TFloat>(pData, cItemsPerBitPack, cScores);
 
          cCastScores = static_cast<typename TFloat::TInt::T>(cScores);
 
@@ -190,7 +240,7 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
       const typename TFloat::T* pWeight;
       TFloat metricSum;
       typename TFloat::T* pGradientAndHessian;
-      if(bValidation) {
+      if(bMetric) {
          if(bWeight) {
             pWeight = reinterpret_cast<const typename TFloat::T*>(pData->m_aWeights);
 #ifndef GPU_COMPILE
@@ -198,7 +248,8 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
 #endif // GPU_COMPILE
          }
          metricSum = 0.0;
-      } else {
+      }
+      if(!bValidation) {
          pGradientAndHessian = reinterpret_cast<typename TFloat::T*>(pData->m_aGradientsAndHessians);
 #ifndef GPU_COMPILE
          EBM_ASSERT(nullptr != pGradientAndHessian);
@@ -207,6 +258,14 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
       do {
          typename TFloat::TInt iTensorBinCombined;
          if(!bCollapsed) {
+            if(pInputData < pPrefetchEnd) {
+               PrefetchUpdateScores<TFloat>(aUpdateTensorScores,
+                     pInputData + k_cApplyUpdatePrefetchWords * size_t{TFloat::TInt::k_cSIMDPack},
+                     maskBits,
+                     cBitsPerItemMax,
+                     cShiftReset,
+                     cScores);
+            }
             iTensorBinCombined = TFloat::TInt::Load(pInputData);
             pInputData += TFloat::TInt::k_cSIMDPack;
          }
@@ -228,7 +287,14 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
             // Probably we want to put the code below inside the loop into an inline function that we can call
             // either at the start during init or the end once the rest is done.. not sure which.
 
+            typename TFloat::TInt target = TFloat::TInt::Load(pTargetData);
+            pTargetData += TFloat::TInt::k_cSIMDPack;
+
             TFloat sumExp = 0.0;
+            TFloat targetScore;
+            if(bMetric && !bUseApprox) {
+               targetScore = 0.0;
+            }
             size_t iScore1 = 0;
             do {
                TFloat updateScore;
@@ -245,31 +311,42 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
                sampleScore.Store(pSampleScore);
                pSampleScore += TFloat::k_cSIMDPack;
 
-               const TFloat oneExp = TFloat::template ApproxExp<bUseApprox, false>(sampleScore);
-               oneExp.Store(&aExps[iScore1 << TFloat::k_cSIMDShift]);
+               const TFloat oneExp = ExpForDegree<TFloat, bUseApprox, cExpDegree>(sampleScore);
+               if(bMetric && !bUseApprox) {
+                  // keep the target's score in a register instead of gathering its exp from memory afterwards
+                  targetScore = IfThenElse(target == static_cast<typename TFloat::TInt::T>(iScore1),
+                        sampleScore,
+                        targetScore);
+               }
+               if(!bValidation || bUseApprox) {
+                  // the gradients need every exp, and so does the approximate metric
+                  oneExp.Store(&aExps[iScore1 << TFloat::k_cSIMDShift]);
+               }
                sumExp += oneExp;
 
                ++iScore1;
             } while(cScores != iScore1);
 
-            typename TFloat::TInt target = TFloat::TInt::Load(pTargetData);
-            pTargetData += TFloat::TInt::k_cSIMDPack;
-
-            if(bValidation) {
-               // TODO: instead of writing the exp values to memory, since we just need 1 and the sum,
-               // we could use an if selector to keep only the one that matches our target and we don't need
-               // to store (or re-load) from memory.  This also saves us a gathering load, which will be expensive
-               // in latency
-
-               target = target << TFloat::k_cSIMDShift;
-               target = target + TFloat::TInt::MakeIndexes();
-
-               // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
-               // identical, so instead of calling LoadScattered we'll be able to call LoadAligned
-               const TFloat itemExp = TFloat::Load(aExps, target);
-               const TFloat invertedProbability = FastApproxDivide(sumExp, itemExp);
-               // zero and negative are impossible since 1.0 is the lowest possible value
-               TFloat metric = TFloat::template ApproxLog<bUseApprox, false, true, false, false>(invertedProbability);
+            if(bMetric) {
+               TFloat metric;
+               if(bUseApprox) {
+                  // Schraudolph's exp and log are only accurate for inputs close together, so keep the ratio. The
+                  // gradients below still need the unshifted target
+                  const typename TFloat::TInt iTargetExp =
+                        (target << TFloat::k_cSIMDShift) + TFloat::TInt::MakeIndexes();
+
+                  // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
+                  // identical, so instead of calling LoadScattered we'll be able to call LoadAligned
+                  const TFloat itemExp = TFloat::Load(aExps, iTargetExp);
+                  const TFloat invertedProbability = FastApproxDivide(sumExp, itemExp);
+                  // zero and negative are impossible since 1.0 is the lowest possible value
+                  metric = TFloat::template ApproxLog<bUseApprox, false, true, false, false>(invertedProbability);
+               } else {
+                  // log(sumExp / exp(targetScore)) is the log-sum-exp minus the target's score, which needs no
+                  // division and no gather. sumExp includes exp(targetScore), so it can only be zero if every
+                  // score underflows.
+                  metric = TFloat::template ApproxLog<false, false, true, false, false>(sumExp) - targetScore;
+               }
 
                if(bWeight) {
                   const TFloat weight = TFloat::Load(pWeight);
@@ -278,7 +355,8 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
                } else {
                   metricSum += metric;
                }
-            } else {
+            }
+            if(!bValidation) {
                // this Reciprocal is fast and is more SIMD-able, but it does create some complications.
                // When sumExp gets somewhat large, arround +4.5 or above, then the sumExp can get to be something
                // in the order of +100.  The inverse of that is around 0.01. We can then later multiply a number
@@ -365,7 +443,7 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
          }
       } while(pSampleScoresEnd != pSampleScore);
 
-      if(bValidation) {
+      if(bMetric) {
          pData->m_metricOut += static_cast<double>(Sum(metricSum));
       }
    }
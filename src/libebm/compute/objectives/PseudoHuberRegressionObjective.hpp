@@ -9,6 +9,9 @@
 template<typename TFloat> struct PseudoHuberRegressionObjective : RegressionObjective {
    OBJECTIVE_BOILERPLATE(PseudoHuberRegressionObjective, MINIMIZE_METRIC, Link_identity, true)
 
+   // the hessian is in (0, 1], so HessianConstant bounds it
+   static constexpr bool k_bConstantHessian = true;
+
    TFloat m_deltaInverted;
    double m_deltaSquared;
 
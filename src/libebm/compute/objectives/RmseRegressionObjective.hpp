@@ -114,7 +114,8 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
    GPU_DEVICE NEVER_INLINE void InjectedApplyUpdate(ApplyUpdateBridge* const pData) const {
       static_assert(k_oneScore == cCompilerScores, "for RMSE regression there should always be one score");
       static_assert(!bHessian, "for RMSE regression we should never need the hessians");
-      static_assert(bValidation || !bWeight, "bWeight can only be true if bValidation is true");
+      // weights on the training set are the out of bag weights, which only the metric uses
+      static constexpr bool bMetric = bValidation || bWeight;
       static_assert(!bUseApprox, "Approximations cannot be enabled on RMSE since there are none on RMSE");
 
       static constexpr bool bFixedSizePack = k_cItemsPerBitPackUndefined != cCompilerPack;
@@ -144,6 +145,7 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
       int cShiftReset;
       typename TFloat::TInt maskBits;
       const typename TFloat::TInt::T* pInputData;
+      const typename TFloat::TInt::T* pPrefetchEnd;
 
       TFloat updateScore;
 
@@ -168,6 +170,7 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
 #ifndef GPU_COMPILE
          EBM_ASSERT(nullptr != pInputData);
 #endif // GPU_COMPILE
+         pPrefetchEnd = GetApplyUpdatePrefetchEnd<TFloat>(pData, cItemsPerBitPack, size_t{1});
 
          cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
          if(bFixedSizePack) {
@@ -187,7 +190,7 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
 
       const typename TFloat::T* pWeight;
       TFloat metricSum;
-      if(bValidation) {
+      if(bMetric) {
          if(bWeight) {
             pWeight = reinterpret_cast<const typename TFloat::T*>(pData->m_aWeights);
 #ifndef GPU_COMPILE
@@ -208,6 +211,14 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
 
          typename TFloat::TInt iTensorBinCombined;
          if(!bCollapsed) {
+            if(pInputData < pPrefetchEnd) {
+               PrefetchUpdateScores<TFloat>(aUpdateTensorScores,
+                     pInputData + k_cApplyUpdatePrefetchWords * size_t{TFloat::TInt::k_cSIMDPack},
+                     maskBits,
+                     cBitsPerItemMax,
+                     cShiftReset,
+                     size_t{1});
+            }
             iTensorBinCombined = TFloat::TInt::Load(pInputData);
             pInputData += TFloat::TInt::k_cSIMDPack;
          }
@@ -221,12 +232,9 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
             TFloat gradient = TFloat::Load(pGradient);
 
             TFloat weight;
-            if(bValidation) {
-               // we use RMSE so get the squared error part here
-               if(bWeight) {
-                  weight = TFloat::Load(pWeight);
-                  pWeight += TFloat::k_cSIMDPack;
-               }
+            if(bWeight) {
+               weight = TFloat::Load(pWeight);
+               pWeight += TFloat::k_cSIMDPack;
             }
 
             typename TFloat::TInt iTensorBin;
@@ -241,7 +249,7 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
             gradient.Store(pGradient);
             pGradient += TFloat::k_cSIMDPack;
 
-            if(bValidation) {
+            if(bMetric) {
                // we use RMSE so get the squared error part here
                if(bWeight) {
                   metricSum = FusedMultiplyAdd(gradient * gradient, weight, metricSum);
@@ -269,7 +277,7 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
          }
       } while(pGradientsEnd != pGradient);
 
-      if(bValidation) {
+      if(bMetric) {
          pData->m_metricOut += static_cast<double>(Sum(metricSum));
       }
    }
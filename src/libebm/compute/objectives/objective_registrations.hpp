@@ -33,6 +33,7 @@
 #include "PseudoHuberRegressionObjective.hpp"
 #include "LogLossBinaryObjective.hpp"
 #include "LogLossMulticlassObjective.hpp"
+#include "CrossEntropyBinaryObjective.hpp"
 
 // Add new *Objective type registrations to this list:
 template<typename TFloat> static const std::vector<std::shared_ptr<const Registration>> RegisterObjectives() {
@@ -48,7 +49,10 @@ template<typename TFloat> static const std::vector<std::shared_ptr<const Registr
          Register<TFloat, GammaDevianceRegressionObjective, AccelerationFlags_ALL>("gamma_deviance"),
          Register<TFloat, PseudoHuberRegressionObjective, AccelerationFlags_ALL>(
                "pseudo_huber", FloatParam("delta", 1.0)),
-         Register<TFloat, LogLossBinaryObjective, AccelerationFlags_ALL>("log_loss"),
-         Register<TFloat, LogLossMulticlassObjective, AccelerationFlags_ALL>("log_loss"),
+         Register<TFloat, LogLossBinaryObjective, AccelerationFlags_ALL>(
+               "log_loss", FloatParam("max_exp_error", 0.0)),
+         Register<TFloat, LogLossMulticlassObjective, AccelerationFlags_ALL>(
+               "log_loss", FloatParam("max_exp_error", 0.0)),
+         Register<TFloat, CrossEntropyBinaryObjective, AccelerationFlags_ALL>("cross_entropy"),
    };
 }
@@ -160,7 +160,133 @@ static bool IsFMA3() {
    return 0 != (abcd[2] & (1 << 12));
 }
 
+static size_t DetectL1DataCacheBytes() {
+   // returns 0 if the CPU does not report it
+   int abcd[4];
+   cpuid(abcd, 0);
+   const int functionMax = abcd[0];
+   // "GenuineIntel" is returned in ebx, edx, ecx
+   if(0x756e6547 == abcd[1] && 0x49656e69 == abcd[3] && 0x6c65746e == abcd[2]) {
+      if(4 <= functionMax) {
+         // deterministic cache parameters. Each subleaf describes one cache until a null type is returned
+         for(int iSubleaf = 0; iSubleaf < 16; ++iSubleaf) {
+            cpuid(abcd, 4, iSubleaf);
+            const unsigned int type = static_cast<unsigned int>(abcd[0]) & 0x1F;
+            if(0 == type) {
+               break;
+            }
+            const unsigned int level = (static_cast<unsigned int>(abcd[0]) >> 5) & 0x7;
+            if(1 == type && 1 == level) {
+               const size_t cWays = static_cast<size_t>((static_cast<unsigned int>(abcd[1]) >> 22) + 1);
+               const size_t cPartitions = static_cast<size_t>(((static_cast<unsigned int>(abcd[1]) >> 12) & 0x3FF) + 1);
+               const size_t cLineBytes = static_cast<size_t>((static_cast<unsigned int>(abcd[1]) & 0xFFF) + 1);
+               const size_t cSets = static_cast<size_t>(static_cast<unsigned int>(abcd[2])) + 1;
+               return cWays * cPartitions * cLineBytes * cSets;
+            }
+         }
+      }
+      return 0;
+   }
+   // AMD and most others report the L1 data cache in KB in the top byte of ecx of this extended function
+   cpuid(abcd, static_cast<int>(0x80000000));
+   if(static_cast<unsigned int>(abcd[0]) < 0x80000005) {
+      return 0;
+   }
+   cpuid(abcd, static_cast<int>(0x80000005));
+   return static_cast<size_t>(static_cast<unsigned int>(abcd[2]) >> 24) * size_t{1024};
+}
+
+#endif // INTEL_SIMD
+
+// the L1 data cache of most x86 CPUs from the last decade, and a safe guess for the others
+static constexpr size_t k_cBytesL1DataCacheDefault = size_t{32768};
+
+extern size_t GetL1DataCacheBytes() {
+   // detected once on first use and then shared by every booster
+   static const size_t cBytesL1DataCache = []() {
+      size_t cBytes = 0;
+#ifdef INTEL_SIMD
+      cBytes = DetectL1DataCacheBytes();
 #endif // INTEL_SIMD
+      // reject anything implausible rather than trust a hypervisor's or emulator's cpuid
+      if(cBytes < size_t{8192} || size_t{1048576} < cBytes) {
+         cBytes = k_cBytesL1DataCacheDefault;
+      }
+      LOG_N(Trace_Info, "INFO GetL1DataCacheBytes %zu", cBytes);
+      return cBytes;
+   }();
+   return cBytesL1DataCache;
+}
+
+EBM_API_BODY AccelerationFlags EBM_CALLING_CONVENTION GetAvailableAcceleration(void) {
+   // detected once on first use, like the L1 data cache
+   static const AccelerationFlags available = []() {
+      AccelerationFlags zones = AccelerationFlags_NONE;
+#ifdef BRIDGE_CUDA_32
+      if(EBM_FALSE != IsAvailable_Cuda_32()) {
+         zones |= AccelerationFlags_Nvidia;
+      }
+#endif // BRIDGE_CUDA_32
+#ifdef BRIDGE_AVX512F_32
+      if(9 <= DetectInstructionset()) {
+         zones |= AccelerationFlags_AVX512F;
+      }
+#endif // BRIDGE_AVX512F_32
+#ifdef BRIDGE_AVX2_32
+      if(8 <= DetectInstructionset() && IsFMA3()) {
+         zones |= AccelerationFlags_AVX2;
+      }
+#endif // BRIDGE_AVX2_32
+#ifdef BRIDGE_NEON_32
+      zones |= AccelerationFlags_NEON;
+#endif // BRIDGE_NEON_32
+      LOG_N(Trace_Info, "INFO GetAvailableAcceleration 0x%x", static_cast<unsigned int>(zones));
+      return zones;
+   }();
+   return available;
+}
+
+struct RegisteredObjective {
+   CreateObjectiveFunction m_createCpu;
+   CreateObjectiveFunction m_createAvx2;
+   CreateObjectiveFunction m_createAvx512f;
+};
+
+// objectives compiled outside of libebm. There are few of them in practice, so a fixed table is enough
+static constexpr size_t k_cRegisteredObjectivesMax = 64;
+static size_t g_cRegisteredObjectives = 0;
+static RegisteredObjective g_aRegisteredObjectives[k_cRegisteredObjectivesMax];
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION RegisterObjective(CreateObjectiveFunction createCpu,
+      CreateObjectiveFunction createAvx2,
+      CreateObjectiveFunction createAvx512f) {
+   LOG_N(Trace_Info,
+         "Entered RegisterObjective: "
+         "createCpu=%p, "
+         "createAvx2=%p, "
+         "createAvx512f=%p",
+         reinterpret_cast<void*>(createCpu),
+         reinterpret_cast<void*>(createAvx2),
+         reinterpret_cast<void*>(createAvx512f));
+
+   if(nullptr == createCpu) {
+      LOG_0(Trace_Error, "ERROR RegisterObjective nullptr == createCpu");
+      return Error_IllegalParamVal;
+   }
+   if(k_cRegisteredObjectivesMax <= g_cRegisteredObjectives) {
+      LOG_0(Trace_Error, "ERROR RegisterObjective k_cRegisteredObjectivesMax <= g_cRegisteredObjectives");
+      return Error_IllegalParamVal;
+   }
+
+   RegisteredObjective* const pRegisteredObjective = &g_aRegisteredObjectives[g_cRegisteredObjectives];
+   pRegisteredObjective->m_createCpu = createCpu;
+   pRegisteredObjective->m_createAvx2 = createAvx2;
+   pRegisteredObjective->m_createAvx512f = createAvx512f;
+   ++g_cRegisteredObjectives;
+
+   LOG_0(Trace_Info, "Exited RegisterObjective");
+   return Error_None;
+}
 
 extern ErrorEbm GetObjective(const Config* const pConfig,
       const char* sObjective,
@@ -188,9 +314,29 @@ extern ErrorEbm GetObjective(const Config* const pConfig,
 
    ErrorEbm error;
 
-   error = CreateObjective_Cpu_64(pConfig, sObjective, sObjectiveEnd, pCpuObjectiveWrapperOut);
-   if(Error_None != error) {
-      return error;
+   // the most recently registered objectives take priority so that they can replace earlier ones of the same name
+   const RegisteredObjective* pRegisteredObjective = nullptr;
+   for(size_t iRegisteredObjective = g_cRegisteredObjectives; 0 != iRegisteredObjective;) {
+      --iRegisteredObjective;
+      const RegisteredObjective* const pRegisteredObjectiveCur = &g_aRegisteredObjectives[iRegisteredObjective];
+      error = (*pRegisteredObjectiveCur->m_createCpu)(pConfig, sObjective, sObjectiveEnd, pCpuObjectiveWrapperOut);
+      if(Error_ObjectiveUnknown != error) {
+         if(Error_None != error) {
+            return error;
+         }
+         LOG_0(Trace_Info, "INFO GetObjective using a registered Objective");
+         pRegisteredObjective = pRegisteredObjectiveCur;
+         break;
+      }
+      EBM_ASSERT(nullptr == pCpuObjectiveWrapperOut->m_pObjective);
+      EBM_ASSERT(nullptr == pCpuObjectiveWrapperOut->m_pFunctionPointersCpp);
+   }
+
+   if(nullptr == pRegisteredObjective) {
+      error = CreateObjective_Cpu_64(pConfig, sObjective, sObjectiveEnd, pCpuObjectiveWrapperOut);
+      if(Error_None != error) {
+         return error;
+      }
    }
 
    const AccelerationFlags zones = static_cast<AccelerationFlags>(pCpuObjectiveWrapperOut->m_zones & acceleration);
@@ -198,18 +344,41 @@ extern ErrorEbm GetObjective(const Config* const pConfig,
    // when compiled with only CPU these variables are not used
    UNUSED(zones);
    UNUSED(pSIMDObjectiveWrapperOut);
+   UNUSED(pRegisteredObjective);
 
    do {
+#ifdef BRIDGE_CUDA_32
+      // registered objectives do not have CUDA kernels
+      if((AccelerationFlags_Nvidia & zones) && nullptr == pRegisteredObjective) {
+         LOG_0(Trace_Info, "INFO GetObjective checking for a CUDA device");
+         EBM_ASSERT(nullptr != pSIMDObjectiveWrapperOut);
+         if(EBM_FALSE != IsAvailable_Cuda_32()) {
+            LOG_0(Trace_Info, "INFO GetObjective creating CUDA Objective");
+            error = CreateObjective_Cuda_32(pConfig, sObjective, sObjectiveEnd, pSIMDObjectiveWrapperOut);
+            if(Error_None != error) {
+               return error;
+            }
+            pSIMDObjectiveWrapperOut->m_zone = AccelerationFlags_Nvidia;
+            break;
+         }
+      }
+#endif // BRIDGE_CUDA_32
+
 #ifdef BRIDGE_AVX512F_32
       if(AccelerationFlags_AVX512F & zones) {
          LOG_0(Trace_Info, "INFO GetObjective checking for AVX512F compatibility");
          EBM_ASSERT(nullptr != pSIMDObjectiveWrapperOut);
-         if(9 <= DetectInstructionset()) {
+         if(9 <= DetectInstructionset() &&
+               (nullptr == pRegisteredObjective || nullptr != pRegisteredObjective->m_createAvx512f)) {
             LOG_0(Trace_Info, "INFO GetObjective creating AVX512F SIMD Objective");
-            error = CreateObjective_Avx512f_32(pConfig, sObjective, sObjectiveEnd, pSIMDObjectiveWrapperOut);
+            error = nullptr == pRegisteredObjective ?
+                  CreateObjective_Avx512f_32(pConfig, sObjective, sObjectiveEnd, pSIMDObjectiveWrapperOut) :
+                  (*pRegisteredObjective->m_createAvx512f)(
+                        pConfig, sObjective, sObjectiveEnd, pSIMDObjectiveWrapperOut);
             if(Error_None != error) {
                return error;
             }
+            pSIMDObjectiveWrapperOut->m_zone = AccelerationFlags_AVX512F;
             break;
          }
       }
@@ -219,17 +388,36 @@ extern ErrorEbm GetObjective(const Config* const pConfig,
       if(AccelerationFlags_AVX2 & zones) {
          LOG_0(Trace_Info, "INFO GetObjective checking for AVX2 compatibility");
          EBM_ASSERT(nullptr != pSIMDObjectiveWrapperOut);
-         if(8 <= DetectInstructionset() && IsFMA3()) {
+         if(8 <= DetectInstructionset() && IsFMA3() &&
+               (nullptr == pRegisteredObjective || nullptr != pRegisteredObjective->m_createAvx2)) {
             LOG_0(Trace_Info, "INFO GetObjective creating AVX2 SIMD Objective");
-            error = CreateObjective_Avx2_32(pConfig, sObjective, sObjectiveEnd, pSIMDObjectiveWrapperOut);
+            error = nullptr == pRegisteredObjective ?
+                  CreateObjective_Avx2_32(pConfig, sObjective, sObjectiveEnd, pSIMDObjectiveWrapperOut) :
+                  (*pRegisteredObjective->m_createAvx2)(pConfig, sObjective, sObjectiveEnd, pSIMDObjectiveWrapperOut);
             if(Error_None != error) {
                return error;
             }
+            pSIMDObjectiveWrapperOut->m_zone = AccelerationFlags_AVX2;
             break;
          }
       }
 #endif // BRIDGE_AVX2_32
 
+#ifdef BRIDGE_NEON_32
+      // registered objectives do not have NEON kernels
+      if((AccelerationFlags_NEON & zones) && nullptr == pRegisteredObjective) {
+         // Advanced SIMD is a mandatory part of AArch64, so there is nothing to check at runtime
+         LOG_0(Trace_Info, "INFO GetObjective creating NEON SIMD Objective");
+         EBM_ASSERT(nullptr != pSIMDObjectiveWrapperOut);
+         error = CreateObjective_Neon_32(pConfig, sObjective, sObjectiveEnd, pSIMDObjectiveWrapperOut);
+         if(Error_None != error) {
+            return error;
+         }
+         pSIMDObjectiveWrapperOut->m_zone = AccelerationFlags_NEON;
+         break;
+      }
+#endif // BRIDGE_NEON_32
+
       LOG_0(Trace_Info, "INFO GetObjective no SIMD option found");
    } while(false);
 
@@ -0,0 +1,405 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "unzoned.h" // EbmMax
+#include "common.hpp" // IsConvertError
+
+#include "ebm_internal.hpp"
+#include "dataset_shared.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// The appended dataset is built through the same Fill functions that callers use, so it gets the same layout and
+// checks as any other dataset. Each section of the two datasets is unpacked into one shared column buffer, which
+// means the old samples are copied as bins and never need to be binned again.
+
+extern ErrorEbm GetAppendFeature(
+      const unsigned char* const pDataSetShared, const size_t iFeature, DataSetAppendFeature* const pFeatureOut) {
+   bool bSparse;
+   UIntShared defaultValSparse;
+   size_t cNonDefaultsSparse;
+   pFeatureOut->m_aFeatureData = GetDataSetSharedFeature(pDataSetShared,
+         iFeature,
+         &pFeatureOut->m_bMissing,
+         &pFeatureOut->m_bUnknown,
+         &pFeatureOut->m_bNominal,
+         &bSparse,
+         &pFeatureOut->m_cBins,
+         &defaultValSparse,
+         &cNonDefaultsSparse,
+         &pFeatureOut->m_cBytesExternal);
+   if(bSparse) {
+      LOG_0(Trace_Error, "ERROR GetAppendFeature sparse features are not supported");
+      return Error_IllegalParamVal;
+   }
+   return Error_None;
+}
+
+extern IntEbm GetCountBinsFill(const DataSetAppendFeature* const pFeature) {
+   // the shared dataset holds the bins without the missing and unknown bins that the feature does not use
+   return static_cast<IntEbm>(pFeature->m_cBins) + (pFeature->m_bMissing ? IntEbm{0} : IntEbm{1}) +
+         (pFeature->m_bUnknown ? IntEbm{0} : IntEbm{1});
+}
+
+extern void UnpackFeature(
+      const DataSetAppendFeature* const pFeature, const size_t cSamples, IntEbm* const aBinIndexes) {
+   // writes the bin indexes in the convention of FillFeature, which counts the missing bin even when it is not used
+   EBM_ASSERT(nullptr != pFeature);
+   EBM_ASSERT(nullptr != aBinIndexes);
+
+   const IntEbm iBinOffset = pFeature->m_bMissing ? IntEbm{0} : IntEbm{1};
+   if(pFeature->m_cBins <= UIntShared{1}) {
+      // features with 1 bin store nothing since every sample is in that bin
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         aBinIndexes[iSample] = iBinOffset;
+      }
+      return;
+   }
+
+   if(size_t{0} != pFeature->m_cBytesExternal) {
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         aBinIndexes[iSample] = static_cast<IntEbm>(
+               GetExternalBinIndex(pFeature->m_aFeatureData, pFeature->m_cBytesExternal, iSample));
+      }
+      return;
+   }
+
+   const int cBitsRequiredMin = CountBitsRequired(pFeature->m_cBins - UIntShared{1});
+   EBM_ASSERT(1 <= cBitsRequiredMin);
+   EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(UIntShared));
+
+   const int cItemsPerBitPack = GetCountItemsBitPacked<UIntShared>(cBitsRequiredMin);
+   EBM_ASSERT(1 <= cItemsPerBitPack);
+
+   const int cBitsPerItemMax = GetCountBits<UIntShared>(cItemsPerBitPack);
+   const UIntShared maskBits = MakeLowMask<UIntShared>(cBitsPerItemMax);
+
+   // the first pack holds the remainder of the samples in its low items, like FillFeature writes them
+   const UIntShared* pFeatureData = static_cast<const UIntShared*>(pFeature->m_aFeatureData);
+   int cShift = static_cast<int>((cSamples - size_t{1}) % static_cast<size_t>(cItemsPerBitPack)) * cBitsPerItemMax;
+   const int cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
+   IntEbm* pBinIndex = aBinIndexes;
+   const IntEbm* const pBinIndexesEnd = aBinIndexes + cSamples;
+   do {
+      const UIntShared bits = *pFeatureData;
+      ++pFeatureData;
+      do {
+         *pBinIndex = static_cast<IntEbm>((bits >> cShift) & maskBits) + iBinOffset;
+         ++pBinIndex;
+         cShift -= cBitsPerItemMax;
+      } while(0 <= cShift);
+      cShift = cShiftReset;
+   } while(pBinIndexesEnd != pBinIndex);
+}
+
+static ErrorEbm CheckAppendable(const unsigned char* const pDataSetShared,
+      const unsigned char* const pDataSetSharedAppend,
+      size_t* const pcSamplesOut,
+      size_t* const pcSamplesAppendOut,
+      size_t* const pcFeaturesOut,
+      size_t* const pcWeightsOut,
+      size_t* const pcTargetsOut) {
+   ErrorEbm error;
+
+   UIntShared countSamples;
+   error = GetDataSetSharedHeader(pDataSetShared, &countSamples, pcFeaturesOut, pcWeightsOut, pcTargetsOut);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   UIntShared countSamplesAppend;
+   size_t cFeaturesAppend;
+   size_t cWeightsAppend;
+   size_t cTargetsAppend;
+   error = GetDataSetSharedHeader(
+         pDataSetSharedAppend, &countSamplesAppend, &cFeaturesAppend, &cWeightsAppend, &cTargetsAppend);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   if(*pcFeaturesOut != cFeaturesAppend || *pcWeightsOut != cWeightsAppend || *pcTargetsOut != cTargetsAppend) {
+      LOG_0(Trace_Error, "ERROR CheckAppendable the datasets do not have the same features, weights and targets");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countSamples) || IsConvertError<size_t>(countSamplesAppend)) {
+      LOG_0(Trace_Error, "ERROR CheckAppendable countSamples is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+   const size_t cSamplesAppend = static_cast<size_t>(countSamplesAppend);
+   if(IsAddError(cSamples, cSamplesAppend) || IsConvertError<IntEbm>(cSamples + cSamplesAppend)) {
+      LOG_0(Trace_Error, "ERROR CheckAppendable too many samples");
+      return Error_IllegalParamVal;
+   }
+
+   for(size_t iFeature = 0; iFeature < *pcFeaturesOut; ++iFeature) {
+      DataSetAppendFeature feature;
+      error = GetAppendFeature(pDataSetShared, iFeature, &feature);
+      if(Error_None != error) {
+         return error;
+      }
+      DataSetAppendFeature featureAppend;
+      error = GetAppendFeature(pDataSetSharedAppend, iFeature, &featureAppend);
+      if(Error_None != error) {
+         return error;
+      }
+      // the bins need to mean the same thing in both, which they do when both were binned with the same cuts
+      if(feature.m_bMissing != featureAppend.m_bMissing || feature.m_bUnknown != featureAppend.m_bUnknown ||
+            feature.m_bNominal != featureAppend.m_bNominal || feature.m_cBins != featureAppend.m_cBins) {
+         LOG_0(Trace_Error, "ERROR CheckAppendable a feature has different bins in the two datasets");
+         return Error_IllegalParamVal;
+      }
+      if(IsConvertError<IntEbm>(feature.m_cBins)) {
+         LOG_0(Trace_Error, "ERROR CheckAppendable IsConvertError<IntEbm>(feature.m_cBins)");
+         return Error_IllegalParamVal;
+      }
+   }
+
+   for(size_t iTarget = 0; iTarget < *pcTargetsOut; ++iTarget) {
+      ptrdiff_t cClasses;
+      if(nullptr == GetDataSetSharedTarget(pDataSetShared, iTarget, &cClasses)) {
+         // already logged
+         return Error_IllegalParamVal;
+      }
+      ptrdiff_t cClassesAppend;
+      if(nullptr == GetDataSetSharedTarget(pDataSetSharedAppend, iTarget, &cClassesAppend)) {
+         // already logged
+         return Error_IllegalParamVal;
+      }
+      if(cClasses != cClassesAppend) {
+         LOG_0(Trace_Error, "ERROR CheckAppendable a target has different classes in the two datasets");
+         return Error_IllegalParamVal;
+      }
+   }
+
+   *pcSamplesOut = cSamples;
+   *pcSamplesAppendOut = cSamplesAppend;
+   return Error_None;
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureAppendedDataSet(const void* dataSet, const void* dataSetAppend) {
+   LOG_N(Trace_Info,
+         "Entered MeasureAppendedDataSet: "
+         "dataSet=%p, "
+         "dataSetAppend=%p",
+         dataSet,
+         dataSetAppend);
+
+   const unsigned char* const pDataSetShared = static_cast<const unsigned char*>(dataSet);
+   const unsigned char* const pDataSetSharedAppend = static_cast<const unsigned char*>(dataSetAppend);
+
+   size_t cSamples;
+   size_t cSamplesAppend;
+   size_t cFeatures;
+   size_t cWeights;
+   size_t cTargets;
+   const ErrorEbm error = CheckAppendable(
+         pDataSetShared, pDataSetSharedAppend, &cSamples, &cSamplesAppend, &cFeatures, &cWeights, &cTargets);
+   if(Error_None != error) {
+      return error;
+   }
+   const IntEbm countSamples = static_cast<IntEbm>(cSamples + cSamplesAppend);
+
+   IntEbm cBytes = MeasureDataSetHeader(
+         static_cast<IntEbm>(cFeatures), static_cast<IntEbm>(cWeights), static_cast<IntEbm>(cTargets));
+   if(cBytes < IntEbm{0}) {
+      return cBytes;
+   }
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      DataSetAppendFeature feature;
+      GetAppendFeature(pDataSetShared, iFeature, &feature); // checked in CheckAppendable
+      // without binIndexes this measures the dense layout from countBins and countSamples alone
+      const IntEbm cBytesFeature = MeasureFeature(GetCountBinsFill(&feature),
+            feature.m_bMissing ? EBM_TRUE : EBM_FALSE,
+            feature.m_bUnknown ? EBM_TRUE : EBM_FALSE,
+            feature.m_bNominal ? EBM_TRUE : EBM_FALSE,
+            countSamples,
+            nullptr);
+      if(cBytesFeature < IntEbm{0}) {
+         return cBytesFeature;
+      }
+      cBytes += cBytesFeature;
+   }
+   for(size_t iWeight = 0; iWeight < cWeights; ++iWeight) {
+      // measuring only checks the array for nullptr, so the shorter weights of dataSet can stand in for the
+      // combined weights that FillAppendedDataSet builds
+      const IntEbm cBytesWeight = MeasureWeight(countSamples, GetDataSetSharedWeight(pDataSetShared, iWeight));
+      if(cBytesWeight < IntEbm{0}) {
+         return cBytesWeight;
+      }
+      cBytes += cBytesWeight;
+   }
+   for(size_t iTarget = 0; iTarget < cTargets; ++iTarget) {
+      ptrdiff_t cClasses;
+      const void* const aTargets = GetDataSetSharedTarget(pDataSetShared, iTarget, &cClasses);
+      // like the weights, the targets are only checked for nullptr when measuring
+      const IntEbm cBytesTarget = ptrdiff_t{Task_Regression} == cClasses ?
+            MeasureRegressionTarget(countSamples, static_cast<const double*>(aTargets)) :
+            MeasureClassificationTarget(
+                  static_cast<IntEbm>(cClasses), countSamples, static_cast<const IntEbm*>(aTargets));
+      if(cBytesTarget < IntEbm{0}) {
+         return cBytesTarget;
+      }
+      cBytes += cBytesTarget;
+   }
+
+   LOG_N(Trace_Info, "Exited MeasureAppendedDataSet: %" IntEbmPrintf, cBytes);
+   return cBytes;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillAppendedDataSet(
+      const void* dataSet, const void* dataSetAppend, IntEbm countBytesAllocated, void* fillMem) {
+   LOG_N(Trace_Info,
+         "Entered FillAppendedDataSet: "
+         "dataSet=%p, "
+         "dataSetAppend=%p, "
+         "countBytesAllocated=%" IntEbmPrintf ", "
+         "fillMem=%p",
+         dataSet,
+         dataSetAppend,
+         countBytesAllocated,
+         fillMem);
+
+   ErrorEbm error;
+
+   const unsigned char* const pDataSetShared = static_cast<const unsigned char*>(dataSet);
+   const unsigned char* const pDataSetSharedAppend = static_cast<const unsigned char*>(dataSetAppend);
+
+   size_t cSamples;
+   size_t cSamplesAppend;
+   size_t cFeatures;
+   size_t cWeights;
+   size_t cTargets;
+   error = CheckAppendable(
+         pDataSetShared, pDataSetSharedAppend, &cSamples, &cSamplesAppend, &cFeatures, &cWeights, &cTargets);
+   if(Error_None != error) {
+      return error;
+   }
+   const size_t cSamplesAll = cSamples + cSamplesAppend;
+   const IntEbm countSamples = static_cast<IntEbm>(cSamplesAll);
+
+   error = FillDataSetHeader(static_cast<IntEbm>(cFeatures),
+         static_cast<IntEbm>(cWeights),
+         static_cast<IntEbm>(cTargets),
+         countBytesAllocated,
+         fillMem);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+
+   // one column of IntEbm bin indexes or doubles is reused for every section
+   static_assert(sizeof(FloatShared) == sizeof(double), "the weights and regression targets are copied as doubles");
+   void* aColumn = nullptr;
+   if(size_t{0} != cSamplesAll) {
+      if(IsMultiplyError(EbmMax(sizeof(IntEbm), sizeof(double)), cSamplesAll)) {
+         LOG_0(Trace_Warning, "WARNING FillAppendedDataSet IsMultiplyError(sizeof(IntEbm), cSamplesAll)");
+         return Error_OutOfMemory;
+      }
+      aColumn = malloc(EbmMax(sizeof(IntEbm), sizeof(double)) * cSamplesAll);
+      if(nullptr == aColumn) {
+         LOG_0(Trace_Warning, "WARNING FillAppendedDataSet nullptr == aColumn");
+         return Error_OutOfMemory;
+      }
+   }
+
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      DataSetAppendFeature feature;
+      GetAppendFeature(pDataSetShared, iFeature, &feature); // checked in CheckAppendable
+      DataSetAppendFeature featureAppend;
+      GetAppendFeature(pDataSetSharedAppend, iFeature, &featureAppend);
+
+      IntEbm* const aBinIndexes = static_cast<IntEbm*>(aColumn);
+      if(size_t{0} != cSamples) {
+         UnpackFeature(&feature, cSamples, aBinIndexes);
+      }
+      if(size_t{0} != cSamplesAppend) {
+         UnpackFeature(&featureAppend, cSamplesAppend, aBinIndexes + cSamples);
+      }
+      error = FillFeature(GetCountBinsFill(&feature),
+            feature.m_bMissing ? EBM_TRUE : EBM_FALSE,
+            feature.m_bUnknown ? EBM_TRUE : EBM_FALSE,
+            feature.m_bNominal ? EBM_TRUE : EBM_FALSE,
+            countSamples,
+            aBinIndexes,
+            countBytesAllocated,
+            fillMem);
+      if(Error_None != error) {
+         free(aColumn);
+         return error;
+      }
+   }
+
+   for(size_t iWeight = 0; iWeight < cWeights; ++iWeight) {
+      double* const aWeights = static_cast<double*>(aColumn);
+      const FloatShared* const aWeightsFrom = GetDataSetSharedWeight(pDataSetShared, iWeight);
+      const FloatShared* const aWeightsAppend = GetDataSetSharedWeight(pDataSetSharedAppend, iWeight);
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         aWeights[iSample] = static_cast<double>(aWeightsFrom[iSample]);
+      }
+      for(size_t iSample = 0; iSample < cSamplesAppend; ++iSample) {
+         aWeights[cSamples + iSample] = static_cast<double>(aWeightsAppend[iSample]);
+      }
+      error = FillWeight(countSamples, aWeights, countBytesAllocated, fillMem);
+      if(Error_None != error) {
+         free(aColumn);
+         return error;
+      }
+   }
+
+   for(size_t iTarget = 0; iTarget < cTargets; ++iTarget) {
+      ptrdiff_t cClasses;
+      const void* const aTargetsFrom = GetDataSetSharedTarget(pDataSetShared, iTarget, &cClasses);
+      const void* const aTargetsAppend = GetDataSetSharedTarget(pDataSetSharedAppend, iTarget, &cClasses);
+      if(ptrdiff_t{Task_Regression} == cClasses) {
+         double* const aTargets = static_cast<double*>(aColumn);
+         for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+            aTargets[iSample] = static_cast<double>(static_cast<const FloatShared*>(aTargetsFrom)[iSample]);
+         }
+         for(size_t iSample = 0; iSample < cSamplesAppend; ++iSample) {
+            aTargets[cSamples + iSample] =
+                  static_cast<double>(static_cast<const FloatShared*>(aTargetsAppend)[iSample]);
+         }
+         error = FillRegressionTarget(countSamples, aTargets, countBytesAllocated, fillMem);
+      } else {
+         IntEbm* const aTargets = static_cast<IntEbm*>(aColumn);
+         for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+            aTargets[iSample] = static_cast<IntEbm>(static_cast<const UIntShared*>(aTargetsFrom)[iSample]);
+         }
+         for(size_t iSample = 0; iSample < cSamplesAppend; ++iSample) {
+            aTargets[cSamples + iSample] = static_cast<IntEbm>(static_cast<const UIntShared*>(aTargetsAppend)[iSample]);
+         }
+         error = FillClassificationTarget(
+               static_cast<IntEbm>(cClasses), countSamples, aTargets, countBytesAllocated, fillMem);
+      }
+      if(Error_None != error) {
+         free(aColumn);
+         return error;
+      }
+   }
+
+   free(aColumn);
+
+   LOG_0(Trace_Info, "Exited FillAppendedDataSet");
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
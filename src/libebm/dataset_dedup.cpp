@@ -0,0 +1,528 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <string.h> // memcpy
+#include <limits> // numeric_limits
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "unzoned.h" // EbmMax
+#include "common.hpp" // IsConvertError
+
+#include "ebm_internal.hpp"
+#include "dataset_shared.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// The rows are grouped one column at a time. Each pass maps the pair of (group of the row so far, value of the row in
+// the next column) to a new group, so after the last column two rows share a group exactly when they have the same
+// bins and targets. The hash table holds one entry per group, which is never more than the number of unique rows, so
+// it stays small for the heavily duplicated datasets that this is meant for even when the dataset itself is huge.
+// New groups are numbered in the order of their first row, which makes the unique rows keep the original order.
+
+struct DedupEntry {
+   size_t m_iGroupPrev;
+   uint64_t m_val;
+   size_t m_iGroup;
+};
+
+static constexpr size_t k_iGroupEmpty = std::numeric_limits<size_t>::max();
+
+INLINE_ALWAYS static size_t HashDedup(const size_t iGroupPrev, const uint64_t val) noexcept {
+   // the finalizer of splitmix64, which spreads both the group and the bin into the low bits that pick the bucket
+   uint64_t x = static_cast<uint64_t>(iGroupPrev) * uint64_t{0x9E3779B97F4A7C15} ^ val;
+   x ^= x >> 30;
+   x *= uint64_t{0xBF58476D1CE4E5B9};
+   x ^= x >> 27;
+   x *= uint64_t{0x94D049BB133111EB};
+   x ^= x >> 31;
+   return static_cast<size_t>(x);
+}
+
+static DedupEntry* AllocateDedupTable(const size_t cEntries) {
+   EBM_ASSERT(size_t{0} == (cEntries & (cEntries - size_t{1})));
+   if(IsMultiplyError(sizeof(DedupEntry), cEntries)) {
+      LOG_0(Trace_Warning, "WARNING AllocateDedupTable IsMultiplyError(sizeof(DedupEntry), cEntries)");
+      return nullptr;
+   }
+   DedupEntry* const aTable = static_cast<DedupEntry*>(malloc(sizeof(DedupEntry) * cEntries));
+   if(nullptr == aTable) {
+      LOG_0(Trace_Warning, "WARNING AllocateDedupTable nullptr == aTable");
+      return nullptr;
+   }
+   for(size_t iEntry = 0; iEntry < cEntries; ++iEntry) {
+      aTable[iEntry].m_iGroup = k_iGroupEmpty;
+   }
+   return aTable;
+}
+
+static ErrorEbm RefineGroups(const size_t cSamples,
+      const uint64_t* const aVals,
+      size_t* const aGroups,
+      size_t* const pcGroupsInOut,
+      DedupEntry** const paTableInOut,
+      size_t* const pcTableInOut) {
+   EBM_ASSERT(size_t{0} != cSamples);
+
+   DedupEntry* aTable = *paTableInOut;
+   size_t cTable = *pcTableInOut;
+   for(size_t iEntry = 0; iEntry < cTable; ++iEntry) {
+      aTable[iEntry].m_iGroup = k_iGroupEmpty;
+   }
+
+   size_t cGroups = 0;
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      if(cTable >> 1 <= cGroups) {
+         // keep the table at most half full so that the probes stay short
+         if(IsMultiplyError(size_t{2}, cTable)) {
+            LOG_0(Trace_Warning, "WARNING RefineGroups IsMultiplyError(size_t { 2 }, cTable)");
+            return Error_OutOfMemory;
+         }
+         const size_t cTableNew = cTable << 1;
+         DedupEntry* const aTableNew = AllocateDedupTable(cTableNew);
+         if(nullptr == aTableNew) {
+            // already logged
+            return Error_OutOfMemory;
+         }
+         const size_t maskNew = cTableNew - size_t{1};
+         for(size_t iEntry = 0; iEntry < cTable; ++iEntry) {
+            const DedupEntry* const pEntry = &aTable[iEntry];
+            if(k_iGroupEmpty != pEntry->m_iGroup) {
+               size_t iBucket = HashDedup(pEntry->m_iGroupPrev, pEntry->m_val) & maskNew;
+               while(k_iGroupEmpty != aTableNew[iBucket].m_iGroup) {
+                  iBucket = (iBucket + size_t{1}) & maskNew;
+               }
+               aTableNew[iBucket] = *pEntry;
+            }
+         }
+         free(aTable);
+         aTable = aTableNew;
+         cTable = cTableNew;
+         *paTableInOut = aTable;
+         *pcTableInOut = cTable;
+      }
+
+      const size_t iGroupPrev = aGroups[iSample];
+      const uint64_t val = aVals[iSample];
+      const size_t mask = cTable - size_t{1};
+      size_t iBucket = HashDedup(iGroupPrev, val) & mask;
+      while(true) {
+         DedupEntry* const pEntry = &aTable[iBucket];
+         if(k_iGroupEmpty == pEntry->m_iGroup) {
+            pEntry->m_iGroupPrev = iGroupPrev;
+            pEntry->m_val = val;
+            pEntry->m_iGroup = cGroups;
+            aGroups[iSample] = cGroups;
+            ++cGroups;
+            break;
+         }
+         if(iGroupPrev == pEntry->m_iGroupPrev && val == pEntry->m_val) {
+            aGroups[iSample] = pEntry->m_iGroup;
+            break;
+         }
+         iBucket = (iBucket + size_t{1}) & mask;
+      }
+   }
+   EBM_ASSERT(*pcGroupsInOut <= cGroups);
+   *pcGroupsInOut = cGroups;
+   return Error_None;
+}
+
+struct DedupResult {
+   size_t m_cSamples;
+   size_t m_cFeatures;
+   size_t m_cWeights;
+   size_t m_cTargets;
+   size_t m_cUnique;
+   // the unique row of each original sample
+   size_t* m_aiUnique;
+   // the first original sample of each unique row, from which its bins and targets are copied
+   size_t* m_aiFirst;
+   // the summed weights of the samples in each unique row, or their count if the dataset has no weights
+   double* m_aWeights;
+};
+
+static void FreeDedupResult(DedupResult* const pResult) {
+   free(pResult->m_aiUnique);
+   free(pResult->m_aiFirst);
+   free(pResult->m_aWeights);
+}
+
+static ErrorEbm DedupSamples(const unsigned char* const pDataSetShared, DedupResult* const pResultOut) {
+   ErrorEbm error;
+
+   pResultOut->m_aiUnique = nullptr;
+   pResultOut->m_aiFirst = nullptr;
+   pResultOut->m_aWeights = nullptr;
+
+   UIntShared countSamples;
+   size_t cFeatures;
+   size_t cWeights;
+   size_t cTargets;
+   error = GetDataSetSharedHeader(pDataSetShared, &countSamples, &cFeatures, &cWeights, &cTargets);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+   if(size_t{1} < cWeights) {
+      LOG_0(Trace_Error, "ERROR DedupSamples the weights of datasets with more than 1 weight cannot be merged");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countSamples) || IsConvertError<IntEbm>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR DedupSamples countSamples is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   pResultOut->m_cSamples = cSamples;
+   pResultOut->m_cFeatures = cFeatures;
+   pResultOut->m_cWeights = cWeights;
+   pResultOut->m_cTargets = cTargets;
+   pResultOut->m_cUnique = 0;
+
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      DataSetAppendFeature feature;
+      error = GetAppendFeature(pDataSetShared, iFeature, &feature);
+      if(Error_None != error) {
+         return error;
+      }
+      if(IsConvertError<IntEbm>(feature.m_cBins)) {
+         LOG_0(Trace_Error, "ERROR DedupSamples IsConvertError<IntEbm>(feature.m_cBins)");
+         return Error_IllegalParamVal;
+      }
+   }
+
+   if(size_t{0} == cSamples) {
+      return Error_None;
+   }
+
+   if(IsMultiplyError(EbmMax(sizeof(size_t), sizeof(uint64_t)), cSamples)) {
+      LOG_0(Trace_Warning, "WARNING DedupSamples IsMultiplyError(sizeof(size_t), cSamples)");
+      return Error_OutOfMemory;
+   }
+   size_t* const aGroups = static_cast<size_t*>(malloc(sizeof(size_t) * cSamples));
+   pResultOut->m_aiUnique = aGroups;
+   uint64_t* const aVals = static_cast<uint64_t*>(malloc(sizeof(uint64_t) * cSamples));
+   size_t cTable = 16;
+   DedupEntry* aTable = AllocateDedupTable(cTable);
+   if(nullptr == aGroups || nullptr == aVals || nullptr == aTable) {
+      LOG_0(Trace_Warning, "WARNING DedupSamples nullptr == aGroups || nullptr == aVals || nullptr == aTable");
+      free(aVals);
+      free(aTable);
+      FreeDedupResult(pResultOut);
+      return Error_OutOfMemory;
+   }
+
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      aGroups[iSample] = 0;
+   }
+   size_t cGroups = 1;
+
+   // the targets go first since they usually split the rows the most, which lets the all unique check stop sooner
+   for(size_t iTarget = 0; iTarget < cTargets && cGroups != cSamples; ++iTarget) {
+      ptrdiff_t cClasses;
+      const void* const aTargets = GetDataSetSharedTarget(pDataSetShared, iTarget, &cClasses);
+      if(nullptr == aTargets) {
+         // already logged
+         error = Error_IllegalParamVal;
+         goto exit_error;
+      }
+      if(ptrdiff_t{Task_Regression} == cClasses) {
+         static_assert(sizeof(FloatShared) == sizeof(uint64_t), "the regression targets are compared by their bits");
+         // identical values compare equal, and the rare equal values with different bits like -0.0 and 0.0 are only
+         // left as separate rows
+         memcpy(aVals, aTargets, sizeof(uint64_t) * cSamples);
+      } else {
+         const UIntShared* const aClasses = static_cast<const UIntShared*>(aTargets);
+         for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+            aVals[iSample] = static_cast<uint64_t>(aClasses[iSample]);
+         }
+      }
+      error = RefineGroups(cSamples, aVals, aGroups, &cGroups, &aTable, &cTable);
+      if(Error_None != error) {
+         goto exit_error;
+      }
+   }
+
+   static_assert(sizeof(IntEbm) == sizeof(uint64_t), "the bins are unpacked into the values buffer");
+   for(size_t iFeature = 0; iFeature < cFeatures && cGroups != cSamples; ++iFeature) {
+      DataSetAppendFeature feature;
+      GetAppendFeature(pDataSetShared, iFeature, &feature); // checked above
+      if(feature.m_cBins <= UIntShared{1}) {
+         // every sample is in the same bin, so the feature cannot tell any rows apart
+         continue;
+      }
+      UnpackFeature(&feature, cSamples, reinterpret_cast<IntEbm*>(aVals));
+      error = RefineGroups(cSamples, aVals, aGroups, &cGroups, &aTable, &cTable);
+      if(Error_None != error) {
+         goto exit_error;
+      }
+   }
+   free(aVals);
+   free(aTable);
+
+   {
+      EBM_ASSERT(1 <= cGroups && cGroups <= cSamples);
+      pResultOut->m_cUnique = cGroups;
+
+      if(IsMultiplyError(EbmMax(sizeof(size_t), sizeof(double)), cGroups)) {
+         LOG_0(Trace_Warning, "WARNING DedupSamples IsMultiplyError(sizeof(size_t), cGroups)");
+         FreeDedupResult(pResultOut);
+         return Error_OutOfMemory;
+      }
+      size_t* const aiFirst = static_cast<size_t*>(malloc(sizeof(size_t) * cGroups));
+      pResultOut->m_aiFirst = aiFirst;
+      double* const aWeights = static_cast<double*>(malloc(sizeof(double) * cGroups));
+      pResultOut->m_aWeights = aWeights;
+      if(nullptr == aiFirst || nullptr == aWeights) {
+         LOG_0(Trace_Warning, "WARNING DedupSamples nullptr == aiFirst || nullptr == aWeights");
+         FreeDedupResult(pResultOut);
+         return Error_OutOfMemory;
+      }
+
+      for(size_t iUnique = 0; iUnique < cGroups; ++iUnique) {
+         aWeights[iUnique] = 0.0;
+      }
+      const FloatShared* const aWeightsFrom =
+            size_t{0} == cWeights ? nullptr : GetDataSetSharedWeight(pDataSetShared, 0);
+      size_t cFirst = 0;
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         const size_t iUnique = aGroups[iSample];
+         if(cFirst == iUnique) {
+            // the groups are numbered in the order of their first sample
+            aiFirst[iUnique] = iSample;
+            ++cFirst;
+         }
+         aWeights[iUnique] += nullptr == aWeightsFrom ? 1.0 : static_cast<double>(aWeightsFrom[iSample]);
+      }
+      EBM_ASSERT(cGroups == cFirst);
+   }
+   return Error_None;
+
+exit_error:;
+   free(aVals);
+   free(aTable);
+   FreeDedupResult(pResultOut);
+   return error;
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureDedupedDataSet(const void* dataSet, IntEbm* countSamplesOut) {
+   LOG_N(Trace_Info,
+         "Entered MeasureDedupedDataSet: "
+         "dataSet=%p, "
+         "countSamplesOut=%p",
+         dataSet,
+         static_cast<void*>(countSamplesOut));
+
+   if(nullptr != countSamplesOut) {
+      *countSamplesOut = 0;
+   }
+
+   const unsigned char* const pDataSetShared = static_cast<const unsigned char*>(dataSet);
+
+   DedupResult result;
+   const ErrorEbm error = DedupSamples(pDataSetShared, &result);
+   if(Error_None != error) {
+      return error;
+   }
+   const IntEbm countUnique = static_cast<IntEbm>(result.m_cUnique);
+
+   // the deduplicated dataset always has a weight since the merged rows carry the weight of all their samples
+   IntEbm cBytes = MeasureDataSetHeader(
+         static_cast<IntEbm>(result.m_cFeatures), IntEbm{1}, static_cast<IntEbm>(result.m_cTargets));
+   if(cBytes < IntEbm{0}) {
+      FreeDedupResult(&result);
+      return cBytes;
+   }
+   for(size_t iFeature = 0; iFeature < result.m_cFeatures; ++iFeature) {
+      DataSetAppendFeature feature;
+      GetAppendFeature(pDataSetShared, iFeature, &feature); // checked in DedupSamples
+      // without binIndexes this measures the dense layout from countBins and countSamples alone
+      const IntEbm cBytesFeature = MeasureFeature(GetCountBinsFill(&feature),
+            feature.m_bMissing ? EBM_TRUE : EBM_FALSE,
+            feature.m_bUnknown ? EBM_TRUE : EBM_FALSE,
+            feature.m_bNominal ? EBM_TRUE : EBM_FALSE,
+            countUnique,
+            nullptr);
+      if(cBytesFeature < IntEbm{0}) {
+         FreeDedupResult(&result);
+         return cBytesFeature;
+      }
+      cBytes += cBytesFeature;
+   }
+   const IntEbm cBytesWeight = MeasureWeight(countUnique, result.m_aWeights);
+   if(cBytesWeight < IntEbm{0}) {
+      FreeDedupResult(&result);
+      return cBytesWeight;
+   }
+   cBytes += cBytesWeight;
+   for(size_t iTarget = 0; iTarget < result.m_cTargets; ++iTarget) {
+      ptrdiff_t cClasses;
+      const void* const aTargets = GetDataSetSharedTarget(pDataSetShared, iTarget, &cClasses);
+      // measuring only checks the targets for nullptr, so the longer targets of dataSet can stand in for the
+      // deduplicated targets that FillDedupedDataSet builds
+      const IntEbm cBytesTarget = ptrdiff_t{Task_Regression} == cClasses ?
+            MeasureRegressionTarget(countUnique, static_cast<const double*>(aTargets)) :
+            MeasureClassificationTarget(
+                  static_cast<IntEbm>(cClasses), countUnique, static_cast<const IntEbm*>(aTargets));
+      if(cBytesTarget < IntEbm{0}) {
+         FreeDedupResult(&result);
+         return cBytesTarget;
+      }
+      cBytes += cBytesTarget;
+   }
+   FreeDedupResult(&result);
+
+   if(nullptr != countSamplesOut) {
+      *countSamplesOut = countUnique;
+   }
+
+   LOG_N(Trace_Info, "Exited MeasureDedupedDataSet: %" IntEbmPrintf, cBytes);
+   return cBytes;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillDedupedDataSet(
+      const void* dataSet, IntEbm countBytesAllocated, void* fillMem, IntEbm* uniqueIndexesOut) {
+   LOG_N(Trace_Info,
+         "Entered FillDedupedDataSet: "
+         "dataSet=%p, "
+         "countBytesAllocated=%" IntEbmPrintf ", "
+         "fillMem=%p, "
+         "uniqueIndexesOut=%p",
+         dataSet,
+         countBytesAllocated,
+         fillMem,
+         static_cast<void*>(uniqueIndexesOut));
+
+   ErrorEbm error;
+
+   const unsigned char* const pDataSetShared = static_cast<const unsigned char*>(dataSet);
+
+   DedupResult result;
+   error = DedupSamples(pDataSetShared, &result);
+   if(Error_None != error) {
+      return error;
+   }
+   const size_t cSamples = result.m_cSamples;
+   const size_t cUnique = result.m_cUnique;
+   const IntEbm countUnique = static_cast<IntEbm>(cUnique);
+
+   error = FillDataSetHeader(static_cast<IntEbm>(result.m_cFeatures),
+         IntEbm{1},
+         static_cast<IntEbm>(result.m_cTargets),
+         countBytesAllocated,
+         fillMem);
+   if(Error_None != error) {
+      // already logged
+      FreeDedupResult(&result);
+      return error;
+   }
+
+   // the bins of each feature are unpacked for all the samples and then gathered from the first sample of each
+   // unique row, which is also how the targets are gathered
+   static_assert(sizeof(FloatShared) == sizeof(double), "the regression targets are copied as doubles");
+   IntEbm* aBinIndexes = nullptr;
+   void* aColumn = nullptr;
+   if(size_t{0} != cSamples) {
+      if(IsMultiplyError(sizeof(IntEbm), cSamples) ||
+            IsMultiplyError(EbmMax(sizeof(IntEbm), sizeof(double)), cUnique)) {
+         LOG_0(Trace_Warning, "WARNING FillDedupedDataSet IsMultiplyError(sizeof(IntEbm), cSamples)");
+         FreeDedupResult(&result);
+         return Error_OutOfMemory;
+      }
+      aBinIndexes = static_cast<IntEbm*>(malloc(sizeof(IntEbm) * cSamples));
+      aColumn = malloc(EbmMax(sizeof(IntEbm), sizeof(double)) * cUnique);
+      if(nullptr == aBinIndexes || nullptr == aColumn) {
+         LOG_0(Trace_Warning, "WARNING FillDedupedDataSet nullptr == aBinIndexes || nullptr == aColumn");
+         error = Error_OutOfMemory;
+         goto exit_error;
+      }
+   }
+
+   for(size_t iFeature = 0; iFeature < result.m_cFeatures; ++iFeature) {
+      DataSetAppendFeature feature;
+      GetAppendFeature(pDataSetShared, iFeature, &feature); // checked in DedupSamples
+
+      IntEbm* const aBinIndexesUnique = static_cast<IntEbm*>(aColumn);
+      if(size_t{0} != cSamples) {
+         UnpackFeature(&feature, cSamples, aBinIndexes);
+         for(size_t iUnique = 0; iUnique < cUnique; ++iUnique) {
+            aBinIndexesUnique[iUnique] = aBinIndexes[result.m_aiFirst[iUnique]];
+         }
+      }
+      error = FillFeature(GetCountBinsFill(&feature),
+            feature.m_bMissing ? EBM_TRUE : EBM_FALSE,
+            feature.m_bUnknown ? EBM_TRUE : EBM_FALSE,
+            feature.m_bNominal ? EBM_TRUE : EBM_FALSE,
+            countUnique,
+            aBinIndexesUnique,
+            countBytesAllocated,
+            fillMem);
+      if(Error_None != error) {
+         goto exit_error;
+      }
+   }
+
+   error = FillWeight(countUnique, result.m_aWeights, countBytesAllocated, fillMem);
+   if(Error_None != error) {
+      goto exit_error;
+   }
+
+   for(size_t iTarget = 0; iTarget < result.m_cTargets; ++iTarget) {
+      ptrdiff_t cClasses;
+      const void* const aTargetsFrom = GetDataSetSharedTarget(pDataSetShared, iTarget, &cClasses);
+      if(ptrdiff_t{Task_Regression} == cClasses) {
+         double* const aTargets = static_cast<double*>(aColumn);
+         for(size_t iUnique = 0; iUnique < cUnique; ++iUnique) {
+            aTargets[iUnique] =
+                  static_cast<double>(static_cast<const FloatShared*>(aTargetsFrom)[result.m_aiFirst[iUnique]]);
+         }
+         error = FillRegressionTarget(countUnique, aTargets, countBytesAllocated, fillMem);
+      } else {
+         IntEbm* const aTargets = static_cast<IntEbm*>(aColumn);
+         for(size_t iUnique = 0; iUnique < cUnique; ++iUnique) {
+            aTargets[iUnique] =
+                  static_cast<IntEbm>(static_cast<const UIntShared*>(aTargetsFrom)[result.m_aiFirst[iUnique]]);
+         }
+         error = FillClassificationTarget(
+               static_cast<IntEbm>(cClasses), countUnique, aTargets, countBytesAllocated, fillMem);
+      }
+      if(Error_None != error) {
+         goto exit_error;
+      }
+   }
+
+   if(nullptr != uniqueIndexesOut) {
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         uniqueIndexesOut[iSample] = static_cast<IntEbm>(result.m_aiUnique[iSample]);
+      }
+   }
+
+   free(aBinIndexes);
+   free(aColumn);
+   FreeDedupResult(&result);
+
+   LOG_0(Trace_Info, "Exited FillDedupedDataSet");
+   return Error_None;
+
+exit_error:;
+   free(aBinIndexes);
+   free(aColumn);
+   FreeDedupResult(&result);
+   return error;
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,407 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdio.h> // fopen, fwrite, fclose, remove
+#include <string.h> // memset
+#include <type_traits> // std::is_standard_layout
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else // _WIN32
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+#endif // _WIN32
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError
+
+#include "ebm_internal.hpp"
+#include "dataset_shared.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// A dataset file is a HeaderDataSetFile followed by the exact bytes of a finished shared dataset. The shared dataset
+// is already a flat buffer that is read by offset, so nothing needs to be translated when the file is mapped back
+// into memory. Version 1 files are written in the byte order of the machine that wrote them, which m_byteOrder
+// detects, and they cannot hold external features since those are pointers into the writing process.
+static constexpr UIntShared k_dataSetFileMagic = 0x41544144304D4245; // "EBM0DATA" when stored little endian
+static constexpr UIntShared k_dataSetFileVersion = 1;
+static constexpr UIntShared k_dataSetFileByteOrder = 0x0102030405060708;
+
+struct HeaderDataSetFile {
+   UIntShared m_magic;
+   UIntShared m_version;
+   UIntShared m_byteOrder;
+   UIntShared m_cBytesDataSet;
+
+   // keeps the shared dataset cache line aligned within the page aligned mapping. Must be zero in version 1
+   UIntShared m_reserved[4];
+};
+static_assert(std::is_standard_layout<HeaderDataSetFile>::value,
+      "HeaderDataSetFile is written to disk, so it definetly needs to be standard layout and trivial");
+static_assert(std::is_trivial<HeaderDataSetFile>::value,
+      "HeaderDataSetFile is written to disk, so it definetly needs to be standard layout and trivial");
+static_assert(0 == sizeof(HeaderDataSetFile) % 64, "The shared dataset should start on a cache line");
+
+struct DataSetFile {
+   static constexpr size_t k_handleVerificationOk = 30491; // random 15 bit number
+   static constexpr size_t k_handleVerificationFreed = 13567; // random 15 bit number
+   size_t m_handleVerification; // this needs to be at the top and make it pointer sized to keep best alignment
+
+   const unsigned char* m_pMapped;
+   size_t m_cBytesMapped;
+
+#ifdef _WIN32
+   HANDLE m_hFile;
+   HANDLE m_hMapping;
+#endif // _WIN32
+};
+static_assert(std::is_standard_layout<DataSetFile>::value, "We use malloc/free on DataSetFile");
+static_assert(std::is_trivial<DataSetFile>::value, "We use malloc/free on DataSetFile");
+
+static DataSetFile* GetDataSetFileFromHandle(const DataSetFileHandle dataSetFileHandle) {
+   if(nullptr == dataSetFileHandle) {
+      LOG_0(Trace_Error, "ERROR GetDataSetFileFromHandle null dataSetFileHandle");
+      return nullptr;
+   }
+   DataSetFile* const pDataSetFile = reinterpret_cast<DataSetFile*>(dataSetFileHandle);
+   if(DataSetFile::k_handleVerificationOk == pDataSetFile->m_handleVerification) {
+      return pDataSetFile;
+   }
+   if(DataSetFile::k_handleVerificationFreed == pDataSetFile->m_handleVerification) {
+      LOG_0(Trace_Error, "ERROR GetDataSetFileFromHandle attempt to use freed DataSetFileHandle");
+   } else {
+      LOG_0(Trace_Error, "ERROR GetDataSetFileFromHandle attempt to use invalid DataSetFileHandle");
+   }
+   return nullptr;
+}
+
+static void UnmapDataSetFile(DataSetFile* const pDataSetFile) {
+   EBM_ASSERT(nullptr != pDataSetFile);
+#ifdef _WIN32
+   if(nullptr != pDataSetFile->m_pMapped) {
+      UnmapViewOfFile(pDataSetFile->m_pMapped);
+   }
+   if(nullptr != pDataSetFile->m_hMapping) {
+      CloseHandle(pDataSetFile->m_hMapping);
+   }
+   if(INVALID_HANDLE_VALUE != pDataSetFile->m_hFile) {
+      CloseHandle(pDataSetFile->m_hFile);
+   }
+#else // _WIN32
+   if(nullptr != pDataSetFile->m_pMapped) {
+      munmap(const_cast<unsigned char*>(pDataSetFile->m_pMapped), pDataSetFile->m_cBytesMapped);
+   }
+#endif // _WIN32
+   pDataSetFile->m_handleVerification = DataSetFile::k_handleVerificationFreed;
+   free(pDataSetFile);
+}
+
+static ErrorEbm MapDataSetFile(const char* const filename, DataSetFile* const pDataSetFile) {
+   EBM_ASSERT(nullptr != filename);
+   EBM_ASSERT(nullptr != pDataSetFile);
+
+#ifdef _WIN32
+   pDataSetFile->m_hFile = CreateFileA(filename,
+         GENERIC_READ,
+         FILE_SHARE_READ,
+         nullptr,
+         OPEN_EXISTING,
+         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+         nullptr);
+   if(INVALID_HANDLE_VALUE == pDataSetFile->m_hFile) {
+      LOG_0(Trace_Error, "ERROR MapDataSetFile CreateFileA failed");
+      return Error_FileIO;
+   }
+   LARGE_INTEGER cBytesFile;
+   if(!GetFileSizeEx(pDataSetFile->m_hFile, &cBytesFile)) {
+      LOG_0(Trace_Error, "ERROR MapDataSetFile GetFileSizeEx failed");
+      return Error_FileIO;
+   }
+   if(cBytesFile.QuadPart < static_cast<LONGLONG>(sizeof(HeaderDataSetFile)) ||
+         IsConvertError<size_t>(cBytesFile.QuadPart)) {
+      LOG_0(Trace_Error, "ERROR MapDataSetFile file size is not valid for a dataset file");
+      return Error_IllegalParamVal;
+   }
+   pDataSetFile->m_hMapping = CreateFileMappingA(pDataSetFile->m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if(nullptr == pDataSetFile->m_hMapping) {
+      LOG_0(Trace_Error, "ERROR MapDataSetFile CreateFileMappingA failed");
+      return Error_FileIO;
+   }
+   void* const pMapped = MapViewOfFile(pDataSetFile->m_hMapping, FILE_MAP_READ, 0, 0, 0);
+   if(nullptr == pMapped) {
+      LOG_0(Trace_Error, "ERROR MapDataSetFile MapViewOfFile failed");
+      return Error_FileIO;
+   }
+   pDataSetFile->m_pMapped = static_cast<const unsigned char*>(pMapped);
+   pDataSetFile->m_cBytesMapped = static_cast<size_t>(cBytesFile.QuadPart);
+#else // _WIN32
+   const int fd = open(filename, O_RDONLY);
+   if(fd < 0) {
+      LOG_0(Trace_Error, "ERROR MapDataSetFile open failed");
+      return Error_FileIO;
+   }
+   struct stat statFile;
+   if(0 != fstat(fd, &statFile)) {
+      LOG_0(Trace_Error, "ERROR MapDataSetFile fstat failed");
+      close(fd);
+      return Error_FileIO;
+   }
+   if(statFile.st_size < static_cast<off_t>(sizeof(HeaderDataSetFile)) || IsConvertError<size_t>(statFile.st_size)) {
+      LOG_0(Trace_Error, "ERROR MapDataSetFile file size is not valid for a dataset file");
+      close(fd);
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesFile = static_cast<size_t>(statFile.st_size);
+   // MAP_SHARED lets every process that maps the same file share the page cache copy of it
+   void* const pMapped = mmap(nullptr, cBytesFile, PROT_READ, MAP_SHARED, fd, 0);
+   // the mapping holds its own reference to the file, so we do not need the descriptor anymore
+   close(fd);
+   if(MAP_FAILED == pMapped) {
+      LOG_0(Trace_Error, "ERROR MapDataSetFile mmap failed");
+      return Error_FileIO;
+   }
+   pDataSetFile->m_pMapped = static_cast<const unsigned char*>(pMapped);
+   pDataSetFile->m_cBytesMapped = cBytesFile;
+#endif // _WIN32
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION WriteDataSetFile(
+      IntEbm countBytesAllocated, const void* dataSet, const char* filename) {
+   LOG_N(Trace_Info,
+         "Entered WriteDataSetFile: "
+         "countBytesAllocated=%" IntEbmPrintf ", "
+         "dataSet=%p, "
+         "filename=%p",
+         countBytesAllocated,
+         dataSet,
+         static_cast<const void*>(filename));
+
+   if(nullptr == filename) {
+      LOG_0(Trace_Error, "ERROR WriteDataSetFile nullptr == filename");
+      return Error_IllegalParamVal;
+   }
+
+   if(countBytesAllocated <= IntEbm{0}) {
+      // unlike CheckDataSet we need the exact size since everything up to countBytesAllocated is written
+      LOG_0(Trace_Error, "ERROR WriteDataSetFile countBytesAllocated must be the exact positive size of the dataSet");
+      return Error_IllegalParamVal;
+   }
+
+   ErrorEbm error = CheckDataSet(countBytesAllocated, dataSet);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+   EBM_ASSERT(!IsConvertError<size_t>(countBytesAllocated)); // checked in CheckDataSet
+
+   IntEbm countFeatures;
+   error = ExtractDataSetHeader(dataSet, nullptr, &countFeatures, nullptr, nullptr);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+   EBM_ASSERT(!IsConvertError<size_t>(countFeatures)); // checked in CheckDataSet
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      bool bMissing;
+      bool bUnknown;
+      bool bNominal;
+      bool bSparse;
+      UIntShared countBins;
+      UIntShared defaultValSparse;
+      size_t cNonDefaultsSparse;
+      size_t cBytesExternal;
+      GetDataSetSharedFeature(static_cast<const unsigned char*>(dataSet),
+            iFeature,
+            &bMissing,
+            &bUnknown,
+            &bNominal,
+            &bSparse,
+            &countBins,
+            &defaultValSparse,
+            &cNonDefaultsSparse,
+            &cBytesExternal);
+      if(size_t{0} != cBytesExternal) {
+         LOG_0(Trace_Error, "ERROR WriteDataSetFile datasets with external features cannot be written to a file");
+         return Error_IllegalParamVal;
+      }
+   }
+
+   HeaderDataSetFile header;
+   memset(&header, 0, sizeof(header));
+   header.m_magic = k_dataSetFileMagic;
+   header.m_version = k_dataSetFileVersion;
+   header.m_byteOrder = k_dataSetFileByteOrder;
+   header.m_cBytesDataSet = static_cast<UIntShared>(countBytesAllocated);
+
+   const size_t cBytesDataSet = static_cast<size_t>(countBytesAllocated);
+
+   FILE* const pFile = fopen(filename, "wb");
+   if(nullptr == pFile) {
+      LOG_0(Trace_Error, "ERROR WriteDataSetFile fopen failed");
+      return Error_FileIO;
+   }
+   const bool bWriteFailed = size_t{1} != fwrite(&header, sizeof(header), 1, pFile) ||
+         size_t{1} != fwrite(dataSet, cBytesDataSet, 1, pFile);
+   // fclose flushes our buffered writes, so a failure there also means the file is incomplete
+   const bool bCloseFailed = 0 != fclose(pFile);
+   if(bWriteFailed || bCloseFailed) {
+      LOG_0(Trace_Error, "ERROR WriteDataSetFile failed writing the file");
+      remove(filename);
+      return Error_FileIO;
+   }
+
+   LOG_0(Trace_Info, "Exited WriteDataSetFile");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION OpenDataSetFile(const char* filename,
+      DataSetFileHandle* dataSetFileHandleOut,
+      const void** dataSetOut,
+      IntEbm* countBytesOut) {
+   LOG_N(Trace_Info,
+         "Entered OpenDataSetFile: "
+         "filename=%p, "
+         "dataSetFileHandleOut=%p, "
+         "dataSetOut=%p, "
+         "countBytesOut=%p",
+         static_cast<const void*>(filename),
+         static_cast<void*>(dataSetFileHandleOut),
+         static_cast<void*>(dataSetOut),
+         static_cast<void*>(countBytesOut));
+
+   if(nullptr == dataSetFileHandleOut) {
+      LOG_0(Trace_Error, "ERROR OpenDataSetFile nullptr == dataSetFileHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *dataSetFileHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   if(nullptr == dataSetOut) {
+      LOG_0(Trace_Error, "ERROR OpenDataSetFile nullptr == dataSetOut");
+      return Error_IllegalParamVal;
+   }
+   *dataSetOut = nullptr;
+
+   if(nullptr != countBytesOut) {
+      *countBytesOut = IntEbm{0};
+   }
+
+   if(nullptr == filename) {
+      LOG_0(Trace_Error, "ERROR OpenDataSetFile nullptr == filename");
+      return Error_IllegalParamVal;
+   }
+
+   DataSetFile* const pDataSetFile = static_cast<DataSetFile*>(malloc(sizeof(DataSetFile)));
+   if(nullptr == pDataSetFile) {
+      LOG_0(Trace_Warning, "WARNING OpenDataSetFile nullptr == pDataSetFile");
+      return Error_OutOfMemory;
+   }
+   pDataSetFile->m_handleVerification = DataSetFile::k_handleVerificationOk;
+   pDataSetFile->m_pMapped = nullptr;
+   pDataSetFile->m_cBytesMapped = 0;
+#ifdef _WIN32
+   pDataSetFile->m_hFile = INVALID_HANDLE_VALUE;
+   pDataSetFile->m_hMapping = nullptr;
+#endif // _WIN32
+
+   ErrorEbm error = MapDataSetFile(filename, pDataSetFile);
+   if(Error_None != error) {
+      UnmapDataSetFile(pDataSetFile);
+      return error;
+   }
+   EBM_ASSERT(sizeof(HeaderDataSetFile) <= pDataSetFile->m_cBytesMapped);
+
+   const HeaderDataSetFile* const pHeader = reinterpret_cast<const HeaderDataSetFile*>(pDataSetFile->m_pMapped);
+   if(k_dataSetFileMagic != pHeader->m_magic) {
+      LOG_0(Trace_Error, "ERROR OpenDataSetFile the file is not a dataset file");
+      UnmapDataSetFile(pDataSetFile);
+      return Error_IllegalParamVal;
+   }
+   if(k_dataSetFileByteOrder != pHeader->m_byteOrder) {
+      LOG_0(Trace_Error, "ERROR OpenDataSetFile the file was written on a machine with a different byte order");
+      UnmapDataSetFile(pDataSetFile);
+      return Error_IllegalParamVal;
+   }
+   if(k_dataSetFileVersion != pHeader->m_version) {
+      LOG_N(Trace_Error,
+            "ERROR OpenDataSetFile unsupported dataset file version %" UIntEbmPrintf,
+            static_cast<UIntEbm>(pHeader->m_version));
+      UnmapDataSetFile(pDataSetFile);
+      return Error_IllegalParamVal;
+   }
+   for(const UIntShared reserved : pHeader->m_reserved) {
+      if(UIntShared{0} != reserved) {
+         LOG_0(Trace_Error, "ERROR OpenDataSetFile UIntShared { 0 } != reserved");
+         UnmapDataSetFile(pDataSetFile);
+         return Error_IllegalParamVal;
+      }
+   }
+   const size_t cBytesFileData = pDataSetFile->m_cBytesMapped - sizeof(HeaderDataSetFile);
+   if(IsConvertError<size_t>(pHeader->m_cBytesDataSet) ||
+         cBytesFileData != static_cast<size_t>(pHeader->m_cBytesDataSet) ||
+         IsConvertError<IntEbm>(cBytesFileData)) {
+      LOG_0(Trace_Error, "ERROR OpenDataSetFile the file size does not match the dataset size in its header");
+      UnmapDataSetFile(pDataSetFile);
+      return Error_IllegalParamVal;
+   }
+
+   const void* const pDataSet = pDataSetFile->m_pMapped + sizeof(HeaderDataSetFile);
+
+   // the file might be truncated or corrupted, so check it fully before anyone reads it by offset. This reads the
+   // whole file once, which also warms the page cache for the CreateBooster calls that follow
+   error = CheckDataSet(static_cast<IntEbm>(cBytesFileData), pDataSet);
+   if(Error_None != error) {
+      // already logged
+      UnmapDataSetFile(pDataSetFile);
+      return error;
+   }
+
+   *dataSetFileHandleOut = reinterpret_cast<DataSetFileHandle>(pDataSetFile);
+   *dataSetOut = pDataSet;
+   if(nullptr != countBytesOut) {
+      *countBytesOut = static_cast<IntEbm>(cBytesFileData);
+   }
+
+   LOG_0(Trace_Info, "Exited OpenDataSetFile");
+   return Error_None;
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION CloseDataSetFile(DataSetFileHandle dataSetFileHandle) {
+   LOG_N(Trace_Info, "Entered CloseDataSetFile: dataSetFileHandle=%p", static_cast<void*>(dataSetFileHandle));
+
+   if(nullptr != dataSetFileHandle) {
+      DataSetFile* const pDataSetFile = GetDataSetFileFromHandle(dataSetFileHandle);
+      if(nullptr != pDataSetFile) {
+         UnmapDataSetFile(pDataSetFile);
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited CloseDataSetFile");
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -68,7 +68,11 @@ static constexpr UIntShared k_missingFeatureBit = 0x1;
 static constexpr UIntShared k_unknownFeatureBit = 0x2;
 static constexpr UIntShared k_nominalFeatureBit = 0x4;
 static constexpr UIntShared k_sparseFeatureBit = 0x8;
-static constexpr UIntShared k_featureId = 0x2B40; // random 15 bit number with lower 4 bits set to zero
+static constexpr UIntShared k_externalFeatureBit = 0x10;
+static constexpr UIntShared k_featureId = 0x2B40; // random 15 bit number with lower 5 bits set to zero
+
+// set in the fill state while a feature is being streamed, which makes every other Fill* call fail until EndFeature
+static constexpr UIntShared k_streamingStateBit = UIntShared{1} << (COUNT_BITS(UIntShared) - 1);
 
 // weight ids
 static constexpr UIntShared k_weightId = 0x31FB; // random 15 bit number
@@ -78,8 +82,11 @@ static constexpr UIntShared k_classificationBit = 0x1;
 static constexpr UIntShared k_targetId = 0x5A92; // random 15 bit number with lowest bit set to zero
 
 INLINE_ALWAYS static bool IsFeature(const UIntShared id) noexcept {
-   return (k_missingFeatureBit | k_unknownFeatureBit | k_nominalFeatureBit | k_sparseFeatureBit | k_featureId) ==
-         ((k_missingFeatureBit | k_unknownFeatureBit | k_nominalFeatureBit | k_sparseFeatureBit) | id);
+   return (k_missingFeatureBit | k_unknownFeatureBit | k_nominalFeatureBit | k_sparseFeatureBit |
+                k_externalFeatureBit | k_featureId) ==
+         ((k_missingFeatureBit | k_unknownFeatureBit | k_nominalFeatureBit | k_sparseFeatureBit |
+                k_externalFeatureBit) |
+               id);
 }
 INLINE_ALWAYS static bool IsMissingFeature(const UIntShared id) noexcept {
    static_assert(0 == (k_missingFeatureBit & k_featureId), "k_featureId should not be missing");
@@ -101,11 +108,19 @@ INLINE_ALWAYS static bool IsSparseFeature(const UIntShared id) noexcept {
    EBM_ASSERT(IsFeature(id));
    return 0 != (k_sparseFeatureBit & id);
 }
-INLINE_ALWAYS static UIntShared GetFeatureId(
-      const bool bMissing, const bool bUnknown, const bool bNominal, const bool bSparse) noexcept {
+INLINE_ALWAYS static bool IsExternalFeature(const UIntShared id) noexcept {
+   static_assert(0 == (k_externalFeatureBit & k_featureId), "k_featureId should not be external");
+   EBM_ASSERT(IsFeature(id));
+   return 0 != (k_externalFeatureBit & id);
+}
+INLINE_ALWAYS static UIntShared GetFeatureId(const bool bMissing,
+      const bool bUnknown,
+      const bool bNominal,
+      const bool bSparse,
+      const bool bExternal) noexcept {
    return k_featureId | (bMissing ? k_missingFeatureBit : UIntShared{0}) |
          (bUnknown ? k_unknownFeatureBit : UIntShared{0}) | (bNominal ? k_nominalFeatureBit : UIntShared{0}) |
-         (bSparse ? k_sparseFeatureBit : UIntShared{0});
+         (bSparse ? k_sparseFeatureBit : UIntShared{0}) | (bExternal ? k_externalFeatureBit : UIntShared{0});
 }
 
 INLINE_ALWAYS static bool IsTarget(const UIntShared id) noexcept {
@@ -163,6 +178,24 @@ static_assert(std::is_standard_layout<SparseFeatureDataSetShared>::value,
 static_assert(std::is_trivial<SparseFeatureDataSetShared>::value,
       "These structs are shared between processes, so they definetly need to be standard layout and trivial");
 
+// External features do not hold their bin indexes. They point to an array owned by the caller that holds one
+// uint8_t, uint16_t or uint32_t per sample using the same bin index convention as the binIndexes of FillFeature.
+// The caller's array has to remain valid and unchanged for as long as the dataset is used, and since the dataset
+// holds a pointer it can only be used within the process that filled it.
+struct ExternalFeatureDataSetShared {
+   UIntShared m_pBinIndexes;
+   UIntShared m_cBytesPerBinIndex;
+};
+static_assert(std::is_standard_layout<ExternalFeatureDataSetShared>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(std::is_trivial<ExternalFeatureDataSetShared>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+
+INLINE_ALWAYS static bool IsExternalBinIndexSize(const UIntShared cBytesPerBinIndex) noexcept {
+   return UIntShared{sizeof(uint8_t)} == cBytesPerBinIndex || UIntShared{sizeof(uint16_t)} == cBytesPerBinIndex ||
+         UIntShared{sizeof(uint32_t)} == cBytesPerBinIndex;
+}
+
 struct WeightDataSetShared {
    UIntShared m_id;
 };
@@ -269,6 +302,10 @@ static bool IsHeaderError(
          reinterpret_cast<const UIntShared*>(pFillMem + cBytesAllocated - sizeof(UIntShared));
 
    const UIntShared internalState = *pInternalState;
+   if(UIntShared{0} != (k_streamingStateBit & internalState)) {
+      LOG_0(Trace_Error, "ERROR IsHeaderError EndFeature needs to be called before filling the next section");
+      return true;
+   }
    if(IsConvertError<size_t>(internalState)) {
       LOG_0(Trace_Error, "ERROR IsHeaderError opaqueState invalid");
       return true;
@@ -460,7 +497,60 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAlloc
          // that would exceed a size_t here and catch those on whatever system this dataset is unpacked on
          const UIntShared countBins = pFeatureDataSetShared->m_cBins;
 
-         if(IsSparseFeature(id)) {
+         if(IsExternalFeature(id)) {
+            if(IsSparseFeature(id)) {
+               LOG_0(Trace_Error, "ERROR CheckDataSet external features cannot be sparse");
+               return Error_IllegalParamVal;
+            }
+            // we only make external features when there is something to store
+            if(UIntShared{0} == countSamples || countBins <= UIntShared{1}) {
+               LOG_0(Trace_Error, "ERROR CheckDataSet external features need samples and 2 or more bins");
+               return Error_IllegalParamVal;
+            }
+            if(IsConvertError<size_t>(countSamples)) {
+               LOG_0(Trace_Error, "ERROR CheckDataSet IsConvertError<size_t>(countSamples)");
+               return Error_IllegalParamVal;
+            }
+            const size_t cSamples = static_cast<size_t>(countSamples);
+
+            iOffsetCur = iOffsetNext;
+            if(IsAddError(iOffsetNext, sizeof(ExternalFeatureDataSetShared))) {
+               LOG_0(Trace_Error, "ERROR CheckDataSet IsAddError(iOffsetNext, sizeof(ExternalFeatureDataSetShared))");
+               return Error_IllegalParamVal;
+            }
+            iOffsetNext += sizeof(ExternalFeatureDataSetShared);
+
+            if(cBytesMax < iOffsetNext) {
+               LOG_0(Trace_Error, "ERROR CheckDataSet Not enough space to access ExternalFeatureDataSetShared");
+               return Error_IllegalParamVal;
+            }
+
+            const ExternalFeatureDataSetShared* const pExternalFeatureDataSetShared =
+                  reinterpret_cast<const ExternalFeatureDataSetShared*>(pDataSetShared + iOffsetCur);
+
+            const UIntShared cBytesPerBinIndex = pExternalFeatureDataSetShared->m_cBytesPerBinIndex;
+            if(!IsExternalBinIndexSize(cBytesPerBinIndex)) {
+               LOG_0(Trace_Error, "ERROR CheckDataSet !IsExternalBinIndexSize(cBytesPerBinIndex)");
+               return Error_IllegalParamVal;
+            }
+            const void* const aBinIndexes = reinterpret_cast<const void*>(
+                  static_cast<uintptr_t>(pExternalFeatureDataSetShared->m_pBinIndexes));
+            if(nullptr == aBinIndexes) {
+               LOG_0(Trace_Error, "ERROR CheckDataSet nullptr == aBinIndexes");
+               return Error_IllegalParamVal;
+            }
+
+            // the bin indexes live outside of our buffer, so the only thing we can check is their values
+            const UIntShared iBinOffset = IsMissingFeature(id) ? UIntShared{0} : UIntShared{1};
+            for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+               const UIntShared indexBin =
+                     GetExternalBinIndex(aBinIndexes, static_cast<size_t>(cBytesPerBinIndex), iSample);
+               if(indexBin < iBinOffset || countBins <= indexBin - iBinOffset) {
+                  LOG_0(Trace_Error, "ERROR CheckDataSet external bin index out of range");
+                  return Error_IllegalParamVal;
+               }
+            }
+         } else if(IsSparseFeature(id)) {
             const size_t cBytesSparseHeaderNoOffset = offsetof(SparseFeatureDataSetShared, m_nonDefaults);
 
             iOffsetCur = iOffsetNext;
@@ -987,10 +1077,18 @@ static IntEbm AppendFeature(const IntEbm countBins,
       const BoolEbm isNominal,
       const IntEbm countSamples,
       const IntEbm* binIndexes,
+      const size_t cBytesPerBinIndexExternal,
+      const void* const aBinIndexesExternal,
+      const bool bBeginStream,
       const size_t cBytesAllocated,
       unsigned char* const pFillMem) {
    EBM_ASSERT(size_t{0} == cBytesAllocated && nullptr == pFillMem ||
          nullptr != pFillMem && k_cBytesHeaderId <= cBytesAllocated);
+   // streamed features get their bin indexes later through AppendFeatureChunk
+   EBM_ASSERT(!bBeginStream || nullptr != pFillMem && nullptr == binIndexes && size_t{0} == cBytesPerBinIndexExternal);
+   // callers either give us IntEbm binIndexes to copy, or an external array that we reference but do not own
+   EBM_ASSERT(size_t{0} == cBytesPerBinIndexExternal && nullptr == aBinIndexesExternal ||
+         nullptr == binIndexes && IsExternalBinIndexSize(static_cast<UIntShared>(cBytesPerBinIndexExternal)));
 
    LOG_N(Trace_Info,
          "Entered AppendFeature: "
@@ -1000,6 +1098,9 @@ static IntEbm AppendFeature(const IntEbm countBins,
          "isNominal=%s, "
          "countSamples=%" IntEbmPrintf ", "
          "binIndexes=%p, "
+         "cBytesPerBinIndexExternal=%zu, "
+         "aBinIndexesExternal=%p, "
+         "bBeginStream=%s, "
          "cBytesAllocated=%zu, "
          "pFillMem=%p",
          countBins,
@@ -1008,6 +1109,9 @@ static IntEbm AppendFeature(const IntEbm countBins,
          ObtainTruth(isNominal),
          countSamples,
          static_cast<const void*>(binIndexes),
+         cBytesPerBinIndexExternal,
+         aBinIndexesExternal,
+         ObtainTruth(bBeginStream ? EBM_TRUE : EBM_FALSE),
          cBytesAllocated,
          static_cast<void*>(pFillMem));
 
@@ -1044,14 +1148,24 @@ static IntEbm AppendFeature(const IntEbm countBins,
       const size_t cSamples = static_cast<size_t>(countSamples);
 
       bool bSparse = false;
+      bool bExternal = false;
       if(size_t{0} != cSamples) {
-         if(nullptr == binIndexes) {
+         if(size_t{0} != cBytesPerBinIndexExternal) {
+            if(nullptr == aBinIndexesExternal) {
+               LOG_0(Trace_Error, "ERROR AppendFeature nullptr == aBinIndexesExternal");
+               goto return_bad;
+            }
+            // features with only 1 bin store nothing, so there is nothing to reference either
+            bExternal = UIntShared{1} < cBins;
+         } else if(nullptr != binIndexes) {
+            // TODO: handle sparse data someday
+            bSparse = DecideIfSparse(cSamples, binIndexes);
+         } else if(nullptr != pFillMem && !bBeginStream) {
             LOG_0(Trace_Error, "ERROR AppendFeature nullptr == binIndexes");
             goto return_bad;
          }
-
-         // TODO: handle sparse data someday
-         bSparse = DecideIfSparse(cSamples, binIndexes);
+         // otherwise we are measuring or streaming from the declared countBins and countSamples alone, which
+         // always uses the dense layout
       }
 
       size_t iOffset = 0;
@@ -1095,12 +1209,61 @@ static IntEbm AppendFeature(const IntEbm countBins,
                reinterpret_cast<FeatureDataSetShared*>(pFillMem + iHighestOffset);
 
          pFeatureDataSetShared->m_id =
-               GetFeatureId(EBM_FALSE != isMissing, EBM_FALSE != isUnknown, EBM_FALSE != isNominal, bSparse);
+               GetFeatureId(EBM_FALSE != isMissing, EBM_FALSE != isUnknown, EBM_FALSE != isNominal, bSparse, bExternal);
          pFeatureDataSetShared->m_cBins = cBins;
       }
 
-      // if there is only 1 bin we always know what it will be and we do not need to store anything
-      if(size_t{0} != cSamples) {
+      if(size_t{0} != cSamples && size_t{0} != cBytesPerBinIndexExternal) {
+         if(UIntShared{0} == cBins) {
+            LOG_0(Trace_Error, "ERROR AppendFeature UIntShared { 0 } == cBins");
+            goto return_bad;
+         }
+
+         size_t iByteNext = iByteCur;
+         if(bExternal) {
+            if(IsAddError(iByteCur, sizeof(ExternalFeatureDataSetShared))) {
+               LOG_0(Trace_Error, "ERROR AppendFeature IsAddError(iByteCur, sizeof(ExternalFeatureDataSetShared))");
+               goto return_bad;
+            }
+            iByteNext += sizeof(ExternalFeatureDataSetShared);
+         }
+
+         if(nullptr != pFillMem) {
+            if(cBytesAllocated < iByteNext) {
+               LOG_0(Trace_Error, "ERROR AppendFeature cBytesAllocated < iByteNext");
+               goto return_bad;
+            }
+
+            // we only hold a pointer to the caller's memory, so this is our one chance to check the values.
+            // The caller is responsible for not modifying them afterwards
+            const UIntShared indexBinIllegal =
+                  static_cast<UIntShared>(countBins) - (EBM_FALSE != isUnknown ? UIntShared{0} : UIntShared{1});
+            const UIntShared indexBinMin = EBM_FALSE != isMissing ? UIntShared{0} : UIntShared{1};
+            size_t iSample = 0;
+            do {
+               const UIntShared indexBin = GetExternalBinIndex(aBinIndexesExternal, cBytesPerBinIndexExternal, iSample);
+               if(indexBinIllegal <= indexBin) {
+                  LOG_0(Trace_Error, "ERROR AppendFeature indexBinIllegal <= indexBin");
+                  goto return_bad;
+               }
+               if(indexBin < indexBinMin) {
+                  LOG_0(Trace_Error, "ERROR AppendFeature indexBin < indexBinMin");
+                  goto return_bad;
+               }
+               ++iSample;
+            } while(cSamples != iSample);
+
+            if(bExternal) {
+               ExternalFeatureDataSetShared* const pExternalFeatureDataSetShared =
+                     reinterpret_cast<ExternalFeatureDataSetShared*>(pFillMem + iByteCur);
+               pExternalFeatureDataSetShared->m_pBinIndexes =
+                     static_cast<UIntShared>(reinterpret_cast<uintptr_t>(aBinIndexesExternal));
+               pExternalFeatureDataSetShared->m_cBytesPerBinIndex = static_cast<UIntShared>(cBytesPerBinIndexExternal);
+            }
+         }
+         iByteCur = iByteNext;
+      } else if(size_t{0} != cSamples) {
+         // if there is only 1 bin we always know what it will be and we do not need to store anything
          const IntEbm* pBinIndex = binIndexes;
          const IntEbm* const pBinIndexsEnd = binIndexes + cSamples;
          if(cBins <= UIntShared{1}) {
@@ -1108,15 +1271,17 @@ static IntEbm AppendFeature(const IntEbm countBins,
                LOG_0(Trace_Error, "ERROR AppendFeature UIntShared { 0 } == cBins");
                goto return_bad;
             }
-            const IntEbm indexBinLegal = EBM_FALSE != isMissing ? IntEbm{0} : IntEbm{1};
-            do {
-               const IntEbm indexBin = *pBinIndex;
-               if(indexBinLegal != indexBin) {
-                  LOG_0(Trace_Error, "ERROR AppendFeature indexBinLegal != indexBin");
-                  goto return_bad;
-               }
-               ++pBinIndex;
-            } while(pBinIndexsEnd != pBinIndex);
+            if(nullptr != binIndexes) {
+               const IntEbm indexBinLegal = EBM_FALSE != isMissing ? IntEbm{0} : IntEbm{1};
+               do {
+                  const IntEbm indexBin = *pBinIndex;
+                  if(indexBinLegal != indexBin) {
+                     LOG_0(Trace_Error, "ERROR AppendFeature indexBinLegal != indexBin");
+                     goto return_bad;
+                  }
+                  ++pBinIndex;
+               } while(pBinIndexsEnd != pBinIndex);
+            }
          } else {
             const int cBitsRequiredMin = CountBitsRequired(cBins - UIntShared{1});
             EBM_ASSERT(1 <= cBitsRequiredMin);
@@ -1145,7 +1310,14 @@ static IntEbm AppendFeature(const IntEbm countBins,
             }
             const size_t iByteNext = iByteCur + cBytesAllSamples;
 
-            if(nullptr != pFillMem) {
+            if(nullptr != pFillMem && bBeginStream) {
+               if(cBytesAllocated < iByteNext) {
+                  LOG_0(Trace_Error, "ERROR AppendFeature cBytesAllocated < iByteNext");
+                  goto return_bad;
+               }
+               // AppendFeatureChunk ORs each sample into place, so all the bits need to start at zero
+               memset(pFillMem + iByteCur, 0, cBytesAllSamples);
+            } else if(nullptr != pFillMem) {
                if(cBytesAllocated < iByteNext) {
                   LOG_0(Trace_Error, "ERROR AppendFeature cBytesAllocated < iByteNext");
                   goto return_bad;
@@ -1205,11 +1377,34 @@ static IntEbm AppendFeature(const IntEbm countBins,
          HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<HeaderDataSetShared*>(pFillMem);
          EBM_ASSERT(k_sharedDataSetWorkingId == pHeaderDataSetShared->m_id);
 
-         ++iOffset;
          const size_t cOffsets = static_cast<size_t>(pHeaderDataSetShared->m_cFeatures) +
                static_cast<size_t>(pHeaderDataSetShared->m_cWeights) +
                static_cast<size_t>(pHeaderDataSetShared->m_cTargets);
 
+         if(bBeginStream) {
+            // while streaming, the offset of the next section holds the count of samples appended so far. The last
+            // section has no next offset, and its data would overwrite our state, so it cannot be streamed
+            if(iOffset + size_t{1} == cOffsets) {
+               LOG_0(Trace_Error, "ERROR AppendFeature the last section of a dataset cannot be streamed");
+               goto return_bad;
+            }
+            if(cBytesAllocated - sizeof(UIntShared) < iByteCur) {
+               LOG_0(Trace_Error, "ERROR AppendFeature cBytesAllocated - sizeof(UIntShared) < iByteCur");
+               goto return_bad;
+            }
+            if(IsConvertError<UIntShared>(iOffset) ||
+                  UIntShared{0} != (k_streamingStateBit & static_cast<UIntShared>(iOffset))) {
+               LOG_0(Trace_Error, "ERROR AppendFeature iOffset cannot be held in the streaming state");
+               goto return_bad;
+            }
+            ArrayToPointer(pHeaderDataSetShared->m_offsets)[iOffset + size_t{1}] = UIntShared{0};
+            UIntShared* const pInternalState =
+                  reinterpret_cast<UIntShared*>(pFillMem + cBytesAllocated - sizeof(UIntShared));
+            *pInternalState = static_cast<UIntShared>(iOffset) | k_streamingStateBit;
+            return Error_None;
+         }
+
+         ++iOffset;
          if(iOffset == cOffsets) {
             if(cBytesAllocated != iByteCur) {
                LOG_0(Trace_Error, "ERROR AppendFeature buffer size and fill size do not agree");
@@ -1716,7 +1911,8 @@ EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureFeature(IntEbm countBins,
       BoolEbm isNominal,
       IntEbm countSamples,
       const IntEbm* binIndexes) {
-   return AppendFeature(countBins, isMissing, isUnknown, isNominal, countSamples, binIndexes, 0, nullptr);
+   return AppendFeature(
+         countBins, isMissing, isUnknown, isNominal, countSamples, binIndexes, 0, nullptr, false, 0, nullptr);
 }
 
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillFeature(IntEbm countBins,
@@ -1758,11 +1954,451 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillFeature(IntEbm countBins,
          isNominal,
          countSamples,
          binIndexes,
+         0,
+         nullptr,
+         false,
+         cBytesAllocated,
+         static_cast<unsigned char*>(fillMem));
+   return static_cast<ErrorEbm>(ret);
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureFeatureExternal(IntEbm countBins,
+      BoolEbm isMissing,
+      BoolEbm isUnknown,
+      BoolEbm isNominal,
+      IntEbm countSamples,
+      IntEbm countBytesPerBinIndex,
+      const void* binIndexes) {
+   if(IsConvertError<size_t>(countBytesPerBinIndex) ||
+         !IsExternalBinIndexSize(static_cast<UIntShared>(countBytesPerBinIndex))) {
+      LOG_0(Trace_Error, "ERROR MeasureFeatureExternal countBytesPerBinIndex must be 1, 2, or 4");
+      return Error_IllegalParamVal;
+   }
+   return AppendFeature(countBins,
+         isMissing,
+         isUnknown,
+         isNominal,
+         countSamples,
+         nullptr,
+         static_cast<size_t>(countBytesPerBinIndex),
+         binIndexes,
+         false,
+         0,
+         nullptr);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillFeatureExternal(IntEbm countBins,
+      BoolEbm isMissing,
+      BoolEbm isUnknown,
+      BoolEbm isNominal,
+      IntEbm countSamples,
+      IntEbm countBytesPerBinIndex,
+      const void* binIndexes,
+      IntEbm countBytesAllocated,
+      void* fillMem) {
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR FillFeatureExternal nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR FillFeatureExternal countBytesAllocated is outside the range of a valid size");
+      // don't set the header to bad if we don't have enough memory for the header itself
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   if(cBytesAllocated < k_cBytesHeaderId) {
+      LOG_0(Trace_Error, "ERROR FillFeatureExternal cBytesAllocated < k_cBytesHeaderId");
+      // don't check or set the header to bad if we don't have enough memory for the header id itself
+      return Error_IllegalParamVal;
+   }
+
+   HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<HeaderDataSetShared*>(fillMem);
+   if(k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id) {
+      LOG_0(Trace_Error, "ERROR FillFeatureExternal k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id");
+      // don't set the header to bad since it's already set to something invalid and we don't know why
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesPerBinIndex) ||
+         !IsExternalBinIndexSize(static_cast<UIntShared>(countBytesPerBinIndex))) {
+      LOG_0(Trace_Error, "ERROR FillFeatureExternal countBytesPerBinIndex must be 1, 2, or 4");
+      pHeaderDataSetShared->m_id = k_sharedDataSetErrorId;
+      return Error_IllegalParamVal;
+   }
+
+   const IntEbm ret = AppendFeature(countBins,
+         isMissing,
+         isUnknown,
+         isNominal,
+         countSamples,
+         nullptr,
+         static_cast<size_t>(countBytesPerBinIndex),
+         binIndexes,
+         false,
+         cBytesAllocated,
+         static_cast<unsigned char*>(fillMem));
+   return static_cast<ErrorEbm>(ret);
+}
+
+// returns the feature that BeginFeature started, or nullptr if pFillMem is not in the middle of streaming one
+static FeatureDataSetShared* GetStreamingFeature(
+      const size_t cBytesAllocated, unsigned char* const pFillMem, size_t* const piOffsetOut) {
+   EBM_ASSERT(nullptr != pFillMem);
+   EBM_ASSERT(k_cBytesHeaderId <= cBytesAllocated);
+   EBM_ASSERT(nullptr != piOffsetOut);
+
+   if(cBytesAllocated < k_cBytesHeaderNoOffset + sizeof(HeaderDataSetShared::m_offsets[0]) + sizeof(UIntShared)) {
+      LOG_0(Trace_Error, "ERROR GetStreamingFeature not enough memory allocated for the shared dataset header");
+      return nullptr;
+   }
+
+   HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<HeaderDataSetShared*>(pFillMem);
+   EBM_ASSERT(k_sharedDataSetWorkingId == pHeaderDataSetShared->m_id); // checked by our caller
+
+   const UIntShared internalState =
+         *reinterpret_cast<const UIntShared*>(pFillMem + cBytesAllocated - sizeof(UIntShared));
+   if(UIntShared{0} == (k_streamingStateBit & internalState)) {
+      LOG_0(Trace_Error, "ERROR GetStreamingFeature BeginFeature was not called before this");
+      return nullptr;
+   }
+   const UIntShared indexOffset = internalState & ~k_streamingStateBit;
+
+   // BeginFeature only streams features, and never the last section, so iOffset + 1 is a valid offset index
+   const UIntShared countFeatures = pHeaderDataSetShared->m_cFeatures;
+   if(countFeatures <= indexOffset || IsConvertError<size_t>(countFeatures)) {
+      // we're being untrusting of the caller manipulating the memory improperly here
+      LOG_0(Trace_Error, "ERROR GetStreamingFeature countFeatures <= indexOffset");
+      return nullptr;
+   }
+   const size_t iOffset = static_cast<size_t>(indexOffset);
+
+   if(IsMultiplyError(sizeof(HeaderDataSetShared::m_offsets[0]), iOffset + size_t{2}) ||
+         IsAddError(k_cBytesHeaderNoOffset, sizeof(HeaderDataSetShared::m_offsets[0]) * (iOffset + size_t{2})) ||
+         cBytesAllocated - sizeof(UIntShared) <
+               k_cBytesHeaderNoOffset + sizeof(HeaderDataSetShared::m_offsets[0]) * (iOffset + size_t{2})) {
+      LOG_0(Trace_Error, "ERROR GetStreamingFeature the offsets do not fit into the allocated memory");
+      return nullptr;
+   }
+
+   const UIntShared indexByteFeature = ArrayToPointer(pHeaderDataSetShared->m_offsets)[iOffset];
+   if(IsConvertError<size_t>(indexByteFeature) ||
+         cBytesAllocated - sizeof(UIntShared) - sizeof(FeatureDataSetShared) <
+               static_cast<size_t>(indexByteFeature)) {
+      // we're being untrusting of the caller manipulating the memory improperly here
+      LOG_0(Trace_Error, "ERROR GetStreamingFeature indexByteFeature is outside the allocated memory");
+      return nullptr;
+   }
+
+   FeatureDataSetShared* const pFeatureDataSetShared =
+         reinterpret_cast<FeatureDataSetShared*>(pFillMem + static_cast<size_t>(indexByteFeature));
+   const UIntShared id = pFeatureDataSetShared->m_id;
+   if(!IsFeature(id) || IsSparseFeature(id) || IsExternalFeature(id)) {
+      LOG_0(Trace_Error, "ERROR GetStreamingFeature the streamed section is not a dense feature");
+      return nullptr;
+   }
+
+   *piOffsetOut = iOffset;
+   return pFeatureDataSetShared;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION BeginFeature(IntEbm countBins,
+      BoolEbm isMissing,
+      BoolEbm isUnknown,
+      BoolEbm isNominal,
+      IntEbm countSamples,
+      IntEbm countBytesAllocated,
+      void* fillMem) {
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR BeginFeature nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR BeginFeature countBytesAllocated is outside the range of a valid size");
+      // don't set the header to bad if we don't have enough memory for the header itself
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   if(cBytesAllocated < k_cBytesHeaderId) {
+      LOG_0(Trace_Error, "ERROR BeginFeature cBytesAllocated < k_cBytesHeaderId");
+      // don't check or set the header to bad if we don't have enough memory for the header id itself
+      return Error_IllegalParamVal;
+   }
+
+   HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<HeaderDataSetShared*>(fillMem);
+   if(k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id) {
+      LOG_0(Trace_Error, "ERROR BeginFeature k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id");
+      // don't set the header to bad since it's already set to something invalid and we don't know why
+      return Error_IllegalParamVal;
+   }
+
+   const IntEbm ret = AppendFeature(countBins,
+         isMissing,
+         isUnknown,
+         isNominal,
+         countSamples,
+         nullptr,
+         0,
+         nullptr,
+         true,
          cBytesAllocated,
          static_cast<unsigned char*>(fillMem));
    return static_cast<ErrorEbm>(ret);
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION AppendFeatureChunk(
+      IntEbm countSamplesChunk, const IntEbm* binIndexes, IntEbm countBytesAllocated, void* fillMem) {
+   LOG_N(Trace_Verbose,
+         "Entered AppendFeatureChunk: "
+         "countSamplesChunk=%" IntEbmPrintf ", "
+         "binIndexes=%p, "
+         "countBytesAllocated=%" IntEbmPrintf ", "
+         "fillMem=%p",
+         countSamplesChunk,
+         static_cast<const void*>(binIndexes),
+         countBytesAllocated,
+         fillMem);
+
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR AppendFeatureChunk nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR AppendFeatureChunk countBytesAllocated is outside the range of a valid size");
+      // don't set the header to bad if we don't have enough memory for the header itself
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   if(cBytesAllocated < k_cBytesHeaderId) {
+      LOG_0(Trace_Error, "ERROR AppendFeatureChunk cBytesAllocated < k_cBytesHeaderId");
+      // don't check or set the header to bad if we don't have enough memory for the header id itself
+      return Error_IllegalParamVal;
+   }
+
+   unsigned char* const pFillMem = static_cast<unsigned char*>(fillMem);
+   HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<HeaderDataSetShared*>(pFillMem);
+   if(k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id) {
+      LOG_0(Trace_Error, "ERROR AppendFeatureChunk k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id");
+      // don't set the header to bad since it's already set to something invalid and we don't know why
+      return Error_IllegalParamVal;
+   }
+
+   {
+      size_t iOffset;
+      FeatureDataSetShared* const pFeatureDataSetShared = GetStreamingFeature(cBytesAllocated, pFillMem, &iOffset);
+      if(nullptr == pFeatureDataSetShared) {
+         // already logged
+         goto return_bad;
+      }
+
+      if(IsConvertError<size_t>(countSamplesChunk)) {
+         LOG_0(Trace_Error, "ERROR AppendFeatureChunk countSamplesChunk is outside the range of a valid index");
+         goto return_bad;
+      }
+      const size_t cSamplesChunk = static_cast<size_t>(countSamplesChunk);
+      if(size_t{0} == cSamplesChunk) {
+         return Error_None;
+      }
+      if(nullptr == binIndexes) {
+         LOG_0(Trace_Error, "ERROR AppendFeatureChunk nullptr == binIndexes");
+         goto return_bad;
+      }
+
+      const UIntShared countSamples = pHeaderDataSetShared->m_cSamples;
+      UIntShared* const pcSamplesDone = &ArrayToPointer(pHeaderDataSetShared->m_offsets)[iOffset + size_t{1}];
+      const UIntShared countSamplesDone = *pcSamplesDone;
+      if(IsConvertError<size_t>(countSamples) || countSamples < countSamplesDone) {
+         LOG_0(Trace_Error, "ERROR AppendFeatureChunk the streaming state is invalid");
+         goto return_bad;
+      }
+      const size_t cSamples = static_cast<size_t>(countSamples);
+      const size_t cSamplesDone = static_cast<size_t>(countSamplesDone);
+      if(cSamples - cSamplesDone < cSamplesChunk) {
+         LOG_0(Trace_Error, "ERROR AppendFeatureChunk more samples were appended than BeginFeature declared");
+         goto return_bad;
+      }
+
+      const UIntShared id = pFeatureDataSetShared->m_id;
+      const UIntShared cBins = pFeatureDataSetShared->m_cBins;
+      if(UIntShared{0} == cBins) {
+         LOG_0(Trace_Error, "ERROR AppendFeatureChunk UIntShared { 0 } == cBins");
+         goto return_bad;
+      }
+      // binIndexes follow the FillFeature convention, so without a missing bin the lowest legal index is 1
+      const IntEbm indexBinMin = IsMissingFeature(id) ? IntEbm{0} : IntEbm{1};
+
+      const IntEbm* pBinIndex = binIndexes;
+      const IntEbm* const pBinIndexsEnd = binIndexes + cSamplesChunk;
+      if(cBins <= UIntShared{1}) {
+         // if there is only 1 bin we always know what it will be and we do not need to store anything
+         do {
+            if(indexBinMin != *pBinIndex) {
+               LOG_0(Trace_Error, "ERROR AppendFeatureChunk indexBinLegal != indexBin");
+               goto return_bad;
+            }
+            ++pBinIndex;
+         } while(pBinIndexsEnd != pBinIndex);
+      } else {
+         const int cBitsRequiredMin = CountBitsRequired(cBins - UIntShared{1});
+         EBM_ASSERT(1 <= cBitsRequiredMin);
+         EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(UIntShared));
+
+         const int cItemsPerBitPack = GetCountItemsBitPacked<UIntShared>(cBitsRequiredMin);
+         EBM_ASSERT(1 <= cItemsPerBitPack);
+         EBM_ASSERT(cItemsPerBitPack <= COUNT_BITS(UIntShared));
+
+         const int cBitsPerItemMax = GetCountBits<UIntShared>(cItemsPerBitPack);
+         EBM_ASSERT(1 <= cBitsPerItemMax);
+         EBM_ASSERT(cBitsPerItemMax <= COUNT_BITS(UIntShared));
+
+         EBM_ASSERT(1 <= cSamples);
+         const size_t cItemsPerBitPackSizeT = static_cast<size_t>(cItemsPerBitPack);
+         const size_t cDataUnits = (cSamples - size_t{1}) / cItemsPerBitPackSizeT + size_t{1};
+
+         // the first data unit is the partial one, so count positions as if it had been padded to a full unit
+         const size_t iPosition = cSamplesDone + (cItemsPerBitPackSizeT - size_t{1}) -
+               (cSamples - size_t{1}) % cItemsPerBitPackSizeT;
+
+         // GetStreamingFeature checked that the FeatureDataSetShared fits before the state at the end
+         unsigned char* const pFeatureData = reinterpret_cast<unsigned char*>(pFeatureDataSetShared + 1);
+         const size_t cBytesAvailable =
+               static_cast<size_t>(pFillMem + cBytesAllocated - sizeof(UIntShared) - pFeatureData);
+         if(IsMultiplyError(sizeof(UIntShared), cDataUnits) || cBytesAvailable < sizeof(UIntShared) * cDataUnits) {
+            LOG_0(Trace_Error, "ERROR AppendFeatureChunk the feature data does not fit into the allocated memory");
+            goto return_bad;
+         }
+
+         UIntShared* pFillData = reinterpret_cast<UIntShared*>(pFeatureData) + iPosition / cItemsPerBitPackSizeT;
+         int cShift = static_cast<int>(cItemsPerBitPackSizeT - size_t{1} - iPosition % cItemsPerBitPackSizeT) *
+               cBitsPerItemMax;
+         const int cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
+         do {
+            const IntEbm indexBin = *pBinIndex;
+            if(indexBin < indexBinMin) {
+               LOG_0(Trace_Error, "ERROR AppendFeatureChunk indexBin < indexBinMin");
+               goto return_bad;
+            }
+            const UIntShared iBin = static_cast<UIntShared>(indexBin - indexBinMin);
+            if(cBins <= iBin) {
+               LOG_0(Trace_Error, "ERROR AppendFeatureChunk indexBinIllegal <= indexBin");
+               goto return_bad;
+            }
+            ++pBinIndex;
+
+            EBM_ASSERT(0 <= cShift);
+            EBM_ASSERT(cShift < COUNT_BITS(UIntShared));
+            *pFillData |= iBin << cShift;
+            cShift -= cBitsPerItemMax;
+            if(cShift < 0) {
+               cShift = cShiftReset;
+               ++pFillData;
+            }
+         } while(pBinIndexsEnd != pBinIndex);
+      }
+
+      *pcSamplesDone = static_cast<UIntShared>(cSamplesDone + cSamplesChunk);
+      return Error_None;
+   }
+
+return_bad:;
+
+   pHeaderDataSetShared->m_id = k_sharedDataSetErrorId;
+   return Error_IllegalParamVal;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION EndFeature(IntEbm countBytesAllocated, void* fillMem) {
+   LOG_N(Trace_Info,
+         "Entered EndFeature: "
+         "countBytesAllocated=%" IntEbmPrintf ", "
+         "fillMem=%p",
+         countBytesAllocated,
+         fillMem);
+
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR EndFeature nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR EndFeature countBytesAllocated is outside the range of a valid size");
+      // don't set the header to bad if we don't have enough memory for the header itself
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   if(cBytesAllocated < k_cBytesHeaderId) {
+      LOG_0(Trace_Error, "ERROR EndFeature cBytesAllocated < k_cBytesHeaderId");
+      // don't check or set the header to bad if we don't have enough memory for the header id itself
+      return Error_IllegalParamVal;
+   }
+
+   unsigned char* const pFillMem = static_cast<unsigned char*>(fillMem);
+   HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<HeaderDataSetShared*>(pFillMem);
+   if(k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id) {
+      LOG_0(Trace_Error, "ERROR EndFeature k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id");
+      // don't set the header to bad since it's already set to something invalid and we don't know why
+      return Error_IllegalParamVal;
+   }
+
+   {
+      size_t iOffset;
+      const FeatureDataSetShared* const pFeatureDataSetShared =
+            GetStreamingFeature(cBytesAllocated, pFillMem, &iOffset);
+      if(nullptr == pFeatureDataSetShared) {
+         // already logged
+         goto return_bad;
+      }
+
+      const UIntShared countSamples = pHeaderDataSetShared->m_cSamples;
+      UIntShared* const pNextOffset = &ArrayToPointer(pHeaderDataSetShared->m_offsets)[iOffset + size_t{1}];
+      if(countSamples != *pNextOffset || IsConvertError<size_t>(countSamples)) {
+         LOG_0(Trace_Error, "ERROR EndFeature fewer samples were appended than BeginFeature declared");
+         goto return_bad;
+      }
+      const size_t cSamples = static_cast<size_t>(countSamples);
+
+      const UIntShared cBins = pFeatureDataSetShared->m_cBins;
+      size_t cBytesFeature = sizeof(FeatureDataSetShared);
+      if(size_t{0} != cSamples && UIntShared{1} < cBins) {
+         const int cBitsRequiredMin = CountBitsRequired(cBins - UIntShared{1});
+         const int cItemsPerBitPack = GetCountItemsBitPacked<UIntShared>(cBitsRequiredMin);
+         const size_t cDataUnits = (cSamples - size_t{1}) / static_cast<size_t>(cItemsPerBitPack) + size_t{1};
+         // AppendFeatureChunk has already written to this memory, so it cannot overflow
+         EBM_ASSERT(!IsMultiplyError(sizeof(UIntShared), cDataUnits));
+         cBytesFeature += sizeof(UIntShared) * cDataUnits;
+      }
+
+      const unsigned char* const pNext = reinterpret_cast<const unsigned char*>(pFeatureDataSetShared) + cBytesFeature;
+      if(pFillMem + cBytesAllocated - sizeof(UIntShared) < pNext) {
+         LOG_0(Trace_Error, "ERROR EndFeature cBytesAllocated - sizeof(UIntShared) < iByteNext");
+         goto return_bad;
+      }
+      const size_t iByteNext = static_cast<size_t>(pNext - pFillMem);
+      if(IsConvertError<UIntShared>(iByteNext)) {
+         LOG_0(Trace_Error, "ERROR EndFeature IsConvertError<UIntShared>(iByteNext)");
+         goto return_bad;
+      }
+
+      // the section after us is never the last, so this is the same bookkeeping that AppendFeature does
+      *pNextOffset = static_cast<UIntShared>(iByteNext);
+      UIntShared* const pInternalState = reinterpret_cast<UIntShared*>(pFillMem + cBytesAllocated - sizeof(UIntShared));
+      *pInternalState = static_cast<UIntShared>(iOffset + size_t{1});
+
+      LOG_0(Trace_Info, "Exited EndFeature");
+      return Error_None;
+   }
+
+return_bad:;
+
+   pHeaderDataSetShared->m_id = k_sharedDataSetErrorId;
+   return Error_IllegalParamVal;
+}
+
 EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureWeight(IntEbm countSamples, const double* weights) {
    return AppendWeight(countSamples, weights, 0, nullptr);
 }
@@ -1964,7 +2600,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ExtractDataSetHeader(const void* da
 }
 
 // TODO: make an inline wrapper that forces this to the correct type and have 2 differently named functions
-// GetDataSetSharedFeature will return either (SparseFeatureDataSetSharedEntry *) or (UIntShared *)
+// GetDataSetSharedFeature will return either (SparseFeatureDataSetSharedEntry *) or (UIntShared *) or the caller's
+// external array of bin indexes
 extern const void* GetDataSetSharedFeature(const unsigned char* const pDataSetShared,
       const size_t iFeature,
       bool* const pbMissingOut,
@@ -1973,7 +2610,8 @@ extern const void* GetDataSetSharedFeature(const unsigned char* const pDataSetSh
       bool* const pbSparseOut,
       UIntShared* const pcBinsOut,
       UIntShared* const pDefaultValSparseOut,
-      size_t* const pcNonDefaultsSparseOut) {
+      size_t* const pcNonDefaultsSparseOut,
+      size_t* const pcBytesExternalOut) {
    EBM_ASSERT(nullptr != pDataSetShared);
    EBM_ASSERT(nullptr != pbMissingOut);
    EBM_ASSERT(nullptr != pbUnknownOut);
@@ -1982,6 +2620,7 @@ extern const void* GetDataSetSharedFeature(const unsigned char* const pDataSetSh
    EBM_ASSERT(nullptr != pcBinsOut);
    EBM_ASSERT(nullptr != pDefaultValSparseOut);
    EBM_ASSERT(nullptr != pcNonDefaultsSparseOut);
+   EBM_ASSERT(nullptr != pcBytesExternalOut);
 
    const HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<const HeaderDataSetShared*>(pDataSetShared);
    EBM_ASSERT(k_sharedDataSetDoneId == pHeaderDataSetShared->m_id);
@@ -2007,8 +2646,19 @@ extern const void* GetDataSetSharedFeature(const unsigned char* const pDataSetSh
 
    *pcBinsOut = pFeatureDataSetShared->m_cBins;
 
+   *pcBytesExternalOut = 0;
+
    const void* pRet = reinterpret_cast<const void*>(pFeatureDataSetShared + 1);
-   if(bSparse) {
+   if(IsExternalFeature(id)) {
+      EBM_ASSERT(!bSparse);
+      const ExternalFeatureDataSetShared* const pExternalFeatureDataSetShared =
+            reinterpret_cast<const ExternalFeatureDataSetShared*>(pRet);
+
+      const UIntShared cBytesPerBinIndex = pExternalFeatureDataSetShared->m_cBytesPerBinIndex;
+      EBM_ASSERT(IsExternalBinIndexSize(cBytesPerBinIndex)); // checked in CheckDataSet
+      *pcBytesExternalOut = static_cast<size_t>(cBytesPerBinIndex);
+      pRet = reinterpret_cast<const void*>(static_cast<uintptr_t>(pExternalFeatureDataSetShared->m_pBinIndexes));
+   } else if(bSparse) {
       const SparseFeatureDataSetShared* const pSparseFeatureDataSetShared =
             reinterpret_cast<const SparseFeatureDataSetShared*>(pRet);
 
@@ -6,9 +6,11 @@
 #define DATASET_SHARED_HPP
 
 #include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint8_t, uint16_t, uint32_t
 
 #include "libebm.h" // UIntEbm
 
+#include "logging.h" // EBM_ASSERT
 #include "bridge.h" // FloatShared
 
 #include "ebm_internal.hpp"
@@ -34,7 +36,9 @@ extern ErrorEbm GetDataSetSharedHeader(const unsigned char* const pDataSetShared
       size_t* const pcWeightsOut,
       size_t* const pcTargetsOut);
 
-// GetDataSetSharedFeature will return either (SparseFeatureDataSetSharedEntry *) or (UIntShared *)
+// GetDataSetSharedFeature will return either (SparseFeatureDataSetSharedEntry *) or (UIntShared *), or for external
+// features the caller's array of bin indexes, in which case *pcBytesExternalOut is set to the size of each item.
+// *pcBytesExternalOut is zero for features that are held within the shared dataset
 extern const void* GetDataSetSharedFeature(const unsigned char* const pDataSetShared,
       const size_t iFeature,
       bool* const pbMissingOut,
@@ -43,7 +47,22 @@ extern const void* GetDataSetSharedFeature(const unsigned char* const pDataSetSh
       bool* const pbSparseOut,
       UIntShared* const pcBinsOut,
       UIntShared* const pDefaultValSparseOut,
-      size_t* const pcNonDefaultsSparseOut);
+      size_t* const pcNonDefaultsSparseOut,
+      size_t* const pcBytesExternalOut);
+
+// external bin indexes follow the binIndexes convention of FillFeature, so when the feature has no missing bin
+// the caller needs to subtract 1 from the result to get the bin in the range [0, cBins)
+INLINE_ALWAYS static UIntShared GetExternalBinIndex(
+      const void* const aBinIndexes, const size_t cBytesPerBinIndex, const size_t iSample) noexcept {
+   if(sizeof(uint8_t) == cBytesPerBinIndex) {
+      return static_cast<UIntShared>(static_cast<const uint8_t*>(aBinIndexes)[iSample]);
+   } else if(sizeof(uint16_t) == cBytesPerBinIndex) {
+      return static_cast<UIntShared>(static_cast<const uint16_t*>(aBinIndexes)[iSample]);
+   } else {
+      EBM_ASSERT(sizeof(uint32_t) == cBytesPerBinIndex);
+      return static_cast<UIntShared>(static_cast<const uint32_t*>(aBinIndexes)[iSample]);
+   }
+}
 
 extern const FloatShared* GetDataSetSharedWeight(const unsigned char* const pDataSetShared, const size_t iWeight);
 
@@ -51,6 +70,23 @@ extern const FloatShared* GetDataSetSharedWeight(const unsigned char* const pDat
 extern const void* GetDataSetSharedTarget(
       const unsigned char* const pDataSetShared, const size_t iTarget, ptrdiff_t* const pcClassesOut);
 
+// the dataset builders in dataset_append.cpp and dataset_dedup.cpp read the features of finished datasets through
+// these, which unpack the stored bins back into the binIndexes convention that FillFeature accepts
+struct DataSetAppendFeature {
+   bool m_bMissing;
+   bool m_bUnknown;
+   bool m_bNominal;
+   UIntShared m_cBins;
+   const void* m_aFeatureData;
+   size_t m_cBytesExternal;
+};
+
+extern ErrorEbm GetAppendFeature(
+      const unsigned char* const pDataSetShared, const size_t iFeature, DataSetAppendFeature* const pFeatureOut);
+extern IntEbm GetCountBinsFill(const DataSetAppendFeature* const pFeature);
+extern void UnpackFeature(
+      const DataSetAppendFeature* const pFeature, const size_t cSamples, IntEbm* const aBinIndexes);
+
 } // namespace DEFINED_ZONE_NAME
 
 #endif // DATASET_SHARED_HPP
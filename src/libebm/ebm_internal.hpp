@@ -47,6 +47,8 @@ typedef double FloatPrecomp;
 static constexpr FloatCalc k_illegalGainFloat = std::numeric_limits<FloatCalc>::lowest();
 static constexpr double k_illegalGainDouble = std::numeric_limits<double>::lowest();
 
+static constexpr size_t k_cMemorySections = static_cast<size_t>(MemorySection_COUNT);
+
 #ifndef NDEBUG
 static constexpr FloatCalc k_epsilonNegativeGainAllowed = FloatCalc{-1e-7};
 #endif // NDEBUG
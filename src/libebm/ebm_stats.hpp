@@ -126,6 +126,14 @@ INLINE_ALWAYS static FloatCalc CalcPartialGainFromUpdate(const FloatCalc sumGrad
    return partialGain;
 }
 
+// the partial gain when deltaStepMax is infinite.  This has no branches, so loops over it can be vectorized
+INLINE_ALWAYS static FloatCalc CalcPartialGainUnclipped(
+      const FloatCalc sumGradient, const FloatCalc sumHessian, const FloatCalc regAlpha, const FloatCalc regLambda) {
+   EBM_ASSERT(std::isnan(sumHessian) || FloatCalc{0} < sumHessian);
+   const FloatCalc regularizedSumGradient = ApplyL1(sumGradient, regAlpha);
+   return regularizedSumGradient / ApplyL2(sumHessian, regLambda) * regularizedSumGradient;
+}
+
 template<bool bCheckHessian>
 INLINE_ALWAYS static FloatCalc CalcPartialGain(const FloatCalc sumGradient,
       const FloatCalc sumHessian,
@@ -149,8 +157,7 @@ INLINE_ALWAYS static FloatCalc CalcPartialGain(const FloatCalc sumGradient,
       const FloatCalc negUpdate = CalcNegUpdate<false>(sumGradient, sumHessian, regAlpha, regLambda, deltaStepMax);
       partialGain = CalcPartialGainFromUpdate<false>(sumGradient, sumHessian, negUpdate, regAlpha, regLambda);
    } else {
-      const FloatCalc regularizedSumGradient = ApplyL1(sumGradient, regAlpha);
-      partialGain = regularizedSumGradient / ApplyL2(sumHessian, regLambda) * regularizedSumGradient;
+      partialGain = CalcPartialGainUnclipped(sumGradient, sumHessian, regAlpha, regLambda);
 
       EBM_ASSERT(std::isnan(partialGain) ||
             IsApproxEqual(partialGain,
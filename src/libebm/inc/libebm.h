@@ -133,6 +133,26 @@ typedef struct _InteractionHandle {
    uint32_t handleVerification; // should be 21773 if ok. Do not use size_t since that requires an additional header.
 }* InteractionHandle;
 
+typedef struct _DataSetFileHandle {
+   uint32_t handleVerification; // should be 30491 if ok. Do not use size_t since that requires an additional header.
+}* DataSetFileHandle;
+
+typedef struct _PredictorHandle {
+   uint32_t handleVerification; // should be 17413 if ok. Do not use size_t since that requires an additional header.
+}* PredictorHandle;
+
+typedef struct _ScratchArenaHandle {
+   uint32_t handleVerification; // should be 8191 if ok. Do not use size_t since that requires an additional header.
+}* ScratchArenaHandle;
+
+typedef struct _PreparedTrainingDataHandle {
+   uint32_t handleVerification; // should be 24593 if ok. Do not use size_t since that requires an additional header.
+}* PreparedTrainingDataHandle;
+
+typedef struct _ModelSnapshotHandle {
+   uint32_t handleVerification; // should be 12889 if ok. Do not use size_t since that requires an additional header.
+}* ModelSnapshotHandle;
+
 #define BOOL_CAST(val)                     (STATIC_CAST(BoolEbm, (val)))
 #define MONOTONE_CAST(val)                 (STATIC_CAST(MonotoneDirection, (val)))
 #define ERROR_CAST(val)                    (STATIC_CAST(ErrorEbm, (val)))
@@ -191,6 +211,10 @@ typedef struct _InteractionHandle {
 // bad input values that are from the end user. These should have been filtered out by our higher level caller
 #define Error_UserParamVal      (ERROR_CAST(-4))
 #define Error_ThreadStartFailed (ERROR_CAST(-5))
+// the operating system failed to open, map, or write a file
+#define Error_FileIO (ERROR_CAST(-6))
+// the call was stopped early by CancelRunningCalls
+#define Error_Cancelled (ERROR_CAST(-7))
 
 #define Error_ObjectiveConstructorException    (ERROR_CAST(-10))
 #define Error_ObjectiveParamUnknown            (ERROR_CAST(-11))
@@ -213,6 +237,56 @@ typedef struct _InteractionHandle {
 #define CreateBoosterFlags_DifferentialPrivacy (CREATE_BOOSTER_FLAGS_CAST(0x00000001))
 #define CreateBoosterFlags_UseApprox           (CREATE_BOOSTER_FLAGS_CAST(0x00000002))
 #define CreateBoosterFlags_BinaryAsMulticlass  (CREATE_BOOSTER_FLAGS_CAST(0x00000004))
+#define CreateBoosterFlags_ValidationAuc       (CREATE_BOOSTER_FLAGS_CAST(0x00000008))
+#define CreateBoosterFlags_MixedPrecision      (CREATE_BOOSTER_FLAGS_CAST(0x00000010))
+#define CreateBoosterFlags_CompressGradients   (CREATE_BOOSTER_FLAGS_CAST(0x00000020))
+// boost with the hessians held at the objective's HessianConstant. Only objectives with a hessian bounded by that
+// constant, like pseudo_huber, accept it, and the others fail with Error_IllegalParamVal. Objectives without hessians
+// ignore it
+#define CreateBoosterFlags_ConstantHessian     (CREATE_BOOSTER_FLAGS_CAST(0x00000040))
+// count calls, work and time in the sections of boosting listed below, which GetBoosterProfile reports
+#define CreateBoosterFlags_Profile             (CREATE_BOOSTER_FLAGS_CAST(0x00000080))
+// fail with Error_UserParamVal instead of falling back to the cpu_64 zone when none of the requested AccelerationFlags
+// zones can be used, so that passing a single zone forces it
+#define CreateBoosterFlags_RequireAcceleration (CREATE_BOOSTER_FLAGS_CAST(0x00000100))
+// stochastically round the training gradients and hessians of each round to integers in [-127, 127] with a shared
+// scale before binning them, so that the histogram sums are exact. Ignored for RMSE. ComputeTermHistogram does not
+// quantize, since the machines summing their histograms would need to share the scale
+#define CreateBoosterFlags_QuantizeGradients   (CREATE_BOOSTER_FLAGS_CAST(0x00000200))
+// publish an immutable copy of the current and best models after every call that changes them, which
+// GetModelSnapshot can read from other threads while boosting continues
+#define CreateBoosterFlags_ModelSnapshots      (CREATE_BOOSTER_FLAGS_CAST(0x00000400))
+// compute the validation metric in the training pass from the samples that no inner bag draws, weighted like the
+// validation samples would be, instead of from a separate validation set. The bag cannot hold validation samples and
+// the booster needs at least one inner bag. Each bootstrap bag leaves out about 36.8% of the samples, so with k inner
+// bags only about 0.368^k of them are out of every bag and the metric gets noisy quickly as k grows
+#define CreateBoosterFlags_OutOfBagMetric      (CREATE_BOOSTER_FLAGS_CAST(0x00000800))
+
+// the sections of GetBoosterProfile, which are also the indexes into its output arrays
+#define ProfileSection_DataSet                 (STATIC_CAST(IntEbm, 0))
+#define ProfileSection_BinSumsBoosting         (STATIC_CAST(IntEbm, 1))
+#define ProfileSection_TensorTotalsBuild       (STATIC_CAST(IntEbm, 2))
+#define ProfileSection_PartitionOneDimensional (STATIC_CAST(IntEbm, 3))
+#define ProfileSection_PartitionTwoDimensional (STATIC_CAST(IntEbm, 4))
+#define ProfileSection_Purify                  (STATIC_CAST(IntEbm, 5))
+#define ProfileSection_ApplyUpdate             (STATIC_CAST(IntEbm, 6))
+#define ProfileSection_COUNT                   (STATIC_CAST(IntEbm, 7))
+
+// the subsystems of GetBoosterMemoryUsage, GetInteractionMemoryUsage and EstimateBoosterMemoryUsage, which are also
+// the indexes into their output arrays
+// bit packed feature and term data, including the sparse and cache blocked sample lists
+#define MemorySection_TermData     (STATIC_CAST(IntEbm, 0))
+// targets in the compute format, and the copy of the original targets some objectives keep
+#define MemorySection_Targets      (STATIC_CAST(IntEbm, 1))
+// sample weights, inner bag weights, and the bin counts and weights of each term in each inner bag
+#define MemorySection_Weights      (STATIC_CAST(IntEbm, 2))
+#define MemorySection_Gradients    (STATIC_CAST(IntEbm, 3))
+#define MemorySection_SampleScores (STATIC_CAST(IntEbm, 4))
+// the current and best models and the term updates
+#define MemorySection_Tensors      (STATIC_CAST(IntEbm, 5))
+// histogram bins, split positions and tree nodes that are reused between calls
+#define MemorySection_Scratch      (STATIC_CAST(IntEbm, 6))
+#define MemorySection_COUNT        (STATIC_CAST(IntEbm, 7))
 
 #define TermBoostFlags_Default             (TERM_BOOST_FLAGS_CAST(0x00000000))
 #define TermBoostFlags_PurifyGain          (TERM_BOOST_FLAGS_CAST(0x00000001))
@@ -221,22 +295,35 @@ typedef struct _InteractionHandle {
 #define TermBoostFlags_DisableNewtonUpdate (TERM_BOOST_FLAGS_CAST(0x00000008))
 #define TermBoostFlags_GradientSums        (TERM_BOOST_FLAGS_CAST(0x00000010))
 #define TermBoostFlags_RandomSplits        (TERM_BOOST_FLAGS_CAST(0x00000020))
+// mains on nominal features split their bins in order of gradient over hessian, so each split can group any of the
+// categories together. Only applies to a single score without a monotone constraint
+#define TermBoostFlags_SortNominal         (TERM_BOOST_FLAGS_CAST(0x00000040))
 
 #define CreateInteractionFlags_Default             (CREATE_INTERACTION_FLAGS_CAST(0x00000000))
 #define CreateInteractionFlags_DifferentialPrivacy (CREATE_INTERACTION_FLAGS_CAST(0x00000001))
 #define CreateInteractionFlags_UseApprox           (CREATE_INTERACTION_FLAGS_CAST(0x00000002))
 #define CreateInteractionFlags_BinaryAsMulticlass  (CREATE_INTERACTION_FLAGS_CAST(0x00000004))
+#define CreateInteractionFlags_CacheMarginals     (CREATE_INTERACTION_FLAGS_CAST(0x00000008))
+// like CreateBoosterFlags_RequireAcceleration
+#define CreateInteractionFlags_RequireAcceleration (CREATE_INTERACTION_FLAGS_CAST(0x00000010))
+// splits the samples into enough subsets for CalcInteractionStrengthInterval to leave out one group of them at a time
+#define CreateInteractionFlags_JackknifeGroups    (CREATE_INTERACTION_FLAGS_CAST(0x00000020))
 
 #define CalcInteractionFlags_Default       (CALC_INTERACTION_FLAGS_CAST(0x00000000))
 #define CalcInteractionFlags_Purify        (CALC_INTERACTION_FLAGS_CAST(0x00000001))
 #define CalcInteractionFlags_DisableNewton (CALC_INTERACTION_FLAGS_CAST(0x00000002))
+// terms of 3 or more features accumulate only their occupied tensor cells, ignore maxCardinality, and are scored by
+// an approximate best cut of each feature. Ignored with CalcInteractionFlags_Purify
+#define CalcInteractionFlags_SparseBins    (CALC_INTERACTION_FLAGS_CAST(0x00000004))
 
 #define AccelerationFlags_NONE      (ACCELERATION_CAST(0x00000000))
 #define AccelerationFlags_Nvidia    (ACCELERATION_CAST(0x00000001))
 #define AccelerationFlags_AVX2      (ACCELERATION_CAST(0x00000002))
 #define AccelerationFlags_AVX512F   (ACCELERATION_CAST(0x00000004))
+#define AccelerationFlags_NEON      (ACCELERATION_CAST(0x00000008))
 #define AccelerationFlags_IntelSIMD (AccelerationFlags_AVX2 | AccelerationFlags_AVX512F)
-#define AccelerationFlags_SIMD      (AccelerationFlags_IntelSIMD)
+#define AccelerationFlags_ArmSIMD   (AccelerationFlags_NEON)
+#define AccelerationFlags_SIMD      (AccelerationFlags_IntelSIMD | AccelerationFlags_ArmSIMD)
 #define AccelerationFlags_GPU       (AccelerationFlags_Nvidia)
 #define AccelerationFlags_ALL       (ACCELERATION_CAST(~ACCELERATION_CAST(0)))
 
@@ -251,6 +338,16 @@ typedef struct _InteractionHandle {
 // All messages logged. Useful for tracing execution in detail. Might log too much detail for production systems.
 #define Trace_Verbose (TRACE_CAST(4))
 
+// structured trace events, with the numeric fields each one carries in order
+// GenerateTermUpdate: indexTerm, learningRate, flags, gainAvg
+#define TraceEvent_GenerateTermUpdate       (STATIC_CAST(IntEbm, 1))
+// ApplyTermUpdate: indexTerm, validationMetricAvg
+#define TraceEvent_ApplyTermUpdate          (STATIC_CAST(IntEbm, 2))
+// CalcInteractionStrength: countDimensions, flags, bestGain
+#define TraceEvent_CalcInteractionStrength  (STATIC_CAST(IntEbm, 3))
+// no event has more fields than this, so DrainTraceEvents writes this many doubles per event
+#define TraceEventFieldsMax                 (STATIC_CAST(IntEbm, 4))
+
 // https://www.sagepub.com/sites/default/files/upm-binaries/21121_Chapter_15.pdf
 // https://www.rdocumentation.org/packages/VGAM/versions/1.1-8/topics/Links
 #define Link_ERROR (LINK_CAST(0))
@@ -298,6 +395,58 @@ EBM_API_INCLUDE void EBM_CALLING_CONVENTION SetLogCallback(LogCallbackFunction l
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION SetTraceLevel(TraceEbm traceLevel);
 EBM_API_INCLUDE const char* EBM_CALLING_CONVENTION GetTraceLevelString(TraceEbm traceLevel);
 
+// Structured trace events are separate from the text log above. Nothing is formatted when they are raised, so they
+// are cheap enough to leave on in production and are not throttled like the text messages of the hot functions.
+// handle is the BoosterHandle or InteractionHandle the event concerns and fields are TraceEvent_* specific.
+typedef void(EBM_CALLING_CONVENTION* TraceEventCallbackFunction)(
+      TraceEbm traceLevel, IntEbm eventId, void* handle, IntEbm countFields, const double* fields);
+
+// SetTraceEventCallback calls traceEventCallback on the raising thread for each event at or below traceLevel. It
+// replaces any buffer set by SetTraceEventBuffer. Use Trace_Off to stop raising events. Neither this nor
+// SetTraceEventBuffer may be called while other libebm calls are running.
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION SetTraceEventCallback(
+      TraceEbm traceLevel, TraceEventCallbackFunction traceEventCallback);
+// SetTraceEventBuffer queues events at or below traceLevel into a lock-free ring of at least countEvents events,
+// instead of calling back. Events raised while the ring is full are dropped and counted. countEvents of 0 frees it.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetTraceEventBuffer(TraceEbm traceLevel, IntEbm countEvents);
+// DrainTraceEvents moves up to countEventsMax queued events out of the ring, oldest first, and returns how many it
+// moved. fieldsOut holds TraceEventFieldsMax doubles per event, with unused fields set to NaN. countDroppedOut
+// receives the number of events dropped since the previous drain. It can run on any single thread while events are
+// being raised.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION DrainTraceEvents(IntEbm countEventsMax,
+      TraceEbm* traceLevelsOut,
+      IntEbm* eventIdsOut,
+      void** handlesOut,
+      double* fieldsOut,
+      IntEbm* countDroppedOut);
+
+// An objective creation function for one compute zone, with the same signature as the CreateObjective_* functions
+// in bridge.h. The config is a Config and the wrapper is an ObjectiveWrapper from bridge.h. Functions that do not
+// recognize the objective string should return Error_ObjectiveUnknown.
+typedef ErrorEbm (*CreateObjectiveFunction)(
+      const void* config, const char* objective, const char* objectiveEnd, void* objectiveWrapperOut);
+
+// Registers objectives that are compiled outside of libebm, typically in a shared library that the caller loads.
+// The functions must be built against the same libebm headers, and the kernels they return are called directly,
+// so they run at the same speed as the built in objectives. createCpu is required and the SIMD functions can be
+// NULL. Registered objectives are checked before the built in ones. This is not thread safe with respect to
+// boosters and interactions that are being created, so register all objectives before creating any.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION RegisterObjective(CreateObjectiveFunction createCpu,
+      CreateObjectiveFunction createAvx2,
+      CreateObjectiveFunction createAvx512f);
+// GetAvailableAcceleration returns the AccelerationFlags zones that were compiled in and that this machine can run.
+// AccelerationFlags_NONE means that everything runs in the cpu_64 zone
+EBM_API_INCLUDE AccelerationFlags EBM_CALLING_CONVENTION GetAvailableAcceleration(void);
+
+// libebm runs the work of one call on a process wide thread pool. SetThreadCount caps the threads that all libebm calls
+// use together, and 0 restores the default of one thread per hardware thread. Calls made from several threads at once
+// or from inside BoostOuterBags run on their calling thread rather than adding more threads. SetThreadAffinity
+// controls whether the workers are pinned to the NUMA nodes of the machine, which is the default. Both apply from the
+// next call, except that boosters and interactions never use more threads than they had when they were created. A
+// forked child process recreates the pool on its next call.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetThreadCount(IntEbm countThreads);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetThreadAffinity(BoolEbm isAffinity);
+
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION CleanFloats(IntEbm count, double* valsInOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SafeMean(
       IntEbm countBags, IntEbm countTensorBins, const double* vals, const double* weights, double* tensorOut);
@@ -308,6 +457,9 @@ EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureRNG(void);
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION InitRNG(SeedEbm seed, void* rngOut);
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION CopyRNG(void* rng, void* rngOut);
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION BranchRNG(void* rng, void* rngOut);
+// BranchRNGStream sets rngOut to substream indexStream of rng without advancing rng. Any substream can be taken
+// directly and in any order, so threads can branch their own streams from a shared rng without coordinating.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION BranchRNGStream(void* rng, IntEbm indexStream, void* rngOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateSeed(void* rng, SeedEbm* seedOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateGaussianRandom(
       void* rng, double stddev, IntEbm count, double* randomOut);
@@ -329,11 +481,42 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
       double* scoresInOut,
       double* impuritiesOut,
       double* interceptOut);
+// PurifyModel purifies countTerms terms as Purify would, spread across threads. dimensionLengths, weights,
+// scoresInOut and impuritiesOut hold the arrays that Purify takes for each term, one term after the other. A term
+// without dimensions has a single bin and is left unchanged. interceptsOut receives countMultiScores intercepts for
+// each term. If not NULL, sweepCountsOut receives the number of sweeps over the surface bins that each term needed.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION PurifyModel(double tolerance,
+      BoolEbm isRandomized,
+      BoolEbm isMulticlassNormalization,
+      IntEbm countMultiScores,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* dimensionLengths,
+      const double* weights,
+      double* scoresInOut,
+      double* impuritiesOut,
+      double* interceptsOut,
+      IntEbm* sweepCountsOut);
 
 EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION GetHistogramCutCount(IntEbm countSamples, const double* featureVals);
+// GetHistogramCutCount for each of countColumns columns of countSamples values, one column after the other
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetHistogramCutCountBatch(
+      IntEbm countSamples, IntEbm countColumns, const double* featureVals, IntEbm* countCutsOut);
 // CutUniform does not fail with valid inputs, so we return the number of cuts generated
 EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION CutUniform(
       IntEbm countSamples, const double* featureVals, IntEbm countDesiredCuts, double* cutsLowerBoundInclusiveOut);
+// featureVals holds countColumns columns of countSamples values each, one column after the other. Each column is cut
+// as CutUniform would with its countCutsInOut value, which is then overwritten with the number of cuts made. The
+// cuts are laid out in cutsLowerBoundInclusiveOut the same way as for CutQuantileBatch. If not NULL,
+// minFeatureValsOut and maxFeatureValsOut receive each column's non-missing min and max from the same scan, or NaN
+// if the column only has missing values, ready for SuggestGraphBoundsBatch.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutUniformBatch(IntEbm countSamples,
+      IntEbm countColumns,
+      const double* featureVals,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut,
+      double* minFeatureValsOut,
+      double* maxFeatureValsOut);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
       const double* featureVals,
@@ -341,8 +524,39 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
       BoolEbm isRounded,
       IntEbm* countCutsInOut,
       double* cutsLowerBoundInclusiveOut);
+// featureVals holds countColumns columns of countSamples values each, one column after the other. Each column is cut
+// as CutQuantile would with its own minSamplesBin and countCutsInOut value. The cuts for a column are written into
+// cutsLowerBoundInclusiveOut starting at the sum of the countCutsInOut values passed in for the earlier columns.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantileBatch(IntEbm countSamples,
+      IntEbm countColumns,
+      const double* featureVals,
+      const IntEbm* minSamplesBin,
+      BoolEbm isRounded,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut);
+// A quantile sketch approximates CutQuantile for data that does not fit into memory at once. The sketch lives in
+// countBytesAllocated bytes of caller memory from MeasureQuantileSketch, and it can be copied between processes on
+// the same architecture. Chunks of a column are added with AppendQuantileSketch, where weights can be nullptr for
+// unit weights, and sketches built on separate shards are combined with MergeQuantileSketch. More centroids give
+// more accurate cuts. CutQuantileSketch respects minSamplesBin as a minimum weight per bin.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureQuantileSketch(IntEbm countCentroidsMax);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION InitQuantileSketch(
+      IntEbm countCentroidsMax, IntEbm countBytesAllocated, void* sketchOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION AppendQuantileSketch(
+      IntEbm countSamples, const double* featureVals, const double* weights, void* sketchInOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION MergeQuantileSketch(const void* sketchFrom, void* sketchInOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantileSketch(const void* sketch,
+      IntEbm minSamplesBin,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
       IntEbm countSamples, const double* featureVals, IntEbm* countCutsInOut, double* cutsLowerBoundInclusiveOut);
+// cuts each of the countColumns columns in featureVals as CutWinsorized would, laid out as for CutQuantileBatch
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutWinsorizedBatch(IntEbm countSamples,
+      IntEbm countColumns,
+      const double* featureVals,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SuggestGraphBounds(IntEbm countCuts,
       double lowestCut,
@@ -351,15 +565,42 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SuggestGraphBounds(IntEbm countC
       double maxFeatureVal,
       double* lowGraphBoundOut,
       double* highGraphBoundOut);
+// SuggestGraphBounds for each of countColumns columns, with the cuts laid out as CutQuantileBatch leaves them: the
+// cuts of column i start at the sum of countCuts over the earlier columns
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SuggestGraphBoundsBatch(IntEbm countColumns,
+      const IntEbm* countCuts,
+      const double* cutsLowerBoundInclusive,
+      const double* minFeatureVals,
+      const double* maxFeatureVals,
+      double* lowGraphBoundsOut,
+      double* highGraphBoundsOut);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
       const double* featureVals,
       IntEbm countCuts,
       const double* cutsLowerBoundInclusive,
       IntEbm* binIndexesOut);
+// DiscretizeBatch bins countColumns columns of featureVals, each holding countSamples values (column-major), in
+// parallel. Column i uses countCuts[i] cuts taken in order from cutsLowerBoundInclusive. Each column's bin indexes are
+// written as unsigned integers of the fewest bytes (1, 2, or 4) that hold them, starting binIndexesOffsetsOut[i] bytes
+// into binIndexesOut, which must be aligned to 4 bytes and hold MeasureDiscretizeBatch bytes. The width goes into
+// countBytesPerBinIndexOut[i], so each column can be given to FillFeatureExternal without further conversion.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureDiscretizeBatch(
+      IntEbm countSamples, IntEbm countColumns, const IntEbm* countCuts);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DiscretizeBatch(IntEbm countSamples,
+      IntEbm countColumns,
+      const double* featureVals,
+      const IntEbm* countCuts,
+      const double* cutsLowerBoundInclusive,
+      IntEbm countBytesAllocated,
+      void* binIndexesOut,
+      IntEbm* binIndexesOffsetsOut,
+      IntEbm* countBytesPerBinIndexOut);
 
 EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureDataSetHeader(
       IntEbm countFeatures, IntEbm countWeights, IntEbm countTargets);
+// binIndexes can be nullptr in MeasureFeature, in which case the size comes from countBins and countSamples alone.
+// That is the size that BeginFeature needs
 EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureFeature(IntEbm countBins,
       BoolEbm isMissing,
       BoolEbm isUnknown,
@@ -381,6 +622,40 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillFeature(IntEbm countBins,
       const IntEbm* binIndexes,
       IntEbm countBytesAllocated,
       void* fillMem);
+// the External variants reference binIndexes instead of copying them into the dataset. binIndexes holds
+// countBytesPerBinIndex (1, 2, or 4) unsigned bytes per sample and must remain valid and unmodified until every
+// booster and interaction detector made from the dataset is freed. Datasets with external features cannot be
+// used outside of the process that filled them.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureFeatureExternal(IntEbm countBins,
+      BoolEbm isMissing,
+      BoolEbm isUnknown,
+      BoolEbm isNominal,
+      IntEbm countSamples,
+      IntEbm countBytesPerBinIndex,
+      const void* binIndexes);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillFeatureExternal(IntEbm countBins,
+      BoolEbm isMissing,
+      BoolEbm isUnknown,
+      BoolEbm isNominal,
+      IntEbm countSamples,
+      IntEbm countBytesPerBinIndex,
+      const void* binIndexes,
+      IntEbm countBytesAllocated,
+      void* fillMem);
+// BeginFeature, AppendFeatureChunk and EndFeature fill a feature from consecutive chunks of binIndexes instead of
+// needing the whole column at once. Chunks can have any length, but together they must hold exactly countSamples
+// items before EndFeature is called. No other Fill function can be called between BeginFeature and EndFeature, and
+// the last section of a dataset cannot be streamed, which is never a feature when the dataset has a weight or target.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION BeginFeature(IntEbm countBins,
+      BoolEbm isMissing,
+      BoolEbm isUnknown,
+      BoolEbm isNominal,
+      IntEbm countSamples,
+      IntEbm countBytesAllocated,
+      void* fillMem);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION AppendFeatureChunk(
+      IntEbm countSamplesChunk, const IntEbm* binIndexes, IntEbm countBytesAllocated, void* fillMem);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION EndFeature(IntEbm countBytesAllocated, void* fillMem);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillWeight(
       IntEbm countSamples, const double* weights, IntEbm countBytesAllocated, void* fillMem);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillClassificationTarget(
@@ -402,6 +677,39 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractBinCounts(
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractTargetClasses(
       const void* dataSet, IntEbm countTargetsVerify, IntEbm* classCountsOut);
 
+// WriteDataSetFile stores a finished dataset in a versioned file that OpenDataSetFile maps back into memory without
+// copying it, so the dataSetOut pointer can be passed directly to CreateBooster and CreateInteractionDetector. The
+// mapping is read only and shared through the page cache with any other process that opens the same file. It must
+// stay open until those calls return. Datasets with external features cannot be written to a file.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION WriteDataSetFile(
+      IntEbm countBytesAllocated, const void* dataSet, const char* filename);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION OpenDataSetFile(const char* filename,
+      DataSetFileHandle* dataSetFileHandleOut,
+      const void** dataSetOut,
+      IntEbm* countBytesOut);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION CloseDataSetFile(DataSetFileHandle dataSetFileHandle);
+
+// FillAppendedDataSet builds a dataset that holds the samples of dataSet followed by the samples of dataSetAppend.
+// Both datasets need the same features, weights and targets, and the appended samples must be binned with the cuts
+// that were used for dataSet, since the stored bins are copied without being binned again. Bags and initScores for the
+// combined dataset cover the original samples first. To continue training on the combined dataset without starting
+// from zero, pass the term scores of the previous model as initTermScores to CreateBooster.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureAppendedDataSet(const void* dataSet, const void* dataSetAppend);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillAppendedDataSet(
+      const void* dataSet, const void* dataSetAppend, IntEbm countBytesAllocated, void* fillMem);
+
+// FillDedupedDataSet builds a dataset with one row for each distinct combination of bins and targets in dataSet, in the
+// order in which they first appear. The weight of each row is the sum of the weights of the samples it merges, or
+// their count when dataSet has no weights. MeasureDedupedDataSet returns the number of unique rows in countSamplesOut.
+// uniqueIndexesOut can be NULL, or else it receives the unique row of each sample in dataSet, which maps the scores of
+// the deduplicated dataset back to the original samples. Bags and initScores apply to the unique rows, so sampling
+// a row includes all the samples that were merged into it. Boosting and interaction detection only give the same
+// results as on dataSet when minSamplesLeaf is 1 or less and there are no inner bags, since minSamplesLeaf counts
+// unique rows and inner bags draw unique rows. Use minHessian instead, which sums the weights, to limit small leaves.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureDedupedDataSet(const void* dataSet, IntEbm* countSamplesOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillDedupedDataSet(
+      const void* dataSet, IntEbm countBytesAllocated, void* fillMem, IntEbm* uniqueIndexesOut);
+
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacement(
       void* rng, IntEbm countTrainingSamples, IntEbm countValidationSamples, BagEbm* bagOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratified(void* rng,
@@ -410,6 +718,17 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratifi
       IntEbm countValidationSamples,
       const IntEbm* targets,
       BagEbm* bagOut);
+// GenerateBags fills countBags bags one after the other, so bag i begins at
+// bagsOut[i * (countTrainingSamples + countValidationSamples)]. The bags are drawn on separate threads, each from an
+// RNG branched from rng in bag order, which makes them identical to calling BranchRNG and then SampleWithoutReplacement
+// once per bag. If targets is not NULL, SampleWithoutReplacementStratified is used instead and countClasses applies.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateBags(void* rng,
+      IntEbm countBags,
+      IntEbm countClasses,
+      IntEbm countTrainingSamples,
+      IntEbm countValidationSamples,
+      const IntEbm* targets,
+      BagEbm* bagsOut);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DetermineTask(const char* objective, TaskEbm* taskOut);
 EBM_API_INCLUDE const char* EBM_CALLING_CONVENTION GetTaskStr(TaskEbm task);
@@ -420,6 +739,22 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DetermineLinkFunction(
 EBM_API_INCLUDE const char* EBM_CALLING_CONVENTION GetLinkFunctionStr(LinkEbm link);
 EBM_API_INCLUDE LinkEbm EBM_CALLING_CONVENTION GetLinkFunctionInt(const char* link);
 
+// A scratch arena caches the bin, split and tree node buffers of the boosters and interaction detectors created with
+// it after they are freed, and hands them to the next ones instead of allocating. It is worth passing when many short
+// lived handles are made in sequence, like for cross validation folds or outer bags. Handles keep their arena alive,
+// so the arena can be freed at any time. countBytesInUse counts the buffers that live handles hold, countBytesCached
+// the ones waiting to be reused, and countAllocations and countReuses how each buffer request was satisfied.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateScratchArena(ScratchArenaHandle* scratchArenaHandleOut);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreeScratchArena(ScratchArenaHandle scratchArenaHandle);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetScratchArenaCounts(ScratchArenaHandle scratchArenaHandle,
+      IntEbm* countBytesInUseOut,
+      IntEbm* countBytesCachedOut,
+      IntEbm* countAllocationsOut,
+      IntEbm* countReusesOut);
+
+// initTermScores warm starts the booster from a previous model. It holds a tensor for every term, one after another in
+// the layout of GetBestTermScores, which become the starting current and best models. The sample scores are moved by
+// them in one pass over the bit packed term data, on top of initScores if both are given. It can be nullptr.
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
       const void* dataSet,
       const BagEbm* bag,
@@ -428,15 +763,59 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
       IntEbm countTerms,
       const IntEbm* dimensionCounts,
       const IntEbm* featureIndexes,
+      const double* initTermScores, // can be nullptr
       IntEbm countInnerBags,
       CreateBoosterFlags flags,
       AccelerationFlags acceleration,
       const char* objective,
       const double* experimentalParams,
+      ScratchArenaHandle scratchArenaHandle, // can be nullptr
+      BoosterHandle* boosterHandleOut);
+// Prepared training data holds the bit packed features, targets and weights that CreateBooster would build from a
+// dataset, bag and set of terms. Boosters made from it share that data and only allocate their own gradients, scores
+// and model tensors, which is cheaper when many boosters differ only by their inner bags, init scores or boosting
+// parameters. Boosters keep the prepared data alive, so it can be freed at any time.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreatePreparedTrainingData(const void* dataSet,
+      const BagEbm* bag,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      CreateBoosterFlags flags,
+      AccelerationFlags acceleration,
+      const char* objective,
+      const double* experimentalParams,
+      PreparedTrainingDataHandle* preparedTrainingDataHandleOut);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreePreparedTrainingData(
+      PreparedTrainingDataHandle preparedTrainingDataHandle);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBoosterFromPreparedTrainingData(void* rng,
+      PreparedTrainingDataHandle preparedTrainingDataHandle,
+      const double* initScores, // indexed like CreateBooster, by the samples the prepared bag includes
+      const double* initTermScores, // can be nullptr
+      IntEbm countInnerBags,
+      ScratchArenaHandle scratchArenaHandle, // can be nullptr
+      BoosterHandle* boosterHandleOut);
+// CreateFoldBoosterFromPreparedTrainingData makes a booster for one cross validation fold. folds holds the fold of
+// every sample in the dataset, and the training samples whose fold is indexFold are held out by giving them zero
+// weight in every inner bag, so the k fold boosters share the packed data and each owns only its gradients and
+// scores. The held out samples still have their scores updated, so GetSampleScores with a direction of 1 returns
+// their out of fold scores. The validation set remains the one that the prepared bag defines
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateFoldBoosterFromPreparedTrainingData(void* rng,
+      PreparedTrainingDataHandle preparedTrainingDataHandle,
+      const IntEbm* folds, // one per dataset sample, including the ones that the prepared bag excludes
+      IntEbm indexFold,
+      const double* initScores, // indexed like CreateBooster, by the samples the prepared bag includes
+      const double* initTermScores, // can be nullptr
+      IntEbm countInnerBags,
+      ScratchArenaHandle scratchArenaHandle, // can be nullptr
       BoosterHandle* boosterHandleOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBoosterView(
       BoosterHandle boosterHandle, BoosterHandle* boosterHandleViewOut);
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreeBooster(BoosterHandle boosterHandle);
+// GetBoosterAcceleration writes the zone that the booster's SIMD or GPU kernels were bound to, or
+// AccelerationFlags_NONE if it only uses the cpu_64 zone. Samples that do not fill a whole SIMD pack are always
+// processed in the cpu_64 zone
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetBoosterAcceleration(
+      BoosterHandle boosterHandle, AccelerationFlags* accelerationOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
       BoosterHandle boosterHandle,
       IntEbm indexTerm,
@@ -450,6 +829,33 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
       const IntEbm* leavesMax,
       const MonotoneDirection* direction,
       double* avgGainOut);
+// For boosting over data that is sharded across machines, GenerateTermUpdate is split in two. ComputeTermHistogram
+// sums the local training samples of one inner bag for a term. Each tensor bin is written as its sample count, its
+// weight, and then the gradient and hessian sums of each score, or only the gradient sums when the objective has no
+// hessian. The caller adds the histograms of all machines elementwise, for example with an MPI allreduce, and passes
+// the histograms of every inner bag one after another to GenerateTermUpdateFromHistogram on each machine. Given the
+// same rng state, every machine then makes the same update, which ApplyTermUpdate applies to its local samples.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureTermHistogram(BoosterHandle boosterHandle, IntEbm indexTerm);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ComputeTermHistogram(BoosterHandle boosterHandle,
+      IntEbm indexTerm,
+      IntEbm indexBag,
+      IntEbm countHistogramValues,
+      double* histogramOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdateFromHistogram(void* rng,
+      BoosterHandle boosterHandle,
+      IntEbm indexTerm,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      const MonotoneDirection* direction,
+      IntEbm countHistogramValues,
+      const double* histograms,
+      double* avgGainOut);
 // GetTermUpdateSplits must be called before calls to GetTermUpdate/SetTermUpdate
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetTermUpdateSplits(
       BoosterHandle boosterHandle, IntEbm indexDimension, IntEbm* countSplitsInOut, IntEbm* splitsOut);
@@ -457,12 +863,273 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetTermUpdate(
       BoosterHandle boosterHandle, double* updateScoresTensorOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetTermUpdate(
       BoosterHandle boosterHandle, IntEbm indexTerm, const double* updateScoresTensor);
+// with CreateBoosterFlags_ValidationAuc the binary classification validation metric is the negated AUC, so that
+// smaller is still better
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
       BoosterHandle boosterHandle, double* avgValidationMetricOut);
+// keeps the samples whose gradients are in the top topFraction by magnitude plus a random otherFraction of all
+// samples drawn from the rest, which are weighted up to stand in for the rest. The following GenerateTermUpdate calls
+// bin only the kept samples until this is called again. A topFraction + otherFraction of 1.0 or more keeps every sample
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleGradients(
+      void* rng, BoosterHandle boosterHandle, double topFraction, double otherFraction);
+// same as ApplyTermUpdate, but also sums the histogram for indexTermNext while the updated gradients are in the
+// cache. A GenerateTermUpdate call on indexTermNext that directly follows this call skips its first binning pass
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdateAndBinNext(
+      BoosterHandle boosterHandle, IntEbm indexTermNext, double* avgValidationMetricOut);
+// with a countUpdates above 1, ApplyTermUpdate and the calls built on it only update the training set and hold the
+// update back from the validation set. Every countUpdates updates, all of the held back updates are applied to the
+// validation set in a single pass. The calls in between report a validation metric of +inf and leave the best model
+// alone. BoostCyclic and BoostGreedy also apply the held back updates at the end of every round, so a countUpdates
+// at or above the number of terms validates once per round. 0 and 1 validate every update, which is the default
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetValidationBatch(BoosterHandle boosterHandle, IntEbm countUpdates);
+// applies the updates that SetValidationBatch held back to the validation set now and reports the validation metric,
+// after which the current model becomes the best model if it is the best so far. Reports +inf if nothing was held back
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ApplyValidationUpdates(
+      BoosterHandle boosterHandle, double* avgValidationMetricOut);
+// runs GenerateTermUpdate and ApplyTermUpdateAndBinNext over all terms in order for up to maxRounds rounds.
+// leavesMax applies to every term. A non-positive earlyStoppingRounds disables early stopping
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION BoostCyclic(void* rng,
+      BoosterHandle boosterHandle,
+      IntEbm maxRounds,
+      IntEbm earlyStoppingRounds,
+      double earlyStoppingTolerance,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      IntEbm* countRoundsOut,
+      double* minMetricOut);
+// boosts the countTerms terms in indexTerms as one Jacobi step. Every update is generated from the same gradients with
+// learningRate divided by countTerms, and then all of the updates are applied in a single pass that computes the
+// gradients and the validation metric once. avgGainsOut receives countTerms gains, or can be nullptr
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION BoostJacobi(void* rng,
+      BoosterHandle boosterHandle,
+      IntEbm countTerms,
+      const IntEbm* indexTerms,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      double* avgGainsOut,
+      double* avgValidationMetricOut);
+// boosts the terms in order of the gain each one had when it was last boosted instead of in strict cycles. The first
+// round and every refreshRounds-th round after it boost every term, and the other rounds only boost the
+// countTermsPerRound terms with the highest gains. An update whose gain is at or below gainTolerance is dropped
+// without applying it. A non-positive refreshRounds only refreshes on the first round, and a non-positive
+// countTermsPerRound boosts every term on every round. Boosting ends early when a refresh round drops every update.
+// The other parameters work as in BoostCyclic
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION BoostGreedy(void* rng,
+      BoosterHandle boosterHandle,
+      IntEbm maxRounds,
+      IntEbm refreshRounds,
+      IntEbm countTermsPerRound,
+      double gainTolerance,
+      IntEbm earlyStoppingRounds,
+      double earlyStoppingTolerance,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      IntEbm* countRoundsOut,
+      double* minMetricOut);
+// creates countOuterBags boosters over dataSet and runs BoostCyclic on each of them concurrently. bags holds
+// countOuterBags bags of countSamples items each, or is nullptr. avgTermScoresOut receives the best term scores of all
+// terms, one tensor after another in the layout of GetBestTermScores, averaged over the outer bags
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION BoostOuterBags(void* rng,
+      const void* dataSet,
+      IntEbm countOuterBags,
+      const BagEbm* bags,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      IntEbm countInnerBags,
+      CreateBoosterFlags createBoosterFlags,
+      AccelerationFlags acceleration,
+      const char* objective,
+      const double* experimentalParams,
+      IntEbm maxRounds,
+      IntEbm earlyStoppingRounds,
+      double earlyStoppingTolerance,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      double* avgTermScoresOut);
+// OuterBagFinishedFunction receives the countTermScores best term scores of outer bag indexOuterBag, laid out as in
+// avgTermScoresOut of BoostOuterBags and only valid during the call. Returning anything but Error_None stops the bags
+// that have not started and becomes the result of BoostOuterBagsStreaming
+typedef ErrorEbm (*OuterBagFinishedFunction)(
+      void* context, IntEbm indexOuterBag, IntEbm countTermScores, const double* termScores);
+// BoostOuterBagsStreaming boosts the outer bags like BoostOuterBags, but hands each bag's scores to outerBagFinished as
+// soon as the bag is done and frees its booster right away. Each thread moves on to create the booster of the next bag
+// while the other threads are still boosting theirs, and at most maxBoostersLive boosters exist at once, or any number
+// if it is 0. The callbacks come one at a time from libebm threads, in the order that the bags finish
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION BoostOuterBagsStreaming(void* rng,
+      const void* dataSet,
+      IntEbm countOuterBags,
+      const BagEbm* bags,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      IntEbm countInnerBags,
+      CreateBoosterFlags createBoosterFlags,
+      AccelerationFlags acceleration,
+      const char* objective,
+      const double* experimentalParams,
+      IntEbm maxBoostersLive,
+      IntEbm maxRounds,
+      IntEbm earlyStoppingRounds,
+      double earlyStoppingTolerance,
+      TermBoostFlags flags,
+      double learningRate,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      const IntEbm* leavesMax,
+      OuterBagFinishedFunction outerBagFinished,
+      void* context);
+// CancelRunningCalls makes every BoostCyclic, BoostGreedy, BoostOuterBags, BoostOuterBagsStreaming,
+// CalcInteractionStrengths and FindTopInteractions call that has already started return Error_Cancelled at its next
+// round, term, or task boundary. Calls that start after it returns are unaffected. It can be called from any thread,
+// which is how a caller that keeps its own thread free while libebm works in the background stops a long call. The
+// booster keeps the model from the last finished round
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION CancelRunningCalls(void);
+// GetBoosterProfile writes the first countSections ProfileSection counters of a booster made with
+// CreateBoosterFlags_Profile into each out array that is not nullptr. Items are samples for DataSet, BinSumsBoosting
+// and ApplyUpdate, and tensor bins for the other sections. Bytes estimate the sample data or bins read and written.
+// Nanoseconds add up the time on every thread. Views share the counters of their booster. Boosters made without the
+// flag report zeros
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetBoosterProfile(BoosterHandle boosterHandle,
+      IntEbm countSections,
+      IntEbm* countCallsOut,
+      IntEbm* countItemsOut,
+      IntEbm* countBytesOut,
+      IntEbm* nanosecondsOut);
+// GetBoosterMemoryUsage writes the bytes held for each of the first countSections MemorySection subsystems into
+// bytesOut. Data shared through CreatePreparedTrainingData or CreateBoosterView is included in full for each handle,
+// so the sum over handles that share data overstates the process total. Small bookkeeping allocations are left out.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetBoosterMemoryUsage(
+      BoosterHandle boosterHandle, IntEbm countSections, IntEbm* bytesOut);
+// EstimateBoosterMemoryUsage predicts what GetBoosterMemoryUsage would report for CreateBooster with the same
+// dataSet, bag and terms without allocating any of it. It assumes 64 bit floats and hessians, which makes it an
+// upper bound on everything except the scratch space, where it is an approximation.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION EstimateBoosterMemoryUsage(const void* dataSet,
+      const BagEbm* bag,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      IntEbm countInnerBags,
+      IntEbm countSections,
+      IntEbm* bytesOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetBestTermScores(
       BoosterHandle boosterHandle, IntEbm indexTerm, double* termScoresTensorOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetCurrentTermScores(
       BoosterHandle boosterHandle, IntEbm indexTerm, double* termScoresTensorOut);
+// GetModelSnapshot returns the current and best models of a booster made with CreateBoosterFlags_ModelSnapshots as
+// they were after the last completed ApplyTermUpdate, WarmStartBooster or LoadBoosterState. It can be called from
+// any thread while another thread boosts, and only waits for the booster to swap a pointer. Snapshots never change
+// and outlive the booster, so FreeModelSnapshot must be called on each. The version increases by one with every
+// snapshot the booster publishes. GetModelSnapshotTermScores writes in the layout of GetBestTermScores, so the tensors
+// of a snapshot can be passed to CreatePredictor to score a holdout set while training continues
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetModelSnapshot(
+      BoosterHandle boosterHandle, ModelSnapshotHandle* modelSnapshotHandleOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetModelSnapshotVersion(
+      ModelSnapshotHandle modelSnapshotHandle, IntEbm* versionOut, double* bestModelMetricOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetModelSnapshotTermScores(
+      ModelSnapshotHandle modelSnapshotHandle, IntEbm indexTerm, BoolEbm isBest, double* termScoresTensorOut);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreeModelSnapshot(ModelSnapshotHandle modelSnapshotHandle);
+// GetSampleScores writes the scores that the current model gives the training samples for a direction of 1, or the
+// validation samples for a direction of -1, without rescoring them. Each sample in that direction of the bag gets
+// countScores values in the order of the dataset, which is the layout of initScores without the other direction.
+// Replicated samples are written once. The scores include initScores and any initTermScores
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetSampleScores(
+      BoosterHandle boosterHandle, BagEbm direction, double* sampleScoresOut);
+// ScoreBoosterSamples writes the scores that the model in termScores gives the training samples for a direction of 1,
+// or the validation samples for a direction of -1, in the layout of GetSampleScores. termScores holds a tensor for
+// every term, one after another in the layout of GetBestTermScores. The scores are read from the booster's binned
+// data, so no features need to be supplied, and they do not include initScores. The booster is not modified, which
+// makes this suitable for scoring the held out samples of an outer bag with a model that was averaged across bags
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ScoreBoosterSamples(
+      BoosterHandle boosterHandle, BagEbm direction, const double* termScores, double* sampleScoresOut);
+// SaveBoosterState writes the current and best models, the best validation metric and the sample scores of a booster
+// to a file, along with the gradients if isGradients is true and the rng if it is not nullptr. LoadBoosterState reads
+// them back into a booster made with the same dataset, bags, terms, flags and acceleration, which resumes boosting
+// where the saved booster stopped without rescoring any samples. Gradients that were not saved are recalculated from
+// the sample scores in one pass. Held back validation updates must be applied before saving. If LoadBoosterState
+// fails with Error_FileIO the booster is partly overwritten and needs to be freed
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SaveBoosterState(
+      BoosterHandle boosterHandle, void* rng, BoolEbm isGradients, const char* filename);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION LoadBoosterState(
+      BoosterHandle boosterHandle, void* rng, const char* filename);
+
+// CreatePredictor copies a finished model into a single allocation that Predict can use from any number of threads.
+// Feature i has countBins[i] bins, which must include the missing bin and the countCuts[i] + 1 regular bins, and its
+// cuts are taken in order from cutsLowerBoundInclusive. Term i uses the dimensionCounts[i] features taken in order
+// from featureIndexes, and its tensor is taken in order from termScores in the layout of GetBestTermScores.
+// intercept can be nullptr, in which case it is zero.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreatePredictor(LinkEbm link,
+      double linkParam,
+      IntEbm countScores,
+      const double* intercept,
+      IntEbm countFeatures,
+      const IntEbm* countBins,
+      const IntEbm* countCuts,
+      const double* cutsLowerBoundInclusive,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      const double* termScores,
+      PredictorHandle* predictorHandleOut);
+// CreatePredictorFromBooster makes the same Predictor from the best model of a booster. The booster only holds binned
+// features, so countCuts and cutsLowerBoundInclusive give the cuts for each of its features as in CreatePredictor.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreatePredictorFromBooster(BoosterHandle boosterHandle,
+      const IntEbm* countCuts,
+      const double* cutsLowerBoundInclusive,
+      const double* intercept,
+      PredictorHandle* predictorHandleOut);
+// featureVals holds countSamples values for each feature (column-major). predictionsOut receives countScores values
+// for each sample, either the additive scores or, if isRawScores is EBM_FALSE, the result of the inverse link.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION Predict(PredictorHandle predictorHandle,
+      IntEbm countSamples,
+      const double* featureVals,
+      BoolEbm isRawScores,
+      double* predictionsOut);
+// PredictOne scores a single sample whose value for each feature is in featureVals. It allocates nothing, so it is
+// the lowest latency way to score requests one at a time.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION PredictOne(
+      PredictorHandle predictorHandle, const double* featureVals, BoolEbm isRawScores, double* predictionsOut);
+// PredictContributions scores countSamples samples laid out as in Predict, and in the same pass breaks each score
+// into the countScores values that every term adds to it. If countTop is zero, contributionsOut receives
+// countTerms * countScores values for each sample in term order and termIndexesOut is not used. Otherwise
+// contributionsOut receives the countScores values of only the countTop terms with the largest sum of absolute
+// values, largest first, and termIndexesOut receives the index of each of those terms. scoresOut can be nullptr, or
+// receives the raw scores of Predict. The contributions do not include the intercept.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION PredictContributions(PredictorHandle predictorHandle,
+      IntEbm countSamples,
+      const double* featureVals,
+      IntEbm countTop,
+      double* scoresOut,
+      double* contributionsOut,
+      IntEbm* termIndexesOut);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreePredictor(PredictorHandle predictorHandle);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const void* dataSet,
       const BagEbm* bag,
@@ -472,8 +1139,22 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const
       AccelerationFlags acceleration,
       const char* objective,
       const double* experimentalParams,
+      ScratchArenaHandle scratchArenaHandle, // can be nullptr
+      InteractionHandle* interactionHandleOut);
+// CreateInteractionDetectorFromBooster reads the training gradients and binned features of boosterHandle in place
+// instead of copying the dataset, so interaction strengths reflect the booster's current model. Only features that
+// are the sole feature of some term in the booster can be used. The detector keeps the booster alive until it is
+// freed, and boosting must not run on the booster while its interaction strengths are being calculated. The booster
+// already fixed the objective, so CreateInteractionFlags_UseApprox is the only flag it accepts.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetectorFromBooster(BoosterHandle boosterHandle,
+      CreateInteractionFlags flags,
+      ScratchArenaHandle scratchArenaHandle, // can be nullptr
       InteractionHandle* interactionHandleOut);
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreeInteractionDetector(InteractionHandle interactionHandle);
+// GetInteractionAcceleration is GetBoosterAcceleration for interaction detectors. A detector made from a booster
+// reports the booster's zone
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetInteractionAcceleration(
+      InteractionHandle interactionHandle, AccelerationFlags* accelerationOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(InteractionHandle interactionHandle,
       IntEbm countDimensions,
       const IntEbm* featureIndexes,
@@ -485,6 +1166,61 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interact
       double regLambda,
       double maxDeltaStep,
       double* avgInteractionStrengthOut);
+// CalcInteractionStrengthInterval is CalcInteractionStrength plus a delete-a-group jackknife standard error of the
+// strength, for screening pairs on a detector made from a subsample, such as a bag from
+// SampleWithoutReplacementStratified. Only the pairs whose interval reaches the top-K boundary need to be scored
+// again on all of the data. The groups are runs of samples in dataset order, so the dataset should not be sorted by
+// anything related to the target. Create the detector with CreateInteractionFlags_JackknifeGroups to get enough
+// groups. standardErrorOut is +inf when there are fewer than 2 groups. CalcInteractionFlags_SparseBins is ignored.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrengthInterval(InteractionHandle interactionHandle,
+      IntEbm countDimensions,
+      const IntEbm* featureIndexes,
+      CalcInteractionFlags flags,
+      IntEbm maxCardinality,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      double* avgInteractionStrengthOut,
+      double* standardErrorOut);
+// CalcInteractionStrengths calculates the strength of countTerms terms that each have countDimensions features. The
+// features of term i are featureIndexes[i * countDimensions] onwards, and its strength goes in
+// avgInteractionStrengthsOut[i]. Each strength is the same as calling CalcInteractionStrength for that term alone.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrengths(InteractionHandle interactionHandle,
+      IntEbm countTerms,
+      IntEbm countDimensions,
+      const IntEbm* featureIndexes,
+      CalcInteractionFlags flags,
+      IntEbm maxCardinality,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      double* avgInteractionStrengthsOut);
+// FindTopInteractions finds the countTop strongest pairs among the countCandidates features, in the terms of
+// CalcInteractionStrength. The features of the strongest pair go in topFeatureIndexesOut[0] and [1], the next in [2]
+// and [3], and so on, with their strengths in topInteractionStrengthsOut, which can be nullptr. If there are fewer
+// pairs than countTop, only that many are written. Pairs that cannot beat the weakest pair found so far are skipped
+// without computing their full strength.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FindTopInteractions(InteractionHandle interactionHandle,
+      IntEbm countCandidates,
+      const IntEbm* candidateFeatureIndexes,
+      IntEbm countTop,
+      CalcInteractionFlags flags,
+      IntEbm maxCardinality,
+      IntEbm minSamplesLeaf,
+      double minHessian,
+      double regAlpha,
+      double regLambda,
+      double maxDeltaStep,
+      IntEbm* topFeatureIndexesOut,
+      double* topInteractionStrengthsOut);
+// GetInteractionMemoryUsage is GetBoosterMemoryUsage for interaction detectors. A detector made from a booster borrows
+// the booster's data, which is then reported by the booster and not here.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetInteractionMemoryUsage(
+      InteractionHandle interactionHandle, IntEbm countSections, IntEbm* bytesOut);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -18,6 +18,7 @@
 #include "common.hpp" // IsConvertError
 
 #include "ebm_internal.hpp" // FloatTickIncrement
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -1238,6 +1239,64 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SuggestGraphBounds(IntEbm countCuts
    return Error_None;
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SuggestGraphBoundsBatch(IntEbm countColumns,
+      const IntEbm* countCuts,
+      const double* cutsLowerBoundInclusive,
+      const double* minFeatureVals,
+      const double* maxFeatureVals,
+      double* lowGraphBoundsOut,
+      double* highGraphBoundsOut) {
+   // each column only costs a few comparisons, so unlike the other batch functions we don't use a ThreadPool here
+
+   if(UNLIKELY(countColumns <= IntEbm{0})) {
+      if(UNLIKELY(countColumns < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR SuggestGraphBoundsBatch countColumns < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countColumns))) {
+      LOG_0(Trace_Error, "ERROR SuggestGraphBoundsBatch IsConvertError<size_t>(countColumns)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cColumns = static_cast<size_t>(countColumns);
+
+   if(UNLIKELY(nullptr == countCuts || nullptr == minFeatureVals || nullptr == maxFeatureVals ||
+            nullptr == lowGraphBoundsOut || nullptr == highGraphBoundsOut)) {
+      LOG_0(Trace_Error, "ERROR SuggestGraphBoundsBatch a required array is NULL");
+      return Error_IllegalParamVal;
+   }
+
+   ErrorEbm errorRet = Error_None;
+   const double* pCuts = cutsLowerBoundInclusive;
+   for(size_t iColumn = 0; iColumn < cColumns; ++iColumn) {
+      const IntEbm countColumnCuts = countCuts[iColumn];
+      double lowestCut = 0.0;
+      double highestCut = 0.0;
+      if(IntEbm{0} < countColumnCuts) {
+         if(UNLIKELY(nullptr == pCuts || IsConvertError<size_t>(countColumnCuts))) {
+            LOG_0(Trace_Error, "ERROR SuggestGraphBoundsBatch invalid cuts for a column");
+            return Error_IllegalParamVal;
+         }
+         lowestCut = pCuts[0];
+         highestCut = pCuts[static_cast<size_t>(countColumnCuts) - size_t{1}];
+         pCuts += static_cast<size_t>(countColumnCuts);
+      }
+      // keep going after a bad column so that every column gets its bounds, which are NaN for the bad ones
+      const ErrorEbm error = SuggestGraphBounds(countColumnCuts,
+            lowestCut,
+            highestCut,
+            minFeatureVals[iColumn],
+            maxFeatureVals[iColumn],
+            &lowGraphBoundsOut[iColumn],
+            &highGraphBoundsOut[iColumn]);
+      if(Error_None != error && Error_None == errorRet) {
+         errorRet = error;
+      }
+   }
+   return errorRet;
+}
+
 static double Stddev(const size_t cSamples,
       const size_t cStride,
       const double* const aFeatureVals,
@@ -1651,31 +1710,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SafeStandardDeviation(
    return Error_None;
 }
 
-// we don't care if an extra log message is outputted due to the non-atomic nature of the decrement to this value
-static int g_cLogEnterGetHistogramCutCount = 25;
-static int g_cLogExitGetHistogramCutCount = 25;
-
-EBM_API_BODY IntEbm EBM_CALLING_CONVENTION GetHistogramCutCount(IntEbm countSamples, const double* featureVals) {
-   LOG_COUNTED_N(&g_cLogEnterGetHistogramCutCount,
-         Trace_Info,
-         Trace_Verbose,
-         "Entered GetHistogramCutCount: "
-         "countSamples=%" IntEbmPrintf ", "
-         "featureVals=%p",
-         countSamples,
-         static_cast<const void*>(featureVals));
-
-   if(UNLIKELY(countSamples <= 0)) {
-      if(UNLIKELY(countSamples < 0)) {
-         LOG_0(Trace_Warning, "WARNING GetHistogramCutCount countSamples < 0");
-      }
-      return 0;
-   }
-   if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
-      LOG_0(Trace_Warning, "WARNING GetHistogramCutCount IsConvertError<size_t>(countSamples)");
-      return 0;
-   }
-   const size_t cSamples = static_cast<size_t>(countSamples);
+static IntEbm GetHistogramCutCountColumn(const size_t cSamples, const double* const featureVals) {
+   EBM_ASSERT(size_t{1} <= cSamples);
 
    IntEbm ret = 0;
    size_t cNaN;
@@ -1716,6 +1752,36 @@ EBM_API_BODY IntEbm EBM_CALLING_CONVENTION GetHistogramCutCount(IntEbm countSamp
          --ret; // # of cuts is one less than the number of bins
       }
    }
+   return ret;
+}
+
+// we don't care if an extra log message is outputted due to the non-atomic nature of the decrement to this value
+static int g_cLogEnterGetHistogramCutCount = 25;
+static int g_cLogExitGetHistogramCutCount = 25;
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION GetHistogramCutCount(IntEbm countSamples, const double* featureVals) {
+   LOG_COUNTED_N(&g_cLogEnterGetHistogramCutCount,
+         Trace_Info,
+         Trace_Verbose,
+         "Entered GetHistogramCutCount: "
+         "countSamples=%" IntEbmPrintf ", "
+         "featureVals=%p",
+         countSamples,
+         static_cast<const void*>(featureVals));
+
+   if(UNLIKELY(countSamples <= 0)) {
+      if(UNLIKELY(countSamples < 0)) {
+         LOG_0(Trace_Warning, "WARNING GetHistogramCutCount countSamples < 0");
+      }
+      return 0;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
+      LOG_0(Trace_Warning, "WARNING GetHistogramCutCount IsConvertError<size_t>(countSamples)");
+      return 0;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   const IntEbm ret = GetHistogramCutCountColumn(cSamples, featureVals);
 
    LOG_COUNTED_N(&g_cLogExitGetHistogramCutCount,
          Trace_Info,
@@ -1727,4 +1793,75 @@ EBM_API_BODY IntEbm EBM_CALLING_CONVENTION GetHistogramCutCount(IntEbm countSamp
    return ret;
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetHistogramCutCountBatch(
+      IntEbm countSamples, IntEbm countColumns, const double* featureVals, IntEbm* countCutsOut) {
+   LOG_N(Trace_Info,
+         "Entered GetHistogramCutCountBatch: "
+         "countSamples=%" IntEbmPrintf ", "
+         "countColumns=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "countCutsOut=%p",
+         countSamples,
+         countColumns,
+         static_cast<const void*>(featureVals),
+         static_cast<void*>(countCutsOut));
+
+   if(UNLIKELY(countColumns <= IntEbm{0})) {
+      if(UNLIKELY(countColumns < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR GetHistogramCutCountBatch countColumns < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countColumns))) {
+      LOG_0(Trace_Error, "ERROR GetHistogramCutCountBatch IsConvertError<size_t>(countColumns)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cColumns = static_cast<size_t>(countColumns);
+
+   if(UNLIKELY(nullptr == countCutsOut)) {
+      LOG_0(Trace_Error, "ERROR GetHistogramCutCountBatch nullptr == countCutsOut");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(countSamples <= IntEbm{0})) {
+      if(UNLIKELY(countSamples < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR GetHistogramCutCountBatch countSamples < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      }
+      memset(countCutsOut, 0, sizeof(*countCutsOut) * cColumns);
+      return Error_None;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
+      LOG_0(Trace_Error, "ERROR GetHistogramCutCountBatch IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   if(UNLIKELY(IsMultiplyError(sizeof(double), cSamples, cColumns))) {
+      LOG_0(Trace_Error, "ERROR GetHistogramCutCountBatch IsMultiplyError(sizeof(double), cSamples, cColumns)");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == featureVals)) {
+      LOG_0(Trace_Error, "ERROR GetHistogramCutCountBatch nullptr == featureVals");
+      return Error_IllegalParamVal;
+   }
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cColumns, &pThreadPool);
+   if(Error_None != error) {
+      return error;
+   }
+   auto countColumn = [&](const size_t iTask, const size_t) -> ErrorEbm {
+      countCutsOut[iTask] = GetHistogramCutCountColumn(cSamples, featureVals + cSamples * iTask);
+      return Error_None;
+   };
+   error = pThreadPool->Run(cColumns, countColumn);
+   ThreadPool::Return(pThreadPool);
+
+   LOG_N(Trace_Info, "Exited GetHistogramCutCountBatch: return=%" ErrorEbmPrintf, error);
+
+   return error;
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -42,6 +42,23 @@ EBM_API_BODY void EBM_CALLING_CONVENTION BranchRNG(void* rng, void* rngOut) {
    pRngOut->Initialize(seed);
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION BranchRNGStream(void* rng, IntEbm indexStream, void* rngOut) {
+   if(IntEbm{0} > indexStream) {
+      LOG_0(Trace_Error, "ERROR BranchRNGStream indexStream must be non-negative");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<uint64_t>(indexStream)) {
+      LOG_0(Trace_Error, "ERROR BranchRNGStream IsConvertError<uint64_t>(indexStream)");
+      return Error_IllegalParamVal;
+   }
+   const RandomDeterministic* const pRng = reinterpret_cast<const RandomDeterministic*>(rng);
+   RandomDeterministic* const pRngOut = reinterpret_cast<RandomDeterministic*>(rngOut);
+
+   // rngOut can be the same memory as rng since InitializeStream reads the parent before writing
+   pRngOut->InitializeStream(*pRng, static_cast<uint64_t>(indexStream));
+   return Error_None;
+}
+
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateSeed(void* rng, SeedEbm* seedOut) {
    if(nullptr == seedOut) {
       LOG_0(Trace_Warning, "WARNING GenerateSeed nullptr == seedOut");
@@ -135,21 +152,14 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateGaussianRandom(
 
    GaussianDistribution gaussian(stddev);
 
-   double* pRandom = randomOut;
-   const double* const pRandomEnd = randomOut + count;
+   // fill the whole buffer in one call so that the sampler's setup is shared by every sample
    if(nullptr != rng) {
       RandomDeterministic* const pRng = reinterpret_cast<RandomDeterministic*>(rng);
-      do {
-         *pRandom = gaussian.Sample(*pRng, 1.0);
-         ++pRandom;
-      } while(pRandomEnd != pRandom);
+      gaussian.Fill(*pRng, 1.0, c, randomOut);
    } else {
       try {
          RandomNondeterministic<uint64_t> randomGenerator;
-         do {
-            *pRandom = gaussian.Sample(randomGenerator, 1.0);
-            ++pRandom;
-         } while(pRandomEnd != pRandom);
+         gaussian.Fill(randomGenerator, 1.0, c, randomOut);
       } catch(const std::bad_alloc&) {
          LOG_0(Trace_Warning, "WARNING GenerateGaussianRandom Out of memory allocating randomGenerator");
          return Error_OutOfMemory;
@@ -16,6 +16,7 @@
 #include "RandomDeterministic.hpp"
 #include "RandomNondeterministic.hpp"
 #include "dataset_shared.hpp" // GetDataSetSharedWeight
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -422,6 +423,114 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratified(
    return Error_None;
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateBags(void* rng,
+      IntEbm countBags,
+      IntEbm countClasses,
+      IntEbm countTrainingSamples,
+      IntEbm countValidationSamples,
+      const IntEbm* targets,
+      BagEbm* bagsOut) {
+   LOG_N(Trace_Info,
+         "Entered GenerateBags: "
+         "rng=%p, "
+         "countBags=%" IntEbmPrintf ", "
+         "countClasses=%" IntEbmPrintf ", "
+         "countTrainingSamples=%" IntEbmPrintf ", "
+         "countValidationSamples=%" IntEbmPrintf ", "
+         "targets=%p, "
+         "bagsOut=%p",
+         rng,
+         countBags,
+         countClasses,
+         countTrainingSamples,
+         countValidationSamples,
+         static_cast<const void*>(targets),
+         static_cast<void*>(bagsOut));
+
+   if(UNLIKELY(countBags <= IntEbm{0})) {
+      if(UNLIKELY(countBags < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR GenerateBags countBags < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countBags))) {
+      LOG_0(Trace_Error, "ERROR GenerateBags IsConvertError<size_t>(countBags)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBags = static_cast<size_t>(countBags);
+
+   if(UNLIKELY(IsConvertError<size_t>(countTrainingSamples))) {
+      LOG_0(Trace_Error, "ERROR GenerateBags IsConvertError<size_t>(countTrainingSamples)");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsConvertError<size_t>(countValidationSamples))) {
+      LOG_0(Trace_Error, "ERROR GenerateBags IsConvertError<size_t>(countValidationSamples)");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(IsAddError(static_cast<size_t>(countTrainingSamples), static_cast<size_t>(countValidationSamples)))) {
+      LOG_0(Trace_Error, "ERROR GenerateBags IsAddError(countTrainingSamples, countValidationSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countTrainingSamples) + static_cast<size_t>(countValidationSamples);
+   if(UNLIKELY(size_t{0} == cSamples)) {
+      LOG_0(Trace_Info, "Exited GenerateBags with zero samples");
+      return Error_None;
+   }
+   if(UNLIKELY(IsMultiplyError(sizeof(*bagsOut), cSamples, cBags))) {
+      LOG_0(Trace_Error, "ERROR GenerateBags IsMultiplyError(sizeof(*bagsOut), cSamples, cBags)");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(nullptr == bagsOut)) {
+      LOG_0(Trace_Error, "ERROR GenerateBags nullptr == bagsOut");
+      return Error_IllegalParamVal;
+   }
+
+   // Each bag gets its own RNG, branched from ours in bag order before any bag is drawn, so the bags do not depend
+   // on the number of threads or on the order in which the threads finish them
+   RandomDeterministic* aRngs = nullptr;
+   if(nullptr != rng) {
+      if(UNLIKELY(IsMultiplyError(sizeof(RandomDeterministic), cBags))) {
+         LOG_0(Trace_Warning, "WARNING GenerateBags IsMultiplyError(sizeof(RandomDeterministic), cBags)");
+         return Error_OutOfMemory;
+      }
+      aRngs = static_cast<RandomDeterministic*>(malloc(sizeof(RandomDeterministic) * cBags));
+      if(UNLIKELY(nullptr == aRngs)) {
+         LOG_0(Trace_Warning, "WARNING GenerateBags nullptr == aRngs");
+         return Error_OutOfMemory;
+      }
+      for(size_t iBag = 0; iBag < cBags; ++iBag) {
+         BranchRNG(rng, &aRngs[iBag]);
+      }
+   }
+
+   ThreadPool* pThreadPool = nullptr;
+   ErrorEbm error = ThreadPool::Borrow(cBags, &pThreadPool);
+   if(Error_None != error) {
+      free(aRngs);
+      return error;
+   }
+
+   auto generateBag = [&](const size_t iTask, const size_t iThread) -> ErrorEbm {
+      UNUSED(iThread);
+      void* const rngBag = nullptr == aRngs ? nullptr : &aRngs[iTask];
+      BagEbm* const bagOut = bagsOut + cSamples * iTask;
+      if(nullptr == targets) {
+         return SampleWithoutReplacement(rngBag, countTrainingSamples, countValidationSamples, bagOut);
+      }
+      return SampleWithoutReplacementStratified(
+            rngBag, countClasses, countTrainingSamples, countValidationSamples, targets, bagOut);
+   };
+   error = pThreadPool->Run(cBags, generateBag);
+
+   ThreadPool::Return(pThreadPool);
+   free(aRngs);
+
+   LOG_N(Trace_Info, "Exited GenerateBags: return=%" ErrorEbmPrintf, error);
+
+   return error;
+}
+
 extern ErrorEbm Unbag(const size_t cSamples,
       const BagEbm* const aBag,
       size_t* const pcTrainingSamplesOut,
@@ -0,0 +1,102 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// Standalone checks of the CreateBooster parameter validation. This is not part of the package build. It only uses the
+// public interface, so build libebm as a shared library first and then something like:
+//
+//   g++ -std=c++17 -O2 -I../inc create_booster_test.cpp -o create_booster_test -L<dir> -lebm -Wl,-rpath,<dir> -pthread
+//   ./create_booster_test
+//
+// Each failed check is written to stderr and the exit code is the number of failed checks.
+
+#include <stddef.h> // size_t
+#include <stdio.h> // printf, fprintf
+#include <vector>
+
+#include "libebm.h"
+
+namespace {
+
+static std::vector<unsigned char> MakeRegressionDataSet() {
+   static constexpr IntEbm k_cSamples = 16;
+   static constexpr IntEbm k_cBins = 4;
+
+   IntEbm binIndexes[k_cSamples];
+   double targets[k_cSamples];
+   for(IntEbm iSample = 0; iSample < k_cSamples; ++iSample) {
+      binIndexes[iSample] = 1 + iSample % (k_cBins - 2);
+      // positive so that the deviance objectives accept the targets
+      targets[iSample] = 0.5 + static_cast<double>(iSample);
+   }
+
+   const IntEbm cBytes = MeasureDataSetHeader(1, 0, 1) +
+         MeasureFeature(k_cBins, EBM_TRUE, EBM_FALSE, EBM_FALSE, k_cSamples, binIndexes) +
+         MeasureRegressionTarget(k_cSamples, targets);
+
+   std::vector<unsigned char> dataSet(static_cast<size_t>(cBytes));
+   ErrorEbm error = FillDataSetHeader(1, 0, 1, cBytes, dataSet.data());
+   error |= FillFeature(k_cBins, EBM_TRUE, EBM_FALSE, EBM_FALSE, k_cSamples, binIndexes, cBytes, dataSet.data());
+   error |= FillRegressionTarget(k_cSamples, targets, cBytes, dataSet.data());
+   if(Error_None != error) {
+      dataSet.clear();
+   }
+   return dataSet;
+}
+
+static int CheckCreateBooster(const std::vector<unsigned char>& dataSet,
+      const char* const sObjective,
+      const CreateBoosterFlags flags,
+      const ErrorEbm errorExpected) {
+   const IntEbm dimensionCounts[1] = {1};
+   const IntEbm featureIndexes[1] = {0};
+   BoosterHandle boosterHandle = nullptr;
+   const ErrorEbm error = CreateBooster(nullptr,
+         dataSet.data(),
+         nullptr,
+         nullptr,
+         1,
+         dimensionCounts,
+         featureIndexes,
+         nullptr,
+         0,
+         flags,
+         AccelerationFlags_NONE,
+         sObjective,
+         nullptr,
+         nullptr,
+         &boosterHandle);
+   FreeBooster(boosterHandle);
+   if(errorExpected != error) {
+      fprintf(stderr,
+            "create_booster_test: CreateBooster for %s with flags 0x%x returned %d instead of %d\n",
+            sObjective,
+            static_cast<unsigned int>(flags),
+            static_cast<int>(error),
+            static_cast<int>(errorExpected));
+      return 1;
+   }
+   return 0;
+}
+
+} // namespace
+
+int main() {
+   const std::vector<unsigned char> dataSet = MakeRegressionDataSet();
+   if(dataSet.empty()) {
+      fprintf(stderr, "create_booster_test: could not build the dataset\n");
+      return 1;
+   }
+
+   int cFailed = 0;
+
+   // CreateBoosterFlags_ConstantHessian is only accepted by objectives whose hessian is bounded by HessianConstant
+   cFailed += CheckCreateBooster(dataSet, "pseudo_huber", CreateBoosterFlags_ConstantHessian, Error_None);
+   cFailed += CheckCreateBooster(dataSet, "rmse", CreateBoosterFlags_ConstantHessian, Error_None);
+   cFailed += CheckCreateBooster(dataSet, "poisson_deviance", CreateBoosterFlags_Default, Error_None);
+   cFailed +=
+         CheckCreateBooster(dataSet, "poisson_deviance", CreateBoosterFlags_ConstantHessian, Error_IllegalParamVal);
+
+   printf("create_booster_test: %d failed\n", cFailed);
+   return cFailed;
+}
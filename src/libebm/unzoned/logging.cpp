@@ -4,6 +4,12 @@
 
 #include <stdio.h> // vsnprintf
 #include <stdarg.h> // va_start
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t
+#include <math.h> // NAN
+#include <new> // placement new
+#include <atomic>
+#include <limits>
 
 #include "logging.h"
 
@@ -22,6 +28,177 @@ static LogCallbackFunction g_pLogCallbackFunction = NULL;
 unsigned int g_coverage[TEST_COVERAGE_COUNT] = {0};
 #endif // NDEBUG
 
+TraceEbm g_traceEventLevel = Trace_Off;
+
+static TraceEventCallbackFunction g_pTraceEventCallbackFunction = NULL;
+
+// A bounded multi-producer queue in the style of Dmitry Vyukov's. Each slot's sequence tells a producer the slot is
+// free when it equals the producer's ticket, and tells the consumer it is filled when it equals the ticket plus one.
+// Producers never wait: a full ring drops the event instead, since stalling a boosting thread on tracing would be
+// worse than losing a trace record.
+struct TraceEventSlot {
+   std::atomic<size_t> m_sequence;
+   TraceEbm m_traceLevel;
+   IntEbm m_eventId;
+   void* m_handle;
+   double m_aFields[TraceEventFieldsMax];
+};
+
+static TraceEventSlot* g_aTraceEventSlots = NULL;
+static size_t g_iTraceEventSlotMask = 0;
+static std::atomic<size_t> g_iTraceEventEnqueue(0);
+static std::atomic<size_t> g_iTraceEventDequeue(0);
+static std::atomic<size_t> g_cTraceEventsDropped(0);
+
+static void FreeTraceEventSlots(void) {
+   free(g_aTraceEventSlots);
+   g_aTraceEventSlots = NULL;
+   g_iTraceEventSlotMask = 0;
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION SetTraceEventCallback(
+      TraceEbm traceLevel, TraceEventCallbackFunction traceEventCallback) {
+   if(traceLevel < Trace_Off || Trace_Verbose < traceLevel || NULL == traceEventCallback) {
+      traceLevel = Trace_Off;
+   }
+   g_traceEventLevel = traceLevel;
+   FreeTraceEventSlots();
+   g_pTraceEventCallbackFunction = traceEventCallback;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SetTraceEventBuffer(TraceEbm traceLevel, IntEbm countEvents) {
+   g_traceEventLevel = Trace_Off;
+   FreeTraceEventSlots();
+   g_pTraceEventCallbackFunction = NULL;
+   g_iTraceEventEnqueue.store(0, std::memory_order_relaxed);
+   g_iTraceEventDequeue.store(0, std::memory_order_relaxed);
+   g_cTraceEventsDropped.store(0, std::memory_order_relaxed);
+
+   if(countEvents < 0 || traceLevel < Trace_Off || Trace_Verbose < traceLevel) {
+      return Error_IllegalParamVal;
+   }
+   if(0 == countEvents || Trace_Off == traceLevel) {
+      return Error_None;
+   }
+   // a power of two lets the ticket wrap around the ring with a mask
+   size_t cSlots = 1;
+   while(cSlots < static_cast<size_t>(countEvents)) {
+      if((std::numeric_limits<size_t>::max() >> 1) < cSlots) {
+         return Error_OutOfMemory;
+      }
+      cSlots <<= 1;
+   }
+   if(std::numeric_limits<size_t>::max() / sizeof(TraceEventSlot) < cSlots) {
+      return Error_OutOfMemory;
+   }
+   TraceEventSlot* const aSlots = static_cast<TraceEventSlot*>(malloc(sizeof(TraceEventSlot) * cSlots));
+   if(NULL == aSlots) {
+      return Error_OutOfMemory;
+   }
+   for(size_t iSlot = 0; iSlot < cSlots; ++iSlot) {
+      new(&aSlots[iSlot].m_sequence) std::atomic<size_t>(iSlot);
+   }
+   g_aTraceEventSlots = aSlots;
+   g_iTraceEventSlotMask = cSlots - 1;
+   g_traceEventLevel = traceLevel;
+   return Error_None;
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION DrainTraceEvents(IntEbm countEventsMax,
+      TraceEbm* traceLevelsOut,
+      IntEbm* eventIdsOut,
+      void** handlesOut,
+      double* fieldsOut,
+      IntEbm* countDroppedOut) {
+   if(NULL != countDroppedOut) {
+      const size_t cDropped = g_cTraceEventsDropped.exchange(0, std::memory_order_relaxed);
+      *countDroppedOut = static_cast<size_t>(std::numeric_limits<IntEbm>::max()) < cDropped ?
+            std::numeric_limits<IntEbm>::max() :
+            static_cast<IntEbm>(cDropped);
+   }
+   TraceEventSlot* const aSlots = g_aTraceEventSlots;
+   if(NULL == aSlots || countEventsMax <= 0) {
+      return 0;
+   }
+
+   IntEbm cDrained = 0;
+   size_t iDequeue = g_iTraceEventDequeue.load(std::memory_order_relaxed);
+   do {
+      TraceEventSlot* const pSlot = &aSlots[iDequeue & g_iTraceEventSlotMask];
+      if(pSlot->m_sequence.load(std::memory_order_acquire) != iDequeue + 1) {
+         // the next slot is either empty or a producer is still filling it
+         break;
+      }
+      if(NULL != traceLevelsOut) {
+         traceLevelsOut[cDrained] = pSlot->m_traceLevel;
+      }
+      if(NULL != eventIdsOut) {
+         eventIdsOut[cDrained] = pSlot->m_eventId;
+      }
+      if(NULL != handlesOut) {
+         handlesOut[cDrained] = pSlot->m_handle;
+      }
+      if(NULL != fieldsOut) {
+         for(IntEbm iField = 0; iField < TraceEventFieldsMax; ++iField) {
+            fieldsOut[cDrained * TraceEventFieldsMax + iField] = pSlot->m_aFields[iField];
+         }
+      }
+      // hand the slot back to the producer that will wrap around to it
+      pSlot->m_sequence.store(iDequeue + g_iTraceEventSlotMask + 1, std::memory_order_release);
+      ++iDequeue;
+      ++cDrained;
+   } while(cDrained < countEventsMax);
+   g_iTraceEventDequeue.store(iDequeue, std::memory_order_relaxed);
+   return cDrained;
+}
+
+INTERNAL_IMPORT_EXPORT_BODY void InternalTraceEvent(const TraceEbm traceLevel,
+      const IntEbm eventId,
+      void* const handle,
+      const IntEbm countFields,
+      const double* const aFields) {
+   assert(0 <= countFields && countFields <= TraceEventFieldsMax);
+
+   TraceEventSlot* const aSlots = g_aTraceEventSlots;
+   if(NULL == aSlots) {
+      if(NULL != g_pTraceEventCallbackFunction) {
+         (*g_pTraceEventCallbackFunction)(traceLevel, eventId, handle, countFields, aFields);
+      }
+      return;
+   }
+
+   TraceEventSlot* pSlot;
+   size_t iEnqueue = g_iTraceEventEnqueue.load(std::memory_order_relaxed);
+   while(true) {
+      pSlot = &aSlots[iEnqueue & g_iTraceEventSlotMask];
+      const size_t sequence = pSlot->m_sequence.load(std::memory_order_acquire);
+      if(sequence == iEnqueue) {
+         if(g_iTraceEventEnqueue.compare_exchange_weak(iEnqueue, iEnqueue + 1, std::memory_order_relaxed)) {
+            break;
+         }
+         // another producer took this ticket and iEnqueue now holds the newer one
+      } else if(static_cast<ptrdiff_t>(sequence - iEnqueue) < 0) {
+         // the consumer has not drained the slot from the previous lap, so the ring is full
+         g_cTraceEventsDropped.fetch_add(1, std::memory_order_relaxed);
+         return;
+      } else {
+         iEnqueue = g_iTraceEventEnqueue.load(std::memory_order_relaxed);
+      }
+   }
+
+   pSlot->m_traceLevel = traceLevel;
+   pSlot->m_eventId = eventId;
+   pSlot->m_handle = handle;
+   IntEbm iField = 0;
+   for(; iField < countFields; ++iField) {
+      pSlot->m_aFields[iField] = aFields[iField];
+   }
+   for(; iField < TraceEventFieldsMax; ++iField) {
+      pSlot->m_aFields[iField] = NAN;
+   }
+   pSlot->m_sequence.store(iEnqueue + 1, std::memory_order_release);
+}
+
 EBM_API_BODY const char* EBM_CALLING_CONVENTION GetTraceLevelString(TraceEbm traceLevel) {
    static const char g_sTraceOff[] = "OFF";
    static const char g_sTraceError[] = "ERROR";
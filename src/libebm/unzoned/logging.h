@@ -52,6 +52,14 @@ inline static const char* ObtainTruth(const BoolEbm b) { return EBM_FALSE != b ?
 
 INTERNAL_EXPORT_VAR_INCLUDE TraceEbm g_traceLevel;
 
+INTERNAL_EXPORT_VAR_INCLUDE TraceEbm g_traceEventLevel;
+
+INTERNAL_IMPORT_EXPORT_INCLUDE void InternalTraceEvent(const TraceEbm traceLevel,
+      const IntEbm eventId,
+      void* const handle,
+      const IntEbm countFields,
+      const double* const aFields);
+
 INTERNAL_IMPORT_EXPORT_INCLUDE void InteralLogWithArguments(const TraceEbm traceLevel, const char* const sMessage, ...);
 INTERNAL_IMPORT_EXPORT_INCLUDE void InteralLogWithoutArguments(const TraceEbm traceLevel, const char* const sMessage);
 INTERNAL_IMPORT_EXPORT_INCLUDE void LogAssertFailure(const unsigned long long lineNumber,
@@ -196,6 +204,27 @@ INTERNAL_IMPORT_EXPORT_INCLUDE void LogAssertFailure(const unsigned long long li
       }                                                                                                                \
    } while((void)0, 0)
 
+// TRACE_EVENT raises a structured event with the variadic arguments as its double fields. Like LOG_N, the arguments
+// are only evaluated when the event level is on, and there is no formatting, so it needs no throttling
+#define TRACE_EVENT(traceLevel, eventId, handle, ...)                                                                  \
+   do {                                                                                                                \
+      const TraceEbm LOG__traceLevel = (traceLevel);                                                                   \
+      static_assert(Trace_Off < LOG__traceLevel,                                                                       \
+            "traceLevel can't be Trace_Off or lower for call to TRACE_EVENT(traceLevel, eventId, handle, ...)");       \
+      static_assert(LOG__traceLevel <= Trace_Verbose,                                                                  \
+            "traceLevel can't be higher than Trace_Verbose for call to TRACE_EVENT(traceLevel, eventId, handle, ...)"); \
+      if(LOG__traceLevel <= g_traceEventLevel) {                                                                       \
+         const double LOG__aFields[] = {__VA_ARGS__};                                                                  \
+         static_assert(sizeof(LOG__aFields) / sizeof(LOG__aFields[0]) <= TraceEventFieldsMax,                          \
+               "TRACE_EVENT has more fields than TraceEventFieldsMax");                                                \
+         InternalTraceEvent(LOG__traceLevel,                                                                           \
+               (eventId),                                                                                              \
+               (handle),                                                                                               \
+               STATIC_CAST(IntEbm, sizeof(LOG__aFields) / sizeof(LOG__aFields[0])),                                    \
+               LOG__aFields);                                                                                          \
+      }                                                                                                                \
+   } while((void)0, 0)
+
 #ifndef NDEBUG
 // the "assert(!  #bCondition)" condition needs some explanation.  At that point we definetly want to assert false, and
 // we also want to include the text of the assert that triggered the failure. Any string will have a non-zero pointer,
@@ -3,7 +3,11 @@
 // Author: Paul Koch <code@koch.ninja>
 
 #include <string.h> // memcpy, strchr
-#include <stdlib.h> // strtod, malloc, free
+#include <stdlib.h> // strtod, malloc, free, posix_memalign
+
+#ifdef __linux__
+#include <sys/mman.h> // madvise
+#endif // __linux__
 
 #include "unzoned.h"
 
@@ -170,8 +174,40 @@ INTERNAL_IMPORT_EXPORT_BODY size_t CountParams(const char* sRegistration, const
    return cParams;
 }
 
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+// Transparent hugepages are 2 MiB on x86_64 and on aarch64 kernels with 4 KiB base pages. Arrays this large are the
+// per subset gradients, sample scores and packed term data, which are streamed through on every boosting step. Putting
+// them on hugepages removes most of the TLB misses, and rounding up to whole hugepages wastes at most one of them.
+#define HUGE_PAGE_BYTES (STATIC_CAST(size_t, 2) << 20)
+#define HUGE_PAGE_MIN_BYTES (STATIC_CAST(size_t, 4) << 20)
+
+static void* AlignedAllocHuge(const size_t cBytes) {
+   if(SIZE_MAX - SIMD_BYTE_ALIGNMENT - (HUGE_PAGE_BYTES - 1) < cBytes) {
+      return NULL;
+   }
+   const size_t cPaddedBytes =
+         (SIMD_BYTE_ALIGNMENT + cBytes + (HUGE_PAGE_BYTES - 1)) & ~STATIC_CAST(size_t, HUGE_PAGE_BYTES - 1);
+   void* p;
+   if(0 != posix_memalign(&p, HUGE_PAGE_BYTES, cPaddedBytes)) {
+      return NULL;
+   }
+   // this only fails when the kernel has transparent hugepages disabled, and then we keep the regular pages
+   madvise(p, cPaddedBytes, MADV_HUGEPAGE);
+
+   // keep the same layout as the regular path so that AlignedFree does not need to know which path was taken
+   void** const pAligned = REINTERPRET_CAST(void**, REINTERPRET_CAST(char*, p) + SIMD_BYTE_ALIGNMENT);
+   *(pAligned - 1) = p;
+   return REINTERPRET_CAST(void*, pAligned);
+}
+#endif // __linux__ && MADV_HUGEPAGE
+
 INTERNAL_IMPORT_EXPORT_BODY void* AlignedAlloc(const size_t cBytes) {
    EBM_ASSERT(0 != cBytes);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+   if(HUGE_PAGE_MIN_BYTES <= cBytes) {
+      return AlignedAllocHuge(cBytes);
+   }
+#endif // __linux__ && MADV_HUGEPAGE
    if(SIZE_MAX - (sizeof(void*) + SIMD_BYTE_ALIGNMENT - 1) < cBytes) {
       return NULL;
    }
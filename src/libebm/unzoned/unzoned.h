@@ -147,6 +147,8 @@ extern "C" {
 
 #define INLINE_ALWAYS inline __attribute__((always_inline))
 #define NEVER_INLINE  __attribute__((noinline))
+// hint that we'll read the memory soon.  Prefetches never fault, but the address should still be inside the allocation
+#define PREFETCH_READ(p) __builtin_prefetch((p), 0, 3)
 
 // TODO : use EBM_RESTRICT_FUNCTION_RETURN EBM_RESTRICT_PARAM_VARIABLE and EBM_NOALIAS.  This helps performance by
 // telling the compiler that pointers are
@@ -169,6 +171,7 @@ extern "C" {
 #define UNPREDICTABLE(b) (b)
 #define INLINE_ALWAYS    inline __forceinline
 #define NEVER_INLINE     __declspec(noinline)
+#define PREFETCH_READ(p) ((void)(p))
 
 #else // compiler type
 #error compiler not recognized